@@ -18,6 +18,7 @@
 #include "config.h"
 #include "../localization.h"
 #include "../ffs_paths.h"
+#include "../afs/concrete.h"
 #include "../return_codes.h"
 
     #include <gtk/gtk.h>
@@ -145,6 +146,8 @@ bool Application::OnInit()
     }
     catch (const FileError& e) { notifyAppError(e.toString(), FfsExitCode::warning); }
 
+    fff::initAfs({fff::getResourceDirPath(), fff::getConfigDirPath()}); //FTP/SFTP/Google Drive folders are monitored by polling
+
 
     auto onSystemShutdown = []
     {
@@ -202,6 +205,11 @@ int Application::OnExit()
 {
     fff::localizationCleanup();
     imageResourcesCleanup();
+
+    const std::wstring& warningMsg = fff::teardownAfs();
+    if (!warningMsg.empty())
+        notifyAppError(warningMsg, FfsExitCode::warning);
+
     return wxApp::OnExit();
 }
 
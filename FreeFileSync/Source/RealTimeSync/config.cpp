@@ -16,7 +16,7 @@ using namespace zen;
 using namespace rts;
 
 //-------------------------------------------------------------------------------------------------------------------------------
-const int XML_FORMAT_RTS_CFG = 2; //2020-04-14
+const int XML_FORMAT_RTS_CFG = 3; //2026-10-15
 //-------------------------------------------------------------------------------------------------------------------------------
 
 
@@ -37,6 +37,38 @@ bool readText(const std::string& input, wxLanguage& value)
 
 namespace
 {
+//analog to FreeFileSync's config.cpp
+std::vector<Zstring> splitFilterByLines(const Zstring& filterPhrase)
+{
+    return split(filterPhrase, Zstr('\n'), SplitOnEmpty::allow);
+}
+
+
+Zstring mergeFilterLines(const std::vector<Zstring>& filterLines)
+{
+    Zstring out;
+    for (const Zstring& line : filterLines)
+    {
+        if (!out.empty())
+            out += Zstr('\n');
+        out += line;
+    }
+    return out;
+}
+
+
+void readFilter(const XmlIn& in, Zstring& includeFilter, Zstring& excludeFilter)
+{
+    std::vector<Zstring> tmpIn;
+    if (in["Include"](tmpIn)) //else: keep default value
+        includeFilter = mergeFilterLines(tmpIn);
+
+    std::vector<Zstring> tmpEx;
+    if (in["Exclude"](tmpEx)) //else: keep default value
+        excludeFilter = mergeFilterLines(tmpEx);
+}
+
+
 enum class RtsXmlType
 {
     real,
@@ -69,6 +101,9 @@ void readConfig(const XmlIn& in, XmlRealConfig& cfg, int formatVer)
     in["Delay"      ](cfg.delay);
     in["Commandline"](cfg.commandline);
 
+    if (formatVer >= 3) //TODO: remove check after migration! 2026-10-15
+        readFilter(in["Filter"], cfg.includeFilter, cfg.excludeFilter);
+
     //TODO: remove if clause after migration! 2020-04-14
     if (formatVer < 2)
         if (startsWithAsciiNoCase(cfg.commandline, "cmd /c ") ||
@@ -82,6 +117,9 @@ void writeConfig(const XmlRealConfig& cfg, XmlOut& out)
     out["Directories"](cfg.directories);
     out["Delay"      ](cfg.delay);
     out["Commandline"](cfg.commandline);
+
+    out["Filter"]["Include"](splitFilterByLines(cfg.includeFilter));
+    out["Filter"]["Exclude"](splitFilterByLines(cfg.excludeFilter));
 }
 }
 
@@ -151,6 +189,9 @@ void rts::readRealOrBatchConfig(const Zstring& filePath, XmlRealConfig& cfg, std
             uniqueFolders.insert(folderPathPhraseRight);
         }
 
+        //local filters are combined with the global one => global filter alone never excludes relevant changes
+        readFilter(in["Filter"], cfg.includeFilter, cfg.excludeFilter);
+
         //don't report failure as warning only:
         checkXmlMappingErrors(in, filePath); //throw FileError
         //---------------------------------------------------------------------------------------
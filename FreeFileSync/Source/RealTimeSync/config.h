@@ -18,6 +18,10 @@ struct XmlRealConfig
     std::vector<Zstring> directories;
     Zstring commandline;
     unsigned int delay = 10;
+
+    //changes of excluded items don't trigger the command (global filter of an imported .ffs_batch)
+    Zstring includeFilter = Zstr("*");
+    Zstring excludeFilter;
 };
 
 void readConfig(const Zstring& filePath, XmlRealConfig& config, std::wstring& warningMsg); //throw FileError
@@ -345,6 +345,9 @@ void MainDialog::setConfiguration(const XmlRealConfig& cfg)
 
     m_textCtrlCommand->SetValue(utfTo<wxString>(cfg.commandline));
     m_spinCtrlDelay  ->SetValue(static_cast<int>(cfg.delay));
+
+    includeFilter_ = cfg.includeFilter;
+    excludeFilter_ = cfg.excludeFilter;
 }
 
 
@@ -359,6 +362,8 @@ XmlRealConfig MainDialog::getConfiguration()
 
     output.commandline = utfTo<Zstring>(m_textCtrlCommand->GetValue());
     output.delay       = m_spinCtrlDelay->GetValue();
+    output.includeFilter = includeFilter_;
+    output.excludeFilter = excludeFilter_;
 
     return output;
 }
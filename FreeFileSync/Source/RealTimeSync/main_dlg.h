@@ -66,6 +66,9 @@ private:
 
     Zstring folderLastSelected_;
 
+    Zstring includeFilter_; //no GUI controls: keep as loaded
+    Zstring excludeFilter_; //
+
     zen::AsyncGuiQueue guiQueue_; //schedule and run long-running tasks asynchronously, but process results on GUI queue
 
     const zen::SharedRef<std::function<void()>> onBeforeSystemShutdownCookie_ = zen::makeSharedRef<std::function<void()>>([this] { onBeforeSystemShutdown(); });
@@ -9,173 +9,492 @@
 #include <zen/dir_watcher.h>
 #include <zen/thread.h>
 #include <zen/resolve_path.h>
+#include <zen/file_path.h>
+#include "../afs/concrete.h"
 //#include "../library/db_file.h"     //SYNC_DB_FILE_ENDING -> complete file too much of a dependency; file ending too little to decouple into single header
 //#include "../library/lock_holder.h" //LOCK_FILE_ENDING
 //TEMP_FILE_ENDING
 
 using namespace zen;
+using namespace fff;
+using AFS = AbstractFileSystem;
 
 
 namespace
 {
 constexpr std::chrono::seconds FOLDER_EXISTENCE_CHECK_INTERVAL(1);
+constexpr std::chrono::seconds MISSING_FOLDER_PROBE_INTERVAL_MAX(32); //per-folder backoff: 1, 2, 4, ... seconds
 
+//don't bother listing excessive number of changes: let FreeFileSync run a full comparison instead
+constexpr size_t CHANGED_ITEMS_MAX = 10000;
 
-//wait until all directories become available (again) + logs in network share
-std::set<Zstring, LessNativePath> waitForMissingDirs(const std::vector<Zstring>& folderPathPhrases, //throw FileError
-                                                     const std::function<void(const Zstring& folderPath)>& requestUiUpdate, std::chrono::milliseconds cbInterval)
+//event storms (e.g. build output): report the parent folder instead of its changed children => FreeFileSync traverses it completely
+constexpr size_t CHANGED_CHILDREN_MAX = 100;
+
+//FTP/SFTP: every poll traverses the complete folder hierarchy on the server
+constexpr std::chrono::seconds REMOTE_POLL_INTERVAL(60);
+//Google Drive: traversal is served from the local buffer which is kept up to date via the Changes API => cheap
+constexpr std::chrono::seconds REMOTE_POLL_INTERVAL_GDRIVE(10);
+
+
+bool isRemoteFolder(const Zstring& folderPathPhrase)
 {
-    //early failure! check for unsupported folder paths:
-    for (const char* protoName : {"ftp", "sftp", "mtp", "gdrive"})
-        for (const Zstring& phrase : folderPathPhrases)
-            //hopefully clear enough now: https://freefilesync.org/forum/viewtopic.php?t=4302
-            if (startsWithAsciiNoCase(trimCpy(phrase), std::string(protoName) + ':'))
-                throw FileError(replaceCpy(_("The %x protocol does not support directory monitoring:"), L"%x", utfTo<std::wstring>(protoName)) + L"\n\n" + fmtPath(phrase));
+    for (const char* protoName : {"ftp", "sftp", "gdrive"})
+        if (startsWithAsciiNoCase(trimCpy(folderPathPhrase), std::string(protoName) + ':'))
+            return true;
+    return false;
+}
 
-    for (;;)
+
+//FTP/SFTP/Google Drive don't support change notifications => compare snapshots of the folder hierarchy instead
+class RemoteWatcher
+{
+public:
+    RemoteWatcher(const Zstring& folderPath /*display path*/, const AbstractPath& afsFolderPath, const fff::PathFilter& filter) :
+        folderPath_(folderPath),
+        afsFolderPath_(afsFolderPath),
+        filter_(filter),
+        pollInterval_(startsWithAsciiNoCase(AFS::getInitPathPhrase(afsFolderPath), "gdrive:") ? REMOTE_POLL_INTERVAL_GDRIVE : REMOTE_POLL_INTERVAL)
     {
-        struct FolderInfo
-        {
-            Zstring folderPathPhrase;
-            std::future<bool> folderAvailable;
-        };
-        std::map<Zstring /*folderPath*/, FolderInfo, LessNativePath> folderInfos;
+        startSnapshot(); //baseline: changes before it is available are not reported
+    }
 
-        for (const Zstring& phrase : folderPathPhrases)
+    const Zstring& getFolderPath() const { return folderPath_; }
+    const AbstractPath& getAfsFolderPath() const { return afsFolderPath_; }
+
+    std::vector<DirWatcher::Change> fetchChanges() //throw FileError; non-blocking
+    {
+        if (!worker_.joinable())
         {
-            const Zstring& folderPath = getResolvedFilePath(phrase);
+            if (std::chrono::steady_clock::now() >= nextPollTime_)
+                startSnapshot();
+            return {};
+        }
+
+        if (nextSnapshot_.wait_for(std::chrono::seconds(0)) == std::future_status::timeout)
+            return {};
 
-            //start all folder checks asynchronously (non-existent network path may block)
-            if (!folderInfos.contains(folderPath))
-                folderInfos[folderPath] = { phrase, runAsync([folderPath]{ return dirAvailable(folderPath); }) };
+        worker_.join();
+        nextPollTime_ = std::chrono::steady_clock::now() + pollInterval_;
+
+        Snapshot snapshot = nextSnapshot_.get(); //throw FileError
+
+        std::vector<DirWatcher::Change> changes;
+        if (lastSnapshot_)
+        {
+            auto makeChange = [&](DirWatcher::ChangeType type, const Zstring& relPath)
+            {
+                return DirWatcher::Change{type, utfTo<Zstring>(AFS::getDisplayPath(AFS::appendRelPath(afsFolderPath_, relPath)))};
+            };
+
+            for (const auto& [relPath, state] : snapshot)
+                if (auto it = lastSnapshot_->find(relPath);
+                    it == lastSnapshot_->end())
+                    changes.push_back(makeChange(DirWatcher::ChangeType::create, relPath));
+                else if (it->second != state)
+                    changes.push_back(makeChange(DirWatcher::ChangeType::update, relPath));
+
+            for (const auto& [relPath, state] : *lastSnapshot_)
+                if (!snapshot.contains(relPath))
+                    changes.push_back(makeChange(DirWatcher::ChangeType::remove, relPath));
         }
+        lastSnapshot_ = std::move(snapshot);
+        return changes;
+    }
+
+private:
+    RemoteWatcher           (const RemoteWatcher&) = delete;
+    RemoteWatcher& operator=(const RemoteWatcher&) = delete;
+
+    struct ItemState
+    {
+        AFS::ItemType type = AFS::ItemType::file;
+        uint64_t fileSize = 0;
+        time_t modTime = 0; //n/a for folders
+        bool operator==(const ItemState&) const = default;
+    };
+    using Snapshot = std::unordered_map<Zstring /*relPath*/, ItemState>;
+
+    void startSnapshot()
+    {
+        std::promise<Snapshot> promSnapshot;
+        nextSnapshot_ = promSnapshot.get_future();
 
-        std::set<Zstring, LessNativePath> availablePaths;
-        std::set<Zstring, LessNativePath> missingPathPhrases;
-        for (auto& [folderPath, folderInfo] : folderInfos)
+        worker_ = InterruptibleThread([afsFolderPath = afsFolderPath_, &filter = filter_, promSnapshot = std::move(promSnapshot)]() mutable
         {
-            std::future<bool>& folderAvailable = folderInfo.folderAvailable;
+            setCurrentThreadName(Zstr("RTS Remote Poll"));
+            try
+            {
+                promSnapshot.set_value(getSnapshot(afsFolderPath, filter)); //throw FileError, ThreadStopRequest
+            }
+            catch (FileError&) { promSnapshot.set_exception(std::current_exception()); }
+        });
+    }
 
-            while (folderAvailable.wait_for(cbInterval) == std::future_status::timeout)
-                requestUiUpdate(folderPath); //throw X
+    static Snapshot getSnapshot(const AbstractPath& afsFolderPath, const fff::PathFilter& filter) //throw FileError, ThreadStopRequest
+    {
+        Snapshot snapshot;
+        std::vector<Zstring> pendingRelPaths{Zstring()};
 
-            if (folderAvailable.get())
-                availablePaths.insert(folderPath);
-            else
-                missingPathPhrases.insert(folderInfo.folderPathPhrase);
+        while (!pendingRelPaths.empty())
+        {
+            interruptionPoint(); //throw ThreadStopRequest
+
+            const Zstring folderRelPath = std::move(pendingRelPaths.back());
+            pendingRelPaths.pop_back();
+
+            AFS::traverseFolderFlat(AFS::appendRelPath(afsFolderPath, folderRelPath), //throw FileError
+            [&](const AFS::FileInfo& fi)
+            {
+                if (const Zstring& relPath = appendPath(folderRelPath, fi.itemName);
+                    filter.passFileFilter(relPath))
+                    snapshot.emplace(relPath, ItemState{AFS::ItemType::file, fi.fileSize, fi.modTime});
+            },
+            [&](const AFS::FolderInfo& fi)
+            {
+                const Zstring& relPath = appendPath(folderRelPath, fi.itemName);
+                bool childItemMightMatch = true;
+                if (filter.passDirFilter(relPath, &childItemMightMatch))
+                    snapshot.emplace(relPath, ItemState{AFS::ItemType::folder});
+                else if (!childItemMightMatch)
+                    return;
+
+                pendingRelPaths.push_back(relPath);
+            },
+            [&](const AFS::SymlinkInfo& si)
+            {
+                if (const Zstring& relPath = appendPath(folderRelPath, si.itemName);
+                    filter.passFileFilter(relPath))
+                    snapshot.emplace(relPath, ItemState{AFS::ItemType::symlink, 0, si.modTime});
+            });
         }
-        if (missingPathPhrases.empty())
-            return availablePaths; //only return when all folders were found on *first* try!
+        return snapshot;
+    }
 
+    const Zstring folderPath_;
+    const AbstractPath afsFolderPath_;
+    const fff::PathFilter& filter_;
+    const std::chrono::seconds pollInterval_;
 
-        auto delayUntil = std::chrono::steady_clock::now() + FOLDER_EXISTENCE_CHECK_INTERVAL;
+    std::optional<Snapshot> lastSnapshot_; //empty until baseline is available
+    std::future<Snapshot> nextSnapshot_;
+    std::chrono::steady_clock::time_point nextPollTime_;
+    InterruptibleThread worker_; //declare last: stop and join *before* other members are destroyed!
+};
 
-        for (const Zstring& folderPathPhrase : missingPathPhrases)
-            for (;;)
-            {
-                //support specifying volume by name => call getResolvedFilePath() repeatedly
-                const Zstring folderPath = getResolvedFilePath(folderPathPhrase);
 
-                //wait some time...
-                for (auto now = std::chrono::steady_clock::now(); now < delayUntil; now = std::chrono::steady_clock::now())
-                {
-                    requestUiUpdate(folderPath); //throw X
-                    std::this_thread::sleep_for(cbInterval);
-                }
+bool remoteFolderAvailable(const AbstractPath& afsFolderPath) //noexcept
+{
+    try
+    {
+        return AFS::getItemType(afsFolderPath) != AFS::ItemType::file; //throw FileError
+    }
+    catch (FileError&) { return false; }
+}
 
-                std::future<bool> folderAvailable = runAsync([folderPath]
-                {
-                    return dirAvailable(folderPath);
-                });
 
-                while (folderAvailable.wait_for(cbInterval) == std::future_status::timeout)
-                    requestUiUpdate(folderPath); //throw X
+bool isExcluded(const Zstring& itemPath, const Zstring& folderPath, const fff::PathFilter& filter)
+{
+    const Zstring& folderPathPf = appendSeparator(folderPath);
+    if (!startsWith(itemPath, folderPathPf))
+        return false;
+
+    //item type is unknown (e.g. already deleted) => exclude only if neither a file nor a folder (nor its children) would match
+    const Zstring relPath(itemPath.begin() + folderPathPf.size(), itemPath.end());
+    bool childItemMightMatch = true;
+    return !filter.passFileFilter(relPath) &&
+           !filter.passDirFilter(relPath, &childItemMightMatch) && !childItemMightMatch;
+}
+
 
-                if (folderAvailable.get())
-                    break;
-                //else: wait until folder is available: do not needlessly poll existing folders again!
-                delayUntil = std::chrono::steady_clock::now() + FOLDER_EXISTENCE_CHECK_INTERVAL;
+//merge changes per subtree: FreeFileSync's incremental comparison traverses a changed folder completely
+std::vector<Zstring> coalesceChanges(const std::set<Zstring, LessNativePath>& changedItemPaths, const std::set<Zstring, LessNativePath>& folderPaths)
+{
+    std::set<Zstring, LessNativePath> output;
+
+    std::map<Zstring, std::vector<Zstring>, LessNativePath> changesByParent;
+    for (const Zstring& itemPath : changedItemPaths)
+        changesByParent[beforeLast(itemPath, FILE_NAME_SEPARATOR, IfNotFoundReturn::none)].push_back(itemPath);
+
+    for (const auto& [parentPath, itemPaths] : changesByParent)
+        if (itemPaths.size() > CHANGED_CHILDREN_MAX && !folderPaths.contains(parentPath)) //changed base folder => full comparison: don't escalate
+            output.insert(parentPath);
+        else
+            output.insert(itemPaths.begin(), itemPaths.end());
+
+    //remove items contained in changed folders
+    std::vector<Zstring> minimalPaths;
+    for (const Zstring& itemPath : output)
+    {
+        bool parentChanged = false;
+        for (Zstring parentPath = beforeLast(itemPath, FILE_NAME_SEPARATOR, IfNotFoundReturn::none);
+             !parentPath.empty() && !folderPaths.contains(parentPath);
+             parentPath = beforeLast(parentPath, FILE_NAME_SEPARATOR, IfNotFoundReturn::none))
+            if (output.contains(parentPath))
+            {
+                parentChanged = true;
+                break;
             }
+
+        if (!parentChanged)
+            minimalPaths.push_back(itemPath);
     }
+    return minimalPaths;
 }
 
 
-//wait until changes are detected or if a directory is not available (anymore)
-DirWatcher::Change waitForChanges(const std::set<Zstring, LessNativePath>& folderPaths, //throw FileError
-                                  const std::function<void(bool readyForSync)>& requestUiUpdate, std::chrono::milliseconds cbInterval)
+//support specifying volume by name => call repeatedly
+Zstring getFolderPath(const Zstring& folderPathPhrase)
 {
-    assert(std::all_of(folderPaths.begin(), folderPaths.end(), [](const Zstring& folderPath) { return dirAvailable(folderPath); }));
-    if (folderPaths.empty()) //pathological case, but we have to check else this function will wait endlessly
-        throw FileError(_("A folder input field is empty.")); //should have been checked by caller!
+    if (isRemoteFolder(folderPathPhrase))
+        return utfTo<Zstring>(AFS::getDisplayPath(createAbstractPath(folderPathPhrase))); //don't show credentials!
+    return getResolvedFilePath(folderPathPhrase);
+}
 
-    std::vector<std::pair<Zstring, std::unique_ptr<DirWatcher>>> watches;
 
-    for (const Zstring& folderPath : folderPaths)
-        try
+std::future<bool> folderAvailableAsync(const Zstring& folderPathPhrase)
+{
+    //non-existent network path may block
+    if (isRemoteFolder(folderPathPhrase))
+        return runAsync([afsFolderPath = createAbstractPath(folderPathPhrase)] { return remoteFolderAvailable(afsFolderPath); });
+
+    return runAsync([folderPath = getResolvedFilePath(folderPathPhrase)] { return dirAvailable(folderPath); });
+}
+
+
+/*  monitor each folder independently: a missing folder must not hold back change detection for all the others
+    - available folders are watched right away
+    - missing folders are probed in the background with per-folder backoff and watched as soon as they (re-)appear
+    - changes while a folder was missing are unknown => its arrival is reported as ChangeType::baseFolderUnavailable    */
+class FolderMonitor
+{
+public:
+    FolderMonitor(const std::vector<Zstring>& folderPathPhrases, const fff::PathFilter& filter) : filter_(filter) //throw FileError
+    {
+        //early failure! check for unsupported folder paths:
+        for (const char* protoName : {"mtp"})
+            for (const Zstring& phrase : folderPathPhrases)
+                //hopefully clear enough now: https://freefilesync.org/forum/viewtopic.php?t=4302
+                if (startsWithAsciiNoCase(trimCpy(phrase), std::string(protoName) + ':'))
+                    throw FileError(replaceCpy(_("The %x protocol does not support directory monitoring:"), L"%x", utfTo<std::wstring>(protoName)) + L"\n\n" + fmtPath(phrase));
+
+        std::set<Zstring, LessNativePath> folderPaths;
+        for (const Zstring& phrase : folderPathPhrases)
+            if (const Zstring& folderPath = getFolderPath(phrase);
+                folderPaths.insert(folderPath).second)
+            {
+                Folder& folder = folders_.emplace_back();
+                folder.folderPathPhrase = phrase;
+                folder.folderPath = folderPath;
+                folder.probe = folderAvailableAsync(phrase); //start all folder checks asynchronously (non-existent network path may block)
+            }
+    }
+
+    //wait for the first existence check of all folders: the initial command execution covers the folders found
+    void waitForInitialCheck(const std::function<void()>& requestUiUpdate /*throw X*/, std::chrono::milliseconds cbInterval) //throw FileError, X
+    {
+        for (Folder& folder : folders_)
         {
-            watches.emplace_back(folderPath, std::make_unique<DirWatcher>(folderPath)); //throw FileError
+            while (folder.probe.wait_for(cbInterval) == std::future_status::timeout)
+                requestUiUpdate(); //throw X
+
+            evalProbe(folder); //throw FileError
         }
-        catch (FileError&)
+    }
+
+    //wait until changes are detected or a missing folder (re-)appears
+    std::vector<DirWatcher::Change> waitForChanges(const std::function<void(bool readyForSync)>& requestUiUpdate /*throw X*/, std::chrono::milliseconds cbInterval) //throw FileError, X
+    {
+        if (folders_.empty()) //pathological case, but we have to check else this function will wait endlessly
+            throw FileError(_("A folder input field is empty.")); //should have been checked by caller!
+
+        for (;;)
         {
-            if (!dirAvailable(folderPath)) //folder not existing or can't access
-                return {DirWatcher::ChangeType::baseFolderUnavailable, folderPath};
-            throw;
+            const bool checkDirNow = [&] //checking once per sec should suffice
+            {
+                const auto now = std::chrono::steady_clock::now();
+                if (now > lastCheckTime_ + FOLDER_EXISTENCE_CHECK_INTERVAL)
+                {
+                    lastCheckTime_ = now;
+                    return true;
+                }
+                return false;
+            }();
+
+            std::vector<DirWatcher::Change> changes;
+
+            for (Folder& folder : folders_)
+                if (folder.dirWatcher)
+                    fetchNativeChanges(folder, checkDirNow, changes, [&] { requestUiUpdate(false /*readyForSync*/); /*throw X*/ }, cbInterval); //throw FileError, X
+                else if (folder.remoteWatcher)
+                    fetchRemoteChanges(folder, changes); //throw FileError
+                else if (!folder.probe.valid())
+                {
+                    if (std::chrono::steady_clock::now() >= folder.nextProbeTime)
+                    {
+                        //support specifying volume by name => call getFolderPath() repeatedly
+                        folder.folderPath = getFolderPath(folder.folderPathPhrase);
+                        folder.probe = folderAvailableAsync(folder.folderPathPhrase);
+                    }
+                }
+                else if (isReady(folder.probe))
+                    if (evalProbe(folder)) //throw FileError
+                        changes.push_back({DirWatcher::ChangeType::baseFolderUnavailable, folder.folderPath});
+
+            if (!changes.empty())
+                return changes;
+
+            std::this_thread::sleep_for(cbInterval);
+            requestUiUpdate(true /*readyForSync*/); //throw X: may start sync at this presumably idle time
         }
+    }
 
-    auto lastCheckTime = std::chrono::steady_clock::now();
-    for (;;)
+    //new baseline: don't report the changes made by the command (e.g. FreeFileSync) as remote changes
+    void restartRemoteWatchers()
     {
-        const bool checkDirNow = [&] //checking once per sec should suffice
-        {
-            const auto now = std::chrono::steady_clock::now();
-            if (now > lastCheckTime + FOLDER_EXISTENCE_CHECK_INTERVAL)
+        for (Folder& folder : folders_)
+            if (folder.remoteWatcher)
             {
-                lastCheckTime = now;
-                return true;
+                folder.remoteWatcher.reset(); //stop polling *before* starting the next snapshot
+                folder.remoteWatcher = std::make_unique<RemoteWatcher>(folder.folderPath, createAbstractPath(folder.folderPathPhrase), filter_);
             }
-            return false;
-        }();
+    }
 
-        for (const auto& [folderPath, watcher] : watches)
-        {
-            //IMPORTANT CHECK: DirWatcher has problems detecting removal of top watched directories!
-            if (checkDirNow)
-                if (!dirAvailable(folderPath)) //catch errors related to directory removal, e.g. ERROR_NETNAME_DELETED
-                    return {DirWatcher::ChangeType::baseFolderUnavailable, folderPath};
-            try
-            {
-                std::vector<DirWatcher::Change> changes = watcher->fetchChanges([&] { requestUiUpdate(false /*readyForSync*/); /*throw X*/ },
-                                                                                cbInterval); //throw FileError
+    const Zstring* getMissingFolder() const //nullptr if all folders are watched
+    {
+        for (const Folder& folder : folders_)
+            if (!folder.dirWatcher && !folder.remoteWatcher)
+                return &folder.folderPath;
+        return nullptr;
+    }
+
+    bool isWatchingAny() const
+    {
+        return std::any_of(folders_.begin(), folders_.end(), [](const Folder& folder) { return folder.dirWatcher || folder.remoteWatcher; });
+    }
+
+    std::set<Zstring, LessNativePath> getFolderPaths() const
+    {
+        std::set<Zstring, LessNativePath> folderPaths;
+        for (const Folder& folder : folders_)
+            folderPaths.insert(folder.folderPath);
+        return folderPaths;
+    }
 
-                //give precedence to ChangeType::baseFolderUnavailable
-                for (const DirWatcher::Change& change : changes)
-                    if (change.type == DirWatcher::ChangeType::baseFolderUnavailable)
-                        return change;
+private:
+    FolderMonitor           (const FolderMonitor&) = delete;
+    FolderMonitor& operator=(const FolderMonitor&) = delete;
 
-                std::erase_if(changes, [](const DirWatcher::Change& e)
+    struct Folder
+    {
+        Zstring folderPathPhrase;
+        Zstring folderPath; //display path
+        //available:
+        std::unique_ptr<DirWatcher> dirWatcher;
+        std::unique_ptr<RemoteWatcher> remoteWatcher; //FTP/SFTP/Google Drive: no change notifications => polling
+        //missing:
+        std::future<bool> probe; //invalid if none in progress
+        std::chrono::steady_clock::time_point nextProbeTime;
+        std::chrono::seconds probeInterval = FOLDER_EXISTENCE_CHECK_INTERVAL;
+    };
+
+    //returns true if folder is available and now watched
+    bool evalProbe(Folder& folder) //throw FileError
+    {
+        if (folder.probe.get())
+        {
+            if (isRemoteFolder(folder.folderPathPhrase))
+                //first snapshot is the baseline for all changes until the next command execution
+                folder.remoteWatcher = std::make_unique<RemoteWatcher>(folder.folderPath, createAbstractPath(folder.folderPathPhrase), filter_);
+            else
+                try
                 {
-                    return
-                        endsWith(e.itemPath, Zstr(".ffs_tmp"))  || //sync.8ea2.ffs_tmp
-                        endsWith(e.itemPath, Zstr(".ffs_lock")) || //sync.ffs_lock, sync.Del.ffs_lock
-                        endsWith(e.itemPath, Zstr(".ffs_db"));     //sync.ffs_db
-                    //no need to ignore temporary recycle bin directory: this must be caused by a file deletion anyway
-                });
-
-                if (!changes.empty())
-                    return changes[0];
-            }
-            catch (FileError&)
+                    folder.dirWatcher = std::make_unique<DirWatcher>(folder.folderPath); //throw FileError
+                }
+                catch (FileError&)
+                {
+                    if (dirAvailable(folder.folderPath)) //else: folder gone again => keep probing
+                        throw;
+                }
+
+            if (folder.dirWatcher || folder.remoteWatcher)
             {
-                if (!dirAvailable(folderPath)) //a benign(?) race condition with FileError
-                    return {DirWatcher::ChangeType::baseFolderUnavailable, folderPath};
-                throw;
+                folder.probeInterval = FOLDER_EXISTENCE_CHECK_INTERVAL;
+                return true;
             }
         }
+        //else: wait until folder is available: do not needlessly poll existing folders again!
+        folder.nextProbeTime = std::chrono::steady_clock::now() + folder.probeInterval;
+        folder.probeInterval = std::min(folder.probeInterval * 2, MISSING_FOLDER_PROBE_INTERVAL_MAX);
+        return false;
+    }
 
-        std::this_thread::sleep_for(cbInterval);
-        requestUiUpdate(true /*readyForSync*/); //throw X: may start sync at this presumably idle time
+    static void setMissing(Folder& folder)
+    {
+        folder.dirWatcher   .reset();
+        folder.remoteWatcher.reset();
+        folder.nextProbeTime = std::chrono::steady_clock::now() + FOLDER_EXISTENCE_CHECK_INTERVAL;
+        folder.probeInterval = FOLDER_EXISTENCE_CHECK_INTERVAL;
     }
-}
+
+    void fetchNativeChanges(Folder& folder, bool checkDirNow, std::vector<DirWatcher::Change>& changes, //throw FileError, X
+                            const std::function<void()>& requestUiUpdate /*throw X*/, std::chrono::milliseconds cbInterval)
+    {
+        //IMPORTANT CHECK: DirWatcher has problems detecting removal of top watched directories!
+        if (checkDirNow)
+            if (!dirAvailable(folder.folderPath)) //catch errors related to directory removal, e.g. ERROR_NETNAME_DELETED
+                return setMissing(folder);
+        try
+        {
+            std::vector<DirWatcher::Change> folderChanges = folder.dirWatcher->fetchChanges(requestUiUpdate, cbInterval); //throw FileError, X
+
+            if (std::any_of(folderChanges.begin(), folderChanges.end(), [](const DirWatcher::Change& e) { return e.type == DirWatcher::ChangeType::baseFolderUnavailable; }))
+                return setMissing(folder);
+
+            for (DirWatcher::Change& change : folderChanges)
+                if (!isFfsTempItem(change.itemPath) &&
+                    !isExcluded(change.itemPath, folder.folderPath, filter_)) //excluded items don't delay or trigger the command
+                    changes.push_back(std::move(change));
+        }
+        catch (FileError&)
+        {
+            if (!dirAvailable(folder.folderPath)) //a benign(?) race condition with FileError
+                return setMissing(folder);
+            throw;
+        }
+    }
+
+    static void fetchRemoteChanges(Folder& folder, std::vector<DirWatcher::Change>& changes) //throw FileError
+    {
+        try
+        {
+            //excluded items are already skipped during traversal
+            for (DirWatcher::Change& change : folder.remoteWatcher->fetchChanges()) //throw FileError
+                if (!isFfsTempItem(change.itemPath))
+                    changes.push_back(std::move(change));
+        }
+        catch (FileError&)
+        {
+            //no need to check existence once per sec: a failed poll will tell
+            if (!remoteFolderAvailable(folder.remoteWatcher->getAfsFolderPath()))
+                return setMissing(folder);
+            throw;
+        }
+    }
+
+    static bool isFfsTempItem(const Zstring& itemPath)
+    {
+        return
+            endsWith(itemPath, Zstr(".ffs_tmp"))  || //sync.8ea2.ffs_tmp
+            endsWith(itemPath, Zstr(".ffs_lock")) || //sync.ffs_lock, sync.Del.ffs_lock
+            endsWith(itemPath, Zstr(".ffs_db"));     //sync.ffs_db
+        //no need to ignore temporary recycle bin directory: this must be caused by a file deletion anyway
+    }
+
+    const fff::PathFilter& filter_;
+    std::vector<Folder> folders_;
+    std::chrono::steady_clock::time_point lastCheckTime_ = std::chrono::steady_clock::now();
+};
 
 
 std::wstring getChangeTypeName(DirWatcher::ChangeType type)
@@ -199,8 +518,9 @@ struct ExecCommandNowException {};
 }
 
 
-void rts::monitorDirectories(const std::vector<Zstring>& folderPathPhrases, std::chrono::seconds delay,
-                             const std::function<void(const Zstring& itemPath, const std::wstring& actionName)>& executeExternalCommand /*throw FileError*/,
+void rts::monitorDirectories(const std::vector<Zstring>& folderPathPhrases, const fff::PathFilter& filter, std::chrono::seconds delay,
+                             const std::function<void(const Zstring& itemPath, const std::wstring& actionName,
+                                                      const std::vector<Zstring>& changedItemPaths)>& executeExternalCommand /*throw FileError*/,
                              const std::function<void(const Zstring* missingFolderPath)>& requestUiUpdate,
                              const std::function<void(const std::wstring& msg         )>& reportError,
                              std::chrono::milliseconds cbInterval)
@@ -212,11 +532,16 @@ void rts::monitorDirectories(const std::vector<Zstring>& folderPathPhrases, std:
     for (;;)
         try
         {
-            std::set<Zstring, LessNativePath> folderPaths = waitForMissingDirs(folderPathPhrases, [&](const Zstring& folderPath) { requestUiUpdate(&folderPath); }, cbInterval); //throw FileError
+            FolderMonitor monitor(folderPathPhrases, filter); //throw FileError
+            monitor.waitForInitialCheck([&] { requestUiUpdate(monitor.getMissingFolder()); }, cbInterval); //throw FileError
 
-            //schedule initial execution (*after* all directories have arrived)
+            //schedule initial execution (*after* the first existence check: missing folders are added as soon as they appear)
             auto nextExecTime = std::chrono::steady_clock::now() + delay;
 
+            //initial execution: changes unknown
+            bool changesComplete = false;
+            std::set<Zstring, LessNativePath> changedItemPaths;
+
             for (;;) //command executions
             {
                 DirWatcher::Change lastChangeDetected;
@@ -224,18 +549,33 @@ void rts::monitorDirectories(const std::vector<Zstring>& folderPathPhrases, std:
                 {
                     for (;;) //detected changes
                     {
-                        lastChangeDetected = waitForChanges(folderPaths, [&](bool readyForSync) //throw FileError, ExecCommandNowException
+                        const std::vector<DirWatcher::Change> changes = monitor.waitForChanges([&](bool readyForSync) //throw FileError, ExecCommandNowException
                         {
-                            requestUiUpdate(nullptr);
+                            requestUiUpdate(monitor.getMissingFolder());
 
-                            if (readyForSync && std::chrono::steady_clock::now() >= nextExecTime)
+                            if (readyForSync && std::chrono::steady_clock::now() >= nextExecTime &&
+                                monitor.isWatchingAny()) //don't execute the command before at least one folder is available!
                                 throw ExecCommandNowException(); //abort wait and start sync
                         }, cbInterval);
+                        assert(!changes.empty());
+                        lastChangeDetected = changes.back();
 
-                        if (lastChangeDetected.type == DirWatcher::ChangeType::baseFolderUnavailable)
-                            //don't execute the command before all directories are available!
-                            folderPaths = waitForMissingDirs(folderPathPhrases, [&](const Zstring& folderPath) { requestUiUpdate(&folderPath); }, cbInterval); //throw FileError
-
+                        for (const DirWatcher::Change& change : changes)
+                        {
+                            if (change.type == DirWatcher::ChangeType::baseFolderUnavailable) //folder (re-)appeared
+                                changesComplete = false; //no notifications while folder was missing
+
+                            if (changedItemPaths.size() <= CHANGED_ITEMS_MAX) //else: full comparison anyway
+                            {
+                                changedItemPaths.insert(change.itemPath);
+
+                                if (changedItemPaths.size() > CHANGED_ITEMS_MAX) //try to stay below limit
+                                {
+                                    const std::vector<Zstring>& minimalPaths = coalesceChanges(changedItemPaths, monitor.getFolderPaths());
+                                    changedItemPaths = {minimalPaths.begin(), minimalPaths.end()};
+                                }
+                            }
+                        }
                         nextExecTime = std::chrono::steady_clock::now() + delay;
                     }
                 }
@@ -243,10 +583,18 @@ void rts::monitorDirectories(const std::vector<Zstring>& folderPathPhrases, std:
 
                 try
                 {
-                    executeExternalCommand(lastChangeDetected.itemPath, getChangeTypeName(lastChangeDetected.type)); //throw FileError
+                    executeExternalCommand(lastChangeDetected.itemPath, getChangeTypeName(lastChangeDetected.type),
+                                           changesComplete && changedItemPaths.size() <= CHANGED_ITEMS_MAX ?
+                                           coalesceChanges(changedItemPaths, monitor.getFolderPaths()) : std::vector<Zstring>()); //throw FileError
                 }
                 catch (const FileError& e) { reportError(e.toString()); }
 
+                //all changes until here have been handled by the external command (or considered as such even if it failed)
+                changesComplete = true;
+                changedItemPaths.clear();
+
+                monitor.restartRemoteWatchers();
+
                 nextExecTime = std::chrono::steady_clock::time_point::max();
             }
         }
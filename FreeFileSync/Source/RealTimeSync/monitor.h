@@ -10,14 +10,18 @@
 #include <chrono>
 #include <functional>
 #include <zen/zstring.h>
+#include "../base/path_filter.h"
 
 
 namespace rts
 {
 void monitorDirectories(const std::vector<Zstring>& folderPathPhrases,
                         //non-formatted paths that yet require call to getFormattedDirectoryName(); empty directories must be checked by caller!
+                        //FTP/SFTP/Google Drive: no change notifications => folder snapshots are compared periodically
+                        const fff::PathFilter& filter, //relative to the monitored folders: changes of excluded items are ignored
                         std::chrono::seconds delay,
-                        const std::function<void(const Zstring& changedItemPath, const std::wstring& actionName)>& executeExternalCommand,
+                        const std::function<void(const Zstring& changedItemPath, const std::wstring& actionName,
+                                                 const std::vector<Zstring>& changedItemPaths /*minimal set of changed items and folders since last execution; empty if unknown*/)>& executeExternalCommand,
                         const std::function<void(const Zstring* missingFolderPath)>& requestUiUpdate, //either waiting for change notifications or at least one folder is missing
                         const std::function<void(const std::wstring& msg         )>& reportError, //automatically retries after return!
                         std::chrono::milliseconds cbInterval);
@@ -8,6 +8,9 @@
 #include <chrono>
 #include <zen/thread.h>
 #include <zen/resolve_path.h>
+#include <zen/file_io.h>
+#include <zen/guid.h>
+#include <zen/scope_guard.h>
 #include <wx/taskbar.h>
 #include <wx/icon.h> //Linux needs this
 #include <wx/app.h>
@@ -249,10 +252,24 @@ rts::AbortReason rts::runFolderMonitor(const XmlRealConfig& config, const wxStri
 
     TrayIconHolder trayIcon(jobname);
 
-    auto executeExternalCommand = [&](const Zstring& changedItemPath, const std::wstring& actionName) //throw FileError
+    auto executeExternalCommand = [&](const Zstring& changedItemPath, const std::wstring& actionName, const std::vector<Zstring>& changedItemPaths) //throw FileError
     {
         ::wxSetEnv(L"change_path", utfTo<wxString>(changedItemPath)); //crude way to report changed file
         ::wxSetEnv(L"change_action", actionName);                     //
+
+        //all changes since last execution, one path per line, e.g. for: FreeFileSync "job.ffs_batch" -ChangedPaths "%change_list%"
+        //empty file if changes are unknown (e.g. first execution) => FreeFileSync runs a full comparison
+        const Zstring changeListPath = appendPath(getTempFolderPath(), //throw FileError
+                                                  Zstr("RTS-") + utfTo<Zstring>(formatAsHexString(generateGUID())) + Zstr(".txt"));
+        std::string changeList;
+        for (const Zstring& itemPath : changedItemPaths)
+            changeList += utfTo<std::string>(itemPath) + '\n';
+
+        setFileContent(changeListPath, changeList, nullptr /*notifyUnbufferedIO*/); //throw FileError
+        ZEN_ON_SCOPE_EXIT(try { removeFilePlain(changeListPath); } catch (FileError&) {});
+
+        ::wxSetEnv(L"change_list", utfTo<wxString>(changeListPath));
+
         auto cmdLineExp = expandMacros(cmdLine);
 
         try
@@ -303,7 +320,7 @@ rts::AbortReason rts::runFolderMonitor(const XmlRealConfig& config, const wxStri
 
     try
     {
-        monitorDirectories(dirNamesNonFmt, std::chrono::seconds(config.delay),
+        monitorDirectories(dirNamesNonFmt, fff::NameFilter(config.includeFilter, config.excludeFilter), std::chrono::seconds(config.delay),
                            executeExternalCommand /*throw FileError*/,
                            requestUiUpdate, //throw AbortMonitoring
                            reportError,     //
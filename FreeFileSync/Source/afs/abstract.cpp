@@ -8,7 +8,10 @@
 #include <zen/serialize.h>
 #include <zen/guid.h>
 #include <zen/crc.h>
+#include <zen/thread.h>
+#include <zen/stream_buffer.h>
 #include <typeindex>
+#include <condition_variable>
 
 using namespace zen;
 using namespace fff;
@@ -66,9 +69,9 @@ struct FlatTraverserCallback : public AFS::TraverserCallback
         onSymlink_(onSymlink) {}
 
 private:
-    void                               onFile   (const AFS::FileInfo&    fi) override { if (onFile_)    onFile_   (fi); }
-    std::shared_ptr<TraverserCallback> onFolder (const AFS::FolderInfo&  fi) override { if (onFolder_)  onFolder_ (fi); return nullptr; }
-    HandleLink                         onSymlink(const AFS::SymlinkInfo& si) override { if (onSymlink_) onSymlink_(si); return TraverserCallback::HandleLink::skip; }
+    void                               onFile   (AFS::FileInfo&&    fi) override { if (onFile_)    onFile_   (fi); }
+    std::shared_ptr<TraverserCallback> onFolder (AFS::FolderInfo&&  fi) override { if (onFolder_)  onFolder_ (fi); return nullptr; }
+    HandleLink                         onSymlink(AFS::SymlinkInfo&& si) override { if (onSymlink_) onSymlink_(si); return TraverserCallback::HandleLink::skip; }
 
     HandleError reportDirError (const ErrorInfo& errorInfo)                          override { throw FileError(errorInfo.msg); }
     HandleError reportItemError(const ErrorInfo& errorInfo, const Zstring& itemName) override { throw FileError(errorInfo.msg); }
@@ -90,17 +93,79 @@ void AFS::traverseFolderFlat(const AfsPath& afsPath, //throw FileError
 }
 
 
+std::unique_ptr<AFS::InputStream> AFS::getInputStreamAt(const AfsPath& afsPath, uint64_t offset, const IoCallback& notifyUnbufferedIO /*throw X*/) const //throw FileError, ErrorFileLocked
+{
+    throw std::logic_error("Contract violation! " + std::string(__FILE__) + ':' + numberTo<std::string>(__LINE__)); //see getSegmentedCopyStreams()
+}
+
+
+std::unique_ptr<AFS::OutputStreamImpl> AFS::getOutputStreamAt(const AfsPath& afsPath, uint64_t offset, std::optional<time_t> modTime, //throw FileError
+                                                              const IoCallback& notifyUnbufferedIO /*throw X*/) const
+{
+    throw std::logic_error("Contract violation! " + std::string(__FILE__) + ':' + numberTo<std::string>(__LINE__)); //see getSegmentedCopyStreams()
+}
+
+
+std::vector<AFS::FileCopyResult> AFS::uploadFileBatch(const AfsPath& targetFolder, const std::vector<BatchUploadItem>& items, //throw FileError, ErrorFileLocked, X
+                                                      const IoCallback& notifyUnbufferedIO /*throw X*/) const
+{
+    throw std::logic_error("Contract violation! " + std::string(__FILE__) + ':' + numberTo<std::string>(__LINE__)); //see getBatchUploadFileCountMax()
+}
+
+
+namespace
+{
+/*  segmented copy: split large files into ranges that are copied concurrently, each over a separate connection
+    => work around per-connection throttling of servers, e.g. SFTP: one session per thread (see SftpSessionManager)
+    - segment 0 is copied by the caller's stream pair which also creates the target file and sets its modification time
+    - remaining segments write into the already existing target file on worker threads      */
+const uint64_t SEGMENTED_COPY_SEGMENT_SIZE_MIN = 32 * 1024 * 1024;
+
+/*  overlapped copy: read source on a worker thread into a ring buffer, while this thread writes the target
+    => cross-backend copies (e.g. SFTP -> Google Drive) approach the bandwidth of the slower side instead of being bound by the sum of both latencies  */
+const uint64_t OVERLAPPED_COPY_SIZE_MIN = 1024 * 1024; //small files: not worth a thread
+const size_t OVERLAPPED_COPY_BUFFER_BLOCKS = 4; //unit: streamIn block size
+
+
+template <class StreamOut>
+uint64_t copyStreamRange(AFS::InputStream& streamIn, StreamOut& streamOut, uint64_t bytesToCopy, const std::atomic<bool>& stopRequested, //throw FileError, ErrorFileLocked, X
+                         HashStream* hashStream /*optional*/, const std::wstring& sourceDisplayPath)
+{
+    std::vector<std::byte> buffer(streamIn.getBlockSize());
+    uint64_t bytesCopied = 0;
+    while (bytesCopied < bytesToCopy && !stopRequested)
+    {
+        const size_t bytesRead = streamIn.read(&buffer[0], static_cast<size_t>(std::min<uint64_t>(buffer.size(), bytesToCopy - bytesCopied))); //throw FileError, ErrorFileLocked, X
+        if (bytesRead == 0) //premature end of stream => caller checks
+            break;
+        if (hashStream)
+            try { hashStream->update(&buffer[0], bytesRead); /*throw SysError*/ }
+            catch (const SysError& e) { throw FileError(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(sourceDisplayPath)), e.toString()); }
+
+        streamOut.write(&buffer[0], bytesRead); //throw FileError, X
+        bytesCopied += bytesRead;
+    }
+    return bytesCopied;
+}
+}
+
+
 //already existing: undefined behavior! (e.g. fail/overwrite/auto-rename)
 AFS::FileCopyResult AFS::copyFileAsStream(const AfsPath& afsSource, const StreamAttributes& attrSource, //throw FileError, ErrorFileLocked, X
-                                          const AbstractPath& apTarget, const IoCallback& notifyUnbufferedIO /*throw X*/) const
+                                          const AbstractPath& apTarget, const IoCallback& notifyUnbufferedIO /*throw X*/,
+                                          std::optional<HashAlgorithm> sourceHashAlgo) const
 {
     int64_t totalUnbufferedIO = 0;
     IOCallbackDivider cbd(notifyUnbufferedIO, totalUnbufferedIO);
 
     int64_t totalBytesRead    = 0;
     int64_t totalBytesWritten = 0;
-    auto notifyUnbufferedRead  = [&](int64_t bytesDelta) { totalBytesRead    += bytesDelta; cbd(bytesDelta); };
-    auto notifyUnbufferedWrite = [&](int64_t bytesDelta) { totalBytesWritten += bytesDelta; cbd(bytesDelta); };
+    std::atomic<int64_t> segmentBytesRead   {0}; //segmented copy: I/O of worker threads is reported via the caller's thread
+    std::atomic<int64_t> segmentBytesWritten{0}; //
+    bool readOnWorkerThread = false; //overlapped copy: streamIn is read on a worker thread => report via segmentBytesRead
+    auto reportUnbufferedRead  = [&](int64_t bytesDelta) { bytesDelta += segmentBytesRead   .exchange(0); totalBytesRead    += bytesDelta; cbd(bytesDelta); };
+    auto notifyUnbufferedRead  = [&](int64_t bytesDelta) { if (readOnWorkerThread) segmentBytesRead += bytesDelta; else reportUnbufferedRead(bytesDelta); };
+    auto notifyUnbufferedWrite = [&](int64_t bytesDelta) { bytesDelta += segmentBytesWritten.exchange(0); totalBytesWritten += bytesDelta; cbd(bytesDelta); };
     //--------------------------------------------------------------------------------------------------------
 
     auto streamIn = getInputStream(afsSource, notifyUnbufferedRead); //throw FileError, ErrorFileLocked
@@ -113,10 +178,152 @@ AFS::FileCopyResult AFS::copyFileAsStream(const AfsPath& afsSource, const Stream
         attrSourceNew = attrSource; //SFTP/FTP
     //TODO: evaluate: consequences of stale attributes
 
+    const AbstractFileSystem& afsTarget = apTarget.afsDevice.ref();
+
+    std::optional<HashStream> hashStream;
+    if (sourceHashAlgo)
+        try { hashStream.emplace(*sourceHashAlgo); /*throw SysError*/ }
+        catch (const SysError& e) { throw FileError(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(getDisplayPath(afsSource))), e.toString()); }
+
+    size_t segmentCount = 1;
+    if (const size_t streamsSource = getSegmentedCopyStreams(),
+        /**/         streamsTarget = afsTarget.getSegmentedCopyStreams();
+        streamsSource > 0 && streamsTarget > 0 && //random access required on both sides
+        !hashStream) //hash requires sequential read
+        segmentCount = static_cast<size_t>(std::clamp<uint64_t>(attrSourceNew.fileSize / SEGMENTED_COPY_SEGMENT_SIZE_MIN, 1, std::max(streamsSource, streamsTarget)));
+
+    const uint64_t segmentSize = (attrSourceNew.fileSize + segmentCount - 1) / segmentCount;
+    assert(segmentCount == 1 || segmentSize * (segmentCount - 1) < attrSourceNew.fileSize);
+
     //already existing: undefined behavior! (e.g. fail/overwrite/auto-rename)
-    auto streamOut = getOutputStream(apTarget, attrSourceNew.fileSize, attrSourceNew.modTime, notifyUnbufferedWrite); //throw FileError
+    auto streamOut = std::make_unique<OutputStream>(afsTarget.getOutputStream(apTarget.afsPath, attrSourceNew.fileSize, attrSourceNew.modTime, notifyUnbufferedWrite), //throw FileError
+                                                    apTarget, segmentCount == 1 ? attrSourceNew.fileSize : segmentSize);
+
+    //overlapped copy: return false if worker thread creation failed
+    auto copyOverlapped = [&] //throw FileError, ErrorFileLocked, X
+    {
+        const size_t blockSize = streamIn->getBlockSize();
+        AsyncStreamBuffer asyncBuf(OVERLAPPED_COPY_BUFFER_BLOCKS * blockSize);
+
+        auto readSource = [&] //noexcept: errors are passed to this thread via asyncBuf
+        {
+            try
+            {
+                copyStreamRange(*streamIn, asyncBuf, std::numeric_limits<uint64_t>::max(), std::atomic<bool>(false), //throw FileError, ErrorFileLocked, <read error>
+                                hashStream ? &*hashStream : nullptr, getDisplayPath(afsSource));
+                asyncBuf.closeStream();
+            }
+            catch (...) { asyncBuf.setWriteError(std::current_exception()); }
+        };
 
-    bufferedStreamCopy(*streamIn, *streamOut); //throw FileError, ErrorFileLocked, X
+        std::future<void> readDone;
+        readOnWorkerThread = true; //set before thread creation => no data race
+        ZEN_ON_SCOPE_EXIT(readOnWorkerThread = false);
+        try
+        {
+            readDone = runAsync([readSource]
+            {
+                setCurrentThreadName(Zstr("Overlapped Copy"));
+                readSource();
+            });
+        }
+        catch (const std::system_error&) { return false; }
+
+        //worker thread accesses local variables => wait for it, even on failure:
+        ZEN_ON_SCOPE_EXIT(readDone.wait());
+        try
+        {
+            std::vector<std::byte> buffer(blockSize);
+            for (;;)
+            {
+                const size_t bytesRead = asyncBuf.read(&buffer[0], blockSize); //throw FileError, ErrorFileLocked; return "bytesToRead" bytes unless end of stream!
+                streamOut->write(&buffer[0], bytesRead); //throw FileError, X
+                reportUnbufferedRead(0); //throw X: report worker thread I/O
+
+                if (bytesRead != blockSize) //end of file
+                    break;
+            }
+        }
+        catch (...) { asyncBuf.setReadError(std::current_exception()); throw; } //unblock worker thread
+        return true;
+    };
+
+    if (segmentCount == 1)
+    {
+        if (attrSourceNew.fileSize >= OVERLAPPED_COPY_SIZE_MIN && copyOverlapped()) //throw FileError, ErrorFileLocked, X
+            reportUnbufferedRead(0); //throw X
+        else if (hashStream)
+            copyStreamRange(*streamIn, *streamOut, std::numeric_limits<uint64_t>::max(), std::atomic<bool>(false), &*hashStream, getDisplayPath(afsSource)); //throw FileError, ErrorFileLocked, X
+        else
+            bufferedStreamCopy(*streamIn, *streamOut); //throw FileError, ErrorFileLocked, X
+    }
+    else
+    {
+        std::atomic<bool> stopRequested{false};
+        std::vector<std::future<void>> segmentsDone;
+
+        //worker threads access local variables => wait for all of them, even on failure:
+        ZEN_ON_SCOPE_EXIT(for (std::future<void>& ft : segmentsDone) if (ft.valid()) ft.wait());
+        ZEN_ON_SCOPE_FAIL(stopRequested = true);
+
+        for (size_t i = 1; i < segmentCount; ++i)
+        {
+            const uint64_t offset = i * segmentSize;
+            const uint64_t bytesToCopy = std::min(segmentSize, attrSourceNew.fileSize - offset);
+
+            auto copySegment = [&, offset, bytesToCopy] //throw FileError, ErrorFileLocked
+            {
+                ZEN_ON_SCOPE_FAIL(stopRequested = true); //no need to continue the other segments
+
+                auto segmentIn  =           getInputStreamAt (afsSource,        offset, [&](int64_t bytesDelta) { segmentBytesRead    += bytesDelta; }); //throw FileError, ErrorFileLocked
+                auto segmentOut = afsTarget.getOutputStreamAt(apTarget.afsPath, offset, std::nullopt /*modTime*/, [&](int64_t bytesDelta) { segmentBytesWritten += bytesDelta; }); //throw FileError
+
+                const uint64_t bytesCopied = copyStreamRange(*segmentIn, *segmentOut, bytesToCopy, stopRequested, nullptr /*hashStream*/, {}); //throw FileError, ErrorFileLocked
+                if (stopRequested)
+                    return;
+
+                if (bytesCopied != bytesToCopy)
+                    throw FileError(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(getDisplayPath(afsSource))),
+                                    replaceCpy(replaceCpy(_("Unexpected size of data stream.\nExpected: %x bytes\nActual: %y bytes"),
+                                                          L"%x", formatNumber(offset + bytesToCopy)),
+                                               L"%y", formatNumber(offset + bytesCopied)));
+                segmentOut->finalize(); //throw FileError
+            };
+            try
+            {
+                segmentsDone.push_back(runAsync([copySegment, threadName = Zstr("Segmented Copy[") + numberTo<Zstring>(i) + Zstr('/') + numberTo<Zstring>(segmentCount) + Zstr(']')]
+                {
+                    setCurrentThreadName(threadName);
+                    copySegment(); //throw FileError, ErrorFileLocked
+                }));
+            }
+            catch (const std::system_error&) //thread creation failed: copy segment on this thread
+            {
+                std::packaged_task<void()> pt(copySegment);
+                segmentsDone.push_back(pt.get_future());
+                pt();
+            }
+        }
+
+        const uint64_t bytesCopied = copyStreamRange(*streamIn, *streamOut, segmentSize, stopRequested, nullptr /*hashStream*/, {}); //throw FileError, ErrorFileLocked, X
+
+        while (!waitForAllTimed(segmentsDone.begin(), segmentsDone.end(), std::chrono::milliseconds(100)))
+        {
+            notifyUnbufferedRead (0); //throw X: report worker thread I/O and allow cancellation
+            notifyUnbufferedWrite(0); //
+        }
+        for (std::future<void>& ft : segmentsDone)
+            ft.get(); //throw FileError, ErrorFileLocked: report first, likely the reason for stopRequested
+
+        notifyUnbufferedRead (0); //throw X
+        notifyUnbufferedWrite(0); //
+
+        if (bytesCopied != segmentSize)
+            throw FileError(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(getDisplayPath(afsSource))),
+                            replaceCpy(replaceCpy(_("Unexpected size of data stream.\nExpected: %x bytes\nActual: %y bytes"),
+                                                  L"%x", formatNumber(segmentSize)),
+                                       L"%y", formatNumber(bytesCopied)));
+    }
 
     //check incomplete input *before* failing with (slightly) misleading error message in OutputStream::finalize()
     if (totalBytesRead != makeSigned(attrSourceNew.fileSize))
@@ -142,6 +349,9 @@ AFS::FileCopyResult AFS::copyFileAsStream(const AfsPath& afsSource, const Stream
     cpResult.sourceFilePrint = attrSourceNew.filePrint;
     cpResult.targetFilePrint = finResult.filePrint;
     cpResult.errorModTime    = finResult.errorModTime;
+    if (hashStream)
+        try { cpResult.sourceHash = formatAsHexString(hashStream->finalize()); /*throw SysError*/ }
+        catch (const SysError& e) { throw FileError(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(getDisplayPath(afsSource))), e.toString()); }
     /* Failing to set modification time is not a serious problem from synchronization perspective (treat like external update)
             => Support additional scenarios:
             - GVFS failing to set modTime for FTP: https://freefilesync.org/forum/viewtopic.php?t=2372
@@ -152,20 +362,171 @@ AFS::FileCopyResult AFS::copyFileAsStream(const AfsPath& afsSource, const Stream
 }
 
 
+namespace
+{
+//resumable copy: continuing a partial file is only as good as its last block => re-verify before appending
+const uint64_t RESUMABLE_COPY_VERIFY_SIZE = 1024 * 1024;
+}
+
+
+//existing partial target: continue after the first "partialSize" bytes; keep it on failure
+AFS::FileCopyResult AFS::copyFileAsStreamResumable(const AfsPath& afsSource, const StreamAttributes& attrSource, //throw FileError, ErrorFileLocked, X
+                                                   const AbstractPath& apTarget, uint64_t partialSize, const IoCallback& notifyUnbufferedIO /*throw X*/,
+                                                   std::optional<HashAlgorithm> sourceHashAlgo) const
+{
+    const AbstractFileSystem& afsTarget = apTarget.afsDevice.ref();
+
+    auto readRange = [](InputStream& streamIn, uint64_t bytesToRead) //throw FileError, ErrorFileLocked, X
+    {
+        std::string buffer(bytesToRead, '\0');
+        size_t bytesRead = 0;
+        while (bytesRead < buffer.size())
+        {
+            const size_t bytesDelta = streamIn.read(&buffer[bytesRead], buffer.size() - bytesRead); //throw FileError, ErrorFileLocked, X
+            if (bytesDelta == 0) //end of stream
+                break;
+            bytesRead += bytesDelta;
+        }
+        buffer.resize(bytesRead);
+        return buffer;
+    };
+
+    uint64_t resumeOffset = std::min(partialSize, attrSource.fileSize);
+    if (resumeOffset > 0)
+        try
+        {
+            //connection drop while writing: last block might be incomplete or garbage
+            const uint64_t verifyOffset = resumeOffset - std::min(resumeOffset, RESUMABLE_COPY_VERIFY_SIZE);
+
+            auto verifyIn  =           getInputStreamAt(afsSource,        verifyOffset, nullptr /*notifyUnbufferedIO*/); //throw FileError, ErrorFileLocked
+            auto verifyTrg = afsTarget.getInputStreamAt(apTarget.afsPath, verifyOffset, nullptr /*notifyUnbufferedIO*/); //
+
+            //source changed since comparison? => partial file belongs to a different version
+            if (std::optional<StreamAttributes> attr = verifyIn->getAttributesBuffered()) //throw FileError
+                if (attr->fileSize != attrSource.fileSize || attr->modTime != attrSource.modTime)
+                    resumeOffset = 0;
+
+            if (resumeOffset > 0 &&
+                readRange(*verifyIn,  resumeOffset - verifyOffset) != //throw FileError, ErrorFileLocked
+                readRange(*verifyTrg, resumeOffset - verifyOffset))   //
+                resumeOffset = 0;
+        }
+        catch (FileError&) { resumeOffset = 0; } //e.g. partial file deleted in the meantime => start over
+
+    if (resumeOffset == 0 && partialSize > 0)
+        try { afsTarget.removeFilePlain(apTarget.afsPath); /*throw FileError*/ }
+        catch (FileError&) {} //not existing anymore? let getOutputStream() decide
+
+    std::optional<HashStream> hashStream;
+    if (sourceHashAlgo)
+        try { hashStream.emplace(*sourceHashAlgo); /*throw SysError*/ }
+        catch (const SysError& e) { throw FileError(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(getDisplayPath(afsSource))), e.toString()); }
+
+    bool keepPartial = false; //failure: don't run callbacks that could throw while saving the partial file
+
+    int64_t totalUnbufferedIO = 0;
+    IOCallbackDivider cbd(notifyUnbufferedIO, totalUnbufferedIO);
+    auto notifyIO = [&](int64_t bytesDelta) { if (!keepPartial) cbd(bytesDelta); }; //throw X
+
+    //hash requires the complete source: read (but don't copy) the part that's already there => not part of the progress
+    int64_t prefixBytesLeft = hashStream ? resumeOffset : 0;
+    auto notifyRead = [&](int64_t bytesDelta) //throw X
+    {
+        const int64_t prefixDelta = std::min(prefixBytesLeft, bytesDelta);
+        prefixBytesLeft -= prefixDelta;
+        notifyIO(bytesDelta - prefixDelta); //report zero bytes, too: allow cancellation
+    };
+    auto streamIn = hashStream ?
+                    getInputStream  (afsSource,               notifyRead) : //throw FileError, ErrorFileLocked
+                    getInputStreamAt(afsSource, resumeOffset, notifyRead);  //
+    if (hashStream)
+        for (uint64_t bytesHashed = 0; bytesHashed < resumeOffset;)
+        {
+            const std::string buffer = readRange(*streamIn, std::min<uint64_t>(resumeOffset - bytesHashed, streamIn->getBlockSize() * 8)); //throw FileError, ErrorFileLocked, X
+            if (buffer.empty())
+                throw FileError(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(getDisplayPath(afsSource))), L"Unexpected end of file.");
+            try { hashStream->update(buffer.data(), buffer.size()); /*throw SysError*/ }
+            catch (const SysError& e) { throw FileError(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(getDisplayPath(afsSource))), e.toString()); }
+            bytesHashed += buffer.size();
+        }
+
+    std::unique_ptr<OutputStreamImpl> streamOut = resumeOffset == 0 ?
+                                                  afsTarget.getOutputStream  (apTarget.afsPath, attrSource.fileSize, attrSource.modTime, notifyIO) : //throw FileError
+                                                  afsTarget.getOutputStreamAt(apTarget.afsPath, resumeOffset, attrSource.modTime, notifyIO);          //
+    //failure: save what was written so far => next run continues from here (finalize() also sets modTime => doesn't matter for a temp file)
+    ZEN_ON_SCOPE_FAIL(if (streamOut)
+    {
+        keepPartial = true;
+        try { streamOut->finalize(); /*throw FileError*/ }
+        catch (FileError&) {}
+    });
+
+    const uint64_t bytesCopied = copyStreamRange(*streamIn, *streamOut, attrSource.fileSize - resumeOffset, std::atomic<bool>(false), //throw FileError, ErrorFileLocked, X
+                                                 hashStream ? &*hashStream : nullptr, getDisplayPath(afsSource));
+    if (resumeOffset + bytesCopied != attrSource.fileSize || !readRange(*streamIn, 1).empty()) //throw FileError, ErrorFileLocked, X
+        throw FileError(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(getDisplayPath(afsSource))),
+                        replaceCpy(replaceCpy(_("Unexpected size of data stream.\nExpected: %x bytes\nActual: %y bytes"),
+                                              L"%x", formatNumber(attrSource.fileSize)),
+                                   L"%y", formatNumber(resumeOffset + bytesCopied)));
+
+    const FinalizeResult finResult = streamOut->finalize(); //throw FileError, X
+    streamOut.reset(); //finalized => nothing left to save
+
+    FileCopyResult cpResult;
+    cpResult.fileSize        = attrSource.fileSize;
+    cpResult.modTime         = attrSource.modTime;
+    cpResult.sourceFilePrint = attrSource.filePrint;
+    cpResult.targetFilePrint = finResult.filePrint;
+    cpResult.errorModTime    = finResult.errorModTime;
+    if (hashStream)
+        try { cpResult.sourceHash = formatAsHexString(hashStream->finalize()); /*throw SysError*/ }
+        catch (const SysError& e) { throw FileError(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(getDisplayPath(afsSource))), e.toString()); }
+    return cpResult;
+}
+
+
+namespace
+{
+Zstring getTempFileName(const Zstring& fileName, const Zstring& tag)
+{
+    Zstring tmpName = beforeLast(fileName, Zstr('.'), IfNotFoundReturn::all);
+
+    //don't make the temp name longer than the original when hitting file system name length limitations: "lpMaximumComponentLength is commonly 255 characters"
+    while (tmpName.size() > 200) //BUT don't trim short names! we want early failure on filename-related issues
+        tmpName = getUnicodeSubstring(tmpName, 0 /*uniPosFirst*/, unicodeLength(tmpName) / 2 /*uniPosLast*/); //consider UTF encoding when cutting in the middle! (e.g. for macOS)
+
+    return tmpName + Zstr('~') + tag + AFS::TEMP_FILE_ENDING;
+}
+}
+
+
+Zstring AFS::getResumableTempFileName(const Zstring& fileName, const StreamAttributes& attrSource)
+{
+    //8 hex digits: can't clash with the 4-digit random names of non-resumable copies
+    const std::string sourceId = numberTo<std::string>(attrSource.fileSize)  + '|' +
+                                 numberTo<std::string>(attrSource.modTime)   + '|' +
+                                 numberTo<std::string>(attrSource.filePrint) + '|' + utfTo<std::string>(fileName);
+    return getTempFileName(fileName, printNumber<Zstring>(Zstr("%08x"), static_cast<unsigned int>(getCrc32(sourceId))));
+}
+
+
 //already existing + no onDeleteTargetFile: undefined behavior! (e.g. fail/overwrite/auto-rename)
 AFS::FileCopyResult AFS::copyFileTransactional(const AbstractPath& apSource, const StreamAttributes& attrSource, //throw FileError, ErrorFileLocked, X
                                                const AbstractPath& apTarget,
                                                bool copyFilePermissions,
                                                bool transactionalCopy,
+                                               bool deltaCopy,
+                                               std::optional<uint64_t> resumableCopy,
                                                const std::function<void()>& onDeleteTargetFile,
-                                               const IoCallback& notifyUnbufferedIO /*throw X*/)
+                                               const IoCallback& notifyUnbufferedIO /*throw X*/,
+                                               std::optional<HashAlgorithm> sourceHashAlgo)
 {
     auto copyFilePlain = [&](const AbstractPath& apTargetTmp)
     {
         //caveat: typeid returns static type for pointers, dynamic type for references!!!
         if (typeid(apSource.afsDevice.ref()) == typeid(apTargetTmp.afsDevice.ref()))
             return apSource.afsDevice.ref().copyFileForSameAfsType(apSource.afsPath, attrSource,
-                                                                   apTargetTmp, copyFilePermissions, notifyUnbufferedIO); //throw FileError, ErrorFileLocked, X
+                                                                   apTargetTmp, copyFilePermissions, notifyUnbufferedIO, sourceHashAlgo); //throw FileError, ErrorFileLocked, X
         //already existing: undefined behavior! (e.g. fail/overwrite/auto-rename)
 
         //fall back to stream-based file copy:
@@ -174,7 +535,7 @@ AFS::FileCopyResult AFS::copyFileTransactional(const AbstractPath& apSource, con
                             _("Operation not supported between different devices."));
 
         //already existing: undefined behavior! (e.g. fail/overwrite/auto-rename)
-        return apSource.afsDevice.ref().copyFileAsStream(apSource.afsPath, attrSource, apTargetTmp, notifyUnbufferedIO); //throw FileError, ErrorFileLocked, X
+        return apSource.afsDevice.ref().copyFileAsStream(apSource.afsPath, attrSource, apTargetTmp, notifyUnbufferedIO, sourceHashAlgo); //throw FileError, ErrorFileLocked, X
     };
 
     if (transactionalCopy && !hasNativeTransactionalCopy(apTarget))
@@ -184,20 +545,39 @@ AFS::FileCopyResult AFS::copyFileTransactional(const AbstractPath& apSource, con
             throw FileError(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(getDisplayPath(apTarget))), L"Path is device root.");
         const Zstring fileName = getItemName(apTarget);
 
+        //resumable copy: needs random access on both sides; permissions are not supported by stream-based copy
+        const bool resumable = resumableCopy && !copyFilePermissions &&
+                               apSource.afsDevice.ref().getSegmentedCopyStreams() > 0 &&
+                               apTarget.afsDevice.ref().getSegmentedCopyStreams() > 0 &&
+                               !(typeid(apSource.afsDevice.ref()) == typeid(apTarget.afsDevice.ref()) &&
+                                 apSource.afsDevice.ref().hasServerSideCopy(apTarget)); //no data transfer => nothing to resume
+
+        //no temp file at all: nothing to rename, no remnant ffs_tmp files after a crash (expensive directory operations on NFS, overlayfs)
+        if (!resumable && !deltaCopy && typeid(apSource.afsDevice.ref()) == typeid(apTarget.afsDevice.ref()))
+            if (std::optional<FileCopyResult> anonResult = apSource.afsDevice.ref().copyFileAnonymousForSameAfsType(apSource.afsPath, attrSource, //throw FileError, ErrorFileLocked, X
+                                                             apTarget, copyFilePermissions, onDeleteTargetFile, notifyUnbufferedIO, sourceHashAlgo))
+                return std::move(*anonResult);
+
         //- generate (hopefully) unique file name to avoid clashing with some remnant ffs_tmp file
         //- do not loop: avoid pathological cases, e.g. https://freefilesync.org/forum/viewtopic.php?t=1592
-        Zstring tmpName = beforeLast(fileName, Zstr('.'), IfNotFoundReturn::all);
-
-        //don't make the temp name longer than the original when hitting file system name length limitations: "lpMaximumComponentLength is commonly 255 characters"
-        while (tmpName.size() > 200) //BUT don't trim short names! we want early failure on filename-related issues
-            tmpName = getUnicodeSubstring(tmpName, 0 /*uniPosFirst*/, unicodeLength(tmpName) / 2 /*uniPosLast*/); //consider UTF encoding when cutting in the middle! (e.g. for macOS)
+        const AbstractPath apTargetTmp = appendRelPath(*parentPath, resumable ? getResumableTempFileName(fileName, attrSource) :
+                                                       getTempFileName(fileName, printNumber<Zstring>(Zstr("%04x"), static_cast<unsigned int>(getCrc16(generateGUID())))));
+        //-------------------------------------------------------------------------------------------
 
-        const Zstring& shortGuid = printNumber<Zstring>(Zstr("%04x"), static_cast<unsigned int>(getCrc16(generateGUID())));
+        const FileCopyResult result = [&]
+        {
+            if (resumable)
+                return apSource.afsDevice.ref().copyFileAsStreamResumable(apSource.afsPath, attrSource, //throw FileError, ErrorFileLocked, X
+                                                                          apTargetTmp, *resumableCopy, notifyUnbufferedIO, sourceHashAlgo);
 
-        const AbstractPath apTargetTmp = appendRelPath(*parentPath, tmpName + Zstr('~') + shortGuid + TEMP_FILE_ENDING);
-        //-------------------------------------------------------------------------------------------
+            //delta copy: the existing target is still in place at this point => use as base for the temp file
+            if (deltaCopy && typeid(apSource.afsDevice.ref()) == typeid(apTarget.afsDevice.ref()))
+                if (std::optional<FileCopyResult> deltaResult = apSource.afsDevice.ref().copyFileDeltaForSameAfsType(apSource.afsPath, attrSource, //throw FileError, ErrorFileLocked, X
+                                                                 apTargetTmp, apTarget.afsPath, copyFilePermissions, notifyUnbufferedIO, sourceHashAlgo))
+                    return std::move(*deltaResult);
 
-        const FileCopyResult result = copyFilePlain(apTargetTmp); //throw FileError, ErrorFileLocked
+            return copyFilePlain(apTargetTmp); //throw FileError, ErrorFileLocked
+        }();
 
         //transactional behavior: ensure cleanup; not needed before copyFilePlain() which is already transactional
         ZEN_ON_SCOPE_FAIL( try { removeFilePlain(apTargetTmp); }
@@ -307,67 +687,137 @@ std::optional<AFS::ItemType> AFS::itemStillExists(const AfsPath& afsPath) const
 }
 
 
-//default implementation: folder traversal
-void AFS::removeFolderIfExistsRecursion(const AfsPath& afsPath, //throw FileError
-                                        const std::function<void (const std::wstring& displayPath)>& onBeforeFileDeletion /*throw X*/, //optional
-                                        const std::function<void (const std::wstring& displayPath)>& onBeforeFolderDeletion) const //one call for each object!
+void AFS::removeFolderTreePipelined(const AfsPath& afsPath, //throw FileError, X
+                                    const std::function<void (const std::wstring& displayPath)>& onBeforeFileDeletion /*throw X*/, //optional
+                                    const std::function<void (const std::wstring& displayPath)>& onBeforeFolderDeletion /*throw X*/, //one call for each object!
+                                    size_t parallelOps) const
 {
-    //deferred recursion => save stack space and allow deletion of extremely deep hierarchies!
-    std::function<void(const AfsPath& folderPath)> removeFolderRecursionImpl;
-    removeFolderRecursionImpl = [this, &onBeforeFileDeletion, &onBeforeFolderDeletion, &removeFolderRecursionImpl](const AfsPath& folderPath) //throw FileError
+    //no error situation if directory is not existing! manual deletion relies on it!
+    const std::optional<ItemType> type = itemStillExists(afsPath); //throw FileError
+    if (!type) //even if the folder did not exist anymore, significant I/O work was done => report
     {
-        std::vector<Zstring> fileNames;
-        std::vector<Zstring> folderNames;
-        std::vector<Zstring> symlinkNames;
+        if (onBeforeFolderDeletion) onBeforeFolderDeletion(getDisplayPath(afsPath)); //throw X
+        return;
+    }
+    if (*type == ItemType::symlink)
+    {
+        if (onBeforeFileDeletion)
+            onBeforeFileDeletion(getDisplayPath(afsPath)); //throw X
 
-        traverseFolderFlat(folderPath, //throw FileError
-        [&](const    FileInfo& fi) {    fileNames.push_back(fi.itemName); },
-        [&](const  FolderInfo& fi) {  folderNames.push_back(fi.itemName); },
-        [&](const SymlinkInfo& si) { symlinkNames.push_back(si.itemName); });
+        removeSymlinkPlain(afsPath); //throw FileError
+        return;
+    }
+    //--------------------------------------------------------------------------------------------------------------
 
-        for (const Zstring& fileName : fileNames)
-        {
-            const AfsPath filePath(appendPath(folderPath.value, fileName));
-            if (onBeforeFileDeletion)
-                onBeforeFileDeletion(getDisplayPath(filePath)); //throw X
+    /*  - traversal and callbacks on calling thread: callbacks may require the caller's thread context (e.g. AsyncCallback::updateStatus())
+        - deletion of files/symlinks overlaps with traversal of the next folder: one request per item (unlink(), SFTP/FTP command)
+        - folders are deleted bottom-up after all of their content is gone: deepest level first, parallel within the same level
+        - bounded queue: memory stays constant for huge folder trees; first error => stop queueing, skip pending deletions  */
+    std::mutex lockStatus;
+    std::condition_variable conditionItemDone;
+    size_t itemsPending = 0;
+    std::optional<FileError> firstError;
 
-            removeFilePlain(filePath); //throw FileError
+    ThreadGroup<std::function<void()>> tg(std::max<size_t>(parallelOps, 1), Zstr("Remove Folder")); //threads are created on demand only
+    //declare *after* shared state: ~ThreadGroup() must join before lockStatus/conditionItemDone go out of scope!
+
+    const size_t queueSizeMax = 2 * std::max<size_t>(parallelOps, 1); //keep helper threads busy while traversal is waiting for the next folder listing
+
+    auto removeItemAsync = [&](std::function<void()>&& removeItem /*throw FileError*/) //throw FileError
+    {
+        {
+            std::unique_lock dummy(lockStatus);
+            conditionItemDone.wait(dummy, [&] { return firstError || itemsPending < queueSizeMax; });
+            if (firstError)
+                throw* firstError;
+            ++itemsPending;
         }
+        tg.run([&, removeItem = std::move(removeItem)]
+        {
+            std::optional<FileError> error;
+            try
+            {
+                bool skip = false;
+                {
+                    std::lock_guard dummy(lockStatus);
+                    skip = static_cast<bool>(firstError);
+                }
+                if (!skip)
+                    removeItem(); //throw FileError
+            }
+            catch (const FileError& e) { error = e; }
 
-        for (const Zstring& symlinkName : symlinkNames)
+            {
+                std::lock_guard dummy(lockStatus);
+                if (error && !firstError)
+                    firstError = std::move(error);
+                --itemsPending;
+            }
+            conditionItemDone.notify_all();
+        });
+    };
+
+    auto waitUntilAllRemoved = [&] //throw FileError
+    {
+        std::unique_lock dummy(lockStatus);
+        conditionItemDone.wait(dummy, [&] { return itemsPending == 0; });
+        if (firstError)
+            throw* firstError;
+    };
+
+    //breadth-first => no recursion: save stack space and allow deletion of extremely deep hierarchies!
+    std::vector<std::vector<AfsPath>> foldersByDepth{{afsPath}};
+
+    for (size_t depth = 0; depth < foldersByDepth.size(); ++depth)
+    {
+        if (depth + 1 == foldersByDepth.size())
+            foldersByDepth.emplace_back(); //reallocate *before* taking references below
+
+        const std::vector<AfsPath>& folders = foldersByDepth[depth];
+        std::vector<AfsPath>& subFolders    = foldersByDepth[depth + 1];
+
+        for (const AfsPath& folderPath : folders)
         {
-            const AfsPath linkPath(appendPath(folderPath.value, symlinkName));
-            if (onBeforeFileDeletion)
-                onBeforeFileDeletion(getDisplayPath(linkPath)); //throw X
+            std::vector<AfsPath> filePaths;
+            std::vector<AfsPath> symlinkPaths;
 
-            removeSymlinkPlain(linkPath); //throw FileError
-        }
+            traverseFolderFlat(folderPath, //throw FileError
+            [&](const    FileInfo& fi) {    filePaths.emplace_back(appendPath(folderPath.value, fi.itemName)); },
+            [&](const  FolderInfo& fi) {   subFolders.emplace_back(appendPath(folderPath.value, fi.itemName)); },
+            [&](const SymlinkInfo& si) { symlinkPaths.emplace_back(appendPath(folderPath.value, si.itemName)); });
 
-        for (const Zstring& folderName : folderNames)
-            removeFolderRecursionImpl(AfsPath(appendPath(folderPath.value, folderName))); //throw FileError
+            for (const AfsPath& filePath : filePaths)
+            {
+                if (onBeforeFileDeletion)
+                    onBeforeFileDeletion(getDisplayPath(filePath)); //throw X
 
-        if (onBeforeFolderDeletion)
-            onBeforeFolderDeletion(getDisplayPath(folderPath)); //throw X
+                removeItemAsync([this, filePath] { removeFilePlain(filePath); /*throw FileError*/ }); //throw FileError
+            }
 
-        removeFolderPlain(folderPath); //throw FileError
-    };
-    //--------------------------------------------------------------------------------------------------------------
+            for (const AfsPath& linkPath : symlinkPaths)
+            {
+                if (onBeforeFileDeletion)
+                    onBeforeFileDeletion(getDisplayPath(linkPath)); //throw X
 
-    //no error situation if directory is not existing! manual deletion relies on it!
-    if (std::optional<ItemType> type = itemStillExists(afsPath)) //throw FileError
+                removeItemAsync([this, linkPath] { removeSymlinkPlain(linkPath); /*throw FileError*/ }); //throw FileError
+            }
+        }
+        if (subFolders.empty())
+            foldersByDepth.pop_back();
+    }
+    waitUntilAllRemoved(); //throw FileError
+
+    for (auto it = foldersByDepth.rbegin(); it != foldersByDepth.rend(); ++it)
     {
-        if (*type == ItemType::symlink)
+        for (const AfsPath& folderPath : *it)
         {
-            if (onBeforeFileDeletion)
-                onBeforeFileDeletion(getDisplayPath(afsPath)); //throw X
+            if (onBeforeFolderDeletion)
+                onBeforeFolderDeletion(getDisplayPath(folderPath)); //throw X
 
-            removeSymlinkPlain(afsPath); //throw FileError
+            removeItemAsync([this, folderPath] { removeFolderPlain(folderPath); /*throw FileError*/ }); //throw FileError
         }
-        else
-            removeFolderRecursionImpl(afsPath); //throw FileError
+        waitUntilAllRemoved(); //throw FileError: parent folders only after all child folders are gone
     }
-    else //even if the folder did not exist anymore, significant I/O work was done => report
-        if (onBeforeFolderDeletion) onBeforeFolderDeletion(getDisplayPath(afsPath)); //throw X
 }
 
 
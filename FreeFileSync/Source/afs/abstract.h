@@ -12,6 +12,7 @@
 #include <zen/file_error.h>
 #include <zen/file_path.h>
 #include <zen/serialize.h> //InputStream/OutputStream support buffered stream concept
+#include <zen/open_ssl.h> //HashAlgorithm
 #include <wx+/image_holder.h> //NOT a wxWidgets dependency!
 
 
@@ -74,6 +75,9 @@ struct AbstractFileSystem //THREAD-SAFETY: "const" member functions must model t
     static void authenticateAccess(const AfsDevice& afsDevice, bool allowUserInteraction) //throw FileError
     { return afsDevice.ref().authenticateAccess(allowUserInteraction); }
 
+    static void prewarmConnections(const AfsDevice& afsDevice, size_t parallelOps) //throw FileError
+    { return afsDevice.ref().prewarmConnections(parallelOps); }
+
     static int getAccessTimeout(const AbstractPath& ap) { return ap.afsDevice.ref().getAccessTimeout(); } //returns "0" if no timeout in force
 
     static bool supportPermissionCopy(const AbstractPath& apSource, const AbstractPath& apTarget); //throw FileError
@@ -121,7 +125,7 @@ struct AbstractFileSystem //THREAD-SAFETY: "const" member functions must model t
     static void removeSymlinkPlain(const AbstractPath& ap) { ap.afsDevice.ref().removeSymlinkPlain(ap.afsPath); } //throw FileError
     static void removeFolderPlain (const AbstractPath& ap) { ap.afsDevice.ref().removeFolderPlain (ap.afsPath); } //
     //----------------------------------------------------------------------------------------------------------------
-    //static void setModTime(const AbstractPath& ap, time_t modTime) { ap.afsDevice.ref().setModTime(ap.afsPath, modTime); } //throw FileError, follows symlinks
+    static void setModTime(const AbstractPath& ap, time_t modTime) { ap.afsDevice.ref().setModTime(ap.afsPath, modTime); } //throw FileError, follows symlinks
 
     static AbstractPath getSymlinkResolvedPath(const AbstractPath& ap) { return ap.afsDevice.ref().getSymlinkResolvedPath (ap.afsPath); } //throw FileError
     static bool equalSymlinkContent(const AbstractPath& apLhs, const AbstractPath& apRhs); //throw FileError
@@ -187,6 +191,14 @@ struct AbstractFileSystem //THREAD-SAFETY: "const" member functions must model t
     { return std::make_unique<OutputStream>(ap.afsDevice.ref().getOutputStream(ap.afsPath, streamSize, modTime, notifyUnbufferedIO), ap, streamSize); }
     //----------------------------------------------------------------------------------------------------------------
 
+    //optional: file hash calculated by the server => compare file content without transferring it (e.g. SFTP, FTP)
+    //algorithms in order of preference; may be empty
+    static std::vector<zen::HashAlgorithm> getServerHashAlgorithms(const AbstractPath& ap) { return ap.afsDevice.ref().getServerHashAlgorithms(); }
+
+    //returns hex string; none: not available for this file => fall back to reading the file (which also reports errors)
+    static std::optional<std::string> getServerFileHash(const AbstractPath& ap, zen::HashAlgorithm algo) { return ap.afsDevice.ref().getServerFileHash(ap.afsPath, algo); }
+    //----------------------------------------------------------------------------------------------------------------
+
     struct SymlinkInfo
     {
         Zstring itemName;
@@ -224,10 +236,11 @@ struct AbstractFileSystem //THREAD-SAFETY: "const" member functions must model t
             ignore
         };
 
-        virtual void                               onFile   (const FileInfo&    fi) = 0; //
-        virtual HandleLink                         onSymlink(const SymlinkInfo& si) = 0; //throw X
-        virtual std::shared_ptr<TraverserCallback> onFolder (const FolderInfo&  fi) = 0; //
+        virtual void                               onFile   (FileInfo&&    fi) = 0; //
+        virtual HandleLink                         onSymlink(SymlinkInfo&& si) = 0; //throw X
+        virtual std::shared_ptr<TraverserCallback> onFolder (FolderInfo&&  fi) = 0; //
         //nullptr: ignore directory, non-nullptr: traverse into, using the (new) callback
+        //item name is handed over: callback may take ownership instead of copying
 
         struct ErrorInfo
         {
@@ -238,6 +251,9 @@ struct AbstractFileSystem //THREAD-SAFETY: "const" member functions must model t
 
         virtual HandleError reportDirError (const ErrorInfo& errorInfo)                          = 0; //failed directory traversal -> consider directory data at current level as incomplete!
         virtual HandleError reportItemError(const ErrorInfo& errorInfo, const Zstring& itemName) = 0; //failed to get data for single file/dir/symlink only!
+
+        //optional: folder read completed (or error ignored), excluding sub folders; callbacks for its items are included
+        virtual void onFolderRead(std::chrono::steady_clock::duration readTime) {}
     };
 
     using TraverserWorkload = std::vector<std::pair<AfsPath, std::shared_ptr<TraverserCallback> /*throw X*/>>;
@@ -260,6 +276,9 @@ struct AbstractFileSystem //THREAD-SAFETY: "const" member functions must model t
     static inline const Zchar* const TEMP_FILE_ENDING = Zstr(".ffs_tmp"); //don't use Zstring as global constant: avoid static initialization order problem in global namespace!
     // caveat: ending is hard-coded by RealTimeSync
 
+    //resumable copy: partial temp file is named after the source attributes => found again by the next run, as long as the source is unchanged
+    static Zstring getResumableTempFileName(const Zstring& fileName, const StreamAttributes& attrSource);
+
     struct FileCopyResult
     {
         uint64_t fileSize = 0;
@@ -267,6 +286,7 @@ struct AbstractFileSystem //THREAD-SAFETY: "const" member functions must model t
         FingerPrint sourceFilePrint = 0; //optional
         FingerPrint targetFilePrint = 0; //
         std::optional<zen::FileError> errorModTime; //failure to set modification time
+        std::string sourceHash; //hex string; only if requested and file content was streamed by FFS (e.g. not for server-side copies)
     };
 
     //symlink handling: follow
@@ -276,11 +296,34 @@ struct AbstractFileSystem //THREAD-SAFETY: "const" member functions must model t
                                                 const AbstractPath& apTarget,
                                                 bool copyFilePermissions,
                                                 bool transactionalCopy,
+                                                //target is existing: transfer changed blocks only (if supported); requires transactionalCopy
+                                                bool deltaCopy,
+                                                //keep partial temp file on failure, see getResumableTempFileName(); requires transactionalCopy + random access on both sides
+                                                //value: size of the partial temp file left by a previous run (0 if none)
+                                                std::optional<uint64_t> resumableCopy,
                                                 //if target is existing user *must* implement deletion to avoid undefined behavior
                                                 //if transactionalCopy == true, full read access on source had been proven at this point, so it's safe to delete it.
                                                 const std::function<void()>& onDeleteTargetFile /*throw X*/,
                                                 //accummulated delta != file size! consider ADS, sparse, compressed files
-                                                const zen::IoCallback& notifyUnbufferedIO /*throw X*/);
+                                                const zen::IoCallback& notifyUnbufferedIO /*throw X*/,
+                                                //optional: hash source content while copying => FileCopyResult::sourceHash
+                                                std::optional<zen::HashAlgorithm> sourceHashAlgo);
+
+    //optional: create many small files with a single request => avoid per-file round trips (e.g. SFTP: tar stream unpacked via shell access)
+    //0: not supported
+    static size_t getBatchUploadFileCountMax(const AbstractPath& apTargetFolder) { return apTargetFolder.afsDevice.ref().getBatchUploadFileCountMax(); }
+
+    struct BatchUploadItem
+    {
+        AbstractPath sourcePath;
+        StreamAttributes attrSource;
+        Zstring targetName; //item name inside target folder
+    };
+    //already existing: undefined behavior! (e.g. fail/overwrite/auto-rename)
+    //all or nothing: on FileError none of the files can be considered copied; results in same order as items
+    static std::vector<FileCopyResult> uploadFileBatch(const AbstractPath& apTargetFolder, const std::vector<BatchUploadItem>& items, //throw FileError, ErrorFileLocked, X
+                                                       const zen::IoCallback& notifyUnbufferedIO /*throw X*/)
+    { return apTargetFolder.afsDevice.ref().uploadFileBatch(apTargetFolder.afsPath, items, notifyUnbufferedIO); }
 
     //already existing: fail
     //symlink handling: follow
@@ -319,11 +362,17 @@ protected:
     //default implementation: folder traversal
     virtual std::optional<ItemType> itemStillExists(const AfsPath& afsPath) const = 0; //throw FileError
 
-    //default implementation: folder traversal
+    //default implementation: removeFolderTreePipelined()
     virtual void removeFolderIfExistsRecursion(const AfsPath& afsPath, //throw FileError
                                                const std::function<void (const std::wstring& displayPath)>& onBeforeFileDeletion,              //optional
                                                const std::function<void (const std::wstring& displayPath)>& onBeforeFolderDeletion) const = 0; //one call for each object!
 
+    //folder traversal on calling thread (including callbacks) + item deletion pipelined on "parallelOps" helper threads
+    void removeFolderTreePipelined(const AfsPath& afsPath, //throw FileError, X
+                                   const std::function<void (const std::wstring& displayPath)>& onBeforeFileDeletion /*throw X*/,   //optional
+                                   const std::function<void (const std::wstring& displayPath)>& onBeforeFolderDeletion /*throw X*/, //one call for each object!
+                                   size_t parallelOps) const;
+
     void traverseFolderFlat(const AfsPath& afsPath, //throw FileError
                             const std::function<void (const FileInfo&    fi)>& onFile,           //
                             const std::function<void (const FolderInfo&  fi)>& onFolder,         //optional
@@ -331,7 +380,13 @@ protected:
 
     //already existing: undefined behavior! (e.g. fail/overwrite/auto-rename)
     FileCopyResult copyFileAsStream(const AfsPath& afsSource, const StreamAttributes& attrSource, //throw FileError, ErrorFileLocked, X
-                                    const AbstractPath& apTarget, const zen::IoCallback& notifyUnbufferedIO /*throw X*/) const;
+                                    const AbstractPath& apTarget, const zen::IoCallback& notifyUnbufferedIO /*throw X*/,
+                                    std::optional<zen::HashAlgorithm> sourceHashAlgo) const;
+
+    //existing partial target: continue after the first "partialSize" bytes; keep it on failure
+    FileCopyResult copyFileAsStreamResumable(const AfsPath& afsSource, const StreamAttributes& attrSource, //throw FileError, ErrorFileLocked, X
+                                             const AbstractPath& apTarget, uint64_t partialSize, const zen::IoCallback& notifyUnbufferedIO /*throw X*/,
+                                             std::optional<zen::HashAlgorithm> sourceHashAlgo) const;
 
 private:
     virtual std::optional<Zstring> getNativeItemPath(const AfsPath& afsPath) const { return {}; };
@@ -359,7 +414,7 @@ private:
     virtual void removeFolderPlain (const AfsPath& afsPath) const = 0; //throw FileError
 
     //----------------------------------------------------------------------------------------------------------------
-    //virtual void setModTime(const AfsPath& afsPath, time_t modTime) const = 0; //throw FileError, follows symlinks
+    virtual void setModTime(const AfsPath& afsPath, time_t modTime) const = 0; //throw FileError, follows symlinks
 
     virtual AbstractPath getSymlinkResolvedPath(const AfsPath& afsPath) const = 0; //throw FileError
     virtual bool equalSymlinkContentForSameAfsType(const AfsPath& afsLhs, const AbstractPath& apRhs) const = 0; //throw FileError
@@ -372,6 +427,23 @@ private:
                                                               std::optional<uint64_t> streamSize,
                                                               std::optional<time_t> modTime,
                                                               const zen::IoCallback& notifyUnbufferedIO /*throw X*/) const = 0;
+
+    //optional random access for segmented copy of large files, see copyFileAsStream():
+    //0: not supported; 1: supported, but no benefit from concurrent streams; > 1: concurrent streams per file
+    virtual size_t getSegmentedCopyStreams() const { return 0; }
+
+    virtual std::unique_ptr<InputStream> getInputStreamAt(const AfsPath& afsPath, uint64_t offset, const zen::IoCallback& notifyUnbufferedIO /*throw X*/) const; //throw FileError, ErrorFileLocked
+
+    //not existing: fail; write starting at offset without truncating the file; modTime: set during finalize()
+    virtual std::unique_ptr<OutputStreamImpl> getOutputStreamAt(const AfsPath& afsPath, uint64_t offset, std::optional<time_t> modTime, //throw FileError
+                                                                const zen::IoCallback& notifyUnbufferedIO /*throw X*/) const;
+
+    virtual std::vector<zen::HashAlgorithm> getServerHashAlgorithms() const { return {}; }
+    virtual std::optional<std::string> getServerFileHash(const AfsPath& afsPath, zen::HashAlgorithm algo) const { return {}; }
+
+    virtual size_t getBatchUploadFileCountMax() const { return 0; }
+    virtual std::vector<FileCopyResult> uploadFileBatch(const AfsPath& targetFolder, const std::vector<BatchUploadItem>& items, //throw FileError, ErrorFileLocked, X
+                                                        const zen::IoCallback& notifyUnbufferedIO /*throw X*/) const;
     //----------------------------------------------------------------------------------------------------------------
     virtual void traverseFolderRecursive(const TraverserWorkload& workload /*throw X*/, size_t parallelOps) const = 0;
     //----------------------------------------------------------------------------------------------------------------
@@ -385,7 +457,27 @@ private:
     virtual FileCopyResult copyFileForSameAfsType(const AfsPath& afsSource, const StreamAttributes& attrSource, //throw FileError, ErrorFileLocked, X
                                                   const AbstractPath& apTarget, bool copyFilePermissions,
                                                   //accummulated delta != file size! consider ADS, sparse, compressed files
-                                                  const zen::IoCallback& notifyUnbufferedIO /*throw X*/) const = 0;
+                                                  const zen::IoCallback& notifyUnbufferedIO /*throw X*/,
+                                                  std::optional<zen::HashAlgorithm> sourceHashAlgo) const = 0;
+
+    //copyFileForSameAfsType() copies on the server without transferring file content (same device/account)
+    //=> preferable over resumable stream-based copy
+    virtual bool hasServerSideCopy(const AbstractPath& apTarget) const { return false; }
+
+    //delta copy: create "apTarget" from the source, reusing unchanged blocks of the existing "afsBase" (same device as "apTarget")
+    //std::nullopt: not supported => nothing created, caller falls back to copyFileForSameAfsType()
+    virtual std::optional<FileCopyResult> copyFileDeltaForSameAfsType(const AfsPath& afsSource, const StreamAttributes& attrSource, //throw FileError, ErrorFileLocked, X
+                                                                      const AbstractPath& apTarget, const AfsPath& afsBase, bool copyFilePermissions,
+                                                                      const zen::IoCallback& notifyUnbufferedIO /*throw X*/,
+                                                                      std::optional<zen::HashAlgorithm> sourceHashAlgo) const { return std::nullopt; }
+
+    //transactional copy without temporary file name: "apTarget" appears only once complete; onBeforePublish: e.g. delete the old target file
+    //std::nullopt: not supported => nothing created, onBeforePublish() not called, caller falls back to temp file + rename
+    virtual std::optional<FileCopyResult> copyFileAnonymousForSameAfsType(const AfsPath& afsSource, const StreamAttributes& attrSource, //throw FileError, ErrorFileLocked, X
+                                                                          const AbstractPath& apTarget, bool copyFilePermissions,
+                                                                          const std::function<void()>& onBeforePublish /*throw X*/,
+                                                                          const zen::IoCallback& notifyUnbufferedIO /*throw X*/,
+                                                                          std::optional<zen::HashAlgorithm> sourceHashAlgo) const { return std::nullopt; }
 
 
     //symlink handling: follow
@@ -401,6 +493,9 @@ private:
 
     virtual void authenticateAccess(bool allowUserInteraction) const = 0; //throw FileError
 
+    //open connections for "parallelOps" concurrent operations up front, e.g. before traversal/synchronization => hide login latency (if applicable)
+    virtual void prewarmConnections(size_t parallelOps) const = 0; //throw FileError
+
     virtual int getAccessTimeout() const = 0; //returns "0" if no timeout in force
 
     virtual bool hasNativeTransactionalCopy() const = 0;
@@ -9,6 +9,8 @@
 
 #include "abstract.h"
 #include <zen/thread.h>
+#include <zen/ring_buffer.h>
+#include <zen/scope_guard.h>
 #include <zen/stream_buffer.h>
 
 
@@ -18,22 +20,28 @@ template <class Function> inline //return ignored error message if available
 std::wstring tryReportingDirError(Function cmd /*throw FileError*/, AbstractFileSystem::TraverserCallback& cb /*throw X*/)
 {
     for (size_t retryNumber = 0;; ++retryNumber)
+    {
+        const auto readStartTime = std::chrono::steady_clock::now();
         try
         {
             cmd(); //throw FileError
+            cb.onFolderRead(std::chrono::steady_clock::now() - readStartTime);
             return std::wstring();
         }
         catch (const zen::FileError& e)
         {
             assert(!e.toString().empty());
-            switch (cb.reportDirError({e.toString(), std::chrono::steady_clock::now(), retryNumber})) //throw X
+            const auto failTime = std::chrono::steady_clock::now();
+            switch (cb.reportDirError({e.toString(), failTime, retryNumber})) //throw X
             {
                 case AbstractFileSystem::TraverserCallback::HandleError::ignore:
+                    cb.onFolderRead(failTime - readStartTime); //e.g. timeout on network share: exactly what we want to know about
                     return e.toString();
                 case AbstractFileSystem::TraverserCallback::HandleError::retry:
                     break; //continue with loop
             }
         }
+    }
 }
 
 template <class Command> inline
@@ -57,6 +65,130 @@ bool tryReportingItemError(Command cmd, AbstractFileSystem::TraverserCallback& c
         }
 }
 
+/* work-stealing traversal: one queue per thread
+    - own queue:    LIFO => depth-first: keeps the number of pending folders (and their callbacks) low
+    - other queues: FIFO => steal the oldest items, i.e. the ones closest to the root with (likely) the largest sub trees
+    - a work item is at least one opendir() + readdir() per folder (native: + lstat() per item; SFTP: network round trips) => a single lock for all queues is good enough
+    - callbacks run concurrently, but each TraverserCallback instance is only ever used by a single thread          */
+template <class WorkItem>
+class ParallelFolderTraverser
+{
+public:
+    using TraverseFlat = std::function<void(const WorkItem& wi, std::vector<WorkItem>& subFolders)>; //throw X; read a single folder, append sub folders to traverse next
+
+    ParallelFolderTraverser(std::vector<WorkItem>&& workload, size_t threadCount, const Zstring& threadName, const TraverseFlat& traverseFlat) :
+        threadName_(threadName), traverseFlat_(traverseFlat), queues_(threadCount)
+    {
+        assert(threadCount >= 2);
+        for (size_t i = 0; i < workload.size(); ++i)
+            queues_[i % threadCount].push_back(std::move(workload[i]));
+        itemsPending_ = workload.size();
+    }
+
+    void run() //throw X
+    {
+        {
+            std::vector<zen::InterruptibleThread> worker;
+            ZEN_ON_SCOPE_FAIL( for (zen::InterruptibleThread& wt : worker) wt.requestStop(); ); //stop *all* at the same time before join!
+
+            for (size_t threadIdx = 1; threadIdx < queues_.size(); ++threadIdx)
+                worker.emplace_back([this, threadIdx]
+            {
+                zen::setCurrentThreadName(threadName_ + Zstr('[') + zen::numberTo<Zstring>(threadIdx + 1) + Zstr('/') + zen::numberTo<Zstring>(queues_.size()) + Zstr(']'));
+                try
+                {
+                    workerLoop(threadIdx); //throw X
+                }
+                catch (zen::ThreadStopRequest&) { throw; }
+                catch (...)
+                {
+                    {
+                        std::lock_guard dummy(lockQueues_);
+                        if (!workerException_)
+                            workerException_ = std::current_exception();
+                    }
+                    conditionNewItems_.notify_all();
+                }
+            });
+
+            //current thread is part of the team => ThreadStopRequest for the caller will also stop the other workers (see above)
+            workerLoop(0); //throw X
+
+            for (zen::InterruptibleThread& wt : worker)
+                wt.join();
+        }
+
+        if (workerException_)
+            std::rethrow_exception(workerException_); //throw X
+    }
+
+private:
+    ParallelFolderTraverser           (const ParallelFolderTraverser&) = delete;
+    ParallelFolderTraverser& operator=(const ParallelFolderTraverser&) = delete;
+
+    void workerLoop(size_t threadIdx) //throw X
+    {
+        std::vector<WorkItem> subFolders;
+
+        std::unique_lock dummy(lockQueues_);
+        for (;;)
+        {
+            std::optional<WorkItem> wi;
+
+            zen::interruptibleWait(conditionNewItems_, dummy, [&] //throw ThreadStopRequest
+            {
+                if (itemsPending_ == 0 || workerException_)
+                    return true;
+
+                if (zen::RingBuffer<WorkItem>& ownQueue = queues_[threadIdx];
+                    !ownQueue.empty())
+                {
+                    wi = std::move(ownQueue.back());
+                    ownQueue.pop_back();
+                    return true;
+                }
+                for (size_t i = 1; i < queues_.size(); ++i)
+                    if (zen::RingBuffer<WorkItem>& otherQueue = queues_[(threadIdx + i) % queues_.size()];
+                        !otherQueue.empty())
+                    {
+                        wi = std::move(otherQueue.front());
+                        otherQueue.pop_front();
+                        return true;
+                    }
+                return false;
+            });
+            if (!wi) //all done (or failed)
+                return;
+
+            dummy.unlock();
+            traverseFlat_(*wi, subFolders); //throw X
+            wi.reset(); //release callback early
+            dummy.lock();
+
+            zen::RingBuffer<WorkItem>& ownQueue = queues_[threadIdx];
+            for (WorkItem& subWi : subFolders)
+                ownQueue.push_back(std::move(subWi));
+
+            itemsPending_ += subFolders.size();
+            --itemsPending_;
+
+            if (!subFolders.empty() || itemsPending_ == 0)
+                conditionNewItems_.notify_all();
+            subFolders.clear();
+        }
+    }
+
+    const Zstring threadName_;
+    const TraverseFlat traverseFlat_;
+
+    std::mutex lockQueues_;
+    std::condition_variable conditionNewItems_;
+    std::vector<zen::RingBuffer<WorkItem>> queues_; //one per thread
+    size_t itemsPending_ = 0; //queued + currently traversed
+    std::exception_ptr workerException_;
+};
+
+
 //==========================================================================================
 
 //Google Drive/MTP happily create duplicate files/folders with the same names, without failing
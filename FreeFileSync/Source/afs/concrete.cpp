@@ -16,10 +16,11 @@ using namespace zen;
 
 void fff::initAfs(const AfsConfig& cfg)
 {
-    ftpInit();
+    ftpInit(appendPath(cfg.configDirPath, Zstr("FtpTimes.db")));
     sftpInit();
     gdriveInit(appendPath(cfg.configDirPath,   Zstr("GoogleDrive")),
-               appendPath(cfg.resourceDirPath, Zstr("cacert.pem")));
+               appendPath(cfg.resourceDirPath, Zstr("cacert.pem")),
+               cfg.httpSessionMaxIdleTime);
 }
 
 
@@ -15,6 +15,7 @@ struct AfsConfig
 {
     Zstring resourceDirPath; //directory to read AFS-specific files
     Zstring configDirPath;   //directory to store AFS-specific files
+    std::chrono::seconds httpSessionMaxIdleTime{60}; //Google Drive: reuse TLS connections across requests
 };
 void initAfs(const AfsConfig& cfg);
 [[nodiscard]] std::wstring /*warningMsg*/ teardownAfs();
@@ -10,6 +10,9 @@
 #include <zen/globals.h>
 #include <zen/resolve_path.h>
 #include <zen/time.h>
+#include <zen/crc.h>
+#include <zen/file_io.h>
+#include <zen/zlib_wrap.h>
 #include <libcurl/curl_wrap.h> //DON'T include <curl/curl.h> directly!
 #include "init_curl_libssh2.h"
 #include "ftp_common.h"
@@ -29,6 +32,7 @@ namespace
 
 constexpr std::chrono::seconds FTP_SESSION_MAX_IDLE_TIME  (20);
 constexpr std::chrono::seconds FTP_SESSION_CLEANUP_INTERVAL(4);
+const size_t FTP_REMOVE_FOLDER_PARALLEL_OPS = 2; //one FTP connection per helper thread: servers commonly limit connections per client IP
 const int FTP_STREAM_BUFFER_SIZE = 512 * 1024; //unit: [byte]
 //FTP stream buffer should be at least as big as the biggest AFS block size (currently 256 KB for MTP),
 //but there seems to be no reason for an upper limit
@@ -661,6 +665,68 @@ public:
         return utfToServerEncoding(serverPath, encoding); //throw SysError
     }
 
+    //returns hex string; none: not supported by server
+    std::optional<std::string> getServerFileHash(const AfsPath& afsPath, HashAlgorithm algo) //throw SysError
+    {
+        const auto [hashName, hashLen, hashFeature] = [&]() -> std::tuple<const char*, size_t, bool Features::*>
+        {
+            switch (algo)
+            {
+                //*INDENT-OFF*
+                case HashAlgorithm::md5:    return {"MD5",     32, &Features::hashMd5};
+                case HashAlgorithm::sha1:   return {"SHA-1",   40, &Features::hashSha1};
+                case HashAlgorithm::sha256: return {"SHA-256", 64, &Features::hashSha256};
+                //*INDENT-ON*
+            }
+            throw std::logic_error("Contract violation! " + std::string(__FILE__) + ':' + numberTo<std::string>(__LINE__));
+        }();
+
+        auto isValidHash = [hashLen = hashLen](const std::string& str) { return str.size() == hashLen && std::all_of(str.begin(), str.end(), isHexDigit<char>); };
+
+        //https://datatracker.ietf.org/doc/html/draft-bryan-ftpext-hash-02
+        if (getFeatureSupport(hashFeature)) //throw SysError
+        {
+            runSingleFtpCommand(std::string("OPTS HASH ") + hashName, false /*requiresUtf8*/); //throw SysError
+
+            const std::string hashBuf = runSingleFtpCommand("HASH " + getServerPathInternal(afsPath), true /*requiresUtf8*/); //throw SysError
+            for (const std::string& line : splitFtpResponse(hashBuf))
+                if (startsWith(line, "213 ")) //213<space><algorithm><space><start>-<end><space><hash><space><file name>
+                {
+                    const std::vector<std::string> items = split(line, ' ', SplitOnEmpty::skip);
+                    if (items.size() >= 4 && isValidHash(items[3]))
+                        return items[3];
+                    break;
+                }
+            return {};
+        }
+
+        //non-standard, but widespread: e.g. "250 <hash>", "251 <file name> <hash>"
+        if (algo == HashAlgorithm::md5 && getFeatureSupport(&Features::xmd5)) //throw SysError
+        {
+            const std::string hashBuf = runSingleFtpCommand("XMD5 " + getServerPathInternal(afsPath), true /*requiresUtf8*/); //throw SysError
+            for (const std::string& line : splitFtpResponse(hashBuf))
+                if (startsWith(line, "25"))
+                {
+                    for (const std::string& item : split(line, ' ', SplitOnEmpty::skip))
+                        if (isValidHash(item))
+                            return item;
+                    break;
+                }
+            return {};
+        }
+        return {};
+    }
+
+    std::vector<HashAlgorithm> getServerHashAlgorithms() //throw SysError
+    {
+        std::vector<HashAlgorithm> hashAlgos;
+        if (getFeatureSupport(&Features::hashSha256)) hashAlgos.push_back(HashAlgorithm::sha256); //throw SysError
+        if (getFeatureSupport(&Features::hashSha1  )) hashAlgos.push_back(HashAlgorithm::sha1);   //
+        if (getFeatureSupport(&Features::hashMd5   ) ||
+            getFeatureSupport(&Features::xmd5      )) hashAlgos.push_back(HashAlgorithm::md5);    //
+        return hashAlgos;
+    }
+
 private:
     FtpSession           (const FtpSession&) = delete;
     FtpSession& operator=(const FtpSession&) = delete;
@@ -745,6 +811,10 @@ private:
         bool mfmt = false;
         bool clnt = false;
         bool utf8 = false;
+        bool hashSha256 = false;
+        bool hashSha1   = false;
+        bool hashMd5    = false;
+        bool xmd5       = false;
     };
     using FeatureList = std::unordered_map<Zstring /*server name*/, std::optional<Features>, StringHashAsciiNoCase, StringEqualAsciiNoCase>;
 
@@ -814,6 +884,22 @@ private:
 
                 else if (equalAsciiNoCase(line, " CLNT"))
                     output.clnt = true;
+
+                //https://datatracker.ietf.org/doc/html/draft-bryan-ftpext-hash-02#section-3.3
+                else if (startsWithAsciiNoCase(line, " HASH ")) //SP "HASH" SP hashlist; "*" marks the currently selected algorithm: e.g. " HASH SHA-256;SHA-1*;MD5"
+                    for (std::string hashName : split(afterFirst(line, "HASH ", IfNotFoundReturn::none), ';', SplitOnEmpty::skip))
+                    {
+                        trim(hashName, true, true, [](char c) { return c == '*' || isWhiteSpace(c); });
+                        if (equalAsciiNoCase(hashName, "SHA-256"))
+                            output.hashSha256 = true;
+                        else if (equalAsciiNoCase(hashName, "SHA-1"))
+                            output.hashSha1 = true;
+                        else if (equalAsciiNoCase(hashName, "MD5"))
+                            output.hashMd5 = true;
+                    }
+
+                else if (equalAsciiNoCase(line, " XMD5"))
+                    output.xmd5 = true;
             }
         }
         return output;
@@ -946,6 +1032,142 @@ UniInitializer globalStartupInitFtp(*globalFtpSessionCount.get());
 constinit Global<FtpSessionManager> globalFtpSessionManager; //caveat: life time must be subset of static UniInitializer!
 //--------------------------------------------------------------------------------------
 
+
+/*  FtpLogin::preciseTimes: LIST output is imprecise (minutes, or just the date for older files; time zone unknown)
+    => time-based comparison sees differences that don't exist and copies the same files again and again
+    => get the precise time via MDTM once, then reuse it as long as LIST still reports the same size and time   */
+class FtpPreciseTimeCache
+{
+public:
+    explicit FtpPreciseTimeCache(const Zstring& dbFilePath) : dbFilePath_(dbFilePath) {}
+
+    std::optional<time_t> get(const Zstring& itemKey, uint64_t listFileSize, time_t listModTime)
+    {
+        std::optional<time_t> modTime;
+        itemsBuf_.access([&](CacheState& state)
+        {
+            loadIfNeeded(state);
+            if (auto it = state.items.find(itemKey);
+                it != state.items.end() && it->second.listFileSize == listFileSize && it->second.listModTime == listModTime)
+            {
+                it->second.lastUsed = std::time(nullptr);
+                state.changed = true;
+                modTime = it->second.preciseModTime;
+            }
+        });
+        return modTime;
+    }
+
+    void set(const Zstring& itemKey, uint64_t listFileSize, time_t listModTime, time_t preciseModTime)
+    {
+        itemsBuf_.access([&](CacheState& state)
+        {
+            loadIfNeeded(state);
+            state.items[itemKey] = {listFileSize, listModTime, preciseModTime, std::time(nullptr)};
+            state.changed = true;
+        });
+    }
+
+    void save() //throw FileError
+    {
+        itemsBuf_.access([&](CacheState& state)
+        {
+            if (!state.changed)
+                return;
+
+            const time_t expiredBefore = std::time(nullptr) - TIME_CACHE_EXPIRY_DAYS * 24 * 3600; //items not seen for a long time: deleted or not an FTP target anymore
+
+            MemoryStreamOut<std::string> streamOutBody;
+            for (const auto& [itemKey, item] : state.items)
+                if (item.lastUsed >= expiredBefore)
+                {
+                    writeContainer(streamOutBody, utfTo<std::string>(itemKey));
+                    writeNumber<uint64_t>(streamOutBody, item.listFileSize);
+                    writeNumber< int64_t>(streamOutBody, item.listModTime);
+                    writeNumber< int64_t>(streamOutBody, item.preciseModTime);
+                    writeNumber< int64_t>(streamOutBody, item.lastUsed);
+                }
+
+            MemoryStreamOut<std::string> streamOut;
+            writeArray(streamOut, TIME_CACHE_FILE_DESCR, sizeof(TIME_CACHE_FILE_DESCR));
+            writeNumber<int32_t>(streamOut, TIME_CACHE_FILE_VERSION);
+            writeNumber<uint32_t>(streamOut, getCrc32(streamOutBody.ref()));
+            try
+            {
+                streamOut.ref() += compress(streamOutBody.ref(), 3 /*best compression level: see db_file.cpp*/); //throw SysError
+            }
+            catch (const SysError& e) { throw FileError(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(dbFilePath_)), e.toString()); }
+
+            setFileContent(dbFilePath_, streamOut.ref(), nullptr /*notifyUnbufferedIO*/); //throw FileError
+            state.changed = false;
+        });
+    }
+
+private:
+    FtpPreciseTimeCache           (const FtpPreciseTimeCache&) = delete;
+    FtpPreciseTimeCache& operator=(const FtpPreciseTimeCache&) = delete;
+
+    struct CachedTime
+    {
+        uint64_t listFileSize = 0;
+        time_t listModTime = 0;
+        time_t preciseModTime = 0;
+        time_t lastUsed = 0;
+    };
+    struct CacheState
+    {
+        bool loaded = false;
+        bool changed = false;
+        std::unordered_map<Zstring, CachedTime> items; //key: display path (server, port, username, path)
+    };
+
+    void loadIfNeeded(CacheState& state) //noexcept: cache is not critical => start over on error
+    {
+        if (state.loaded)
+            return;
+        state.loaded = true;
+        try
+        {
+            const std::string byteStream = getFileContent(dbFilePath_, nullptr /*notifyUnbufferedIO*/); //throw FileError
+
+            MemoryStreamIn streamIn(byteStream);
+            char tmp[sizeof(TIME_CACHE_FILE_DESCR)] = {};
+            readArray(streamIn, &tmp, sizeof(tmp)); //throw SysErrorUnexpectedEos
+            if (!std::equal(std::begin(tmp), std::end(tmp), std::begin(TIME_CACHE_FILE_DESCR)) ||
+                readNumber<int32_t>(streamIn) != TIME_CACHE_FILE_VERSION) //throw SysErrorUnexpectedEos
+                return;
+            const uint32_t bodyCrc = readNumber<uint32_t>(streamIn); //throw SysErrorUnexpectedEos
+
+            const std::string body = decompress(std::string(byteStream.begin() + streamIn.pos(), byteStream.end())); //throw SysError
+            if (getCrc32(body) != bodyCrc)
+                return;
+
+            MemoryStreamIn streamInBody(body);
+            while (streamInBody.pos() != body.size())
+            {
+                const Zstring itemKey = utfTo<Zstring>(readContainer<std::string>(streamInBody)); //throw SysErrorUnexpectedEos
+                CachedTime& item = state.items[itemKey];
+                item.listFileSize   = readNumber<uint64_t>(streamInBody); //
+                item.listModTime    = readNumber< int64_t>(streamInBody); //throw SysErrorUnexpectedEos
+                item.preciseModTime = readNumber< int64_t>(streamInBody); //
+                item.lastUsed       = readNumber< int64_t>(streamInBody); //
+            }
+        }
+        catch (FileError&) { state.items.clear(); } //e.g. not existing (first run)
+        catch (SysError&) { state.items.clear(); }
+    }
+
+    static constexpr char TIME_CACHE_FILE_DESCR[] = "FreeFileSync: FTP Times";
+    static constexpr int TIME_CACHE_FILE_VERSION = 1; //2026-10-15
+    static constexpr int TIME_CACHE_EXPIRY_DAYS = 90;
+
+    const Zstring dbFilePath_;
+    Protected<CacheState> itemsBuf_;
+};
+
+constinit Global<FtpPreciseTimeCache> globalFtpPreciseTimeCache;
+//--------------------------------------------------------------------------------------
+
 void accessFtpSession(const FtpLogin& login, const std::function<void(FtpSession& session)>& useFtpSession /*throw X*/) //throw SysError, X
 {
     if (const std::shared_ptr<FtpSessionManager> mgr = globalFtpSessionManager.get())
@@ -966,6 +1188,26 @@ struct FtpItem
 };
 
 
+time_t parseMdtmResponse(const std::string& mdtmBuf) //throw SysError
+{
+    //https://tools.ietf.org/html/rfc3659#section-3
+    for (const std::string& line : splitFtpResponse(mdtmBuf))
+        if (startsWith(line, "213 ")) // 213<space> YYYYMMDDHHMMSS[.sss]       "Time values are always represented in UTC (GMT)" ...and libcurl thinks so, too
+        {
+            const auto itStart = line.begin() + 4;
+            const auto itEnd = std::find(itStart, line.end(), '.');
+
+            if (const TimeComp tc = parseTime("%Y%m%d%H%M%S", makeStringView(itStart, itEnd));
+                tc != TimeComp())
+                if (const auto [modTime, timeValid] = utcToTimeT(tc);
+                    timeValid)
+                    return modTime;
+            break;
+        }
+    throw SysError(L"Unexpected FTP response. (" + utfTo<std::wstring>(mdtmBuf) + L')');
+}
+
+
 //get info about *existing* symlink!
 FtpItem getFtpSymlinkInfo(const FtpLogin& login, const AfsPath& linkPath) //throw FileError
 {
@@ -1013,23 +1255,7 @@ FtpItem getFtpSymlinkInfo(const FtpLogin& login, const AfsPath& linkPath) //thro
         if (output.type == AFS::ItemType::folder)
             return output;
 
-        output.modTime = [&] //https://tools.ietf.org/html/rfc3659#section-3
-        {
-            for (const std::string& line : splitFtpResponse(mdtmBuf))
-                if (startsWith(line, "213 ")) // 213<space> YYYYMMDDHHMMSS[.sss]       "Time values are always represented in UTC (GMT)" ...and libcurl thinks so, too
-                {
-                    const auto itStart = line.begin() + 4;
-                    const auto itEnd = std::find(itStart, line.end(), '.');
-
-                    if (const TimeComp tc = parseTime("%Y%m%d%H%M%S", makeStringView(itStart, itEnd));
-                        tc != TimeComp())
-                        if (const auto [modTime, timeValid] = utcToTimeT(tc);
-                            timeValid)
-                            return modTime;
-                    break;
-                }
-            throw SysError(L"Unexpected FTP response. (" + utfTo<std::wstring>(mdtmBuf) + L')');
-        }();
+        output.modTime = parseMdtmResponse(mdtmBuf); //throw SysError
 
         return output;
     }
@@ -1043,7 +1269,7 @@ FtpItem getFtpSymlinkInfo(const FtpLogin& login, const AfsPath& linkPath) //thro
 class FtpDirectoryReader
 {
 public:
-    static std::vector<FtpItem> execute(const FtpLogin& login, const AfsPath& afsDirPath) //throw FileError
+    static std::vector<FtpItem> execute(const FtpLogin& login, const AfsPath& afsDirPath, bool& preciseTimes) //throw FileError
     {
         std::string rawListing; //get raw FTP directory listing
 
@@ -1099,7 +1325,8 @@ public:
                 session.perform(afsDirPath, true /*isDir*/, pathMethod, options, true /*requiresUtf8*/); //throw SysError
 
                 const ServerEncoding encoding = session.getServerEncoding(); //throw SysError
-                if (session.supportsMlsd()) //throw SysError
+                preciseTimes = session.supportsMlsd(); //throw SysError
+                if (preciseTimes)
                     output = parseMlsd(rawListing, encoding); //throw SysError
                 else
                     output = parseUnknown(rawListing, encoding); //throw SysError
@@ -1559,34 +1786,84 @@ private:
 };
 
 
-class SingleFolderTraverser
+struct TraverserWorkItem
 {
-public:
-    SingleFolderTraverser(const FtpLogin& login, const std::vector<std::pair<AfsPath, std::shared_ptr<AFS::TraverserCallback>>>& workload /*throw X*/)
-        : workload_(workload), login_(login)
-    {
-        while (!workload_.empty())
+    AfsPath dirPath;
+    std::shared_ptr<AFS::TraverserCallback> cb;
+};
+
+
+//LIST-based listing + FtpLogin::preciseTimes: replace file times with cached or freshly fetched MDTM times
+//MDTM failure (e.g. not supported, file deleted in the meantime) is not an error: keep LIST time
+void applyPreciseFileTimes(const FtpLogin& login, const AfsPath& afsDirPath, std::vector<FtpItem>& items, size_t parallelOps) //noexcept
+{
+    const std::shared_ptr<FtpPreciseTimeCache> timeCache = globalFtpPreciseTimeCache.get();
+    if (!timeCache)
+        return;
+
+    std::vector<std::pair<FtpItem*, Zstring /*itemKey*/>> itemsToFetch;
+    for (FtpItem& item : items)
+        if (item.type == AFS::ItemType::file)
         {
-            auto wi = std::move(workload_.    back()); //yes, no strong exception guarantee (std::bad_alloc)
-            /**/                workload_.pop_back();  //
-            const auto& [folderPath, cb] = wi;
+            Zstring itemKey = utfTo<Zstring>(getCurlDisplayPath(login, AfsPath(appendPath(afsDirPath.value, item.itemName))));
 
-            tryReportingDirError([&] //throw X
+            if (const std::optional<time_t> modTime = timeCache->get(itemKey, item.fileSize, item.modTime))
+                item.modTime = *modTime;
+            else
+                itemsToFetch.emplace_back(&item, std::move(itemKey));
+        }
+
+    std::atomic<size_t> nextPos{0};
+    auto fetchTimes = [&] //noexcept
+    {
+        for (size_t pos = nextPos++; pos < itemsToFetch.size(); pos = nextPos++)
+        {
+            FtpItem& item = *itemsToFetch[pos].first;
+            try
             {
-                traverseWithException(folderPath, *cb); //throw FileError, X
-            }, *cb);
+                std::string mdtmBuf;
+                accessFtpSession(login, [&](FtpSession& session) //throw SysError
+                {
+                    mdtmBuf = session.runSingleFtpCommand("MDTM " + session.getServerPathInternal(AfsPath(appendPath(afsDirPath.value, item.itemName))),
+                                                          true /*requiresUtf8*/); //throw SysError
+                });
+                const time_t modTime = parseMdtmResponse(mdtmBuf); //throw SysError
+
+                timeCache->set(itemsToFetch[pos].second, item.fileSize, item.modTime, modTime);
+                item.modTime = modTime;
+            }
+            catch (SysError&) {}
         }
-    }
+    };
 
-private:
-    SingleFolderTraverser           (const SingleFolderTraverser&) = delete;
-    SingleFolderTraverser& operator=(const SingleFolderTraverser&) = delete;
+    //one MDTM round trip per file: use the same number of (pooled) sessions as the traverser
+    std::vector<std::future<void>> helpers;
+    for (size_t i = 1; i < std::min(parallelOps, itemsToFetch.size()); ++i)
+        try { helpers.push_back(runAsync([&] { setCurrentThreadName(Zstr("FTP Times")); fetchTimes(); })); }
+        catch (const std::system_error&) { break; } //thread creation failed? => fewer helpers
+
+    fetchTimes(); //noexcept
+    for (std::future<void>& ft : helpers)
+        ft.wait();
+}
+
+
+//read a single folder: sub folders to traverse next are appended to "workload"
+void traverseFolderFlat(const FtpLogin& login, const TraverserWorkItem& wi, std::vector<TraverserWorkItem>& workload, size_t parallelOps) //throw X
+{
+    AFS::TraverserCallback& cb = *wi.cb;
 
-    void traverseWithException(const AfsPath& dirPath, AFS::TraverserCallback& cb) //throw FileError, X
+    tryReportingDirError([&] //throw X
     {
-        for (const FtpItem& item : FtpDirectoryReader::execute(login_, dirPath)) //throw FileError
+        bool preciseTimes = false;
+        std::vector<FtpItem> items = FtpDirectoryReader::execute(login, wi.dirPath, preciseTimes); //throw FileError
+
+        if (!preciseTimes && login.preciseTimes)
+            applyPreciseFileTimes(login, wi.dirPath, items, parallelOps); //noexcept
+
+        for (const FtpItem& item : items)
         {
-            const AfsPath itemPath(appendPath(dirPath.value, item.itemName));
+            const AfsPath itemPath(appendPath(wi.dirPath.value, item.itemName));
 
             switch (item.type)
             {
@@ -1596,7 +1873,7 @@ private:
 
                 case AFS::ItemType::folder:
                     if (std::shared_ptr<AFS::TraverserCallback> cbSub = cb.onFolder({item.itemName, false /*isFollowedSymlink*/})) //throw X
-                        workload_.push_back({itemPath, std::move(cbSub)});
+                        workload.push_back({itemPath, std::move(cbSub)});
                     break;
 
                 case AFS::ItemType::symlink:
@@ -1607,14 +1884,14 @@ private:
                             FtpItem target = {};
                             if (!tryReportingItemError([&] //throw X
                         {
-                            target = getFtpSymlinkInfo(login_, itemPath); //throw FileError
+                            target = getFtpSymlinkInfo(login, itemPath); //throw FileError
                             }, cb, item.itemName))
                             continue;
 
                             if (target.type == AFS::ItemType::folder)
                             {
                                 if (std::shared_ptr<AFS::TraverserCallback> cbSub = cb.onFolder({item.itemName, true /*isFollowedSymlink*/})) //throw X
-                                    workload_.push_back({itemPath, std::move(cbSub)});
+                                    workload.push_back({itemPath, std::move(cbSub)});
                             }
                             else //a file or named pipe, etc.
                                 cb.onFile({item.itemName, target.fileSize, target.modTime, item.filePrint, true /*isFollowedSymlink*/}); //throw X
@@ -1627,16 +1904,30 @@ private:
                     break;
             }
         }
-    }
-
-    std::vector<std::pair<AfsPath, std::shared_ptr<AFS::TraverserCallback>>> workload_;
-    const FtpLogin login_;
-};
+    }, cb);
+}
 
 
-void traverseFolderRecursiveFTP(const FtpLogin& login, const std::vector<std::pair<AfsPath, std::shared_ptr<AFS::TraverserCallback>>>& workload /*throw X*/, size_t) //throw X
+void traverseFolderRecursiveFTP(const FtpLogin& login, const std::vector<std::pair<AfsPath, std::shared_ptr<AFS::TraverserCallback>>>& workload /*throw X*/, size_t parallelOps) //throw X
 {
-    SingleFolderTraverser dummy(login, workload); //throw X
+    std::vector<TraverserWorkItem> workItems;
+    for (const auto& [folderPath, cb] : workload)
+        workItems.push_back({folderPath, cb});
+
+    //FtpSessionManager hands out one idle (or new) session per concurrent access => "parallelOps" control connections, each listing a different folder
+    if (parallelOps >= 2)
+        return ParallelFolderTraverser<TraverserWorkItem>(std::move(workItems), parallelOps, Zstr("FTP Traverser"), [&login](const TraverserWorkItem& wi, std::vector<TraverserWorkItem>& subFolders)
+    {
+        traverseFolderFlat(login, wi, subFolders, 1 /*parallelOps: folders are already read in parallel*/); //throw X
+    }).run(); //throw X
+
+    while (!workItems.empty())
+    {
+        TraverserWorkItem wi = std::move(workItems.    back()); //yes, no strong exception guarantee (std::bad_alloc)
+        /**/                              workItems.pop_back();  //
+
+        traverseFolderFlat(login, wi, workItems, std::max<size_t>(parallelOps, 1)); //throw X
+    }
 }
 //===========================================================================================================================
 //===========================================================================================================================
@@ -1757,6 +2048,31 @@ void ftpFileUpload(const FtpLogin& login, const AfsPath& afsFilePath, //throw Fi
     }
 }
 
+
+void setModTimeMfmt(const FtpLogin& login, const AfsPath& afsPath, time_t modTime) //throw FileError, follows symlinks
+{
+    try
+    {
+        const std::string isoTime = utfTo<std::string>(formatTime(Zstr("%Y%m%d%H%M%S"), getUtcTime(modTime))); //returns empty string on failure
+        if (isoTime.empty())
+            throw SysError(L"Invalid modification time (time_t: " + numberTo<std::wstring>(modTime) + L')');
+
+        accessFtpSession(login, [&](FtpSession& session) //throw SysError
+        {
+            if (!session.supportsMfmt()) //throw SysError
+                throw SysError(L"Server does not support the MFMT command.");
+
+            session.runSingleFtpCommand("MFMT " + isoTime + ' ' + session.getServerPathInternal(afsPath),
+                                        true /*requiresUtf8*/); //throw SysError
+            //does MFMT follow symlinks? for Linux FTP server (using utime) it does
+        });
+    }
+    catch (const SysError& e)
+    {
+        throw FileError(replaceCpy(_("Cannot write modification time of %x."), L"%x", fmtPath(getCurlDisplayPath(login, afsPath))), e.toString());
+    }
+}
+
 //===========================================================================================================================
 
 struct InputStreamFtp : public AFS::InputStream
@@ -1915,26 +2231,7 @@ private:
     {
         //assert(isReady(futUploadDone_)); => MUST NOT CALL *after* std::future<>::get()!
         if (modTime_)
-            try
-            {
-                const std::string isoTime = utfTo<std::string>(formatTime(Zstr("%Y%m%d%H%M%S"), getUtcTime(*modTime_))); //returns empty string on failure
-                if (isoTime.empty())
-                    throw SysError(L"Invalid modification time (time_t: " + numberTo<std::wstring>(*modTime_) + L')');
-
-                accessFtpSession(login_, [&](FtpSession& session) //throw SysError
-                {
-                    if (!session.supportsMfmt()) //throw SysError
-                        throw SysError(L"Server does not support the MFMT command.");
-
-                    session.runSingleFtpCommand("MFMT " + isoTime + ' ' + session.getServerPathInternal(afsPath_),
-                                                true /*requiresUtf8*/); //throw SysError
-                    //not relevant for OutputStreamFtp, but: does MFMT follow symlinks? for Linux FTP server (using utime) it does
-                });
-            }
-            catch (const SysError& e)
-            {
-                throw FileError(replaceCpy(_("Cannot write modification time of %x."), L"%x", fmtPath(getCurlDisplayPath(login_, afsPath_))), e.toString());
-            }
+            setModTimeMfmt(login_, afsPath_, *modTime_); //throw FileError, follows symlinks
     }
 
     const FtpLogin login_;
@@ -2128,7 +2425,13 @@ private:
                                        const std::function<void (const std::wstring& displayPath)>& onBeforeFolderDeletion) const override //one call for each object!
     {
         //default implementation: folder traversal
-        AFS::removeFolderIfExistsRecursion(afsPath, onBeforeFileDeletion, onBeforeFolderDeletion); //throw FileError, X
+        removeFolderTreePipelined(afsPath, onBeforeFileDeletion, onBeforeFolderDeletion, FTP_REMOVE_FOLDER_PARALLEL_OPS); //throw FileError, X
+    }
+
+    //----------------------------------------------------------------------------------------------------------------
+    void setModTime(const AfsPath& afsPath, time_t modTime) const override //throw FileError, follows symlinks
+    {
+        setModTimeMfmt(login_, afsPath, modTime); //throw FileError
     }
 
     //----------------------------------------------------------------------------------------------------------------
@@ -2149,6 +2452,28 @@ private:
         return std::make_unique<InputStreamFtp>(login_, afsPath, notifyUnbufferedIO);
     }
 
+    std::vector<HashAlgorithm> getServerHashAlgorithms() const override
+    {
+        std::vector<HashAlgorithm> hashAlgos;
+        try
+        {
+            accessFtpSession(login_, [&](FtpSession& session) { hashAlgos = session.getServerHashAlgorithms(); }); //throw SysError
+        }
+        catch (SysError&) {} //no server hash => connection errors are reported by regular file access
+        return hashAlgos;
+    }
+
+    std::optional<std::string> getServerFileHash(const AfsPath& afsPath, HashAlgorithm algo) const override
+    {
+        std::optional<std::string> hash;
+        try
+        {
+            accessFtpSession(login_, [&](FtpSession& session) { hash = session.getServerFileHash(afsPath, algo); }); //throw SysError
+        }
+        catch (SysError&) { return {}; } //e.g. "550 Permission denied" => let regular file access report errors
+        return hash;
+    }
+
     //already existing: undefined behavior! (e.g. fail/overwrite/auto-rename)
     //=> actual behavior: fail(+delete!)/overwrite/auto-rename
     std::unique_ptr<OutputStreamImpl> getOutputStream(const AfsPath& afsPath, //throw FileError
@@ -2174,14 +2499,15 @@ private:
     //symlink handling: follow
     //already existing: undefined behavior! (e.g. fail/overwrite/auto-rename)
     FileCopyResult copyFileForSameAfsType(const AfsPath& afsSource, const StreamAttributes& attrSource, //throw FileError, (ErrorFileLocked), X
-                                          const AbstractPath& apTarget, bool copyFilePermissions, const IoCallback& notifyUnbufferedIO /*throw X*/) const override
+                                          const AbstractPath& apTarget, bool copyFilePermissions, const IoCallback& notifyUnbufferedIO /*throw X*/,
+                                          std::optional<HashAlgorithm> sourceHashAlgo) const override
     {
         //no native FTP file copy => use stream-based file copy:
         if (copyFilePermissions)
             throw FileError(replaceCpy(_("Cannot write permissions of %x."), L"%x", fmtPath(AFS::getDisplayPath(apTarget))), _("Operation not supported by device."));
 
         //already existing: undefined behavior! (e.g. fail/overwrite/auto-rename)
-        return copyFileAsStream(afsSource, attrSource, apTarget, notifyUnbufferedIO); //throw FileError, (ErrorFileLocked), X
+        return copyFileAsStream(afsSource, attrSource, apTarget, notifyUnbufferedIO, sourceHashAlgo); //throw FileError, (ErrorFileLocked), X
     }
 
     //symlink handling: follow
@@ -2249,6 +2575,8 @@ private:
 
     void authenticateAccess(bool allowUserInteraction) const override {} //throw FileError
 
+    void prewarmConnections(size_t parallelOps) const override {} //throw FileError
+
     int getAccessTimeout() const override { return login_.timeoutSec; } //returns "0" if no timeout in force
 
     bool hasNativeTransactionalCopy() const override { return false; }
@@ -2297,6 +2625,9 @@ Zstring concatenateFtpFolderPathPhrase(const FtpLogin& login, const AfsPath& afs
     if (login.useTls)
         options += Zstr("|ssl");
 
+    if (login.preciseTimes)
+        options += Zstr("|precisetime");
+
     if (!login.password.empty()) //password always last => visually truncated by folder input field
         options += Zstr("|pass64=") + encodePasswordBase64(login.password);
 
@@ -2305,15 +2636,27 @@ Zstring concatenateFtpFolderPathPhrase(const FtpLogin& login, const AfsPath& afs
 }
 
 
-void fff::ftpInit()
+void fff::ftpInit(const Zstring& timeCacheFilePath)
 {
     assert(!globalFtpSessionManager.get());
     globalFtpSessionManager.set(std::make_unique<FtpSessionManager>());
+
+    assert(!globalFtpPreciseTimeCache.get());
+    globalFtpPreciseTimeCache.set(std::make_unique<FtpPreciseTimeCache>(timeCacheFilePath));
 }
 
 
 void fff::ftpTeardown()
 {
+    assert(globalFtpPreciseTimeCache.get());
+    try
+    {
+        if (const std::shared_ptr<FtpPreciseTimeCache> timeCache = globalFtpPreciseTimeCache.get())
+            timeCache->save(); //throw FileError
+    }
+    catch (FileError&) {} //not critical: worst case, MDTM times are fetched once more
+    globalFtpPreciseTimeCache.set(nullptr);
+
     assert(globalFtpSessionManager.get());
     globalFtpSessionManager.set(nullptr);
 }
@@ -2410,6 +2753,8 @@ AbstractPath fff::createItemPathFtp(const Zstring& itemPathPhrase) //noexcept
             login.timeoutSec = stringTo<int>(afterFirst(optPhrase, Zstr("="), IfNotFoundReturn::none));
         else if (optPhrase == Zstr("ssl"))
             login.useTls = true;
+        else if (optPhrase == Zstr("precisetime"))
+            login.preciseTimes = true;
         else if (startsWith(optPhrase, Zstr("pass64=")))
             login.password = decodePasswordBase64(afterFirst(optPhrase, Zstr("="), IfNotFoundReturn::none));
         else
@@ -15,7 +15,7 @@ namespace fff
 bool  acceptsItemPathPhraseFtp(const Zstring& itemPathPhrase); //noexcept
 AbstractPath createItemPathFtp(const Zstring& itemPathPhrase); //noexcept
 
-void ftpInit();
+void ftpInit(const Zstring& timeCacheFilePath);
 void ftpTeardown();
 
 //-------------------------------------------------------
@@ -35,6 +35,7 @@ struct FtpLogin : FtpSessionId
 {
     //other settings not specific to FTP session:
     int timeoutSec = 15;
+    bool preciseTimes = false; //servers without MLSD: get exact modification times via MDTM (cached) instead of relying on imprecise LIST output
 };
 AfsDevice condenseToFtpDevice(const FtpLogin& login); //noexcept; potentially messy user input
 FtpLogin extractFtpLogin(const AfsDevice& afsDevice); //noexcept
@@ -73,18 +73,32 @@ namespace
 //Google Drive REST API Reference: https://developers.google.com/drive/api/v3/reference
 const Zchar* GOOGLE_REST_API_SERVER = Zstr("www.googleapis.com");
 
-constexpr std::chrono::seconds HTTP_SESSION_MAX_IDLE_TIME  (20);
 constexpr std::chrono::seconds HTTP_SESSION_CLEANUP_INTERVAL(4);
 constexpr std::chrono::seconds GDRIVE_SYNC_INTERVAL         (5);
+constexpr std::chrono::seconds GDRIVE_PREFETCH_POLL_INTERVAL(1);
+constexpr std::chrono::seconds GDRIVE_PREFETCH_LEAD         (2); //fetch changes ahead of GDRIVE_SYNC_INTERVAL => foreground access finds them applied
+constexpr std::chrono::seconds GDRIVE_PREFETCH_IDLE_STOP    (60); //no more change polling if the account is not used anymore
+constexpr std::chrono::minutes GDRIVE_DB_SAVE_INTERVAL      (5); //don't lose the buffered file state (=> warm start) if process is killed
 
 const int GDRIVE_STREAM_BUFFER_SIZE = 512 * 1024; //unit: [byte]
 
+const size_t GDRIVE_UPLOAD_CHUNK_SIZE = 8 * 1024 * 1024; //unit: [byte]; "must be a multiple of 256 KiB"; larger files are uploaded in chunks
+const int GDRIVE_UPLOAD_RETRY_MAX = 5; //resume attempts per chunk after transient errors
+const int GDRIVE_RATE_LIMIT_RETRY_MAX = 6; //attempts per request after "userRateLimitExceeded"; backoff: 1, 2, 4, 8, 16, 32 seconds
+
+const uint64_t GDRIVE_RANGED_DOWNLOAD_MIN = 64 * 1024 * 1024; //unit: [byte]; larger files are downloaded in segments via parallel range requests
+const size_t GDRIVE_RANGED_SEGMENT_SIZE   =  8 * 1024 * 1024; //unit: [byte]
+const size_t GDRIVE_RANGED_STREAMS_MAX    = 4; //parallel range requests per file: each holds up to one segment in memory
+
+constexpr size_t GDRIVE_CONCURRENCY_MAX = 64; //requests in flight per user account: upper limit for additive increase
+constexpr std::chrono::seconds GDRIVE_RATE_LIMIT_BACKOFF_MAX(32);
+
 const Zchar gdrivePrefix[] = Zstr("gdrive:");
 const char gdriveFolderMimeType  [] = "application/vnd.google-apps.folder";
 const char gdriveShortcutMimeType[] = "application/vnd.google-apps.shortcut"; //= symbolic link!
 
 const char DB_FILE_DESCR[] = "FreeFileSync";
-const int  DB_FILE_VERSION = 5; //2021-05-15
+const int  DB_FILE_VERSION = 6; //2026-10-14
 
 std::string getGdriveClientId    () { return ""; } // => replace with live credentials
 std::string getGdriveClientSecret() { return ""; } //
@@ -184,8 +198,9 @@ UniInitializer globalInitHttp(*httpSessionCount.get());
 class HttpSessionManager //reuse (healthy) HTTP sessions globally
 {
 public:
-    explicit HttpSessionManager(const Zstring& caCertFilePath) :
+    HttpSessionManager(const Zstring& caCertFilePath, std::chrono::seconds maxIdleTime) :
         caCertFilePath_(caCertFilePath),
+        maxIdleTime_(maxIdleTime),
         sessionCleaner_([this]
     {
         setCurrentThreadName(Zstr("Session Cleaner[HTTP]"));
@@ -210,7 +225,7 @@ public:
 
         //create new HTTP session outside the lock: 1. don't block other threads 2. non-atomic regarding "sessionStore"! => one session too many is not a problem!
         if (!httpSession)
-            httpSession = std::make_unique<HttpInitSession>(getLibsshCurlUnifiedInitCookie(httpSessionCount), login.server, caCertFilePath_); //throw SysError
+            httpSession = std::make_unique<HttpInitSession>(getLibsshCurlUnifiedInitCookie(httpSessionCount), getSessionShare(), login.server, caCertFilePath_); //throw SysError
 
         ZEN_ON_SCOPE_EXIT(
             if (isHealthy(httpSession->session)) //thread that created the "!isHealthy()" session is responsible for clean up (avoid hitting server connection limits!)
@@ -219,20 +234,46 @@ public:
         useHttpSession(httpSession->session); //throw X
     }
 
+    std::chrono::seconds getMaxIdleTime() const { return maxIdleTime_; }
+
 private:
     HttpSessionManager           (const HttpSessionManager&) = delete;
     HttpSessionManager& operator=(const HttpSessionManager&) = delete;
 
     //associate session counting (for initialization/teardown)
+    struct HttpInitShare
+    {
+        explicit HttpInitShare(std::shared_ptr<UniCounterCookie> cook) : cookie(std::move(cook)), share(std::make_shared<HttpSessionShare>()) {}
+
+        std::shared_ptr<UniCounterCookie> cookie;
+        std::shared_ptr<HttpSessionShare> share; //life time must be subset of UniCounterCookie
+    };
+
     struct HttpInitSession
     {
-        HttpInitSession(std::shared_ptr<UniCounterCookie> cook, const Zstring& server, const Zstring& caCertFilePath) :
-            cookie(std::move(cook)), session(server, true /*useTls*/, caCertFilePath) {}
+        HttpInitSession(std::shared_ptr<UniCounterCookie> cook, std::shared_ptr<HttpInitShare> sh, const Zstring& server, const Zstring& caCertFilePath) :
+            cookie(std::move(cook)), initShare(std::move(sh)), session(server, true /*useTls*/, caCertFilePath, initShare->share) {}
 
         std::shared_ptr<UniCounterCookie> cookie;
+        std::shared_ptr<HttpInitShare> initShare;
         HttpSession session; //life time must be subset of UniCounterCookie
     };
-    static bool isHealthy(const HttpSession& s) { return std::chrono::steady_clock::now() - s.getLastUseTime() <= HTTP_SESSION_MAX_IDLE_TIME; }
+    bool isHealthy(const HttpSession& s) const { return std::chrono::steady_clock::now() - s.getLastUseTime() <= maxIdleTime_; }
+
+    //DNS cache, TLS sessions and connections shared by all HTTP sessions (all servers, all logins): released together with the last session
+    std::shared_ptr<HttpInitShare> getSessionShare() //throw SysError
+    {
+        return sessionShare_.access([](std::weak_ptr<HttpInitShare>& weakShare)
+        {
+            std::shared_ptr<HttpInitShare> initShare = weakShare.lock();
+            if (!initShare)
+            {
+                initShare = std::make_shared<HttpInitShare>(getLibsshCurlUnifiedInitCookie(httpSessionCount)); //throw SysError
+                weakShare = initShare;
+            }
+            return initShare;
+        });
+    }
 
     using IdleHttpSessions = std::vector<std::unique_ptr<HttpInitSession>>;
 
@@ -292,7 +333,9 @@ private:
     using GlobalHttpSessions = std::map<HttpSessionId, Protected<IdleHttpSessions>>;
 
     Protected<GlobalHttpSessions> globalSessionStore_;
+    Protected<std::weak_ptr<HttpInitShare>> sessionShare_;
     const Zstring caCertFilePath_;
+    const std::chrono::seconds maxIdleTime_;
     InterruptibleThread sessionCleaner_;
 };
 
@@ -300,12 +343,109 @@ private:
 constinit Global<HttpSessionManager> globalHttpSessionManager; //caveat: life time must be subset of static UniInitializer!
 //--------------------------------------------------------------------------------------
 
+/*  Drive API quota per user: "403 userRateLimitExceeded", "403 rateLimitExceeded", "429 Too Many Requests" => too many requests in flight
+    => AIMD: halve the requests in flight when rate-limited, then add one per window of healthy responses; pause all requests during backoff ("Retry-After")
+    - shared by all threads working for the same user account: see GdriveAccessBuffer
+    - a request occupies its slot until the response headers arrive: long downloads must not hold up the (metadata) requests needed to consume them! */
+class GdriveRateLimiter
+{
+public:
+    void acquire() //throw ThreadStopRequest
+    {
+        std::unique_lock dummy(lockState_);
+        for (;;)
+            if (const auto now = std::chrono::steady_clock::now();
+                now < blockedUntil_)
+            {
+                const auto delay = blockedUntil_ - now;
+                dummy.unlock();
+                interruptibleSleep(delay); //throw ThreadStopRequest
+                dummy.lock();
+            }
+            else if (inFlight_ < window_)
+            {
+                ++inFlight_;
+                return;
+            }
+            else
+                interruptibleWait(conditionSlotFree_, dummy, [this] { return inFlight_ < window_; }); //throw ThreadStopRequest
+    }
+
+    void release(bool rateLimited, std::optional<std::chrono::seconds> retryAfter) //noexcept
+    {
+        {
+            std::lock_guard dummy(lockState_);
+            assert(inFlight_ > 0);
+            const size_t inFlightBefore = inFlight_--;
+            const auto now = std::chrono::steady_clock::now();
+
+            if (rateLimited)
+            {
+                if (now >= blockedUntil_) //decrease once per backoff: requests sent before it are still coming back rate-limited
+                {
+                    window_ = std::max<size_t>(1, std::min(window_, inFlightBefore) / 2);
+                    backoff_ = std::min(std::max(2 * backoff_, std::chrono::seconds(1)), GDRIVE_RATE_LIMIT_BACKOFF_MAX);
+                }
+                healthyCount_ = 0;
+                blockedUntil_ = std::max(blockedUntil_, now + (retryAfter ? *retryAfter : backoff_));
+            }
+            else if (++healthyCount_ >= window_)
+            {
+                healthyCount_ = 0;
+                backoff_ = std::chrono::seconds(0);
+                window_ = std::min(window_ + 1, GDRIVE_CONCURRENCY_MAX);
+            }
+        }
+        conditionSlotFree_.notify_all();
+    }
+
+    size_t getWindow() //current number of concurrent requests deemed sustainable
+    {
+        std::lock_guard dummy(lockState_);
+        return window_;
+    }
+
+private:
+    std::mutex lockState_;
+    std::condition_variable conditionSlotFree_;
+    size_t window_ = GDRIVE_CONCURRENCY_MAX;
+    size_t inFlight_ = 0;
+    size_t healthyCount_ = 0;
+    std::chrono::seconds backoff_{0};
+    std::chrono::steady_clock::time_point blockedUntil_;
+};
+
+
 struct GdriveAccess
 {
     std::string token;
     int timeoutSec = 0;
+    std::shared_ptr<GdriveRateLimiter> rateLimiter; //optional
 };
 
+
+bool isGdriveRateLimitError(int statusCode, const std::string& response)
+{
+    if (statusCode == 429)
+        return true;
+
+    if (statusCode == 403) //same status code as "insufficientPermissions" => check reason
+        try
+        {
+            const JsonValue jresponse = parseJson(response); //throw JsonParsingError
+            if (const JsonValue* error = getChildFromJsonObject(jresponse, "error"))
+                if (const JsonValue* errors = getChildFromJsonObject(*error, "errors"))
+                    if (errors->type == JsonValue::Type::array)
+                        for (const JsonValue& item : errors->arrayVal)
+                            if (const JsonValue* reason = getChildFromJsonObject(item, "reason"))
+                                if (reason->primVal == "userRateLimitExceeded" ||
+                                    reason->primVal == "rateLimitExceeded")
+                                    return true;
+        }
+        catch (JsonParsingError&) {}
+    return false;
+}
+
 //===========================================================================================================================
 
 HttpSession::Result googleHttpsRequest(const Zstring& serverName, const std::string& serverRelPath, //throw SysError, X
@@ -324,6 +464,8 @@ HttpSession::Result googleHttpsRequest(const Zstring& serverName, const std::str
     if (!mgr)
         throw SysError(formatSystemError("googleHttpsRequest", L"", L"Function call not allowed during init/shutdown."));
 
+    extraOptions.emplace_back(CURLOPT_MAXAGE_CONN, mgr->getMaxIdleTime().count()); //pooled connections: same life time as idle sessions
+
     HttpSession::Result httpResult;
 
     mgr->access(HttpSessionId(serverName), [&](HttpSession& session) //throw SysError
@@ -345,14 +487,330 @@ HttpSession::Result gdriveHttpsRequest(const std::string& serverRelPath, //throw
 {
     extraHeaders.push_back("Authorization: Bearer " + access.token);
 
-    return googleHttpsRequest(GOOGLE_REST_API_SERVER, serverRelPath,
-                              extraHeaders,
-                              extraOptions,
-                              writeResponse /*throw X*/,
-                              readRequest   /*throw X*/,
-                              receiveHeader /*throw X*/, access.timeoutSec); //throw SysError, X
+    if (!access.rateLimiter)
+        return googleHttpsRequest(GOOGLE_REST_API_SERVER, serverRelPath,
+                                  extraHeaders,
+                                  extraOptions,
+                                  writeResponse /*throw X*/,
+                                  readRequest   /*throw X*/,
+                                  receiveHeader /*throw X*/, access.timeoutSec); //throw SysError, X
+
+    //retry transparently only if nothing was passed on to the caller yet (and the request body can be sent again)
+    const bool retryable = !readRequest && !receiveHeader;
+
+    for (int retryCount = 0;; ++retryCount)
+    {
+        access.rateLimiter->acquire(); //throw ThreadStopRequest
+
+        int statusCode = 0;
+        bool slotReleased = false;
+        bool holdBackResponse = false; //until we know whether it's rate limiting
+        std::string responseHeld;
+        std::optional<std::chrono::seconds> retryAfter;
+
+        ZEN_ON_SCOPE_EXIT(if (!slotReleased) access.rateLimiter->release(false /*rateLimited*/, std::nullopt));
+
+        auto onHeaderData = [&](const std::string_view& header)
+        {
+            if (startsWith(header, "HTTP/")) //status line: e.g. "HTTP/2 429"; also after "100 Continue"
+                statusCode = stringTo<int>(beforeFirst(afterFirst(header, ' ', IfNotFoundReturn::none), ' ', IfNotFoundReturn::all));
+            else if (startsWithAsciiNoCase(header, "Retry-After:"))
+                retryAfter = std::chrono::seconds(stringTo<int>(afterFirst(header, ':', IfNotFoundReturn::none))); //HTTP-date not used by Google
+            else if ((header == "\r\n" || header == "\n") && statusCode >= 200) //end of (final) response header
+            {
+                holdBackResponse = statusCode == 403 || statusCode == 429;
+                if (!holdBackResponse && !slotReleased)
+                {
+                    slotReleased = true;
+                    access.rateLimiter->release(false /*rateLimited*/, std::nullopt);
+                }
+            }
+
+            if (receiveHeader)
+                receiveHeader(header); //throw X
+        };
+
+        auto onResponseData = [&](std::span<const char> buf)
+        {
+            if (holdBackResponse)
+                responseHeld.append(buf.data(), buf.size());
+            else if (writeResponse)
+                writeResponse(buf); //throw X
+        };
+
+        const HttpSession::Result httpResult = googleHttpsRequest(GOOGLE_REST_API_SERVER, serverRelPath, //throw SysError, X
+                                                                  extraHeaders,
+                                                                  extraOptions,
+                                                                  onResponseData, readRequest, onHeaderData, access.timeoutSec);
+        if (holdBackResponse)
+        {
+            const bool rateLimited = isGdriveRateLimitError(httpResult.statusCode, responseHeld);
+            if (!slotReleased)
+            {
+                slotReleased = true;
+                access.rateLimiter->release(rateLimited, retryAfter);
+            }
+            if (rateLimited && retryable && retryCount + 1 < GDRIVE_RATE_LIMIT_RETRY_MAX)
+                continue; //acquire() waits for the backoff
+
+            if (writeResponse && !responseHeld.empty())
+                writeResponse(responseHeld); //throw X
+        }
+        return httpResult;
+    }
+}
+
+//========================================================================================================
+
+//coalesce independent metadata requests of concurrent threads into a single HTTP round trip: https://developers.google.com/drive/api/v3/batch
+//=> e.g. parallel deletion of many items: one request per item means one round trip per item!
+struct GdriveBatchRequest
+{
+    std::string method; //e.g. "DELETE", "PATCH", "POST"
+    std::string serverRelPath;
+    std::string jsonBody; //optional
+};
+
+struct GdriveBatchResponse
+{
+    int statusCode = 0;
+    std::string body;
+};
+
+constexpr size_t GDRIVE_BATCH_SIZE_MAX = 100; //"You're limited to 100 calls in a single batch request."
+
+
+GdriveBatchResponse gdriveHttpsRequestSingle(const GdriveBatchRequest& request, const GdriveAccess& access) //throw SysError
+{
+    std::vector<std::string> extraHeaders;
+    std::vector<CurlOption> extraOptions;
+    if (request.method != "POST") //POST is implied by CURLOPT_POSTFIELDS
+        extraOptions.emplace_back(CURLOPT_CUSTOMREQUEST, request.method.c_str());
+    if (!request.jsonBody.empty())
+    {
+        extraHeaders.push_back("Content-Type: application/json; charset=UTF-8");
+        extraOptions.emplace_back(CURLOPT_POSTFIELDS, request.jsonBody.c_str());
+    }
+
+    GdriveBatchResponse response;
+    response.statusCode = gdriveHttpsRequest(request.serverRelPath, extraHeaders, extraOptions,
+    [&](std::span<const char> buf) { response.body.append(buf.data(), buf.size()); },
+    nullptr /*readRequest*/, nullptr /*receiveHeader*/, access).statusCode; //throw SysError
+    return response;
+}
+
+
+//find end of a header block: returns position after the empty line, or npos
+size_t findHeaderEnd(const std::string_view& msg)
+{
+    for (const std::string_view separator : {"\r\n\r\n", "\n\n"})
+        if (const size_t pos = msg.find(separator);
+            pos != std::string_view::npos)
+            return pos + separator.size();
+    return std::string_view::npos;
+}
+
+
+//empty return value for items missing in the response
+std::vector<std::optional<GdriveBatchResponse>> gdriveHttpsRequestBatch(const std::vector<GdriveBatchRequest>& requests, const GdriveAccess& access) //throw SysError
+{
+    assert(!requests.empty() && requests.size() <= GDRIVE_BATCH_SIZE_MAX);
+    const std::string boundary = "batch_" + formatAsHexString(generateGUID());
+
+    std::string postBuf;
+    for (size_t i = 0; i < requests.size(); ++i)
+    {
+        const GdriveBatchRequest& req = requests[i];
+        postBuf += "--" + boundary + "\r\n"
+                   "Content-Type: application/http\r\n"
+                   "Content-ID: <item" + numberTo<std::string>(i) + ">\r\n"
+                   "\r\n" +
+                   req.method + ' ' + req.serverRelPath + " HTTP/1.1\r\n";
+        if (!req.jsonBody.empty())
+            postBuf += "Content-Type: application/json; charset=UTF-8\r\n"
+                       "\r\n" + req.jsonBody + "\r\n";
+        else
+            postBuf += "\r\n";
+    }
+    postBuf += "--" + boundary + "--\r\n";
+
+    std::string responseBoundary;
+    auto onHeaderData = [&](const std::string_view& header)
+    {
+        //"Content-Type: multipart/mixed; boundary=batch_xyz"
+        if (startsWithAsciiNoCase(header, "Content-Type:"))
+        {
+            responseBoundary = afterFirst(header, "boundary=", IfNotFoundReturn::none);
+            trim(responseBoundary);
+            trim(responseBoundary, true, true, [](char c) { return c == '"'; });
+        }
+    };
+
+    std::string response;
+    gdriveHttpsRequest("/batch/drive/v3", {"Content-Type: multipart/mixed; boundary=" + boundary}, {{CURLOPT_POSTFIELDS, postBuf.c_str()}},
+    [&](std::span<const char> buf) { response.append(buf.data(), buf.size()); }, nullptr /*readRequest*/, onHeaderData, access); //throw SysError
+
+    if (responseBoundary.empty())
+        throw SysError(formatGdriveErrorRaw(response)); //e.g. batch request itself failed: 401 Unauthorized
+
+    std::vector<std::optional<GdriveBatchResponse>> responses(requests.size());
+
+    const std::string delimiter = "--" + responseBoundary;
+    for (size_t pos = response.find(delimiter); pos != std::string::npos;)
+    {
+        const size_t partBegin = pos + delimiter.size();
+        if (response.compare(partBegin, 2, "--") == 0) //close-delimiter
+            break;
+
+        pos = response.find(delimiter, partBegin);
+        const std::string_view part = std::string_view(response).substr(partBegin, pos == std::string::npos ? std::string::npos : pos - partBegin);
+
+        //MIME part headers:
+        const size_t mimeHeaderEnd = findHeaderEnd(part);
+        if (mimeHeaderEnd == std::string_view::npos)
+            continue;
+        const std::string_view mimeHeaders = part.substr(0, mimeHeaderEnd);
+
+        //"Content-ID: <response-item3>"
+        const std::string_view contentId = beforeFirst(afterFirst(mimeHeaders, "response-item", IfNotFoundReturn::none), '>', IfNotFoundReturn::none);
+        if (contentId.empty())
+            continue;
+        const size_t itemIdx = stringTo<size_t>(contentId);
+        if (itemIdx >= responses.size())
+            continue;
+
+        //embedded HTTP response: "HTTP/1.1 204 No Content" + headers + body
+        const std::string_view httpMsg = part.substr(mimeHeaderEnd);
+        const size_t httpHeaderEnd = findHeaderEnd(httpMsg);
+        if (!startsWith(httpMsg, "HTTP/") || httpHeaderEnd == std::string_view::npos)
+            continue;
+
+        GdriveBatchResponse& itemResponse = responses[itemIdx].emplace();
+        itemResponse.statusCode = stringTo<int>(beforeFirst(afterFirst(httpMsg, ' ', IfNotFoundReturn::none), ' ', IfNotFoundReturn::all));
+        itemResponse.body = httpMsg.substr(httpHeaderEnd);
+        trim(itemResponse.body, false, true, [](char c) { return c == '\r' || c == '\n'; });
+    }
+    return responses;
 }
 
+
+class GdriveRequestBatcher
+{
+public:
+    GdriveRequestBatcher() {}
+
+    //- no extra latency: the first request is sent immediately; only requests arriving while a round trip is still in progress are batched
+    //- requests with different access tokens (= users) are never mixed
+    GdriveBatchResponse perform(const GdriveBatchRequest& request, const GdriveAccess& access) //throw SysError
+    {
+        const auto item = std::make_shared<PendingRequest>(request, access);
+
+        std::unique_lock dummy(lockQueue_);
+        queue_.push_back(item);
+
+        for (;;)
+        {
+            if (item->done)
+            {
+                if (item->error)
+                    std::rethrow_exception(item->error); //throw SysError
+                return std::move(*item->response);
+            }
+
+            if (!tokensInProgress_.contains(access.token)) //=> take the lead and send the next batch for this user
+            {
+                tokensInProgress_.insert(access.token);
+
+                std::vector<std::shared_ptr<PendingRequest>> batch;
+                std::erase_if(queue_, [&](const std::shared_ptr<PendingRequest>& pending)
+                {
+                    if (batch.size() >= GDRIVE_BATCH_SIZE_MAX || pending->access.token != access.token)
+                        return false;
+                    batch.push_back(pending);
+                    return true;
+                });
+                dummy.unlock();
+
+                runBatch(batch, access); //noexcept
+
+                dummy.lock();
+                tokensInProgress_.erase(access.token);
+                for (const std::shared_ptr<PendingRequest>& pending : batch)
+                    pending->done = true;
+                conditionBatchDone_.notify_all();
+            }
+            else
+                conditionBatchDone_.wait(dummy);
+        }
+    }
+
+private:
+    GdriveRequestBatcher           (const GdriveRequestBatcher&) = delete;
+    GdriveRequestBatcher& operator=(const GdriveRequestBatcher&) = delete;
+
+    struct PendingRequest
+    {
+        PendingRequest(const GdriveBatchRequest& req, const GdriveAccess& acc) : request(req), access(acc) {}
+
+        const GdriveBatchRequest request;
+        const GdriveAccess access;
+
+        bool done = false; //protected by lockQueue_
+        std::optional<GdriveBatchResponse> response;
+        std::exception_ptr error;
+    };
+
+    static void runBatch(const std::vector<std::shared_ptr<PendingRequest>>& batch, const GdriveAccess& access) //noexcept
+    {
+        try
+        {
+            if (batch.size() == 1) //don't bother with batch overhead
+                batch[0]->response = gdriveHttpsRequestSingle(batch[0]->request, access); //throw SysError
+            else
+            {
+                std::vector<GdriveBatchRequest> requests;
+                for (const std::shared_ptr<PendingRequest>& pending : batch)
+                    requests.push_back(pending->request);
+
+                std::vector<std::optional<GdriveBatchResponse>> responses = gdriveHttpsRequestBatch(requests, access); //throw SysError
+
+                for (size_t i = 0; i < batch.size(); ++i)
+                    if (responses[i])
+                        batch[i]->response = std::move(responses[i]);
+                    else
+                        try { throw SysError(formatSystemError("gdriveHttpsRequestBatch", L"", L"Server response is incomplete.")); }
+                        catch (SysError&) { batch[i]->error = std::current_exception(); }
+            }
+        }
+        catch (...) //demultiplex error of the batch request itself
+        {
+            for (const std::shared_ptr<PendingRequest>& pending : batch)
+                if (!pending->response)
+                    pending->error = std::current_exception();
+        }
+    }
+
+    std::mutex lockQueue_;
+    std::vector<std::shared_ptr<PendingRequest>> queue_;
+    std::unordered_set<std::string> tokensInProgress_;
+    std::condition_variable conditionBatchDone_;
+};
+
+//--------------------------------------------------------------------------------------
+constinit Global<GdriveRequestBatcher> globalGdriveRequestBatcher;
+//--------------------------------------------------------------------------------------
+
+//metadata operations without dependency on other in-flight requests => may be sent as part of a batch
+GdriveBatchResponse gdriveHttpsRequestBatchable(const GdriveBatchRequest& request, const GdriveAccess& access) //throw SysError
+{
+    const std::shared_ptr<GdriveRequestBatcher> batcher = globalGdriveRequestBatcher.get();
+    if (!batcher)
+        throw SysError(formatSystemError("gdriveHttpsRequestBatchable", L"", L"Function call not allowed during init/shutdown."));
+
+    return batcher->perform(request, access); //throw SysError
+}
+
+
 //========================================================================================================
 
 struct GdriveUser
@@ -909,67 +1367,133 @@ struct GdriveItemDetails
     FileOwner owner = FileOwner::none;
     //------------------------
     std::string targetId; //for GdriveItemType::shortcut: https://developers.google.com/drive/api/v3/shortcuts
+    std::string md5; //GdriveItemType::file: hex string of content hash; empty for Google Docs (and files uploaded before next sync with Google)
     std::vector<std::string> parentIds;
 
     bool operator==(const GdriveItemDetails&) const = default;
 };
 
 
-GdriveItemDetails extractItemDetails(const JsonValue& jvalue) //throw SysError
+//large listings: parse JSON with JsonReader => don't build a JsonValue tree for 1000 items per page
+std::optional<std::string> readPrimitiveOrSkip(JsonReader& reader) //throw JsonParsingError
 {
-    assert(jvalue.type == JsonValue::Type::object);
+    if (const JsonValue::Type type = reader.peekType(); //throw JsonParsingError
+        type == JsonValue::Type::object ||
+        type == JsonValue::Type::array)
+    {
+        reader.skipValue(); //throw JsonParsingError
+        return std::nullopt;
+    }
+    return reader.readPrimitive(); //throw JsonParsingError
+}
+
 
-    /**/  std::optional<std::string> itemName     = getPrimitiveFromJsonObject(jvalue, "name");
-    const std::optional<std::string> mimeType     = getPrimitiveFromJsonObject(jvalue, "mimeType");
-    const std::optional<std::string> ownedByMe    = getPrimitiveFromJsonObject(jvalue, "ownedByMe");
-    const std::optional<std::string> size         = getPrimitiveFromJsonObject(jvalue, "size");
-    const std::optional<std::string> modifiedTime = getPrimitiveFromJsonObject(jvalue, "modifiedTime");
-    const JsonValue*                 parents      = getChildFromJsonObject    (jvalue, "parents");
-    const JsonValue*                 shortcut     = getChildFromJsonObject    (jvalue, "shortcutDetails");
+struct GdriveItemJson //"files" resource: https://developers.google.com/drive/api/v3/reference/files
+{
+    std::optional<std::string> id;
+    std::optional<std::string> trashed;
+    std::optional<std::string> name;
+    std::optional<std::string> mimeType;
+    std::optional<std::string> ownedByMe;
+    std::optional<std::string> size;
+    std::optional<std::string> modifiedTime;
+    std::optional<std::string> md5Checksum; //only for binary files
+    std::vector<std::string> parentIds;
+    bool parentsValid = true;
+    bool hasShortcut = false;
+    std::optional<std::string> shortcutTargetId;
+};
 
-    if (!itemName || itemName->empty() || !mimeType || !modifiedTime)
-        throw SysError(formatGdriveErrorRaw(serializeJson(jvalue)));
 
-    const GdriveItemType type = *mimeType == gdriveFolderMimeType   ? GdriveItemType::folder :
-                                *mimeType == gdriveShortcutMimeType ? GdriveItemType::shortcut :
+GdriveItemJson readItemJson(JsonReader& reader) //throw JsonParsingError
+{
+    GdriveItemJson item;
+    reader.readObject([&](const std::string& name) //throw JsonParsingError
+    {
+        /**/ if (name == "id"          ) item.id           = readPrimitiveOrSkip(reader); //throw JsonParsingError
+        else if (name == "trashed"     ) item.trashed      = readPrimitiveOrSkip(reader); //
+        else if (name == "name"        ) item.name         = readPrimitiveOrSkip(reader); //
+        else if (name == "mimeType"    ) item.mimeType     = readPrimitiveOrSkip(reader); //
+        else if (name == "ownedByMe"   ) item.ownedByMe    = readPrimitiveOrSkip(reader); //
+        else if (name == "size"        ) item.size         = readPrimitiveOrSkip(reader); //
+        else if (name == "modifiedTime") item.modifiedTime = readPrimitiveOrSkip(reader); //
+        else if (name == "md5Checksum" ) item.md5Checksum  = readPrimitiveOrSkip(reader); //
+        else if (name == "parents")
+        {
+            if (reader.peekType() == JsonValue::Type::array) //throw JsonParsingError
+                reader.readArray([&]
+                {
+                    if (reader.peekType() == JsonValue::Type::string)
+                        item.parentIds.push_back(*reader.readPrimitive()); //throw JsonParsingError
+                    else
+                    {
+                        item.parentsValid = false;
+                        reader.skipValue(); //throw JsonParsingError
+                    }
+                });
+            else
+                reader.skipValue(); //throw JsonParsingError
+        }
+        else if (name == "shortcutDetails")
+        {
+            item.hasShortcut = true;
+            if (reader.peekType() == JsonValue::Type::object) //throw JsonParsingError
+                reader.readObject([&](const std::string& name2)
+                {
+                    if (name2 == "targetId")
+                        item.shortcutTargetId = readPrimitiveOrSkip(reader); //throw JsonParsingError
+                    else
+                        reader.skipValue(); //throw JsonParsingError
+                });
+            else
+                reader.skipValue(); //throw JsonParsingError
+        }
+        else
+            reader.skipValue(); //throw JsonParsingError
+    });
+    return item;
+}
+
+
+GdriveItemDetails extractItemDetails(GdriveItemJson& item, std::string_view itemJson /*for error messages*/) //throw SysError
+{
+    if (!item.name || item.name->empty() || !item.mimeType || !item.modifiedTime)
+        throw SysError(formatGdriveErrorRaw(std::string(itemJson)));
+
+    const GdriveItemType type = *item.mimeType == gdriveFolderMimeType   ? GdriveItemType::folder :
+                                *item.mimeType == gdriveShortcutMimeType ? GdriveItemType::shortcut :
                                 GdriveItemType::file;
 
-    const FileOwner owner = ownedByMe ? (*ownedByMe == "true" ? FileOwner::me : FileOwner::other) : FileOwner::none; //"Not populated for items in Shared Drives"
-    const uint64_t fileSize = size ? stringTo<uint64_t>(*size) : 0; //not available for folders and shortcuts
+    const FileOwner owner = item.ownedByMe ? (*item.ownedByMe == "true" ? FileOwner::me : FileOwner::other) : FileOwner::none; //"Not populated for items in Shared Drives"
+    const uint64_t fileSize = item.size ? stringTo<uint64_t>(*item.size) : 0; //not available for folders and shortcuts
 
     //RFC 3339 date-time: e.g. "2018-09-29T08:39:12.053Z"
-    const TimeComp tc = parseTime("%Y-%m-%dT%H:%M:%S", beforeLast(*modifiedTime, '.', IfNotFoundReturn::all));
-    if (tc == TimeComp() || !endsWith(*modifiedTime, 'Z')) //'Z' means "UTC" => it seems Google doesn't use the time-zone offset postfix
-        throw SysError(L"Modification time could not be parsed. (" + utfTo<std::wstring>(*modifiedTime) + L')');
+    const TimeComp tc = parseTime("%Y-%m-%dT%H:%M:%S", beforeLast(*item.modifiedTime, '.', IfNotFoundReturn::all));
+    if (tc == TimeComp() || !endsWith(*item.modifiedTime, 'Z')) //'Z' means "UTC" => it seems Google doesn't use the time-zone offset postfix
+        throw SysError(L"Modification time could not be parsed. (" + utfTo<std::wstring>(*item.modifiedTime) + L')');
 
     const auto [modTime, timeValid] = utcToTimeT(tc);
     if (!timeValid)
-        throw SysError(L"Modification time could not be parsed. (" + utfTo<std::wstring>(*modifiedTime) + L')');
+        throw SysError(L"Modification time could not be parsed. (" + utfTo<std::wstring>(*item.modifiedTime) + L')');
 
-    std::vector<std::string> parentIds;
-    if (parents) //item without "parents" array is possible! e.g. 1. shared item located in "Shared with me", referenced via a Shortcut 2. root folder under "Computers"
-        for (const JsonValue& parentVal : parents->arrayVal)
-        {
-            if (parentVal.type != JsonValue::Type::string)
-                throw SysError(formatGdriveErrorRaw(serializeJson(jvalue)));
-            parentIds.emplace_back(parentVal.primVal);
-        }
+    //item without "parents" array is possible! e.g. 1. shared item located in "Shared with me", referenced via a Shortcut 2. root folder under "Computers"
+    if (!item.parentsValid)
+        throw SysError(formatGdriveErrorRaw(std::string(itemJson)));
 
-    if (!!shortcut != (type == GdriveItemType::shortcut))
-        throw SysError(formatGdriveErrorRaw(serializeJson(jvalue)));
+    if (item.hasShortcut != (type == GdriveItemType::shortcut))
+        throw SysError(formatGdriveErrorRaw(std::string(itemJson)));
 
     std::string targetId;
-    if (shortcut)
+    if (item.hasShortcut)
     {
-        std::optional<std::string> targetItemId = getPrimitiveFromJsonObject(*shortcut, "targetId");
-        if (!targetItemId || targetItemId->empty())
-            throw SysError(formatGdriveErrorRaw(serializeJson(jvalue)));
+        if (!item.shortcutTargetId || item.shortcutTargetId->empty())
+            throw SysError(formatGdriveErrorRaw(std::string(itemJson)));
 
-        targetId = std::move(*targetItemId);
+        targetId = std::move(*item.shortcutTargetId);
         //evaluate "targetMimeType" ? don't bother: "The MIME type of a shortcut can become stale"!
     }
 
-    return {utfTo<Zstring>(*itemName), fileSize, modTime, type, owner, std::move(targetId), std::move(parentIds)};
+    return {utfTo<Zstring>(*item.name), fileSize, modTime, type, owner, std::move(targetId), item.md5Checksum ? std::move(*item.md5Checksum) : std::string(), std::move(item.parentIds)};
 }
 
 
@@ -978,27 +1502,29 @@ GdriveItemDetails getItemDetails(const std::string& itemId, const GdriveAccess&
     //https://developers.google.com/drive/api/v3/reference/files/get
     const std::string& queryParams = xWwwFormUrlEncode(
     {
-        {"fields", "trashed,name,mimeType,ownedByMe,size,modifiedTime,parents,shortcutDetails(targetId)"},
+        {"fields", "trashed,name,mimeType,ownedByMe,size,modifiedTime,md5Checksum,parents,shortcutDetails(targetId)"},
         {"supportsAllDrives", "true"},
     });
     std::string response;
     gdriveHttpsRequest("/drive/v3/files/" + itemId + '?' + queryParams, {} /*extraHeaders*/, {} /*extraOptions*/,
     [&](std::span<const char> buf) { response.append(buf.data(), buf.size()); },
     nullptr /*readRequest*/, nullptr /*receiveHeader*/, access); //throw SysError
+    GdriveItemJson item;
     try
     {
-        const JsonValue jvalue = parseJson(response); //throw JsonParsingError
-
-        //careful: do NOT return details about trashed items! they don't exist as far as FFS is concerned!!!
-        const std::optional<std::string> trashed = getPrimitiveFromJsonObject(jvalue, "trashed");
-        if (!trashed)
-            throw SysError(formatGdriveErrorRaw(response));
-        else if (*trashed == "true")
-            throw SysError(L"Item has been trashed.");
-
-        return extractItemDetails(jvalue); //throw SysError
+        JsonReader reader(response); //throw JsonParsingError
+        item = readItemJson(reader); //
+        reader.expectEnd();          //
     }
     catch (JsonParsingError&) { throw SysError(formatGdriveErrorRaw(response)); }
+
+    //careful: do NOT return details about trashed items! they don't exist as far as FFS is concerned!!!
+    if (!item.trashed)
+        throw SysError(formatGdriveErrorRaw(response));
+    else if (*item.trashed == "true")
+        throw SysError(L"Item has been trashed.");
+
+    return extractItemDetails(item, response); //throw SysError
 }
 
 
@@ -1023,7 +1549,7 @@ std::vector<GdriveItem> readFolderContent(const std::string& folderId, const Gdr
                 {"q", "not trashed and '" + folderId + "' in parents"},
                 {"spaces", "drive"},
                 {"supportsAllDrives", "true"},
-                {"fields", "nextPageToken,incompleteSearch,files(id,name,mimeType,ownedByMe,size,modifiedTime,parents,shortcutDetails(targetId))"}, //https://developers.google.com/drive/api/v3/reference/files
+                {"fields", "nextPageToken,incompleteSearch,files(id,name,mimeType,ownedByMe,size,modifiedTime,md5Checksum,parents,shortcutDetails(targetId))"}, //https://developers.google.com/drive/api/v3/reference/files
             });
             if (nextPageToken)
                 queryParams += '&' + xWwwFormUrlEncode({{"pageToken", *nextPageToken}});
@@ -1033,27 +1559,43 @@ std::vector<GdriveItem> readFolderContent(const std::string& folderId, const Gdr
             [&](std::span<const char> buf) { response.append(buf.data(), buf.size()); },
             nullptr /*readRequest*/, nullptr /*receiveHeader*/, access); //throw SysError
 
-            JsonValue jresponse;
-            try { jresponse = parseJson(response); }
-            catch (JsonParsingError&) {}
-
-            /**/                             nextPageToken    = getPrimitiveFromJsonObject(jresponse, "nextPageToken");
-            const std::optional<std::string> incompleteSearch = getPrimitiveFromJsonObject(jresponse, "incompleteSearch");
-            const JsonValue*                 files            = getChildFromJsonObject    (jresponse, "files");
-            if (!incompleteSearch || *incompleteSearch != "false" || !files || files->type != JsonValue::Type::array)
-                throw SysError(formatGdriveErrorRaw(response));
-
-            for (const JsonValue& childVal : files->arrayVal)
+            nextPageToken = std::nullopt;
+            std::optional<std::string> incompleteSearch;
+            bool filesFound = false;
+            try
             {
-                std::optional<std::string> itemId = getPrimitiveFromJsonObject(childVal, "id");
-                if (!itemId || itemId->empty())
-                    throw SysError(formatGdriveErrorRaw(serializeJson(childVal)));
+                JsonReader reader(response); //throw JsonParsingError
+                reader.readObject([&](const std::string& name) //throw JsonParsingError, SysError
+                {
+                    /**/ if (name == "nextPageToken"   ) nextPageToken    = readPrimitiveOrSkip(reader); //throw JsonParsingError
+                    else if (name == "incompleteSearch") incompleteSearch = readPrimitiveOrSkip(reader); //
+                    else if (name == "files")
+                    {
+                        filesFound = true;
+                        reader.readArray([&] //throw JsonParsingError, SysError
+                        {
+                            const size_t posItemBegin = reader.posValueBegin();
+                            GdriveItemJson item = readItemJson(reader); //throw JsonParsingError
+                            const std::string_view itemJson = std::string_view(response).substr(posItemBegin, reader.posValueEnd() - posItemBegin);
+
+                            if (!item.id || item.id->empty())
+                                throw SysError(formatGdriveErrorRaw(std::string(itemJson)));
 
-                GdriveItemDetails itemDetails(extractItemDetails(childVal)); //throw SysError
-                assert(std::find(itemDetails.parentIds.begin(), itemDetails.parentIds.end(), folderId) != itemDetails.parentIds.end());
+                            GdriveItemDetails itemDetails(extractItemDetails(item, itemJson)); //throw SysError
+                            assert(std::find(itemDetails.parentIds.begin(), itemDetails.parentIds.end(), folderId) != itemDetails.parentIds.end());
 
-                childItems.push_back({std::move(*itemId), std::move(itemDetails)});
+                            childItems.push_back({std::move(*item.id), std::move(itemDetails)});
+                        });
+                    }
+                    else
+                        reader.skipValue(); //throw JsonParsingError
+                });
+                reader.expectEnd(); //throw JsonParsingError
             }
+            catch (JsonParsingError&) { throw SysError(formatGdriveErrorRaw(response)); }
+
+            if (!incompleteSearch || *incompleteSearch != "false" || !filesFound)
+                throw SysError(formatGdriveErrorRaw(response));
         }
         while (nextPageToken);
     }
@@ -1061,6 +1603,49 @@ std::vector<GdriveItem> readFolderContent(const std::string& folderId, const Gdr
 }
 
 
+struct GdriveChangeJson //"changes" resource: https://developers.google.com/drive/api/v3/reference/changes
+{
+    std::optional<std::string> kind;
+    std::optional<std::string> changeType;
+    std::optional<std::string> removed;
+    std::optional<std::string> fileId;
+    std::optional<GdriveItemJson> file;
+    std::optional<std::string> driveId;
+    bool hasDrive = false;
+    std::optional<std::string> driveName;
+};
+
+
+GdriveChangeJson readChangeJson(JsonReader& reader) //throw JsonParsingError
+{
+    GdriveChangeJson chg;
+    reader.readObject([&](const std::string& name) //throw JsonParsingError
+    {
+        /**/ if (name == "kind"      ) chg.kind       = readPrimitiveOrSkip(reader); //throw JsonParsingError
+        else if (name == "changeType") chg.changeType = readPrimitiveOrSkip(reader); //
+        else if (name == "removed"   ) chg.removed    = readPrimitiveOrSkip(reader); //
+        else if (name == "fileId"    ) chg.fileId     = readPrimitiveOrSkip(reader); //
+        else if (name == "driveId"   ) chg.driveId    = readPrimitiveOrSkip(reader); //
+        else if (name == "file" && reader.peekType() == JsonValue::Type::object)
+            chg.file = readItemJson(reader); //throw JsonParsingError
+        else if (name == "drive" && reader.peekType() == JsonValue::Type::object)
+        {
+            chg.hasDrive = true;
+            reader.readObject([&](const std::string& name2)
+            {
+                if (name2 == "name")
+                    chg.driveName = readPrimitiveOrSkip(reader); //throw JsonParsingError
+                else
+                    reader.skipValue(); //throw JsonParsingError
+            });
+        }
+        else
+            reader.skipValue(); //throw JsonParsingError
+    });
+    return chg;
+}
+
+
 struct FileChange
 {
     std::string itemId;
@@ -1087,7 +1672,7 @@ ChangesDelta getChangesDelta(const std::string& sharedDriveId /*empty for "My Dr
         std::string queryParams = xWwwFormUrlEncode(
         {
             {"pageToken", *nextPageToken},
-            {"fields", "kind,nextPageToken,newStartPageToken,changes(kind,changeType,removed,fileId,file(trashed,name,mimeType,ownedByMe,size,modifiedTime,parents,shortcutDetails(targetId)),driveId,drive(name))"},
+            {"fields", "kind,nextPageToken,newStartPageToken,changes(kind,changeType,removed,fileId,file(trashed,name,mimeType,ownedByMe,size,modifiedTime,md5Checksum,parents,shortcutDetails(targetId)),driveId,drive(name))"},
             {"includeItemsFromAllDrives", "true"}, //semantics are a mess https://developers.google.com/drive/api/v3/enable-shareddrives https://freefilesync.org/forum/viewtopic.php?t=7827&start=30#p29712
             //in short: if driveId is set: required, but blatant lie; only drive-specific file changes returned
             //          if no driveId set: optional, but blatant lie; only changes to drive objects are returned, but not contained files (with a few exceptions)
@@ -1104,75 +1689,83 @@ ChangesDelta getChangesDelta(const std::string& sharedDriveId /*empty for "My Dr
         [&](std::span<const char> buf) { response.append(buf.data(), buf.size()); },
         nullptr /*readRequest*/, nullptr /*receiveHeader*/, access); //throw SysError
 
-        JsonValue jresponse;
-        try { jresponse = parseJson(response); }
-        catch (JsonParsingError&) {}
-
-        /**/                             nextPageToken     = getPrimitiveFromJsonObject(jresponse, "nextPageToken");
-        const std::optional<std::string> newStartPageToken = getPrimitiveFromJsonObject(jresponse, "newStartPageToken");
-        const std::optional<std::string> listKind          = getPrimitiveFromJsonObject(jresponse, "kind");
-        const JsonValue*                 changes           = getChildFromJsonObject    (jresponse, "changes");
-
-        if (!!nextPageToken == !!newStartPageToken || //there can be only one
-            !listKind || *listKind != "drive#changeList" ||
-            !changes || changes->type != JsonValue::Type::array)
-            throw SysError(formatGdriveErrorRaw(response));
-
-        for (const JsonValue& childVal : changes->arrayVal)
+        nextPageToken = std::nullopt;
+        std::optional<std::string> newStartPageToken;
+        std::optional<std::string> listKind;
+        bool changesFound = false;
+        try
         {
-            const std::optional<std::string> kind       = getPrimitiveFromJsonObject(childVal, "kind");
-            const std::optional<std::string> changeType = getPrimitiveFromJsonObject(childVal, "changeType");
-            const std::optional<std::string> removed    = getPrimitiveFromJsonObject(childVal, "removed");
-            if (!kind || *kind != "drive#change" || !changeType || !removed)
-                throw SysError(formatGdriveErrorRaw(serializeJson(childVal)));
-
-            if (*changeType == "file")
+            JsonReader reader(response); //throw JsonParsingError
+            reader.readObject([&](const std::string& name) //throw JsonParsingError, SysError
             {
-                std::optional<std::string> fileId = getPrimitiveFromJsonObject(childVal, "fileId");
-                if (!fileId || fileId->empty())
-                    throw SysError(formatGdriveErrorRaw(serializeJson(childVal)));
-
-                FileChange change;
-                change.itemId = std::move(*fileId);
-                if (*removed != "true")
+                /**/ if (name == "nextPageToken"    ) nextPageToken     = readPrimitiveOrSkip(reader); //throw JsonParsingError
+                else if (name == "newStartPageToken") newStartPageToken = readPrimitiveOrSkip(reader); //
+                else if (name == "kind"             ) listKind          = readPrimitiveOrSkip(reader); //
+                else if (name == "changes")
                 {
-                    const JsonValue* file = getChildFromJsonObject(childVal, "file");
-                    if (!file)
-                        throw SysError(formatGdriveErrorRaw(serializeJson(childVal)));
+                    changesFound = true;
+                    reader.readArray([&] //throw JsonParsingError, SysError
+                    {
+                        const size_t posChangeBegin = reader.posValueBegin();
+                        GdriveChangeJson chg = readChangeJson(reader); //throw JsonParsingError
+                        const std::string_view changeJson = std::string_view(response).substr(posChangeBegin, reader.posValueEnd() - posChangeBegin);
 
-                    const std::optional<std::string> trashed = getPrimitiveFromJsonObject(*file, "trashed");
-                    if (!trashed)
-                        throw SysError(formatGdriveErrorRaw(serializeJson(childVal)));
+                        if (!chg.kind || *chg.kind != "drive#change" || !chg.changeType || !chg.removed)
+                            throw SysError(formatGdriveErrorRaw(std::string(changeJson)));
 
-                    if (*trashed != "true")
-                        change.details = extractItemDetails(*file); //throw SysError
-                }
-                delta.fileChanges.push_back(std::move(change));
-            }
-            else if (*changeType == "drive")
-            {
-                std::optional<std::string> driveId = getPrimitiveFromJsonObject(childVal, "driveId");
-                if (!driveId || driveId->empty())
-                    throw SysError(formatGdriveErrorRaw(serializeJson(childVal)));
+                        if (*chg.changeType == "file")
+                        {
+                            if (!chg.fileId || chg.fileId->empty())
+                                throw SysError(formatGdriveErrorRaw(std::string(changeJson)));
 
-                DriveChange change;
-                change.driveId = std::move(*driveId);
-                if (*removed != "true")
-                {
-                    const JsonValue* drive = getChildFromJsonObject(childVal, "drive");
-                    if (!drive)
-                        throw SysError(formatGdriveErrorRaw(serializeJson(childVal)));
+                            FileChange change;
+                            change.itemId = std::move(*chg.fileId);
+                            if (*chg.removed != "true")
+                            {
+                                if (!chg.file)
+                                    throw SysError(formatGdriveErrorRaw(std::string(changeJson)));
+
+                                if (!chg.file->trashed)
+                                    throw SysError(formatGdriveErrorRaw(std::string(changeJson)));
+
+                                if (*chg.file->trashed != "true")
+                                    change.details = extractItemDetails(*chg.file, changeJson); //throw SysError
+                            }
+                            delta.fileChanges.push_back(std::move(change));
+                        }
+                        else if (*chg.changeType == "drive")
+                        {
+                            if (!chg.driveId || chg.driveId->empty())
+                                throw SysError(formatGdriveErrorRaw(std::string(changeJson)));
+
+                            DriveChange change;
+                            change.driveId = std::move(*chg.driveId);
+                            if (*chg.removed != "true")
+                            {
+                                if (!chg.hasDrive)
+                                    throw SysError(formatGdriveErrorRaw(std::string(changeJson)));
 
-                    const std::optional<std::string> name = getPrimitiveFromJsonObject(*drive, "name");
-                    if (!name || name->empty())
-                        throw SysError(formatGdriveErrorRaw(serializeJson(childVal)));
+                                if (!chg.driveName || chg.driveName->empty())
+                                    throw SysError(formatGdriveErrorRaw(std::string(changeJson)));
 
-                    change.driveName = utfTo<Zstring>(*name);
+                                change.driveName = utfTo<Zstring>(*chg.driveName);
+                            }
+                            delta.driveChanges.push_back(std::move(change));
+                        }
+                        else assert(false); //no other types (yet!)
+                    });
                 }
-                delta.driveChanges.push_back(std::move(change));
-            }
-            else assert(false); //no other types (yet!)
+                else
+                    reader.skipValue(); //throw JsonParsingError
+            });
+            reader.expectEnd(); //throw JsonParsingError
         }
+        catch (JsonParsingError&) { throw SysError(formatGdriveErrorRaw(response)); }
+
+        if (!!nextPageToken == !!newStartPageToken || //there can be only one
+            !listKind || *listKind != "drive#changeList" ||
+            !changesFound)
+            throw SysError(formatGdriveErrorRaw(response));
 
         if (!nextPageToken)
         {
@@ -1219,12 +1812,9 @@ void gdriveDeleteItem(const std::string& itemId, const GdriveAccess& access) //t
     {
         {"supportsAllDrives", "true"},
     });
-    std::string response;
-    const HttpSession::Result httpResult = gdriveHttpsRequest("/drive/v3/files/" + itemId + '?' + queryParams,
-    {} /*extraHeaders*/, {{CURLOPT_CUSTOMREQUEST, "DELETE"}}, [&](std::span<const char> buf) { response.append(buf.data(), buf.size()); },
-    nullptr /*readRequest*/, nullptr /*receiveHeader*/, access); //throw SysError
+    const auto& [statusCode, response] = gdriveHttpsRequestBatchable({"DELETE", "/drive/v3/files/" + itemId + '?' + queryParams, {} /*jsonBody*/}, access); //throw SysError
 
-    if (response.empty() && httpResult.statusCode == 204)
+    if (response.empty() && statusCode == 204)
         return; //"If successful, this method returns an empty response body"
 
     throw SysError(formatGdriveErrorRaw(response));
@@ -1241,12 +1831,9 @@ void gdriveUnlinkParent(const std::string& itemId, const std::string& parentId,
         {"supportsAllDrives", "true"},
         {"fields", "id,parents"}, //for test if operation was successful
     });
-    std::string response;
-    const HttpSession::Result httpResult = gdriveHttpsRequest("/drive/v3/files/" + itemId + '?' + queryParams,
-    {"Content-Type: application/json; charset=UTF-8"}, {{CURLOPT_CUSTOMREQUEST, "PATCH"}, { CURLOPT_POSTFIELDS, "{}"}},
-    [&](std::span<const char> buf) { response.append(buf.data(), buf.size()); }, nullptr /*readRequest*/, nullptr /*receiveHeader*/, access); //throw SysError
+    const auto& [statusCode, response] = gdriveHttpsRequestBatchable({"PATCH", "/drive/v3/files/" + itemId + '?' + queryParams, "{}"}, access); //throw SysError
 
-    if (response.empty() && httpResult.statusCode == 204)
+    if (response.empty() && statusCode == 204)
         return; //removing last parent of item not owned by us returns "204 No Content" (instead of 200 + file body)
 
     JsonValue jresponse;
@@ -1278,10 +1865,7 @@ void gdriveMoveToTrash(const std::string& itemId, const GdriveAccess& access) //
     });
     const std::string postBuf = R"({ "trashed": true })";
 
-    std::string response;
-    gdriveHttpsRequest("/drive/v3/files/" + itemId + '?' + queryParams,
-    {"Content-Type: application/json; charset=UTF-8"}, {{CURLOPT_CUSTOMREQUEST, "PATCH"}, {CURLOPT_POSTFIELDS, postBuf.c_str()}},
-    [&](std::span<const char> buf) { response.append(buf.data(), buf.size()); }, nullptr /*readRequest*/, nullptr /*receiveHeader*/, access); //throw SysError
+    const std::string response = gdriveHttpsRequestBatchable({"PATCH", "/drive/v3/files/" + itemId + '?' + queryParams, postBuf}, access).body; //throw SysError
 
     JsonValue jresponse;
     try { jresponse = parseJson(response); /*throw JsonParsingError*/ }
@@ -1308,10 +1892,7 @@ std::string /*folderId*/ gdriveCreateFolderPlain(const Zstring& folderName, cons
     postParams.objectVal.emplace("parents", std::vector<JsonValue> {JsonValue(parentId)});
     const std::string& postBuf = serializeJson(postParams, "" /*lineBreak*/, "" /*indent*/);
 
-    std::string response;
-    gdriveHttpsRequest("/drive/v3/files?" + queryParams,
-    {"Content-Type: application/json; charset=UTF-8"}, {{CURLOPT_POSTFIELDS, postBuf.c_str()}},
-    [&](std::span<const char> buf) { response.append(buf.data(), buf.size()); }, nullptr /*readRequest*/, nullptr /*receiveHeader*/, access); //throw SysError
+    const std::string response = gdriveHttpsRequestBatchable({"POST", "/drive/v3/files?" + queryParams, postBuf}, access).body; //throw SysError
 
     JsonValue jresponse;
     try { jresponse = parseJson(response); }
@@ -1434,11 +2015,7 @@ void gdriveMoveAndRenameItem(const std::string& itemId, const std::string& paren
     postParams.objectVal.emplace("modifiedTime", modTimeRfc);
     const std::string& postBuf = serializeJson(postParams, "" /*lineBreak*/, "" /*indent*/);
 
-    std::string response;
-    gdriveHttpsRequest("/drive/v3/files/" + itemId + '?' + queryParams,
-    {"Content-Type: application/json; charset=UTF-8"}, {{CURLOPT_CUSTOMREQUEST, "PATCH"}, {CURLOPT_POSTFIELDS, postBuf.c_str()}},
-    [&](std::span<const char> buf) { response.append(buf.data(), buf.size()); },
-    nullptr /*readRequest*/, nullptr /*receiveHeader*/, access); //throw SysError
+    const std::string response = gdriveHttpsRequestBatchable({"PATCH", "/drive/v3/files/" + itemId + '?' + queryParams, postBuf}, access).body; //throw SysError
 
     JsonValue jresponse;
     try { jresponse = parseJson(response); /*throw JsonParsingError*/ }
@@ -1560,6 +2137,157 @@ void gdriveDownloadFile(const std::string& fileId, const std::function<void(cons
 }
 
 
+//download bytes [offset, offset + bytesToRead) into memory
+std::string gdriveDownloadRange(const std::string& fileId, uint64_t offset, size_t bytesToRead, //throw SysError, SysErrorAbusiveFile, ThreadStopRequest
+                                bool acknowledgeAbuse, const GdriveAccess& access)
+{
+    std::string queryParams = xWwwFormUrlEncode(
+    {
+        {"supportsAllDrives", "true"},
+        {"alt", "media"},
+    });
+    if (acknowledgeAbuse)
+        queryParams += '&' + xWwwFormUrlEncode({{"acknowledgeAbuse", "true"}});
+
+    std::string response;
+    response.reserve(bytesToRead);
+
+    const HttpSession::Result httpResult = gdriveHttpsRequest("/drive/v3/files/" + fileId + '?' + queryParams,
+    {"Range: bytes=" + numberTo<std::string>(offset) + '-' + numberTo<std::string>(offset + bytesToRead - 1)}, {} /*extraOptions*/,
+    [&](std::span<const char> buf)
+    {
+        interruptionPoint(); //throw ThreadStopRequest
+        if (response.size() + buf.size() > bytesToRead) //server ignoring the range: don't buffer the complete file!
+            throw SysError(replaceCpy(replaceCpy(_("Unexpected size of data stream.\nExpected: %x bytes\nActual: %y bytes"),
+                                                 L"%x", formatNumber(bytesToRead)),
+                                      L"%y", formatNumber(response.size() + buf.size())));
+        response.append(buf.data(), buf.size());
+    }, nullptr /*readRequest*/, nullptr /*receiveHeader*/, access); //throw SysError, ThreadStopRequest
+
+    if (httpResult.statusCode != 206) //"Partial Content"
+    {
+        if (httpResult.statusCode == 403 && contains(response, "\"cannotDownloadAbusiveFile\""))
+            throw SysErrorAbusiveFile(formatGdriveErrorRaw(response));
+
+        throw SysError(formatGdriveErrorRaw(response));
+    }
+
+    if (response.size() != bytesToRead)
+        throw SysError(replaceCpy(replaceCpy(_("Unexpected size of data stream.\nExpected: %x bytes\nActual: %y bytes"),
+                                             L"%x", formatNumber(bytesToRead)),
+                                  L"%y", formatNumber(response.size())));
+    return response;
+}
+
+
+//single HTTP connection is throughput-limited by Google => download segments in parallel, pass them on in order
+void gdriveDownloadFileRangedImpl(const std::string& fileId, uint64_t fileSize, //throw SysError, SysErrorAbusiveFile, ThreadStopRequest
+                                  const std::function<void(const void* buffer, size_t bytesToWrite)>& writeBlock /*throw ThreadStopRequest*/,
+                                  bool acknowledgeAbuse, const GdriveAccess& access)
+{
+    const size_t segmentCount = static_cast<size_t>((fileSize + GDRIVE_RANGED_SEGMENT_SIZE - 1) / GDRIVE_RANGED_SEGMENT_SIZE);
+
+    //Google rate limiting => AIMD window shrinks => fewer parallel segments: don't compete with other requests for the remaining slots
+    const size_t streamCount = std::max<size_t>(1, std::min({GDRIVE_RANGED_STREAMS_MAX, segmentCount,
+                                                             access.rateLimiter ? access.rateLimiter->getWindow() : GDRIVE_RANGED_STREAMS_MAX}));
+    std::mutex lockSegments;
+    std::condition_variable conditionSegmentsChanged;
+    size_t segmentNext    = 0; //next segment to download
+    size_t segmentWritten = 0; //segments passed on to writeBlock()
+    std::map<size_t /*segment index*/, std::string> segmentsDone; //downloaded, not yet written
+    std::exception_ptr firstError;
+
+    auto downloadSegments = [&] //throw ThreadStopRequest
+    {
+        for (;;)
+        {
+            size_t segmentIdx = 0;
+            {
+                std::unique_lock dummy(lockSegments);
+                //don't run ahead of the writer by more than streamCount segments => bounded memory
+                interruptibleWait(conditionSegmentsChanged, dummy, [&] { return firstError || segmentNext >= segmentCount || segmentNext < segmentWritten + streamCount; }); //throw ThreadStopRequest
+                if (firstError || segmentNext >= segmentCount)
+                    return;
+                segmentIdx = segmentNext++;
+            }
+
+            const uint64_t offset = static_cast<uint64_t>(segmentIdx) * GDRIVE_RANGED_SEGMENT_SIZE;
+            const size_t bytesToRead = static_cast<size_t>(std::min<uint64_t>(GDRIVE_RANGED_SEGMENT_SIZE, fileSize - offset));
+            try
+            {
+                std::string segment = gdriveDownloadRange(fileId, offset, bytesToRead, acknowledgeAbuse, access); //throw SysError, SysErrorAbusiveFile, ThreadStopRequest
+
+                std::lock_guard dummy(lockSegments);
+                segmentsDone.emplace(segmentIdx, std::move(segment));
+            }
+            catch (SysError&)
+            {
+                std::lock_guard dummy(lockSegments);
+                if (!firstError)
+                    firstError = std::current_exception();
+            }
+            conditionSegmentsChanged.notify_all();
+        }
+    };
+
+    std::vector<InterruptibleThread> worker; //declare after the shared state: ~InterruptibleThread() requests stop and joins
+    for (size_t i = 0; i < streamCount; ++i)
+        worker.emplace_back([&downloadSegments, i]
+    {
+        setCurrentThreadName(Zstr("Gdrive range[") + numberTo<Zstring>(i) + Zstr(']'));
+        downloadSegments(); //throw ThreadStopRequest
+    });
+
+    for (size_t segmentIdx = 0; segmentIdx < segmentCount; ++segmentIdx)
+    {
+        std::string segment;
+        {
+            std::unique_lock dummy(lockSegments);
+            interruptibleWait(conditionSegmentsChanged, dummy, [&] { return firstError || segmentsDone.contains(segmentIdx); }); //throw ThreadStopRequest
+            if (firstError)
+                std::rethrow_exception(firstError); //throw SysError, SysErrorAbusiveFile
+
+            auto it = segmentsDone.find(segmentIdx);
+            segment = std::move(it->second);
+            segmentsDone.erase(it);
+        }
+
+        writeBlock(segment.c_str(), segment.size()); //throw ThreadStopRequest
+
+        {
+            std::lock_guard dummy(lockSegments);
+            ++segmentWritten;
+        }
+        conditionSegmentsChanged.notify_all();
+    }
+}
+
+
+void gdriveDownloadFileRanged(const std::string& fileId, uint64_t fileSize, //throw SysError, ThreadStopRequest
+                              const std::function<void(const void* buffer, size_t bytesToWrite)>& writeBlock /*throw ThreadStopRequest*/,
+                              const GdriveAccess& access)
+{
+    bool dataWritten = false;
+    auto writeBlockTracked = [&](const void* buffer, size_t bytesToWrite)
+    {
+        dataWritten = true;
+        writeBlock(buffer, bytesToWrite); //throw ThreadStopRequest
+    };
+
+    try
+    {
+        gdriveDownloadFileRangedImpl(fileId, fileSize, writeBlockTracked, false /*acknowledgeAbuse*/, access); //throw SysError, SysErrorAbusiveFile, ThreadStopRequest
+    }
+    catch (const SysErrorAbusiveFile& e)
+    {
+        if (dataWritten) //can't start over
+            throw SysError(e.toString());
+
+        gdriveDownloadFileRangedImpl(fileId, fileSize, writeBlock, true /*acknowledgeAbuse*/, access); //throw SysError, (SysErrorAbusiveFile), ThreadStopRequest
+    }
+}
+
+
 #if 0
 //file name already existing? => duplicate file created!
 //note: Google Drive upload is already transactional!
@@ -1651,22 +2379,135 @@ TODO:
     [&](std::span<const char> buf) { response.append(buf.data(), buf.size()); }, readMultipartBlock,
     nullptr /*receiveHeader*/, access); //throw SysError, X
 
-    JsonValue jresponse;
-    try { jresponse = parseJson(response); }
-    catch (JsonParsingError&) {}
+    JsonValue jresponse;
+    try { jresponse = parseJson(response); }
+    catch (JsonParsingError&) {}
+
+    const std::optional<std::string> itemId = getPrimitiveFromJsonObject(jresponse, "id");
+    if (!itemId)
+        throw SysError(formatGdriveErrorRaw(response));
+
+    return *itemId;
+}
+#endif
+
+
+//file name already existing? => duplicate file created!
+//note: Google Drive upload is already transactional!
+std::string /*itemId*/ gdriveUploadFileChunked(const std::string& uploadUrlRelative, //throw SysError, X
+                                               const std::function<size_t(void* buffer, size_t bytesToRead)>& readBlock /*throw X*/, //returning 0 signals EOF: Posix read() semantics
+                                               const GdriveAccess& access)
+{
+    //https://developers.google.com/drive/api/v3/manage-uploads#uploading_the_file_in_chunks
+    //https://developers.google.com/drive/api/v3/manage-uploads#resume-upload
+    std::vector<char> chunk(GDRIVE_UPLOAD_CHUNK_SIZE);
+    uint64_t chunkOffset = 0; //stream position of chunk[0]
+
+    for (;;)
+    {
+        size_t chunkSize = 0;
+        while (chunkSize < chunk.size())
+            if (const size_t bytesRead = readBlock(chunk.data() + chunkSize, chunk.size() - chunkSize); //throw X
+                bytesRead != 0)
+                chunkSize += bytesRead;
+            else
+                break;
+        const bool lastChunk = chunkSize < chunk.size(); //total stream size is a multiple of chunk size? => last chunk is empty
+        const std::string totalSizeStr = lastChunk ? numberTo<std::string>(chunkOffset + chunkSize) : "*";
+
+        uint64_t bytesAcked = chunkOffset; //as confirmed by Google
+        bool queryStatus = false; //after transient error: ask for upload progress before resending
+        for (int retryCount = 0;;)
+        {
+            const size_t chunkPos = static_cast<size_t>(bytesAcked - chunkOffset);
+            const size_t bytesToSend = queryStatus ? 0 : chunkSize - chunkPos;
+
+            std::string contentRange = "Content-Range: bytes ";
+            if (bytesToSend == 0)
+                contentRange += '*';
+            else
+                contentRange += numberTo<std::string>(bytesAcked) + '-' + numberTo<std::string>(bytesAcked + bytesToSend - 1);
+            contentRange += '/' + totalSizeStr;
+
+            std::optional<uint64_t> rangeEnd; //"Range: bytes=0-42" (missing if no bytes received yet)
+            auto onHeaderData = [&](const std::string_view& header)
+            {
+                if (startsWithAsciiNoCase(header, "Range:"))
+                    rangeEnd = stringTo<uint64_t>(afterLast(header, '-', IfNotFoundReturn::none));
+            };
+
+            size_t sendPos = chunkPos;
+            auto readRequest = [&](std::span<char> buf)
+            {
+                const size_t bytesRead = std::min(buf.size(), chunkPos + bytesToSend - sendPos);
+                std::memcpy(buf.data(), chunk.data() + sendPos, bytesRead);
+                sendPos += bytesRead;
+                return bytesRead;
+            };
+
+            std::string response;
+            std::optional<SysError> transientError;
+            HttpSession::Result httpResult;
+            try
+            {
+                httpResult = googleHttpsRequest(GOOGLE_REST_API_SERVER, uploadUrlRelative, {contentRange}, //don't need "Authorization: Bearer"
+                {{CURLOPT_INFILESIZE_LARGE, static_cast<curl_off_t>(bytesToSend)}},
+                [&](std::span<const char> buf) { response.append(buf.data(), buf.size()); }, readRequest, onHeaderData, access.timeoutSec); //throw SysError
+            }
+            catch (const SysError& e) { transientError = e; } //connection broken, timeout, etc.
+
+            if (!transientError)
+            {
+                if (httpResult.statusCode == 200 || //upload complete
+                    httpResult.statusCode == 201)
+                {
+                    JsonValue jresponse;
+                    try { jresponse = parseJson(response); }
+                    catch (JsonParsingError&) {}
+
+                    const std::optional<std::string> itemId = getPrimitiveFromJsonObject(jresponse, "id");
+                    if (!itemId)
+                        throw SysError(formatGdriveErrorRaw(response));
+                    return *itemId;
+                }
+
+                if (httpResult.statusCode == 308) //"Resume Incomplete"
+                {
+                    const uint64_t bytesAckedNew = rangeEnd ? *rangeEnd + 1 : 0;
+                    if (bytesAckedNew < bytesAcked || bytesAckedNew > chunkOffset + chunkSize)
+                        throw SysError(L"Unexpected upload progress: " + numberTo<std::wstring>(bytesAckedNew) + L'/' + numberTo<std::wstring>(chunkOffset + chunkSize));
+
+                    if (bytesAckedNew == bytesAcked && !queryStatus) //no progress despite successful request
+                        transientError = SysError(formatGdriveErrorRaw(response));
+                    else
+                    {
+                        bytesAcked = bytesAckedNew;
+                        queryStatus = false;
+                        retryCount = 0;
+
+                        if (bytesAcked == chunkOffset + chunkSize && !lastChunk)
+                            break; //next chunk
+                        continue;
+                    }
+                }
+                else if (httpResult.statusCode < 500) //4xx: e.g. upload session expired => don't resume
+                    throw SysError(formatGdriveErrorRaw(response));
+                else //"If you get a 5xx response, resume the upload"
+                    transientError = SysError(formatGdriveErrorRaw(response));
+            }
 
-    const std::optional<std::string> itemId = getPrimitiveFromJsonObject(jresponse, "id");
-    if (!itemId)
-        throw SysError(formatGdriveErrorRaw(response));
+            if (++retryCount > GDRIVE_UPLOAD_RETRY_MAX)
+                throw *transientError;
 
-    return *itemId;
+            interruptibleSleep(std::chrono::seconds(retryCount)); //throw ThreadStopRequest
+            queryStatus = true;
+        }
+        chunkOffset += chunkSize;
+    }
 }
-#endif
 
 
-//file name already existing? => duplicate file created!
-//note: Google Drive upload is already transactional!
-std::string /*itemId*/ gdriveUploadFile(const Zstring& fileName, const std::string& parentId, std::optional<time_t> modTime, //throw SysError, X
+std::string /*itemId*/ gdriveUploadFile(const Zstring& fileName, const std::string& parentId, std::optional<uint64_t> streamSize, std::optional<time_t> modTime, //throw SysError, X
                                         const std::function<size_t(void* buffer, size_t bytesToRead)>& readBlock /*throw X*/, //returning 0 signals EOF: Posix read() semantics
                                         const GdriveAccess& access)
 {
@@ -1725,6 +2566,11 @@ std::string /*itemId*/ gdriveUploadFile(const Zstring& fileName, const std::stri
     //---------------------------------------------------
     //step 2: upload file content
 
+    //large files: resume after transient errors at the last acknowledged offset, instead of restarting the whole upload
+    //=> no gzip for chunked uploads: Content-Range refers to the uploaded bytes
+    if (streamSize && *streamSize > GDRIVE_UPLOAD_CHUNK_SIZE)
+        return gdriveUploadFileChunked(uploadUrlRelative, readBlock, access); //throw SysError, X
+
     //not officially documented, but Google Drive supports compressed file upload when "Content-Encoding: gzip" is set! :)))
     InputStreamAsGzip gzipStream(readBlock); //throw SysError
 
@@ -1793,7 +2639,16 @@ public:
             accessInfo_.accessToken = std::move(token);
         }
 
-        return {accessInfo_.accessToken.value, timeoutSec};
+        return {accessInfo_.accessToken.value, timeoutSec, rateLimiter_};
+    }
+
+    //callable under shared lock: no token refresh => nullopt if due
+    std::optional<GdriveAccess> tryGetAccessTokenBuffered(int timeoutSec) const
+    {
+        if (accessInfo_.accessToken.validUntil <= std::time(nullptr) + timeoutSec + 5 /*some leeway*/) //expired/will expire
+            return std::nullopt;
+
+        return GdriveAccess{accessInfo_.accessToken.value, timeoutSec, rateLimiter_};
     }
 
     const std::string& getUserEmail() const { return accessInfo_.userInfo.email; }
@@ -1821,13 +2676,17 @@ private:
 
     GdriveAccessInfo accessInfo_;
     std::weak_ptr<int> timeoutSec_;
+    const std::shared_ptr<GdriveRateLimiter> rateLimiter_ = std::make_shared<GdriveRateLimiter>(); //one per user account
 };
 
 
 class GdriveDrivesBuffer;
 
 
-class GdriveFileState //per-user-session! => serialize access (perf: amortized fully buffered!)
+struct GdriveBufferMiss {}; //read-only lookup under shared lock needs data not yet buffered => retry with exclusive access
+
+
+class GdriveFileState //per-user-session! => serialize changes; buffered lookups (const) may run concurrently (perf: amortized fully buffered!)
 {
 public:
     GdriveFileState(const std::string& driveId, //ID of shared drive or "My Drive": never empty!
@@ -1867,6 +2726,7 @@ public:
             details.fileSize = readNumber      <uint64_t>(stream); //SysErrorUnexpectedEos
             details.modTime  = readNumber       <int64_t>(stream); //
             details.targetId = readContainer<std::string>(stream); //
+            details.md5      = readContainer<std::string>(stream); //
 
             size_t parentsCount = readNumber<uint32_t>(stream); //SysErrorUnexpectedEos
             while (parentsCount-- != 0)
@@ -1899,6 +2759,7 @@ public:
             writeNumber       <int64_t>(stream, details.modTime);
             static_assert(sizeof(details.modTime) <= sizeof(int64_t)); //ensure cross-platform compatibility!
             writeContainer(stream, details.targetId);
+            writeContainer(stream, details.md5);
 
             writeNumber(stream, static_cast<uint32_t>(details.parentIds.size()));
             for (const std::string& parentId : details.parentIds)
@@ -1941,44 +2802,15 @@ public:
         AfsPath existingPath;         //input path =: existingPath + relPath
         std::vector<Zstring> relPath; //
     };
-    PathStatus getPathStatus(const std::string& locationRootId, const AfsPath& afsPath, bool followLeafShortcut) //throw SysError
-    {
-        const std::vector<Zstring> relPath = split(afsPath.value, FILE_NAME_SEPARATOR, SplitOnEmpty::skip);
-        if (relPath.empty())
-            return {locationRootId, GdriveItemType::folder, AfsPath(), {}};
-        else
-            return getPathStatusSub(locationRootId, AfsPath(), relPath, followLeafShortcut); //throw SysError
-    }
+    //non-const: read missing folder content/item details from Google Drive; const: buffered only => throw GdriveBufferMiss
+    PathStatus getPathStatus(const std::string& locationRootId, const AfsPath& afsPath, bool followLeafShortcut)       { return getPathStatusImpl(*this, locationRootId, afsPath, followLeafShortcut); } //throw SysError
+    PathStatus getPathStatus(const std::string& locationRootId, const AfsPath& afsPath, bool followLeafShortcut) const { return getPathStatusImpl(*this, locationRootId, afsPath, followLeafShortcut); } //throw SysError, GdriveBufferMiss
 
-    std::string /*itemId*/ getItemId(const std::string& locationRootId, const AfsPath& afsPath, bool followLeafShortcut) //throw SysError
-    {
-        const GdriveFileState::PathStatus& ps = getPathStatus(locationRootId, afsPath, followLeafShortcut); //throw SysError
-        if (ps.relPath.empty())
-            return ps.existingItemId;
-
-        const AfsPath afsPathMissingChild(appendPath(ps.existingPath.value, ps.relPath.front()));
-        throw SysError(replaceCpy(_("Cannot find %x."), L"%x", fmtPath(getShortDisplayPath(afsPathMissingChild))));
-    }
-
-    std::pair<std::string /*itemId*/, GdriveItemDetails> getFileAttributes(const std::string& locationRootId, const AfsPath& afsPath, bool followLeafShortcut) //throw SysError
-    {
-        if (afsPath.value.empty()) //location root not covered by itemDetails_
-        {
-            GdriveItemDetails rootDetails = {};
-            rootDetails.type = GdriveItemType::folder;
-            //rootDetails.itemName =... => better leave empty for a root item!
-            rootDetails.owner = sharedDriveName_.empty() ? FileOwner::me : FileOwner::none;
-            return {locationRootId, std::move(rootDetails)};
-        }
-
-        const std::string itemId = getItemId(locationRootId, afsPath, followLeafShortcut); //throw SysError
-        if (auto it = itemDetails_.find(itemId);
-            it != itemDetails_.end())
-            return *it;
+    std::string /*itemId*/ getItemId(const std::string& locationRootId, const AfsPath& afsPath, bool followLeafShortcut)       { return getItemIdImpl(*this, locationRootId, afsPath, followLeafShortcut); } //throw SysError
+    std::string /*itemId*/ getItemId(const std::string& locationRootId, const AfsPath& afsPath, bool followLeafShortcut) const { return getItemIdImpl(*this, locationRootId, afsPath, followLeafShortcut); } //throw SysError, GdriveBufferMiss
 
-        //itemId was found! => (must either be a location root) or buffered in itemDetails_
-        throw std::logic_error("Contract violation! " + std::string(__FILE__) + ':' + numberTo<std::string>(__LINE__));
-    }
+    std::pair<std::string /*itemId*/, GdriveItemDetails> getFileAttributes(const std::string& locationRootId, const AfsPath& afsPath, bool followLeafShortcut)       { return getFileAttributesImpl(*this, locationRootId, afsPath, followLeafShortcut); } //throw SysError
+    std::pair<std::string /*itemId*/, GdriveItemDetails> getFileAttributes(const std::string& locationRootId, const AfsPath& afsPath, bool followLeafShortcut) const { return getFileAttributesImpl(*this, locationRootId, afsPath, followLeafShortcut); } //throw SysError, GdriveBufferMiss
 
     std::optional<GdriveItemDetails> tryGetBufferedItemDetails(const std::string& itemId) const
     {
@@ -2129,72 +2961,131 @@ private:
         }
     }
 
-    FileStateDelta registerFileStateDelta()
+    FileStateDelta registerFileStateDelta() const //callable under shared lock: see GdrivePersistentSessions::lookupGlobalFileState()
     {
         auto deltaPtr = std::make_shared<ItemIdDelta>();
+
+        std::lock_guard dummy(lockChangeLog_);
         changeLog_.push_back(deltaPtr);
         return FileStateDelta(deltaPtr);
     }
 
-    bool syncIsDue() const { return std::chrono::steady_clock::now() >= lastSyncTime_ + GDRIVE_SYNC_INTERVAL; }
+    bool syncIsDue(std::chrono::seconds lead = std::chrono::seconds(0)) const { return std::chrono::steady_clock::now() + lead >= lastSyncTime_ + GDRIVE_SYNC_INTERVAL; }
 
     void markSyncDue() { lastSyncTime_ = std::chrono::steady_clock::now() - GDRIVE_SYNC_INTERVAL; }
 
     void syncWithGoogle() //throw SysError
     {
-        const ChangesDelta delta = getChangesDelta(sharedDriveName_.empty() ? std::string() : driveId_, lastSyncToken_, accessBuf_.getAccessToken()); //throw SysError
-
-        for (const FileChange& change : delta.fileChanges)
-            updateItemState(change.itemId, get(change.details));
-
-        lastSyncToken_ = delta.newStartPageToken;
-        lastSyncTime_ = std::chrono::steady_clock::now();
+        applyChanges(getChangesDelta(getChangesDriveId(), lastSyncToken_, accessBuf_.getAccessToken())); //throw SysError
 
         //good to know: if item is created and deleted between polling for changes it is still reported as deleted by Google!
         //Same goes for any other change that is undone in between change notification syncs.
     }
 
-    PathStatus getPathStatusSub(const std::string& folderId, const AfsPath& folderPath, const std::vector<Zstring>& relPath, bool followLeafShortcut) //throw SysError
+    //background sync: getChangesDelta() runs without holding the session lock, only applying the result needs exclusive access
+    std::string getChangesDriveId() const { return sharedDriveName_.empty() ? std::string() : driveId_; }
+    const std::string& getSyncToken() const { return lastSyncToken_; }
+
+    void applyPrefetchedChanges(const std::string& startPageToken, const ChangesDelta& delta)
+    {
+        if (startPageToken == lastSyncToken_) //else: syncWithGoogle() got ahead in the meantime => discard
+            applyChanges(delta);
+    }
+
+    template <class FileState> //const FileState: buffered lookup only
+    static PathStatus getPathStatusImpl(FileState& fs, const std::string& locationRootId, const AfsPath& afsPath, bool followLeafShortcut) //throw SysError, GdriveBufferMiss
+    {
+        const std::vector<Zstring> relPath = split(afsPath.value, FILE_NAME_SEPARATOR, SplitOnEmpty::skip);
+        if (relPath.empty())
+            return {locationRootId, GdriveItemType::folder, AfsPath(), {}};
+        else
+            return getPathStatusSub(fs, locationRootId, AfsPath(), relPath, followLeafShortcut); //throw SysError, GdriveBufferMiss
+    }
+
+    template <class FileState>
+    static std::string /*itemId*/ getItemIdImpl(FileState& fs, const std::string& locationRootId, const AfsPath& afsPath, bool followLeafShortcut) //throw SysError, GdriveBufferMiss
+    {
+        const GdriveFileState::PathStatus& ps = getPathStatusImpl(fs, locationRootId, afsPath, followLeafShortcut); //throw SysError, GdriveBufferMiss
+        if (ps.relPath.empty())
+            return ps.existingItemId;
+
+        const AfsPath afsPathMissingChild(appendPath(ps.existingPath.value, ps.relPath.front()));
+        throw SysError(replaceCpy(_("Cannot find %x."), L"%x", fmtPath(fs.getShortDisplayPath(afsPathMissingChild))));
+    }
+
+    template <class FileState>
+    static std::pair<std::string /*itemId*/, GdriveItemDetails> getFileAttributesImpl(FileState& fs, const std::string& locationRootId, const AfsPath& afsPath, bool followLeafShortcut) //throw SysError, GdriveBufferMiss
+    {
+        if (afsPath.value.empty()) //location root not covered by itemDetails_
+        {
+            GdriveItemDetails rootDetails = {};
+            rootDetails.type = GdriveItemType::folder;
+            //rootDetails.itemName =... => better leave empty for a root item!
+            rootDetails.owner = fs.sharedDriveName_.empty() ? FileOwner::me : FileOwner::none;
+            return {locationRootId, std::move(rootDetails)};
+        }
+
+        const std::string itemId = getItemIdImpl(fs, locationRootId, afsPath, followLeafShortcut); //throw SysError, GdriveBufferMiss
+        if (auto it = fs.itemDetails_.find(itemId);
+            it != fs.itemDetails_.end())
+            return *it;
+
+        //itemId was found! => (must either be a location root) or buffered in itemDetails_
+        throw std::logic_error("Contract violation! " + std::string(__FILE__) + ':' + numberTo<std::string>(__LINE__));
+    }
+
+    template <class FileState>
+    static PathStatus getPathStatusSub(FileState& fs, const std::string& folderId, const AfsPath& folderPath, const std::vector<Zstring>& relPath, bool followLeafShortcut) //throw SysError, GdriveBufferMiss
     {
         assert(!relPath.empty());
 
-        auto itKnown = folderContents_.find(folderId);
-        if (itKnown == folderContents_.end() || !itKnown->second.isKnownFolder)
+        auto itKnown = fs.folderContents_.find(folderId);
+        if (itKnown == fs.folderContents_.end() || !itKnown->second.isKnownFolder)
         {
-            notifyFolderContent(registerFileStateDelta(), folderId, readFolderContent(folderId, accessBuf_.getAccessToken())); //throw SysError
-            //perf: always buffered, except for direct, first-time folder access!
-            itKnown = folderContents_.find(folderId);
-            assert(itKnown != folderContents_.end());
-            if (!itKnown->second.isKnownFolder)
-                throw std::logic_error("Contract violation! " + std::string(__FILE__) + ':' + numberTo<std::string>(__LINE__));
+            if constexpr (std::is_const_v<FileState>)
+                throw GdriveBufferMiss();
+            else
+            {
+                fs.notifyFolderContent(fs.registerFileStateDelta(), folderId, readFolderContent(folderId, fs.accessBuf_.getAccessToken())); //throw SysError
+                //perf: always buffered, except for direct, first-time folder access!
+                itKnown = fs.folderContents_.find(folderId);
+                assert(itKnown != fs.folderContents_.end());
+                if (!itKnown->second.isKnownFolder)
+                    throw std::logic_error("Contract violation! " + std::string(__FILE__) + ':' + numberTo<std::string>(__LINE__));
+            }
         }
 
-        auto itFound = itemDetails_.cend();
+        auto itFound = fs.itemDetails_.cend();
         for (const DetailsIterator& itChild : itKnown->second.childItems)
             //Since Google Drive has no concept of a file path, we have to roll our own "path to ID" mapping => let's use the platform-native style
             if (equalNativePath(itChild->second.itemName, relPath.front()))
             {
-                if (itFound != itemDetails_.end())
+                if (itFound != fs.itemDetails_.end())
                     throw SysError(replaceCpy(_("Cannot find %x."), L"%x",
-                                              fmtPath(getShortDisplayPath(AfsPath(appendPath(folderPath.value, relPath.front()))))) + L' ' +
+                                              fmtPath(fs.getShortDisplayPath(AfsPath(appendPath(folderPath.value, relPath.front()))))) + L' ' +
                                    replaceCpy(_("The name %x is used by more than one item in the folder."), L"%x", fmtPath(relPath.front())));
 
                 itFound = itChild;
             }
 
-        if (itFound == itemDetails_.end())
+        if (itFound == fs.itemDetails_.end())
             return {folderId, GdriveItemType::folder, folderPath, relPath}; //always a folder, see check before recursion above
         else
         {
             auto getItemDetailsBuffered = [&](const std::string& itemId) -> const GdriveItemDetails&
             {
-                auto it = itemDetails_.find(itemId);
-                if (it == itemDetails_.end())
+                auto it = fs.itemDetails_.find(itemId);
+                if (it == fs.itemDetails_.end())
                 {
-                    notifyItemUpdated(registerFileStateDelta(), {itemId, getItemDetails(itemId, accessBuf_.getAccessToken())}); //throw SysError
-                    //perf: always buffered, except for direct, first-time folder access!
-                    it = itemDetails_.find(itemId);
-                    assert(it != itemDetails_.end());
+                    if constexpr (std::is_const_v<FileState>)
+                        throw GdriveBufferMiss();
+                    else
+                    {
+                        fs.notifyItemUpdated(fs.registerFileStateDelta(), {itemId, getItemDetails(itemId, fs.accessBuf_.getAccessToken())}); //throw SysError
+                        //perf: always buffered, except for direct, first-time folder access!
+                        it = fs.itemDetails_.find(itemId);
+                        assert(it != fs.itemDetails_.end());
+                    }
                 }
                 return it->second;
             };
@@ -2217,7 +3108,7 @@ private:
                     return {childId, childDetails.type, childItemPath, childRelPath};
 
                 case GdriveItemType::folder:
-                    return getPathStatusSub(childId, childItemPath, childRelPath, followLeafShortcut); //throw SysError
+                    return getPathStatusSub(fs, childId, childItemPath, childRelPath, followLeafShortcut); //throw SysError, GdriveBufferMiss
 
                 case GdriveItemType::shortcut:
                     switch (getItemDetailsBuffered(childDetails.targetId).type)
@@ -2226,11 +3117,11 @@ private:
                             return {childDetails.targetId, GdriveItemType::file, childItemPath, childRelPath}; //resolve symlinks if in the *middle* of a path!
 
                         case GdriveItemType::folder: //parent/folder-symlink/child-rel-path... => always follow
-                            return getPathStatusSub(childDetails.targetId, childItemPath, childRelPath, followLeafShortcut); //throw SysError
+                            return getPathStatusSub(fs, childDetails.targetId, childItemPath, childRelPath, followLeafShortcut); //throw SysError, GdriveBufferMiss
 
                         case GdriveItemType::shortcut: //should never happen: creating shortcuts to shortcuts fails with "Internal Error"
                             throw SysError(replaceCpy(_("Cannot resolve symbolic link %x."), L"%x",
-                                                      fmtPath(getShortDisplayPath(AfsPath(appendPath(folderPath.value, relPath.front()))))) + L' ' +
+                                                      fmtPath(fs.getShortDisplayPath(AfsPath(appendPath(folderPath.value, relPath.front()))))) + L' ' +
                                            L"Google Drive Shortcut points to another Shortcut.");
                     }
                     break;
@@ -2239,6 +3130,15 @@ private:
         }
     }
 
+    void applyChanges(const ChangesDelta& delta)
+    {
+        for (const FileChange& change : delta.fileChanges)
+            updateItemState(change.itemId, get(change.details));
+
+        lastSyncToken_ = delta.newStartPageToken;
+        lastSyncTime_ = std::chrono::steady_clock::now();
+    }
+
     void updateItemState(const std::string& itemId, const GdriveItemDetails* details)
     {
         auto it = itemDetails_.find(itemId);
@@ -2247,6 +3147,7 @@ private:
                 return; //=> avoid misleading changeLog_ entries after Google Drive sync!!!
 
         //update change logs (and clean up obsolete entries)
+        std::lock_guard dummy(lockChangeLog_);
         std::erase_if(changeLog_, [&](std::weak_ptr<ItemIdDelta>& weakPtr)
         {
             if (std::shared_ptr<ItemIdDelta> iid = weakPtr.lock())
@@ -2327,7 +3228,8 @@ private:
     std::string lastSyncToken_; //drive-specific(!) marker corresponding to last sync with Google's change notifications
     std::chrono::steady_clock::time_point lastSyncTime_ = std::chrono::steady_clock::now() - GDRIVE_SYNC_INTERVAL; //... with Google Drive (default: sync is due)
 
-    std::vector<std::weak_ptr<ItemIdDelta>> changeLog_; //track changed items since FileStateDelta was created (includes sync with Google + our own intermediate change notifications)
+    mutable std::mutex lockChangeLog_; //registerFileStateDelta() runs under shared lock
+    mutable std::vector<std::weak_ptr<ItemIdDelta>> changeLog_; //track changed items since FileStateDelta was created (includes sync with Google + our own intermediate change notifications)
 
     std::string driveId_; //ID of shared drive or "My Drive": never empty!
     Zstring sharedDriveName_; //name of shared drive: empty for "My Drive"!
@@ -2339,27 +3241,37 @@ private:
 class GdriveFileStateAtLocation
 {
 public:
-    GdriveFileStateAtLocation(GdriveFileState& fileState, const std::string& locationRootId) : fileState_(fileState), locationRootId_(locationRootId) {}
+    GdriveFileStateAtLocation(      GdriveFileState& fileState, const std::string& locationRootId) : fileState_(fileState), fileStateMutable_(&fileState), locationRootId_(locationRootId) {}
+    GdriveFileStateAtLocation(const GdriveFileState& fileState, const std::string& locationRootId) : fileState_(fileState), locationRootId_(locationRootId) {} //buffered lookups only
 
-    GdriveFileState::PathStatus getPathStatus(const AfsPath& afsPath, bool followLeafShortcut) //throw SysError
+    //lookups run with exclusive access: read missing data from Google Drive; shared access: throw GdriveBufferMiss
+    GdriveFileState::PathStatus getPathStatus(const AfsPath& afsPath, bool followLeafShortcut) const //throw SysError, GdriveBufferMiss
     {
-        return fileState_.getPathStatus(locationRootId_, afsPath, followLeafShortcut); //throw SysError
+        return fileStateMutable_ ?
+               fileStateMutable_->getPathStatus(locationRootId_, afsPath, followLeafShortcut) : //throw SysError
+               fileState_        .getPathStatus(locationRootId_, afsPath, followLeafShortcut);  //throw SysError, GdriveBufferMiss
     }
 
-    std::string /*itemId*/ getItemId(const AfsPath& afsPath, bool followLeafShortcut) //throw SysError
+    std::string /*itemId*/ getItemId(const AfsPath& afsPath, bool followLeafShortcut) const //throw SysError, GdriveBufferMiss
     {
-        return fileState_.getItemId(locationRootId_, afsPath, followLeafShortcut); //throw SysError
+        return fileStateMutable_ ?
+               fileStateMutable_->getItemId(locationRootId_, afsPath, followLeafShortcut) : //throw SysError
+               fileState_        .getItemId(locationRootId_, afsPath, followLeafShortcut);  //throw SysError, GdriveBufferMiss
     }
 
-    std::pair<std::string /*itemId*/, GdriveItemDetails> getFileAttributes(const AfsPath& afsPath, bool followLeafShortcut) //throw SysError
+    std::pair<std::string /*itemId*/, GdriveItemDetails> getFileAttributes(const AfsPath& afsPath, bool followLeafShortcut) const //throw SysError, GdriveBufferMiss
     {
-        return fileState_.getFileAttributes(locationRootId_, afsPath, followLeafShortcut); //throw SysError
+        return fileStateMutable_ ?
+               fileStateMutable_->getFileAttributes(locationRootId_, afsPath, followLeafShortcut) : //throw SysError
+               fileState_        .getFileAttributes(locationRootId_, afsPath, followLeafShortcut);  //throw SysError, GdriveBufferMiss
     }
 
-    GdriveFileState& all() { return fileState_; }
+    /**/  GdriveFileState& all()       { assert(fileStateMutable_); return *fileStateMutable_; }
+    const GdriveFileState& all() const { return fileState_; }
 
 private:
-    GdriveFileState& fileState_;
+    const GdriveFileState& fileState_;
+    GdriveFileState* fileStateMutable_ = nullptr; //exclusive access only
     const std::string locationRootId_;
 };
 
@@ -2412,6 +3324,8 @@ public:
 
     std::pair<GdriveFileStateAtLocation, GdriveFileState::FileStateDelta> prepareAccess(const Zstring& locationName) //throw SysError
     {
+        lastAccessTime_ = std::chrono::steady_clock::now();
+
         //checking for added/renamed/deleted shared drives *every* GDRIVE_SYNC_INTERVAL is needlessly excessive!
         //  => check 1. once per FFS run
         //           2. on drive access error
@@ -2440,6 +3354,59 @@ public:
         return {fileState, fileState.all().registerFileStateDelta()};
     }
 
+    //same as prepareAccess(), but callable under shared lock: no sync with Google Drive => nullopt if due
+    std::optional<std::pair<GdriveFileStateAtLocation, GdriveFileState::FileStateDelta>> tryPrepareAccessBuffered(const Zstring& locationName) const
+    {
+        lastAccessTime_ = std::chrono::steady_clock::now();
+
+        if (lastSyncTime_ == std::chrono::steady_clock::time_point())
+            return std::nullopt;
+        try
+        {
+            GdriveFileStateAtLocation fileState = getFileState(locationName); //throw SysError
+            if (fileState.all().syncIsDue())
+                return std::nullopt;
+
+            return std::pair(fileState, fileState.all().registerFileStateDelta());
+        }
+        catch (SysError&) { return std::nullopt; } //let prepareAccess() sync and report errors
+    }
+
+    std::chrono::steady_clock::time_point getLastAccessTime() const { return lastAccessTime_; }
+
+    struct ChangesPrefetch
+    {
+        std::string driveId;
+        std::string changesDriveId; //empty for "My Drive"
+        std::string startPageToken;
+        ChangesDelta delta;
+    };
+    //callable under shared lock: drives due for sync within "lead"
+    std::vector<ChangesPrefetch> getChangesPrefetchDue(std::chrono::seconds lead) const
+    {
+        std::vector<ChangesPrefetch> due;
+
+        auto addIfDue = [&](const GdriveFileState& fileState)
+        {
+            if (fileState.syncIsDue(lead))
+                due.push_back({fileState.getDriveId(), fileState.getChangesDriveId(), fileState.getSyncToken(), {}});
+        };
+        addIfDue(myDrive_);
+        for (const auto& [driveId, fileState] : sharedDrives_)
+            addIfDue(fileState.ref());
+
+        return due;
+    }
+
+    void applyPrefetchedChanges(const ChangesPrefetch& prefetch)
+    {
+        if (prefetch.driveId == myDrive_.getDriveId())
+            myDrive_.applyPrefetchedChanges(prefetch.startPageToken, prefetch.delta);
+        else if (auto it = sharedDrives_.find(prefetch.driveId);
+                 it != sharedDrives_.end()) //else: shared drive removed in the meantime
+            it->second.ref().applyPrefetchedChanges(prefetch.startPageToken, prefetch.delta);
+    }
+
 private:
     bool syncIsDue() const { return std::chrono::steady_clock::now() >= lastSyncTime_ + GDRIVE_SYNC_INTERVAL; }
 
@@ -2472,40 +3439,42 @@ private:
         lastSyncTime_ = std::chrono::steady_clock::now(); //...(uhm, mostly, except for setSharedDriveName())
     }
 
-    GdriveFileStateAtLocation getFileState(const Zstring& locationName) //throw SysError
+    template <class DrivesBuffer> //const DrivesBuffer => const GdriveFileState
+    static auto findFileState(DrivesBuffer& db, const Zstring& locationName) //throw SysError
     {
+        using FileStatePtr = decltype(&db.myDrive_);
         if (locationName.empty())
-            return {myDrive_, myDrive_.getDriveId()};
+            return std::pair<FileStatePtr, std::string>(&db.myDrive_, db.myDrive_.getDriveId());
 
-        GdriveFileState* fileState = nullptr;
+        FileStatePtr fileState = nullptr;
         std::string locationRootId;
 
-        for (auto& [driveId, fileStateRef] : sharedDrives_)
+        for (auto& [driveId, fileStateRef] : db.sharedDrives_)
             if (equalNativePath(fileStateRef.ref().getSharedDriveName(), locationName))
             {
                 if (fileState)
                     throw SysError(replaceCpy(_("Cannot find %x."), L"%x",
-                    fmtPath(getGdriveDisplayPath({{accessBuf_.getUserEmail(), locationName}, AfsPath()}))) + L' ' +
+                    fmtPath(getGdriveDisplayPath({{db.accessBuf_.getUserEmail(), locationName}, AfsPath()}))) + L' ' +
                 replaceCpy(_("The name %x is used by more than one item in the folder."), L"%x", fmtPath(locationName)));
 
                 fileState = &fileStateRef.ref();
                 locationRootId = driveId;
             }
 
-        for (const StarredFolderDetails& sfd : starredFolders_)
+        for (const StarredFolderDetails& sfd : db.starredFolders_)
             if (equalNativePath(sfd.folderName, locationName))
             {
                 if (fileState)
                     throw SysError(replaceCpy(_("Cannot find %x."), L"%x",
-                    fmtPath(getGdriveDisplayPath({{accessBuf_.getUserEmail(), locationName}, AfsPath()}))) + L' ' +
+                    fmtPath(getGdriveDisplayPath({{db.accessBuf_.getUserEmail(), locationName}, AfsPath()}))) + L' ' +
                 replaceCpy(_("The name %x is used by more than one item in the folder."), L"%x", fmtPath(locationName)));
 
                 if (sfd.sharedDriveId.empty()) //=> My Drive
-                    fileState = &myDrive_;
+                    fileState = &db.myDrive_;
                 else
                 {
-                    auto it = sharedDrives_.find(sfd.sharedDriveId);
-                    if (it == sharedDrives_.end())
+                    auto it = db.sharedDrives_.find(sfd.sharedDriveId);
+                    if (it == db.sharedDrives_.end())
                         break;
 
                     fileState = &it->second.ref();
@@ -2515,13 +3484,17 @@ private:
 
         if (!fileState)
             throw SysError(replaceCpy(_("Cannot find %x."), L"%x",
-            fmtPath(getGdriveDisplayPath({{accessBuf_.getUserEmail(), locationName}, AfsPath()}))));
+            fmtPath(getGdriveDisplayPath({{db.accessBuf_.getUserEmail(), locationName}, AfsPath()}))));
 
-        return {*fileState, locationRootId};
+        return std::pair(fileState, locationRootId);
     }
 
+    GdriveFileStateAtLocation getFileState(const Zstring& locationName)       { const auto& [fileState, locationRootId] = findFileState(*this, locationName); return {*fileState, locationRootId}; } //throw SysError
+    GdriveFileStateAtLocation getFileState(const Zstring& locationName) const { const auto& [fileState, locationRootId] = findFileState(*this, locationName); return {*fileState, locationRootId}; } //throw SysError
+
     GdriveAccessBuffer& accessBuf_;
     std::chrono::steady_clock::time_point lastSyncTime_; //... with Google Drive (default: sync is due)
+    mutable std::atomic<std::chrono::steady_clock::time_point> lastAccessTime_{std::chrono::steady_clock::now()}; //updated under shared lock
 
     GdriveFileState myDrive_;
     std::unordered_map<std::string /*drive ID*/, SharedRef<GdriveFileState>> sharedDrives_;
@@ -2535,14 +3508,25 @@ private:
 class GdrivePersistentSessions
 {
 public:
-    explicit GdrivePersistentSessions(const Zstring& configDirPath) : configDirPath_(configDirPath)
+    explicit GdrivePersistentSessions(const Zstring& configDirPath) :
+        configDirPath_(configDirPath),
+        sessionSaver_([this]
+    {
+        setCurrentThreadName(Zstr("Session Saver[Gdrive]"));
+        runPeriodicSessionSave(); //throw ThreadStopRequest
+    }),
+    changesPrefetcher_([this]
+    {
+        setCurrentThreadName(Zstr("Changes Prefetch[Gdrive]"));
+        runChangesPrefetch(); //throw ThreadStopRequest
+    })
     {
         onSystemShutdownRegister(onBeforeSystemShutdownCookie_);
     }
 
     void saveActiveSessions() //throw FileError
     {
-        std::vector<Protected<SessionHolder>*> protectedSessions; //pointers remain stable, thanks to std::unordered_map<>
+        std::vector<ProtectedShared<SessionHolder>*> protectedSessions; //pointers remain stable, thanks to std::unordered_map<>
         globalSessions_.access([&](GlobalSessions& sessions)
         {
             for (auto& [accountEmail, protectedSession] : sessions)
@@ -2556,14 +3540,14 @@ public:
             std::exception_ptr firstError;
 
             //access each session outside the globalSessions_ lock!
-            for (Protected<SessionHolder>* protectedSession : protectedSessions)
+            for (ProtectedShared<SessionHolder>* protectedSession : protectedSessions)
                 protectedSession->access([&](SessionHolder& holder)
             {
                 if (holder.session)
                     try
                     {
                         const Zstring dbFilePath = getDbFilePath(holder.session->accessBuf.ref().getUserEmail());
-                        saveSession(dbFilePath, *holder.session); //throw FileError
+                        saveSession(dbFilePath, *holder.session, holder.dbSavedCrc); //throw FileError
                     }
                     catch (FileError&) { if (!firstError) firstError = std::current_exception(); }
             });
@@ -2634,7 +3618,7 @@ public:
     {
         std::vector<std::string> emails;
 
-        std::vector<Protected<SessionHolder>*> protectedSessions; //pointers remain stable, thanks to std::unordered_map<>
+        std::vector<ProtectedShared<SessionHolder>*> protectedSessions; //pointers remain stable, thanks to std::unordered_map<>
         globalSessions_.access([&](GlobalSessions& sessions)
         {
             for (auto& [accountEmail, protectedSession] : sessions)
@@ -2642,7 +3626,7 @@ public:
         });
 
         //access each session outside the globalSessions_ lock!
-        for (Protected<SessionHolder>* protectedSession : protectedSessions)
+        for (ProtectedShared<SessionHolder>* protectedSession : protectedSessions)
             protectedSession->access([&](SessionHolder& holder)
         {
             if (holder.session)
@@ -2707,11 +3691,50 @@ public:
         return {access, stateDelta};
     }
 
+    //keep the change feed applied in the background while the account is in use: large change feeds (e.g. after loading a session
+    //from the DB) are fetched in parallel with local work (DB loading, local traversal), instead of blocking the first access of each phase
+    void startChangesPrefetch(const GdriveLogin& login)
+    {
+        prefetchAccounts_.access([&](PrefetchAccounts& accounts) { accounts.insert_or_assign(login.email, PrefetchAccount{login.timeoutSec, std::chrono::steady_clock::now()}); });
+    }
+
+    //read-only lookups: run concurrently under shared lock if fully buffered, else with exclusive access (sync with Google Drive, refresh access token, read missing folder content)
+    //=> useFileState may run twice: set output only
+    AsyncAccessInfo lookupGlobalFileState(const GdriveLogin& login, const std::function<void(const GdriveFileStateAtLocation& fileState)>& useFileState /*throw X*/) //throw SysError, X
+    {
+        std::optional<AsyncAccessInfo> aai;
+        try
+        {
+            ProtectedShared<SessionHolder>* protectedSession = nullptr; //pointers remain stable, thanks to std::unordered_map<>
+            globalSessions_.access([&](GlobalSessions& sessions) { protectedSession = &sessions[login.email]; });
+
+            protectedSession->accessShared([&](const SessionHolder& holder)
+            {
+                if (holder.session) //not yet loaded or missing: let accessGlobalFileState() handle
+                    if (std::optional<GdriveAccess> access = holder.session->accessBuf.ref().tryGetAccessTokenBuffered(login.timeoutSec))
+                        if (std::optional<std::pair<GdriveFileStateAtLocation, GdriveFileState::FileStateDelta>> prep = holder.session->drivesBuf.ref().tryPrepareAccessBuffered(login.locationName))
+                        {
+                            const auto& [fileState, stateDelta] = *prep;
+
+                            useFileState(fileState); //throw SysError, GdriveBufferMiss, X
+                            aai = AsyncAccessInfo{std::move(*access), stateDelta};
+                        }
+            });
+        }
+        catch (GdriveBufferMiss&) {}
+
+        if (aai)
+            return *aai;
+
+        return accessGlobalFileState(login, [&](GdriveFileStateAtLocation& fileState) { useFileState(fileState); }); //throw SysError, X
+    }
+
 private:
     GdrivePersistentSessions           (const GdrivePersistentSessions&) = delete;
     GdrivePersistentSessions& operator=(const GdrivePersistentSessions&) = delete;
 
     struct UserSession;
+    struct PrefetchAccount;
 
     Zstring getDbFilePath(std::string accountEmail) const
     {
@@ -2723,7 +3746,7 @@ private:
 
     void accessUserSession(const std::string& accountEmail, int timeoutSec, const std::function<void(std::optional<UserSession>& userSession)>& useSession /*throw X*/) //throw SysError, X
     {
-        Protected<SessionHolder>* protectedSession = nullptr; //pointers remain stable, thanks to std::unordered_map<>
+        ProtectedShared<SessionHolder>* protectedSession = nullptr; //pointers remain stable, thanks to std::unordered_map<>
         globalSessions_.access([&](GlobalSessions& sessions) { protectedSession = &sessions[accountEmail]; });
 
         protectedSession->access([&](SessionHolder& holder)
@@ -2744,7 +3767,8 @@ private:
         });
     }
 
-    static void saveSession(const Zstring& dbFilePath, const UserSession& userSession) //throw FileError
+    //dbSavedCrc: skip writing if nothing changed since last save
+    static void saveSession(const Zstring& dbFilePath, const UserSession& userSession, std::optional<uint32_t>& dbSavedCrc) //throw FileError
     {
         MemoryStreamOut<std::string> streamOut;
         writeArray(streamOut, DB_FILE_DESCR, sizeof(DB_FILE_DESCR));
@@ -2754,6 +3778,10 @@ private:
         userSession.accessBuf.ref().serialize(streamOutBody);
         userSession.drivesBuf.ref().serialize(streamOutBody);
 
+        const uint32_t bodyCrc = getCrc32(streamOutBody.ref());
+        if (dbSavedCrc && *dbSavedCrc == bodyCrc)
+            return;
+
         try
         {
             streamOut.ref() += compress(streamOutBody.ref(), 3 /*best compression level: see db_file.cpp*/); //throw SysError
@@ -2761,6 +3789,82 @@ private:
         catch (const SysError& e) { throw FileError(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(dbFilePath)), e.toString()); }
 
         setFileContent(dbFilePath, streamOut.ref(), nullptr /*notifyUnbufferedIO*/); //throw FileError
+        dbSavedCrc = bodyCrc;
+    }
+
+    //context of worker thread:
+    void runPeriodicSessionSave() //throw ThreadStopRequest
+    {
+        for (;;)
+        {
+            interruptibleSleep(GDRIVE_DB_SAVE_INTERVAL); //throw ThreadStopRequest
+            try
+            {
+                saveActiveSessions(); //throw FileError
+            }
+            catch (FileError&) {} //not critical: error will be reported by gdriveTeardown() (if persistent)
+        }
+    }
+
+    //context of worker thread:
+    void runChangesPrefetch() //throw ThreadStopRequest
+    {
+        for (;;)
+        {
+            interruptibleSleep(GDRIVE_PREFETCH_POLL_INTERVAL); //throw ThreadStopRequest
+
+            PrefetchAccounts accounts;
+            prefetchAccounts_.access([&](PrefetchAccounts& accounts2) { accounts = accounts2; });
+
+            for (const auto& [accountEmail, account] : accounts)
+                try
+                {
+                    if (!prefetchChanges(accountEmail, account)) //throw SysError
+                        prefetchAccounts_.access([&, &accountEmail /*clang bug*/= accountEmail](PrefetchAccounts& accounts2) { accounts2.erase(accountEmail); });
+                }
+                catch (SysError&) {} //not critical: foreground access will sync (and report errors) as usual
+        }
+    }
+
+    //returns false if account is idle => stop prefetching
+    bool prefetchChanges(const std::string& accountEmail, const PrefetchAccount& account) //throw SysError
+    {
+        ProtectedShared<SessionHolder>* protectedSession = nullptr; //pointers remain stable, thanks to std::unordered_map<>
+        globalSessions_.access([&](GlobalSessions& sessions) { protectedSession = &sessions[accountEmail]; });
+
+        bool isIdle = false;
+        std::optional<GdriveAccess> access;
+        std::vector<GdriveDrivesBuffer::ChangesPrefetch> prefetches;
+
+        protectedSession->accessShared([&](const SessionHolder& holder)
+        {
+            if (holder.session) //not yet loaded: try again next round
+            {
+                const GdriveDrivesBuffer& drivesBuf = holder.session->drivesBuf.ref();
+                isIdle = std::chrono::steady_clock::now() > std::max(account.startTime, drivesBuf.getLastAccessTime()) + GDRIVE_PREFETCH_IDLE_STOP;
+
+                if (!isIdle)
+                    if ((access = holder.session->accessBuf.ref().tryGetAccessTokenBuffered(account.timeoutSec))) //else: let foreground access refresh the token
+                        prefetches = drivesBuf.getChangesPrefetchDue(GDRIVE_PREFETCH_LEAD);
+            }
+        });
+        if (isIdle)
+            return false;
+
+        if (!prefetches.empty())
+        {
+            //don't hold the session lock while waiting for Google Drive!
+            for (GdriveDrivesBuffer::ChangesPrefetch& prefetch : prefetches)
+                prefetch.delta = getChangesDelta(prefetch.changesDriveId, prefetch.startPageToken, *access); //throw SysError
+
+            protectedSession->access([&](SessionHolder& holder)
+            {
+                if (holder.session)
+                    for (const GdriveDrivesBuffer::ChangesPrefetch& prefetch : prefetches)
+                        holder.session->drivesBuf.ref().applyPrefetchedChanges(prefetch);
+            });
+        }
+        return true;
     }
 
     static std::optional<UserSession> loadSession(const Zstring& dbFilePath, int timeoutSec) //throw FileError
@@ -2818,7 +3922,7 @@ private:
                     throw SysError(_("File content is corrupted.") + L" (invalid header)");
 
                 const int version = readNumber<int32_t>(streamIn);
-                if (version != 4 &&
+                if (version != 4 && version != 5 &&
                     version != DB_FILE_VERSION)
                     throw SysError(_("Unsupported data format.") + L' ' + replaceCpy(_("Version: %x"), L"%x", numberTo<std::wstring>(version)));
 
@@ -2828,8 +3932,8 @@ private:
                 accessBuf.ref().setContextTimeout(timeoutSec2); //not used by GdriveDrivesBuffer(), but let's be consistent
                 auto drivesBuf = [&]
                 {
-                    //TODO: remove migration code at some time! 2021-05-15
-                    if (version <= 4) //fully discard old state due to revamped shared drive handling
+                    //TODO: remove migration code at some time! 2021-05-15, 2026-10-14
+                    if (version <= 5) //fully discard old state: 4: revamped shared drive handling, 5: cached items are without md5Checksum
                         return makeSharedRef<GdriveDrivesBuffer>(accessBuf.ref()); //throw SysError
                     else
                         return makeSharedRef<GdriveDrivesBuffer>(streamInBody, accessBuf.ref()); //throw SysError
@@ -2853,18 +3957,30 @@ private:
     {
         bool dbWasLoaded = false;
         std::optional<UserSession> session;
+        std::optional<uint32_t> dbSavedCrc;
     };
-    using GlobalSessions = std::unordered_map<std::string /*Google account email*/, Protected<SessionHolder>, StringHashAsciiNoCase, StringEqualAsciiNoCase>;
+    using GlobalSessions = std::unordered_map<std::string /*Google account email*/, ProtectedShared<SessionHolder>, StringHashAsciiNoCase, StringEqualAsciiNoCase>;
 
     Protected<GlobalSessions> globalSessions_;
     const Zstring configDirPath_;
 
+    struct PrefetchAccount
+    {
+        int timeoutSec = 0;
+        std::chrono::steady_clock::time_point startTime;
+    };
+    using PrefetchAccounts = std::unordered_map<std::string /*Google account email*/, PrefetchAccount, StringHashAsciiNoCase, StringEqualAsciiNoCase>;
+    Protected<PrefetchAccounts> prefetchAccounts_;
+
     const SharedRef<std::function<void()>> onBeforeSystemShutdownCookie_ = makeSharedRef<std::function<void()>>([this]
     {
         try //let's not lose Google Drive data due to unexpected system shutdown:
         { saveActiveSessions(); } //throw FileError
         catch (FileError&) { assert(false); }
     });
+
+    InterruptibleThread sessionSaver_;      //declare last: start after all other members are initialized
+    InterruptibleThread changesPrefetcher_; //
 };
 //==========================================================================================
 constinit Global<GdrivePersistentSessions> globalGdriveSessions;
@@ -2878,6 +3994,15 @@ GdrivePersistentSessions::AsyncAccessInfo accessGlobalFileState(const GdriveLogi
     throw SysError(formatSystemError("accessGlobalFileState", L"", L"Function call not allowed during init/shutdown."));
 }
 
+
+GdrivePersistentSessions::AsyncAccessInfo lookupGlobalFileState(const GdriveLogin& login, const std::function<void(const GdriveFileStateAtLocation& fileState)>& useFileState /*throw X*/) //throw SysError, X
+{
+    if (const std::shared_ptr<GdrivePersistentSessions> gps = globalGdriveSessions.get())
+        return gps->lookupGlobalFileState(login, useFileState); //throw SysError, X
+
+    throw SysError(formatSystemError("lookupGlobalFileState", L"", L"Function call not allowed during init/shutdown."));
+}
+
 //==========================================================================================
 //==========================================================================================
 
@@ -2896,7 +4021,7 @@ struct GetDirDetails
         {
             std::string folderId;
             std::optional<std::vector<GdriveItem>> childItemsBuf;
-            const GdrivePersistentSessions::AsyncAccessInfo aai = accessGlobalFileState(folderPath_.gdriveLogin, [&](GdriveFileStateAtLocation& fileState) //throw SysError
+            const GdrivePersistentSessions::AsyncAccessInfo aai = lookupGlobalFileState(folderPath_.gdriveLogin, [&](const GdriveFileStateAtLocation& fileState) //throw SysError
             {
                 const auto& [itemId, itemDetails] = fileState.getFileAttributes(folderPath_.itemPath, true /*followLeafShortcut*/); //throw SysError
 
@@ -2947,7 +4072,7 @@ struct GetShortcutTargetDetails
         try
         {
             std::optional<GdriveItemDetails> targetDetailsBuf;
-            const GdrivePersistentSessions::AsyncAccessInfo aai = accessGlobalFileState(shortcutPath_.gdriveLogin, [&](GdriveFileStateAtLocation& fileState) //throw SysError
+            const GdrivePersistentSessions::AsyncAccessInfo aai = lookupGlobalFileState(shortcutPath_.gdriveLogin, [&](const GdriveFileStateAtLocation& fileState) //throw SysError
             {
                 targetDetailsBuf = fileState.all().tryGetBufferedItemDetails(shortcutDetails_.targetId);
             });
@@ -2977,32 +4102,21 @@ private:
 };
 
 
-class SingleFolderTraverser
+struct TraverserWorkItem
 {
-public:
-    SingleFolderTraverser(const GdriveLogin& gdriveLogin, const std::vector<std::pair<AfsPath, std::shared_ptr<AFS::TraverserCallback>>>& workload /*throw X*/) :
-        gdriveLogin_(gdriveLogin), workload_(workload)
-    {
-        while (!workload_.empty())
-        {
-            auto wi = std::move(workload_.    back()); //yes, no strong exception guarantee (std::bad_alloc)
-            /**/                workload_.pop_back();  //
-            const auto& [folderPath, cb] = wi;
+    AfsPath dirPath;
+    std::shared_ptr<AFS::TraverserCallback> cb;
+};
 
-            tryReportingDirError([&] //throw X
-            {
-                traverseWithException(folderPath, *cb); //throw FileError, X
-            }, *cb);
-        }
-    }
 
-private:
-    SingleFolderTraverser           (const SingleFolderTraverser&) = delete;
-    SingleFolderTraverser& operator=(const SingleFolderTraverser&) = delete;
+//read a single folder: sub folders to traverse next are appended to "workload"
+void traverseFolderFlat(const GdriveLogin& gdriveLogin, const TraverserWorkItem& wi, std::vector<TraverserWorkItem>& workload) //throw X
+{
+    AFS::TraverserCallback& cb = *wi.cb;
 
-    void traverseWithException(const AfsPath& folderPath, AFS::TraverserCallback& cb) //throw FileError, X
+    tryReportingDirError([&] //throw X
     {
-        const std::vector<GdriveItem>& childItems = GetDirDetails({gdriveLogin_, folderPath})().childItems; //throw FileError
+        const std::vector<GdriveItem>& childItems = GetDirDetails({gdriveLogin, wi.dirPath})().childItems; //throw FileError
 
         for (const GdriveItem& item : childItems)
         {
@@ -3017,8 +4131,8 @@ private:
                 case GdriveItemType::folder:
                     if (std::shared_ptr<AFS::TraverserCallback> cbSub = cb.onFolder({itemName, false /*isFollowedSymlink*/})) //throw X
                     {
-                        const AfsPath afsItemPath(appendPath(folderPath.value, itemName));
-                        workload_.push_back({afsItemPath, std::move(cbSub)});
+                        const AfsPath afsItemPath(appendPath(wi.dirPath.value, itemName));
+                        workload.push_back({afsItemPath, std::move(cbSub)});
                     }
                     break;
 
@@ -3027,19 +4141,19 @@ private:
                     {
                         case AFS::TraverserCallback::HandleLink::follow:
                         {
-                            const AfsPath afsItemPath(appendPath(folderPath.value, itemName));
+                            const AfsPath afsItemPath(appendPath(wi.dirPath.value, itemName));
 
                             GdriveItemDetails targetDetails = {};
                             if (!tryReportingItemError([&] //throw X
                         {
-                            targetDetails = GetShortcutTargetDetails({gdriveLogin_, afsItemPath}, item.details)().target; //throw FileError
+                            targetDetails = GetShortcutTargetDetails({gdriveLogin, afsItemPath}, item.details)().target; //throw FileError
                             }, cb, itemName))
                             continue;
 
                             if (targetDetails.type == GdriveItemType::folder)
                             {
                                 if (std::shared_ptr<AFS::TraverserCallback> cbSub = cb.onFolder({itemName, true /*isFollowedSymlink*/})) //throw X
-                                    workload_.push_back({afsItemPath, std::move(cbSub)});
+                                    workload.push_back({afsItemPath, std::move(cbSub)});
                             }
                             else //a file or named pipe, etc.
                                 cb.onFile({itemName, targetDetails.fileSize, targetDetails.modTime, getGdriveFilePrint(item.details.targetId), true /*isFollowedSymlink*/}); //throw X
@@ -3052,16 +4166,31 @@ private:
                     break;
             }
         }
-    }
-
-    const GdriveLogin gdriveLogin_;
-    std::vector<std::pair<AfsPath, std::shared_ptr<AFS::TraverserCallback>>> workload_;
-};
+    }, cb);
+}
 
 
-void gdriveTraverseFolderRecursive(const GdriveLogin& gdriveLogin, const std::vector<std::pair<AfsPath, std::shared_ptr<AFS::TraverserCallback>>>& workload /*throw X*/, size_t) //throw X
+void gdriveTraverseFolderRecursive(const GdriveLogin& gdriveLogin, const std::vector<std::pair<AfsPath, std::shared_ptr<AFS::TraverserCallback>>>& workload /*throw X*/, size_t parallelOps) //throw X
 {
-    SingleFolderTraverser dummy(gdriveLogin, workload); //throw X
+    std::vector<TraverserWorkItem> workItems;
+    for (const auto& [folderPath, cb] : workload)
+        workItems.push_back({folderPath, cb});
+
+    //HTTP sessions are pooled (see HttpSessionManager) and GdriveFileState is only locked for buffer access, not for readFolderContent()
+    //=> keep "parallelOps" folder listings in flight
+    if (parallelOps >= 2)
+        return ParallelFolderTraverser<TraverserWorkItem>(std::move(workItems), parallelOps, Zstr("Gdrive Traverser"), [&gdriveLogin](const TraverserWorkItem& wi, std::vector<TraverserWorkItem>& subFolders)
+    {
+        traverseFolderFlat(gdriveLogin, wi, subFolders); //throw X
+    }).run(); //throw X
+
+    while (!workItems.empty())
+    {
+        TraverserWorkItem wi = std::move(workItems.    back()); //yes, no strong exception guarantee (std::bad_alloc)
+        /**/                              workItems.pop_back();  //
+
+        traverseFolderFlat(gdriveLogin, wi, workItems); //throw X
+    }
 }
 //==========================================================================================
 //==========================================================================================
@@ -3079,11 +4208,14 @@ struct InputStreamGdrive : public AFS::InputStream
             {
                 GdriveAccess access;
                 std::string fileId;
+                uint64_t fileSize = 0;
                 try
                 {
-                    access = accessGlobalFileState(gdrivePath.gdriveLogin, [&](GdriveFileStateAtLocation& fileState) //throw SysError
+                    access = lookupGlobalFileState(gdrivePath.gdriveLogin, [&](const GdriveFileStateAtLocation& fileState) //throw SysError
                     {
-                        fileId = fileState.getItemId(gdrivePath.itemPath, true /*followLeafShortcut*/); //throw SysError
+                        const auto& [itemId, itemDetails] = fileState.getFileAttributes(gdrivePath.itemPath, true /*followLeafShortcut*/); //throw SysError
+                        fileId   = itemId;
+                        fileSize = itemDetails.fileSize;
                     }).access;
                 }
                 catch (const SysError& e) { throw FileError(replaceCpy(_("Cannot open file %x."), L"%x", fmtPath(getGdriveDisplayPath(gdrivePath))), e.toString()); }
@@ -3095,7 +4227,10 @@ struct InputStreamGdrive : public AFS::InputStream
                         return asyncStreamOut->write(buffer, bytesToWrite); //throw ThreadStopRequest
                     };
 
-                    gdriveDownloadFile(fileId, writeBlock, access); //throw SysError, ThreadStopRequest
+                    if (fileSize >= GDRIVE_RANGED_DOWNLOAD_MIN)
+                        gdriveDownloadFileRanged(fileId, fileSize, writeBlock, access); //throw SysError, ThreadStopRequest
+                    else
+                        gdriveDownloadFile(fileId, writeBlock, access); //throw SysError, ThreadStopRequest
                 }
                 catch (const SysError& e) { throw FileError(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(getGdriveDisplayPath(gdrivePath))), e.toString()); }
 
@@ -3125,7 +4260,7 @@ struct InputStreamGdrive : public AFS::InputStream
         AFS::StreamAttributes attr = {};
         try
         {
-            accessGlobalFileState(gdrivePath_.gdriveLogin, [&](GdriveFileStateAtLocation& fileState) //throw SysError
+            lookupGlobalFileState(gdrivePath_.gdriveLogin, [&](const GdriveFileStateAtLocation& fileState) //throw SysError
             {
                 const auto& [itemId, itemDetails] = fileState.getFileAttributes(gdrivePath_.itemPath, true /*followLeafShortcut*/); //throw SysError
                 attr.modTime  = itemDetails.modTime;
@@ -3158,7 +4293,7 @@ private:
 struct OutputStreamGdrive : public AFS::OutputStreamImpl
 {
     OutputStreamGdrive(const GdrivePath& gdrivePath, //throw SysError
-                       std::optional<uint64_t> /*streamSize*/,
+                       std::optional<uint64_t> streamSize,
                        std::optional<time_t> modTime,
                        const IoCallback& notifyUnbufferedIO /*throw X*/,
                        std::unique_ptr<PathAccessLock>&& pal) :
@@ -3171,7 +4306,7 @@ struct OutputStreamGdrive : public AFS::OutputStreamImpl
         //        otherwise ~OutputStreamImpl() will delete the already existing file! => don't check asynchronously!
         const Zstring fileName = AFS::getItemName(gdrivePath.itemPath);
         std::string parentId;
-        /*const*/ GdrivePersistentSessions::AsyncAccessInfo aai = accessGlobalFileState(gdrivePath.gdriveLogin, [&](GdriveFileStateAtLocation& fileState) //throw SysError
+        /*const*/ GdrivePersistentSessions::AsyncAccessInfo aai = lookupGlobalFileState(gdrivePath.gdriveLogin, [&](const GdriveFileStateAtLocation& fileState) //throw SysError
         {
             const GdriveFileState::PathStatus& ps = fileState.getPathStatus(gdrivePath.itemPath, false /*followLeafShortcut*/); //throw SysError
             if (ps.relPath.empty())
@@ -3183,7 +4318,7 @@ struct OutputStreamGdrive : public AFS::OutputStreamImpl
             parentId = ps.existingItemId;
         });
 
-        worker_ = InterruptibleThread([gdrivePath, modTime, fileName, asyncStreamIn = this->asyncStreamOut_,
+        worker_ = InterruptibleThread([gdrivePath, streamSize, modTime, fileName, asyncStreamIn = this->asyncStreamOut_,
                                                    pFilePrint = std::move(pFilePrint),
                                                    parentId   = std::move(parentId),
                                                    aai        = std::move(aai),
@@ -3202,7 +4337,7 @@ struct OutputStreamGdrive : public AFS::OutputStreamImpl
                 //=> 1. issue likely on Google's side => 2. persists even after having fixed "Expect: 100-continue"
                 const std::string fileIdNew = //streamSize && *streamSize < 5 * 1024 * 1024 ?
                     //gdriveUploadSmallFile(fileName, parentId, *streamSize, modTime, readBlock, aai.access) : //throw SysError, ThreadStopRequest
-                    gdriveUploadFile       (fileName, parentId,              modTime, readBlock, aai.access);  //throw SysError, ThreadStopRequest
+                    gdriveUploadFile       (fileName, parentId, streamSize, modTime, readBlock, aai.access);  //throw SysError, ThreadStopRequest
                 assert(asyncStreamIn->getTotalBytesRead() == asyncStreamIn->getTotalBytesWritten());
                 //already existing: creates duplicate
 
@@ -3293,7 +4428,7 @@ public:
         try
         {
             GdriveFileState::PathStatus ps;
-            accessGlobalFileState(gdriveLogin_, [&](GdriveFileStateAtLocation& fileState) //throw SysError
+            lookupGlobalFileState(gdriveLogin_, [&](const GdriveFileStateAtLocation& fileState) //throw SysError
             {
                 ps = fileState.getPathStatus(folderPath, true /*followLeafShortcut*/); //throw SysError
             });
@@ -3319,7 +4454,7 @@ private:
             throw SysError(L"Item is device root");
 
         std::string parentId;
-        accessGlobalFileState(gdriveLogin_, [&](GdriveFileStateAtLocation& fileState) //throw SysError
+        lookupGlobalFileState(gdriveLogin_, [&](const GdriveFileStateAtLocation& fileState) //throw SysError
         {
             parentId = fileState.getItemId(*parentPath, true /*followLeafShortcut*/); //throw SysError
         });
@@ -3359,7 +4494,7 @@ private:
         try
         {
             GdriveFileState::PathStatus ps;
-            accessGlobalFileState(gdriveLogin_, [&](GdriveFileStateAtLocation& fileState) //throw SysError
+            lookupGlobalFileState(gdriveLogin_, [&](const GdriveFileStateAtLocation& fileState) //throw SysError
             {
                 ps = fileState.getPathStatus(afsPath, false /*followLeafShortcut*/); //throw SysError
             });
@@ -3388,7 +4523,7 @@ private:
 
             const Zstring folderName = getItemName(afsPath);
             std::string parentId;
-            const GdrivePersistentSessions::AsyncAccessInfo aai = accessGlobalFileState(gdriveLogin_, [&](GdriveFileStateAtLocation& fileState) //throw SysError
+            const GdrivePersistentSessions::AsyncAccessInfo aai = lookupGlobalFileState(gdriveLogin_, [&](const GdriveFileStateAtLocation& fileState) //throw SysError
             {
                 const GdriveFileState::PathStatus& ps = fileState.getPathStatus(afsPath, false /*followLeafShortcut*/); //throw SysError
                 if (ps.relPath.empty())
@@ -3415,7 +4550,7 @@ private:
     {
         std::string itemId;
         std::optional<std::string> parentIdToUnlink;
-        const GdrivePersistentSessions::AsyncAccessInfo aai = accessGlobalFileState(gdriveLogin_, [&](GdriveFileStateAtLocation& fileState) //throw SysError
+        const GdrivePersistentSessions::AsyncAccessInfo aai = lookupGlobalFileState(gdriveLogin_, [&](const GdriveFileStateAtLocation& fileState) //throw SysError
         {
             const std::optional<AfsPath> parentPath = getParentPath(afsPath);
             if (!parentPath) throw SysError(L"Item is device root");
@@ -3490,6 +4625,12 @@ private:
     }
 
     //----------------------------------------------------------------------------------------------------------------
+    void setModTime(const AfsPath& afsPath, time_t modTime) const override //throw FileError, follows symlinks
+    {
+        //modification time is set only when uploading: changing it later would have to update the buffered file state, too
+        throw FileError(replaceCpy(_("Cannot write modification time of %x."), L"%x", fmtPath(getDisplayPath(afsPath))), _("Operation not supported by device."));
+    }
+
     AbstractPath getSymlinkResolvedPath(const AfsPath& afsPath) const override //throw FileError
     {
         //this function doesn't make sense for Google Drive: Shortcuts do not refer by path, but ID!
@@ -3504,7 +4645,7 @@ private:
             try
             {
                 std::string targetId;
-                const GdrivePersistentSessions::AsyncAccessInfo aai = accessGlobalFileState(gdriveFs.gdriveLogin_, [&](GdriveFileStateAtLocation& fileState) //throw SysError
+                const GdrivePersistentSessions::AsyncAccessInfo aai = lookupGlobalFileState(gdriveFs.gdriveLogin_, [&](const GdriveFileStateAtLocation& fileState) //throw SysError
                 {
                     const GdriveItemDetails& itemDetails = fileState.getFileAttributes(afsPath, false /*followLeafShortcut*/).second; //throw SysError
                     if (itemDetails.type != GdriveItemType::shortcut)
@@ -3528,6 +4669,28 @@ private:
         return std::make_unique<InputStreamGdrive>(getGdrivePath(afsPath), notifyUnbufferedIO);
     }
 
+    std::vector<HashAlgorithm> getServerHashAlgorithms() const override { return {HashAlgorithm::md5}; }
+
+    //md5Checksum is buffered with the file state => no extra server round-trip per file
+    std::optional<std::string> getServerFileHash(const AfsPath& afsPath, HashAlgorithm algo) const override
+    {
+        if (algo != HashAlgorithm::md5)
+            return {};
+
+        std::string md5;
+        try
+        {
+            lookupGlobalFileState(gdriveLogin_, [&](const GdriveFileStateAtLocation& fileState) //throw SysError
+            {
+                md5 = fileState.getFileAttributes(afsPath, true /*followLeafShortcut*/).second.md5; //throw SysError
+            });
+        }
+        catch (SysError&) { return {}; } //let regular file access report errors
+        if (md5.empty())
+            return {};
+        return md5;
+    }
+
     //already existing: undefined behavior! (e.g. fail/overwrite/auto-rename)
     //=> actual behavior: 1. fails or 2. creates duplicate (unlikely)
     std::unique_ptr<OutputStreamImpl> getOutputStream(const AfsPath& afsPath, //throw FileError
@@ -3557,22 +4720,27 @@ private:
     }
     //----------------------------------------------------------------------------------------------------------------
 
+    bool hasServerSideCopy(const AbstractPath& apTarget) const override
+    {
+        return equalAsciiNoCase(gdriveLogin_.email, static_cast<const GdriveFileSystem&>(apTarget.afsDevice.ref()).gdriveLogin_.email);
+    }
+
     //symlink handling: follow
     //already existing: undefined behavior! (e.g. fail/overwrite/auto-rename)
     //=> actual behavior: 1. fails or 2. creates duplicate (unlikely)
     FileCopyResult copyFileForSameAfsType(const AfsPath& afsSource, const StreamAttributes& attrSource, //throw FileError, (ErrorFileLocked), (X)
-                                          const AbstractPath& apTarget, bool copyFilePermissions, const IoCallback& notifyUnbufferedIO /*throw X*/) const override
+                                          const AbstractPath& apTarget, bool copyFilePermissions, const IoCallback& notifyUnbufferedIO /*throw X*/,
+                                          std::optional<HashAlgorithm> sourceHashAlgo) const override
     {
-        //no native Google Drive file copy => use stream-based file copy:
         if (copyFilePermissions)
             throw FileError(replaceCpy(_("Cannot write permissions of %x."), L"%x", fmtPath(AFS::getDisplayPath(apTarget))), _("Operation not supported by device."));
 
         const GdriveFileSystem& fsTarget = static_cast<const GdriveFileSystem&>(apTarget.afsDevice.ref());
 
-        if (!equalAsciiNoCase(gdriveLogin_.email, fsTarget.gdriveLogin_.email))
+        if (!hasServerSideCopy(apTarget)) //different accounts => use stream-based file copy:
             //already existing: undefined behavior! (e.g. fail/overwrite/auto-rename)
             //=> actual behavior: 1. fails or 2. creates duplicate (unlikely)
-            return copyFileAsStream(afsSource, attrSource, apTarget, notifyUnbufferedIO); //throw FileError, (ErrorFileLocked), X
+            return copyFileAsStream(afsSource, attrSource, apTarget, notifyUnbufferedIO, sourceHashAlgo); //throw FileError, (ErrorFileLocked), X
         //else: copying files within account works, e.g. between My Drive <-> shared drives
 
         try
@@ -3583,7 +4751,7 @@ private:
             const Zstring itemNameNew = getItemName(apTarget);
             std::string itemIdSrc;
             GdriveItemDetails itemDetailsSrc;
-            /*const GdrivePersistentSessions::AsyncAccessInfo aaiSrc =*/ accessGlobalFileState(gdriveLogin_, [&](GdriveFileStateAtLocation& fileState) //throw SysError
+            /*const GdrivePersistentSessions::AsyncAccessInfo aaiSrc =*/ lookupGlobalFileState(gdriveLogin_, [&](const GdriveFileStateAtLocation& fileState) //throw SysError
             {
                 std::tie(itemIdSrc, itemDetailsSrc) = fileState.getFileAttributes(afsSource, true /*followLeafShortcut*/); //throw SysError
 
@@ -3593,7 +4761,7 @@ private:
             });
 
             std::string parentIdTrg;
-            const GdrivePersistentSessions::AsyncAccessInfo aaiTrg = accessGlobalFileState(fsTarget.gdriveLogin_, [&](GdriveFileStateAtLocation& fileState) //throw SysError
+            const GdrivePersistentSessions::AsyncAccessInfo aaiTrg = lookupGlobalFileState(fsTarget.gdriveLogin_, [&](const GdriveFileStateAtLocation& fileState) //throw SysError
             {
                 const GdriveFileState::PathStatus psTo = fileState.getPathStatus(apTarget.afsPath, false /*followLeafShortcut*/); //throw SysError
                 if (psTo.relPath.empty())
@@ -3618,6 +4786,7 @@ private:
                 newFileItem.details.owner = fileState.all().getSharedDriveName().empty() ? FileOwner::me : FileOwner::none;
                 newFileItem.details.fileSize = itemDetailsSrc.fileSize;
                 newFileItem.details.modTime = itemDetailsSrc.modTime;
+                newFileItem.details.md5 = itemDetailsSrc.md5; //server-side copy: same content
                 newFileItem.details.parentIds.push_back(parentIdTrg);
                 fileState.all().notifyItemCreated(aaiTrg.stateDelta, newFileItem);
             });
@@ -3655,7 +4824,7 @@ private:
         try
         {
             std::string targetId;
-            accessGlobalFileState(gdriveLogin_, [&](GdriveFileStateAtLocation& fileState) //throw SysError
+            lookupGlobalFileState(gdriveLogin_, [&](const GdriveFileStateAtLocation& fileState) //throw SysError
             {
                 const GdriveItemDetails& itemDetails = fileState.getFileAttributes(afsSource, false /*followLeafShortcut*/).second; //throw SysError
                 if (itemDetails.type != GdriveItemType::shortcut)
@@ -3671,7 +4840,7 @@ private:
 
             const Zstring shortcutName = getItemName(apTarget.afsPath);
             std::string parentId;
-            const GdrivePersistentSessions::AsyncAccessInfo aaiTrg = accessGlobalFileState(fsTarget.gdriveLogin_, [&](GdriveFileStateAtLocation& fileState) //throw SysError
+            const GdrivePersistentSessions::AsyncAccessInfo aaiTrg = lookupGlobalFileState(fsTarget.gdriveLogin_, [&](const GdriveFileStateAtLocation& fileState) //throw SysError
             {
                 const GdriveFileState::PathStatus& ps = fileState.getPathStatus(apTarget.afsPath, false /*followLeafShortcut*/); //throw SysError
                 if (ps.relPath.empty())
@@ -3730,7 +4899,7 @@ private:
             GdriveItemDetails itemDetails;
             std::string parentIdFrom;
             std::string parentIdTo;
-            const GdrivePersistentSessions::AsyncAccessInfo aai = accessGlobalFileState(gdriveLogin_, [&](GdriveFileStateAtLocation& fileState) //throw SysError
+            const GdrivePersistentSessions::AsyncAccessInfo aai = lookupGlobalFileState(gdriveLogin_, [&](const GdriveFileStateAtLocation& fileState) //throw SysError
             {
                 std::tie(itemId, itemDetails) = fileState.getFileAttributes(pathFrom, false /*followLeafShortcut*/); //throw SysError
 
@@ -3794,6 +4963,13 @@ private:
             catch (const SysError& e) { throw FileError(replaceCpy(_("Unable to connect to %x."), L"%x", fmtPath(getDisplayPath(AfsPath()))), e.toString()); }
     }
 
+    void prewarmConnections(size_t parallelOps) const override //throw FileError
+    {
+        //not a connection, but the next best thing: apply Google Drive's change feed in the background while local work is done
+        if (const std::shared_ptr<GdrivePersistentSessions> gps = globalGdriveSessions.get())
+            gps->startChangesPrefetch(gdriveLogin_);
+    }
+
     int getAccessTimeout() const override { return gdriveLogin_.timeoutSec; } //returns "0" if no timeout in force
 
     bool hasNativeTransactionalCopy() const override { return true; }
@@ -3804,7 +4980,7 @@ private:
         bool onMyDrive = false;
         try
         {
-            const GdriveAccess& access = accessGlobalFileState(gdriveLogin_, [&](GdriveFileStateAtLocation& fileState)
+            const GdriveAccess& access = lookupGlobalFileState(gdriveLogin_, [&](const GdriveFileStateAtLocation& fileState)
             { onMyDrive = fileState.all().getSharedDriveName().empty(); }).access; //throw SysError
 
             if (onMyDrive)
@@ -3868,10 +5044,13 @@ Zstring concatenateGdriveFolderPathPhrase(const GdrivePath& gdrivePath) //noexce
 }
 
 
-void fff::gdriveInit(const Zstring& configDirPath, const Zstring& caCertFilePath)
+void fff::gdriveInit(const Zstring& configDirPath, const Zstring& caCertFilePath, std::chrono::seconds httpSessionMaxIdleTime)
 {
     assert(!globalHttpSessionManager.get());
-    globalHttpSessionManager.set(std::make_unique<HttpSessionManager>(caCertFilePath));
+    globalHttpSessionManager.set(std::make_unique<HttpSessionManager>(caCertFilePath, httpSessionMaxIdleTime));
+
+    assert(!globalGdriveRequestBatcher.get());
+    globalGdriveRequestBatcher.set(std::make_unique<GdriveRequestBatcher>());
 
     assert(!globalGdriveSessions.get());
     globalGdriveSessions.set(std::make_unique<GdrivePersistentSessions>(configDirPath));
@@ -3891,6 +5070,9 @@ std::wstring /*warningMsg*/ fff::gdriveTeardown()
     assert(globalGdriveSessions.get());
     globalGdriveSessions.set(nullptr);
 
+    assert(globalGdriveRequestBatcher.get());
+    globalGdriveRequestBatcher.set(nullptr);
+
     assert(globalHttpSessionManager.get());
     globalHttpSessionManager.set(nullptr);
 
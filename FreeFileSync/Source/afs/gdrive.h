@@ -15,7 +15,8 @@ bool         acceptsItemPathPhraseGdrive(const Zstring& itemPathPhrase); //noexc
 AbstractPath createItemPathGdrive       (const Zstring& itemPathPhrase); //noexcept
 
 void gdriveInit(const Zstring& configDirPath,   //directory to store Google-Drive-specific files
-                const Zstring& caCertFilePath); //cacert.pem
+                const Zstring& caCertFilePath,  //cacert.pem
+                std::chrono::seconds httpSessionMaxIdleTime); //keep idle HTTP sessions and connections for reuse
 [[nodiscard]] std::wstring /*warningMsg*/ gdriveTeardown();
 
 //-------------------------------------------------------
@@ -30,6 +30,8 @@ using AFS = AbstractFileSystem;
 
 namespace
 {
+const size_t NATIVE_REMOVE_FOLDER_PARALLEL_OPS = 8; //concurrent unlink(): deletion of huge folder trees is latency-bound (journal commits, network mounts)
+
 
 void initComForThread() //throw FileError
 {
@@ -98,18 +100,10 @@ NativeFileInfo getFileAttributes(FileBase::FileHandle fh) //throw SysError
 struct FsItem
 {
     Zstring itemName;
+    unsigned char type; //dirent::d_type: DT_UNKNOWN if not supported by the file system
 };
-std::vector<FsItem> getDirContentFlat(const Zstring& dirPath) //throw FileError
+std::vector<FsItem> getDirContentFlat(DIR* folder, const Zstring& dirPath) //throw FileError
 {
-    //no need to check for endless recursion:
-    //1. Linux has a fixed limit on the number of symbolic links in a path
-    //2. fails with "too many open files" or "path too long" before reaching stack overflow
-
-    DIR* folder = ::opendir(dirPath.c_str()); //directory must NOT end with path separator, except "/"
-    if (!folder)
-        THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot open directory %x."), L"%x", fmtPath(dirPath)), "opendir");
-    ZEN_ON_SCOPE_EXIT(::closedir(folder)); //never close nullptr handles! -> crash
-
     std::vector<FsItem> output;
     for (;;)
     {
@@ -140,7 +134,7 @@ std::vector<FsItem> getDirContentFlat(const Zstring& dirPath) //throw FileError
         if (itemNameRaw[0] == 0) //show error instead of endless recursion!!!
             throw FileError(replaceCpy(_("Cannot read directory %x."), L"%x", fmtPath(dirPath)), formatSystemError("readdir", L"", L"Folder contains an item without name."));
 
-        output.push_back({itemNameRaw});
+        output.push_back({itemNameRaw, dirEntry->d_type});
 
         /* Unicode normalization is file-system-dependent:
 
@@ -178,11 +172,11 @@ struct FsItemDetails
     uint64_t fileSize; //unit: bytes!
     AFS::FingerPrint filePrint;
 };
-FsItemDetails getItemDetails(const Zstring& itemPath) //throw FileError
+FsItemDetails getItemDetails(int dirFd, const Zstring& itemName, const Zstring& itemPath) //throw FileError
 {
     struct stat itemInfo = {};
-    if (::lstat(itemPath.c_str(), &itemInfo) != 0) //lstat() does not resolve symlinks
-        THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot read file attributes of %x."), L"%x", fmtPath(itemPath)), "lstat");
+    if (::fstatat(dirFd, itemName.c_str(), &itemInfo, AT_SYMLINK_NOFOLLOW) != 0) //does not resolve symlinks
+        THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot read file attributes of %x."), L"%x", fmtPath(itemPath)), "fstatat");
 
     return {S_ISLNK(itemInfo.st_mode) ? ItemType::symlink : //on Linux there is no distinction between file and directory symlinks!
             /**/ (S_ISDIR(itemInfo.st_mode) ? ItemType::folder : ItemType::file), //a file or named pipe, etc. => dont't check using S_ISREG(): see comment in file_traverser.cpp
@@ -192,21 +186,29 @@ FsItemDetails getItemDetails(const Zstring& itemPath) //throw FileError
 }
 
 
-FsItemDetails getSymlinkTargetDetails(const Zstring& linkPath) //throw FileError
+struct SymlinkTargetDetails
+{
+    FsItemDetails details;
+    dev_t device;
+    ino_t inode;
+};
+SymlinkTargetDetails getSymlinkTargetDetails(int dirFd, const Zstring& linkName, const Zstring& linkPath) //throw FileError
 {
     try
     {
         struct stat itemInfo = {};
-        if (::stat(linkPath.c_str(), &itemInfo) != 0)
-            THROW_LAST_SYS_ERROR("stat");
+        if (::fstatat(dirFd, linkName.c_str(), &itemInfo, 0 /*flags: follow symlinks*/) != 0)
+            THROW_LAST_SYS_ERROR("fstatat");
 
         const ItemType targetType = S_ISDIR(itemInfo.st_mode) ? ItemType::folder : ItemType::file;
 
         const AFS::FingerPrint filePrint = targetType == ItemType::folder ? 0 : getFileFingerprint(itemInfo.st_ino);
-        return {targetType,
-                itemInfo.st_mtime,
-                makeUnsigned(itemInfo.st_size),
-                filePrint};
+        return {{targetType,
+                 itemInfo.st_mtime,
+                 makeUnsigned(itemInfo.st_size),
+                 filePrint},
+                itemInfo.st_dev,
+                itemInfo.st_ino};
     }
     catch (const SysError& e)
     {
@@ -215,52 +217,67 @@ FsItemDetails getSymlinkTargetDetails(const Zstring& linkPath) //throw FileError
 }
 
 
-class SingleFolderTraverser
+//followed folder symlinks on the path from the base folder
+struct LinkedFolder
 {
-public:
-    SingleFolderTraverser(const std::vector<std::pair<Zstring, std::shared_ptr<AFS::TraverserCallback>>>& workload /*throw X*/)
-    {
-        for (const auto& [folderPath, cb] : workload)
-            workload_.push_back({folderPath, cb});
+    dev_t device;
+    ino_t inode;
+    std::shared_ptr<const LinkedFolder> parent; //optional
+};
 
-        while (!workload_.empty())
-        {
-            WorkItem wi = std::move(workload_.    back()); //yes, no strong exception guarantee (std::bad_alloc)
-            /**/                    workload_.pop_back();  //
 
-            tryReportingDirError([&] //throw X
-            {
-                traverseWithException(wi.dirPath, *wi.cb); //throw FileError, X
-            }, *wi.cb);
-        }
-    }
+struct TraverserWorkItem
+{
+    Zstring dirPath;
+    std::shared_ptr<AFS::TraverserCallback> cb;
+    std::shared_ptr<const LinkedFolder> linkedFolders; //optional
+};
 
-private:
-    SingleFolderTraverser           (const SingleFolderTraverser&) = delete;
-    SingleFolderTraverser& operator=(const SingleFolderTraverser&) = delete;
 
-    void traverseWithException(const Zstring& dirPath, AFS::TraverserCallback& cb) //throw FileError, X
+//read a single folder: sub folders to traverse next are appended to "workload"
+void traverseFolderFlat(const TraverserWorkItem& wi, std::vector<TraverserWorkItem>& workload) //throw X
+{
+    AFS::TraverserCallback& cb = *wi.cb;
+
+    tryReportingDirError([&] //throw X
     {
-        for (const auto& [itemName] : getDirContentFlat(dirPath)) //throw FileError
+        //no need to check for stack overflow:
+        //1. Linux has a fixed limit on the number of symbolic links in a path
+        //2. fails with "too many open files" or "path too long" before reaching stack overflow
+        //still: a symlink to a parent folder is detected after one round at the latest (see linkedFolders) instead of recursing up to FOLDER_TRAVERSAL_LEVEL_MAX
+
+        DIR* folder = ::opendir(wi.dirPath.c_str()); //directory must NOT end with path separator, except "/"
+        if (!folder)
+            THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot open directory %x."), L"%x", fmtPath(wi.dirPath)), "opendir");
+        ZEN_ON_SCOPE_EXIT(::closedir(folder)); //never close nullptr handles! -> crash
+
+        //keep folder open: get item details relative to the directory handle => no path lookup per item (deep trees, network file systems)
+        const int dirFd = ::dirfd(folder);
+        if (dirFd == -1)
+            THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot open directory %x."), L"%x", fmtPath(wi.dirPath)), "dirfd");
+
+        for (auto& [itemName, itemType] : getDirContentFlat(folder, wi.dirPath)) //throw FileError
         {
-            const Zstring itemPath = appendPath(dirPath, itemName);
+            const Zstring itemPath = appendPath(wi.dirPath, itemName);
 
             FsItemDetails itemDetails = {};
-            if (!tryReportingItemError([&] //throw X
+            if (itemType == DT_DIR) //folders need no details => skip stat() if the file system reports the type
+                itemDetails.type = ItemType::folder;
+            else if (!tryReportingItemError([&] //throw X
         {
-            itemDetails = getItemDetails(itemPath); //throw FileError
+            itemDetails = getItemDetails(dirFd, itemName, itemPath); //throw FileError
             }, cb, itemName))
             continue; //ignore error: skip file
 
             switch (itemDetails.type)
             {
                 case ItemType::file:
-                    cb.onFile({itemName, itemDetails.fileSize, itemDetails.modTime, itemDetails.filePrint, false /*isFollowedSymlink*/}); //throw X
+                    cb.onFile({std::move(itemName), itemDetails.fileSize, itemDetails.modTime, itemDetails.filePrint, false /*isFollowedSymlink*/}); //throw X
                     break;
 
                 case ItemType::folder:
                     if (std::shared_ptr<AFS::TraverserCallback> cbSub = cb.onFolder({itemName, false /*isFollowedSymlink*/})) //throw X
-                        workload_.push_back({itemPath, std::move(cbSub)});
+                        workload.push_back({itemPath, std::move(cbSub), wi.linkedFolders});
                     break;
 
                 case ItemType::symlink:
@@ -268,20 +285,27 @@ private:
                     {
                         case AFS::TraverserCallback::HandleLink::follow:
                         {
-                            FsItemDetails targetDetails = {};
+                            SymlinkTargetDetails target = {};
                             if (!tryReportingItemError([&] //throw X
                         {
-                            targetDetails = getSymlinkTargetDetails(itemPath); //throw FileError
+                            target = getSymlinkTargetDetails(dirFd, itemName, itemPath); //throw FileError
+
+                            //target already followed on this path => endless recursion: compare file IDs, no need to wait for FOLDER_TRAVERSAL_LEVEL_MAX
+                            if (target.details.type == ItemType::folder)
+                                for (const LinkedFolder* lf = wi.linkedFolders.get(); lf; lf = lf->parent.get())
+                                    if (lf->device == target.device && lf->inode == target.inode)
+                                        throw FileError(replaceCpy(_("Cannot read directory %x."), L"%x", fmtPath(itemPath)), L"Endless recursion.");
                             }, cb, itemName))
                             continue;
 
-                            if (targetDetails.type == ItemType::folder)
+                            if (target.details.type == ItemType::folder)
                             {
                                 if (std::shared_ptr<AFS::TraverserCallback> cbSub = cb.onFolder({itemName, true /*isFollowedSymlink*/})) //throw X
-                                    workload_.push_back({itemPath, std::move(cbSub)}); //symlink may link to different volume!
+                                    workload.push_back({itemPath, std::move(cbSub), //symlink may link to different volume!
+                                                        std::make_shared<const LinkedFolder>(LinkedFolder{target.device, target.inode, wi.linkedFolders})});
                             }
                             else //a file or named pipe, etc.
-                                cb.onFile({itemName, targetDetails.fileSize, targetDetails.modTime, targetDetails.filePrint, true /*isFollowedSymlink*/}); //throw X
+                                cb.onFile({itemName, target.details.fileSize, target.details.modTime, target.details.filePrint, true /*isFollowedSymlink*/}); //throw X
                         }
                         break;
 
@@ -291,20 +315,26 @@ private:
                     break;
             }
         }
-    }
-
-    struct WorkItem
-    {
-        Zstring dirPath;
-        std::shared_ptr<AFS::TraverserCallback> cb;
-    };
-    std::vector<WorkItem> workload_;
-};
+    }, cb);
+}
 
 
-void traverseFolderRecursiveNative(const std::vector<std::pair<Zstring, std::shared_ptr<AFS::TraverserCallback>>>& workload /*throw X*/, size_t) //throw X
+void traverseFolderRecursiveNative(const std::vector<std::pair<Zstring, std::shared_ptr<AFS::TraverserCallback>>>& workload /*throw X*/, size_t parallelOps) //throw X
 {
-    SingleFolderTraverser dummy(workload); //throw X
+    std::vector<TraverserWorkItem> workItems;
+    for (const auto& [folderPath, cb] : workload)
+        workItems.push_back({folderPath, cb, nullptr /*linkedFolders*/});
+
+    if (parallelOps >= 2)
+        return ParallelFolderTraverser<TraverserWorkItem>(std::move(workItems), parallelOps, Zstr("Native Traverser"), traverseFolderFlat).run(); //throw X
+
+    while (!workItems.empty())
+    {
+        TraverserWorkItem wi = std::move(workItems.    back()); //yes, no strong exception guarantee (std::bad_alloc)
+        /**/                              workItems.pop_back();  //
+
+        traverseFolderFlat(wi, workItems); //throw X
+    }
 }
 //====================================================================================================
 //====================================================================================================
@@ -319,13 +349,20 @@ public:
 
 private:
     const Zstring baseFolderPath_; //ends with path separator
+    TrashSession trashSession_; //resolve trash folder once per device: g_file_trash() is slow for many items
 };
 
 //===========================================================================================================================
 
 struct InputStreamNative : public AFS::InputStream
 {
-    InputStreamNative(const Zstring& filePath, const IoCallback& notifyUnbufferedIO /*throw X*/) : fi_(filePath, notifyUnbufferedIO) {} //throw FileError, ErrorFileLocked
+    InputStreamNative(const Zstring& filePath, uint64_t offset, const IoCallback& notifyUnbufferedIO /*throw X*/) : //throw FileError, ErrorFileLocked
+        fi_(filePath, notifyUnbufferedIO) //throw FileError, ErrorFileLocked
+    {
+        if (offset != 0)
+            if (::lseek(fi_.getHandle(), offset, SEEK_SET) == -1)
+                THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(filePath)), "lseek");
+    }
 
     size_t read(void* buffer, size_t bytesToRead) override { return fi_.read(buffer, bytesToRead); } //throw FileError, ErrorFileLocked, X; return "bytesToRead" bytes unless end of stream!
     size_t getBlockSize() const override { return fi_.getBlockSize(); } //non-zero block size is AFS contract!
@@ -361,6 +398,15 @@ struct OutputStreamNative : public AFS::OutputStreamImpl
             fo_.reserveSpace(*streamSize); //throw FileError
     }
 
+    //write into existing file (without truncation), e.g. one range of a segmented file copy
+    OutputStreamNative(const Zstring& filePath, uint64_t offset, std::optional<time_t> modTime, const IoCallback& notifyUnbufferedIO /*throw X*/) : //throw FileError
+        fo_(openExistingFileForWrite(filePath), filePath, notifyUnbufferedIO),
+        modTime_(modTime)
+    {
+        if (::lseek(fo_.getHandle(), offset, SEEK_SET) == -1)
+            THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(filePath)), "lseek");
+    }
+
     void write(const void* buffer, size_t bytesToWrite) override { fo_.write(buffer, bytesToWrite); } //throw FileError, X
 
     AFS::FinalizeResult finalize() override //throw FileError, X
@@ -389,6 +435,14 @@ struct OutputStreamNative : public AFS::OutputStreamImpl
     }
 
 private:
+    static FileBase::FileHandle openExistingFileForWrite(const Zstring& filePath) //throw FileError
+    {
+        const int fdFile = ::open(filePath.c_str(), O_WRONLY | O_CLOEXEC);
+        if (fdFile == -1) //don't check "< 0" -> docu seems to allow "-2" to be a valid file handle
+            THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(filePath)), "open");
+        return fdFile; //pass ownership
+    }
+
     FileOutput fo_;
     const std::optional<time_t> modTime_;
 };
@@ -476,10 +530,16 @@ private:
                                        const std::function<void (const std::wstring& displayPath)>& onBeforeFolderDeletion) const override //one call for each object!
     {
         //default implementation: folder traversal
-        AFS::removeFolderIfExistsRecursion(afsPath, onBeforeFileDeletion, onBeforeFolderDeletion); //throw FileError, X
+        removeFolderTreePipelined(afsPath, onBeforeFileDeletion, onBeforeFolderDeletion, NATIVE_REMOVE_FOLDER_PARALLEL_OPS); //throw FileError, X
     }
 
     //----------------------------------------------------------------------------------------------------------------
+    void setModTime(const AfsPath& afsPath, time_t modTime) const override //throw FileError, follows symlinks
+    {
+        initComForThread(); //throw FileError
+        setFileTime(getNativePath(afsPath), modTime, ProcSymlink::follow); //throw FileError
+    }
+
     AbstractPath getSymlinkResolvedPath(const AfsPath& afsPath) const override //throw FileError
     {
         initComForThread(); //throw FileError
@@ -514,7 +574,22 @@ private:
     std::unique_ptr<InputStream> getInputStream(const AfsPath& afsPath, const IoCallback& notifyUnbufferedIO /*throw X*/) const override //throw FileError, ErrorFileLocked
     {
         initComForThread(); //throw FileError
-        return std::make_unique<InputStreamNative>(getNativePath(afsPath), notifyUnbufferedIO); //throw FileError, ErrorFileLocked
+        return std::make_unique<InputStreamNative>(getNativePath(afsPath), 0 /*offset*/, notifyUnbufferedIO); //throw FileError, ErrorFileLocked
+    }
+
+    size_t getSegmentedCopyStreams() const override { return 1; } //random access is supported, but concurrent local streams don't help
+
+    std::unique_ptr<InputStream> getInputStreamAt(const AfsPath& afsPath, uint64_t offset, const IoCallback& notifyUnbufferedIO /*throw X*/) const override //throw FileError, ErrorFileLocked
+    {
+        initComForThread(); //throw FileError
+        return std::make_unique<InputStreamNative>(getNativePath(afsPath), offset, notifyUnbufferedIO); //throw FileError, ErrorFileLocked
+    }
+
+    std::unique_ptr<OutputStreamImpl> getOutputStreamAt(const AfsPath& afsPath, uint64_t offset, std::optional<time_t> modTime, //throw FileError
+                                                        const IoCallback& notifyUnbufferedIO /*throw X*/) const override
+    {
+        initComForThread(); //throw FileError
+        return std::make_unique<OutputStreamNative>(getNativePath(afsPath), offset, modTime, notifyUnbufferedIO); //throw FileError
     }
 
     //already existing: undefined behavior! (e.g. fail/overwrite/auto-rename)
@@ -545,28 +620,94 @@ private:
     //already existing: undefined behavior! (e.g. fail/overwrite/auto-rename)
     //=> actual behavior: fail with clear error message
     FileCopyResult copyFileForSameAfsType(const AfsPath& afsSource, const StreamAttributes& attrSource, //throw FileError, ErrorFileLocked, X
-                                          const AbstractPath& apTarget, bool copyFilePermissions, const IoCallback& notifyUnbufferedIO /*throw X*/) const override
+                                          const AbstractPath& apTarget, bool copyFilePermissions, const IoCallback& notifyUnbufferedIO /*throw X*/,
+                                          std::optional<HashAlgorithm> sourceHashAlgo) const override
     {
         const Zstring nativePathTarget = static_cast<const NativeFileSystem&>(apTarget.afsDevice.ref()).getNativePath(apTarget.afsPath);
 
+        return *copyFileNative(afsSource, nativePathTarget, copyFilePermissions, sourceHashAlgo, [&](const Zstring& nativePathSource, const auto& onSourceData)
+        {
+            return copyNewFile(nativePathSource, nativePathTarget, notifyUnbufferedIO, onSourceData); //throw FileError, ErrorTargetExisting, ErrorFileLocked, X
+        });
+    }
+
+    std::optional<FileCopyResult> copyFileDeltaForSameAfsType(const AfsPath& afsSource, const StreamAttributes& attrSource, //throw FileError, ErrorFileLocked, X
+                                                              const AbstractPath& apTarget, const AfsPath& afsBase, bool copyFilePermissions,
+                                                              const IoCallback& notifyUnbufferedIO /*throw X*/,
+                                                              std::optional<HashAlgorithm> sourceHashAlgo) const override
+    {
+        const NativeFileSystem& nativeTarget = static_cast<const NativeFileSystem&>(apTarget.afsDevice.ref());
+        const Zstring nativePathTarget = nativeTarget.getNativePath(apTarget.afsPath);
+        const Zstring nativePathBase   = nativeTarget.getNativePath(afsBase);
+
+        return copyFileNative(afsSource, nativePathTarget, copyFilePermissions, sourceHashAlgo, [&](const Zstring& nativePathSource, const auto& onSourceData)
+        {
+            return copyNewFileDelta(nativePathSource, nativePathBase, nativePathTarget, notifyUnbufferedIO, onSourceData); //throw FileError, ErrorTargetExisting, ErrorFileLocked, X
+        });
+    }
+
+    std::optional<FileCopyResult> copyFileAnonymousForSameAfsType(const AfsPath& afsSource, const StreamAttributes& attrSource, //throw FileError, ErrorFileLocked, X
+                                                                  const AbstractPath& apTarget, bool copyFilePermissions,
+                                                                  const std::function<void()>& onBeforePublish /*throw X*/,
+                                                                  const IoCallback& notifyUnbufferedIO /*throw X*/,
+                                                                  std::optional<HashAlgorithm> sourceHashAlgo) const override
+    {
+        //copyItemPermissions() works on the file path only => would have to be applied *after* the file became visible
+        if (copyFilePermissions)
+            return std::nullopt;
+
+        const Zstring nativePathTarget = static_cast<const NativeFileSystem&>(apTarget.afsDevice.ref()).getNativePath(apTarget.afsPath);
+
+        return copyFileNative(afsSource, nativePathTarget, false /*copyFilePermissions*/, sourceHashAlgo, [&](const Zstring& nativePathSource, const auto& onSourceData)
+        {
+            return copyNewFileAnonymous(nativePathSource, nativePathTarget, notifyUnbufferedIO, onSourceData, onBeforePublish); //throw FileError, ErrorTargetExisting, ErrorFileLocked, X
+        });
+    }
+
+    //copyFile: (const Zstring& nativePathSource, const std::function<void(const void* buffer, size_t bytes)>& onSourceData) -> std::optional<zen::FileCopyResult>
+    template <class Function>
+    std::optional<FileCopyResult> copyFileNative(const AfsPath& afsSource, const Zstring& nativePathTarget, bool copyFilePermissions, //throw FileError, ErrorFileLocked, X
+                                                 std::optional<HashAlgorithm> sourceHashAlgo, Function copyFile) const
+    {
+        const Zstring nativePathSource = getNativePath(afsSource);
+
         initComForThread(); //throw FileError
 
-        const zen::FileCopyResult nativeResult = copyNewFile(getNativePath(afsSource), nativePathTarget, notifyUnbufferedIO); //throw FileError, ErrorTargetExisting, ErrorFileLocked, X
+        std::optional<HashStream> hashStream;
+        std::function<void(const void* buffer, size_t bytes)> onSourceData;
+        if (sourceHashAlgo)
+            try
+            {
+                hashStream.emplace(*sourceHashAlgo); //throw SysError
+                onSourceData = [&](const void* buffer, size_t bytes)
+                {
+                    try { hashStream->update(buffer, bytes); /*throw SysError*/ }
+                    catch (const SysError& e) { throw FileError(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(nativePathSource)), e.toString()); }
+                };
+            }
+            catch (const SysError& e) { throw FileError(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(nativePathSource)), e.toString()); }
+
+        const std::optional<zen::FileCopyResult> nativeResult = copyFile(nativePathSource, onSourceData); //throw FileError, ErrorTargetExisting, ErrorFileLocked, X
+        if (!nativeResult)
+            return std::nullopt;
 
         //at this point we know we created a new file, so it's fine to delete it for cleanup!
         ZEN_ON_SCOPE_FAIL(try { zen::removeFilePlain(nativePathTarget); }
         catch (FileError&) {});
 
         if (copyFilePermissions)
-            copyItemPermissions(getNativePath(afsSource), nativePathTarget, ProcSymlink::follow); //throw FileError
+            copyItemPermissions(nativePathSource, nativePathTarget, ProcSymlink::follow); //throw FileError
 
         FileCopyResult result;
-        result.fileSize = nativeResult.fileSize;
+        result.fileSize = nativeResult->fileSize;
         //caveat: modTime will be incorrect for file systems with imprecise file times, e.g. see FAT_FILE_TIME_PRECISION_SEC
-        result.modTime = nativeFileTimeToTimeT(nativeResult.sourceModTime);
-        result.sourceFilePrint = getFileFingerprint(nativeResult.sourceFileIdx);
-        result.targetFilePrint = getFileFingerprint(nativeResult.targetFileIdx);
-        result.errorModTime = nativeResult.errorModTime;
+        result.modTime = nativeFileTimeToTimeT(nativeResult->sourceModTime);
+        result.sourceFilePrint = getFileFingerprint(nativeResult->sourceFileIdx);
+        result.targetFilePrint = getFileFingerprint(nativeResult->targetFileIdx);
+        result.errorModTime = nativeResult->errorModTime;
+        if (hashStream)
+            try { result.sourceHash = formatAsHexString(hashStream->finalize()); /*throw SysError*/ }
+            catch (const SysError& e) { throw FileError(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(nativePathSource)), e.toString()); }
         return result;
     }
 
@@ -655,6 +796,8 @@ private:
     {
     }
 
+    void prewarmConnections(size_t parallelOps) const override {} //throw FileError
+
     int getAccessTimeout() const override { return 0; } //returns "0" if no timeout in force
 
     bool hasNativeTransactionalCopy() const override { return false; }
@@ -699,7 +842,7 @@ void RecycleSessionNative::recycleItemIfExists(const AbstractPath& itemPath, con
     if (itemPathNative.empty())
         throw std::logic_error("Contract violation! " + std::string(__FILE__) + ':' + numberTo<std::string>(__LINE__));
 
-    recycleOrDeleteIfExists(itemPathNative); //throw FileError
+    trashSession_.recycleOrDeleteIfExists(itemPathNative); //throw FileError
 }
 
 
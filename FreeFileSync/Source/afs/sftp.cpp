@@ -13,6 +13,9 @@
 #include <zen/socket.h>
 #include <zen/open_ssl.h>
 #include <zen/resolve_path.h>
+#include <zen/zlib_wrap.h>
+#include <zen/guid.h>
+#include <zen/crc.h>
 #include <libssh2/libssh2_wrap.h> //DON'T include <libssh2_sftp.h> directly!
 #include "init_curl_libssh2.h"
 #include "ftp_common.h"
@@ -52,6 +55,11 @@ const Zchar sftpPrefix[] = Zstr("sftp:");
 constexpr std::chrono::seconds SFTP_SESSION_MAX_IDLE_TIME           (20);
 constexpr std::chrono::seconds SFTP_SESSION_CLEANUP_INTERVAL         (4); //facilitate default of 5-seconds delay for error retry
 constexpr std::chrono::seconds SFTP_CHANNEL_LIMIT_DETECTION_TIME_OUT(30);
+const size_t SFTP_PREWARM_PARALLEL_MAX = 8; //stay below OpenSSH's "MaxStartups 10:30:100" limit for concurrent unauthenticated connections
+const size_t SFTP_ZLIB_SAMPLE_BYTES = 4 * 1024 * 1024; //decide on zlib after this many bytes of file content have been transferred
+const int SFTP_ZLIB_SAMPLE_LEVEL = 6; //= Z_DEFAULT_COMPRESSION used by libssh2
+const size_t SFTP_REMOVE_FOLDER_PARALLEL_OPS = 4; //one SSH session per helper thread: stay well below OpenSSH's "MaxStartups" limit
+const size_t SFTP_BATCH_UPLOAD_FILES_MAX = 256; //files per tar stream: bound remote command line length (one quoted name per file)
 
 //permissions for new files: rw- rw- rw- [0666] => consider umask! (e.g. 0022 for ffs.org)
 const long SFTP_DEFAULT_PERMISSION_FILE = LIBSSH2_SFTP_S_IRUSR | LIBSSH2_SFTP_S_IWUSR |
@@ -65,8 +73,11 @@ const long SFTP_DEFAULT_PERMISSION_FOLDER = LIBSSH2_SFTP_S_IRWXU |
 
 //attention: if operation fails due to time out, e.g. file copy, the cleanup code may hang, too => total delay = 2 x time out interval
 
-const size_t SFTP_OPTIMAL_BLOCK_SIZE_READ  = 8 * MAX_SFTP_READ_SIZE;     //https://github.com/libssh2/libssh2/issues/90
-const size_t SFTP_OPTIMAL_BLOCK_SIZE_WRITE = 8 * MAX_SFTP_OUTGOING_SIZE; //
+//libssh2_sftp_read/libssh2_sftp_write split the buffer into MAX_SFTP_*_SIZE chunks and keep all of them in flight before waiting for the first reply
+//=> requests in flight := block size / MAX_SFTP_*_SIZE; default (SftpLogin::transferRequestsInFlight): 8x, see perf tests below
+//=> the pipeline window must cover bandwidth x round-trip time: high-latency links need more requests in flight
+size_t getOptimalBlockSizeRead (const SftpLogin& login) { return std::max(login.transferRequestsInFlight, 1) * MAX_SFTP_READ_SIZE;     } //https://github.com/libssh2/libssh2/issues/90
+size_t getOptimalBlockSizeWrite(const SftpLogin& login) { return std::max(login.transferRequestsInFlight, 1) * MAX_SFTP_OUTGOING_SIZE; } //
 static_assert(MAX_SFTP_READ_SIZE == 30000 && MAX_SFTP_OUTGOING_SIZE == 30000, "reevaluate optimal block sizes if these constants change!");
 
 /* Perf Test, Sourceforge frs, SFTP upload, compressed 25 MB test file:
@@ -194,6 +205,228 @@ constinit Global<UniSessionCounter> globalSftpSessionCount;
 GLOBAL_RUN_ONCE(globalSftpSessionCount.set(createUniSessionCounter()));
 
 
+/*  zlib compression is a net loss for already-compressed content (media, archives, backups) and fast links: https://freefilesync.org/forum/viewtopic.php?t=7244#p24250
+    => sample the file content transferred per login and stop using zlib if it doesn't shrink by at least 10%
+    - compression is negotiated during SSH handshake and can't be turned off for an existing session => retire zlib sessions instead     */
+class ZlibUsage
+{
+public:
+    bool isWorthwhile() const { return !disabled_; }
+
+    void addSample(const void* buffer, size_t bytes) //noexcept, thread-safe
+    {
+        if (sampleDone_ || bytes == 0)
+            return;
+
+        std::string compressed(impl::zlib_compressBound(bytes), '\0');
+        size_t bytesCompressed = 0;
+        try
+        {
+            bytesCompressed = impl::zlib_compress(buffer, bytes, compressed.data(), compressed.size(), SFTP_ZLIB_SAMPLE_LEVEL); //throw SysError
+        }
+        catch (SysError&) { assert(false); return; }
+
+        std::lock_guard dummy(lockSample_);
+        if (sampleDone_)
+            return;
+
+        bytesSampled_    += bytes;
+        bytesCompressed_ += bytesCompressed;
+
+        if (bytesSampled_ >= SFTP_ZLIB_SAMPLE_BYTES)
+        {
+            if (bytesCompressed_ * 10 > bytesSampled_ * 9)
+                disabled_ = true;
+            sampleDone_ = true;
+        }
+    }
+
+private:
+    std::atomic<bool> disabled_{false};
+    std::atomic<bool> sampleDone_{false};
+
+    std::mutex lockSample_;
+    uint64_t bytesSampled_    = 0;
+    uint64_t bytesCompressed_ = 0;
+};
+
+constinit Global<Protected<std::map<SshSessionId, std::shared_ptr<ZlibUsage>>>> globalZlibUsage;
+GLOBAL_RUN_ONCE(globalZlibUsage.set(std::make_unique<Protected<std::map<SshSessionId, std::shared_ptr<ZlibUsage>>>>()));
+
+
+//libssh2_sftp_fsetstat() before closing the handle saves a round trip compared to setting the modification time by path afterwards,
+//but some servers ignore it (Synology: https://freefilesync.org/forum/viewtopic.php?t=1281) => probe once per server
+constinit Global<Protected<std::map<SshSessionId, bool>>> globalFsetstatSupport;
+GLOBAL_RUN_ONCE(globalFsetstatSupport.set(std::make_unique<Protected<std::map<SshSessionId, bool>>>()));
+
+
+std::optional<bool> getFsetstatSupport(const SshSessionId& sessionId) //std::nullopt: not yet probed
+{
+    std::optional<bool> supported;
+    if (const auto fsetstatMap = globalFsetstatSupport.get())
+        fsetstatMap->access([&](const std::map<SshSessionId, bool>& map)
+    {
+        if (const auto it = map.find(sessionId); it != map.end())
+            supported = it->second;
+    });
+    return supported;
+}
+
+
+void setFsetstatSupport(const SshSessionId& sessionId, bool supported)
+{
+    if (const auto fsetstatMap = globalFsetstatSupport.get())
+        fsetstatMap->access([&](std::map<SshSessionId, bool>& map) { map[sessionId] = supported; });
+}
+
+
+std::shared_ptr<ZlibUsage> getZlibUsage(const SshSessionId& sessionId)
+{
+    assert(sessionId.allowZlib);
+    if (const auto zlibUsageMap = globalZlibUsage.get())
+    {
+        std::shared_ptr<ZlibUsage> usage;
+        zlibUsageMap->access([&](std::map<SshSessionId, std::shared_ptr<ZlibUsage>>& map)
+        {
+            std::shared_ptr<ZlibUsage>& entry = map[sessionId];
+            if (!entry)
+                entry = std::make_shared<ZlibUsage>();
+            usage = entry;
+        });
+        return usage;
+    }
+    return nullptr; //during static destruction
+}
+
+
+void wipeSecret(std::string& secret)
+{
+    ::explicit_bzero(secret.data(), secret.size()); //not optimized away like memset()
+    secret.clear();
+}
+
+
+//private key as passed to libssh2: reading the key file and PuTTY conversion (including passphrase decryption) only once per process
+struct DecodedPrivateKey
+{
+    DecodedPrivateKey() {}
+    DecodedPrivateKey           (const DecodedPrivateKey&) = default;
+    DecodedPrivateKey& operator=(const DecodedPrivateKey&) = default;
+    ~DecodedPrivateKey()
+    {
+        wipeSecret(keyFilePassphrase);
+        wipeSecret(pkStream);
+        wipeSecret(pkPassphrase);
+    }
+
+    std::string keyFilePassphrase; //as entered by the user
+    std::string pkStream;          //OpenSSH/PKIX format
+    std::string pkPassphrase;      //empty after PuTTY conversion
+};
+
+constinit Global<Protected<std::map<Zstring /*key file path*/, DecodedPrivateKey>>> globalPrivateKeyCache; //wiped during static destruction
+GLOBAL_RUN_ONCE(globalPrivateKeyCache.set(std::make_unique<Protected<std::map<Zstring, DecodedPrivateKey>>>()));
+
+
+std::optional<DecodedPrivateKey> getCachedPrivateKey(const Zstring& keyFilePath, const std::string& keyFilePassphrase)
+{
+    std::optional<DecodedPrivateKey> key;
+    if (const auto keyCache = globalPrivateKeyCache.get())
+        keyCache->access([&](const std::map<Zstring, DecodedPrivateKey>& cache)
+    {
+        if (const auto it = cache.find(keyFilePath);
+            it != cache.end() && it->second.keyFilePassphrase == keyFilePassphrase)
+            key = it->second;
+    });
+    return key;
+}
+
+
+void setCachedPrivateKey(const Zstring& keyFilePath, const DecodedPrivateKey& key)
+{
+    if (const auto keyCache = globalPrivateKeyCache.get())
+        keyCache->access([&](std::map<Zstring, DecodedPrivateKey>& cache) { cache[keyFilePath] = key; });
+}
+
+
+void eraseCachedPrivateKey(const Zstring& keyFilePath)
+{
+    if (const auto keyCache = globalPrivateKeyCache.get())
+        keyCache->access([&](std::map<Zstring, DecodedPrivateKey>& cache) { cache.erase(keyFilePath); });
+}
+
+
+//public key blob of the SSH agent identity that authenticated last: try it first instead of walking through all identities
+constinit Global<Protected<std::map<SshSessionId, std::string>>> globalAgentIdentity;
+GLOBAL_RUN_ONCE(globalAgentIdentity.set(std::make_unique<Protected<std::map<SshSessionId, std::string>>>()));
+
+
+std::string getAgentIdentity(const SshSessionId& sessionId) //empty if unknown
+{
+    std::string blob;
+    if (const auto identityMap = globalAgentIdentity.get())
+        identityMap->access([&](const std::map<SshSessionId, std::string>& map)
+    {
+        if (const auto it = map.find(sessionId); it != map.end())
+            blob = it->second;
+    });
+    return blob;
+}
+
+
+void setAgentIdentity(const SshSessionId& sessionId, const std::string& blob)
+{
+    if (const auto identityMap = globalAgentIdentity.get())
+        identityMap->access([&](std::map<SshSessionId, std::string>& map) { map[sessionId] = blob; });
+}
+
+
+//libssh2 defaults to the slowest ciphers first (aes*-ctr + separate MAC) => prefer AEAD ciphers; AES-GCM only with hardware AES support
+void setCipherPreference(LIBSSH2_SESSION* sshSession) //noexcept: best effort, keep libssh2 defaults on failure
+{
+    const bool hasHardwareAes = []
+    {
+#if defined __x86_64__ || defined __i386__
+        return __builtin_cpu_supports("aes") > 0;
+#else
+        return true; //ARMv8 crypto extensions
+#endif
+    }();
+
+    std::vector<std::string_view> preferred;
+    if (hasHardwareAes)
+        preferred = {"aes128-gcm@openssh.com", "aes256-gcm@openssh.com", "chacha20-poly1305@openssh.com"};
+    else
+        preferred = {"chacha20-poly1305@openssh.com", "aes128-gcm@openssh.com", "aes256-gcm@openssh.com"};
+
+    for (const int methodType : {LIBSSH2_METHOD_CRYPT_CS, LIBSSH2_METHOD_CRYPT_SC})
+    {
+        const char** algs = nullptr;
+        const int algCount = ::libssh2_session_supported_algs(sshSession, methodType, &algs);
+        if (algCount <= 0)
+            continue;
+        ZEN_ON_SCOPE_EXIT(::libssh2_free(sshSession, algs));
+
+        const std::vector<std::string_view> supported(algs, algs + algCount);
+
+        std::vector<std::string_view> ordered;
+        for (const std::string_view alg : preferred)
+            if (std::find(supported.begin(), supported.end(), alg) != supported.end())
+                ordered.push_back(alg);
+        for (const std::string_view alg : supported)
+            if (std::find(ordered.begin(), ordered.end(), alg) == ordered.end())
+                ordered.push_back(alg);
+
+        std::string prefList;
+        for (const std::string_view alg : ordered)
+            prefList += (prefList.empty() ? "" : ",") + std::string(alg);
+
+        [[maybe_unused]] const int rc = ::libssh2_session_method_pref(sshSession, methodType, prefList.c_str());
+        assert(rc == 0);
+    }
+}
+
+
 class SshSession
 {
 public:
@@ -214,9 +447,16 @@ public:
         //if zlib compression causes trouble, make it a user setting: https://freefilesync.org/forum/viewtopic.php?t=6663
         //=> surprise: it IS causing trouble: slow-down in local syncs: https://freefilesync.org/forum/viewtopic.php?t=7244#p24250
         if (sessionId.allowZlib)
-            if (const int rc = ::libssh2_session_flag(sshSession_, LIBSSH2_FLAG_COMPRESS, 1);
-                rc != 0) //does not set SSH last error
-                throw SysError(formatSystemError("libssh2_session_flag", formatSshStatusCode(rc), L""));
+            if (std::shared_ptr<ZlibUsage> zlibUsage = getZlibUsage(sessionId);
+                zlibUsage && zlibUsage->isWorthwhile())
+            {
+                if (const int rc = ::libssh2_session_flag(sshSession_, LIBSSH2_FLAG_COMPRESS, 1);
+                    rc != 0) //does not set SSH last error
+                    throw SysError(formatSystemError("libssh2_session_flag", formatSshStatusCode(rc), L""));
+                zlibUsage_ = std::move(zlibUsage);
+            }
+
+        setCipherPreference(sshSession_); //noexcept
 
         ::libssh2_session_set_blocking(sshSession_, 1);
 
@@ -317,24 +557,33 @@ public:
                         throw SysError(replaceCpy(_("The server does not support authentication via %x."), L"%x", L"\"key file\"") +
                                        L'\n' +_("Required:") + L' ' + utfTo<std::wstring>(authList));
 
-                    std::string passphrase = passwordUtf8;
-                    std::string pkStream;
-                    try
+                    std::optional<DecodedPrivateKey> cachedKey = getCachedPrivateKey(sessionId_.privateKeyFilePath, passwordUtf8);
+                    const bool keyFromCache = cachedKey.has_value();
+                    if (!cachedKey)
                     {
-                        pkStream = getFileContent(sessionId_.privateKeyFilePath, nullptr /*notifyUnbufferedIO*/); //throw FileError
-                        trim(pkStream);
-                    }
-                    catch (const FileError& e) { throw SysError(replaceCpy(e.toString(), L"\n\n", L'\n')); } //errors should be further enriched by context info => SysError
+                        DecodedPrivateKey& key = cachedKey.emplace();
+                        key.keyFilePassphrase = key.pkPassphrase = passwordUtf8;
+                        try
+                        {
+                            key.pkStream = getFileContent(sessionId_.privateKeyFilePath, nullptr /*notifyUnbufferedIO*/); //throw FileError
+                            trim(key.pkStream);
+                        }
+                        catch (const FileError& e) { throw SysError(replaceCpy(e.toString(), L"\n\n", L'\n')); } //errors should be further enriched by context info => SysError
 
-                    //libssh2 doesn't support the PuTTY key file format, but we do!
-                    if (isPuttyKeyStream(pkStream))
-                    {
-                        pkStream = convertPuttyKeyToPkix(pkStream, passphrase); //throw SysError
-                        passphrase.clear();
+                        //libssh2 doesn't support the PuTTY key file format, but we do!
+                        if (isPuttyKeyStream(key.pkStream))
+                        {
+                            key.pkStream = convertPuttyKeyToPkix(key.pkStream, key.pkPassphrase); //throw SysError
+                            wipeSecret(key.pkPassphrase);
+                        }
                     }
+                    const std::string& pkStream = cachedKey->pkStream;
 
-                    if (::libssh2_userauth_publickey_frommemory(sshSession_, usernameUtf8, pkStream, passphrase) != 0) //const char* passphrase
+                    if (::libssh2_userauth_publickey_frommemory(sshSession_, usernameUtf8, pkStream, cachedKey->pkPassphrase) != 0) //const char* passphrase
                     {
+                        if (keyFromCache) //key file might have changed in the meantime: read again next time
+                            eraseCachedPrivateKey(sessionId_.privateKeyFilePath);
+
                         //libssh2_userauth_publickey_frommemory()'s "Unable to extract public key from private key" isn't exactly *helpful*
                         //=> detect invalid key files and give better error message:
                         const wchar_t* invalidKeyFormat = [&]() -> const wchar_t*
@@ -376,6 +625,9 @@ public:
 
                         throw SysError(formatLastSshError("libssh2_userauth_publickey_frommemory", nullptr));
                     }
+
+                    if (!keyFromCache)
+                        setCachedPrivateKey(sessionId_.privateKeyFilePath, *cachedKey);
                 }
                 break;
 
@@ -393,23 +645,35 @@ public:
                     if (::libssh2_agent_list_identities(sshAgent) != 0)
                         throw SysError(formatLastSshError("libssh2_agent_list_identities", nullptr));
 
+                    std::vector<libssh2_agent_publickey*> identities;
                     for (libssh2_agent_publickey* prev = nullptr;;)
                     {
                         libssh2_agent_publickey* identity = nullptr;
                         const int rc = ::libssh2_agent_get_identity(sshAgent, &identity, prev);
                         if (rc == 0) //public key returned
-                            ;
+                            identities.push_back(identity);
                         else if (rc == 1) //no more public keys
-                            throw SysError(L"SSH agent contains no matching public key.");
+                            break;
                         else
                             throw SysError(formatLastSshError("libssh2_agent_get_identity", nullptr));
-
-                        if (::libssh2_agent_userauth(sshAgent, usernameUtf8.c_str(), identity) == 0)
-                            break; //authentication successful
-
-                        //else: failed => try next public key
                         prev = identity;
                     }
+
+                    //each failed libssh2_agent_userauth() costs a server round trip => start with the identity that worked last time
+                    auto getBlob = [](const libssh2_agent_publickey& identity) { return std::string(reinterpret_cast<const char*>(identity.blob), identity.blob_len); };
+
+                    if (const std::string lastBlob = getAgentIdentity(sessionId_);
+                        !lastBlob.empty())
+                        std::stable_partition(identities.begin(), identities.end(), [&](const libssh2_agent_publickey* identity) { return getBlob(*identity) == lastBlob; });
+
+                    const auto itIdentity = std::find_if(identities.begin(), identities.end(), [&](libssh2_agent_publickey* identity)
+                    {
+                        return ::libssh2_agent_userauth(sshAgent, usernameUtf8.c_str(), identity) == 0; //else: failed => try next public key
+                    });
+                    if (itIdentity == identities.end())
+                        throw SysError(L"SSH agent contains no matching public key.");
+
+                    setAgentIdentity(sessionId_, getBlob(**itIdentity));
                 }
                 break;
             }
@@ -434,6 +698,9 @@ public:
         if (possiblyCorrupted_)
             return false;
 
+        if (zlibUsage_ && !zlibUsage_->isWorthwhile()) //replace by session without compression
+            return false;
+
         if (std::chrono::steady_clock::now() > lastSuccessfulUseTime_ + SFTP_SESSION_MAX_IDLE_TIME)
             return false;
 
@@ -442,6 +709,8 @@ public:
 
     void markAsCorrupted() { possiblyCorrupted_ = true; }
 
+    void addZlibSample(const void* buffer, size_t bytes) { if (zlibUsage_) zlibUsage_->addSample(buffer, bytes); } //noexcept
+
     struct Details
     {
         LIBSSH2_SESSION* sshSession;
@@ -627,6 +896,22 @@ public:
         }
     }
 
+    std::wstring formatLastSshError(const char* functionName, LIBSSH2_SFTP* sftpChannel /*optional*/) const
+    {
+        char* lastErrorMsg = nullptr; //owned by "sshSession"
+        const int sshStatusCode = ::libssh2_session_last_error(sshSession_, &lastErrorMsg, nullptr, false /*want_buf*/);
+        assert(lastErrorMsg);
+
+        std::wstring errorMsg;
+        if (lastErrorMsg)
+            errorMsg = trimCpy(utfTo<std::wstring>(lastErrorMsg));
+
+        if (sftpChannel && sshStatusCode == LIBSSH2_ERROR_SFTP_PROTOCOL)
+            errorMsg += (errorMsg.empty() ? L"" : L" - ") + formatSftpStatusCode(::libssh2_sftp_last_error(sftpChannel));
+
+        return formatSystemError(functionName, formatSshStatusCode(sshStatusCode), errorMsg);
+    }
+
 private:
     SshSession           (const SshSession&) = delete;
     SshSession& operator=(const SshSession&) = delete;
@@ -649,22 +934,6 @@ private:
         }
     }
 
-    std::wstring formatLastSshError(const char* functionName, LIBSSH2_SFTP* sftpChannel /*optional*/) const
-    {
-        char* lastErrorMsg = nullptr; //owned by "sshSession"
-        const int sshStatusCode = ::libssh2_session_last_error(sshSession_, &lastErrorMsg, nullptr, false /*want_buf*/);
-        assert(lastErrorMsg);
-
-        std::wstring errorMsg;
-        if (lastErrorMsg)
-            errorMsg = trimCpy(utfTo<std::wstring>(lastErrorMsg));
-
-        if (sftpChannel && sshStatusCode == LIBSSH2_ERROR_SFTP_PROTOCOL)
-            errorMsg += (errorMsg.empty() ? L"" : L" - ") + formatSftpStatusCode(::libssh2_sftp_last_error(sftpChannel));
-
-        return formatSystemError(functionName, formatSshStatusCode(sshStatusCode), errorMsg);
-    }
-
     struct SftpNonBlockInfo
     {
         bool commandPending = false;
@@ -690,6 +959,7 @@ private:
     const SshSessionId sessionId_;
     const std::shared_ptr<UniCounterCookie> libsshCurlUnifiedInitCookie_;
     std::chrono::steady_clock::time_point lastSuccessfulUseTime_; //...of the SSH session (but not necessarily the SFTP functionality!)
+    std::shared_ptr<ZlibUsage> zlibUsage_; //only if zlib compression is enabled for this session
 };
 
 //===========================================================================================================================
@@ -726,6 +996,8 @@ public:
 
         //bool isHealthy() const { return session_->isHealthy(); }
 
+        void addZlibSample(const void* buffer, size_t bytes) { session_->addZlibSample(buffer, bytes); } //noexcept
+
         void executeBlocking(const char* functionName, const std::function<int(const SshSession::Details& sd)>& sftpCommand /*noexcept!*/) //throw SysError, FatalSshError
         {
             assert(threadId_ == std::this_thread::get_id());
@@ -739,6 +1011,62 @@ public:
                     SshSession::waitForTraffic({session_.get()}, timeoutSec_); //throw FatalSshError
         }
 
+        struct PipelinedCommand
+        {
+            const char* functionName;
+            std::function<int(const SshSession::Details& sd)> sftpCommand; /*noexcept!*/
+        };
+
+        //pipelining: send each request as soon as the previous one is on the wire, then collect the replies => one round trip instead of one per command
+        //- libssh2 keeps a separate state per type of SFTP operation => fine to interleave *different* operations, but never the same one twice!
+        //- SFTP servers process requests in the order received (OpenSSH sftp-server: sequentially)
+        //returns one result per command: a failing command (SFTP error) doesn't stop the others
+        std::vector<std::optional<SysError>> executePipelined(const std::vector<PipelinedCommand>& commands) //throw SysError, FatalSshError
+        {
+            std::string functionNames;
+            for (const PipelinedCommand& cmd : commands)
+                functionNames += (functionNames.empty() ? "" : ", ") + std::string(cmd.functionName);
+
+            std::vector<bool> cmdDone(commands.size());
+            std::vector<std::optional<SysError>> cmdErrors(commands.size());
+
+            executeBlocking(functionNames.c_str(), [&](const SshSession::Details& sd) //throw SysError, FatalSshError
+            {
+                for (;;)
+                {
+                    bool progress = false;
+                    bool pending  = false;
+                    for (size_t i = 0; i < commands.size(); ++i)
+                        if (!cmdDone[i])
+                        {
+                            const int rc = commands[i].sftpCommand(sd); //noexcept
+                            if (rc == LIBSSH2_ERROR_EAGAIN)
+                            {
+                                pending = true;
+                                if (::libssh2_session_block_directions(sd.sshSession) & LIBSSH2_SESSION_BLOCK_OUTBOUND)
+                                    return rc; //request not yet sent completely: don't interleave the next one!
+                            }
+                            else if (rc >= LIBSSH2_ERROR_NONE || rc == LIBSSH2_ERROR_SFTP_PROTOCOL)
+                            {
+                                cmdDone[i] = progress = true;
+                                if (rc == LIBSSH2_ERROR_SFTP_PROTOCOL) //[!] format now: next command overwrites libssh2's last error
+                                    cmdErrors[i] = SysError(session_->formatLastSshError(commands[i].functionName, sd.sftpChannel));
+                            }
+                            else //SSH session error => fail all
+                                return rc;
+                        }
+
+                    if (!pending)
+                        return LIBSSH2_ERROR_NONE;
+                    if (!progress) //all remaining commands returned LIBSSH2_ERROR_EAGAIN => wait for traffic
+                        return LIBSSH2_ERROR_EAGAIN;
+                }
+            });
+            return cmdErrors;
+        }
+
+        const SshSessionId& getSessionId() const { return session_->getSessionId(); }
+
     private:
         std::unique_ptr<SshSession, ReUseOnDelete> session_; //bound!
         const std::thread::id threadId_ = std::this_thread::get_id();
@@ -878,6 +1206,52 @@ public:
         return std::make_unique<SshSessionExclusive>(std::move(sshSession), login.timeoutSec);
     }
 
+
+    //create sessions *in parallel* ahead of time: each costs TCP connect + SSH handshake + authentication + SFTP init round trips
+    void prewarmSessions(const SftpLogin& login, size_t sessionCount) //throw SysError
+    {
+        Protected<IdleSshSessions>& sessionStore = getSessionStore(login);
+
+        size_t idleCount = 0;
+        sessionStore.access([&](IdleSshSessions& sessions) { idleCount = sessions.idleSshSessions.size(); }); //assume "isHealthy()", see getExclusiveSession()
+
+        if (idleCount >= sessionCount)
+            return;
+
+        std::mutex errorLock;
+        std::optional<SysError> firstError;
+        {
+            ThreadGroup<std::function<void()>> tg(std::min(sessionCount - idleCount, SFTP_PREWARM_PARALLEL_MAX), Zstr("SFTP Prewarm"));
+
+            for (size_t i = idleCount; i < sessionCount; ++i)
+                tg.run([&]
+            {
+                std::unique_ptr<SshSession, ReUseOnDelete> sshSession; //=> added to idle sessions when going out of scope (if healthy)
+                try
+                {
+                    sshSession.reset(new SshSession(login, login.timeoutSec)); //throw SysError
+
+                    //SFTP channel is needed for both shared and exclusive sessions:
+                    SshSession::addSftpChannel({sshSession.get()}, login.timeoutSec); //throw SysError, FatalSshError
+                }
+                catch (const SysError& e)
+                {
+                    std::lock_guard dummy(errorLock);
+                    if (!firstError) firstError = e;
+                }
+                catch (const FatalSshError& e)
+                {
+                    sshSession->markAsCorrupted(); //=> not returned to idle sessions
+                    std::lock_guard dummy(errorLock);
+                    if (!firstError) firstError = SysError(e.toString());
+                }
+            });
+            tg.wait();
+        }
+        if (firstError)
+            throw* firstError;
+    }
+
 private:
     SftpSessionManager           (const SftpSessionManager&) = delete;
     SftpSessionManager& operator=(const SftpSessionManager&) = delete;
@@ -991,6 +1365,15 @@ std::unique_ptr<SftpSessionManager::SshSessionExclusive> getExclusiveSftpSession
 }
 
 
+void prewarmSftpSessions(const SftpLogin& login, size_t sessionCount) //throw SysError
+{
+    if (const std::shared_ptr<SftpSessionManager> mgr = globalSftpSessionManager.get())
+        return mgr->prewarmSessions(login, sessionCount); //throw SysError
+
+    throw SysError(formatSystemError("prewarmSftpSessions", L"", L"Function call not allowed during init/shutdown."));
+}
+
+
 void runSftpCommand(const SftpLogin& login, const char* functionName,
                     const std::function<int(const SshSession::Details& sd)>& sftpCommand /*noexcept!*/) //throw SysError
 {
@@ -1003,6 +1386,154 @@ void runSftpCommand(const SftpLogin& login, const char* functionName,
     catch (const FatalSshError& e) { throw SysError(e.toString()); } //SSH session corrupted! => we stop using session => map to SysError is okay
 }
 
+
+//POSIX shell quoting: '...' with embedded single quotes as '\''
+std::string quoteShellArg(const std::string& str)
+{
+    return '\'' + replaceCpy(str, "'", "'\\''") + '\'';
+}
+
+
+//run command on the server via SSH "exec" channel: requires shell access! (fails e.g. for accounts restricted to "internal-sftp")
+//getStdinChunk: optional; called until returning an empty chunk (= end of input)
+std::string runSshExecCommand(const SftpLogin& login, const std::string& command, int& exitStatus, //throw SysError, X
+                              const std::function<std::string()>& getStdinChunk = nullptr /*throw X*/)
+{
+    //all channel operations must use the same SSH session => keep shared session bound to current thread:
+    std::shared_ptr<SftpSessionManager::SshSessionShared> asyncSession = getSharedSftpSession(login); //throw SysError
+    try
+    {
+        LIBSSH2_CHANNEL* channel = nullptr;
+        asyncSession->executeBlocking("libssh2_channel_open_session", //throw SysError, FatalSshError
+                                      [&](const SshSession::Details& sd) //noexcept!
+        {
+            channel = ::libssh2_channel_open_session(sd.sshSession);
+            if (!channel)
+                return std::min(::libssh2_session_last_errno(sd.sshSession), LIBSSH2_ERROR_SOCKET_NONE);
+            return LIBSSH2_ERROR_NONE;
+        });
+        ZEN_ON_SCOPE_EXIT(try { asyncSession->executeBlocking("libssh2_channel_free", [&](const SshSession::Details& sd) { return ::libssh2_channel_free(channel); }); }
+        catch (SysError&) {} catch (FatalSshError&) {});
+
+        //don't let stderr fill up the channel window:
+        asyncSession->executeBlocking("libssh2_channel_handle_extended_data2", //throw SysError, FatalSshError
+        [&](const SshSession::Details& sd) { return ::libssh2_channel_handle_extended_data2(channel, LIBSSH2_CHANNEL_EXTENDED_DATA_IGNORE); }); //noexcept!
+
+        asyncSession->executeBlocking("libssh2_channel_exec", //throw SysError, FatalSshError
+        [&](const SshSession::Details& sd) { return ::libssh2_channel_exec(channel, command.c_str()); }); //noexcept!
+
+        if (getStdinChunk)
+        {
+            for (std::string chunk; !(chunk = getStdinChunk()).empty();) //throw X
+                for (size_t bytesSent = 0; bytesSent < chunk.size();)
+                {
+                    ssize_t bytesWritten = 0;
+                    asyncSession->executeBlocking("libssh2_channel_write", //throw SysError, FatalSshError
+                                                  [&](const SshSession::Details& sd) //noexcept!
+                    {
+                        bytesWritten = ::libssh2_channel_write(channel, chunk.data() + bytesSent, chunk.size() - bytesSent);
+                        return static_cast<int>(bytesWritten);
+                    });
+
+                    if (bytesWritten <= 0 || static_cast<size_t>(bytesWritten) > chunk.size() - bytesSent) //better safe than sorry
+                        throw SysError(formatSystemError("libssh2_channel_write", L"", L"Unexpected number of bytes written."));
+                    bytesSent += bytesWritten;
+                }
+
+            asyncSession->executeBlocking("libssh2_channel_send_eof", //throw SysError, FatalSshError
+            [&](const SshSession::Details& sd) { return ::libssh2_channel_send_eof(channel); }); //noexcept!
+        }
+
+        std::string output;
+        for (;;)
+        {
+            std::array<char, 4096> buffer;
+            ssize_t bytesRead = 0;
+            asyncSession->executeBlocking("libssh2_channel_read", //throw SysError, FatalSshError
+                                          [&](const SshSession::Details& sd) //noexcept!
+            {
+                bytesRead = ::libssh2_channel_read(channel, buffer.data(), buffer.size());
+                return static_cast<int>(bytesRead);
+            });
+            if (bytesRead == 0) //end of stream
+                break;
+
+            output.append(buffer.data(), bytesRead);
+            if (output.size() > 1024 * 1024) //better safe than sorry
+                throw SysError(formatSystemError("libssh2_channel_read", L"", L"Unexpected amount of command output."));
+        }
+
+        asyncSession->executeBlocking("libssh2_channel_close", //throw SysError, FatalSshError
+        [&](const SshSession::Details& sd) { return ::libssh2_channel_close(channel); }); //noexcept!
+
+        asyncSession->executeBlocking("libssh2_channel_wait_closed", //throw SysError, FatalSshError
+        [&](const SshSession::Details& sd) { return ::libssh2_channel_wait_closed(channel); }); //noexcept!
+
+        exitStatus = ::libssh2_channel_get_exit_status(channel);
+        return output;
+    }
+    catch (const FatalSshError& e) { throw SysError(e.toString()); } //SSH session corrupted! => we stop using session => map to SysError is okay
+}
+
+
+//tar stream for batch uploads: ustar + GNU long name extension (supported by GNU tar, bsdtar, BusyBox)
+void appendTarHeader(std::string& stream, const std::string& itemName, char typeFlag, uint64_t itemSize, time_t modTime) //throw SysError
+{
+    const uint64_t octalMax = (uint64_t(1) << 33) - 1; //11 octal digits
+    if (itemSize > octalMax)
+        throw SysError(formatSystemError("appendTarHeader", L"", L"File size too large: " + numberTo<std::wstring>(itemSize)));
+    if (modTime < 0 || static_cast<uint64_t>(modTime) > octalMax)
+        throw SysError(formatSystemError("appendTarHeader", L"", L"Unsupported modification time: " + numberTo<std::wstring>(modTime)));
+
+    std::array<char, 512> header = {};
+    auto writeOctal = [&](size_t pos, size_t len, uint64_t num) //len includes terminating null
+    {
+        header[pos + len - 1] = '\0';
+        for (size_t i = len - 1; i-- > 0; num /= 8)
+            header[pos + i] = static_cast<char>('0' + num % 8);
+    };
+
+    std::copy(itemName.begin(), itemName.begin() + std::min<size_t>(itemName.size(), 100), header.begin()); //name: null-termination optional for 100 chars
+    writeOctal(100,  8, 0644); //mode: tar applies umask
+    writeOctal(108,  8, 0);    //uid: ignored due to "tar -o"
+    writeOctal(116,  8, 0);    //gid
+    writeOctal(124, 12, itemSize);
+    writeOctal(136, 12, modTime);
+    std::fill(header.begin() + 148, header.begin() + 156, ' '); //checksum is calculated with blanks
+    header[156] = typeFlag;
+    std::copy_n("ustar\0" "00", 8, header.begin() + 257); //magic + version
+
+    unsigned int checksum = 0;
+    for (const char c : header)
+        checksum += static_cast<unsigned char>(c);
+    writeOctal(148, 7, checksum); //6 digits + null + blank
+
+    stream.append(header.data(), header.size());
+}
+
+
+void appendTarPadding(std::string& stream)
+{
+    stream.append((512 - stream.size() % 512) % 512, '\0');
+}
+
+
+std::string getTarFileEntry(const std::string& fileName, const std::string& content, time_t modTime) //throw SysError
+{
+    std::string stream;
+    if (fileName.size() > 100)
+    {
+        appendTarHeader(stream, "././@LongLink", 'L', fileName.size() + 1, 0); //throw SysError
+        stream += fileName;
+        stream += '\0';
+        appendTarPadding(stream);
+    }
+    appendTarHeader(stream, fileName, '0' /*regular file*/, content.size(), modTime); //throw SysError
+    stream += content;
+    appendTarPadding(stream);
+    return stream;
+}
+
 //===========================================================================================================================
 //===========================================================================================================================
 struct SftpItemDetails
@@ -1113,39 +1644,23 @@ SftpItemDetails getSymlinkTargetDetails(const SftpLogin& login, const AfsPath& l
 }
 
 
-class SingleFolderTraverser
+struct TraverserWorkItem
 {
-public:
-    using WorkItem = std::pair<AfsPath, std::shared_ptr<AFS::TraverserCallback>>;
-
-    SingleFolderTraverser(const SftpLogin& login, const std::vector<std::pair<AfsPath, std::shared_ptr<AFS::TraverserCallback>>>& workload /*throw X*/) :
-        login_(login)
-    {
-        for (const auto& [folderPath, cb] : workload)
-            workload_.push_back(WorkItem{folderPath, cb});
-
-        while (!workload_.empty())
-        {
-            auto wi = std::move(workload_.    front()); //yes, no strong exception guarantee (std::bad_alloc)
-            /**/                workload_.pop_front();  //
-            const auto& [folderPath, cb] = wi;
+    AfsPath dirPath;
+    std::shared_ptr<AFS::TraverserCallback> cb;
+};
 
-            tryReportingDirError([&] //throw X
-            {
-                traverseWithException(folderPath, *cb); //throw FileError, X
-            }, *cb);
-        }
-    }
 
-private:
-    SingleFolderTraverser           (const SingleFolderTraverser&) = delete;
-    SingleFolderTraverser& operator=(const SingleFolderTraverser&) = delete;
+//read a single folder: sub folders to traverse next are appended to "workload"
+void traverseFolderFlat(const SftpLogin& login, const TraverserWorkItem& wi, std::vector<TraverserWorkItem>& workload) //throw X
+{
+    AFS::TraverserCallback& cb = *wi.cb;
 
-    void traverseWithException(const AfsPath& dirPath, AFS::TraverserCallback& cb) //throw FileError, X
+    tryReportingDirError([&] //throw X
     {
-        for (const SftpItem& item : getDirContentFlat(login_, dirPath)) //throw FileError
+        for (const SftpItem& item : getDirContentFlat(login, wi.dirPath)) //throw FileError
         {
-            const AfsPath itemPath(appendPath(dirPath.value, item.itemName));
+            const AfsPath itemPath(appendPath(wi.dirPath.value, item.itemName));
 
             switch (item.details.type)
             {
@@ -1155,7 +1670,7 @@ private:
 
                 case AFS::ItemType::folder:
                     if (std::shared_ptr<AFS::TraverserCallback> cbSub = cb.onFolder({item.itemName, false /*isFollowedSymlink*/})) //throw X
-                        workload_.push_back(WorkItem{itemPath, std::move(cbSub)});
+                        workload.push_back({itemPath, std::move(cbSub)});
                     break;
 
                 case AFS::ItemType::symlink:
@@ -1166,14 +1681,14 @@ private:
                             SftpItemDetails targetDetails = {};
                             if (!tryReportingItemError([&] //throw X
                         {
-                            targetDetails = getSymlinkTargetDetails(login_, itemPath); //throw FileError
+                            targetDetails = getSymlinkTargetDetails(login, itemPath); //throw FileError
                             }, cb, item.itemName))
                             continue;
 
                             if (targetDetails.type == AFS::ItemType::folder)
                             {
                                 if (std::shared_ptr<AFS::TraverserCallback> cbSub = cb.onFolder({item.itemName, true /*isFollowedSymlink*/})) //throw X
-                                    workload_.push_back(WorkItem{itemPath, std::move(cbSub)});
+                                    workload.push_back({itemPath, std::move(cbSub)});
                             }
                             else //a file or named pipe, etc.
                                 cb.onFile({item.itemName, targetDetails.fileSize, targetDetails.modTime, AFS::FingerPrint() /*not supported by SFTP*/, true /*isFollowedSymlink*/}); //throw X
@@ -1186,24 +1701,39 @@ private:
                     break;
             }
         }
-    }
-
-    const SftpLogin login_;
-    RingBuffer<WorkItem> workload_;
-};
+    }, cb);
+}
 
 
-void traverseFolderRecursiveSftp(const SftpLogin& login, const std::vector<std::pair<AfsPath, std::shared_ptr<AFS::TraverserCallback>>>& workload /*throw X*/, size_t) //throw X
+void traverseFolderRecursiveSftp(const SftpLogin& login, const std::vector<std::pair<AfsPath, std::shared_ptr<AFS::TraverserCallback>>>& workload /*throw X*/, size_t parallelOps) //throw X
 {
-    SingleFolderTraverser dummy(login, workload); //throw X
+    std::vector<TraverserWorkItem> workItems;
+    for (const auto& [folderPath, cb] : workload)
+        workItems.push_back({folderPath, cb});
+
+    //one SFTP session per thread (see getSharedSftpSession()) => keep "parallelOps" opendir/readdir round trips in flight
+    if (parallelOps >= 2)
+        return ParallelFolderTraverser<TraverserWorkItem>(std::move(workItems), parallelOps, Zstr("SFTP Traverser"), [&login](const TraverserWorkItem& wi, std::vector<TraverserWorkItem>& subFolders)
+    {
+        traverseFolderFlat(login, wi, subFolders); //throw X
+    }).run(); //throw X
+
+    while (!workItems.empty())
+    {
+        TraverserWorkItem wi = std::move(workItems.    back()); //yes, no strong exception guarantee (std::bad_alloc)
+        /**/                              workItems.pop_back();  //
+
+        traverseFolderFlat(login, wi, workItems); //throw X
+    }
 }
 
 //===========================================================================================================================
 
 struct InputStreamSftp : public AFS::InputStream
 {
-    InputStreamSftp(const SftpLogin& login, const AfsPath& filePath, const IoCallback& notifyUnbufferedIO /*throw X*/) : //throw FileError
+    InputStreamSftp(const SftpLogin& login, const AfsPath& filePath, uint64_t offset, const IoCallback& notifyUnbufferedIO /*throw X*/) : //throw FileError
         displayPath_(getSftpDisplayPath(login, filePath)),
+        blockSize_(getOptimalBlockSizeRead(login)),
         notifyUnbufferedIO_(notifyUnbufferedIO)
     {
         try
@@ -1218,6 +1748,9 @@ struct InputStreamSftp : public AFS::InputStream
                     return std::min(::libssh2_session_last_errno(sd.sshSession), LIBSSH2_ERROR_SOCKET_NONE);
                 return LIBSSH2_ERROR_NONE;
             });
+
+            if (offset != 0)
+                ::libssh2_sftp_seek64(fileHandle_, offset); //no server round-trip: SFTP READ requests carry the offset
         }
         catch (const SysError&      e) { throw FileError(replaceCpy(_("Cannot open file %x."), L"%x", fmtPath(displayPath_)), e.toString()); }
         catch (const FatalSshError& e) { throw FileError(replaceCpy(_("Cannot open file %x."), L"%x", fmtPath(displayPath_)), e.toString()); } //SSH session corrupted! => stop using session
@@ -1252,9 +1785,16 @@ struct InputStreamSftp : public AFS::InputStream
             if (it == itEnd)
                 break;
             //--------------------------------------------------------------------
-            const size_t bytesRead = tryRead(&memBuf_[0], blockSize); //throw FileError; may return short, only 0 means EOF! => CONTRACT: bytesToRead > 0
-            bufPos_ = 0;
-            bufPosEnd_ = bytesRead;
+            //at least one full block left: read directly into caller's buffer => no memcpy() through memBuf_
+            const bool readDirect = static_cast<size_t>(itEnd - it) >= blockSize;
+            const size_t bytesRead = tryRead(readDirect ? it : &memBuf_[0], blockSize); //throw FileError; may return short, only 0 means EOF! => CONTRACT: bytesToRead > 0
+            if (readDirect)
+                it += bytesRead; //memBuf_ is empty at this point
+            else
+            {
+                bufPos_ = 0;
+                bufPosEnd_ = bytesRead;
+            }
 
             if (notifyUnbufferedIO_) notifyUnbufferedIO_(bytesRead); //throw X
 
@@ -1264,7 +1804,7 @@ struct InputStreamSftp : public AFS::InputStream
         return it - static_cast<std::byte*>(buffer);
     }
 
-    size_t getBlockSize() const override { return SFTP_OPTIMAL_BLOCK_SIZE_READ; } //non-zero block size is AFS contract!
+    size_t getBlockSize() const override { return blockSize_; } //non-zero block size is AFS contract!
 
     std::optional<AFS::StreamAttributes> getAttributesBuffered() override //throw FileError
     {
@@ -1292,6 +1832,8 @@ private:
 
             if (static_cast<size_t>(bytesRead) > bytesToRead) //better safe than sorry
                 throw SysError(formatSystemError("libssh2_sftp_read", L"", L"Buffer overflow.")); //user should never see this
+
+            session_->addZlibSample(buffer, static_cast<size_t>(bytesRead)); //noexcept
         }
         catch (const SysError&      e) { throw FileError(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(displayPath_)), e.toString()); }
         catch (const FatalSshError& e) { throw FileError(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(displayPath_)), e.toString()); } //SSH session corrupted! => caller (will/should) stop using session
@@ -1300,6 +1842,7 @@ private:
     }
 
     const std::wstring displayPath_;
+    const size_t blockSize_;
     LIBSSH2_SFTP_HANDLE* fileHandle_ = nullptr;
     const IoCallback notifyUnbufferedIO_; //throw X
     std::shared_ptr<SftpSessionManager::SshSessionShared> session_;
@@ -1316,10 +1859,12 @@ struct OutputStreamSftp : public AFS::OutputStreamImpl
 {
     OutputStreamSftp(const SftpLogin& login, //throw FileError
                      const AfsPath& filePath,
+                     std::optional<uint64_t> existingFileOffset, //write into existing file (without truncation) instead of creating a new one
                      std::optional<time_t> modTime,
                      const IoCallback& notifyUnbufferedIO /*throw X*/) :
         filePath_(filePath),
         displayPath_(getSftpDisplayPath(login, filePath)),
+        blockSize_(getOptimalBlockSizeWrite(login)),
         modTime_(modTime),
         notifyUnbufferedIO_(notifyUnbufferedIO)
     {
@@ -1331,12 +1876,16 @@ struct OutputStreamSftp : public AFS::OutputStreamImpl
                                       [&](const SshSession::Details& sd) //noexcept!
             {
                 fileHandle_ = ::libssh2_sftp_open(sd.sftpChannel, getLibssh2Path(filePath),
+                                                  existingFileOffset ? LIBSSH2_FXF_WRITE :
                                                   LIBSSH2_FXF_WRITE | LIBSSH2_FXF_CREAT | LIBSSH2_FXF_EXCL,
                                                   SFTP_DEFAULT_PERMISSION_FILE); //note: server may also apply umask! (e.g. 0022 for ffs.org)
                 if (!fileHandle_)
                     return std::min(::libssh2_session_last_errno(sd.sshSession), LIBSSH2_ERROR_SOCKET_NONE);
                 return LIBSSH2_ERROR_NONE;
             });
+
+            if (existingFileOffset && *existingFileOffset != 0)
+                ::libssh2_sftp_seek64(fileHandle_, *existingFileOffset); //no server round-trip: SFTP WRITE requests carry the offset
         }
         catch (const SysError&      e) { throw FileError(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(displayPath_)), e.toString()); }
         catch (const FatalSshError& e) { throw FileError(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(displayPath_)), e.toString()); } //SSH session corrupted! => stop using session
@@ -1366,6 +1915,17 @@ struct OutputStreamSftp : public AFS::OutputStreamImpl
         const auto itEnd = it + bytesToWrite;
         for (;;)
         {
+            //nothing buffered + at least one full block left: write directly from caller's buffer => no memcpy() through memBuf_
+            if (bufPos_ == bufPosEnd_ && static_cast<size_t>(itEnd - it) >= blockSize)
+            {
+                const size_t bytesWritten = tryWrite(it, blockSize); //throw FileError; may return short! CONTRACT: bytesToWrite > 0
+                it += bytesWritten;
+                if (notifyUnbufferedIO_) notifyUnbufferedIO_(bytesWritten); //throw X!
+                if (it == itEnd)
+                    return;
+                continue;
+            }
+
             if (memBuf_.size() - bufPos_ < blockSize) //support memBuf_.size() > blockSize to reduce memmove()s, but perf test shows: not really needed!
                 // || bufPos_ == bufPosEnd_) -> not needed while memBuf_.size() == blockSize
             {
@@ -1399,18 +1959,81 @@ struct OutputStreamSftp : public AFS::OutputStreamImpl
             if (notifyUnbufferedIO_) notifyUnbufferedIO_(bytesWritten); //throw X!
         }
 
-        //~OutputStreamSftp() would call this one, too, but we want to propagate errors if any:
-        close(); //throw FileError
-
-        //it seems libssh2_sftp_fsetstat() triggers bugs on synology server => set mtime by path! https://freefilesync.org/forum/viewtopic.php?t=1281
-
         AFS::FinalizeResult result;
         //result.filePrint = ... -> not supported by SFTP
+
+        //~OutputStreamSftp() would close the handle, too, but we want to propagate errors if any:
+        if (!modTime_)
+        {
+            close(); //throw FileError
+            return result;
+        }
+
+        //close + set modification time: pipelined => one round trip
+        try
+        {
+            ZEN_ON_SCOPE_EXIT(fileHandle_ = nullptr);
+
+            LIBSSH2_SFTP_ATTRIBUTES attribNew = {};
+            attribNew.flags = LIBSSH2_SFTP_ATTR_ACMODTIME;
+            attribNew.mtime = static_cast<decltype(attribNew.mtime)>(*modTime_);        //32-bit target! loss of data!
+            attribNew.atime = static_cast<decltype(attribNew.atime)>(::time(nullptr));  //
+
+            const SftpSessionManager::SshSessionShared::PipelinedCommand cmdClose{"libssh2_sftp_close",
+                [&](const SshSession::Details& sd) { return ::libssh2_sftp_close(fileHandle_); }}; //noexcept!
+
+            const std::optional<bool> fsetstatSupport = getFsetstatSupport(session_->getSessionId());
+            if (fsetstatSupport && !*fsetstatSupport)
+            {
+                //is setting modtime after closing the file handle a pessimization? SFTP: no, needed for functional correctness (synology server), same as for Native
+                const std::vector<std::optional<SysError>> errors = session_->executePipelined( //throw SysError, FatalSshError
+                {
+                    cmdClose,
+                    {"libssh2_sftp_setstat", [&](const SshSession::Details& sd) { return ::libssh2_sftp_setstat(sd.sftpChannel, getLibssh2Path(filePath_), &attribNew); }}, //noexcept!
+                });
+                if (errors[0])
+                    throw* errors[0];
+                if (errors[1])
+                    result.errorModTime = FileError(replaceCpy(_("Cannot write modification time of %x."), L"%x", fmtPath(displayPath_)), errors[1]->toString());
+                return result;
+            }
+
+            //not yet probed: check the modification time as seen by the server after close (still pipelined)
+            LIBSSH2_SFTP_ATTRIBUTES attribProbe = {};
+            std::vector<SftpSessionManager::SshSessionShared::PipelinedCommand> commands
+            {
+                {"libssh2_sftp_fsetstat", [&](const SshSession::Details& sd) { return ::libssh2_sftp_fsetstat(fileHandle_, &attribNew); }}, //noexcept!
+                cmdClose,
+            };
+            if (!fsetstatSupport)
+                commands.push_back({"libssh2_sftp_stat", [&](const SshSession::Details& sd) { return ::libssh2_sftp_stat(sd.sftpChannel, getLibssh2Path(filePath_), &attribProbe); }}); //noexcept!
+
+            const std::vector<std::optional<SysError>> errors = session_->executePipelined(commands); //throw SysError, FatalSshError
+            if (errors[1])
+                throw* errors[1];
+
+            if (fsetstatSupport) //= true
+            {
+                if (!errors[0])
+                    return result;
+            }
+            else if (errors[0])
+                setFsetstatSupport(session_->getSessionId(), false);
+            else if (!errors[2]) //probe failed? => try again next time
+            {
+                const bool supported = (attribProbe.flags & LIBSSH2_SFTP_ATTR_ACMODTIME) && attribProbe.mtime == attribNew.mtime;
+                setFsetstatSupport(session_->getSessionId(), supported);
+                if (supported)
+                    return result;
+            }
+        }
+        catch (const SysError&      e) { throw FileError(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(displayPath_)), e.toString()); }
+        catch (const FatalSshError& e) { throw FileError(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(displayPath_)), e.toString()); } //SSH session corrupted! => caller (will/should) stop using session
+
+        //fsetstat failed or was ignored by the server: set mtime by path
         try
         {
             setModTimeIfAvailable(); //throw FileError, follows symlinks
-            /* is setting modtime after closing the file handle a pessimization?
-                SFTP: no, needed for functional correctness (synology server), same as for Native */
         }
         catch (const FileError& e) { result.errorModTime = e; /*slicing?*/ }
 
@@ -1418,7 +2041,7 @@ struct OutputStreamSftp : public AFS::OutputStreamImpl
     }
 
 private:
-    size_t getBlockSize() const { return SFTP_OPTIMAL_BLOCK_SIZE_WRITE; } //non-zero block size is AFS contract!
+    size_t getBlockSize() const { return blockSize_; } //non-zero block size is AFS contract!
 
     void close() //throw FileError
     {
@@ -1453,6 +2076,8 @@ private:
 
             if (bytesWritten > static_cast<ssize_t>(bytesToWrite)) //better safe than sorry
                 throw SysError(formatSystemError("libssh2_sftp_write", L"", L"Buffer overflow."));
+
+            session_->addZlibSample(buffer, static_cast<size_t>(bytesWritten)); //noexcept
         }
         catch (const SysError&      e) { throw FileError(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(displayPath_)), e.toString()); }
         catch (const FatalSshError& e) { throw FileError(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(displayPath_)), e.toString()); } //SSH session corrupted! => caller (will/should) stop using session
@@ -1483,6 +2108,7 @@ private:
 
     const AfsPath filePath_;
     const std::wstring displayPath_;
+    const size_t blockSize_;
     LIBSSH2_SFTP_HANDLE* fileHandle_ = nullptr;
     const std::optional<time_t> modTime_;
     const IoCallback notifyUnbufferedIO_; //throw X
@@ -1653,7 +2279,22 @@ private:
                                        const std::function<void (const std::wstring& displayPath)>& onBeforeFolderDeletion) const override //one call for each object!
     {
         //default implementation: folder traversal
-        AFS::removeFolderIfExistsRecursion(afsPath, onBeforeFileDeletion, onBeforeFolderDeletion); //throw FileError, X
+        removeFolderTreePipelined(afsPath, onBeforeFileDeletion, onBeforeFolderDeletion, SFTP_REMOVE_FOLDER_PARALLEL_OPS); //throw FileError, X
+    }
+
+    //----------------------------------------------------------------------------------------------------------------
+    void setModTime(const AfsPath& afsPath, time_t modTime) const override //throw FileError, follows symlinks
+    {
+        LIBSSH2_SFTP_ATTRIBUTES attribNew = {};
+        attribNew.flags = LIBSSH2_SFTP_ATTR_ACMODTIME;
+        attribNew.mtime = static_cast<decltype(attribNew.mtime)>(modTime);         //32-bit target! loss of data!
+        attribNew.atime = static_cast<decltype(attribNew.atime)>(::time(nullptr)); //
+        try
+        {
+            runSftpCommand(login_, "libssh2_sftp_setstat", //throw SysError
+            [&](const SshSession::Details& sd) { return ::libssh2_sftp_setstat(sd.sftpChannel, getLibssh2Path(afsPath), &attribNew); }); //noexcept!
+        }
+        catch (const SysError& e) { throw FileError(replaceCpy(_("Cannot write modification time of %x."), L"%x", fmtPath(getDisplayPath(afsPath))), e.toString()); }
     }
 
     //----------------------------------------------------------------------------------------------------------------
@@ -1706,7 +2347,164 @@ private:
     //return value always bound:
     std::unique_ptr<InputStream> getInputStream(const AfsPath& afsPath, const IoCallback& notifyUnbufferedIO /*throw X*/) const override //throw FileError, (ErrorFileLocked)
     {
-        return std::make_unique<InputStreamSftp>(login_, afsPath, notifyUnbufferedIO); //throw FileError
+        return std::make_unique<InputStreamSftp>(login_, afsPath, 0 /*offset*/, notifyUnbufferedIO); //throw FileError
+    }
+
+    size_t getSegmentedCopyStreams() const override { return login_.segmentedCopyStreams; }
+
+    //SFTP "check-file" extension would be preferable, but libssh2 has no API for custom SFTP requests => use shell commands instead
+    std::vector<HashAlgorithm> getServerHashAlgorithms() const override
+    {
+        if (!login_.allowShellHash || shellHashUnsupported_)
+            return {};
+        return {HashAlgorithm::sha256, HashAlgorithm::sha1, HashAlgorithm::md5};
+    }
+
+    std::optional<std::string> getServerFileHash(const AfsPath& afsPath, HashAlgorithm algo) const override
+    {
+        if (!login_.allowShellHash || shellHashUnsupported_)
+            return {};
+
+        const auto [hashCmd, hashLen] = [&]() -> std::pair<const char*, size_t>
+        {
+            switch (algo)
+            {
+                //*INDENT-OFF*
+                case HashAlgorithm::md5:    return {"md5sum",    32};
+                case HashAlgorithm::sha1:   return {"sha1sum",   40};
+                case HashAlgorithm::sha256: return {"sha256sum", 64};
+                //*INDENT-ON*
+            }
+            throw std::logic_error("Contract violation! " + std::string(__FILE__) + ':' + numberTo<std::string>(__LINE__));
+        }();
+
+        try
+        {
+            int exitStatus = 0;
+            std::string output = runSshExecCommand(login_, std::string(hashCmd) + " -- " + quoteShellArg(getLibssh2Path(afsPath)), exitStatus); //throw SysError
+
+            if (exitStatus == 126 || exitStatus == 127) //command not executable/not found
+            {
+                shellHashUnsupported_ = true;
+                return {};
+            }
+            if (exitStatus != 0) //e.g. file not found, access denied => let the regular file access report the error
+                return {};
+
+            shellHashConfirmed_ = true;
+
+            //"<hash>  <file name>"; GNU coreutils: leading backslash if file name contains backslash or line break
+            if (startsWith(output, '\\'))
+                output.erase(0, 1);
+            std::string hash = beforeFirst(output, ' ', IfNotFoundReturn::none);
+
+            if (hash.size() != hashLen || !std::all_of(hash.begin(), hash.end(), isHexDigit<char>))
+                return {};
+            return hash;
+        }
+        catch (SysError&)
+        {
+            if (!shellHashConfirmed_) //exec channel not permitted?
+                shellHashUnsupported_ = true;
+            return {};
+        }
+    }
+
+    size_t getBatchUploadFileCountMax() const override
+    {
+        if (!login_.allowShellBatchUpload || shellBatchUploadUnsupported_)
+            return 0;
+        return SFTP_BATCH_UPLOAD_FILES_MAX;
+    }
+
+    //stream files as tar via SSH exec channel: unpack into temp folder, then move into place => no partially written files under the final name
+    std::vector<FileCopyResult> uploadFileBatch(const AfsPath& targetFolder, const std::vector<BatchUploadItem>& items, //throw FileError, ErrorFileLocked, X
+                                                const IoCallback& notifyUnbufferedIO /*throw X*/) const override
+    {
+        assert(!items.empty() && items.size() <= SFTP_BATCH_UPLOAD_FILES_MAX);
+
+        const Zstring tmpFolderName = Zstr("ffs_batch.") + printNumber<Zstring>(Zstr("%04x"), static_cast<unsigned int>(getCrc16(generateGUID()))) + TEMP_FILE_ENDING;
+        const std::string tmpQ = quoteShellArg(utfTo<std::string>(tmpFolderName));
+
+        std::string script = "command -v tar >/dev/null 2>&1 || exit 127; "
+                             "cd -- " + quoteShellArg(getLibssh2Path(targetFolder)) + " && mkdir -- " + tmpQ + " || exit 1; "
+                             "ok=1; tar -x -o -f - -C " + tmpQ + " >/dev/null 2>&1 || ok=0; "
+                             "if [ $ok = 1 ]; then for f in";
+        for (const BatchUploadItem& item : items)
+            script += ' ' + quoteShellArg(utfTo<std::string>(item.targetName));
+        script += "; do mv -f -- " + tmpQ + "/\"$f\" \"$f\" || { ok=0; break; }; done; fi; "
+                  "rm -rf -- " + tmpQ + "; [ $ok = 1 ]";
+
+        std::vector<FileCopyResult> results;
+        size_t itemIdx = 0;
+
+        auto getNextTarEntry = [&]() -> std::string //throw FileError, ErrorFileLocked, X
+        {
+            if (itemIdx > items.size())
+                return {};
+            if (itemIdx == items.size()) //end of archive: two zero blocks
+            {
+                ++itemIdx;
+                return std::string(2 * 512, '\0');
+            }
+            const BatchUploadItem& item = items[itemIdx++];
+
+            auto streamIn = AFS::getInputStream(item.sourcePath, notifyUnbufferedIO); //throw FileError, ErrorFileLocked
+
+            StreamAttributes attrSource = item.attrSource;
+            if (std::optional<StreamAttributes> attr = streamIn->getAttributesBuffered()) //throw FileError
+                attrSource = *attr; //tar header needs the size up front => use most current attributes, if available
+
+            const std::string content = bufferedLoad<std::string>(*streamIn); //throw FileError, ErrorFileLocked, X
+            if (content.size() != attrSource.fileSize)
+                throw FileError(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(AFS::getDisplayPath(item.sourcePath))),
+                                replaceCpy(replaceCpy(_("Unexpected size of data stream.\nExpected: %x bytes\nActual: %y bytes"),
+                                                      L"%x", formatNumber(attrSource.fileSize)),
+                                           L"%y", formatNumber(content.size())));
+            results.push_back({.fileSize = attrSource.fileSize, .modTime = attrSource.modTime, .sourceFilePrint = attrSource.filePrint});
+            try
+            {
+                return getTarFileEntry(utfTo<std::string>(item.targetName), content, attrSource.modTime); //throw SysError
+            }
+            catch (const SysError& e) { throw FileError(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(AFS::getDisplayPath(item.sourcePath))), e.toString()); }
+        };
+
+        const std::wstring errorMsg = replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(getDisplayPath(AfsPath(appendPath(targetFolder.value, items[0].targetName))))) +
+                                      (items.size() > 1 ? L" [+" + formatNumber(items.size() - 1) + L']' : L"");
+        try
+        {
+            int exitStatus = 0;
+            runSshExecCommand(login_, "sh -c " + quoteShellArg(script), exitStatus, getNextTarEntry); //throw SysError, FileError, ErrorFileLocked, X
+
+            if (exitStatus == 126 || exitStatus == 127) //sh or tar not available
+            {
+                shellBatchUploadUnsupported_ = true;
+                throw SysError(L"tar: command not found.");
+            }
+            if (exitStatus != 0)
+                throw SysError(formatSystemError("tar", L"", L"Exit status " + numberTo<std::wstring>(exitStatus) + L'.'));
+
+            shellBatchUploadConfirmed_ = true;
+            assert(results.size() == items.size());
+            return results;
+        }
+        catch (const SysError& e)
+        {
+            if (!shellBatchUploadConfirmed_ && results.empty()) //exec channel not permitted?
+                shellBatchUploadUnsupported_ = true;
+            throw FileError(errorMsg, e.toString());
+        }
+    }
+
+    std::unique_ptr<InputStream> getInputStreamAt(const AfsPath& afsPath, uint64_t offset, const IoCallback& notifyUnbufferedIO /*throw X*/) const override //throw FileError, (ErrorFileLocked)
+    {
+        return std::make_unique<InputStreamSftp>(login_, afsPath, offset, notifyUnbufferedIO); //throw FileError
+    }
+
+    std::unique_ptr<OutputStreamImpl> getOutputStreamAt(const AfsPath& afsPath, uint64_t offset, std::optional<time_t> modTime, //throw FileError
+                                                        const IoCallback& notifyUnbufferedIO /*throw X*/) const override
+    {
+        return std::make_unique<OutputStreamSftp>(login_, afsPath, offset, modTime, notifyUnbufferedIO); //throw FileError
     }
 
     //already existing: undefined behavior! (e.g. fail/overwrite/auto-rename)
@@ -1716,7 +2514,7 @@ private:
                                                       std::optional<time_t> modTime,
                                                       const IoCallback& notifyUnbufferedIO /*throw X*/) const override
     {
-        return std::make_unique<OutputStreamSftp>(login_, afsPath, modTime, notifyUnbufferedIO); //throw FileError
+        return std::make_unique<OutputStreamSftp>(login_, afsPath, std::nullopt /*existingFileOffset*/, modTime, notifyUnbufferedIO); //throw FileError
     }
 
     //----------------------------------------------------------------------------------------------------------------
@@ -1729,14 +2527,76 @@ private:
     //symlink handling: follow
     //already existing: undefined behavior! (e.g. fail/overwrite/auto-rename)
     FileCopyResult copyFileForSameAfsType(const AfsPath& afsSource, const StreamAttributes& attrSource, //throw FileError, (ErrorFileLocked), X
-                                          const AbstractPath& apTarget, bool copyFilePermissions, const IoCallback& notifyUnbufferedIO /*throw X*/) const override
+                                          const AbstractPath& apTarget, bool copyFilePermissions, const IoCallback& notifyUnbufferedIO /*throw X*/,
+                                          std::optional<HashAlgorithm> sourceHashAlgo) const override
     {
-        //no native SFTP file copy => use stream-based file copy:
         if (copyFilePermissions)
             throw FileError(replaceCpy(_("Cannot write permissions of %x."), L"%x", fmtPath(AFS::getDisplayPath(apTarget))), _("Operation not supported by device."));
 
+        //same server: copy remotely instead of download + upload (e.g. versioning on the same server)
+        if (std::optional<FileCopyResult> result = tryCopyFileOnServer(afsSource, apTarget)) //throw FileError
+            return std::move(*result);
+
         //already existing: undefined behavior! (e.g. fail/overwrite/auto-rename)
-        return copyFileAsStream(afsSource, attrSource, apTarget, notifyUnbufferedIO); //throw FileError, (ErrorFileLocked), X
+        return copyFileAsStream(afsSource, attrSource, apTarget, notifyUnbufferedIO, sourceHashAlgo); //throw FileError, (ErrorFileLocked), X
+    }
+
+    bool hasServerSideCopy(const AbstractPath& apTarget) const override
+    {
+        return login_.allowShellCopy && !shellCopyUnsupported_ &&
+               compareDeviceSameAfsType(apTarget.afsDevice.ref()) == std::weak_ordering::equivalent;
+    }
+
+    //SFTP "copy-data" extension would be preferable, but libssh2 has no API for custom SFTP requests => use shell commands instead
+    //std::nullopt: not supported => nothing created, caller falls back to stream-based copy
+    std::optional<FileCopyResult> tryCopyFileOnServer(const AfsPath& afsSource, const AbstractPath& apTarget) const //throw FileError
+    {
+        if (!hasServerSideCopy(apTarget))
+            return std::nullopt;
+
+        const std::string sourcePathQ = quoteShellArg(getLibssh2Path(afsSource));
+        const std::string targetPathQ = quoteShellArg(getLibssh2Path(apTarget.afsPath));
+
+        //GNU cp: clone file if supported by the file system (e.g. Btrfs, XFS), else regular copy; POSIX cp: fails on unknown option => retry
+        const std::string script = "command -v cp >/dev/null 2>&1 && command -v touch >/dev/null 2>&1 || exit 127; "
+                                   "{ cp --reflink=auto -- " + sourcePathQ + ' ' + targetPathQ + " 2>/dev/null || "
+                                   "cp -- " + sourcePathQ + ' ' + targetPathQ + "; } && "
+                                   "touch -r " + sourcePathQ + ' ' + targetPathQ; //"symlink handling: follow" is cp's default for non-recursive copy
+        const std::wstring errorMsg = replaceCpy(replaceCpy(_("Cannot copy file %x to %y."),
+                                                            L"%x", L'\n' + fmtPath(getDisplayPath(afsSource))),
+                                                 L"%y", L'\n' + fmtPath(AFS::getDisplayPath(apTarget)));
+        try
+        {
+            int exitStatus = 0;
+            runSshExecCommand(login_, "sh -c " + quoteShellArg(script), exitStatus); //throw SysError
+
+            if (exitStatus == 126 || exitStatus == 127) //sh, cp or touch not available
+            {
+                shellCopyUnsupported_ = true;
+                return std::nullopt;
+            }
+            shellCopyConfirmed_ = true;
+
+            if (exitStatus != 0) //e.g. source not found, access denied
+                throw FileError(errorMsg, formatSystemError("cp", L"", L"Exit status " + numberTo<std::wstring>(exitStatus) + L'.'));
+        }
+        catch (const SysError& e)
+        {
+            if (!shellCopyConfirmed_) //exec channel not permitted? => nothing was created
+            {
+                shellCopyUnsupported_ = true;
+                return std::nullopt;
+            }
+            throw FileError(errorMsg, e.toString());
+        }
+
+        //report current attributes of the new file, e.g. source changed in the meantime
+        const SftpItemDetails targetDetails = getSymlinkTargetDetails(login_, apTarget.afsPath); //throw FileError
+
+        FileCopyResult result;
+        result.fileSize = targetDetails.fileSize;
+        result.modTime  = targetDetails.modTime;
+        return result;
     }
 
     //symlink handling: follow
@@ -1804,6 +2664,15 @@ private:
 
     void authenticateAccess(bool allowUserInteraction) const override {} //throw FileError
 
+    void prewarmConnections(size_t parallelOps) const override //throw FileError
+    {
+        try
+        {
+            prewarmSftpSessions(login_, parallelOps); //throw SysError
+        }
+        catch (const SysError& e) { throw FileError(replaceCpy(_("Unable to connect to %x."), L"%x", fmtPath(login_.server)), e.toString()); }
+    }
+
     int getAccessTimeout() const override { return login_.timeoutSec; } //returns "0" if no timeout in force
 
     bool hasNativeTransactionalCopy() const override { return false; }
@@ -1850,6 +2719,12 @@ private:
     }
 
     const SftpLogin login_;
+    mutable std::atomic<bool> shellHashConfirmed_{false};   //server hash via shell commands
+    mutable std::atomic<bool> shellHashUnsupported_{false}; //
+    mutable std::atomic<bool> shellBatchUploadConfirmed_{false};   //batch upload via "tar"
+    mutable std::atomic<bool> shellBatchUploadUnsupported_{false}; //
+    mutable std::atomic<bool> shellCopyConfirmed_{false};   //server-side copy via "cp"
+    mutable std::atomic<bool> shellCopyUnsupported_{false}; //
 };
 
 //===========================================================================================================================
@@ -1878,6 +2753,21 @@ Zstring concatenateSftpFolderPathPhrase(const SftpLogin& login, const AfsPath& a
     if (login.traverserChannelsPerConnection != loginDefault.traverserChannelsPerConnection)
         options += Zstr("|chan=") + numberTo<Zstring>(login.traverserChannelsPerConnection);
 
+    if (login.transferRequestsInFlight != loginDefault.transferRequestsInFlight)
+        options += Zstr("|window=") + numberTo<Zstring>(login.transferRequestsInFlight);
+
+    if (login.segmentedCopyStreams != loginDefault.segmentedCopyStreams)
+        options += Zstr("|segments=") + numberTo<Zstring>(login.segmentedCopyStreams);
+
+    if (login.allowShellHash)
+        options += Zstr("|shellhash");
+
+    if (login.allowShellBatchUpload)
+        options += Zstr("|shelltar");
+
+    if (login.allowShellCopy)
+        options += Zstr("|shellcopy");
+
     if (login.allowZlib)
         options += Zstr("|zlib");
 
@@ -1934,6 +2824,8 @@ AfsDevice fff::condenseToSftpDevice(const SftpLogin& login) //noexcept
 
     loginTmp.timeoutSec = std::max(1, loginTmp.timeoutSec);
     loginTmp.traverserChannelsPerConnection = std::max(1, loginTmp.traverserChannelsPerConnection);
+    loginTmp.transferRequestsInFlight       = std::max(1, loginTmp.transferRequestsInFlight);
+    loginTmp.segmentedCopyStreams           = std::max(1, loginTmp.segmentedCopyStreams);
 
     if (startsWithAsciiNoCase(loginTmp.server, "http:" ) ||
         startsWithAsciiNoCase(loginTmp.server, "https:") ||
@@ -2035,6 +2927,10 @@ AbstractPath fff::createItemPathSftp(const Zstring& itemPathPhrase) //noexcept
             login.timeoutSec = stringTo<int>(afterFirst(optPhrase, Zstr("="), IfNotFoundReturn::none));
         else if (startsWith(optPhrase, Zstr("chan=")))
             login.traverserChannelsPerConnection = stringTo<int>(afterFirst(optPhrase, Zstr("="), IfNotFoundReturn::none));
+        else if (startsWith(optPhrase, Zstr("window=")))
+            login.transferRequestsInFlight = stringTo<int>(afterFirst(optPhrase, Zstr("="), IfNotFoundReturn::none));
+        else if (startsWith(optPhrase, Zstr("segments=")))
+            login.segmentedCopyStreams = stringTo<int>(afterFirst(optPhrase, Zstr("="), IfNotFoundReturn::none));
         else if (startsWith(optPhrase, Zstr("keyfile=")))
         {
             login.authType = SftpAuthType::keyFile;
@@ -2046,6 +2942,12 @@ AbstractPath fff::createItemPathSftp(const Zstring& itemPathPhrase) //noexcept
             login.password = decodePasswordBase64(afterFirst(optPhrase, Zstr("="), IfNotFoundReturn::none));
         else if (optPhrase == Zstr("zlib"))
             login.allowZlib = true;
+        else if (optPhrase == Zstr("shellhash"))
+            login.allowShellHash = true;
+        else if (optPhrase == Zstr("shelltar"))
+            login.allowShellBatchUpload = true;
+        else if (optPhrase == Zstr("shellcopy"))
+            login.allowShellCopy = true;
         else
             assert(false);
 
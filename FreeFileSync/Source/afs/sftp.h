@@ -47,6 +47,11 @@ struct SftpLogin : SshSessionId
     //other settings not specific to SFTP session:
     int timeoutSec = 15;                    //valid range: [1, inf)
     int traverserChannelsPerConnection = 1; //valid range: [1, inf)
+    int transferRequestsInFlight = 8;       //valid range: [1, inf); pipelined SFTP READ/WRITE requests per file transfer: increase for high-latency links
+    int segmentedCopyStreams = 1;           //valid range: [1, inf); copy large files as ranges over this many SFTP sessions: work around per-connection throttling
+    bool allowShellHash = false;            //compare by content: let the server hash files via "sha256sum" & co. (requires shell access)
+    bool allowShellBatchUpload = false;     //create small files as a batch: unpack "tar" stream on the server (requires shell access)
+    bool allowShellCopy = false;            //copy within the same server via "cp" instead of download + upload (requires shell access)
 };
 AfsDevice condenseToSftpDevice(const SftpLogin& login); //noexcept; potentially messy user input
 SftpLogin extractSftpLogin(const AfsDevice& afsDevice); //noexcept
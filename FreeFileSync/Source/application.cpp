@@ -7,6 +7,7 @@
 #include "application.h"
 #include <memory>
 #include <zen/file_access.h>
+#include <zen/file_io.h>
 #include <zen/perf.h>
 #include <zen/shutdown.h>
 #include <zen/process_exec.h>
@@ -19,9 +20,12 @@
 #include <wx/msgdlg.h>
 #include "afs/concrete.h"
 #include "base/algorithm.h"
+#include "base/benchmark.h"
+#include "base/cmp_result_file.h"
 #include "base/comparison.h"
 #include "base/synchronization.h"
 #include "ui/batch_status_handler.h"
+#include "ui/file_view.h"
 #include "ui/main_dlg.h"
 #include "base_tools.h"
 //#include "log_file.h"
@@ -58,6 +62,7 @@ void showSyntaxHelp()
                                                  L"    [" + _("config files:") + L" *.ffs_gui/*.ffs_batch]" + L'\n' +
                                                  L"    [-DirPair " + _("directory") + L' ' + _("directory") + L"]" L"\n" +
                                                  L"    [-Edit]" + L'\n' +
+                                                 L"    [-ChangedPaths " + _("file") + L"]" + L'\n' +
                                                  L"    [" + _("global config file:") + L" GlobalSettings.xml]" + L"\n\n" +
 
                                                  _("config files:") + L'\n' +
@@ -69,6 +74,9 @@ void showSyntaxHelp()
                                                  L"-Edit" + '\n' +
                                                  _("Open the selected configuration for editing only, without executing it.") + L"\n\n" +
 
+                                                 L"-ChangedPaths " + _("file") + L'\n' +
+                                                 _("Batch mode: Only compare folders containing the items listed in the file (one path per line), take everything else from the database of the last synchronization.") + L"\n\n" +
+
                                                  _("global config file:") + L'\n' +
                                                  _("Path to an alternate GlobalSettings.xml file.")));
 }
@@ -222,6 +230,13 @@ void Application::onEnterEventLoop(wxEvent& event)
 
 int Application::OnExit()
 {
+    if (!traceFilePath_.empty())
+        try
+        {
+            setFileContent(traceFilePath_, getTraceJson(), nullptr /*notifyUnbufferedIO*/); //throw FileError
+        }
+        catch (const FileError& e) { notifyAppError(e.toString(), FfsExitCode::warning); }
+
     localizationCleanup();
     imageResourcesCleanup();
 
@@ -273,10 +288,19 @@ void Application::launch(const std::vector<Zstring>& commandArgs)
         std::vector<std::pair<Zstring, XmlType>> configFiles; //XmlType: batch or GUI files only
         Zstring globalConfigFile;
         bool openForEdit = false;
+        std::vector<Zstring> changedItemPaths; //incremental comparison (e.g. reported by RealTimeSync)
+        Zstring benchmarkFolderPath;
+        Zstring benchmarkResultPath;
+        std::vector<Zstring> benchmarkArgs;
+        std::vector<Zstring> benchmarkCmpPaths; //baseline, current, report
         {
-            const char* optionEdit    = "-edit";
-            const char* optionDirPair = "-dirpair";
-            const char* optionSendTo  = "-sendto"; //remaining arguments are unspecified number of folder paths; wonky syntax; let's keep it undocumented
+            const char* optionEdit         = "-edit";
+            const char* optionDirPair      = "-dirpair";
+            const char* optionChangedPaths = "-changedpaths";
+            const char* optionSendTo       = "-sendto"; //remaining arguments are unspecified number of folder paths; wonky syntax; let's keep it undocumented
+            const char* optionTrace        = "-trace";  //write Chrome trace/Perfetto JSON on exit (zen/perf.h); for performance analysis => undocumented
+            const char* optionBenchmark    = "-benchmark"; //<work folder> <result.json> [name=value...]: synthetic benchmark (base/benchmark.h), no UI => undocumented
+            const char* optionBenchmarkCmp = "-benchmarkcompare"; //<baseline.json> <current.json> <report.json>: exit code "error" on performance regressions => undocumented
 
             auto isHelpRequest = [](const Zstring& arg)
             {
@@ -291,9 +315,12 @@ void Application::launch(const std::vector<Zstring>& commandArgs)
 
             auto isCommandLineOption = [&](const Zstring& arg)
             {
-                return equalAsciiNoCase(arg, optionEdit   ) ||
-                       equalAsciiNoCase(arg, optionDirPair) ||
-                       equalAsciiNoCase(arg, optionSendTo ) ||
+                return equalAsciiNoCase(arg, optionEdit        ) ||
+                       equalAsciiNoCase(arg, optionDirPair     ) ||
+                       equalAsciiNoCase(arg, optionChangedPaths) ||
+                       equalAsciiNoCase(arg, optionSendTo      ) ||
+                       equalAsciiNoCase(arg, optionTrace       ) ||
+                       equalAsciiNoCase(arg, optionBenchmark   ) ||
                        isHelpRequest(arg);
             };
 
@@ -312,6 +339,49 @@ void Application::launch(const std::vector<Zstring>& commandArgs)
                         throw FileError(replaceCpy(_("A left and a right directory path are expected after %x."), L"%x", utfTo<std::wstring>(optionDirPair)));
                     dirPathPhrasePairs.back().second = *it;
                 }
+                else if (equalAsciiNoCase(*it, optionChangedPaths))
+                {
+                    if (++it == commandArgs.end() || isCommandLineOption(*it))
+                        throw FileError(replaceCpy(_("A file path is expected after %x."), L"%x", utfTo<std::wstring>(optionChangedPaths)));
+
+                    const std::string& changeList = getFileContent(getResolvedFilePath(*it), nullptr /*notifyUnbufferedIO*/); //throw FileError
+                    //empty file => nothing known about the changes => full comparison
+                    for (const std::string& line : split(changeList, '\n', SplitOnEmpty::skip))
+                        if (const Zstring& itemPath = trimCpy(utfTo<Zstring>(line));
+                            !itemPath.empty())
+                            changedItemPaths.push_back(itemPath);
+                }
+                else if (equalAsciiNoCase(*it, optionTrace))
+                {
+                    if (++it == commandArgs.end() || isCommandLineOption(*it))
+                        throw FileError(replaceCpy(_("A file path is expected after %x."), L"%x", utfTo<std::wstring>(optionTrace)));
+
+                    traceFilePath_ = getResolvedFilePath(*it);
+                    enableTracing(true);
+                }
+                else if (equalAsciiNoCase(*it, optionBenchmark))
+                {
+                    if (++it == commandArgs.end() || isCommandLineOption(*it))
+                        throw FileError(replaceCpy(_("A directory path is expected after %x."), L"%x", utfTo<std::wstring>(optionBenchmark)));
+                    benchmarkFolderPath = getResolvedFilePath(*it);
+
+                    if (++it == commandArgs.end() || isCommandLineOption(*it))
+                        throw FileError(replaceCpy(_("A file path is expected after %x."), L"%x", utfTo<std::wstring>(optionBenchmark)));
+                    benchmarkResultPath = getResolvedFilePath(*it);
+
+                    while (++it != commandArgs.end() && contains(*it, Zstr('=')) && !isCommandLineOption(*it))
+                        benchmarkArgs.push_back(*it);
+                    --it;
+                }
+                else if (equalAsciiNoCase(*it, optionBenchmarkCmp))
+                {
+                    for (int i = 0; i < 3; ++i)
+                    {
+                        if (++it == commandArgs.end() || isCommandLineOption(*it))
+                            throw FileError(replaceCpy(_("A file path is expected after %x."), L"%x", utfTo<std::wstring>(optionBenchmarkCmp)));
+                        benchmarkCmpPaths.push_back(getResolvedFilePath(*it));
+                    }
+                }
                 else if (equalAsciiNoCase(*it, optionSendTo))
                 {
                     for (size_t i = 0; ; ++i)
@@ -411,6 +481,41 @@ void Application::launch(const std::vector<Zstring>& commandArgs)
             }
         };
 
+        if (!benchmarkFolderPath.empty())
+        {
+            const BenchmarkConfig benchCfg = parseBenchmarkConfig(benchmarkArgs); //throw FileError
+            setFileContent(benchmarkResultPath, runBenchmark(benchmarkFolderPath, benchCfg, [](FolderComparison& folderCmp, const BenchmarkMeasure& measure)
+            {
+                //GUI view operations: same calls as the main grid on column click/filter change, without rendering
+                FileView view(folderCmp);
+                const int64_t rowCount = view.rowsTotal();
+                bool ascending = false; //alternate: don't sort already sorted input
+
+                for (const auto& [name, colType] : {std::pair("view.sortView.path", ColumnTypeRim::path),
+                                                    std::pair("view.sortView.size", ColumnTypeRim::size),
+                                                    std::pair("view.sortView.date", ColumnTypeRim::date)})
+                    measure(name, rowCount, [&, colType /*clang bug*/= colType] { view.sortView(colType, ItemPathFormat::relative, true /*onLeft*/, ascending = !ascending); });
+
+                measure("view.sortView.action", rowCount, [&] { view.sortView(ColumnTypeCenter::action, ascending = !ascending); });
+
+                measure("view.applyDifferenceFilter", rowCount, [&] { view.applyDifferenceFilter(true, true, true, true, true, true, true, true); });
+                measure("view.applyActionFilter",     rowCount, [&] { view.applyActionFilter(true, true, true, true, true, true, true, true, true, true); });
+            }), nullptr /*notifyUnbufferedIO*/); //throw FileError
+            return;
+        }
+
+        if (!benchmarkCmpPaths.empty())
+        {
+            const BenchmarkComparison benchCmp = compareBenchmarks(getFileContent(benchmarkCmpPaths[0], nullptr /*notifyUnbufferedIO*/), //throw FileError
+                                                                   getFileContent(benchmarkCmpPaths[1], nullptr /*notifyUnbufferedIO*/),
+                                                                   BENCHMARK_CMP_ALPHA, BENCHMARK_CMP_MIN_CHANGE_PERCENT);
+            setFileContent(benchmarkCmpPaths[2], benchCmp.report, nullptr /*notifyUnbufferedIO*/); //throw FileError
+
+            if (benchCmp.regressions > 0)
+                notifyAppError(L"Performance regressions: " + numberTo<std::wstring>(benchCmp.regressions) + L' ' + fmtPath(benchmarkCmpPaths[2]), FfsExitCode::error); //diagnostics only => untranslated
+            return;
+        }
+
         //distinguish sync scenarios:
         //---------------------------
         const Zstring globalConfigFilePath = !globalConfigFile.empty() ? globalConfigFile : getGlobalConfigDefaultPath();
@@ -444,7 +549,7 @@ void Application::launch(const std::vector<Zstring>& commandArgs)
 
                 replaceDirectories(batchCfg.mainCfg); //throw FileError
 
-                runBatchMode(globalConfigFilePath, batchCfg, filepath);
+                runBatchMode(globalConfigFilePath, batchCfg, filepath, changedItemPaths);
             }
             //GUI mode: single config (ffs_gui *or* ffs_batch)
             else
@@ -498,7 +603,8 @@ void Application::runGuiMode(const Zstring& globalConfigFilePath,
 }
 
 
-void Application::runBatchMode(const Zstring& globalConfigFilePath, const XmlBatchConfig& batchCfg, const Zstring& cfgFilePath)
+void Application::runBatchMode(const Zstring& globalConfigFilePath, const XmlBatchConfig& batchCfg, const Zstring& cfgFilePath,
+                               const std::vector<Zstring>& changedItemPaths)
 {
     XmlGlobalSettings globalCfg;
     try
@@ -575,12 +681,31 @@ void Application::runBatchMode(const Zstring& globalConfigFilePath, const XmlBat
         //COMPARE DIRECTORIES
         FolderComparison cmpResult = compare(globalCfg.warnDlgs,
                                              globalCfg.fileTimeTolerance,
+                                             globalCfg.contentCmpTrustDatabase,
+                                             globalCfg.timeSizeVerifyContent,
+                                             globalCfg.remoteScanTrustDatabase,
+                                             globalCfg.snapshotChangeDiscovery,
+                                             globalCfg.outOfCoreComparison,
                                              allowUserInteraction,
                                              globalCfg.runWithBackgroundPriority,
                                              globalCfg.createLockFile,
                                              dirLocks,
                                              extractCompareCfg(batchCfg.mainCfg),
+                                             batchCfg.mainCfg.deviceParallelOps,
+                                             changedItemPaths,
+                                             nullptr /*onPairCompared*/,
                                              statusHandler); //throw AbortProcess
+
+        //save before synchronization changes it: review what the batch job did without rescanning
+        if (globalCfg.saveComparisonResult && !cmpResult.empty() && !cfgFilePath.empty())
+            try
+            {
+                const Zstring cmpFilePath = getCmpResultFilePath(cfgFilePath);
+                saveComparisonResult(cmpResult, cfgFilePath, std::chrono::system_clock::to_time_t(syncStartTime), cmpFilePath); //throw FileError
+                statusHandler.logInfo(replaceCpy(_("Comparison result saved: %x"), L"%x", fmtPath(cmpFilePath))); //throw AbortProcess
+            }
+            catch (const FileError& e) { statusHandler.logInfo(e.toString()); } //throw AbortProcess; not fatal
+
         //START SYNCHRONIZATION
         if (!cmpResult.empty())
             synchronize(syncStartTime,
@@ -588,9 +713,23 @@ void Application::runBatchMode(const Zstring& globalConfigFilePath, const XmlBat
                         globalCfg.copyLockedFiles,
                         globalCfg.copyFilePermissions,
                         globalCfg.failSafeFileCopy,
+                        globalCfg.syncDbJournal,
                         globalCfg.runWithBackgroundPriority,
+                        globalCfg.syncIoPriority,
+                        globalCfg.dropPageCacheBehind,
+                        globalCfg.flushTargetBuffers,
+                        static_cast<uint64_t>(std::max(globalCfg.deltaCopyMinSizeMB, 0)) * 1024 * 1024,
+                        static_cast<uint64_t>(std::max(globalCfg.resumableCopyMinSizeMB, 0)) * 1024 * 1024,
+                        globalCfg.compressVersions,
                         extractSyncCfg(batchCfg.mainCfg),
                         cmpResult,
+                        batchCfg.mainCfg.deviceParallelOps,
+                        globalCfg.autoTuneParallelOps,
+                        globalCfg.globalDeviceBudget,
+                        batchCfg.mainCfg.deviceBandwidthLimits,
+                        batchCfg.mainCfg.autoRetryCount,
+                        batchCfg.mainCfg.autoRetryDelay,
+                        globalCfg.syncHistory,
                         globalCfg.warnDlgs,
                         statusHandler); //throw AbortProcess
     }
@@ -604,7 +743,7 @@ void Application::runBatchMode(const Zstring& globalConfigFilePath, const XmlBat
         logFolderPath = createAbstractPath(getLogFolderDefaultPath());
 
     BatchStatusHandler::Result r = statusHandler.reportResults(batchCfg.mainCfg.postSyncCommand, batchCfg.mainCfg.postSyncCondition,
-                                                               logFolderPath, globalCfg.logfilesMaxAgeDays, globalCfg.logFormat, logFilePathsToKeep,
+                                                               logFolderPath, globalCfg.logfilesMaxAgeDays, globalCfg.logFormat, globalCfg.logMetrics, logFilePathsToKeep,
                                                                batchCfg.mainCfg.emailNotifyAddress, batchCfg.mainCfg.emailNotifyCondition); //noexcept
     //----------------------------------------------------------------------
     switch (r.syncResult)
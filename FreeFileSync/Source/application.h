@@ -31,9 +31,11 @@ private:
 
     void runGuiMode  (const Zstring& globalConfigFile);
     void runGuiMode  (const Zstring& globalConfigFile, const XmlGuiConfig& guiCfg, const std::vector<Zstring>& cfgFilePaths, bool startComparison);
-    void runBatchMode(const Zstring& globalConfigFile, const XmlBatchConfig& batchCfg, const Zstring& cfgFilePath);
+    void runBatchMode(const Zstring& globalConfigFile, const XmlBatchConfig& batchCfg, const Zstring& cfgFilePath,
+                      const std::vector<Zstring>& changedItemPaths /*optional: incremental comparison*/);
 
     FfsExitCode exitCode_ = FfsExitCode::success;
+    Zstring traceFilePath_; //optional: "-Trace" command line option
 };
 }
 
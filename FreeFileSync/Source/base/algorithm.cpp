@@ -26,13 +26,31 @@ void fff::swapGrids(const MainConfiguration& mainCfg, FolderComparison& folderCm
     std::for_each(begin(folderCmp), end(folderCmp), [](BaseFolderPair& baseFolder) { baseFolder.flip(); });
 
     redetermineSyncDirection(extractDirectionCfg(folderCmp, mainCfg),
-                             callback); //throw FileError
+                             nullptr /*buf*/, callback); //throw FileError
 }
 
 //----------------------------------------------------------------------------------------------
 
 namespace
 {
+//resumable copy: keep the partial temp file of a copy that is still pending, see AFS::getResumableTempFileName()
+//=> stale ones (source changed, or already in sync) are deleted as usual
+template <SelectSide sideTrg>
+bool isPendingResumableCopy(const FilePair& tmpFile)
+{
+    constexpr SelectSide sideSrc = getOtherSide<sideTrg>;
+
+    for (const FilePair& file : tmpFile.parent().refSubFiles())
+        if (&file != &tmpFile && !file.isEmpty<sideSrc>() && file.getCategory() != FILE_EQUAL)
+        {
+            const AFS::StreamAttributes attrSource{file.getLastWriteTime<sideSrc>(), file.getFileSize<sideSrc>(), file.getFilePrint<sideSrc>()};
+            if (AFS::getResumableTempFileName(file.getItemName<sideSrc>(), attrSource) == tmpFile.getItemName<sideTrg>())
+                return true;
+        }
+    return false;
+}
+
+
 //visitFSObjectRecursively? nope, see premature end of traversal in processFolder()
 class SetSyncDirectionByConfig
 {
@@ -44,6 +62,9 @@ private:
 
     void recurse(ContainerObject& hierObj) const
     {
+        if (hierObj.isSpilled()) //equal items only: sync direction "none" already
+            return;
+
         for (FilePair& file : hierObj.refSubFiles())
             processFile(file);
         for (SymlinkPair& link : hierObj.refSubLinks())
@@ -58,9 +79,9 @@ private:
 
         //##################### schedule old temporary files for deletion ####################
         if (cat == FILE_LEFT_SIDE_ONLY && endsWith(file.getItemName<SelectSide::left>(), AFS::TEMP_FILE_ENDING))
-            return file.setSyncDir(SyncDirection::left);
+            return file.setSyncDir(isPendingResumableCopy<SelectSide::left>(file) ? SyncDirection::none : SyncDirection::left);
         else if (cat == FILE_RIGHT_SIDE_ONLY && endsWith(file.getItemName<SelectSide::right>(), AFS::TEMP_FILE_ENDING))
-            return file.setSyncDir(SyncDirection::right);
+            return file.setSyncDir(isPendingResumableCopy<SelectSide::right>(file) ? SyncDirection::none : SyncDirection::right);
         //####################################################################################
 
         switch (cat)
@@ -80,8 +101,18 @@ private:
             case FILE_DIFFERENT_CONTENT:
                 file.setSyncDir(dirCfg_.different);
                 break;
+            case FILE_DIFFERENT_METADATA:
+                //CompareVariant::timeSize: different time, but content found equal => direction as if categorized by time
+                if (file.base().getCompVariant() == CompareVariant::timeSize)
+                    if (const TimeResult tr = compareFileTime(file.getLastWriteTime<SelectSide::left >(),
+                                                              file.getLastWriteTime<SelectSide::right>(), file.base().getTimeTolerance());
+                        tr == TimeResult::leftNewer || tr == TimeResult::rightNewer)
+                    {
+                        file.setSyncDir(tr == TimeResult::leftNewer ? dirCfg_.leftNewer : dirCfg_.rightNewer);
+                        break;
+                    }
+                [[fallthrough]]; //short name case: use setting from "conflict/cannot categorize"
             case FILE_CONFLICT:
-            case FILE_DIFFERENT_METADATA: //use setting from "conflict/cannot categorize"
                 if (dirCfg_.conflict == SyncDirection::none)
                     file.setSyncDirConflict(file.getCatExtraDescription()); //take over category conflict
                 else
@@ -167,6 +198,9 @@ private:
 //test if non-equal items exist in scanned data
 bool allItemsCategoryEqual(const ContainerObject& hierObj)
 {
+    if (hierObj.isSpilled()) //see spillInSyncSubTrees()
+        return true;
+
     return std::all_of(hierObj.refSubFiles().begin(), hierObj.refSubFiles().end(),
     [](const FilePair& file) { return file.getCategory() == FILE_EQUAL; })&&
 
@@ -190,7 +224,7 @@ bool fff::allElementsEqual(const FolderComparison& folderCmp)
 namespace
 {
 template <SelectSide side> inline
-bool matchesDbEntry(const FilePair& file, const InSyncFile* dbFile, const std::vector<unsigned int>& ignoreTimeShiftMinutes)
+bool matchesDbEntry(const FilePair& file, const InSyncFile* dbFile, const TimeTolerance& dbTimeTolerance)
 {
     if (file.isEmpty<side>())
         return !dbFile;
@@ -200,7 +234,7 @@ bool matchesDbEntry(const FilePair& file, const InSyncFile* dbFile, const std::v
     const InSyncDescrFile& descrDb = selectParam<side>(dbFile->left, dbFile->right);
 
     return //we're not interested in "fileTimeTolerance" here!
-        sameFileTime(file.getLastWriteTime<side>(), descrDb.modTime, FAT_FILE_TIME_PRECISION_SEC, ignoreTimeShiftMinutes) &&
+        sameFileTime(file.getLastWriteTime<side>(), descrDb.modTime, dbTimeTolerance) &&
         file.getFileSize<side>() == dbFile->fileSize;
     //note: we do *not* consider file ID here, but are only interested in *visual* changes. Consider user moving data to some other medium, this is not a change!
 }
@@ -208,7 +242,7 @@ bool matchesDbEntry(const FilePair& file, const InSyncFile* dbFile, const std::v
 
 //check whether database entry is in sync considering *current* comparison settings
 inline
-bool stillInSync(const InSyncFile& dbFile, CompareVariant compareVar, int fileTimeTolerance, const std::vector<unsigned int>& ignoreTimeShiftMinutes)
+bool stillInSync(const InSyncFile& dbFile, CompareVariant compareVar, const TimeTolerance& timeTolerance)
 {
     switch (compareVar)
     {
@@ -216,7 +250,7 @@ bool stillInSync(const InSyncFile& dbFile, CompareVariant compareVar, int fileTi
             if (dbFile.cmpVar == CompareVariant::content) return true; //special rule: this is certainly "good enough" for CompareVariant::timeSize!
 
             //case-sensitive short name match is a database invariant!
-            return sameFileTime(dbFile.left.modTime, dbFile.right.modTime, fileTimeTolerance, ignoreTimeShiftMinutes);
+            return sameFileTime(dbFile.left.modTime, dbFile.right.modTime, timeTolerance);
 
         case CompareVariant::content:
             //case-sensitive short name match is a database invariant!
@@ -234,7 +268,7 @@ bool stillInSync(const InSyncFile& dbFile, CompareVariant compareVar, int fileTi
 
 //check whether database entry and current item match: *irrespective* of current comparison settings
 template <SelectSide side> inline
-bool matchesDbEntry(const SymlinkPair& symlink, const InSyncSymlink* dbSymlink, const std::vector<unsigned int>& ignoreTimeShiftMinutes)
+bool matchesDbEntry(const SymlinkPair& symlink, const InSyncSymlink* dbSymlink, const TimeTolerance& dbTimeTolerance)
 {
     if (symlink.isEmpty<side>())
         return !dbSymlink;
@@ -243,13 +277,13 @@ bool matchesDbEntry(const SymlinkPair& symlink, const InSyncSymlink* dbSymlink,
 
     const InSyncDescrLink& descrDb = selectParam<side>(dbSymlink->left, dbSymlink->right);
 
-    return sameFileTime(symlink.getLastWriteTime<side>(), descrDb.modTime, FAT_FILE_TIME_PRECISION_SEC, ignoreTimeShiftMinutes);
+    return sameFileTime(symlink.getLastWriteTime<side>(), descrDb.modTime, dbTimeTolerance);
 }
 
 
 //check whether database entry is in sync considering *current* comparison settings
 inline
-bool stillInSync(const InSyncSymlink& dbLink, CompareVariant compareVar, int fileTimeTolerance, const std::vector<unsigned int>& ignoreTimeShiftMinutes)
+bool stillInSync(const InSyncSymlink& dbLink, CompareVariant compareVar, const TimeTolerance& timeTolerance)
 {
     switch (compareVar)
     {
@@ -258,7 +292,7 @@ bool stillInSync(const InSyncSymlink& dbLink, CompareVariant compareVar, int fil
                 return true; //special rule: this is already "good enough" for CompareVariant::timeSize!
 
             //case-sensitive short name match is a database invariant!
-            return sameFileTime(dbLink.left.modTime, dbLink.right.modTime, fileTimeTolerance, ignoreTimeShiftMinutes);
+            return sameFileTime(dbLink.left.modTime, dbLink.right.modTime, timeTolerance);
 
         case CompareVariant::content:
         case CompareVariant::size: //== categorized by content! see comparison.cpp, ComparisonBuffer::compareBySize()
@@ -290,38 +324,104 @@ bool stillInSync(const InSyncFolder& dbFolder)
 
 //----------------------------------------------------------------------------------------------
 
+//open addressing hash table: file print -> unique file item (or nullptr if print is ambiguous)
+class FilePrintIndex
+{
+public:
+    //returns nullptr if file print was already in use
+    FilePair** insert(AFS::FingerPrint filePrint, FilePair& file)
+    {
+        assert(filePrint != 0);
+        if (2 * (size_ + 1) > slots_.size()) //max load factor 0.5 => short probe sequences
+            rehash(std::max<size_t>(64, 2 * slots_.size()));
+
+        Slot& slot = slots_[findPos(filePrint)];
+        if (slot.filePrint == 0)
+        {
+            slot = {filePrint, &file};
+            ++size_;
+            return nullptr;
+        }
+        return &slot.file;
+    }
+
+    FilePair* find(AFS::FingerPrint filePrint) const
+    {
+        assert(filePrint != 0);
+        return slots_.empty() ? nullptr : slots_[findPos(filePrint)].file;
+    }
+
+    bool empty() const { return size_ == 0; }
+
+private:
+    struct Slot
+    {
+        AFS::FingerPrint filePrint = 0; //0: empty slot
+        FilePair* file = nullptr;
+    };
+
+    size_t findPos(AFS::FingerPrint filePrint) const //linear probing: position of filePrint or first empty slot
+    {
+        const size_t mask = slots_.size() - 1;
+        //file prints are not uniformly distributed (e.g. sequential inode numbers) => Fibonacci hashing
+        for (size_t pos = static_cast<size_t>((filePrint * 0x9E3779B97F4A7C15ULL) >> 32);; ++pos)
+            if (const AFS::FingerPrint slotPrint = slots_[pos & mask].filePrint;
+                slotPrint == filePrint || slotPrint == 0)
+                return pos & mask;
+    }
+
+    void rehash(size_t slotCount) //power of 2
+    {
+        std::vector<Slot> slotsOld(slotCount);
+        slotsOld.swap(slots_);
+
+        for (const Slot& slot : slotsOld)
+            if (slot.filePrint != 0)
+                slots_[findPos(slot.filePrint)] = slot;
+    }
+
+    std::vector<Slot> slots_;
+    size_t size_ = 0;
+};
+
+
 class DetectMovedFiles
 {
 public:
-    static void execute(BaseFolderPair& baseFolder, const InSyncFolder& dbFolder) { DetectMovedFiles(baseFolder, dbFolder); }
+    static void execute(BaseFolderPair& baseFolder, const InSyncFolder& dbFolder, bool byTimeSize) { DetectMovedFiles(baseFolder, dbFolder, byTimeSize); }
 
 private:
-    DetectMovedFiles(BaseFolderPair& baseFolder, const InSyncFolder& dbFolder) :
-        cmpVar_           (baseFolder.getCompVariant()),
-        fileTimeTolerance_(baseFolder.getFileTimeTolerance()),
-        ignoreTimeShiftMinutes_(baseFolder.getIgnoredTimeShift())
+    DetectMovedFiles(BaseFolderPair& baseFolder, const InSyncFolder& dbFolder, bool byTimeSize) :
+        cmpVar_       (baseFolder.getCompVariant()),
+        timeTolerance_(baseFolder.getTimeTolerance()),
+        byTimeSize_(byTimeSize)
     {
         recurse(baseFolder, &dbFolder, &dbFolder);
 
-        purgeDuplicates<SelectSide::left >(filesL_,  exLeftOnlyById_);
-        purgeDuplicates<SelectSide::right>(filesR_, exRightOnlyById_);
+        if ((!filesByIdL_.empty() || !exLeftOnlyByPath_ .empty() || !exLeftOnlyByTimeSize_ .empty()) &&
+            (!filesByIdR_.empty() || !exRightOnlyByPath_.empty() || !exRightOnlyByTimeSize_.empty()))
+        {
+            if (!exLeftOnlyByTimeSize_.empty() || !exRightOnlyByTimeSize_.empty())
+                countDbTimeSize(dbFolder);
 
-        if ((!exLeftOnlyById_ .empty() || !exLeftOnlyByPath_ .empty()) &&
-            (!exRightOnlyById_.empty() || !exRightOnlyByPath_.empty()))
             detectMovePairs(dbFolder);
+        }
     }
 
     void recurse(ContainerObject& hierObj, const InSyncFolder* dbFolderL, const InSyncFolder* dbFolderR)
     {
+        if (hierObj.isSpilled()) //equal items only: no move candidates
+            return;
+
         for (FilePair& file : hierObj.refSubFiles())
         {
-            const AFS::FingerPrint filePrintL = file.getFilePrint<SelectSide::left >();
-            const AFS::FingerPrint filePrintR = file.getFilePrint<SelectSide::right>();
+            const bool noFilePrintL = file.getFilePrint<SelectSide::left >() == 0; //get before duplicates are cleared
+            const bool noFilePrintR = file.getFilePrint<SelectSide::right>() == 0; //
 
-            if (filePrintL != 0) filesL_.push_back(&file); //collect *all* prints for uniqueness check!
-            if (filePrintR != 0) filesR_.push_back(&file); //
+            addFilePrint<SelectSide::left >(file); //collect *all* prints for uniqueness check!
+            addFilePrint<SelectSide::right>(file); //
 
-            auto getDbEntry = [](const InSyncFolder* dbFolder, const Zstring& fileName) -> const InSyncFile*
+            auto getDbEntry = [](const InSyncFolder* dbFolder, const ZstringNorm& fileName) -> const InSyncFile*
             {
                 if (dbFolder)
                     if (const auto it = dbFolder->files.find(fileName);
@@ -333,13 +433,17 @@ private:
             if (const CompareFileResult cat = file.getCategory();
                 cat == FILE_LEFT_SIDE_ONLY)
             {
-                if (const InSyncFile* dbEntry = getDbEntry(dbFolderL, file.getItemName<SelectSide::left>()))
+                if (const InSyncFile* dbEntry = getDbEntry(dbFolderL, file.getItemNameNorm<SelectSide::left>()))
                     exLeftOnlyByPath_.emplace(dbEntry, &file);
+                else if (byTimeSize_ && noFilePrintL)
+                    addTimeSize<SelectSide::left>(file);
             }
             else if (cat == FILE_RIGHT_SIDE_ONLY)
             {
-                if (const InSyncFile* dbEntry = getDbEntry(dbFolderR, file.getItemName<SelectSide::right>()))
+                if (const InSyncFile* dbEntry = getDbEntry(dbFolderR, file.getItemNameNorm<SelectSide::right>()))
                     exRightOnlyByPath_.emplace(dbEntry, &file);
+                else if (byTimeSize_ && noFilePrintR)
+                    addTimeSize<SelectSide::right>(file);
             }
         }
 
@@ -353,8 +457,8 @@ private:
                         return &it->second;
                 return nullptr;
             };
-            const ZstringNorm itemNameL = folder.getItemName<SelectSide::left >();
-            const ZstringNorm itemNameR = folder.getItemName<SelectSide::right>();
+            const ZstringNorm itemNameL = folder.getItemNameNorm<SelectSide::left >();
+            const ZstringNorm itemNameR = folder.getItemNameNorm<SelectSide::right>();
 
             const InSyncFolder* dbEntryL = getDbEntry(dbFolderL, itemNameL);
             const InSyncFolder* dbEntryR = dbFolderL == dbFolderR && itemNameL == itemNameR ?
@@ -365,40 +469,56 @@ private:
     }
 
     template <SelectSide side>
-    static void purgeDuplicates(std::vector<FilePair*>& files,
-                                std::unordered_map<AFS::FingerPrint, FilePair*>& exOneSideById)
+    void addFilePrint(FilePair& file)
     {
-        if (!files.empty())
-        {
-            std::sort(files.begin(), files.end(), [](const FilePair* lhs, const FilePair* rhs)
-            { return lhs->getFilePrint<side>() < rhs->getFilePrint<side>(); });
-
-            AFS::FingerPrint prevPrint = files[0]->getFilePrint<side>();
-
-            for (auto it = files.begin() + 1; it != files.end(); ++it)
-                if (const AFS::FingerPrint filePrint = (*it)->getFilePrint<side>();
-                    prevPrint != filePrint)
-                    prevPrint = filePrint;
-                else //duplicate file ID! NTFS hard link/symlink?
+        if (const AFS::FingerPrint filePrint = file.getFilePrint<side>();
+            filePrint != 0)
+            if (FilePair** fileFirst = selectParam<side>(filesByIdL_, filesByIdR_).insert(filePrint, file))
+            {
+                //duplicate file ID! NTFS hard link/symlink?
+                //remove from model: do *not* store invalid file prints in sync.ffs_db!
+                if (*fileFirst)
                 {
-                    const auto dupFirst = it - 1;
-                    const auto dupLast = std::find_if(it + 1, files.end(), [prevPrint](const FilePair* file)
-                    { return file->getFilePrint<side>() != prevPrint; });
-
-                    //remove from model: do *not* store invalid file prints in sync.ffs_db!
-                    std::for_each(dupFirst, dupLast, [](FilePair* file) { file->clearFilePrint<side>(); });
-                    it = dupLast - 1;
+                    (*fileFirst)->clearFilePrint<side>();
+                    *fileFirst = nullptr; //keep index entry: mark file print as ambiguous
                 }
+                file.clearFilePrint<side>();
+            }
+    }
+
+    using TimeSizeKey = std::pair<uint64_t /*file size*/, time_t /*modification time*/>;
+    struct TimeSizeCandidate
+    {
+        FilePair* file = nullptr; //nullptr if ambiguous
+        size_t dbItemCount = 0;
+    };
 
-            //collect unique file prints for files existing on one side only:
-            constexpr CompareFileResult oneSideOnlyTag = side == SelectSide::left ? FILE_LEFT_SIDE_ONLY : FILE_RIGHT_SIDE_ONLY;
+    template <SelectSide side>
+    void addTimeSize(FilePair& file)
+    {
+        auto& exOneSideByTimeSize = selectParam<side>(exLeftOnlyByTimeSize_, exRightOnlyByTimeSize_);
 
-            for (FilePair* file : files)
-                if (file->getCategory() == oneSideOnlyTag)
-                    if (const AFS::FingerPrint filePrint = file->getFilePrint<side>();
-                        filePrint != 0) //skip duplicates marked by clearFilePrint()
-                        exOneSideById.emplace(filePrint, file);
+        if (const auto [it, inserted] = exOneSideByTimeSize.try_emplace({file.getFileSize<side>(), file.getLastWriteTime<side>()}, TimeSizeCandidate{&file});
+            !inserted)
+            it->second.file = nullptr; //not unique => no association
+    }
+
+    void countDbTimeSize(const InSyncFolder& container)
+    {
+        for (const auto& [fileName, dbAttrib] : container.files)
+        {
+            auto countItem = [fileSize = dbAttrib.fileSize](std::map<TimeSizeKey, TimeSizeCandidate>& exOneSideByTimeSize, const InSyncDescrFile& descr)
+            {
+                if (const auto it = exOneSideByTimeSize.find({fileSize, descr.modTime});
+                    it != exOneSideByTimeSize.end())
+                    ++it->second.dbItemCount;
+            };
+            countItem(exLeftOnlyByTimeSize_,  dbAttrib.left);
+            countItem(exRightOnlyByTimeSize_, dbAttrib.right);
         }
+
+        for (const auto& [folderName, subFolder] : container.folders)
+            countDbTimeSize(subFolder);
     }
 
     void detectMovePairs(const InSyncFolder& container) const
@@ -430,7 +550,7 @@ private:
     FilePair* getAssocFilePair(const InSyncFile& dbFile) const
     {
         const std::unordered_map<const InSyncFile*, FilePair*>& exOneSideByPath = selectParam<side>(exLeftOnlyByPath_, exRightOnlyByPath_);
-        const std::unordered_map<AFS::FingerPrint,  FilePair*>& exOneSideById   = selectParam<side>(exLeftOnlyById_,   exRightOnlyById_);
+        const FilePrintIndex& filesById = selectParam<side>(filesByIdL_, filesByIdR_);
 
         if (const auto it = exOneSideByPath.find(&dbFile);
             it != exOneSideByPath.end())
@@ -440,16 +560,30 @@ private:
 
         if (const AFS::FingerPrint filePrint = selectParam<side>(dbFile.left, dbFile.right).filePrint;
             filePrint != 0)
-            if (const auto it = exOneSideById.find(filePrint);
-                it != exOneSideById.end())
-                return it->second;
+        {
+            if (FilePair* file = filesById.find(filePrint)) //nullptr if ambiguous
+            {
+                constexpr CompareFileResult oneSideOnlyTag = side == SelectSide::left ? FILE_LEFT_SIDE_ONLY : FILE_RIGHT_SIDE_ONLY;
+                if (file->getCategory() == oneSideOnlyTag)
+                    return file;
+            }
+        }
+        else if (byTimeSize_) //no file ID available (e.g. FTP, SFTP): fall back to size and modification time, but *only* if unique on both file system and database
+        {
+            const std::map<TimeSizeKey, TimeSizeCandidate>& exOneSideByTimeSize = selectParam<side>(exLeftOnlyByTimeSize_, exRightOnlyByTimeSize_);
+
+            if (const auto it = exOneSideByTimeSize.find({dbFile.fileSize, selectParam<side>(dbFile.left, dbFile.right).modTime});
+                it != exOneSideByTimeSize.end())
+                if (it->second.dbItemCount == 1)
+                    return it->second.file; //nullptr if ambiguous
+        }
 
         return nullptr;
     }
 
     void findAndSetMovePair(const InSyncFile& dbFile) const
     {
-        if (stillInSync(dbFile, cmpVar_, fileTimeTolerance_, ignoreTimeShiftMinutes_))
+        if (stillInSync(dbFile, cmpVar_, timeTolerance_))
             if (FilePair* fileLeftOnly = getAssocFilePair<SelectSide::left>(dbFile))
                 if (sameSizeAndDate<SelectSide::left>(*fileLeftOnly, dbFile))
                     if (FilePair* fileRightOnly = getAssocFilePair<SelectSide::right>(dbFile))
@@ -470,18 +604,18 @@ private:
     }
 
     const CompareVariant cmpVar_;
-    const int fileTimeTolerance_;
-    const std::vector<unsigned int> ignoreTimeShiftMinutes_;
+    const TimeTolerance& timeTolerance_;
+    const bool byTimeSize_;
 
-    std::vector<FilePair*> filesL_; //collection of *all* file items (with non-null filePrint)
-    std::vector<FilePair*> filesR_; // => detect duplicate file IDs
-
-    std::unordered_map<AFS::FingerPrint, FilePair*>  exLeftOnlyById_; //MSVC: twice as fast as std::map for 1 million items!
-    std::unordered_map<AFS::FingerPrint, FilePair*> exRightOnlyById_;
+    FilePrintIndex filesByIdL_; //*all* file items with non-null filePrint => detect duplicate file IDs
+    FilePrintIndex filesByIdR_; //single pass, no per-item allocations: 10 million items!
 
     std::unordered_map<const InSyncFile*, FilePair*>  exLeftOnlyByPath_; //MSVC: only 4% faster than std::map for 1 million items!
     std::unordered_map<const InSyncFile*, FilePair*> exRightOnlyByPath_;
 
+    std::map<TimeSizeKey, TimeSizeCandidate>  exLeftOnlyByTimeSize_; //only files without file ID and without association by path
+    std::map<TimeSizeKey, TimeSizeCandidate> exRightOnlyByTimeSize_;
+
     /*  Detect Renamed Files:
 
          X  ->  |_|      Create right
@@ -496,6 +630,9 @@ private:
               |  (file ID, size, date)                   |  (file ID, size, date)
               |            or                            |            or
               |  (file path, size, date)                 |  (file path, size, date)
+              |            or                            |            or
+              |  (unique size, date): optional fallback  |  (unique size, date): optional fallback
+              |   if no file ID (FTP, SFTP)              |   if no file ID (FTP, SFTP)
              \|/                                        \|/
         file left only                             file right only
 
@@ -514,9 +651,9 @@ public:
 
 private:
     SetSyncDirectionsTwoWay(BaseFolderPair& baseFolder, const InSyncFolder& dbFolder) :
-        cmpVar_                (baseFolder.getCompVariant()),
-        fileTimeTolerance_     (baseFolder.getFileTimeTolerance()),
-        ignoreTimeShiftMinutes_(baseFolder.getIgnoredTimeShift())
+        cmpVar_         (baseFolder.getCompVariant()),
+        timeTolerance_  (baseFolder.getTimeTolerance()),
+        dbTimeTolerance_(FAT_FILE_TIME_PRECISION_SEC, baseFolder.getIgnoredTimeShift())
     {
         //-> considering filter not relevant:
         //  if stricter filter than last time: all ok;
@@ -526,6 +663,9 @@ private:
 
     void recurse(ContainerObject& hierObj, const InSyncFolder* dbFolder) const
     {
+        if (hierObj.isSpilled()) //equal items only: nothing to do, see processFile()
+            return;
+
         for (FilePair& file : hierObj.refSubFiles())
             processFile(file, dbFolder);
         for (SymlinkPair& symlink : hierObj.refSubLinks())
@@ -542,9 +682,9 @@ private:
 
         //##################### schedule old temporary files for deletion ####################
         if (cat == FILE_LEFT_SIDE_ONLY && endsWith(file.getItemName<SelectSide::left>(), AFS::TEMP_FILE_ENDING))
-            return file.setSyncDir(SyncDirection::left);
+            return file.setSyncDir(isPendingResumableCopy<SelectSide::left>(file) ? SyncDirection::none : SyncDirection::left);
         else if (cat == FILE_RIGHT_SIDE_ONLY && endsWith(file.getItemName<SelectSide::right>(), AFS::TEMP_FILE_ENDING))
-            return file.setSyncDir(SyncDirection::right);
+            return file.setSyncDir(isPendingResumableCopy<SelectSide::right>(file) ? SyncDirection::none : SyncDirection::right);
         //####################################################################################
 
         //try to find corresponding database entry
@@ -556,8 +696,8 @@ private:
                     return &it->second;
             return nullptr;
         };
-        const ZstringNorm itemNameL = file.getItemName<SelectSide::left >();
-        const ZstringNorm itemNameR = file.getItemName<SelectSide::right>();
+        const ZstringNorm itemNameL = file.getItemNameNorm<SelectSide::left >();
+        const ZstringNorm itemNameR = file.getItemNameNorm<SelectSide::right>();
 
         const InSyncFile* dbEntryL = getDbEntry(itemNameL);
         const InSyncFile* dbEntryR = itemNameL == itemNameR ? dbEntryL : getDbEntry(itemNameR);
@@ -565,13 +705,13 @@ private:
         if (dbEntryL && dbEntryR && dbEntryL != dbEntryR) //conflict: which db entry to use?
             return file.setSyncDirConflict(txtDbAmbiguous_);
 
-        const bool changeOnLeft  = !matchesDbEntry<SelectSide::left >(file, dbEntryL, ignoreTimeShiftMinutes_);
-        const bool changeOnRight = !matchesDbEntry<SelectSide::right>(file, dbEntryR, ignoreTimeShiftMinutes_);
+        const bool changeOnLeft  = !matchesDbEntry<SelectSide::left >(file, dbEntryL, dbTimeTolerance_);
+        const bool changeOnRight = !matchesDbEntry<SelectSide::right>(file, dbEntryR, dbTimeTolerance_);
 
         if (changeOnLeft == changeOnRight)
             file.setSyncDirConflict(changeOnLeft ? txtBothSidesChanged_ : txtNoSideChanged_);
         else if (const InSyncFile* dbEntry = dbEntryL ? dbEntryL : dbEntryR;
-                 dbEntry && !stillInSync(*dbEntry, cmpVar_, fileTimeTolerance_, ignoreTimeShiftMinutes_))
+                 dbEntry && !stillInSync(*dbEntry, cmpVar_, timeTolerance_))
             file.setSyncDirConflict(txtDbNotInSync_);
         else
             file.setSyncDir(changeOnLeft ? SyncDirection::right : SyncDirection::left);
@@ -592,8 +732,8 @@ private:
                     return &it->second;
             return nullptr;
         };
-        const ZstringNorm itemNameL = symlink.getItemName<SelectSide::left >();
-        const ZstringNorm itemNameR = symlink.getItemName<SelectSide::right>();
+        const ZstringNorm itemNameL = symlink.getItemNameNorm<SelectSide::left >();
+        const ZstringNorm itemNameR = symlink.getItemNameNorm<SelectSide::right>();
 
         const InSyncSymlink* dbEntryL = getDbEntry(itemNameL);
         const InSyncSymlink* dbEntryR = itemNameL == itemNameR ? dbEntryL : getDbEntry(itemNameR);
@@ -601,13 +741,13 @@ private:
         if (dbEntryL && dbEntryR && dbEntryL != dbEntryR) //conflict: which db entry to use?
             return symlink.setSyncDirConflict(txtDbAmbiguous_);
 
-        const bool changeOnLeft  = !matchesDbEntry<SelectSide::left >(symlink, dbEntryL, ignoreTimeShiftMinutes_);
-        const bool changeOnRight = !matchesDbEntry<SelectSide::right>(symlink, dbEntryR, ignoreTimeShiftMinutes_);
+        const bool changeOnLeft  = !matchesDbEntry<SelectSide::left >(symlink, dbEntryL, dbTimeTolerance_);
+        const bool changeOnRight = !matchesDbEntry<SelectSide::right>(symlink, dbEntryR, dbTimeTolerance_);
 
         if (changeOnLeft == changeOnRight)
             symlink.setSyncDirConflict(changeOnLeft ? txtBothSidesChanged_ : txtNoSideChanged_);
         else if (const InSyncSymlink* dbEntry = dbEntryL ? dbEntryL : dbEntryR;
-                 dbEntry && !stillInSync(*dbEntry, cmpVar_, fileTimeTolerance_, ignoreTimeShiftMinutes_))
+                 dbEntry && !stillInSync(*dbEntry, cmpVar_, timeTolerance_))
             symlink.setSyncDirConflict(txtDbNotInSync_);
         else
             symlink.setSyncDir(changeOnLeft ? SyncDirection::right : SyncDirection::left);
@@ -634,8 +774,8 @@ private:
             return nullptr;
         };
 
-        const ZstringNorm itemNameL = folder.getItemName<SelectSide::left >();
-        const ZstringNorm itemNameR = folder.getItemName<SelectSide::right>();
+        const ZstringNorm itemNameL = folder.getItemNameNorm<SelectSide::left >();
+        const ZstringNorm itemNameR = folder.getItemNameNorm<SelectSide::right>();
 
         const InSyncFolder* dbEntryL = getDbEntry(itemNameL);
         const InSyncFolder* dbEntryR = itemNameL == itemNameR ? dbEntryL : getDbEntry(itemNameR);
@@ -674,8 +814,8 @@ private:
     const Zstringc txtDbAmbiguous_      = utfTo<Zstringc>(_("Cannot determine sync-direction:") + L'\n' + _("The database entry is ambiguous."));
 
     const CompareVariant cmpVar_;
-    const int fileTimeTolerance_;
-    const std::vector<unsigned int> ignoreTimeShiftMinutes_;
+    const TimeTolerance& timeTolerance_;
+    const TimeTolerance dbTimeTolerance_; //FAT precision + ignored time shifts
 };
 }
 
@@ -708,51 +848,87 @@ std::vector<std::pair<BaseFolderPair*, SyncDirectionConfig>> fff::extractDirecti
 }
 
 
-void fff::redetermineSyncDirection(const std::vector<std::pair<BaseFolderPair*, SyncDirectionConfig>>& directCfgs,
+void fff::redetermineSyncDirection(const std::vector<std::pair<BaseFolderPair*, SyncDirectionConfig>>& directCfgsAll,
+                                   SyncDirectionBuffer* buf, //optional
                                    PhaseCallback& callback /*throw X*/) //throw X
 {
+    auto getBufferState = [buf](const BaseFolderPair* baseFolder) -> const SyncDirectionBuffer::BaseFolderState*
+    {
+        if (buf)
+            if (auto it = buf->baseFolders_.find(baseFolder);
+                it != buf->baseFolders_.end())
+                return &it->second;
+        return nullptr;
+    };
+
+    std::vector<std::pair<BaseFolderPair*, SyncDirectionConfig>> directCfgs;
+    for (const auto& [baseFolder, dirCfg] : directCfgsAll)
+        if (const SyncDirectionBuffer::BaseFolderState* state = getBufferState(baseFolder);
+            !state || state->dirCfg != dirCfg || state->changeId != baseFolder->getChangeId()) //else: nothing changed since last evaluation
+            directCfgs.emplace_back(baseFolder, dirCfg);
+
     if (directCfgs.empty())
         return;
 
     std::unordered_set<const BaseFolderPair*> allEqualPairs;
     std::unordered_map<const BaseFolderPair*, SharedRef<const InSyncFolder>> lastSyncStates;
+    bool dbLoadComplete = false; //don't buffer fallback directions after user cancelled
 
-    //best effort: always set sync directions (even on DB load error and when user cancels during file loading)
-    ZEN_ON_SCOPE_EXIT
-    (
-        //*INDENT-OFF*
+    auto setSyncDirections = [&]
+    {
+        std::vector<std::pair<BaseFolderPair*, SyncDirectionConfig>> workload;
         for (const auto& [baseFolder, dirCfg] : directCfgs)
             if (!allEqualPairs.contains(baseFolder))
             {
-                auto it = lastSyncStates.find(baseFolder);
-                const InSyncFolder* lastSyncState = it != lastSyncStates.end() ? &it->second.ref() : nullptr;
-
-                //set sync directions
-                if (dirCfg.var == SyncVariant::twoWay)
+                if (dirCfg.var == SyncVariant::twoWay && !lastSyncStates.contains(baseFolder)) //default fallback
                 {
-                    if (lastSyncState)
-                        SetSyncDirectionsTwoWay::execute(*baseFolder, *lastSyncState);
-                    else //default fallback
-                    {
-                        std::wstring msg = _("Setting directions for first synchronization: Old files will be overwritten with newer files.");
-                        if (directCfgs.size() > 1)
-                            msg += L'\n' + AFS::getDisplayPath(baseFolder->getAbstractPath<SelectSide::left >()) + L' ' + getVariantNameWithSymbol(dirCfg.var) + L' ' +
-                                          AFS::getDisplayPath(baseFolder->getAbstractPath<SelectSide::right>());
-
-                        try { callback.logInfo(msg); /*throw X*/} catch (...) {};
+                    std::wstring msg = _("Setting directions for first synchronization: Old files will be overwritten with newer files.");
+                    if (directCfgs.size() > 1)
+                        msg += L'\n' + AFS::getDisplayPath(baseFolder->getAbstractPath<SelectSide::left >()) + L' ' + getVariantNameWithSymbol(dirCfg.var) + L' ' +
+                                      AFS::getDisplayPath(baseFolder->getAbstractPath<SelectSide::right>());
 
-                        SetSyncDirectionByConfig::execute(getTwoWayUpdateSet(), *baseFolder);
-                    }
+                    try { callback.logInfo(msg); /*throw X*/} catch (...) {};
                 }
-                else
-                    SetSyncDirectionByConfig::execute(extractDirections(dirCfg), *baseFolder);
+                workload.emplace_back(baseFolder, dirCfg);
+            }
+
+        //CPU-bound only, and base folder pairs are independent => one thread per pair
+        runParallel(workload.size(), [&](size_t pos)
+        {
+            const auto& [baseFolder, dirCfg] = workload[pos];
+
+            auto it = lastSyncStates.find(baseFolder);
+            const InSyncFolder* lastSyncState = it != lastSyncStates.end() ? &it->second.ref() : nullptr;
 
-                //detect renamed files
+            //set sync directions
+            if (dirCfg.var == SyncVariant::twoWay)
+            {
                 if (lastSyncState)
-                    DetectMovedFiles::execute(*baseFolder, *lastSyncState);
+                    SetSyncDirectionsTwoWay::execute(*baseFolder, *lastSyncState);
+                else //default fallback
+                    SetSyncDirectionByConfig::execute(getTwoWayUpdateSet(), *baseFolder);
             }
-        //*INDENT-ON*
-    );
+            else
+                SetSyncDirectionByConfig::execute(extractDirections(dirCfg), *baseFolder);
+
+            //detect renamed files
+            if (lastSyncState)
+                DetectMovedFiles::execute(*baseFolder, *lastSyncState, dirCfg.detectMovedFilesByTimeSize);
+        });
+
+        if (buf && dbLoadComplete)
+            for (const auto& [baseFolder, dirCfg] : directCfgs)
+            {
+                SyncDirectionBuffer::BaseFolderState& state = buf->baseFolders_[baseFolder];
+                if (auto it = lastSyncStates.find(baseFolder);
+                    it != lastSyncStates.end())
+                    state.lastSyncState = it->second.ptr();
+                state.dirCfg   = dirCfg;
+                state.changeId = baseFolder->getChangeId();
+            }
+    };
+    //best effort: always set sync directions (even on DB load error and when user cancels during file loading)
+    ZEN_ON_SCOPE_EXIT(setSyncDirections());
 
     std::vector<const BaseFolderPair*> baseFoldersForDbLoad;
     for (const auto& [baseFolder, dirCfg] : directCfgs)
@@ -760,13 +936,17 @@ void fff::redetermineSyncDirection(const std::vector<std::pair<BaseFolderPair*,
         {
             if (allItemsCategoryEqual(*baseFolder)) //nothing to do: don't even try to open DB files
                 allEqualPairs.insert(baseFolder);
+            else if (const SyncDirectionBuffer::BaseFolderState* state = getBufferState(baseFolder);
+                     state && state->lastSyncState)
+                lastSyncStates.emplace(baseFolder, SharedRef<const InSyncFolder>(state->lastSyncState)); //perf: database already loaded for this comparison
             else
                 baseFoldersForDbLoad.push_back(baseFolder);
         }
 
     //(try to) load sync-database files
-    lastSyncStates = loadLastSynchronousState(baseFoldersForDbLoad,
-                                              callback /*throw X*/); //throw X
+    lastSyncStates.merge(loadLastSynchronousState(baseFoldersForDbLoad, nullptr /*namePool*/,
+                                                  callback /*throw X*/)); //throw X
+    dbLoadComplete = true;
 
     callback.updateStatus(_("Calculating sync directions...")); //throw X
     callback.requestUiUpdate(true /*force*/); //throw X
@@ -784,6 +964,59 @@ void fff::setSyncDirectionRec(SyncDirection newDirection, FileSystemObject& fsOb
     visitFSObjectRecursively(fsObj, onFsItem, onFsItem, onFsItem);
 }
 
+
+namespace
+{
+//bulk changes of a GUI selection (e.g. 1M rows): visit each item once + independent folder pairs in parallel
+template <class Function>
+void visitSelectionRecursively(const std::vector<FileSystemObject*>& selection, Function onFsItem)
+{
+    std::unordered_set<const ContainerObject*> selectedFolders;
+    for (const FileSystemObject* fsObj : selection)
+        if (auto folder = dynamic_cast<const FolderPair*>(fsObj))
+            selectedFolders.insert(folder);
+
+    //skip items below selected folders: already covered by recursion (tree view selections include all child rows!)
+    auto isNestedInSelection = [&](const FileSystemObject& fsObj)
+    {
+        for (const ContainerObject* parent = &fsObj.parent(); parent != &fsObj.base(); )
+        {
+            auto folder = static_cast<const FolderPair*>(parent); //parent is either a FolderPair or the BaseFolderPair
+            if (selectedFolders.contains(folder))
+                return true;
+            parent = &folder->parent();
+        }
+        return false;
+    };
+
+    std::unordered_map<const BaseFolderPair*, std::vector<FileSystemObject*>> selectionByBase;
+    for (FileSystemObject* fsObj : selection)
+        if (selectedFolders.empty() || !isNestedInSelection(*fsObj))
+            selectionByBase[&fsObj->base()].push_back(fsObj);
+
+    std::vector<const std::vector<FileSystemObject*>*> workload;
+    for (const auto& [baseFolder, baseSelection] : selectionByBase)
+        workload.push_back(&baseSelection);
+
+    //folder pairs are independent: change ids are updated atomically, see ContainerObject::lastChangeId_
+    runParallel(workload.size(), [&](size_t pos)
+    {
+        for (FileSystemObject* fsObj : *workload[pos])
+            visitFSObjectRecursively(*fsObj, onFsItem, onFsItem, onFsItem);
+    });
+}
+}
+
+
+void fff::setSyncDirectionRec(SyncDirection newDirection, const std::vector<FileSystemObject*>& selection)
+{
+    visitSelectionRecursively(selection, [newDirection](FileSystemObject& fsObj)
+    {
+        if (fsObj.getCategory() != FILE_EQUAL)
+            fsObj.setSyncDir(newDirection);
+    });
+}
+
 //--------------- functions related to filtering ------------------------------------------------------------------------------------
 
 void fff::setActiveStatus(bool newStatus, FolderComparison& folderCmp)
@@ -805,6 +1038,12 @@ void fff::setActiveStatus(bool newStatus, FileSystemObject& fsObj)
 }
 
 
+void fff::setActiveStatus(bool newStatus, const std::vector<FileSystemObject*>& selection)
+{
+    visitSelectionRecursively(selection, [newStatus](FileSystemObject& fsObj) { fsObj.setActive(newStatus); });
+}
+
+
 namespace
 {
 enum FilterStrategy
@@ -831,57 +1070,96 @@ struct Eval<STRATEGY_AND>
 };
 
 
+/*  ApplyHardFilter in two passes:
+      1. evaluate filter: CPU-bound + read-only => sub trees are evaluated in parallel
+      2. set the changed active status on the main thread: change ids propagate to the parent folders => not thread-safe  */
 template <FilterStrategy strategy>
 class ApplyHardFilter
 {
 public:
-    static void execute(ContainerObject& hierObj, const PathFilter& filterProcIn) { ApplyHardFilter(hierObj, filterProcIn); }
+    static void execute(ContainerObject& hierObj, const PathFilter& filterProcIn)
+    {
+        const ApplyHardFilter filter(filterProcIn);
+        FilterTask rootTask;
+        {
+            //caveat: declare *after* filter and rootTask: worker threads are joined in ThreadGroup destructor
+            FilterThreadGroup filterGroup(std::max<size_t>(std::thread::hardware_concurrency(), 1), Zstr("Apply Filter"));
+
+            filter.recurse(hierObj, 0 /*depth*/, rootTask, filterGroup);
+            filterGroup.wait();
+        }
+        applyChanges(rootTask);
+    }
 
 private:
-    ApplyHardFilter(ContainerObject& hierObj, const PathFilter& filterProcIn) : filterProc(filterProcIn)  { recurse(hierObj); }
+    using FilterThreadGroup = ThreadGroup<std::function<void()>>;
 
-    void recurse(ContainerObject& hierObj) const
+    struct FilterTask
+    {
+        std::vector<std::pair<FileSystemObject*, bool /*active*/>> changes; //perf: don't touch unchanged items in pass 2
+        std::list<FilterTask> subTasks; //stable addresses
+    };
+
+    //sub trees of folders up to this level below the base folder are evaluated by separate tasks
+    static constexpr int FILTER_PARALLEL_DEPTH = 2;
+
+    explicit ApplyHardFilter(const PathFilter& filterProcIn) : filterProc_(filterProcIn) {}
+
+    void recurse(ContainerObject& hierObj, int depth, FilterTask& task, FilterThreadGroup& filterGroup) const
     {
+        ChildPathBuilder itemPath(hierObj.getRelativePathAny());
+
         for (FilePair& file : hierObj.refSubFiles())
-            processFile(file);
+            if (Eval<strategy>::process(file))
+                setActive(task, file, filterProc_.passFileFilter(itemPath.getPath(file.getItemNameAny())));
+
         for (SymlinkPair& symlink : hierObj.refSubLinks())
-            processLink(symlink);
+            if (Eval<strategy>::process(symlink))
+                setActive(task, symlink, filterProc_.passFileFilter(itemPath.getPath(symlink.getItemNameAny())));
+
         for (FolderPair& folder : hierObj.refSubFolders())
-            processDir(folder);
-    }
+        {
+            bool childItemMightMatch = true;
+            const bool filterPassed = filterProc_.passDirFilter(folder.getRelativePathAny(), &childItemMightMatch);
 
-    void processFile(FilePair& file) const
-    {
-        if (Eval<strategy>::process(file))
-            file.setActive(filterProc.passFileFilter(file.getRelativePathAny()));
+            if (Eval<strategy>::process(folder))
+                setActive(task, folder, filterPassed);
+
+            if (!childItemMightMatch) //use same logic like directory traversing here: evaluate filter in subdirs only if objects could match
+            {
+                //exclude all files dirs in subfolders => incompatible with STRATEGY_OR!
+                auto onFsItem = [&task](FileSystemObject& fsObj) { setActive(task, fsObj, false); };
+                visitFSObjectRecursively(static_cast<ContainerObject&>(folder), onFsItem, onFsItem, onFsItem);
+            }
+            else if (depth < FILTER_PARALLEL_DEPTH)
+            {
+                FilterTask& subTask = task.subTasks.emplace_back();
+                filterGroup.run([this, &folder, depth, &subTask, &filterGroup] //context of worker thread
+                {
+                    recurse(folder, depth + 1, subTask, filterGroup);
+                });
+            }
+            else
+                recurse(folder, depth + 1, task, filterGroup);
+        }
     }
 
-    void processLink(SymlinkPair& symlink) const
+    static void setActive(FilterTask& task, FileSystemObject& fsObj, bool active)
     {
-        if (Eval<strategy>::process(symlink))
-            symlink.setActive(filterProc.passFileFilter(symlink.getRelativePathAny()));
+        if (fsObj.isActive() != active)
+            task.changes.emplace_back(&fsObj, active);
     }
 
-    void processDir(FolderPair& folder) const
+    static void applyChanges(const FilterTask& task)
     {
-        bool childItemMightMatch = true;
-        const bool filterPassed = filterProc.passDirFilter(folder.getRelativePathAny(), &childItemMightMatch);
-
-        if (Eval<strategy>::process(folder))
-            folder.setActive(filterPassed);
-
-        if (!childItemMightMatch) //use same logic like directory traversing here: evaluate filter in subdirs only if objects could match
-        {
-            //exclude all files dirs in subfolders => incompatible with STRATEGY_OR!
-            auto onFsItem = [](FileSystemObject& fsObj) { fsObj.setActive(false); };
-            visitFSObjectRecursively(static_cast<ContainerObject&>(folder), onFsItem, onFsItem, onFsItem);
-            return;
-        }
+        for (const auto& [fsObj, active] : task.changes)
+            fsObj->setActive(active);
 
-        recurse(folder);
+        for (const FilterTask& subTask : task.subTasks)
+            applyChanges(subTask);
     }
 
-    const PathFilter& filterProc;
+    const PathFilter& filterProc_;
 };
 
 
@@ -1135,13 +1413,12 @@ void copyToAlternateFolderFrom(const std::vector<const FileSystemObject*>& rowsT
                                const AbstractPath& targetFolderPath,
                                bool keepRelPaths,
                                bool overwriteIfExists,
+                               const std::map<AfsDevice, size_t>& deviceParallelOps,
                                ProcessCallback& callback /*throw X*/) //throw X
 {
-    auto notifyItemCopy = [&](const std::wstring& statusText, const std::wstring& displayPath)
+    auto notifyItemCopy = [](const std::wstring& statusText, const std::wstring& displayPath, AsyncCallback& acb)
     {
-        std::wstring msg = replaceCpy(statusText, L"%x", fmtPath(displayPath));
-        callback.logInfo(msg);                 //throw X
-        callback.updateStatus(std::move(msg)); //
+        acb.reportInfo(replaceCpy(statusText, L"%x", fmtPath(displayPath))); //throw ThreadStopRequest
     };
     const std::wstring txtCreatingFile  (_("Creating file %x"         ));
     const std::wstring txtCreatingFolder(_("Creating folder %x"       ));
@@ -1194,62 +1471,76 @@ void copyToAlternateFolderFrom(const std::vector<const FileSystemObject*>& rowsT
         }
     };
 
+    //work items only read the file model => safe to run in parallel
+    std::vector<std::pair<AbstractPath, ParallelWorkItem>> parallelWorkload;
+
     for (const FileSystemObject* fsObj : rowsToCopy)
-        tryReportingError([&]
+        parallelWorkload.emplace_back(fsObj->getAbstractPath<side>(), [&, fsObj](ParallelContext& ctx) //throw ThreadStopRequest
     {
-        const Zstring& relPath = keepRelPaths ? fsObj->getRelativePath<side>() : fsObj->getItemName<side>();
-        const AbstractPath sourcePath = fsObj->getAbstractPath<side>();
-        const AbstractPath targetPath = AFS::appendRelPath(targetFolderPath, relPath);
-
-        visitFSObject(*fsObj, [&](const FolderPair& folder)
+        tryReportingError([&]
         {
-            ItemStatReporter statReporter(1, 0, callback);
-            notifyItemCopy(txtCreatingFolder, AFS::getDisplayPath(targetPath));
+            const Zstring& relPath = keepRelPaths ? fsObj->getRelativePath<side>() : fsObj->getItemName<side>();
+            const AbstractPath& sourcePath = ctx.itemPath;
+            const AbstractPath targetPath = AFS::appendRelPath(targetFolderPath, relPath);
 
-            AFS::createFolderIfMissingRecursion(targetPath); //throw FileError
-            statReporter.reportDelta(1, 0);
-            //folder might already exist: see creation of intermediate directories below
-        },
+            visitFSObject(*fsObj, [&](const FolderPair& folder)
+            {
+                AsyncItemStatReporter statReporter(1, 0, ctx.acb);
+                notifyItemCopy(txtCreatingFolder, AFS::getDisplayPath(targetPath), ctx.acb); //throw ThreadStopRequest
 
-        [&](const FilePair& file)
-        {
-            std::wstring statusMsg = replaceCpy(txtCreatingFile, L"%x", fmtPath(AFS::getDisplayPath(targetPath)));
-            callback.logInfo(statusMsg); //throw X
-            PercentStatReporter statReporter(std::move(statusMsg), file.getFileSize<side>(), callback); //throw X
+                AFS::createFolderIfMissingRecursion(targetPath); //throw FileError
+                statReporter.reportDelta(1, 0);
+                //folder might already exist: see creation of intermediate directories below
+            },
+
+            [&](const FilePair& file)
+            {
+                std::wstring statusMsg = replaceCpy(txtCreatingFile, L"%x", fmtPath(AFS::getDisplayPath(targetPath)));
+                ctx.acb.logInfo(statusMsg); //throw ThreadStopRequest
+                AsyncPercentStatReporter statReporter(std::move(statusMsg), file.getFileSize<side>(), ctx.acb); //throw ThreadStopRequest
 
-            const FileAttributes attr = file.getAttributes<side>();
-            const AFS::StreamAttributes sourceAttr{attr.modTime, attr.fileSize, attr.filePrint};
+                const FileAttributes attr = file.getAttributes<side>();
+                const AFS::StreamAttributes sourceAttr{attr.modTime, attr.fileSize, attr.filePrint};
 
-            copyItem(targetPath, [&](const std::function<void()>& deleteTargetItem) //throw FileError
+                copyItem(targetPath, [&](const std::function<void()>& deleteTargetItem) //throw FileError
+                {
+                    //already existing + !overwriteIfExists: undefined behavior! (e.g. fail/overwrite/auto-rename)
+                    /*const AFS::FileCopyResult result =*/ AFS::copyFileTransactional(sourcePath, sourceAttr, targetPath, //throw FileError, ErrorFileLocked, ThreadStopRequest
+                                                                                      false /*copyFilePermissions*/, true /*transactionalCopy*/, false /*deltaCopy*/, std::nullopt /*resumableCopy*/, deleteTargetItem,
+                                                                                      [&](int64_t bytesDelta)
+                    {
+                        statReporter.updateStatus(0, bytesDelta); //throw ThreadStopRequest
+                        interruptionPoint(); //throw ThreadStopRequest => not reliably covered by AsyncPercentStatReporter::updateStatus()!
+                    }, std::nullopt /*sourceHashAlgo*/);
+                    //result.errorModTime? => probably irrelevant (behave like Windows Explorer)
+                });
+                statReporter.updateStatus(1, 0); //throw ThreadStopRequest
+            },
+
+            [&](const SymlinkPair& symlink)
             {
-                //already existing + !overwriteIfExists: undefined behavior! (e.g. fail/overwrite/auto-rename)
-                /*const AFS::FileCopyResult result =*/ AFS::copyFileTransactional(sourcePath, sourceAttr, targetPath, //throw FileError, ErrorFileLocked, X
-                                                                                  false /*copyFilePermissions*/, true /*transactionalCopy*/, deleteTargetItem,
-                                                                                  [&](int64_t bytesDelta)
+                AsyncItemStatReporter statReporter(1, 0, ctx.acb);
+                notifyItemCopy(txtCreatingLink, AFS::getDisplayPath(targetPath), ctx.acb); //throw ThreadStopRequest
+
+                copyItem(targetPath, [&](const std::function<void()>& deleteTargetItem) //throw FileError
                 {
-                    statReporter.updateStatus(0, bytesDelta); //throw X
-                    callback.requestUiUpdate(); //throw X  => not reliably covered by PercentStatReporter::updateStatus()! e.g. during first few seconds: STATUS_PERCENT_DELAY!
+                    deleteTargetItem(); //throw FileError
+                    AFS::copySymlink(sourcePath, targetPath, false /*copyFilePermissions*/); //throw FileError
                 });
-                //result.errorModTime? => probably irrelevant (behave like Windows Explorer)
+                statReporter.reportDelta(1, 0);
             });
-            statReporter.updateStatus(1, 0); //throw X
-        },
+        }, ctx.acb); //throw ThreadStopRequest
+    });
 
-        [&](const SymlinkPair& symlink)
-        {
-            ItemStatReporter statReporter(1, 0, callback);
-            notifyItemCopy(txtCreatingLink, AFS::getDisplayPath(targetPath));
+    //all copies write to the same target device => don't exceed its parallel operations per source device
+    const size_t parallelOpsTrg = getDeviceParallelOps(deviceParallelOps, targetFolderPath.afsDevice);
 
-            copyItem(targetPath, [&](const std::function<void()>& deleteTargetItem) //throw FileError
-            {
-                deleteTargetItem(); //throw FileError
-                AFS::copySymlink(sourcePath, targetPath, false /*copyFilePermissions*/); //throw FileError
-            });
-            statReporter.reportDelta(1, 0);
-        });
+    std::map<AfsDevice, size_t> copyParallelOps;
+    for (const auto& [sourcePath, workItem] : parallelWorkload)
+        copyParallelOps[sourcePath.afsDevice] = std::min(getDeviceParallelOps(deviceParallelOps, sourcePath.afsDevice), parallelOpsTrg);
 
-        callback.requestUiUpdate(); //throw X
-    }, callback); //throw X
+    massParallelExecute(parallelWorkload, copyParallelOps,
+                        Zstr("Copy to"), callback /*throw X*/); //throw X
 }
 }
 
@@ -1259,6 +1550,7 @@ void fff::copyToAlternateFolder(std::span<const FileSystemObject* const> rowsToC
                                 const Zstring& targetFolderPathPhrase,
                                 bool keepRelPaths,
                                 bool overwriteIfExists,
+                                const std::map<AfsDevice, size_t>& deviceParallelOps,
                                 WarningDialogs& warnings,
                                 ProcessCallback& callback /*throw X*/) //throw X
 {
@@ -1284,8 +1576,8 @@ void fff::copyToAlternateFolder(std::span<const FileSystemObject* const> rowsToC
 
     const AbstractPath targetFolderPath = createAbstractPath(targetFolderPathPhrase);
 
-    copyToAlternateFolderFrom<SelectSide::left >(itemSelectionLeft,  targetFolderPath, keepRelPaths, overwriteIfExists, callback);
-    copyToAlternateFolderFrom<SelectSide::right>(itemSelectionRight, targetFolderPath, keepRelPaths, overwriteIfExists, callback);
+    copyToAlternateFolderFrom<SelectSide::left >(itemSelectionLeft,  targetFolderPath, keepRelPaths, overwriteIfExists, deviceParallelOps, callback); //throw X
+    copyToAlternateFolderFrom<SelectSide::right>(itemSelectionRight, targetFolderPath, keepRelPaths, overwriteIfExists, deviceParallelOps, callback); //
 }
 
 //############################################################################################################
@@ -1293,15 +1585,14 @@ void fff::copyToAlternateFolder(std::span<const FileSystemObject* const> rowsToC
 namespace
 {
 template <SelectSide side>
-void deleteFromGridAndHDOneSide(std::vector<FileSystemObject*>& rowsToDelete,
+void deleteFromGridAndHDOneSide(const std::vector<FileSystemObject*>& rowsToDelete,
                                 bool useRecycleBin,
-                                PhaseCallback& callback)
+                                const std::map<AfsDevice, size_t>& deviceParallelOps,
+                                PhaseCallback& callback /*throw X*/) //throw X
 {
-    auto notifyItemDeletion = [&](const std::wstring& statusText, const std::wstring& displayPath)
+    auto notifyItemDeletion = [](const std::wstring& statusText, const std::wstring& displayPath, AsyncCallback& acb)
     {
-        std::wstring msg = replaceCpy(statusText, L"%x", fmtPath(displayPath));
-        callback.logInfo(msg);                 //throw X
-        callback.updateStatus(std::move(msg)); //
+        acb.reportInfo(replaceCpy(statusText, L"%x", fmtPath(displayPath))); //throw ThreadStopRequest
     };
 
     std::wstring txtRemovingFile;
@@ -1321,69 +1612,102 @@ void deleteFromGridAndHDOneSide(std::vector<FileSystemObject*>& rowsToDelete,
         txtRemovingSymlink   = _("Deleting symbolic link %x");
     }
 
-
-    for (FileSystemObject* fsObj : rowsToDelete) //all pointers are required(!) to be bound
-        tryReportingError([&]
+    //don't race a folder's recursive deletion against selected items inside it:
+    //delete top-most rows first, then what's left over (e.g. parent folder deletion failed)
+    for (std::vector<FileSystemObject*> rowsRemaining = rowsToDelete; !rowsRemaining.empty();)
     {
-        ItemStatReporter statReporter(1, 0, callback);
+        const std::unordered_set<const FileSystemObject*> rowsRemainingSet(rowsRemaining.begin(), rowsRemaining.end());
 
-        if (!fsObj->isEmpty<side>()) //element may be implicitly deleted, e.g. if parent folder was deleted first
+        std::vector<FileSystemObject*> rowsNow;
+        std::vector<FileSystemObject*> rowsLater;
+        for (FileSystemObject* fsObj : rowsRemaining) //all pointers are required(!) to be bound
         {
-            visitFSObject(*fsObj,
-                          [&](const FolderPair& folder)
+            bool haveParentRow = false;
+            for (const FolderPair* f = dynamic_cast<const FolderPair*>(&fsObj->parent()); f && !haveParentRow; f = dynamic_cast<const FolderPair*>(&f->parent()))
+                haveParentRow = rowsRemainingSet.contains(f);
+
+            (haveParentRow ? rowsLater : rowsNow).push_back(fsObj);
+        }
+
+        //work items only read the file model => update it on main thread, even if cancelled: remain transactional as much as possible
+        std::vector<char> rowsDeleted(rowsNow.size()); //each work item writes its own element only
+        ZEN_ON_SCOPE_EXIT
+        (
+            for (size_t i = 0; i < rowsNow.size(); ++i)
+                if (rowsDeleted[i])
+                    rowsNow[i]->removeObject<side>(); //if directory: removes recursively!
+        );
+
+        std::vector<std::pair<AbstractPath, ParallelWorkItem>> parallelWorkload;
+
+        for (size_t i = 0; i < rowsNow.size(); ++i)
+            parallelWorkload.emplace_back(rowsNow[i]->getAbstractPath<side>(), [&, fsObj = rowsNow[i], &rowDeleted = rowsDeleted[i]](ParallelContext& ctx) //throw ThreadStopRequest
+        {
+            tryReportingError([&]
             {
-                if (useRecycleBin)
-                {
-                    notifyItemDeletion(txtRemovingDirectory, AFS::getDisplayPath(folder.getAbstractPath<side>())); //throw X
+                AsyncItemStatReporter statReporter(1, 0, ctx.acb);
 
-                    AFS::recycleItemIfExists(folder.getAbstractPath<side>()); //throw FileError
-                    statReporter.reportDelta(1, 0);
-                }
-                else
+                if (!fsObj->isEmpty<side>()) //element may be implicitly deleted, e.g. if parent folder was deleted first
                 {
-                    auto onBeforeFileDeletion = [&](const std::wstring& displayPath)
-                    {
-                        notifyItemDeletion(txtRemovingFile, displayPath); //throw X
-                        statReporter.reportDelta(1, 0);
-                    };
-                    auto onBeforeDirDeletion = [&](const std::wstring& displayPath)
+                    visitFSObject(*fsObj,
+                                  [&](const FolderPair& folder)
                     {
-                        notifyItemDeletion(txtRemovingDirectory, displayPath); //throw X
-                        statReporter.reportDelta(1, 0);
-                    };
+                        if (useRecycleBin)
+                        {
+                            notifyItemDeletion(txtRemovingDirectory, AFS::getDisplayPath(ctx.itemPath), ctx.acb); //throw ThreadStopRequest
 
-                    AFS::removeFolderIfExistsRecursion(folder.getAbstractPath<side>(), onBeforeFileDeletion, onBeforeDirDeletion); //throw FileError
-                }
-            },
+                            AFS::recycleItemIfExists(ctx.itemPath); //throw FileError
+                            statReporter.reportDelta(1, 0);
+                        }
+                        else
+                        {
+                            auto onBeforeFileDeletion = [&](const std::wstring& displayPath)
+                            {
+                                notifyItemDeletion(txtRemovingFile, displayPath, ctx.acb); //throw ThreadStopRequest
+                                statReporter.reportDelta(1, 0);
+                            };
+                            auto onBeforeDirDeletion = [&](const std::wstring& displayPath)
+                            {
+                                notifyItemDeletion(txtRemovingDirectory, displayPath, ctx.acb); //throw ThreadStopRequest
+                                statReporter.reportDelta(1, 0);
+                            };
 
-            [&](const FilePair& file)
-            {
-                notifyItemDeletion(txtRemovingFile, AFS::getDisplayPath(file.getAbstractPath<side>())); //throw X
+                            AFS::removeFolderIfExistsRecursion(ctx.itemPath, onBeforeFileDeletion, onBeforeDirDeletion); //throw FileError, ThreadStopRequest
+                        }
+                    },
 
-                if (useRecycleBin)
-                    AFS::recycleItemIfExists(file.getAbstractPath<side>()); //throw FileError
-                else
-                    AFS::removeFileIfExists(file.getAbstractPath<side>()); //throw FileError
-                statReporter.reportDelta(1, 0);
-            },
+                    [&](const FilePair& file)
+                    {
+                        notifyItemDeletion(txtRemovingFile, AFS::getDisplayPath(ctx.itemPath), ctx.acb); //throw ThreadStopRequest
 
-            [&](const SymlinkPair& symlink)
-            {
-                notifyItemDeletion(txtRemovingSymlink, AFS::getDisplayPath(symlink.getAbstractPath<side>())); //throw X
+                        if (useRecycleBin)
+                            AFS::recycleItemIfExists(ctx.itemPath); //throw FileError
+                        else
+                            AFS::removeFileIfExists(ctx.itemPath); //throw FileError
+                        statReporter.reportDelta(1, 0);
+                    },
 
-                if (useRecycleBin)
-                    AFS::recycleItemIfExists(symlink.getAbstractPath<side>()); //throw FileError
-                else
-                    AFS::removeSymlinkIfExists(symlink.getAbstractPath<side>()); //throw FileError
-                statReporter.reportDelta(1, 0);
-            });
+                    [&](const SymlinkPair& symlink)
+                    {
+                        notifyItemDeletion(txtRemovingSymlink, AFS::getDisplayPath(ctx.itemPath), ctx.acb); //throw ThreadStopRequest
 
-            fsObj->removeObject<side>(); //if directory: removes recursively!
-        }
+                        if (useRecycleBin)
+                            AFS::recycleItemIfExists(ctx.itemPath); //throw FileError
+                        else
+                            AFS::removeSymlinkIfExists(ctx.itemPath); //throw FileError
+                        statReporter.reportDelta(1, 0);
+                    });
 
-        //remain transactional as much as possible => allow for abort only *after* updating file model
-        callback.requestUiUpdate(); //throw X
-    }, callback); //throw X
+                    rowDeleted = true;
+                }
+            }, ctx.acb); //throw ThreadStopRequest
+        });
+
+        massParallelExecute(parallelWorkload, deviceParallelOps,
+                            Zstr("Deletion"), callback /*throw X*/); //throw X
+
+        rowsRemaining = std::move(rowsLater);
+    }
 }
 
 
@@ -1428,6 +1752,7 @@ void fff::deleteFromGridAndHD(const std::vector<FileSystemObject*>& rowsToDelete
                               const std::vector<FileSystemObject*>& rowsToDeleteOnRight, //all pointers need to be bound!
                               const std::vector<std::pair<BaseFolderPair*, SyncDirectionConfig>>& directCfgs, //attention: rows will be physically deleted!
                               bool useRecycleBin,
+                              const std::map<AfsDevice, size_t>& deviceParallelOps,
                               bool& warnRecyclerMissing,
                               ProcessCallback& callback /*throw X*/) //throw X
 {
@@ -1513,11 +1838,11 @@ void fff::deleteFromGridAndHD(const std::vector<FileSystemObject*>& rowsToDelete
         callback.reportWarning(msg, warnRecyclerMissing); //throw?
     }
 
-    deleteFromGridAndHDOneSide<SelectSide::left>(deleteRecylerLeft,   true,  callback);
-    deleteFromGridAndHDOneSide<SelectSide::left>(deletePermanentLeft, false, callback);
+    deleteFromGridAndHDOneSide<SelectSide::left>(deleteRecylerLeft,   true,  deviceParallelOps, callback); //throw X
+    deleteFromGridAndHDOneSide<SelectSide::left>(deletePermanentLeft, false, deviceParallelOps, callback); //
 
-    deleteFromGridAndHDOneSide<SelectSide::right>(deleteRecylerRight,   true,  callback);
-    deleteFromGridAndHDOneSide<SelectSide::right>(deletePermanentRight, false, callback);
+    deleteFromGridAndHDOneSide<SelectSide::right>(deleteRecylerRight,   true,  deviceParallelOps, callback); //
+    deleteFromGridAndHDOneSide<SelectSide::right>(deletePermanentRight, false, deviceParallelOps, callback); //
 }
 
 //############################################################################################################
@@ -1568,7 +1893,7 @@ Zstring TempFileBuffer::getTempPath(const FileDescriptor& descr) const
 }
 
 
-void TempFileBuffer::createTempFiles(const std::set<FileDescriptor>& workLoad, ProcessCallback& callback /*throw X*/) //throw X
+void TempFileBuffer::createTempFiles(const std::set<FileDescriptor>& workLoad, const std::map<AfsDevice, size_t>& deviceParallelOps, ProcessCallback& callback /*throw X*/) //throw X
 {
     const int itemTotal = static_cast<int>(workLoad.size());
     int64_t bytesTotal = 0;
@@ -1585,6 +1910,27 @@ void TempFileBuffer::createTempFiles(const std::set<FileDescriptor>& workLoad, P
     }, callback); //throw X
     if (!errMsg.empty()) return;
 
+    //same file content already buffered under a different path (e.g. renamed on Google Drive)? => copy local temp file instead of downloading again
+    std::map<std::tuple<AfsDevice, AFS::FingerPrint, time_t, uint64_t>, Zstring> tempFilesByPrint;
+    for (const auto& [descr, tempFilePath] : tempFilePaths_)
+        if (descr.attr.filePrint != 0)
+            tempFilesByPrint.emplace(std::tuple(descr.path.afsDevice, descr.attr.filePrint, descr.attr.modTime, descr.attr.fileSize), tempFilePath);
+
+    std::vector<Zstring> tempFilePathsNew(workLoad.size()); //same order as workLoad; each work item writes its own element only
+    ZEN_ON_SCOPE_EXIT //update buffer on main thread, even if cancelled
+    (
+        auto itPath = tempFilePathsNew.begin();
+        for (const FileDescriptor& descr : workLoad)
+            if (const Zstring& tempFilePath = *itPath++;
+                !tempFilePath.empty())
+                tempFilePaths_[descr] = tempFilePath;
+    );
+
+    const std::wstring txtCreatingFile = _("Creating file %x");
+
+    std::vector<std::pair<AbstractPath, ParallelWorkItem>> parallelWorkload;
+    size_t itemIdx = 0;
+
     for (const FileDescriptor& descr : workLoad)
     {
         assert(!tempFilePaths_.contains(descr)); //ensure correct stats, NO overwrite-copy => caller-contract!
@@ -1605,30 +1951,40 @@ void TempFileBuffer::createTempFiles(const std::set<FileDescriptor>& workLoad, P
         const Zstring tempFileName = Zstring(fileName.begin(), it) + Zstr('~') + descrHash + Zstring(it, fileName.end());
 
         const Zstring tempFilePath = appendPath(tempFolderPath_, tempFileName);
-        const AFS::StreamAttributes sourceAttr{descr.attr.modTime, descr.attr.fileSize, descr.attr.filePrint};
 
-        tryReportingError([&]
+        AbstractPath sourcePath = descr.path;
+        if (descr.attr.filePrint != 0)
+            if (auto itCached = tempFilesByPrint.find(std::tuple(descr.path.afsDevice, descr.attr.filePrint, descr.attr.modTime, descr.attr.fileSize));
+                itCached != tempFilesByPrint.end())
+                sourcePath = createItemPathNative(itCached->second);
+
+        parallelWorkload.emplace_back(sourcePath, [&descr, tempFilePath, &tempFilePathOut = tempFilePathsNew[itemIdx], &txtCreatingFile](ParallelContext& ctx) //throw ThreadStopRequest
         {
-            std::wstring statusMsg = replaceCpy(_("Creating file %x"), L"%x", fmtPath(tempFilePath));
-            callback.logInfo(statusMsg); //throw X
-            PercentStatReporter statReporter(std::move(statusMsg), descr.attr.fileSize, callback); //throw X
-
-            //already existing: undefined behavior! (e.g. fail/overwrite/auto-rename)
-            /*const AFS::FileCopyResult result =*/
-            AFS::copyFileTransactional(descr.path, sourceAttr, //throw FileError, ErrorFileLocked, X
-                                       createItemPathNative(tempFilePath),
-                                       false /*copyFilePermissions*/, true /*transactionalCopy*/, nullptr /*onDeleteTargetFile*/,
-                                       [&](int64_t bytesDelta)
+            tryReportingError([&]
             {
-                statReporter.updateStatus(0, bytesDelta); //throw X
-                callback.requestUiUpdate(); //throw X  => not reliably covered by PercentStatReporter::updateStatus()! e.g. during first few seconds: STATUS_PERCENT_DELAY!
-            });
-            //result.errorModTime? => irrelevant for temp files!
-            statReporter.updateStatus(1, 0); //throw X
-
-            tempFilePaths_[descr] = tempFilePath;
-        }, callback); //throw X
-
-        callback.requestUiUpdate(); //throw X
+                std::wstring statusMsg = replaceCpy(txtCreatingFile, L"%x", fmtPath(tempFilePath));
+                ctx.acb.logInfo(statusMsg); //throw ThreadStopRequest
+                AsyncPercentStatReporter statReporter(std::move(statusMsg), descr.attr.fileSize, ctx.acb); //throw ThreadStopRequest
+
+                //already existing: undefined behavior! (e.g. fail/overwrite/auto-rename)
+                /*const AFS::FileCopyResult result =*/
+                AFS::copyFileTransactional(ctx.itemPath, {descr.attr.modTime, descr.attr.fileSize, descr.attr.filePrint}, //throw FileError, ErrorFileLocked, ThreadStopRequest
+                                           createItemPathNative(tempFilePath),
+                                           false /*copyFilePermissions*/, true /*transactionalCopy*/, false /*deltaCopy*/, std::nullopt /*resumableCopy*/, nullptr /*onDeleteTargetFile*/,
+                                           [&](int64_t bytesDelta)
+                {
+                    statReporter.updateStatus(0, bytesDelta); //throw ThreadStopRequest
+                    interruptionPoint(); //throw ThreadStopRequest => not reliably covered by AsyncPercentStatReporter::updateStatus()!
+                }, std::nullopt /*sourceHashAlgo*/);
+                //result.errorModTime? => irrelevant for temp files!
+                statReporter.updateStatus(1, 0); //throw ThreadStopRequest
+
+                tempFilePathOut = tempFilePath;
+            }, ctx.acb); //throw ThreadStopRequest
+        });
+        ++itemIdx;
     }
+
+    massParallelExecute(parallelWorkload, deviceParallelOps,
+                        Zstr("Temp Files"), callback /*throw X*/); //throw X
 }
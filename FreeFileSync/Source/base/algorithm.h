@@ -22,10 +22,34 @@ void swapGrids(const MainConfiguration& mainCfg, FolderComparison& folderCmp,
 
 std::vector<std::pair<BaseFolderPair*, SyncDirectionConfig>> extractDirectionCfg(FolderComparison& folderCmp, const MainConfiguration& mainCfg);
 
+struct InSyncFolder;
+
+/*  GUI: iterating on sync settings should not reload sync.ffs_db and re-evaluate all folder pairs every time
+    - database contents are kept for the lifetime of the comparison => clear() after sync and after swapping sides!
+    - folder pairs with neither a changed SyncDirectionConfig nor a changed ContainerObject::getChangeId() are skipped */
+class SyncDirectionBuffer
+{
+public:
+    void clear() { baseFolders_.clear(); }
+
+private:
+    friend void redetermineSyncDirection(const std::vector<std::pair<BaseFolderPair*, SyncDirectionConfig>>& directCfgs, SyncDirectionBuffer* buf, PhaseCallback& callback);
+
+    struct BaseFolderState
+    {
+        std::shared_ptr<const InSyncFolder> lastSyncState; //nullptr: not (yet) loaded
+        std::optional<SyncDirectionConfig> dirCfg; //config and change id after last evaluation
+        uint64_t changeId = 0;                     //
+    };
+    std::unordered_map<const BaseFolderPair*, BaseFolderState> baseFolders_; //weak pointers: *never dereference*!
+};
+
 void redetermineSyncDirection(const std::vector<std::pair<BaseFolderPair*, SyncDirectionConfig>>& directCfgs,
+                              SyncDirectionBuffer* buf, //optional
                               PhaseCallback& callback /*throw X*/); //throw X
 
 void setSyncDirectionRec(SyncDirection newDirection, FileSystemObject& fsObj); //set new direction (recursively)
+void setSyncDirectionRec(SyncDirection newDirection, const std::vector<FileSystemObject*>& selection); //bulk: GUI selection
 
 bool allElementsEqual(const FolderComparison& folderCmp);
 
@@ -38,6 +62,7 @@ void applyTimeSpanFilter(FolderComparison& folderCmp, time_t timeFrom, time_t ti
 
 void setActiveStatus(bool newStatus, FolderComparison& folderCmp); //activate or deactivate all rows
 void setActiveStatus(bool newStatus, FileSystemObject& fsObj);     //activate or deactivate row: (not recursively anymore)
+void setActiveStatus(bool newStatus, const std::vector<FileSystemObject*>& selection); //bulk: GUI selection
 
 struct PathDependency
 {
@@ -58,6 +83,7 @@ void copyToAlternateFolder(std::span<const FileSystemObject* const> rowsToCopyOn
                            const Zstring& targetFolderPathPhrase,
                            bool keepRelPaths,
                            bool overwriteIfExists,
+                           const std::map<AfsDevice, size_t>& deviceParallelOps,
                            WarningDialogs& warnings,
                            ProcessCallback& callback /*throw X*/); //throw X
 
@@ -66,6 +92,7 @@ void deleteFromGridAndHD(const std::vector<FileSystemObject*>& rowsToDeleteOnLef
                          const std::vector<FileSystemObject*>& rowsToDeleteOnRight, //all pointers need to be bound!
                          const std::vector<std::pair<BaseFolderPair*, SyncDirectionConfig>>& directCfgs, //attention: rows will be physically deleted!
                          bool useRecycleBin,
+                         const std::map<AfsDevice, size_t>& deviceParallelOps,
                          //global warnings:
                          bool& warnRecyclerMissing,
                          ProcessCallback& callback /*throw X*/); //throw X
@@ -90,7 +117,7 @@ public:
     Zstring getTempPath(const FileDescriptor& descr) const; //returns empty if not in buffer (item not existing, error during copy)
 
     //contract: only add files not yet in the buffer!
-    void createTempFiles(const std::set<FileDescriptor>& workLoad, ProcessCallback& callback /*throw X*/); //throw X
+    void createTempFiles(const std::set<FileDescriptor>& workLoad, const std::map<AfsDevice, size_t>& deviceParallelOps, ProcessCallback& callback /*throw X*/); //throw X
 
 private:
     TempFileBuffer           (const TempFileBuffer&) = delete;
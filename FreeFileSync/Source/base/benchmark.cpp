@@ -0,0 +1,799 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#include "benchmark.h"
+#include <random>
+#include <numeric>
+#include <sys/utsname.h>
+#include <zen/file_access.h>
+#include <zen/file_io.h>
+#include <zen/json.h>
+#include <zen/perf.h>
+#include <zen/basic_math.h>
+#include <zen/crc.h>
+#include "binary.h"
+#include "comparison.h"
+#include "db_file.h"
+#include "lock_holder.h"
+#include "parallel_scan.h"
+#include "../afs/concrete.h"
+#include "../afs/native.h"
+#include "../version/version.h"
+
+using namespace zen;
+using namespace fff;
+
+
+namespace
+{
+//benchmark is headless: the first error or fatal error aborts via FileError, warnings are ignored
+class BenchmarkCallback : public ProcessCallback
+{
+public:
+    void initNewPhase(int itemsTotal, int64_t bytesTotal, ProcessPhase phaseId) override {}
+
+    void updateDataProcessed(int itemsDelta, int64_t bytesDelta) override {}
+    void updateDataTotal    (int itemsDelta, int64_t bytesDelta) override {}
+    void requestUiUpdate(bool force) override {}
+    void updateStatus(std::wstring&& msg) override {}
+    void logInfo(const std::wstring& msg) override {}
+
+    void reportWarning(const std::wstring& msg, bool& warningActive) override {}
+
+    Response reportError(const ErrorInfo& errorInfo) override { throw FileError(errorInfo.msg); }
+    void reportFatalError(const std::wstring& msg) override { throw FileError(msg); }
+};
+
+
+struct SyntheticTree
+{
+    std::vector<Zstring> folderRelPaths; //parent folders before children
+    std::vector<std::pair<Zstring /*relPath*/, uint64_t /*fileSize*/>> files;
+    uint64_t bytesTotal = 0;
+};
+
+
+SyntheticTree generateTreeLayout(const BenchmarkConfig& cfg)
+{
+    std::mt19937 rng(cfg.randomSeed);
+
+    auto randomName = [&](size_t suffixNo)
+    {
+        const Zstring suffix = Zstr('_') + numberTo<Zstring>(suffixNo); //ensure uniqueness
+        const int nameLen = std::uniform_int_distribution<int>(cfg.nameLengthMin, cfg.nameLengthMax)(rng);
+
+        Zstring name;
+        for (int i = static_cast<int>(suffix.size()); i < nameLen; ++i)
+            name += static_cast<Zchar>(Zstr('a') + std::uniform_int_distribution<int>(0, 25)(rng));
+        return name + suffix;
+    };
+
+    SyntheticTree tree;
+    tree.folderRelPaths.push_back(Zstring()); //base folder
+    {
+        size_t levelBegin = 0;
+        for (int level = 0; level < cfg.folderDepth; ++level)
+        {
+            const size_t levelEnd = tree.folderRelPaths.size();
+            for (size_t i = levelBegin; i < levelEnd; ++i)
+                for (int j = 0; j < cfg.foldersPerLevel; ++j)
+                    tree.folderRelPaths.push_back(appendPath(tree.folderRelPaths[i], randomName(tree.folderRelPaths.size())));
+            levelBegin = levelEnd;
+        }
+    }
+
+    //log-uniform file size: realistic mix of many small files and few large ones
+    const double logSizeMin = std::log(static_cast<double>(cfg.fileSizeMin) + 1);
+    const double logSizeMax = std::log(static_cast<double>(cfg.fileSizeMax) + 1);
+    std::uniform_real_distribution<double> logSizeDist(logSizeMin, std::max(logSizeMin, logSizeMax));
+    std::uniform_int_distribution<size_t> folderDist(0, tree.folderRelPaths.size() - 1);
+
+    for (int i = 0; i < cfg.fileCount; ++i)
+    {
+        const uint64_t fileSize = std::clamp(static_cast<uint64_t>(std::exp(logSizeDist(rng)) - 1), cfg.fileSizeMin, cfg.fileSizeMax);
+
+        tree.files.emplace_back(appendPath(tree.folderRelPaths[folderDist(rng)], randomName(i)), fileSize);
+        tree.bytesTotal += fileSize;
+    }
+    return tree;
+}
+
+
+//stop watch that also takes the shim's traffic during the measured sections
+class BenchClock
+{
+public:
+    explicit BenchClock(const LatencyShim* shim) : shim_(shim) {}
+
+    void resume()
+    {
+        stopWatch_.resume();
+        if (shim_)
+            trafficStart_ = shim_->getTraffic();
+    }
+
+    void pause()
+    {
+        stopWatch_.pause();
+        if (shim_)
+        {
+            const LatencyShimTraffic trafficEnd = shim_->getTraffic();
+            traffic_.connections   += trafficEnd.connections   - trafficStart_.connections;
+            traffic_.roundTrips    += trafficEnd.roundTrips    - trafficStart_.roundTrips;
+            traffic_.bytesSent     += trafficEnd.bytesSent     - trafficStart_.bytesSent;
+            traffic_.bytesReceived += trafficEnd.bytesReceived - trafficStart_.bytesReceived;
+        }
+    }
+
+    double getSeconds() const { return std::chrono::duration<double>(stopWatch_.elapsed()).count(); }
+    const LatencyShimTraffic& getTraffic() const { return traffic_; }
+
+private:
+    const LatencyShim* const shim_;
+    StopWatch stopWatch_{true /*startPaused*/};
+    LatencyShimTraffic trafficStart_;
+    LatencyShimTraffic traffic_;
+};
+
+
+//run "iterations" times; record wall time (and shim traffic) of each run
+class Measurements
+{
+public:
+    Measurements(int iterations, const LatencyShim* shim) : iterations_(iterations), shim_(shim) {}
+
+    template <class Function>
+    void measure(const std::string& name, int64_t itemCount, int64_t byteCount, Function runOnce /*throw FileError*/)
+    {
+        std::vector<double> seconds;
+        std::vector<LatencyShimTraffic> traffic;
+        for (int i = 0; i < iterations_; ++i)
+        {
+            BenchClock clock(shim_);
+            runOnce(clock); //throw FileError; runOnce() resumes/pauses clock around the measured operation(s)
+            seconds.push_back(clock.getSeconds());
+            traffic.push_back(clock.getTraffic());
+        }
+
+        JsonValue jbench(JsonValue::Type::object);
+        jbench.objectVal["items"] = JsonValue(itemCount);
+        jbench.objectVal["bytes"] = JsonValue(byteCount);
+
+        std::vector<JsonValue> jseconds;
+        for (double sec : seconds)
+            jseconds.emplace_back(sec);
+        jbench.objectVal["seconds"] = JsonValue(std::move(jseconds));
+
+        if (shim_)
+        {
+            auto toJson = [&](int64_t LatencyShimTraffic::* member)
+            {
+                std::vector<JsonValue> jvals;
+                for (const LatencyShimTraffic& t : traffic)
+                    jvals.emplace_back(t.*member);
+                return JsonValue(std::move(jvals));
+            };
+            jbench.objectVal["connections"  ] = toJson(&LatencyShimTraffic::connections);
+            jbench.objectVal["roundTrips"   ] = toJson(&LatencyShimTraffic::roundTrips);
+            jbench.objectVal["bytesSent"    ] = toJson(&LatencyShimTraffic::bytesSent);
+            jbench.objectVal["bytesReceived"] = toJson(&LatencyShimTraffic::bytesReceived);
+
+            if (itemCount > 0) //the number to watch for pipelining improvements
+                jbench.objectVal["roundTripsPerItem"] = JsonValue(static_cast<double>(traffic.back().roundTrips) / itemCount);
+        }
+
+        if (!seconds.empty())
+        {
+            const double secondsMedian = numeric::median(seconds.begin(), seconds.end()); //invalidates input range!
+            jbench.objectVal["secondsMin"   ] = JsonValue(*std::min_element(seconds.begin(), seconds.end()));
+            jbench.objectVal["secondsMedian"] = JsonValue(secondsMedian);
+
+            if (byteCount > 0 && secondsMedian > 0)
+                jbench.objectVal["bytesPerSecond"] = JsonValue(byteCount / secondsMedian);
+        }
+        results_.objectVal[name] = std::move(jbench);
+    }
+
+    JsonValue& getResults() { return results_; }
+
+private:
+    const int iterations_;
+    const LatencyShim* const shim_;
+    JsonValue results_{JsonValue::Type::object};
+};
+
+//performance-relevant machine properties: "fingerprint" changes => results are not comparable
+JsonValue getHardwareInfo()
+{
+    std::string cpuModel = "unknown";
+    try
+    {
+        for (const std::string& line : split(getFileContent(Zstr("/proc/cpuinfo"), nullptr /*notifyUnbufferedIO*/), '\n', SplitOnEmpty::skip)) //throw FileError
+            if (startsWith(line, "model name") || startsWith(line, "Model")) //ARM: no "model name"
+            {
+                cpuModel = trimCpy(afterFirst(line, ':', IfNotFoundReturn::none));
+                break;
+            }
+    }
+    catch (FileError&) {} //not critical: fingerprint still distinguishes cores and memory
+
+    const int64_t cpuCores = std::thread::hardware_concurrency();
+    const int64_t memoryBytes = static_cast<int64_t>(::sysconf(_SC_PHYS_PAGES)) * ::sysconf(_SC_PAGESIZE);
+
+    std::string osName = "unknown";
+    std::string machine = "unknown";
+    if (::utsname uts = {};
+        ::uname(&uts) == 0)
+    {
+        osName  = std::string(uts.sysname) + ' ' + uts.release;
+        machine = uts.machine;
+    }
+
+    const char* simdLevel = getSimdLevelName(getCpuSimdLevel());
+
+    //OS release excluded: kernel updates shouldn't invalidate the baseline, but do show up in the comparison report
+    const uint32_t fingerprint = getCrc32(cpuModel + '|' + numberTo<std::string>(cpuCores) + '|' + numberTo<std::string>(memoryBytes) + '|' + machine + '|' + simdLevel);
+
+    JsonValue jhw(JsonValue::Type::object);
+    jhw.objectVal["cpu"        ] = JsonValue(cpuModel);
+    jhw.objectVal["cpuCores"   ] = JsonValue(cpuCores);
+    jhw.objectVal["memoryBytes"] = JsonValue(memoryBytes);
+    jhw.objectVal["machine"    ] = JsonValue(machine);
+    jhw.objectVal["os"         ] = JsonValue(osName);
+    jhw.objectVal["simd"       ] = JsonValue(simdLevel);
+    jhw.objectVal["fingerprint"] = JsonValue(printNumber<std::string>("%08x", fingerprint));
+    return jhw;
+}
+
+
+//one-sided Mann-Whitney U test: p-value of "current samples are larger than baseline samples"
+//exact distribution for small samples (benchmark iterations!), normal approximation else
+double getMannWhitneyPValue(const std::vector<double>& baseline, const std::vector<double>& current)
+{
+    const size_t n = current.size();
+    const size_t m = baseline.size();
+    assert(n > 0 && m > 0);
+
+    double u = 0; //number of (current, baseline) pairs where current is larger; ties count half
+    for (double c : current)
+        for (double b : baseline)
+            u += c > b ? 1 : c == b ? 0.5 : 0;
+
+    if (n <= 20 && m <= 20)
+    {
+        //counts[i][j][k]: number of orderings of i "current" and j "baseline" samples with U == k
+        std::vector<std::vector<std::vector<double>>> counts(n + 1, std::vector<std::vector<double>>(m + 1));
+        for (size_t i = 0; i <= n; ++i)
+            for (size_t j = 0; j <= m; ++j)
+            {
+                std::vector<double>& c = counts[i][j];
+                c.resize(i * j + 1);
+                if (i == 0 || j == 0)
+                    c[0] = 1;
+                else
+                    for (size_t k = 0; k <= i * j; ++k) //largest sample is either "current" (beats all j baseline samples) or "baseline"
+                        c[k] = (k >= j ? counts[i - 1][j][k - j] : 0) +
+                               (k <= i * (j - 1) ? counts[i][j - 1][k] : 0);
+            }
+
+        const std::vector<double>& dist = counts[n][m];
+        const double total = std::accumulate(dist.begin(), dist.end(), 0.0);
+        //ties: round down => conservative
+        const double tail = std::accumulate(dist.begin() + static_cast<size_t>(u), dist.end(), 0.0);
+        return tail / total;
+    }
+
+    const double mu    = n * m / 2.0;
+    const double sigma = std::sqrt(n * m * (n + m + 1) / 12.0);
+    const double z = (u - mu - 0.5 /*continuity correction*/) / sigma;
+    return 0.5 * std::erfc(z / std::sqrt(2.0));
+}
+
+
+std::vector<double> getJsonNumbers(const JsonValue& jbench, const std::string& name)
+{
+    std::vector<double> numbers;
+    if (const JsonValue* jarray = getChildFromJsonObject(jbench, name))
+        if (jarray->type == JsonValue::Type::array)
+            for (const JsonValue& jval : jarray->arrayVal)
+                if (jval.type == JsonValue::Type::number)
+                    numbers.push_back(stringTo<double>(jval.primVal));
+    return numbers;
+}
+
+
+JsonValue parseBenchmarkResult(const std::string& json, const wchar_t* fileDescr) //throw FileError
+{
+    JsonValue jroot;
+    try
+    {
+        jroot = parseJson(json); //throw JsonParsingError
+    }
+    catch (const JsonParsingError& e)
+    {
+        throw FileError(L"Invalid benchmark result: " + utfTo<std::wstring>(fileDescr), //diagnostics only => untranslated
+                        L"Line " + numberTo<std::wstring>(e.row + 1) + L", column " + numberTo<std::wstring>(e.col + 1));
+    }
+
+    const int schema = stringTo<int>(getPrimitiveFromJsonObject(jroot, "schema").value_or("1"));
+    if (schema != BENCHMARK_SCHEMA_VERSION && schema != 1) //schema 1 has the same "benchmarks" layout
+        throw FileError(L"Unsupported benchmark result schema: " + utfTo<std::wstring>(fileDescr), L"Schema: " + numberTo<std::wstring>(schema));
+
+    if (!getChildFromJsonObject(jroot, "benchmarks"))
+        throw FileError(L"Invalid benchmark result: " + utfTo<std::wstring>(fileDescr), L"Missing \"benchmarks\".");
+    return jroot;
+}
+}
+
+
+BenchmarkConfig fff::parseBenchmarkConfig(const std::vector<Zstring>& args) //throw FileError
+{
+    BenchmarkConfig cfg;
+
+    for (const Zstring& arg : args)
+    {
+        const Zstring name  = trimCpy(beforeFirst(arg, Zstr('='), IfNotFoundReturn::none));
+        const Zstring value = trimCpy(afterFirst (arg, Zstr('='), IfNotFoundReturn::none));
+
+        if (equalAsciiNoCase(name, "remote") && !value.empty()) //path phrase: not a number
+        {
+            cfg.remoteFolderPhrase = value;
+            continue;
+        }
+
+        if (name.empty() || value.empty() || !std::all_of(value.begin(), value.end(), [](Zchar c) { return isDigit(c); }))
+            throw FileError(L"Invalid benchmark parameter: " + utfTo<std::wstring>(arg)); //diagnostics only => untranslated
+
+        auto toPort = [&]
+        {
+            const int port = stringTo<int>(value);
+            if (port <= 0 || port > 65535)
+                throw FileError(L"Invalid benchmark parameter: " + utfTo<std::wstring>(arg));
+            return static_cast<uint16_t>(port);
+        };
+
+        //*INDENT-OFF*
+        if      (equalAsciiNoCase(name, "files"      )) cfg.fileCount       = stringTo<int>(value);
+        else if (equalAsciiNoCase(name, "depth"      )) cfg.folderDepth     = stringTo<int>(value);
+        else if (equalAsciiNoCase(name, "folders"    )) cfg.foldersPerLevel = stringTo<int>(value);
+        else if (equalAsciiNoCase(name, "sizemin"    )) cfg.fileSizeMin     = stringTo<uint64_t>(value);
+        else if (equalAsciiNoCase(name, "sizemax"    )) cfg.fileSizeMax     = stringTo<uint64_t>(value);
+        else if (equalAsciiNoCase(name, "namemin"    )) cfg.nameLengthMin   = stringTo<int>(value);
+        else if (equalAsciiNoCase(name, "namemax"    )) cfg.nameLengthMax   = stringTo<int>(value);
+        else if (equalAsciiNoCase(name, "iterations" )) cfg.iterations      = stringTo<int>(value);
+        else if (equalAsciiNoCase(name, "seed"       )) cfg.randomSeed      = stringTo<unsigned int>(value);
+        else if (equalAsciiNoCase(name, "shimport"   )) cfg.shimPort        = toPort();
+        else if (equalAsciiNoCase(name, "shimtarget" )) cfg.shimTargetPort  = toPort();
+        else if (equalAsciiNoCase(name, "rtt"        )) cfg.shimCfg.roundTripTime = std::chrono::milliseconds(stringTo<int>(value));
+        else if (equalAsciiNoCase(name, "bandwidth"  )) cfg.shimCfg.bytesPerSec   = stringTo<uint64_t>(value);
+        else if (equalAsciiNoCase(name, "loss"       )) cfg.shimCfg.lossPerMille  = std::min(stringTo<int>(value), 1000);
+        else
+            throw FileError(L"Invalid benchmark parameter: " + utfTo<std::wstring>(arg));
+        //*INDENT-ON*
+    }
+
+    cfg.foldersPerLevel = std::max(cfg.foldersPerLevel, 1);
+    cfg.nameLengthMax   = std::max(cfg.nameLengthMax, cfg.nameLengthMin);
+    cfg.fileSizeMax     = std::max(cfg.fileSizeMax,   cfg.fileSizeMin);
+    cfg.iterations      = std::max(cfg.iterations, 1);
+
+    if ((cfg.shimPort != 0) != (cfg.shimTargetPort != 0) ||
+        (cfg.shimPort != 0 && cfg.remoteFolderPhrase.empty()))
+        throw FileError(L"Invalid benchmark parameters: shim requires \"shimport\", \"shimtarget\" and \"remote\".");
+    return cfg;
+}
+
+
+std::string fff::runBenchmark(const Zstring& workFolderPath, const BenchmarkConfig& cfg, const BenchmarkViewOps& measureViewOps) //throw FileError
+{
+    const SyntheticTree tree = generateTreeLayout(cfg);
+
+    const Zstring benchFolderPath = appendPath(workFolderPath, Zstr("FreeFileSync Benchmark"));
+    const Zstring folderPathL = appendPath(benchFolderPath, Zstr("left"));
+    const Zstring folderPathR = appendPath(benchFolderPath, Zstr("right"));
+
+    createDirectoryIfMissingRecursion(workFolderPath); //throw FileError
+    createDirectory(benchFolderPath); //throw FileError, ErrorTargetExisting: don't touch user data!
+    ZEN_ON_SCOPE_EXIT(try { removeDirectoryPlainRecursion(benchFolderPath); /*throw FileError*/ }
+    catch (FileError&) { assert(false); });
+
+    //generate left side: file content is a slice of one shared random buffer
+    {
+        std::mt19937 rng(cfg.randomSeed);
+        std::string randomBytes(static_cast<size_t>(cfg.fileSizeMax), '\0');
+        std::generate(randomBytes.begin(), randomBytes.end(), [&] { return static_cast<char>(rng()); });
+
+        for (const Zstring& relPath : tree.folderRelPaths)
+            createDirectoryIfMissingRecursion(appendPath(folderPathL, relPath)); //throw FileError
+
+        for (const auto& [relPath, fileSize] : tree.files)
+            setFileContent(appendPath(folderPathL, relPath), randomBytes.substr(0, static_cast<size_t>(fileSize)), nullptr /*notifyUnbufferedIO*/); //throw FileError
+    }
+
+    BenchmarkCallback callback;
+    Measurements bench(cfg.iterations, nullptr /*shim*/);
+    const int64_t fileCount = static_cast<int64_t>(tree.files.size());
+    const int64_t bytesTotal = static_cast<int64_t>(tree.bytesTotal);
+
+    //---------------------------------------------------------------------------------------
+    //last iteration leaves the right side as an exact copy => time/size comparison finds no differences
+    bench.measure("copyNewFile", fileCount, bytesTotal, [&](BenchClock& clock)
+    {
+        if (dirAvailable(folderPathR))
+            removeDirectoryPlainRecursion(folderPathR); //throw FileError
+
+        for (const Zstring& relPath : tree.folderRelPaths)
+            createDirectoryIfMissingRecursion(appendPath(folderPathR, relPath)); //throw FileError
+
+        for (const auto& [relPath, fileSize] : tree.files)
+        {
+            const Zstring filePathL = appendPath(folderPathL, relPath);
+            const Zstring filePathR = appendPath(folderPathR, relPath);
+
+            clock.resume();
+            const FileCopyResult result = copyNewFile(filePathL, filePathR, nullptr /*notifyUnbufferedIO*/, nullptr /*onSourceData*/); //throw FileError, ErrorTargetExisting, ErrorFileLocked
+            clock.pause();
+
+            setFileTime(filePathR, nativeFileTimeToTimeT(result.sourceModTime), ProcSymlink::follow); //throw FileError
+        }
+    });
+
+    //---------------------------------------------------------------------------------------
+    const std::set<DirectoryKey> foldersToRead
+    {
+        DirectoryKey{createItemPathNative(folderPathL), makeSharedRef<NullFilter>(), SymLinkHandling::exclude},
+        DirectoryKey{createItemPathNative(folderPathR), makeSharedRef<NullFilter>(), SymLinkHandling::exclude},
+    };
+
+    bench.measure("parallelDeviceTraversal", 2 * fileCount, 0, [&](BenchClock& clock)
+    {
+        clock.resume();
+        std::map<DirectoryKey, DirectoryValue> folderBuffer =
+            parallelDeviceTraversal(foldersToRead, {} /*deviceParallelOps*/, {} /*incrementalScans*/, nullptr /*namePool*/, nullptr /*scanStats*/,
+        [&](const PhaseCallback::ErrorInfo& errorInfo) { return callback.reportError(errorInfo); }, //throw FileError
+        [](const std::wstring& statusLine, int itemsTotal) {},
+        nullptr /*onFolderDone*/,
+        UI_UPDATE_INTERVAL);
+        clock.pause();
+
+        for (const auto& [folderKey, folderVal] : folderBuffer)
+            if (!folderVal.failedFolderReads.empty() || !folderVal.failedItemReads.empty())
+                throw FileError(replaceCpy(_("Cannot read directory %x."), L"%x", fmtPath(AbstractFileSystem::getDisplayPath(folderKey.folderPath)))); //reportError() throws => unexpected
+    });
+
+    //---------------------------------------------------------------------------------------
+    FolderComparison folderCmp;
+
+    bench.measure("compare", 2 * fileCount, 0, [&](BenchClock& clock)
+    {
+        WarningDialogs warnings;
+        std::unique_ptr<LockHolder> dirLocks;
+        folderCmp.clear();
+
+        clock.resume();
+        folderCmp = compare(warnings,
+                            2 /*fileTimeTolerance*/,
+                            false /*contentCmpTrustDatabase*/,
+                            false /*timeSizeVerifyContent*/,
+                            false /*remoteScanTrustDatabase*/,
+                            false /*snapshotChangeDiscovery*/,
+                            false /*outOfCoreComparison*/,
+                            false /*allowUserInteraction*/,
+                            false /*runWithBackgroundPriority*/,
+                            false /*createDirLocks*/,
+                            dirLocks,
+        {
+            FolderPairCfg(folderPathL, folderPathR,
+                          CompareVariant::timeSize, SymLinkHandling::exclude, {} /*ignoreTimeShiftMinutes*/,
+                          normalizeFilters(FilterConfig(), FilterConfig()), SyncDirectionConfig())
+        },
+        {} /*deviceParallelOps*/,
+        {} /*changedItemPaths*/,
+        nullptr /*onPairCompared*/,
+        callback); //throw FileError
+        clock.pause();
+    });
+    assert(folderCmp.size() == 1);
+
+    //---------------------------------------------------------------------------------------
+    bench.measure("filesHaveSameContent", fileCount, 2 * bytesTotal, [&](BenchClock& clock)
+    {
+        for (const auto& [relPath, fileSize] : tree.files)
+        {
+            const AbstractPath filePathL = createItemPathNative(appendPath(folderPathL, relPath));
+            const AbstractPath filePathR = createItemPathNative(appendPath(folderPathR, relPath));
+
+            clock.resume();
+            const bool sameContent = filesHaveSameContent(filePathL, filePathR, nullptr /*notifyUnbufferedIO*/); //throw FileError
+            clock.pause();
+
+            if (!sameContent)
+                throw FileError(L"Unexpected content mismatch: " + fmtPath(relPath)); //copyNewFile() failed silently!?
+        }
+    });
+
+    //---------------------------------------------------------------------------------------
+    const BaseFolderPair& baseFolder = *folderCmp[0];
+
+    bench.measure("saveLastSynchronousState", fileCount, 0, [&](BenchClock& clock)
+    {
+        clock.resume();
+        saveLastSynchronousState(baseFolder, true /*transactionalCopy*/, false /*useJournal*/, callback); //throw FileError
+        clock.pause();
+    });
+
+    bench.measure("loadLastSynchronousState", fileCount, 0, [&](BenchClock& clock)
+    {
+        clock.resume();
+        const auto lastSyncStates = loadLastSynchronousState({&baseFolder}, nullptr /*namePool*/, callback); //throw FileError
+        clock.pause();
+
+        if (lastSyncStates.empty())
+            throw FileError(L"Database file not found after saving."); //unexpected
+    });
+
+    //---------------------------------------------------------------------------------------
+    if (measureViewOps)
+        measureViewOps(folderCmp, [&](const std::string& name, int64_t itemCount, const std::function<void()>& runOnce) //throw FileError
+    {
+        bench.measure(name, itemCount, 0, [&](BenchClock& clock)
+        {
+            clock.resume();
+            runOnce(); //throw FileError
+            clock.pause();
+        });
+    });
+
+    //---------------------------------------------------------------------------------------
+    //SIMD kernels: each variant the CPU can run must reproduce the scalar result, including unaligned start and odd lengths
+    {
+        std::mt19937 rng(cfg.randomSeed);
+        std::string randomBytes(16 * 1024 * 1024, '\0');
+        std::generate(randomBytes.begin(), randomBytes.end(), [&] { return static_cast<char>(rng()); });
+
+        const auto crc32Variants = getSimdVariants(zen::impl::crc32Kernel);
+        auto crc32Scalar = [&](size_t offset, size_t bytes) { return crc32Variants[0].second(0xFFFFFFFF, randomBytes.data() + offset, bytes); };
+
+        for (const auto& [simdLevel, updateCrc32] : crc32Variants)
+        {
+            for (size_t offset = 0; offset < 16; ++offset)
+                for (size_t bytes : {0, 1, 15, 16, 17, 63, 64, 65, 127, 128, 4096 + 15})
+                    if (updateCrc32(0xFFFFFFFF, randomBytes.data() + offset, bytes) != crc32Scalar(offset, bytes))
+                        throw FileError(L"Unexpected CRC32 mismatch: SIMD variant " + utfTo<std::wstring>(getSimdLevelName(simdLevel)) +
+                                        L", offset " + numberTo<std::wstring>(offset) + L", bytes " + numberTo<std::wstring>(bytes));
+
+            bench.measure(std::string("simd.crc32.") + getSimdLevelName(simdLevel), 0, static_cast<int64_t>(randomBytes.size()), [&](BenchClock& clock)
+            {
+                clock.resume();
+                const uint32_t crc = updateCrc32(0xFFFFFFFF, randomBytes.data(), randomBytes.size());
+                clock.pause();
+
+                if (crc != crc32Scalar(0, randomBytes.size()))
+                    throw FileError(L"Unexpected CRC32 mismatch: SIMD variant " + utfTo<std::wstring>(getSimdLevelName(simdLevel)));
+            });
+        }
+    }
+
+    //---------------------------------------------------------------------------------------
+    if (!cfg.remoteFolderPhrase.empty())
+    {
+        std::unique_ptr<LatencyShim> shim;
+        if (cfg.shimPort != 0)
+            try
+            {
+                shim = std::make_unique<LatencyShim>(cfg.shimPort, cfg.shimTargetPort, cfg.shimCfg); //throw SysError
+            }
+            catch (const SysError& e) { throw FileError(L"Cannot start latency shim.", e.toString()); }
+
+        Measurements remoteBench(cfg.iterations, shim.get());
+
+        const AbstractPath remoteBasePath = createAbstractPath(cfg.remoteFolderPhrase);
+        const AbstractPath remoteBenchPath = AbstractFileSystem::appendRelPath(remoteBasePath, Zstr("FreeFileSync Benchmark"));
+        const AbstractPath remoteTreePath  = AbstractFileSystem::appendRelPath(remoteBenchPath, Zstr("tree"));
+
+        AbstractFileSystem::authenticateAccess(remoteBasePath.afsDevice, false /*allowUserInteraction*/); //throw FileError
+        AbstractFileSystem::createFolderIfMissingRecursion(remoteBasePath); //throw FileError
+        AbstractFileSystem::createFolderPlain(remoteBenchPath); //throw FileError, ErrorTargetExisting: don't touch user data!
+        ZEN_ON_SCOPE_EXIT(try { AbstractFileSystem::removeFolderIfExistsRecursion(remoteBenchPath, nullptr, nullptr); /*throw FileError*/ }
+        catch (FileError&) { assert(false); });
+
+        const time_t modTime = std::time(nullptr);
+        bool remoteTreeExists = false;
+
+        auto uploadTree = [&](BenchClock* clock) //throw FileError
+        {
+            if (remoteTreeExists)
+                AbstractFileSystem::removeFolderIfExistsRecursion(remoteTreePath, nullptr, nullptr); //throw FileError
+            remoteTreeExists = true;
+
+            if (clock) clock->resume();
+            for (const Zstring& relPath : tree.folderRelPaths)
+                AbstractFileSystem::createFolderPlain(AbstractFileSystem::appendRelPath(remoteTreePath, relPath)); //throw FileError
+
+            for (const auto& [relPath, fileSize] : tree.files)
+                AbstractFileSystem::copyFileTransactional(createItemPathNative(appendPath(folderPathL, relPath)), {modTime, fileSize, 0 /*filePrint*/}, //throw FileError, ErrorFileLocked
+                                                          AbstractFileSystem::appendRelPath(remoteTreePath, relPath),
+                                                          false /*copyFilePermissions*/,
+                                                          false /*transactionalCopy*/,
+                                                          false /*deltaCopy*/,
+                                                          std::nullopt /*resumableCopy*/,
+                                                          nullptr /*onDeleteTargetFile*/,
+                                                          nullptr /*notifyUnbufferedIO*/,
+                                                          std::nullopt /*sourceHashAlgo*/);
+            if (clock) clock->pause();
+        };
+
+        remoteBench.measure("remote.copyFileTransactional", fileCount, bytesTotal, [&](BenchClock& clock) { uploadTree(&clock); });
+
+        remoteBench.measure("remote.parallelDeviceTraversal", fileCount, 0, [&](BenchClock& clock)
+        {
+            clock.resume();
+            std::map<DirectoryKey, DirectoryValue> folderBuffer =
+                parallelDeviceTraversal({DirectoryKey{remoteTreePath, makeSharedRef<NullFilter>(), SymLinkHandling::exclude}},
+                                        {} /*deviceParallelOps*/, {} /*incrementalScans*/, nullptr /*namePool*/, nullptr /*scanStats*/,
+            [&](const PhaseCallback::ErrorInfo& errorInfo) { return callback.reportError(errorInfo); }, //throw FileError
+            [](const std::wstring& statusLine, int itemsTotal) {},
+            nullptr /*onFolderDone*/,
+            UI_UPDATE_INTERVAL);
+            clock.pause();
+        });
+
+        remoteBench.measure("remote.removeFolderIfExistsRecursion", fileCount, 0, [&](BenchClock& clock)
+        {
+            if (!remoteTreeExists)
+                uploadTree(nullptr); //throw FileError
+
+            clock.resume();
+            AbstractFileSystem::removeFolderIfExistsRecursion(remoteTreePath, nullptr, nullptr); //throw FileError
+            clock.pause();
+            remoteTreeExists = false;
+        });
+
+        for (auto& [name, jbench] : remoteBench.getResults().objectVal)
+            bench.getResults().objectVal[name] = std::move(jbench);
+    }
+
+    //---------------------------------------------------------------------------------------
+    JsonValue jcfg(JsonValue::Type::object);
+    jcfg.objectVal["files"     ] = JsonValue(cfg.fileCount);
+    jcfg.objectVal["folders"   ] = JsonValue(static_cast<int64_t>(tree.folderRelPaths.size()));
+    jcfg.objectVal["depth"     ] = JsonValue(cfg.folderDepth);
+    jcfg.objectVal["bytes"     ] = JsonValue(bytesTotal);
+    jcfg.objectVal["sizeMin"   ] = JsonValue(static_cast<int64_t>(cfg.fileSizeMin));
+    jcfg.objectVal["sizeMax"   ] = JsonValue(static_cast<int64_t>(cfg.fileSizeMax));
+    jcfg.objectVal["nameMin"   ] = JsonValue(cfg.nameLengthMin);
+    jcfg.objectVal["nameMax"   ] = JsonValue(cfg.nameLengthMax);
+    jcfg.objectVal["iterations"] = JsonValue(cfg.iterations);
+    jcfg.objectVal["seed"      ] = JsonValue(static_cast<int64_t>(cfg.randomSeed));
+    if (!cfg.remoteFolderPhrase.empty())
+        jcfg.objectVal["remote"] = JsonValue(utfTo<std::string>(cfg.remoteFolderPhrase));
+    if (cfg.shimPort != 0)
+    {
+        jcfg.objectVal["rtt"      ] = JsonValue(static_cast<int64_t>(cfg.shimCfg.roundTripTime.count()));
+        jcfg.objectVal["bandwidth"] = JsonValue(static_cast<int64_t>(cfg.shimCfg.bytesPerSec));
+        jcfg.objectVal["loss"     ] = JsonValue(cfg.shimCfg.lossPerMille);
+    }
+
+    JsonValue jroot(JsonValue::Type::object);
+    jroot.objectVal["schema"    ] = JsonValue(BENCHMARK_SCHEMA_VERSION);
+    jroot.objectVal["version"   ] = JsonValue(ffsVersion);
+    jroot.objectVal["simd"      ] = JsonValue(getSimdLevelName(getCpuSimdLevel())); //schema 1; see "hardware"
+    jroot.objectVal["hardware"  ] = getHardwareInfo();
+    jroot.objectVal["config"    ] = std::move(jcfg);
+    jroot.objectVal["benchmarks"] = std::move(bench.getResults());
+
+    return serializeJson(jroot) + '\n';
+}
+
+
+BenchmarkComparison fff::compareBenchmarks(const std::string& baselineJson, const std::string& currentJson, double alpha, double minChangePercent) //throw FileError
+{
+    const JsonValue jbaseline = parseBenchmarkResult(baselineJson, L"baseline"); //throw FileError
+    const JsonValue jcurrent  = parseBenchmarkResult(currentJson,  L"current");  //
+
+    auto getHardwareValue = [](const JsonValue& jroot, const std::string& name)
+    {
+        if (const JsonValue* jhw = getChildFromJsonObject(jroot, "hardware"))
+            return getPrimitiveFromJsonObject(*jhw, name).value_or("");
+        return std::string(); //schema 1
+    };
+    auto getRunInfo = [&](const JsonValue& jroot)
+    {
+        JsonValue jrun(JsonValue::Type::object);
+        jrun.objectVal["version"    ] = JsonValue(getPrimitiveFromJsonObject(jroot, "version").value_or(""));
+        jrun.objectVal["os"         ] = JsonValue(getHardwareValue(jroot, "os"));
+        jrun.objectVal["fingerprint"] = JsonValue(getHardwareValue(jroot, "fingerprint"));
+        return jrun;
+    };
+    auto getConfig = [](const JsonValue& jroot)
+    {
+        const JsonValue* jcfg = getChildFromJsonObject(jroot, "config");
+        return jcfg ? serializeJson(*jcfg) : std::string();
+    };
+
+    const std::map<std::string, JsonValue>& benchmarksBase = getChildFromJsonObject(jbaseline, "benchmarks")->objectVal;
+    const std::map<std::string, JsonValue>& benchmarksCur  = getChildFromJsonObject(jcurrent,  "benchmarks")->objectVal;
+
+    std::set<std::string> names;
+    for (const auto& [name, jbench] : benchmarksBase) names.insert(name);
+    for (const auto& [name, jbench] : benchmarksCur ) names.insert(name);
+
+    BenchmarkComparison result;
+    JsonValue jcomparisons(JsonValue::Type::object);
+
+    for (const std::string& name : names)
+    {
+        JsonValue jcmp(JsonValue::Type::object);
+        const char* verdict = "unchanged";
+
+        auto itBase = benchmarksBase.find(name);
+        auto itCur  = benchmarksCur .find(name);
+        const std::vector<double> secondsBase = itBase != benchmarksBase.end() ? getJsonNumbers(itBase->second, "seconds") : std::vector<double>();
+        const std::vector<double> secondsCur  = itCur  != benchmarksCur .end() ? getJsonNumbers(itCur ->second, "seconds") : std::vector<double>();
+
+        if (secondsBase.empty())
+            verdict = "new";
+        else if (secondsCur.empty())
+            verdict = "missing";
+        else
+        {
+            std::vector<double> tmp = secondsBase;
+            const double medianBase = numeric::median(tmp.begin(), tmp.end()); //invalidates input range!
+            tmp = secondsCur;
+            const double medianCur = numeric::median(tmp.begin(), tmp.end());
+
+            const double changePercent = medianBase > 0 ? (medianCur / medianBase - 1) * 100 : 0;
+            const double pSlower = getMannWhitneyPValue(secondsBase, secondsCur);
+            const double pFaster = getMannWhitneyPValue(secondsCur, secondsBase);
+            //smallest p-value possible for these sample sizes: all current samples larger than all baseline samples
+            const double pMin = getMannWhitneyPValue(std::vector<double>(secondsBase.size(), 0), std::vector<double>(secondsCur.size(), 1));
+
+            if (changePercent >= minChangePercent)
+                verdict = pSlower <= alpha ? "regression" : pMin > alpha ? "inconclusive" : "unchanged";
+            else if (-changePercent >= minChangePercent && pFaster <= alpha)
+                verdict = "improvement";
+
+            jcmp.objectVal["secondsMedianBaseline"] = JsonValue(medianBase);
+            jcmp.objectVal["secondsMedianCurrent" ] = JsonValue(medianCur);
+            jcmp.objectVal["changePercent"        ] = JsonValue(changePercent);
+            jcmp.objectVal["pValue"               ] = JsonValue(changePercent >= 0 ? pSlower : pFaster);
+
+            //remote benchmarks with shim: round trips don't depend on timing noise
+            if (std::vector<double> roundTripsBase = getJsonNumbers(itBase->second, "roundTrips"),
+                /**/                roundTripsCur  = getJsonNumbers(itCur ->second, "roundTrips");
+                !roundTripsBase.empty() && !roundTripsCur.empty())
+            {
+                const double medianRtBase = numeric::median(roundTripsBase.begin(), roundTripsBase.end());
+                const double medianRtCur  = numeric::median(roundTripsCur .begin(), roundTripsCur .end());
+                jcmp.objectVal["roundTripsMedianBaseline"] = JsonValue(medianRtBase);
+                jcmp.objectVal["roundTripsMedianCurrent" ] = JsonValue(medianRtCur);
+
+                if (medianRtCur > medianRtBase * (1 + minChangePercent / 100))
+                    verdict = "regression";
+            }
+        }
+
+        if (std::string_view(verdict) == "regression")
+            ++result.regressions;
+
+        jcmp.objectVal["verdict"] = JsonValue(verdict);
+        jcomparisons.objectVal[name] = std::move(jcmp);
+    }
+
+    JsonValue jroot(JsonValue::Type::object);
+    jroot.objectVal["schema"          ] = JsonValue(BENCHMARK_SCHEMA_VERSION);
+    jroot.objectVal["baseline"        ] = getRunInfo(jbaseline);
+    jroot.objectVal["current"         ] = getRunInfo(jcurrent);
+    jroot.objectVal["hardwareMismatch"] = JsonValue(getHardwareValue(jbaseline, "fingerprint") != getHardwareValue(jcurrent, "fingerprint")); //results are not comparable!
+    jroot.objectVal["configMismatch"  ] = JsonValue(getConfig(jbaseline) != getConfig(jcurrent));                                             //
+    jroot.objectVal["alpha"           ] = JsonValue(alpha);
+    jroot.objectVal["minChangePercent"] = JsonValue(minChangePercent);
+    jroot.objectVal["regressions"     ] = JsonValue(result.regressions);
+    jroot.objectVal["benchmarks"      ] = std::move(jcomparisons);
+
+    result.report = serializeJson(jroot) + '\n';
+    return result;
+}
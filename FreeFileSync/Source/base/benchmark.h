@@ -0,0 +1,77 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#ifndef BENCHMARK_H_3847190562384756123
+#define BENCHMARK_H_3847190562384756123
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <zen/zstring.h>
+#include "file_hierarchy.h"
+#include "latency_shim.h"
+
+
+namespace fff
+{
+//synthetic file tree: generated below the work folder, removed again afterwards
+struct BenchmarkConfig
+{
+    int fileCount   = 10'000;
+    int folderDepth = 3;      //0: all files in base folder
+    int foldersPerLevel = 8;
+    uint64_t fileSizeMin = 0;         //log-uniform distribution: many small, few large files
+    uint64_t fileSizeMax = 1024 * 1024; //
+    int nameLengthMin = 8;
+    int nameLengthMax = 32;
+    int iterations = 3;
+    unsigned int randomSeed = 0; //same seed => same tree
+
+    //optional: upload/scan/delete the tree on a network folder, too, e.g. "sftp://user@127.0.0.1:2022/tmp"
+    Zstring remoteFolderPhrase;
+
+    //optional: emulated WAN link in front of a local server => path phrase must use shimPort
+    uint16_t shimPort       = 0; //0: no shim
+    uint16_t shimTargetPort = 0;
+    LatencyShimConfig shimCfg;
+};
+
+//parse "name=value" pairs, e.g. "files=50000" or "remote=sftp://..." "shimport=2222" "shimtarget=22" "rtt=80" "bandwidth=1000000" "loss=5": throw FileError
+BenchmarkConfig parseBenchmarkConfig(const std::vector<Zstring>& args);
+
+//GUI view operations (e.g. FileView::sortView()) are measured by the caller: base/ must not depend on ui/
+using BenchmarkMeasure  = std::function<void(const std::string& name, int64_t itemCount, const std::function<void()>& runOnce /*throw FileError*/)>;
+using BenchmarkViewOps = std::function<void(FolderComparison& folderCmp, const BenchmarkMeasure& measure)>; //throw FileError
+
+/*  result schema: stable for tracking performance over releases
+    - increment BENCHMARK_SCHEMA_VERSION on incompatible changes only: renamed/removed keys, changed units or semantics; new keys and benchmarks are fine
+    - "hardware": CPU, cores, memory, OS + "fingerprint" of the performance-relevant parts => compare results of the same machine (class) only
+    - "benchmarks": per name: "seconds" (one sample per iteration), "secondsMedian", "secondsMin", "items", "bytes", ...  */
+const int BENCHMARK_SCHEMA_VERSION = 2; //1: without "schema" and "hardware"
+
+//measures parallelDeviceTraversal(), compare(), saveLastSynchronousState(), loadLastSynchronousState(), filesHaveSameContent(), copyNewFile()
+//+ remote folder: copyFileTransactional(), parallelDeviceTraversal(), removeFolderIfExistsRecursion() incl. round trips and traffic if shim is used
+//+ measureViewOps (optional) on the compared folder pair
+//returns JSON: stable key order
+std::string runBenchmark(const Zstring& workFolderPath, const BenchmarkConfig& cfg, const BenchmarkViewOps& measureViewOps); //throw FileError
+
+/*  compare two runBenchmark() results: per benchmark "regression" requires
+    1. statistical significance: one-sided Mann-Whitney U test on the "seconds" samples, p <= alpha
+    2. practical significance:  median slowdown >= minChangePercent
+    "inconclusive": change above threshold, but too few iterations to reach alpha (e.g. 3 vs 3 samples: p >= 0.05)
+    + remote benchmarks with shim: more round trips beyond minChangePercent are a regression, too (deterministic => no test needed)  */
+struct BenchmarkComparison
+{
+    std::string report; //JSON
+    int regressions = 0;
+};
+BenchmarkComparison compareBenchmarks(const std::string& baselineJson, const std::string& currentJson, double alpha, double minChangePercent); //throw FileError
+
+const double BENCHMARK_CMP_ALPHA = 0.05;
+const double BENCHMARK_CMP_MIN_CHANGE_PERCENT = 5;
+}
+
+#endif //BENCHMARK_H_3847190562384756123
@@ -7,6 +7,9 @@
 #include "binary.h"
 #include <vector>
 #include <chrono>
+#include <cstring>
+#include <zen/file_access.h>
+#include "../afs/native.h"
 
 using namespace zen;
 using namespace fff;
@@ -37,25 +40,35 @@ Impact of buffer size when files are on same disk:
 const size_t BLOCK_SIZE_MAX =  16 * 1024 * 1024;
 
 
-struct StreamReader
+class StreamReader
 {
+public:
     StreamReader(const AbstractPath& filePath, const IoCallback& notifyUnbufferedIO) : //throw FileError
         stream_(AFS::getInputStream(filePath, notifyUnbufferedIO)), //throw FileError, ErrorFileLocked
         defaultBlockSize_(stream_->getBlockSize()),
         dynamicBlockSize_(defaultBlockSize_) { assert(defaultBlockSize_ > 0); }
 
-    void appendChunk(std::vector<std::byte>& buffer) //throw FileError, X
+    //unconsumed bytes of last chunk read
+    const std::byte* data() const { return &buffer_[0] + bufPos_; }
+    size_t size() const { return bufPosEnd_ - bufPos_; }
+
+    void consume(size_t bytes) { assert(bytes <= size()); bufPos_ += bytes; }
+
+    //CONTRACT: size() == 0 => buffer is reused from the start: no memmove, no reallocation unless block size grows
+    void readChunk() //throw FileError, X
     {
-        assert(!eof_);
+        assert(!eof_ && size() == 0);
         if (eof_) return;
 
-        buffer.resize(buffer.size() + dynamicBlockSize_);
+        if (buffer_.size() < dynamicBlockSize_)
+            buffer_.resize(dynamicBlockSize_);
 
         const auto startTime = std::chrono::steady_clock::now();
-        const size_t bytesRead = stream_->read(&*(buffer.end() - dynamicBlockSize_), dynamicBlockSize_); //throw FileError, ErrorFileLocked, X; return "bytesToRead" bytes unless end of stream!
+        const size_t bytesRead = stream_->read(&buffer_[0], dynamicBlockSize_); //throw FileError, ErrorFileLocked, X; return "bytesToRead" bytes unless end of stream!
         const auto stopTime = std::chrono::steady_clock::now();
 
-        buffer.resize(buffer.size() - dynamicBlockSize_ + bytesRead); //caveat: unsigned arithmetics
+        bufPos_    = 0;
+        bufPosEnd_ = bytesRead;
 
         if (bytesRead < dynamicBlockSize_)
         {
@@ -90,50 +103,113 @@ private:
     size_t dynamicBlockSize_;
     std::chrono::steady_clock::time_point lastDelayViolation_ = std::chrono::steady_clock::now();
     bool eof_ = false;
+
+    std::vector<std::byte> buffer_; //only grows: up to BLOCK_SIZE_MAX
+    size_t bufPos_    = 0;
+    size_t bufPosEnd_ = 0;
 };
 }
 
 
+std::string fff::calcFileHash(const AbstractPath& filePath, HashAlgorithm algo, const IoCallback& notifyUnbufferedIO /*throw X*/) //throw FileError, X
+{
+    try
+    {
+        StreamReader reader(filePath, notifyUnbufferedIO); //throw FileError
+        HashStream hash(algo); //throw SysError
+
+        while (!reader.isEof())
+        {
+            reader.readChunk(); //throw FileError, X
+            hash.update(reader.data(), reader.size()); //throw SysError
+            reader.consume(reader.size());
+        }
+        return formatAsHexString(hash.finalize()); //throw SysError
+    }
+    catch (const SysError& e) { throw FileError(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(AFS::getDisplayPath(filePath))), e.toString()); }
+}
+
+
+namespace
+{
+//let the server(s) hash the file content instead of transferring it:
+//1. both servers support the same algorithm: no file content transfer at all
+//2. one server only: read the other file, e.g. local file vs SFTP backup
+std::optional<bool> compareServerFileHashes(const AbstractPath& filePath1, const AbstractPath& filePath2, const IoCallback& notifyUnbufferedIO /*throw X*/) //throw FileError, X
+{
+    const std::vector<HashAlgorithm> hashAlgos1 = AFS::getServerHashAlgorithms(filePath1);
+    const std::vector<HashAlgorithm> hashAlgos2 = AFS::getServerHashAlgorithms(filePath2);
+
+    for (const HashAlgorithm algo : hashAlgos1)
+        if (std::find(hashAlgos2.begin(), hashAlgos2.end(), algo) != hashAlgos2.end())
+            if (const std::optional<std::string> hash1 = AFS::getServerFileHash(filePath1, algo))
+            {
+                if (const std::optional<std::string> hash2 = AFS::getServerFileHash(filePath2, algo))
+                    return equalAsciiNoCase(*hash1, *hash2);
+                return equalAsciiNoCase(*hash1, calcFileHash(filePath2, algo, notifyUnbufferedIO)); //throw FileError, X
+            }
+
+    auto compareOneSided = [&](const AbstractPath& filePathServer, const std::vector<HashAlgorithm>& hashAlgos, const AbstractPath& filePathRead) -> std::optional<bool>
+    {
+        for (const HashAlgorithm algo : hashAlgos)
+            if (const std::optional<std::string> hash = AFS::getServerFileHash(filePathServer, algo))
+                return equalAsciiNoCase(*hash, calcFileHash(filePathRead, algo, notifyUnbufferedIO)); //throw FileError, X
+        return {};
+    };
+    if (const std::optional<bool> sameContent = compareOneSided(filePath1, hashAlgos1, filePath2)) //throw FileError, X
+        return sameContent;
+    return compareOneSided(filePath2, hashAlgos2, filePath1); //throw FileError, X
+}
+}
+
+
 bool fff::filesHaveSameContent(const AbstractPath& filePath1, const AbstractPath& filePath2, const IoCallback& notifyUnbufferedIO /*throw X*/) //throw FileError, X
 {
+    if (const std::optional<bool> sameContent = compareServerFileHashes(filePath1, filePath2, notifyUnbufferedIO)) //throw FileError, X
+        return *sameContent;
+
+    if (const Zstring& nativePath1 = getNativeItemPath(filePath1); !nativePath1.empty())
+        if (const Zstring& nativePath2 = getNativeItemPath(filePath2); !nativePath2.empty())
+        {
+            //hard links, reflinks, deduplicated backups: don't read what is stored only once
+            if (const std::optional<bool> sameContent = sharedFilesHaveSameContent(nativePath1, nativePath2, notifyUnbufferedIO)) //throw FileError, X
+                return *sameContent;
+
+            //sparse files, e.g. VM images: don't read gigabytes of zeros for holes on both sides
+            if (const std::optional<bool> sameContent = sparseFilesHaveSameContent(nativePath1, nativePath2, notifyUnbufferedIO)) //throw FileError, X
+                return *sameContent;
+
+            //local vs local: compare page cache directly instead of copying twice (kernel -> FileInput buffer -> StreamReader buffer)
+            if (const std::optional<bool> sameContent = mappedFilesHaveSameContent(nativePath1, nativePath2, notifyUnbufferedIO)) //throw FileError, X
+                return *sameContent;
+        }
+
     int64_t totalUnbufferedIO = 0;
 
     StreamReader reader1(filePath1, IOCallbackDivider(notifyUnbufferedIO, totalUnbufferedIO)); //throw FileError
     StreamReader reader2(filePath2, IOCallbackDivider(notifyUnbufferedIO, totalUnbufferedIO)); //
 
-    StreamReader* readerLow  = &reader1;
-    StreamReader* readerHigh = &reader2;
-
-    std::vector<std::byte> bufferLow;
-    std::vector<std::byte> bufferHigh;
-
     for (;;)
     {
-        readerLow->appendChunk(bufferLow); //throw FileError, X
+        //refill only readers that have been consumed completely => block sizes may differ, but no data is ever moved
+        if (reader1.size() == 0 && !reader1.isEof()) reader1.readChunk(); //throw FileError, X
+        if (reader2.size() == 0 && !reader2.isEof()) reader2.readChunk(); //
 
-        if (bufferLow.size() > bufferHigh.size())
+        const size_t bytesCmp = std::min(reader1.size(), reader2.size());
+        if (bytesCmp == 0) //at least one stream is at its end
         {
-            bufferLow.swap(bufferHigh);
-            std::swap(readerLow, readerHigh);
+            if (reader1.size() != 0 || reader2.size() != 0 ||
+                !reader1.isEof() || !reader2.isEof())
+                return false;
+            break;
         }
 
-        if (!std::equal(bufferLow. begin(), bufferLow.end(),
-                        bufferHigh.begin()))
+        //memcmp() is SIMD-optimized by the C runtime (glibc: runtime-dispatched SSE2/AVX2/EVEX) and exits on first mismatch
+        if (std::memcmp(reader1.data(), reader2.data(), bytesCmp) != 0)
             return false;
 
-        if (readerLow->isEof())
-        {
-            if (bufferLow.size() < bufferHigh.size())
-                return false;
-            if (readerHigh->isEof())
-                break;
-            //bufferLow.swap(bufferHigh); not needed
-            std::swap(readerLow, readerHigh);
-        }
-
-        //don't let sliding buffer grow too large
-        bufferHigh.erase(bufferHigh.begin(), bufferHigh.begin() + bufferLow.size());
-        bufferLow.clear();
+        reader1.consume(bytesCmp);
+        reader2.consume(bytesCmp);
     }
 
     if (totalUnbufferedIO % 2 != 0)
@@ -15,6 +15,9 @@ namespace fff
 bool filesHaveSameContent(const AbstractPath& filePath1, //throw FileError, X
                           const AbstractPath& filePath2,
                           const zen::IoCallback& notifyUnbufferedIO  /*throw X*/);
+
+//returns hex string
+std::string calcFileHash(const AbstractPath& filePath, zen::HashAlgorithm algo, const zen::IoCallback& notifyUnbufferedIO /*throw X*/); //throw FileError, X
 }
 
 #endif //BINARY_H_3941281398513241134
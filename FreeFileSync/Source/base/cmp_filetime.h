@@ -8,51 +8,71 @@
 #define CMP_FILETIME_H_032180451675845
 
 #include <ctime>
+#include <vector>
+#include <limits>
+#include <cassert>
 #include <algorithm>
 
 
 namespace fff
 {
-inline
-bool sameFileTime(time_t lhs, time_t rhs, int tolerance, const std::vector<unsigned int>& ignoreTimeShiftMinutes)
+/*  file times are considered equal if they differ by at most "tolerance" seconds, optionally after ignoring a time shift (e.g. DST: 60 minutes)
+    => precompute once per folder pair: accepted time differences as sorted, disjoint ranges
+    => one binary search per comparison instead of a loop over all time shifts   */
+class TimeTolerance
 {
-    if (tolerance < 0) //:= unlimited tolerance by convention!
-        return true;
-
-    if (lhs < rhs)
-        std::swap(lhs, rhs);
-
-    if (rhs > std::numeric_limits<time_t>::max() - tolerance) //protect against overflow!
-        return true;
-
-    if (lhs <= rhs + tolerance)
-        return true;
+public:
+    TimeTolerance(int tolerance, const std::vector<unsigned int>& ignoreTimeShiftMinutes)
+    {
+        if (tolerance < 0) //:= unlimited tolerance by convention!
+        {
+            ranges_.emplace_back(0, std::numeric_limits<uint64_t>::max());
+            return;
+        }
+        const uint64_t tol = tolerance;
+
+        ranges_.emplace_back(0, tol);
+        for (const unsigned int minutes : ignoreTimeShiftMinutes)
+        {
+            assert(minutes > 0);
+            const uint64_t shiftSec = static_cast<uint64_t>(minutes) * 60;
+            ranges_.emplace_back(shiftSec > tol ? shiftSec - tol : 0, shiftSec + tol);
+        }
+
+        //merge overlapping ranges
+        std::sort(ranges_.begin(), ranges_.end());
+        auto itLast = ranges_.begin();
+        for (auto it = ranges_.begin() + 1; it != ranges_.end(); ++it)
+            if (it->first <= itLast->second + 1)
+                itLast->second = std::max(itLast->second, it->second);
+            else
+                *++itLast = *it;
+        ranges_.erase(itLast + 1, ranges_.end());
+    }
 
-    for (const unsigned int minutes : ignoreTimeShiftMinutes)
+    bool sameFileTime(time_t lhs, time_t rhs) const
     {
-        assert(minutes > 0);
-        const int shiftSec = static_cast<int>(minutes) * 60;
+        //no overflow: the absolute difference of two time_t always fits into uint64_t
+        const uint64_t timeDiff = lhs < rhs ?
+                                  static_cast<uint64_t>(rhs) - static_cast<uint64_t>(lhs) :
+                                  static_cast<uint64_t>(lhs) - static_cast<uint64_t>(rhs);
 
-        time_t low  = rhs;
-        time_t high = lhs;
+        if (timeDiff <= ranges_[0].second) //perf: most common case; ranges_[0] always starts at 0
+            return true;
 
-        if (low <= std::numeric_limits<time_t>::max() - shiftSec) //protect against overflow!
-            low += shiftSec;
-        else
-            high -= shiftSec;
+        const auto it = std::lower_bound(ranges_.begin() + 1, ranges_.end(), timeDiff, //first range ending at or after timeDiff
+        [](const std::pair<uint64_t, uint64_t>& range, uint64_t diff) { return range.second < diff; });
 
-        if (high < low)
-            std::swap(high, low);
+        return it != ranges_.end() && it->first <= timeDiff;
+    }
 
-        if (low > std::numeric_limits<time_t>::max() - tolerance) //protect against overflow!
-            return true;
+private:
+    std::vector<std::pair<uint64_t, uint64_t>> ranges_; //[first, second] of accepted absolute time differences
+};
 
-        if (high <= low + tolerance)
-            return true;
-    }
 
-    return false;
-}
+inline
+bool sameFileTime(time_t lhs, time_t rhs, const TimeTolerance& tolerance) { return tolerance.sameFileTime(lhs, rhs); }
 
 //---------------------------------------------------------------------------------------------------------------
 
@@ -67,12 +87,12 @@ enum class TimeResult
 
 
 inline
-TimeResult compareFileTime(time_t lhs, time_t rhs, int tolerance, const std::vector<unsigned int>& ignoreTimeShiftMinutes)
+TimeResult compareFileTime(time_t lhs, time_t rhs, const TimeTolerance& tolerance)
 {
     //number of seconds since Jan 1st 1970 + 1 year (needn't be too precise)
     static const time_t oneYearFromNow = std::time(nullptr) + 365 * 24 * 3600;
 
-    if (sameFileTime(lhs, rhs, tolerance, ignoreTimeShiftMinutes)) //last write time may differ by up to 2 seconds (NTFS vs FAT32)
+    if (sameFileTime(lhs, rhs, tolerance)) //last write time may differ by up to 2 seconds (NTFS vs FAT32)
         return TimeResult::equal;
 
     //check for erroneous dates
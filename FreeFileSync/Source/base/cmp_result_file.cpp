@@ -0,0 +1,341 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#include "cmp_result_file.h"
+#include <zen/crc.h>
+#include <zen/file_io.h>
+#include <zen/zlib_wrap.h>
+#include "../afs/concrete.h"
+
+
+using namespace zen;
+using namespace fff;
+
+
+namespace
+{
+//-------------------------------------------------------------------------------------------------------------------------------
+const char CMP_RESULT_FILE_DESCR[] = "FreeFileSync Comparison";
+const int CMP_RESULT_FILE_VERSION = 1; //2026-10-15
+//-------------------------------------------------------------------------------------------------------------------------------
+
+/*------------------------------------------------------------------------------
+  | ensure 32/64 bit portability: use fixed size data types only e.g. uint32_t |
+  ------------------------------------------------------------------------------*/
+
+class CmpResultWriter
+{
+public:
+    static void writeBaseFolder(const BaseFolderPair& baseFolder, MemoryStreamOut<std::string>& stream)
+    {
+        writeContainer(stream, AFS::getInitPathPhrase(baseFolder.getAbstractPath<SelectSide::left >()));
+        writeContainer(stream, AFS::getInitPathPhrase(baseFolder.getAbstractPath<SelectSide::right>()));
+        writeNumber<int8_t>(stream, static_cast<int8_t>(baseFolder.getFolderStatus<SelectSide::left >()));
+        writeNumber<int8_t>(stream, static_cast<int8_t>(baseFolder.getFolderStatus<SelectSide::right>()));
+        writeNumber<int8_t>(stream, static_cast<int8_t>(baseFolder.getCompVariant()));
+        writeNumber<int32_t>(stream, baseFolder.getFileTimeTolerance());
+
+        writeNumber<uint32_t>(stream, static_cast<uint32_t>(baseFolder.getIgnoredTimeShift().size()));
+        for (unsigned int shiftMinutes : baseFolder.getIgnoredTimeShift())
+            writeNumber<uint32_t>(stream, shiftMinutes);
+
+        CmpResultWriter writer(stream);
+        writer.recurse(baseFolder);
+
+        //moved files: pairs of file indexes in traversal order => written after the hierarchy
+        writeNumber<uint32_t>(stream, static_cast<uint32_t>(writer.movePairs_.size()));
+        for (const auto& [fileIdxFrom, fileIdxTo] : writer.movePairs_)
+        {
+            writeNumber<uint32_t>(stream, fileIdxFrom);
+            writeNumber<uint32_t>(stream, fileIdxTo);
+        }
+    }
+
+private:
+    explicit CmpResultWriter(MemoryStreamOut<std::string>& stream) : stream_(stream) {}
+
+    void recurse(const ContainerObject& hierObj)
+    {
+        //out-of-core comparison: spilled sub trees are reloaded temporarily => keep peak memory low
+        const bool wasSpilled = hierObj.isSpilled();
+
+        writeNumber<uint32_t>(stream_, static_cast<uint32_t>(hierObj.refSubFiles().size()));
+        for (const FilePair& file : hierObj.refSubFiles())
+        {
+            writeItem(file);
+            writeNumber<int64_t >(stream_, file.getLastWriteTime<SelectSide::left >());
+            writeNumber<int64_t >(stream_, file.getLastWriteTime<SelectSide::right>());
+            writeNumber<uint64_t>(stream_, file.getFileSize<SelectSide::left >());
+            writeNumber<uint64_t>(stream_, file.getFileSize<SelectSide::right>());
+            writeNumber<AFS::FingerPrint>(stream_, file.getFilePrint<SelectSide::left >());
+            writeNumber<AFS::FingerPrint>(stream_, file.getFilePrint<SelectSide::right>());
+            writeNumber<int8_t>(stream_, file.isFollowedSymlink<SelectSide::left >());
+            writeNumber<int8_t>(stream_, file.isFollowedSymlink<SelectSide::right>());
+
+            const uint32_t fileIdx = fileCount_++;
+            if (file.getMoveRef()) //move references are mutual: record pair when seeing the second file
+            {
+                if (auto it = moveRefIdxs_.find(file.getMoveRef()); it != moveRefIdxs_.end())
+                    movePairs_.emplace_back(it->second, fileIdx);
+                else
+                    moveRefIdxs_.emplace(file.getId(), fileIdx);
+            }
+        }
+
+        writeNumber<uint32_t>(stream_, static_cast<uint32_t>(hierObj.refSubLinks().size()));
+        for (const SymlinkPair& symlink : hierObj.refSubLinks())
+        {
+            writeItem(symlink);
+            writeNumber<int64_t>(stream_, symlink.getLastWriteTime<SelectSide::left >());
+            writeNumber<int64_t>(stream_, symlink.getLastWriteTime<SelectSide::right>());
+        }
+
+        writeNumber<uint32_t>(stream_, static_cast<uint32_t>(hierObj.refSubFolders().size()));
+        for (const FolderPair& folder : hierObj.refSubFolders())
+        {
+            writeItem(folder);
+            writeNumber<int8_t>(stream_, folder.isFollowedSymlink<SelectSide::left >());
+            writeNumber<int8_t>(stream_, folder.isFollowedSymlink<SelectSide::right>());
+            recurse(folder);
+        }
+
+        if (wasSpilled)
+            hierObj.unloadSpilled();
+    }
+
+    void writeItem(const FileSystemObject& fsObj)
+    {
+        writeContainer(stream_, fsObj.isEmpty<SelectSide::left >() ? Zstring() : fsObj.getItemName<SelectSide::left >());
+        writeContainer(stream_, fsObj.isEmpty<SelectSide::right>() ? Zstring() : fsObj.getItemName<SelectSide::right>());
+        writeNumber<int8_t>(stream_, static_cast<int8_t>(fsObj.getCategory()));
+        writeContainer(stream_, fsObj.getCatExtraDescription());
+        writeNumber<int8_t>(stream_, static_cast<int8_t>(fsObj.getSyncDir()));
+        writeContainer(stream_, fsObj.getSyncDirConflict());
+        writeNumber<int8_t>(stream_, fsObj.isActive());
+    }
+
+    MemoryStreamOut<std::string>& stream_;
+    uint32_t fileCount_ = 0;
+    std::unordered_map<FileSystemObject::ObjectIdConst, uint32_t, FileSystemObject::ObjectIdConst::Hash> moveRefIdxs_; //files waiting for their move partner
+    std::vector<std::pair<uint32_t, uint32_t>> movePairs_;
+};
+
+
+class CmpResultReader
+{
+public:
+    static std::shared_ptr<BaseFolderPair> readBaseFolder(MemoryStreamIn<std::string>& stream) //throw SysError, SysErrorUnexpectedEos
+    {
+        const Zstring folderPathPhraseL = readContainer<Zstring>(stream); //throw SysErrorUnexpectedEos
+        const Zstring folderPathPhraseR = readContainer<Zstring>(stream); //
+        const auto folderStatusL = static_cast<BaseFolderStatus>(readNumber<int8_t>(stream));
+        const auto folderStatusR = static_cast<BaseFolderStatus>(readNumber<int8_t>(stream));
+        const auto cmpVar        = static_cast<CompareVariant>  (readNumber<int8_t>(stream));
+        const int fileTimeTolerance = readNumber<int32_t>(stream);
+
+        std::vector<unsigned int> ignoreTimeShiftMinutes;
+        for (auto shiftCount = readNumber<uint32_t>(stream); shiftCount-- > 0;)
+            ignoreTimeShiftMinutes.push_back(readNumber<uint32_t>(stream));
+
+        //view only: items were filtered during comparison already
+        auto baseFolder = std::make_shared<BaseFolderPair>(createAbstractPath(folderPathPhraseL), folderStatusL,
+                                                           createAbstractPath(folderPathPhraseR), folderStatusR,
+                                                           makeSharedRef<NullFilter>(), cmpVar, fileTimeTolerance, ignoreTimeShiftMinutes);
+        CmpResultReader reader(stream);
+        reader.recurse(*baseFolder); //throw SysError, SysErrorUnexpectedEos
+
+        for (auto moveCount = readNumber<uint32_t>(stream); moveCount-- > 0;)
+        {
+            const uint32_t fileIdxFrom = readNumber<uint32_t>(stream);
+            const uint32_t fileIdxTo   = readNumber<uint32_t>(stream);
+            if (fileIdxFrom >= reader.files_.size() ||
+                fileIdxTo   >= reader.files_.size())
+                throw SysError(_("File content is corrupted.") + L" (invalid move reference)");
+
+            reader.files_[fileIdxFrom]->setMoveRef(reader.files_[fileIdxTo  ]->getId());
+            reader.files_[fileIdxTo  ]->setMoveRef(reader.files_[fileIdxFrom]->getId());
+        }
+        return baseFolder;
+    }
+
+private:
+    explicit CmpResultReader(MemoryStreamIn<std::string>& stream) : stream_(stream) {}
+
+    struct ItemState
+    {
+        Zstring itemNameL;
+        Zstring itemNameR;
+        CompareFileResult cmpResult = FILE_EQUAL;
+        Zstringc cmpResultDescr;
+        SyncDirection syncDir = SyncDirection::none;
+        Zstringc syncDirConflict;
+        bool active = true;
+    };
+
+    void recurse(ContainerObject& hierObj) //throw SysError, SysErrorUnexpectedEos
+    {
+        for (auto fileCount = readNumber<uint32_t>(stream_); fileCount-- > 0;)
+        {
+            const ItemState item = readItem(); //throw SysError, SysErrorUnexpectedEos
+            const auto modTimeL   = readNumber<int64_t >(stream_);
+            const auto modTimeR   = readNumber<int64_t >(stream_);
+            const auto fileSizeL  = readNumber<uint64_t>(stream_);
+            const auto fileSizeR  = readNumber<uint64_t>(stream_);
+            const auto filePrintL = readNumber<AFS::FingerPrint>(stream_);
+            const auto filePrintR = readNumber<AFS::FingerPrint>(stream_);
+            const bool isSymlinkL = readNumber<int8_t>(stream_) != 0;
+            const bool isSymlinkR = readNumber<int8_t>(stream_) != 0;
+
+            FilePair& file = hierObj.addSubFile(item.itemNameL, FileAttributes(modTimeL, fileSizeL, filePrintL, isSymlinkL), item.cmpResult,
+                                                item.itemNameR, FileAttributes(modTimeR, fileSizeR, filePrintR, isSymlinkR));
+            applyItemState(file, item);
+            files_.push_back(&file);
+        }
+
+        for (auto linkCount = readNumber<uint32_t>(stream_); linkCount-- > 0;)
+        {
+            const ItemState item = readItem(); //throw SysError, SysErrorUnexpectedEos
+            const auto modTimeL = readNumber<int64_t>(stream_);
+            const auto modTimeR = readNumber<int64_t>(stream_);
+
+            SymlinkPair& symlink = hierObj.addSubLink(item.itemNameL, LinkAttributes(modTimeL), static_cast<CompareSymlinkResult>(item.cmpResult),
+                                                      item.itemNameR, LinkAttributes(modTimeR));
+            applyItemState(symlink, item);
+        }
+
+        for (auto folderCount = readNumber<uint32_t>(stream_); folderCount-- > 0;)
+        {
+            const ItemState item = readItem(); //throw SysError, SysErrorUnexpectedEos
+            const bool isSymlinkL = readNumber<int8_t>(stream_) != 0;
+            const bool isSymlinkR = readNumber<int8_t>(stream_) != 0;
+
+            FolderPair& folder = hierObj.addSubFolder(item.itemNameL, FolderAttributes(isSymlinkL), static_cast<CompareDirResult>(item.cmpResult),
+                                                      item.itemNameR, FolderAttributes(isSymlinkR));
+            applyItemState(folder, item);
+            recurse(folder); //throw SysError, SysErrorUnexpectedEos
+        }
+    }
+
+    ItemState readItem() //throw SysError, SysErrorUnexpectedEos
+    {
+        ItemState item;
+        item.itemNameL       = readContainer<Zstring>(stream_);
+        item.itemNameR       = readContainer<Zstring>(stream_);
+        const int cmpResult  = readNumber<int8_t>(stream_);
+        item.cmpResultDescr  = readContainer<Zstringc>(stream_);
+        const int syncDir    = readNumber<int8_t>(stream_);
+        item.syncDirConflict = readContainer<Zstringc>(stream_);
+        item.active          = readNumber<int8_t>(stream_) != 0;
+
+        //don't trust the file content: FileSystemObject class invariants
+        if (cmpResult < FILE_EQUAL || cmpResult > FILE_CONFLICT ||
+            syncDir < static_cast<int>(SyncDirection::none) || syncDir > static_cast<int>(SyncDirection::right) ||
+            (item.itemNameL.empty() && item.itemNameR.empty()) ||
+            ((cmpResult == FILE_CONFLICT || cmpResult == FILE_DIFFERENT_METADATA) && item.cmpResultDescr.empty()))
+            throw SysError(_("File content is corrupted.") + L" (invalid item)");
+
+        item.cmpResult = static_cast<CompareFileResult>(cmpResult);
+        item.syncDir   = static_cast<SyncDirection>(syncDir);
+        return item;
+    }
+
+    static void applyItemState(FileSystemObject& fsObj, const ItemState& item)
+    {
+        if (item.cmpResult == FILE_CONFLICT)
+            fsObj.setCategoryConflict(item.cmpResultDescr);
+        else if (item.cmpResult == FILE_DIFFERENT_METADATA)
+            fsObj.setCategoryDiffMetadata(item.cmpResultDescr);
+
+        if (!item.syncDirConflict.empty())
+            fsObj.setSyncDirConflict(item.syncDirConflict);
+        else
+            fsObj.setSyncDir(item.syncDir);
+
+        fsObj.setActive(item.active);
+    }
+
+    MemoryStreamIn<std::string>& stream_;
+    std::vector<FilePair*> files_; //traversal order: resolve move references
+};
+}
+
+
+Zstring fff::getCmpResultFilePath(const Zstring& cfgFilePath)
+{
+    return beforeLast(cfgFilePath, Zstr('.'), IfNotFoundReturn::all) + CMP_RESULT_FILE_ENDING;
+}
+
+
+void fff::saveComparisonResult(const FolderComparison& folderCmp, const Zstring& cfgFilePath, time_t cmpTime, const Zstring& filePath) //throw FileError
+{
+    try
+    {
+        MemoryStreamOut<std::string> streamOut;
+        writeContainer(streamOut, cfgFilePath);
+        writeNumber<int64_t>(streamOut, cmpTime);
+
+        writeNumber<uint32_t>(streamOut, static_cast<uint32_t>(folderCmp.size()));
+        for (const std::shared_ptr<BaseFolderPair>& baseFolder : folderCmp)
+            CmpResultWriter::writeBaseFolder(*baseFolder, streamOut);
+        //------------------------------------------------------------------------------------------------------------------------
+
+        MemoryStreamOut<std::string> memStreamOut;
+        writeArray(memStreamOut, CMP_RESULT_FILE_DESCR, sizeof(CMP_RESULT_FILE_DESCR));
+        writeNumber<int32_t>(memStreamOut, CMP_RESULT_FILE_VERSION);
+        writeContainer(memStreamOut, compress(streamOut.ref(), 3 /*level*/)); //throw SysError
+        //item names and paths: similar to sync.ffs_db => same compression level
+
+        writeNumber<uint32_t>(memStreamOut, getCrc32(memStreamOut.ref()));
+
+        setFileContent(filePath, memStreamOut.ref(), nullptr /*notifyUnbufferedIO*/); //throw FileError
+    }
+    catch (const SysError& e)
+    {
+        throw FileError(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(filePath)), e.toString());
+    }
+}
+
+
+ComparisonResultFile fff::loadComparisonResult(const Zstring& filePath) //throw FileError
+{
+    const std::string byteStream = getFileContent(filePath, nullptr /*notifyUnbufferedIO*/); //throw FileError
+    try
+    {
+        MemoryStreamIn<std::string_view> memStreamIn(byteStream); //perf: don't copy complete file
+
+        char formatDescr[sizeof(CMP_RESULT_FILE_DESCR)] = {};
+        readArray(memStreamIn, formatDescr, sizeof(formatDescr)); //throw SysErrorUnexpectedEos
+
+        if (!std::equal(CMP_RESULT_FILE_DESCR, CMP_RESULT_FILE_DESCR + sizeof(CMP_RESULT_FILE_DESCR), formatDescr))
+            throw SysError(_("File content is corrupted.") + L" (invalid header)");
+
+        const int version = readNumber<int32_t>(memStreamIn); //throw SysErrorUnexpectedEos
+        if (version != CMP_RESULT_FILE_VERSION)
+            throw SysError(_("Unsupported data format.") + L' ' + replaceCpy(_("Version: %x"), L"%x", numberTo<std::wstring>(version)));
+
+        assert(byteStream.size() >= sizeof(uint32_t)); //obviously in this context!
+        MemoryStreamOut<std::string> crcStreamOut;
+        writeNumber<uint32_t>(crcStreamOut, getCrc32(byteStream.begin(), byteStream.end() - sizeof(uint32_t)));
+
+        if (!endsWith(byteStream, crcStreamOut.ref()))
+            throw SysError(_("File content is corrupted.") + L" (invalid checksum)");
+
+        MemoryStreamIn<std::string> streamIn(decompress(readContainer<std::string>(memStreamIn))); //throw SysErrorUnexpectedEos, SysError
+
+        ComparisonResultFile output;
+        output.cfgFilePath = readContainer<Zstring>(streamIn); //throw SysErrorUnexpectedEos
+        output.cmpTime = readNumber<int64_t>(streamIn);        //
+
+        for (auto baseFolderCount = readNumber<uint32_t>(streamIn); baseFolderCount-- > 0;)
+            output.folderCmp.push_back(CmpResultReader::readBaseFolder(streamIn)); //throw SysError, SysErrorUnexpectedEos
+
+        return output;
+    }
+    catch (const SysError& e)
+    {
+        throw FileError(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(filePath)), e.toString());
+    }
+}
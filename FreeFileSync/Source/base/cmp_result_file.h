@@ -0,0 +1,35 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#ifndef CMP_RESULT_FILE_H_3820571946205837461
+#define CMP_RESULT_FILE_H_3820571946205837461
+
+#include <zen/file_error.h>
+#include "file_hierarchy.h"
+
+
+namespace fff
+{
+/*  comparison result file: snapshot of a FolderComparison (hierarchy, categories, sync directions, conflicts)
+    - batch mode saves it next to the *.ffs_batch file => GUI displays it without rescanning the folders
+    - view only: filter settings are not recorded, file system may have changed since => compare again before synchronization */
+inline const Zchar* const CMP_RESULT_FILE_ENDING = Zstr(".ffs_cmp"); //don't use Zstring as global constant: avoid static initialization order problem
+
+Zstring getCmpResultFilePath(const Zstring& cfgFilePath); //<config name>.ffs_cmp next to the config file
+
+void saveComparisonResult(const FolderComparison& folderCmp, const Zstring& cfgFilePath, time_t cmpTime, const Zstring& filePath); //throw FileError
+
+
+struct ComparisonResultFile
+{
+    Zstring cfgFilePath; //configuration used for comparison
+    time_t cmpTime = 0;
+    FolderComparison folderCmp;
+};
+ComparisonResultFile loadComparisonResult(const Zstring& filePath); //throw FileError
+}
+
+#endif //CMP_RESULT_FILE_H_3820571946205837461
@@ -13,11 +13,14 @@
 #include "parallel_scan.h"
 #include "dir_exist_async.h"
 #include "db_file.h"
+#include "fs_snapshot.h"
 #include "binary.h"
 #include "cmp_filetime.h"
 #include "status_handler_impl.h"
 #include "../afs/concrete.h"
 #include "../afs/native.h"
+#include "../afs/ftp.h"
+#include "../afs/sftp.h"
 
 using namespace zen;
 using namespace fff;
@@ -57,6 +60,10 @@ std::vector<FolderPairCfg> fff::extractCompareCfg(const MainConfiguration& mainC
 //------------------------------------------------------------------------------------------
 namespace
 {
+const size_t SCAN_STATS_LOG_COUNT = 3;
+const std::chrono::milliseconds SCAN_STATS_LOG_THRESHOLD(1000); //fast scan => no need for a hot-folder report
+
+
 struct ResolvedFolderPair
 {
     AbstractPath folderPathLeft;
@@ -72,6 +79,7 @@ struct ResolvedBaseFolders
 
 
 ResolvedBaseFolders initializeBaseFolders(const std::vector<FolderPairCfg>& fpCfgList,
+                                          const std::map<AfsDevice, size_t>& deviceParallelOps,
                                           bool allowUserInteraction,
                                           WarningDialogs& warnings,
                                           PhaseCallback& callback /*throw X*/) //throw X
@@ -95,7 +103,7 @@ ResolvedBaseFolders initializeBaseFolders(const std::vector<FolderPairCfg>& fpCf
             allFolders.insert(output.resolvedPairs.back().folderPathRight);
         }
         //---------------------------------------------------------------------------
-        output.baseFolderStatus = getFolderStatusNonBlocking(allFolders,
+        output.baseFolderStatus = getFolderStatusNonBlocking(allFolders, deviceParallelOps,
                                                              allowUserInteraction, callback); //throw X
         if (!output.baseFolderStatus.failedChecks.empty())
         {
@@ -155,44 +163,166 @@ ResolvedBaseFolders initializeBaseFolders(const std::vector<FolderPairCfg>& fpCf
 class ComparisonBuffer
 {
 public:
-    ComparisonBuffer(const std::set<DirectoryKey>& folderKeys,
+    ComparisonBuffer(const std::vector<std::pair<ResolvedFolderPair, FolderPairCfg>>& workLoad,
                      const FolderStatus& baseFolderStatus,
                      int fileTimeTolerance,
+                     bool contentCmpTrustDatabase,
+                     bool timeSizeVerifyContent,
+                     const std::map<AfsDevice, size_t>& deviceParallelOps,
+                     const std::map<DirectoryKey, IncrementalScan>& incrementalScans,
+                     ItemNamePool& namePool,
+                     const OnPairCompared& onTimeSizePairCategorized, //optional: categorize CompareVariant::timeSize right after merging
                      ProcessCallback& callback);
 
-    //create comparison result table and fill category except for files existing on both sides: undefinedFiles and undefinedSymlinks are appended!
-    std::shared_ptr<BaseFolderPair> compareByTimeSize(const ResolvedFolderPair& fp, const FolderPairCfg& fpConfig) const;
-    std::shared_ptr<BaseFolderPair> compareBySize    (const ResolvedFolderPair& fp, const FolderPairCfg& fpConfig) const;
-    std::vector<std::shared_ptr<BaseFolderPair>> compareByContent(const std::vector<std::pair<ResolvedFolderPair, FolderPairCfg>>& workLoad) const;
+    //finish categorization of folder pair (index into workLoad): call once per pair
+    std::vector<std::shared_ptr<BaseFolderPair>> compareByTimeSize(const std::vector<size_t>& pairIdxs);
+    std::vector<std::shared_ptr<BaseFolderPair>> compareBySize(const std::vector<size_t>& pairIdxs);
+    std::vector<std::shared_ptr<BaseFolderPair>> compareByContent(const std::vector<size_t>& pairIdxs);
 
 private:
     ComparisonBuffer           (const ComparisonBuffer&) = delete;
     ComparisonBuffer& operator=(const ComparisonBuffer&) = delete;
 
+    struct MergedPair
+    {
+        std::shared_ptr<BaseFolderPair> baseFolder;
+        std::vector<FilePair*> undefinedFiles;
+        std::vector<SymlinkPair*> undefinedSymlinks;
+        bool categorized = false; //CompareVariant::timeSize: progressive display
+    };
+    MergedPair takeMergedPair(size_t pairIdx);
+
+    static void categorizeByTimeSize(MergedPair& mp); //context of worker thread
+    void verifyTimeDiffByContent(const std::vector<MergedPair>& mergedPairs); //throw X
+
+    struct BytewiseWorkload
+    {
+        const BaseFolderPair* baseFolder;
+        RingBuffer<FilePair*> files; //same size on both sides
+        RingBuffer<SymlinkPair*> symlinks; //one readlink per side => latency-bound (SFTP): resolve in parallel, too
+    };
+    template <class Function>
+    void compareBytewise(std::vector<BytewiseWorkload>&& workload, Function categorizeFile /*throw ThreadStopRequest*/); //throw X
+
+    //create comparison result table and fill category except for files existing on both sides: undefinedFiles and undefinedSymlinks are appended!
     std::shared_ptr<BaseFolderPair> performComparison(const ResolvedFolderPair& fp,
                                                       const FolderPairCfg& fpCfg,
+                                                      const DirectoryValue& dirValL,
+                                                      const DirectoryValue& dirValR,
+                                                      size_t mergeThreadCount,
                                                       std::vector<FilePair*>& undefinedFiles,
-                                                      std::vector<SymlinkPair*>& undefinedSymlinks) const;
+                                                      std::vector<SymlinkPair*>& undefinedSymlinks) const; //context of worker thread: no callbacks!
 
+    const std::vector<std::pair<ResolvedFolderPair, FolderPairCfg>>& workLoad_;
     std::map<DirectoryKey, DirectoryValue> folderBuffer_; //contains entries for *all* scanned folders!
+    std::vector<std::optional<MergedPair>> mergedPairs_; //same order as workLoad_
     const int fileTimeTolerance_;
+    const bool contentCmpTrustDatabase_;
+    const bool timeSizeVerifyContent_;
     const FolderStatus& folderStatus_;
+    const std::map<AfsDevice, size_t>& deviceParallelOps_;
+    ItemNamePool& namePool_;
     ProcessCallback& cb_;
 };
 
 
-ComparisonBuffer::ComparisonBuffer(const std::set<DirectoryKey>& folderKeys,
+ComparisonBuffer::ComparisonBuffer(const std::vector<std::pair<ResolvedFolderPair, FolderPairCfg>>& workLoad,
                                    const FolderStatus& folderStatus,
                                    int fileTimeTolerance,
+                                   bool contentCmpTrustDatabase,
+                                   bool timeSizeVerifyContent,
+                                   const std::map<AfsDevice, size_t>& deviceParallelOps,
+                                   const std::map<DirectoryKey, IncrementalScan>& incrementalScans,
+                                   ItemNamePool& namePool,
+                                   const OnPairCompared& onTimeSizePairCategorized,
                                    ProcessCallback& callback) :
+    workLoad_(workLoad),
+    mergedPairs_(workLoad.size()),
     fileTimeTolerance_(fileTimeTolerance),
+    contentCmpTrustDatabase_(contentCmpTrustDatabase),
+    timeSizeVerifyContent_(timeSizeVerifyContent),
     folderStatus_(folderStatus),
+    deviceParallelOps_(deviceParallelOps),
+    namePool_(namePool),
     cb_(callback)
 {
+    auto getFolderKeyL = [](const ResolvedFolderPair& fp, const FolderPairCfg& fpCfg) { return DirectoryKey{fp.folderPathLeft,  fpCfg.filter.nameFilter, fpCfg.handleSymlinks}; };
+    auto getFolderKeyR = [](const ResolvedFolderPair& fp, const FolderPairCfg& fpCfg) { return DirectoryKey{fp.folderPathRight, fpCfg.filter.nameFilter, fpCfg.handleSymlinks}; };
+
     std::set<DirectoryKey> foldersToRead;
-    for (const DirectoryKey& folderKey : folderKeys)
-        if (folderStatus.existing.contains(folderKey.folderPath))
-            foldersToRead.insert(folderKey); //only traverse *existing* folders
+    for (const auto& [folderPair, fpCfg] : workLoad)
+        for (const DirectoryKey& folderKey : {getFolderKeyL(folderPair, fpCfg), getFolderKeyR(folderPair, fpCfg)})
+            if (folderStatus_.existing.contains(folderKey.folderPath))
+                foldersToRead.insert(folderKey); //only traverse *existing* folders
+            //create entries for the rest:
+            else if (auto it = folderStatus_.failedChecks.find(folderKey.folderPath);
+                     it != folderStatus_.failedChecks.end())
+                //make sure all items are disabled => avoid user panicking: https://freefilesync.org/forum/viewtopic.php?t=7582
+                folderBuffer_[folderKey].failedFolderReads[Zstring() /*empty string for root*/] = utfTo<Zstringc>(it->second.toString());
+            else
+            {
+                folderBuffer_[folderKey];
+                assert(folderStatus_.notExisting.contains(folderKey.folderPath) ||
+                       AFS::isNullPath(folderKey.folderPath));
+            }
+
+    //streaming: merge a folder pair as soon as both sides are available, while slower devices (e.g. SFTP) are still being traversed
+    std::map<DirectoryKey, const DirectoryValue*> foldersDone;
+    for (const auto& [folderKey, folderVal] : folderBuffer_)
+        foldersDone.emplace(folderKey, &folderVal);
+
+    auto mergeAvailablePairs = [&] //throw X
+    {
+        struct ReadyPair
+        {
+            size_t pairIdx;
+            const DirectoryValue* dirValL;
+            const DirectoryValue* dirValR;
+        };
+        std::vector<ReadyPair> readyPairs;
+
+        for (size_t i = 0; i < workLoad.size(); ++i)
+            if (!mergedPairs_[i])
+            {
+                const auto& [folderPair, fpCfg] = workLoad[i];
+                auto itL = foldersDone.find(getFolderKeyL(folderPair, fpCfg));
+                auto itR = foldersDone.find(getFolderKeyR(folderPair, fpCfg));
+                if (itL != foldersDone.end() && itR != foldersDone.end())
+                    readyPairs.push_back({i, itL->second, itR->second});
+            }
+
+        if (readyPairs.empty())
+            return;
+
+        callback.updateStatus(_("Generating file list...")); //throw X
+        callback.requestUiUpdate(true /*force*/); //throw X
+
+        //independent folder pairs => merge in parallel
+        //don't oversubscribe: MergeSides plans the subtrees of each pair in parallel, too
+        const size_t mergeThreadCount = std::max<size_t>(std::thread::hardware_concurrency() / readyPairs.size(), 1);
+
+        runParallel(readyPairs.size(), [&](size_t pos)
+        {
+            const ReadyPair& rp = readyPairs[pos];
+            const auto& [folderPair, fpCfg] = workLoad[rp.pairIdx];
+
+            MergedPair& mp = mergedPairs_[rp.pairIdx].emplace();
+            mp.baseFolder = performComparison(folderPair, fpCfg, *rp.dirValL, *rp.dirValR, mergeThreadCount, mp.undefinedFiles, mp.undefinedSymlinks);
+
+            if (onTimeSizePairCategorized && fpCfg.compareVar == CompareVariant::timeSize && //no need to wait for the other folder pairs
+                !timeSizeVerifyContent_) //categories may still change after content check
+            {
+                categorizeByTimeSize(mp);
+                mp.categorized = true;
+            }
+        });
+
+        if (onTimeSizePairCategorized)
+            for (const ReadyPair& rp : readyPairs)
+                if (const MergedPair& mp = *mergedPairs_[rp.pairIdx];
+                    mp.categorized)
+                    onTimeSizePairCategorized(rp.pairIdx, mp.baseFolder); //throw X
+    };
 
     //------------------------------------------------------------------
     const std::chrono::steady_clock::time_point compareStartTime = std::chrono::steady_clock::now();
@@ -206,31 +336,55 @@ ComparisonBuffer::ComparisonBuffer(const std::set<DirectoryKey>& folderKeys,
         callback.updateStatus(textScanning + statusLine); //throw X
     };
 
-    folderBuffer_ = parallelDeviceTraversal(foldersToRead,
+    FolderScanStats scanStats;
+    folderBuffer_.merge(parallelDeviceTraversal(foldersToRead, deviceParallelOps, incrementalScans, &namePool, &scanStats,
     [&](const PhaseCallback::ErrorInfo& errorInfo) { return callback.reportError(errorInfo); }, //throw X
     onStatusUpdate, //throw X
-    UI_UPDATE_INTERVAL / 2); //every ~50 ms
+    [&](const DirectoryKey& folderKey, const DirectoryValue& folderVal) //throw X
+    {
+        foldersDone.emplace(folderKey, &folderVal);
+        mergeAvailablePairs(); //throw X
+    },
+    UI_UPDATE_INTERVAL / 2)); //every ~50 ms
+    //std::map::merge() => nodes are relinked, not copied: DirectoryValue references used by the merged pairs stay valid
 
     const int64_t totalTimeSec = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - compareStartTime).count();
 
     callback.logInfo(_("Comparison finished:") + L' ' +
                      _P("1 item found", "%x items found", itemsReported) + SPACED_DASH +
                      _("Time elapsed:") + L' ' + copyStringTo<std::wstring>(wxTimeSpan::Seconds(totalTimeSec).Format())); //throw X
-    //------------------------------------------------------------------
 
-    //folderStatus_.existing already in buffer, now create entries for the rest:
-    for (const DirectoryKey& folderKey : folderKeys)
-        if (auto it = folderStatus_.failedChecks.find(folderKey.folderPath);
-            it != folderStatus_.failedChecks.end())
-            //make sure all items are disabled => avoid user panicking: https://freefilesync.org/forum/viewtopic.php?t=7582
-            folderBuffer_[folderKey].failedFolderReads[Zstring() /*empty string for root*/] = utfTo<Zstringc>(it->second.toString());
-        else
+    //hot-folder report: keep the log short, full list goes to the metrics file
+    if (!scanStats.slowest.empty() && scanStats.slowest[0].readTime >= SCAN_STATS_LOG_THRESHOLD)
+    {
+        std::wstring report = _("Slowest folders:");
+        for (size_t i = 0; i < std::min(scanStats.slowest.size(), SCAN_STATS_LOG_COUNT) && scanStats.slowest[i].readTime >= SCAN_STATS_LOG_THRESHOLD; ++i)
+        {
+            const FolderScanStats::Folder& f = scanStats.slowest[i];
+            report += L"\n    " + formatNumber(f.readTime.count()) + L" ms" + SPACED_DASH + replaceCpy(_("%x items"), L"%x", formatNumber(f.itemCount)) + SPACED_DASH + f.displayPath;
+        }
+        report += L'\n' + _("Largest folders:");
+        for (size_t i = 0; i < std::min(scanStats.largest.size(), SCAN_STATS_LOG_COUNT); ++i)
         {
-            folderBuffer_[folderKey];
-            assert(folderStatus_.existing   .contains(folderKey.folderPath) ||
-                   folderStatus_.notExisting.contains(folderKey.folderPath) ||
-                   AFS::isNullPath(folderKey.folderPath));
+            const FolderScanStats::Folder& f = scanStats.largest[i];
+            report += L"\n    " + replaceCpy(_("%x items"), L"%x", formatNumber(f.itemCount)) + SPACED_DASH + formatNumber(f.readTime.count()) + L" ms" + SPACED_DASH + f.displayPath;
         }
+        callback.logInfo(report); //throw X
+    }
+    callback.reportScanStats(scanStats);
+    //------------------------------------------------------------------
+
+    mergeAvailablePairs(); //throw X; e.g. no existing folders => nothing was traversed
+    assert(std::all_of(mergedPairs_.begin(), mergedPairs_.end(), [](const std::optional<MergedPair>& mp) { return mp.has_value(); }));
+}
+
+
+ComparisonBuffer::MergedPair ComparisonBuffer::takeMergedPair(size_t pairIdx)
+{
+    assert(mergedPairs_[pairIdx]);
+    MergedPair mp = std::move(*mergedPairs_[pairIdx]);
+    mergedPairs_[pairIdx].reset();
+    return mp;
 }
 
 
@@ -274,7 +428,6 @@ Zstringc getDescrDiffMetaShortnameCase(const FileSystemObject& fsObj)
 }
 
 
-#if 0
 template <class FileOrLinkPair>
 Zstringc getDescrDiffMetaData(const FileOrLinkPair& file)
 {
@@ -282,7 +435,6 @@ Zstringc getDescrDiffMetaData(const FileOrLinkPair& file)
                            arrowLeft  + L' ' + _("Date:") + L' ' + formatUtcToLocalTime(file.template getLastWriteTime<SelectSide::left >()) + L'\n' +
                            arrowRight + L' ' + _("Date:") + L' ' + formatUtcToLocalTime(file.template getLastWriteTime<SelectSide::right>()));
 }
-#endif
 
 
 Zstringc getConflictAmbiguousItemName(const Zstring& itemName)
@@ -296,7 +448,7 @@ void categorizeSymlinkByTime(SymlinkPair& symlink)
 {
     //categorize symlinks that exist on both sides
     switch (compareFileTime(symlink.getLastWriteTime<SelectSide::left>(),
-                            symlink.getLastWriteTime<SelectSide::right>(), symlink.base().getFileTimeTolerance(), symlink.base().getIgnoredTimeShift()))
+                            symlink.getLastWriteTime<SelectSide::right>(), symlink.base().getTimeTolerance()))
     {
         case TimeResult::equal:
             //Caveat:
@@ -329,22 +481,38 @@ void categorizeSymlinkByTime(SymlinkPair& symlink)
 }
 
 
-std::shared_ptr<BaseFolderPair> ComparisonBuffer::compareByTimeSize(const ResolvedFolderPair& fp, const FolderPairCfg& fpConfig) const
+std::vector<std::shared_ptr<BaseFolderPair>> ComparisonBuffer::compareByTimeSize(const std::vector<size_t>& pairIdxs)
 {
-    //do basis scan and retrieve files existing on both sides as "compareCandidates"
-    std::vector<FilePair*> uncategorizedFiles;
-    std::vector<SymlinkPair*> uncategorizedLinks;
-    std::shared_ptr<BaseFolderPair> output = performComparison(fp, fpConfig, uncategorizedFiles, uncategorizedLinks);
+    //basis scan was done already: retrieve files existing on both sides as "compareCandidates"
+    std::vector<MergedPair> mergedPairs;
+    for (const size_t pairIdx : pairIdxs)
+        mergedPairs.push_back(takeMergedPair(pairIdx));
+
+    //CPU-bound, no callbacks, independent folder pairs => categorize in parallel
+    runParallel(mergedPairs.size(), [&](size_t pos) { if (!mergedPairs[pos].categorized) categorizeByTimeSize(mergedPairs[pos]); });
+
+    if (timeSizeVerifyContent_)
+        verifyTimeDiffByContent(mergedPairs); //throw X
+
+    std::vector<std::shared_ptr<BaseFolderPair>> output;
+    for (MergedPair& mp : mergedPairs)
+        output.push_back(std::move(mp.baseFolder));
+    return output;
+}
 
+
+void ComparisonBuffer::categorizeByTimeSize(MergedPair& mp)
+{
     //finish symlink categorization
-    for (SymlinkPair* symlink : uncategorizedLinks)
+    for (SymlinkPair* symlink : mp.undefinedSymlinks)
         categorizeSymlinkByTime(*symlink);
 
     //categorize files that exist on both sides
-    for (FilePair* file : uncategorizedFiles)
+    const TimeTolerance& timeTolerance = mp.baseFolder->getTimeTolerance();
+    for (FilePair* file : mp.undefinedFiles)
     {
         switch (compareFileTime(file->getLastWriteTime<SelectSide::left>(),
-                                file->getLastWriteTime<SelectSide::right>(), fileTimeTolerance_, fpConfig.ignoreTimeShiftMinutes))
+                                file->getLastWriteTime<SelectSide::right>(), timeTolerance))
         {
             case TimeResult::equal:
                 //Caveat:
@@ -380,24 +548,109 @@ std::shared_ptr<BaseFolderPair> ComparisonBuffer::compareByTimeSize(const Resolv
                 break;
         }
     }
-    return output;
+}
+
+
+namespace parallel
+{
+//--------------------------------------------------------------
+//ATTENTION CALLBACKS: they also run asynchronously *outside* the singleThread lock!
+//--------------------------------------------------------------
+inline
+bool filesHaveSameContent(const AbstractPath& filePath1, const AbstractPath& filePath2, //throw FileError, X
+                          const IoCallback& notifyUnbufferedIO /*throw X*/,
+                          std::mutex& singleThread)
+{ return parallelScope([=] { return filesHaveSameContent(filePath1, filePath2, notifyUnbufferedIO); /*throw FileError, X*/ }, singleThread); }
+
+inline
+bool equalSymlinkContent(const AbstractPath& linkPath1, const AbstractPath& linkPath2, std::mutex& singleThread) //throw FileError
+{ return parallelScope([=] { return AFS::equalSymlinkContent(linkPath1, linkPath2); /*throw FileError*/ }, singleThread); }
 }
 
 
 namespace
 {
-void categorizeSymlinkByContent(SymlinkPair& symlink, PhaseCallback& callback)
+void categorizeFileSameContent(FilePair& file)
+{
+    //Caveat:
+    //1. FILE_EQUAL may only be set if short names match in case: InSyncFolder's mapping tables use short name as a key! see db_file.cpp
+    //2. FILE_EQUAL is expected to mean identical file sizes! See InSyncFile
+    //3. harmonize with "bool stillInSync()" in algorithm.cpp, FilePair::setSyncedTo() in file_hierarchy.h
+    if (getUnicodeNormalForm(file.getItemName<SelectSide::left >()) !=
+        getUnicodeNormalForm(file.getItemName<SelectSide::right>()))
+        file.setCategoryDiffMetadata(getDescrDiffMetaShortnameCase(file));
+#if 0 //don't synchronize modtime only see FolderPairSyncer::synchronizeFileInt(), SO_COPY_METADATA_TO_*
+    else if (!sameFileTime(file.getLastWriteTime<SelectSide::left>(),
+                           file.getLastWriteTime<SelectSide::right>(), file.base().getTimeTolerance()))
+        file.setCategoryDiffMetadata(getDescrDiffMetaData(file));
+#endif
+    else
+        file.setCategory<FILE_EQUAL>();
+}
+
+
+bool haveSameContent(const FilePair& file, const std::wstring& txtComparingContentOfFiles, AsyncCallback& acb, std::mutex& singleThread) //throw FileError, ThreadStopRequest
+{
+    PercentStatReporter statReporter(replaceCpy(txtComparingContentOfFiles, L"%x", fmtPath(file.getRelativePathAny())),
+                                     file.getFileSize<SelectSide::left>(), acb); //throw ThreadStopRequest
+
+    //callbacks run *outside* singleThread_ lock! => fine
+    auto notifyUnbufferedIO = [&statReporter](int64_t bytesDelta)
+    {
+        statReporter.updateStatus(0, bytesDelta); //throw ThreadStopRequest
+        interruptionPoint(); //throw ThreadStopRequest => not reliably covered by AsyncPercentStatReporter::updateStatus()!
+    };
+
+    const bool sameContent = parallel::filesHaveSameContent(file.getAbstractPath<SelectSide::left >(),
+                                                            file.getAbstractPath<SelectSide::right>(), notifyUnbufferedIO, singleThread); //throw FileError, ThreadStopRequest
+    statReporter.updateStatus(1, 0); //throw ThreadStopRequest
+    return sameContent;
+}
+
+
+void categorizeFileByContent(FilePair& file, const std::wstring& txtComparingContentOfFiles, AsyncCallback& acb, std::mutex& singleThread) //throw ThreadStopRequest
+{
+    bool sameContent = false;
+    const std::wstring errMsg = tryReportingError([&]
+    {
+        sameContent = haveSameContent(file, txtComparingContentOfFiles, acb, singleThread); //throw FileError, ThreadStopRequest
+    }, acb); //throw ThreadStopRequest
+
+    if (!errMsg.empty())
+        file.setCategoryConflict(utfTo<Zstringc>(errMsg));
+    else
+    {
+        if (sameContent)
+            categorizeFileSameContent(file);
+        else
+            file.setCategory<FILE_DIFFERENT_CONTENT>();
+    }
+}
+
+
+//CompareVariant::timeSize: content check is an optimization only => keep categorization by time unless content is found equal
+void categorizeFileTimeDiffByContent(FilePair& file, const std::wstring& txtComparingContentOfFiles, AsyncCallback& acb, std::mutex& singleThread) //throw ThreadStopRequest
+{
+    try
+    {
+        if (haveSameContent(file, txtComparingContentOfFiles, acb, singleThread)) //throw FileError, ThreadStopRequest
+            file.setCategoryDiffMetadata(getDescrDiffMetaData(file)); //=> SO_COPY_METADATA_TO_*: update modification time instead of copying
+    }
+    catch (const FileError& e) { acb.logInfo(e.toString()); } //throw ThreadStopRequest
+}
+
+
+void categorizeSymlinkByContent(SymlinkPair& symlink, const std::wstring& txtResolvingSymlink, AsyncCallback& acb, std::mutex& singleThread) //throw ThreadStopRequest
 {
     //categorize symlinks that exist on both sides
-    callback.updateStatus(replaceCpy(_("Resolving symbolic link %x"), L"%x", fmtPath(AFS::getDisplayPath(symlink.getAbstractPath<SelectSide::left >())))); //throw X
-    callback.updateStatus(replaceCpy(_("Resolving symbolic link %x"), L"%x", fmtPath(AFS::getDisplayPath(symlink.getAbstractPath<SelectSide::right>())))); //throw X
+    acb.updateStatus(txtResolvingSymlink, AFS::getDisplayPath(symlink.getAbstractPath<SelectSide::left>())); //throw ThreadStopRequest
 
     bool equalContent = false;
     const std::wstring errMsg = tryReportingError([&]
     {
-        equalContent = AFS::equalSymlinkContent(symlink.getAbstractPath<SelectSide::left >(),
-                                                symlink.getAbstractPath<SelectSide::right>()); //throw FileError
-    }, callback); //throw X
+        equalContent = parallel::equalSymlinkContent(symlink.getAbstractPath<SelectSide::left >(),
+                                                     symlink.getAbstractPath<SelectSide::right>(), singleThread); //throw FileError
+    }, acb); //throw ThreadStopRequest
 
     if (!errMsg.empty())
         symlink.setCategoryConflict(utfTo<Zstringc>(errMsg));
@@ -413,7 +666,7 @@ void categorizeSymlinkByContent(SymlinkPair& symlink, PhaseCallback& callback)
                 getUnicodeNormalForm(symlink.getItemName<SelectSide::right>()))
                 symlink.setCategoryDiffMetadata(getDescrDiffMetaShortnameCase(symlink));
             //else if (!sameFileTime(symlink.getLastWriteTime<SelectSide::left>(),
-            //                       symlink.getLastWriteTime<SelectSide::right>(), symlink.base().getFileTimeTolerance(), symlink.base().getIgnoredTimeShift()))
+            //                       symlink.getLastWriteTime<SelectSide::right>(), symlink.base().getTimeTolerance()))
             //    symlink.setCategoryDiffMetadata(getDescrDiffMetaData(symlink));
             else
                 symlink.setCategory<FILE_EQUAL>();
@@ -421,112 +674,67 @@ void categorizeSymlinkByContent(SymlinkPair& symlink, PhaseCallback& callback)
         else
             symlink.setCategory<FILE_DIFFERENT_CONTENT>();
     }
-}
+    acb.updateDataProcessed(1, 0); //noexcept
 }
 
 
-std::shared_ptr<BaseFolderPair> ComparisonBuffer::compareBySize(const ResolvedFolderPair& fp, const FolderPairCfg& fpConfig) const
+//find files that were equal by content as of last sync and are unchanged since: same file ID, modification time and size on both sides
+class FindUnchangedContent
 {
-    //do basis scan and retrieve files existing on both sides as "compareCandidates"
-    std::vector<FilePair*> uncategorizedFiles;
-    std::vector<SymlinkPair*> uncategorizedLinks;
-    std::shared_ptr<BaseFolderPair> output = performComparison(fp, fpConfig, uncategorizedFiles, uncategorizedLinks);
-
-    //finish symlink categorization
-    for (SymlinkPair* symlink : uncategorizedLinks)
-        categorizeSymlinkByContent(*symlink, cb_); //"compare by size" has the semantics of a quick content-comparison!
-    //harmonize with algorithm.cpp, stillInSync()!
-
-    //categorize files that exist on both sides
-    for (FilePair* file : uncategorizedFiles)
+public:
+    static void execute(const BaseFolderPair& baseFolder, const InSyncFolder& dbFolder, std::unordered_set<const FilePair*>& unchangedFiles)
     {
-        //Caveat:
-        //1. FILE_EQUAL may only be set if short names match in case: InSyncFolder's mapping tables use short name as a key! see db_file.cpp
-        //2. FILE_EQUAL is expected to mean identical file sizes! See InSyncFile
-        //3. harmonize with "bool stillInSync()" in algorithm.cpp, FilePair::setSyncedTo() in file_hierarchy.h
-        if (file->getFileSize<SelectSide::left>() == file->getFileSize<SelectSide::right>())
-        {
-            if (getUnicodeNormalForm(file->getItemName<SelectSide::left >()) ==
-                getUnicodeNormalForm(file->getItemName<SelectSide::right>()))
-                file->setCategory<FILE_EQUAL>();
-            else
-                file->setCategoryDiffMetadata(getDescrDiffMetaShortnameCase(*file));
-        }
-        else
-            file->setCategory<FILE_DIFFERENT_CONTENT>();
+        FindUnchangedContent(unchangedFiles).recurse(baseFolder, dbFolder);
     }
-    return output;
-}
-
-
-namespace parallel
-{
-//--------------------------------------------------------------
-//ATTENTION CALLBACKS: they also run asynchronously *outside* the singleThread lock!
-//--------------------------------------------------------------
-inline
-bool filesHaveSameContent(const AbstractPath& filePath1, const AbstractPath& filePath2, //throw FileError, X
-                          const IoCallback& notifyUnbufferedIO /*throw X*/,
-                          std::mutex& singleThread)
-{ return parallelScope([=] { return filesHaveSameContent(filePath1, filePath2, notifyUnbufferedIO); /*throw FileError, X*/ }, singleThread); }
-}
 
+private:
+    explicit FindUnchangedContent(std::unordered_set<const FilePair*>& unchangedFiles) : unchangedFiles_(unchangedFiles) {}
 
-namespace
-{
-void categorizeFileByContent(FilePair& file, const std::wstring& txtComparingContentOfFiles, AsyncCallback& acb, std::mutex& singleThread) //throw ThreadStopRequest
-{
-    bool haveSameContent = false;
-    const std::wstring errMsg = tryReportingError([&]
+    void recurse(const ContainerObject& hierObj, const InSyncFolder& dbFolder)
     {
-        PercentStatReporter statReporter(replaceCpy(txtComparingContentOfFiles, L"%x", fmtPath(file.getRelativePathAny())),
-                                         file.getFileSize<SelectSide::left>(), acb); //throw ThreadStopRequest
-
-        //callbacks run *outside* singleThread_ lock! => fine
-        auto notifyUnbufferedIO = [&statReporter](int64_t bytesDelta)
-        {
-            statReporter.updateStatus(0, bytesDelta); //throw ThreadStopRequest
-            interruptionPoint(); //throw ThreadStopRequest => not reliably covered by AsyncPercentStatReporter::updateStatus()!
-        };
-
-        haveSameContent = parallel::filesHaveSameContent(file.getAbstractPath<SelectSide::left >(),
-                                                         file.getAbstractPath<SelectSide::right>(), notifyUnbufferedIO, singleThread); //throw FileError, ThreadStopRequest
-        statReporter.updateStatus(1, 0); //throw ThreadStopRequest
-    }, acb); //throw ThreadStopRequest
+        for (const FilePair& file : hierObj.refSubFiles())
+            if (!file.isEmpty<SelectSide::left>() && !file.isEmpty<SelectSide::right>())
+                if (auto it = dbFolder.files.find(file.getItemName<SelectSide::left>());
+                    it != dbFolder.files.end())
+                    if (getUnicodeNormalForm(file.getItemName<SelectSide::left >()) ==
+                        getUnicodeNormalForm(file.getItemName<SelectSide::right>()) && //don't pick a DB entry for the wrong name
+                        stillUnchanged(file, it->second))
+                        unchangedFiles_.insert(&file);
+
+        for (const FolderPair& folder : hierObj.refSubFolders())
+            if (!folder.isEmpty<SelectSide::left>() && !folder.isEmpty<SelectSide::right>())
+                if (auto it = dbFolder.folders.find(folder.getItemName<SelectSide::left>());
+                    it != dbFolder.folders.end())
+                    recurse(folder, it->second);
+    }
 
-    if (!errMsg.empty())
-        file.setCategoryConflict(utfTo<Zstringc>(errMsg));
-    else
+    static bool stillUnchanged(const FilePair& file, const InSyncFile& dbFile)
     {
-        if (haveSameContent)
-        {
-            //Caveat:
-            //1. FILE_EQUAL may only be set if short names match in case: InSyncFolder's mapping tables use short name as a key! see db_file.cpp
-            //2. FILE_EQUAL is expected to mean identical file sizes! See InSyncFile
-            //3. harmonize with "bool stillInSync()" in algorithm.cpp, FilePair::setSyncedTo() in file_hierarchy.h
-            if (getUnicodeNormalForm(file.getItemName<SelectSide::left >()) !=
-                getUnicodeNormalForm(file.getItemName<SelectSide::right>()))
-                file.setCategoryDiffMetadata(getDescrDiffMetaShortnameCase(file));
-#if 0 //don't synchronize modtime only see FolderPairSyncer::synchronizeFileInt(), SO_COPY_METADATA_TO_*
-            else if (!sameFileTime(file.getLastWriteTime<SelectSide::left>(),
-                                   file.getLastWriteTime<SelectSide::right>(), file.base().getFileTimeTolerance(), file.base().getIgnoredTimeShift()))
-                file.setCategoryDiffMetadata(getDescrDiffMetaData(file));
-#endif
-            else
-                file.setCategory<FILE_EQUAL>();
-        }
-        else
-            file.setCategory<FILE_DIFFERENT_CONTENT>();
+        //file ID is mandatory: modification time and size alone are not good enough to skip a byte-by-byte comparison
+        return dbFile.cmpVar == CompareVariant::content &&
+               dbFile.left .filePrint != 0 && dbFile.left .filePrint == file.getFilePrint<SelectSide::left >() &&
+               dbFile.right.filePrint != 0 && dbFile.right.filePrint == file.getFilePrint<SelectSide::right>() &&
+               dbFile.left .modTime == file.getLastWriteTime<SelectSide::left >() &&
+               dbFile.right.modTime == file.getLastWriteTime<SelectSide::right>() &&
+               dbFile.fileSize == file.getFileSize<SelectSide::left >() &&
+               dbFile.fileSize == file.getFileSize<SelectSide::right>();
     }
-}
+
+    std::unordered_set<const FilePair*>& unchangedFiles_;
+};
 }
 
 
-std::vector<std::shared_ptr<BaseFolderPair>> ComparisonBuffer::compareByContent(const std::vector<std::pair<ResolvedFolderPair, FolderPairCfg>>& workLoad) const
+template <class Function>
+void ComparisonBuffer::compareBytewise(std::vector<BytewiseWorkload>&& workload, Function categorizeFile /*throw ThreadStopRequest*/) //throw X
 {
+    if (workload.empty()) //run ProcessPhase::comparingContent only when needed
+        return;
+
     struct ParallelOps
     {
         size_t current      = 0;
+        size_t max          = 1; //number of file pairs in flight per device: overlap I/O latency of one pair with reading/comparing of others
     };
     std::map<AfsDevice, ParallelOps> parallelOpsStatus;
 
@@ -535,35 +743,149 @@ std::vector<std::shared_ptr<BaseFolderPair>> ComparisonBuffer::compareByContent(
         ParallelOps& parallelOpsL; //
         ParallelOps& parallelOpsR; //consider aliasing!
         RingBuffer<FilePair*> filesToCompareBytewise;
+        RingBuffer<SymlinkPair*> symlinksToResolve;
     };
     std::vector<BinaryWorkload> fpWorkload;
 
-    auto addToBinaryWorkload = [&](const AbstractPath& basePathL, const AbstractPath& basePathR, RingBuffer<FilePair*>&& filesToCompareBytewise)
+    for (BytewiseWorkload& bwl : workload)
     {
+        const AbstractPath basePathL = bwl.baseFolder->getAbstractPath<SelectSide::left >();
+        const AbstractPath basePathR = bwl.baseFolder->getAbstractPath<SelectSide::right>();
         ParallelOps& posL = parallelOpsStatus[basePathL.afsDevice];
         ParallelOps& posR = parallelOpsStatus[basePathR.afsDevice];
-        fpWorkload.push_back({posL, posR, std::move(filesToCompareBytewise)});
+        posL.max = getDeviceParallelOps(deviceParallelOps_, basePathL.afsDevice);
+        posR.max = getDeviceParallelOps(deviceParallelOps_, basePathR.afsDevice);
+        fpWorkload.push_back({posL, posR, std::move(bwl.files), std::move(bwl.symlinks)});
+    }
+
+    int      itemsTotal = 0;
+    uint64_t bytesTotal = 0;
+    for (const BinaryWorkload& bwl : fpWorkload)
+    {
+        itemsTotal += bwl.filesToCompareBytewise.size() + bwl.symlinksToResolve.size();
+
+        for (const FilePair* file : bwl.filesToCompareBytewise)
+            bytesTotal += file->getFileSize<SelectSide::left>(); //left and right file sizes are equal
+    }
+    cb_.initNewPhase(itemsTotal, bytesTotal, ProcessPhase::comparingContent); //throw X
+
+    ZEN_TRACE_SCOPE_ARG("compare:content", itemsTotal)
+
+    std::mutex singleThread; //only a single worker thread may run at a time, except for parallel file I/O
+
+    AsyncCallback acb;                       //
+    std::function<void()> scheduleMoreTasks; //manage life time: enclose ThreadGroup!
+
+    ThreadGroup<std::function<void()>> tg(std::numeric_limits<size_t>::max(), Zstr("Binary Comparison"));
+
+    scheduleMoreTasks = [&, txtComparingContentOfFiles = _("Comparing content of files %x"),
+                          /**/txtResolvingSymlink        = _("Resolving symbolic link %x")]
+    {
+        bool wereDone = true;
+
+        for (size_t j = 0; j < fpWorkload.size(); ++j)
+        {
+            BinaryWorkload& bwl = fpWorkload[j];
+            ParallelOps& posL = bwl.parallelOpsL;
+            ParallelOps& posR = bwl.parallelOpsR;
+            const size_t newTaskCount = std::min<size_t>({posL.max - posL.current, posR.max - posR.current,
+                                                          bwl.symlinksToResolve.size() + bwl.filesToCompareBytewise.size()});
+            if (&posL != &posR)
+                posL.current += newTaskCount; //
+            posR.current += newTaskCount;     //consider aliasing!
+
+            for (size_t i = 0; i < newTaskCount; ++i)
+            {
+                SymlinkPair* symlink = nullptr;
+                FilePair*    file    = nullptr;
+                if (!bwl.symlinksToResolve.empty()) //symlinks first: cheap, but one round trip each => keep the device busy while file pairs are streamed
+                {
+                    symlink = bwl.symlinksToResolve.front();
+                    bwl.symlinksToResolve.pop_front();
+                }
+                else
+                {
+                    file = bwl.filesToCompareBytewise.front();
+                    bwl.filesToCompareBytewise.pop_front();
+                }
+
+                tg.run([&, statusPrio = j, symlink, file]
+                {
+                    acb.notifyTaskBegin(statusPrio); //prioritize status messages according to natural order of folder pairs
+                    ZEN_ON_SCOPE_EXIT(acb.notifyTaskEnd());
+
+                    std::lock_guard dummy(singleThread); //protect ALL variable accesses unless explicitly not needed ("parallel" scope)!
+                    //---------------------------------------------------------------------------------------------------
+                    ZEN_ON_SCOPE_SUCCESS(if (&posL != &posR) --posL.current;
+                                         /**/                --posR.current;
+                                         scheduleMoreTasks());
+
+                    if (symlink)
+                        categorizeSymlinkByContent(*symlink, txtResolvingSymlink, acb, singleThread); //throw ThreadStopRequest
+                    else
+                        categorizeFile(*file, txtComparingContentOfFiles, acb, singleThread); //throw ThreadStopRequest
+                });
+            }
+            if (posL.current != 0 || posR.current != 0 || !bwl.symlinksToResolve.empty() || !bwl.filesToCompareBytewise.empty())
+                wereDone = false;
+        }
+        if (wereDone)
+            acb.notifyAllDone();
     };
 
+    {
+        std::lock_guard dummy(singleThread); //[!] potential race with worker threads!
+        scheduleMoreTasks(); //set initial load
+    }
+
+    acb.waitUntilDone(UI_UPDATE_INTERVAL / 2 /*every ~50 ms*/, cb_); //throw X
+}
+
+
+std::vector<std::shared_ptr<BaseFolderPair>> ComparisonBuffer::compareByContent(const std::vector<size_t>& pairIdxs)
+{
+    std::vector<BytewiseWorkload> bytewiseWorkload;
+
     //PERF_START;
     std::vector<std::shared_ptr<BaseFolderPair>> output;
 
     const Zstringc txtConflictSkippedBinaryComparison = getConflictSkippedBinaryComparison(); //avoid premature pess.: save memory via ref-counted string
 
-    for (const auto& [folderPair, fpCfg] : workLoad)
+    std::vector<std::vector<FilePair*>> undefinedFilesByPair;
+    std::vector<std::vector<SymlinkPair*>> uncategorizedLinksByPair;
+
+    for (const size_t pairIdx : pairIdxs)
     {
-        std::vector<FilePair*> undefinedFiles;
-        std::vector<SymlinkPair*> uncategorizedLinks;
-        //run basis scan and retrieve candidates for binary comparison (files existing on both sides)
-        output.push_back(performComparison(folderPair, fpCfg, undefinedFiles, uncategorizedLinks));
+        //basis scan was done already: retrieve candidates for binary comparison (files existing on both sides)
+        MergedPair mp = takeMergedPair(pairIdx);
+        output.push_back(std::move(mp.baseFolder));
+        undefinedFilesByPair    .push_back(std::move(mp.undefinedFiles));
+        uncategorizedLinksByPair.push_back(std::move(mp.undefinedSymlinks));
+    }
+
+    //optional: skip files found equal during last sync and unchanged since => trade certainty for a full read of both sides
+    std::unordered_set<const FilePair*> unchangedFiles;
+    if (contentCmpTrustDatabase_)
+    {
+        std::vector<const BaseFolderPair*> baseFoldersForDbLoad;
+        for (const std::shared_ptr<BaseFolderPair>& baseFolder : output)
+            baseFoldersForDbLoad.push_back(baseFolder.get());
 
+        for (const auto& [baseFolder, lastSyncState] : loadLastSynchronousState(baseFoldersForDbLoad, &namePool_, cb_ /*throw X*/)) //throw X
+            FindUnchangedContent::execute(*baseFolder, lastSyncState.ref(), unchangedFiles);
+    }
+
+    for (size_t i = 0; i < output.size(); ++i)
+    {
         RingBuffer<FilePair*> filesToCompareBytewise;
         //content comparison of file content happens AFTER finding corresponding files and AFTER filtering
         //in order to separate into two processes (scanning and comparing)
-        for (FilePair* file : undefinedFiles)
+        for (FilePair* file : undefinedFilesByPair[i])
             //pre-check: files have different content if they have a different file size (must not be FILE_EQUAL: see InSyncFile)
             if (file->getFileSize<SelectSide::left>() != file->getFileSize<SelectSide::right>())
                 file->setCategory<FILE_DIFFERENT_CONTENT>();
+            else if (unchangedFiles.contains(file))
+                categorizeFileSameContent(*file);
             else
             {
                 //perf: skip binary comparison for excluded rows (e.g. via time span and size filter)!
@@ -573,339 +895,503 @@ std::vector<std::shared_ptr<BaseFolderPair>> ComparisonBuffer::compareByContent(
                 else
                     filesToCompareBytewise.push_back(file);
             }
-        if (!filesToCompareBytewise.empty())
-            addToBinaryWorkload(output.back()->getAbstractPath<SelectSide::left >(),
-                                output.back()->getAbstractPath<SelectSide::right>(), std::move(filesToCompareBytewise));
 
         //finish symlink categorization
-        for (SymlinkPair* symlink : uncategorizedLinks)
-            categorizeSymlinkByContent(*symlink, cb_);
+        RingBuffer<SymlinkPair*> symlinksToResolve;
+        for (SymlinkPair* symlink : uncategorizedLinksByPair[i])
+            symlinksToResolve.push_back(symlink);
+
+        if (!filesToCompareBytewise.empty() || !symlinksToResolve.empty())
+            bytewiseWorkload.push_back({output[i].get(), std::move(filesToCompareBytewise), std::move(symlinksToResolve)});
     }
 
     //finish categorization: compare files (that have same size) bytewise...
-    if (!fpWorkload.empty()) //run ProcessPhase::comparingContent only when needed
-    {
-        int      itemsTotal = 0;
-        uint64_t bytesTotal = 0;
-        for (const BinaryWorkload& bwl : fpWorkload)
-        {
-            itemsTotal += bwl.filesToCompareBytewise.size();
-
-            for (const FilePair* file : bwl.filesToCompareBytewise)
-                bytesTotal += file->getFileSize<SelectSide::left>(); //left and right file sizes are equal
-        }
-        cb_.initNewPhase(itemsTotal, bytesTotal, ProcessPhase::comparingContent); //throw X
+    compareBytewise(std::move(bytewiseWorkload), categorizeFileByContent); //throw X
 
-        //PERF_START;
+    return output;
+}
 
-        std::mutex singleThread; //only a single worker thread may run at a time, except for parallel file I/O
 
-        AsyncCallback acb;                       //
-        std::function<void()> scheduleMoreTasks; //manage life time: enclose ThreadGroup!
+std::vector<std::shared_ptr<BaseFolderPair>> ComparisonBuffer::compareBySize(const std::vector<size_t>& pairIdxs)
+{
+    std::vector<BytewiseWorkload> symlinkWorkload;
+    std::vector<std::shared_ptr<BaseFolderPair>> output;
 
-        ThreadGroup<std::function<void()>> tg(std::numeric_limits<size_t>::max(), Zstr("Binary Comparison"));
+    for (const size_t pairIdx : pairIdxs)
+    {
+        //basis scan was done already: retrieve files existing on both sides as "compareCandidates"
+        MergedPair mp = takeMergedPair(pairIdx);
 
-        scheduleMoreTasks = [&, txtComparingContentOfFiles = _("Comparing content of files %x")]
+        //categorize files that exist on both sides
+        for (FilePair* file : mp.undefinedFiles)
         {
-            bool wereDone = true;
-
-            for (size_t j = 0; j < fpWorkload.size(); ++j)
+            //Caveat:
+            //1. FILE_EQUAL may only be set if short names match in case: InSyncFolder's mapping tables use short name as a key! see db_file.cpp
+            //2. FILE_EQUAL is expected to mean identical file sizes! See InSyncFile
+            //3. harmonize with "bool stillInSync()" in algorithm.cpp, FilePair::setSyncedTo() in file_hierarchy.h
+            if (file->getFileSize<SelectSide::left>() == file->getFileSize<SelectSide::right>())
             {
-                BinaryWorkload& bwl = fpWorkload[j];
-                ParallelOps& posL = bwl.parallelOpsL;
-                ParallelOps& posR = bwl.parallelOpsR;
-                const size_t newTaskCount = std::min<size_t>({1                 - posL.current, 1                 - posR.current, bwl.filesToCompareBytewise.size()});
-                if (&posL != &posR)
-                    posL.current += newTaskCount; //
-                posR.current += newTaskCount;     //consider aliasing!
-
-                for (size_t i = 0; i < newTaskCount; ++i)
-                {
-                    tg.run([&, statusPrio = j, &file = *bwl.filesToCompareBytewise.front()]
-                    {
-                        acb.notifyTaskBegin(statusPrio); //prioritize status messages according to natural order of folder pairs
-                        ZEN_ON_SCOPE_EXIT(acb.notifyTaskEnd());
-
-                        std::lock_guard dummy(singleThread); //protect ALL variable accesses unless explicitly not needed ("parallel" scope)!
-                        //---------------------------------------------------------------------------------------------------
-                        ZEN_ON_SCOPE_SUCCESS(if (&posL != &posR) --posL.current;
-                                             /**/                --posR.current;
-                                             scheduleMoreTasks());
-
-                        categorizeFileByContent(file, txtComparingContentOfFiles, acb, singleThread); //throw ThreadStopRequest
-                    });
-
-                    bwl.filesToCompareBytewise.pop_front();
-                }
-                if (posL.current != 0 || posR.current != 0 || !bwl.filesToCompareBytewise.empty())
-                    wereDone = false;
+                if (getUnicodeNormalForm(file->getItemName<SelectSide::left >()) ==
+                    getUnicodeNormalForm(file->getItemName<SelectSide::right>()))
+                    file->setCategory<FILE_EQUAL>();
+                else
+                    file->setCategoryDiffMetadata(getDescrDiffMetaShortnameCase(*file));
             }
-            if (wereDone)
-                acb.notifyAllDone();
-        };
-
-        {
-            std::lock_guard dummy(singleThread); //[!] potential race with worker threads!
-            scheduleMoreTasks(); //set initial load
+            else
+                file->setCategory<FILE_DIFFERENT_CONTENT>();
         }
 
-        acb.waitUntilDone(UI_UPDATE_INTERVAL / 2 /*every ~50 ms*/, cb_); //throw X
+        //finish symlink categorization: "compare by size" has the semantics of a quick content-comparison!
+        //harmonize with algorithm.cpp, stillInSync()!
+        RingBuffer<SymlinkPair*> symlinksToResolve;
+        for (SymlinkPair* symlink : mp.undefinedSymlinks)
+            symlinksToResolve.push_back(symlink);
+
+        if (!symlinksToResolve.empty())
+            symlinkWorkload.push_back({mp.baseFolder.get(), {}, std::move(symlinksToResolve)});
+
+        output.push_back(std::move(mp.baseFolder));
     }
 
+    compareBytewise(std::move(symlinkWorkload), categorizeFileByContent /*no files: symlinks only*/); //throw X
+
     return output;
 }
 
-//-----------------------------------------------------------------------------------------------
 
-class MergeSides
+//CompareVariant::timeSize: same content, but different modification time after restoring backups, "touch", some cloud clients
+//=> compare content of same-size files with different times: equal content needs a modification time update only instead of a full copy
+void ComparisonBuffer::verifyTimeDiffByContent(const std::vector<MergedPair>& mergedPairs) //throw X
 {
-public:
-    MergeSides(const std::unordered_map<ZstringNoCase, Zstringc>& errorsByRelPath,
-               std::vector<FilePair*>& undefinedFilesOut,
-               std::vector<SymlinkPair*>& undefinedSymlinksOut) :
-        errorsByRelPath_(errorsByRelPath),
-        undefinedFiles_(undefinedFilesOut),
-        undefinedSymlinks_(undefinedSymlinksOut) {}
+    std::vector<BytewiseWorkload> bytewiseWorkload;
 
-    void execute(const FolderContainer& lhs, const FolderContainer& rhs, ContainerObject& output)
+    for (const MergedPair& mp : mergedPairs)
     {
-        auto it = errorsByRelPath_.find(Zstring()); //empty path if read-error for whole base directory
+        RingBuffer<FilePair*> filesToCompareBytewise;
+        for (FilePair* file : mp.undefinedFiles)
+            if ((file->getCategory() == FILE_LEFT_NEWER || file->getCategory() == FILE_RIGHT_NEWER) &&
+                file->getFileSize<SelectSide::left>() == file->getFileSize<SelectSide::right>() &&
+                file->isActive()) //perf: skip binary comparison for excluded rows
+                filesToCompareBytewise.push_back(file);
 
-        mergeTwoSides(lhs, rhs,
-                      it != errorsByRelPath_.end() ? &it->second : nullptr,
-                      output);
+        if (!filesToCompareBytewise.empty())
+            bytewiseWorkload.push_back({mp.baseFolder.get(), std::move(filesToCompareBytewise)});
     }
 
-private:
-    void mergeTwoSides(const FolderContainer& lhs, const FolderContainer& rhs, const Zstringc* errorMsg, ContainerObject& output);
+    compareBytewise(std::move(bytewiseWorkload), categorizeFileTimeDiffByContent); //throw X
+}
 
-    template <SelectSide side>
-    void fillOneSide(const FolderContainer& folderCont, const Zstringc* errorMsg, ContainerObject& output);
 
-    const Zstringc* checkFailedRead(FileSystemObject& fsObj, const Zstringc* errorMsg);
+//-----------------------------------------------------------------------------------------------
 
-    const std::unordered_map<ZstringNoCase, Zstringc>& errorsByRelPath_; //base-relative paths or empty if read-error for whole base directory
-    std::vector<FilePair*>&    undefinedFiles_;
-    std::vector<SymlinkPair*>& undefinedSymlinks_;
+/*  MergeSides in two passes:
+      1. match items of both sides: sort by upper-case name, detect ambiguous names => CPU-bound + read-only => subtrees are planned in parallel
+      2. build the BaseFolderPair hierarchy from the plan on a single thread: the change ids of parent folders are updated along the way
+         (different folder pairs are merged in parallel: see ComparisonBuffer)
+    => deterministic: same item order as a sequential merge                                                                        */
+struct MergeStep
+{
+    enum class Type : unsigned char
+    {
+        file,
+        symlink,
+        folder,
+        folderDeferred, //child items are planned by the next MergeTask
+        folderEnd,      //child items of the last folder are complete
+    };
+    const void* itemL; //value_type of FolderContainer::FileList/SymlinkList/FolderList
+    const void* itemR; //nullptr if item exists on one side only
+    Type type;
+    bool ambiguousName; //next conflict message
 };
 
+struct MergeTask;
 
-inline
-const Zstringc* MergeSides::checkFailedRead(FileSystemObject& fsObj, const Zstringc* errorMsg)
+struct MergePlan
 {
-    if (!errorMsg)
-        if (const auto it = errorsByRelPath_.find(fsObj.getRelativePathAny());
-            it != errorsByRelPath_.end())
-            errorMsg = &it->second;
+    std::vector<MergeStep> steps; //pre-order: perf: no per-folder allocation
+    std::vector<Zstringc> conflictMsgs;
+    std::list<MergeTask> subTasks; //stable addresses (+ supports incomplete type)
+};
 
-    if (errorMsg)
-    {
-        fsObj.setActive(false);
-        fsObj.setCategoryConflict(*errorMsg); //peak memory: Zstringc is ref-counted, unlike std::string!
-        static_assert(std::is_same_v<const Zstringc&, decltype(*errorMsg)>);
-    }
-    return errorMsg;
-}
+struct MergeTask
+{
+    MergePlan plan;
+    std::promise<void> planDone;
+};
 
+using PlanThreadGroup = ThreadGroup<std::function<void()>>;
 
-template <class MapType, class Function>
-void forEachSorted(const MapType& fileMap, Function fun)
+
+template <class MapType>
+struct ItemRef
 {
-    struct FileRef
-    {
-        Zstring upperCaseName;
-        const typename MapType::value_type* ref;
-    };
-    std::vector<FileRef> fileList;
-    fileList.reserve(fileMap.size()); //perf: ~5% shorter runtime
+    Zstring upperCaseKey; //getUpperCaseKey(): perf: no memory allocation for ASCII names
+    const typename MapType::value_type* ref;
+};
 
-    for (const auto& item : fileMap)
-        fileList.push_back({getUpperCase(item.first), &item});
+template <class MapType>
+std::vector<ItemRef<MapType>> getSortedItems(const MapType& itemMap)
+{
+    std::vector<ItemRef<MapType>> itemRefs;
+    itemRefs.reserve(itemMap.size()); //perf: ~5% shorter runtime
+
+    for (const auto& item : itemMap)
+        itemRefs.push_back({getUpperCaseKey(item.first), &item});
 
     //primary sort: ignore Unicode normal form and upper/lower case
     //=> natural default sequence on file grid UI
-    std::sort(fileList.begin(), fileList.end(), [](const FileRef& lhs, const FileRef& rhs) { return lhs.upperCaseName < rhs.upperCaseName; });
-
-    for (const auto& item : fileList)
-        fun(item.ref->first, item.ref->second);
+    std::sort(itemRefs.begin(), itemRefs.end(), [](const ItemRef<MapType>& lhs, const ItemRef<MapType>& rhs)
+    { return std::is_lt(compareUpperCaseKey(lhs.upperCaseKey, rhs.upperCaseKey)); });
+    return itemRefs;
 }
 
 
-template <SelectSide side>
-void MergeSides::fillOneSide(const FolderContainer& folderCont, const Zstringc* errorMsg, ContainerObject& output)
+template <class MapType, class Function>
+void forEachSorted(const MapType& itemMap, Function fun)
 {
-    forEachSorted(folderCont.files, [&](const Zstring& fileName, const FileAttributes& attrib)
-    {
-        FilePair& newItem = output.addSubFile<side>(fileName, attrib);
-        checkFailedRead(newItem, errorMsg);
-    });
-
-    forEachSorted(folderCont.symlinks, [&](const Zstring& linkName, const LinkAttributes& attrib)
-    {
-        SymlinkPair& newItem = output.addSubLink<side>(linkName, attrib);
-        checkFailedRead(newItem, errorMsg);
-    });
-
-    forEachSorted(folderCont.folders, [&](const Zstring& folderName, const std::pair<FolderAttributes, FolderContainer>& attrib)
-    {
-        FolderPair& newFolder = output.addSubFolder<side>(folderName, attrib.first);
-        const Zstringc* errorMsgNew = checkFailedRead(newFolder, errorMsg);
-
-        fillOneSide<side>(attrib.second, errorMsgNew, newFolder); //recurse
-    });
+    for (const ItemRef<MapType>& itemRef : getSortedItems(itemMap))
+        fun(*itemRef.ref);
 }
 
 
 template <class MapType, class ProcessLeftOnly, class ProcessRightOnly, class ProcessBoth> inline
 void matchFolders(const MapType& mapLeft, const MapType& mapRight, ProcessLeftOnly lo, ProcessRightOnly ro, ProcessBoth bo)
 {
-    struct FileRef
-    {
-        Zstring upperCaseName; //buffer expensive getUpperCase() calls!!
-        const typename MapType::value_type* ref;
-        bool leftSide;
-    };
-    std::vector<FileRef> fileList;
-    fileList.reserve(mapLeft.size() + mapRight.size()); //perf: ~5% shorter runtime
-
-    for (const auto& item : mapLeft ) fileList.push_back({getUpperCase(item.first), &item, true });
-    for (const auto& item : mapRight) fileList.push_back({getUpperCase(item.first), &item, false});
+    using ValueType = typename MapType::value_type;
 
-    //primary sort: ignore Unicode normal form and upper/lower case
-    //bonus: natural default sequence on file grid UI
-    std::sort(fileList.begin(), fileList.end(), [](const FileRef& lhs, const FileRef& rhs) { return lhs.upperCaseName < rhs.upperCaseName; });
-
-    using ItType = typename std::vector<FileRef>::iterator;
-    auto tryMatchRange = [&](ItType it, ItType itLast) //auto? compiler error on VS 17.2...
+    auto tryMatch = [&](size_t equalCountL, const ValueType* refL, size_t equalCountR, const ValueType* refR)
     {
-        const size_t equalCountL = std::count_if(it, itLast, [](const FileRef& fr) { return fr.leftSide; });
-        const size_t equalCountR = itLast - it - equalCountL;
-
         if (equalCountL == 1 && equalCountR == 1) //we have a match
-        {
-            if (it->leftSide)
-                bo(*it[0].ref, *it[1].ref);
-            else
-                bo(*it[1].ref, *it[0].ref);
-        }
+            bo(*refL, *refR);
         else if (equalCountL == 1 && equalCountR == 0)
-            lo(*it->ref, nullptr);
+            lo(*refL, nullptr);
         else if (equalCountL == 0 && equalCountR == 1)
-            ro(*it->ref, nullptr);
+            ro(*refR, nullptr);
         else //ambiguous (yes, even if one side only, e.g. different Unicode normalization forms)
             return false;
         return true;
     };
 
-    for (auto it = fileList.begin(); it != fileList.end();)
+    const std::vector<ItemRef<MapType>>& itemsL = getSortedItems(mapLeft);
+    const std::vector<ItemRef<MapType>>& itemsR = getSortedItems(mapRight);
+
+    //linear two-way merge of sorted sides
+    for (auto itL = itemsL.begin(), itR = itemsR.begin(); itL != itemsL.end() || itR != itemsR.end();)
     {
         //find equal range: ignore case, ignore Unicode normalization
-        auto itEndEq = std::find_if(it + 1, fileList.end(), [&](const FileRef& fr) { return fr.upperCaseName != it->upperCaseName; });
-        if (!tryMatchRange(it, itEndEq))
+        const Zstring& upperCaseKey = itR == itemsR.end() ||
+                                      (itL != itemsL.end() && std::is_lteq(compareUpperCaseKey(itL->upperCaseKey, itR->upperCaseKey))) ?
+                                      itL->upperCaseKey : itR->upperCaseKey;
+        auto isEqual = [&](const ItemRef<MapType>& ir) { return std::is_eq(compareUpperCaseKey(ir.upperCaseKey, upperCaseKey)); };
+
+        const auto itEndL = std::find_if_not(itL, itemsL.end(), isEqual);
+        const auto itEndR = std::find_if_not(itR, itemsR.end(), isEqual);
+
+        if (!tryMatch(itEndL - itL, itL != itEndL ? itL->ref : nullptr,
+                      itEndR - itR, itR != itEndR ? itR->ref : nullptr))
         {
+            struct CaseRef
+            {
+                Zstring normName;
+                const ValueType* ref;
+                bool leftSide;
+            };
+            std::vector<CaseRef> caseRefs;
+            for (auto it = itL; it != itEndL; ++it) caseRefs.push_back({getUnicodeNormalForm(it->ref->first), it->ref, true});
+            for (auto it = itR; it != itEndR; ++it) caseRefs.push_back({getUnicodeNormalForm(it->ref->first), it->ref, false});
+
             //secondary sort: respect case, ignore unicode normal forms
-            std::sort(it, itEndEq, [](const FileRef& lhs, const FileRef& rhs) { return getUnicodeNormalForm(lhs.ref->first) < getUnicodeNormalForm(rhs.ref->first); });
+            std::sort(caseRefs.begin(), caseRefs.end(), [](const CaseRef& lhs, const CaseRef& rhs) { return lhs.normName < rhs.normName; });
 
-            for (auto itCase = it; itCase != itEndEq;)
+            for (auto itCase = caseRefs.begin(); itCase != caseRefs.end();)
             {
                 //find equal range: respect case, ignore Unicode normalization
-                auto itEndCase = std::find_if(itCase + 1, itEndEq, [&](const FileRef& fr) { return getUnicodeNormalForm(fr.ref->first) != getUnicodeNormalForm(itCase->ref->first); });
-                if (!tryMatchRange(itCase, itEndCase))
+                const auto itEndCase = std::find_if(itCase + 1, caseRefs.end(), [&](const CaseRef& cr) { return cr.normName != itCase->normName; });
+
+                const auto itCaseL = std::find_if    (itCase, itEndCase, [](const CaseRef& cr) { return cr.leftSide; });
+                const auto itCaseR = std::find_if_not(itCase, itEndCase, [](const CaseRef& cr) { return cr.leftSide; });
+                const size_t equalCountL = std::count_if(itCase, itEndCase, [](const CaseRef& cr) { return cr.leftSide; });
+
+                if (!tryMatch(equalCountL,                        itCaseL != itEndCase ? itCaseL->ref : nullptr,
+                              itEndCase - itCase - equalCountL,   itCaseR != itEndCase ? itCaseR->ref : nullptr))
                 {
                     const Zstringc& conflictMsg = getConflictAmbiguousItemName(itCase->ref->first);
-                    std::for_each(itCase, itEndCase, [&](const FileRef& fr)
+                    std::for_each(itCase, itEndCase, [&](const CaseRef& cr)
                     {
-                        if (fr.leftSide)
-                            lo(*fr.ref, &conflictMsg);
+                        if (cr.leftSide)
+                            lo(*cr.ref, &conflictMsg);
                         else
-                            ro(*fr.ref, &conflictMsg);
+                            ro(*cr.ref, &conflictMsg);
                     });
                 }
                 itCase = itEndCase;
             }
         }
-        it = itEndEq;
+        itL = itEndL;
+        itR = itEndR;
     }
 }
 
 
-void MergeSides::mergeTwoSides(const FolderContainer& lhs, const FolderContainer& rhs, const Zstringc* errorMsg, ContainerObject& output)
+//subtrees of folders up to this level below the base folder are planned by separate tasks
+constexpr int MERGE_PARALLEL_DEPTH = 2;
+
+template <class Function>
+void planSubFolder(int depth, MergePlan& plan, PlanThreadGroup& planGroup, Function planChildren /*(int depth, MergePlan& plan)*/)
 {
-    using FileData = FolderContainer::FileList::value_type;
+    if (depth < MERGE_PARALLEL_DEPTH)
+    {
+        plan.steps.back().type = MergeStep::Type::folderDeferred;
 
-    matchFolders(lhs.files, rhs.files, [&](const FileData& fileLeft, const Zstringc* conflictMsg)
+        MergeTask& task = plan.subTasks.emplace_back();
+        planGroup.run([&task, depth, planChildren] //context of worker thread
+        {
+            planChildren(depth + 1, task.plan);
+            task.planDone.set_value();
+        });
+    }
+    else
     {
-        FilePair& newItem = output.addSubFile<SelectSide::left >(fileLeft .first, fileLeft .second);
-        checkFailedRead(newItem, conflictMsg ? conflictMsg : errorMsg);
-    },
-    [&](const FileData& fileRight, const Zstringc* conflictMsg)
+        planChildren(depth + 1, plan); //recurse
+        plan.steps.push_back({nullptr, nullptr, MergeStep::Type::folderEnd, false});
+    }
+}
+
+
+template <SelectSide side>
+void planOneSide(const FolderContainer& folderCont, int depth, MergePlan& plan, PlanThreadGroup& planGroup)
+{
+    auto addStep = [&](const void* item, MergeStep::Type type)
     {
-        FilePair& newItem = output.addSubFile<SelectSide::right>(fileRight.first, fileRight.second);
-        checkFailedRead(newItem, conflictMsg ? conflictMsg : errorMsg);
-    },
-    [&](const FileData& fileLeft, const FileData& fileRight)
+        plan.steps.push_back({side == SelectSide::left ? item : nullptr,
+                              side == SelectSide::left ? nullptr : item, type, false});
+    };
+
+    forEachSorted(folderCont.files,    [&](const FolderContainer::FileList   ::value_type& item) { addStep(&item, MergeStep::Type::file); });
+    forEachSorted(folderCont.symlinks, [&](const FolderContainer::SymlinkList::value_type& item) { addStep(&item, MergeStep::Type::symlink); });
+    forEachSorted(folderCont.folders,  [&](const FolderContainer::FolderList ::value_type& item)
     {
-        FilePair& newItem = output.addSubFile(fileLeft.first,
-                                              fileLeft.second,
-                                              FILE_CONFLICT, //dummy-value until categorization is finished later
-                                              fileRight.first,
-                                              fileRight.second);
-        if (!checkFailedRead(newItem, errorMsg))
-            undefinedFiles_.push_back(&newItem);
-        static_assert(std::is_same_v<ContainerObject::FileList, std::list<FilePair>>); //ContainerObject::addSubFile() must NOT invalidate references used in "undefinedFiles"!
+        addStep(&item, MergeStep::Type::folder);
+        planSubFolder(depth, plan, planGroup, [&subFolderCont = item.second.second, &planGroup](int depthSub, MergePlan& planSub)
+        { planOneSide<side>(subFolderCont, depthSub, planSub, planGroup); });
     });
+}
 
-    //-----------------------------------------------------------------------------------------------
-    using SymlinkData = FolderContainer::SymlinkList::value_type;
 
-    matchFolders(lhs.symlinks, rhs.symlinks, [&](const SymlinkData& symlinkLeft, const Zstringc* conflictMsg)
-    {
-        SymlinkPair& newItem = output.addSubLink<SelectSide::left >(symlinkLeft .first, symlinkLeft .second);
-        checkFailedRead(newItem, conflictMsg ? conflictMsg : errorMsg);
-    },
-    [&](const SymlinkData& symlinkRight, const Zstringc* conflictMsg)
-    {
-        SymlinkPair& newItem = output.addSubLink<SelectSide::right>(symlinkRight.first, symlinkRight.second);
-        checkFailedRead(newItem, conflictMsg ? conflictMsg : errorMsg);
-    },
-    [&](const SymlinkData& symlinkLeft, const SymlinkData& symlinkRight) //both sides
+void planTwoSides(const FolderContainer& lhs, const FolderContainer& rhs, int depth, MergePlan& plan, PlanThreadGroup& planGroup)
+{
+    auto addStep = [&](const void* itemL, const void* itemR, MergeStep::Type type, const Zstringc* conflictMsg)
     {
-        SymlinkPair& newItem = output.addSubLink(symlinkLeft.first,
-                                                 symlinkLeft.second,
-                                                 SYMLINK_CONFLICT, //dummy-value until categorization is finished later
-                                                 symlinkRight.first,
-                                                 symlinkRight.second);
-        if (!checkFailedRead(newItem, errorMsg))
-            undefinedSymlinks_.push_back(&newItem);
-    });
+        plan.steps.push_back({itemL, itemR, type, conflictMsg != nullptr});
+        if (conflictMsg)
+            plan.conflictMsgs.push_back(*conflictMsg);
+    };
+
+    matchFolders(lhs.files, rhs.files,
+    [&](const FolderContainer::FileList::value_type& fileLeft,  const Zstringc* conflictMsg) { addStep(&fileLeft, nullptr, MergeStep::Type::file, conflictMsg); },
+    [&](const FolderContainer::FileList::value_type& fileRight, const Zstringc* conflictMsg) { addStep(nullptr, &fileRight, MergeStep::Type::file, conflictMsg); },
+    [&](const FolderContainer::FileList::value_type& fileLeft, const FolderContainer::FileList::value_type& fileRight)
+    { addStep(&fileLeft, &fileRight, MergeStep::Type::file, nullptr); });
+
+    matchFolders(lhs.symlinks, rhs.symlinks,
+    [&](const FolderContainer::SymlinkList::value_type& symlinkLeft,  const Zstringc* conflictMsg) { addStep(&symlinkLeft, nullptr, MergeStep::Type::symlink, conflictMsg); },
+    [&](const FolderContainer::SymlinkList::value_type& symlinkRight, const Zstringc* conflictMsg) { addStep(nullptr, &symlinkRight, MergeStep::Type::symlink, conflictMsg); },
+    [&](const FolderContainer::SymlinkList::value_type& symlinkLeft, const FolderContainer::SymlinkList::value_type& symlinkRight)
+    { addStep(&symlinkLeft, &symlinkRight, MergeStep::Type::symlink, nullptr); });
 
-    //-----------------------------------------------------------------------------------------------
     using FolderData = FolderContainer::FolderList::value_type;
 
     matchFolders(lhs.folders, rhs.folders, [&](const FolderData& dirLeft, const Zstringc* conflictMsg)
     {
-        FolderPair& newFolder = output.addSubFolder<SelectSide::left>(dirLeft.first, dirLeft.second.first);
-        const Zstringc* errorMsgNew = checkFailedRead(newFolder, conflictMsg ? conflictMsg : errorMsg);
-        this->fillOneSide<SelectSide::left>(dirLeft.second.second, errorMsgNew, newFolder); //recurse
+        addStep(&dirLeft, nullptr, MergeStep::Type::folder, conflictMsg);
+        planSubFolder(depth, plan, planGroup, [&subFolderCont = dirLeft.second.second, &planGroup](int depthSub, MergePlan& planSub)
+        { planOneSide<SelectSide::left>(subFolderCont, depthSub, planSub, planGroup); });
     },
     [&](const FolderData& dirRight, const Zstringc* conflictMsg)
     {
-        FolderPair& newFolder = output.addSubFolder<SelectSide::right>(dirRight.first, dirRight.second.first);
-        const Zstringc* errorMsgNew = checkFailedRead(newFolder, conflictMsg ? conflictMsg : errorMsg);
-        this->fillOneSide<SelectSide::right>(dirRight.second.second, errorMsgNew, newFolder); //recurse
+        addStep(nullptr, &dirRight, MergeStep::Type::folder, conflictMsg);
+        planSubFolder(depth, plan, planGroup, [&subFolderCont = dirRight.second.second, &planGroup](int depthSub, MergePlan& planSub)
+        { planOneSide<SelectSide::right>(subFolderCont, depthSub, planSub, planGroup); });
     },
     [&](const FolderData& dirLeft, const FolderData& dirRight)
     {
-        FolderPair& newFolder = output.addSubFolder(dirLeft.first, dirLeft.second.first, DIR_EQUAL, dirRight.first, dirRight.second.first);
-        const Zstringc* errorMsgNew = checkFailedRead(newFolder, errorMsg);
+        addStep(&dirLeft, &dirRight, MergeStep::Type::folder, nullptr);
+        planSubFolder(depth, plan, planGroup, [&subFolderContL = dirLeft.second.second, &subFolderContR = dirRight.second.second, &planGroup](int depthSub, MergePlan& planSub)
+        { planTwoSides(subFolderContL, subFolderContR, depthSub, planSub, planGroup); });
+    });
+}
 
-        if (!errorMsgNew)
-            if (getUnicodeNormalForm(dirLeft.first) !=
-                getUnicodeNormalForm(dirRight.first))
-                newFolder.setCategoryDiffMetadata(getDescrDiffMetaShortnameCase(newFolder));
 
-        mergeTwoSides(dirLeft.second.second, dirRight.second.second, errorMsgNew, newFolder); //recurse
-    });
+class MergeSides
+{
+public:
+    MergeSides(const std::unordered_map<ZstringNoCase, Zstringc>& errorsByRelPath,
+               size_t threadCount,
+               std::vector<FilePair*>& undefinedFilesOut,
+               std::vector<SymlinkPair*>& undefinedSymlinksOut) :
+        errorsByRelPath_(errorsByRelPath),
+        threadCount_(threadCount),
+        undefinedFiles_(undefinedFilesOut),
+        undefinedSymlinks_(undefinedSymlinksOut) {}
+
+    void execute(const FolderContainer& lhs, const FolderContainer& rhs, ContainerObject& output)
+    {
+        auto it = errorsByRelPath_.find(Zstring()); //empty path if read-error for whole base directory
+
+        MergePlan plan;
+        //caveat: declare *after* plan: worker threads are joined in ThreadGroup destructor
+        PlanThreadGroup planGroup(threadCount_, Zstr("Merge Sides"));
+
+        planTwoSides(lhs, rhs, 0 /*depth*/, plan, planGroup);
+
+        applyPlan(plan, it != errorsByRelPath_.end() ? &it->second : nullptr, output);
+    }
+
+private:
+    void applyPlan(MergePlan& plan, const Zstringc* errorMsg, ContainerObject& output);
+
+    const Zstringc* checkFailedRead(FileSystemObject& fsObj, const Zstringc* errorMsg);
+
+    const std::unordered_map<ZstringNoCase, Zstringc>& errorsByRelPath_; //base-relative paths or empty if read-error for whole base directory
+    const size_t threadCount_;
+    std::vector<FilePair*>&    undefinedFiles_;
+    std::vector<SymlinkPair*>& undefinedSymlinks_;
+};
+
+
+inline
+const Zstringc* MergeSides::checkFailedRead(FileSystemObject& fsObj, const Zstringc* errorMsg)
+{
+    if (!errorMsg && !errorsByRelPath_.empty()) //perf: skip relative path creation in the common case
+        if (const auto it = errorsByRelPath_.find(fsObj.getRelativePathAny());
+            it != errorsByRelPath_.end())
+            errorMsg = &it->second;
+
+    if (errorMsg)
+    {
+        fsObj.setActive(false);
+        fsObj.setCategoryConflict(*errorMsg); //peak memory: Zstringc is ref-counted, unlike std::string!
+        static_assert(std::is_same_v<const Zstringc&, decltype(*errorMsg)>);
+    }
+    return errorMsg;
+}
+
+
+void MergeSides::applyPlan(MergePlan& plan, const Zstringc* errorMsg, ContainerObject& output)
+{
+    using FileData    = FolderContainer::FileList   ::value_type;
+    using SymlinkData = FolderContainer::SymlinkList::value_type;
+    using FolderData  = FolderContainer::FolderList ::value_type;
+
+    struct FolderLevel
+    {
+        ContainerObject* container;
+        const Zstringc* errorMsg;
+    };
+    std::vector<FolderLevel> folderStack{{&output, errorMsg}};
+
+    auto itConflictMsg = plan.conflictMsgs.begin();
+    auto itSubTask     = plan.subTasks    .begin();
+
+    for (const MergeStep& step : plan.steps)
+    {
+        const FolderLevel level = folderStack.back();
+        const Zstringc* conflictMsg = step.ambiguousName ? &*itConflictMsg++ : nullptr;
+
+        switch (step.type)
+        {
+            case MergeStep::Type::file:
+            {
+                const auto fileL = static_cast<const FileData*>(step.itemL);
+                const auto fileR = static_cast<const FileData*>(step.itemR);
+                if (fileL && fileR)
+                {
+                    FilePair& newItem = level.container->addSubFile(fileL->first,
+                                                                    fileL->second,
+                                                                    FILE_CONFLICT, //dummy-value until categorization is finished later
+                                                                    fileR->first,
+                                                                    fileR->second);
+                    if (!checkFailedRead(newItem, level.errorMsg))
+                        undefinedFiles_.push_back(&newItem);
+                    static_assert(std::is_same_v<ContainerObject::FileList, std::list<FilePair, zen::ArenaAllocator<FilePair>>>); //ContainerObject::addSubFile() must NOT invalidate references used in "undefinedFiles"!
+                }
+                else
+                {
+                    FilePair& newItem = fileL ? level.container->addSubFile<SelectSide::left >(fileL->first, fileL->second) :
+                                        /**/    level.container->addSubFile<SelectSide::right>(fileR->first, fileR->second);
+                    checkFailedRead(newItem, conflictMsg ? conflictMsg : level.errorMsg);
+                }
+            }
+            break;
+
+            case MergeStep::Type::symlink:
+            {
+                const auto symlinkL = static_cast<const SymlinkData*>(step.itemL);
+                const auto symlinkR = static_cast<const SymlinkData*>(step.itemR);
+                if (symlinkL && symlinkR)
+                {
+                    SymlinkPair& newItem = level.container->addSubLink(symlinkL->first,
+                                                                       symlinkL->second,
+                                                                       SYMLINK_CONFLICT, //dummy-value until categorization is finished later
+                                                                       symlinkR->first,
+                                                                       symlinkR->second);
+                    if (!checkFailedRead(newItem, level.errorMsg))
+                        undefinedSymlinks_.push_back(&newItem);
+                }
+                else
+                {
+                    SymlinkPair& newItem = symlinkL ? level.container->addSubLink<SelectSide::left >(symlinkL->first, symlinkL->second) :
+                                           /**/       level.container->addSubLink<SelectSide::right>(symlinkR->first, symlinkR->second);
+                    checkFailedRead(newItem, conflictMsg ? conflictMsg : level.errorMsg);
+                }
+            }
+            break;
+
+            case MergeStep::Type::folder:
+            case MergeStep::Type::folderDeferred:
+            {
+                const auto dirL = static_cast<const FolderData*>(step.itemL);
+                const auto dirR = static_cast<const FolderData*>(step.itemR);
+
+                FolderPair* newFolder = nullptr;
+                const Zstringc* errorMsgNew = nullptr;
+                if (dirL && dirR)
+                {
+                    newFolder = &level.container->addSubFolder(dirL->first, dirL->second.first, DIR_EQUAL, dirR->first, dirR->second.first);
+                    errorMsgNew = checkFailedRead(*newFolder, level.errorMsg);
+
+                    if (!errorMsgNew)
+                        if (getUnicodeNormalForm(dirL->first) !=
+                            getUnicodeNormalForm(dirR->first))
+                            newFolder->setCategoryDiffMetadata(getDescrDiffMetaShortnameCase(*newFolder));
+                }
+                else
+                {
+                    newFolder = dirL ? &level.container->addSubFolder<SelectSide::left >(dirL->first, dirL->second.first) :
+                                /**/   &level.container->addSubFolder<SelectSide::right>(dirR->first, dirR->second.first);
+                    errorMsgNew = checkFailedRead(*newFolder, conflictMsg ? conflictMsg : level.errorMsg);
+                }
+
+                if (step.type == MergeStep::Type::folder)
+                    folderStack.push_back({newFolder, errorMsgNew});
+                else
+                {
+                    MergeTask& task = *itSubTask++;
+                    task.planDone.get_future().get(); //wait until worker thread is done
+
+                    applyPlan(task.plan, errorMsgNew, *newFolder); //recurse
+                    task.plan = {}; //release memory early
+                }
+            }
+            break;
+
+            case MergeStep::Type::folderEnd:
+                folderStack.pop_back();
+                break;
+        }
+    }
+    assert(folderStack.size() == 1 && itConflictMsg == plan.conflictMsgs.end() && itSubTask == plan.subTasks.end());
 }
 
 //-----------------------------------------------------------------------------------------------
@@ -919,7 +1405,7 @@ void stripExcludedDirectories(ContainerObject& hierObj, const PathFilter& filter
     //remove superfluous directories:
     //   this does not invalidate "std::vector<FilePair*>& undefinedFiles", since we delete folders only
     //   and there is no side-effect for memory positions of FilePair and SymlinkPair thanks to std::list!
-    static_assert(std::is_same_v<std::list<FolderPair>, ContainerObject::FolderList>);
+    static_assert(std::is_same_v<std::list<FolderPair, zen::ArenaAllocator<FolderPair>>, ContainerObject::FolderList>);
 
     hierObj.refSubFolders().remove_if([&](FolderPair& folder)
     {
@@ -939,19 +1425,16 @@ void stripExcludedDirectories(ContainerObject& hierObj, const PathFilter& filter
 //create comparison result table and fill category except for files existing on both sides: undefinedFiles and undefinedSymlinks are appended!
 std::shared_ptr<BaseFolderPair> ComparisonBuffer::performComparison(const ResolvedFolderPair& fp,
                                                                     const FolderPairCfg& fpCfg,
+                                                                    const DirectoryValue& dirValL,
+                                                                    const DirectoryValue& dirValR,
+                                                                    size_t mergeThreadCount,
                                                                     std::vector<FilePair*>& undefinedFiles,
                                                                     std::vector<SymlinkPair*>& undefinedSymlinks) const
 {
-    cb_.updateStatus(_("Generating file list...")); //throw X
-    cb_.requestUiUpdate(true /*force*/); //throw X
-
     std::unordered_map<ZstringNoCase, Zstringc> failedReads; //base-relative paths or empty if read-error for whole base directory
 
-    auto evalFolderContent = [&](const AbstractPath& folderPath) -> const FolderContainer&
+    auto evalFolderContent = [&](const DirectoryValue& dirVal) -> const FolderContainer&
     {
-        const DirectoryValue& dirVal = folderBuffer_.find({folderPath, fpCfg.filter.nameFilter, fpCfg.handleSymlinks})->second;
-        //contract: folderBuffer_ has entries for *all* folders (existing or not)
-
         //mix failedFolderReads with failedItemReads:
         //associate folder traversing errors with folder (instead of child items only) to show on GUI! See "MergeSides"
         //=> minor pessimization for "excludefilterFailedRead" which needlessly excludes parent folders, too
@@ -966,8 +1449,8 @@ std::shared_ptr<BaseFolderPair> ComparisonBuffer::performComparison(const Resolv
         return dirVal.folderCont;
     };
 
-    const FolderContainer& folderContL = evalFolderContent(fp.folderPathLeft);
-    const FolderContainer& folderContR = evalFolderContent(fp.folderPathRight);
+    const FolderContainer& folderContL = evalFolderContent(dirValL);
+    const FolderContainer& folderContR = evalFolderContent(dirValR);
 
     //*after* evalFolderContent():
     Zstring excludefilterFailedRead;
@@ -1003,9 +1486,10 @@ std::shared_ptr<BaseFolderPair> ComparisonBuffer::performComparison(const Resolv
                                                                               fpCfg.compareVar,
                                                                               fileTimeTolerance_,
                                                                               fpCfg.ignoreTimeShiftMinutes);
-    //PERF_START;
-    MergeSides(failedReads, undefinedFiles, undefinedSymlinks).execute(folderContL, folderContR, *output);
-    //PERF_STOP;
+    {
+        ZEN_TRACE_SCOPE("compare:mergeSides")
+        MergeSides(failedReads, mergeThreadCount, undefinedFiles, undefinedSymlinks).execute(folderContL, folderContR, *output);
+    }
 
     //##################### in/exclude rows according to filtering #####################
     //NOTE: we need to finish de-activating rows BEFORE binary comparison is run so that it can skip them!
@@ -1020,19 +1504,193 @@ std::shared_ptr<BaseFolderPair> ComparisonBuffer::performComparison(const Resolv
     //##################################################################################
     return output;
 }
+
+
+//FTP/SFTP: listing folders is slow (one request per folder); Google Drive is fully buffered in memory already
+bool isSlowRemoteFolder(const AbstractPath& folderPath)
+{
+    const Zstring& pathPhrase = AFS::getInitPathPhrase(folderPath);
+    return acceptsItemPathPhraseFtp(pathPhrase) || acceptsItemPathPhraseSftp(pathPhrase);
+}
+
+
+//Btrfs/ZFS: take new snapshot *before* traversal, then compare with the snapshot recorded during last sync
+std::optional<SnapshotDiff> getSnapshotChanges(const AbstractPath& folderPath, const AbstractPath& partnerPath, std::string& snapshotIdOut, PhaseCallback& callback) //throw X
+{
+    const Zstring& nativePath = getNativeItemPath(folderPath);
+    if (nativePath.empty())
+        return std::nullopt;
+    try
+    {
+        const std::optional<std::string> snapshotId = createSnapshot(nativePath); //throw FileError
+        if (!snapshotId) //not Btrfs/ZFS
+            return std::nullopt;
+        snapshotIdOut = *snapshotId;
+
+        std::optional<SnapshotDiff> diff = getSnapshotDiff(nativePath, AFS::getInitPathPhrase(partnerPath), *snapshotId); //throw FileError
+        if (diff)
+            callback.logInfo(replaceCpy(_P("Folder %y: 1 item changed since last synchronization according to the file system snapshot.",
+                                           "Folder %y: %x items changed since last synchronization according to the file system snapshot.",
+                                           diff->changedRelPaths.size() + diff->modifiedRelPaths.size()),
+                                        L"%y", fmtPath(AFS::getDisplayPath(folderPath)))); //throw X
+        return diff;
+    }
+    catch (const FileError& e) //not critical => full traversal
+    {
+        callback.logInfo(e.toString()); //throw X
+        return std::nullopt;
+    }
+}
+
+
+/*  incremental comparison: only traverse affected folders, take the rest from sync.ffs_db
+    - changes reported by the caller (e.g. RealTimeSync) for native folders
+    - remoteScanTrustDatabase: FTP/SFTP folders are assumed to be modified by FreeFileSync only => read base folder only
+    - snapshotChangeDiscovery: Btrfs/ZFS folders => read folders reported by snapshot diff only                                */
+std::map<DirectoryKey, IncrementalScan> prepareIncrementalScans(const std::vector<std::pair<ResolvedFolderPair, FolderPairCfg>>& workLoad,
+                                                                const FolderStatus& folderStatus,
+                                                                const std::vector<Zstring>& changedItemPaths, //native paths
+                                                                bool remoteScanTrustDatabase,
+                                                                bool snapshotChangeDiscovery,
+                                                                int fileTimeTolerance,
+                                                                std::map<DirectoryKey, std::string>& snapshotIds, //out
+                                                                ItemNamePool& namePool,
+                                                                PhaseCallback& callback) //throw X
+{
+    //a folder read by multiple pairs (with same filter) has no unique last synchronous state
+    std::map<DirectoryKey, size_t> folderKeyCount;
+    for (const auto& [folderPair, fpCfg] : workLoad)
+    {
+        ++folderKeyCount[DirectoryKey({folderPair.folderPathLeft,  fpCfg.filter.nameFilter, fpCfg.handleSymlinks})];
+        ++folderKeyCount[DirectoryKey({folderPair.folderPathRight, fpCfg.filter.nameFilter, fpCfg.handleSymlinks})];
+    }
+
+    struct IncrementalPair
+    {
+        std::shared_ptr<BaseFolderPair> baseFolder; //empty: only needed for loading sync.ffs_db
+        DirectoryKey folderKeyL;
+        DirectoryKey folderKeyR;
+        std::optional<SnapshotDiff> changesL; //none: full traversal
+        std::optional<SnapshotDiff> changesR; //
+    };
+    std::vector<IncrementalPair> incPairs;
+
+    for (const auto& [folderPair, fpCfg] : workLoad)
+        if (fpCfg.compareVar != CompareVariant::content && //binary comparison would read all unchanged files anyway
+            folderStatus.existing.contains(folderPair.folderPathLeft) &&
+            folderStatus.existing.contains(folderPair.folderPathRight))
+        {
+            const DirectoryKey folderKeyL({folderPair.folderPathLeft,  fpCfg.filter.nameFilter, fpCfg.handleSymlinks});
+            const DirectoryKey folderKeyR({folderPair.folderPathRight, fpCfg.filter.nameFilter, fpCfg.handleSymlinks});
+
+            const Zstring& basePathL = getNativeItemPath(folderPair.folderPathLeft); //change notifications are available for native paths only
+            const Zstring& basePathR = getNativeItemPath(folderPair.folderPathRight);
+
+            const bool nativeChanges = !changedItemPaths.empty() && !basePathL.empty() && !basePathR.empty();
+            const bool trustDbL = remoteScanTrustDatabase && isSlowRemoteFolder(folderPair.folderPathLeft);
+            const bool trustDbR = remoteScanTrustDatabase && isSlowRemoteFolder(folderPair.folderPathRight);
+
+            const bool useSnapshots = snapshotChangeDiscovery &&
+                                      fpCfg.handleSymlinks != SymLinkHandling::follow; //followed symlinks may point outside of the snapshot
+
+            if (folderKeyCount[folderKeyL] == 1 && folderKeyCount[folderKeyR] == 1 &&
+                (nativeChanges || trustDbL || trustDbR || useSnapshots))
+            {
+                std::optional<SnapshotDiff> changesL;
+                std::optional<SnapshotDiff> changesR;
+
+                if (nativeChanges)
+                {
+                    std::set<Zstring> changedRelPaths; //apply changes of either side to both sides
+                    bool baseFolderChanged = false;
+
+                    for (const Zstring& itemPath : changedItemPaths)
+                        for (const Zstring& basePath : {basePathL, basePathR})
+                        {
+                            if (equalNativePath(itemPath, basePath))
+                                baseFolderChanged = true;
+                            else if (const Zstring& basePathPf = appendSeparator(basePath);
+                                     startsWith(itemPath, basePathPf))
+                                changedRelPaths.insert(Zstring(itemPath.begin() + basePathPf.size(), itemPath.end()));
+                        }
+
+                    if (!baseFolderChanged)
+                        changesL = changesR = SnapshotDiff{{changedRelPaths.begin(), changedRelPaths.end()}, {}};
+                }
+                else
+                {
+                    if (trustDbL) changesL = SnapshotDiff();
+                    if (trustDbR) changesR = SnapshotDiff();
+                }
+
+                if (useSnapshots) //snapshot is needed for the next comparison, even if there are change notifications for this one
+                {
+                    std::optional<SnapshotDiff> snapDiffL = getSnapshotChanges(folderPair.folderPathLeft,  folderPair.folderPathRight, snapshotIds[folderKeyL], callback); //throw X
+                    std::optional<SnapshotDiff> snapDiffR = getSnapshotChanges(folderPair.folderPathRight, folderPair.folderPathLeft,  snapshotIds[folderKeyR], callback); //
+                    if (!changesL) changesL = std::move(snapDiffL);
+                    if (!changesR) changesR = std::move(snapDiffR);
+                }
+
+                if (changesL || changesR)
+                    incPairs.push_back({std::make_shared<BaseFolderPair>(folderPair.folderPathLeft,  BaseFolderStatus::existing,
+                                                                         folderPair.folderPathRight, BaseFolderStatus::existing,
+                                                                         fpCfg.filter.nameFilter,
+                                                                         fpCfg.compareVar,
+                                                                         fileTimeTolerance,
+                                                                         fpCfg.ignoreTimeShiftMinutes),
+                                        folderKeyL, folderKeyR, std::move(changesL), std::move(changesR)});
+            }
+        }
+    std::erase_if(snapshotIds, [](const auto& v) { return v.second.empty(); });
+
+    std::vector<const BaseFolderPair*> baseFolders;
+    for (const IncrementalPair& ip : incPairs)
+        baseFolders.push_back(ip.baseFolder.get());
+
+    const std::unordered_map<const BaseFolderPair*, SharedRef<const InSyncFolder>> lastSyncStates =
+        loadLastSynchronousState(baseFolders, &namePool, callback); //throw X
+
+    std::map<DirectoryKey, IncrementalScan> output;
+    for (const IncrementalPair& ip : incPairs)
+        if (auto it = lastSyncStates.find(ip.baseFolder.get());
+            it != lastSyncStates.end()) //no database => full traversal
+        {
+            if (ip.changesL) output.emplace(ip.folderKeyL, IncrementalScan{it->second, SelectSide::left,  ip.changesL->changedRelPaths, ip.changesL->modifiedRelPaths});
+            if (ip.changesR) output.emplace(ip.folderKeyR, IncrementalScan{it->second, SelectSide::right, ip.changesR->changedRelPaths, ip.changesR->modifiedRelPaths});
+        }
+
+    if (remoteScanTrustDatabase)
+        for (const auto& [folderKey, incScan] : output)
+            if (isSlowRemoteFolder(folderKey.folderPath))
+                callback.logInfo(replaceCpy(_("Folder %x is taken from the database, except for the base folder."), L"%x",
+                                            fmtPath(AFS::getDisplayPath(folderKey.folderPath)))); //throw X
+
+    if (!changedItemPaths.empty() && !output.empty())
+        callback.logInfo(_P("Incremental comparison for 1 changed item: unchanged folders are taken from the database.",
+                            "Incremental comparison for %x changed items: unchanged folders are taken from the database.", changedItemPaths.size())); //throw X
+    return output;
+}
 }
 
 
 FolderComparison fff::compare(WarningDialogs& warnings,
                               int fileTimeTolerance,
+                              bool contentCmpTrustDatabase,
+                              bool timeSizeVerifyContent,
+                              bool remoteScanTrustDatabase,
+                              bool snapshotChangeDiscovery,
+                              bool outOfCoreComparison,
                               bool allowUserInteraction,
                               bool runWithBackgroundPriority,
                               bool createDirLocks,
                               std::unique_ptr<LockHolder>& dirLocks,
                               const std::vector<FolderPairCfg>& fpCfgList,
+                              const std::map<AfsDevice, size_t>& deviceParallelOps,
+                              const std::vector<Zstring>& changedItemPaths,
+                              const OnPairCompared& onPairCompared,
                               ProcessCallback& callback)
 {
-    //PERF_START;
+    ZEN_TRACE_SCOPE_ARG("compare", fpCfgList.size())
 
     //indicator at the very beginning of the log to make sense of "total time"
     //init process: keep at beginning so that all gui elements are initialized properly
@@ -1060,7 +1718,7 @@ FolderComparison fff::compare(WarningDialogs& warnings,
         callback.logInfo(e.toString()); //throw X
     }
 
-    const ResolvedBaseFolders& resInfo = initializeBaseFolders(fpCfgList,
+    const ResolvedBaseFolders& resInfo = initializeBaseFolders(fpCfgList, deviceParallelOps,
                                                                allowUserInteraction, warnings, callback); //throw X
     //directory existence only checked *once* to avoid race conditions!
     if (resInfo.resolvedPairs.size() != fpCfgList.size())
@@ -1126,40 +1784,81 @@ FolderComparison fff::compare(WarningDialogs& warnings,
     try
     {
         FolderComparison output;
+        std::map<DirectoryKey, std::string> snapshotIds; //Btrfs/ZFS snapshots taken before traversal
+
+        //progressive display: finish CompareVariant::timeSize pairs while the rest is still being traversed
+        assert(!onPairCompared || !outOfCoreComparison); //spilling would invalidate items already displayed
+        std::vector<bool> pairsDone(workLoad.size()); //sync directions determined and reported already
+        OnPairCompared onTimeSizePairCategorized;
+        if (onPairCompared)
+            onTimeSizePairCategorized = [&](size_t pairIdx, const std::shared_ptr<BaseFolderPair>& baseFolder) //throw X
+        {
+            redetermineSyncDirection({{baseFolder.get(), fpCfgList[pairIdx].directionCfg}},
+                                     nullptr /*buf*/, callback); //throw X
+            pairsDone[pairIdx] = true;
+            onPairCompared(pairIdx, baseFolder); //throw X
+        };
         //reduce peak memory by restricting lifetime of ComparisonBuffer to have ended when loading potentially huge InSyncFolder instance in redetermineSyncDirection()
         {
-            //------------------- fill directory buffer: traverse/read folders --------------------------
-            std::set<DirectoryKey> folderKeys;
-            for (const auto& [folderPair, fpCfg] : workLoad)
-            {
-                folderKeys.emplace(DirectoryKey({folderPair.folderPathLeft,  fpCfg.filter.nameFilter, fpCfg.handleSymlinks}));
-                folderKeys.emplace(DirectoryKey({folderPair.folderPathRight, fpCfg.filter.nameFilter, fpCfg.handleSymlinks}));
-            }
+            //share item names between left/right sides and sync.ffs_db: names stay shared (ref-counted) after the pool is gone
+            ItemNamePool namePool;
+
+            std::map<DirectoryKey, IncrementalScan> incrementalScans;
+            if (!changedItemPaths.empty() || remoteScanTrustDatabase || snapshotChangeDiscovery)
+                incrementalScans = prepareIncrementalScans(workLoad, resInfo.baseFolderStatus, changedItemPaths, remoteScanTrustDatabase, snapshotChangeDiscovery,
+                                                           fileTimeTolerance, snapshotIds, namePool, callback); //throw X
 
+            //------------------- fill directory buffer: traverse/read folders --------------------------
             //PERF_START;
-            ComparisonBuffer cmpBuff(folderKeys,
+            ComparisonBuffer cmpBuff(workLoad,
                                      resInfo.baseFolderStatus,
-                                     fileTimeTolerance, callback);
+                                     fileTimeTolerance,
+                                     contentCmpTrustDatabase,
+                                     timeSizeVerifyContent,
+                                     deviceParallelOps,
+                                     incrementalScans, namePool, onTimeSizePairCategorized, callback);
             //PERF_STOP;
 
             //process binary comparison as one junk
-            std::vector<std::pair<ResolvedFolderPair, FolderPairCfg>> workLoadByContent;
-            for (const auto& [folderPair, fpCfg] : workLoad)
-                if (fpCfg.compareVar == CompareVariant::content)
-                    workLoadByContent.push_back({folderPair, fpCfg});
+            std::vector<size_t> workLoadByContent;
+            std::vector<size_t> workLoadByTimeSize;
+            std::vector<size_t> workLoadBySize;
+            for (size_t i = 0; i < workLoad.size(); ++i)
+                switch (workLoad[i].second.compareVar)
+                {
+                    case CompareVariant::timeSize:
+                        workLoadByTimeSize.push_back(i);
+                        break;
+                    case CompareVariant::size:
+                        workLoadBySize.push_back(i);
+                        break;
+                    case CompareVariant::content:
+                        workLoadByContent.push_back(i);
+                        break;
+                }
 
             std::vector<std::shared_ptr<BaseFolderPair>> outputByContent = cmpBuff.compareByContent(workLoadByContent);
             auto itOByC = outputByContent.begin();
 
+            std::vector<std::shared_ptr<BaseFolderPair>> outputByTimeSize = cmpBuff.compareByTimeSize(workLoadByTimeSize);
+            auto itOByTS = outputByTimeSize.begin();
+
+            std::vector<std::shared_ptr<BaseFolderPair>> outputBySize = cmpBuff.compareBySize(workLoadBySize);
+            auto itOByS = outputBySize.begin();
+
             //write output in expected order
-            for (const auto& [folderPair, fpCfg] : workLoad)
-                switch (fpCfg.compareVar)
+            for (size_t i = 0; i < workLoad.size(); ++i)
+                switch (workLoad[i].second.compareVar)
                 {
                     case CompareVariant::timeSize:
-                        output.push_back(cmpBuff.compareByTimeSize(folderPair, fpCfg));
+                        assert(itOByTS != outputByTimeSize.end());
+                        if (itOByTS != outputByTimeSize.end())
+                            output.push_back(*itOByTS++);
                         break;
                     case CompareVariant::size:
-                        output.push_back(cmpBuff.compareBySize(folderPair, fpCfg));
+                        assert(itOByS != outputBySize.end());
+                        if (itOByS != outputBySize.end())
+                            output.push_back(*itOByS++);
                         break;
                     case CompareVariant::content:
                         assert(itOByC != outputByContent.end());
@@ -1170,13 +1869,41 @@ FolderComparison fff::compare(WarningDialogs& warnings,
         }
         assert(output.size() == fpCfgList.size());
 
+        //record snapshots after sync.ffs_db was saved: see synchronize()
+        for (size_t i = 0; i < output.size(); ++i)
+        {
+            const auto& [folderPair, fpCfg] = workLoad[i];
+            if (auto it = snapshotIds.find(DirectoryKey({folderPair.folderPathLeft,  fpCfg.filter.nameFilter, fpCfg.handleSymlinks})); it != snapshotIds.end())
+                output[i]->setSnapshotId<SelectSide::left>(it->second);
+            if (auto it = snapshotIds.find(DirectoryKey({folderPair.folderPathRight, fpCfg.filter.nameFilter, fpCfg.handleSymlinks})); it != snapshotIds.end())
+                output[i]->setSnapshotId<SelectSide::right>(it->second);
+        }
+
+        //free memory before loading sync.ffs_db: sub trees without changes are needed again only when saving it
+        if (outOfCoreComparison)
+            for (const std::shared_ptr<BaseFolderPair>& baseFolder : output)
+                try
+                {
+                    if (const size_t itemCount = spillInSyncSubTrees(*baseFolder); //throw FileError
+                        itemCount > 0)
+                        callback.logInfo(_P("Moved 1 item without changes to a temporary file.",
+                                            "Moved %x items without changes to a temporary file.", itemCount)); //throw X
+                }
+                catch (const FileError& e) { callback.logInfo(e.toString()); } //throw X; not fatal: keep in memory
+
         //--------- set initial sync-direction --------------------------------------------------
         std::vector<std::pair<BaseFolderPair*, SyncDirectionConfig>> directCfgs;
-        for (auto it = output.begin(); it != output.end(); ++it)
-            directCfgs.emplace_back(&** it, fpCfgList[it - output.begin()].directionCfg);
+        for (size_t i = 0; i < output.size(); ++i)
+            if (!pairsDone[i])
+                directCfgs.emplace_back(output[i].get(), fpCfgList[i].directionCfg);
 
         redetermineSyncDirection(directCfgs,
-                                 callback); //throw X
+                                 nullptr /*buf*/, callback); //throw X
+
+        if (onPairCompared)
+            for (size_t i = 0; i < output.size(); ++i)
+                if (!pairsDone[i])
+                    onPairCompared(i, output[i]); //throw X
 
         return output;
     }
@@ -46,14 +46,26 @@ struct FolderPairCfg
 
 std::vector<FolderPairCfg> extractCompareCfg(const MainConfiguration& mainCfg); //fill FolderPairCfg and resolve folder pairs
 
+//progressive display: called (main thread) for each folder pair as soon as categories and sync directions are final, in order of completion
+// => CompareVariant::timeSize: while other pairs are still being traversed; others: after the complete comparison
+using OnPairCompared = std::function<void(size_t pairIdx, const std::shared_ptr<BaseFolderPair>& baseFolder)>; //throw X
+
 //FFS core routine:     output.size() == fpCfgList.size() or 0 on fatal error
 FolderComparison compare(WarningDialogs& warnings,
                          int fileTimeTolerance,
+                         bool contentCmpTrustDatabase, //CompareVariant::content: skip files found equal during last sync if unchanged (file ID, time, size)
+                         bool timeSizeVerifyContent,   //CompareVariant::timeSize: compare content of same-size files with different time => equal: FILE_DIFFERENT_METADATA
+                         bool remoteScanTrustDatabase, //FTP/SFTP: take sub folders from sync.ffs_db instead of traversing (only FreeFileSync modifies them)
+                         bool snapshotChangeDiscovery, //Btrfs/ZFS: read only folders with changes according to file system snapshots, take the rest from sync.ffs_db
+                         bool outOfCoreComparison, //move sub trees without changes to a temporary file: not for the GUI grid!
                          bool allowUserInteraction,
                          bool runWithBackgroundPriority,
                          bool createDirLocks,
                          std::unique_ptr<LockHolder>& dirLocks, //out
                          const std::vector<FolderPairCfg>& fpCfgList,
+                         const std::map<AfsDevice, size_t>& deviceParallelOps,
+                         const std::vector<Zstring>& changedItemPaths, //optional: incremental comparison; native paths of items changed since last sync
+                         const OnPairCompared& onPairCompared, //optional: progressive display; not together with outOfCoreComparison!
                          ProcessCallback& callback);
 }
 
@@ -8,11 +8,16 @@
 #include <bit> //std::endian
 #include <zen/guid.h>
 #include <zen/crc.h>
+#include <zen/perf.h>
 #include <zen/build_info.h>
 #include <zen/zlib_wrap.h>
+#ifdef HAVE_ZSTD
+    #include <zen/zstd_wrap.h>
+#endif
 #include "../afs/concrete.h"
 #include "../afs/native.h"
 #include "status_handler_impl.h"
+#include "memory_stats.h"
 
 
 using namespace zen;
@@ -24,7 +29,26 @@ namespace
 //-------------------------------------------------------------------------------------------------------------------------------
 const char DB_FILE_DESCR[] = "FreeFileSync";
 const int DB_FILE_VERSION   = 11; //2020-02-07
-const int DB_STREAM_VERSION =  4; //2021-02-14
+const int DB_STREAM_VERSION =  6; //2026-10-14: varint + delta encoding
+
+const char DB_JOURNAL_DESCR[] = "FreeFileSync Journal";
+const int DB_JOURNAL_VERSION = 1; //2026-10-14
+
+const uint32_t DB_JOURNAL_SAVES_MAX = 100; //compact journal into a full database file after this many syncs...
+const double DB_JOURNAL_SIZE_RATIO_MAX = 0.25; //...or if the journal grows above this fraction of the database size
+//-------------------------------------------------------------------------------------------------------------------------------
+
+enum class DbStreamCodec : int8_t //stream version 5+: recorded in the header; don't change existing values!
+{
+    zlib = 0,
+    zstd = 1, //requires HAVE_ZSTD
+};
+
+#ifdef HAVE_ZSTD
+const DbStreamCodec DB_STREAM_CODEC = DbStreamCodec::zstd;
+#else
+const DbStreamCodec DB_STREAM_CODEC = DbStreamCodec::zlib;
+#endif
 //-------------------------------------------------------------------------------------------------------------------------------
 
 DEFINE_NEW_FILE_ERROR(FileErrorDatabaseNotExisting)
@@ -45,6 +69,33 @@ using DbStreams = std::unordered_map<UniqueId, SessionData>; //list of streams b
   | ensure 32/64 bit portability: use fixed size data types only e.g. uint32_t |
   ------------------------------------------------------------------------------*/
 
+/* journal: changes since the last full database save ("snapshot")
+    - each side stores the complete journal: usually just a few KB
+    - one journal per snapshot session: a base folder may be part of multiple folder pairs
+    - if one side fails to save, left and right journal IDs differ => journal is ignored, fall back to the (older) snapshot */
+struct JournalData
+{
+    UniqueId journalID; //identical for left and right journal file
+    bool isLeadStream = false;
+    uint32_t saveCount   = 0; //number of syncs recorded since the snapshot
+    uint64_t recordCount = 0;
+    DbStreamCodec codec = DbStreamCodec::zlib;
+    std::string recordsCompressed;
+};
+
+using DbJournals = std::unordered_map<UniqueId, JournalData>; //journal by snapshot session GUID
+
+enum class JournalOp : int8_t //don't change existing values!
+{
+    setFile       = 0,
+    setSymlink    = 1,
+    setFolder     = 2,
+    removeFile    = 3,
+    removeSymlink = 4,
+    removeFolder  = 5,
+};
+
+
 template <SelectSide side> inline
 AbstractPath getDatabaseFilePath(const BaseFolderPair& baseFolder)
 {
@@ -62,50 +113,76 @@ AbstractPath getDatabaseFilePath(const BaseFolderPair& baseFolder)
     return AFS::appendRelPath(baseFolder.getAbstractPath<side>(), dbName + SYNC_DB_FILE_ENDING);
 }
 
-//#######################################################################################################################################
 
-void saveStreams(const DbStreams& streamList, const AbstractPath& dbPath, const IoCallback& notifyUnbufferedIO /*throw X*/) //throw FileError, X
+template <SelectSide side> inline
+AbstractPath getJournalFilePath(const BaseFolderPair& baseFolder)
 {
-    MemoryStreamOut<std::string> memStreamOut;
+    const Zstring journalName = Zstr(".sync.journal"); //keep SYNC_DB_FILE_ENDING: excluded from comparison and ignored by RealTimeSync
+    return AFS::appendRelPath(baseFolder.getAbstractPath<side>(), journalName + SYNC_DB_FILE_ENDING);
+}
 
-    //write FreeFileSync file identifier
-    writeArray(memStreamOut, DB_FILE_DESCR, sizeof(DB_FILE_DESCR));
+//#######################################################################################################################################
 
-    //save file format version
-    writeNumber<int32_t>(memStreamOut, DB_FILE_VERSION);
+std::string compressDbStream(const std::string& stream) //throw SysError
+{
+#ifdef HAVE_ZSTD
+    /* zstd level 3: much faster than zlib level 3 at comparable size
+       worker threads only kick in for large streams (zstd splits input into jobs of several MB) */
+    return compressZstd(stream, 3 /*level*/, static_cast<int>(std::min(std::thread::hardware_concurrency(), 4U)) /*threadCount*/); //throw SysError
+#else
+    /* Zlib: optimal level - test case 1 million files
+    level|size [MB]|time [ms]
+      0    49.54      272 (uncompressed)
+      1    14.53     1013
+      2    14.13     1106
+      3    13.76     1288 - best compromise between speed and compression
+      4    13.20     1526
+      5    12.73     1916
+      6    12.58     2765
+      7    12.54     3633
+      8    12.51     9032
+      9    12.50    19698 (maximal compression) */
+    return compress(stream, 3 /*level*/); //throw SysError
+#endif
+}
 
-    //write stream list
-    writeNumber(memStreamOut, static_cast<uint32_t>(streamList.size()));
 
-    for (const auto& [sessionID, sessionData] : streamList)
+std::string decompressDbStream(const std::string& stream, DbStreamCodec codec) //throw SysError
+{
+    switch (codec)
     {
-        writeContainer<std::string>(memStreamOut, sessionID);
-
-        writeNumber<int8_t>(memStreamOut, sessionData.isLeadStream);
-        writeContainer     (memStreamOut, sessionData.rawStream);
+        case DbStreamCodec::zlib:
+            return decompress(stream); //throw SysError
+        case DbStreamCodec::zstd:
+#ifdef HAVE_ZSTD
+            return decompressZstd(stream); //throw SysError
+#else
+            break; //database written by a build with zstd support
+#endif
     }
+    throw SysError(_("Unsupported data format.") + L" (codec: " + numberTo<std::wstring>(static_cast<int>(codec)) + L')');
+}
 
-    writeNumber<uint32_t>(memStreamOut, getCrc32(memStreamOut.ref()));
-    //------------------------------------------------------------------------------------------------------------------------
+//#######################################################################################################################################
 
+void saveDbFile(const std::string& byteStream, const AbstractPath& dbPath, const IoCallback& notifyUnbufferedIO /*throw X*/) //throw FileError, X
+{
     //already existing: undefined behavior! (e.g. fail/overwrite/auto-rename)
     const std::unique_ptr<AFS::OutputStream> fileStreamOut = AFS::getOutputStream(dbPath, //throw FileError
-                                                                                  memStreamOut.ref().size(),
+                                                                                  byteStream.size(),
                                                                                   std::nullopt /*modTime*/,
                                                                                   notifyUnbufferedIO /*throw X*/);
-    fileStreamOut->write(memStreamOut.ref().c_str(), memStreamOut.ref().size()); //throw FileError, X
-    fileStreamOut->finalize();                                                   //throw FileError, X
-
+    fileStreamOut->write(byteStream.c_str(), byteStream.size()); //throw FileError, X
+    fileStreamOut->finalize();                                   //throw FileError, X
 }
 
 
-DbStreams loadStreams(const AbstractPath& dbPath, const IoCallback& notifyUnbufferedIO /*throw X*/) //throw FileError, FileErrorDatabaseNotExisting, X
+std::string loadDbFile(const AbstractPath& dbPath, const IoCallback& notifyUnbufferedIO /*throw X*/) //throw FileError, FileErrorDatabaseNotExisting, X
 {
-    std::string byteStream;
     try
     {
         const std::unique_ptr<AFS::InputStream> fileStreamIn = AFS::getInputStream(dbPath, notifyUnbufferedIO); //throw FileError, ErrorFileLocked
-        byteStream = bufferedLoad<std::string>(*fileStreamIn); //throw FileError, ErrorFileLocked, X
+        return bufferedLoad<std::string>(*fileStreamIn); //throw FileError, ErrorFileLocked, X
     }
     catch (const FileError& e)
     {
@@ -120,10 +197,44 @@ DbStreams loadStreams(const AbstractPath& dbPath, const IoCallback& notifyUnbuff
         else
             throw;
     }
+}
+
+
+void saveStreams(const DbStreams& streamList, const AbstractPath& dbPath, const IoCallback& notifyUnbufferedIO /*throw X*/) //throw FileError, X
+{
+    MemoryStreamOut<std::string> memStreamOut;
+
+    //write FreeFileSync file identifier
+    writeArray(memStreamOut, DB_FILE_DESCR, sizeof(DB_FILE_DESCR));
+
+    //save file format version
+    writeNumber<int32_t>(memStreamOut, DB_FILE_VERSION);
+
+    //write stream list
+    writeNumber(memStreamOut, static_cast<uint32_t>(streamList.size()));
+
+    for (const auto& [sessionID, sessionData] : streamList)
+    {
+        writeContainer<std::string>(memStreamOut, sessionID);
+
+        writeNumber<int8_t>(memStreamOut, sessionData.isLeadStream);
+        writeContainer     (memStreamOut, sessionData.rawStream);
+    }
+
+    writeNumber<uint32_t>(memStreamOut, getCrc32(memStreamOut.ref()));
+    //------------------------------------------------------------------------------------------------------------------------
+
+    saveDbFile(memStreamOut.ref(), dbPath, notifyUnbufferedIO); //throw FileError, X
+}
+
+
+DbStreams loadStreams(const AbstractPath& dbPath, const IoCallback& notifyUnbufferedIO /*throw X*/) //throw FileError, FileErrorDatabaseNotExisting, X
+{
+    const std::string byteStream = loadDbFile(dbPath, notifyUnbufferedIO); //throw FileError, FileErrorDatabaseNotExisting, X
     //------------------------------------------------------------------------------------------------------------------------
     try
     {
-        MemoryStreamIn memStreamIn(byteStream);
+        MemoryStreamIn<std::string_view> memStreamIn(byteStream); //perf: don't copy complete database file
 
         char formatDescr[sizeof(DB_FILE_DESCR)] = {};
         readArray(memStreamIn, formatDescr, sizeof(formatDescr)); //throw SysErrorUnexpectedEos
@@ -184,6 +295,98 @@ DbStreams loadStreams(const AbstractPath& dbPath, const IoCallback& notifyUnbuff
     }
 }
 
+
+void saveJournals(const DbJournals& journals, const AbstractPath& journalPath, const IoCallback& notifyUnbufferedIO /*throw X*/) //throw FileError, X
+{
+    MemoryStreamOut<std::string> memStreamOut;
+
+    writeArray(memStreamOut, DB_JOURNAL_DESCR, sizeof(DB_JOURNAL_DESCR));
+    writeNumber<int32_t>(memStreamOut, DB_JOURNAL_VERSION);
+
+    writeNumber(memStreamOut, static_cast<uint32_t>(journals.size()));
+
+    for (const auto& [sessionID, journal] : journals)
+    {
+        writeContainer<std::string>(memStreamOut, sessionID);
+        writeContainer<std::string>(memStreamOut, journal.journalID);
+
+        writeNumber<int8_t  >(memStreamOut, journal.isLeadStream);
+        writeNumber<uint32_t>(memStreamOut, journal.saveCount);
+        writeNumber<uint64_t>(memStreamOut, journal.recordCount);
+        writeNumber<int8_t  >(memStreamOut, static_cast<int8_t>(journal.codec));
+        writeContainer       (memStreamOut, journal.recordsCompressed);
+    }
+
+    writeNumber<uint32_t>(memStreamOut, getCrc32(memStreamOut.ref()));
+
+    saveDbFile(memStreamOut.ref(), journalPath, notifyUnbufferedIO); //throw FileError, X
+}
+
+
+DbJournals loadJournals(const AbstractPath& journalPath, const IoCallback& notifyUnbufferedIO /*throw X*/) //throw FileError, FileErrorDatabaseNotExisting, X
+{
+    const std::string byteStream = loadDbFile(journalPath, notifyUnbufferedIO); //throw FileError, FileErrorDatabaseNotExisting, X
+    try
+    {
+        MemoryStreamIn<std::string_view> memStreamIn(byteStream);
+
+        char formatDescr[sizeof(DB_JOURNAL_DESCR)] = {};
+        readArray(memStreamIn, formatDescr, sizeof(formatDescr)); //throw SysErrorUnexpectedEos
+
+        if (!std::equal(DB_JOURNAL_DESCR, DB_JOURNAL_DESCR + sizeof(DB_JOURNAL_DESCR), formatDescr))
+            throw SysError(_("File content is corrupted.") + L" (invalid header)");
+
+        const int version = readNumber<int32_t>(memStreamIn); //throw SysErrorUnexpectedEos
+        if (version != DB_JOURNAL_VERSION)
+            throw SysError(_("Unsupported data format.") + L' ' + replaceCpy(_("Version: %x"), L"%x", numberTo<std::wstring>(version)));
+
+        assert(byteStream.size() >= sizeof(uint32_t)); //obviously in this context!
+        MemoryStreamOut<std::string> crcStreamOut;
+        writeNumber<uint32_t>(crcStreamOut, getCrc32(byteStream.begin(), byteStream.end() - sizeof(uint32_t)));
+
+        if (!endsWith(byteStream, crcStreamOut.ref()))
+            throw SysError(_("File content is corrupted.") + L" (invalid checksum)");
+
+        DbJournals output;
+
+        size_t journalCount = readNumber<uint32_t>(memStreamIn); //throw SysErrorUnexpectedEos
+        while (journalCount-- != 0)
+        {
+            std::string sessionID = readContainer<std::string>(memStreamIn); //throw SysErrorUnexpectedEos
+
+            JournalData journal;
+            journal.journalID         = readContainer<std::string>(memStreamIn);                      //throw SysErrorUnexpectedEos
+            journal.isLeadStream      = readNumber<int8_t  >(memStreamIn) != 0;                       //
+            journal.saveCount         = readNumber<uint32_t>(memStreamIn);                            //
+            journal.recordCount       = readNumber<uint64_t>(memStreamIn);                            //
+            journal.codec             = static_cast<DbStreamCodec>(readNumber<int8_t>(memStreamIn)); //
+            journal.recordsCompressed = readContainer<std::string>(memStreamIn);                      //
+
+            output[sessionID] = std::move(journal);
+        }
+        return output;
+    }
+    catch (const SysError& e)
+    {
+        throw FileError(replaceCpy(_("Cannot read database file %x."), L"%x", fmtPath(AFS::getDisplayPath(journalPath))), e.toString());
+    }
+}
+
+
+//journal is usable only if both sides were saved during the same sync
+const JournalData* findCommonJournal(const DbJournals& journalsL, const DbJournals& journalsR, const UniqueId& sessionID)
+{
+    auto itL = journalsL.find(sessionID);
+    auto itR = journalsR.find(sessionID);
+
+    if (itL != journalsL.end() &&
+        itR != journalsR.end() &&
+        itL->second.journalID    == itR->second.journalID &&
+        itL->second.isLeadStream != itR->second.isLeadStream)
+        return &itL->second;
+    return nullptr;
+}
+
 //#######################################################################################################################################
 
 class StreamGenerator
@@ -201,23 +404,14 @@ public:
         writeNumber<int32_t>(outL, DB_STREAM_VERSION);
         writeNumber<int32_t>(outR, DB_STREAM_VERSION);
 
+        writeNumber<int8_t>(outL, static_cast<int8_t>(DB_STREAM_CODEC));
+        writeNumber<int8_t>(outR, static_cast<int8_t>(DB_STREAM_CODEC));
+
         auto compStream = [&](const std::string& stream) //throw FileError
         {
             try
             {
-                /* Zlib: optimal level - test case 1 million files
-                level|size [MB]|time [ms]
-                  0    49.54      272 (uncompressed)
-                  1    14.53     1013
-                  2    14.13     1106
-                  3    13.76     1288 - best compromise between speed and compression
-                  4    13.20     1526
-                  5    12.73     1916
-                  6    12.58     2765
-                  7    12.54     3633
-                  8    12.51     9032
-                  9    12.50    19698 (maximal compression) */
-                return compress(stream, 3 /*level*/); //throw SysError
+                return compressDbStream(stream); //throw SysError
             }
             catch (const SysError& e)
             {
@@ -226,13 +420,23 @@ public:
         };
 
         StreamGenerator generator;
-        //PERF_START
-        generator.recurse(dbFolder);
-        //PERF_STOP
+        {
+            ZEN_TRACE_SCOPE("db:generateStreams")
+            generator.recurse(dbFolder);
+        }
+
+        //compress streams in parallel: zlib is single-threaded, and even zstd doesn't multi-thread small streams
+        std::future<std::string> ftText     = runAsync([&] { return compStream(generator.streamOutText_    .ref()); });
+        std::future<std::string> ftSmallNum = runAsync([&] { return compStream(generator.streamOutSmallNum_.ref()); });
+        std::future<std::string> ftBigNum   = runAsync([&] { return compStream(generator.streamOutBigNum_  .ref()); });
 
-        const std::string bufText     = compStream(generator.streamOutText_    .ref());
-        const std::string bufSmallNum = compStream(generator.streamOutSmallNum_.ref());
-        const std::string bufBigNum   = compStream(generator.streamOutBigNum_  .ref());
+        ftText    .wait(); //[!] don't leave scope while detached threads are still referencing "generator"
+        ftSmallNum.wait(); //
+        ftBigNum  .wait(); //
+
+        const std::string bufText     = ftText    .get(); //throw FileError
+        const std::string bufSmallNum = ftSmallNum.get(); //
+        const std::string bufBigNum   = ftBigNum  .get(); //
 
         MemoryStreamOut<std::string> streamOut;
         writeContainer(streamOut, bufText);
@@ -258,50 +462,87 @@ public:
 private:
     void recurse(const InSyncFolder& container)
     {
-        writeNumber<uint32_t>(streamOutSmallNum_, static_cast<uint32_t>(container.files.size()));
+        writeVarInt<uint32_t>(streamOutSmallNum_, static_cast<uint32_t>(container.files   .size()));
+        writeVarInt<uint32_t>(streamOutSmallNum_, static_cast<uint32_t>(container.symlinks.size()));
+        writeVarInt<uint32_t>(streamOutSmallNum_, static_cast<uint32_t>(container.folders .size()));
+
+        //modification times are stored as delta to the folder's median: usually few bytes instead of 8
+        int64_t modTimeBase = 0;
+        if (!container.files.empty() || !container.symlinks.empty())
+        {
+            modTimeBase = getMedianModTime(container);
+            writeVarInt<int64_t>(streamOutBigNum_, modTimeBase);
+        }
+
         for (const auto& [itemName, inSyncData] : container.files)
         {
             writeItemName(itemName.normStr);
-            writeNumber(streamOutSmallNum_, static_cast<int32_t>(inSyncData.cmpVar));
-            writeNumber<uint64_t>(streamOutSmallNum_, inSyncData.fileSize);
+            writeVarInt<int32_t >(streamOutSmallNum_, static_cast<int32_t>(inSyncData.cmpVar));
+            writeVarInt<uint64_t>(streamOutSmallNum_, inSyncData.fileSize);
 
-            writeFileDescr(inSyncData.left);
-            writeFileDescr(inSyncData.right);
+            writeModTimes(modTimeBase, inSyncData.left.modTime, inSyncData.right.modTime);
+            writeFilePrint(lastFilePrintL_, inSyncData.left .filePrint);
+            writeFilePrint(lastFilePrintR_, inSyncData.right.filePrint);
         }
 
-        writeNumber<uint32_t>(streamOutSmallNum_, static_cast<uint32_t>(container.symlinks.size()));
         for (const auto& [itemName, inSyncData] : container.symlinks)
         {
             writeItemName(itemName.normStr);
-            writeNumber(streamOutSmallNum_, static_cast<int32_t>(inSyncData.cmpVar));
+            writeVarInt<int32_t>(streamOutSmallNum_, static_cast<int32_t>(inSyncData.cmpVar));
 
-            writeNumber<int64_t>(streamOutBigNum_, inSyncData.left .modTime);
-            writeNumber<int64_t>(streamOutBigNum_, inSyncData.right.modTime);
+            writeModTimes(modTimeBase, inSyncData.left.modTime, inSyncData.right.modTime);
         }
 
-        writeNumber<uint32_t>(streamOutSmallNum_, static_cast<uint32_t>(container.folders.size()));
         for (const auto& [itemName, inSyncData] : container.folders)
         {
             writeItemName(itemName.normStr);
-            writeNumber<int32_t>(streamOutSmallNum_, inSyncData.status);
+            writeVarInt<int32_t>(streamOutSmallNum_, inSyncData.status);
 
             recurse(inSyncData);
         }
     }
 
-    void writeItemName(const Zstring& str) { writeContainer(streamOutText_, utfTo<std::string>(str)); }
+    static int64_t getMedianModTime(const InSyncFolder& container)
+    {
+        std::vector<int64_t> modTimes;
+        modTimes.reserve(container.files.size() + container.symlinks.size());
 
-    void writeFileDescr(const InSyncDescrFile& descr)
+        for (const auto& [itemName, inSyncData] : container.files)
+            modTimes.push_back(inSyncData.left.modTime);
+        for (const auto& [itemName, inSyncData] : container.symlinks)
+            modTimes.push_back(inSyncData.left.modTime);
+
+        auto itMedian = modTimes.begin() + modTimes.size() / 2;
+        std::nth_element(modTimes.begin(), itMedian, modTimes.end());
+        return *itMedian;
+    }
+
+    void writeItemName(const Zstring& str)
     {
-        writeNumber<int64_t         >(streamOutBigNum_, descr.modTime);
-        writeNumber<AFS::FingerPrint>(streamOutBigNum_, descr.filePrint);
-        static_assert(sizeof(descr.modTime) <= sizeof(int64_t)); //ensure cross-platform compatibility!
+        const std::string& itemName = utfTo<std::string>(str);
+        writeVarInt<uint32_t>(streamOutText_, static_cast<uint32_t>(itemName.size()));
+        writeArray(streamOutText_, itemName.c_str(), itemName.size());
+    }
+
+    //left side relative to folder median, right side relative to left side (the same in the common case anyway, or off by FAT precision)
+    void writeModTimes(int64_t modTimeBase, time_t modTimeL, time_t modTimeR)
+    {
+        static_assert(sizeof(modTimeL) <= sizeof(int64_t)); //ensure cross-platform compatibility!
+        writeVarInt<int64_t>(streamOutBigNum_, static_cast<int64_t>(static_cast<uint64_t>(modTimeL) - static_cast<uint64_t>(modTimeBase))); //no signed overflow UB for corrupt/extreme times
+        writeVarInt<int64_t>(streamOutBigNum_, static_cast<int64_t>(static_cast<uint64_t>(modTimeR) - static_cast<uint64_t>(modTimeL)));    //
+    }
+
+    //file IDs of the same folder (or created within the same sync) are usually close to each other => delta to previous file on same side
+    void writeFilePrint(AFS::FingerPrint& lastFilePrint, AFS::FingerPrint filePrint)
+    {
+        writeVarInt<int64_t>(streamOutBigNum_, static_cast<int64_t>(filePrint - lastFilePrint)); //wrap-around is fine: reversed when parsing
+        lastFilePrint = filePrint;
     }
 
     /* maximize zlib compression by grouping similar data (=> 20% size reduction!)
          -> further ~5% reduction possible by having one container per data type
 
-       other ideas: - avoid left/right side interleaving in writeFileDescr()              => pessimization!
+       other ideas: - avoid left/right side interleaving in writeModTimes()              => pessimization!
                     - convert CompareVariant/InSyncStatus to "enum : unsigned char"       => only 0,4% size reduction!
                     - split up writeItemName() to use streamOutSmallNum_ + streamOutText_ => pessimization!
                     - use null-termination in writeItemName()                             => 5% size reduction (embedded zeros impossible?)
@@ -310,6 +551,9 @@ private:
     MemoryStreamOut<std::string> streamOutText_;     //
     MemoryStreamOut<std::string> streamOutSmallNum_; //data with bias to lead side (= always left in this context)
     MemoryStreamOut<std::string> streamOutBigNum_;   //
+
+    AFS::FingerPrint lastFilePrintL_ = 0;
+    AFS::FingerPrint lastFilePrintR_ = 0;
 };
 
 
@@ -320,12 +564,13 @@ public:
                                            const std::string& streamL,
                                            const std::string& streamR,
                                            const std::wstring& displayFilePathL, //for diagnostics only
-                                           const std::wstring& displayFilePathR)
+                                           const std::wstring& displayFilePathR,
+                                           ItemNamePool* namePool) //optional
     {
         try
         {
-            MemoryStreamIn streamInL(streamL);
-            MemoryStreamIn streamInR(streamR);
+            MemoryStreamIn<std::string_view> streamInL(streamL); //perf: avoid copying the (big) raw streams
+            MemoryStreamIn<std::string_view> streamInR(streamR); //
 
             const int streamVersion  = readNumber<int32_t>(streamInL); //throw SysErrorUnexpectedEos
             const int streamVersionR = readNumber<int32_t>(streamInR); //
@@ -344,8 +589,8 @@ public:
                 if (has1stPartL != leadStreamLeft)
                     throw SysError(_("File content is corrupted.") + L" (has1stPartL != leadStreamLeft)");
 
-                MemoryStreamIn<std::string>& in1stPart = leadStreamLeft ? streamInL : streamInR;
-                MemoryStreamIn<std::string>& in2ndPart = leadStreamLeft ? streamInR : streamInL;
+                MemoryStreamIn<std::string_view>& in1stPart = leadStreamLeft ? streamInL : streamInR;
+                MemoryStreamIn<std::string_view>& in2ndPart = leadStreamLeft ? streamInR : streamInL;
 
                 const size_t size1stPart = static_cast<size_t>(readNumber<uint64_t>(in1stPart));
                 const size_t size2ndPart = static_cast<size_t>(readNumber<uint64_t>(in2ndPart));
@@ -365,28 +610,48 @@ public:
                 return output;
             }
             else if (streamVersion == 3 || //TODO: remove migration code at some time! 2021-02-14
+                     streamVersion == 4 || //zlib-only
+                     streamVersion == 5 || //TODO: remove migration code at some time! 2026-10-14
                      streamVersion == DB_STREAM_VERSION)
             {
-                MemoryStreamIn<std::string>& streamInPart1 = leadStreamLeft ? streamInL : streamInR;
-                MemoryStreamIn<std::string>& streamInPart2 = leadStreamLeft ? streamInR : streamInL;
+                DbStreamCodec codec = DbStreamCodec::zlib;
+                if (streamVersion >= 5)
+                {
+                    const int8_t codecL = readNumber<int8_t>(streamInL); //throw SysErrorUnexpectedEos
+                    const int8_t codecR = readNumber<int8_t>(streamInR); //
+                    if (codecL != codecR)
+                        throw SysError(_("File content is corrupted.") + L" (different stream codecs)");
+
+                    codec = static_cast<DbStreamCodec>(codecL);
+                }
+
+                MemoryStreamIn<std::string_view>& streamInPart1 = leadStreamLeft ? streamInL : streamInR;
+                MemoryStreamIn<std::string_view>& streamInPart2 = leadStreamLeft ? streamInR : streamInL;
 
                 const size_t sizePart1 = static_cast<size_t>(readNumber<uint64_t>(streamInPart1));
                 const size_t sizePart2 = static_cast<size_t>(readNumber<uint64_t>(streamInPart2));
 
-                std::string buf(sizePart1 + sizePart2, '\0');
-                if (sizePart1 > 0) readArray(streamInPart1, &buf[0],             sizePart1); //throw SysErrorUnexpectedEos
-                if (sizePart2 > 0) readArray(streamInPart2, &buf[0] + sizePart1, sizePart2); //
-
-                MemoryStreamIn streamIn(buf);
-                const std::string bufText     = readContainer<std::string>(streamIn); //
-                const std::string bufSmallNum = readContainer<std::string>(streamIn); //throw SysErrorUnexpectedEos
-                const std::string bufBigNum   = readContainer<std::string>(streamIn); //
+                //reduce peak memory: release compressed buffers *before* building the InSyncFolder hierarchy
+                std::string bufText;
+                std::string bufSmallNum;
+                std::string bufBigNum;
+                {
+                    std::string buf(sizePart1 + sizePart2, '\0');
+                    if (sizePart1 > 0) readArray(streamInPart1, &buf[0],             sizePart1); //throw SysErrorUnexpectedEos
+                    if (sizePart2 > 0) readArray(streamInPart2, &buf[0] + sizePart1, sizePart2); //
+
+                    MemoryStreamIn<std::string_view> streamIn(buf);
+                    bufText     = decompressDbStream(readContainer<std::string>(streamIn), codec); //throw SysErrorUnexpectedEos, SysError
+                    bufSmallNum = decompressDbStream(readContainer<std::string>(streamIn), codec); //
+                    bufBigNum   = decompressDbStream(readContainer<std::string>(streamIn), codec); //
+                }
 
                 auto output = makeSharedRef<InSyncFolder>(InSyncFolder::DIR_STATUS_IN_SYNC);
                 StreamParser parser(streamVersion,
-                                    decompress(bufText),     //
-                                    decompress(bufSmallNum), //throw SysError
-                                    decompress(bufBigNum));  //
+                                    std::move(bufText),     //
+                                    std::move(bufSmallNum), //no copy: may be hundreds of MB
+                                    std::move(bufBigNum),   //
+                                    namePool);
                 if (leadStreamLeft)
                     parser.recurse<SelectSide::left>(output.ref()); //throw SysError
                 else
@@ -403,16 +668,87 @@ public:
     }
 
 private:
-    StreamParser(int streamVersion, const std::string& bufText, const std::string& bufSmallNumbers, const std::string& bufBigNumbers) :
+    StreamParser(int streamVersion, std::string&& bufText, std::string&& bufSmallNumbers, std::string&& bufBigNumbers, ItemNamePool* namePool) :
         streamVersion_(streamVersion),
-        streamInText_(bufText),
-        streamInSmallNum_(bufSmallNumbers),
-        streamInBigNum_(bufBigNumbers) {}
+        itemCountMax_(streamVersion >= 6 ? bufText.size() : bufText.size() / sizeof(uint32_t)), //each item name has a length prefix
+        streamInText_    (std::move(bufText)),
+        streamInSmallNum_(std::move(bufSmallNumbers)),
+        streamInBigNum_  (std::move(bufBigNumbers)),
+        namePool_(namePool) {}
 
     template <SelectSide leadSide>
     void recurse(InSyncFolder& container) //throw SysError
+    {
+        if (streamVersion_ < 6) //TODO: remove migration code at some time! 2026-10-14
+            return recurseV5<leadSide>(container); //throw SysError
+
+        size_t fileCount = readVarInt<uint32_t>(streamInSmallNum_); //throw SysErrorUnexpectedEos
+        size_t linkCount = readVarInt<uint32_t>(streamInSmallNum_); //
+        size_t dirCount  = readVarInt<uint32_t>(streamInSmallNum_); //
+
+        const int64_t modTimeBase = fileCount > 0 || linkCount > 0 ? readVarInt<int64_t>(streamInBigNum_) : 0; //throw SysErrorUnexpectedEos
+
+        reserveItems(container.files, fileCount);
+        while (fileCount-- != 0)
+        {
+            const Zstring itemName = readItemName(); //throw SysErrorUnexpectedEos
+            const auto cmpVar = static_cast<CompareVariant>(readVarInt<int32_t>(streamInSmallNum_)); //
+            const uint64_t fileSize = readVarInt<uint64_t>(streamInSmallNum_); //
+
+            const auto [modTimeL, modTimeT] = readModTimes(modTimeBase);   //throw SysErrorUnexpectedEos
+            const InSyncDescrFile dataL(modTimeL, readFilePrint(lastFilePrintL_)); //
+            const InSyncDescrFile dataT(modTimeT, readFilePrint(lastFilePrintT_)); //
+
+            container.addFile(itemName,
+                              selectParam<leadSide>(dataL, dataT),
+                              selectParam<leadSide>(dataT, dataL), cmpVar, fileSize);
+        }
+
+        reserveItems(container.symlinks, linkCount);
+        while (linkCount-- != 0)
+        {
+            const Zstring itemName = readItemName(); //throw SysErrorUnexpectedEos
+            const auto cmpVar = static_cast<CompareVariant>(readVarInt<int32_t>(streamInSmallNum_)); //
+
+            const auto [modTimeL, modTimeT] = readModTimes(modTimeBase); //throw SysErrorUnexpectedEos
+            const InSyncDescrLink dataL(modTimeL);
+            const InSyncDescrLink dataT(modTimeT);
+
+            container.addSymlink(itemName,
+                                 selectParam<leadSide>(dataL, dataT),
+                                 selectParam<leadSide>(dataT, dataL), cmpVar);
+        }
+
+        reserveItems(container.folders, dirCount);
+        while (dirCount-- != 0)
+        {
+            const Zstring itemName = readItemName(); //throw SysErrorUnexpectedEos
+            const auto status = static_cast<InSyncFolder::InSyncStatus>(readVarInt<int32_t>(streamInSmallNum_)); //
+
+            InSyncFolder& dbFolder = container.addFolder(itemName, status);
+            recurse<leadSide>(dbFolder);
+        }
+    }
+
+    std::pair<time_t, time_t> readModTimes(int64_t modTimeBase) //throw SysErrorUnexpectedEos
+    {
+        const uint64_t modTimeL = static_cast<uint64_t>(modTimeBase) + static_cast<uint64_t>(readVarInt<int64_t>(streamInBigNum_)); //throw SysErrorUnexpectedEos
+        const uint64_t modTimeT = modTimeL                             + static_cast<uint64_t>(readVarInt<int64_t>(streamInBigNum_)); //
+        return {static_cast<time_t>(static_cast<int64_t>(modTimeL)),
+                static_cast<time_t>(static_cast<int64_t>(modTimeT))};
+    }
+
+    AFS::FingerPrint readFilePrint(AFS::FingerPrint& lastFilePrint) //throw SysErrorUnexpectedEos
+    {
+        lastFilePrint += static_cast<AFS::FingerPrint>(readVarInt<int64_t>(streamInBigNum_)); //throw SysErrorUnexpectedEos
+        return lastFilePrint;
+    }
+
+    template <SelectSide leadSide>
+    void recurseV5(InSyncFolder& container) //throw SysError
     {
         size_t fileCount = readNumber<uint32_t>(streamInSmallNum_); //throw SysErrorUnexpectedEos
+        reserveItems(container.files, fileCount);
         while (fileCount-- != 0)
         {
             const Zstring itemName = readItemName(); //
@@ -428,6 +764,7 @@ private:
         }
 
         size_t linkCount = readNumber<uint32_t>(streamInSmallNum_);
+        reserveItems(container.symlinks, linkCount);
         while (linkCount-- != 0)
         {
             const Zstring itemName = readItemName(); //
@@ -442,17 +779,43 @@ private:
         }
 
         size_t dirCount = readNumber<uint32_t>(streamInSmallNum_); //
+        reserveItems(container.folders, dirCount);
         while (dirCount-- != 0)
         {
             const Zstring itemName = readItemName(); //
             const auto status = static_cast<InSyncFolder::InSyncStatus>(readNumber<int32_t>(streamInSmallNum_)); //
 
             InSyncFolder& dbFolder = container.addFolder(itemName, status);
-            recurse<leadSide>(dbFolder);
+            recurseV5<leadSide>(dbFolder);
+        }
+    }
+
+    Zstring readItemName() //throw SysErrorUnexpectedEos
+    {
+        Zstring itemName;
+        if (streamVersion_ < 6)
+            itemName = utfTo<Zstring>(readContainer<std::string>(streamInText_)); //throw SysErrorUnexpectedEos
+        else
+        {
+            const size_t nameLen = readVarInt<uint32_t>(streamInText_); //throw SysErrorUnexpectedEos
+            if (nameLen > itemCountMax_) //don't trust corrupted data
+                throw SysErrorUnexpectedEos();
+
+            std::string buf(nameLen, '\0');
+            if (nameLen > 0)
+                readArray(streamInText_, &buf[0], nameLen); //throw SysErrorUnexpectedEos
+            itemName = utfTo<Zstring>(buf);
         }
+        return namePool_ ? namePool_->intern(itemName) : itemName;
     }
 
-    Zstring readItemName() { return utfTo<Zstring>(readContainer<std::string>(streamInText_)); } //throw SysErrorUnexpectedEos
+    //perf: avoid rehashing while filling large folders
+    template <class Map>
+    void reserveItems(Map& items, size_t itemCount)
+    {
+        if (itemCount <= itemCountMax_) //don't trust corrupted data
+            items.reserve(itemCount);
+    }
 
     InSyncDescrFile readFileDescr() //throw SysErrorUnexpectedEos
     {
@@ -530,11 +893,165 @@ private:
     };
 
     const int streamVersion_;
+    const size_t itemCountMax_;
     MemoryStreamIn<std::string> streamInText_;     //
     MemoryStreamIn<std::string> streamInSmallNum_; //data with bias to lead side
     MemoryStreamIn<std::string> streamInBigNum_;   //
+    ItemNamePool* const namePool_; //optional
+
+    AFS::FingerPrint lastFilePrintL_ = 0; //stream version 6+: file prints are delta-encoded
+    AFS::FingerPrint lastFilePrintT_ = 0; //
+};
+
+//#######################################################################################################################################
+
+class JournalRecorder
+{
+public:
+    void setFile(const Zstring& itemRelPath, const InSyncFile& file)
+    {
+        writeRecordHeader(JournalOp::setFile, itemRelPath);
+        writeNumber<int32_t >(streamOut_, static_cast<int32_t>(file.cmpVar));
+        writeNumber<uint64_t>(streamOut_, file.fileSize);
+        writeFileDescr(file.left);
+        writeFileDescr(file.right);
+    }
+
+    void setSymlink(const Zstring& itemRelPath, const InSyncSymlink& symlink)
+    {
+        writeRecordHeader(JournalOp::setSymlink, itemRelPath);
+        writeNumber<int32_t>(streamOut_, static_cast<int32_t>(symlink.cmpVar));
+        writeNumber<int64_t>(streamOut_, symlink.left .modTime);
+        writeNumber<int64_t>(streamOut_, symlink.right.modTime);
+    }
+
+    void setFolder(const Zstring& itemRelPath, InSyncFolder::InSyncStatus status)
+    {
+        writeRecordHeader(JournalOp::setFolder, itemRelPath);
+        writeNumber<int32_t>(streamOut_, status);
+    }
+
+    void removeItem(JournalOp op, const Zstring& itemRelPath)
+    {
+        assert(op == JournalOp::removeFile || op == JournalOp::removeSymlink || op == JournalOp::removeFolder);
+        writeRecordHeader(op, itemRelPath);
+    }
+
+    uint64_t getRecordCount() const { return recordCount_; }
+    const std::string& getRecords() const { return streamOut_.ref(); }
+
+private:
+    void writeRecordHeader(JournalOp op, const Zstring& itemRelPath)
+    {
+        writeNumber<int8_t>(streamOut_, static_cast<int8_t>(op));
+        writeContainer(streamOut_, utfTo<std::string>(itemRelPath));
+        ++recordCount_;
+    }
+
+    void writeFileDescr(const InSyncDescrFile& descr)
+    {
+        writeNumber<int64_t         >(streamOut_, descr.modTime);
+        writeNumber<AFS::FingerPrint>(streamOut_, descr.filePrint);
+    }
+
+    MemoryStreamOut<std::string> streamOut_;
+    uint64_t recordCount_ = 0;
 };
 
+
+void applyJournal(InSyncFolder& dbRoot, const JournalData& journalL /*from left journal file*/) //throw SysError
+{
+    const bool leadStreamLeft = journalL.isLeadStream;
+    const std::string records = decompressDbStream(journalL.recordsCompressed, journalL.codec); //throw SysError
+    MemoryStreamIn<std::string_view> streamIn(records);
+
+    auto readFileDescr = [&]
+    {
+        const auto modTime   = readNumber<int64_t         >(streamIn); //throw SysErrorUnexpectedEos
+        const auto filePrint = readNumber<AFS::FingerPrint>(streamIn); //
+        return InSyncDescrFile(modTime, filePrint);
+    };
+
+    for (uint64_t i = 0; i < journalL.recordCount; ++i)
+    {
+        const auto op = static_cast<JournalOp>(readNumber<int8_t>(streamIn));            //throw SysErrorUnexpectedEos
+        const Zstring itemRelPath = utfTo<Zstring>(readContainer<std::string>(streamIn)); //
+
+        const std::vector<Zstring> pathNames = split(itemRelPath, FILE_NAME_SEPARATOR, SplitOnEmpty::skip);
+        if (pathNames.empty())
+            throw SysError(_("File content is corrupted.") + L" (invalid journal item path)");
+        const Zstring& itemName = pathNames.back();
+
+        //parent folders are always recorded before their children, except when they were straw men already
+        auto getParentFolder = [&](bool createMissing) -> InSyncFolder*
+        {
+            InSyncFolder* dbFolder = &dbRoot;
+            for (auto it = pathNames.begin(); it != pathNames.end() - 1; ++it)
+                if (createMissing)
+                    dbFolder = &dbFolder->addFolder(*it, InSyncFolder::DIR_STATUS_STRAW_MAN); //get or create
+                else if (auto itF = dbFolder->folders.find(*it);
+                         itF != dbFolder->folders.end())
+                    dbFolder = &itF->second;
+                else
+                    return nullptr;
+            return dbFolder;
+        };
+
+        switch (op)
+        {
+            case JournalOp::setFile:
+            {
+                const auto cmpVar = static_cast<CompareVariant>(readNumber<int32_t>(streamIn)); //throw SysErrorUnexpectedEos
+                const uint64_t fileSize = readNumber<uint64_t>(streamIn); //
+                const InSyncDescrFile dataL = readFileDescr(); //
+                const InSyncDescrFile dataR = readFileDescr(); //
+
+                getParentFolder(true)->files.insert_or_assign(itemName, leadStreamLeft ?
+                                                              InSyncFile(dataL, dataR, cmpVar, fileSize) :
+                                                              InSyncFile(dataR, dataL, cmpVar, fileSize));
+            }
+            break;
+
+            case JournalOp::setSymlink:
+            {
+                const auto cmpVar = static_cast<CompareVariant>(readNumber<int32_t>(streamIn)); //throw SysErrorUnexpectedEos
+                const InSyncDescrLink dataL(readNumber<int64_t>(streamIn)); //
+                const InSyncDescrLink dataR(readNumber<int64_t>(streamIn)); //
+
+                getParentFolder(true)->symlinks.insert_or_assign(itemName, leadStreamLeft ?
+                                                                 InSyncSymlink(dataL, dataR, cmpVar) :
+                                                                 InSyncSymlink(dataR, dataL, cmpVar));
+            }
+            break;
+
+            case JournalOp::setFolder:
+            {
+                const auto status = static_cast<InSyncFolder::InSyncStatus>(readNumber<int32_t>(streamIn)); //throw SysErrorUnexpectedEos
+                getParentFolder(true)->addFolder(itemName, status).status = status;
+            }
+            break;
+
+            case JournalOp::removeFile:
+                if (InSyncFolder* dbFolder = getParentFolder(false))
+                    dbFolder->files.erase(itemName);
+                break;
+
+            case JournalOp::removeSymlink:
+                if (InSyncFolder* dbFolder = getParentFolder(false))
+                    dbFolder->symlinks.erase(itemName);
+                break;
+
+            case JournalOp::removeFolder:
+                if (InSyncFolder* dbFolder = getParentFolder(false))
+                    dbFolder->folders.erase(itemName);
+                break;
+
+            default:
+                throw SysError(_("File content is corrupted.") + L" (invalid journal record)");
+        }
+    }
+}
+
 //#######################################################################################################################################
 
 class LastSynchronousStateUpdater
@@ -544,27 +1061,33 @@ class LastSynchronousStateUpdater
        2. Symlink handling *does* create a new (asymmetric) hierarchy during comparison
           => update all database entries!                                           */
 public:
-    static void execute(const BaseFolderPair& baseFolder, InSyncFolder& dbFolder)
+    static void execute(const BaseFolderPair& baseFolder, InSyncFolder& dbFolder, JournalRecorder* journal /*optional: record all changes*/)
     {
-        LastSynchronousStateUpdater updater(baseFolder.getCompVariant(), baseFolder.getFilter());
-        updater.recurse(baseFolder, dbFolder);
+        LastSynchronousStateUpdater updater(baseFolder.getCompVariant(), baseFolder.getFilter(), journal);
+        updater.recurse(baseFolder, Zstring(), dbFolder);
     }
 
 private:
-    LastSynchronousStateUpdater(CompareVariant activeCmpVar, const PathFilter& filter) :
+    LastSynchronousStateUpdater(CompareVariant activeCmpVar, const PathFilter& filter, JournalRecorder* journal) :
         filter_(filter),
-        activeCmpVar_(activeCmpVar) {}
+        activeCmpVar_(activeCmpVar),
+        journal_(journal) {}
 
-    void recurse(const ContainerObject& hierObj, InSyncFolder& dbFolder)
+    //dbRelPath: path of dbFolder within the database; may differ from hierObj's path, e.g. in case
+    void recurse(const ContainerObject& hierObj, const Zstring& dbRelPath, InSyncFolder& dbFolder)
     {
-        process(hierObj.refSubFiles  (), hierObj.getRelativePathAny(), dbFolder.files);
-        process(hierObj.refSubLinks  (), hierObj.getRelativePathAny(), dbFolder.symlinks);
-        process(hierObj.refSubFolders(), hierObj.getRelativePathAny(), dbFolder.folders);
+        process(hierObj.refSubFiles  (), hierObj.getRelativePathAny(), dbRelPath, dbFolder.files);
+        process(hierObj.refSubLinks  (), hierObj.getRelativePathAny(), dbRelPath, dbFolder.symlinks);
+        process(hierObj.refSubFolders(), hierObj.getRelativePathAny(), dbRelPath, dbFolder.folders);
+
+        hierObj.unloadSpilled(); //out-of-core comparison: don't keep the reloaded sub tree
     }
 
-    void process(const ContainerObject::FileList& currentFiles, const Zstring& parentRelPath, InSyncFolder::FileList& dbFiles)
+    void process(const ContainerObject::FileList& currentFiles, const Zstring& parentRelPath, const Zstring& dbParentRelPath, InSyncFolder::FileList& dbFiles)
     {
         std::unordered_set<ZstringNorm> toPreserve;
+        ChildPathBuilder itemPath(parentRelPath);
+        ChildPathBuilder dbItemPath(dbParentRelPath);
 
         for (const FilePair& file : currentFiles)
             if (!file.isPairEmpty())
@@ -577,37 +1100,49 @@ private:
                     assert(file.getFileSize<SelectSide::left>() == file.getFileSize<SelectSide::right>());
 
                     //create or update new "in-sync" state
-                    dbFiles.insert_or_assign(file.getItemNameAny(),
-                                             InSyncFile(InSyncDescrFile(file.getLastWriteTime<SelectSide::left >(),
-                                                                        file.getFilePrint    <SelectSide::left >()),
-                                                        InSyncDescrFile(file.getLastWriteTime<SelectSide::right>(),
-                                                                        file.getFilePrint    <SelectSide::right>()),
-                                                        activeCmpVar_,
-                                                        file.getFileSize<SelectSide::left>()));
-                    toPreserve.insert(file.getItemNameAny());
+                    const InSyncFile dbFileNew(InSyncDescrFile(file.getLastWriteTime<SelectSide::left >(),
+                                                               file.getFilePrint    <SelectSide::left >()),
+                                               InSyncDescrFile(file.getLastWriteTime<SelectSide::right>(),
+                                                               file.getFilePrint    <SelectSide::right>()),
+                                               activeCmpVar_,
+                                               file.getFileSize<SelectSide::left>());
+
+                    if (const auto [it, inserted] = dbFiles.try_emplace(file.getItemNameNorm<SelectSide::left>(), dbFileNew);
+                        inserted || !(it->second == dbFileNew))
+                    {
+                        it->second = dbFileNew;
+                        if (journal_)
+                            journal_->setFile(dbItemPath.getPath(file.getItemNameAny()), dbFileNew);
+                    }
+                    toPreserve.insert(file.getItemNameNorm<SelectSide::left>());
                 }
                 else //not in sync: preserve last synchronous state
                 {
-                    toPreserve.insert(file.getItemName<SelectSide::left >()); //left/right may differ in case!
-                    toPreserve.insert(file.getItemName<SelectSide::right>()); //
+                    toPreserve.insert(file.getItemNameNorm<SelectSide::left >()); //left/right may differ in case!
+                    toPreserve.insert(file.getItemNameNorm<SelectSide::right>()); //
                 }
             }
 
         //delete removed items (= "in-sync") from database
-        std::erase_if(dbFiles, [&](const InSyncFolder::FileList::value_type& v)
+        eraseIf(dbFiles, [&](const InSyncFolder::FileList::value_type& v)
         {
             if (toPreserve.contains(v.first))
                 return false;
             //all items not existing in "currentFiles" have either been deleted meanwhile or been excluded via filter:
-            const Zstring& itemRelPath = appendPath(parentRelPath, v.first.normStr);
-            return filter_.passFileFilter(itemRelPath);
+            const Zstring& itemRelPath = itemPath.getPath(v.first.normStr);
+            const bool passFilter = filter_.passFileFilter(itemRelPath);
             //note: items subject to traveral errors are also excluded by this file filter here! see comparison.cpp, modified file filter for read errors
+            if (passFilter && journal_)
+                journal_->removeItem(JournalOp::removeFile, dbItemPath.getPath(v.first.normStr));
+            return passFilter;
         });
     }
 
-    void process(const ContainerObject::SymlinkList& currentSymlinks, const Zstring& parentRelPath, InSyncFolder::SymlinkList& dbSymlinks)
+    void process(const ContainerObject::SymlinkList& currentSymlinks, const Zstring& parentRelPath, const Zstring& dbParentRelPath, InSyncFolder::SymlinkList& dbSymlinks)
     {
         std::unordered_set<ZstringNorm> toPreserve;
+        ChildPathBuilder itemPath(parentRelPath);
+        ChildPathBuilder dbItemPath(dbParentRelPath);
 
         for (const SymlinkPair& symlink : currentSymlinks)
             if (!symlink.isPairEmpty())
@@ -617,31 +1152,41 @@ private:
                     assert(getUnicodeNormalForm(symlink.getItemName<SelectSide::left>()) == getUnicodeNormalForm(symlink.getItemName<SelectSide::right>()));
 
                     //create or update new "in-sync" state
-                    dbSymlinks.insert_or_assign(symlink.getItemNameAny(),
-                                                InSyncSymlink(InSyncDescrLink(symlink.getLastWriteTime<SelectSide::left >()),
-                                                              InSyncDescrLink(symlink.getLastWriteTime<SelectSide::right>()),
-                                                              activeCmpVar_));
-                    toPreserve.insert(symlink.getItemNameAny());
+                    const InSyncSymlink dbSymlinkNew(InSyncDescrLink(symlink.getLastWriteTime<SelectSide::left >()),
+                                                     InSyncDescrLink(symlink.getLastWriteTime<SelectSide::right>()),
+                                                     activeCmpVar_);
+
+                    if (const auto [it, inserted] = dbSymlinks.try_emplace(symlink.getItemNameNorm<SelectSide::left>(), dbSymlinkNew);
+                        inserted || !(it->second == dbSymlinkNew))
+                    {
+                        it->second = dbSymlinkNew;
+                        if (journal_)
+                            journal_->setSymlink(dbItemPath.getPath(symlink.getItemNameAny()), dbSymlinkNew);
+                    }
+                    toPreserve.insert(symlink.getItemNameNorm<SelectSide::left>());
                 }
                 else //not in sync: preserve last synchronous state
                 {
-                    toPreserve.insert(symlink.getItemName<SelectSide::left >()); //left/right may differ in case!
-                    toPreserve.insert(symlink.getItemName<SelectSide::right>()); //
+                    toPreserve.insert(symlink.getItemNameNorm<SelectSide::left >()); //left/right may differ in case!
+                    toPreserve.insert(symlink.getItemNameNorm<SelectSide::right>()); //
                 }
             }
 
         //delete removed items (= "in-sync") from database
-        std::erase_if(dbSymlinks, [&](const InSyncFolder::SymlinkList::value_type& v)
+        eraseIf(dbSymlinks, [&](const InSyncFolder::SymlinkList::value_type& v)
         {
             if (toPreserve.contains(v.first))
                 return false;
             //all items not existing in "currentSymlinks" have either been deleted meanwhile or been excluded via filter:
-            const Zstring& itemRelPath = appendPath(parentRelPath, v.first.normStr);
-            return filter_.passFileFilter(itemRelPath);
+            const Zstring& itemRelPath = itemPath.getPath(v.first.normStr);
+            const bool passFilter = filter_.passFileFilter(itemRelPath);
+            if (passFilter && journal_)
+                journal_->removeItem(JournalOp::removeSymlink, dbItemPath.getPath(v.first.normStr));
+            return passFilter;
         });
     }
 
-    void process(const ContainerObject::FolderList& currentFolders, const Zstring& parentRelPath, InSyncFolder::FolderList& dbFolders)
+    void process(const ContainerObject::FolderList& currentFolders, const Zstring& parentRelPath, const Zstring& dbParentRelPath, InSyncFolder::FolderList& dbFolders)
     {
         std::unordered_map<ZstringNorm, const FolderPair*> toPreserve;
 
@@ -653,15 +1198,21 @@ private:
                     assert(getUnicodeNormalForm(folder.getItemName<SelectSide::left>()) == getUnicodeNormalForm(folder.getItemName<SelectSide::right>()));
 
                     //update directory entry only (shallow), but do *not touch* existing child elements!!!
-                    InSyncFolder& dbFolder = dbFolders.emplace(folder.getItemNameAny(), InSyncFolder(InSyncFolder::DIR_STATUS_IN_SYNC)).first->second; //get or create
-                    dbFolder.status = InSyncFolder::DIR_STATUS_IN_SYNC;
+                    const auto [it, inserted] = dbFolders.emplace(folder.getItemNameNorm<SelectSide::left>(), InSyncFolder(InSyncFolder::DIR_STATUS_IN_SYNC)); //get or create
+                    InSyncFolder& dbFolder = it->second;
+                    if (inserted || dbFolder.status != InSyncFolder::DIR_STATUS_IN_SYNC)
+                    {
+                        dbFolder.status = InSyncFolder::DIR_STATUS_IN_SYNC;
+                        if (journal_)
+                            journal_->setFolder(appendPath(dbParentRelPath, folder.getItemNameAny()), InSyncFolder::DIR_STATUS_IN_SYNC);
+                    }
 
-                    toPreserve.emplace(folder.getItemNameAny(), &folder);
+                    toPreserve.emplace(folder.getItemNameNorm<SelectSide::left>(), &folder);
                 }
                 else //not in sync: preserve last synchronous state
                 {
-                    toPreserve.emplace(folder.getItemName<SelectSide::left >(), &folder); //names differing in case? => treat like any other folder rename
-                    toPreserve.emplace(folder.getItemName<SelectSide::right>(), &folder); //=> no *new* database entries even if child items are in sync
+                    toPreserve.emplace(folder.getItemNameNorm<SelectSide::left >(), &folder); //names differing in case? => treat like any other folder rename
+                    toPreserve.emplace(folder.getItemNameNorm<SelectSide::right>(), &folder); //=> no *new* database entries even if child items are in sync
                 }
             }
 
@@ -670,7 +1221,7 @@ private:
         {
             if (auto it = toPreserve.find(v.first); it != toPreserve.end())
             {
-                recurse(*(it->second), v.second); //required even if e.g. DIR_LEFT_SIDE_ONLY:
+                recurse(*(it->second), appendPath(dbParentRelPath, v.first.normStr), v.second); //required even if e.g. DIR_LEFT_SIDE_ONLY:
                 //existing child-items may not be in sync, but items deleted on both sides *are* in-sync!!!
                 return false;
             }
@@ -682,16 +1233,25 @@ private:
             bool childItemMightMatch = true;
             const bool passFilter = filter_.passDirFilter(itemRelPath, &childItemMightMatch);
             if (!passFilter && childItemMightMatch)
-                dbSetEmptyState(v.second, appendSeparator(itemRelPath)); //child items might match, e.g. *.txt include filter!
+                dbSetEmptyState(v.second, appendSeparator(itemRelPath), appendPath(dbParentRelPath, v.first.normStr)); //child items might match, e.g. *.txt include filter!
+            if (passFilter && journal_)
+                journal_->removeItem(JournalOp::removeFolder, appendPath(dbParentRelPath, v.first.normStr));
             return passFilter;
         });
     }
 
     //delete all entries for removed folder (= "in-sync") from database
-    void dbSetEmptyState(InSyncFolder& dbFolder, const Zstring& parentRelPathPf)
+    void dbSetEmptyState(InSyncFolder& dbFolder, const Zstring& parentRelPathPf, const Zstring& dbRelPath)
     {
-        std::erase_if(dbFolder.files,    [&](const InSyncFolder::FileList   ::value_type& v) { return filter_.passFileFilter(parentRelPathPf + v.first.normStr); });
-        std::erase_if(dbFolder.symlinks, [&](const InSyncFolder::SymlinkList::value_type& v) { return filter_.passFileFilter(parentRelPathPf + v.first.normStr); });
+        auto passFilterAndRecord = [&](const Zstring& itemName, JournalOp op)
+        {
+            const bool passFilter = filter_.passFileFilter(parentRelPathPf + itemName);
+            if (passFilter && journal_)
+                journal_->removeItem(op, appendPath(dbRelPath, itemName));
+            return passFilter;
+        };
+        eraseIf(dbFolder.files,    [&](const InSyncFolder::FileList   ::value_type& v) { return passFilterAndRecord(v.first.normStr, JournalOp::removeFile); });
+        eraseIf(dbFolder.symlinks, [&](const InSyncFolder::SymlinkList::value_type& v) { return passFilterAndRecord(v.first.normStr, JournalOp::removeSymlink); });
 
         eraseIf(dbFolder.folders, [&](InSyncFolder::FolderList::value_type& v)
         {
@@ -700,13 +1260,16 @@ private:
             bool childItemMightMatch = true;
             const bool passFilter = filter_.passDirFilter(itemRelPath, &childItemMightMatch);
             if (!passFilter && childItemMightMatch)
-                dbSetEmptyState(v.second, appendSeparator(itemRelPath));
+                dbSetEmptyState(v.second, appendSeparator(itemRelPath), appendPath(dbRelPath, v.first.normStr));
+            if (passFilter && journal_)
+                journal_->removeItem(JournalOp::removeFolder, appendPath(dbRelPath, v.first.normStr));
             return passFilter;
         });
     }
 
     const PathFilter& filter_; //filter used while scanning directory: generates view on actual files!
     const CompareVariant activeCmpVar_;
+    JournalRecorder* const journal_;
 };
 
 
@@ -763,103 +1326,253 @@ std::pair<DbStreams::const_iterator,
 
     return {itCommonL, itCommonR};
 }
+
+
+template <class Function>
+void saveDbFileTransactional(const AbstractPath& filePath, bool transactionalCopy, Function saveFile /*throw FileError, X*/) //throw FileError, X
+{
+    if (transactionalCopy && !AFS::hasNativeTransactionalCopy(filePath))
+    {
+        //write (temp-) files as a transaction
+        const Zstring shortGuid = printNumber<Zstring>(Zstr("%04x"), static_cast<unsigned int>(getCrc16(generateGUID())));
+        const AbstractPath filePathTmp = AFS::appendRelPath(*AFS::getParentPath(filePath), AFS::getItemName(filePath) + Zstr('.') + shortGuid + AFS::TEMP_FILE_ENDING);
+
+        saveFile(filePathTmp); //throw FileError, X
+        ZEN_ON_SCOPE_FAIL(try { AFS::removeFilePlain(filePathTmp); }
+        catch (FileError&) {});
+
+        //operation finished: rename temp file -> this should work (almost) transactionally:
+        //if there were no write access, creation of temp file would have failed
+        AFS::removeFileIfExists(filePath);             //throw FileError
+        AFS::moveAndRenameItem(filePathTmp, filePath); //throw FileError, (ErrorMoveUnsupported)
+    }
+    else //some MTP devices don't even allow renaming files: https://freefilesync.org/forum/viewtopic.php?t=6531
+    {
+        AFS::removeFileIfExists(filePath); //throw FileError
+        saveFile(filePath);                //throw FileError, X
+    }
+}
+
+
+int64_t estimateMemoryUsage(const InSyncFolder& folder)
+{
+    int64_t bytes = folder.files   .size() * sizeof(InSyncFolder::FileList   ::value_type) +
+                    folder.symlinks.size() * sizeof(InSyncFolder::SymlinkList::value_type) +
+                    folder.folders .size() * (sizeof(InSyncFolder::FolderList::value_type) + 2 * sizeof(void*)) + folder.folders.bucket_count() * sizeof(void*);
+
+    for (const auto& [folderName, subFolder] : folder.folders)
+        bytes += estimateMemoryUsage(subFolder);
+    return bytes;
+}
+
+
+//account for the last synchronous state until the last reference is gone
+SharedRef<const InSyncFolder> trackMemoryUsage(const SharedRef<InSyncFolder>& lastSyncState)
+{
+    const int64_t bytes = estimateMemoryUsage(lastSyncState.ref());
+    addMemoryUsage(MemoryCategory::syncState, bytes);
+
+    return SharedRef<const InSyncFolder>(std::shared_ptr<const InSyncFolder>(&lastSyncState.ref(), [ptr = lastSyncState.ptr(), bytes](const InSyncFolder*) mutable
+    {
+        ptr.reset();
+        addMemoryUsage(MemoryCategory::syncState, -bytes);
+    }));
+}
 }
 
 //#######################################################################################################################################
 
 std::unordered_map<const BaseFolderPair*, SharedRef<const InSyncFolder>> fff::loadLastSynchronousState(const std::vector<const BaseFolderPair*>& baseFolders,
+                                                                      ItemNamePool* namePool, //optional
                                                                       PhaseCallback& callback /*throw X*/) //throw X
 {
-    std::set<AbstractPath> dbFilePaths;
+    ZEN_TRACE_SCOPE_ARG("db:loadLastSynchronousState", baseFolders.size())
+
+    struct DbParseJob
+    {
+        const BaseFolderPair* baseFolder = nullptr;
+        AbstractPath dbPathL;
+        AbstractPath dbPathR;
+        AbstractPath journalPathL;
+        AbstractPath journalPathR;
+        size_t filesPending = 0; //start parsing as soon as all files of this base folder were loaded
+
+        std::optional<SharedRef<const InSyncFolder>> lastSyncState;
+        std::wstring errorMsg;
+    };
+    std::vector<DbParseJob> parseJobs;
+    std::map<AbstractPath, std::vector<size_t /*parse job index*/>> parseJobsByPath;
 
     for (const BaseFolderPair* baseFolder : baseFolders)
         //avoid race condition with directory existence check: reading sync.ffs_db may succeed although first dir check had failed => conflicts!
         if (baseFolder->getFolderStatus<SelectSide::left >() == BaseFolderStatus::existing &&
             baseFolder->getFolderStatus<SelectSide::right>() == BaseFolderStatus::existing)
         {
-            dbFilePaths.insert(getDatabaseFilePath<SelectSide::left >(*baseFolder));
-            dbFilePaths.insert(getDatabaseFilePath<SelectSide::right>(*baseFolder));
+            DbParseJob& job = parseJobs.emplace_back(DbParseJob
+            {
+                .baseFolder   = baseFolder,
+                .dbPathL      = getDatabaseFilePath<SelectSide::left >(*baseFolder),
+                .dbPathR      = getDatabaseFilePath<SelectSide::right>(*baseFolder),
+                .journalPathL = getJournalFilePath <SelectSide::left >(*baseFolder),
+                .journalPathR = getJournalFilePath <SelectSide::right>(*baseFolder),
+            });
+            const std::set<AbstractPath> jobPaths{job.dbPathL, job.dbPathR, job.journalPathL, job.journalPathR};
+            job.filesPending = jobPaths.size();
+
+            for (const AbstractPath& filePath : jobPaths)
+                parseJobsByPath[filePath].push_back(parseJobs.size() - 1);
         }
     //else: ignore; there's no value in reporting it other than to confuse users
 
-    std::map<AbstractPath, DbStreams> dbStreamsByPath;
-    //------------ (try to) load DB files in parallel -------------------------
+    std::map<AbstractPath, DbStreams > dbStreamsByPath;
+    std::map<AbstractPath, DbJournals> journalsByPath;
+    //------------ (try to) load DB files in parallel and parse on a separate thread pool -------------------------
     {
-        Protected<std::map<AbstractPath, DbStreams>&> dbStreamsByPathShared(dbStreamsByPath);
-        std::vector<std::pair<AbstractPath, ParallelWorkItem>> parallelWorkload;
+        Protected<std::map<AbstractPath, DbStreams >&> dbStreamsByPathShared(dbStreamsByPath);
+        Protected<std::map<AbstractPath, DbJournals>&> journalsByPathShared (journalsByPath);
+        Protected<std::vector<DbParseJob>&> parseJobsShared(parseJobs); //protects DbParseJob::filesPending only
 
-        for (const AbstractPath& dbPath : dbFilePaths)
-            parallelWorkload.emplace_back(dbPath, [&dbStreamsByPathShared](ParallelContext& ctx) //throw ThreadStopRequest
+        auto parseDatabase = [&](DbParseJob& job) //noexcept (runs on parse thread)
         {
-            StreamStatusNotifier notifyLoad(replaceCpy(_("Loading file %x..."), L"%x", fmtPath(AFS::getDisplayPath(ctx.itemPath))), ctx.acb);
+            //files were loaded completely => no more concurrent map insertions for paths of this job
+            const DbStreams*  streamsL  = nullptr;
+            const DbStreams*  streamsR  = nullptr;
+            const DbJournals* journalsL = nullptr;
+            const DbJournals* journalsR = nullptr;
 
-            tryReportingError([&] //throw ThreadStopRequest
+            dbStreamsByPathShared.access([&](const auto& dbStreamsByPath2)
+            {
+                if (auto it = dbStreamsByPath2.find(job.dbPathL); it != dbStreamsByPath2.end()) streamsL = &it->second;
+                if (auto it = dbStreamsByPath2.find(job.dbPathR); it != dbStreamsByPath2.end()) streamsR = &it->second;
+            });
+            journalsByPathShared.access([&](const auto& journalsByPath2)
             {
+                if (auto it = journalsByPath2.find(job.journalPathL); it != journalsByPath2.end()) journalsL = &it->second;
+                if (auto it = journalsByPath2.find(job.journalPathR); it != journalsByPath2.end()) journalsR = &it->second;
+            });
+
+            if (streamsL && streamsR)
                 try
                 {
-                    DbStreams dbStreams = ::loadStreams(ctx.itemPath, notifyLoad); //throw FileError, FileErrorDatabaseNotExisting, ThreadStopRequest
-
-                    dbStreamsByPathShared.access([&](auto& dbStreamsByPath2) { dbStreamsByPath2.emplace(ctx.itemPath, std::move(dbStreams)); });
+                    //find associated session: there can be at most one session within intersection of left and right IDs
+                    const auto [itStreamL, itStreamR] = findCommonSession(*streamsL, *streamsR,
+                                                                          AFS::getDisplayPath(job.dbPathL),
+                                                                          AFS::getDisplayPath(job.dbPathR)); //throw FileError
+                    if (itStreamL != streamsL->end())
+                    {
+                        assert(itStreamL->second.isLeadStream != itStreamR->second.isLeadStream);
+                        SharedRef<InSyncFolder> lastSyncState = StreamParser::execute(itStreamL->second.isLeadStream,
+                                                                                      itStreamL->second.rawStream,
+                                                                                      itStreamR->second.rawStream,
+                                                                                      AFS::getDisplayPath(job.dbPathL),
+                                                                                      AFS::getDisplayPath(job.dbPathR),
+                                                                                      namePool); //throw FileError
+                        if (journalsL && journalsR)
+                            if (const JournalData* journal = findCommonJournal(*journalsL, *journalsR, itStreamL->first))
+                                try
+                                {
+                                    applyJournal(lastSyncState.ref(), *journal); //throw SysError
+                                }
+                                catch (const SysError& e)
+                                {
+                                    throw FileError(replaceCpy(_("Cannot read database file %x."), L"%x", fmtPath(AFS::getDisplayPath(job.journalPathL))), e.toString());
+                                }
+
+                        job.lastSyncState = trackMemoryUsage(lastSyncState);
+                    }
                 }
-                catch (const FileErrorDatabaseNotExisting&) {} //redundant info => no reportInfo()
-            }, ctx.acb);
-        });
-
-        massParallelExecute(parallelWorkload,
-                            Zstr("Load sync.ffs_db"), callback /*throw X*/); //throw X
-    }
-    //----------------------------------------------------------------
+                catch (const FileError& e) { job.errorMsg = e.toString(); } //report in main thread
+        };
 
-    std::unordered_map<const BaseFolderPair*, SharedRef<const InSyncFolder>> output;
+        //CPU-bound: decompression + building InSyncFolder hierarchy => don't block the (per-device) I/O threads!
+        ThreadGroup<std::function<void()>> parseGroup(std::max<size_t>(std::thread::hardware_concurrency(), 1), Zstr("Parse sync.ffs_db"));
+        //caveat: declare *after* parseDatabase: worker threads are joined in ThreadGroup destructor
 
-    for (const BaseFolderPair* baseFolder : baseFolders)
-        if (baseFolder->getFolderStatus<SelectSide::left >() == BaseFolderStatus::existing &&
-            baseFolder->getFolderStatus<SelectSide::right>() == BaseFolderStatus::existing)
+        auto notifyFileLoaded = [&](const AbstractPath& filePath) //context of I/O worker thread
         {
-            const AbstractPath dbPathL = getDatabaseFilePath<SelectSide::left >(*baseFolder);
-            const AbstractPath dbPathR = getDatabaseFilePath<SelectSide::right>(*baseFolder);
+            for (const size_t jobIdx : parseJobsByPath.find(filePath)->second) //parseJobsByPath is not modified => no locking needed
+                if (parseJobsShared.access([&](auto& parseJobs2) { return --parseJobs2[jobIdx].filesPending == 0; }))
+                    parseGroup.run([&parseDatabase, &job = parseJobs[jobIdx]] { parseDatabase(job); });
+        };
 
-            auto itL = dbStreamsByPath.find(dbPathL);
-            auto itR = dbStreamsByPath.find(dbPathR);
+        std::vector<std::pair<AbstractPath, ParallelWorkItem>> parallelWorkload;
 
-            if (itL != dbStreamsByPath.end() &&
-                itR != dbStreamsByPath.end())
-                try
+        for (const auto& [filePath, jobIdxs] : parseJobsByPath)
+            if (filePath == parseJobs[jobIdxs[0]].journalPathL ||
+                filePath == parseJobs[jobIdxs[0]].journalPathR)
+                parallelWorkload.emplace_back(filePath, [&journalsByPathShared, &notifyFileLoaded](ParallelContext& ctx) //throw ThreadStopRequest
+            {
+                ZEN_ON_SCOPE_SUCCESS(notifyFileLoaded(ctx.itemPath)); //also if loading failed
+
+                StreamStatusNotifier notifyLoad(replaceCpy(_("Loading file %x..."), L"%x", fmtPath(AFS::getDisplayPath(ctx.itemPath))), ctx.acb);
+
+                tryReportingError([&] //throw ThreadStopRequest
                 {
-                    const DbStreams& streamsL = itL->second;
-                    const DbStreams& streamsR = itR->second;
+                    try
+                    {
+                        DbJournals journals = ::loadJournals(ctx.itemPath, notifyLoad); //throw FileError, FileErrorDatabaseNotExisting, ThreadStopRequest
 
-                    //find associated session: there can be at most one session within intersection of left and right IDs
-                    const auto [itStreamL, itStreamR] = findCommonSession(streamsL, streamsR,
-                                                                          AFS::getDisplayPath(dbPathL),
-                                                                          AFS::getDisplayPath(dbPathR)); //throw FileError
-                    if (itStreamL != streamsL.end())
+                        journalsByPathShared.access([&](auto& journalsByPath2) { journalsByPath2.emplace(ctx.itemPath, std::move(journals)); });
+                    }
+                    catch (const FileErrorDatabaseNotExisting&) {} //journal is optional
+                }, ctx.acb);
+            });
+            else
+                parallelWorkload.emplace_back(filePath, [&dbStreamsByPathShared, &notifyFileLoaded](ParallelContext& ctx) //throw ThreadStopRequest
+            {
+                ZEN_ON_SCOPE_SUCCESS(notifyFileLoaded(ctx.itemPath)); //also if loading failed
+
+                StreamStatusNotifier notifyLoad(replaceCpy(_("Loading file %x..."), L"%x", fmtPath(AFS::getDisplayPath(ctx.itemPath))), ctx.acb);
+
+                tryReportingError([&] //throw ThreadStopRequest
+                {
+                    try
                     {
-                        assert(itStreamL->second.isLeadStream != itStreamR->second.isLeadStream);
-                        SharedRef<InSyncFolder> lastSyncState = StreamParser::execute(itStreamL->second.isLeadStream,
-                                                                                      itStreamL->second.rawStream,
-                                                                                      itStreamR->second.rawStream,
-                                                                                      AFS::getDisplayPath(dbPathL),
-                                                                                      AFS::getDisplayPath(dbPathR)); //throw FileError
-                        output.emplace(baseFolder, lastSyncState);
+                        DbStreams dbStreams = ::loadStreams(ctx.itemPath, notifyLoad); //throw FileError, FileErrorDatabaseNotExisting, ThreadStopRequest
+
+                        dbStreamsByPathShared.access([&](auto& dbStreamsByPath2) { dbStreamsByPath2.emplace(ctx.itemPath, std::move(dbStreams)); });
                     }
-                }
-                catch (const FileError& e) { callback.reportFatalError(e.toString()); } //throw X
-        }
+                    catch (const FileErrorDatabaseNotExisting&) {} //redundant info => no reportInfo()
+                }, ctx.acb);
+            });
+
+        massParallelExecute(parallelWorkload,
+                            Zstr("Load sync.ffs_db"), callback /*throw X*/); //throw X
+
+        parseGroup.wait(); //parse jobs are not interruptible; loading is the slow part anyway for non-local DBs
+    }
+    //----------------------------------------------------------------
+
+    std::unordered_map<const BaseFolderPair*, SharedRef<const InSyncFolder>> output;
+
+    for (const DbParseJob& job : parseJobs)
+        if (!job.errorMsg.empty())
+            callback.reportFatalError(job.errorMsg); //throw X
+        else if (job.lastSyncState)
+            output.emplace(job.baseFolder, *job.lastSyncState);
 
     return output;
 }
 
 
-void fff::saveLastSynchronousState(const BaseFolderPair& baseFolder, bool transactionalCopy,
+bool fff::saveLastSynchronousState(const BaseFolderPair& baseFolder, bool transactionalCopy, bool useJournal,
                                    PhaseCallback& callback /*throw X*/) //throw X
 {
+    ZEN_TRACE_SCOPE("db:saveLastSynchronousState")
+
     const AbstractPath dbPathL = getDatabaseFilePath<SelectSide::left >(baseFolder);
     const AbstractPath dbPathR = getDatabaseFilePath<SelectSide::right>(baseFolder);
 
+    const AbstractPath journalPathL = getJournalFilePath<SelectSide::left >(baseFolder);
+    const AbstractPath journalPathR = getJournalFilePath<SelectSide::right>(baseFolder);
+
     //------------ (try to) load DB files in parallel -------------------------
     DbStreams streamsL; //list of session ID + DirInfo-stream
     DbStreams streamsR; //
+    DbJournals journalsL; //list of session ID + journal
+    DbJournals journalsR; //
+    bool journalLoadSuccessL = false;
+    bool journalLoadSuccessR = false;
     {
         bool loadSuccessL = false;
         bool loadSuccessR = false;
@@ -882,21 +1595,41 @@ void fff::saveLastSynchronousState(const BaseFolderPair& baseFolder, bool transa
             loadSuccess = errMsg.empty();
         });
 
+        for (const auto& [journalPath, journalsOut, loadSuccess] :
+             {
+                 std::tuple(journalPathL, &journalsL, &journalLoadSuccessL),
+                 std::tuple(journalPathR, &journalsR, &journalLoadSuccessR)
+             })
+            parallelWorkload.emplace_back(journalPath, [&journalsOut = *journalsOut, &loadSuccess = *loadSuccess](ParallelContext& ctx) //throw ThreadStopRequest
+        {
+            StreamStatusNotifier notifyLoad(replaceCpy(_("Loading file %x..."), L"%x", fmtPath(AFS::getDisplayPath(ctx.itemPath))), ctx.acb);
+
+            const std::wstring errMsg = tryReportingError([&] //throw ThreadStopRequest
+            {
+                try { journalsOut = ::loadJournals(ctx.itemPath, notifyLoad); } //throw FileError, FileErrorDatabaseNotExisting, ThreadStopRequest
+                catch (FileErrorDatabaseNotExisting&) {}
+            }, ctx.acb);
+            loadSuccess = errMsg.empty();
+        });
+
         massParallelExecute(parallelWorkload,
                             Zstr("Load sync.ffs_db"), callback /*throw X*/); //throw X
 
         if (!loadSuccessL || !loadSuccessR)
-            return; /* don't continue when one of the two files failed to load (e.g. network drop):
+            return false; /* don't continue when one of the two files failed to load (e.g. network drop):
                        no common session would be found, (although it may exist!) =>
                            a) if file also fails to save: new orphan session in the other file created
                            b) if file saves successfully: previous stream sessions lost + old session in other file not cleaned up (orphan)       */
+        //journal failed to load: not fatal => save full database, but don't overwrite the (unreadable) journal file
     }
     //----------------------------------------------------------------
 
     //load last synchrounous state
     auto itStreamOldL = streamsL.cend();
     auto itStreamOldR = streamsR.cend();
+    const JournalData* journalOld = nullptr;
     InSyncFolder lastSyncState(InSyncFolder::DIR_STATUS_IN_SYNC);
+    bool lastSyncStateValid = false;
     try
     {
         //find associated session: there can be at most one session within intersection of left and right IDs
@@ -904,17 +1637,119 @@ void fff::saveLastSynchronousState(const BaseFolderPair& baseFolder, bool transa
                                                                  AFS::getDisplayPath(dbPathL),
                                                                  AFS::getDisplayPath(dbPathR)); //throw FileError
         if (itStreamOldL != streamsL.end())
+        {
             lastSyncState = std::move(StreamParser::execute(itStreamOldL->second.isLeadStream /*leadStreamLeft*/,
                                                             itStreamOldL->second.rawStream,
                                                             itStreamOldR->second.rawStream,
                                                             AFS::getDisplayPath(dbPathL),
-                                                            AFS::getDisplayPath(dbPathR)).ref()); //throw FileError
+                                                            AFS::getDisplayPath(dbPathR),
+                                                            nullptr /*namePool*/).ref()); //throw FileError
+            if (journalLoadSuccessL && journalLoadSuccessR)
+                if ((journalOld = findCommonJournal(journalsL, journalsR, itStreamOldL->first)))
+                    try
+                    {
+                        applyJournal(lastSyncState, *journalOld); //throw SysError
+                    }
+                    catch (const SysError& e)
+                    {
+                        journalOld = nullptr;
+                        lastSyncState = InSyncFolder(InSyncFolder::DIR_STATUS_IN_SYNC); //journal might be partially applied
+                        throw FileError(replaceCpy(_("Cannot read database file %x."), L"%x", fmtPath(AFS::getDisplayPath(journalPathL))), e.toString());
+                    }
+            lastSyncStateValid = true;
+        }
     }
     catch (const FileError& e) { callback.reportFatalError(e.toString()); } //throw X
     //if database files are corrupted: just overwrite! User is already informed about errors right after comparing!
 
+    //journal can be continued only if it is consistent with the database: either applied successfully, or not yet started
+    const bool continueJournal = useJournal && lastSyncStateValid && journalLoadSuccessL && journalLoadSuccessR &&
+                                 (journalOld ? journalOld->isLeadStream : //folder pair swapped? => can't append records with different orientation
+                                  !journalsL.contains(itStreamOldL->first) &&
+                                  !journalsR.contains(itStreamOldR->first));
     //update last synchrounous state
-    LastSynchronousStateUpdater::execute(baseFolder, lastSyncState);
+    JournalRecorder journalNew;
+    LastSynchronousStateUpdater::execute(baseFolder, lastSyncState, continueJournal ? &journalNew : nullptr);
+
+    //------------ journal: save changes only -------------------------
+    if (continueJournal)
+    {
+        if (journalNew.getRecordCount() == 0)
+            return true; //some users monitor the *.ffs_db file with RTS => don't touch the file if it isnt't strictly needed
+
+        JournalData journalDataL;
+        journalDataL.journalID    = zen::generateGUID();
+        journalDataL.isLeadStream = true;
+        journalDataL.saveCount    = (journalOld ? journalOld->saveCount   : 0) + 1;
+        journalDataL.recordCount  = (journalOld ? journalOld->recordCount : 0) + journalNew.getRecordCount();
+        journalDataL.codec        = DB_STREAM_CODEC;
+
+        if (const std::wstring errMsg = tryReportingError([&] //throw X
+    {
+        try
+        {
+            std::string records;
+            if (journalOld)
+                records = decompressDbStream(journalOld->recordsCompressed, journalOld->codec); //throw SysError
+            records += journalNew.getRecords();
+
+            journalDataL.recordsCompressed = compressDbStream(records); //throw SysError
+        }
+        catch (const SysError& e)
+        {
+            throw FileError(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(AFS::getDisplayPath(journalPathL))), e.toString());
+        }
+    }, callback /*throw X*/); !errMsg.empty())
+        return false;
+
+        //compact into full database if journal is becoming too large: loading it is not free either
+        const size_t dbSize = itStreamOldL->second.rawStream.size() + itStreamOldR->second.rawStream.size();
+
+        if (journalDataL.saveCount <= DB_JOURNAL_SAVES_MAX &&
+            journalDataL.recordsCompressed.size() <= dbSize * DB_JOURNAL_SIZE_RATIO_MAX)
+        {
+            JournalData journalDataR = journalDataL; //journal size is small => copy is okay
+            journalDataR.isLeadStream = false;
+
+            const UniqueId& sessionID = itStreamOldL->first;
+            assert(sessionID == itStreamOldR->first);
+
+            //remove journals of sessions that no longer exist in the database files
+            std::erase_if(journalsL, [&](const DbJournals::value_type& v) { return !streamsL.contains(v.first); });
+            std::erase_if(journalsR, [&](const DbJournals::value_type& v) { return !streamsR.contains(v.first); });
+
+            journalsL[sessionID] = std::move(journalDataL);
+            journalsR[sessionID] = std::move(journalDataR);
+
+            //------------ save journal files in parallel -------------------------
+            std::vector<std::pair<AbstractPath, ParallelWorkItem>> parallelWorkload;
+            bool saveOkL = false;
+            bool saveOkR = false;
+
+            for (const auto& [journalPath, journals, saveOk] :
+                 {
+                     std::tuple(journalPathL, &journalsL, &saveOkL),
+                     std::tuple(journalPathR, &journalsR, &saveOkR)
+                 })
+                parallelWorkload.emplace_back(journalPath, [&journals = *journals, &saveOk = *saveOk, transactionalCopy](ParallelContext& ctx) //throw ThreadStopRequest
+            {
+                saveOk = tryReportingError([&] //throw ThreadStopRequest
+                {
+                    StreamStatusNotifier notifySave(replaceCpy(_("Saving file %x..."), L"%x", fmtPath(AFS::getDisplayPath(ctx.itemPath))), ctx.acb);
+
+                    saveDbFileTransactional(ctx.itemPath, transactionalCopy, [&](const AbstractPath& filePath) //throw FileError, ThreadStopRequest
+                    {
+                        saveJournals(journals, filePath, notifySave); //throw FileError, ThreadStopRequest
+                    });
+                }, ctx.acb).empty();
+            });
+
+            massParallelExecute(parallelWorkload,
+                                Zstr("Save sync.ffs_db"), callback /*throw X*/); //throw X
+            return saveOkL && saveOkR;
+        }
+    }
+    //------------ full database -------------------------
 
     //serialize again
     SessionData sessionDataL = {};
@@ -930,12 +1765,12 @@ void fff::saveLastSynchronousState(const BaseFolderPair& baseFolder, bool transa
                              sessionDataL.rawStream,
                              sessionDataR.rawStream);
     }, callback /*throw X*/); !errMsg.empty())
-    return;
+    return false;
 
     //check if there is some work to do at all
     if (itStreamOldL != streamsL.end() && itStreamOldL->second == sessionDataL &&
-        itStreamOldR != streamsR.end() && itStreamOldR->second == sessionDataR)
-        return; //some users monitor the *.ffs_db file with RTS => don't touch the file if it isnt't strictly needed
+        itStreamOldR != streamsR.end() && itStreamOldR->second == sessionDataR && !journalOld)
+        return true; //some users monitor the *.ffs_db file with RTS => don't touch the file if it isnt't strictly needed
 
     //erase old session data
     if (itStreamOldL != streamsL.end())
@@ -949,46 +1784,53 @@ void fff::saveLastSynchronousState(const BaseFolderPair& baseFolder, bool transa
     streamsL[sessionID] = std::move(sessionDataL);
     streamsR[sessionID] = std::move(sessionDataR);
 
+    //journals of the old session are obsolete now => clean up, but only if the journal file is readable
+    const size_t journalCountOldL = journalsL.size();
+    const size_t journalCountOldR = journalsR.size();
+    std::erase_if(journalsL, [&](const DbJournals::value_type& v) { return !streamsL.contains(v.first); });
+    std::erase_if(journalsR, [&](const DbJournals::value_type& v) { return !streamsR.contains(v.first); });
+
+    const bool updateJournalL = journalLoadSuccessL && journalsL.size() != journalCountOldL;
+    const bool updateJournalR = journalLoadSuccessR && journalsR.size() != journalCountOldR;
+
     //------------ save DB files in parallel -------------------------
+    bool saveOkL = false;
+    bool saveOkR = false;
     {
         std::vector<std::pair<AbstractPath, ParallelWorkItem>> parallelWorkload;
 
-        for (const auto& [dbPath, streams] :
+        for (const auto& [dbPath, streams, journalPath, journals, updateJournal, saveOk] :
              {
-                 std::pair(dbPathL, &streamsL),
-                 std::pair(dbPathR, &streamsR)
+                 std::tuple(dbPathL, &streamsL, journalPathL, &journalsL, updateJournalL, &saveOkL),
+                 std::tuple(dbPathR, &streamsR, journalPathR, &journalsR, updateJournalR, &saveOkR)
              })
-            parallelWorkload.emplace_back(dbPath, [&streams = *streams, transactionalCopy](ParallelContext& ctx) //throw ThreadStopRequest
+            parallelWorkload.emplace_back(dbPath, [&streams = *streams, &journalPath = journalPath, &journals = *journals, updateJournal = updateJournal, &saveOk = *saveOk, transactionalCopy](ParallelContext& ctx) //throw ThreadStopRequest
         {
-            tryReportingError([&] //throw ThreadStopRequest
+            saveOk = tryReportingError([&] //throw ThreadStopRequest
             {
                 StreamStatusNotifier notifySave(replaceCpy(_("Saving file %x..."), L"%x", fmtPath(AFS::getDisplayPath(ctx.itemPath))), ctx.acb);
 
-                if (transactionalCopy && !AFS::hasNativeTransactionalCopy(ctx.itemPath))
+                saveDbFileTransactional(ctx.itemPath, transactionalCopy, [&](const AbstractPath& filePath) //throw FileError, ThreadStopRequest
                 {
-                    //write (temp-) files as a transaction
-                    const Zstring shortGuid = printNumber<Zstring>(Zstr("%04x"), static_cast<unsigned int>(getCrc16(generateGUID())));
-                    const AbstractPath dbPathTmp = AFS::appendRelPath(*AFS::getParentPath(ctx.itemPath), AFS::getItemName(ctx.itemPath) + Zstr('.') + shortGuid + AFS::TEMP_FILE_ENDING);
-
-                    saveStreams(streams, dbPathTmp, notifySave); //throw FileError, ThreadStopRequest
-                    ZEN_ON_SCOPE_FAIL(try { AFS::removeFilePlain(dbPathTmp); }
-                    catch (FileError&) {});
-
-                    //operation finished: rename temp file -> this should work (almost) transactionally:
-                    //if there were no write access, creation of temp file would have failed
-                    AFS::removeFileIfExists(ctx.itemPath);           //throw FileError
-                    AFS::moveAndRenameItem(dbPathTmp, ctx.itemPath); //throw FileError, (ErrorMoveUnsupported)
-                }
-                else //some MTP devices don't even allow renaming files: https://freefilesync.org/forum/viewtopic.php?t=6531
+                    saveStreams(streams, filePath, notifySave); //throw FileError, ThreadStopRequest
+                });
+
+                if (updateJournal)
                 {
-                    AFS::removeFileIfExists(ctx.itemPath);          //throw FileError
-                    saveStreams(streams, ctx.itemPath, notifySave); //throw FileError, ThreadStopRequest
+                    if (journals.empty())
+                        AFS::removeFileIfExists(journalPath); //throw FileError
+                    else
+                        saveDbFileTransactional(journalPath, transactionalCopy, [&](const AbstractPath& filePath) //throw FileError, ThreadStopRequest
+                    {
+                        saveJournals(journals, filePath, notifySave); //throw FileError, ThreadStopRequest
+                    });
                 }
-            }, ctx.acb);
+            }, ctx.acb).empty();
         });
 
         massParallelExecute(parallelWorkload,
                             Zstr("Save sync.ffs_db"), callback /*throw X*/); //throw X
     }
     //----------------------------------------------------------------
+    return saveOkL && saveOkR;
 }
@@ -10,6 +10,7 @@
 #include <unordered_map>
 #include <zen/file_error.h>
 #include "file_hierarchy.h"
+#include "item_name_pool.h"
 #include "process_callback.h"
 
 
@@ -25,6 +26,8 @@ struct InSyncDescrFile //subset of FileAttributes
 
     time_t modTime = 0;
     AFS::FingerPrint filePrint = 0; //optional!
+
+    bool operator==(const InSyncDescrFile&) const = default;
 };
 
 struct InSyncDescrLink
@@ -32,6 +35,8 @@ struct InSyncDescrLink
     explicit InSyncDescrLink(time_t modTimeIn) : modTime(modTimeIn) {}
 
     time_t modTime = 0;
+
+    bool operator==(const InSyncDescrLink&) const = default;
 };
 
 
@@ -43,6 +48,8 @@ struct InSyncFile
     InSyncDescrFile right; //
     CompareVariant cmpVar = CompareVariant::timeSize; //the one active while finding "file in sync"
     uint64_t fileSize = 0; //file size must be identical on both sides!
+
+    bool operator==(const InSyncFile&) const = default;
 };
 
 struct InSyncSymlink
@@ -51,6 +58,8 @@ struct InSyncSymlink
     InSyncDescrLink left;
     InSyncDescrLink right;
     CompareVariant cmpVar = CompareVariant::timeSize;
+
+    bool operator==(const InSyncSymlink&) const = default;
 };
 
 struct InSyncFolder
@@ -68,8 +77,8 @@ struct InSyncFolder
 
     //------------------------------------------------------------------
     using FolderList  = std::unordered_map<ZstringNorm, InSyncFolder >; //
-    using FileList    = std::unordered_map<ZstringNorm, InSyncFile   >; // key: file name (ignoring Unicode normal forms)
-    using SymlinkList = std::unordered_map<ZstringNorm, InSyncSymlink>; //
+    using FileList    = zen::FlatMap      <ZstringNorm, InSyncFile   >; // key: file name (ignoring Unicode normal forms)
+    using SymlinkList = zen::FlatMap      <ZstringNorm, InSyncSymlink>; //
     //------------------------------------------------------------------
 
     FolderList  folders;
@@ -95,9 +104,12 @@ struct InSyncFolder
 
 
 std::unordered_map<const BaseFolderPair*, zen::SharedRef<const InSyncFolder>> loadLastSynchronousState(const std::vector<const BaseFolderPair*>& baseFolders,
+                                                                           ItemNamePool* namePool, //optional: share item name storage with the comparison result
                                                                            PhaseCallback& callback /*throw X*/); //throw X
 
-void saveLastSynchronousState(const BaseFolderPair& baseFolder, bool transactionalCopy, //throw X
+//return false if the database could not be updated (errors are reported via callback)
+bool saveLastSynchronousState(const BaseFolderPair& baseFolder, bool transactionalCopy, //throw X
+                              bool useJournal, //save changes to separate journal files instead of rewriting the database (if possible)
                               PhaseCallback& callback /*throw X*/);
 }
 
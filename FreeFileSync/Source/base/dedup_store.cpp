@@ -0,0 +1,390 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#include "dedup_store.h"
+#include <array>
+#include <unordered_set>
+#include <zen/crc.h>
+#include <zen/guid.h>
+#include <zen/open_ssl.h>
+#include <zen/serialize.h>
+
+using namespace zen;
+using namespace fff;
+
+
+namespace
+{
+const Zchar DEDUP_CHUNK_FOLDER_NAME[] = Zstr(".ffs_chunks");
+
+//average chunk size ~ CHUNK_SIZE_MIN + 1 MiB: few enough chunk files for multi-GB database dumps, yet small enough to deduplicate partial changes
+const size_t CHUNK_SIZE_MIN = 256 * 1024;
+const size_t CHUNK_SIZE_MAX = 4 * 1024 * 1024;
+const uint64_t CHUNK_BOUNDARY_MASK = uint64_t(0xfffff) << 44; //20 bits => boundary every 2^20 bytes on average
+
+const size_t CHUNK_HASH_SIZE = 32; //SHA-256
+
+const char DEDUP_MANIFEST_DESCR[] = "FreeFileSync Version";
+const int DEDUP_MANIFEST_VERSION = 1; //2026-10-15
+
+
+//splitmix64 with fixed seed: chunk boundaries must never change, or existing chunks can't be reused anymore!
+constexpr std::array<uint64_t, 256> GEAR_TABLE = []
+{
+    std::array<uint64_t, 256> table{};
+    uint64_t state = 0;
+    for (uint64_t& val : table)
+    {
+        uint64_t z = (state += 0x9e3779b97f4a7c15);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+        val = z ^ (z >> 31);
+    }
+    return table;
+}();
+
+
+/*  gear hash: h = (h << 1) + GEAR[byte] => bit k of h depends on the last k + 1 bytes only
+    => boundary decision is a function of the last 64 bytes: same content, same boundaries, no matter what came before  */
+class ContentChunker
+{
+public:
+    //consume bytes up to and including the next chunk boundary: returns {bytes consumed, boundary found}
+    std::pair<size_t, bool> feed(const unsigned char* data, size_t len)
+    {
+        size_t pos = 0;
+        if (chunkSize_ + 64 < CHUNK_SIZE_MIN) //no boundary allowed yet => no need to hash bytes that are shifted out anyway
+        {
+            pos = std::min(len, CHUNK_SIZE_MIN - 64 - chunkSize_);
+            chunkSize_ += pos;
+        }
+
+        for (; pos < len; ++pos)
+        {
+            hash_ = (hash_ << 1) + GEAR_TABLE[data[pos]];
+            ++chunkSize_;
+
+            if ((chunkSize_ >= CHUNK_SIZE_MIN && (hash_ & CHUNK_BOUNDARY_MASK) == 0) || chunkSize_ >= CHUNK_SIZE_MAX)
+            {
+                chunkSize_ = 0;
+                hash_ = 0;
+                return {pos + 1, true};
+            }
+        }
+        return {len, false};
+    }
+
+private:
+    size_t chunkSize_ = 0;
+    uint64_t hash_ = 0;
+};
+
+
+struct ChunkRef
+{
+    std::string hash; //SHA-256: raw bytes
+    uint32_t size = 0;
+};
+
+struct DedupManifest
+{
+    time_t modTime = 0;
+    uint64_t fileSize = 0;
+    std::vector<ChunkRef> chunks;
+};
+
+
+std::string calcChunkHash(const std::string& chunk) //throw SysError
+{
+    HashStream hashStream(HashAlgorithm::sha256); //throw SysError
+    hashStream.update(chunk.data(), chunk.size()); //throw SysError
+    return hashStream.finalize(); //throw SysError
+}
+
+
+AbstractPath getChunkPath(const AbstractPath& chunkFolderPath, const std::string& hash)
+{
+    const Zstring chunkName = utfTo<Zstring>(formatAsHexString(hash));
+    //256 sub folders: keep folder sizes reasonable even for millions of chunks
+    return AFS::appendRelPath(chunkFolderPath, Zstring(chunkName.begin(), chunkName.begin() + 2) + FILE_NAME_SEPARATOR + chunkName);
+}
+
+
+void writeFileCreatingParent(const AbstractPath& filePath, const std::string& byteStream) //throw FileError
+{
+    auto writeFile = [&] //throw FileError
+    {
+        //already existing: undefined behavior! (e.g. fail/overwrite/auto-rename)
+        const std::unique_ptr<AFS::OutputStream> fileStreamOut = AFS::getOutputStream(filePath, //throw FileError
+                                                                                      byteStream.size(),
+                                                                                      std::nullopt /*modTime*/,
+                                                                                      nullptr /*notifyUnbufferedIO*/);
+        fileStreamOut->write(byteStream.c_str(), byteStream.size()); //throw FileError
+        fileStreamOut->finalize();                                   //throw FileError
+    };
+
+    try
+    {
+        writeFile(); //throw FileError
+    }
+    catch (FileError&) //parent folder missing => create + retry
+    {
+        if (const std::optional<AbstractPath> parentPath = AFS::getParentPath(filePath))
+            AFS::createFolderIfMissingRecursion(*parentPath); //throw FileError
+        writeFile(); //throw FileError
+    }
+}
+
+
+bool chunkExists(const AbstractPath& chunkPath) //noexcept
+{
+    try
+    {
+        AFS::getItemType(chunkPath); //throw FileError
+        return true;
+    }
+    catch (FileError&) { return false; } //not existing (or access error: let the next file operation report it)
+}
+
+
+void writeChunkIfMissing(const AbstractPath& chunkPath, const std::string& chunk) //throw FileError
+{
+    if (chunkExists(chunkPath)) //the common case for unchanged parts of a file
+        return;
+
+    //write to temp file + rename: an interrupted write must never leave a truncated chunk under its final name!
+    const uint16_t shortGuid = static_cast<uint16_t>(getCrc16(generateGUID()));
+    const AbstractPath tmpPath = AFS::appendRelPath(*AFS::getParentPath(chunkPath), AFS::getItemName(chunkPath) + Zstr('.') +
+                                                    printNumber<Zstring>(Zstr("%04x"), static_cast<unsigned int>(shortGuid)) + AFS::TEMP_FILE_ENDING);
+    writeFileCreatingParent(tmpPath, chunk); //throw FileError
+    try
+    {
+        //already existing: undefined behavior! (e.g. fail/overwrite)
+        AFS::moveAndRenameItem(tmpPath, chunkPath); //throw FileError, ErrorMoveUnsupported
+    }
+    catch (FileError&)
+    {
+        try { AFS::removeFilePlain(tmpPath); /*throw FileError*/ }
+        catch (FileError&) {}
+
+        if (chunkExists(chunkPath)) //same chunk stored by a parallel thread in the meantime
+            return;
+        throw;
+    }
+}
+
+
+std::string serializeManifest(const DedupManifest& manifest)
+{
+    MemoryStreamOut<std::string> streamOut;
+    writeArray(streamOut, DEDUP_MANIFEST_DESCR, sizeof(DEDUP_MANIFEST_DESCR));
+    writeNumber<int32_t>(streamOut, DEDUP_MANIFEST_VERSION);
+
+    writeNumber<int64_t> (streamOut, manifest.modTime);
+    writeNumber<uint64_t>(streamOut, manifest.fileSize);
+    writeNumber<uint32_t>(streamOut, static_cast<uint32_t>(manifest.chunks.size()));
+
+    for (const ChunkRef& ref : manifest.chunks)
+    {
+        assert(ref.hash.size() == CHUNK_HASH_SIZE);
+        writeArray(streamOut, ref.hash.data(), ref.hash.size());
+        writeNumber<uint32_t>(streamOut, ref.size);
+    }
+    writeNumber<uint32_t>(streamOut, getCrc32(streamOut.ref()));
+    return streamOut.ref();
+}
+
+
+DedupManifest loadManifest(const AbstractPath& manifestPath) //throw FileError
+{
+    const std::unique_ptr<AFS::InputStream> fileStreamIn = AFS::getInputStream(manifestPath, nullptr /*notifyUnbufferedIO*/); //throw FileError, ErrorFileLocked
+    const std::string byteStream = bufferedLoad<std::string>(*fileStreamIn); //throw FileError, ErrorFileLocked
+    try
+    {
+        MemoryStreamIn streamIn(byteStream);
+
+        char formatDescr[sizeof(DEDUP_MANIFEST_DESCR)] = {};
+        readArray(streamIn, formatDescr, sizeof(formatDescr)); //throw SysErrorUnexpectedEos
+
+        if (!std::equal(DEDUP_MANIFEST_DESCR, DEDUP_MANIFEST_DESCR + sizeof(DEDUP_MANIFEST_DESCR), formatDescr))
+            throw SysError(_("File content is corrupted.") + L" (invalid header)");
+
+        const int version = readNumber<int32_t>(streamIn); //throw SysErrorUnexpectedEos
+        if (version != DEDUP_MANIFEST_VERSION)
+            throw SysError(_("Unsupported data format.") + L' ' + replaceCpy(_("Version: %x"), L"%x", numberTo<std::wstring>(version)));
+
+        MemoryStreamOut<std::string> crcStreamOut;
+        writeNumber<uint32_t>(crcStreamOut, getCrc32(byteStream.begin(), byteStream.end() - std::min(byteStream.size(), sizeof(uint32_t))));
+        if (!endsWith(byteStream, crcStreamOut.ref()))
+            throw SysError(_("File content is corrupted.") + L" (invalid checksum)");
+
+        DedupManifest manifest;
+        manifest.modTime  = readNumber<int64_t >(streamIn); //throw SysErrorUnexpectedEos
+        manifest.fileSize = readNumber<uint64_t>(streamIn); //
+
+        size_t chunkCount = readNumber<uint32_t>(streamIn); //throw SysErrorUnexpectedEos
+        while (chunkCount-- != 0)
+        {
+            ChunkRef ref;
+            ref.hash.resize(CHUNK_HASH_SIZE);
+            readArray(streamIn, ref.hash.data(), ref.hash.size()); //throw SysErrorUnexpectedEos
+            ref.size = readNumber<uint32_t>(streamIn);              //
+            manifest.chunks.push_back(std::move(ref));
+        }
+        return manifest;
+    }
+    catch (const SysError& e) { throw FileError(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(AFS::getDisplayPath(manifestPath))), e.toString()); }
+}
+}
+
+
+AbstractPath fff::getDedupChunkFolderPath(const AbstractPath& versioningFolderPath)
+{
+    return AFS::appendRelPath(versioningFolderPath, DEDUP_CHUNK_FOLDER_NAME);
+}
+
+
+void fff::storeDedupVersion(const AbstractPath& filePath, time_t modTime, //throw FileError, ErrorFileLocked, X
+                            const AbstractPath& versioningFolderPath, const AbstractPath& manifestPath,
+                            const IoCallback& notifyUnbufferedIO /*throw X*/)
+{
+    const AbstractPath chunkFolderPath = getDedupChunkFolderPath(versioningFolderPath);
+
+    DedupManifest manifest;
+    manifest.modTime = modTime;
+    std::string chunk;
+
+    auto storeChunk = [&] //throw FileError
+    {
+        std::string hash;
+        try
+        {
+            hash = calcChunkHash(chunk); //throw SysError
+        }
+        catch (const SysError& e) { throw FileError(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(AFS::getDisplayPath(filePath))), e.toString()); }
+
+        writeChunkIfMissing(getChunkPath(chunkFolderPath, hash), chunk); //throw FileError
+
+        manifest.chunks.push_back({std::move(hash), static_cast<uint32_t>(chunk.size())});
+        chunk.clear();
+    };
+
+    const std::unique_ptr<AFS::InputStream> fileStreamIn = AFS::getInputStream(filePath, notifyUnbufferedIO); //throw FileError, ErrorFileLocked
+
+    const size_t blockSize = fileStreamIn->getBlockSize();
+    std::vector<unsigned char> buffer(blockSize);
+    ContentChunker chunker;
+
+    for (;;)
+    {
+        const size_t bytesRead = fileStreamIn->read(buffer.data(), blockSize); //throw FileError, ErrorFileLocked, X
+        manifest.fileSize += bytesRead;
+
+        for (size_t pos = 0; pos < bytesRead;)
+        {
+            const auto [bytesConsumed, boundaryFound] = chunker.feed(&buffer[pos], bytesRead - pos);
+            chunk.append(reinterpret_cast<const char*>(&buffer[pos]), bytesConsumed);
+            pos += bytesConsumed;
+
+            if (boundaryFound)
+                storeChunk(); //throw FileError
+        }
+        if (bytesRead != blockSize) //end of file
+            break;
+    }
+    if (!chunk.empty())
+        storeChunk(); //throw FileError
+
+    //write manifest *after* all chunks: a manifest must never reference missing chunks
+    AFS::removeFileIfExists(manifestPath); //throw FileError
+    writeFileCreatingParent(manifestPath, serializeManifest(manifest)); //throw FileError
+}
+
+
+void fff::restoreDedupVersion(const AbstractPath& manifestPath, const AbstractPath& targetPath, //throw FileError, X
+                              const IoCallback& notifyUnbufferedIO /*throw X*/)
+{
+    const DedupManifest manifest = loadManifest(manifestPath); //throw FileError
+
+    const AbstractPath chunkFolderPath = [&]
+    {
+        for (std::optional<AbstractPath> folderPath = AFS::getParentPath(manifestPath); folderPath; folderPath = AFS::getParentPath(*folderPath))
+            if (const AbstractPath chunkFolderPathTmp = getDedupChunkFolderPath(*folderPath);
+                chunkExists(chunkFolderPathTmp)) //noexcept
+                return chunkFolderPathTmp;
+
+        throw FileError(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(AFS::getDisplayPath(manifestPath))),
+                        replaceCpy(_("Cannot find folder %x."), L"%x", fmtPath(DEDUP_CHUNK_FOLDER_NAME)));
+    }();
+
+    //transactional output stream: partial file is deleted on error
+    const std::unique_ptr<AFS::OutputStream> fileStreamOut = AFS::getOutputStream(targetPath, manifest.fileSize, manifest.modTime, notifyUnbufferedIO); //throw FileError
+
+    for (const ChunkRef& ref : manifest.chunks)
+    {
+        const AbstractPath chunkPath = getChunkPath(chunkFolderPath, ref.hash);
+
+        const std::unique_ptr<AFS::InputStream> chunkStreamIn = AFS::getInputStream(chunkPath, nullptr /*notifyUnbufferedIO*/); //throw FileError, ErrorFileLocked
+        const std::string chunk = bufferedLoad<std::string>(*chunkStreamIn); //throw FileError, ErrorFileLocked
+        try
+        {
+            //verify: a damaged chunk would silently corrupt every version referencing it
+            if (chunk.size() != ref.size || calcChunkHash(chunk) != ref.hash) //throw SysError
+                throw SysError(_("File content is corrupted."));
+        }
+        catch (const SysError& e) { throw FileError(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(AFS::getDisplayPath(chunkPath))), e.toString()); }
+
+        fileStreamOut->write(chunk.data(), chunk.size()); //throw FileError, X
+    }
+    fileStreamOut->finalize(); //throw FileError, X
+}
+
+
+void fff::removeUnreferencedChunks(const AbstractPath& versioningFolderPath, const std::vector<AbstractPath>& manifestPaths) //throw FileError
+{
+    std::unordered_set<std::string> referencedChunks; //SHA-256: raw bytes
+    for (const AbstractPath& manifestPath : manifestPaths)
+        for (ChunkRef& ref : loadManifest(manifestPath).chunks) //throw FileError
+            referencedChunks.insert(std::move(ref.hash));
+
+    const AbstractPath chunkFolderPath = getDedupChunkFolderPath(versioningFolderPath);
+
+    std::vector<Zstring> subFolderNames;
+    AFS::traverseFolderFlat(chunkFolderPath, nullptr /*onFile*/, //throw FileError
+    [&](const AFS::FolderInfo& fi) { subFolderNames.push_back(fi.itemName); }, nullptr /*onSymlink*/);
+
+    for (const Zstring& subFolderName : subFolderNames)
+    {
+        const AbstractPath subFolderPath = AFS::appendRelPath(chunkFolderPath, subFolderName);
+
+        std::vector<Zstring> chunkNames;
+        AFS::traverseFolderFlat(subFolderPath, [&](const AFS::FileInfo& fi) { chunkNames.push_back(fi.itemName); }, //throw FileError
+        nullptr /*onFolder*/, nullptr /*onSymlink*/);
+
+        size_t chunksRemaining = chunkNames.size();
+        for (const Zstring& chunkName : chunkNames)
+        {
+            const std::string chunkNameUtf = utfTo<std::string>(chunkName);
+            //temp files: might be in use by a running storeDedupVersion() => leave alone
+            if (chunkNameUtf.size() != 2 * CHUNK_HASH_SIZE ||
+                !std::all_of(chunkNameUtf.begin(), chunkNameUtf.end(), [](char c) { return isHexDigit(c); }))
+                continue;
+
+            std::string hash;
+            for (size_t i = 0; i < chunkNameUtf.size(); i += 2)
+                hash += unhexify(chunkNameUtf[i], chunkNameUtf[i + 1]);
+
+            if (!referencedChunks.contains(hash))
+            {
+                AFS::removeFilePlain(AFS::appendRelPath(subFolderPath, chunkName)); //throw FileError
+                --chunksRemaining;
+            }
+        }
+        if (chunksRemaining == 0)
+            try { AFS::removeEmptyFolderIfExists(subFolderPath); /*throw FileError*/ }
+            catch (FileError&) {} //not critical: e.g. other (temp) items
+    }
+}
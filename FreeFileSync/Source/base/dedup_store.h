@@ -0,0 +1,41 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#ifndef DEDUP_STORE_H_5820193746502817364
+#define DEDUP_STORE_H_5820193746502817364
+
+#include <zen/file_error.h>
+#include "structures.h"
+
+
+namespace fff
+{
+/*  deduplicating version store: VersioningStyle::deduplicate
+    - file content is split at content-defined boundaries (gear rolling hash) => insertions and deletions only change the chunks around them
+    - each unique chunk is stored once:    <versioning folder>/.ffs_chunks/<ab>/<abcdef...> (SHA-256)
+    - each file version is a small manifest: <versioning folder>/<relpath>/Sample.txt 2012-05-15 131513.txt.ffs_ver
+
+    - multi-threading: storeDedupVersion() may be called concurrently (same chunk stored twice => identical content)
+    - don't share the versioning folder with jobs running at the same time: removeUnreferencedChunks() only knows the manifests it is given! */
+inline const Zchar* const DEDUP_MANIFEST_ENDING = Zstr(".ffs_ver"); //don't use Zstring as global constant: avoid static initialization order problem
+
+AbstractPath getDedupChunkFolderPath(const AbstractPath& versioningFolderPath);
+
+//file content => chunks + manifest (replaced if existing); source file is not modified
+void storeDedupVersion(const AbstractPath& filePath, time_t modTime, //throw FileError, ErrorFileLocked, X
+                       const AbstractPath& versioningFolderPath, const AbstractPath& manifestPath,
+                       const zen::IoCallback& notifyUnbufferedIO /*throw X*/);
+
+//manifest + chunks => file (already existing: undefined behavior!)
+//chunk store is found by searching the parent folders of the manifest => versioning folder may be moved or copied as a whole
+void restoreDedupVersion(const AbstractPath& manifestPath, const AbstractPath& targetPath, //throw FileError, X
+                         const zen::IoCallback& notifyUnbufferedIO /*throw X*/);
+
+//mark and sweep: manifestPaths must be *all* manifests of the versioning folder; unreadable manifest => nothing is deleted
+void removeUnreferencedChunks(const AbstractPath& versioningFolderPath, const std::vector<AbstractPath>& manifestPaths); //throw FileError
+}
+
+#endif //DEDUP_STORE_H_5820193746502817364
@@ -0,0 +1,149 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#include "device_budget.h"
+#include <zen/file_access.h>
+#include <zen/thread.h>
+    #include <fcntl.h>    //open()
+    #include <unistd.h>   //close()
+    #include <sys/file.h> //flock()
+
+using namespace zen;
+using namespace fff;
+using AFS = AbstractFileSystem;
+
+
+namespace
+{
+const std::chrono::milliseconds DEVICE_BUDGET_POLL_INTERVAL(50);
+
+
+Zstring getSlotLockFilePath(const AfsDevice& afsDevice, size_t slotIdx) //throw FileError
+{
+    //device root path phrase identifies the device across processes; hash: don't leak user/server names into the temp folder
+    const Zstring rootPhrase = AFS::getInitPathPhrase(AbstractPath(afsDevice, AfsPath()));
+
+    return appendPath(getTempFolderPath(), //throw FileError
+                      Zstr("FreeFileSync device ") + printNumber<Zstring>(Zstr("%016llx"), static_cast<unsigned long long>(hashString<uint64_t>(rootPhrase))) +
+                      Zstr('.') + numberTo<Zstring>(slotIdx) + Zstr(".lock"));
+}
+}
+
+
+DeviceBudget::DeviceBudget(const std::map<AfsDevice, size_t>& deviceSlots) //throw FileError
+{
+    ZEN_ON_SCOPE_FAIL(for (const std::vector<Slot>& slots : deviceSlots_)
+                          for (const Slot& slot : slots)
+                              ::close(slot.fdLockFile));
+
+    for (const auto& [afsDevice, slotCount] : deviceSlots)
+    {
+        assert(slotCount > 0);
+        std::vector<Slot>& slots = deviceSlots_.emplace_back();
+
+        for (size_t slotIdx = 0; slotIdx < slotCount; ++slotIdx)
+        {
+            const Zstring lockFilePath = getSlotLockFilePath(afsDevice, slotIdx); //throw FileError
+
+            //lock files are never deleted: removing a file another process is about to flock() would split the slot
+            const int fdLockFile = ::open(lockFilePath.c_str(), O_RDONLY | O_CREAT | O_CLOEXEC,
+                                          S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH); //0666 => budget shared with other users (subject to umask)
+            if (fdLockFile == -1)
+                THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot open file %x."), L"%x", fmtPath(lockFilePath)), "open");
+
+            slots.push_back({fdLockFile});
+        }
+    }
+}
+
+
+DeviceBudget::~DeviceBudget()
+{
+    for (const std::vector<Slot>& slots : deviceSlots_)
+        for (const Slot& slot : slots)
+        {
+            assert(!slot.taken);
+            ::close(slot.fdLockFile); //releases the flock() => slot free for other processes
+        }
+}
+
+
+DeviceBudget::Reservation::~Reservation()
+{
+    if (budget_)
+    {
+        std::lock_guard dummy(budget_->lockSlots_);
+        budget_->release(slotIdxs_);
+    }
+}
+
+
+bool DeviceBudget::tryLock(Slot& slot)
+{
+    if (slot.taken)
+        return false;
+
+    if (::flock(slot.fdLockFile, LOCK_EX | LOCK_NB) != 0)
+    {
+        assert(errno == EWOULDBLOCK || errno == EINTR); //EINTR: try again next time
+        return false;
+    }
+    slot.taken = true;
+    return true;
+}
+
+
+void DeviceBudget::unlock(Slot& slot)
+{
+    assert(slot.taken);
+    [[maybe_unused]] const int rv = ::flock(slot.fdLockFile, LOCK_UN);
+    assert(rv == 0);
+    slot.taken = false;
+}
+
+
+bool DeviceBudget::tryReserve(std::vector<size_t>& slotIdxs)
+{
+    assert(slotIdxs.empty());
+
+    for (std::vector<Slot>& slots : deviceSlots_)
+    {
+        auto it = std::find_if(slots.begin(), slots.end(), [&](Slot& slot) { return tryLock(slot); });
+        if (it == slots.end())
+        {
+            release(slotIdxs); //all or nothing
+            slotIdxs.clear();
+            return false;
+        }
+        slotIdxs.push_back(it - slots.begin());
+    }
+    return true;
+}
+
+
+void DeviceBudget::release(const std::vector<size_t>& slotIdxs)
+{
+    assert(slotIdxs.size() <= deviceSlots_.size());
+    for (size_t i = 0; i < slotIdxs.size(); ++i)
+        unlock(deviceSlots_[i][slotIdxs[i]]);
+}
+
+
+DeviceBudget::Reservation DeviceBudget::reserve() //throw ThreadStopRequest
+{
+    for (;;)
+    {
+        {
+            std::vector<size_t> slotIdxs;
+
+            std::lock_guard dummy(lockSlots_);
+            if (tryReserve(slotIdxs))
+                return Reservation(*this, std::move(slotIdxs));
+        }
+        //flock() can't wait interruptibly and with a timeout => poll
+        interruptibleSleep(DEVICE_BUDGET_POLL_INTERVAL); //throw ThreadStopRequest
+    }
+}
@@ -0,0 +1,65 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#ifndef DEVICE_BUDGET_H_5720394185736201948
+#define DEVICE_BUDGET_H_5720394185736201948
+
+#include <mutex>
+#include <zen/file_error.h>
+#include "../afs/abstract.h"
+
+
+namespace fff
+{
+/*  system-wide budget of parallel operations per device: shared by all FreeFileSync processes, e.g. batch jobs running at the same time
+    - one lock file per slot in the temp folder, locked via flock() => released by the OS when the process ends: no stale slots after a crash
+    - all slots of a reservation are taken at once or not at all => no deadlock between processes waiting for each other's devices
+    - processes using a different number of parallel operations for the same device share the lower slots only    */
+class DeviceBudget
+{
+public:
+    explicit DeviceBudget(const std::map<AfsDevice, size_t /*parallel ops*/>& deviceSlots); //throw FileError
+    ~DeviceBudget();
+
+    class Reservation
+    {
+    public:
+        ~Reservation();
+        Reservation(Reservation&& tmp) noexcept : budget_(tmp.budget_), slotIdxs_(std::move(tmp.slotIdxs_)) { tmp.budget_ = nullptr; }
+
+    private:
+        friend class DeviceBudget;
+        Reservation(DeviceBudget& budget, std::vector<size_t>&& slotIdxs) : budget_(&budget), slotIdxs_(std::move(slotIdxs)) {}
+        Reservation           (const Reservation&) = delete;
+        Reservation& operator=(const Reservation&) = delete;
+
+        DeviceBudget* budget_;
+        std::vector<size_t> slotIdxs_; //one per device
+    };
+
+    //context of worker thread: block until a slot is free on each device
+    Reservation reserve(); //throw ThreadStopRequest
+
+private:
+    DeviceBudget           (const DeviceBudget&) = delete;
+    DeviceBudget& operator=(const DeviceBudget&) = delete;
+
+    struct Slot
+    {
+        int fdLockFile = -1;
+        bool taken = false; //flock() does not exclude threads sharing the same file descriptor
+    };
+    bool tryLock  (Slot& slot);
+    void unlock   (Slot& slot);
+    bool tryReserve(std::vector<size_t>& slotIdxs);
+    void release  (const std::vector<size_t>& slotIdxs);
+
+    std::mutex lockSlots_;
+    std::vector<std::vector<Slot>> deviceSlots_;
+};
+}
+
+#endif //DEVICE_BUDGET_H_5720394185736201948
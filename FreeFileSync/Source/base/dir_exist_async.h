@@ -10,6 +10,7 @@
 #include <zen/thread.h>
 #include <zen/file_error.h>
 #include "process_callback.h"
+#include "structures.h"
 #include "../afs/abstract.h"
 
 
@@ -17,6 +18,30 @@ namespace fff
 {
 const int DEFAULT_FOLDER_ACCESS_TIME_OUT_SEC = 20; //consider CD-ROM insert or hard disk spin up time from sleep
 
+namespace impl
+{
+/*  folder checks are shared by all getFolderStatusNonBlocking() calls in this process (comparison, sync, versioning; consecutive runs):
+    - check still pending (e.g. dead network share): join it => wait only for the *remaining* timeout instead of the full timeout again
+    - check failed recently: reuse the error
+    - check succeeded: never reuse => existence may have changed (e.g. sync re-checks after comparison)           */
+const std::chrono::seconds FOLDER_CHECK_ERROR_REUSE_TIME(10);
+const std::chrono::seconds FOLDER_CHECK_PENDING_REUSE_MAX(120); //hanging even longer? start over: maybe the device is back
+
+struct FolderCheck
+{
+    std::shared_future<bool> ftIsExisting;
+    std::chrono::steady_clock::time_point startTime;
+    bool allowUserInteraction = false;
+};
+
+inline
+zen::Protected<std::map<AbstractPath, FolderCheck>>& getFolderCheckCache()
+{
+    static zen::Protected<std::map<AbstractPath, FolderCheck>> inst; //inline function: same instance for all translation units
+    return inst;
+}
+}
+
 namespace
 {
 //directory existence checking may hang for non-existent network drives => run asynchronously and update UI!
@@ -31,18 +56,48 @@ struct FolderStatus
 
 
 FolderStatus getFolderStatusNonBlocking(const std::set<AbstractPath>& folderPaths,
+                                        const std::map<AfsDevice, size_t>& deviceParallelOps, //connections to open up front, if applicable
                                         bool allowUserInteraction, PhaseCallback& procCallback /*throw X*/)
 {
     using namespace zen;
 
+    const auto now = std::chrono::steady_clock::now();
+
+    auto canReuse = [&](const impl::FolderCheck& fc)
+    {
+        if (fc.ftIsExisting.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            return true; //hanging => join
+
+        if (now - fc.startTime > impl::FOLDER_CHECK_ERROR_REUSE_TIME ||
+            (allowUserInteraction && !fc.allowUserInteraction)) //user interaction might fix authentication
+            return false;
+        try
+        {
+            fc.ftIsExisting.get(); //throw FileError
+            return false;
+        }
+        catch (FileError&) { return true; }
+    };
+
+    std::vector<std::pair<AbstractPath, impl::FolderCheck>> folderChecks;
+
     //aggregate folder paths that are on the same root device: see parallel_scan.h
     std::map<AfsDevice, std::set<AbstractPath>> perDevicePaths;
 
-    for (const AbstractPath& folderPath : folderPaths)
-        if (!AFS::isNullPath(folderPath)) //skip empty folders
-            perDevicePaths[folderPath.afsDevice].insert(folderPath);
+    impl::getFolderCheckCache().access([&](std::map<AbstractPath, impl::FolderCheck>& cache)
+    {
+        std::erase_if(cache, [&](const auto& item) { return now - item.second.startTime > impl::FOLDER_CHECK_PENDING_REUSE_MAX; });
 
-    std::vector<std::pair<AbstractPath, std::future<bool>>> futureDetails;
+        for (const AbstractPath& folderPath : folderPaths)
+            if (!AFS::isNullPath(folderPath)) //skip empty folders
+            {
+                if (auto it = cache.find(folderPath);
+                    it != cache.end() && canReuse(it->second))
+                    folderChecks.emplace_back(folderPath, it->second);
+                else
+                    perDevicePaths[folderPath.afsDevice].insert(folderPath);
+            }
+    });
 
     std::vector<ThreadGroup<std::packaged_task<bool()>>> perDeviceThreads;
     for (const auto& [afsDevice, deviceFolderPaths] : perDevicePaths)
@@ -52,8 +107,18 @@ FolderStatus getFolderStatusNonBlocking(const std::set<AbstractPath>& folderPath
         threadGroup.detach(); //don't wait on threads hanging longer than "folderAccessTimeout"
 
         //1. login to network share, connect with Google Drive, etc.
-        std::shared_future<void> ftAuth = runAsync([afsDevice /*clang bug*/= afsDevice, allowUserInteraction]
-        { AFS::authenticateAccess(afsDevice, allowUserInteraction); /*throw FileError*/ });
+        std::shared_future<void> ftAuth = runAsync([afsDevice /*clang bug*/= afsDevice, allowUserInteraction, parallelOps = getDeviceParallelOps(deviceParallelOps, afsDevice)]
+        {
+            AFS::authenticateAccess(afsDevice, allowUserInteraction); //throw FileError
+
+            //e.g. SFTP: open sessions for parallel traversal/sync concurrently instead of one after another on first use
+            //=> don't hold back the existence check: connection errors will be reported by it anyway
+            runAsync([afsDevice, parallelOps]
+            {
+                try { AFS::prewarmConnections(afsDevice, parallelOps); /*throw FileError*/ }
+                catch (FileError&) {} //not critical
+            });
+        });
 
         for (const AbstractPath& folderPath : deviceFolderPaths)
         {
@@ -73,19 +138,18 @@ FolderStatus getFolderStatusNonBlocking(const std::set<AbstractPath>& folderPath
                 return static_cast<bool>(AFS::itemStillExists(folderPath)); //throw FileError
                 //consider ItemType::file a failure instead? Meanwhile: return "false" IFF nothing (of any type) exists
             });
-            auto ftIsExisting = pt.get_future();
+            impl::FolderCheck fc{pt.get_future().share(), now, allowUserInteraction};
             threadGroup.run(std::move(pt));
 
-            futureDetails.emplace_back(folderPath, std::move(ftIsExisting));
+            impl::getFolderCheckCache().access([&](std::map<AbstractPath, impl::FolderCheck>& cache) { cache.insert_or_assign(folderPath, fc); });
+            folderChecks.emplace_back(folderPath, std::move(fc));
         }
     }
 
-    //don't wait (almost) endlessly like Win32 would on non-existing network shares:
-    const auto startTime = std::chrono::steady_clock::now();
-
     FolderStatus output;
 
-    for (auto& [folderPath, ftIsExisting] : futureDetails)
+    //don't wait (almost) endlessly like Win32 would on non-existing network shares:
+    for (const auto& [folderPath, fc] : folderChecks)
     {
         const std::wstring& displayPathFmt = fmtPath(AFS::getDisplayPath(folderPath));
 
@@ -95,20 +159,19 @@ FolderStatus getFolderStatusNonBlocking(const std::set<AbstractPath>& folderPath
         if (deviceTimeOutSec <= 0)
             deviceTimeOutSec = DEFAULT_FOLDER_ACCESS_TIME_OUT_SEC;
 
-        const auto timeoutTime = startTime + std::chrono::seconds(deviceTimeOutSec);
+        const auto timeoutTime = fc.startTime + std::chrono::seconds(deviceTimeOutSec); //joined check: remaining time only
 
         while (std::chrono::steady_clock::now() < timeoutTime &&
-               ftIsExisting.wait_for(UI_UPDATE_INTERVAL / 2) == std::future_status::timeout)
+               fc.ftIsExisting.wait_for(UI_UPDATE_INTERVAL / 2) == std::future_status::timeout)
             procCallback.requestUiUpdate(); //throw X
 
-        if (!isReady(ftIsExisting))
+        if (fc.ftIsExisting.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
             output.failedChecks.emplace(folderPath, FileError(replaceCpy(_("Timeout while searching for folder %x."), L"%x", displayPathFmt) +
                                                               L" [" + _P("1 sec", "%x sec", deviceTimeOutSec) + L']'));
         else
             try
             {
-                //call future::get() only *once*! otherwise: undefined behavior!
-                if (ftIsExisting.get()) //throw FileError
+                if (fc.ftIsExisting.get()) //throw FileError
                     output.existing.insert(folderPath);
                 else
                     output.notExisting.insert(folderPath);
@@ -6,6 +6,7 @@
 
 #include "dir_lock.h"
 #include <memory>
+#include <mutex>
 #include <unordered_map>
 #include <zen/crc.h>
 #include <zen/sys_error.h>
@@ -20,6 +21,8 @@
     #include <fcntl.h>  //open()
     #include <unistd.h> //close()
     #include <signal.h> //kill()
+    #include <poll.h>   //poll()
+    #include <sys/inotify.h>
 
 using namespace zen;
 using namespace fff;
@@ -314,6 +317,51 @@ uint64_t getLockFileSize(const Zstring& filePath) //throw FileError, ErrorFileNo
 }
 
 
+//wake up waiters as soon as the lock file is deleted instead of waiting for the next POLL_LIFE_SIGN_INTERVAL
+//=> local file systems only: no notifications for changes made by other computers on network shares => polling remains the fallback
+class LockFileWatch
+{
+public:
+    explicit LockFileWatch(const Zstring& lockFilePath) //noexcept
+    {
+        notifyFd_ = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (notifyFd_ != -1)
+            if (::inotify_add_watch(notifyFd_, lockFilePath.c_str(), IN_DELETE_SELF | IN_MOVE_SELF | IN_ATTRIB /*link count*/) == -1)
+            {
+                ::close(notifyFd_); //e.g. ENOENT: lock file already gone => caller will find out
+                notifyFd_ = -1;
+            }
+    }
+
+    ~LockFileWatch() { if (notifyFd_ != -1) ::close(notifyFd_); }
+
+    //return true if lock file *may* have been released
+    bool waitForChange(std::chrono::milliseconds timeout) //noexcept
+    {
+        if (notifyFd_ == -1)
+        {
+            std::this_thread::sleep_for(timeout);
+            return false;
+        }
+
+        pollfd pfd = {.fd = notifyFd_, .events = POLLIN};
+        if (::poll(&pfd, 1, static_cast<int>(timeout.count())) <= 0) //timeout, error (e.g. EINTR): just continue polling
+            return false;
+
+        alignas(inotify_event) char buf[4096];
+        while (::read(notifyFd_, buf, sizeof(buf)) > 0) //consume all events: non-blocking
+            ;
+        return true;
+    }
+
+private:
+    LockFileWatch           (const LockFileWatch&) = delete;
+    LockFileWatch& operator=(const LockFileWatch&) = delete;
+
+    int notifyFd_ = -1;
+};
+
+
 void waitOnDirLock(const Zstring& lockFilePath, const DirLockCallback& notifyStatus /*throw X*/, std::chrono::milliseconds cbInterval) //throw FileError
 {
     std::wstring infoMsg = _("Waiting while directory is in use:") + L' ' + fmtPath(lockFilePath);
@@ -344,6 +392,8 @@ void waitOnDirLock(const Zstring& lockFilePath, const DirLockCallback& notifySta
     catch (FileError&) {} //logfile may be only partly written -> this is no error!
     //------------------------------------------------------------------------------
 
+    LockFileWatch lockWatch(lockFilePath); //noexcept
+
     uint64_t fileSizeOld = 0;
     auto lastLifeSign = std::chrono::steady_clock::now();
 
@@ -403,7 +453,8 @@ void waitOnDirLock(const Zstring& lockFilePath, const DirLockCallback& notifySta
                 else
                     notifyStatus(std::wstring(infoMsg)); //throw X; emit a message in any case (might clear other one)
             }
-            std::this_thread::sleep_for(cbInterval);
+            if (lockWatch.waitForChange(cbInterval)) //noexcept
+                break; //check lock file right away
         }
     }
 }
@@ -496,19 +547,22 @@ public:
     //create or retrieve a SharedDirLock
     std::shared_ptr<SharedDirLock> retrieve(const Zstring& lockFilePath, const DirLockCallback& notifyStatus, std::chrono::milliseconds cbInterval) //throw FileError
     {
-        assert(runningOnMainThread()); //function is not thread-safe!
-
-        tidyUp();
-
-        //optimization: check if we already own a lock for this path
-        if (auto itGuid = guidByPath_.find(lockFilePath);
-            itGuid != guidByPath_.end())
-            if (const std::shared_ptr<SharedDirLock>& activeLock = getActiveLock(itGuid->second)) //returns null-lock if not found
-                return activeLock; //SharedDirLock is still active -> enlarge circle of shared ownership
+        {
+            std::lock_guard dummy(lockRegistry_);
+            tidyUp();
+
+            //optimization: check if we already own a lock for this path
+            if (auto itGuid = guidByPath_.find(lockFilePath);
+                itGuid != guidByPath_.end())
+                if (const std::shared_ptr<SharedDirLock>& activeLock = getActiveLock(itGuid->second)) //returns null-lock if not found
+                    return activeLock; //SharedDirLock is still active -> enlarge circle of shared ownership
+        }
 
         try //check based on lock GUID, deadlock prevention: "lockFilePath" may be an alternative name for a lock already owned by this process
         {
             const std::string lockId = retrieveLockId(lockFilePath); //throw FileError
+
+            std::lock_guard dummy(lockRegistry_);
             if (const std::shared_ptr<SharedDirLock>& activeLock = getActiveLock(lockId)) //returns null-lock if not found
             {
                 guidByPath_[lockFilePath] = lockId; //found an alias for one of our active locks
@@ -517,10 +571,11 @@ public:
         }
         catch (FileError&) {} //catch everything, let SharedDirLock constructor deal with errors, e.g. 0-sized/corrupted lock files
 
-        //lock not owned by us => create a new one
+        //lock not owned by us => create a new one: don't hold lockRegistry_ while (possibly) waiting on other processes, or for recursive DirLock (abandoned lock resolution)
         auto newLock = std::make_shared<SharedDirLock>(lockFilePath, notifyStatus, cbInterval); //throw FileError
         const std::string& newLockGuid = retrieveLockId(lockFilePath); //throw FileError
 
+        std::lock_guard dummy(lockRegistry_);
         guidByPath_[lockFilePath] = newLockGuid; //update registry
         locksByGuid_[newLockGuid] = newLock;     //
 
@@ -546,6 +601,7 @@ private:
         std::erase_if(guidByPath_, [&](const auto& v) { return !locksByGuid_.contains(v.second); });
     }
 
+    std::mutex lockRegistry_; //protect guidByPath_, locksByGuid_: locks on different devices are created in parallel, see LockHolder
     std::unordered_map<Zstring, UniqueId> guidByPath_;                      //lockFilePath |-> GUID; n:1; locks can be referenced by a lockFilePath or alternatively a GUID
     std::unordered_map<UniqueId, std::weak_ptr<SharedDirLock>> locksByGuid_; //GUID |-> "shared lock ownership"; 1:1
 };
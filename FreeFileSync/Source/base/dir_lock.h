@@ -22,7 +22,7 @@ namespace fff
     - detects and resolves abandoned locks (instantly if lock is associated with local pc, else after 30 seconds)
     - temporary locks created during abandoned lock resolution keep "lockFilePath"'s extension
     - race-free (Windows, almost on Linux(NFS))
-    - NOT thread-safe! (1. global LockAdmin 2. locks for directory aliases should be created sequentially to detect duplicate locks!)         */
+    - thread-safe, BUT locks for directory aliases must be created sequentially (same thread) to detect duplicate locks!         */
 
 //while waiting for the lock
 using DirLockCallback = std::function<void(std::wstring&& msg)>; //throw X
@@ -7,11 +7,19 @@
 #include "file_hierarchy.h"
 #include <zen/i18n.h>
 #include <zen/utf.h>
+#include <zen/file_access.h>
 #include <zen/file_error.h>
+#include <zen/serialize.h>
+    #include <fcntl.h>  //open
+    #include <unistd.h> //pread, pwrite
 
 using namespace zen;
 using namespace fff;
 
+//memory budget: one FilePair per file of the comparison => think twice before adding members!
+static_assert(sizeof(void*) != 8 || sizeof(FilePair)    <= 120);
+static_assert(sizeof(void*) != 8 || sizeof(SymlinkPair) <=  80);
+
 
 std::wstring fff::getShortDisplayNameForFolderPair(const AbstractPath& itemPathL, const AbstractPath& itemPathR)
 {
@@ -55,8 +63,62 @@ std::wstring fff::getShortDisplayNameForFolderPair(const AbstractPath& itemPathL
 }
 
 
+const ContainerObject::NameIndexNoCase& ContainerObject::getNameIndex() const
+{
+    reloadIfSpilled();
+
+    if (!nameIndex_ ||
+        nameIndex_->fileCount   != subFiles_  .size() || //items added or erased without updateNameIndex(), e.g. addSubFile(), removeEmptyRec()
+        nameIndex_->linkCount   != subLinks_  .size() || //=> rebuild
+        nameIndex_->folderCount != subFolders_.size())
+    {
+        auto index = std::make_unique<NameIndexNoCase>();
+
+        auto addNames = [](std::unordered_multiset<ZstringNoCase>& names, const auto& items)
+        {
+            names.reserve(items.size());
+            for (const FileSystemObject& fsObj : items)
+                if (!fsObj.isPairEmpty())
+                    names.insert(fsObj.getItemNameAny());
+        };
+        addNames(index->files,   subFiles_);
+        addNames(index->links,   subLinks_);
+        addNames(index->folders, subFolders_);
+
+        index->fileCount   = subFiles_  .size();
+        index->linkCount   = subLinks_  .size();
+        index->folderCount = subFolders_.size();
+        nameIndex_ = std::move(index);
+    }
+    return *nameIndex_;
+}
+
+
+void ContainerObject::updateNameIndex(const FileSystemObject& fsObj, const Zstring& itemNameAnyOld)
+{
+    if (!nameIndex_)
+        return;
+
+    const Zstring itemNameAnyNew = fsObj.isPairEmpty() ? Zstring() : fsObj.getItemNameAny();
+    if (itemNameAnyNew == itemNameAnyOld)
+        return;
+
+    std::unordered_multiset<ZstringNoCase>& names = dynamic_cast<const FilePair*   >(&fsObj) ? nameIndex_->files :
+                                                    dynamic_cast<const SymlinkPair*>(&fsObj) ? nameIndex_->links : nameIndex_->folders;
+    if (!itemNameAnyOld.empty())
+        if (auto it = names.find(itemNameAnyOld); it != names.end())
+            names.erase(it); //erase a single element only!
+
+    if (!itemNameAnyNew.empty())
+        names.insert(itemNameAnyNew);
+}
+
+
 void ContainerObject::removeEmptyRec()
 {
+    if (isSpilled()) //only equal items => nothing to remove
+        return;
+
     bool emptyExisting = false;
     auto isEmpty = [&](const FileSystemObject& fsObj) -> bool
     {
@@ -78,6 +140,282 @@ void ContainerObject::removeEmptyRec()
 }
 
 
+//anonymous temporary file: gone with the process, even after a crash
+class fff::HierarchySpillFile
+{
+public:
+    HierarchySpillFile() : //throw FileError
+        tempFolderPath_(getTempFolderPath()) //throw FileError
+    {
+        fileHandle_ = ::open(tempFolderPath_.c_str(), O_TMPFILE | O_RDWR | O_CLOEXEC, S_IRUSR | S_IWUSR);
+        if (fileHandle_ == -1)
+            THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot create file %x."), L"%x", fmtPath(tempFolderPath_)), "open(O_TMPFILE)");
+    }
+
+    ~HierarchySpillFile() { ::close(fileHandle_); }
+
+    uint64_t append(const std::string& buf) //throw FileError
+    {
+        const uint64_t offset = fileSize_;
+        for (size_t bytesWritten = 0; bytesWritten < buf.size();)
+        {
+            const ssize_t rv = ::pwrite(fileHandle_, buf.data() + bytesWritten, buf.size() - bytesWritten, offset + bytesWritten);
+            if (rv < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(tempFolderPath_)), "pwrite");
+            }
+            if (rv == 0) //should not happen for regular files
+                throw FileError(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(tempFolderPath_)), formatSystemError("pwrite", L"", L"Zero bytes written."));
+            bytesWritten += rv;
+        }
+        fileSize_ += buf.size();
+        return offset;
+    }
+
+    std::string read(uint64_t offset, size_t byteCount) const //throw FileError
+    {
+        std::string buf(byteCount, '\0');
+        for (size_t bytesRead = 0; bytesRead < byteCount;)
+        {
+            const ssize_t rv = ::pread(fileHandle_, buf.data() + bytesRead, byteCount - bytesRead, offset + bytesRead);
+            if (rv < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(tempFolderPath_)), "pread");
+            }
+            if (rv == 0)
+                throw FileError(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(tempFolderPath_)), formatSystemError("pread", L"", L"Unexpected end of file."));
+            bytesRead += rv;
+        }
+        return buf;
+    }
+
+private:
+    HierarchySpillFile           (const HierarchySpillFile&) = delete;
+    HierarchySpillFile& operator=(const HierarchySpillFile&) = delete;
+
+    const Zstring tempFolderPath_; //the file itself has no name
+    int fileHandle_ = -1;
+    uint64_t fileSize_ = 0;
+};
+
+
+namespace
+{
+const size_t SPILL_ITEM_COUNT_MIN = 1000; //one segment per spilled sub tree => don't bother with small ones
+
+//spilled sub trees contain equal items only: FILE_EQUAL, SYMLINK_EQUAL, DIR_EQUAL, no sync direction, no conflict
+void serializeInSyncRec(const ContainerObject& hierObj, MemoryStreamOut<std::string>& stream)
+{
+    writeNumber<uint32_t>(stream, static_cast<uint32_t>(hierObj.refSubFiles().size()));
+    for (const FilePair& file : hierObj.refSubFiles())
+    {
+        assert(file.getCategory() == FILE_EQUAL);
+        writeContainer(stream, file.getItemName<SelectSide::left >());
+        writeContainer(stream, file.getItemName<SelectSide::right>());
+        writeNumber<int64_t >(stream, file.getLastWriteTime<SelectSide::left >());
+        writeNumber<int64_t >(stream, file.getLastWriteTime<SelectSide::right>());
+        writeNumber<uint64_t>(stream, file.getFileSize<SelectSide::left >());
+        writeNumber<uint64_t>(stream, file.getFileSize<SelectSide::right>());
+        writeNumber<AFS::FingerPrint>(stream, file.getFilePrint<SelectSide::left >());
+        writeNumber<AFS::FingerPrint>(stream, file.getFilePrint<SelectSide::right>());
+        writeNumber<int8_t>(stream, file.isFollowedSymlink<SelectSide::left >());
+        writeNumber<int8_t>(stream, file.isFollowedSymlink<SelectSide::right>());
+        writeNumber<int8_t>(stream, file.isActive());
+    }
+
+    writeNumber<uint32_t>(stream, static_cast<uint32_t>(hierObj.refSubLinks().size()));
+    for (const SymlinkPair& symlink : hierObj.refSubLinks())
+    {
+        assert(symlink.getCategory() == FILE_EQUAL);
+        writeContainer(stream, symlink.getItemName<SelectSide::left >());
+        writeContainer(stream, symlink.getItemName<SelectSide::right>());
+        writeNumber<int64_t>(stream, symlink.getLastWriteTime<SelectSide::left >());
+        writeNumber<int64_t>(stream, symlink.getLastWriteTime<SelectSide::right>());
+        writeNumber<int8_t>(stream, symlink.isActive());
+    }
+
+    writeNumber<uint32_t>(stream, static_cast<uint32_t>(hierObj.refSubFolders().size()));
+    for (const FolderPair& folder : hierObj.refSubFolders())
+    {
+        assert(folder.getCategory() == FILE_EQUAL);
+        writeContainer(stream, folder.getItemName<SelectSide::left >());
+        writeContainer(stream, folder.getItemName<SelectSide::right>());
+        writeNumber<int8_t>(stream, folder.isFollowedSymlink<SelectSide::left >());
+        writeNumber<int8_t>(stream, folder.isFollowedSymlink<SelectSide::right>());
+        writeNumber<int8_t>(stream, folder.isActive());
+        serializeInSyncRec(folder, stream);
+    }
+}
+
+
+void deserializeInSyncRec(ContainerObject& hierObj, MemoryStreamIn<std::string>& stream) //throw SysErrorUnexpectedEos
+{
+    for (auto fileCount = readNumber<uint32_t>(stream); fileCount-- > 0;)
+    {
+        const Zstring itemNameL = readContainer<Zstring>(stream);
+        const Zstring itemNameR = readContainer<Zstring>(stream);
+        const auto modTimeL   = readNumber<int64_t >(stream);
+        const auto modTimeR   = readNumber<int64_t >(stream);
+        const auto fileSizeL  = readNumber<uint64_t>(stream);
+        const auto fileSizeR  = readNumber<uint64_t>(stream);
+        const auto filePrintL = readNumber<AFS::FingerPrint>(stream);
+        const auto filePrintR = readNumber<AFS::FingerPrint>(stream);
+        const bool isSymlinkL = readNumber<int8_t>(stream) != 0;
+        const bool isSymlinkR = readNumber<int8_t>(stream) != 0;
+        const bool active     = readNumber<int8_t>(stream) != 0;
+
+        FilePair& file = hierObj.addSubFile(itemNameL, FileAttributes(modTimeL, fileSizeL, filePrintL, isSymlinkL), FILE_EQUAL,
+                                            itemNameR, FileAttributes(modTimeR, fileSizeR, filePrintR, isSymlinkR));
+        file.setActive(active);
+    }
+
+    for (auto linkCount = readNumber<uint32_t>(stream); linkCount-- > 0;)
+    {
+        const Zstring itemNameL = readContainer<Zstring>(stream);
+        const Zstring itemNameR = readContainer<Zstring>(stream);
+        const auto modTimeL = readNumber<int64_t>(stream);
+        const auto modTimeR = readNumber<int64_t>(stream);
+        const bool active   = readNumber<int8_t>(stream) != 0;
+
+        SymlinkPair& symlink = hierObj.addSubLink(itemNameL, LinkAttributes(modTimeL), SYMLINK_EQUAL,
+                                                  itemNameR, LinkAttributes(modTimeR));
+        symlink.setActive(active);
+    }
+
+    for (auto folderCount = readNumber<uint32_t>(stream); folderCount-- > 0;)
+    {
+        const Zstring itemNameL = readContainer<Zstring>(stream);
+        const Zstring itemNameR = readContainer<Zstring>(stream);
+        const bool isSymlinkL = readNumber<int8_t>(stream) != 0;
+        const bool isSymlinkR = readNumber<int8_t>(stream) != 0;
+        const bool active     = readNumber<int8_t>(stream) != 0;
+
+        FolderPair& folder = hierObj.addSubFolder(itemNameL, FolderAttributes(isSymlinkL), DIR_EQUAL,
+                                                  itemNameR, FolderAttributes(isSymlinkR));
+        folder.setActive(active);
+        deserializeInSyncRec(folder, stream); //throw SysErrorUnexpectedEos
+    }
+}
+}
+
+
+//returns item count of sub tree if it contains equal items only (not considering hierObj itself)
+std::optional<size_t> ContainerObject::spillInSyncRec(HierarchySpillFile& spillFile, size_t& spilledCount) //throw FileError
+{
+    if (spilled_) //spillInSyncSubTrees() called before: keep it simple
+        return std::nullopt;
+
+    bool inSync = true;
+    size_t itemCount = subFiles_.size() + subLinks_.size() + subFolders_.size();
+
+    for (const FilePair& file : subFiles_)
+        if (file.getCategory() != FILE_EQUAL)
+            inSync = false;
+
+    for (const SymlinkPair& symlink : subLinks_)
+        if (symlink.getCategory() != FILE_EQUAL)
+            inSync = false;
+
+    std::vector<std::pair<FolderPair*, size_t>> inSyncFolders;
+    for (FolderPair& folder : subFolders_)
+        if (const std::optional<size_t> subItemCount = folder.spillInSyncRec(spillFile, spilledCount)) //throw FileError
+        {
+            if (folder.getCategory() != FILE_EQUAL)
+                inSync = false;
+            itemCount += *subItemCount;
+            inSyncFolders.emplace_back(&folder, *subItemCount);
+        }
+        else
+            inSync = false;
+
+    if (inSync)
+        return itemCount; //let parent spill the complete sub tree
+
+    for (const auto& [folder, subItemCount] : inSyncFolders)
+        if (subItemCount >= SPILL_ITEM_COUNT_MIN)
+        {
+            folder->spill(spillFile, subItemCount); //throw FileError
+            spilledCount += subItemCount;
+        }
+    return std::nullopt;
+}
+
+
+void ContainerObject::spill(HierarchySpillFile& spillFile, size_t itemCount) //throw FileError
+{
+    MemoryStreamOut<std::string> stream;
+    serializeInSyncRec(*this, stream);
+
+    auto segment = std::make_unique<SpillSegment>();
+    segment->offset    = spillFile.append(stream.ref()); //throw FileError
+    segment->byteCount = stream.ref().size();
+    segment->itemCount = itemCount;
+
+    subFiles_  .clear(); //no notifySyncCfgChanged(): nothing changed from a client's perspective
+    subLinks_  .clear();
+    subFolders_.clear();
+    nameIndex_.reset();
+    spilled_ = std::move(segment);
+}
+
+
+void ContainerObject::reloadSpilled()
+{
+    assert(isSpilled());
+    std::string buf;
+    try
+    {
+        buf = getBase().spillFile_->read(spilled_->offset, spilled_->byteCount); //throw FileError
+    }
+    catch (const FileError& e) { throw std::runtime_error(utfTo<std::string>(e.toString())); } //callers can't handle errors: e.g. refSubFiles()
+
+    spilled_->loaded = true; //*before* addSub*()
+    try
+    {
+        MemoryStreamIn memStreamIn(std::move(buf));
+        deserializeInSyncRec(*this, memStreamIn); //throw SysErrorUnexpectedEos
+    }
+    catch (const SysErrorUnexpectedEos&) { throw std::logic_error("Contract violation! " + std::string(__FILE__) + ':' + numberTo<std::string>(__LINE__)); }
+
+    spilled_->changeIdLoaded = changeId_;
+}
+
+
+void ContainerObject::unloadSpilled() const
+{
+    if (spilled_ && spilled_->loaded &&
+        spilled_->changeIdLoaded == changeId_) //else: sub tree was modified => keep in memory
+    {
+        auto& hierObj = const_cast<ContainerObject&>(*this); //same logical content: see refSub*()
+        hierObj.subFiles_  .clear();
+        hierObj.subLinks_  .clear();
+        hierObj.subFolders_.clear();
+        nameIndex_.reset();
+        spilled_->loaded = false;
+    }
+}
+
+
+size_t fff::spillInSyncSubTrees(BaseFolderPair& baseFolder) //throw FileError
+{
+    if (!baseFolder.spillFile_)
+        baseFolder.spillFile_ = std::make_shared<HierarchySpillFile>(); //throw FileError
+
+    size_t spilledCount = 0;
+    if (const std::optional<size_t> itemCount = baseFolder.spillInSyncRec(*baseFolder.spillFile_, spilledCount)) //throw FileError
+        if (*itemCount >= SPILL_ITEM_COUNT_MIN)
+        {
+            baseFolder.spill(*baseFolder.spillFile_, *itemCount); //throw FileError
+            spilledCount += *itemCount;
+        }
+    return spilledCount;
+}
+
+
 namespace
 {
 SyncOperation getIsolatedSyncOperation(bool itemExistsLeft,
@@ -310,6 +648,17 @@ SyncOperation FilePair::applyMoveOptimization(SyncOperation op) const
 }
 
 
+void FilePair::notifySyncCfgChanged()
+{
+    FileSystemObject::notifySyncCfgChanged();
+
+    //sync operation of the move partner depends on ours (see applyMoveOptimization()) => its folder needs a new change id, too
+    if (moveFileRef_)
+        if (auto refFile = dynamic_cast<FilePair*>(FileSystemObject::retrieve(moveFileRef_)))
+            refFile->FileSystemObject::notifySyncCfgChanged(); //do *not* make a virtual call!
+}
+
+
 SyncOperation FilePair::testSyncOperation(SyncDirection testSyncDir) const
 {
     return applyMoveOptimization(FileSystemObject::testSyncOperation(testSyncDir));
@@ -12,9 +12,16 @@
 #include <list>
 #include <functional>
 #include <unordered_set>
+#include <limits>
 #include <unordered_map>
+#include <atomic>
+#include <mutex>
+#include <zen/arena.h>
+#include <zen/flat_map.h>
 #include "structures.h"
+#include "cmp_filetime.h"
 #include "path_filter.h"
+#include "memory_stats.h"
 #include "../afs/abstract.h"
 
 
@@ -94,12 +101,17 @@ struct FolderContainer
     //------------------------------------------------------------------
     //key: raw file name, without any (Unicode) normalization, preserving original upper-/lower-case
     //"Changing data [...] to NFC would cause interoperability problems. Always leave data as it is."
-    using FolderList  = std::unordered_map<Zstring, std::pair<FolderAttributes, FolderContainer>>;
-    using FileList    = std::unordered_map<Zstring, FileAttributes>;
-    using SymlinkList = std::unordered_map<Zstring, LinkAttributes>;
+    //files/symlinks: most folders hold only a handful of items => zen::FlatMap instead of std::unordered_map
+    //folders: node-based! references returned by addSubFolder() must stay valid while siblings are added
+    //         nodes are allocated from the (optional) scan arena: traversal threads don't contend for the heap, memory is dropped at once after comparison
+    using FolderList  = std::unordered_map<Zstring, std::pair<FolderAttributes, FolderContainer>, std::hash<Zstring>, std::equal_to<Zstring>,
+                                           zen::MonotonicAllocator<std::pair<const Zstring, std::pair<FolderAttributes, FolderContainer>>>>;
+    using FileList    = zen::FlatMap<Zstring, FileAttributes>;
+    using SymlinkList = zen::FlatMap<Zstring, LinkAttributes>;
     //------------------------------------------------------------------
 
     FolderContainer() = default;
+    explicit FolderContainer(const FolderList::allocator_type& alloc) : folders(alloc) {} //scan arena must outlive the container!
     FolderContainer           (const FolderContainer&) = delete; //catch accidental (and unnecessary) copying
     FolderContainer& operator=(const FolderContainer&) = delete; //
 
@@ -107,30 +119,27 @@ struct FolderContainer
     SymlinkList symlinks; //non-followed symlinks
     FolderList  folders;
 
-    void addSubFile(const Zstring& itemName, const FileAttributes& attr)
+    void addSubFile(Zstring itemName, const FileAttributes& attr)
     {
-        const auto [it, inserted] = files.emplace(itemName, attr);
+        const auto [it, inserted] = files.emplace(std::move(itemName), attr);
         if (!inserted) //update entry if already existing (e.g. during folder traverser "retry")
             it->second = attr;
     }
 
-    void addSubLink(const Zstring& itemName, const LinkAttributes& attr)
+    void addSubLink(Zstring itemName, const LinkAttributes& attr)
     {
-        const auto [it, inserted] = symlinks.emplace(itemName, attr);
+        const auto [it, inserted] = symlinks.emplace(std::move(itemName), attr);
         if (!inserted)
             it->second = attr;
     }
 
     FolderContainer& addSubFolder(const Zstring& itemName, const FolderAttributes& attr)
     {
-        auto& p = folders[itemName]; //value default-construction is okay here
-        p.first = attr;
-        return p.second;
-
-        //const auto [it, inserted] = folders.emplace(itemName, std::pair<FolderAttributes, FolderContainer>(attr, FolderContainer()));
-        //if (!inserted)
-        //  it->second.first = attr;
-        //return it->second.second;
+        //sub folder shares the scan arena
+        const auto [it, inserted] = folders.try_emplace(itemName, std::piecewise_construct, std::forward_as_tuple(attr), std::forward_as_tuple(folders.get_allocator()));
+        if (!inserted)
+            it->second.first = attr;
+        return it->second.second;
     }
 };
 
@@ -139,55 +148,62 @@ class FolderPair;
 class FilePair;
 class SymlinkPair;
 class FileSystemObject;
+class HierarchySpillFile;
 
-/*------------------------------------------------------------------
-    inheritance diagram:
-
-         ObjectMgr        PathInformation
-            /|\                 /|\
-             |________  _________|_________
-                      ||                   |
-               FileSystemObject     ContainerObject
-                     /|\                  /|\
-           ___________|___________   ______|______
-          |           |           | |             |
-     SymlinkPair   FilePair    FolderPair   BaseFolderPair
-
-------------------------------------------------------------------*/
-
-struct PathInformation //diamond-shaped inheritence!
+//perf: build relative paths of a folder's child items in a reusable buffer => no temporary Zstring per item (filtering, database update)
+class ChildPathBuilder
 {
-    virtual ~PathInformation() {}
+public:
+    explicit ChildPathBuilder(const Zstring& parentRelPath) : buf_(parentRelPath)
+    {
+        if (!buf_.empty())
+            buf_ += zen::FILE_NAME_SEPARATOR;
+        parentPathLen_ = buf_.length();
+    }
 
-    template <SelectSide side> AbstractPath getAbstractPath() const;
-    template <SelectSide side> Zstring      getRelativePath() const; //get path relative to base sync dir (without leading/trailing FILE_NAME_SEPARATOR)
-    Zstring getRelativePathAny() const { return getRelativePathL(); } //side doesn't matter
+    //CAVEAT: returned reference is only valid until the next call!
+    const Zstring& getPath(const Zstring& itemName)
+    {
+        buf_.resize(parentPathLen_);
+        buf_ += itemName;
+        return buf_;
+    }
 
 private:
-    virtual AbstractPath getAbstractPathL() const = 0; //implemented by FileSystemObject + BaseFolderPair
-    virtual AbstractPath getAbstractPathR() const = 0; //
+    ChildPathBuilder           (const ChildPathBuilder&) = delete;
+    ChildPathBuilder& operator=(const ChildPathBuilder&) = delete;
 
-    virtual Zstring getRelativePathL() const = 0; //implemented by SymlinkPair/FilePair + ContainerObject
-    virtual Zstring getRelativePathR() const = 0; //
+    Zstring buf_;
+    size_t parentPathLen_ = 0;
 };
 
-template <> inline AbstractPath PathInformation::getAbstractPath<SelectSide::left >() const { return getAbstractPathL(); }
-template <> inline AbstractPath PathInformation::getAbstractPath<SelectSide::right>() const { return getAbstractPathR(); }
-
-template <> inline Zstring PathInformation::getRelativePath<SelectSide::left >() const { return getRelativePathL(); }
-template <> inline Zstring PathInformation::getRelativePath<SelectSide::right>() const { return getRelativePathR(); }
+/*------------------------------------------------------------------
+    inheritance diagram:
 
-//------------------------------------------------------------------
+         ObjectMgr
+            /|\
+             |
+      FileSystemObject             ContainerObject
+            /|\                         /|\
+  ___________|___________   _____________|______
+ |           |           | |                    |
+SymlinkPair FilePair    FolderPair         BaseFolderPair
+
+    path getters are non-virtual (no diamond via a common "PathInformation" base): saves one vptr per item
+    => FolderPair: FileSystemObject and ContainerObject agree on the paths; the latter is buffered
+------------------------------------------------------------------*/
 
-class ContainerObject : public virtual PathInformation
+class ContainerObject
 {
     friend class FolderPair;
     friend class FileSystemObject;
 
 public:
-    using FileList    = std::list<FilePair>;    //MergeSides::execute() requires a structure that doesn't invalidate pointers after push_back()
-    using SymlinkList = std::list<SymlinkPair>; //
-    using FolderList  = std::list<FolderPair>;
+    //MergeSides::execute() requires a structure that doesn't invalidate pointers after push_back()
+    //=> list nodes of the complete hierarchy are allocated from the arena of the BaseFolderPair
+    using FileList    = std::list<FilePair,    zen::ArenaAllocator<FilePair   >>;
+    using SymlinkList = std::list<SymlinkPair, zen::ArenaAllocator<SymlinkPair>>;
+    using FolderList  = std::list<FolderPair,  zen::ArenaAllocator<FolderPair >>;
 
     FolderPair& addSubFolder(const Zstring&          itemNameL,
                              const FolderAttributes& left,    //file exists on both sides
@@ -219,19 +235,43 @@ public:
     SymlinkPair& addSubLink(const Zstring&        itemName, //link exists on one side only
                             const LinkAttributes& attr);
 
-    const FileList& refSubFiles() const { return subFiles_; }
-    /**/  FileList& refSubFiles()       { return subFiles_; }
+    const FileList& refSubFiles() const { reloadIfSpilled(); return subFiles_; }
+    /**/  FileList& refSubFiles()       { reloadIfSpilled(); return subFiles_; }
+
+    const SymlinkList& refSubLinks() const { reloadIfSpilled(); return subLinks_; }
+    /**/  SymlinkList& refSubLinks()       { reloadIfSpilled(); return subLinks_; }
+
+    const FolderList& refSubFolders() const { reloadIfSpilled(); return subFolders_; }
+    /**/  FolderList& refSubFolders()       { reloadIfSpilled(); return subFolders_; }
 
-    const SymlinkList& refSubLinks() const { return subLinks_; }
-    /**/  SymlinkList& refSubLinks()       { return subLinks_; }
+    //out-of-core comparison: child items moved to a temporary file by spillInSyncSubTrees() are reloaded transparently by refSub*()
+    //=> traversals with nothing to do for equal items should skip spilled sub trees instead
+    bool isSpilled() const { return spilled_ && !spilled_->loaded; }
+    size_t getSpilledItemCount() const { return spilled_ ? spilled_->itemCount : 0; } //recursive
+    void unloadSpilled() const; //drop reloaded child items again if unchanged => invalidates their ObjectIds!
 
-    const FolderList& refSubFolders() const { return subFolders_; }
-    /**/  FolderList& refSubFolders()       { return subFolders_; }
+    //case-insensitive lookup with equalNoCase() semantics, e.g. name clash checks during sync
+    //index is built on first use, then kept up to date => not thread-safe (same as the item lists)
+    bool hasSubFileNoCase  (const Zstring& itemName) const { return getNameIndex().files  .contains(itemName); }
+    bool hasSubLinkNoCase  (const Zstring& itemName) const { return getNameIndex().links  .contains(itemName); }
+    bool hasSubFolderNoCase(const Zstring& itemName) const { return getNameIndex().folders.contains(itemName); }
 
-    BaseFolderPair& getBase() { return base_; }
+    const BaseFolderPair& getBase() const { return base_; }
+    /**/  BaseFolderPair& getBase()       { return base_; }
+
+    template <SelectSide side> AbstractPath getAbstractPath() const;
+    template <SelectSide side> const Zstring& getRelativePath() const { return selectParam<side>(relPathL_, relPathR_); } //get path relative to base sync dir (without leading/trailing FILE_NAME_SEPARATOR)
+    const Zstring& getRelativePathAny() const { return relPathL_; } //side doesn't matter
+
+    //updated after any change of sync config (direction, activation, ...), categories or removal of items within this sub tree: detect outdated caches
+    uint64_t getChangeId() const { return changeId_; }
+    static uint64_t getLastChangeId() { return lastChangeId_; } //any change within any folder pair
 
 protected:
-    ContainerObject(BaseFolderPair& baseFolder) : //used during BaseFolderPair constructor
+    ContainerObject(BaseFolderPair& baseFolder, zen::Arena& arena) : //used during BaseFolderPair constructor
+        subFiles_  (zen::ArenaAllocator<FilePair   >(arena)),
+        subLinks_  (zen::ArenaAllocator<SymlinkPair>(arena)),
+        subFolders_(zen::ArenaAllocator<FolderPair >(arena)),
         base_(baseFolder) {} //take reference only: baseFolder *not yet* fully constructed at this point!
 
     ContainerObject(const FileSystemObject& fsAlias); //used during FolderPair constructor
@@ -245,14 +285,39 @@ protected:
     template <SelectSide side>
     void updateRelPathsRecursion(const FileSystemObject& fsAlias);
 
+    void updateNameIndex(const FileSystemObject& fsObj, const Zstring& itemNameAnyOld); //call after item name changes
+
 private:
     ContainerObject           (const ContainerObject&) = delete; //this class is referenced by its child elements => make it non-copyable/movable!
     ContainerObject& operator=(const ContainerObject&) = delete;
 
-    virtual void notifySyncCfgChanged() {}
+    virtual void notifySyncCfgChanged() { changeId_ = ++lastChangeId_; }
 
-    Zstring getRelativePathL() const override { return relPathL_; }
-    Zstring getRelativePathR() const override { return relPathR_; }
+    struct NameIndexNoCase
+    {
+        std::unordered_multiset<ZstringNoCase> files; //multi: e.g. "a.txt" and "A.txt" on a case-sensitive file system
+        std::unordered_multiset<ZstringNoCase> links;
+        std::unordered_multiset<ZstringNoCase> folders;
+        size_t fileCount   = 0; //detect items added or erased since last update
+        size_t linkCount   = 0; //
+        size_t folderCount = 0; //
+    };
+    const NameIndexNoCase& getNameIndex() const;
+
+    friend size_t spillInSyncSubTrees(BaseFolderPair& baseFolder); //throw FileError
+    std::optional<size_t> spillInSyncRec(HierarchySpillFile& spillFile, size_t& spilledCount); //throw FileError
+    void spill(HierarchySpillFile& spillFile, size_t itemCount); //throw FileError
+    void reloadIfSpilled() const { if (isSpilled()) [[unlikely]] const_cast<ContainerObject*>(this)->reloadSpilled(); }
+    void reloadSpilled();
+
+    struct SpillSegment
+    {
+        uint64_t offset = 0;
+        size_t byteCount = 0;
+        size_t itemCount = 0; //recursive
+        bool loaded = false;
+        uint64_t changeIdLoaded = 0; //detect changes after reload
+    };
 
     FileList    subFiles_;
     SymlinkList subLinks_;
@@ -262,6 +327,12 @@ private:
     Zstring relPathR_; //
 
     BaseFolderPair& base_;
+
+    mutable std::unique_ptr<NameIndexNoCase> nameIndex_; //lazy: only a few containers ever need it
+    std::unique_ptr<SpillSegment> spilled_; //optional: out-of-core comparison only
+
+    uint64_t changeId_ = ++lastChangeId_; //unique: no false cache hits for a new container reusing the address of a removed one
+    static inline std::atomic<uint64_t> lastChangeId_ = 0; //all folder pairs: sync directions of different folder pairs are set in parallel (see ObjectMgr for other threading considerations)
 };
 
 //------------------------------------------------------------------
@@ -273,7 +344,13 @@ enum class BaseFolderStatus
     failure,
 };
 
-class BaseFolderPair : public ContainerObject //synchronization base directory
+struct HierarchyArena //base-from-member: arena must be constructed before and destroyed after the ContainerObject item lists
+{
+    zen::Arena itemArena{[](int64_t bytesDelta) { addMemoryUsage(MemoryCategory::fileHierarchy, bytesDelta); }};
+};
+
+
+class BaseFolderPair : private HierarchyArena, public ContainerObject //synchronization base directory
 {
 public:
     BaseFolderPair(const AbstractPath& folderPathLeft,
@@ -284,8 +361,9 @@ public:
                    CompareVariant cmpVar,
                    int fileTimeTolerance,
                    const std::vector<unsigned int>& ignoreTimeShiftMinutes) :
-        ContainerObject(*this), //trust that ContainerObject knows that *this is not yet fully constructed!
+        ContainerObject(*this, itemArena), //trust that ContainerObject knows that *this is not yet fully constructed!
         filter_(filter), cmpVar_(cmpVar), fileTimeTolerance_(fileTimeTolerance), ignoreTimeShiftMinutes_(ignoreTimeShiftMinutes),
+        timeTolerance_(fileTimeTolerance, ignoreTimeShiftMinutes),
         folderStatusLeft_ (folderStatusLeft),
         folderStatusRight_(folderStatusRight),
         folderPathLeft_(folderPathLeft),
@@ -296,31 +374,51 @@ public:
     template <SelectSide side> BaseFolderStatus getFolderStatus() const; //base folder status at the time of comparison!
     template <SelectSide side> void setFolderStatus(BaseFolderStatus value); //update after creating the directory in FFS
 
+    //file system snapshot taken before traversal (optional): recorded after sync.ffs_db was saved => next comparison reads changed folders only
+    template <SelectSide side> const std::string& getSnapshotId() const { return selectParam<side>(snapshotIdLeft_, snapshotIdRight_); }
+    template <SelectSide side> void setSnapshotId(const std::string& snapshotId) { selectParam<side>(snapshotIdLeft_, snapshotIdRight_) = snapshotId; }
+
     //get settings which were used while creating BaseFolderPair
     const PathFilter&   getFilter() const { return filter_.ref(); }
     CompareVariant getCompVariant() const { return cmpVar_; }
     int  getFileTimeTolerance() const { return fileTimeTolerance_; }
     const std::vector<unsigned int>& getIgnoredTimeShift() const { return ignoreTimeShiftMinutes_; }
+    const TimeTolerance& getTimeTolerance() const { return timeTolerance_; } //precomputed from both of the above
 
     void flip() override;
 
-private:
-    AbstractPath getAbstractPathL() const override { return folderPathLeft_; }
-    AbstractPath getAbstractPathR() const override { return folderPathRight_; }
+    template <SelectSide side> AbstractPath getAbstractPath() const { return selectParam<side>(folderPathLeft_, folderPathRight_); } //hides ContainerObject::getAbstractPath()
 
+private:
     const FilterRef filter_; //filter used while scanning directory: represents sub-view of actual files!
     const CompareVariant cmpVar_;
     const int fileTimeTolerance_;
     const std::vector<unsigned int> ignoreTimeShiftMinutes_;
+    const TimeTolerance timeTolerance_;
 
     BaseFolderStatus folderStatusLeft_;
     BaseFolderStatus folderStatusRight_;
 
     AbstractPath folderPathLeft_;
     AbstractPath folderPathRight_;
+
+    std::string snapshotIdLeft_;
+    std::string snapshotIdRight_;
+
+    friend class ContainerObject;
+    friend size_t spillInSyncSubTrees(BaseFolderPair& baseFolder); //throw FileError
+    std::shared_ptr<HierarchySpillFile> spillFile_; //optional: out-of-core comparison only
 };
 
 
+/*  out-of-core comparison: move sub trees with nothing to sync (only equal items) to an anonymous temporary file
+    => less memory for sync.ffs_db and synchronization of very large folder pairs
+    - call after comparison (including content comparison), before anybody holds ObjectIds of the items (e.g. the GUI grid)
+    - spilled items are reloaded transparently by ContainerObject::refSub*() (changed ObjectIds!)
+    returns number of spilled items                                                              */
+size_t spillInSyncSubTrees(BaseFolderPair& baseFolder); //throw FileError
+
+
 //get rid of shared_ptr indirection
 template <class IterImpl, //underlying iterator type
           class T>        //target value type
@@ -373,44 +471,119 @@ template <class T>
 class ObjectMgr
 {
 public:
-    using ObjectId      =       ObjectMgr*;
-    using ObjectIdConst = const ObjectMgr*;
+    //generation-counted handle: index into the handle table + generation of the slot when the object was created
+    class ObjectIdConst
+    {
+    public:
+        ObjectIdConst() {}
+        ObjectIdConst(std::nullptr_t) {}
+
+        explicit operator bool() const { return generation_ != 0; }
+        bool operator==(const ObjectIdConst&) const = default;
+
+        struct Hash { size_t operator()(const ObjectIdConst& id) const { return (static_cast<size_t>(id.generation_) << 32) ^ id.index_; } };
+
+    private:
+        friend class ObjectMgr;
+        ObjectIdConst(uint32_t index, uint32_t generation) : index_(index), generation_(generation) {}
+
+        uint32_t index_      = 0;
+        uint32_t generation_ = 0; //0: null handle
+    };
+
+    class ObjectId : public ObjectIdConst
+    {
+    public:
+        ObjectId() {}
+        ObjectId(std::nullptr_t) {}
+    private:
+        friend class ObjectMgr;
+        explicit ObjectId(const ObjectIdConst& id) : ObjectIdConst(id) {}
+    };
 
-    ObjectIdConst  getId() const { return this; }
-    /**/  ObjectId getId()       { return this; }
+    ObjectIdConst  getId() const { return id_; }
+    /**/  ObjectId getId()       { return ObjectId(id_); }
 
     static const T* retrieve(ObjectIdConst id) //returns nullptr if object is not valid anymore
     {
-        return static_cast<const T*>(activeObjects_.contains(id) ? id : nullptr);
+        if (id.index_ < slots_.size()) //perf: O(1) array access instead of hash lookup
+            if (const Slot& slot = slots_[id.index_];
+                slot.generation == id.generation_) //never matches null handle
+                return static_cast<const T*>(slot.obj);
+        return nullptr;
     }
     static T* retrieve(ObjectId id) { return const_cast<T*>(retrieve(static_cast<ObjectIdConst>(id))); }
 
 protected:
-    ObjectMgr () { activeObjects_.insert(this); }
-    ~ObjectMgr() { activeObjects_.erase (this); }
+    ObjectMgr()
+    {
+        std::lock_guard dummy(slotsLock_);
+        uint32_t index = freeSlotIdx_;
+        if (index != NO_FREE_SLOT)
+            freeSlotIdx_ = slots_[index].nextFree;
+        else
+        {
+            index = static_cast<uint32_t>(slots_.size());
+            slots_.emplace_back();
+        }
+        Slot& slot = slots_[index];
+        slot.obj = this;
+        id_ = ObjectIdConst(index, slot.generation);
+    }
+
+    ~ObjectMgr()
+    {
+        std::lock_guard dummy(slotsLock_);
+        Slot& slot = slots_[id_.index_];
+        assert(slot.obj == this && slot.generation == id_.generation_);
+        slot.obj = nullptr;
+        if (++slot.generation == 0) //invalidate all existing handles
+            slot.generation = 1; //wrap-around: reserve 0 for null handle
+
+        slot.nextFree = freeSlotIdx_;
+        freeSlotIdx_ = id_.index_;
+    }
 
 private:
     ObjectMgr           (const ObjectMgr& rhs) = delete;
     ObjectMgr& operator=(const ObjectMgr& rhs) = delete; //it's not well-defined what copying an objects means regarding object-identity in this context
 
-    //our global ObjectMgr is not thread-safe (and currently does not need to be!)
+    ObjectIdConst id_;
+
+    struct Slot
+    {
+        const ObjectMgr* obj = nullptr;
+        uint32_t generation = 1;
+        uint32_t nextFree = 0; //free list: only valid if obj == nullptr
+    };
+    static constexpr uint32_t NO_FREE_SLOT = std::numeric_limits<uint32_t>::max();
+
+    //construction/destruction is thread-safe: folder pairs are merged in parallel (see comparison.cpp)
+    //retrieve() is not: slots_ may be reallocated => must not run while objects are created or destroyed on other threads
     //assert(runningOnMainThread()); -> still, may be accessed by synchronization worker threads, one thread at a time
-    static inline std::unordered_set<const ObjectMgr*> activeObjects_; //external linkage!
+    static inline std::mutex slotsLock_;
+    static inline std::vector<Slot> slots_; //external linkage!
+    static inline uint32_t freeSlotIdx_ = NO_FREE_SLOT; //LIFO: reuse recently freed (cached) slots first
 };
 
 //------------------------------------------------------------------
 
-class FileSystemObject : public ObjectMgr<FileSystemObject>, public virtual PathInformation
+class FileSystemObject : public ObjectMgr<FileSystemObject>
 {
 public:
     virtual void accept(FSObjectVisitor& visitor) const = 0;
 
+    template <SelectSide side> AbstractPath getAbstractPath() const;
+    template <SelectSide side> Zstring      getRelativePath() const; //get path relative to base sync dir (without leading/trailing FILE_NAME_SEPARATOR)
+    Zstring getRelativePathAny() const { return getRelativePath<SelectSide::left>(); } //side doesn't matter
+
     bool isPairEmpty() const; //true, if both sides are empty
     template <SelectSide side> bool isEmpty() const;
 
     //path getters always return valid values, even if isEmpty<side>()!
     Zstring getItemNameAny() const; //like getItemName() but without bias to which side is returned
     template <SelectSide side> Zstring getItemName() const; //case sensitive!
+    template <SelectSide side> ZstringNorm getItemNameNorm() const; //database lookup key: normalization is evaluated once per item
 
     //comparison result
     CompareFileResult getCategory() const { return cmpResult_; }
@@ -420,6 +593,7 @@ public:
     SyncDirection getSyncDir() const { return syncDir_; }
     void setSyncDir(SyncDirection newDir);
     void setSyncDirConflict(const Zstringc& description); //set syncDir = SyncDirection::none + fill conflict description
+    Zstringc getSyncDirConflict() const { return syncDirectionConflict_; } //empty if no conflict
 
     bool isActive() const { return selectedForSync_; }
     void setActive(bool active);
@@ -452,6 +626,7 @@ protected:
         parent_(parentObj)
     {
         assert(itemNameL_.c_str() == itemNameR_.c_str() || itemNameL_ != itemNameR_); //also checks ref-counted string precondition
+        namesInNormalForm_ = isInNormalForm(itemNameL_) && isInNormalForm(itemNameR_);
         parent_.notifySyncCfgChanged();
     }
 
@@ -467,24 +642,28 @@ private:
     FileSystemObject           (const FileSystemObject&) = delete;
     FileSystemObject& operator=(const FileSystemObject&) = delete;
 
-    AbstractPath getAbstractPathL() const override { return AFS::appendRelPath(base().getAbstractPath<SelectSide::left >(), getRelativePath<SelectSide::left >()); }
-    AbstractPath getAbstractPathR() const override { return AFS::appendRelPath(base().getAbstractPath<SelectSide::right>(), getRelativePath<SelectSide::right>()); }
-
     virtual void removeObjectL() = 0;
     virtual void removeObjectR() = 0;
 
     template <SelectSide side>
     void propagateChangedItemName(const Zstring& itemNameOld); //required after any itemName changes
 
+    static bool isInNormalForm(const Zstring& itemName) { return getUnicodeNormalForm(itemName) == itemName; } //ASCII: no allocation
+
     //categorization
     Zstringc cmpResultDescr_; //only filled if getCategory() == FILE_CONFLICT or FILE_DIFFERENT_METADATA
     //conserve memory (avoid std::string SSO overhead + allow ref-counting!)
     CompareFileResult cmpResult_; //although this uses 4 bytes there is currently *no* space wasted in class layout!
 
-    bool selectedForSync_ = true;
+    bool selectedForSync_   : 1 = true;
+    bool namesInNormalForm_ : 1 = false; //both item names are Unicode-normalized (e.g. ASCII) => cheap ZstringNorm; share byte with selectedForSync_
 
-    //Note: we model *four* states with following two variables => "syncDirectionConflict is empty or syncDir == NONE" is a class invariant!!!
+    //Note: we model *four* states with syncDir_ and syncDirectionConflict_ => "syncDirectionConflict is empty or syncDir == NONE" is a class invariant!!!
     SyncDirection syncDir_ = SyncDirection::none; //1 byte: optimize memory layout!
+protected:
+    bool followedSymlinkL_ = false; //FilePair only: fill the padding after syncDir_ => -8 bytes per FilePair
+    bool followedSymlinkR_ = false; //
+private:
     Zstringc syncDirectionConflict_; //non-empty if we have a conflict setting sync-direction
     //conserve memory (avoid std::string SSO overhead + allow ref-counting!)
 
@@ -504,6 +683,10 @@ class FolderPair : public FileSystemObject, public ContainerObject
 public:
     void accept(FSObjectVisitor& visitor) const override;
 
+    using ContainerObject::getAbstractPath;    //
+    using ContainerObject::getRelativePath;    //same result as FileSystemObject's, but buffered
+    using ContainerObject::getRelativePathAny; //
+
     CompareDirResult getDirCategory() const; //returns actually used subset of CompareFileResult
 
     FolderPair(const Zstring& itemNameL, //use empty itemName if "not existing"
@@ -552,9 +735,11 @@ public:
              const Zstring&        itemNameR, //
              const FileAttributes& attrR,
              ContainerObject& parentObj) :
-        FileSystemObject(itemNameL, itemNameR, parentObj, defaultCmpResult),
-        attrL_(attrL),
-        attrR_(attrR) {}
+        FileSystemObject(itemNameL, itemNameR, parentObj, defaultCmpResult)
+    {
+        setAttributes<SelectSide::left >(attrL);
+        setAttributes<SelectSide::right>(attrR);
+    }
 
     template <SelectSide side> time_t       getLastWriteTime() const;
     template <SelectSide side> uint64_t          getFileSize() const;
@@ -582,17 +767,24 @@ public:
                      bool isSymlinkSrc);
 
 private:
-    Zstring getRelativePathL() const override { return appendPath(parent().getRelativePath<SelectSide::left >(), getItemName<SelectSide::left >()); }
-    Zstring getRelativePathR() const override { return appendPath(parent().getRelativePath<SelectSide::right>(), getItemName<SelectSide::right>()); }
-
     SyncOperation applyMoveOptimization(SyncOperation op) const;
 
     void flip         () override;
-    void removeObjectL() override { attrL_ = FileAttributes(); }
-    void removeObjectR() override { attrR_ = FileAttributes(); }
+    void notifySyncCfgChanged() override;
+    void removeObjectL() override { setAttributes<SelectSide::left >(FileAttributes()); }
+    void removeObjectR() override { setAttributes<SelectSide::right>(FileAttributes()); }
 
-    FileAttributes attrL_;
-    FileAttributes attrR_;
+    template <SelectSide side> void setAttributes(const FileAttributes& attr);
+
+    //FileAttributes without "isFollowedSymlink" (see FileSystemObject): avoid 2 x 7 bytes of padding => one FilePair per file: memory matters!
+    struct FileData
+    {
+        time_t modTime = 0;
+        uint64_t fileSize = 0;
+        AFS::FingerPrint filePrint = 0;
+    };
+    FileData attrL_;
+    FileData attrR_;
 
     ObjectId moveFileRef_ = nullptr; //optional, filled by redetermineSyncDirection()
 };
@@ -626,9 +818,6 @@ public:
                      int64_t lastWriteTimeSrc);
 
 private:
-    Zstring getRelativePathL() const override { return appendPath(parent().getRelativePath<SelectSide::left >(), getItemName<SelectSide::left >()); }
-    Zstring getRelativePathR() const override { return appendPath(parent().getRelativePath<SelectSide::right>(), getItemName<SelectSide::right>()); }
-
     void flip()          override;
     void removeObjectL() override { attrL_ = LinkAttributes(); }
     void removeObjectR() override { attrR_ = LinkAttributes(); }
@@ -686,11 +875,14 @@ class RecursiveObjectVisitor
 public:
     RecursiveObjectVisitor(Function1 onFolder,
                            Function2 onFile,
-                           Function3 onSymlink) : //unifying assignment
-        onFolder_(std::move(onFolder)), onFile_(std::move(onFile)), onSymlink_(std::move(onSymlink)) {}
+                           Function3 onSymlink, bool skipSpilled = false) : //unifying assignment
+        onFolder_(std::move(onFolder)), onFile_(std::move(onFile)), onSymlink_(std::move(onSymlink)), skipSpilled_(skipSpilled) {}
 
     void execute(ContainerObject& hierObj)
     {
+        if (skipSpilled_ && hierObj.isSpilled())
+            return;
+
         for (FilePair& file : hierObj.refSubFiles())
             onFile_(file);
         for (SymlinkPair& symlink : hierObj.refSubLinks())
@@ -706,6 +898,7 @@ private:
     const Function1 onFolder_;
     const Function2 onFile_;
     const Function3 onSymlink_;
+    const bool skipSpilled_;
 };
 }
 
@@ -718,6 +911,16 @@ void visitFSObjectRecursively(ContainerObject& hierObj, //consider contained ite
     impl::RecursiveObjectVisitor(onFolder, onFile, onSymlink).execute(hierObj);
 }
 
+//same, but don't reload sub trees spilled to disk: only equal items, see spillInSyncSubTrees()
+template <class Function1, class Function2, class Function3> inline
+void visitLoadedFSObjectsRecursively(ContainerObject& hierObj,
+                                     Function1 onFolder,
+                                     Function2 onFile,
+                                     Function3 onSymlink)
+{
+    impl::RecursiveObjectVisitor(onFolder, onFile, onSymlink, true /*skipSpilled*/).execute(hierObj);
+}
+
 template <class Function1, class Function2, class Function3> inline
 void visitFSObjectRecursively(FileSystemObject& fsObj, //consider item and contained items (if folder)
                               Function1 onFolder,
@@ -812,8 +1015,11 @@ std::wstring FileSystemObject::getSyncOpConflict() const
 inline
 void FileSystemObject::setActive(bool active)
 {
-    selectedForSync_ = active;
-    notifySyncCfgChanged();
+    if (selectedForSync_ != active) //perf: (re-)applying filters leaves most items unchanged => keep change ids of unaffected sub trees
+    {
+        selectedForSync_ = active;
+        notifySyncCfgChanged();
+    }
 }
 
 
@@ -831,6 +1037,27 @@ bool FileSystemObject::isPairEmpty() const
 }
 
 
+template <SelectSide side> inline
+AbstractPath ContainerObject::getAbstractPath() const
+{
+    return AFS::appendRelPath(base_.getAbstractPath<side>(), getRelativePath<side>());
+}
+
+
+template <SelectSide side> inline
+AbstractPath FileSystemObject::getAbstractPath() const
+{
+    return AFS::appendRelPath(base().getAbstractPath<side>(), getRelativePath<side>());
+}
+
+
+template <SelectSide side> inline
+Zstring FileSystemObject::getRelativePath() const
+{
+    return appendPath(parent().getRelativePath<side>(), getItemName<side>());
+}
+
+
 template <SelectSide side> inline
 Zstring FileSystemObject::getItemName() const
 {
@@ -844,6 +1071,15 @@ Zstring FileSystemObject::getItemName() const
 }
 
 
+template <SelectSide side> inline
+ZstringNorm FileSystemObject::getItemNameNorm() const
+{
+    if (namesInNormalForm_) //removeObject<side>() leaves it set: empty name is in normal form, too
+        return ZstringNorm(getItemName<side>(), ZstringNorm::InNormalForm());
+    return getItemName<side>();
+}
+
+
 inline
 Zstring FileSystemObject::getItemNameAny() const
 {
@@ -855,6 +1091,7 @@ template <> inline
 void FileSystemObject::removeObject<SelectSide::left>()
 {
     const Zstring itemNameOld = getItemName<SelectSide::left>();
+    const Zstring itemNameAnyOld = getItemNameAny();
 
     cmpResult_ = isEmpty<SelectSide::right>() ? FILE_EQUAL : FILE_RIGHT_SIDE_ONLY;
     itemNameL_.clear();
@@ -862,6 +1099,7 @@ void FileSystemObject::removeObject<SelectSide::left>()
 
     setSyncDir(SyncDirection::none); //calls notifySyncCfgChanged()
     propagateChangedItemName<SelectSide::left>(itemNameOld);
+    parent_.updateNameIndex(*this, itemNameAnyOld);
 }
 
 
@@ -869,6 +1107,7 @@ template <> inline
 void FileSystemObject::removeObject<SelectSide::right>()
 {
     const Zstring itemNameOld = getItemName<SelectSide::right>();
+    const Zstring itemNameAnyOld = getItemNameAny();
 
     cmpResult_ = isEmpty<SelectSide::left>() ? FILE_EQUAL : FILE_LEFT_SIDE_ONLY;
     itemNameR_.clear();
@@ -876,6 +1115,7 @@ void FileSystemObject::removeObject<SelectSide::right>()
 
     setSyncDir(SyncDirection::none); //calls notifySyncCfgChanged()
     propagateChangedItemName<SelectSide::right>(itemNameOld);
+    parent_.updateNameIndex(*this, itemNameAnyOld);
 }
 
 
@@ -884,14 +1124,17 @@ void FileSystemObject::setSynced(const Zstring& itemName)
 {
     const Zstring itemNameOldL = getItemName<SelectSide::left>();
     const Zstring itemNameOldR = getItemName<SelectSide::right>();
+    const Zstring itemNameAnyOld = getItemNameAny();
 
     assert(!isPairEmpty());
     itemNameR_ = itemNameL_ = itemName;
+    namesInNormalForm_ = isInNormalForm(itemName);
     cmpResult_ = FILE_EQUAL;
     setSyncDir(SyncDirection::none);
 
     propagateChangedItemName<SelectSide::left >(itemNameOldL);
     propagateChangedItemName<SelectSide::right>(itemNameOldR);
+    parent_.updateNameIndex(*this, itemNameAnyOld);
 }
 
 
@@ -977,6 +1220,9 @@ void ContainerObject::updateRelPathsRecursion(const FileSystemObject& fsAlias)
 
 inline
 ContainerObject::ContainerObject(const FileSystemObject& fsAlias) :
+    subFiles_  (fsAlias.parent().subFiles_  .get_allocator()), //share arena of BaseFolderPair
+    subLinks_  (fsAlias.parent().subLinks_  .get_allocator()), //
+    subFolders_(fsAlias.parent().subFolders_.get_allocator()), //
     relPathL_(appendPath(fsAlias.parent().relPathL_, fsAlias.getItemName<SelectSide::left>())),
     relPathR_(
         fsAlias.parent().relPathL_.c_str() ==        //
@@ -1002,6 +1248,7 @@ void ContainerObject::flip()
         folder.flip();
 
     std::swap(relPathL_, relPathR_);
+    nameIndex_.reset(); //getItemNameAny() now returns the other side's names
 }
 
 
@@ -1012,6 +1259,7 @@ FolderPair& ContainerObject::addSubFolder(const Zstring& itemNameL,
                                           const Zstring& itemNameR,
                                           const FolderAttributes& right)
 {
+    reloadIfSpilled(); //don't mix new items with spilled ones
     subFolders_.emplace_back(itemNameL, left, defaultCmpResult, itemNameR, right, *this);
     return subFolders_.back();
 }
@@ -1020,6 +1268,7 @@ FolderPair& ContainerObject::addSubFolder(const Zstring& itemNameL,
 template <> inline
 FolderPair& ContainerObject::addSubFolder<SelectSide::left>(const Zstring& itemName, const FolderAttributes& attr)
 {
+    reloadIfSpilled();
     subFolders_.emplace_back(itemName, attr, DIR_LEFT_SIDE_ONLY, Zstring(), FolderAttributes(), *this);
     return subFolders_.back();
 }
@@ -1028,6 +1277,7 @@ FolderPair& ContainerObject::addSubFolder<SelectSide::left>(const Zstring& itemN
 template <> inline
 FolderPair& ContainerObject::addSubFolder<SelectSide::right>(const Zstring& itemName, const FolderAttributes& attr)
 {
+    reloadIfSpilled();
     subFolders_.emplace_back(Zstring(), FolderAttributes(), DIR_RIGHT_SIDE_ONLY, itemName, attr, *this);
     return subFolders_.back();
 }
@@ -1040,6 +1290,7 @@ FilePair& ContainerObject::addSubFile(const Zstring&        itemNameL,
                                       const Zstring&        itemNameR,
                                       const FileAttributes& right)
 {
+    reloadIfSpilled();
     subFiles_.emplace_back(itemNameL, left, defaultCmpResult, itemNameR, right, *this);
     return subFiles_.back();
 }
@@ -1048,6 +1299,7 @@ FilePair& ContainerObject::addSubFile(const Zstring&        itemNameL,
 template <> inline
 FilePair& ContainerObject::addSubFile<SelectSide::left>(const Zstring& itemName, const FileAttributes& attr)
 {
+    reloadIfSpilled();
     subFiles_.emplace_back(itemName, attr, FILE_LEFT_SIDE_ONLY, Zstring(), FileAttributes(), *this);
     return subFiles_.back();
 }
@@ -1056,6 +1308,7 @@ FilePair& ContainerObject::addSubFile<SelectSide::left>(const Zstring& itemName,
 template <> inline
 FilePair& ContainerObject::addSubFile<SelectSide::right>(const Zstring& itemName, const FileAttributes& attr)
 {
+    reloadIfSpilled();
     subFiles_.emplace_back(Zstring(), FileAttributes(), FILE_RIGHT_SIDE_ONLY, itemName, attr, *this);
     return subFiles_.back();
 }
@@ -1068,6 +1321,7 @@ SymlinkPair& ContainerObject::addSubLink(const Zstring&        itemNameL,
                                          const Zstring&        itemNameR,
                                          const LinkAttributes& right)
 {
+    reloadIfSpilled();
     subLinks_.emplace_back(itemNameL, left, defaultCmpResult, itemNameR, right, *this);
     return subLinks_.back();
 }
@@ -1076,6 +1330,7 @@ SymlinkPair& ContainerObject::addSubLink(const Zstring&        itemNameL,
 template <> inline
 SymlinkPair& ContainerObject::addSubLink<SelectSide::left>(const Zstring& itemName, const LinkAttributes& attr)
 {
+    reloadIfSpilled();
     subLinks_.emplace_back(itemName, attr, SYMLINK_LEFT_SIDE_ONLY, Zstring(), LinkAttributes(), *this);
     return subLinks_.back();
 }
@@ -1084,6 +1339,7 @@ SymlinkPair& ContainerObject::addSubLink<SelectSide::left>(const Zstring& itemNa
 template <> inline
 SymlinkPair& ContainerObject::addSubLink<SelectSide::right>(const Zstring& itemName, const LinkAttributes& attr)
 {
+    reloadIfSpilled();
     subLinks_.emplace_back(Zstring(), LinkAttributes(), SYMLINK_RIGHT_SIDE_ONLY, itemName, attr, *this);
     return subLinks_.back();
 }
@@ -1095,6 +1351,7 @@ void BaseFolderPair::flip()
     ContainerObject::flip();
     std::swap(folderStatusLeft_, folderStatusRight_);
     std::swap(folderPathLeft_,   folderPathRight_);
+    std::swap(snapshotIdLeft_,   snapshotIdRight_);
 }
 
 
@@ -1154,13 +1411,23 @@ void FilePair::flip()
 {
     FileSystemObject::flip(); //call base class version
     std::swap(attrL_, attrR_);
+    std::swap(followedSymlinkL_, followedSymlinkR_);
 }
 
 
 template <SelectSide side> inline
 FileAttributes FilePair::getAttributes() const
 {
-    return selectParam<side>(attrL_, attrR_);
+    const FileData& data = selectParam<side>(attrL_, attrR_);
+    return FileAttributes(data.modTime, data.fileSize, data.filePrint, isFollowedSymlink<side>());
+}
+
+
+template <SelectSide side> inline
+void FilePair::setAttributes(const FileAttributes& attr)
+{
+    selectParam<side>(attrL_, attrR_) = {attr.modTime, attr.fileSize, attr.filePrint};
+    selectParam<side>(followedSymlinkL_, followedSymlinkR_) = attr.isFollowedSymlink;
 }
 
 
@@ -1181,7 +1448,7 @@ uint64_t FilePair::getFileSize() const
 template <SelectSide side> inline
 bool FilePair::isFollowedSymlink() const
 {
-    return selectParam<side>(attrL_, attrR_).isFollowedSymlink;
+    return selectParam<side>(followedSymlinkL_, followedSymlinkR_);
 }
 
 
@@ -1217,8 +1484,8 @@ void FilePair::setSyncedTo(const Zstring& itemName,
                            bool isSymlinkSrc)
 {
     //FILE_EQUAL is only allowed for same short name and file size: enforced by this method!
-    selectParam<             sideTrg >(attrL_, attrR_) = FileAttributes(lastWriteTimeTrg, fileSize, filePrintTrg, isSymlinkTrg);
-    selectParam<getOtherSide<sideTrg>>(attrL_, attrR_) = FileAttributes(lastWriteTimeSrc, fileSize, filePrintSrc, isSymlinkSrc);
+    setAttributes<             sideTrg >(FileAttributes(lastWriteTimeTrg, fileSize, filePrintTrg, isSymlinkTrg));
+    setAttributes<getOtherSide<sideTrg>>(FileAttributes(lastWriteTimeSrc, fileSize, filePrintSrc, isSymlinkSrc));
 
     moveFileRef_ = nullptr;
     FileSystemObject::setSynced(itemName); //set FileSystemObject specific part
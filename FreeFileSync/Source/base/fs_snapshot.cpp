@@ -0,0 +1,598 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#include "fs_snapshot.h"
+#include <unordered_map>
+#include <unordered_set>
+#include <zen/crc.h>
+#include <zen/file_access.h>
+#include <zen/file_io.h>
+#include <zen/file_traverser.h>
+#include <zen/guid.h>
+#include <zen/process_exec.h>
+#include <zen/serialize.h>
+#include <zen/time.h>
+
+    #include <sys/stat.h>
+    #include <sys/vfs.h> //statfs
+    #include <linux/magic.h> //BTRFS_SUPER_MAGIC
+
+using namespace zen;
+using namespace fff;
+
+
+namespace
+{
+const char SNAPSHOT_RECORD_DESCR[] = "FreeFileSync Snapshots";
+const int SNAPSHOT_RECORD_VERSION = 1; //2026-10-15
+
+//keep SYNC_DB_FILE_ENDING: excluded from comparison and ignored by RealTimeSync
+const Zchar SNAPSHOT_RECORD_FILE_NAME[]  = Zstr(".sync.snapshot.ffs_db");
+const Zchar BTRFS_SNAPSHOT_FOLDER_NAME[] = Zstr(".sync.snapshots.ffs_db");
+
+const decltype(statfs::f_type) ZFS_SUPER_MAGIC = 0x2fc12fc1; //not in <linux/magic.h>
+const ino_t BTRFS_SUBVOLUME_ROOT_INO = 256; //BTRFS_FIRST_FREE_OBJECTID: root folder of each subvolume
+
+const char ZFS_ID_PREFIX  [] = "zfs:";
+const char BTRFS_ID_PREFIX[] = "btrfs:";
+
+
+//snapshots of different base folders on the same volume must not get in each other's way
+Zstring getSnapshotNamePrefix(const Zstring& baseFolderPath)
+{
+    return Zstr("ffs-") + printNumber<Zstring>(Zstr("%08x"), static_cast<unsigned int>(getCrc32(utfTo<std::string>(baseFolderPath)))) + Zstr('-');
+}
+
+
+struct SnapshotLocation
+{
+    bool isZfs = false;
+    Zstring container; //ZFS: dataset; Btrfs: snapshot folder
+    Zstring name;
+};
+
+std::string getSnapshotId(const SnapshotLocation& sl)
+{
+    return sl.isZfs ?
+           ZFS_ID_PREFIX   + utfTo<std::string>(sl.container + Zstr('@') + sl.name) :
+           BTRFS_ID_PREFIX + utfTo<std::string>(appendPath(sl.container, sl.name));
+}
+
+std::optional<SnapshotLocation> parseSnapshotId(const std::string& snapshotId)
+{
+    if (startsWith(snapshotId, ZFS_ID_PREFIX))
+    {
+        const Zstring snapPath = utfTo<Zstring>(afterFirst(snapshotId, ZFS_ID_PREFIX, IfNotFoundReturn::none));
+        if (contains(snapPath, Zstr('@')))
+            return SnapshotLocation{true, beforeFirst(snapPath, Zstr('@'), IfNotFoundReturn::none),
+                                    afterFirst (snapPath, Zstr('@'), IfNotFoundReturn::none)};
+    }
+    else if (startsWith(snapshotId, BTRFS_ID_PREFIX))
+    {
+        const Zstring snapPath = utfTo<Zstring>(afterFirst(snapshotId, BTRFS_ID_PREFIX, IfNotFoundReturn::none));
+        if (contains(snapPath, FILE_NAME_SEPARATOR))
+            return SnapshotLocation{false, beforeLast(snapPath, FILE_NAME_SEPARATOR, IfNotFoundReturn::none),
+                                    afterLast (snapPath, FILE_NAME_SEPARATOR, IfNotFoundReturn::none)};
+    }
+    return std::nullopt;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------------
+
+//POSIX shell: no expansion within single quotes
+Zstring quoteShellArg(const Zstring& arg)
+{
+    return Zstr('\'') + replaceCpy(arg, Zstr('\''), Zstr("'\\''")) + Zstr('\'');
+}
+
+
+std::string runCommand(const Zstring& cmdLine) //throw SysError
+{
+    const auto& [exitCode, output] = consoleExecute(cmdLine, std::nullopt /*timeoutMs*/); //throw SysError, (SysErrorTimeOut)
+    if (exitCode != 0)
+        throw SysError(formatSystemError(utfTo<std::string>(cmdLine),
+                                         replaceCpy(_("Exit code %x"), L"%x", numberTo<std::wstring>(exitCode)), utfTo<std::wstring>(trimCpy(output))));
+    return utfTo<std::string>(output);
+}
+
+
+/*  "zfs diff":              \ + 4 octal digits for space, backslash and non-printable chars
+    "btrfs receive --dump":  \ + 3 octal digits for non-printable chars, C escape sequences otherwise
+    /proc/self/mountinfo:    \ + 3 octal digits for space, tab, newline, backslash                    */
+Zstring unescapePath(const std::string_view str, size_t octalDigits)
+{
+    std::string output;
+    for (auto it = str.begin(); it != str.end(); ++it)
+        if (*it == '\\' && it + 1 != str.end())
+        {
+            ++it;
+            if ('0' <= *it && *it <= '7' && static_cast<size_t>(str.end() - it) >= octalDigits)
+            {
+                unsigned int val = 0;
+                for (size_t i = 0; i < octalDigits; ++i, ++it)
+                    val = val * 8 + (*it - '0');
+                --it;
+                output += static_cast<char>(val);
+            }
+            else
+                switch (*it)
+                {
+                    //*INDENT-OFF*
+                    case 'a': output += '\a'; break;
+                    case 'b': output += '\b'; break;
+                    case 'e': output += '\x1b'; break;
+                    case 'f': output += '\f'; break;
+                    case 'n': output += '\n'; break;
+                    case 'r': output += '\r'; break;
+                    case 't': output += '\t'; break;
+                    case 'v': output += '\v'; break;
+                    default:  output += *it;  break;
+                    //*INDENT-ON*
+                }
+        }
+        else
+            output += *it;
+
+    return utfTo<Zstring>(output);
+}
+
+
+template <class Function> inline
+void forEachLine(const std::string& text, Function onLine)
+{
+    split2(text, [](char c) { return c == '\n'; }, [&](const char* first, const char* last) { onLine(std::string_view(first, last)); });
+}
+
+
+//split at unescaped white space
+std::vector<std::string_view> splitEscaped(const std::string_view line)
+{
+    std::vector<std::string_view> tokens;
+    for (auto it = line.begin();;)
+    {
+        it = std::find_if_not(it, line.end(), [](char c) { return isWhiteSpace(c); });
+        if (it == line.end())
+            return tokens;
+
+        const auto itStart = it;
+        for (; it != line.end() && !isWhiteSpace(*it); ++it)
+            if (*it == '\\' && it + 1 != line.end())
+                ++it;
+        tokens.emplace_back(itStart, it);
+    }
+}
+
+//-------------------------------------------------------------------------------------------------------------------------------
+
+struct MountInfo
+{
+    Zstring mountPath;
+    std::string fsType;
+    Zstring source; //ZFS: dataset name
+};
+
+std::vector<MountInfo> getMounts() //throw FileError
+{
+    //https://www.kernel.org/doc/Documentation/filesystems/proc.txt  "3.5 /proc/<pid>/mountinfo"
+    //36 35 98:0 /mnt1 /mnt2 rw,noatime master:1 - ext3 /dev/root rw,errors=continue
+    const std::string content = getFileContent("/proc/self/mountinfo", nullptr /*notifyUnbufferedIO*/); //throw FileError
+
+    std::vector<MountInfo> mounts;
+    forEachLine(content, [&](const std::string_view line)
+    {
+        const std::vector<std::string_view> items = splitEscaped(line);
+
+        if (auto itSep = std::find(items.begin(), items.end(), "-");
+            items.size() >= 5 && itSep != items.end() && items.end() - itSep >= 3)
+            mounts.push_back({unescapePath(items[4], 3), std::string(itSep[1]), unescapePath(itSep[2], 3)});
+    });
+    return mounts;
+}
+
+
+//the snapshot must cover everything below the base folder
+MountInfo getBaseFolderMount(const Zstring& baseFolderPath, const std::vector<MountInfo>& mounts) //throw SysError
+{
+    const Zstring& baseFolderPathPf = appendSeparator(baseFolderPath);
+
+    const MountInfo* baseMount = nullptr;
+    for (const MountInfo& mi : mounts)
+        if (startsWith(mi.mountPath, baseFolderPathPf))
+            throw SysError(replaceCpy<std::wstring>(L"Another file system is mounted at %x.", L"%x", fmtPath(mi.mountPath)));
+        else if (startsWith(baseFolderPathPf, appendSeparator(mi.mountPath)))
+            if (!baseMount || baseMount->mountPath.size() <= mi.mountPath.size()) //"<=": last mount shadows the previous ones
+                baseMount = &mi;
+
+    if (!baseMount)
+        throw SysError(replaceCpy<std::wstring>(L"Mount point of %x not found.", L"%x", fmtPath(baseFolderPath)));
+    return *baseMount;
+}
+
+
+Zstring getBtrfsSubvolumePath(const Zstring& folderPath) //throw SysError
+{
+    for (Zstring dirPath = folderPath;;)
+    {
+        struct stat fileInfo = {};
+        if (::stat(dirPath.c_str(), &fileInfo) != 0)
+            THROW_LAST_SYS_ERROR("stat");
+
+        if (fileInfo.st_ino == BTRFS_SUBVOLUME_ROOT_INO)
+            return dirPath;
+
+        const std::optional<Zstring> parentPath = getParentFolderPath(dirPath);
+        if (!parentPath)
+            throw SysError(replaceCpy<std::wstring>(L"Btrfs subvolume of %x not found.", L"%x", fmtPath(folderPath)));
+        dirPath = *parentPath;
+    }
+}
+
+
+//nested subvolumes are not part of the snapshot
+void checkNoNestedSubvolumes(const Zstring& subvolumePath) //throw SysError
+{
+    //ID 258 gen 1234 top level 5 path home/user/nested
+    const std::string output = runCommand(Zstr("btrfs subvolume list -o ") + quoteShellArg(subvolumePath)); //throw SysError
+
+    forEachLine(output, [&](const std::string_view line)
+    {
+        if (const size_t pos = line.find(" path "); pos != std::string_view::npos)
+        {
+            const Zstring path = Zstr('/') + utfTo<Zstring>(line.substr(pos + strLength(" path ")));
+            if (!contains(path, Zstring(Zstr("/")) + BTRFS_SNAPSHOT_FOLDER_NAME + Zstr('/')))
+                throw SysError(replaceCpy<std::wstring>(L"Nested Btrfs subvolume %x is not supported.", L"%x", fmtPath(path)));
+        }
+    });
+}
+
+//-------------------------------------------------------------------------------------------------------------------------------
+
+struct SnapshotRecord
+{
+    std::string snapshotId;
+    std::vector<Zstring> unsyncedRelPaths;
+};
+using SnapshotRecords = std::unordered_map<Zstring /*partner ID*/, SnapshotRecord>;
+
+
+SnapshotRecords loadSnapshotRecords(const Zstring& recordFilePath) //throw FileError
+{
+    if (!itemStillExists(recordFilePath)) //throw FileError
+        return {};
+
+    const std::string byteStream = getFileContent(recordFilePath, nullptr /*notifyUnbufferedIO*/); //throw FileError
+    try
+    {
+        MemoryStreamIn<std::string_view> memStreamIn(byteStream);
+
+        char formatDescr[sizeof(SNAPSHOT_RECORD_DESCR)] = {};
+        readArray(memStreamIn, formatDescr, sizeof(formatDescr)); //throw SysErrorUnexpectedEos
+
+        if (!std::equal(SNAPSHOT_RECORD_DESCR, SNAPSHOT_RECORD_DESCR + sizeof(SNAPSHOT_RECORD_DESCR), formatDescr))
+            throw SysError(_("File content is corrupted.") + L" (invalid header)");
+
+        const int version = readNumber<int32_t>(memStreamIn); //throw SysErrorUnexpectedEos
+        if (version != SNAPSHOT_RECORD_VERSION)
+            throw SysError(_("Unsupported data format.") + L' ' + replaceCpy(_("Version: %x"), L"%x", numberTo<std::wstring>(version)));
+
+        MemoryStreamOut<std::string> crcStreamOut;
+        writeNumber<uint32_t>(crcStreamOut, getCrc32(byteStream.begin(), byteStream.end() - sizeof(uint32_t)));
+
+        if (!endsWith(byteStream, crcStreamOut.ref()))
+            throw SysError(_("File content is corrupted.") + L" (invalid checksum)");
+
+        SnapshotRecords records;
+
+        size_t recordCount = readNumber<uint32_t>(memStreamIn); //throw SysErrorUnexpectedEos
+        while (recordCount-- != 0)
+        {
+            const Zstring partnerId = utfTo<Zstring>(readContainer<std::string>(memStreamIn)); //throw SysErrorUnexpectedEos
+
+            SnapshotRecord& record = records[partnerId];
+            record.snapshotId = readContainer<std::string>(memStreamIn); //throw SysErrorUnexpectedEos
+
+            size_t pathCount = readNumber<uint32_t>(memStreamIn); //throw SysErrorUnexpectedEos
+            while (pathCount-- != 0)
+                record.unsyncedRelPaths.push_back(utfTo<Zstring>(readContainer<std::string>(memStreamIn))); //throw SysErrorUnexpectedEos
+        }
+        return records;
+    }
+    catch (const SysError& e)
+    {
+        throw FileError(replaceCpy(_("Cannot read database file %x."), L"%x", fmtPath(recordFilePath)), e.toString());
+    }
+}
+
+
+void saveSnapshotRecords(const SnapshotRecords& records, const Zstring& recordFilePath) //throw FileError
+{
+    MemoryStreamOut<std::string> memStreamOut;
+
+    writeArray(memStreamOut, SNAPSHOT_RECORD_DESCR, sizeof(SNAPSHOT_RECORD_DESCR));
+    writeNumber<int32_t>(memStreamOut, SNAPSHOT_RECORD_VERSION);
+
+    writeNumber(memStreamOut, static_cast<uint32_t>(records.size()));
+    for (const auto& [partnerId, record] : records)
+    {
+        writeContainer(memStreamOut, utfTo<std::string>(partnerId));
+        writeContainer(memStreamOut, record.snapshotId);
+
+        writeNumber(memStreamOut, static_cast<uint32_t>(record.unsyncedRelPaths.size()));
+        for (const Zstring& relPath : record.unsyncedRelPaths)
+            writeContainer(memStreamOut, utfTo<std::string>(relPath));
+    }
+
+    writeNumber<uint32_t>(memStreamOut, getCrc32(memStreamOut.ref()));
+
+    setFileContent(recordFilePath, memStreamOut.ref(), nullptr /*notifyUnbufferedIO*/); //throw FileError
+}
+
+//-------------------------------------------------------------------------------------------------------------------------------
+
+//M	/	/tank/data/folder
+//R	F	/tank/data/old name.txt	/tank/data/new name.txt
+SnapshotDiff getZfsDiff(const Zstring& baseFolderPath, const SnapshotLocation& snapOld, const SnapshotLocation& snapNew) //throw SysError
+{
+    const std::string output = runCommand(Zstr("zfs diff -FH ") + quoteShellArg(snapOld.container + Zstr('@') + snapOld.name) + Zstr(' ') + //throw SysError
+                                          /**/                    quoteShellArg(snapNew.container + Zstr('@') + snapNew.name));
+    const Zstring& baseFolderPathPf = appendSeparator(baseFolderPath);
+    SnapshotDiff diff;
+
+    auto addItem = [&](std::vector<Zstring>& relPaths, const std::string_view itemPathEsc)
+    {
+        //base folder itself: always read anyway
+        if (const Zstring& itemPath = unescapePath(itemPathEsc, 4);
+            startsWith(itemPath, baseFolderPathPf))
+            relPaths.emplace_back(itemPath.begin() + baseFolderPathPf.size(), itemPath.end());
+    };
+
+    forEachLine(output, [&](const std::string_view line)
+    {
+        if (line.empty())
+            return;
+
+        const std::vector<std::string_view> items = split(line, '\t', SplitOnEmpty::allow);
+        if (items.size() < 3 || items[0].size() != 1)
+            throw SysError(L"Unexpected output of \"zfs diff\": " + utfTo<std::wstring>(line));
+
+        switch (items[0][0])
+        {
+            case 'M': //modified
+                addItem(diff.modifiedRelPaths, items[2]);
+                break;
+            case '+': //created
+            case '-': //removed
+                addItem(diff.changedRelPaths, items[2]);
+                break;
+            case 'R': //renamed
+                if (items.size() < 4)
+                    throw SysError(L"Unexpected output of \"zfs diff\": " + utfTo<std::wstring>(line));
+                addItem(diff.changedRelPaths, items[2]);
+                addItem(diff.changedRelPaths, items[3]);
+                break;
+            default:
+                throw SysError(L"Unexpected output of \"zfs diff\": " + utfTo<std::wstring>(line));
+        }
+    });
+    return diff;
+}
+
+
+//snapshot        ./ffs-0123abcd-20261015-120000-1a2b     uuid=... transid=... parent_uuid=... parent_transid=...
+//rename          ./ffs-0123abcd-20261015-120000-1a2b/old\ name.txt     dest=./ffs-0123abcd-20261015-120000-1a2b/new\ name.txt
+//utimes          ./ffs-0123abcd-20261015-120000-1a2b/folder            atime=... mtime=... ctime=...
+SnapshotDiff getBtrfsDiff(const Zstring& baseFolderPath, const SnapshotLocation& snapOld, const SnapshotLocation& snapNew) //throw SysError, FileError
+{
+    const Zstring tempFilePath = appendPath(getTempFolderPath(), //throw FileError
+                                            Zstr("FFS-") + utfTo<Zstring>(formatAsHexString(generateGUID())));
+    ZEN_ON_SCOPE_EXIT(try { removeFilePlain(tempFilePath); }
+    catch (FileError&) {});
+
+    //metadata only: no need to read the file content
+    std::ignore = runCommand(Zstr("btrfs send --no-data -q -p ") + quoteShellArg(appendPath(snapOld.container, snapOld.name)) + //throw SysError
+                             Zstr(" -f ") + quoteShellArg(tempFilePath) + Zstr(' ') + quoteShellArg(appendPath(snapNew.container, snapNew.name)));
+
+    const std::string output = runCommand(Zstr("btrfs receive --dump -f ") + quoteShellArg(tempFilePath)); //throw SysError
+
+    //snapshot folder is located directly in the subvolume root
+    const Zstring subvolumePath = beforeLast(snapNew.container, FILE_NAME_SEPARATOR, IfNotFoundReturn::none);
+    const Zstring baseRelPathPf = baseFolderPath.size() > subvolumePath.size() ?
+                                  appendSeparator(Zstring(baseFolderPath.begin() + appendSeparator(subvolumePath).size(), baseFolderPath.end())) : Zstring();
+    const Zstring itemPathPrefix = Zstr("./") + snapNew.name + FILE_NAME_SEPARATOR + baseRelPathPf;
+    SnapshotDiff diff;
+
+    auto addItem = [&](std::vector<Zstring>& relPaths, const std::string_view itemPathEsc)
+    {
+        if (const Zstring& itemPath = unescapePath(itemPathEsc, 3);
+            startsWith(itemPath, itemPathPrefix) && itemPath.size() > itemPathPrefix.size())
+            relPaths.emplace_back(itemPath.begin() + itemPathPrefix.size(), itemPath.end());
+    };
+
+    forEachLine(output, [&](const std::string_view line)
+    {
+        const std::vector<std::string_view> items = splitEscaped(line);
+        if (items.empty())
+            return;
+        if (items.size() < 2)
+            throw SysError(L"Unexpected output of \"btrfs receive --dump\": " + utfTo<std::wstring>(line));
+
+        const std::string_view cmd = items[0];
+
+        if (cmd == "snapshot" || cmd == "subvol")
+            ;
+        else if (cmd == "mkfile" || cmd == "mkdir" || cmd == "mknod" || cmd == "mkfifo" || cmd == "mksock" || cmd == "symlink" ||
+                 cmd == "link" || cmd == "unlink" || cmd == "rmdir")
+            addItem(diff.changedRelPaths, items[1]);
+        else if (cmd == "rename")
+        {
+            addItem(diff.changedRelPaths, items[1]);
+
+            for (const std::string_view item : items)
+                if (startsWith(item, "dest="))
+                    addItem(diff.changedRelPaths, item.substr(strLength("dest=")));
+        }
+        else //write, update_extent, truncate, chmod, chown, utimes, set_xattr, ...
+            addItem(diff.modifiedRelPaths, items[1]);
+    });
+    return diff;
+}
+
+
+void removeSnapshot(const SnapshotLocation& sl) //throw SysError
+{
+    if (sl.isZfs)
+        std::ignore = runCommand(Zstr("zfs destroy ") + quoteShellArg(sl.container + Zstr('@') + sl.name)); //throw SysError
+    else
+        std::ignore = runCommand(Zstr("btrfs subvolume delete ") + quoteShellArg(appendPath(sl.container, sl.name))); //throw SysError
+}
+
+
+//all snapshots of the base folder, including the ones of comparisons that weren't followed by a sync
+std::vector<SnapshotLocation> getSnapshots(const SnapshotLocation& snapNew, const Zstring& namePrefix) //throw SysError
+{
+    std::vector<SnapshotLocation> snapshots;
+
+    if (snapNew.isZfs)
+    {
+        const std::string output = runCommand(Zstr("zfs list -H -o name -t snapshot ") + quoteShellArg(snapNew.container)); //throw SysError
+        const Zstring snapPathPrefix = snapNew.container + Zstr('@') + namePrefix;
+
+        forEachLine(output, [&](const std::string_view line)
+        {
+            if (const Zstring& snapPath = utfTo<Zstring>(line);
+                startsWith(snapPath, snapPathPrefix))
+                snapshots.push_back({true, snapNew.container, afterFirst(snapPath, Zstr('@'), IfNotFoundReturn::none)});
+        });
+    }
+    else
+        traverseFolder(snapNew.container, nullptr, [&](const FolderInfo& fi)
+    {
+        if (startsWith(fi.itemName, namePrefix))
+            snapshots.push_back({false, snapNew.container, fi.itemName});
+    },
+    nullptr, [](const std::wstring& errorMsg) { throw SysError(errorMsg); });
+
+    return snapshots;
+}
+}
+
+
+std::optional<std::string> fff::createSnapshot(const Zstring& baseFolderPath) //throw FileError
+{
+    struct statfs fsInfo = {};
+    if (::statfs(baseFolderPath.c_str(), &fsInfo) != 0)
+        THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot read file attributes of %x."), L"%x", fmtPath(baseFolderPath)), "statfs");
+
+    if (fsInfo.f_type != ZFS_SUPER_MAGIC &&
+        fsInfo.f_type != BTRFS_SUPER_MAGIC)
+        return std::nullopt;
+
+    const std::wstring errorMsg = replaceCpy(_("Cannot create file system snapshot of %x."), L"%x", fmtPath(baseFolderPath));
+    try
+    {
+        const MountInfo baseMount = getBaseFolderMount(baseFolderPath, getMounts()); //throw SysError, FileError
+
+        SnapshotLocation snapNew;
+        snapNew.name = getSnapshotNamePrefix(baseFolderPath) + formatTime(Zstr("%Y%m%d-%H%M%S")) +
+                       printNumber<Zstring>(Zstr("-%04x"), static_cast<unsigned int>(getCrc16(generateGUID())));
+
+        if (fsInfo.f_type == ZFS_SUPER_MAGIC)
+        {
+            if (baseMount.fsType != "zfs")
+                throw SysError(replaceCpy<std::wstring>(L"Unexpected file system type %x.", L"%x", utfTo<std::wstring>(baseMount.fsType)));
+
+            snapNew.isZfs = true;
+            snapNew.container = baseMount.source; //dataset name
+
+            std::ignore = runCommand(Zstr("zfs snapshot ") + quoteShellArg(snapNew.container + Zstr('@') + snapNew.name)); //throw SysError
+        }
+        else
+        {
+            const Zstring subvolumePath = getBtrfsSubvolumePath(baseFolderPath); //throw SysError
+            checkNoNestedSubvolumes(subvolumePath); //throw SysError
+
+            snapNew.container = appendPath(subvolumePath, BTRFS_SNAPSHOT_FOLDER_NAME);
+            createDirectoryIfMissingRecursion(snapNew.container); //throw FileError
+
+            std::ignore = runCommand(Zstr("btrfs subvolume snapshot -r ") + quoteShellArg(subvolumePath) + Zstr(' ') + //throw SysError
+                                     quoteShellArg(appendPath(snapNew.container, snapNew.name)));
+        }
+        return getSnapshotId(snapNew);
+    }
+    catch (const SysError& e) { throw FileError(errorMsg, e.toString()); }
+}
+
+
+std::optional<SnapshotDiff> fff::getSnapshotDiff(const Zstring& baseFolderPath, const Zstring& partnerId, const std::string& snapshotId) //throw FileError
+{
+    const std::optional<SnapshotLocation> snapNew = parseSnapshotId(snapshotId);
+    if (!snapNew)
+        throw std::logic_error("Contract violation! " + std::string(__FILE__) + ':' + numberTo<std::string>(__LINE__));
+
+    const SnapshotRecords records = loadSnapshotRecords(appendPath(baseFolderPath, SNAPSHOT_RECORD_FILE_NAME)); //throw FileError
+
+    auto it = records.find(partnerId);
+    if (it == records.end())
+        return std::nullopt;
+    const SnapshotRecord& record = it->second;
+
+    //base folder moved to a different volume?
+    const std::optional<SnapshotLocation> snapOld = parseSnapshotId(record.snapshotId);
+    if (!snapOld ||
+        snapOld->isZfs     != snapNew->isZfs ||
+        snapOld->container != snapNew->container ||
+        !startsWith(snapOld->name, getSnapshotNamePrefix(baseFolderPath)))
+        return std::nullopt;
+
+    try
+    {
+        SnapshotDiff diff = snapNew->isZfs ?
+                            getZfsDiff  (baseFolderPath, *snapOld, *snapNew) : //throw SysError
+                            getBtrfsDiff(baseFolderPath, *snapOld, *snapNew);  //throw SysError, FileError
+
+        append(diff.changedRelPaths, record.unsyncedRelPaths);
+        return diff;
+    }
+    catch (const SysError& e)
+    {
+        throw FileError(replaceCpy(_("Cannot compare file system snapshots of %x."), L"%x", fmtPath(baseFolderPath)), e.toString());
+    }
+}
+
+
+void fff::commitSnapshot(const Zstring& baseFolderPath, const Zstring& partnerId, const std::string& snapshotId, //throw FileError
+                         const std::vector<Zstring>& unsyncedRelPaths)
+{
+    const std::optional<SnapshotLocation> snapNew = parseSnapshotId(snapshotId);
+    if (!snapNew)
+        throw std::logic_error("Contract violation! " + std::string(__FILE__) + ':' + numberTo<std::string>(__LINE__));
+
+    const Zstring recordFilePath = appendPath(baseFolderPath, SNAPSHOT_RECORD_FILE_NAME);
+
+    SnapshotRecords records;
+    try { records = loadSnapshotRecords(recordFilePath); } //throw FileError
+    catch (FileError&) {} //corrupted: start over => other folder pairs of this base folder fall back to a full traversal once
+
+    records[partnerId] = {snapshotId, unsyncedRelPaths};
+
+    saveSnapshotRecords(records, recordFilePath); //throw FileError
+
+    //release snapshots that are no longer referenced
+    std::unordered_set<std::string> snapshotIdsInUse;
+    for (const auto& [partnerId2, record] : records)
+        snapshotIdsInUse.insert(record.snapshotId);
+
+    try
+    {
+        for (const SnapshotLocation& sl : getSnapshots(*snapNew, getSnapshotNamePrefix(baseFolderPath))) //throw SysError
+            if (!snapshotIdsInUse.contains(getSnapshotId(sl)))
+                removeSnapshot(sl); //throw SysError
+    }
+    catch (const SysError& e)
+    {
+        throw FileError(replaceCpy(_("Cannot delete file system snapshot of %x."), L"%x", fmtPath(baseFolderPath)), e.toString());
+    }
+}
@@ -0,0 +1,42 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#ifndef FS_SNAPSHOT_H_6203917485520394817
+#define FS_SNAPSHOT_H_6203917485520394817
+
+#include <optional>
+#include <zen/file_error.h>
+
+
+namespace fff
+{
+/*  change discovery via file system snapshots: list the items changed since the last sync instead of traversing all folders
+    - ZFS:   "zfs snapshot" before traversal, "zfs diff" against the snapshot of the last sync
+    - Btrfs: read-only snapshot in <subvolume>/.sync.snapshots.ffs_db, "btrfs send --no-data" + "btrfs receive --dump" against the last one
+    - the snapshot of the last sync is recorded per folder pair next to sync.ffs_db: .sync.snapshot.ffs_db
+    - requires the command line tools and the right to create snapshots (root, or "zfs allow")
+    - not supported: other file systems mounted below the base folder, nested Btrfs subvolumes
+
+    snapshot ID: "zfs:<dataset>@ffs-<base folder hash>-<time>" or "btrfs:<subvolume>/.sync.snapshots.ffs_db/ffs-<base folder hash>-<time>"   */
+struct SnapshotDiff
+{
+    std::vector<Zstring> changedRelPaths;  //relative to base folder: created, deleted, renamed items => read completely
+    std::vector<Zstring> modifiedRelPaths; //relative to base folder: changed content or attributes => read item + parent folder, but not sub folders
+};
+
+//take snapshot *before* traversal; std::nullopt: file system without snapshot support
+std::optional<std::string> createSnapshot(const Zstring& baseFolderPath); //throw FileError
+
+//changes since the snapshot recorded by commitSnapshot(); std::nullopt: no snapshot recorded yet
+std::optional<SnapshotDiff> getSnapshotDiff(const Zstring& baseFolderPath, const Zstring& partnerId, const std::string& snapshotId); //throw FileError
+
+//call after sync.ffs_db was saved: record snapshot for the next comparison, release snapshots no longer needed
+//unsyncedRelPaths: items not in sync.ffs_db (e.g. failed or excluded from sync) => read again next time
+void commitSnapshot(const Zstring& baseFolderPath, const Zstring& partnerId, const std::string& snapshotId, //throw FileError
+                    const std::vector<Zstring>& unsyncedRelPaths);
+}
+
+#endif //FS_SNAPSHOT_H_6203917485520394817
@@ -7,9 +7,11 @@
 #include "icon_loader.h"
 #include <zen/scope_guard.h>
 #include <zen/thread.h> //includes <std/thread.hpp>
+#include <zen/file_path.h>
 
     #include <gtk/gtk.h>
     #include <sys/stat.h>
+    #include <unistd.h> //getpid()
     #include <zen/sys_error.h>
     #include <zen/basic_math.h>
     #include <xBRZ/src/xbrz_tools.h>
@@ -134,6 +136,113 @@ ImageHolder imageHolderFromGicon(GIcon& gicon, int maxSize) //throw SysError
     //we may have to shrink (e.g. GTK3, openSUSE): "an icon theme may have icons that differ slightly from their nominal sizes"
     return copyToImageHolder(*pixBuf, maxSize); //throw SysError
 }
+
+
+/*  persistent thumbnail cache: freedesktop.org Thumbnail Managing Standard => shared with file managers (Nautilus, Dolphin, ...)
+    https://specifications.freedesktop.org/thumbnail-spec/latest/
+    - $XDG_CACHE_HOME/thumbnails/<size>/<MD5 of file URI>.png with "Thumb::URI" and "Thumb::MTime" => outdated once the file is modified
+    - all functions are best effort: any error => fall back to decoding the original image       */
+struct ThumbnailCacheSlot
+{
+    Zstring thumbFilePath;
+    std::string fileUri;
+    std::string fileMTime;
+    int size = 0;
+};
+
+
+std::optional<ThumbnailCacheSlot> getThumbnailCacheSlot(const Zstring& filePath, const struct stat& fileInfo, int maxSize)
+{
+    int size = 0;
+    const char* sizeName = nullptr;
+    for (const auto& [bucketSize, bucketName] : {std::pair(128, "normal"), std::pair(256, "large"), std::pair(512, "x-large"), std::pair(1024, "xx-large")})
+        if (maxSize <= bucketSize)
+        {
+            size = bucketSize;
+            sizeName = bucketName;
+            break;
+        }
+    if (!sizeName)
+        return {};
+
+    const Zstring thumbRootPath = appendPath(::g_get_user_cache_dir(), Zstr("thumbnails")); //"should not be freed"
+    if (startsWith(filePath, appendSeparator(thumbRootPath))) //"must not create thumbnails for files in the thumbnail directory"
+        return {};
+
+    gchar* fileUri = ::g_filename_to_uri(filePath.c_str(), nullptr /*hostname*/, nullptr /*error*/);
+    if (!fileUri)
+        return {};
+    ZEN_ON_SCOPE_EXIT(::g_free(fileUri));
+
+    gchar* uriMd5 = ::g_compute_checksum_for_string(G_CHECKSUM_MD5, fileUri, -1);
+    if (!uriMd5)
+        return {};
+    ZEN_ON_SCOPE_EXIT(::g_free(uriMd5));
+
+    return ThumbnailCacheSlot
+    {
+        .thumbFilePath = appendPath(appendPath(thumbRootPath, sizeName), Zstring(uriMd5) + Zstr(".png")),
+        .fileUri = fileUri,
+        .fileMTime = numberTo<std::string>(fileInfo.st_mtime),
+        .size = size,
+    };
+}
+
+
+GdkPixbuf* loadCachedThumbnail(const ThumbnailCacheSlot& slot) //return nullptr if not available or outdated; caller takes ownership
+{
+    GdkPixbuf* const thumb = ::gdk_pixbuf_new_from_file(slot.thumbFilePath.c_str(), nullptr /*error*/);
+    if (!thumb)
+        return nullptr;
+
+    const gchar* thumbUri   = ::gdk_pixbuf_get_option(thumb, "tEXt::Thumb::URI");   //"owned by the pixbuf"
+    const gchar* thumbMTime = ::gdk_pixbuf_get_option(thumb, "tEXt::Thumb::MTime"); //
+    if (thumbUri   && thumbUri   == slot.fileUri &&
+        thumbMTime && thumbMTime == slot.fileMTime)
+        return thumb;
+
+    ::g_object_unref(thumb);
+    return nullptr;
+}
+
+
+//return nullptr if image is not bigger than the thumbnail; caller takes ownership
+GdkPixbuf* saveCachedThumbnail(const ThumbnailCacheSlot& slot, GdkPixbuf& pixBuf)
+{
+    const int width  = ::gdk_pixbuf_get_width (&pixBuf);
+    const int height = ::gdk_pixbuf_get_height(&pixBuf);
+    const int maxExtent = std::max(width, height);
+    if (maxExtent <= slot.size) //small image: decoding is as fast as loading a thumbnail
+        return nullptr;
+
+    GdkPixbuf* const thumb = ::gdk_pixbuf_scale_simple(&pixBuf,                                                    //const GdkPixbuf* src
+                                                       std::max(numeric::intDivRound(width  * slot.size, maxExtent), 1), //int dest_width
+                                                       std::max(numeric::intDivRound(height * slot.size, maxExtent), 1), //int dest_height
+                                                       GDK_INTERP_BILINEAR);                                      //GdkInterpType interp_type
+    if (!thumb)
+        return nullptr;
+
+    const Zstring thumbFolderPath = beforeLast(slot.thumbFilePath, FILE_NAME_SEPARATOR, IfNotFoundReturn::none);
+    if (::g_mkdir_with_parents(thumbFolderPath.c_str(), 0700) == 0) //"should be 700"
+    {
+        //write temp file + rename: other processes must never see a partial thumbnail
+        static std::atomic<unsigned int> tmpCounter{0};
+        const Zstring tmpFilePath = slot.thumbFilePath + Zstr('.') + numberTo<Zstring>(::getpid()) + Zstr('.') + numberTo<Zstring>(++tmpCounter) + Zstr(".tmp");
+
+        if (::gdk_pixbuf_save(thumb, tmpFilePath.c_str(), "png", nullptr /*error*/,
+                              "tEXt::Thumb::URI",   slot.fileUri  .c_str(),
+                              "tEXt::Thumb::MTime", slot.fileMTime.c_str(),
+                              "tEXt::Software", "FreeFileSync", nullptr))
+        {
+            ::chmod(tmpFilePath.c_str(), S_IRUSR | S_IWUSR); //"should be 600": thumbnails reveal file content
+            if (::rename(tmpFilePath.c_str(), slot.thumbFilePath.c_str()) != 0)
+                ::unlink(tmpFilePath.c_str());
+        }
+        else
+            ::unlink(tmpFilePath.c_str());
+    }
+    return thumb;
+}
 }
 
 
@@ -242,6 +351,14 @@ ImageHolder fff::getThumbnailImage(const Zstring& filePath, int maxSize) //throw
     if (!S_ISREG(fileInfo.st_mode)) //skip blocking file types, e.g. named pipes, see file_io.cpp
         throw SysError(_("Unsupported item type.") + L" [" + printNumber<std::wstring>(L"0%06o", fileInfo.st_mode & S_IFMT) + L']');
 
+    const std::optional<ThumbnailCacheSlot> cacheSlot = getThumbnailCacheSlot(filePath, fileInfo, maxSize);
+    if (cacheSlot)
+        if (GdkPixbuf* const thumb = loadCachedThumbnail(*cacheSlot))
+        {
+            ZEN_ON_SCOPE_EXIT(::g_object_unref(thumb));
+            return copyToImageHolder(*thumb, maxSize); //throw SysError
+        }
+
     GError* error = nullptr;
     ZEN_ON_SCOPE_EXIT(if (error) ::g_error_free(error));
 
@@ -250,6 +367,13 @@ ImageHolder fff::getThumbnailImage(const Zstring& filePath, int maxSize) //throw
         throw SysError(formatGlibError("gdk_pixbuf_new_from_file", error));
     ZEN_ON_SCOPE_EXIT(::g_object_unref(pixBuf));
 
+    if (cacheSlot)
+        if (GdkPixbuf* const thumb = saveCachedThumbnail(*cacheSlot, *pixBuf))
+        {
+            ZEN_ON_SCOPE_EXIT(::g_object_unref(thumb));
+            return copyToImageHolder(*thumb, maxSize); //throw SysError; perf: shrink from thumbnail size
+        }
+
     return copyToImageHolder(*pixBuf, maxSize); //throw SysError
 
 }
@@ -0,0 +1,57 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#ifndef ITEM_NAME_POOL_H_8347258934752983475
+#define ITEM_NAME_POOL_H_8347258934752983475
+
+#include <array>
+#include <mutex>
+#include <unordered_set>
+#include <zen/zstring.h>
+
+
+namespace fff
+{
+/* share storage of identical item names (left/right sides, sync.ffs_db, common names like "desktop.ini") during one comparison
+    - Zstring is ref-counted: pooled names stay shared after the pool is gone => pool lifetime only needs to span building the hierarchy
+    - thread-safe: used by parallel folder traversal and database parsing threads
+    - bounded: once full, unknown names are passed through unchanged (mostly unique names, e.g. photos, would only cost memory) */
+class ItemNamePool
+{
+public:
+    Zstring intern(const Zstring& itemName) //noexcept
+    {
+        if (itemName.empty())
+            return itemName;
+
+        const size_t nameHash = std::hash<Zstring>()(itemName);
+        Shard& shard = shards_[nameHash % shards_.size()];
+
+        std::lock_guard dummy(shard.lock);
+
+        if (auto it = shard.names.find(itemName);
+            it != shard.names.end())
+            return *it;
+
+        if (shard.names.size() < SHARD_NAMES_MAX)
+            shard.names.insert(itemName);
+        return itemName;
+    }
+
+private:
+    static constexpr size_t SHARD_COUNT = 16; //reduce lock contention between traverser threads
+    static constexpr size_t SHARD_NAMES_MAX = 1'000'000 / SHARD_COUNT;
+
+    struct Shard
+    {
+        std::mutex lock;
+        std::unordered_set<Zstring> names;
+    };
+    std::array<Shard, SHARD_COUNT> shards_;
+};
+}
+
+#endif //ITEM_NAME_POOL_H_8347258934752983475
@@ -0,0 +1,248 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#include "latency_shim.h"
+#include <deque>
+#include <random>
+#include <csignal>
+#include <poll.h>
+#include <zen/socket.h>
+
+using namespace zen;
+using namespace fff;
+
+
+namespace
+{
+const size_t RELAY_CHUNK_SIZE = 64 * 1024;
+const std::chrono::milliseconds MIN_RETRANSMIT_TIMEOUT(200); //RFC 6298: Linux uses 200 ms
+const std::chrono::milliseconds ACCEPT_POLL_INTERVAL(100);
+
+
+SocketType createListenSocket(uint16_t port) //throw SysError
+{
+    if (std::signal(SIGPIPE, SIG_IGN) == SIG_ERR) //either side may disconnect while data is still queued
+        THROW_LAST_SYS_ERROR("signal(SIGPIPE)");
+
+    const SocketType sock = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (sock == invalidSocket)
+        THROW_LAST_SYS_ERROR("socket");
+    ZEN_ON_SCOPE_FAIL(closeSocket(sock));
+
+    const int enable = 1;
+    if (::setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable)) != 0) //benchmark runs back to back: don't wait for TIME_WAIT
+        THROW_LAST_SYS_ERROR("setsockopt(SO_REUSEADDR)");
+
+    ::sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    if (::bind(sock, reinterpret_cast<const ::sockaddr*>(&addr), sizeof(addr)) != 0)
+        THROW_LAST_SYS_ERROR("bind");
+
+    if (::listen(sock, SOMAXCONN) != 0)
+        THROW_LAST_SYS_ERROR("listen");
+
+    return sock;
+}
+}
+
+
+//one direction of a relayed connection: reader thread queues chunks with their due time, writer thread sends them when due
+class LatencyShim::Direction
+{
+public:
+    Direction(SocketType socketFrom, SocketType socketTo, const LatencyShimConfig& cfg, const std::function<void(size_t bytes)>& onRead) :
+        socketFrom_(socketFrom), socketTo_(socketTo), cfg_(cfg), onRead_(onRead),
+        readThread_ ([this] { setCurrentThreadName(Zstr("Latency shim read" )); readChunks (); }),
+        writeThread_([this] { setCurrentThreadName(Zstr("Latency shim write")); writeChunks(); }) {}
+
+    void stop() //caller must shut down sockets first: recv() is not interruptible
+    {
+        readThread_ .requestStop();
+        writeThread_.requestStop();
+        readThread_ .join();
+        writeThread_.join();
+    }
+
+private:
+    struct Chunk
+    {
+        std::chrono::steady_clock::time_point due;
+        std::string bytes; //empty: end of stream
+    };
+
+    void readChunks() //throw ThreadStopRequest
+    {
+        std::vector<char> buf(RELAY_CHUNK_SIZE);
+        std::mt19937 rng(std::random_device{}());
+        auto linkFreeTime = std::chrono::steady_clock::now();
+
+        for (;;)
+        {
+            size_t bytesRead = 0;
+            try { bytesRead = tryReadSocket(socketFrom_, buf.data(), buf.size()); /*throw SysError*/ }
+            catch (SysError&) {} //connection reset or shut down => same as end of stream
+            interruptionPoint(); //throw ThreadStopRequest
+
+            const auto now = std::chrono::steady_clock::now();
+            Chunk chunk{now + cfg_.roundTripTime / 2, std::string(buf.data(), bytesRead)};
+
+            if (bytesRead > 0)
+            {
+                onRead_(bytesRead);
+
+                if (cfg_.bytesPerSec > 0) //serialization delay: link is still busy with previous chunks
+                {
+                    linkFreeTime = std::max(linkFreeTime, now) + std::chrono::microseconds(bytesRead * 1'000'000 / cfg_.bytesPerSec);
+                    chunk.due = linkFreeTime + cfg_.roundTripTime / 2;
+                }
+
+                if (cfg_.lossPerMille > 0 && std::uniform_int_distribution<int>(0, 999)(rng) < cfg_.lossPerMille)
+                    chunk.due += std::max(MIN_RETRANSMIT_TIMEOUT, cfg_.roundTripTime); //in-order delivery => holds back all later chunks, too
+            }
+
+            {
+                std::lock_guard dummy(lockQueue_);
+                queue_.push_back(std::move(chunk));
+            }
+            conditionNewChunk_.notify_all();
+
+            if (bytesRead == 0)
+                return;
+        }
+    }
+
+    void writeChunks() //throw ThreadStopRequest
+    {
+        for (;;)
+        {
+            Chunk chunk;
+            {
+                std::unique_lock dummy(lockQueue_);
+                interruptibleWait(conditionNewChunk_, dummy, [this] { return !queue_.empty(); }); //throw ThreadStopRequest
+                chunk = std::move(queue_.front());
+                queue_.pop_front();
+            }
+
+            if (const auto now = std::chrono::steady_clock::now();
+                chunk.due > now)
+                interruptibleSleep(chunk.due - now); //throw ThreadStopRequest
+            try
+            {
+                if (chunk.bytes.empty()) //pass on half-close
+                    return shutdownSocketSend(socketTo_); //throw SysError
+
+                for (size_t bytesWritten = 0; bytesWritten < chunk.bytes.size();)
+                    bytesWritten += tryWriteSocket(socketTo_, chunk.bytes.data() + bytesWritten, chunk.bytes.size() - bytesWritten); //throw SysError
+            }
+            catch (SysError&) //receiver gone => no point in reading any further
+            {
+                ::shutdown(socketFrom_, SHUT_RDWR);
+                return;
+            }
+        }
+    }
+
+    const SocketType socketFrom_;
+    const SocketType socketTo_;
+    const LatencyShimConfig cfg_;
+    const std::function<void(size_t bytes)> onRead_;
+
+    std::mutex lockQueue_;
+    std::condition_variable conditionNewChunk_;
+    std::deque<Chunk> queue_;
+
+    InterruptibleThread readThread_;  //declare last: threads use all of the above
+    InterruptibleThread writeThread_; //
+};
+
+
+class LatencyShim::Connection
+{
+public:
+    Connection(SocketType clientSocket, std::unique_ptr<Socket>&& serverSocket, LatencyShim& shim) :
+        clientSocket_(clientSocket),
+        serverSocket_(std::move(serverSocket)),
+        upstream_(clientSocket_, serverSocket_->get(), shim.cfg_, [this, &shim](size_t bytes)
+    {
+        shim.bytesSent_ += bytes;
+        if (serverSpokeLast_.exchange(false))
+            ++shim.roundTrips_;
+    }),
+    downstream_(serverSocket_->get(), clientSocket_, shim.cfg_, [this, &shim](size_t bytes)
+    {
+        shim.bytesReceived_ += bytes;
+        serverSpokeLast_ = true;
+    }) {}
+
+    ~Connection()
+    {
+        ::shutdown(clientSocket_,          SHUT_RDWR); //unblock recv()
+        ::shutdown(serverSocket_->get(), SHUT_RDWR); //
+        upstream_  .stop();
+        downstream_.stop();
+        closeSocket(clientSocket_);
+    }
+
+private:
+    const SocketType clientSocket_;
+    const std::unique_ptr<Socket> serverSocket_;
+    std::atomic<bool> serverSpokeLast_{true}; //client's first request counts as a round trip, too
+
+    Direction upstream_;   //client -> server
+    Direction downstream_; //server -> client
+};
+
+
+LatencyShim::LatencyShim(uint16_t listenPort, uint16_t targetPort, const LatencyShimConfig& cfg) : //throw SysError
+    targetPort_(targetPort),
+    cfg_(cfg),
+    listenSocket_(createListenSocket(listenPort)) //throw SysError
+{
+    acceptThread_ = InterruptibleThread([this] { setCurrentThreadName(Zstr("Latency shim")); acceptConnections(); });
+}
+
+
+LatencyShim::~LatencyShim()
+{
+    acceptThread_.requestStop();
+    acceptThread_.join();
+
+    connections_.clear();
+    closeSocket(listenSocket_);
+}
+
+
+LatencyShimTraffic LatencyShim::getTraffic() const
+{
+    return {connectionCount_, roundTrips_, bytesSent_, bytesReceived_};
+}
+
+
+void LatencyShim::acceptConnections() //throw ThreadStopRequest
+{
+    for (;;)
+    {
+        ::pollfd fds[] = {{listenSocket_, POLLIN, 0}};
+        const int rv = ::poll(fds, std::size(fds), static_cast<int>(ACCEPT_POLL_INTERVAL.count()));
+        interruptionPoint(); //throw ThreadStopRequest
+        if (rv <= 0) //timeout or EINTR
+            continue;
+
+        const SocketType clientSock = ::accept4(listenSocket_, nullptr, nullptr, SOCK_CLOEXEC);
+        if (clientSock == invalidSocket)
+            continue; //e.g. client already gone
+        try
+        {
+            auto serverSocket = std::make_unique<Socket>(Zstr("127.0.0.1"), numberTo<Zstring>(targetPort_)); //throw SysError
+            connections_.push_back(std::make_unique<Connection>(clientSock, std::move(serverSocket), *this));
+            ++connectionCount_;
+        }
+        catch (SysError&) { closeSocket(clientSock); } //server not running: client sees connection reset, like without the shim
+    }
+}
@@ -0,0 +1,74 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#ifndef LATENCY_SHIM_H_6190374528164093725
+#define LATENCY_SHIM_H_6190374528164093725
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <zen/sys_error.h>
+#include <zen/thread.h>
+
+
+namespace fff
+{
+/*  TCP relay on localhost emulating a WAN link to a local (S)FTP server: for benchmarking only (base/benchmark.h)
+    - latency: half the round trip time is added per direction; data in flight is queued, not serialized behind sleeps => pipelining still pays off
+    - bandwidth: per direction, 0 for unlimited
+    - loss: loopback doesn't lose data => a "lost" chunk and everything behind it is held back for a retransmission timeout, like TCP would
+    - counts bytes and request/response turns ("round trips": client sends after having received data)
+    caveat: FTP data connections bypass the relay (server announces its own port for PASV/EPSV) => only the control connection is shaped */
+struct LatencyShimConfig
+{
+    std::chrono::milliseconds roundTripTime{0};
+    uint64_t bytesPerSec = 0; //0: unlimited
+    int lossPerMille = 0;
+};
+
+struct LatencyShimTraffic
+{
+    int64_t connections   = 0;
+    int64_t roundTrips    = 0;
+    int64_t bytesSent     = 0; //client -> server
+    int64_t bytesReceived = 0; //server -> client
+};
+
+
+class LatencyShim
+{
+public:
+    //listen on 127.0.0.1:listenPort, forward to 127.0.0.1:targetPort
+    LatencyShim(uint16_t listenPort, uint16_t targetPort, const LatencyShimConfig& cfg); //throw SysError
+    ~LatencyShim();
+
+    LatencyShimTraffic getTraffic() const;
+
+private:
+    LatencyShim           (const LatencyShim&) = delete;
+    LatencyShim& operator=(const LatencyShim&) = delete;
+
+    class Connection;
+    class Direction;
+
+    void acceptConnections(); //throw ThreadStopRequest; context of accept thread
+
+    const uint16_t targetPort_;
+    const LatencyShimConfig cfg_;
+    const int listenSocket_;
+
+    std::atomic<int64_t> connectionCount_{0};
+    std::atomic<int64_t> roundTrips_     {0};
+    std::atomic<int64_t> bytesSent_      {0};
+    std::atomic<int64_t> bytesReceived_  {0};
+
+    std::vector<std::unique_ptr<Connection>> connections_; //accessed by accept thread only (and destructor after it ended)
+    zen::InterruptibleThread acceptThread_;
+};
+}
+
+#endif //LATENCY_SHIM_H_6190374528164093725
@@ -3,6 +3,9 @@
 
 #include <zen/stl_tools.h>
 #include <zen/file_path.h>
+#include <zen/thread.h>
+#include <zen/format_unit.h>
+#include <sys/stat.h>
 #include "dir_lock.h"
 #include "process_callback.h"
 
@@ -23,17 +26,82 @@ public:
     {
         using namespace zen;
 
-        std::vector<std::pair<Zstring, FileError>> failedLocks;
+        /*  lock file creation is synchronous and may block noticeably for very slow devices (USB sticks, mapped cloud storage, NAS)
+            - different devices: lock in parallel => don't add up latencies and waiting times for busy folders
+            - same device: lock sequentially in deterministic (sorted) order => folder aliases (symlinks, case differences) are detected by DirLock
+              and two processes locking the same set of folders can't deadlock each other                                                     */
+        std::map<std::optional<dev_t>, std::vector<Zstring>> perDevicePaths; //no device id: lock sequentially with other failed stat() calls
 
         for (const Zstring& folderPath : folderPaths)
-            try
+        {
+            struct stat folderInfo = {};
+            perDevicePaths[::stat(folderPath.c_str(), &folderInfo) == 0 ? std::optional(folderInfo.st_dev) : std::nullopt].push_back(folderPath);
+        }
+
+        std::mutex lockResults; //protect lockHolder_, failedLocks, statusMsgs
+        std::vector<std::pair<Zstring, FileError>> failedLocks;
+        std::vector<std::wstring> statusMsgs(perDevicePaths.size()); //"waiting for lock" status per device
+        {
+            ThreadGroup<std::function<void()>> tg(std::max<size_t>(perDevicePaths.size(), 1), Zstr("DirLock"));
+
+            size_t deviceIdx = 0;
+            for (const auto& [deviceId, deviceFolderPaths] : perDevicePaths)
             {
-                //lock file creation is synchronous and may block noticeably for very slow devices (USB sticks, mapped cloud storage)
-                lockHolder_.emplace_back(appendPath(folderPath, Zstring(Zstr("sync")) + LOCK_FILE_ENDING),
-                [&](std::wstring&& msg) { pcb.updateStatus(std::move(msg)); /*throw X*/ },
-                UI_UPDATE_INTERVAL / 2); //throw FileError
+                tg.run([&, deviceIdx, &deviceFolderPaths = deviceFolderPaths]
+                {
+                    for (const Zstring& folderPath : deviceFolderPaths)
+                        try
+                        {
+                            DirLock dirLock(appendPath(folderPath, Zstring(Zstr("sync")) + LOCK_FILE_ENDING),
+                            [&](std::wstring&& msg)
+                            {
+                                interruptionPoint(); //throw ThreadStopRequest
+                                std::lock_guard dummy(lockResults);
+                                statusMsgs[deviceIdx] = std::move(msg);
+                            },
+                            UI_UPDATE_INTERVAL / 2); //throw FileError, ThreadStopRequest
+
+                            std::lock_guard dummy(lockResults);
+                            lockHolder_.push_back(std::move(dirLock));
+                        }
+                        catch (const FileError& e)
+                        {
+                            std::lock_guard dummy(lockResults);
+                            failedLocks.emplace_back(folderPath, e);
+                        }
+
+                    std::lock_guard dummy(lockResults);
+                    statusMsgs[deviceIdx].clear();
+                });
+                ++deviceIdx;
             }
-            catch (const FileError& e) { failedLocks.emplace_back(folderPath, e); }
+
+            //same as ThreadGroup::wait(), but keep UI responsive: user may abort while waiting on busy folders
+            auto promiseDone = std::make_shared<std::promise<void>>();
+            std::future<void> allDone = promiseDone->get_future();
+            tg.notifyWhenDone([promiseDone] { promiseDone->set_value(); });
+
+            while (allDone.wait_for(UI_UPDATE_INTERVAL / 2) == std::future_status::timeout)
+            {
+                std::wstring statusMsg;
+                size_t waitCount = 0;
+                {
+                    std::lock_guard dummy(lockResults);
+                    for (const std::wstring& msg : statusMsgs)
+                        if (!msg.empty())
+                            if (waitCount++ == 0)
+                                statusMsg = msg;
+                }
+                if (waitCount > 1)
+                    statusMsg += L" [+" + formatNumber(waitCount - 1) + L']';
+
+                if (statusMsg.empty())
+                    pcb.requestUiUpdate(); //throw X
+                else
+                    pcb.updateStatus(std::move(statusMsg)); //throw X
+            } //exception: ~ThreadGroup() stops and joins workers (see interruptionPoint() above) *before* the local variables they access go out of scope
+        }
+        std::sort(failedLocks.begin(), failedLocks.end(), [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; }); //deterministic warning message
 
         if (!failedLocks.empty())
         {
@@ -0,0 +1,81 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#include "memory_stats.h"
+#include <atomic>
+#include <cassert>
+#include <zen/format_unit.h>
+#include <zen/utf.h>
+
+using namespace zen;
+using namespace fff;
+
+
+namespace
+{
+constexpr size_t MEMORY_CATEGORY_COUNT = static_cast<size_t>(MemoryCategory::log) + 1;
+
+struct MemoryCounter
+{
+    std::atomic<int64_t> bytes{0};
+    std::atomic<int64_t> bytesPeak{0};
+};
+constinit MemoryCounter memoryCounters[MEMORY_CATEGORY_COUNT];
+}
+
+
+void fff::addMemoryUsage(MemoryCategory category, int64_t bytesDelta) //noexcept
+{
+    assert(static_cast<size_t>(category) < MEMORY_CATEGORY_COUNT);
+    MemoryCounter& counter = memoryCounters[static_cast<size_t>(category)];
+
+    const int64_t bytesNew = counter.bytes += bytesDelta;
+    assert(bytesNew >= 0);
+
+    for (int64_t peak = counter.bytesPeak; bytesNew > peak && !counter.bytesPeak.compare_exchange_weak(peak, bytesNew);)
+        ; //peak is updated on failure
+}
+
+
+std::vector<MemoryUsage> fff::getMemoryUsage()
+{
+    std::vector<MemoryUsage> usage;
+    for (size_t i = 0; i < MEMORY_CATEGORY_COUNT; ++i)
+        usage.push_back({static_cast<MemoryCategory>(i), memoryCounters[i].bytes, memoryCounters[i].bytesPeak});
+    return usage;
+}
+
+
+const char* fff::getMemoryCategoryName(MemoryCategory category)
+{
+    switch (category)
+    {
+        //*INDENT-OFF*
+        case MemoryCategory::scanBuffer:    return "scanBuffer";
+        case MemoryCategory::fileHierarchy: return "fileHierarchy";
+        case MemoryCategory::viewIndex:     return "viewIndex";
+        case MemoryCategory::syncState:     return "syncState";
+        case MemoryCategory::iconCache:     return "iconCache";
+        case MemoryCategory::log:           return "log";
+        //*INDENT-ON*
+    }
+    assert(false);
+    return "";
+}
+
+
+std::wstring fff::formatMemoryUsage(const std::vector<MemoryUsage>& usage)
+{
+    std::wstring output;
+    for (const MemoryUsage& mu : usage)
+    {
+        if (!output.empty())
+            output += L" | ";
+        output += utfTo<std::wstring>(getMemoryCategoryName(mu.category)) + L' ' + formatFilesizeShort(mu.bytes) +
+                  L" (peak " + formatFilesizeShort(mu.bytesPeak) + L')';
+    }
+    return output;
+}
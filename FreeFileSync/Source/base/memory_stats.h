@@ -0,0 +1,90 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#ifndef MEMORY_STATS_H_4712983650192837465
+#define MEMORY_STATS_H_4712983650192837465
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <atomic>
+#include <zen/error_log.h>
+
+
+namespace fff
+{
+/*  process-wide memory accounting per subsystem: for sizing machines for big jobs and spotting memory regressions
+    - counts large structures only (arena blocks, view indexes, ...) => lightweight, but an estimate, not the process total
+    - thread-safe: counters are updated from worker threads, too                                                              */
+enum class MemoryCategory
+{
+    scanBuffer,    //folder traversal output: see parallelDeviceTraversal()
+    fileHierarchy, //BaseFolderPair item lists
+    viewIndex,     //FileView/TreeView rows and lookup tables
+    syncState,     //sync.ffs_db: last synchronous state
+    iconCache,     //decoded file icons and thumbnails
+    log,           //error logs of running processes
+};
+
+struct MemoryUsage
+{
+    MemoryCategory category = MemoryCategory::scanBuffer;
+    int64_t bytes     = 0;
+    int64_t bytesPeak = 0; //since process start
+};
+
+void addMemoryUsage(MemoryCategory category, int64_t bytesDelta); //noexcept
+std::vector<MemoryUsage> getMemoryUsage(); //all categories
+
+const char* getMemoryCategoryName(MemoryCategory category); //untranslated: debug info and metrics only
+std::wstring formatMemoryUsage(const std::vector<MemoryUsage>& usage); //single line
+
+
+//size estimate of an object for its lifetime: thread-safe
+class MemoryUsageTracker
+{
+public:
+    explicit MemoryUsageTracker(MemoryCategory category) : category_(category) {}
+    ~MemoryUsageTracker() { addMemoryUsage(category_, -bytes_); }
+
+    void set(int64_t bytes) { addMemoryUsage(category_, bytes - bytes_.exchange(bytes)); } //noexcept
+    void add(int64_t bytesDelta) { bytes_ += bytesDelta; addMemoryUsage(category_, bytesDelta); } //
+
+private:
+    MemoryUsageTracker           (const MemoryUsageTracker&) = delete;
+    MemoryUsageTracker& operator=(const MemoryUsageTracker&) = delete;
+
+    const MemoryCategory category_;
+    std::atomic<int64_t> bytes_{0};
+};
+
+
+//append-only error log: O(new entries) per update
+class ErrorLogMemoryTracker
+{
+public:
+    void update(const zen::ErrorLog& log)
+    {
+        if (log.size() < entriesCounted_) //log was replaced
+        {
+            entriesCounted_ = 0;
+            messageBytes_ = 0;
+        }
+        for (size_t i = entriesCounted_; i < log.size(); ++i)
+            messageBytes_ += log[i].message.size();
+        entriesCounted_ = log.size();
+
+        tracker_.set(log.capacity() * sizeof(zen::LogEntry) + messageBytes_);
+    }
+
+private:
+    size_t entriesCounted_ = 0;
+    int64_t messageBytes_ = 0;
+    MemoryUsageTracker tracker_{MemoryCategory::log};
+};
+}
+
+#endif //MEMORY_STATS_H_4712983650192837465
@@ -69,7 +69,8 @@ public:
     }
 
     //context of main thread
-    void waitUntilDone(std::chrono::milliseconds duration, const TravErrorCb& onError, const TravStatusCb& onStatusUpdate) //throw X
+    void waitUntilDone(std::chrono::milliseconds duration, const TravErrorCb& onError, const TravStatusCb& onStatusUpdate, //throw X
+                       const std::function<void(int threadIdx)>& onThreadDone /*throw X*/)
     {
         assert(runningOnMainThread());
         for (;;)
@@ -78,10 +79,20 @@ public:
 
             for (std::unique_lock dummy(lockRequest_) ;;) //process all errors without delay
             {
-                const bool rv = conditionNewRequest.wait_until(dummy, callbackTime, [this] { return (errorRequest_ && !errorResponse_) || (threadsToFinish_ == 0); });
+                const bool rv = conditionNewRequest.wait_until(dummy, callbackTime, [this] { return (errorRequest_ && !errorResponse_) || !threadsDone_.empty() || (threadsToFinish_ == 0); });
                 if (!rv) //time-out + condition not met
                     break;
 
+                if (!threadsDone_.empty())
+                {
+                    const std::vector<int> threadsDone = std::exchange(threadsDone_, {});
+                    dummy.unlock(); //don't block error reporting of the remaining threads
+                    for (const int threadIdx : threadsDone)
+                        onThreadDone(threadIdx); //throw X
+                    dummy.lock();
+                    continue; //re-evaluate: more threads may have finished meanwhile
+                }
+
                 if (errorRequest_ && !errorResponse_)
                 {
                     assert(threadsToFinish_ != 0);
@@ -111,15 +122,18 @@ public:
     }
 
     //perf optimization: comparison phase is 7% faster by avoiding needless std::wstring construction for reportCurrentFile()
-    bool mayReportCurrentFile(int threadIdx, std::chrono::steady_clock::time_point& lastReportTime) const
+    bool mayReportCurrentFile(int threadIdx) const
     {
         if (threadIdx != notifyingThreadIdx_) //only one thread at a time may report status: the first in sequential order
             return false;
 
+        //keep "lastReportTime" at (OS) thread level to avoid locking: a device may be traversed by multiple threads!
+        thread_local std::chrono::steady_clock::time_point lastReportTime;
+
         const auto now = std::chrono::steady_clock::now();
         if (now > lastReportTime + cbInterval_) //perform ui updates not more often than necessary
         {
-            lastReportTime = now; //keep "lastReportTime" at worker thread level to avoid locking!
+            lastReportTime = now;
             return true;
         }
         return false;
@@ -157,8 +171,9 @@ public:
         {
             std::lock_guard dummy(lockRequest_);
             assert(threadsToFinish_ > 0);
-            if (--threadsToFinish_ == 0)
-                conditionNewRequest.notify_all(); //perf: should unlock mutex before notify!? (insignificant)
+            --threadsToFinish_;
+            threadsDone_.push_back(threadIdx);
+            conditionNewRequest.notify_all(); //perf: should unlock mutex before notify!? (insignificant)
         }
     }
 
@@ -188,6 +203,7 @@ private:
     std::optional<AFS::TraverserCallback::ErrorInfo  > errorRequest_;
     std::optional<AFS::TraverserCallback::HandleError> errorResponse_;
     size_t threadsToFinish_; //can't use activeThreadIdxs_.size() which is locked by different mutex!
+    std::vector<int> threadsDone_; //finished, but not yet reported to main thread
     //also note: activeThreadIdxs_.size() may be 0 during worker thread construction!
 
     //---- status updates ----
@@ -204,47 +220,143 @@ private:
 
 //-------------------------------------------------------------------------------------------------
 
+//keep only the top slowest/largest folders => bounded memory even for huge folder trees
+class ScanStatsCollector
+{
+public:
+    //context of worker thread
+    void add(std::chrono::steady_clock::duration readTime, size_t itemCount, const AbstractPath& folderPath)
+    {
+        const auto readTimeMs = std::chrono::duration_cast<std::chrono::milliseconds>(readTime);
+
+        std::lock_guard dummy(lockStats_);
+
+        const bool isSlow  = qualifies(stats_.slowest, [&](const FolderScanStats::Folder& f) { return readTimeMs > f.readTime;  });
+        const bool isLarge = qualifies(stats_.largest, [&](const FolderScanStats::Folder& f) { return itemCount  > f.itemCount; });
+        if (!isSlow && !isLarge)
+            return; //the common case: don't even create the display path
+
+        const FolderScanStats::Folder folder{AFS::getDisplayPath(folderPath), readTimeMs, itemCount};
+        if (isSlow)
+            insertTopN(stats_.slowest, folder, [](const FolderScanStats::Folder& lhs, const FolderScanStats::Folder& rhs) { return lhs.readTime > rhs.readTime; });
+        if (isLarge)
+            insertTopN(stats_.largest, folder, [](const FolderScanStats::Folder& lhs, const FolderScanStats::Folder& rhs) { return lhs.itemCount > rhs.itemCount; });
+    }
+
+    FolderScanStats get() const { std::lock_guard dummy(lockStats_); return stats_; }
+
+private:
+    static constexpr size_t TOP_COUNT = 10;
+
+    template <class Pred>
+    static bool qualifies(const std::vector<FolderScanStats::Folder>& topN, Pred isGreater)
+    {
+        return topN.size() < TOP_COUNT || isGreater(topN.back());
+    }
+
+    template <class Greater>
+    static void insertTopN(std::vector<FolderScanStats::Folder>& topN, const FolderScanStats::Folder& folder, Greater greater)
+    {
+        topN.insert(std::upper_bound(topN.begin(), topN.end(), folder, greater), folder);
+        if (topN.size() > TOP_COUNT)
+            topN.pop_back();
+    }
+
+    mutable std::mutex lockStats_;
+    FolderScanStats stats_;
+};
+
+//-------------------------------------------------------------------------------------------------
+
 struct TraverserConfig
 {
     const AbstractPath baseFolderPath;  //thread-safe like an int! :)
     const FilterRef filter;
     const SymLinkHandling handleSymlinks;
 
-    std::unordered_map<Zstring, Zstringc>& failedDirReads;
-    std::unordered_map<Zstring, Zstringc>& failedItemReads;
+    std::unordered_map<Zstring, Zstringc>& failedDirReads;  //
+    std::unordered_map<Zstring, Zstringc>& failedItemReads; //protected by lockFailedReads
+    std::mutex lockFailedReads{}; //callbacks may run in parallel for "parallel file operations" > 1
+    MemoryUsageTracker& itemListMemory; //thread-safe
 
+    //incremental traversal (optional):
+    const SelectSide lastSyncSide;
+    const std::unordered_set<Zstring> changedRelPaths;
+    const std::unordered_set<Zstring> changedParentRelPaths; //all (strict) parent folders of changedRelPaths + modified folders => read, but don't traverse completely
+
+    ItemNamePool* const namePool; //optional
+    ScanStatsCollector* const scanStats; //optional
     AsyncCallback& acb;
     const int threadIdx;
-    std::chrono::steady_clock::time_point& lastReportTime; //thread-level
 };
 
 
+std::unordered_set<Zstring> getParentRelPaths(const IncrementalScan& incScan)
+{
+    std::unordered_set<Zstring> parentPaths;
+    for (const std::vector<Zstring>* relPaths : {&incScan.changedRelPaths, &incScan.modifiedRelPaths})
+        for (const Zstring& relPath : *relPaths)
+            for (Zstring parentPath = relPath;;)
+            {
+                parentPath = beforeLast(parentPath, FILE_NAME_SEPARATOR, IfNotFoundReturn::none);
+                if (parentPath.empty() || !parentPaths.insert(parentPath).second) //=> all further parents already inserted
+                    break;
+            }
+
+    //modified item might be a folder: read it, but take sub folders from the last synchronous state
+    parentPaths.insert(incScan.modifiedRelPaths.begin(), incScan.modifiedRelPaths.end());
+    return parentPaths;
+}
+
+
 class DirCallback : public AFS::TraverserCallback
 {
 public:
     DirCallback(TraverserConfig& cfg,
                 const Zstring& parentRelPathPf, //postfixed with FILE_NAME_SEPARATOR!
                 FolderContainer& output,
+                const InSyncFolder* lastSyncFolder, //optional: nullptr => traverse all sub folders
                 int level) :
         cfg_(cfg),
         parentRelPathPf_(parentRelPathPf),
         output_(output),
+        lastSyncFolder_(lastSyncFolder),
         level_(level) {} //MUST NOT use cfg_ during construction! see BaseDirCallback()
 
-    virtual void                               onFile   (const AFS::FileInfo&    fi) override; //
-    virtual std::shared_ptr<TraverserCallback> onFolder (const AFS::FolderInfo&  fi) override; //throw ThreadStopRequest
-    virtual HandleLink                         onSymlink(const AFS::SymlinkInfo& li) override; //
+    virtual void                               onFile   (AFS::FileInfo&&    fi) override; //
+    virtual std::shared_ptr<TraverserCallback> onFolder (AFS::FolderInfo&&  fi) override; //throw ThreadStopRequest
+    virtual HandleLink                         onSymlink(AFS::SymlinkInfo&& li) override; //
 
     HandleError reportDirError (const ErrorInfo& errorInfo)                          override  { return reportError(errorInfo, Zstring()); } //throw ThreadStopRequest
     HandleError reportItemError(const ErrorInfo& errorInfo, const Zstring& itemName) override  { return reportError(errorInfo, itemName);  } //
 
+    void onFolderRead(std::chrono::steady_clock::duration readTime) override
+    {
+        cfg_.itemListMemory.add(output_.files   .size() * sizeof(FolderContainer::FileList   ::value_type) +
+                                output_.symlinks.size() * sizeof(FolderContainer::SymlinkList::value_type));
+        if (cfg_.scanStats)
+            cfg_.scanStats->add(readTime, itemCount_, AFS::appendRelPath(cfg_.baseFolderPath, beforeLast(parentRelPathPf_, FILE_NAME_SEPARATOR, IfNotFoundReturn::none)));
+    }
+
 private:
     HandleError reportError(const ErrorInfo& errorInfo, const Zstring& itemName /*optional*/); //throw ThreadStopRequest
 
+    void addLastSyncState(FolderContainer& output, const InSyncFolder& dbFolder, const Zstring& parentRelPathPf); //noexcept
+
+    Zstring poolName(Zstring&& itemName) const { return cfg_.namePool ? cfg_.namePool->intern(itemName) : std::move(itemName); }
+
+    void reportCurrentItem(const Zstring& itemName) //update status information no matter if item is excluded or not!
+    {
+        if (cfg_.acb.mayReportCurrentFile(cfg_.threadIdx)) //relative path only when actually shown
+            cfg_.acb.reportCurrentFile(AFS::getDisplayPath(AFS::appendRelPath(cfg_.baseFolderPath, parentRelPathPf_ + itemName)));
+    }
+
     TraverserConfig& cfg_;
     const Zstring parentRelPathPf_;
     FolderContainer& output_;
+    const InSyncFolder* const lastSyncFolder_;
     const int level_;
+    size_t itemCount_ = 0; //items reported for this folder (including excluded ones)
 };
 
 
@@ -252,8 +364,12 @@ class BaseDirCallback : public DirCallback
 {
 public:
     BaseDirCallback(const DirectoryKey& baseFolderKey, DirectoryValue& output,
-                    AsyncCallback& acb, int threadIdx, std::chrono::steady_clock::time_point& lastReportTime) :
-        DirCallback(travCfg_ /*not yet constructed!!!*/, Zstring(), output.folderCont, 0 /*level*/),
+                    const IncrementalScan* incScan, //optional
+                    ItemNamePool* namePool, //optional
+                    ScanStatsCollector* scanStats, //optional
+                    AsyncCallback& acb, int threadIdx) :
+        DirCallback(travCfg_ /*not yet constructed!!!*/, Zstring(), output.folderCont,
+                    incScan ? &incScan->lastSyncState.ref() : nullptr, 0 /*level*/),
         travCfg_
     {
         baseFolderKey.folderPath,
@@ -261,12 +377,18 @@ public:
         baseFolderKey.handleSymlinks,
         output.failedFolderReads,
         output.failedItemReads,
+        {},
+        output.itemListMemory,
+        incScan ? incScan->side : SelectSide::left,
+        incScan ? std::unordered_set<Zstring>(incScan->changedRelPaths.begin(), incScan->changedRelPaths.end()) : std::unordered_set<Zstring>(),
+        incScan ? getParentRelPaths(*incScan) : std::unordered_set<Zstring>(),
+        namePool,
+        scanStats,
         acb,
-        threadIdx,
-        lastReportTime
+        threadIdx
     }
     {
-        if (acb.mayReportCurrentFile(threadIdx, lastReportTime))
+        if (acb.mayReportCurrentFile(threadIdx))
             acb.reportCurrentFile(AFS::getDisplayPath(baseFolderKey.folderPath)); //just in case first directory access is blocking
     }
 
@@ -275,19 +397,16 @@ private:
 };
 
 
-void DirCallback::onFile(const AFS::FileInfo& fi) //throw ThreadStopRequest
+void DirCallback::onFile(AFS::FileInfo&& fi) //throw ThreadStopRequest
 {
     interruptionPoint(); //throw ThreadStopRequest
+    ++itemCount_;
 
-    const Zstring& relPath = parentRelPathPf_ + fi.itemName;
-
-    //update status information no matter if item is excluded or not!
-    if (cfg_.acb.mayReportCurrentFile(cfg_.threadIdx, cfg_.lastReportTime))
-        cfg_.acb.reportCurrentFile(AFS::getDisplayPath(AFS::appendRelPath(cfg_.baseFolderPath, relPath)));
+    reportCurrentItem(fi.itemName);
 
     //------------------------------------------------------------------------------------
     //apply filter before processing (use relative name!)
-    if (!cfg_.filter.ref().passFileFilter(relPath))
+    if (!cfg_.filter.ref().passChildFileFilter(parentRelPathPf_, fi.itemName))
         return;
 
     //sync.ffs_db database and lock files are excluded via filter!
@@ -302,20 +421,21 @@ void DirCallback::onFile(const AFS::FileInfo& fi) //throw ThreadStopRequest
 
         Linux: retrieveFileID takes about 50% longer in VM! (avoidable because of redundant stat() call!)       */
 
-    output_.addSubFile(fi.itemName, FileAttributes(fi.modTime, fi.fileSize, fi.filePrint, fi.isFollowedSymlink));
+    output_.addSubFile(poolName(std::move(fi.itemName)), FileAttributes(fi.modTime, fi.fileSize, fi.filePrint, fi.isFollowedSymlink));
 
     cfg_.acb.incItemsScanned(); //add 1 element to the progress indicator
 }
 
 
-std::shared_ptr<AFS::TraverserCallback> DirCallback::onFolder(const AFS::FolderInfo& fi) //throw ThreadStopRequest
+std::shared_ptr<AFS::TraverserCallback> DirCallback::onFolder(AFS::FolderInfo&& fi) //throw ThreadStopRequest
 {
     interruptionPoint(); //throw ThreadStopRequest
+    ++itemCount_;
 
     const Zstring& relPath = parentRelPathPf_ + fi.itemName;
 
     //update status information no matter if item is excluded or not!
-    if (cfg_.acb.mayReportCurrentFile(cfg_.threadIdx, cfg_.lastReportTime))
+    if (cfg_.acb.mayReportCurrentFile(cfg_.threadIdx))
         cfg_.acb.reportCurrentFile(AFS::getDisplayPath(AFS::appendRelPath(cfg_.baseFolderPath, relPath)));
 
     //------------------------------------------------------------------------------------
@@ -326,11 +446,26 @@ std::shared_ptr<AFS::TraverserCallback> DirCallback::onFolder(const AFS::FolderI
         return nullptr; //do NOT traverse subdirs
     //else: attention! ensure directory filtering is applied later to exclude actually filtered directories
 
-    FolderContainer& subFolder = output_.addSubFolder(fi.itemName, FolderAttributes(fi.isFollowedSymlink));
+    FolderContainer& subFolder = output_.addSubFolder(poolName(std::move(fi.itemName)), FolderAttributes(fi.isFollowedSymlink));
     if (passFilter)
         cfg_.acb.incItemsScanned(); //add 1 element to the progress indicator
 
     //------------------------------------------------------------------------------------
+    //incremental traversal: folders not affected by changes are taken from the last synchronous state
+    const InSyncFolder* lastSyncSubFolder = nullptr;
+    if (lastSyncFolder_ && !cfg_.changedRelPaths.contains(relPath)) //changed folder => traverse completely
+        if (auto itDb = lastSyncFolder_->folders.find(fi.itemName);
+            itDb != lastSyncFolder_->folders.end()) //not in database => traverse completely
+        {
+            lastSyncSubFolder = &itDb->second;
+
+            if (!cfg_.changedParentRelPaths.contains(relPath))
+            {
+                addLastSyncState(subFolder, *lastSyncSubFolder, relPath + FILE_NAME_SEPARATOR);
+                return nullptr; //do NOT traverse subdirs
+            }
+        }
+
     if (level_ > FOLDER_TRAVERSAL_LEVEL_MAX) //Win32 traverser: stack overflow approximately at level 1000
         //check after FolderContainer::addSubFolder()
         for (size_t retryNumber = 0;; ++retryNumber)
@@ -343,19 +478,59 @@ std::shared_ptr<AFS::TraverserCallback> DirCallback::onFolder(const AFS::FolderI
                     return nullptr;
             }
 
-    return std::make_shared<DirCallback>(cfg_, relPath + FILE_NAME_SEPARATOR, subFolder, level_ + 1);
+    return std::make_shared<DirCallback>(cfg_, relPath + FILE_NAME_SEPARATOR, subFolder, lastSyncSubFolder, level_ + 1);
 }
 
 
-DirCallback::HandleLink DirCallback::onSymlink(const AFS::SymlinkInfo& si) //throw ThreadStopRequest
+void DirCallback::addLastSyncState(FolderContainer& output, const InSyncFolder& dbFolder, const Zstring& parentRelPathPf) //noexcept
 {
-    interruptionPoint(); //throw ThreadStopRequest
+    //items were filtered while saving the database, but the filter may have changed since
+    for (const auto& [fileName, dbFile] : dbFolder.files)
+        if (cfg_.filter.ref().passFileFilter(parentRelPathPf + fileName.normStr))
+        {
+            const InSyncDescrFile& descr = cfg_.lastSyncSide == SelectSide::left ? dbFile.left : dbFile.right;
+            output.addSubFile(fileName.normStr, FileAttributes(descr.modTime, dbFile.fileSize, descr.filePrint, false /*isFollowedSymlink*/));
+            cfg_.acb.incItemsScanned(); //add 1 element to the progress indicator
+        }
 
-    const Zstring& relPath = parentRelPathPf_ + si.itemName;
+    if (cfg_.handleSymlinks == SymLinkHandling::direct) //database contains non-followed symlinks only
+        for (const auto& [linkName, dbLink] : dbFolder.symlinks)
+            if (cfg_.filter.ref().passFileFilter(parentRelPathPf + linkName.normStr))
+            {
+                const InSyncDescrLink& descr = cfg_.lastSyncSide == SelectSide::left ? dbLink.left : dbLink.right;
+                output.addSubLink(linkName.normStr, LinkAttributes(descr.modTime));
+                cfg_.acb.incItemsScanned(); //add 1 element to the progress indicator
+            }
 
-    //update status information no matter if item is excluded or not!
-    if (cfg_.acb.mayReportCurrentFile(cfg_.threadIdx, cfg_.lastReportTime))
-        cfg_.acb.reportCurrentFile(AFS::getDisplayPath(AFS::appendRelPath(cfg_.baseFolderPath, relPath)));
+    for (const auto& [folderName, dbSubFolder] : dbFolder.folders)
+    {
+        const Zstring& relPath = parentRelPathPf + folderName.normStr;
+
+        bool childItemMightMatch = true;
+        const bool passFilter = cfg_.filter.ref().passDirFilter(relPath, &childItemMightMatch);
+        if (!passFilter && !childItemMightMatch)
+            continue;
+
+        //straw man without children: don't make up a folder that might exist on one side only
+        if (dbSubFolder.status == InSyncFolder::DIR_STATUS_STRAW_MAN &&
+            dbSubFolder.files.empty() && dbSubFolder.symlinks.empty() && dbSubFolder.folders.empty())
+            continue;
+
+        FolderContainer& subFolder = output.addSubFolder(folderName.normStr, FolderAttributes(false /*isSymlink*/));
+        if (passFilter)
+            cfg_.acb.incItemsScanned(); //add 1 element to the progress indicator
+
+        addLastSyncState(subFolder, dbSubFolder, relPath + FILE_NAME_SEPARATOR);
+    }
+}
+
+
+DirCallback::HandleLink DirCallback::onSymlink(AFS::SymlinkInfo&& si) //throw ThreadStopRequest
+{
+    interruptionPoint(); //throw ThreadStopRequest
+    ++itemCount_;
+
+    reportCurrentItem(si.itemName);
 
     switch (cfg_.handleSymlinks)
     {
@@ -363,9 +538,9 @@ DirCallback::HandleLink DirCallback::onSymlink(const AFS::SymlinkInfo& si) //thr
             return HandleLink::skip;
 
         case SymLinkHandling::direct:
-            if (cfg_.filter.ref().passFileFilter(relPath)) //always use file filter: Link type may not be "stable" on Linux!
+            if (cfg_.filter.ref().passChildFileFilter(parentRelPathPf_, si.itemName)) //always use file filter: Link type may not be "stable" on Linux!
             {
-                output_.addSubLink(si.itemName, LinkAttributes(si.modTime));
+                output_.addSubLink(poolName(std::move(si.itemName)), LinkAttributes(si.modTime));
                 cfg_.acb.incItemsScanned(); //add 1 element to the progress indicator
             }
             return HandleLink::skip;
@@ -373,10 +548,10 @@ DirCallback::HandleLink DirCallback::onSymlink(const AFS::SymlinkInfo& si) //thr
         case SymLinkHandling::follow:
             //filter symlinks before trying to follow them: handle user-excluded broken symlinks!
             //since we don't know yet what type the symlink will resolve to, only do this when both filter variants agree:
-            if (!cfg_.filter.ref().passFileFilter(relPath))
+            if (!cfg_.filter.ref().passChildFileFilter(parentRelPathPf_, si.itemName))
             {
                 bool childItemMightMatch = true;
-                if (!cfg_.filter.ref().passDirFilter(relPath, &childItemMightMatch))
+                if (!cfg_.filter.ref().passDirFilter(parentRelPathPf_ + si.itemName, &childItemMightMatch))
                     if (!childItemMightMatch)
                         return HandleLink::skip;
             }
@@ -388,17 +563,64 @@ DirCallback::HandleLink DirCallback::onSymlink(const AFS::SymlinkInfo& si) //thr
 }
 
 
+//derive the result of a traversal with a narrower filter: same rules as DirCallback
+void copyFiltered(const FolderContainer& folderCont, FolderContainer& output, const PathFilter& filter, const Zstring& parentRelPathPf)
+{
+    for (const auto& [fileName, attr] : folderCont.files)
+        if (filter.passFileFilter(parentRelPathPf + fileName))
+            output.addSubFile(fileName, attr);
+
+    for (const auto& [linkName, attr] : folderCont.symlinks)
+        if (filter.passFileFilter(parentRelPathPf + linkName))
+            output.addSubLink(linkName, attr);
+
+    for (const auto& [folderName, attrAndSub] : folderCont.folders)
+    {
+        const Zstring& relPath = parentRelPathPf + folderName;
+
+        bool childItemMightMatch = true;
+        if (!filter.passDirFilter(relPath, &childItemMightMatch) && !childItemMightMatch)
+            continue;
+
+        copyFiltered(attrAndSub.second, output.addSubFolder(folderName, attrAndSub.first), filter, relPath + FILE_NAME_SEPARATOR);
+    }
+}
+
+
+void copyFiltered(const DirectoryValue& dirVal, DirectoryValue& output, const PathFilter& filter)
+{
+    copyFiltered(dirVal.folderCont, output.folderCont, filter, Zstring());
+
+    for (const auto& [relPath, errorMsg] : dirVal.failedFolderReads)
+    {
+        bool childItemMightMatch = true;
+        if (relPath.empty() || filter.passDirFilter(relPath, &childItemMightMatch) || childItemMightMatch)
+            output.failedFolderReads.emplace(relPath, errorMsg);
+    }
+
+    for (const auto& [relPath, errorMsg] : dirVal.failedItemReads) //item type unknown: file or folder
+    {
+        bool childItemMightMatch = true;
+        if (filter.passFileFilter(relPath) || filter.passDirFilter(relPath, &childItemMightMatch) || childItemMightMatch)
+            output.failedItemReads.emplace(relPath, errorMsg);
+    }
+}
+
+
 DirCallback::HandleError DirCallback::reportError(const ErrorInfo& errorInfo, const Zstring& itemName /*optional*/) //throw ThreadStopRequest
 {
     const HandleError handleErr = cfg_.acb.reportError(errorInfo); //throw ThreadStopRequest
     switch (handleErr)
     {
         case HandleError::ignore:
+        {
+            std::lock_guard dummy(cfg_.lockFailedReads);
             if (itemName.empty())
                 cfg_.failedDirReads.emplace(beforeLast(parentRelPathPf_, FILE_NAME_SEPARATOR, IfNotFoundReturn::none), utfTo<Zstringc>(errorInfo.msg));
             else
                 cfg_.failedItemReads.emplace(parentRelPathPf_ + itemName, utfTo<Zstringc>(errorInfo.msg));
-            break;
+        }
+        break;
 
         case HandleError::retry:
             break;
@@ -409,20 +631,56 @@ DirCallback::HandleError DirCallback::reportError(const ErrorInfo& errorInfo, co
 
 
 std::map<DirectoryKey, DirectoryValue> fff::parallelDeviceTraversal(const std::set<DirectoryKey>& foldersToRead,
+                                                                    const std::map<AfsDevice, size_t>& deviceParallelOps,
+                                                                    const std::map<DirectoryKey, IncrementalScan>& incrementalScans,
+                                                                    ItemNamePool* namePool,
+                                                                    FolderScanStats* scanStats,
                                                                     const TravErrorCb& onError, const TravStatusCb& onStatusUpdate,
+                                                                    const TravFolderDoneCb& onFolderDone,
                                                                     std::chrono::milliseconds cbInterval)
 {
     std::map<DirectoryKey, DirectoryValue> output;
 
+    //same folder needed with different filters (e.g. one source synced to multiple targets): traverse only once using the union of all filters
+    std::map<std::pair<AbstractPath, SymLinkHandling>, std::vector<DirectoryKey>> keysByFolder;
+    for (const DirectoryKey& key : foldersToRead)
+        keysByFolder[{key.folderPath, key.handleSymlinks}].push_back(key);
+
+    std::vector<std::pair<DirectoryKey /*shared traversal*/, std::vector<DirectoryKey>>> sharedKeys;
+    std::set<DirectoryKey> foldersToTraverse;
+
+    for (const auto& [folder, keys] : keysByFolder)
+        if (keys.size() == 1 || std::any_of(keys.begin(), keys.end(), [&](const DirectoryKey& key) { return incrementalScans.contains(key); }))
+            foldersToTraverse.insert(keys.begin(), keys.end()); //incremental scans depend on the filter of their sync.ffs_db => don't share
+        else
+        {
+            std::vector<FilterRef> filters;
+            for (const DirectoryKey& key : keys)
+                filters.push_back(key.filter);
+
+            FilterRef unionFilter = makeSharedRef<NullFilter>();
+            if (std::none_of(filters.begin(), filters.end(), [](const FilterRef& filter) { return filter.ref().isNull(); }))
+                unionFilter = makeSharedRef<UnionFilter>(filters);
+
+            const DirectoryKey unionKey{folder.first, unionFilter, folder.second};
+            foldersToTraverse.insert(unionKey);
+            sharedKeys.emplace_back(unionKey, keys);
+        }
+
     //aggregate folder paths that are on the same root device:
     // => one worker thread *per device*: avoid excessive parallelism
     // => parallel folder traversal considers "parallel file operations" as specified by user
     // => (S)FTP: avoid hitting connection limits inadvertently
     std::map<AfsDevice, std::set<DirectoryKey>> perDeviceFolders;
 
-    for (const DirectoryKey& key : foldersToRead)
+    for (const DirectoryKey& key : foldersToTraverse)
         perDeviceFolders[key.folderPath.afsDevice].insert(key);
 
+    std::vector<std::vector<DirectoryKey>> threadFolders; //traversed by thread: threadIdx => keys
+
+    ScanStatsCollector statsCollector; //shared by all threads: manage life time: enclose InterruptibleThread's!!!
+    ScanStatsCollector* const statsCollectorOpt = scanStats ? &statsCollector : nullptr;
+
     //communication channel used by threads
     AsyncCallback acb(perDeviceFolders.size() /*threadsToFinish*/, cbInterval); //manage life time: enclose InterruptibleThread's!!!
 
@@ -437,32 +695,63 @@ std::map<DirectoryKey, DirectoryValue> fff::parallelDeviceTraversal(const std::s
         Zstring threadName = Zstr("Comp Device[") + numberTo<Zstring>(threadIdx + 1) + Zstr('/') + numberTo<Zstring>(perDeviceFolders.size()) + Zstr("] ") +
                              utfTo<Zstring>(AFS::getDisplayPath({afsDevice, AfsPath()}));
 
-        const size_t parallelOps = 1;
-        std::map<DirectoryKey, DirectoryValue*> workload;
+        const size_t parallelOps = getDeviceParallelOps(deviceParallelOps, afsDevice);
+        std::map<DirectoryKey, std::pair<DirectoryValue*, const IncrementalScan*>> workload;
+        threadFolders.emplace_back(dirKeys.begin(), dirKeys.end());
 
         for (const DirectoryKey& key : dirKeys)
-            workload.emplace(key, &output[key]); //=> DirectoryValue* unshared for lock-free worker-thread access
+        {
+            auto itInc = incrementalScans.find(key);
+            workload.emplace(key, std::pair(&output[key], //=> DirectoryValue* unshared for lock-free worker-thread access
+                                            itInc != incrementalScans.end() ? &itInc->second : nullptr));
+        }
 
-        worker.emplace_back([afsDevice /*clang bug*/= afsDevice, workload, threadIdx, &acb, parallelOps, threadName = std::move(threadName)]() mutable
+        worker.emplace_back([afsDevice /*clang bug*/= afsDevice, workload, threadIdx, &acb, namePool, statsCollectorOpt, parallelOps, threadName = std::move(threadName)]() mutable
         {
             setCurrentThreadName(threadName);
 
             acb.notifyWorkBegin(threadIdx, parallelOps);
             ZEN_ON_SCOPE_EXIT(acb.notifyWorkEnd(threadIdx));
 
-            std::chrono::steady_clock::time_point lastReportTime; //keep thread-local!
-
             AFS::TraverserWorkload travWorkload;
 
-            for (auto& [folderKey, folderVal] : workload)
+            for (auto& [folderKey, folderWork] : workload)
             {
                 assert(folderKey.folderPath.afsDevice == afsDevice);
-                travWorkload.emplace_back(folderKey.folderPath.afsPath, std::make_shared<BaseDirCallback>(folderKey, *folderVal, acb, threadIdx, lastReportTime));
+                auto& [folderVal, incScan] = folderWork;
+                travWorkload.emplace_back(folderKey.folderPath.afsPath, std::make_shared<BaseDirCallback>(folderKey, *folderVal, incScan, namePool, statsCollectorOpt, acb, threadIdx));
             }
             AFS::traverseFolderRecursive(afsDevice, travWorkload, parallelOps); //throw ThreadStopRequest
         });
     }
-    acb.waitUntilDone(cbInterval, onError, onStatusUpdate); //throw X
 
+    //a device is done => its folders are complete and may be processed while other devices are still being traversed
+    auto onThreadDone = [&](int threadIdx) //throw X
+    {
+        for (const DirectoryKey& travKey : threadFolders[threadIdx])
+            if (auto itShared = std::find_if(sharedKeys.begin(), sharedKeys.end(), [&](const auto& item) { return std::is_eq(item.first <=> travKey); });
+                itShared != sharedKeys.end())
+            {
+                const DirectoryValue& unionVal = output.find(travKey)->second;
+
+                for (const DirectoryKey& key : itShared->second)
+                {
+                    if (!std::is_eq(key <=> travKey)) //e.g. NullFilter
+                        copyFiltered(unionVal, output[key], key.filter.ref());
+                    if (onFolderDone)
+                        onFolderDone(key, output[key]); //throw X
+                }
+            }
+            else if (onFolderDone)
+                onFolderDone(travKey, output.find(travKey)->second); //throw X
+    };
+    acb.waitUntilDone(cbInterval, onError, onStatusUpdate, onThreadDone); //throw X
+
+    for (const auto& [unionKey, keys] : sharedKeys)
+        if (std::none_of(keys.begin(), keys.end(), [&](const DirectoryKey& key) { return std::is_eq(key <=> unionKey); }))
+            output.erase(unionKey);
+
+    if (scanStats)
+        *scanStats = statsCollector.get();
     return output;
 }
@@ -13,6 +13,8 @@
 #include "path_filter.h"
 #include "structures.h"
 #include "file_hierarchy.h"
+#include "db_file.h"
+#include "item_name_pool.h"
 #include "process_callback.h"
 
 
@@ -30,7 +32,9 @@ struct DirectoryKey
 
 struct DirectoryValue
 {
-    FolderContainer folderCont;
+    zen::MonotonicArena scanArena{[](int64_t bytesDelta) { addMemoryUsage(MemoryCategory::scanBuffer, bytesDelta); }}; //declare first: released after folderCont
+    FolderContainer folderCont{FolderContainer::FolderList::allocator_type(&scanArena)};
+    MemoryUsageTracker itemListMemory{MemoryCategory::scanBuffer}; //file and symlink lists: estimated when a folder is read
 
     //relative paths (or empty string for root) for directories that could not be read (completely), e.g. access denied, or temporary network drop
     std::unordered_map<Zstring, Zstringc /*error message*/> failedFolderReads;
@@ -40,14 +44,30 @@ struct DirectoryValue
 };
 
 
+//incremental traversal: only read folders affected by (externally reported) changes, take everything else from the last synchronous state
+struct IncrementalScan
+{
+    zen::SharedRef<const InSyncFolder> lastSyncState;
+    SelectSide side = SelectSide::left;
+    std::vector<Zstring> changedRelPaths; //relative to base folder; empty: only the base folder itself is read
+    std::vector<Zstring> modifiedRelPaths; //relative to base folder: changed content/attributes only => read item + parent folder, but not its sub folders
+};
+
+
 //Attention: 1. ensure directory filtering is applied later to exclude filtered folders which have been kept as parent folders
 //           2. remove folder aliases (e.g. case differences) *before* calling this function!!!
 
 using TravErrorCb  = std::function<PhaseCallback::Response(const PhaseCallback::ErrorInfo& errorInfo)>;
 using TravStatusCb = std::function<void (const std::wstring& statusLine, int itemsTotal)>;
+using TravFolderDoneCb = std::function<void(const DirectoryKey& folderKey, const DirectoryValue& folderVal)>; //called on main thread while other devices may still be traversed
 
 std::map<DirectoryKey, DirectoryValue> parallelDeviceTraversal(const std::set<DirectoryKey>& foldersToRead,
+                                                               const std::map<AfsDevice, size_t>& deviceParallelOps, //one thread per device, each running "parallelOps" traversals
+                                                               const std::map<DirectoryKey, IncrementalScan>& incrementalScans, //optional
+                                                               ItemNamePool* namePool, //optional: share item name storage
+                                                               FolderScanStats* scanStats, //optional: slowest/largest folders
                                                                const TravErrorCb& onError, const TravStatusCb& onStatusUpdate, //NOT optional
+                                                               const TravFolderDoneCb& onFolderDone, //optional: stream completed folders
                                                                std::chrono::milliseconds cbInterval);
 }
 
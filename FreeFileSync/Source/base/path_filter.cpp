@@ -99,116 +99,205 @@ void NameFilter::parseFilterPhrase(const Zstring& filterPhrase, FilterSet& filte
 }
 
 
-void NameFilter::MaskMatcher::insert(const Zstring& mask)
+void NameFilter::WildcardAutomaton::addMask(const Zstring& mask)
 {
-    assert(mask == getUpperCase(mask));
-    if (contains(mask, Zstr('?')) ||
-        contains(mask, Zstr('*')))
-        realMasks_.insert(mask);
-    else
+    static_assert(sizeof(Zchar) == 1); //charStates_ indexed by byte
+
+    /* states of mask "A*B?": 0: (start)  1: A  2: *  3: B  4: ? => accept
+       consecutive '*' are equivalent to a single one                          */
+    std::vector<Zchar> tokens;
+    for (const Zchar c : mask)
+        if (c != Zstr('*') || tokens.empty() || tokens.back() != Zstr('*'))
+            tokens.push_back(c);
+
+    const size_t stateFirst = stateCount_;
+    stateCount_ += tokens.size() + 1;
+
+    const size_t wordCount = (stateCount_ + 63) / 64;
+    for (std::vector<uint64_t>* bits : {&startStates_, &starStates_, &acceptStates_, &sepMoreStates_})
+        bits->resize(wordCount);
+    charStates_.resize(256);
+    for (std::vector<uint64_t>& bits : charStates_)
+        bits.resize(wordCount);
+
+    setBit(startStates_, stateFirst);
+    setBit(acceptStates_, stateCount_ - 1);
+
+    for (size_t i = 0; i < tokens.size(); ++i)
     {
-        relPaths_   .insert(mask);
-        relPathsCmp_.insert(mask); //little memory wasted thanks to COW string!
+        const size_t state = stateFirst + 1 + i;
+        switch (const Zchar t = tokens[i])
+        {
+            case Zstr('*'):
+                setBit(starStates_, state);
+                break;
+
+            case Zstr('?'): //should not match FILE_NAME_SEPARATOR
+                for (size_t c = 0; c < charStates_.size(); ++c)
+                    if (static_cast<Zchar>(c) != FILE_NAME_SEPARATOR)
+                        setBit(charStates_[c], state);
+                break;
+
+            default:
+                setBit(charStates_[static_cast<unsigned char>(t)], state);
+                if (t == FILE_NAME_SEPARATOR && i + 1 < tokens.size())
+                    setBit(sepMoreStates_, state);
+                break;
+        }
     }
 }
 
 
 namespace
 {
-//"true" if path or any parent path matches the mask
-bool matchesMask(const Zchar* path, const Zchar* const pathEnd, const Zchar* mask /*0-terminated*/)
+//keep the active states of WildcardAutomaton on the stack for the common case
+class NfaStates
 {
-    for (;; ++mask, ++path)
+public:
+    explicit NfaStates(size_t wordCount) : wordCount_(wordCount)
     {
-        Zchar m = *mask;
-        switch (m)
+        if (wordCount > STACK_WORDS_MAX)
         {
-            case 0:
-                return path == pathEnd || *path == FILE_NAME_SEPARATOR; //"full" or parent path match
+            heapBuf_.resize(wordCount);
+            states_ = heapBuf_.data();
+        }
+    }
 
-            case Zstr('?'): //should not match FILE_NAME_SEPARATOR
-                if (path == pathEnd || *path == FILE_NAME_SEPARATOR)
-                    return false;
-                break;
+    //add states reachable without consuming a char
+    void init(const uint64_t* startStates, const uint64_t* starStates)
+    {
+        uint64_t carry = 0;
+        for (size_t w = 0; w < wordCount_; ++w)
+        {
+            states_[w] = startStates[w] | (((startStates[w] << 1) | carry) & starStates[w]);
+            carry = startStates[w] >> 63;
+        }
+    }
 
-            case Zstr('*'):
-                do //advance mask to next non-* char
-                {
-                    m = *++mask;
-                }
-                while (m == Zstr('*'));
-
-                if (m == 0) //mask ends with '*':
-                    return true;
-
-                ++mask;
-                if (m == Zstr('?')) //*? pattern
-                {
-                    while (path != pathEnd)
-                        if (*path++ != FILE_NAME_SEPARATOR)
-                            if (matchesMask(path, pathEnd, mask))
-                                return true;
-                }
-                else //*[letter or /] pattern
-                    while (path != pathEnd)
-                        if (*path++ == m)
-                            if (matchesMask(path, pathEnd, mask))
-                                return true;
-                return false;
+    //returns false if no state is active anymore
+    bool consume(const uint64_t* charStates, const uint64_t* starStates)
+    {
+        uint64_t carryOld = 0;
+        uint64_t carryNew = 0;
+        uint64_t active = 0;
+        for (size_t w = 0; w < wordCount_; ++w)
+        {
+            const uint64_t old = states_[w];
+            uint64_t next = (((old << 1) | carryOld) & charStates[w]) | (old & starStates[w]); //consume char
+            carryOld = old >> 63;
 
-            default:
-                if (path == pathEnd || *path != m)
-                    return false;
+            next |= ((next << 1) | carryNew) & starStates[w]; //enter '*' states: no consecutive '*' => single step is sufficient
+            carryNew = next >> 63;
+
+            states_[w] = next;
+            active |= next;
         }
+        return active != 0;
     }
-}
-
 
-//"true" if path matches (only!) the beginning of mask
-template <bool haveWildcards> bool matchesMaskBegin(const Zstring& relPath, const Zstring& mask);
+    bool intersects(const uint64_t* states) const
+    {
+        for (size_t w = 0; w < wordCount_; ++w)
+            if (states_[w] & states[w])
+                return true;
+        return false;
+    }
 
-template <> inline
-bool matchesMaskBegin<true /*haveWildcards*/>(const Zstring& relPath, const Zstring& mask)
-{
-    auto itP = relPath.begin();
-    for (auto itM = mask.begin(); itM != mask.end(); ++itM, ++itP)
+    bool intersectsAfterConsume(const uint64_t* charStates, const uint64_t* states) const
     {
-        const Zchar m = *itM;
-        switch (m)
+        uint64_t carry = 0;
+        for (size_t w = 0; w < wordCount_; ++w)
         {
-            case Zstr('?'):
-                if (itP == relPath.end() || *itP == FILE_NAME_SEPARATOR)
-                    return false;
-                break;
-
-            case Zstr('*'):
+            if ((((states_[w] << 1) | carry) & charStates[w] & states[w]) != 0)
                 return true;
+            carry = states_[w] >> 63;
+        }
+        return false;
+    }
 
-            default:
-                if (itP == relPath.end())
-                    return m == FILE_NAME_SEPARATOR && mask.end() - itM > 1; //require strict sub match
+private:
+    NfaStates           (const NfaStates&) = delete;
+    NfaStates& operator=(const NfaStates&) = delete;
 
-                if (*itP != m)
-                    return false;
-        }
+    static constexpr size_t STACK_WORDS_MAX = 128; //8192 mask states
+
+    const size_t wordCount_;
+    uint64_t stackBuf_[STACK_WORDS_MAX];
+    std::vector<uint64_t> heapBuf_;
+    uint64_t* states_ = stackBuf_;
+};
+}
+
+
+bool NameFilter::WildcardAutomaton::matches(const Zchar* pathFirst, const Zchar* pathLast) const
+{
+    if (stateCount_ == 0)
+        return false;
+
+    NfaStates states(startStates_.size());
+    states.init(startStates_.data(), starStates_.data());
+
+    for (const Zchar* it = pathFirst; it != pathLast; ++it)
+    {
+        if (*it == FILE_NAME_SEPARATOR && states.intersects(acceptStates_.data())) //parent path match
+            return true;
+
+        if (!states.consume(charStates_[static_cast<unsigned char>(*it)].data(), starStates_.data()))
+            return false;
     }
-    return false; //not a strict sub match
+    return states.intersects(acceptStates_.data()); //"full" path match
 }
 
-template <> inline //perf: going overboard? remaining fruits are hanging higher and higher...
-bool matchesMaskBegin<false /*haveWildcards*/>(const Zstring& relPath, const Zstring& mask)
+
+bool NameFilter::WildcardAutomaton::matchesBegin(const Zchar* pathFirst, const Zchar* pathLast) const
 {
-    return mask.size() > relPath.size() + 1 && //room for FILE_NAME_SEPARATOR *and* at least one more char
-           mask[relPath.size()] == FILE_NAME_SEPARATOR &&
-           startsWith(mask, relPath);
+    if (stateCount_ == 0)
+        return false;
+
+    NfaStates states(startStates_.size());
+    states.init(startStates_.data(), starStates_.data());
+
+    for (const Zchar* it = pathFirst; it != pathLast; ++it)
+    {
+        if (states.intersects(starStates_.data())) //'*' might match anything that follows
+            return true;
+
+        if (!states.consume(charStates_[static_cast<unsigned char>(*it)].data(), starStates_.data()))
+            return false;
+    }
+    if (states.intersects(starStates_.data()))
+        return true;
+
+    //require strict sub match: at least one more char after separator
+    return states.intersectsAfterConsume(charStates_[static_cast<unsigned char>(FILE_NAME_SEPARATOR)].data(), sepMoreStates_.data());
 }
+
+
+void NameFilter::MaskMatcher::insert(const Zstring& mask)
+{
+    assert(mask == getUpperCase(mask));
+    if (contains(mask, Zstr('?')) ||
+        contains(mask, Zstr('*')))
+    {
+        if (realMasks_.insert(mask).second)
+            realMasksAutomaton_.addMask(mask);
+    }
+    else if (relPaths_.insert(mask).second)
+    {
+        relPathsCmp_.insert(mask); //little memory wasted thanks to COW string!
+
+        //path matches (only!) the beginning of mask <=> path is a parent of mask
+        for (auto it = mask.begin(); (it = std::find(it, mask.end(), FILE_NAME_SEPARATOR)) != mask.end(); ++it)
+            if (mask.end() - it > 1) //room for FILE_NAME_SEPARATOR *and* at least one more char
+                relPathParents_.emplace(mask.begin(), it);
+    }
 }
 
 
 bool NameFilter::MaskMatcher::matches(const Zchar* pathFirst, const Zchar* pathLast) const
 {
-    if (std::any_of(realMasks_.begin(), realMasks_.end(), [&](const Zstring& mask) { return matchesMask(pathFirst, pathLast, mask.c_str()); }))
-    /**/return true;
+    if (realMasksAutomaton_.matches(pathFirst, pathLast))
+        return true;
 
     //perf: for relPaths_ we can go from linear to *constant* time!!! => annihilates https://freefilesync.org/forum/viewtopic.php?t=7768#p26519
     const Zchar* sepPos = pathFirst;
@@ -228,8 +317,9 @@ bool NameFilter::MaskMatcher::matches(const Zchar* pathFirst, const Zchar* pathL
 
 bool NameFilter::MaskMatcher::matchesBegin(const Zstring& relPath) const
 {
-    return std::any_of(realMasks_.begin(), realMasks_.end(), [&](const Zstring& mask) { return matchesMaskBegin<true  /*haveWildcards*/>(relPath, mask); }) ||
-    /**/   std::any_of(relPaths_ .begin(), relPaths_ .end(), [&](const Zstring& mask) { return matchesMaskBegin<false /*haveWildcards*/>(relPath, mask); });
+    //perf: O(path length) instead of linear in number of masks: decide early if folder traversal can be skipped for narrow include filters
+    return relPathParents_.contains(relPath) ||
+           realMasksAutomaton_.matchesBegin(relPath.begin(), relPath.end());
 }
 
 //#################################################################################################
@@ -252,8 +342,28 @@ bool NameFilter::passFileFilter(const Zstring& relFilePath) const
     assert(!startsWith(relFilePath, FILE_NAME_SEPARATOR));
 
     //normalize input: 1. ignore Unicode normalization form 2. ignore case
-    const Zstring& pathFmt = getUpperCase(relFilePath);
+    return passFileFilterUpperCase(getUpperCase(relFilePath));
+}
+
 
+bool NameFilter::passChildFileFilter(const Zstring& parentRelPathPf, const Zstring& itemName) const
+{
+    assert(parentRelPathPf.empty() || endsWith(parentRelPathPf, FILE_NAME_SEPARATOR));
+
+    //ASCII (most file names): concatenate and upper-case in a single buffer => one allocation instead of two
+    if (isAsciiString(parentRelPathPf) && isAsciiString(itemName))
+    {
+        Zstring pathFmt = parentRelPathPf + itemName;
+        for (size_t i = 0; i < pathFmt.size(); ++i) //fresh, unshared buffer: no copy-on-write
+            pathFmt[i] = asciiToUpper(pathFmt[i]);
+        return passFileFilterUpperCase(pathFmt);
+    }
+    return passFileFilter(parentRelPathPf + itemName);
+}
+
+
+bool NameFilter::passFileFilterUpperCase(const Zstring& pathFmt) const
+{
     const Zchar* sepPos = findLast(pathFmt.begin(), pathFmt.end(), FILE_NAME_SEPARATOR);
 
     if (excludeFilter.fileFolderMasks.matches(pathFmt.begin(), pathFmt.end()) || //either match on file or any parent folder
@@ -7,6 +7,8 @@
 #ifndef HARD_FILTER_H_825780275842758345
 #define HARD_FILTER_H_825780275842758345
 
+#include <set>
+#include <algorithm>
 #include <vector>
 #include <memory>
 #include <unordered_set>
@@ -21,9 +23,9 @@ namespace fff
 
                   PathFilter (interface)
                       /|\
-           ____________|_____________
-          |            |             |
-    NullFilter    NameFilter  CombinedFilter                         */
+           ____________|_____________________________
+          |            |             |               |
+    NullFilter    NameFilter  CombinedFilter    UnionFilter          */
 
 class PathFilter;
 using FilterRef = zen::SharedRef<const PathFilter>;
@@ -42,6 +44,10 @@ public:
     //childItemMightMatch: file/dir in subdirectories could(!) match
     //note: this hint is only set if passDirFilter returns false!
 
+    //same as passFileFilter(parentRelPathPf + itemName): folder traversal doesn't need the concatenated path unless the filter does
+    virtual bool passChildFileFilter(const Zstring& parentRelPathPf /*postfixed with FILE_NAME_SEPARATOR or empty*/, const Zstring& itemName) const
+    { return passFileFilter(parentRelPathPf + itemName); }
+
     virtual bool isNull() const = 0; //filter is equivalent to NullFilter
 
     virtual FilterRef copyFilterAddingExclusion(const Zstring& excludePhrase) const = 0;
@@ -62,6 +68,7 @@ class NullFilter : public PathFilter //no filtering at all
 public:
     bool passFileFilter(const Zstring& relFilePath) const override { return true; }
     bool passDirFilter(const Zstring& relDirPath, bool* childItemMightMatch) const override;
+    bool passChildFileFilter(const Zstring& parentRelPathPf, const Zstring& itemName) const override { return true; }
     bool isNull() const override { return true; }
     FilterRef copyFilterAddingExclusion(const Zstring& excludePhrase) const override;
 
@@ -79,6 +86,7 @@ public:
 
     bool passFileFilter(const Zstring& relFilePath) const override;
     bool passDirFilter(const Zstring& relDirPath, bool* childItemMightMatch) const override;
+    bool passChildFileFilter(const Zstring& parentRelPathPf, const Zstring& itemName) const override;
 
     bool isNull() const override;
     static bool isNull(const Zstring& includePhrase, const Zstring& excludePhrase); //*fast* check without expensive NameFilter construction!
@@ -88,6 +96,28 @@ private:
     friend class CombinedFilter;
     std::strong_ordering compareSameType(const PathFilter& other) const override;
 
+    /* all wildcard masks compiled into a single bit-parallel NFA ("Shift-And"):
+        - one bit per mask state; all masks are simulated simultaneously
+        - per path character: a few AND/OR/SHIFT operations per 64 mask states => no backtracking, no per-mask loop  */
+    class WildcardAutomaton
+    {
+    public:
+        void addMask(const Zstring& mask); //containing ? or *
+
+        bool matches     (const Zchar* pathFirst, const Zchar* pathLast) const; //"true" if path or any parent path matches a mask
+        bool matchesBegin(const Zchar* pathFirst, const Zchar* pathLast) const; //"true" if path matches (only!) the beginning of a mask
+
+    private:
+        static void setBit(std::vector<uint64_t>& bits, size_t pos) { bits[pos / 64] |= uint64_t(1) << (pos % 64); }
+
+        size_t stateCount_ = 0;
+        std::vector<uint64_t> startStates_;   //first state of each mask (before consuming any char)
+        std::vector<uint64_t> starStates_;    //'*': self-loop on any char, entered without consuming a char
+        std::vector<uint64_t> acceptStates_;  //last state of each mask
+        std::vector<uint64_t> sepMoreStates_; //entered by consuming separator, followed by at least one more mask char => matchesBegin()
+        std::vector<std::vector<uint64_t>> charStates_; //[256]: states entered by consuming char c
+    };
+
     class MaskMatcher
     {
     public:
@@ -109,7 +139,9 @@ private:
 
     private:
         std::set<Zstring> realMasks_; //always containing ? or *       (use std::set<> to scrap duplicates!)
+        WildcardAutomaton realMasksAutomaton_;
         std::unordered_set<Zstring, zen::StringHash, zen::StringEqual> relPaths_; //never containing ? or *
+        std::unordered_set<Zstring, zen::StringHash, zen::StringEqual> relPathParents_; //all (strict) parent paths of relPaths_ => matchesBegin() in constant time
         std::set<Zstring>                                              relPathsCmp_; //req. for operator<=> only :(
     };
 
@@ -123,6 +155,8 @@ private:
 
     static void parseFilterPhrase(const Zstring& filterPhrase, FilterSet& filter);
 
+    bool passFileFilterUpperCase(const Zstring& pathFmt) const;
+
     FilterSet includeFilter;
     FilterSet excludeFilter;
 };
@@ -135,6 +169,7 @@ public:
 
     bool passFileFilter(const Zstring& relFilePath) const override;
     bool passDirFilter(const Zstring& relDirPath, bool* childItemMightMatch) const override;
+    bool passChildFileFilter(const Zstring& parentRelPathPf, const Zstring& itemName) const override;
     bool isNull() const override;
     FilterRef copyFilterAddingExclusion(const Zstring& excludePhrase) const override;
 
@@ -146,6 +181,24 @@ private:
 };
 
 
+class UnionFilter : public PathFilter //match if *any* filter matches: traverse a folder once for multiple filters, then apply each filter separately
+{
+public:
+    explicit UnionFilter(const std::vector<FilterRef>& filters) : filters_(filters) { assert(filters.size() > 1); }
+
+    bool passFileFilter(const Zstring& relFilePath) const override;
+    bool passDirFilter(const Zstring& relDirPath, bool* childItemMightMatch) const override;
+    bool passChildFileFilter(const Zstring& parentRelPathPf, const Zstring& itemName) const override;
+    bool isNull() const override;
+    FilterRef copyFilterAddingExclusion(const Zstring& excludePhrase) const override;
+
+private:
+    std::strong_ordering compareSameType(const PathFilter& other) const override;
+
+    const std::vector<FilterRef> filters_;
+};
+
+
 
 
 
@@ -186,6 +239,14 @@ bool CombinedFilter::passFileFilter(const Zstring& relFilePath) const
 }
 
 
+inline
+bool CombinedFilter::passChildFileFilter(const Zstring& parentRelPathPf, const Zstring& itemName) const
+{
+    return first_ .passChildFileFilter(parentRelPathPf, itemName) && //short-circuit behavior
+           second_.passChildFileFilter(parentRelPathPf, itemName);
+}
+
+
 inline
 bool CombinedFilter::passDirFilter(const Zstring& relDirPath, bool* childItemMightMatch) const
 {
@@ -233,6 +294,72 @@ std::strong_ordering CombinedFilter::compareSameType(const PathFilter& other) co
 }
 
 
+inline
+bool UnionFilter::passFileFilter(const Zstring& relFilePath) const
+{
+    return std::any_of(filters_.begin(), filters_.end(), [&](const FilterRef& filter) { return filter.ref().passFileFilter(relFilePath); });
+}
+
+
+inline
+bool UnionFilter::passChildFileFilter(const Zstring& parentRelPathPf, const Zstring& itemName) const
+{
+    return std::any_of(filters_.begin(), filters_.end(), [&](const FilterRef& filter) { return filter.ref().passChildFileFilter(parentRelPathPf, itemName); });
+}
+
+
+inline
+bool UnionFilter::passDirFilter(const Zstring& relDirPath, bool* childItemMightMatch) const
+{
+    assert(!childItemMightMatch || *childItemMightMatch); //check correct usage
+    bool childMightMatch = false;
+
+    for (const FilterRef& filter : filters_)
+    {
+        bool childMightMatchTmp = true;
+        if (filter.ref().passDirFilter(relDirPath, &childMightMatchTmp))
+            return true;
+        childMightMatch = childMightMatch || childMightMatchTmp;
+    }
+
+    if (childItemMightMatch)
+        *childItemMightMatch = childMightMatch;
+    return false;
+}
+
+
+inline
+bool UnionFilter::isNull() const
+{
+    return std::any_of(filters_.begin(), filters_.end(), [](const FilterRef& filter) { return filter.ref().isNull(); });
+}
+
+
+inline
+FilterRef UnionFilter::copyFilterAddingExclusion(const Zstring& excludePhrase) const
+{
+    std::vector<FilterRef> filters;
+    for (const FilterRef& filter : filters_)
+        filters.push_back(filter.ref().copyFilterAddingExclusion(excludePhrase));
+
+    return zen::makeSharedRef<UnionFilter>(filters);
+}
+
+
+inline
+std::strong_ordering UnionFilter::compareSameType(const PathFilter& other) const
+{
+    assert(typeid(*this) == typeid(other)); //always given in this context!
+
+    const UnionFilter& lhs = *this;
+    const UnionFilter& rhs = static_cast<const UnionFilter&>(other);
+
+    return std::lexicographical_compare_three_way(lhs.filters_.begin(), lhs.filters_.end(),
+                                                  rhs.filters_.begin(), rhs.filters_.end(),
+    [](const FilterRef& lhs2, const FilterRef& rhs2) { return lhs2 <=> rhs2; });
+}
+
+
 inline
 FilterRef constructFilter(const Zstring& includePhrase,
                           const Zstring& excludePhrase,
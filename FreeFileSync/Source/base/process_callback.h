@@ -8,12 +8,27 @@
 #define PROCESS_CALLBACK_H_48257827842345454545
 
 #include <string>
+#include <vector>
 #include <cstdint>
 #include <chrono>
 
 
 namespace fff
 {
+//scan-time statistics: see parallelDeviceTraversal()
+struct FolderScanStats
+{
+    struct Folder
+    {
+        std::wstring displayPath;
+        std::chrono::milliseconds readTime{}; //excluding sub folders
+        size_t itemCount = 0;                 //
+    };
+    std::vector<Folder> slowest; //sorted descending
+    std::vector<Folder> largest; //
+};
+
+
 struct PhaseCallback
 {
     virtual ~PhaseCallback() {}
@@ -58,6 +73,12 @@ struct PhaseCallback
     };
     virtual Response reportError(const ErrorInfo& errorInfo) = 0; //throw X; recoverable error
     virtual void reportFatalError(const std::wstring& msg)   = 0; //throw X; non-recoverable error
+
+    //optional: metrics output
+    virtual void reportScanStats(const FolderScanStats& stats) {}
+
+    //optional: throughput expected from previous runs => remaining time before the first speed samples
+    virtual void reportExpectedSpeed(double bytesPerSec) {}
 };
 
 
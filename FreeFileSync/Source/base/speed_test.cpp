@@ -44,6 +44,9 @@ std::optional<double> SpeedTest::getRemainingSec(int /*itemsRemaining*/, int64_t
         if (bytesDelta != 0) //sign(dataRemaining) != sign(bytesDelta) usually an error, so show it!
             return bytesRemaining * timeDelta / bytesDelta;
     }
+    if (fallbackBytesPerSec_ && *fallbackBytesPerSec_ > 0)
+        return bytesRemaining / *fallbackBytesPerSec_;
+
     return std::nullopt;
 }
 
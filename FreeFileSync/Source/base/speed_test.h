@@ -29,6 +29,9 @@ public:
     std::wstring getBytesPerSecFmt() const; //empty if not (yet) available
     std::wstring getItemsPerSecFmt() const; //
 
+    //remaining time until enough samples are available: e.g. throughput of previous runs
+    void setFallbackBytesPerSec(std::optional<double> bytesPerSec) { fallbackBytesPerSec_ = bytesPerSec; }
+
     void clear() { samples_.clear(); }
 
 private:
@@ -41,6 +44,7 @@ private:
 
     const std::chrono::milliseconds windowSize_;
     zen::RingBuffer<Sample> samples_;
+    std::optional<double> fallbackBytesPerSec_;
 };
 }
 
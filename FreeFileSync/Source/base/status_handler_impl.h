@@ -7,11 +7,15 @@
 #ifndef STATUS_HANDLER_IMPL_H_07682758976
 #define STATUS_HANDLER_IMPL_H_07682758976
 
+#include <array>
+#include <atomic>
 #include <zen/basic_math.h>
 #include <zen/file_error.h>
+#include <zen/scope_guard.h>
 #include <zen/thread.h>
 #include "process_callback.h"
 #include "speed_test.h"
+#include "structures.h"
 
 
 namespace fff
@@ -20,17 +24,35 @@ class AsyncCallback //actor pattern
 {
 public:
     AsyncCallback() {}
+    explicit AsyncCallback(size_t workloadCount) : workloadsActive_(workloadCount) { assert(workloadCount > 0); } //e.g. folder pairs synced concurrently
 
-    //non-blocking: context of worker thread (and main thread, see reportStats())
+    //non-blocking: context of worker thread
     void updateDataProcessed(int itemsDelta, int64_t bytesDelta) //noexcept!
     {
-        itemsDeltaProcessed_ += itemsDelta;
-        bytesDeltaProcessed_ += bytesDelta;
+        StatShard& shard = getStatShard();
+        //relaxed: no other data is published through these counters; main thread only needs eventual consistency
+        shard.itemsDeltaProcessed.fetch_add(itemsDelta, std::memory_order_relaxed);
+        shard.bytesDeltaProcessed.fetch_add(bytesDelta, std::memory_order_relaxed);
+        shard.itemsProcessedSum  .fetch_add(itemsDelta, std::memory_order_relaxed);
+        shard.bytesProcessedSum  .fetch_add(bytesDelta, std::memory_order_relaxed);
     }
     void updateDataTotal(int itemsDelta, int64_t bytesDelta) //noexcept!
     {
-        itemsDeltaTotal_ += itemsDelta;
-        bytesDeltaTotal_ += bytesDelta;
+        StatShard& shard = getStatShard();
+        shard.itemsDeltaTotal.fetch_add(itemsDelta, std::memory_order_relaxed);
+        shard.bytesDeltaTotal.fetch_add(bytesDelta, std::memory_order_relaxed);
+    }
+
+    //cumulative, e.g. for throughput measurement: context of any thread
+    std::pair<int64_t, int64_t> getDataProcessedSum() const
+    {
+        std::pair<int64_t, int64_t> sum;
+        for (const StatShard& shard : statShards_)
+        {
+            sum.first  += shard.itemsProcessedSum.load(std::memory_order_relaxed);
+            sum.second += shard.bytesProcessedSum.load(std::memory_order_relaxed);
+        }
+        return sum;
     }
 
     //context of worker thread
@@ -40,25 +62,46 @@ public:
         {
             std::lock_guard dummy(lockCurrentStatus_);
             if (ThreadStatus* ts = getThreadStatus()) //call while holding "lockCurrentStatus_" lock!!
+            {
                 ts->statusMsg = std::move(msg);
+                ts->pathCount = 0;
+            }
             else assert(false);
         }
         zen::interruptionPoint(); //throw ThreadStopRequest
     }
 
-    //blocking call: context of worker thread
-    //=> indirect support for "pause": logInfo() is called under singleThread lock,
-    //   so all other worker threads will wait when coming out of parallel I/O (trying to lock singleThread)
+    //same as updateStatus(replaceCpy(msgTemplate, L"%x", fmtPath(displayPath))), but formatted lazily:
+    //status is sampled by the main thread every UI_UPDATE_INTERVAL only => don't waste time formatting per item (e.g. deleting thousands of small files)
+    void updateStatus(const std::wstring& msgTemplate, const std::wstring& displayPath) //throw ThreadStopRequest
+    {
+        updateStatusLazy(msgTemplate, 1, displayPath, std::wstring()); //throw ThreadStopRequest
+    }
+
+    //"%x" and "%y" are replaced by L'\n' + fmtPath(...)
+    void updateStatus(const std::wstring& msgTemplate, const std::wstring& displayPathX, const std::wstring& displayPathY) //throw ThreadStopRequest
+    {
+        updateStatusLazy(msgTemplate, 2, displayPathX, displayPathY); //throw ThreadStopRequest
+    }
+
+    //context of worker thread: queued + formatted lazily by the main thread => no waiting for the main thread per log message
+    //=> indirect support for "pause": queue is bounded, so worker threads wait as soon as the paused main thread stops taking records;
+    //   logInfo() is called under singleThread lock, so all other worker threads will wait when coming out of parallel I/O (trying to lock singleThread)
     void logInfo(const std::wstring& msg) //throw ThreadStopRequest
     {
-        assert(!zen::runningOnMainThread());
-        std::unique_lock dummy(lockRequest_);
-        zen::interruptibleWait(conditionReadyForNewRequest_, dummy, [this] { return !logInfoRequest_; }); //throw ThreadStopRequest
+        queueLogInfo(msg, 0, std::wstring(), std::wstring()); //throw ThreadStopRequest
+    }
 
-        logInfoRequest_ = /*std::move(taskPrefix) + */ msg;
+    //same as logInfo(replaceCpy(msgTemplate, L"%x", fmtPath(displayPath)))
+    void logInfo(const std::wstring& msgTemplate, const std::wstring& displayPath) //throw ThreadStopRequest
+    {
+        queueLogInfo(msgTemplate, 1, displayPath, std::wstring()); //throw ThreadStopRequest
+    }
 
-        dummy.unlock(); //optimization for condition_variable::notify_all()
-        conditionNewRequest.notify_all();
+    //"%x" and "%y" are replaced by L'\n' + fmtPath(...)
+    void logInfo(const std::wstring& msgTemplate, const std::wstring& displayPathX, const std::wstring& displayPathY) //throw ThreadStopRequest
+    {
+        queueLogInfo(msgTemplate, 2, displayPathX, displayPathY); //throw ThreadStopRequest
     }
 
     void reportInfo(std::wstring&& msg) //throw ThreadStopRequest
@@ -67,6 +110,18 @@ public:
         updateStatus(std::move(msg)); //
     }
 
+    void reportInfo(const std::wstring& msgTemplate, const std::wstring& displayPath) //throw ThreadStopRequest
+    {
+        logInfo     (msgTemplate, displayPath); //throw ThreadStopRequest
+        updateStatus(msgTemplate, displayPath); //
+    }
+
+    void reportInfo(const std::wstring& msgTemplate, const std::wstring& displayPathX, const std::wstring& displayPathY) //throw ThreadStopRequest
+    {
+        logInfo     (msgTemplate, displayPathX, displayPathY); //throw ThreadStopRequest
+        updateStatus(msgTemplate, displayPathX, displayPathY); //
+    }
+
     //blocking call: context of worker thread
     PhaseCallback::Response reportError(const PhaseCallback::ErrorInfo& errorInfo) //throw ThreadStopRequest
     {
@@ -99,22 +154,37 @@ public:
 
             for (std::unique_lock dummy(lockRequest_);;) //process all errors without delay
             {
-                const bool rv = conditionNewRequest.wait_until(dummy, callbackTime, [this] { return (errorRequest_ && !errorResponse_) || logInfoRequest_ || finishNowRequest_; });
+                //format and log outside of mutex scope: don't block worker threads queueing the next records
+                auto flushLogQueue = [&] //throw X
+                {
+                    if (!logQueue_.empty())
+                    {
+                        logQueue_.swap(logQueueFlush_);
+                        conditionReadyForNewRequest_.notify_all(); //=> spurious wake-up for AsyncCallback::reportError()
+
+                        dummy.unlock();
+                        ZEN_ON_SCOPE_EXIT(logQueueFlush_.clear(); dummy.lock());
+
+                        for (const LogRecord& rec : logQueueFlush_)
+                            cb.logInfo(formatLazy(rec.msgTemplate, rec.pathCount, rec.pathX, rec.pathY)); //throw X
+                    }
+                };
+
+                const bool rv = conditionNewRequest.wait_until(dummy, callbackTime, [this] { return (errorRequest_ && !errorResponse_) || logQueue_.size() >= LOG_QUEUE_CAPACITY || finishNowRequest_; });
                 if (!rv) //time-out + condition not met
+                {
+                    flushLogQueue(); //throw X
                     break;
+                }
 
                 if (errorRequest_ && !errorResponse_)
                 {
                     assert(!finishNowRequest_);
+                    flushLogQueue(); //throw X; keep log order: info messages queued before the error
                     errorResponse_ = cb.reportError(*errorRequest_); //throw X
                     conditionHaveResponse_.notify_all(); //instead of notify_one(); work around bug: https://svn.boost.org/trac/boost/ticket/7796
                 }
-                if (logInfoRequest_)
-                {
-                    cb.logInfo(*logInfoRequest_); //throw X
-                    logInfoRequest_ = {};
-                    conditionReadyForNewRequest_.notify_all(); //=> spurious wake-up for AsyncCallback::reportError()
-                }
+                flushLogQueue(); //throw X
                 if (finishNowRequest_)
                 {
                     dummy.unlock(); //call member functions outside of mutex scope:
@@ -152,7 +222,7 @@ public:
         if (statusByPriority_.size() < prio + 1)
             statusByPriority_.resize(prio + 1);
 
-        statusByPriority_[prio].push_back({threadId, /*taskIdx,*/ std::wstring()});
+        statusByPriority_[prio].push_back({threadId, /*taskIdx,*/});
     }
 
     void notifyTaskEnd() //noexcept
@@ -176,9 +246,12 @@ public:
     void notifyAllDone() //noexcept
     {
         std::lock_guard dummy(lockRequest_);
-        assert(!finishNowRequest_);
-        finishNowRequest_ = true;
-        conditionNewRequest.notify_all(); //perf: should unlock mutex before notify!? (insignificant)
+        assert(!finishNowRequest_ && workloadsActive_ > 0);
+        if (--workloadsActive_ == 0) //wait for *all* workloads
+        {
+            finishNowRequest_ = true;
+            conditionNewRequest.notify_all(); //perf: should unlock mutex before notify!? (insignificant)
+        }
     }
 
 private:
@@ -189,8 +262,76 @@ private:
     {
         std::thread::id threadId;
         //size_t   taskIdx = 0; //nice human-readable task id for GUI
-        std::wstring statusMsg;
+        std::wstring statusMsg; //formatted text if pathCount == 0, template otherwise
+        std::wstring pathX;
+        std::wstring pathY;
+        int pathCount = 0;
+    };
+
+    void updateStatusLazy(const std::wstring& msgTemplate, int pathCount, const std::wstring& pathX, const std::wstring& pathY) //throw ThreadStopRequest
+    {
+        assert(!zen::runningOnMainThread());
+        {
+            std::lock_guard dummy(lockCurrentStatus_);
+            if (ThreadStatus* ts = getThreadStatus()) //call while holding "lockCurrentStatus_" lock!!
+            {
+                ts->statusMsg = msgTemplate; //perf: copy assignment reuses existing capacity => usually no allocation
+                ts->pathX     = pathX;       //
+                ts->pathY     = pathY;       //
+                ts->pathCount = pathCount;
+            }
+            else assert(false);
+        }
+        zen::interruptionPoint(); //throw ThreadStopRequest
+    }
+
+    static std::wstring formatLazy(const std::wstring& msgTemplate, int pathCount, const std::wstring& pathX, const std::wstring& pathY)
+    {
+        switch (pathCount)
+        {
+            case 1:
+                return zen::formatMessage(msgTemplate, {{L"%x", zen::fmtPath(pathX)}});
+            case 2:
+                return zen::formatMessage(msgTemplate, {{L"%x", L'\n' + zen::fmtPath(pathX)}, {L"%y", L'\n' + zen::fmtPath(pathY)}});
+        }
+        return msgTemplate;
+    }
+
+    static std::wstring formatStatus(const ThreadStatus& ts) { return formatLazy(ts.statusMsg, ts.pathCount, ts.pathX, ts.pathY); }
+
+    void queueLogInfo(const std::wstring& msgTemplate, int pathCount, const std::wstring& pathX, const std::wstring& pathY) //throw ThreadStopRequest
+    {
+        assert(!zen::runningOnMainThread());
+        std::unique_lock dummy(lockRequest_);
+        zen::interruptibleWait(conditionReadyForNewRequest_, dummy, [this] { return logQueue_.size() < LOG_QUEUE_CAPACITY; }); //throw ThreadStopRequest
+
+        logQueue_.push_back({msgTemplate, pathX, pathY, pathCount});
+
+        if (logQueue_.size() >= LOG_QUEUE_CAPACITY) //else: main thread takes records with next status update
+        {
+            dummy.unlock(); //optimization for condition_variable::notify_all()
+            conditionNewRequest.notify_all();
+        }
+    }
+
+    //main thread only aggregates => avoid cache-line ping-pong between workers updating the same counters
+    struct alignas(64) StatShard //64: typical cache line size (std::hardware_destructive_interference_size is not ABI-stable)
+    {
+        std::atomic<int>     itemsDeltaProcessed{0}; //
+        std::atomic<int64_t> bytesDeltaProcessed{0}; //std:atomic is uninitialized by default!
+        std::atomic<int>     itemsDeltaTotal    {0}; //
+        std::atomic<int64_t> bytesDeltaTotal    {0}; //
+        std::atomic<int64_t> itemsProcessedSum  {0}; //not reset by reportStats()
+        std::atomic<int64_t> bytesProcessedSum  {0}; //
     };
+    static constexpr size_t STAT_SHARD_COUNT = 16;
+
+    StatShard& getStatShard()
+    {
+        static std::atomic<size_t> threadCount{0};
+        thread_local const size_t shardIdx = threadCount++ % STAT_SHARD_COUNT; //round-robin => worker threads (likely) get a shard of their own
+        return statShards_[shardIdx];
+    }
 
     ThreadStatus* getThreadStatus() //call while holding "lockCurrentStatus_" lock!!
     {
@@ -222,18 +363,20 @@ private:
     {
         assert(zen::runningOnMainThread());
 
-        const std::pair<int, int64_t> deltaProcessed(itemsDeltaProcessed_, bytesDeltaProcessed_);
-        if (deltaProcessed.first != 0 || deltaProcessed.second != 0)
+        std::pair<int, int64_t> deltaProcessed;
+        std::pair<int, int64_t> deltaTotal;
+        for (StatShard& shard : statShards_)
         {
-            updateDataProcessed   (-deltaProcessed.first, -deltaProcessed.second); //careful with these atomics: don't just set to 0
-            cb.updateDataProcessed( deltaProcessed.first,  deltaProcessed.second); //noexcept!
+            deltaProcessed.first  += shard.itemsDeltaProcessed.exchange(0, std::memory_order_relaxed); //careful with these atomics: don't just set to 0
+            deltaProcessed.second += shard.bytesDeltaProcessed.exchange(0, std::memory_order_relaxed);
+            deltaTotal    .first  += shard.itemsDeltaTotal    .exchange(0, std::memory_order_relaxed);
+            deltaTotal    .second += shard.bytesDeltaTotal    .exchange(0, std::memory_order_relaxed);
         }
-        const std::pair<int, int64_t> deltaTotal(itemsDeltaTotal_, bytesDeltaTotal_);
+        if (deltaProcessed.first != 0 || deltaProcessed.second != 0)
+            cb.updateDataProcessed(deltaProcessed.first, deltaProcessed.second); //noexcept!
+
         if (deltaTotal.first != 0 || deltaTotal.second != 0)
-        {
-            updateDataTotal   (-deltaTotal.first, -deltaTotal.second);
-            cb.updateDataTotal( deltaTotal.first,  deltaTotal.second); //noexcept!
-        }
+            cb.updateDataTotal(deltaTotal.first, deltaTotal.second); //noexcept!
     }
 
     //context of main thread, call repreatedly
@@ -242,21 +385,22 @@ private:
         assert(zen::runningOnMainThread());
 
         size_t parallelOpsTotal = 0;
-        std::wstring statusMsg;
+        ThreadStatus status;
         {
             std::lock_guard dummy(lockCurrentStatus_);
 
             for (const auto& sbp : statusByPriority_)
                 parallelOpsTotal += sbp.empty() ? 0 : 1;
-            statusMsg = [&]
+            status = [&]
             {
                 for (const std::vector<ThreadStatus>& sbp : statusByPriority_)
                     for (const ThreadStatus& ts : sbp)
                         if (!ts.statusMsg.empty())
-                            return ts.statusMsg;
-                return std::wstring();
+                            return ts;
+                return ThreadStatus();
             }();
         }
+        const std::wstring& statusMsg = formatStatus(status); //format outside of lock
         if (parallelOpsTotal >= 2)
             return L'[' + _P("1 thread", "%x threads", parallelOpsTotal) + L"] " + statusMsg;
         else
@@ -270,8 +414,19 @@ private:
     std::condition_variable conditionHaveResponse_;
     std::optional<PhaseCallback::ErrorInfo> errorRequest_;
     std::optional<PhaseCallback::Response > errorResponse_;
-    std::optional<std::wstring>             logInfoRequest_;
     bool finishNowRequest_ = false;
+    size_t workloadsActive_ = 1; //each calls notifyAllDone() once
+
+    struct LogRecord //formatted by main thread
+    {
+        std::wstring msgTemplate; //formatted text if pathCount == 0
+        std::wstring pathX;
+        std::wstring pathY;
+        int pathCount = 0;
+    };
+    static constexpr size_t LOG_QUEUE_CAPACITY = 100; //limits number of items processed after user pressed "pause"
+    std::vector<LogRecord> logQueue_;
+    std::vector<LogRecord> logQueueFlush_; //main thread only: swapped with logQueue_ => buffers are reused
 
     //---- status updates ----
     std::mutex lockCurrentStatus_; //different lock for status updates so that we're not blocked by other threads reporting errors
@@ -281,10 +436,7 @@ private:
     //std::vector<char/*bool*/> usedIndexNums_; //keep info for human-readable task index numbers
 
     //---- status updates II (lock-free) ----
-    std::atomic<int>     itemsDeltaProcessed_{0}; //
-    std::atomic<int64_t> bytesDeltaProcessed_{0}; //std:atomic is uninitialized by default!
-    std::atomic<int>     itemsDeltaTotal_    {0}; //
-    std::atomic<int64_t> bytesDeltaTotal_    {0}; //
+    std::array<StatShard, STAT_SHARD_COUNT> statShards_;
 };
 
 
@@ -310,6 +462,8 @@ public:
     }
 
     void updateStatus(std::wstring&& msg) { cb_.updateStatus(std::move(msg)); } //throw X
+    void updateStatus(const std::wstring& msgTemplate, const std::wstring& displayPath) { cb_.updateStatus(msgTemplate, displayPath); } //throw X
+    void updateStatus(const std::wstring& msgTemplate, const std::wstring& displayPathX, const std::wstring& displayPathY) { cb_.updateStatus(msgTemplate, displayPathX, displayPathY); } //
 
     void reportDelta(int itemsDelta, int64_t bytesDelta) //noexcept!
     {
@@ -435,9 +589,9 @@ using AsyncPercentStatReporter = PercentStatReporter<AsyncCallback>;
 //=====================================================================================================================
 
 template <class Function, class Callback> inline //return ignored error message if available
-std::wstring tryReportingError(Function cmd /*throw FileError*/, Callback& cb /*throw X*/)
+std::wstring tryReportingError(Function cmd /*throw FileError*/, Callback& cb /*throw X*/, size_t retryNumberFirst = 0 /*tries done before*/)
 {
-    for (size_t retryNumber = 0;; ++retryNumber)
+    for (size_t retryNumber = retryNumberFirst;; ++retryNumber)
         try
         {
             cmd(); //throw FileError
@@ -468,6 +622,7 @@ using ParallelWorkItem = std::function<void(ParallelContext& ctx)> /*throw Threa
 namespace
 {
 void massParallelExecute(const std::vector<std::pair<AbstractPath, ParallelWorkItem>>& workload,
+                         const std::map<AfsDevice, size_t>& deviceParallelOps, //work items on the same device must be safe to run in parallel!
                          const Zstring& threadGroupName,
                          PhaseCallback& callback /*throw X*/) //throw X
 {
@@ -492,7 +647,7 @@ void massParallelExecute(const std::vector<std::pair<AbstractPath, ParallelWorkI
         const size_t statusPrio = deviceThreadGroups.size();
 
         auto& threadGroup = deviceThreadGroups.emplace(afsDevice, ThreadGroup<std::function<void()>>(
-                                                           1,
+                                                           getDeviceParallelOps(deviceParallelOps, afsDevice),
                                                            threadGroupName + Zstr(' ') + utfTo<Zstring>(AFS::getDisplayPath(AbstractPath(afsDevice, AfsPath()))))).first->second;
 
         for (const std::pair<AbstractPath, ParallelWorkItem>* item : wl)
@@ -514,6 +669,15 @@ void massParallelExecute(const std::vector<std::pair<AbstractPath, ParallelWorkI
 
     acb.waitUntilDone(UI_UPDATE_INTERVAL / 2 /*every ~50 ms*/, callback); //throw X
 }
+
+
+//one thread per device:
+void massParallelExecute(const std::vector<std::pair<AbstractPath, ParallelWorkItem>>& workload,
+                         const Zstring& threadGroupName,
+                         PhaseCallback& callback /*throw X*/) //throw X
+{
+    massParallelExecute(workload, {} /*deviceParallelOps*/, threadGroupName, callback); //throw X
+}
 }
 
 //=====================================================================================================================
@@ -167,6 +167,37 @@ void fff::setDeviceParallelOps(std::map<AfsDevice, size_t>& deviceParallelOps, c
 }
 
 
+uint64_t fff::getDeviceBandwidthLimit(const std::map<AfsDevice, uint64_t>& deviceBandwidthLimits, const AfsDevice& afsDevice)
+{
+    auto it = deviceBandwidthLimits.find(afsDevice);
+    return it != deviceBandwidthLimits.end() ? it->second : 0;
+}
+
+
+void fff::setDeviceBandwidthLimit(std::map<AfsDevice, uint64_t>& deviceBandwidthLimits, const AfsDevice& afsDevice, uint64_t bytesPerSec)
+{
+    if (!AFS::isNullDevice(afsDevice))
+    {
+        if (bytesPerSec > 0)
+            deviceBandwidthLimits[afsDevice] = bytesPerSec;
+        else
+            deviceBandwidthLimits.erase(afsDevice);
+    }
+}
+
+
+uint64_t fff::getDeviceBandwidthLimit(const std::map<AfsDevice, uint64_t>& deviceBandwidthLimits, const Zstring& folderPathPhrase)
+{
+    return getDeviceBandwidthLimit(deviceBandwidthLimits, createAbstractPath(folderPathPhrase).afsDevice);
+}
+
+
+void fff::setDeviceBandwidthLimit(std::map<AfsDevice, uint64_t>& deviceBandwidthLimits, const Zstring& folderPathPhrase, uint64_t bytesPerSec)
+{
+    setDeviceBandwidthLimit(deviceBandwidthLimits, createAbstractPath(folderPathPhrase).afsDevice, bytesPerSec);
+}
+
+
 std::wstring fff::getSymbol(CompareFileResult cmpRes)
 {
     switch (cmpRes)
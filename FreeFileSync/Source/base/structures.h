@@ -132,6 +132,7 @@ struct SyncDirectionConfig
     SyncVariant var = SyncVariant::twoWay;
     DirectionSet custom; //sync directions for SyncVariant::custom
     bool detectMovedFiles = false; //variant-dependent: e.g. always active for SyncVariant::twoWay! => use functions below for evaluation!
+    bool detectMovedFilesByTimeSize = false; //fallback for devices without file IDs (e.g. FTP, SFTP): associate by unique size and modification time
 };
 
 bool detectMovedFilesSelectable(const SyncDirectionConfig& cfg);
@@ -149,7 +150,8 @@ bool operator==(const SyncDirectionConfig& lhs, const SyncDirectionConfig& rhs)
 {
     return lhs.var == rhs.var &&
            (lhs.var != SyncVariant::custom || lhs.custom == rhs.custom) && //no need to consider custom directions if var != CUSTOM
-           lhs.detectMovedFiles == rhs.detectMovedFiles; //useful to remember this setting even if the current sync variant does not need it
+           lhs.detectMovedFiles == rhs.detectMovedFiles && //useful to remember this setting even if the current sync variant does not need it
+           lhs.detectMovedFilesByTimeSize == rhs.detectMovedFilesByTimeSize;
     //adapt effectivelyEqual() on changes, too!
 }
 
@@ -158,7 +160,8 @@ bool effectivelyEqual(const SyncDirectionConfig& lhs, const SyncDirectionConfig&
 {
     return (lhs.var == SyncVariant::twoWay) == (rhs.var == SyncVariant::twoWay) && //either both two-way or none
            (lhs.var == SyncVariant::twoWay || extractDirections(lhs) == extractDirections(rhs)) &&
-           detectMovedFilesEnabled(lhs) == detectMovedFilesEnabled(rhs);
+           detectMovedFilesEnabled(lhs) == detectMovedFilesEnabled(rhs) &&
+           (!detectMovedFilesEnabled(lhs) || lhs.detectMovedFilesByTimeSize == rhs.detectMovedFilesByTimeSize);
 }
 
 
@@ -187,6 +190,7 @@ enum class VersioningStyle
     replace,
     timestampFolder,
     timestampFile,
+    deduplicate, //timestampFile naming, but store unique chunks + manifest only: see dedup_store.h
 };
 
 struct SyncConfig
@@ -365,6 +369,7 @@ struct MainConfiguration
     std::vector<LocalPairConfig> additionalPairs;
 
     std::map<AfsDevice, size_t /*parallel operations*/> deviceParallelOps; //should only include devices with >= 2  parallel ops
+    std::map<AfsDevice, uint64_t /*bytes per second*/> deviceBandwidthLimits; //should only include devices with a limit
 
     bool ignoreErrors = false; //true: errors will still be logged
     size_t autoRetryCount = 0;
@@ -387,6 +392,12 @@ void   setDeviceParallelOps(      std::map<AfsDevice, size_t>& deviceParallelOps
 size_t getDeviceParallelOps(const std::map<AfsDevice, size_t>& deviceParallelOps, const Zstring& folderPathPhrase);
 void   setDeviceParallelOps(      std::map<AfsDevice, size_t>& deviceParallelOps, const Zstring& folderPathPhrase, size_t parallelOps);
 
+//0: unlimited
+uint64_t getDeviceBandwidthLimit(const std::map<AfsDevice, uint64_t>& deviceBandwidthLimits, const AfsDevice& afsDevice);
+void     setDeviceBandwidthLimit(      std::map<AfsDevice, uint64_t>& deviceBandwidthLimits, const AfsDevice& afsDevice, uint64_t bytesPerSec);
+uint64_t getDeviceBandwidthLimit(const std::map<AfsDevice, uint64_t>& deviceBandwidthLimits, const Zstring& folderPathPhrase);
+void     setDeviceBandwidthLimit(      std::map<AfsDevice, uint64_t>& deviceBandwidthLimits, const Zstring& folderPathPhrase, uint64_t bytesPerSec);
+
 
 std::optional<CompareVariant>           getCompVariant(const MainConfiguration& mainCfg);
 std::optional<SyncVariant> getSyncVariant(const MainConfiguration& mainCfg);
@@ -409,6 +420,31 @@ struct WarningDialogs
 
     bool operator==(const WarningDialogs&) const = default;
 };
+
+
+//measured by previous syncs: schedule long folder pairs first, estimate remaining time before the first speed samples
+struct FolderPairHistory
+{
+    Zstring folderPathPhraseL; //key: AFS::getInitPathPhrase()
+    Zstring folderPathPhraseR; //
+    time_t lastRunTime = 0;
+    std::chrono::milliseconds duration{};
+    int     items = 0;
+    int64_t bytes = 0;
+};
+
+struct DeviceHistory
+{
+    Zstring devicePathPhrase; //key: AFS::getInitPathPhrase() of device root
+    time_t lastRunTime = 0;
+    double bytesPerSec = 0; //target device, including fixed costs per item: moving average
+};
+
+struct SyncHistory
+{
+    std::vector<FolderPairHistory> folderPairs; //most recent first
+    std::vector<DeviceHistory>     devices;     //
+};
 }
 
 #endif //STRUCTURES_H_8210478915019450901745
@@ -8,14 +8,17 @@
 #include <tuple>
 #include <zen/process_priority.h>
 #include <zen/perf.h>
+#include <zen/file_io.h>
 #include <zen/guid.h>
 #include <zen/crc.h>
 #include "algorithm.h"
 #include "db_file.h"
+#include "fs_snapshot.h"
 #include "dir_exist_async.h"
 #include "status_handler_impl.h"
 #include "versioning.h"
 #include "binary.h"
+#include "device_budget.h"
 #include "../afs/concrete.h"
 #include "../afs/native.h"
 
@@ -31,6 +34,10 @@ namespace
 const size_t CONFLICTS_PREVIEW_MAX = 25; //=> consider memory consumption, log file size, email size!
 const size_t MODTIME_ERRORS_PREVIEW_MAX = 25;
 
+//batch upload of small new files (e.g. SFTP: tar stream) => save per-file round trips:
+const uint64_t BATCH_UPLOAD_FILE_SIZE_MAX  = 256 * 1024;
+const size_t   BATCH_UPLOAD_FILE_COUNT_MIN = 8; //fewer files: not worth the overhead of a batch
+
 
 inline
 int getCUD(const SyncStatistics& stat)
@@ -43,73 +50,204 @@ int getCUD(const SyncStatistics& stat)
 }
 
 
+namespace
+{
+std::vector<SyncStatistics> getFolderPairStats(const FolderComparison& folderCmp)
+{
+    //CPU-bound only, and base folder pairs are independent => one thread per pair
+    std::vector<std::optional<SyncStatistics>> stats(folderCmp.size());
+
+    runParallel(folderCmp.size(), [&](size_t pos) { stats[pos].emplace(*folderCmp[pos]); });
+
+    std::vector<SyncStatistics> output;
+    for (std::optional<SyncStatistics>& st : stats)
+        output.push_back(std::move(*st));
+    return output;
+}
+}
+
+
 SyncStatistics::SyncStatistics(const FolderComparison& folderCmp)
 {
-    std::for_each(begin(folderCmp), end(folderCmp), [&](const BaseFolderPair& baseFolder) { recurse(baseFolder); });
+    for (const SyncStatistics& st : getFolderPairStats(folderCmp))
+        merge(st);
 }
 
 
 SyncStatistics::SyncStatistics(const ContainerObject& hierObj)
 {
+    initHardLinkDetection(hierObj.getBase());
     recurse(hierObj);
 }
 
 
 SyncStatistics::SyncStatistics(const FilePair& file)
 {
-    processFile(file);
-    ++rowsTotal_;
+    const SyncOperation so = file.getSyncOperation();
+    processFile(file, so, counts_, [this](SelectSide sideSrc, AFS::FingerPrint filePrint, uint64_t fileSize) { addCopyBytes(sideSrc, filePrint, fileSize); });
+    if (so == SO_UNRESOLVED_CONFLICT)
+        addConflictPreview(file);
+    ++counts_.rowsTotal;
+}
+
+
+void SyncStatistics::Counts::add(const Counts& sub, bool addSpaceNeeded)
+{
+    createLeft  += sub.createLeft;
+    createRight += sub.createRight;
+    updateLeft  += sub.updateLeft;
+    updateRight += sub.updateRight;
+    deleteLeft  += sub.deleteLeft;
+    deleteRight += sub.deleteRight;
+    physicalDeleteLeft  = physicalDeleteLeft  || sub.physicalDeleteLeft;
+    physicalDeleteRight = physicalDeleteRight || sub.physicalDeleteRight;
+
+    bytesToProcess += sub.bytesToProcess;
+    rowsTotal      += sub.rowsTotal;
+    conflictCount  += sub.conflictCount;
+
+    if (addSpaceNeeded)
+    {
+        spaceNeededLeft  += sub.spaceNeededLeft;
+        spaceNeededRight += sub.spaceNeededRight;
+    }
+}
+
+
+void SyncStatistics::merge(const SyncStatistics& other)
+{
+    counts_.add(other.counts_, true /*addSpaceNeeded*/);
+
+    for (const ConflictInfo& ci : other.conflictsPreview_)
+        if (conflictsPreview_.size() < CONFLICTS_PREVIEW_MAX)
+            conflictsPreview_.push_back(ci);
 }
 
 
 inline
+void SyncStatistics::addConflictPreview(const FileSystemObject& fsObj)
+{
+    if (conflictsPreview_.size() < CONFLICTS_PREVIEW_MAX)
+        conflictsPreview_.push_back({fsObj.getRelativePathAny(), fsObj.getSyncOpConflict()});
+}
+
+
 void SyncStatistics::recurse(const ContainerObject& hierObj)
 {
+    if (hierObj.isSpilled()) //equal items only: see spillInSyncSubTrees()
+    {
+        counts_.rowsTotal += hierObj.getSpilledItemCount();
+        return;
+    }
+
     for (const FilePair& file : hierObj.refSubFiles())
-        processFile(file);
+    {
+        const SyncOperation so = file.getSyncOperation();
+        processFile(file, so, counts_, [this](SelectSide sideSrc, AFS::FingerPrint filePrint, uint64_t fileSize) { addCopyBytes(sideSrc, filePrint, fileSize); });
+        if (so == SO_UNRESOLVED_CONFLICT)
+            addConflictPreview(file);
+    }
+
     for (const SymlinkPair& symlink : hierObj.refSubLinks())
-        processLink(symlink);
+    {
+        const SyncOperation so = symlink.getSyncOperation();
+        processLink(symlink, so, counts_);
+        if (so == SO_UNRESOLVED_CONFLICT)
+            addConflictPreview(symlink);
+    }
+
     for (const FolderPair& folder : hierObj.refSubFolders())
-        processFolder(folder);
+    {
+        const SyncOperation so = folder.getSyncOperation();
+        processFolder(folder, so, counts_);
+        if (so == SO_UNRESOLVED_CONFLICT)
+            addConflictPreview(folder);
+
+        //since we model logical stats, we recurse, even if deletion variant is "recycler" or "versioning + same volume", which is a single physical operation!
+        if (addsSpaceNeeded(folder, so))
+            recurse(folder);
+        else
+        {
+            const int64_t spaceNeededLeft  = counts_.spaceNeededLeft;
+            const int64_t spaceNeededRight = counts_.spaceNeededRight;
+            recurse(folder);
+            counts_.spaceNeededLeft  = spaceNeededLeft;
+            counts_.spaceNeededRight = spaceNeededRight;
+        }
+    }
 
-    rowsTotal_ += hierObj.refSubFolders().size();
-    rowsTotal_ += hierObj.refSubFiles  ().size();
-    rowsTotal_ += hierObj.refSubLinks  ().size();
+    counts_.rowsTotal += hierObj.refSubFolders().size();
+    counts_.rowsTotal += hierObj.refSubFiles  ().size();
+    counts_.rowsTotal += hierObj.refSubLinks  ().size();
+}
+
+
+void SyncStatistics::initHardLinkDetection(const BaseFolderPair& baseFolder)
+{
+    detectHardLinks_ = !getNativeItemPath(baseFolder.getAbstractPath<SelectSide::left >()).empty() &&
+                       !getNativeItemPath(baseFolder.getAbstractPath<SelectSide::right>()).empty();
+    copiedFilePrintsL_.clear();
+    copiedFilePrintsR_.clear();
 }
 
 
 inline
-void SyncStatistics::processFile(const FilePair& file)
+void SyncStatistics::addCopyBytes(SelectSide sideSrc, AFS::FingerPrint filePrint, uint64_t fileSize)
 {
-    switch (file.getSyncOperation()) //evaluate comparison result and sync direction
+    if (detectHardLinks_ && filePrint != 0 &&
+        !(sideSrc == SelectSide::left ? copiedFilePrintsL_ : copiedFilePrintsR_).insert(filePrint).second)
+        return; //hard link copy: no data transfer
+
+    counts_.bytesToProcess += static_cast<int64_t>(fileSize);
+}
+
+
+/*  minimum disk space needed:
+      DeletionPolicy::permanent:  deletion frees space
+      DeletionPolicy::recycler:   won't free space until recycler is full, but then frees space
+      DeletionPolicy::versioning: depends on whether versioning folder is on a different volume
+    -> if deleted item is a followed symlink, no space is freed
+    -> created/updated/deleted item may be on a different volume than base directory: consider symlinks, junctions!
+
+    => generally assume deletion frees space; may avoid false-positive disk space warnings for recycler and versioning   */
+template <class AddCopyBytesFun> inline
+void SyncStatistics::processFile(const FilePair& file, SyncOperation so, Counts& counts, AddCopyBytesFun addCopyBytes)
+{
+    switch (so) //evaluate comparison result and sync direction
     {
         case SO_CREATE_NEW_LEFT:
-            ++createLeft_;
-            bytesToProcess_ += static_cast<int64_t>(file.getFileSize<SelectSide::right>());
+            ++counts.createLeft;
+            addCopyBytes(SelectSide::right, file.getFilePrint<SelectSide::right>(), file.getFileSize<SelectSide::right>());
+            counts.spaceNeededLeft += static_cast<int64_t>(file.getFileSize<SelectSide::right>());
             break;
 
         case SO_CREATE_NEW_RIGHT:
-            ++createRight_;
-            bytesToProcess_ += static_cast<int64_t>(file.getFileSize<SelectSide::left>());
+            ++counts.createRight;
+            addCopyBytes(SelectSide::left, file.getFilePrint<SelectSide::left>(), file.getFileSize<SelectSide::left>());
+            counts.spaceNeededRight += static_cast<int64_t>(file.getFileSize<SelectSide::left>());
             break;
 
         case SO_DELETE_LEFT:
-            ++deleteLeft_;
-            physicalDeleteLeft_ = true;
+            ++counts.deleteLeft;
+            counts.physicalDeleteLeft = true;
+            if (!file.isFollowedSymlink<SelectSide::left>())
+                counts.spaceNeededLeft -= static_cast<int64_t>(file.getFileSize<SelectSide::left>());
             break;
 
         case SO_DELETE_RIGHT:
-            ++deleteRight_;
-            physicalDeleteRight_ = true;
+            ++counts.deleteRight;
+            counts.physicalDeleteRight = true;
+            if (!file.isFollowedSymlink<SelectSide::right>())
+                counts.spaceNeededRight -= static_cast<int64_t>(file.getFileSize<SelectSide::right>());
             break;
 
         case SO_MOVE_LEFT_TO:
-            ++updateLeft_;
-            //physicalDeleteLeft_ ? -> usually, no; except when falling back to "copy + delete"
+            ++counts.updateLeft;
+            //physicalDeleteLeft ? -> usually, no; except when falling back to "copy + delete"
             break;
 
         case SO_MOVE_RIGHT_TO:
-            ++updateRight_;
+            ++counts.updateRight;
             break;
 
         case SO_MOVE_LEFT_FROM:  //ignore; already counted
@@ -117,29 +255,33 @@ void SyncStatistics::processFile(const FilePair& file)
             break;
 
         case SO_OVERWRITE_LEFT:
-            ++updateLeft_;
-            bytesToProcess_ += static_cast<int64_t>(file.getFileSize<SelectSide::right>());
-            physicalDeleteLeft_ = true;
+            ++counts.updateLeft;
+            counts.bytesToProcess += static_cast<int64_t>(file.getFileSize<SelectSide::right>());
+            counts.physicalDeleteLeft = true;
+            if (!file.isFollowedSymlink<SelectSide::left>())
+                counts.spaceNeededLeft -= static_cast<int64_t>(file.getFileSize<SelectSide::left>());
+            counts.spaceNeededLeft += static_cast<int64_t>(file.getFileSize<SelectSide::right>());
             break;
 
         case SO_OVERWRITE_RIGHT:
-            ++updateRight_;
-            bytesToProcess_ += static_cast<int64_t>(file.getFileSize<SelectSide::left>());
-            physicalDeleteRight_ = true;
+            ++counts.updateRight;
+            counts.bytesToProcess += static_cast<int64_t>(file.getFileSize<SelectSide::left>());
+            counts.physicalDeleteRight = true;
+            if (!file.isFollowedSymlink<SelectSide::right>())
+                counts.spaceNeededRight -= static_cast<int64_t>(file.getFileSize<SelectSide::right>());
+            counts.spaceNeededRight += static_cast<int64_t>(file.getFileSize<SelectSide::left>());
             break;
 
         case SO_UNRESOLVED_CONFLICT:
-            ++conflictCount_;
-            if (conflictsPreview_.size() < CONFLICTS_PREVIEW_MAX)
-                conflictsPreview_.push_back({file.getRelativePathAny(), file.getSyncOpConflict()});
+            ++counts.conflictCount;
             break;
 
         case SO_COPY_METADATA_TO_LEFT:
-            ++updateLeft_;
+            ++counts.updateLeft;
             break;
 
         case SO_COPY_METADATA_TO_RIGHT:
-            ++updateRight_;
+            ++counts.updateRight;
             break;
 
         case SO_DO_NOTHING:
@@ -150,44 +292,42 @@ void SyncStatistics::processFile(const FilePair& file)
 
 
 inline
-void SyncStatistics::processLink(const SymlinkPair& symlink)
+void SyncStatistics::processLink(const SymlinkPair& symlink, SyncOperation so, Counts& counts)
 {
-    switch (symlink.getSyncOperation()) //evaluate comparison result and sync direction
+    switch (so) //evaluate comparison result and sync direction
     {
         case SO_CREATE_NEW_LEFT:
-            ++createLeft_;
+            ++counts.createLeft;
             break;
 
         case SO_CREATE_NEW_RIGHT:
-            ++createRight_;
+            ++counts.createRight;
             break;
 
         case SO_DELETE_LEFT:
-            ++deleteLeft_;
-            physicalDeleteLeft_ = true;
+            ++counts.deleteLeft;
+            counts.physicalDeleteLeft = true;
             break;
 
         case SO_DELETE_RIGHT:
-            ++deleteRight_;
-            physicalDeleteRight_ = true;
+            ++counts.deleteRight;
+            counts.physicalDeleteRight = true;
             break;
 
         case SO_OVERWRITE_LEFT:
         case SO_COPY_METADATA_TO_LEFT:
-            ++updateLeft_;
-            physicalDeleteLeft_ = true;
+            ++counts.updateLeft;
+            counts.physicalDeleteLeft = true;
             break;
 
         case SO_OVERWRITE_RIGHT:
         case SO_COPY_METADATA_TO_RIGHT:
-            ++updateRight_;
-            physicalDeleteRight_ = true;
+            ++counts.updateRight;
+            counts.physicalDeleteRight = true;
             break;
 
         case SO_UNRESOLVED_CONFLICT:
-            ++conflictCount_;
-            if (conflictsPreview_.size() < CONFLICTS_PREVIEW_MAX)
-                conflictsPreview_.push_back({symlink.getRelativePathAny(), symlink.getSyncOpConflict()});
+            ++counts.conflictCount;
             break;
 
         case SO_MOVE_LEFT_FROM:
@@ -204,42 +344,40 @@ void SyncStatistics::processLink(const SymlinkPair& symlink)
 
 
 inline
-void SyncStatistics::processFolder(const FolderPair& folder)
+void SyncStatistics::processFolder(const FolderPair& folder, SyncOperation so, Counts& counts)
 {
-    switch (folder.getSyncOperation()) //evaluate comparison result and sync direction
+    switch (so) //evaluate comparison result and sync direction
     {
         case SO_CREATE_NEW_LEFT:
-            ++createLeft_;
+            ++counts.createLeft;
             break;
 
         case SO_CREATE_NEW_RIGHT:
-            ++createRight_;
+            ++counts.createRight;
             break;
 
         case SO_DELETE_LEFT: //if deletion variant == versioning with user-defined directory existing on other volume, this results in a full copy + delete operation!
-            ++deleteLeft_;    //however we cannot (reliably) anticipate this situation, fortunately statistics can be adapted during sync!
-            physicalDeleteLeft_ = true;
+            ++counts.deleteLeft;    //however we cannot (reliably) anticipate this situation, fortunately statistics can be adapted during sync!
+            counts.physicalDeleteLeft = true;
             break;
 
         case SO_DELETE_RIGHT:
-            ++deleteRight_;
-            physicalDeleteRight_ = true;
+            ++counts.deleteRight;
+            counts.physicalDeleteRight = true;
             break;
 
         case SO_UNRESOLVED_CONFLICT:
-            ++conflictCount_;
-            if (conflictsPreview_.size() < CONFLICTS_PREVIEW_MAX)
-                conflictsPreview_.push_back({folder.getRelativePathAny(), folder.getSyncOpConflict()});
+            ++counts.conflictCount;
             break;
 
         case SO_OVERWRITE_LEFT:
         case SO_COPY_METADATA_TO_LEFT:
-            ++updateLeft_;
+            ++counts.updateLeft;
             break;
 
         case SO_OVERWRITE_RIGHT:
         case SO_COPY_METADATA_TO_RIGHT:
-            ++updateRight_;
+            ++counts.updateRight;
             break;
 
         case SO_MOVE_LEFT_FROM:
@@ -252,117 +390,252 @@ void SyncStatistics::processFolder(const FolderPair& folder)
         case SO_EQUAL:
             break;
     }
-
-    recurse(folder); //since we model logical stats, we recurse, even if deletion variant is "recycler" or "versioning + same volume", which is a single physical operation!
 }
 
 
-/*    DeletionPolicy::permanent:  deletion frees space
-      DeletionPolicy::recycler:   won't free space until recycler is full, but then frees space
-      DeletionPolicy::versioning: depends on whether versioning folder is on a different volume
-    -> if deleted item is a followed symlink, no space is freed
-    -> created/updated/deleted item may be on a different volume than base directory: consider symlinks, junctions!
+inline
+bool SyncStatistics::addsSpaceNeeded(const FolderPair& folder, SyncOperation so)
+{
+    switch (so)
+    {
+        case SO_DELETE_LEFT:
+            return !folder.isFollowedSymlink<SelectSide::left>(); //not 100% correct: in fact more that what our model contains may be deleted (consider file filter!)
+        case SO_DELETE_RIGHT:
+            return !folder.isFollowedSymlink<SelectSide::right>();
 
-    => generally assume deletion frees space; may avoid false-positive disk space warnings for recycler and versioning   */
-class MinimumDiskSpaceNeeded
+        case SO_MOVE_LEFT_FROM:
+        case SO_MOVE_RIGHT_FROM:
+        case SO_MOVE_LEFT_TO:
+        case SO_MOVE_RIGHT_TO:
+            assert(false);
+            [[fallthrough]];
+        case SO_CREATE_NEW_LEFT:
+        case SO_CREATE_NEW_RIGHT:
+        case SO_OVERWRITE_LEFT:
+        case SO_OVERWRITE_RIGHT:
+        case SO_COPY_METADATA_TO_LEFT:
+        case SO_COPY_METADATA_TO_RIGHT:
+        case SO_DO_NOTHING:
+        case SO_EQUAL:
+        case SO_UNRESOLVED_CONFLICT:
+            break; //not 100% correct: what if left or right folder is symlink!? => file operations may happen on different volume!
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------------------------------------
+
+struct SyncStatisticsBuffer::BaseFolderBuffer
 {
-public:
-    static std::pair<int64_t, int64_t> calculate(const BaseFolderPair& baseFolder)
+    void evaluate(const BaseFolderPair& baseFolder)
+    {
+        if (const bool detectHardLinksNew = !getNativeItemPath(baseFolder.getAbstractPath<SelectSide::left >()).empty() &&
+                                            !getNativeItemPath(baseFolder.getAbstractPath<SelectSide::right>()).empty();
+            detectHardLinks != detectHardLinksNew)
+        {
+            subTrees.clear();
+            copiedFilePrintsL.clear();
+            copiedFilePrintsR.clear();
+            hardLinkBytes = 0;
+            detectHardLinks = detectHardLinksNew;
+        }
+        update(baseFolder, nullptr /*parent*/);
+    }
+
+    bool isUpToDate(const BaseFolderPair& baseFolder) const
     {
-        MinimumDiskSpaceNeeded inst;
-        inst.recurse(baseFolder);
-        return {inst.spaceNeededLeft_, inst.spaceNeededRight_};
+        auto it = subTrees.find(&baseFolder);
+        return it != subTrees.end() && it->second.changeId == baseFolder.getChangeId();
+    }
+
+    void addTo(SyncStatistics& st, const BaseFolderPair& baseFolder) const
+    {
+        assert(isUpToDate(baseFolder));
+        st.counts_.add(subTrees.find(&baseFolder)->second.counts, true /*addSpaceNeeded*/);
+        st.counts_.bytesToProcess += hardLinkBytes;
+
+        if (st.conflictsPreview_.size() < CONFLICTS_PREVIEW_MAX)
+            addConflictsPreview(st, baseFolder);
     }
 
 private:
-    void recurse(const ContainerObject& hierObj)
+    using FilePrintList = std::vector<std::pair<AFS::FingerPrint, uint64_t /*file size*/>>;
+
+    struct SubTree
+    {
+        uint64_t changeId = 0; //0: not yet evaluated (change ids start at 1)
+        SyncStatistics::Counts counts; //recursive; without bytes of hard link candidates: see copiedFilePrintsL/R
+        const ContainerObject* parent = nullptr;        //weak pointers: *never dereference*!
+        std::vector<const ContainerObject*> subFolders; //sorted
+        FilePrintList copiedFilePrintsL; //this folder only (non-recursive): source file prints of files to create on the *other* side
+        FilePrintList copiedFilePrintsR; //
+    };
+
+    const SyncStatistics::Counts& update(const ContainerObject& hierObj, const ContainerObject* parent)
     {
-        //process files
+        SubTree& sub = subTrees[&hierObj]; //unordered_map: references remain valid during rehash
+        sub.parent = parent;
+        if (sub.changeId == hierObj.getChangeId())
+            return sub.counts;
+
+        updateFilePrints(sub.copiedFilePrintsL, copiedFilePrintsL, false /*add*/);
+        updateFilePrints(sub.copiedFilePrintsR, copiedFilePrintsR, false /*add*/);
+        sub.copiedFilePrintsL.clear();
+        sub.copiedFilePrintsR.clear();
+
+        SyncStatistics::Counts counts;
+
         for (const FilePair& file : hierObj.refSubFiles())
-            switch (file.getSyncOperation()) //evaluate comparison result and sync direction
-            {
-                case SO_CREATE_NEW_LEFT:
-                    spaceNeededLeft_ += static_cast<int64_t>(file.getFileSize<SelectSide::right>());
-                    break;
+            SyncStatistics::processFile(file, file.getSyncOperation(), counts, [&](SelectSide sideSrc, AFS::FingerPrint filePrint, uint64_t fileSize)
+        {
+            if (detectHardLinks && filePrint != 0) //hard link copies are not known until all folders have been evaluated
+                (sideSrc == SelectSide::left ? sub.copiedFilePrintsL : sub.copiedFilePrintsR).emplace_back(filePrint, fileSize);
+            else
+                counts.bytesToProcess += static_cast<int64_t>(fileSize);
+        });
 
-                case SO_CREATE_NEW_RIGHT:
-                    spaceNeededRight_ += static_cast<int64_t>(file.getFileSize<SelectSide::left>());
-                    break;
+        for (const SymlinkPair& symlink : hierObj.refSubLinks())
+            SyncStatistics::processLink(symlink, symlink.getSyncOperation(), counts);
 
-                case SO_DELETE_LEFT:
-                    if (!file.isFollowedSymlink<SelectSide::left>())
-                        spaceNeededLeft_ -= static_cast<int64_t>(file.getFileSize<SelectSide::left>());
-                    break;
+        std::vector<const ContainerObject*> subFolders;
+        for (const FolderPair& folder : hierObj.refSubFolders())
+        {
+            const SyncOperation so = folder.getSyncOperation();
+            SyncStatistics::processFolder(folder, so, counts);
+            counts.add(update(folder, &hierObj), SyncStatistics::addsSpaceNeeded(folder, so));
+            subFolders.push_back(&folder);
+        }
 
-                case SO_DELETE_RIGHT:
-                    if (!file.isFollowedSymlink<SelectSide::right>())
-                        spaceNeededRight_ -= static_cast<int64_t>(file.getFileSize<SelectSide::right>());
-                    break;
+        counts.rowsTotal += hierObj.refSubFolders().size();
+        counts.rowsTotal += hierObj.refSubFiles  ().size();
+        counts.rowsTotal += hierObj.refSubLinks  ().size();
 
-                case SO_OVERWRITE_LEFT:
-                    if (!file.isFollowedSymlink<SelectSide::left>())
-                        spaceNeededLeft_ -= static_cast<int64_t>(file.getFileSize<SelectSide::left>());
-                    spaceNeededLeft_ += static_cast<int64_t>(file.getFileSize<SelectSide::right>());
-                    break;
+        //sub folders removed since last evaluation:
+        std::sort(subFolders.begin(), subFolders.end());
+        for (const ContainerObject* subFolderOld : sub.subFolders)
+            if (!std::binary_search(subFolders.begin(), subFolders.end(), subFolderOld))
+                purge(subFolderOld, &hierObj);
 
-                case SO_OVERWRITE_RIGHT:
-                    if (!file.isFollowedSymlink<SelectSide::right>())
-                        spaceNeededRight_ -= static_cast<int64_t>(file.getFileSize<SelectSide::right>());
-                    spaceNeededRight_ += static_cast<int64_t>(file.getFileSize<SelectSide::left>());
-                    break;
+        updateFilePrints(sub.copiedFilePrintsL, copiedFilePrintsL, true /*add*/);
+        updateFilePrints(sub.copiedFilePrintsR, copiedFilePrintsR, true /*add*/);
 
-                case SO_DO_NOTHING:
-                case SO_EQUAL:
-                case SO_UNRESOLVED_CONFLICT:
-                case SO_COPY_METADATA_TO_LEFT:
-                case SO_COPY_METADATA_TO_RIGHT:
-                case SO_MOVE_LEFT_FROM:
-                case SO_MOVE_RIGHT_FROM:
-                case SO_MOVE_LEFT_TO:
-                case SO_MOVE_RIGHT_TO:
-                    break;
-            }
+        sub.changeId   = hierObj.getChangeId();
+        sub.counts     = counts;
+        sub.subFolders = std::move(subFolders);
+        return sub.counts;
+    }
 
-        //symbolic links
-        //[...]
+    void purge(const ContainerObject* hierObj, const ContainerObject* parent) //folder was removed: *never dereference*!
+    {
+        auto it = subTrees.find(hierObj);
+        if (it == subTrees.end() || it->second.parent != parent) //address already reused by a folder evaluated before
+            return;
 
-        //recurse into sub-dirs
-        for (const FolderPair& folder : hierObj.refSubFolders())
-            switch (folder.getSyncOperation())
-            {
-                case SO_DELETE_LEFT:
-                    if (!folder.isFollowedSymlink<SelectSide::left>())
-                        recurse(folder); //not 100% correct: in fact more that what our model contains may be deleted (consider file filter!)
-                    break;
-                case SO_DELETE_RIGHT:
-                    if (!folder.isFollowedSymlink<SelectSide::right>())
-                        recurse(folder);
-                    break;
+        const SubTree sub = std::move(it->second);
+        subTrees.erase(it);
 
-                case SO_MOVE_LEFT_FROM:
-                case SO_MOVE_RIGHT_FROM:
-                case SO_MOVE_LEFT_TO:
-                case SO_MOVE_RIGHT_TO:
-                    assert(false);
-                    [[fallthrough]];
-                case SO_CREATE_NEW_LEFT:
-                case SO_CREATE_NEW_RIGHT:
-                case SO_OVERWRITE_LEFT:
-                case SO_OVERWRITE_RIGHT:
-                case SO_COPY_METADATA_TO_LEFT:
-                case SO_COPY_METADATA_TO_RIGHT:
-                case SO_DO_NOTHING:
-                case SO_EQUAL:
-                case SO_UNRESOLVED_CONFLICT:
-                    recurse(folder); //not 100% correct: what if left or right folder is symlink!? => file operations may happen on different volume!
-                    break;
+        updateFilePrints(sub.copiedFilePrintsL, copiedFilePrintsL, false /*add*/);
+        updateFilePrints(sub.copiedFilePrintsR, copiedFilePrintsR, false /*add*/);
+
+        for (const ContainerObject* subFolder : sub.subFolders)
+            purge(subFolder, hierObj);
+    }
+
+    void updateFilePrints(const FilePrintList& filePrints, std::unordered_map<AFS::FingerPrint, std::pair<size_t /*ref count*/, uint64_t /*file size*/>>& copiedFilePrints, bool add)
+    {
+        for (const auto& [filePrint, fileSize] : filePrints)
+            if (add)
+            {
+                auto& [refCount, groupFileSize] = copiedFilePrints[filePrint];
+                if (refCount++ == 0) //only the first copy of a hard link group transfers data
+                {
+                    groupFileSize = fileSize;
+                    hardLinkBytes += static_cast<int64_t>(fileSize);
+                }
+            }
+            else
+            {
+                auto it = copiedFilePrints.find(filePrint);
+                assert(it != copiedFilePrints.end());
+                if (it != copiedFilePrints.end() && --it->second.first == 0)
+                {
+                    hardLinkBytes -= static_cast<int64_t>(it->second.second);
+                    copiedFilePrints.erase(it);
+                }
             }
     }
 
-    int64_t spaceNeededLeft_  = 0;
-    int64_t spaceNeededRight_ = 0;
+    //same order as SyncStatistics::recurse(), but skip sub trees without conflicts
+    bool addConflictsPreview(SyncStatistics& st, const ContainerObject& hierObj) const //return false if preview is complete
+    {
+        if (subTrees.find(&hierObj)->second.counts.conflictCount == 0)
+            return true;
+
+        auto addConflict = [&](const FileSystemObject& fsObj)
+        {
+            if (fsObj.getSyncOperation() == SO_UNRESOLVED_CONFLICT)
+                st.addConflictPreview(fsObj);
+            return st.conflictsPreview_.size() < CONFLICTS_PREVIEW_MAX;
+        };
+
+        for (const FilePair& file : hierObj.refSubFiles())
+            if (!addConflict(file))
+                return false;
+
+        for (const SymlinkPair& symlink : hierObj.refSubLinks())
+            if (!addConflict(symlink))
+                return false;
+
+        for (const FolderPair& folder : hierObj.refSubFolders())
+            if (!addConflict(folder) ||
+                !addConflictsPreview(st, folder))
+                return false;
+        return true;
+    }
+
+    bool detectHardLinks = false; //see SyncStatistics::initHardLinkDetection()
+    std::unordered_map<const ContainerObject*, SubTree> subTrees; //weak pointers: *never dereference*!
+
+    std::unordered_map<AFS::FingerPrint, std::pair<size_t /*ref count*/, uint64_t /*file size*/>> copiedFilePrintsL; //all folders
+    std::unordered_map<AFS::FingerPrint, std::pair<size_t /*ref count*/, uint64_t /*file size*/>> copiedFilePrintsR; //
+    int64_t hardLinkBytes = 0; //first copy of each hard link group in copiedFilePrintsL/R
 };
 
+
+SyncStatisticsBuffer::SyncStatisticsBuffer() {}
+SyncStatisticsBuffer::~SyncStatisticsBuffer() {}
+
+
+SyncStatistics SyncStatisticsBuffer::get(const FolderComparison& folderCmp)
+{
+    auto baseBuffersOld = std::move(baseBuffers_); //discard buffers of removed folder pairs
+    baseBuffers_.clear();
+
+    std::vector<std::pair<const BaseFolderPair*, BaseFolderBuffer*>> workload;
+
+    std::for_each(begin(folderCmp), end(folderCmp), [&](const BaseFolderPair& baseFolder)
+    {
+        std::unique_ptr<BaseFolderBuffer>& buf = baseBuffers_[&baseFolder];
+        if (auto it = baseBuffersOld.find(&baseFolder);
+            it != baseBuffersOld.end())
+            buf = std::move(it->second);
+        else
+            buf = std::make_unique<BaseFolderBuffer>();
+
+        if (!buf->isUpToDate(baseFolder)) //perf: don't start threads for unchanged folder pairs
+            workload.emplace_back(&baseFolder, buf.get());
+    });
+
+    runParallel(workload.size(), [&](size_t pos) { workload[pos].second->evaluate(*workload[pos].first); }); //one thread per changed folder pair
+
+    SyncStatistics st;
+    std::for_each(begin(folderCmp), end(folderCmp), [&](const BaseFolderPair& baseFolder)
+    {
+        baseBuffers_.find(&baseFolder)->second->addTo(st, baseFolder);
+    });
+    return st;
+}
+
 //-----------------------------------------------------------------------------------------------------------
 
 std::vector<FolderPairSyncCfg> fff::extractSyncCfg(const MainConfiguration& mainCfg)
@@ -428,6 +701,34 @@ std::optional<SelectSide> getTargetDirection(SyncOperation syncOp)
 }
 
 
+template <SelectSide side>
+void commitFolderSnapshot(BaseFolderPair& baseFolder, PhaseCallback& callback) //throw X
+{
+    const std::string& snapshotId = baseFolder.getSnapshotId<side>();
+    if (snapshotId.empty())
+        return;
+
+    const Zstring& nativePath = getNativeItemPath(baseFolder.getAbstractPath<side>());
+    if (nativePath.empty())
+        return;
+
+    //items sync.ffs_db doesn't know about yet (failed, excluded from sync, conflicts): must be read again next time
+    std::vector<Zstring> unsyncedRelPaths;
+    auto onFsItem = [&](const FileSystemObject& fsObj)
+    {
+        if (fsObj.getCategory() != FILE_EQUAL && !fsObj.isEmpty<side>())
+            unsyncedRelPaths.push_back(fsObj.getRelativePath<side>());
+    };
+    visitLoadedFSObjectsRecursively(baseFolder, onFsItem, onFsItem, onFsItem); //spilled sub trees: equal items only
+
+    try
+    {
+        commitSnapshot(nativePath, AFS::getInitPathPhrase(baseFolder.getAbstractPath<getOtherSide<side>>()), snapshotId, unsyncedRelPaths); //throw FileError
+    }
+    catch (const FileError& e) { callback.logInfo(e.toString()); } //throw X; not fatal: next comparison just reads all folders
+}
+
+
 //test if user accidentally selected the wrong folders to sync
 bool significantDifferenceDetected(const SyncStatistics& folderPairStat)
 {
@@ -459,20 +760,71 @@ void flushFileBuffers(const Zstring& nativeFilePath) //throw FileError
 
     if (::fsync(fdFile) != 0)
         THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(nativeFilePath)), "fsync");
+
+    //pages are clean after fsync() => evict them, so that verification reads from disk instead of the page cache
+    [[maybe_unused]] const int rv = ::posix_fadvise(fdFile, 0 /*offset*/, 0 /*len: all*/, POSIX_FADV_DONTNEED); //"advice": failure doesn't matter
+}
+
+
+//--------------------- durability -------------------------
+//one syncfs() per file system instead of an fsync() per file: crash-consistent backups even on spinning disks
+void flushFileSystemBuffers(const std::vector<AbstractPath>& folderPaths, ProcessCallback& callback) //throw X
+{
+    std::set<dev_t> devicesFlushed;
+
+    for (const AbstractPath& folderPath : folderPaths)
+        if (const Zstring& folderPathNative = getNativeItemPath(folderPath); //no equivalent for SFTP, FTP, Google Drive, MTP
+            !folderPathNative.empty())
+            tryReportingError([&]
+        {
+            const int fdDir = ::open(folderPathNative.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+            if (fdDir == -1)
+            {
+                if (errno == ENOENT) //e.g. versioning folder: nothing was written
+                    return;
+                THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot open directory %x."), L"%x", fmtPath(folderPathNative)), "open");
+            }
+            ZEN_ON_SCOPE_EXIT(::close(fdDir));
+
+            struct stat folderInfo = {};
+            if (::fstat(fdDir, &folderInfo) != 0)
+                THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot read file attributes of %x."), L"%x", fmtPath(folderPathNative)), "fstat");
+
+            if (!devicesFlushed.insert(folderInfo.st_dev).second) //same file system as a previous folder
+                return;
+
+            callback.updateStatus(replaceCpy(_("Flushing file system buffers of %x..."), L"%x", fmtPath(folderPathNative))); //throw X
+
+            if (::syncfs(fdDir) != 0)
+                THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot write file system buffers of %x."), L"%x", fmtPath(folderPathNative)), "syncfs");
+        }, callback); //throw X
 }
 
 
-void verifyFiles(const AbstractPath& sourcePath, const AbstractPath& targetPath, const IoCallback& notifyUnbufferedIO /*throw X*/) //throw FileError, X
+//sourceHash: hash of the copied source content (see AFS::FileCopyResult::sourceHash); empty: compare by reading both files
+void verifyFiles(const AbstractPath& sourcePath, const AbstractPath& targetPath, HashAlgorithm hashAlgo, const std::string& sourceHash, //throw FileError, X
+                 const IoCallback& notifyUnbufferedIO /*throw X*/)
 {
     try
     {
-        //do like "copy /v": 1. flush target file buffers, 2. read again as usual (using OS buffers)
-        // => it seems OS buffers are not invalidated by this: snake oil???
+        //do like "copy /v": 1. flush target file buffers, 2. read again (from disk, not OS buffers)
         if (const Zstring& targetPathNative = getNativeItemPath(targetPath);
             !targetPathNative.empty())
             flushFileBuffers(targetPathNative); //throw FileError
 
-        if (!filesHaveSameContent(sourcePath, targetPath, notifyUnbufferedIO)) //throw FileError, X
+        const bool sameContent = [&]
+        {
+            if (sourceHash.empty())
+                return filesHaveSameContent(sourcePath, targetPath, notifyUnbufferedIO); //throw FileError, X
+
+            //source was hashed during copy => only read target (or even let the server do the hashing)
+            std::optional<std::string> targetHash = AFS::getServerFileHash(targetPath, hashAlgo);
+            if (!targetHash)
+                targetHash = calcFileHash(targetPath, hashAlgo, notifyUnbufferedIO); //throw FileError, X
+            return equalAsciiNoCase(*targetHash, sourceHash);
+        }();
+
+        if (!sameContent)
             throw FileError(replaceCpy(replaceCpy(_("%x and %y have different content."),
                                                   L"%x", L'\n' + fmtPath(AFS::getDisplayPath(sourcePath))),
                                        L"%y", L'\n' + fmtPath(AFS::getDisplayPath(targetPath))));
@@ -513,6 +865,10 @@ inline
 void moveAndRenameItem(const AbstractPath& pathFrom, const AbstractPath& pathTo, std::mutex& singleThread) //throw FileError, ErrorMoveUnsupported
 { parallelScope([pathFrom, pathTo] { AFS::moveAndRenameItem(pathFrom, pathTo); /*throw FileError, ErrorMoveUnsupported*/ }, singleThread); }
 
+inline
+void setModTime(const AbstractPath& ap, time_t modTime, std::mutex& singleThread) //throw FileError
+{ parallelScope([ap, modTime] { AFS::setModTime(ap, modTime); /*throw FileError*/ }, singleThread); }
+
 inline
 AbstractPath getSymlinkResolvedPath(const AbstractPath& ap, std::mutex& singleThread) //throw FileError
 { return parallelScope([ap] { return AFS::getSymlinkResolvedPath(ap); /*throw FileError*/ }, singleThread); }
@@ -545,16 +901,26 @@ AFS::FileCopyResult copyFileTransactional(const AbstractPath& apSource, const AF
                                           const AbstractPath& apTarget,
                                           bool copyFilePermissions,
                                           bool transactionalCopy,
+                                          bool deltaCopy,
+                                          std::optional<uint64_t> resumableCopy,
                                           const std::function<void()>& onDeleteTargetFile /*throw X*/,
                                           const IoCallback& notifyUnbufferedIO /*throw X*/,
+                                          std::optional<HashAlgorithm> sourceHashAlgo,
                                           std::mutex& singleThread)
 {
     return parallelScope([=]
     {
-        return AFS::copyFileTransactional(apSource, attrSource, apTarget, copyFilePermissions, transactionalCopy, onDeleteTargetFile, notifyUnbufferedIO); //throw FileError, ErrorFileLocked, X
+        return AFS::copyFileTransactional(apSource, attrSource, apTarget, copyFilePermissions, transactionalCopy, deltaCopy, resumableCopy, //throw FileError, ErrorFileLocked, X
+                                          onDeleteTargetFile, notifyUnbufferedIO, sourceHashAlgo);
     }, singleThread);
 }
 
+inline
+std::vector<AFS::FileCopyResult> uploadFileBatch(const AbstractPath& apTargetFolder, const std::vector<AFS::BatchUploadItem>& items, //throw FileError, ErrorFileLocked, X
+                                                 const IoCallback& notifyUnbufferedIO /*throw X*/,
+                                                 std::mutex& singleThread)
+{ return parallelScope([=] { return AFS::uploadFileBatch(apTargetFolder, items, notifyUnbufferedIO); /*throw FileError, ErrorFileLocked, X*/ }, singleThread); }
+
 inline //RecycleSession::recycleItemIfExists() is internally synchronized!
 void recycleItemIfExists(AFS::RecycleSession& recyclerSession, const AbstractPath& ap, const Zstring& logicalRelPath, std::mutex& singleThread) //throw FileError
 { parallelScope([=, &recyclerSession] { return recyclerSession.recycleItemIfExists(ap, logicalRelPath); /*throw FileError*/ }, singleThread); }
@@ -577,8 +943,9 @@ void revisionFolder(FileVersioner& versioner,
 { parallelScope([=, &versioner] { versioner.revisionFolder(folderPath, relativePath, onBeforeFileMove, onBeforeFolderMove, notifyUnbufferedIO); /*throw FileError, X*/ }, singleThread); }
 
 inline
-void verifyFiles(const AbstractPath& apSource, const AbstractPath& apTarget, const IoCallback& notifyUnbufferedIO /*throw X*/, std::mutex& singleThread) //throw FileError, X
-{ parallelScope([=] { ::verifyFiles(apSource, apTarget, notifyUnbufferedIO); /*throw FileError, X*/ }, singleThread); }
+void verifyFiles(const AbstractPath& apSource, const AbstractPath& apTarget, HashAlgorithm hashAlgo, const std::string& sourceHash, //throw FileError, X
+                 const IoCallback& notifyUnbufferedIO /*throw X*/, std::mutex& singleThread)
+{ parallelScope([=] { ::verifyFiles(apSource, apTarget, hashAlgo, sourceHash, notifyUnbufferedIO); /*throw FileError, X*/ }, singleThread); }
 
 }
 
@@ -592,9 +959,10 @@ public:
                     DeletionPolicy deletionPolicy,
                     const AbstractPath& versioningFolderPath,
                     VersioningStyle versioningStyle,
+                    bool compressVersions,
                     time_t syncStartTime);
 
-    //clean-up temporary directory (recycle bin optimization)
+    //clean-up temporary directory (recycle bin optimization), complete asynchronous versioning
     void tryCleanup(PhaseCallback& cb /*throw X*/); //throw X
 
     void removeDirWithCallback (const AbstractPath&   dirPath,   const Zstring& relativePath, AsyncItemStatReporter& statReporter, std::mutex& singleThread); //
@@ -605,6 +973,8 @@ public:
     const std::wstring& getTxtRemovingFolder () const { return txtRemovingFolder_;  } //buffered status texts
     const std::wstring& getTxtRemovingSymLink() const { return txtRemovingSymlink_; } //
 
+    std::vector<VersionItem> extractNewVersions() const { return versioner_ ? versioner_->extractNewVersions() : std::vector<VersionItem>(); }
+
 private:
     DeletionHandler           (const DeletionHandler&) = delete;
     DeletionHandler& operator=(const DeletionHandler&) = delete;
@@ -621,7 +991,7 @@ private:
     {
         assert(deletionPolicy_ == DeletionPolicy::versioning);
         if (!versioner_)
-            versioner_ = std::make_unique<FileVersioner>(versioningFolderPath_, versioningStyle_, syncStartTime_); //throw FileError
+            versioner_ = std::make_unique<FileVersioner>(versioningFolderPath_, versioningStyle_, compressVersions_, syncStartTime_, baseFolderPath_); //throw FileError
         return *versioner_;
     }
 
@@ -633,6 +1003,7 @@ private:
     //used only for DeletionPolicy::versioning:
     const AbstractPath versioningFolderPath_;
     const VersioningStyle versioningStyle_;
+    const bool compressVersions_;
     const time_t syncStartTime_;
     std::unique_ptr<FileVersioner> versioner_;
 
@@ -649,11 +1020,13 @@ DeletionHandler::DeletionHandler(const AbstractPath& baseFolderPath, //nothrow!
                                  DeletionPolicy deletionPolicy,
                                  const AbstractPath& versioningFolderPath,
                                  VersioningStyle versioningStyle,
+                                 bool compressVersions,
                                  time_t syncStartTime) :
     deletionPolicy_(deletionPolicy),
     baseFolderPath_(baseFolderPath),
     versioningFolderPath_(versioningFolderPath),
     versioningStyle_(versioningStyle),
+    compressVersions_(compressVersions),
     syncStartTime_(syncStartTime),
     //*INDENT-OFF*
     txtRemovingFile_([&]
@@ -708,8 +1081,12 @@ void DeletionHandler::tryCleanup(PhaseCallback& cb /*throw X*/) //throw X
             }
             break;
 
-        case DeletionPolicy::permanent:
         case DeletionPolicy::versioning:
+            if (versioner_)
+                versioner_->finishAsyncVersioning(cb); //throw X
+            break;
+
+        case DeletionPolicy::permanent:
             break;
     }
 }
@@ -726,7 +1103,7 @@ void DeletionHandler::removeDirWithCallback(const AbstractPath& folderPath,//thr
             //callbacks run *outside* singleThread_ lock! => fine
             auto notifyDeletion = [&statReporter](const std::wstring& statusText, const std::wstring& displayPath)
             {
-                statReporter.updateStatus(replaceCpy(statusText, L"%x", fmtPath(displayPath))); //throw ThreadStopRequest
+                statReporter.updateStatus(statusText, displayPath); //throw ThreadStopRequest
                 statReporter.reportDelta(1, 0); //it would be more correct to report *after* work was done!
                 //OTOH: ThreadStopRequest must not happen just after last deletion was successful: allow for transactional file model update!
             };
@@ -748,7 +1125,7 @@ void DeletionHandler::removeDirWithCallback(const AbstractPath& folderPath,//thr
             //callbacks run *outside* singleThread_ lock! => fine
             auto notifyMove = [&statReporter](const std::wstring& statusText, const std::wstring& displayPathFrom, const std::wstring& displayPathTo)
             {
-                statReporter.updateStatus(replaceCpy(replaceCpy(statusText, L"%x", L'\n' + fmtPath(displayPathFrom)), L"%y", L'\n' + fmtPath(displayPathTo))); //throw ThreadStopRequest
+                statReporter.updateStatus(statusText, displayPathFrom, displayPathTo); //throw ThreadStopRequest
                 statReporter.reportDelta(1, 0); //it would be more correct to report *after* work was done!
             };
             static_assert(std::is_const_v<decltype(txtMovingFileXtoY_)>, "callbacks better be thread-safe!");
@@ -820,10 +1197,77 @@ void DeletionHandler::removeLinkWithCallback(const AbstractPath& linkPath, //thr
 //===================================================================================================
 //===================================================================================================
 
+//fixed costs per item (latency, metadata) in bytes: consider many small files as well as few big ones
+constexpr int64_t ITEM_COST_BYTES = 64 * 1024;
+
+
+//hill climbing: change number of active threads while throughput improves; reverse direction otherwise
+class ParallelOpsTuner
+{
+public:
+    explicit ParallelOpsTuner(size_t opsMax) : opsMax_(opsMax), opsLimit_(std::min<size_t>(opsMax, 2)) { assert(opsMax > 0); }
+
+    size_t getLimit() const { return opsLimit_; }
+
+    //return true if limit was increased
+    bool update(const std::pair<int64_t, int64_t>& dataProcessed /*items, bytes*/, std::chrono::steady_clock::time_point now)
+    {
+        if (sampleStartTime_ == std::chrono::steady_clock::time_point()) //first call
+        {
+            sampleStartTime_ = now;
+            sampleStartData_ = dataProcessed;
+            return false;
+        }
+
+        const auto elapsed = now - sampleStartTime_;
+        if (elapsed < SAMPLE_DURATION)
+            return false;
+
+        //count fixed costs per item, too
+        const double throughput = ((dataProcessed.first  - sampleStartData_.first) * ITEM_COST_BYTES +
+                                   (dataProcessed.second - sampleStartData_.second)) / std::chrono::duration<double>(elapsed).count();
+        sampleStartTime_ = now;
+        sampleStartData_ = dataProcessed;
+
+        if (throughputLast_ >= 0 && throughput < throughputLast_ * (1 + IMPROVEMENT_MIN))
+            grow_ = !grow_; //no significant improvement => try other direction
+        throughputLast_ = throughput;
+
+        const size_t opsLimitOld = opsLimit_;
+        if (grow_)
+            opsLimit_ = std::min(opsLimit_ + 1, opsMax_);
+        else
+            opsLimit_ = std::max<size_t>(opsLimit_ - 1, 1);
+
+        if (opsLimit_ == opsLimitOld) //at the bounds
+            grow_ = !grow_;
+
+        return opsLimit_ > opsLimitOld;
+    }
+
+private:
+    static constexpr std::chrono::seconds SAMPLE_DURATION{3};
+    static constexpr double IMPROVEMENT_MIN = 0.05;
+
+    const size_t opsMax_;
+    size_t opsLimit_;
+    bool grow_ = true;
+
+    std::chrono::steady_clock::time_point sampleStartTime_;
+    std::pair<int64_t, int64_t> sampleStartData_;
+    double throughputLast_ = -1;
+};
+
+
 class Workload
 {
 public:
-    Workload(size_t threadCount, AsyncCallback& acb) : acb_(acb), workload_(threadCount) { assert(threadCount > 0); }
+    Workload(size_t threadCount, bool autoTuneThreads, AsyncCallback& acb) : acb_(acb), workload_(threadCount)
+    {
+        assert(threadCount > 0);
+        if (autoTuneThreads && threadCount > 1)
+            opsTuner_.emplace(threadCount);
+    }
 
     using WorkItem  = std::function<void() /*throw ThreadStopRequest*/>;
     using WorkItems = RingBuffer<WorkItem>; //FIFO!
@@ -834,8 +1278,30 @@ public:
         interruptionPoint(); //throw ThreadStopRequest
 
         std::unique_lock dummy(lockWork_);
+
+        if (opsTuner_ && opsTuner_->update(acb_.getDataProcessedSum(), std::chrono::steady_clock::now()))
+            conditionNewWork_.notify_all(); //wake threads that have become active
+
         for (;;)
         {
+            if (threadIdx >= getActiveLimit()) //wait until thread becomes active again
+            {
+                if (++idleThreads_ == workload_.size() && delayedWorkload_.empty())
+                    notifyAllDone(); //noexcept
+                ZEN_ON_SCOPE_EXIT(--idleThreads_);
+
+                interruptibleWait(conditionNewWork_, dummy, [&] { return threadIdx < getActiveLimit(); }); //throw ThreadStopRequest
+                continue;
+            }
+
+            //automatic retries first: their delay has passed already
+            if (haveDelayedWorkDue())
+                return getNextDelayed();
+
+            //large files first: avoid a long tail of a single thread copying a huge file at the end, but keep one thread to progress the hierarchy
+            if (!largeWorkload_.empty() && largeItemsActive_ + 1 < getActiveLimit())
+                return getNextLarge();
+
             if (!workload_[threadIdx].empty())
             {
                 auto wi = std::move(workload_[threadIdx].    front());
@@ -865,16 +1331,19 @@ public:
                             items.push_back(std::move(wi));
                     }
                 }
+                else if (!largeWorkload_.empty())
+                    return getNextLarge();
                 else //wait...
                 {
-                    if (++idleThreads_ == workload_.size())
-                        acb_.notifyAllDone(); //noexcept
+                    if (++idleThreads_ == workload_.size() && delayedWorkload_.empty()) //pending retries: not done yet!
+                        notifyAllDone(); //noexcept
                     ZEN_ON_SCOPE_EXIT(--idleThreads_);
 
-                    auto haveNewWork = [&] { return !pendingWorkload_.empty() || std::any_of(workload_.begin(), workload_.end(), [](const WorkItems& wi) { return !wi.empty(); }); };
+                    auto haveNewWork = [&] { return !pendingWorkload_.empty() || !largeWorkload_.empty() || haveDelayedWorkDue() || std::any_of(workload_.begin(), workload_.end(), [](const WorkItems& wi) { return !wi.empty(); }); };
 
                     interruptibleWait(conditionNewWork_, dummy, [&] { return haveNewWork(); }); //throw ThreadStopRequest
                     //it's sufficient to notify condition in addWorkItems() only (as long as we use std::condition_variable::notify_all())
+                    //delayed work items: interruptibleWait() re-evaluates the predicate every millisecond => no notification needed when they become due
                 }
             }
         }
@@ -893,28 +1362,241 @@ public:
         conditionNewWork_.notify_all();
     }
 
-private:
-    Workload           (const Workload&) = delete;
-    Workload& operator=(const Workload&) = delete;
-
-    AsyncCallback& acb_;
-
-    std::mutex lockWork_;
-    std::condition_variable conditionNewWork_;
+    //served largest first, ahead of the hierarchy order (except for one thread)
+    void addLargeWorkItem(uint64_t bytes, WorkItem&& wi)
+    {
+        {
+            std::lock_guard dummy(lockWork_);
+            largeWorkload_.emplace(bytes, std::move(wi));
+        }
+        conditionNewWork_.notify_all();
+    }
+
+    //automatic retry: served once the delay has passed => worker threads continue with other items in the meantime
+    void addDelayedWorkItem(std::chrono::steady_clock::time_point notBefore, WorkItem&& wi)
+    {
+        std::lock_guard dummy(lockWork_);
+        delayedWorkload_.emplace(notBefore, std::move(wi));
+    }
+
+    static constexpr uint64_t LARGE_ITEM_BYTES_MIN = 64 * 1024 * 1024;
+
+    size_t getThreadCount() const { return workload_.size(); }
+
+    std::chrono::steady_clock::time_point getTimeAllDone()
+    {
+        std::lock_guard dummy(lockWork_);
+        return timeAllDone_;
+    }
+
+private:
+    Workload           (const Workload&) = delete;
+    Workload& operator=(const Workload&) = delete;
+
+    void notifyAllDone() //context of worker thread, lockWork_ held
+    {
+        timeAllDone_ = std::chrono::steady_clock::now(); //concurrent folder pairs: sync time of *this* folder pair
+        acb_.notifyAllDone(); //noexcept
+    }
+
+    size_t getActiveLimit() const { return opsTuner_ ? opsTuner_->getLimit() : workload_.size(); }
+
+    bool haveDelayedWorkDue() const //lockWork_ held
+    {
+        return !delayedWorkload_.empty() && delayedWorkload_.begin()->first <= std::chrono::steady_clock::now();
+    }
+
+    WorkItem getNextDelayed() //context of worker thread, lockWork_ held
+    {
+        auto it = delayedWorkload_.begin();
+        WorkItem wi = std::move(it->second);
+        delayedWorkload_.erase(it);
+        return wi;
+    }
+
+    WorkItem getNextLarge() //context of worker thread, lockWork_ held
+    {
+        auto it = largeWorkload_.begin();
+        WorkItem wi = std::move(it->second);
+        largeWorkload_.erase(it);
+
+        ++largeItemsActive_;
+        return [this, wi = std::move(wi)]
+        {
+            ZEN_ON_SCOPE_EXIT({ std::lock_guard dummy(lockWork_); --largeItemsActive_; });
+            wi(); //throw ThreadStopRequest
+        };
+    }
+
+    AsyncCallback& acb_;
+
+    std::mutex lockWork_;
+    std::condition_variable conditionNewWork_;
 
     size_t idleThreads_ = 0;
 
     std::vector<WorkItems> workload_; //thread-specific buckets
     RingBuffer<WorkItems> pendingWorkload_; //FIFO: buckets of work items for use by any thread
+
+    std::multimap<uint64_t /*bytes*/, WorkItem, std::greater<>> largeWorkload_;
+    size_t largeItemsActive_ = 0;
+
+    std::multimap<std::chrono::steady_clock::time_point /*not before*/, WorkItem> delayedWorkload_;
+
+    std::optional<ParallelOpsTuner> opsTuner_; //only thread indexes below limit get work
+
+    std::chrono::steady_clock::time_point timeAllDone_;
 };
 
 
-template <class List> inline
-bool haveNameClash(const Zstring& itemName, const List& m)
+/* hard links: recreate link groups on the target instead of copying the same inode N times (e.g. rsnapshot-style backups)
+    - native on both sides only: file print == inode number
+    - candidates: file prints found more than once on the source side => no extra syscalls for all the other files
+    - first copy wins: the remaining items of the group are linked to its target file
+    - items already in sync can serve as link target, too (like rsync -H)
+    - inode numbers are unique per device only: verify st_dev + st_ino before linking (nested mount points!)      */
+class HardLinkTracker
 {
-    return std::any_of(m.begin(), m.end(),
-    [&](const typename List::value_type& obj) { return equalNoCase(obj.getItemNameAny(), itemName); }); //equalNoCase: when in doubt => assume name clash!
-}
+public:
+    explicit HardLinkTracker(BaseFolderPair& baseFolder)
+    {
+        if (getNativeItemPath(baseFolder.getAbstractPath<SelectSide::left >()).empty() ||
+            getNativeItemPath(baseFolder.getAbstractPath<SelectSide::right>()).empty())
+            return;
+
+        std::vector<AFS::FingerPrint> filePrintsL;
+        std::vector<AFS::FingerPrint> filePrintsR;
+        //out-of-core comparison: don't reload spilled sub trees => their (equal) files are not used as link targets
+        visitLoadedFSObjectsRecursively(baseFolder, [](FolderPair&) {}, [&](FilePair& file)
+        {
+            if (!file.isEmpty<SelectSide::left >() && file.getFilePrint<SelectSide::left >() != 0) filePrintsL.push_back(file.getFilePrint<SelectSide::left >());
+            if (!file.isEmpty<SelectSide::right>() && file.getFilePrint<SelectSide::right>() != 0) filePrintsR.push_back(file.getFilePrint<SelectSide::right>());
+        },
+        [](SymlinkPair&) {});
+
+        auto getDuplicates = [](std::vector<AFS::FingerPrint>& filePrints)
+        {
+            std::sort(filePrints.begin(), filePrints.end());
+
+            std::unordered_map<AFS::FingerPrint, LinkGroup> linkGroups;
+            for (auto it = filePrints.begin(); (it = std::adjacent_find(it, filePrints.end())) != filePrints.end(); ++it)
+                linkGroups[*it];
+            return linkGroups;
+        };
+        linkGroups_.access([&](auto& linkGroups)
+        {
+            linkGroups.first  = getDuplicates(filePrintsL);
+            linkGroups.second = getDuplicates(filePrintsR);
+        });
+
+        //seed with items already in sync:
+        visitLoadedFSObjectsRecursively(baseFolder, [](FolderPair&) {}, [&](FilePair& file)
+        {
+            if (file.getSyncOperation() == SO_EQUAL)
+            {
+                registerCopy<SelectSide::left >(file);
+                registerCopy<SelectSide::right>(file);
+            }
+        },
+        [](SymlinkPair&) {});
+    }
+
+    //target file of the same link group (if any) => create hard link instead of copying
+    //returns std::nullopt if not part of a link group, or linking is not possible => caller falls back to regular copy
+    template <SelectSide sideSrc>
+    std::optional<AFS::FileCopyResult> tryCreateHardLink(const FilePair& file) //throw FileError
+    {
+        constexpr SelectSide sideTrg = getOtherSide<sideSrc>;
+
+        const std::optional<LinkGroup> linkGroup = getLinkGroup<sideSrc>(file);
+        if (!linkGroup || linkGroup->sourcePathNative.empty())
+            return std::nullopt;
+
+        const Zstring sourcePathNative = getNativeItemPath(file.getAbstractPath<sideSrc>());
+        const Zstring targetPathNative = getNativeItemPath(file.getAbstractPath<sideTrg>());
+        assert(!sourcePathNative.empty() && !targetPathNative.empty());
+
+        struct stat sourceInfo = {};
+        struct stat groupSourceInfo = {};
+        if (::stat(sourcePathNative.c_str(), &sourceInfo) != 0)
+            THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot read file attributes of %x."), L"%x", fmtPath(sourcePathNative)), "stat");
+
+        if (::stat(linkGroup->sourcePathNative.c_str(), &groupSourceInfo) != 0 || //group's source file renamed/deleted in the meantime?
+            sourceInfo.st_dev != groupSourceInfo.st_dev ||
+            sourceInfo.st_ino != groupSourceInfo.st_ino) //same inode number on different devices
+            return std::nullopt;
+
+        if (::link(linkGroup->targetPathNative.c_str(), targetPathNative.c_str()) != 0)
+        {
+            if (errno == EXDEV  || //target base folder spans multiple devices
+                errno == EPERM  || //file system does not support hard links (e.g. FAT)
+                errno == EMLINK || //maximum number of links exceeded
+                errno == ENOENT || //group's target file deleted in the meantime?
+                errno == EOPNOTSUPP)
+                return std::nullopt;
+
+            THROW_LAST_FILE_ERROR(replaceCpy(replaceCpy(_("Cannot create hard link %x to %y."), L"%x", L'\n' + fmtPath(targetPathNative)),
+                                             L"%y", L'\n' + fmtPath(linkGroup->targetPathNative)), "link");
+        }
+
+        struct stat targetInfo = {};
+        if (::stat(targetPathNative.c_str(), &targetInfo) != 0)
+            THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot read file attributes of %x."), L"%x", fmtPath(targetPathNative)), "stat");
+
+        AFS::FileCopyResult result;
+        result.fileSize = targetInfo.st_size;
+        result.modTime  = targetInfo.st_mtime; //same inode as the group's first copy => modification time was set from source already
+        result.sourceFilePrint = sourceInfo.st_ino; //same as native.cpp getFileFingerprint()
+        result.targetFilePrint = targetInfo.st_ino;
+        return result;
+    }
+
+    //call after file was copied to "sideTrg"
+    template <SelectSide sideSrc>
+    void registerCopy(const FilePair& file)
+    {
+        constexpr SelectSide sideTrg = getOtherSide<sideSrc>;
+
+        linkGroups_.access([&](auto& linkGroups)
+        {
+            auto& linkGroupsSrc = selectParam<sideSrc>(linkGroups.first, linkGroups.second);
+            if (auto it = linkGroupsSrc.find(file.getFilePrint<sideSrc>());
+                it != linkGroupsSrc.end() && it->second.sourcePathNative.empty()) //first copy wins
+                it->second =
+            {
+                getNativeItemPath(file.getAbstractPath<sideSrc>()),
+                getNativeItemPath(file.getAbstractPath<sideTrg>())
+            };
+        });
+    }
+
+private:
+    HardLinkTracker           (const HardLinkTracker&) = delete;
+    HardLinkTracker& operator=(const HardLinkTracker&) = delete;
+
+    struct LinkGroup
+    {
+        Zstring sourcePathNative; //empty: no copy yet
+        Zstring targetPathNative;
+    };
+
+    template <SelectSide sideSrc>
+    std::optional<LinkGroup> getLinkGroup(const FilePair& file)
+    {
+        return linkGroups_.access([&](auto& linkGroups) -> std::optional<LinkGroup>
+        {
+            auto& linkGroupsSrc = selectParam<sideSrc>(linkGroups.first, linkGroups.second);
+            if (auto it = linkGroupsSrc.find(file.getFilePrint<sideSrc>());
+                it != linkGroupsSrc.end())
+                return it->second;
+            return std::nullopt;
+        });
+    }
+
+    //source side left, right => worker threads access in parallel
+    Protected<std::pair<std::unordered_map<AFS::FingerPrint, LinkGroup>,
+              std::unordered_map<AFS::FingerPrint, LinkGroup>>> linkGroups_;
+};
 
 
 class FolderPairSyncer
@@ -925,16 +1607,39 @@ public:
         bool verifyCopiedFiles;
         bool copyFilePermissions;
         bool failSafeFileCopy;
+        uint64_t deltaCopyMinSize; //0: disabled
+        uint64_t resumableCopyMinSize; //
         std::vector<FileError>& errorsModTime;
         DeletionHandler& delHandlerLeft;
         DeletionHandler& delHandlerRight;
+        HardLinkTracker& hardLinks;
+        size_t threadCount;
+        bool autoTuneThreads; //threadCount is upper limit
+        IoPriority ioPriority;
+        const std::map<AfsDevice, std::unique_ptr<BandwidthLimiter>>& bandwidthLimiters; //shared by all folder pairs on the same device
+        DeviceBudget* deviceBudget; //optional: shared with other processes
+        size_t autoRetryCount;
+        std::chrono::seconds autoRetryDelay;
     };
 
-    static void runSync(SyncCtx& syncCtx, BaseFolderPair& baseFolder, PhaseCallback& cb)
+    using FolderPairList = std::vector<std::pair<SyncCtx*, BaseFolderPair*>>;
+
+    //independent folder pairs run concurrently, each with its own worker threads; a pass starts only after all pairs finished the previous one
+    //return sync time per folder pair: excluding the wait for other folder pairs
+    static std::vector<std::chrono::nanoseconds> runSync(const FolderPairList& folderPairs, PhaseCallback& cb) //throw X
     {
-        runPass(PassNo::zero, syncCtx, baseFolder, cb); //prepare file moves
-        runPass(PassNo::one,  syncCtx, baseFolder, cb); //delete files (or overwrite big ones with smaller ones)
-        runPass(PassNo::two,  syncCtx, baseFolder, cb); //copy rest
+        std::vector<std::chrono::nanoseconds> syncTimes(folderPairs.size());
+
+        for (const PassNo pass : {PassNo::zero,    //prepare file moves
+                                  PassNo::one,     //delete files (or overwrite big ones with smaller ones)
+                                  PassNo::folders, //create new folders
+                                  PassNo::two})    //copy rest
+        {
+            const std::vector<std::chrono::nanoseconds> passTimes = runPass(pass, folderPairs, cb); //throw X
+            for (size_t i = 0; i < syncTimes.size(); ++i)
+                syncTimes[i] += passTimes[i];
+        }
+        return syncTimes;
     }
 
 private:
@@ -942,70 +1647,129 @@ private:
 
     enum class PassNo
     {
-        zero, //prepare file moves
-        one,  //delete files
-        two,  //create, modify
-        never //skip item
+        zero,    //prepare file moves
+        one,     //delete files
+        folders, //create new folders level by level: file copies of pass two don't wait for parent folder creation
+        two,     //create, modify
+        never    //skip item
     };
 
     FolderPairSyncer(SyncCtx& syncCtx, std::mutex& singleThread, AsyncCallback& acb) :
         errorsModTime_      (syncCtx.errorsModTime),
         delHandlerLeft_     (syncCtx.delHandlerLeft),
         delHandlerRight_    (syncCtx.delHandlerRight),
+        hardLinks_          (syncCtx.hardLinks),
         verifyCopiedFiles_  (syncCtx.verifyCopiedFiles),
         copyFilePermissions_(syncCtx.copyFilePermissions),
         failSafeFileCopy_   (syncCtx.failSafeFileCopy),
+        deltaCopyMinSize_   (syncCtx.deltaCopyMinSize),
+        resumableCopyMinSize_(syncCtx.resumableCopyMinSize),
+        bandwidthLimiters_  (syncCtx.bandwidthLimiters),
+        autoRetryCount_     (syncCtx.autoRetryCount),
+        autoRetryDelay_     (syncCtx.autoRetryDelay),
         singleThread_(singleThread),
         acb_(acb) {}
 
     static PassNo getPass(const FilePair&    file);
     static PassNo getPass(const SymlinkPair& symlink);
     static PassNo getPass(const FolderPair&  folder);
+    static uint64_t getBytesToCopy(const FilePair& file);
     static bool needZeroPass(const FilePair& file);
     static bool needZeroPass(const FolderPair& folder);
 
-    static void runPass(PassNo pass, SyncCtx& syncCtx, BaseFolderPair& baseFolder, PhaseCallback& cb); //throw X
+    static std::vector<std::chrono::nanoseconds> runPass(PassNo pass, const FolderPairList& folderPairs, PhaseCallback& cb); //throw X
 
     RingBuffer<Workload::WorkItems> getFolderLevelWorkItems(PassNo pass, ContainerObject& parentFolder, Workload& workload);
 
+    template <class Function>
+    void syncItemWithAutoRetry(Function syncItem /*throw FileError*/, Workload& workload, size_t retryNumber = 0); //throw ThreadStopRequest
+
     static bool containsMoveTarget(const FolderPair& parent);
     void executeFileMove(FilePair& file); //throw ThreadStopRequest
     template <SelectSide side> void executeFileMoveImpl(FilePair& fileFrom, FilePair& fileTo); //throw ThreadStopRequest
 
+    bool executeFolderMove(FolderPair& folder); //throw ThreadStopRequest
+    template <SelectSide side> bool executeFolderMoveImpl(FolderPair& folderTo); //throw ThreadStopRequest
+    template <SelectSide side> static FolderPair* getFolderMoveSource(FolderPair& folderTo);
+    template <SelectSide side> static bool isFolderMovePair(const FolderPair& folderFrom, const FolderPair& folderTo);
+    template <SelectSide side> static void setFolderMoveSynced(FolderPair& folderFrom, FolderPair& folderTo);
+
     void synchronizeFile(FilePair& file);                                                     //
     template <SelectSide side> void synchronizeFileInt(FilePair& file, SyncOperation syncOp); //throw FileError, ErrorMoveUnsupported, ThreadStopRequest
 
+    template <SelectSide sideTrg> bool isBatchUploadCandidate(FilePair& file);
+    template <SelectSide sideTrg> void addFileBatchWorkItems(const ContainerObject& hierObj, std::vector<FilePair*>& files, RingBuffer<std::function<void()>>& workItems);
+    template <SelectSide sideTrg> void synchronizeFileBatch(const std::vector<FilePair*>& files); //throw ThreadStopRequest
+
     void synchronizeLink(SymlinkPair& symlink);                                                        //
     template <SelectSide sideTrg> void synchronizeLinkInt(SymlinkPair& symlink, SyncOperation syncOp); //throw FileError, ThreadStopRequest
 
     void synchronizeFolder(FolderPair& folder);                                                        //
     template <SelectSide sideTrg> void synchronizeFolderInt(FolderPair& folder, SyncOperation syncOp); //throw FileError, ThreadStopRequest
 
-    void    logInfo(const std::wstring& rawText, const std::wstring& displayPath) { acb_.logInfo   (replaceCpy(rawText, L"%x", fmtPath(displayPath))); }
-    void reportInfo(const std::wstring& rawText, const std::wstring& displayPath) { acb_.reportInfo(replaceCpy(rawText, L"%x", fmtPath(displayPath))); }
+    void    logInfo(const std::wstring& rawText, const std::wstring& displayPath) { acb_.logInfo   (rawText, displayPath); } //throw ThreadStopRequest
+    void reportInfo(const std::wstring& rawText, const std::wstring& displayPath) { acb_.reportInfo(rawText, displayPath); } //formatted lazily
 
-    void logInfo(const std::wstring& rawText, const std::wstring& displayPath1, const std::wstring& displayPath2) //throw ThreadStopRequest
-    {
-        acb_.logInfo(replaceCpy(replaceCpy(rawText, L"%x", L'\n' + fmtPath(displayPath1)), L"%y", L'\n' + fmtPath(displayPath2))); //throw ThreadStopRequest
-    }
-    void reportInfo(const std::wstring& rawText, const std::wstring& displayPath1, const std::wstring& displayPath2) //throw ThreadStopRequest
-    {
-        acb_.reportInfo(replaceCpy(replaceCpy(rawText, L"%x", L'\n' + fmtPath(displayPath1)), L"%y", L'\n' + fmtPath(displayPath2))); //throw ThreadStopRequest
-    }
+    void    logInfo(const std::wstring& rawText, const std::wstring& displayPath1, const std::wstring& displayPath2) { acb_.logInfo   (rawText, displayPath1, displayPath2); } //throw ThreadStopRequest
+    void reportInfo(const std::wstring& rawText, const std::wstring& displayPath1, const std::wstring& displayPath2) { acb_.reportInfo(rawText, displayPath1, displayPath2); } //"%x", "%y" => L'\n' + fmtPath()
 
     //already existing after onDeleteTargetFile(): undefined behavior! (e.g. fail/overwrite/auto-rename)
     AFS::FileCopyResult copyFileWithCallback(const FileDescriptor& sourceDescr, //throw FileError, ThreadStopRequest, X
                                              const AbstractPath& targetPath,
                                              const std::function<void()>& onDeleteTargetFile /*throw X*/, //optional!
+                                             bool deltaCopy, //reuse unchanged blocks of existing target (if supported)
+                                             std::optional<uint64_t> resumableCopy, //see getResumableCopy()
                                              AsyncPercentStatReporter& statReporter);
+
+    //resumable copy: partial temp file left by a previous run, as found by comparison
+    //std::nullopt: not resumable; 0: no partial file
+    template <SelectSide sideSrc>
+    std::optional<uint64_t> getResumableCopy(FilePair& file)
+    {
+        if (resumableCopyMinSize_ == 0 || file.getFileSize<sideSrc>() < resumableCopyMinSize_)
+            return std::nullopt;
+
+        if (const FilePair* partialFile = getResumablePartial<sideSrc>(file))
+            return partialFile->getFileSize<getOtherSide<sideSrc>>();
+        return 0;
+    }
+
+    //copy succeeded: partial temp file was renamed into the target
+    template <SelectSide sideSrc>
+    void discardResumablePartial(FilePair& file)
+    {
+        if (FilePair* partialFile = getResumablePartial<sideSrc>(file))
+            partialFile->removeObject<getOtherSide<sideSrc>>();
+    }
+
+    template <SelectSide sideSrc>
+    static FilePair* getResumablePartial(FilePair& file)
+    {
+        constexpr SelectSide sideTrg = getOtherSide<sideSrc>;
+
+        const Zstring tmpName = AFS::getResumableTempFileName(file.getItemName<sideSrc>(),
+        {file.getLastWriteTime<sideSrc>(), file.getFileSize<sideSrc>(), file.getFilePrint<sideSrc>()});
+
+        for (FilePair& partialFile : file.parent().refSubFiles())
+            if (!partialFile.isEmpty<sideTrg>() && partialFile.getItemName<sideTrg>() == tmpName)
+                return &partialFile;
+        return nullptr;
+    }
+
     std::vector<FileError>& errorsModTime_;
 
     DeletionHandler& delHandlerLeft_;
     DeletionHandler& delHandlerRight_;
+    HardLinkTracker& hardLinks_;
 
     const bool verifyCopiedFiles_;
     const bool copyFilePermissions_;
     const bool failSafeFileCopy_;
+    const uint64_t deltaCopyMinSize_;
+    const uint64_t resumableCopyMinSize_;
+    const std::map<AfsDevice, std::unique_ptr<BandwidthLimiter>>& bandwidthLimiters_;
+    const size_t autoRetryCount_;
+    const std::chrono::seconds autoRetryDelay_;
 
     std::mutex& singleThread_;
     AsyncCallback& acb_;
@@ -1019,6 +1783,7 @@ private:
     const std::wstring txtVerifyingFile_     {_("Verifying file %x"        )};
     const std::wstring txtUpdatingAttributes_{_("Updating attributes of %x")};
     const std::wstring txtMovingFileXtoY_    {_("Moving file %x to %y"     )};
+    const std::wstring txtMovingFolderXtoY_  {_("Moving folder %x to %y"   )};
     const std::wstring txtSourceItemNotExist_{_("Source item %x is not existing")};
 };
 
@@ -1040,41 +1805,78 @@ Callback     =============       --------------------
                                  |     Workload     |
                                  --------------------
 
-Notes: - All threads share a single mutex, unlocked only during file I/O => do NOT require file_hierarchy.cpp classes to be thread-safe (i.e. internally synchronized)!
+Notes: - All threads (of all folder pairs synced concurrently) share a single mutex, unlocked only during file I/O => do NOT require file_hierarchy.cpp classes to be thread-safe (i.e. internally synchronized)!
+       - Independent folder pairs run concurrently: one Workload with its own worker threads per folder pair, all reporting to the same Async Callback
        - Workload holds (folder-level-) items in buckets associated with each worker thread (FTP scenario: avoid CWDs)
        - If a worker is idle, its Workload bucket is empty and no more pending buckets available: steal from other threads (=> take half of largest bucket)
        - Maximize opportunity for parallelization ASAP: Workload buckets serve folder-items *before* files/symlinks => reduce risk of work-stealing
+       - Large file copies are served largest first, before the buckets, by all threads but one => no long tail of a single huge file at the end
        - Memory consumption: work items may grow indefinitely; however: test case "C:\" ~80MB per 1 million work items
 */
 
-void FolderPairSyncer::runPass(PassNo pass, SyncCtx& syncCtx, BaseFolderPair& baseFolder, PhaseCallback& cb) //throw X
+std::vector<std::chrono::nanoseconds> FolderPairSyncer::runPass(PassNo pass, const FolderPairList& folderPairs, PhaseCallback& cb) //throw X
 {
-    std::mutex singleThread; //only a single worker thread may run at a time, except for parallel file I/O
+    const auto passStartTime = std::chrono::steady_clock::now();
+
+    std::mutex singleThread; //only a single worker thread may run at a time, except for parallel file I/O: shared by *all* folder pairs
 
-    AsyncCallback acb;                                //
-    FolderPairSyncer fps(syncCtx, singleThread, acb); //manage life time: enclose InterruptibleThread's!!!
-    Workload workload(1, acb);
-    workload.addWorkItems(fps.getFolderLevelWorkItems(pass, baseFolder, workload)); //initial workload: set *before* threads get access!
+    AsyncCallback acb(folderPairs.size()); //one Workload per folder pair
+    std::vector<std::unique_ptr<FolderPairSyncer>> syncers;  //manage life time: enclose InterruptibleThread's!!!
+    std::vector<std::unique_ptr<Workload>>         workloads; //
+
+    for (const auto& [syncCtx, baseFolder] : folderPairs)
+    {
+        FolderPairSyncer& fps = *syncers.emplace_back(new FolderPairSyncer(*syncCtx, singleThread, acb));
+        //auto-tuning sees the throughput of all concurrent folder pairs: good enough, they compete for the same CPU and network anyway
+        Workload& workload = *workloads.emplace_back(std::make_unique<Workload>(syncCtx->threadCount, syncCtx->autoTuneThreads, acb));
+        workload.addWorkItems(fps.getFolderLevelWorkItems(pass, *baseFolder, workload)); //initial workload: set *before* threads get access!
+    }
 
     std::vector<InterruptibleThread> worker;
     ZEN_ON_SCOPE_EXIT( for (InterruptibleThread& wt : worker) wt.requestStop(); ); //stop *all* at the same time before join!
 
-    size_t threadIdx = 0;
-    Zstring threadName = Zstr("Sync Worker");
-        worker.emplace_back([threadIdx, &singleThread, &acb, &workload, threadName = std::move(threadName)]
+    for (size_t pairIdx = 0; pairIdx < folderPairs.size(); ++pairIdx)
+    {
+        const SyncCtx& syncCtx = *folderPairs[pairIdx].first;
+        Workload& workload = *workloads[pairIdx];
+
+        for (size_t threadIdx = 0; threadIdx < syncCtx.threadCount; ++threadIdx)
         {
-            setCurrentThreadName(threadName);
+            Zstring threadName = Zstr("Sync Worker");
+            if (folderPairs.size() > 1)
+                threadName += Zstr(" #") + numberTo<Zstring>(pairIdx + 1);
+            if (syncCtx.threadCount > 1)
+                threadName += Zstr('[') + numberTo<Zstring>(threadIdx + 1) + Zstr('/') + numberTo<Zstring>(syncCtx.threadCount) + Zstr(']');
 
-            while (/*blocking call:*/ std::function<void()> workItem = workload.getNext(threadIdx)) //throw ThreadStopRequest
+            worker.emplace_back([threadIdx, &singleThread, &acb, &workload, ioPriority = syncCtx.ioPriority, deviceBudget = syncCtx.deviceBudget, threadName = std::move(threadName)]
             {
-                acb.notifyTaskBegin(0 /*prio*/); //same prio, while processing only one folder pair at a time
-                ZEN_ON_SCOPE_EXIT(acb.notifyTaskEnd());
+                setCurrentThreadName(threadName);
 
-                std::lock_guard dummy(singleThread); //protect ALL accesses to "fps" and workItem execution!
-                workItem(); //throw ThreadStopRequest
-            }
-        });
+                if (ioPriority != IoPriority::normal)
+                    try { setCurrentThreadIoPriority(ioPriority); /*throw FileError*/ }
+                    catch (FileError&) { assert(false); } //best effort: e.g. not supported by the kernel => sync at normal priority
+
+                while (/*blocking call:*/ std::function<void()> workItem = workload.getNext(threadIdx)) //throw ThreadStopRequest
+                {
+                    std::optional<DeviceBudget::Reservation> budgetSlots;
+                    if (deviceBudget)
+                        budgetSlots.emplace(deviceBudget->reserve()); //throw ThreadStopRequest
+
+                    acb.notifyTaskBegin(0 /*prio*/); //same prio for all folder pairs
+                    ZEN_ON_SCOPE_EXIT(acb.notifyTaskEnd());
+
+                    std::lock_guard dummy(singleThread); //protect ALL accesses to "fps" and workItem execution!
+                    workItem(); //throw ThreadStopRequest
+                }
+            });
+        }
+    }
     acb.waitUntilDone(UI_UPDATE_INTERVAL / 2 /*every ~50 ms*/, cb); //throw X
+
+    std::vector<std::chrono::nanoseconds> passTimes;
+    for (const std::unique_ptr<Workload>& workload : workloads)
+        passTimes.push_back(workload->getTimeAllDone() - passStartTime);
+    return passTimes;
 }
 
 
@@ -1091,6 +1893,9 @@ RingBuffer<Workload::WorkItems> FolderPairSyncer::getFolderLevelWorkItems(PassNo
         ContainerObject& hierObj = *foldersToInspect.    front();
         /**/                        foldersToInspect.pop_front();
 
+        if (hierObj.isSpilled()) //equal items only: nothing to sync
+            continue;
+
         RingBuffer<std::function<void()>> workItems;
 
         if (pass == PassNo::zero)
@@ -1102,11 +1907,12 @@ RingBuffer<Workload::WorkItems> FolderPairSyncer::getFolderLevelWorkItems(PassNo
             //create folders as required by file move targets:
             for (FolderPair& folder : hierObj.refSubFolders())
                 if (needZeroPass(folder) &&
-                    !haveNameClash(folder.getItemNameAny(), folder.parent().refSubFiles()) && //name clash with files/symlinks? obscure => skip folder creation
-                    !haveNameClash(folder.getItemNameAny(), folder.parent().refSubLinks()))   // => move: fall back to delete + copy
+                    !folder.parent().hasSubFileNoCase(folder.getItemNameAny()) && //name clash with files/symlinks? obscure => skip folder creation
+                    !folder.parent().hasSubLinkNoCase(folder.getItemNameAny()))   // => move: fall back to delete + copy
                     workItems.push_back([this, &folder, &workload, pass]
                 {
-                    tryReportingError([&] { synchronizeFolder(folder); }, acb_); //throw ThreadStopRequest
+                    if (!executeFolderMove(folder)) //throw ThreadStopRequest
+                        tryReportingError([&] { synchronizeFolder(folder); }, acb_); //throw ThreadStopRequest
                     //error? => still process move targets (for delete + copy fall back!)
                     workload.addWorkItems(getFolderLevelWorkItems(pass, folder, workload));
                 });
@@ -1128,19 +1934,39 @@ RingBuffer<Workload::WorkItems> FolderPairSyncer::getFolderLevelWorkItems(PassNo
                 foldersToInspect.push_back(&folder);
 
             //synchronize files:
+            std::vector<FilePair*> batchFilesL;
+            std::vector<FilePair*> batchFilesR;
+
             for (FilePair& file : hierObj.refSubFiles())
                 if (pass == getPass(file))
-                    workItems.push_back([this, &file]
                 {
-                    tryReportingError([&] { synchronizeFile(file); }, acb_); //throw ThreadStopRequest
-                });
+                    if (isBatchUploadCandidate<SelectSide::left>(file))
+                        batchFilesL.push_back(&file);
+                    else if (isBatchUploadCandidate<SelectSide::right>(file))
+                        batchFilesR.push_back(&file);
+                    else
+                    {
+                        auto workItem = [this, &file, &workload]
+                        {
+                            syncItemWithAutoRetry([this, &file] { synchronizeFile(file); }, workload); //throw ThreadStopRequest
+                        };
+                        if (const uint64_t bytesToCopy = getBytesToCopy(file);
+                            bytesToCopy >= Workload::LARGE_ITEM_BYTES_MIN && workload.getThreadCount() > 1)
+                            workload.addLargeWorkItem(bytesToCopy, workItem);
+                        else
+                            workItems.push_back(workItem);
+                    }
+                }
+
+            addFileBatchWorkItems<SelectSide::left >(hierObj, batchFilesL, workItems);
+            addFileBatchWorkItems<SelectSide::right>(hierObj, batchFilesR, workItems);
 
             //synchronize symbolic links:
             for (SymlinkPair& symlink : hierObj.refSubLinks())
                 if (pass == getPass(symlink))
-                    workItems.push_back([this, &symlink]
+                    workItems.push_back([this, &symlink, &workload]
                 {
-                    tryReportingError([&] { synchronizeLink(symlink); }, acb_); //throw ThreadStopRequest
+                    syncItemWithAutoRetry([this, &symlink] { synchronizeLink(symlink); }, workload); //throw ThreadStopRequest
                 });
         }
 
@@ -1152,6 +1978,161 @@ RingBuffer<Workload::WorkItems> FolderPairSyncer::getFolderLevelWorkItems(PassNo
 }
 
 
+/*  automatic retry: don't wait for the retry delay in reportError() => the worker thread would sit idle (and block all other errors in the meantime)
+    => re-queue as delayed work item instead; only the last try is reported as error (retryNumber == autoRetryCount: no further automatic retry)
+    folder items are not re-queued: their sub items are processed right after and depend on the result    */
+template <class Function>
+void FolderPairSyncer::syncItemWithAutoRetry(Function syncItem /*throw FileError*/, Workload& workload, size_t retryNumber) //throw ThreadStopRequest
+{
+    if (retryNumber < autoRetryCount_)
+        try
+        {
+            syncItem(); //throw FileError
+            return;
+        }
+        catch (const FileError& e)
+        {
+            acb_.logInfo(e.toString() + L"\n-> " + _("Automatic retry")); //throw ThreadStopRequest
+
+            workload.addDelayedWorkItem(std::chrono::steady_clock::now() + autoRetryDelay_, [this, syncItem, &workload, retryNumber]
+            {
+                syncItemWithAutoRetry(syncItem, workload, retryNumber + 1); //throw ThreadStopRequest
+            });
+            return;
+        }
+
+    tryReportingError(syncItem, acb_, retryNumber); //throw ThreadStopRequest
+}
+
+
+template <SelectSide sideTrg>
+bool FolderPairSyncer::isBatchUploadCandidate(FilePair& file)
+{
+    constexpr SelectSide sideSrc = getOtherSide<sideTrg>;
+
+    return file.getSyncOperation() == (sideTrg == SelectSide::left ? SO_CREATE_NEW_LEFT : SO_CREATE_NEW_RIGHT) &&
+           file.getFileSize<sideSrc>() <= BATCH_UPLOAD_FILE_SIZE_MAX &&
+           !verifyCopiedFiles_ && !copyFilePermissions_ && //not supported by batch upload
+           !getResumableCopy<sideSrc>(file);
+}
+
+
+template <SelectSide sideTrg>
+void FolderPairSyncer::addFileBatchWorkItems(const ContainerObject& hierObj, std::vector<FilePair*>& files, RingBuffer<std::function<void()>>& workItems)
+{
+    if (files.empty())
+        return;
+
+    const size_t batchSizeMax = files.size() >= BATCH_UPLOAD_FILE_COUNT_MIN ? AFS::getBatchUploadFileCountMax(hierObj.getAbstractPath<sideTrg>()) : 0;
+    if (batchSizeMax == 0) //=> process one by one
+    {
+        for (FilePair* file : files)
+            workItems.push_back([this, file]
+        {
+            tryReportingError([&] { synchronizeFile(*file); }, acb_); //throw ThreadStopRequest
+        });
+        return;
+    }
+
+    for (size_t i = 0; i < files.size(); i += batchSizeMax)
+        workItems.push_back([this, batch = std::vector<FilePair*>(files.begin() + i, files.begin() + std::min(i + batchSizeMax, files.size()))]
+    {
+        synchronizeFileBatch<sideTrg>(batch); //throw ThreadStopRequest
+    });
+}
+
+
+template <SelectSide sideTrg>
+void FolderPairSyncer::synchronizeFileBatch(const std::vector<FilePair*>& files) //throw ThreadStopRequest
+{
+    assert(!files.empty());
+    constexpr SelectSide sideSrc = getOtherSide<sideTrg>;
+
+    const ContainerObject& parent = files[0]->parent();
+    if (auto parentFolder = dynamic_cast<const FolderPair*>(&parent))
+        if (parentFolder->isEmpty<sideTrg>()) //see synchronizeFileInt()
+            return;
+
+    std::vector<AFS::BatchUploadItem> items;
+    int64_t bytesExpected = 0;
+    for (const FilePair* file : files)
+    {
+        logInfo(txtCreatingFile_, AFS::getDisplayPath(file->getAbstractPath<sideTrg>())); //throw ThreadStopRequest
+        items.push_back({file->getAbstractPath<sideSrc>(),
+            {file->getLastWriteTime<sideSrc>(), file->getFileSize<sideSrc>(), file->getFilePrint<sideSrc>()},
+            file->getItemName<sideSrc>()});
+        bytesExpected += file->getFileSize<sideSrc>();
+    }
+
+    try
+    {
+        AsyncItemStatReporter statReporter(static_cast<int>(files.size()), bytesExpected, acb_);
+        statReporter.updateStatus(txtCreatingFile_, AFS::getDisplayPath(files[0]->getAbstractPath<sideTrg>())); //throw ThreadStopRequest
+
+        IoCallback notifyUnbufferedIO = [&](int64_t bytesDelta)
+        {
+            statReporter.reportDelta(0, bytesDelta);
+            interruptionPoint(); //throw ThreadStopRequest
+        };
+
+        const std::vector<AFS::FileCopyResult> results = parallel::uploadFileBatch(parent.getAbstractPath<sideTrg>(), items, //throw FileError, ErrorFileLocked, ThreadStopRequest
+                                                                                   notifyUnbufferedIO, singleThread_);
+        assert(results.size() == files.size());
+
+        for (size_t i = 0; i < files.size(); ++i)
+        {
+            FilePair& file = *files[i];
+            const AFS::FileCopyResult& result = results[i];
+
+            statReporter.reportDelta(1, 0);
+
+            file.setSyncedTo<sideTrg>(file.getItemName<sideSrc>(), result.fileSize,
+                                      result.modTime, //target time set from source
+                                      result.modTime,
+                                      result.targetFilePrint,
+                                      result.sourceFilePrint,
+                                      false, file.isFollowedSymlink<sideSrc>());
+        }
+    }
+    catch (const FileError& e) //batch is all or nothing => retry one by one for detailed per-file error reporting
+    {
+        acb_.logInfo(e.toString()); //throw ThreadStopRequest
+
+        for (FilePair* file : files)
+            tryReportingError([&] { synchronizeFile(*file); }, acb_); //throw ThreadStopRequest
+    }
+}
+
+
+uint64_t FolderPairSyncer::getBytesToCopy(const FilePair& file)
+{
+    switch (file.getSyncOperation())
+    {
+        case SO_CREATE_NEW_LEFT:
+        case SO_OVERWRITE_LEFT:
+            return file.getFileSize<SelectSide::right>();
+
+        case SO_CREATE_NEW_RIGHT:
+        case SO_OVERWRITE_RIGHT:
+            return file.getFileSize<SelectSide::left>();
+
+        case SO_DELETE_LEFT:
+        case SO_DELETE_RIGHT:
+        case SO_MOVE_LEFT_FROM:
+        case SO_MOVE_LEFT_TO:
+        case SO_MOVE_RIGHT_FROM:
+        case SO_MOVE_RIGHT_TO:
+        case SO_COPY_METADATA_TO_LEFT:
+        case SO_COPY_METADATA_TO_RIGHT:
+        case SO_DO_NOTHING:
+        case SO_EQUAL:
+        case SO_UNRESOLVED_CONFLICT:
+            break;
+    }
+    return 0;
+}
+
+
 /* __________________________
    |Move algorithm, 0th pass|
    --------------------------
@@ -1199,8 +2180,8 @@ void FolderPairSyncer::executeFileMoveImpl(FilePair& fileFrom, FilePair& fileTo)
         }
 
         //name clash with folders/symlinks? obscure => fall back to delete + copy
-        if (haveNameClash(fileTo.getItemNameAny(), fileTo.parent().refSubFolders()) ||
-            haveNameClash(fileTo.getItemNameAny(), fileTo.parent().refSubLinks  ()))
+        if (fileTo.parent().hasSubFolderNoCase(fileTo.getItemNameAny()) || //no case: when in doubt => assume name clash!
+            fileTo.parent().hasSubLinkNoCase  (fileTo.getItemNameAny()))
         {
             logInfo(_("Cannot move file %x to %y.") + L"\n\n" + replaceCpy(_("The name %x is already used by another item."), L"%x", fmtPath(fileTo.getItemNameAny())),
                     AFS::getDisplayPath(fileFrom.getAbstractPath<side>()),
@@ -1238,47 +2219,244 @@ void FolderPairSyncer::executeFileMoveImpl(FilePair& fileFrom, FilePair& fileTo)
         fileTo  .setMoveRef(nullptr);
         const auto [itemsAfter, bytesAfter] = getStats();
 
-        //fix statistics total to match "copy + delete"
-        acb_.updateDataTotal(itemsAfter - itemsBefore, bytesAfter - bytesBefore); //noexcept
+        //fix statistics total to match "copy + delete"
+        acb_.updateDataTotal(itemsAfter - itemsBefore, bytesAfter - bytesBefore); //noexcept
+    }
+}
+
+
+void FolderPairSyncer::executeFileMove(FilePair& file) //throw ThreadStopRequest
+{
+    const SyncOperation syncOp = file.getSyncOperation();
+    switch (syncOp)
+    {
+        case SO_MOVE_LEFT_TO:
+        case SO_MOVE_RIGHT_TO:
+            if (FilePair* fileFrom = dynamic_cast<FilePair*>(FileSystemObject::retrieve(file.getMoveRef())))
+            {
+                assert(fileFrom->getMoveRef() == file.getId());
+
+                if (syncOp == SO_MOVE_LEFT_TO)
+                    executeFileMoveImpl<SelectSide::left>(*fileFrom, file); //throw ThreadStopRequest
+                else
+                    executeFileMoveImpl<SelectSide::right>(*fileFrom, file); //throw ThreadStopRequest
+            }
+            else assert(false);
+            break;
+
+        case SO_CREATE_NEW_LEFT:
+        case SO_CREATE_NEW_RIGHT:
+        case SO_DELETE_LEFT:
+        case SO_DELETE_RIGHT:
+        case SO_MOVE_LEFT_FROM:  //don't try to move more than *once* per pair
+        case SO_MOVE_RIGHT_FROM: //
+        case SO_OVERWRITE_LEFT:
+        case SO_OVERWRITE_RIGHT:
+        case SO_COPY_METADATA_TO_LEFT:
+        case SO_COPY_METADATA_TO_RIGHT:
+        case SO_DO_NOTHING:
+        case SO_EQUAL:
+        case SO_UNRESOLVED_CONFLICT:
+            assert(false); //should have been filtered out by FolderPairSyncer::needZeroPass()
+            break;
+    }
+}
+
+/*  folder move: renamed folder = "create new folder" with only move targets + "delete folder" with the corresponding move sources
+    => single move of the whole folder instead of one move per file
+    - requires identical sub-tree: same item names, every file a move pair between the two folders, no symlinks
+    - no folder match or move failed: fall back to folder creation + individual file moves
+    - active filter: skip! the in-memory hierarchy doesn't show excluded items, which would be moved along with the folder      */
+bool FolderPairSyncer::executeFolderMove(FolderPair& folder) //throw ThreadStopRequest
+{
+    if (!folder.base().getFilter().isNull())
+        return false;
+
+    switch (folder.getSyncOperation())
+    {
+        case SO_CREATE_NEW_LEFT:
+            return executeFolderMoveImpl<SelectSide::left>(folder); //throw ThreadStopRequest
+        case SO_CREATE_NEW_RIGHT:
+            return executeFolderMoveImpl<SelectSide::right>(folder); //throw ThreadStopRequest
+
+        case SO_DELETE_LEFT:
+        case SO_DELETE_RIGHT:
+        case SO_MOVE_LEFT_FROM:
+        case SO_MOVE_RIGHT_FROM:
+        case SO_MOVE_LEFT_TO:
+        case SO_MOVE_RIGHT_TO:
+        case SO_OVERWRITE_LEFT:
+        case SO_OVERWRITE_RIGHT:
+        case SO_COPY_METADATA_TO_LEFT:
+        case SO_COPY_METADATA_TO_RIGHT:
+        case SO_DO_NOTHING:
+        case SO_EQUAL:
+        case SO_UNRESOLVED_CONFLICT:
+            return false;
+    }
+    assert(false);
+    return false;
+}
+
+
+template <SelectSide side>
+bool FolderPairSyncer::executeFolderMoveImpl(FolderPair& folderTo) //throw ThreadStopRequest
+{
+    FolderPair* folderFrom = getFolderMoveSource<side>(folderTo);
+    if (!folderFrom)
+        return false;
+
+    if (auto parentFolder = dynamic_cast<const FolderPair*>(&folderTo.parent()))
+        if (parentFolder->isEmpty<side>()) //parent folder creation failed => synchronizeFolder() handles this case
+            return false;
+
+    const AbstractPath pathFrom = folderFrom->getAbstractPath<side>();
+    const AbstractPath pathTo   = folderTo   .getAbstractPath<side>();
+
+    reportInfo(txtMovingFolderXtoY_, AFS::getDisplayPath(pathFrom), AFS::getDisplayPath(pathTo)); //throw ThreadStopRequest
+
+    const SyncStatistics statsFrom(*folderFrom); //counts sub-objects only!
+    const SyncStatistics statsTo  (folderTo);    //
+    try
+    {
+        //already existing: undefined behavior! (e.g. fail/overwrite)
+        parallel::moveAndRenameItem(pathFrom, pathTo, singleThread_); //throw FileError, ErrorMoveUnsupported
+    }
+    catch (const FileError& e) //including ErrorMoveUnsupported
+    {
+        acb_.logInfo(e.toString()); //throw ThreadStopRequest
+        return false; //fall back to individual file moves
+    }
+
+    //all contained file moves + folder creation + folder deletion are done:
+    const int itemsExpected = 2 + getCUD(statsFrom) + getCUD(statsTo);
+    AsyncItemStatReporter statReporter(itemsExpected, statsFrom.getBytesToProcess() + statsTo.getBytesToProcess(), acb_);
+    statReporter.reportDelta(itemsExpected, 0);
+
+    //update FolderPair
+    setFolderMoveSynced<side>(*folderFrom, folderTo);
+    return true;
+}
+
+
+template <SelectSide side>
+FolderPair* FolderPairSyncer::getFolderMoveSource(FolderPair& folderTo)
+{
+    //locate candidate via the first file found, then verify the complete sub-tree:
+    size_t depth = 0; //of the file's parent folder relative to "folderTo"
+    std::function<const FilePair*(const FolderPair& folder)> findFirstFile;
+    findFirstFile = [&](const FolderPair& folder) -> const FilePair*
+    {
+        if (!folder.refSubFiles().empty())
+            return &folder.refSubFiles().front();
+
+        for (const FolderPair& subFolder : folder.refSubFolders())
+            if (const FilePair* file = findFirstFile(subFolder))
+            {
+                ++depth;
+                return file;
+            }
+        return nullptr;
+    };
+    const FilePair* fileTo = findFirstFile(folderTo);
+    if (!fileTo)
+        return nullptr;
+
+    const FilePair* fileFrom = dynamic_cast<const FilePair*>(FileSystemObject::retrieve(fileTo->getMoveRef()));
+    if (!fileFrom)
+        return nullptr;
+
+    FolderPair* folderFrom = dynamic_cast<FolderPair*>(&const_cast<FilePair*>(fileFrom)->parent());
+    for (; folderFrom && depth > 0; --depth)
+        folderFrom = dynamic_cast<FolderPair*>(&folderFrom->parent());
+
+    if (!folderFrom || !isFolderMovePair<side>(*folderFrom, folderTo))
+        return nullptr;
+    return folderFrom;
+}
+
+
+template <SelectSide side>
+bool FolderPairSyncer::isFolderMovePair(const FolderPair& folderFrom, const FolderPair& folderTo)
+{
+    constexpr SelectSide sideSrc = getOtherSide<side>;
+
+    if (folderFrom.getSyncOperation() != (side == SelectSide::left ? SO_DELETE_LEFT     : SO_DELETE_RIGHT) ||
+        folderTo  .getSyncOperation() != (side == SelectSide::left ? SO_CREATE_NEW_LEFT : SO_CREATE_NEW_RIGHT) ||
+        folderFrom.isFollowedSymlink<side>() || //don't move folder symlink instead of folder
+        !folderFrom.refSubLinks().empty() ||
+        !folderTo  .refSubLinks().empty() ||
+        folderFrom.refSubFiles  ().size() != folderTo.refSubFiles  ().size() ||
+        folderFrom.refSubFolders().size() != folderTo.refSubFolders().size())
+        return false;
+
+    //same number of files + every target file has its move source in "folderFrom" => all source files are covered, too
+    for (const FilePair& fileTo : folderTo.refSubFiles())
+    {
+        if (fileTo.getSyncOperation() != (side == SelectSide::left ? SO_MOVE_LEFT_TO : SO_MOVE_RIGHT_TO))
+            return false;
+
+        const FilePair* fileFrom = dynamic_cast<const FilePair*>(FileSystemObject::retrieve(fileTo.getMoveRef()));
+        if (!fileFrom || &fileFrom->parent() != &folderFrom ||
+            fileFrom->getItemName<side>() != fileTo.getItemName<sideSrc>()) //moved *and* renamed: not part of folder move
+            return false;
+    }
+
+    if (!folderTo.refSubFolders().empty())
+    {
+        std::unordered_map<Zstring, const FolderPair*> subFoldersFrom;
+        for (const FolderPair& subFolderFrom : folderFrom.refSubFolders())
+            subFoldersFrom.emplace(subFolderFrom.getItemName<side>(), &subFolderFrom);
+
+        for (const FolderPair& subFolderTo : folderTo.refSubFolders())
+        {
+            const auto it = subFoldersFrom.find(subFolderTo.getItemName<sideSrc>());
+            if (it == subFoldersFrom.end() || !isFolderMovePair<side>(*it->second, subFolderTo))
+                return false;
+        }
     }
+    return true;
 }
 
 
-void FolderPairSyncer::executeFileMove(FilePair& file) //throw ThreadStopRequest
+template <SelectSide side>
+void FolderPairSyncer::setFolderMoveSynced(FolderPair& folderFrom, FolderPair& folderTo)
 {
-    const SyncOperation syncOp = file.getSyncOperation();
-    switch (syncOp)
+    constexpr SelectSide sideSrc = getOtherSide<side>;
+
+    for (FilePair& fileTo : folderTo.refSubFiles())
     {
-        case SO_MOVE_LEFT_TO:
-        case SO_MOVE_RIGHT_TO:
-            if (FilePair* fileFrom = dynamic_cast<FilePair*>(FileSystemObject::retrieve(file.getMoveRef())))
-            {
-                assert(fileFrom->getMoveRef() == file.getId());
+        const FilePair* fileFrom = dynamic_cast<const FilePair*>(FileSystemObject::retrieve(fileTo.getMoveRef()));
+        assert(fileFrom && fileFrom->getMoveRef() == fileTo.getId());
+
+        fileTo.setSyncedTo<side>(fileTo   .getItemName<sideSrc>(),
+                                 fileTo   .getFileSize<sideSrc>(),
+                                 fileFrom->getLastWriteTime<side>(),
+                                 fileTo   .getLastWriteTime<sideSrc>(),
+                                 fileFrom->getFilePrint<side>(),
+                                 fileTo   .getFilePrint<sideSrc>(),
+                                 fileFrom->isFollowedSymlink<side>(),
+                                 fileTo   .isFollowedSymlink<sideSrc>());
+    }
 
-                if (syncOp == SO_MOVE_LEFT_TO)
-                    executeFileMoveImpl<SelectSide::left>(*fileFrom, file); //throw ThreadStopRequest
-                else
-                    executeFileMoveImpl<SelectSide::right>(*fileFrom, file); //throw ThreadStopRequest
-            }
-            else assert(false);
-            break;
+    if (!folderTo.refSubFolders().empty())
+    {
+        std::unordered_map<Zstring, FolderPair*> subFoldersFrom;
+        for (FolderPair& subFolderFrom : folderFrom.refSubFolders())
+            subFoldersFrom.emplace(subFolderFrom.getItemName<side>(), &subFolderFrom);
 
-        case SO_CREATE_NEW_LEFT:
-        case SO_CREATE_NEW_RIGHT:
-        case SO_DELETE_LEFT:
-        case SO_DELETE_RIGHT:
-        case SO_MOVE_LEFT_FROM:  //don't try to move more than *once* per pair
-        case SO_MOVE_RIGHT_FROM: //
-        case SO_OVERWRITE_LEFT:
-        case SO_OVERWRITE_RIGHT:
-        case SO_COPY_METADATA_TO_LEFT:
-        case SO_COPY_METADATA_TO_RIGHT:
-        case SO_DO_NOTHING:
-        case SO_EQUAL:
-        case SO_UNRESOLVED_CONFLICT:
-            assert(false); //should have been filtered out by FolderPairSyncer::needZeroPass()
-            break;
+        for (FolderPair& subFolderTo : folderTo.refSubFolders())
+            setFolderMoveSynced<side>(*subFoldersFrom.at(subFolderTo.getItemName<sideSrc>()) /*see isFolderMovePair()*/, subFolderTo);
     }
+
+    folderTo.setSyncedTo<side>(folderTo.getItemName<sideSrc>(),
+                               false, //isSymlinkTrg
+                               folderTo.isFollowedSymlink<sideSrc>());
+
+    folderFrom.refSubFiles  ().clear(); //
+    folderFrom.refSubLinks  ().clear(); //all items moved => update FolderPair
+    folderFrom.refSubFolders().clear(); //
+    folderFrom.removeObject<side>();    //
 }
 
 //---------------------------------------------------------------------------------------------------------------
@@ -1442,8 +2620,10 @@ FolderPairSyncer::PassNo FolderPairSyncer::getPass(const FolderPair& folder)
         case SO_DELETE_RIGHT:
             return PassNo::one;
 
-        case SO_CREATE_NEW_LEFT:
-        case SO_CREATE_NEW_RIGHT:
+        case SO_CREATE_NEW_LEFT:  //still pending in pass two? => creation failed: skip silently, see synchronizeFileInt()
+        case SO_CREATE_NEW_RIGHT: //
+            return PassNo::folders;
+
         case SO_OVERWRITE_LEFT:
         case SO_OVERWRITE_RIGHT:
         case SO_COPY_METADATA_TO_LEFT:
@@ -1506,11 +2686,22 @@ void FolderPairSyncer::synchronizeFileInt(FilePair& file, SyncOperation syncOp)
 
             try
             {
-                const AFS::FileCopyResult result = copyFileWithCallback({file.getAbstractPath<sideSrc>(), file.getAttributes<sideSrc>()},
-                                                                        targetPath,
-                                                                        nullptr, //onDeleteTargetFile: nothing to delete
-                                                                        //if existing: undefined behavior! (e.g. fail/overwrite/auto-rename)
-                                                                        statReporter); //throw FileError, ThreadStopRequest
+                const AFS::FileCopyResult result = [&]
+                {
+                    if (std::optional<AFS::FileCopyResult> linkResult = hardLinks_.tryCreateHardLink<sideSrc>(file)) //throw FileError
+                        return std::move(*linkResult);
+
+                    AFS::FileCopyResult copyResult = copyFileWithCallback({file.getAbstractPath<sideSrc>(), file.getAttributes<sideSrc>()},
+                                                                          targetPath,
+                                                                          nullptr, //onDeleteTargetFile: nothing to delete
+                                                                          //if existing: undefined behavior! (e.g. fail/overwrite/auto-rename)
+                                                                          false /*deltaCopy*/,
+                                                                          getResumableCopy<sideSrc>(file),
+                                                                          statReporter); //throw FileError, ThreadStopRequest
+                    hardLinks_.registerCopy<sideSrc>(file);
+                    discardResumablePartial<sideSrc>(file);
+                    return copyResult;
+                }();
                 statReporter.updateStatus(1, 0); //throw ThreadStopRequest
 
                 //update FilePair
@@ -1649,7 +2840,11 @@ void FolderPairSyncer::synchronizeFileInt(FilePair& file, SyncOperation syncOp)
             const AFS::FileCopyResult result = copyFileWithCallback({file.getAbstractPath<sideSrc>(), file.getAttributes<sideSrc>()},
                                                                     targetPathResolvedNew,
                                                                     onDeleteTargetFile,
+                                                                    //large files, e.g. databases, mail archives, VM images: usually only a few blocks change
+                                                                    deltaCopyMinSize_ > 0 && file.getFileSize<sideTrg>() >= deltaCopyMinSize_,
+                                                                    getResumableCopy<sideSrc>(file),
                                                                     statReporter); //throw FileError, ThreadStopRequest, X
+            discardResumablePartial<sideSrc>(file);
             statReporter.updateStatus(1, 0); //throw ThreadStopRequest
             //we model "delete + copy" as ONE logical operation
 
@@ -1688,22 +2883,22 @@ void FolderPairSyncer::synchronizeFileInt(FilePair& file, SyncOperation syncOp)
                     //already existing: undefined behavior! (e.g. fail/overwrite)
                     parallel::moveAndRenameItem(file.getAbstractPath<sideTrg>(), //throw FileError, (ErrorMoveUnsupported)
                                                 AFS::appendRelPath(file.parent().getAbstractPath<sideTrg>(), file.getItemName<sideSrc>()), singleThread_);
-                else
-                    assert(false);
 
-#if 0 //changing file time without copying content is not justified after CompareVariant::size finds "equal" files! similar issue with CompareVariant::timeSize and FileTimeTolerance == -1
-                //Bonus: some devices don't support setting (precise) file times anyway, e.g. FAT or MTP!
-                if (file.getLastWriteTime<sideTrg>() != file.getLastWriteTime<sideSrc>())
-                    //- no need to call sameFileTime() or respect 2 second FAT/FAT32 precision in this comparison
-                    //- do NOT read *current* source file time, but use buffered value which corresponds to time of comparison!
-                    parallel::setModTime(file.getAbstractPath<sideTrg>(), file.getLastWriteTime<sideSrc>()); //throw FileError
-#endif
+                //changing file time without copying content is not justified after CompareVariant::size finds "equal" files! similar issue with CompareVariant::timeSize and FileTimeTolerance == -1
+                //=> only after CompareVariant::timeSize found different times, but equal content: see ComparisonBuffer::verifyTimeDiffByContent()
+                const bool updateModTime = file.base().getCompVariant() == CompareVariant::timeSize &&
+                                           !sameFileTime(file.getLastWriteTime<sideTrg>(), file.getLastWriteTime<sideSrc>(), file.base().getTimeTolerance());
+                if (updateModTime)
+                    //do NOT read *current* source file time, but use buffered value which corresponds to time of comparison!
+                    parallel::setModTime(file.getAbstractPath<sideTrg>(), file.getLastWriteTime<sideSrc>(), singleThread_); //throw FileError
+
+                assert(updateModTime || getUnicodeNormalForm(file.getItemName<sideTrg>()) != getUnicodeNormalForm(file.getItemName<sideSrc>()));
                 statReporter.reportDelta(1, 0);
 
                 //-> both sides *should* be completely equal now...
                 assert(file.getFileSize<sideTrg>() == file.getFileSize<sideSrc>());
                 file.setSyncedTo<sideTrg>(file.getItemName<sideSrc>(), file.getFileSize<sideSrc>(),
-                                          file.getLastWriteTime <sideTrg>(),
+                                          updateModTime ? file.getLastWriteTime<sideSrc>() : file.getLastWriteTime<sideTrg>(),
                                           file.getLastWriteTime <sideSrc>(),
                                           file.getFilePrint     <sideTrg>(),
                                           file.getFilePrint     <sideSrc>(),
@@ -2013,18 +3208,40 @@ void FolderPairSyncer::synchronizeFolderInt(FolderPair& folder, SyncOperation sy
 AFS::FileCopyResult FolderPairSyncer::copyFileWithCallback(const FileDescriptor& sourceDescr, //throw FileError, ThreadStopRequest, X
                                                            const AbstractPath& targetPath,
                                                            const std::function<void()>& onDeleteTargetFile /*throw X*/,
+                                                           bool deltaCopy,
+                                                           std::optional<uint64_t> resumableCopy,
                                                            AsyncPercentStatReporter& statReporter) /*throw ThreadStopRequest*/
 {
     const AbstractPath& sourcePath = sourceDescr.path;
     const AFS::StreamAttributes sourceAttr{sourceDescr.attr.modTime, sourceDescr.attr.fileSize, sourceDescr.attr.filePrint};
 
+    //verification: hash source content while copying => no need to read the source a second time
+    //prefer an algorithm the target can calculate server-side: saves reading back the target, too
+    std::optional<HashAlgorithm> verifyHashAlgo;
+    if (verifyCopiedFiles_)
+    {
+        const std::vector<HashAlgorithm> targetHashAlgos = AFS::getServerHashAlgorithms(targetPath);
+        verifyHashAlgo = targetHashAlgos.empty() ? HashAlgorithm::sha256 : targetHashAlgos[0];
+    }
+
+    //source and target see the same byte stream => throttle by both limits (once if on the same device)
+    auto getBandwidthLimiter = [&](const AfsDevice& afsDevice) -> BandwidthLimiter*
+    {
+        auto it = bandwidthLimiters_.find(afsDevice);
+        return it != bandwidthLimiters_.end() ? it->second.get() : nullptr;
+    };
+    BandwidthLimiter* const bandwidthLimitTrg = getBandwidthLimiter(targetPath.afsDevice);
+    BandwidthLimiter* const bandwidthLimitSrc = sourcePath.afsDevice == targetPath.afsDevice ? nullptr : getBandwidthLimiter(sourcePath.afsDevice);
+
     auto copyOperation = [&](const AbstractPath& sourcePathTmp)
     {
         //already existing + no onDeleteTargetFile: undefined behavior! (e.g. fail/overwrite/auto-rename)
         const AFS::FileCopyResult result = parallel::copyFileTransactional(sourcePathTmp, sourceAttr, //throw FileError, ErrorFileLocked, ThreadStopRequest, X
                                                                            targetPath,
                                                                            copyFilePermissions_,
-                                                                           failSafeFileCopy_, [&]
+                                                                           failSafeFileCopy_,
+                                                                           deltaCopy,
+                                                                           resumableCopy, [&]
         {
             if (onDeleteTargetFile) //running *outside* singleThread_ lock! => onDeleteTargetFile-callback expects lock being held:
             {
@@ -2036,8 +3253,11 @@ AFS::FileCopyResult FolderPairSyncer::copyFileWithCallback(const FileDescriptor&
         {
             statReporter.updateStatus(0, bytesDelta); //throw ThreadStopRequest
             interruptionPoint(); //throw ThreadStopRequest => not reliably covered by AsyncPercentStatReporter::updateStatus()!
+
+            if (bandwidthLimitSrc) bandwidthLimitSrc->consume(bytesDelta); //throw ThreadStopRequest
+            if (bandwidthLimitTrg) bandwidthLimitTrg->consume(bytesDelta); //
         },
-        singleThread_);
+        verifyHashAlgo, singleThread_);
 
         //#################### Verification #############################
         if (verifyCopiedFiles_)
@@ -2048,9 +3268,13 @@ AFS::FileCopyResult FolderPairSyncer::copyFileWithCallback(const FileDescriptor&
             reportInfo(txtVerifyingFile_, AFS::getDisplayPath(targetPath)); //throw ThreadStopRequest
 
             //callback runs *outside* singleThread_ lock! => fine
-            auto verifyCallback = [&](int64_t bytesDelta) { interruptionPoint(); }; //throw ThreadStopRequest
+            auto verifyCallback = [&](int64_t bytesDelta) //throw ThreadStopRequest
+            {
+                interruptionPoint(); //throw ThreadStopRequest
+                if (bandwidthLimitTrg) bandwidthLimitTrg->consume(bytesDelta); //throw ThreadStopRequest
+            };
 
-            parallel::verifyFiles(sourcePathTmp, targetPath, verifyCallback, singleThread_); //throw FileError, ThreadStopRequest
+            parallel::verifyFiles(sourcePathTmp, targetPath, *verifyHashAlgo, result.sourceHash, verifyCallback, singleThread_); //throw FileError, ThreadStopRequest
         }
         //#################### /Verification #############################
 
@@ -2063,7 +3287,7 @@ AFS::FileCopyResult FolderPairSyncer::copyFileWithCallback(const FileDescriptor&
 //###########################################################################################
 
 template <SelectSide side>
-bool checkBaseFolderStatus(BaseFolderPair& baseFolder, PhaseCallback& callback /*throw X*/)
+bool checkBaseFolderStatus(BaseFolderPair& baseFolder, const std::map<AfsDevice, size_t>& deviceParallelOps, PhaseCallback& callback /*throw X*/)
 {
     const AbstractPath folderPath = baseFolder.getAbstractPath<side>();
 
@@ -2080,7 +3304,7 @@ bool checkBaseFolderStatus(BaseFolderPair& baseFolder, PhaseCallback& callback /
 
     const std::wstring errMsg = tryReportingError([&]
     {
-        const FolderStatus status = getFolderStatusNonBlocking({folderPath},
+        const FolderStatus status = getFolderStatusNonBlocking({folderPath}, deviceParallelOps, //sessions may have timed out since comparison
         false /*allowUserInteraction*/, callback);
 
         static_assert(std::is_same_v<decltype(status.failedChecks.begin()->second), FileError>);
@@ -2125,6 +3349,56 @@ bool checkBaseFolderStatus(BaseFolderPair& baseFolder, PhaseCallback& callback /
 }
 
 
+//pre-sync checks are network round trips (e.g. SFTP statvfs, Google Drive "about"): run them for all base folders at once
+struct PreSyncChecks
+{
+    std::map<AbstractPath, std::shared_future<int64_t>> freeDiskSpace;    //returns < 0 if not available
+    std::map<AbstractPath, std::shared_future<bool>>    recyclerSupported; //
+};
+
+PreSyncChecks startPreSyncChecks(const std::set<AbstractPath>& diskSpacePaths, const std::set<AbstractPath>& recyclerPaths,
+                                 const std::map<AfsDevice, size_t>& deviceParallelOps)
+{
+    PreSyncChecks output;
+
+    std::map<AfsDevice, ThreadGroup<std::packaged_task<void()>>> perDeviceThreads;
+
+    auto runOnDevice = [&](const AbstractPath& folderPath, auto&& checkFolder)
+    {
+        auto it = perDeviceThreads.find(folderPath.afsDevice);
+        if (it == perDeviceThreads.end())
+        {
+            it = perDeviceThreads.emplace(folderPath.afsDevice, ThreadGroup<std::packaged_task<void()>>(getDeviceParallelOps(deviceParallelOps, folderPath.afsDevice),
+                                                                                                        Zstr("Pre-sync checks: ") + utfTo<Zstring>(AFS::getDisplayPath(AbstractPath(folderPath.afsDevice, AfsPath()))))).first;
+            it->second.detach(); //don't wait on threads hanging on a dead network share: see getFolderStatusNonBlocking()
+        }
+        //std::packaged_task does NOT support move-only function objects! see runAsync()
+        auto pt = std::make_shared<std::packaged_task<decltype(checkFolder())()>>(std::move(checkFolder));
+        auto ft = pt->get_future().share();
+        it->second.run(std::packaged_task<void()>([pt] { (*pt)(); }));
+        return ft;
+    };
+
+    for (const AbstractPath& folderPath : diskSpacePaths)
+        output.freeDiskSpace.emplace(folderPath, runOnDevice(folderPath, [folderPath] { return AFS::getFreeDiskSpace(folderPath); /*throw FileError*/ }));
+
+    for (const AbstractPath& folderPath : recyclerPaths)
+        output.recyclerSupported.emplace(folderPath, runOnDevice(folderPath, [folderPath] { return AFS::supportsRecycleBin(folderPath); /*throw FileError*/ }));
+
+    return output;
+}
+
+
+template <class T>
+T waitForPreSyncCheck(const std::shared_future<T>& ft, PhaseCallback& callback /*throw X*/) //throw FileError, X
+{
+    while (ft.wait_for(UI_UPDATE_INTERVAL / 2) == std::future_status::timeout)
+        callback.requestUiUpdate(); //throw X
+
+    return ft.get(); //throw FileError
+}
+
+
 template <SelectSide side> //create base directories first (if not yet existing) -> no symlink or attribute copying!
 bool createBaseFolder(BaseFolderPair& baseFolder, bool copyFilePermissions, PhaseCallback& callback /*throw X*/) //return false if fatal error occurred
 {
@@ -2164,6 +3438,221 @@ bool createBaseFolder(BaseFolderPair& baseFolder, bool copyFilePermissions, Phas
     }
     return true;
 }
+
+//folder pairs can be synchronized concurrently if they write to different devices and don't share folders
+struct FolderPairFootprint
+{
+    std::vector<std::pair<AbstractPath, const PathFilter*>> folders; //base folders + versioning folder
+    std::set<AfsDevice> targetDevices;
+};
+
+
+FolderPairFootprint getFolderPairFootprint(const BaseFolderPair& baseFolder, const FolderPairSyncCfg& folderPairCfg, const SyncStatistics& folderPairStat,
+                                           const AbstractPath& versioningFolderPath)
+{
+    static const NullFilter nullFilter;
+    FolderPairFootprint footprint;
+
+    auto addBaseFolder = [&](const AbstractPath& baseFolderPath, bool writeAccess)
+    {
+        if (AFS::isNullPath(baseFolderPath))
+            return;
+
+        footprint.folders.emplace_back(baseFolderPath, &baseFolder.getFilter());
+        if (writeAccess)
+            footprint.targetDevices.insert(baseFolderPath.afsDevice);
+    };
+    addBaseFolder(baseFolder.getAbstractPath<SelectSide::left>(), folderPairStat.createCount<SelectSide::left>() +
+                  folderPairStat.updateCount<SelectSide::left>() +
+                  folderPairStat.deleteCount<SelectSide::left>() > 0);
+    addBaseFolder(baseFolder.getAbstractPath<SelectSide::right>(), folderPairStat.createCount<SelectSide::right>() +
+                  folderPairStat.updateCount<SelectSide::right>() +
+                  folderPairStat.deleteCount<SelectSide::right>() > 0);
+
+    if (folderPairCfg.handleDeletion == DeletionPolicy::versioning && !AFS::isNullPath(versioningFolderPath))
+    {
+        footprint.folders.emplace_back(versioningFolderPath, &nullFilter);
+        footprint.targetDevices.insert(versioningFolderPath.afsDevice);
+    }
+    return footprint;
+}
+
+
+bool canSyncConcurrently(const FolderPairFootprint& lhs, const FolderPairFootprint& rhs)
+{
+    //same target device: nothing to gain, e.g. a local disk or a server's connection limit
+    if (std::any_of(lhs.targetDevices.begin(), lhs.targetDevices.end(), [&](const AfsDevice& afsDevice) { return rhs.targetDevices.contains(afsDevice); }))
+        return false;
+
+    //reading a folder while the other pair writes to it: keep the order of sequential sync
+    for (const auto& [folderPath1, filter1] : lhs.folders)
+        for (const auto& [folderPath2, filter2] : rhs.folders)
+            if (getPathDependency(folderPath1, *filter1, folderPath2, *filter2))
+                return false;
+    return true;
+}
+
+
+const size_t SYNC_HISTORY_FOLDER_PAIRS_MAX = 500;
+const size_t SYNC_HISTORY_DEVICES_MAX     = 100;
+const double SYNC_HISTORY_DEVICE_WEIGHT   = 0.5; //of the latest measurement: adapt quickly to changed network conditions
+const std::chrono::seconds SYNC_HISTORY_DEVICE_TIME_MIN(1); //shorter syncs are dominated by latency
+const double SYNC_HISTORY_BYTES_PER_SEC_DEFAULT = 10 * 1024 * 1024; //no history yet: order folder pairs by amount of work
+
+
+Zstring getDevicePathPhrase(const AfsDevice& afsDevice) { return AFS::getInitPathPhrase(AbstractPath(afsDevice, AfsPath())); }
+
+int64_t getSyncCost(const SyncStatistics& folderPairStat) { return getCUD(folderPairStat) * ITEM_COST_BYTES + folderPairStat.getBytesToProcess(); }
+
+
+//based on the previous sync of the same folder pair, or else the slowest target device
+std::optional<double> estimateSyncSeconds(const SyncHistory& syncHistory, const BaseFolderPair& baseFolder, const SyncStatistics& folderPairStat, const FolderPairFootprint& footprint)
+{
+    const int64_t syncCost = getSyncCost(folderPairStat);
+    if (syncCost == 0)
+        return 0;
+
+    const Zstring folderPathPhraseL = AFS::getInitPathPhrase(baseFolder.getAbstractPath<SelectSide::left >());
+    const Zstring folderPathPhraseR = AFS::getInitPathPhrase(baseFolder.getAbstractPath<SelectSide::right>());
+
+    if (auto it = std::find_if(syncHistory.folderPairs.begin(), syncHistory.folderPairs.end(),
+                               [&](const FolderPairHistory& fph) { return fph.folderPathPhraseL == folderPathPhraseL && fph.folderPathPhraseR == folderPathPhraseR; });
+        it != syncHistory.folderPairs.end())
+        if (const int64_t syncCostLast = it->items * ITEM_COST_BYTES + it->bytes;
+            syncCostLast > 0)
+            return std::chrono::duration<double>(it->duration).count() * syncCost / syncCostLast;
+
+    std::optional<double> bytesPerSecMin;
+    for (const AfsDevice& afsDevice : footprint.targetDevices)
+    {
+        const Zstring devicePathPhrase = getDevicePathPhrase(afsDevice);
+        if (auto it = std::find_if(syncHistory.devices.begin(), syncHistory.devices.end(), [&](const DeviceHistory& dh) { return dh.devicePathPhrase == devicePathPhrase; });
+            it != syncHistory.devices.end() && it->bytesPerSec > 0)
+            bytesPerSecMin = std::min(bytesPerSecMin.value_or(it->bytesPerSec), it->bytesPerSec);
+    }
+    if (bytesPerSecMin)
+        return syncCost / *bytesPerSecMin;
+
+    return std::nullopt;
+}
+
+
+void updateSyncHistory(SyncHistory& syncHistory, const BaseFolderPair& baseFolder, const SyncStatistics& folderPairStat, const FolderPairFootprint& footprint,
+                       std::chrono::nanoseconds syncTime, time_t syncStartTime)
+{
+    const int64_t syncCost = getSyncCost(folderPairStat);
+    if (syncCost == 0) //nothing measured: keep previous numbers
+        return;
+
+    FolderPairHistory fph
+    {
+        .folderPathPhraseL = AFS::getInitPathPhrase(baseFolder.getAbstractPath<SelectSide::left >()),
+        .folderPathPhraseR = AFS::getInitPathPhrase(baseFolder.getAbstractPath<SelectSide::right>()),
+        .lastRunTime = syncStartTime,
+        .duration = std::chrono::duration_cast<std::chrono::milliseconds>(syncTime),
+        .items = getCUD(folderPairStat),
+        .bytes = folderPairStat.getBytesToProcess(),
+    };
+    std::erase_if(syncHistory.folderPairs, [&](const FolderPairHistory& fph2) { return fph2.folderPathPhraseL == fph.folderPathPhraseL && fph2.folderPathPhraseR == fph.folderPathPhraseR; });
+
+    syncHistory.folderPairs.insert(syncHistory.folderPairs.begin(), std::move(fph));
+    if (syncHistory.folderPairs.size() > SYNC_HISTORY_FOLDER_PAIRS_MAX)
+        syncHistory.folderPairs.resize(SYNC_HISTORY_FOLDER_PAIRS_MAX);
+
+    if (syncTime < SYNC_HISTORY_DEVICE_TIME_MIN)
+        return;
+
+    const double bytesPerSec = syncCost / std::chrono::duration<double>(syncTime).count();
+
+    for (const AfsDevice& afsDevice : footprint.targetDevices)
+    {
+        DeviceHistory dh{getDevicePathPhrase(afsDevice), syncStartTime, bytesPerSec};
+
+        if (auto it = std::find_if(syncHistory.devices.begin(), syncHistory.devices.end(), [&](const DeviceHistory& dh2) { return dh2.devicePathPhrase == dh.devicePathPhrase; });
+            it != syncHistory.devices.end())
+        {
+            dh.bytesPerSec = SYNC_HISTORY_DEVICE_WEIGHT * bytesPerSec + (1 - SYNC_HISTORY_DEVICE_WEIGHT) * it->bytesPerSec;
+            syncHistory.devices.erase(it);
+        }
+        syncHistory.devices.insert(syncHistory.devices.begin(), std::move(dh));
+    }
+    if (syncHistory.devices.size() > SYNC_HISTORY_DEVICES_MAX)
+        syncHistory.devices.resize(SYNC_HISTORY_DEVICES_MAX);
+}
+
+
+/*  split folder pairs into batches synchronized one after another; folder pairs of a batch run concurrently
+    - longest first: pair up long folder pairs instead of making them wait for a batch of short ones
+    - folder pairs that can't run concurrently keep their configured order    */
+std::vector<std::vector<size_t>> scheduleFolderPairs(std::vector<size_t> pendingPairs /*configured order*/,
+                                                     const std::vector<FolderPairFootprint>& footprints,
+                                                     const std::vector<double>& syncSecondsEst)
+{
+    std::vector<std::vector<size_t>> batches;
+
+    while (!pendingPairs.empty())
+    {
+        std::vector<size_t> candidates = pendingPairs;
+        std::stable_sort(candidates.begin(), candidates.end(), [&](size_t lhs, size_t rhs) { return syncSecondsEst[lhs] > syncSecondsEst[rhs]; });
+
+        std::vector<size_t>& batch = batches.emplace_back();
+
+        auto canJoinBatch = [&](size_t folderIndex)
+        {
+            for (const size_t folderIndex2 : batch)
+                if (!canSyncConcurrently(footprints[folderIndex2], footprints[folderIndex]))
+                    return false;
+
+            //don't overtake a pending folder pair that comes first in configured order
+            for (auto it = pendingPairs.begin(); *it != folderIndex; ++it)
+                if (std::find(batch.begin(), batch.end(), *it) == batch.end() &&
+                    !canSyncConcurrently(footprints[*it], footprints[folderIndex]))
+                    return false;
+            return true;
+        };
+
+        for (const size_t folderIndex : candidates)
+            if (canJoinBatch(folderIndex))
+                batch.push_back(folderIndex);
+
+        assert(!batch.empty()); //first pending folder pair always qualifies
+        std::erase_if(pendingPairs, [&](size_t folderIndex) { return std::find(batch.begin(), batch.end(), folderIndex) != batch.end(); });
+    }
+    return batches;
+}
+
+
+//state of a folder pair from preparation until after sync: all folder pairs of a batch are prepared before syncing concurrently
+struct FolderPairSyncRun
+{
+    FolderPairSyncRun(BaseFolderPair& baseFolderIn, const FolderPairSyncCfg& folderPairCfgIn, const SyncStatistics& folderPairStatIn, const FolderPairFootprint& footprintIn,
+                      const AbstractPath& versioningFolderPathIn, DeletionPolicy delPolicyL, DeletionPolicy delPolicyR,
+                      bool compressVersions, time_t syncStartTime) :
+        baseFolder(baseFolderIn),
+        folderPairCfg(folderPairCfgIn),
+        folderPairStat(folderPairStatIn),
+        footprint(footprintIn),
+        versioningFolderPath(versioningFolderPathIn),
+        delHandlerL(baseFolder.getAbstractPath<SelectSide::left >(), delPolicyL, versioningFolderPath, folderPairCfg.versioningStyle, compressVersions, syncStartTime),
+        delHandlerR(baseFolder.getAbstractPath<SelectSide::right>(), delPolicyR, versioningFolderPath, folderPairCfg.versioningStyle, compressVersions, syncStartTime),
+        hardLinks(baseFolder) {}
+
+    BaseFolderPair& baseFolder;
+    const FolderPairSyncCfg& folderPairCfg;
+    const SyncStatistics& folderPairStat;
+    const FolderPairFootprint& footprint;
+    const AbstractPath versioningFolderPath;
+
+    DeletionHandler delHandlerL;
+    DeletionHandler delHandlerR;
+    HardLinkTracker hardLinks;
+    std::unique_ptr<DeviceBudget> deviceBudget;
+    std::optional<FolderPairSyncer::SyncCtx> syncCtx;
+
+    bool delCleanupDone = false;
+    bool dbSaveDone     = false;
+};
+
 }
 
 
@@ -2172,30 +3661,41 @@ void fff::synchronize(const std::chrono::system_clock::time_point& syncStartTime
                       bool copyLockedFiles,
                       bool copyFilePermissions,
                       bool failSafeFileCopy,
+                      bool syncDbJournal,
                       bool runWithBackgroundPriority,
+                      IoPriority ioPriority,
+                      bool dropPageCacheBehind,
+                      bool flushTargetBuffers,
+                      uint64_t deltaCopyMinSize,
+                      uint64_t resumableCopyMinSize,
+                      bool compressVersions,
                       const std::vector<FolderPairSyncCfg>& syncConfig,
                       FolderComparison& folderCmp,
+                      const std::map<AfsDevice, size_t>& deviceParallelOps,
+                      bool autoTuneParallelOps,
+                      bool globalDeviceBudget,
+                      const std::map<AfsDevice, uint64_t>& deviceBandwidthLimits,
+                      size_t autoRetryCount,
+                      std::chrono::seconds autoRetryDelay,
+                      SyncHistory& syncHistory,
                       WarningDialogs& warnings,
                       ProcessCallback& callback)
 {
-    //PERF_START;
+    ZEN_TRACE_SCOPE_ARG("synchronize", folderCmp.size())
 
     if (syncConfig.size() != folderCmp.size())
         throw std::logic_error("Contract violation! " + std::string(__FILE__) + ':' + numberTo<std::string>(__LINE__));
 
     //aggregate basic information
-    std::vector<SyncStatistics> folderPairStats;
+    const std::vector<SyncStatistics> folderPairStats = getFolderPairStats(folderCmp);
     {
         int     itemsTotal = 0;
         int64_t bytesTotal = 0;
-        std::for_each(begin(folderCmp), end(folderCmp),
-                      [&](const BaseFolderPair& baseFolder)
+        for (const SyncStatistics& fpStats : folderPairStats)
         {
-            SyncStatistics fpStats(baseFolder);
             itemsTotal += getCUD(fpStats);
             bytesTotal += fpStats.getBytesToProcess();
-            folderPairStats.push_back(fpStats);
-        });
+        }
 
         //inform about the total amount of data that will be processed from now on
         //keep at beginning so that all gui elements are initialized properly
@@ -2214,6 +3714,14 @@ void fff::synchronize(const std::chrono::system_clock::time_point& syncStartTime
         backgroundPrio = std::make_unique<ScheduleForBackgroundProcessing>(); //throw FileError
     }, callback); //throw X
 
+    setPageCacheDropBehind(dropPageCacheBehind);
+    ZEN_ON_SCOPE_EXIT(setPageCacheDropBehind(false));
+
+    std::map<AfsDevice, std::unique_ptr<BandwidthLimiter>> bandwidthLimiters;
+    for (const auto& [afsDevice, bytesPerSec] : deviceBandwidthLimits)
+        if (bytesPerSec > 0)
+            bandwidthLimiters.emplace(afsDevice, std::make_unique<BandwidthLimiter>(bytesPerSec));
+
     //prevent operating system going into sleep state
     std::unique_ptr<PreventStandby> noStandby;
     try
@@ -2235,9 +3743,11 @@ void fff::synchronize(const std::chrono::system_clock::time_point& syncStartTime
 
     std::vector<std::pair<AbstractPath, AbstractPath>> checkSignificantDiffPairs;
 
+    std::vector<std::pair<AbstractPath, int64_t>> checkDiskSpaceNeeded; //base folder / space required
     std::vector<std::pair<AbstractPath, std::pair<int64_t, int64_t>>> checkDiskSpaceMissing; //base folder / space required / space available
 
     //status of base directories which are set to DeletionPolicy::recycler (and contain actual items to be deleted)
+    std::set<AbstractPath> checkRecyclerPaths;
     std::map<AbstractPath, bool> recyclerSupported; //expensive to determine on Win XP => buffer + check recycle bin existence only once per base folder!
 
     std::set<AbstractPath>                                  checkVersioningPaths;
@@ -2304,8 +3814,8 @@ void fff::synchronize(const std::chrono::system_clock::time_point& syncStartTime
         //check for network drops after comparison
         // - convenience: exit sync right here instead of showing tons of errors during file copy
         // - early failure! there's no point in evaluating subsequent warnings
-        if (!checkBaseFolderStatus<SelectSide::left >(baseFolder, callback) ||
-            !checkBaseFolderStatus<SelectSide::right>(baseFolder, callback))
+        if (!checkBaseFolderStatus<SelectSide::left >(baseFolder, deviceParallelOps, callback) ||
+            !checkBaseFolderStatus<SelectSide::right>(baseFolder, deviceParallelOps, callback))
         {
             skipFolderPair[folderIndex] = true;
             continue;
@@ -2364,46 +3874,23 @@ void fff::synchronize(const std::chrono::system_clock::time_point& syncStartTime
                 checkSignificantDiffPairs.emplace_back(baseFolder.getAbstractPath<SelectSide::left >(),
                                                        baseFolder.getAbstractPath<SelectSide::right>());
 
-        //check for sufficient free diskspace
+        //prepare: check for sufficient free diskspace
         auto checkSpace = [&](const AbstractPath& baseFolderPath, int64_t minSpaceNeeded)
         {
             if (!AFS::isNullPath(baseFolderPath) && minSpaceNeeded > 0)
-                try
-                {
-                    const int64_t freeSpace = AFS::getFreeDiskSpace(baseFolderPath); //throw FileError, returns < 0 if not available
-
-                    if (0 <= freeSpace &&
-                        freeSpace < minSpaceNeeded)
-                        checkDiskSpaceMissing.push_back({baseFolderPath, {minSpaceNeeded, freeSpace}});
-                }
-                catch (const FileError& e) //not critical => log only
-                {
-                    callback.logInfo(e.toString()); //throw X
-                }
+                checkDiskSpaceNeeded.emplace_back(baseFolderPath, minSpaceNeeded);
         };
-        const std::pair<int64_t, int64_t> spaceNeeded = MinimumDiskSpaceNeeded::calculate(baseFolder);
-        checkSpace(baseFolder.getAbstractPath<SelectSide::left >(), spaceNeeded.first);
-        checkSpace(baseFolder.getAbstractPath<SelectSide::right>(), spaceNeeded.second);
+        checkSpace(baseFolder.getAbstractPath<SelectSide::left >(), folderPairStat.getSpaceNeeded<SelectSide::left >());
+        checkSpace(baseFolder.getAbstractPath<SelectSide::right>(), folderPairStat.getSpaceNeeded<SelectSide::right>());
 
-        //Windows: check if recycle bin really exists; if not, Windows will silently delete, which is just wrong
+        //prepare: Windows: check if recycle bin really exists; if not, Windows will silently delete, which is just wrong
         if (folderPairCfg.handleDeletion == DeletionPolicy::recycler)
         {
             auto checkRecycler = [&](const AbstractPath& baseFolderPath)
             {
                 assert(!AFS::isNullPath(baseFolderPath));
                 if (!AFS::isNullPath(baseFolderPath))
-                    if (!recyclerSupported.contains(baseFolderPath)) //perf: avoid duplicate checks!
-                    {
-                        callback.updateStatus(replaceCpy(_("Checking recycle bin availability for folder %x..."), L"%x", //throw X
-                                                         fmtPath(AFS::getDisplayPath(baseFolderPath))));
-                        bool recSupported = false;
-                        tryReportingError([&]
-                        {
-                            recSupported = AFS::supportsRecycleBin(baseFolderPath); //throw FileError
-                        }, callback); //throw X
-
-                        recyclerSupported.emplace(baseFolderPath, recSupported);
-                    }
+                    checkRecyclerPaths.insert(baseFolderPath); //perf: avoid duplicate checks!
             };
             if (folderPairStat.expectPhysicalDeletion<SelectSide::left>())
                 checkRecycler(baseFolder.getAbstractPath<SelectSide::left>());
@@ -2413,6 +3900,45 @@ void fff::synchronize(const std::chrono::system_clock::time_point& syncStartTime
         }
     }
     //-----------------------------------------------------------------
+    {
+        std::set<AbstractPath> diskSpacePaths;
+        for (const auto& [baseFolderPath, minSpaceNeeded] : checkDiskSpaceNeeded)
+            diskSpacePaths.insert(baseFolderPath);
+
+        const PreSyncChecks preSyncChecks = startPreSyncChecks(diskSpacePaths, checkRecyclerPaths, deviceParallelOps);
+
+        for (const auto& [baseFolderPath, minSpaceNeeded] : checkDiskSpaceNeeded)
+            try
+            {
+                const int64_t freeSpace = waitForPreSyncCheck(preSyncChecks.freeDiskSpace.find(baseFolderPath)->second, callback); //throw FileError, X
+
+                if (0 <= freeSpace &&
+                    freeSpace < minSpaceNeeded)
+                    checkDiskSpaceMissing.push_back({baseFolderPath, {minSpaceNeeded, freeSpace}});
+            }
+            catch (const FileError& e) //not critical => log only
+            {
+                callback.logInfo(e.toString()); //throw X
+            }
+
+        for (const AbstractPath& baseFolderPath : checkRecyclerPaths)
+        {
+            callback.updateStatus(replaceCpy(_("Checking recycle bin availability for folder %x..."), L"%x", //throw X
+                                             fmtPath(AFS::getDisplayPath(baseFolderPath))));
+            bool recSupported = false;
+            bool firstAttempt = true;
+            tryReportingError([&]
+            {
+                ZEN_ON_SCOPE_EXIT(firstAttempt = false);
+                recSupported = firstAttempt ?
+                               waitForPreSyncCheck(preSyncChecks.recyclerSupported.find(baseFolderPath)->second, callback) : //throw FileError, X
+                               AFS::supportsRecycleBin(baseFolderPath); //throw FileError
+            }, callback); //throw X
+
+            recyclerSupported.emplace(baseFolderPath, recSupported);
+        }
+    }
+    //-----------------------------------------------------------------
 
     //check if unresolved conflicts exist
     if (std::any_of(checkUnresolvedConflicts.begin(), checkUnresolvedConflicts.end(), [](const auto& item) { return item.second.first > 0; }))
@@ -2564,6 +4090,7 @@ void fff::synchronize(const std::chrono::system_clock::time_point& syncStartTime
     std::vector<FileError> errorsModTime; //show all warnings as a single message
 
     std::set<VersioningLimitFolder> versionLimitFolders;
+    std::map<AbstractPath, std::vector<VersionItem>> newVersions; //versioningFolderPath => versions created: incremental update of version index
 
     //------------------- show warnings after synchronization --------------------------------------
     //report errors when setting modification time as (a single) warning only!
@@ -2621,128 +4148,267 @@ void fff::synchronize(const std::chrono::system_clock::time_point& syncStartTime
 
     try
     {
-        //loop through all directory pairs
+        //sync aborted: version index lacks the versions created so far => make sure it's not used next time
+        auto guardVersionIndex = makeGuard<ScopeGuardRunMode::onFail>([&]
+        {
+            for (const auto& [versioningFolderPath, versions] : newVersions)
+                if (!versions.empty())
+                    invalidateVersionIndex(versioningFolderPath); //noexcept
+        });
+
+        //plan the order of folder pairs: folder pairs on independent devices are synchronized concurrently
+        std::vector<FolderPairFootprint> footprints;
+        std::vector<double> syncSecondsEst;
+        std::vector<size_t> pendingPairs;
+        bool haveAllEstimates = true;
+
         for (auto itBase = begin(folderCmp); itBase != end(folderCmp); ++itBase)
         {
-            BaseFolderPair& baseFolder = *itBase;
             const size_t folderIndex = itBase - begin(folderCmp);
             const FolderPairSyncCfg& folderPairCfg  = syncConfig     [folderIndex];
             const SyncStatistics&    folderPairStat = folderPairStats[folderIndex];
 
-            if (skipFolderPair[folderIndex]) //folder pairs may be skipped after fatal errors were found
-                continue;
+            footprints.push_back(getFolderPairFootprint(*itBase, folderPairCfg, folderPairStat, createAbstractPath(folderPairCfg.versioningFolderPhrase)));
 
-            //------------------------------------------------------------------------------------------
-            callback.logInfo(_("Synchronizing folder pair:") + L' ' + getVariantNameWithSymbol(folderPairCfg.syncVar) + L'\n' + //throw X
-                             L"    " + AFS::getDisplayPath(baseFolder.getAbstractPath<SelectSide::left >()) + L'\n' +
-                             L"    " + AFS::getDisplayPath(baseFolder.getAbstractPath<SelectSide::right>()));
-            //------------------------------------------------------------------------------------------
+            const std::optional<double> secondsEst = estimateSyncSeconds(syncHistory, *itBase, folderPairStat, footprints.back());
+            syncSecondsEst.push_back(secondsEst ? *secondsEst : getSyncCost(folderPairStat) / SYNC_HISTORY_BYTES_PER_SEC_DEFAULT);
 
-            //checking a second time: 1. a long time may have passed since syncing the previous folder pairs!
-            //                        2. expected to be run directly *before* createBaseFolder()!
-            if (!checkBaseFolderStatus<SelectSide::left >(baseFolder, callback) ||
-                !checkBaseFolderStatus<SelectSide::right>(baseFolder, callback))
-                continue;
+            if (!skipFolderPair[folderIndex]) //folder pairs may be skipped after fatal errors were found
+            {
+                pendingPairs.push_back(folderIndex);
+                if (!secondsEst)
+                    haveAllEstimates = false;
+            }
+        }
+        const std::vector<std::vector<size_t>> batches = scheduleFolderPairs(pendingPairs, footprints, syncSecondsEst);
 
-            //create base folders if not yet existing
-            if (folderPairStat.createCount() > 0 || folderPairCfg.saveSyncDB) //else: temporary network drop leading to deletions already caught by "sourceFolderMissing" check!
-                if (!createBaseFolder<SelectSide::left >(baseFolder, copyFilePermissions, callback) || //+ detect temporary network drop!!
-                    !createBaseFolder<SelectSide::right>(baseFolder, copyFilePermissions, callback))   //
-                    continue;
+        //each batch takes as long as its slowest folder pair
+        if (haveAllEstimates)
+        {
+            double secondsTotal = 0;
+            int64_t bytesTotal = 0;
+            for (const std::vector<size_t>& batch : batches)
+            {
+                double secondsMax = 0;
+                for (const size_t folderIndex : batch)
+                {
+                    secondsMax = std::max(secondsMax, syncSecondsEst[folderIndex]);
+                    bytesTotal += folderPairStats[folderIndex].getBytesToProcess();
+                }
+                secondsTotal += secondsMax;
+            }
+            if (secondsTotal > 0 && bytesTotal > 0)
+                callback.reportExpectedSpeed(bytesTotal / secondsTotal);
+        }
 
-            //------------------------------------------------------------------------------------------
-            //execute synchronization recursively
+        //loop through all directory pairs
+        for (const std::vector<size_t>& batchPairs : batches)
+        {
+            std::vector<std::unique_ptr<FolderPairSyncRun>> batch;
 
             //update database even when sync is cancelled:
-            auto guardDbSave = makeGuard<ScopeGuardRunMode::onFail>([&]
-            {
-                if (folderPairCfg.saveSyncDB)
-                    saveLastSynchronousState(baseFolder, failSafeFileCopy,
-                                             callbackNoThrow);
-            });
+            ZEN_ON_SCOPE_FAIL
+            (
+                for (const std::unique_ptr<FolderPairSyncRun>& run : batch)
+                    if (run->folderPairCfg.saveSyncDB && !run->dbSaveDone)
+                        saveLastSynchronousState(run->baseFolder, failSafeFileCopy, syncDbJournal,
+                                                 callbackNoThrow);
+            );
 
             //guarantee removal of invalid entries (where element is empty on both sides)
-            ZEN_ON_SCOPE_EXIT(BaseFolderPair::removeEmpty(baseFolder));
+            ZEN_ON_SCOPE_EXIT(for (const std::unique_ptr<FolderPairSyncRun>& run : batch) BaseFolderPair::removeEmpty(run->baseFolder));
 
-            bool copyPermissionsFp = false;
-            tryReportingError([&]
-            {
-                copyPermissionsFp = copyFilePermissions && //copy permissions only if asked for and supported by *both* sides!
-                !AFS::isNullPath(baseFolder.getAbstractPath<SelectSide::left >()) && //scenario: directory selected on one side only
-                !AFS::isNullPath(baseFolder.getAbstractPath<SelectSide::right>()) && //
-                AFS::supportPermissionCopy(baseFolder.getAbstractPath<SelectSide::left>(),
-                                           baseFolder.getAbstractPath<SelectSide::right>()); //throw FileError
-            }, callback); //throw X
+            //always (try to) clean up, even if synchronization is aborted!
+            ZEN_ON_SCOPE_FAIL
+            (
+                for (const std::unique_ptr<FolderPairSyncRun>& run : batch)
+                    if (!run->delCleanupDone)
+                    {
+                        run->delHandlerL.tryCleanup(callbackNoThrow);
+                        run->delHandlerR.tryCleanup(callbackNoThrow);
+                    }
+            );
 
+            //collect new versions even if synchronization is aborted: see guardVersionIndex
+            ZEN_ON_SCOPE_EXIT
+            (
+                for (const std::unique_ptr<FolderPairSyncRun>& run : batch)
+                {
+                    append(newVersions[run->versioningFolderPath], run->delHandlerL.extractNewVersions());
+                    append(newVersions[run->versioningFolderPath], run->delHandlerR.extractNewVersions());
+                }
+            );
 
-            auto getEffectiveDeletionPolicy = [&](const AbstractPath& baseFolderPath) -> DeletionPolicy
+            for (const size_t folderIndex : batchPairs)
             {
-                if (folderPairCfg.handleDeletion == DeletionPolicy::recycler)
+                BaseFolderPair& baseFolder = *folderCmp[folderIndex];
+                const FolderPairSyncCfg& folderPairCfg  = syncConfig     [folderIndex];
+                const SyncStatistics&    folderPairStat = folderPairStats[folderIndex];
+
+                const AbstractPath versioningFolderPath = createAbstractPath(folderPairCfg.versioningFolderPhrase);
+
+                //------------------------------------------------------------------------------------------
+                callback.logInfo(_("Synchronizing folder pair:") + L' ' + getVariantNameWithSymbol(folderPairCfg.syncVar) + L'\n' + //throw X
+                                 L"    " + AFS::getDisplayPath(baseFolder.getAbstractPath<SelectSide::left >()) + L'\n' +
+                                 L"    " + AFS::getDisplayPath(baseFolder.getAbstractPath<SelectSide::right>()));
+                //------------------------------------------------------------------------------------------
+
+                //checking a second time: 1. a long time may have passed since syncing the previous folder pairs!
+                //                        2. expected to be run directly *before* createBaseFolder()!
+                if (!checkBaseFolderStatus<SelectSide::left >(baseFolder, deviceParallelOps, callback) ||
+                    !checkBaseFolderStatus<SelectSide::right>(baseFolder, deviceParallelOps, callback))
+                    continue;
+
+                //create base folders if not yet existing
+                if (folderPairStat.createCount() > 0 || folderPairCfg.saveSyncDB) //else: temporary network drop leading to deletions already caught by "sourceFolderMissing" check!
+                    if (!createBaseFolder<SelectSide::left >(baseFolder, copyFilePermissions, callback) || //+ detect temporary network drop!!
+                        !createBaseFolder<SelectSide::right>(baseFolder, copyFilePermissions, callback))   //
+                        continue;
+
+                //------------------------------------------------------------------------------------------
+                bool copyPermissionsFp = false;
+                tryReportingError([&]
+                {
+                    copyPermissionsFp = copyFilePermissions && //copy permissions only if asked for and supported by *both* sides!
+                    !AFS::isNullPath(baseFolder.getAbstractPath<SelectSide::left >()) && //scenario: directory selected on one side only
+                    !AFS::isNullPath(baseFolder.getAbstractPath<SelectSide::right>()) && //
+                    AFS::supportPermissionCopy(baseFolder.getAbstractPath<SelectSide::left>(),
+                                               baseFolder.getAbstractPath<SelectSide::right>()); //throw FileError
+                }, callback); //throw X
+
+
+                auto getEffectiveDeletionPolicy = [&](const AbstractPath& baseFolderPath) -> DeletionPolicy
+                {
+                    if (folderPairCfg.handleDeletion == DeletionPolicy::recycler)
+                    {
+                        auto it = recyclerSupported.find(baseFolderPath);
+                        if (it != recyclerSupported.end()) //buffer filled during intro checks (but only if deletions are expected)
+                            if (!it->second)
+                                return DeletionPolicy::permanent; //Windows' ::SHFileOperation() will do this anyway, but we have a better and faster deletion routine (e.g. on networks)
+                    }
+                    return folderPairCfg.handleDeletion;
+                };
+
+                //from now on, guards of the batch take care of this folder pair
+                FolderPairSyncRun& run = *batch.emplace_back(std::make_unique<FolderPairSyncRun>(baseFolder, folderPairCfg, folderPairStat, footprints[folderIndex], versioningFolderPath,
+                                                                                                 getEffectiveDeletionPolicy(baseFolder.getAbstractPath<SelectSide::left >()),
+                                                                                                 getEffectiveDeletionPolicy(baseFolder.getAbstractPath<SelectSide::right>()),
+                                                                                                 compressVersions,
+                                                                                                 std::chrono::system_clock::to_time_t(syncStartTime)));
+
+                //system-wide budget: only for devices configured for parallel operations; single-op devices (e.g. local disks) would serialize unrelated jobs
+                if (globalDeviceBudget)
                 {
-                    auto it = recyclerSupported.find(baseFolderPath);
-                    if (it != recyclerSupported.end()) //buffer filled during intro checks (but only if deletions are expected)
-                        if (!it->second)
-                            return DeletionPolicy::permanent; //Windows' ::SHFileOperation() will do this anyway, but we have a better and faster deletion routine (e.g. on networks)
+                    std::map<AfsDevice, size_t> deviceSlots;
+                    for (const AfsDevice& afsDevice : {baseFolder.getAbstractPath<SelectSide::left >().afsDevice,
+                                                       baseFolder.getAbstractPath<SelectSide::right>().afsDevice})
+                        if (const size_t parallelOps = getDeviceParallelOps(deviceParallelOps, afsDevice);
+                            parallelOps > 1)
+                            deviceSlots.emplace(afsDevice, parallelOps);
+
+                    if (!deviceSlots.empty())
+                        try
+                        {
+                            run.deviceBudget = std::make_unique<DeviceBudget>(deviceSlots); //throw FileError
+                        }
+                        catch (const FileError& e) //not critical => sync within the process' own budget
+                        {
+                            callback.logInfo(e.toString()); //throw X
+                        }
                 }
-                return folderPairCfg.handleDeletion;
-            };
-            const AbstractPath versioningFolderPath = createAbstractPath(folderPairCfg.versioningFolderPhrase);
 
-            DeletionHandler delHandlerL(baseFolder.getAbstractPath<SelectSide::left>(),
-                                        getEffectiveDeletionPolicy(baseFolder.getAbstractPath<SelectSide::left>()),
-                                        versioningFolderPath,
-                                        folderPairCfg.versioningStyle,
-                                        std::chrono::system_clock::to_time_t(syncStartTime));
+                run.syncCtx.emplace(FolderPairSyncer::SyncCtx
+                {
+                    verifyCopiedFiles, copyPermissionsFp, failSafeFileCopy,
+                    deltaCopyMinSize,
+                    resumableCopyMinSize,
+                    errorsModTime,
+                    run.delHandlerL, run.delHandlerR,
+                    run.hardLinks,
+                    //one parallel op per device: only file I/O runs in parallel => use max of both sides
+                    std::max(getDeviceParallelOps(deviceParallelOps, baseFolder.getAbstractPath<SelectSide::left >().afsDevice),
+                             getDeviceParallelOps(deviceParallelOps, baseFolder.getAbstractPath<SelectSide::right>().afsDevice)),
+                    autoTuneParallelOps,
+                    ioPriority,
+                    bandwidthLimiters,
+                    run.deviceBudget.get(),
+                    autoRetryCount,
+                    autoRetryDelay,
+                });
+            }
 
-            DeletionHandler delHandlerR(baseFolder.getAbstractPath<SelectSide::right>(),
-                                        getEffectiveDeletionPolicy(baseFolder.getAbstractPath<SelectSide::right>()),
-                                        versioningFolderPath,
-                                        folderPairCfg.versioningStyle,
-                                        std::chrono::system_clock::to_time_t(syncStartTime));
+            if (batch.empty())
+                continue;
 
-            //always (try to) clean up, even if synchronization is aborted!
-            auto guardDelCleanup = makeGuard<ScopeGuardRunMode::onFail>([&]
-            {
-                delHandlerL.tryCleanup(callbackNoThrow);
-                delHandlerR.tryCleanup(callbackNoThrow);
-            });
+            //------------------------------------------------------------------------------------------
+            //execute synchronization recursively
+            FolderPairSyncer::FolderPairList folderPairs;
+            for (const std::unique_ptr<FolderPairSyncRun>& run : batch)
+                folderPairs.emplace_back(&*run->syncCtx, &run->baseFolder);
 
+            const std::vector<std::chrono::nanoseconds> syncTimes = FolderPairSyncer::runSync(folderPairs, callback); //throw X
 
-            FolderPairSyncer::SyncCtx syncCtx =
+            for (size_t i = 0; i < batch.size(); ++i)
+                updateSyncHistory(syncHistory, batch[i]->baseFolder, batch[i]->folderPairStat, batch[i]->footprint, syncTimes[i],
+                                  std::chrono::system_clock::to_time_t(syncStartTime));
+
+            //finish folder pairs one after another: DB save and versioning same as for sequential sync
+            for (const std::unique_ptr<FolderPairSyncRun>& run : batch)
             {
-                verifyCopiedFiles, copyPermissionsFp, failSafeFileCopy,
-                errorsModTime,
-                delHandlerL, delHandlerR,
-            };
-            FolderPairSyncer::runSync(syncCtx, baseFolder, callback);
+                BaseFolderPair& baseFolder = run->baseFolder;
+                const FolderPairSyncCfg& folderPairCfg  = run->folderPairCfg;
+                const SyncStatistics&    folderPairStat = run->folderPairStat;
+
+                //(try to gracefully) clean up temporary Recycle Bin folders and versioning: before flushing the versioning folder
+                run->delHandlerL.tryCleanup(callback); //throw X
+                run->delHandlerR.tryCleanup(callback); //
+                run->delCleanupDone = true;
+
+                //make sure the written data is on disk *before* sync.ffs_db claims both sides are in sync
+                //no need to do the same on failure/cancel: database only contains what was synced
+                if (flushTargetBuffers)
+                {
+                    std::vector<AbstractPath> flushFolderPaths;
+                    if (folderPairStat.createCount<SelectSide::left>() + folderPairStat.updateCount<SelectSide::left>() + folderPairStat.deleteCount<SelectSide::left>() > 0)
+                        flushFolderPaths.push_back(baseFolder.getAbstractPath<SelectSide::left>());
+                    if (folderPairStat.createCount<SelectSide::right>() + folderPairStat.updateCount<SelectSide::right>() + folderPairStat.deleteCount<SelectSide::right>() > 0)
+                        flushFolderPaths.push_back(baseFolder.getAbstractPath<SelectSide::right>());
+                    if (folderPairCfg.handleDeletion == DeletionPolicy::versioning)
+                        flushFolderPaths.push_back(run->versioningFolderPath);
+
+                    flushFileSystemBuffers(flushFolderPaths, callback); //throw X
+                }
 
-            //(try to gracefully) clean up temporary Recycle Bin folders and versioning
-            delHandlerL.tryCleanup(callback); //throw X
-            delHandlerR.tryCleanup(callback); //
-            guardDelCleanup.dismiss();
+                if (folderPairCfg.handleDeletion == DeletionPolicy::versioning &&
+                    folderPairCfg.versioningStyle != VersioningStyle::replace)
+                    versionLimitFolders.insert(
+                {
+                    run->versioningFolderPath,
+                    folderPairCfg.versionMaxAgeDays,
+                    folderPairCfg.versionCountMin,
+                    folderPairCfg.versionCountMax
+                });
 
-            if (folderPairCfg.handleDeletion == DeletionPolicy::versioning &&
-                folderPairCfg.versioningStyle != VersioningStyle::replace)
-                versionLimitFolders.insert(
-            {
-                versioningFolderPath,
-                folderPairCfg.versionMaxAgeDays,
-                folderPairCfg.versionCountMin,
-                folderPairCfg.versionCountMax
-            });
+                //(try to gracefully) write database file
+                if (folderPairCfg.saveSyncDB)
+                {
+                    const bool dbSaved = saveLastSynchronousState(baseFolder, failSafeFileCopy, syncDbJournal, //throw X
+                                                                  callback /*throw X*/);
+                    run->dbSaveDone = true; //[!] after "graceful" try: user might have cancelled during DB write: ensure DB is still written
 
-            //(try to gracefully) write database file
-            if (folderPairCfg.saveSyncDB)
-            {
-                saveLastSynchronousState(baseFolder, failSafeFileCopy, //throw X
-                                         callback /*throw X*/);
-                guardDbSave.dismiss(); //[!] after "graceful" try: user might have cancelled during DB write: ensure DB is still written
+                    if (dbSaved) //snapshot must never be newer than sync.ffs_db!
+                    {
+                        commitFolderSnapshot<SelectSide::left >(baseFolder, callback); //throw X
+                        commitFolderSnapshot<SelectSide::right>(baseFolder, callback); //
+                    }
+                }
             }
         }
         //-----------------------------------------------------------------------------------------------------
 
-        applyVersioningLimit(versionLimitFolders,
+        applyVersioningLimit(versionLimitFolders, newVersions, deviceParallelOps,
                              callback /*throw X*/);
+        guardVersionIndex.dismiss();
     }
     catch (const std::exception& e)
     {
@@ -8,6 +8,10 @@
 #define SYNCHRONIZATION_H_8913470815943295
 
 #include <chrono>
+#include <unordered_set>
+#include <unordered_map>
+#include <memory>
+#include <zen/process_priority.h>
 #include "structures.h"
 #include "file_hierarchy.h"
 #include "process_callback.h"
@@ -19,27 +23,30 @@ class SyncStatistics //count *logical* operations, (create, update, delete + byt
 {
     //-> note the fundamental difference compared to counting disk accesses!
 public:
-    explicit SyncStatistics(const FolderComparison& folderCmp);
+    explicit SyncStatistics(const FolderComparison& folderCmp); //base folder pairs are evaluated in parallel
     explicit SyncStatistics(const ContainerObject& hierObj);
     explicit SyncStatistics(const FilePair& file);
 
     template <SelectSide side>
-    int createCount() const { return selectParam<side>(createLeft_, createRight_); }
-    int createCount() const { return createLeft_ + createRight_; }
+    int createCount() const { return selectParam<side>(counts_.createLeft, counts_.createRight); }
+    int createCount() const { return counts_.createLeft + counts_.createRight; }
 
     template <SelectSide side>
-    int updateCount() const { return selectParam<side>(updateLeft_, updateRight_); }
-    int updateCount() const { return updateLeft_ + updateRight_; }
+    int updateCount() const { return selectParam<side>(counts_.updateLeft, counts_.updateRight); }
+    int updateCount() const { return counts_.updateLeft + counts_.updateRight; }
 
     template <SelectSide side>
-    int deleteCount() const { return selectParam<side>(deleteLeft_, deleteRight_); }
-    int deleteCount() const { return deleteLeft_ + deleteRight_; }
+    int deleteCount() const { return selectParam<side>(counts_.deleteLeft, counts_.deleteRight); }
+    int deleteCount() const { return counts_.deleteLeft + counts_.deleteRight; }
 
     template <SelectSide side>
-    bool expectPhysicalDeletion() const { return selectParam<side>(physicalDeleteLeft_, physicalDeleteRight_); }
+    bool expectPhysicalDeletion() const { return selectParam<side>(counts_.physicalDeleteLeft, counts_.physicalDeleteRight); }
 
-    int64_t getBytesToProcess() const { return bytesToProcess_; }
-    size_t  rowCount         () const { return rowsTotal_; }
+    int64_t getBytesToProcess() const { return counts_.bytesToProcess; }
+    size_t  rowCount         () const { return counts_.rowsTotal; }
+
+    template <SelectSide side> //minimum disk space needed: generally assume deletion frees space (may be negative)
+    int64_t getSpaceNeeded() const { return selectParam<side>(counts_.spaceNeededLeft, counts_.spaceNeededRight); }
 
     struct ConflictInfo
     {
@@ -47,30 +54,75 @@ public:
         std::wstring msg;
     };
     const std::vector<ConflictInfo>& getConflictsPreview() const { return conflictsPreview_; }
-    int conflictCount() const { return conflictCount_; }
+    int conflictCount() const { return counts_.conflictCount; }
 
 private:
+    friend class SyncStatisticsBuffer;
+    SyncStatistics() {}
+
+    struct Counts //everything that can be summed up per sub tree => see SyncStatisticsBuffer
+    {
+        int createLeft  = 0;
+        int createRight = 0;
+        int updateLeft  = 0;
+        int updateRight = 0;
+        int deleteLeft  = 0;
+        int deleteRight = 0;
+        bool physicalDeleteLeft  = false; //at least 1 item will be deleted; considers most "update" cases which also delete items
+        bool physicalDeleteRight = false; //
+
+        int64_t bytesToProcess = 0;
+        size_t rowsTotal = 0;
+        int conflictCount = 0;
+
+        int64_t spaceNeededLeft  = 0;
+        int64_t spaceNeededRight = 0;
+
+        void add(const Counts& sub, bool addSpaceNeeded);
+    };
+
     void recurse(const ContainerObject& hierObj);
+    void merge(const SyncStatistics& other);
+    void addConflictPreview(const FileSystemObject& fsObj);
 
-    void processFile  (const FilePair& file);
-    void processLink  (const SymlinkPair& symlink);
-    void processFolder(const FolderPair& folder);
+    void initHardLinkDetection(const BaseFolderPair& baseFolder);
+    void addCopyBytes(SelectSide sideSrc, AFS::FingerPrint filePrint, uint64_t fileSize);
 
-    int createLeft_  = 0;
-    int createRight_ = 0;
-    int updateLeft_  = 0;
-    int updateRight_ = 0;
-    int deleteLeft_  = 0;
-    int deleteRight_ = 0;
-    bool physicalDeleteLeft_  = false; //at least 1 item will be deleted; considers most "update" cases which also delete items
-    bool physicalDeleteRight_ = false; //
+    //evaluate a single item, but not the sub tree of a folder:
+    template <class AddCopyBytesFun> //void(SelectSide sideSrc, AFS::FingerPrint filePrint, uint64_t fileSize): file to be created on the *other* side
+    static void processFile  (const FilePair&    file,    SyncOperation so, Counts& counts, AddCopyBytesFun addCopyBytes);
+    static void processLink  (const SymlinkPair& symlink, SyncOperation so, Counts& counts);
+    static void processFolder(const FolderPair&  folder,  SyncOperation so, Counts& counts);
+    static bool addsSpaceNeeded(const FolderPair& folder, SyncOperation so); //consider sub tree for getSpaceNeeded()?
 
-    int64_t bytesToProcess_ = 0;
-    size_t rowsTotal_ = 0;
+    Counts counts_;
 
-    int conflictCount_ = 0;
     std::vector<ConflictInfo> conflictsPreview_; //conflict texts to display as a warning message
     //limit conflict count! e.g. there may be hundred thousands of "same date but a different size"
+
+    bool detectHardLinks_ = false; //see HardLinkTracker: native on both sides => only the first copy of a hard link group transfers data
+    std::unordered_set<AFS::FingerPrint> copiedFilePrintsL_; //source file prints of files to create on the *other* side
+    std::unordered_set<AFS::FingerPrint> copiedFilePrintsR_; //
+};
+
+
+/*  GUI: SyncStatistics are needed after every change of sync directions or active status
+    => buffer aggregates per sub tree: only sub trees with a changed ContainerObject::getChangeId() are evaluated again
+    => changing the direction of a single folder costs the path to the root, not a full tree walk          */
+class SyncStatisticsBuffer
+{
+public:
+    SyncStatisticsBuffer();
+    ~SyncStatisticsBuffer();
+
+    SyncStatistics get(const FolderComparison& folderCmp); //base folder pairs are evaluated in parallel
+
+private:
+    SyncStatisticsBuffer           (const SyncStatisticsBuffer&) = delete;
+    SyncStatisticsBuffer& operator=(const SyncStatisticsBuffer&) = delete;
+
+    struct BaseFolderBuffer;
+    std::unordered_map<const BaseFolderPair*, std::unique_ptr<BaseFolderBuffer>> baseBuffers_; //weak pointers: *never dereference*!
 };
 
 
@@ -94,9 +146,23 @@ void synchronize(const std::chrono::system_clock::time_point& syncStartTime,
                  bool copyLockedFiles,
                  bool copyFilePermissions,
                  bool failSafeFileCopy,
+                 bool syncDbJournal, //save sync.ffs_db changes as journal files
                  bool runWithBackgroundPriority,
+                 zen::IoPriority ioPriority, //worker threads
+                 bool dropPageCacheBehind, //streaming copies: don't evict the page cache of other applications
+                 bool flushTargetBuffers,  //syncfs() written file systems before saving sync.ffs_db
+                 uint64_t deltaCopyMinSize, //update files of at least this size by writing changed blocks only; 0: disabled
+                 uint64_t resumableCopyMinSize, //keep partial temp files of at least this size and continue next time; 0: disabled
+                 bool compressVersions, //versioning: store copied versions compressed
                  const std::vector<FolderPairSyncCfg>& syncConfig, //CONTRACT: syncConfig and folderCmp correspond row-wise!
                  FolderComparison& folderCmp,                      //
+                 const std::map<AfsDevice, size_t>& deviceParallelOps,
+                 bool autoTuneParallelOps, //deviceParallelOps is upper limit: adapt number of parallel operations to measured throughput
+                 bool globalDeviceBudget,  //deviceParallelOps is shared with other FreeFileSync processes syncing the same device
+                 const std::map<AfsDevice, uint64_t>& deviceBandwidthLimits, //bytes per second, shared by all file copies reading from or writing to the device
+                 size_t autoRetryCount, //files and symlinks: retry failed items after autoRetryDelay without blocking a worker thread
+                 std::chrono::seconds autoRetryDelay,
+                 SyncHistory& syncHistory, //in: plan folder pair order and remaining time; out: updated with this sync's measurements
                  WarningDialogs& warnings,
                  ProcessCallback& callback);
 }
@@ -5,9 +5,18 @@
 // *****************************************************************************
 
 #include "versioning.h"
+#include <unordered_set>
+#include <zen/crc.h>
+#include <zen/zlib_wrap.h>
+#ifdef HAVE_ZSTD
+    #include <zen/zstd_wrap.h>
+#endif
+#include <zen/guid.h>
 #include "parallel_scan.h"
 #include "status_handler_impl.h"
 #include "dir_exist_async.h"
+#include "db_file.h"
+#include "dedup_store.h"
 
 using namespace zen;
 using namespace fff;
@@ -73,7 +82,7 @@ time_t fff::impl::parseVersionedFolderName(const Zstring& folderName)
 }
 
 
-AbstractPath FileVersioner::generateVersionedPath(const Zstring& relativePath) const
+Zstring FileVersioner::generateVersionedRelPath(const Zstring& relativePath) const
 {
     assert(isValidRelPath(relativePath));
     assert(!relativePath.empty());
@@ -88,13 +97,20 @@ AbstractPath FileVersioner::generateVersionedPath(const Zstring& relativePath) c
             versionedRelPath = timeStamp_ + FILE_NAME_SEPARATOR + relativePath;
             break;
         case VersioningStyle::timestampFile: //assemble time-stamped version name
+        case VersioningStyle::deduplicate:   //file versions: + DEDUP_MANIFEST_ENDING
             versionedRelPath = relativePath + Zstr(' ') + timeStamp_ + getDotExtension(relativePath);
             assert(impl::parseVersionedFileName(afterLast(versionedRelPath, FILE_NAME_SEPARATOR, IfNotFoundReturn::all)) ==
                    std::pair(syncStartTime_, afterLast(relativePath, FILE_NAME_SEPARATOR, IfNotFoundReturn::all)));
-            (void)syncStartTime_; //clang: -Wunused-private-field
             break;
     }
-    return AFS::appendRelPath(versioningFolderPath_, versionedRelPath);
+    return versionedRelPath;
+}
+
+
+void FileVersioner::addNewVersion(const Zstring& relativePath, const Zstring& versionedRelPath, bool isSymlink) const
+{
+    if (versioningStyle_ != VersioningStyle::replace) //no versions from the point of view of applyVersioningLimit()
+        newVersions_.access([&](std::vector<VersionItem>& versions) { versions.push_back({relativePath, versionedRelPath, syncStartTime_, isSymlink}); });
 }
 
 
@@ -106,7 +122,8 @@ namespace
     - target parent directories are created if missing                                 */
 template <class Function>
 void moveExistingItemToVersioning(const AbstractPath& sourcePath, const AbstractPath& targetPath, //throw FileError
-                                  Function copyNewItemPlain /*throw FileError*/)
+                                  Function copyNewItemPlain /*throw FileError*/,
+                                  std::atomic<bool>* moveUnsupported = nullptr) //optional: remember for the next item
 {
     //start deleting existing target as required by copyFileTransactional()/moveAndRenameItem():
     //best amortized performance if "already existing" is the most common case
@@ -148,6 +165,8 @@ void moveExistingItemToVersioning(const AbstractPath& sourcePath, const Abstract
     }
     catch (ErrorMoveUnsupported&)
     {
+        if (moveUnsupported)
+            *moveUnsupported = true;
         try
         {
             copyNewItemPlain(); //throw FileError
@@ -173,11 +192,66 @@ void moveExistingItemToVersioning(const AbstractPath& sourcePath, const Abstract
         }
         catch (ErrorMoveUnsupported&)
         {
+            if (moveUnsupported)
+                *moveUnsupported = true;
             copyNewItemPlain(); //throw FileError
             AFS::removeFilePlain(sourcePath); //throw FileError
         }
     }
 }
+
+
+//versions that have to be copied anyway (different device) => compress on the fly: CPU is cheap compared to network and disk space
+#ifdef HAVE_ZSTD
+const Zchar COMPRESSED_VERSION_ENDING[] = Zstr(".zst");
+#else
+const Zchar COMPRESSED_VERSION_ENDING[] = Zstr(".gz");
+#endif
+const int COMPRESSED_VERSION_ZSTD_LEVEL = 3; //zstd default: similar speed as gzip level 1, but better ratio
+const unsigned int COMPRESSED_VERSION_ZSTD_THREADS_MAX = 4;
+
+
+Zstring stripCompressedVersionEnding(const Zstring& fileName)
+{
+    for (const Zchar* ending : {Zstr(".zst"), Zstr(".gz")}) //consider both: versioning folder might have been filled by a build with/without zstd
+        if (endsWith(fileName, ending))
+            return Zstring(fileName.begin(), fileName.end() - strLength(ending));
+    return fileName;
+}
+
+
+//already existing: undefined behavior! (e.g. fail/overwrite/auto-rename)
+void copyFileCompressed(const AbstractPath& sourcePath, time_t modTime, const AbstractPath& targetPath, //throw FileError, ErrorFileLocked, X
+                        const IoCallback& notifyUnbufferedIO /*throw X*/)
+{
+    const std::unique_ptr<AFS::InputStream> streamIn = AFS::getInputStream(sourcePath, notifyUnbufferedIO); //throw FileError, ErrorFileLocked
+
+    auto readBlock = [&](void* buffer, size_t bytesToRead) { return streamIn->read(buffer, bytesToRead); }; //throw FileError, ErrorFileLocked, X
+
+    const std::unique_ptr<AFS::OutputStream> streamOut = AFS::getOutputStream(targetPath, std::nullopt /*streamSize: unknown after compression*/, modTime, notifyUnbufferedIO); //throw FileError
+    try
+    {
+#ifdef HAVE_ZSTD
+        InputStreamAsZstd compressedStream(readBlock, COMPRESSED_VERSION_ZSTD_LEVEL, //throw SysError
+                                           static_cast<int>(std::min(std::thread::hardware_concurrency(), COMPRESSED_VERSION_ZSTD_THREADS_MAX)));
+#else
+        InputStreamAsGzip compressedStream(readBlock); //throw SysError
+#endif
+        std::vector<std::byte> buffer(streamIn->getBlockSize());
+        for (;;)
+        {
+            const size_t bytesRead = compressedStream.read(buffer.data(), buffer.size()); //throw SysError, FileError, ErrorFileLocked, X; return "bytesToRead" bytes unless end of stream!
+            streamOut->write(buffer.data(), bytesRead); //throw FileError, X
+
+            if (bytesRead != buffer.size()) //end of file
+                break;
+        }
+    }
+    catch (const SysError& e) { throw FileError(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(AFS::getDisplayPath(targetPath))), e.toString()); }
+
+    /*const AFS::FinalizeResult result =*/ streamOut->finalize(); //throw FileError, X
+    //result.errorModTime? => irrelevant for versioning!
+}
 }
 
 
@@ -188,19 +262,156 @@ void FileVersioner::revisionFile(const FileDescriptor& fileDescr, const Zstring&
         if (*type == AFS::ItemType::symlink)
             revisionSymlinkImpl(fileDescr.path, relativePath, nullptr /*onBeforeMove*/); //throw FileError
         else
+        {
+            if (moveUnsupported_ && versioningStyle_ != VersioningStyle::deduplicate) //not for revisionFolder(): staged files would prevent deleting the source folder
+            {
+                const Zstring versionedRelPath = generateVersionedRelPath(relativePath);
+                if (tryStageFile(fileDescr, relativePath, versionedRelPath)) //noexcept
+                    return;
+            }
             revisionFileImpl(fileDescr, relativePath, nullptr /*onBeforeMove*/, notifyUnbufferedIO); //throw FileError, X
+        }
     }
     //else -> missing source item is not an error => check BEFORE deleting target
 }
 
 
+bool FileVersioner::tryStageFile(const FileDescriptor& fileDescr, const Zstring& relativePath, const Zstring& versionedRelPath) const //noexcept
+{
+    const std::optional<AbstractPath> parentPath = AFS::getParentPath(fileDescr.path);
+    if (!parentPath)
+        return false;
+
+    const uint16_t shortGuid = static_cast<uint16_t>(getCrc16(generateGUID()));
+    const AbstractPath stagedPath = AFS::appendRelPath(*parentPath, AFS::getItemName(fileDescr.path) + Zstr('.') +
+                                                       printNumber<Zstring>(Zstr("%04x"), static_cast<unsigned int>(shortGuid)) + AFS::TEMP_FILE_ENDING);
+    try
+    {
+        AFS::moveAndRenameItem(fileDescr.path, stagedPath); //throw FileError, ErrorMoveUnsupported
+    }
+    catch (FileError&) { return false; } //=> let revisionFileImpl() report the error (if any)
+
+    StagedVersion sv{stagedPath, fileDescr.path, {fileDescr.attr.modTime, fileDescr.attr.fileSize, fileDescr.attr.filePrint}, relativePath, versionedRelPath};
+
+    asyncVersioning_.access([&](std::unique_ptr<ThreadGroup<std::function<void()>>>& threadGroup)
+    {
+        if (!threadGroup)
+            threadGroup = std::make_unique<ThreadGroup<std::function<void()>>>(1, Zstr("Versioning"));
+
+        threadGroup->run([this, sv = std::move(sv)]
+        {
+            try
+            {
+                revisionStagedFile(sv, [](int64_t bytesDelta) { interruptionPoint(); }); //throw FileError, ThreadStopRequest
+            }
+            catch (const FileError& e) { stagedFailed_.access([&](auto& failed) { failed.emplace_back(sv, e.toString()); }); }
+        });
+    });
+    return true;
+}
+
+
+void FileVersioner::revisionStagedFile(const StagedVersion& sv, const IoCallback& notifyUnbufferedIO /*throw X*/) const //throw FileError, X
+{
+    if (compressCopies_) //staged => copy needed for sure
+        return revisionFileCompressed(sv.stagedPath, sv.attr.modTime, sv.relativePath, sv.versionedRelPath, notifyUnbufferedIO); //throw FileError, X
+
+    const AbstractPath targetPath = AFS::appendRelPath(versioningFolderPath_, sv.versionedRelPath);
+
+    moveExistingItemToVersioning(sv.stagedPath, targetPath, [&] //throw FileError
+    {
+        /*const AFS::FileCopyResult result =*/ AFS::copyFileTransactional(sv.stagedPath, sv.attr, targetPath, //throw FileError, ErrorFileLocked, X
+                                                                          false, //copyFilePermissions
+                                                                          false, //transactionalCopy: not needed for versioning! partial copy will be overwritten next time
+                                                                          false, //deltaCopy
+                                                                          std::nullopt /*resumableCopy*/,
+                                                                          nullptr /*onDeleteTargetFile*/, notifyUnbufferedIO, std::nullopt /*sourceHashAlgo*/);
+    });
+
+    addNewVersion(sv.relativePath, sv.versionedRelPath, false /*isSymlink*/);
+}
+
+
+void FileVersioner::finishAsyncVersioning(PhaseCallback& callback /*throw X*/) //throw X
+{
+    assert(runningOnMainThread());
+
+    std::future<void> allDone;
+    asyncVersioning_.access([&](std::unique_ptr<ThreadGroup<std::function<void()>>>& threadGroup)
+    {
+        if (threadGroup)
+        {
+            auto promiseDone = std::make_shared<std::promise<void>>();
+            allDone = promiseDone->get_future();
+            threadGroup->notifyWhenDone([promiseDone] { promiseDone->set_value(); });
+        }
+    });
+    if (!allDone.valid())
+        return;
+
+    while (allDone.wait_for(UI_UPDATE_INTERVAL / 2) != std::future_status::ready)
+        callback.requestUiUpdate(); //throw X
+
+    std::vector<std::pair<StagedVersion, std::wstring>> failedItems;
+    stagedFailed_.access([&](auto& failed) { failedItems.swap(failed); });
+
+    const std::wstring txtMovingFileXtoY = _("Moving file %x to %y");
+
+    for (const auto& [sv, errorMsg] : failedItems)
+    {
+        callback.logInfo(errorMsg); //throw X
+
+        const std::wstring errMsg = tryReportingError([&, &sv = sv] //retry on main thread
+        {
+            callback.updateStatus(replaceCpy(replaceCpy(txtMovingFileXtoY, L"%x", fmtPath(AFS::getDisplayPath(sv.stagedPath))),
+                                             L"%y", fmtPath(AFS::getDisplayPath(AFS::appendRelPath(versioningFolderPath_, sv.versionedRelPath))))); //throw X
+
+            revisionStagedFile(sv, [&](int64_t bytesDelta) { callback.requestUiUpdate(); }); //throw FileError, X
+        }, callback); //throw X
+
+        if (!errMsg.empty()) //don't leave *.ffs_tmp behind if avoidable: next sync would delete it!
+            try
+            {
+                if (!AFS::itemStillExists(sv.origPath)) //throw FileError
+                    AFS::moveAndRenameItem(sv.stagedPath, sv.origPath); //throw FileError, ErrorMoveUnsupported
+            }
+            catch (FileError&) {}
+    }
+}
+
+
 void FileVersioner::revisionFileImpl(const FileDescriptor& fileDescr, const Zstring& relativePath, //throw FileError, X
                                      const std::function<void(const std::wstring& displayPathFrom, const std::wstring& displayPathTo)>& onBeforeMove,
                                      const IoCallback& notifyUnbufferedIO  /*throw X*/) const
 {
     const AbstractPath& filePath = fileDescr.path;
 
-    const AbstractPath targetPath = generateVersionedPath(relativePath);
+    if (versioningStyle_ == VersioningStyle::deduplicate) //no move: content is always read
+    {
+        const Zstring manifestRelPath = generateVersionedRelPath(relativePath) + DEDUP_MANIFEST_ENDING;
+        const AbstractPath manifestPath = AFS::appendRelPath(versioningFolderPath_, manifestRelPath);
+
+        if (onBeforeMove)
+            onBeforeMove(AFS::getDisplayPath(filePath), AFS::getDisplayPath(manifestPath));
+
+        storeDedupVersion(filePath, fileDescr.attr.modTime, versioningFolderPath_, manifestPath, notifyUnbufferedIO); //throw FileError, ErrorFileLocked, X
+        AFS::removeFilePlain(filePath); //throw FileError
+
+        addNewVersion(relativePath, manifestRelPath, false /*isSymlink*/);
+        return;
+    }
+
+    const Zstring versionedRelPath = generateVersionedRelPath(relativePath);
+
+    if (compressCopies_ && moveUnsupported_) //known to require copy + delete
+    {
+        if (onBeforeMove)
+            onBeforeMove(AFS::getDisplayPath(filePath), AFS::getDisplayPath(AFS::appendRelPath(versioningFolderPath_, versionedRelPath + COMPRESSED_VERSION_ENDING)));
+
+        return revisionFileCompressed(filePath, fileDescr.attr.modTime, relativePath, versionedRelPath, notifyUnbufferedIO); //throw FileError, X
+    }
+
+    const AbstractPath targetPath = AFS::appendRelPath(versioningFolderPath_, versionedRelPath);
     const AFS::StreamAttributes fileAttr{fileDescr.attr.modTime, fileDescr.attr.fileSize, fileDescr.attr.filePrint};
 
     if (onBeforeMove)
@@ -214,9 +425,41 @@ void FileVersioner::revisionFileImpl(const FileDescriptor& fileDescr, const Zstr
         /*const AFS::FileCopyResult result =*/ AFS::copyFileTransactional(filePath, fileAttr, targetPath, //throw FileError, ErrorFileLocked, X
                                                                           false, //copyFilePermissions
                                                                           false,  //transactionalCopy: not needed for versioning! partial copy will be overwritten next time
-                                                                          nullptr /*onDeleteTargetFile*/, notifyUnbufferedIO);
+                                                                          false,  //deltaCopy
+                                                                          std::nullopt /*resumableCopy*/,
+                                                                          nullptr /*onDeleteTargetFile*/, notifyUnbufferedIO, std::nullopt /*sourceHashAlgo*/);
         //result.errorModTime? => irrelevant for versioning!
-    });
+    }, &moveUnsupported_);
+
+    addNewVersion(relativePath, versionedRelPath, false /*isSymlink*/);
+}
+
+
+void FileVersioner::revisionFileCompressed(const AbstractPath& filePath, time_t modTime, const Zstring& relativePath, const Zstring& versionedRelPath, //throw FileError, X
+                                           const IoCallback& notifyUnbufferedIO /*throw X*/) const
+{
+    const Zstring compressedRelPath = versionedRelPath + COMPRESSED_VERSION_ENDING;
+    const AbstractPath targetPath = AFS::appendRelPath(versioningFolderPath_, compressedRelPath);
+
+    try { AFS::removeFilePlain(targetPath); /*throw FileError*/ }
+    catch (FileError&) {} //probably "not existing" error: real issues will show up below
+
+    try
+    {
+        copyFileCompressed(filePath, modTime, targetPath, notifyUnbufferedIO); //throw FileError, ErrorFileLocked, X
+    }
+    catch (FileError&)
+    {
+        //parent folder missing => create + retry
+        if (const std::optional<AbstractPath> targetParentPath = AFS::getParentPath(targetPath))
+            AFS::createFolderIfMissingRecursion(*targetParentPath); //throw FileError
+
+        copyFileCompressed(filePath, modTime, targetPath, notifyUnbufferedIO); //throw FileError, ErrorFileLocked, X
+    }
+    //[!] remove source file AFTER the copy succeeded!
+    AFS::removeFilePlain(filePath); //throw FileError
+
+    addNewVersion(relativePath, compressedRelPath, false /*isSymlink*/);
 }
 
 
@@ -231,13 +474,15 @@ void FileVersioner::revisionSymlink(const AbstractPath& linkPath, const Zstring&
 void FileVersioner::revisionSymlinkImpl(const AbstractPath& linkPath, const Zstring& relativePath, //throw FileError
                                         const std::function<void(const std::wstring& displayPathFrom, const std::wstring& displayPathTo)>& onBeforeMove) const
 {
-
-    const AbstractPath targetPath = generateVersionedPath(relativePath);
+    const Zstring versionedRelPath = generateVersionedRelPath(relativePath);
+    const AbstractPath targetPath = AFS::appendRelPath(versioningFolderPath_, versionedRelPath);
 
     if (onBeforeMove)
         onBeforeMove(AFS::getDisplayPath(linkPath), AFS::getDisplayPath(targetPath));
 
     moveExistingItemToVersioning(linkPath, targetPath, [&] { AFS::copySymlink(linkPath, targetPath, false /*copy filesystem permissions*/); }); //throw FileError
+
+    addNewVersion(relativePath, versionedRelPath, true /*isSymlink*/);
 }
 
 
@@ -251,7 +496,7 @@ void FileVersioner::revisionFolder(const AbstractPath& folderPath, const Zstring
     {
         if (*type == AFS::ItemType::symlink) //on Linux there is just one type of symlink, and since we do revision file symlinks, we should revision dir symlinks as well!
             revisionSymlinkImpl(folderPath, relativePath, onBeforeFileMove); //throw FileError
-        else
+        else if (!tryMoveFolderWhole(folderPath, relativePath, onBeforeFolderMove)) //throw X
             revisionFolderImpl(folderPath, relativePath, onBeforeFileMove, onBeforeFolderMove, notifyUnbufferedIO); //throw FileError, X
     }
     else //even if the folder did not exist anymore, significant I/O work was done => report
@@ -259,6 +504,42 @@ void FileVersioner::revisionFolder(const AbstractPath& folderPath, const Zstring
 }
 
 
+bool FileVersioner::tryMoveFolderWhole(const AbstractPath& folderPath, const Zstring& relativePath, //throw X
+                                       const std::function<void(const std::wstring& displayPathFrom, const std::wstring& displayPathTo)>& onBeforeFolderMove) const
+{
+    //only VersioningStyle::timestampFolder keeps the original item names => no need to rename item by item
+    if (versioningStyle_ != VersioningStyle::timestampFolder || moveUnsupported_)
+        return false;
+
+    const AbstractPath targetPath = AFS::appendRelPath(versioningFolderPath_, generateVersionedRelPath(relativePath));
+    try
+    {
+        //already existing: undefined behavior for moveAndRenameItem()! e.g. subfolder versioned earlier during this sync => merge item by item
+        if (AFS::itemStillExists(targetPath)) //throw FileError
+            return false;
+
+        if (const std::optional<AbstractPath> targetParentPath = AFS::getParentPath(targetPath))
+            AFS::createFolderIfMissingRecursion(*targetParentPath); //throw FileError
+
+        if (onBeforeFolderMove)
+            onBeforeFolderMove(AFS::getDisplayPath(folderPath), AFS::getDisplayPath(targetPath)); //throw X
+
+        AFS::moveAndRenameItem(folderPath, targetPath); //throw FileError, ErrorMoveUnsupported
+    }
+    catch (ErrorMoveUnsupported&)
+    {
+        moveUnsupported_ = true;
+        return false;
+    }
+    catch (FileError&) { return false; } //e.g. folder in use: item by item versioning reports the details
+
+    //individual versions are unknown without traversal => let applyVersioningLimit() find them with a full traversal instead
+    if (!versionIndexInvalidated_.exchange(true))
+        invalidateVersionIndex(versioningFolderPath_); //noexcept
+    return true;
+}
+
+
 void FileVersioner::revisionFolderImpl(const AbstractPath& folderPath, const Zstring& relPath, //throw FileError, X
                                        const std::function<void(const std::wstring& displayPathFrom, const std::wstring& displayPathTo)>& onBeforeFileMove,
                                        const std::function<void(const std::wstring& displayPathFrom, const std::wstring& displayPathTo)>& onBeforeFolderMove,
@@ -305,9 +586,11 @@ namespace
 {
 struct VersionInfo
 {
-    time_t       versionTime = 0;
-    AbstractPath filePath;
-    bool         isSymlink = false;
+    time_t  versionTime = 0;
+    Zstring relPathVersion; //relative to versioning folder
+    bool    isSymlink = false;
+    bool    toDelete  = false; //
+    bool    removed   = false; //=> drop from version index
 };
 using VersionInfoMap = std::unordered_map<Zstring, std::vector<VersionInfo>>; //relPathOrig => <version infos>
 
@@ -316,25 +599,31 @@ using VersionInfoMap = std::unordered_map<Zstring, std::vector<VersionInfo>>; //
 
 void findFileVersions(VersionInfoMap& versions,
                       const FolderContainer& folderCont,
-                      const AbstractPath& parentFolderPath,
+                      const Zstring& relPathParent,
                       const Zstring& relPathOrigParent,
                       const time_t* versionTimeParent)
 {
     auto addVersion = [&](const Zstring& fileName, const Zstring& fileNameOrig, time_t versionTime, bool isSymlink)
     {
-        const Zstring& relPathOrig   = appendPath(relPathOrigParent, fileNameOrig);
-        const AbstractPath& filePath = AFS::appendRelPath(parentFolderPath, fileName);
+        const Zstring& relPathOrig = appendPath(relPathOrigParent, fileNameOrig);
 
-        versions[relPathOrig].push_back(VersionInfo{versionTime, filePath, isSymlink});
+        versions[relPathOrig].push_back(VersionInfo{versionTime, appendPath(relPathParent, fileName), isSymlink});
     };
 
     auto extractFileVersion = [&](const Zstring& fileName, bool isSymlink)
     {
         if (versionTimeParent) //VersioningStyle::timestampFolder
-            addVersion(fileName, fileName, *versionTimeParent, isSymlink);
+            addVersion(fileName, isSymlink ? fileName : stripCompressedVersionEnding(fileName), *versionTimeParent, isSymlink);
         else
         {
-            const std::pair<time_t, Zstring> vfn = fff::impl::parseVersionedFileName(fileName);
+            const bool isManifest = !isSymlink && endsWith(fileName, DEDUP_MANIFEST_ENDING); //VersioningStyle::deduplicate
+
+            std::pair<time_t, Zstring> vfn = fff::impl::parseVersionedFileName(isManifest ? Zstring(fileName.begin(), fileName.end() - strLength(DEDUP_MANIFEST_ENDING)) : fileName);
+            if (vfn.first == 0 && !isSymlink && !isManifest) //compressed version?
+                if (const Zstring fileNameUncompressed = stripCompressedVersionEnding(fileName);
+                    fileNameUncompressed.size() != fileName.size())
+                    vfn = fff::impl::parseVersionedFileName(fileNameUncompressed);
+
             if (vfn.first != 0) //VersioningStyle::timestampFile
                 addVersion(fileName, vfn.second, vfn.first, isSymlink);
         }
@@ -355,7 +644,7 @@ void findFileVersions(VersionInfoMap& versions,
             if (versionTime != 0)
             {
                 findFileVersions(versions, attrAndSub.second,
-                                 AFS::appendRelPath(parentFolderPath, folderName),
+                                 appendPath(relPathParent, folderName),
                                  Zstring(), //[!] skip time-stamped folder
                                  &versionTime);
                 continue;
@@ -363,7 +652,7 @@ void findFileVersions(VersionInfoMap& versions,
         }
 
         findFileVersions(versions, attrAndSub.second,
-                         AFS::appendRelPath(parentFolderPath, folderName),
+                         appendPath(relPathParent, folderName),
                          appendPath(relPathOrigParent, folderName),
                          versionTimeParent);
     }
@@ -380,6 +669,157 @@ void getFolderItemCount(std::map<AbstractPath, size_t>& folderItemCount, const F
     for (const auto& [folderName, attrAndSub] : folderCont.folders)
         getFolderItemCount(folderItemCount, attrAndSub.second, AFS::appendRelPath(parentFolderPath, folderName));
 }
+
+
+//version index knows about versions only => item count is a lower bound: "empty" folders may still contain other items!
+void getFolderItemCount(std::map<AbstractPath, size_t>& folderItemCount, std::set<AbstractPath>& folderItemCountGuessed,
+                        const VersionInfoMap& versions, const AbstractPath& versioningFolderPath)
+{
+    std::unordered_set<Zstring> foldersCounted;
+
+    for (const auto& [relPathOrig, versionInfos] : versions)
+        for (const VersionInfo& vi : versionInfos)
+            for (Zstring relPath = vi.relPathVersion;;)
+            {
+                const Zstring relPathParent = beforeLast(relPath, FILE_NAME_SEPARATOR, IfNotFoundReturn::none);
+                const AbstractPath parentPath = AFS::appendRelPath(versioningFolderPath, relPathParent);
+
+                ++folderItemCount[parentPath];
+                folderItemCountGuessed.insert(parentPath);
+
+                if (relPathParent.empty() || !foldersCounted.insert(relPathParent).second) //parent already counted as item of its own parent
+                    break;
+                relPath = relPathParent;
+            }
+}
+
+//-------------------------------------------------------------------------------------------
+
+const char VERSION_INDEX_DESCR[] = "FreeFileSync Versions";
+const int VERSION_INDEX_VERSION = 1; //2026-10-14
+
+const int VERSION_INDEX_FULL_SCAN_DAYS = 30; //pick up versions added or removed by other means than FileVersioner
+
+
+struct VersionIndex
+{
+    time_t lastFullScan = 0; //0 if last full traversal was incomplete
+    VersionInfoMap versions;
+};
+
+
+AbstractPath getVersionIndexPath(const AbstractPath& versioningFolderPath)
+{
+    //keep SYNC_DB_FILE_ENDING: excluded from comparison if the versioning folder is part of a folder pair
+    return AFS::appendRelPath(versioningFolderPath, Zstring(Zstr(".sync.versions")) + SYNC_DB_FILE_ENDING);
+}
+
+
+void saveVersionIndex(const VersionIndex& index, const AbstractPath& versioningFolderPath) //throw FileError
+{
+    const AbstractPath indexPath = getVersionIndexPath(versioningFolderPath);
+    try
+    {
+        auto isRemaining = [](const VersionInfo& vi) { return !vi.removed; };
+
+        MemoryStreamOut<std::string> streamOut;
+        writeNumber<int64_t>(streamOut, index.lastFullScan);
+
+        writeNumber<uint32_t>(streamOut, static_cast<uint32_t>(std::count_if(index.versions.begin(), index.versions.end(), [&](const auto& item)
+        { return std::any_of(item.second.begin(), item.second.end(), isRemaining); })));
+
+        for (const auto& [relPathOrig, versions] : index.versions)
+            if (const size_t versionCount = std::count_if(versions.begin(), versions.end(), isRemaining);
+                versionCount > 0)
+            {
+                writeContainer(streamOut, utfTo<std::string>(relPathOrig));
+                writeNumber<uint32_t>(streamOut, static_cast<uint32_t>(versionCount));
+
+                for (const VersionInfo& vi : versions)
+                    if (isRemaining(vi))
+                    {
+                        writeContainer       (streamOut, utfTo<std::string>(vi.relPathVersion));
+                        writeNumber<int64_t> (streamOut, vi.versionTime);
+                        writeNumber<int8_t>  (streamOut, vi.isSymlink);
+                    }
+            }
+        //------------------------------------------------------------------------------------------------------------------------
+        MemoryStreamOut<std::string> memStreamOut;
+        writeArray(memStreamOut, VERSION_INDEX_DESCR, sizeof(VERSION_INDEX_DESCR));
+        writeNumber<int32_t>(memStreamOut, VERSION_INDEX_VERSION);
+        writeContainer(memStreamOut, compress(streamOut.ref(), 3 /*level*/)); //throw SysError
+        writeNumber<uint32_t>(memStreamOut, getCrc32(memStreamOut.ref()));
+
+        const std::string& byteStream = memStreamOut.ref();
+
+        AFS::removeFileIfExists(indexPath); //throw FileError
+        //already existing: undefined behavior! (e.g. fail/overwrite/auto-rename)
+        const std::unique_ptr<AFS::OutputStream> fileStreamOut = AFS::getOutputStream(indexPath, //throw FileError
+                                                                                      byteStream.size(),
+                                                                                      std::nullopt /*modTime*/,
+                                                                                      nullptr /*notifyUnbufferedIO*/);
+        fileStreamOut->write(byteStream.c_str(), byteStream.size()); //throw FileError
+        fileStreamOut->finalize();                                   //throw FileError
+    }
+    catch (const SysError& e) { throw FileError(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(AFS::getDisplayPath(indexPath))), e.toString()); }
+}
+
+
+std::optional<VersionIndex> tryLoadVersionIndex(const AbstractPath& versioningFolderPath) //noexcept: missing or corrupted index => full traversal
+{
+    try
+    {
+        const std::unique_ptr<AFS::InputStream> fileStreamIn = AFS::getInputStream(getVersionIndexPath(versioningFolderPath), nullptr /*notifyUnbufferedIO*/); //throw FileError, ErrorFileLocked
+        const std::string byteStream = bufferedLoad<std::string>(*fileStreamIn); //throw FileError, ErrorFileLocked
+
+        MemoryStreamIn memStreamIn(byteStream);
+
+        char formatDescr[sizeof(VERSION_INDEX_DESCR)] = {};
+        readArray(memStreamIn, formatDescr, sizeof(formatDescr)); //throw SysErrorUnexpectedEos
+
+        if (!std::equal(VERSION_INDEX_DESCR, VERSION_INDEX_DESCR + sizeof(VERSION_INDEX_DESCR), formatDescr) ||
+            readNumber<int32_t>(memStreamIn) != VERSION_INDEX_VERSION) //throw SysErrorUnexpectedEos
+            return std::nullopt;
+
+        MemoryStreamOut<std::string> crcStreamOut;
+        writeNumber<uint32_t>(crcStreamOut, getCrc32(byteStream.begin(), byteStream.end() - sizeof(uint32_t)));
+        if (!endsWith(byteStream, crcStreamOut.ref()))
+            return std::nullopt;
+
+        const std::string stream = decompress(readContainer<std::string>(memStreamIn)); //throw SysError, SysErrorUnexpectedEos
+        MemoryStreamIn streamIn(stream);
+
+        VersionIndex index;
+        index.lastFullScan = readNumber<int64_t>(streamIn); //throw SysErrorUnexpectedEos
+
+        size_t fileCount = readNumber<uint32_t>(streamIn); //throw SysErrorUnexpectedEos
+        while (fileCount-- != 0)
+        {
+            std::vector<VersionInfo>& versions = index.versions[utfTo<Zstring>(readContainer<std::string>(streamIn))]; //throw SysErrorUnexpectedEos
+
+            size_t versionCount = readNumber<uint32_t>(streamIn); //throw SysErrorUnexpectedEos
+            while (versionCount-- != 0)
+            {
+                VersionInfo vi;
+                vi.relPathVersion = utfTo<Zstring>(readContainer<std::string>(streamIn)); //throw SysErrorUnexpectedEos
+                vi.versionTime    = readNumber<int64_t>(streamIn);                        //
+                vi.isSymlink      = readNumber<int8_t >(streamIn) != 0;                   //
+                versions.push_back(std::move(vi));
+            }
+        }
+        return index;
+    }
+    catch (FileError&) {} //=> not existing or inaccessible: let full traversal report access errors
+    catch (SysError&) {}
+    return std::nullopt;
+}
+}
+
+
+void fff::invalidateVersionIndex(const AbstractPath& versioningFolderPath) //noexcept
+{
+    try { AFS::removeFileIfExists(getVersionIndexPath(versioningFolderPath)); /*throw FileError*/ }
+    catch (FileError&) {} //too bad: missing versions are found with the next full traversal at the latest
 }
 
 
@@ -399,6 +839,8 @@ std::weak_ordering fff::operator<=>(const VersioningLimitFolder& lhs, const Vers
 
 
 void fff::applyVersioningLimit(const std::set<VersioningLimitFolder>& folderLimits,
+                               const std::map<AbstractPath, std::vector<VersionItem>>& newVersions,
+                               const std::map<AfsDevice, size_t>& deviceParallelOps,
                                PhaseCallback& callback /*throw X*/)
 {
     //--------- determine existing folder paths for traversal ---------
@@ -413,13 +855,16 @@ void fff::applyVersioningLimit(const std::set<VersioningLimitFolder>& folderLimi
                 pathsToCheck.insert(vlf.versioningFolderPath);
                 folderLimitsTmp.insert(vlf);
             }
+            else if (auto it = newVersions.find(vlf.versioningFolderPath);
+                     it != newVersions.end() && !it->second.empty())
+                invalidateVersionIndex(vlf.versioningFolderPath); //noexcept
 
         //what if versioning folder paths differ only in case? => perf pessimization, but already checked, see fff::synchronize()
 
         //we don't want to show an error if version path does not yet exist!
         tryReportingError([&]
         {
-            const FolderStatus status = getFolderStatusNonBlocking(pathsToCheck,
+            const FolderStatus status = getFolderStatusNonBlocking(pathsToCheck, {} /*deviceParallelOps*/,
                                                                    false /*allowUserInteraction*/, callback); //throw X
             foldersToRead.clear();
             for (const AbstractPath& folderPath : status.existing)
@@ -441,32 +886,62 @@ void fff::applyVersioningLimit(const std::set<VersioningLimitFolder>& folderLimi
         }, callback); //throw X
     }
 
-    //--------- traverse all versioning folders ---------
     const std::wstring textScanning = _("Searching for old file versions:") + L' ';
+    const time_t now = std::time(nullptr);
+
+    std::map<AbstractPath, VersionIndex> versionIndexes; //versioningFolderPath => <version details>
+    std::map<AbstractPath, size_t> folderItemCount; //<folder path> => <item count> for determination of empty folders
+    std::set<AbstractPath> folderItemCountGuessed;  //folders that are not necessarily empty if item count drops to zero
+
+    //--------- use version index if available: no need to traverse (possibly millions of) versions ---------
+    for (auto it = foldersToRead.begin(); it != foldersToRead.end();)
+    {
+        const AbstractPath versioningFolderPath = it->folderPath;
+        callback.updateStatus(textScanning + AFS::getDisplayPath(versioningFolderPath)); //throw X
+
+        if (std::optional<VersionIndex> index = tryLoadVersionIndex(versioningFolderPath); //noexcept
+            index && index->lastFullScan <= now && now - index->lastFullScan < VERSION_INDEX_FULL_SCAN_DAYS * 24 * 3600)
+        {
+            if (auto itNew = newVersions.find(versioningFolderPath); itNew != newVersions.end())
+                for (const VersionItem& item : itNew->second)
+                    index->versions[item.relPathOrig].push_back(VersionInfo{item.versionTime, item.relPathVersion, item.isSymlink});
 
+            getFolderItemCount(folderItemCount, folderItemCountGuessed, index->versions, versioningFolderPath);
+            ++folderItemCount[versioningFolderPath]; //make sure the versioning folder is never found empty and is not deleted
+
+            versionIndexes.emplace(versioningFolderPath, std::move(*index));
+            it = foldersToRead.erase(it);
+        }
+        else
+            ++it;
+    }
+
+    //--------- traverse remaining versioning folders ---------
     auto onStatusUpdate = [&](const std::wstring& statusLine, int itemsTotal)
     {
         callback.updateStatus(textScanning + statusLine); //throw X
     };
 
-    const std::map<DirectoryKey, DirectoryValue> folderBuf = parallelDeviceTraversal(foldersToRead,
+    const std::map<DirectoryKey, DirectoryValue> folderBuf = parallelDeviceTraversal(foldersToRead, deviceParallelOps, {} /*incrementalScans*/, nullptr /*namePool*/, nullptr /*scanStats*/,
     [&](const PhaseCallback::ErrorInfo& errorInfo) { return callback.reportError(errorInfo); }, //throw X
     onStatusUpdate, //throw X
+    nullptr /*onFolderDone*/,
     UI_UPDATE_INTERVAL / 2); //every ~50 ms
 
     //--------- group versions per (original) relative path ---------
-    std::map<AbstractPath, VersionInfoMap> versionDetails; //versioningFolderPath => <version details>
-    std::map<AbstractPath, size_t> folderItemCount; //<folder path> => <item count> for determination of empty folders
-
     for (const auto& [folderKey, folderVal] : folderBuf)
     {
         const AbstractPath versioningFolderPath = folderKey.folderPath;
 
-        assert(!versionDetails.contains(versioningFolderPath));
+        assert(!versionIndexes.contains(versioningFolderPath));
+        VersionIndex& index = versionIndexes[versioningFolderPath];
 
-        findFileVersions(versionDetails[versioningFolderPath],
+        //incomplete traversal: don't trust index next time
+        index.lastFullScan = folderVal.failedFolderReads.empty() && folderVal.failedItemReads.empty() ? now : 0;
+
+        findFileVersions(index.versions,
                          folderVal.folderCont,
-                         versioningFolderPath,
+                         Zstring() /*relPathParent*/,
                          Zstring() /*relPathOrigParent*/,
                          nullptr /*versionTimeParent*/);
 
@@ -482,8 +957,6 @@ void fff::applyVersioningLimit(const std::set<VersioningLimitFolder>& folderLimi
     }
 
     //--------- calculate excess file versions ---------
-    std::map<AbstractPath, bool /*isSymlink*/> itemsToDelete;
-
     const time_t lastMidnightTime = []
     {
         TimeComp tc = getLocalTime(); //returns TimeComp() on error
@@ -495,9 +968,9 @@ void fff::applyVersioningLimit(const std::set<VersioningLimitFolder>& folderLimi
 
     for (const VersioningLimitFolder& vlf : folderLimitsTmp)
     {
-        auto it = versionDetails.find(vlf.versioningFolderPath);
-        if (it != versionDetails.end())
-            for (auto& [versioningFolderPath, versions] : it->second)
+        auto it = versionIndexes.find(vlf.versioningFolderPath);
+        if (it != versionIndexes.end())
+            for (auto& [relPathOrig, versions] : it->second.versions)
             {
                 size_t versionsToKeep = versions.size();
                 if (vlf.versionMaxAgeDays > 0)
@@ -518,23 +991,38 @@ void fff::applyVersioningLimit(const std::set<VersioningLimitFolder>& folderLimi
                     [](const VersionInfo& lhs, const VersionInfo& rhs) { return lhs.versionTime < rhs.versionTime; });
                     //oldest versions sorted to the front
 
-                    std::for_each(versions.begin(), versions.end() - versionsToKeep, [&](const VersionInfo& vi)
-                    {
-                        itemsToDelete.emplace(vi.filePath, vi.isSymlink);
-                    });
+                    std::for_each(versions.begin(), versions.end() - versionsToKeep, [](VersionInfo& vi) { vi.toDelete = true; });
                 }
             }
     }
 
+    //[!] collect pointers only *after* nth_element() reordering for all limits
+    std::map<AbstractPath, VersionInfo*> itemsToDelete;
+
+    for (auto& [versioningFolderPath, index] : versionIndexes)
+        for (auto& [relPathOrig, versions] : index.versions)
+            for (VersionInfo& vi : versions)
+                if (vi.toDelete)
+                    itemsToDelete.emplace(AFS::appendRelPath(versioningFolderPath, vi.relPathVersion), &vi);
+
     //--------- remove excess file versions ---------
     Protected<std::map<AbstractPath, size_t>&> folderItemCountShared(folderItemCount);
     const std::wstring txtRemoving = _("Removing old file versions:") + L' ';
     const std::wstring txtDeletingFolder = _("Deleting folder %x");
 
     std::function<void(const AbstractPath& folderPath, AsyncCallback& acb)> deleteEmptyFolderTask;
-    deleteEmptyFolderTask = [&txtDeletingFolder, &folderItemCountShared, &deleteEmptyFolderTask](const AbstractPath& folderPath, AsyncCallback& acb) //throw ThreadStopRequest
+    deleteEmptyFolderTask = [&txtDeletingFolder, &folderItemCountShared, &folderItemCountGuessed, &deleteEmptyFolderTask](const AbstractPath& folderPath, AsyncCallback& acb) //throw ThreadStopRequest
     {
-        const std::wstring errMsg = tryReportingError([&] //throw ThreadStopRequest
+        std::wstring errMsg;
+        if (folderItemCountGuessed.contains(folderPath)) //folder might contain items unknown to the version index => deletion failure is not an error
+            try
+            {
+                acb.updateStatus(replaceCpy(txtDeletingFolder, L"%x", fmtPath(AFS::getDisplayPath(folderPath)))); //throw ThreadStopRequest
+                AFS::removeEmptyFolderIfExists(folderPath); //throw FileError
+            }
+            catch (const FileError& e) { errMsg = e.toString(); }
+        else
+            errMsg = tryReportingError([&] //throw ThreadStopRequest
         {
             acb.updateStatus(replaceCpy(txtDeletingFolder, L"%x", fmtPath(AFS::getDisplayPath(folderPath)))); //throw ThreadStopRequest
             AFS::removeEmptyFolderIfExists(folderPath); //throw FileError
@@ -559,19 +1047,22 @@ void fff::applyVersioningLimit(const std::set<VersioningLimitFolder>& folderLimi
             deleteEmptyFolderTask(ctx.itemPath, ctx.acb); //throw ThreadStopRequest
         });
 
-    for (const auto& [itemPath, isSymlink] : itemsToDelete)
-        parallelWorkload.emplace_back(itemPath, [isSymlink /*clang bug*/= isSymlink, &txtRemoving, &folderItemCountShared, &deleteEmptyFolderTask](ParallelContext& ctx) //throw ThreadStopRequest
+    for (const auto& [itemPath, versionInfo] : itemsToDelete)
+        parallelWorkload.emplace_back(itemPath, [vi = versionInfo, &txtRemoving, &folderItemCountShared, &deleteEmptyFolderTask](ParallelContext& ctx) //throw ThreadStopRequest
     {
         const std::wstring errMsg = tryReportingError([&] //throw ThreadStopRequest
         {
             ctx.acb.reportInfo(txtRemoving + AFS::getDisplayPath(ctx.itemPath)); //throw ThreadStopRequest
-            if (isSymlink)
+            if (vi->isSymlink)
                 AFS::removeSymlinkIfExists(ctx.itemPath); //throw FileError
             else
                 AFS::removeFileIfExists(ctx.itemPath); //throw FileError
         }, ctx.acb);
 
         if (errMsg.empty())
+        {
+            vi->removed = true; //each work item owns a different VersionInfo => no need to synchronize
+
             if (const std::optional<AbstractPath> parentPath = AFS::getParentPath(ctx.itemPath))
             {
                 bool deleteParent = false;
@@ -579,8 +1070,50 @@ void fff::applyVersioningLimit(const std::set<VersioningLimitFolder>& folderLimi
                 if (deleteParent)
                     deleteEmptyFolderTask(*parentPath, ctx.acb); //throw ThreadStopRequest
             }
+        }
     });
 
-    massParallelExecute(parallelWorkload,
+    //version deletion is independent per item => use all parallel operations available for each device
+    massParallelExecute(parallelWorkload, deviceParallelOps,
                         Zstr("Versioning Limit"), callback /*throw X*/); //throw X
+
+    //--------- remove chunks no longer referenced (VersioningStyle::deduplicate) ---------
+    //only after a complete traversal: the version index might miss manifests, e.g. written by a different job => their chunks would be lost!
+    for (const auto& [versioningFolderPath, index] : versionIndexes)
+        if (index.lastFullScan == now)
+        {
+            std::vector<AbstractPath> manifestPaths;
+            bool manifestsExisting = false;
+
+            for (const auto& [relPathOrig, versions] : index.versions)
+                for (const VersionInfo& vi : versions)
+                    if (!vi.isSymlink && endsWith(vi.relPathVersion, DEDUP_MANIFEST_ENDING))
+                    {
+                        manifestsExisting = true;
+                        if (!vi.removed)
+                            manifestPaths.push_back(AFS::appendRelPath(versioningFolderPath, vi.relPathVersion));
+                    }
+
+            if (manifestsExisting)
+                tryReportingError([&, &versioningFolderPath = versioningFolderPath]
+            {
+                callback.updateStatus(txtRemoving + AFS::getDisplayPath(getDedupChunkFolderPath(versioningFolderPath))); //throw X
+                removeUnreferencedChunks(versioningFolderPath, manifestPaths); //throw FileError
+            }, callback); //throw X
+        }
+
+    //--------- update version index ---------
+    for (const auto& [versioningFolderPath, index] : versionIndexes)
+    {
+        callback.updateStatus(replaceCpy(_("Saving file %x..."), L"%x", fmtPath(AFS::getDisplayPath(getVersionIndexPath(versioningFolderPath))))); //throw X
+        try
+        {
+            saveVersionIndex(index, versioningFolderPath); //throw FileError
+        }
+        catch (const FileError& e) //not critical: next run falls back to full traversal
+        {
+            callback.logInfo(e.toString()); //throw X
+            invalidateVersionIndex(versioningFolderPath); //noexcept
+        }
+    }
 }
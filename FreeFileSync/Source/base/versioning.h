@@ -8,8 +8,10 @@
 #define VERSIONING_H_8760247652438056
 
 #include <functional>
+#include <atomic>
 #include <zen/time.h>
 #include <zen/file_error.h>
+#include <zen/thread.h>
 #include "structures.h"
 #include "algorithm.h"
 #include "../afs/abstract.h"
@@ -29,16 +31,31 @@ namespace fff
         => (unlikely) risk of data loss for naming convention "versioning":
         race-condition if multiple folder pairs process the same filepath!!                */
 
+struct VersionItem //file version created by FileVersioner: paths relative to versioning folder
+{
+    Zstring relPathOrig;
+    Zstring relPathVersion;
+    time_t versionTime = 0;
+    bool isSymlink = false;
+};
+
+
 class FileVersioner
 {
 public:
     FileVersioner(const AbstractPath& versioningFolderPath, //throw FileError
                   VersioningStyle versioningStyle,
-                  time_t syncStartTime) :
+                  bool compressCopies, //versions that can't be moved are copied as .zst (or .gz); not for VersioningStyle::deduplicate
+                  time_t syncStartTime,
+                  const AbstractPath& baseFolderPath) : //items to be versioned are located here
         versioningFolderPath_(versioningFolderPath),
         versioningStyle_(versioningStyle),
+        compressCopies_(compressCopies && versioningStyle != VersioningStyle::deduplicate),
         syncStartTime_(syncStartTime),
-        timeStamp_(zen::formatTime(Zstr("%Y-%m-%d %H%M%S"), zen::getLocalTime(syncStartTime))) //e.g. "2012-05-15 131513"
+        timeStamp_(zen::formatTime(Zstr("%Y-%m-%d %H%M%S"), zen::getLocalTime(syncStartTime))), //e.g. "2012-05-15 131513"
+        //pre-flight: different AFS device => moving to versioning folder will fail for sure
+        //same device, but still not supported (e.g. different volume)? => find out with first move
+        moveUnsupported_(!(versioningFolderPath.afsDevice == baseFolderPath.afsDevice))
     {
         using namespace zen;
 
@@ -49,7 +66,11 @@ public:
             throw FileError(_("Unable to create time stamp for versioning:") + L" \"" + utfTo<std::wstring>(timeStamp_) + L'"');
     }
 
-    //multi-threaded access: internally synchronized!
+    /*  multi-threaded access: internally synchronized!
+
+        move to versioning folder not supported => don't copy + delete on the critical path:
+        - rename file next to its original location instead (*.ffs_tmp)
+        - copy to versioning folder + delete asynchronously => finishAsyncVersioning()!      */
     void revisionFile(const FileDescriptor& fileDescr, //throw FileError, X
                       const Zstring& relativePath,
                       //called frequently if move has to revert to copy + delete => see zen::copyFile for limitations when throwing exceptions!
@@ -63,6 +84,18 @@ public:
                         //called frequently if move has to revert to copy + delete => see zen::copyFile for limitations when throwing exceptions!
                         const zen::IoCallback& notifyUnbufferedIO /*throw X*/) const;
 
+    //context of controlling thread: wait until asynchronous versioning is done, retry failed items
+    //=> call before extractNewVersions() and before destruction (remaining *.ffs_tmp files would be deleted by the next sync!)
+    void finishAsyncVersioning(PhaseCallback& callback /*throw X*/); //throw X
+
+    //time-stamped versions created so far (VersioningStyle::replace: none) => incremental update of the version index, see applyVersioningLimit()
+    std::vector<VersionItem> extractNewVersions() const
+    {
+        std::vector<VersionItem> output;
+        newVersions_.access([&](std::vector<VersionItem>& versions) { output.swap(versions); });
+        return output;
+    }
+
 private:
     FileVersioner           (const FileVersioner&) = delete;
     FileVersioner& operator=(const FileVersioner&) = delete;
@@ -71,6 +104,20 @@ private:
                           const std::function<void(const std::wstring& displayPathFrom, const std::wstring& displayPathTo)>& onBeforeMove,
                           const zen::IoCallback& notifyUnbufferedIO) const;
 
+    struct StagedVersion
+    {
+        AbstractPath stagedPath; //next to original file
+        AbstractPath origPath;
+        AFS::StreamAttributes attr;
+        Zstring relativePath;
+        Zstring versionedRelPath;
+    };
+    bool tryStageFile(const FileDescriptor& fileDescr, const Zstring& relativePath, const Zstring& versionedRelPath) const; //noexcept
+    void revisionStagedFile(const StagedVersion& sv, const zen::IoCallback& notifyUnbufferedIO) const; //throw FileError, X
+
+    void revisionFileCompressed(const AbstractPath& filePath, time_t modTime, const Zstring& relativePath, const Zstring& versionedRelPath, //throw FileError, X
+                                const zen::IoCallback& notifyUnbufferedIO) const;
+
     void revisionSymlinkImpl(const AbstractPath& linkPath, const Zstring& relativePath, //throw FileError
                              const std::function<void(const std::wstring& displayPathFrom, const std::wstring& displayPathTo)>& onBeforeMove) const;
 
@@ -79,12 +126,24 @@ private:
                             const std::function<void(const std::wstring& displayPathFrom, const std::wstring& displayPathTo)>& onBeforeFolderMove,
                             const zen::IoCallback& notifyUnbufferedIO) const; //throw FileError, X
 
-    AbstractPath generateVersionedPath(const Zstring& relativePath) const;
+    bool tryMoveFolderWhole(const AbstractPath& folderPath, const Zstring& relativePath, //throw X
+                            const std::function<void(const std::wstring& displayPathFrom, const std::wstring& displayPathTo)>& onBeforeFolderMove) const;
+
+    Zstring generateVersionedRelPath(const Zstring& relativePath) const;
+    void addNewVersion(const Zstring& relativePath, const Zstring& versionedRelPath, bool isSymlink) const;
 
     const AbstractPath versioningFolderPath_;
     const VersioningStyle versioningStyle_;
+    const bool compressCopies_;
     const time_t syncStartTime_;
     const Zstring timeStamp_;
+
+    mutable zen::Protected<std::vector<VersionItem>> newVersions_;
+
+    mutable std::atomic<bool> moveUnsupported_;
+    mutable std::atomic<bool> versionIndexInvalidated_{false}; //whole folders were moved => version index lacks their items
+    mutable zen::Protected<std::vector<std::pair<StagedVersion, std::wstring /*error*/>>> stagedFailed_;
+    mutable zen::Protected<std::unique_ptr<zen::ThreadGroup<std::function<void()>>>> asyncVersioning_; //[!] declare last: stop + join before other members are destroyed
 };
 
 //--------------------------------------------------------------------------------
@@ -99,9 +158,17 @@ struct VersioningLimitFolder
 std::weak_ordering operator<=>(const VersioningLimitFolder& lhs, const VersioningLimitFolder& rhs);
 
 
+/*  version index: list of all versions stored in the versioning folder => avoid full traversal of huge version histories
+    - updated incrementally with the versions created by FileVersioner (newVersions), rebuilt by full traversal every few weeks
+    - versions added or deleted by other means are picked up with the next full traversal   */
 void applyVersioningLimit(const std::set<VersioningLimitFolder>& folderLimits,
+                          const std::map<AbstractPath, std::vector<VersionItem>>& newVersions, //versioningFolderPath => versions created during this sync
+                          const std::map<AfsDevice, size_t>& deviceParallelOps,
                           PhaseCallback& callback /*throw X*/);
 
+//call if new versions were created, but applyVersioningLimit() is not: force full traversal next time
+void invalidateVersionIndex(const AbstractPath& versioningFolderPath); //noexcept
+
 
 namespace impl //declare for unit tests:
 {
@@ -254,6 +254,13 @@ MainConfiguration fff::merge(const std::vector<MainConfiguration>& mainCfgs)
         for (const auto& [rootPath, parallelOps] : mainCfg.deviceParallelOps)
             mergedParallelOps[rootPath] = std::max(mergedParallelOps[rootPath], parallelOps);
 
+    std::map<AfsDevice, uint64_t> mergedBandwidthLimits; //strictest limit wins
+    for (const MainConfiguration& mainCfg : mainCfgs)
+        for (const auto& [rootPath, bytesPerSec] : mainCfg.deviceBandwidthLimits)
+            if (auto [it, inserted] = mergedBandwidthLimits.emplace(rootPath, bytesPerSec);
+                !inserted)
+                it->second = std::min(it->second, bytesPerSec);
+
     //final assembly
     MainConfiguration cfgOut;
     cfgOut.cmpCfg       = cmpCfgHead;
@@ -262,6 +269,7 @@ MainConfiguration fff::merge(const std::vector<MainConfiguration>& mainCfgs)
     cfgOut.firstPair    = mergedCfgs[0];
     cfgOut.additionalPairs.assign(mergedCfgs.begin() + 1, mergedCfgs.end());
     cfgOut.deviceParallelOps = mergedParallelOps;
+    cfgOut.deviceBandwidthLimits = mergedBandwidthLimits;
 
     cfgOut.ignoreErrors = std::all_of(mainCfgs.begin(), mainCfgs.end(), [](const MainConfiguration& mainCfg) { return mainCfg.ignoreErrors; });
 
@@ -0,0 +1,346 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#include "cli_daemon.h"
+#include <iostream>
+#include <csignal>
+#include <poll.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+#include <zen/dir_watcher.h>
+#include <zen/file_access.h>
+#include <zen/socket.h>
+#include "afs/concrete.h"
+#include "afs/native.h"
+#include "base/comparison.h"
+
+using namespace zen;
+using namespace fff;
+
+
+namespace
+{
+const std::chrono::seconds DAEMON_POLL_INTERVAL(1); //fetch changes regularly: inotify's event queue is limited
+const std::chrono::seconds REQUEST_TIMEOUT(10);
+const size_t REQUEST_LENGTH_MAX = 4096;
+
+
+class DaemonJob
+{
+public:
+    DaemonJob(const Zstring& cfgFilePath, const XmlBatchConfig& batchCfg) : cfgFilePath_(cfgFilePath), batchCfg_(batchCfg)
+    {
+        for (const FolderPairCfg& fpCfg : extractCompareCfg(batchCfg.mainCfg))
+            for (const Zstring& folderPathPhrase : {fpCfg.folderPathPhraseLeft_, fpCfg.folderPathPhraseRight_})
+                if (const Zstring& folderPath = getNativeItemPath(createAbstractPath(folderPathPhrase));
+                    !folderPath.empty())
+                    watches_.emplace_back(folderPath, nullptr);
+                else //change notifications are available for native paths only => always run full comparison
+                {
+                    watches_.clear();
+                    return;
+                }
+
+        rewatch();
+    }
+
+    const Zstring& getCfgFilePath() const { return cfgFilePath_; }
+
+    void fetchChanges() //noexcept
+    {
+        for (auto& [folderPath, watcher] : watches_)
+            fetchChanges(folderPath, watcher);
+    }
+
+    FfsExitCode run(const RunBatchJobFun& runBatchJob)
+    {
+        fetchChanges();
+
+        if (rewatchRequired_)
+            rewatch();
+
+        if (!watches_.empty() && !fullScanRequired_ && changedPaths_.empty() && lastRunSucceeded_)
+        {
+            std::cout << utfTo<std::string>(extractJobName(cfgFilePath_)) + ": " + utfTo<std::string>(_("Nothing to synchronize")) + '\n' << std::flush;
+            return FfsExitCode::success;
+        }
+
+        std::vector<Zstring> changedItemPaths;
+        if (!watches_.empty() && !fullScanRequired_)
+            changedItemPaths.assign(changedPaths_.begin(), changedPaths_.end());
+
+        //changes reported from now on (including our own sync) are considered for the next run
+        changedPaths_.clear();
+        fullScanRequired_ = false;
+
+        const FfsExitCode rc = runBatchJob(batchCfg_, cfgFilePath_, changedItemPaths);
+
+        //sync.ffs_db only matches the folder contents if all differences were synchronized
+        lastRunSucceeded_ = rc == FfsExitCode::success;
+        if (!lastRunSucceeded_)
+            fullScanRequired_ = true;
+        return rc;
+    }
+
+private:
+    void fetchChanges(const Zstring& folderPath, std::unique_ptr<DirWatcher>& watcher) //noexcept
+    {
+        if (!watcher)
+            return;
+        try
+        {
+            for (const DirWatcher::Change& change : watcher->fetchChanges(nullptr /*requestUiUpdate*/, UI_UPDATE_INTERVAL)) //throw FileError
+                if (change.type == DirWatcher::ChangeType::baseFolderUnavailable)
+                {
+                    fullScanRequired_ = rewatchRequired_ = true;
+                    watcher.reset();
+                    return;
+                }
+                else if (!endsWith(change.itemPath, Zstr(".ffs_tmp"))  && //sync.8ea2.ffs_tmp
+                         !endsWith(change.itemPath, Zstr(".ffs_lock")) && //sync.ffs_lock, sync.Del.ffs_lock
+                         !endsWith(change.itemPath, Zstr(".ffs_db")))     //sync.ffs_db
+                {
+                    changedPaths_.insert(change.itemPath);
+
+                    //Linux: new subfolders are not watched automatically; their content is traversed completely as a changed item during the next run
+                    if (change.type == DirWatcher::ChangeType::create && dirAvailable(change.itemPath))
+                        rewatchRequired_ = true;
+                }
+        }
+        catch (FileError&) //e.g. inotify queue overflow
+        {
+            fullScanRequired_ = rewatchRequired_ = true;
+            watcher.reset();
+        }
+    }
+
+    void rewatch() //noexcept
+    {
+        for (auto& [folderPath, watcher] : watches_)
+        {
+            std::unique_ptr<DirWatcher> newWatcher;
+            try
+            {
+                newWatcher = std::make_unique<DirWatcher>(folderPath); //throw FileError
+            }
+            catch (const FileError& e)
+            {
+                std::cerr << utfTo<std::string>(e.toString()) + '\n';
+                fullScanRequired_ = true;
+            }
+            fetchChanges(folderPath, watcher); //old and new watcher overlap => no changes are missed
+            watcher = std::move(newWatcher);
+        }
+        rewatchRequired_ = std::any_of(watches_.begin(), watches_.end(), [](const auto& item) { return !item.second; });
+    }
+
+    const Zstring cfgFilePath_;
+    const XmlBatchConfig batchCfg_;
+
+    std::vector<std::pair<Zstring /*native folder path*/, std::unique_ptr<DirWatcher>>> watches_; //empty if not all base folders are native
+    std::set<Zstring, LessNativePath> changedPaths_;
+    bool fullScanRequired_ = true; //first run: sync.ffs_db might not match the current folder contents
+    bool rewatchRequired_ = false;
+    bool lastRunSucceeded_ = false;
+};
+
+
+::sockaddr_un getSocketAddress(const Zstring& socketPath) //throw SysError
+{
+    ::sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    if (socketPath.empty() || socketPath.size() >= sizeof(addr.sun_path))
+        throw SysError(L"Invalid socket path length.");
+    std::copy(socketPath.begin(), socketPath.end(), addr.sun_path);
+    return addr;
+}
+
+
+SocketType connectSocket(const Zstring& socketPath) //throw SysError
+{
+    const ::sockaddr_un addr = getSocketAddress(socketPath); //throw SysError
+
+    const SocketType sock = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (sock == invalidSocket)
+        THROW_LAST_SYS_ERROR("socket");
+    ZEN_ON_SCOPE_FAIL(closeSocket(sock));
+
+    if (::connect(sock, reinterpret_cast<const ::sockaddr*>(&addr), sizeof(addr)) != 0)
+        THROW_LAST_SYS_ERROR("connect");
+
+    return sock;
+}
+
+
+SocketType createServerSocket(const Zstring& socketPath) //throw SysError
+{
+    const ::sockaddr_un addr = getSocketAddress(socketPath); //throw SysError
+
+    //remove stale socket of a previous instance, but don't steal the socket of a running one
+    if (struct stat fileInfo = {};
+        ::lstat(socketPath.c_str(), &fileInfo) == 0 && S_ISSOCK(fileInfo.st_mode))
+    {
+        bool instanceRunning = false;
+        try
+        {
+            closeSocket(connectSocket(socketPath)); //throw SysError
+            instanceRunning = true;
+        }
+        catch (SysError&) {}
+
+        if (instanceRunning)
+            throw SysError(L"Another instance is already listening on this socket.");
+
+        if (::unlink(socketPath.c_str()) != 0)
+            THROW_LAST_SYS_ERROR("unlink");
+    }
+
+    const SocketType sock = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (sock == invalidSocket)
+        THROW_LAST_SYS_ERROR("socket");
+    ZEN_ON_SCOPE_FAIL(closeSocket(sock));
+
+    if (::bind(sock, reinterpret_cast<const ::sockaddr*>(&addr), sizeof(addr)) != 0)
+        THROW_LAST_SYS_ERROR("bind");
+
+    if (::listen(sock, 16 /*backlog*/) != 0)
+        THROW_LAST_SYS_ERROR("listen");
+
+    return sock;
+}
+
+
+std::string readLine(SocketType sock) //throw SysError
+{
+    std::string line;
+    char buf[256];
+    for (;;)
+    {
+        const size_t bytesRead = tryReadSocket(sock, buf, sizeof(buf)); //throw SysError
+        if (bytesRead == 0) //EOF
+            return line;
+
+        line.append(buf, bytesRead);
+        if (const size_t pos = line.find('\n');
+            pos != std::string::npos)
+            return line.substr(0, pos);
+
+        if (line.size() > REQUEST_LENGTH_MAX)
+            throw SysError(L"Request is too long.");
+    }
+}
+
+
+void writeLine(SocketType sock, const std::string& line) //throw SysError
+{
+    const std::string buf = line + '\n';
+    for (size_t bytesWritten = 0; bytesWritten < buf.size(); )
+        bytesWritten += tryWriteSocket(sock, buf.data() + bytesWritten, buf.size() - bytesWritten); //throw SysError
+}
+}
+
+
+void fff::runDaemon(const Zstring& socketPath, const std::vector<Zstring>& batchFilePaths, const RunBatchJobFun& runBatchJob) //throw FileError
+{
+    std::vector<std::unique_ptr<DaemonJob>> jobs;
+    for (const Zstring& filePath : batchFilePaths)
+    {
+        auto [batchCfg, warningMsg] = readBatchConfig(filePath); //throw FileError
+        if (!warningMsg.empty())
+            throw FileError(warningMsg); //batch mode: break on errors AND even warnings!
+
+        jobs.push_back(std::make_unique<DaemonJob>(filePath, batchCfg));
+    }
+
+    auto findJob = [&](const Zstring& jobName) -> DaemonJob*
+    {
+        for (const std::unique_ptr<DaemonJob>& job : jobs)
+            if (equalNativePath(job->getCfgFilePath(), jobName) ||
+                extractJobName(job->getCfgFilePath()) == utfTo<std::wstring>(jobName))
+                return job.get();
+        return nullptr;
+    };
+
+    try
+    {
+        if (std::signal(SIGPIPE, SIG_IGN) == SIG_ERR) //client may disconnect before reading the reply
+            THROW_LAST_SYS_ERROR("signal(SIGPIPE)");
+
+        const SocketType serverSock = createServerSocket(socketPath); //throw SysError
+        ZEN_ON_SCOPE_EXIT(closeSocket(serverSock); ::unlink(socketPath.c_str()));
+
+        std::cout << "Listening on " + utfTo<std::string>(socketPath) + '\n' << std::flush;
+
+        for (;;)
+        {
+            ::pollfd fds[] = {{serverSock, POLLIN, 0}};
+            const int rv = ::poll(fds, std::size(fds), static_cast<int>(std::chrono::milliseconds(DAEMON_POLL_INTERVAL).count()));
+            if (rv < 0 && errno != EINTR)
+                THROW_LAST_SYS_ERROR("poll");
+
+            for (const std::unique_ptr<DaemonJob>& job : jobs)
+                job->fetchChanges(); //noexcept
+
+            if (rv <= 0) //timeout or EINTR
+                continue;
+
+            const SocketType clientSock = ::accept4(serverSock, nullptr, nullptr, SOCK_CLOEXEC);
+            if (clientSock == invalidSocket)
+                continue; //e.g. client already gone
+            ZEN_ON_SCOPE_EXIT(closeSocket(clientSock));
+
+            try
+            {
+                const ::timeval tv{static_cast<time_t>(REQUEST_TIMEOUT.count()), 0}; //don't let a stuck client block all other requests
+                if (::setsockopt(clientSock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv)) != 0)
+                    THROW_LAST_SYS_ERROR("setsockopt(SO_RCVTIMEO)");
+
+                const std::string request = trimCpy(readLine(clientSock)); //throw SysError
+
+                if (request == "quit")
+                {
+                    writeLine(clientSock, numberTo<std::string>(static_cast<int>(FfsExitCode::success))); //throw SysError
+                    return;
+                }
+                else if (startsWith(request, "run "))
+                {
+                    const Zstring jobName = utfTo<Zstring>(trimCpy(afterFirst(request, ' ', IfNotFoundReturn::none)));
+
+                    FfsExitCode rc = FfsExitCode::aborted;
+                    if (DaemonJob* job = findJob(jobName))
+                        rc = job->run(runBatchJob);
+                    else
+                        std::cerr << utfTo<std::string>(replaceCpy(_("Cannot find file %x."), L"%x", fmtPath(jobName))) + '\n';
+
+                    writeLine(clientSock, numberTo<std::string>(static_cast<int>(rc))); //throw SysError
+                }
+                else
+                    throw SysError(L"Invalid request: " + utfTo<std::wstring>(request));
+            }
+            catch (const SysError& e) { std::cerr << utfTo<std::string>(e.toString()) + '\n'; } //client problem: keep serving
+        }
+    }
+    catch (const SysError& e) { throw FileError(replaceCpy(_("Cannot open file %x."), L"%x", fmtPath(socketPath)), e.toString()); }
+}
+
+
+FfsExitCode fff::requestDaemonRun(const Zstring& socketPath, const Zstring& jobName) //throw FileError
+{
+    try
+    {
+        const SocketType sock = connectSocket(socketPath); //throw SysError
+        ZEN_ON_SCOPE_EXIT(closeSocket(sock));
+
+        writeLine(sock, "run " + utfTo<std::string>(jobName)); //throw SysError
+
+        const std::string reply = trimCpy(readLine(sock)); //throw SysError; no timeout: job may run for hours
+        if (reply.empty() || !std::all_of(reply.begin(), reply.end(), [](char c) { return isDigit(c); }))
+            throw SysError(L"Invalid reply: " + utfTo<std::wstring>(reply));
+
+        return static_cast<FfsExitCode>(stringTo<int>(reply));
+    }
+    catch (const SysError& e) { throw FileError(replaceCpy(_("Cannot open file %x."), L"%x", fmtPath(socketPath)), e.toString()); }
+}
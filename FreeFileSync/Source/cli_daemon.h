@@ -0,0 +1,32 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#ifndef CLI_DAEMON_H_4710928357461029385
+#define CLI_DAEMON_H_4710928357461029385
+
+#include <functional>
+#include "config.h"
+#include "return_codes.h"
+
+
+namespace fff
+{
+/*  long-running service for FreeFileSync_cli: jobs are run on request via a local (Unix domain) socket
+    - one DirWatcher per native base folder: only changed items are traversed, everything else is taken from sync.ffs_db (= incremental comparison)
+    - no changes since the last successful run => nothing to do
+    - FTP/SFTP/Google Drive sessions stay in AFS session pools between runs
+
+    protocol (one request per connection): "run <job name or config file path>\n" -> "<FfsExitCode>\n"
+                                           "quit\n"                                -> "0\n"                                     */
+using RunBatchJobFun = std::function<FfsExitCode(const XmlBatchConfig& batchCfg, const Zstring& cfgFilePath,
+                                                 const std::vector<Zstring>& changedItemPaths /*empty: full comparison*/)>;
+
+void runDaemon(const Zstring& socketPath, const std::vector<Zstring>& batchFilePaths, const RunBatchJobFun& runBatchJob); //throw FileError
+
+FfsExitCode requestDaemonRun(const Zstring& socketPath, const Zstring& jobName); //throw FileError
+}
+
+#endif //CLI_DAEMON_H_4710928357461029385
@@ -0,0 +1,399 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#include <iostream>
+#include <zen/file_access.h>
+#include <zen/file_io.h>
+#include <zen/resolve_path.h>
+#include <zen/shutdown.h>
+#include <wx/init.h>
+#include "afs/concrete.h"
+#include "base/cmp_result_file.h"
+#include "base/comparison.h"
+#include "base/dedup_store.h"
+#include "base/synchronization.h"
+#include "base_tools.h"
+#include "cli_daemon.h"
+#include "console_status_handler.h"
+#include "ffs_paths.h"
+
+using namespace zen;
+using namespace fff;
+
+
+/*  headless batch runner: e.g. cron jobs on servers without X display
+    - wxBase only: no wxApp event loop, no GTK initialization, no image resources, no translations (=> English)
+    - errors cannot be shown in a popup => BatchErrorHandling::showPopup behaves like BatchErrorHandling::cancel  */
+namespace
+{
+void notifyAppError(const std::wstring& msg, FfsExitCode rc, FfsExitCode& exitCode)
+{
+    raiseExitCode(exitCode, rc);
+    std::cerr << "[FreeFileSync] " + utfTo<std::string>(msg) << '\n';
+}
+
+
+void showSyntaxHelp()
+{
+    std::cout << utfTo<std::string>(_("Syntax:") + L"\n\n" +
+                                    L"FreeFileSync_cli" + L'\n' +
+                                    L"    " + _("config files:") + L" *.ffs_batch" + L'\n' +
+                                    L"    [-ChangedPaths " + _("file") + L"]" + L'\n' +
+                                    L"    [" + _("global config file:") + L" GlobalSettings.xml]" + L"\n\n" +
+
+                                    L"FreeFileSync_cli -Daemon <socket> *.ffs_batch [GlobalSettings.xml]" + L'\n' +
+                                    L"    Keep running and run the given jobs on request, using change notifications to compare incrementally." + L"\n\n" +
+
+                                    L"FreeFileSync_cli -Run <socket> <job name>" + L'\n' +
+                                    L"    Ask the daemon listening on <socket> to run a job; returns the job's exit code." + L"\n\n" +
+
+                                    L"FreeFileSync_cli -RestoreVersion <*" + utfTo<std::wstring>(DEDUP_MANIFEST_ENDING) + L"> <" + _("file") + L">" + L'\n' +
+                                    L"    Restore a file version created with versioning style \"" + _("Deduplicate") + L"\"." + L"\n\n" +
+
+                                    L"-ChangedPaths " + _("file") + L'\n' +
+                                    _("Batch mode: Only compare folders containing the items listed in the file (one path per line), take everything else from the database of the last synchronization.") + L"\n\n" +
+
+                                    _("global config file:") + L'\n' +
+                                    _("Path to an alternate GlobalSettings.xml file.")) << '\n';
+}
+
+
+void runBatchJob(const Zstring& globalConfigFilePath, const XmlBatchConfig& batchCfg, const Zstring& cfgFilePath,
+                 const std::vector<Zstring>& changedItemPaths, FfsExitCode& exitCode)
+{
+    XmlGlobalSettings globalCfg;
+    try
+    {
+        std::wstring warningMsg;
+        std::tie(globalCfg, warningMsg) = readGlobalConfig(globalConfigFilePath); //throw FileError
+        assert(warningMsg.empty()); //ignore parsing errors: should be migration problems only *cross-fingers*
+    }
+    catch (const FileError& e)
+    {
+        try
+        {
+            bool cfgFileExists = true;
+            try { cfgFileExists  = !!itemStillExists(globalConfigFilePath); /*throw FileError*/ } //=> unclear which exception is more relevant/useless:
+            catch (const FileError& e2) { throw FileError(replaceCpy(e.toString(), L"\n\n", L'\n'), replaceCpy(e2.toString(), L"\n\n", L'\n')); }
+
+            if (cfgFileExists)
+                throw;
+        }
+        catch (const FileError& e3)
+        {
+            return notifyAppError(e3.toString(), FfsExitCode::aborted, exitCode); //abort sync!
+        }
+    }
+
+    std::set<AbstractPath> logFilePathsToKeep;
+    for (const ConfigFileItem& item : globalCfg.mainDlg.config.fileHistory)
+        logFilePathsToKeep.insert(item.logFilePath);
+
+    const std::chrono::system_clock::time_point syncStartTime = std::chrono::system_clock::now();
+
+    ConsoleStatusHandler statusHandler(extractJobName(cfgFilePath),
+                                       syncStartTime,
+                                       batchCfg.mainCfg.ignoreErrors,
+                                       batchCfg.mainCfg.autoRetryCount,
+                                       batchCfg.mainCfg.autoRetryDelay,
+                                       globalCfg.logFormat);
+    try
+    {
+        //inform about (important) non-default global settings
+        logNonDefaultSettings(globalCfg, statusHandler); //throw AbortProcess
+
+        //batch mode: place directory locks on directories during both comparison AND synchronization
+        std::unique_ptr<LockHolder> dirLocks;
+
+        //COMPARE DIRECTORIES
+        FolderComparison cmpResult = compare(globalCfg.warnDlgs,
+                                             globalCfg.fileTimeTolerance,
+                                             globalCfg.contentCmpTrustDatabase,
+                                             globalCfg.timeSizeVerifyContent,
+                                             globalCfg.remoteScanTrustDatabase,
+                                             globalCfg.snapshotChangeDiscovery,
+                                             globalCfg.outOfCoreComparison,
+                                             false /*allowUserInteraction*/,
+                                             globalCfg.runWithBackgroundPriority,
+                                             globalCfg.createLockFile,
+                                             dirLocks,
+                                             extractCompareCfg(batchCfg.mainCfg),
+                                             batchCfg.mainCfg.deviceParallelOps,
+                                             changedItemPaths,
+                                             nullptr /*onPairCompared*/,
+                                             statusHandler); //throw AbortProcess
+
+        //save before synchronization changes it: review what the batch job did without rescanning
+        if (globalCfg.saveComparisonResult && !cmpResult.empty() && !cfgFilePath.empty())
+            try
+            {
+                const Zstring cmpFilePath = getCmpResultFilePath(cfgFilePath);
+                saveComparisonResult(cmpResult, cfgFilePath, std::chrono::system_clock::to_time_t(syncStartTime), cmpFilePath); //throw FileError
+                statusHandler.logInfo(replaceCpy(_("Comparison result saved: %x"), L"%x", fmtPath(cmpFilePath))); //throw AbortProcess
+            }
+            catch (const FileError& e) { statusHandler.logInfo(e.toString()); } //throw AbortProcess; not fatal
+
+        //START SYNCHRONIZATION
+        if (!cmpResult.empty())
+            synchronize(syncStartTime,
+                        globalCfg.verifyFileCopy,
+                        globalCfg.copyLockedFiles,
+                        globalCfg.copyFilePermissions,
+                        globalCfg.failSafeFileCopy,
+                        globalCfg.syncDbJournal,
+                        globalCfg.runWithBackgroundPriority,
+                        globalCfg.syncIoPriority,
+                        globalCfg.dropPageCacheBehind,
+                        globalCfg.flushTargetBuffers,
+                        static_cast<uint64_t>(std::max(globalCfg.deltaCopyMinSizeMB, 0)) * 1024 * 1024,
+                        static_cast<uint64_t>(std::max(globalCfg.resumableCopyMinSizeMB, 0)) * 1024 * 1024,
+                        globalCfg.compressVersions,
+                        extractSyncCfg(batchCfg.mainCfg),
+                        cmpResult,
+                        batchCfg.mainCfg.deviceParallelOps,
+                        globalCfg.autoTuneParallelOps,
+                        globalCfg.globalDeviceBudget,
+                        batchCfg.mainCfg.deviceBandwidthLimits,
+                        batchCfg.mainCfg.autoRetryCount,
+                        batchCfg.mainCfg.autoRetryDelay,
+                        globalCfg.syncHistory,
+                        globalCfg.warnDlgs,
+                        statusHandler); //throw AbortProcess
+    }
+    catch (AbortProcess&) {} //exit used by statusHandler
+
+    AbstractPath logFolderPath = createAbstractPath(batchCfg.mainCfg.altLogFolderPathPhrase); //optional
+    if (AFS::isNullPath(logFolderPath))
+        logFolderPath = createAbstractPath(globalCfg.logFolderPhrase);
+    assert(!AFS::isNullPath(logFolderPath)); //mandatory! but still: let's include fall back
+    if (AFS::isNullPath(logFolderPath))
+        logFolderPath = createAbstractPath(getLogFolderDefaultPath());
+
+    const ConsoleStatusHandler::Result r = statusHandler.reportResults(batchCfg.mainCfg.postSyncCommand, batchCfg.mainCfg.postSyncCondition,
+                                                                       logFolderPath, globalCfg.logfilesMaxAgeDays, globalCfg.logMetrics, logFilePathsToKeep,
+                                                                       batchCfg.mainCfg.emailNotifyAddress, batchCfg.mainCfg.emailNotifyCondition); //noexcept
+    //----------------------------------------------------------------------
+    switch (r.syncResult)
+    {
+        //*INDENT-OFF*
+        case SyncResult::finishedSuccess: raiseExitCode(exitCode, FfsExitCode::success); break;
+        case SyncResult::finishedWarning: raiseExitCode(exitCode, FfsExitCode::warning); break;
+        case SyncResult::finishedError:   raiseExitCode(exitCode, FfsExitCode::error  ); break;
+        case SyncResult::aborted:         raiseExitCode(exitCode, FfsExitCode::aborted); break;
+        //*INDENT-ON*
+    }
+
+    //email sending, or saving log file failed? at the very least this should affect the exit code:
+    if (r.logStats.error > 0)
+        raiseExitCode(exitCode, FfsExitCode::error);
+    else if (r.logStats.warning > 0)
+        raiseExitCode(exitCode, FfsExitCode::warning);
+
+    //update last sync stats for the selected cfg file
+    for (ConfigFileItem& cfi : globalCfg.mainDlg.config.fileHistory)
+        if (equalNativePath(cfi.cfgFilePath, cfgFilePath))
+        {
+            if (r.syncResult != SyncResult::aborted)
+                cfi.lastSyncTime = std::chrono::system_clock::to_time_t(syncStartTime);
+            assert(!AFS::isNullPath(r.logFilePath));
+            if (!AFS::isNullPath(r.logFilePath))
+            {
+                cfi.logFilePath = r.logFilePath;
+                cfi.logResult   = r.syncResult;
+            }
+            break;
+        }
+
+    //---------------------------------------------------------------------------
+    try //save global settings to XML: e.g. ignored warnings, last sync stats
+    {
+        writeConfig(globalCfg, globalConfigFilePath); //FileError
+    }
+    catch (const FileError& e) { notifyAppError(e.toString(), FfsExitCode::warning, exitCode); }
+
+    //no countdown dialog to cancel => run post sync action right away
+    if (r.syncResult != SyncResult::aborted)
+        try
+        {
+            switch (batchCfg.batchExCfg.postSyncAction)
+            {
+                case PostSyncAction::none:
+                    break;
+                case PostSyncAction::sleep:
+                    suspendSystem(); //throw FileError
+                    break;
+                case PostSyncAction::shutdown:
+                    shutdownSystem(); //throw FileError
+                    break;
+            }
+        }
+        catch (const FileError& e) { notifyAppError(e.toString(), FfsExitCode::error, exitCode); }
+}
+
+
+void runCommandLine(int argc, char* argv[], FfsExitCode& exitCode)
+{
+    try
+    {
+        std::vector<Zstring> batchFilePaths;
+        Zstring globalConfigFile;
+        std::vector<Zstring> changedItemPaths; //incremental comparison (e.g. reported by RealTimeSync)
+        Zstring daemonSocketPath;
+        Zstring requestSocketPath;
+        Zstring requestJobName;
+        Zstring restoreVersionPhrase;
+        Zstring restoreTargetPhrase;
+
+        const char* optionChangedPaths = "-changedpaths";
+        const char* optionDaemon       = "-daemon";
+        const char* optionRun          = "-run";
+        const char* optionRestore      = "-restoreversion";
+
+        for (int i = 1; i < argc; ++i)
+        {
+            const Zstring arg = utfTo<Zstring>(argv[i]);
+
+            if (equalAsciiNoCase(arg, "-h") || equalAsciiNoCase(arg, "--help") || equalAsciiNoCase(arg, "/?"))
+            {
+                showSyntaxHelp();
+                return;
+            }
+            else if (equalAsciiNoCase(arg, optionChangedPaths))
+            {
+                if (++i == argc)
+                    throw FileError(replaceCpy(_("A file path is expected after %x."), L"%x", utfTo<std::wstring>(optionChangedPaths)));
+
+                const std::string& changeList = getFileContent(getResolvedFilePath(utfTo<Zstring>(argv[i])), nullptr /*notifyUnbufferedIO*/); //throw FileError
+                //empty file => nothing known about the changes => full comparison
+                for (const std::string& line : split(changeList, '\n', SplitOnEmpty::skip))
+                    if (const Zstring& itemPath = trimCpy(utfTo<Zstring>(line));
+                        !itemPath.empty())
+                        changedItemPaths.push_back(itemPath);
+            }
+            else if (equalAsciiNoCase(arg, optionDaemon))
+            {
+                if (++i == argc)
+                    throw FileError(replaceCpy(_("A file path is expected after %x."), L"%x", utfTo<std::wstring>(optionDaemon)));
+                daemonSocketPath = getResolvedFilePath(utfTo<Zstring>(argv[i]));
+            }
+            else if (equalAsciiNoCase(arg, optionRun))
+            {
+                if (i + 2 >= argc)
+                    throw FileError(replaceCpy(_("A file path is expected after %x."), L"%x", utfTo<std::wstring>(optionRun)));
+                requestSocketPath = getResolvedFilePath(utfTo<Zstring>(argv[++i]));
+                requestJobName    = utfTo<Zstring>(argv[++i]); //job name or config file path
+            }
+            else if (equalAsciiNoCase(arg, optionRestore))
+            {
+                if (i + 2 >= argc)
+                    throw FileError(replaceCpy(_("A file path is expected after %x."), L"%x", utfTo<std::wstring>(optionRestore)));
+                restoreVersionPhrase = utfTo<Zstring>(argv[++i]); //AFS path phrases: e.g. restore from SFTP versioning folder
+                restoreTargetPhrase  = utfTo<Zstring>(argv[++i]);
+            }
+            else
+            {
+                Zstring filePath = getResolvedFilePath(arg);
+
+                if (!fileAvailable(filePath)) //...be a little tolerant
+                {
+                    if (fileAvailable(filePath + Zstr(".ffs_batch")))
+                        filePath += Zstr(".ffs_batch");
+                    else if (fileAvailable(filePath + Zstr(".xml")))
+                        filePath += Zstr(".xml");
+                    else
+                        throw FileError(replaceCpy(_("Cannot find file %x."), L"%x", fmtPath(filePath)));
+                }
+
+                switch (getXmlType(filePath)) //throw FileError
+                {
+                    case XmlType::batch:
+                        batchFilePaths.push_back(filePath);
+                        break;
+                    case XmlType::global:
+                        globalConfigFile = filePath;
+                        break;
+                    case XmlType::gui:
+                    case XmlType::other:
+                        throw FileError(replaceCpy(_("File %x does not contain a valid configuration."), L"%x", fmtPath(filePath)));
+                }
+            }
+        }
+
+        if (!restoreVersionPhrase.empty()) //VersioningStyle::deduplicate: manifest + chunks => file
+        {
+            const AbstractPath targetPath = createAbstractPath(restoreTargetPhrase);
+
+            if (AFS::itemStillExists(targetPath)) //throw FileError
+                throw FileError(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(AFS::getDisplayPath(targetPath))), _("The item already exists."));
+
+            restoreDedupVersion(createAbstractPath(restoreVersionPhrase), targetPath, nullptr /*notifyUnbufferedIO*/); //throw FileError
+            return;
+        }
+
+        if (!requestSocketPath.empty()) //client: let the daemon run the job
+        {
+            raiseExitCode(exitCode, requestDaemonRun(requestSocketPath, requestJobName)); //throw FileError
+            return;
+        }
+
+        const Zstring globalConfigFilePath = !globalConfigFile.empty() ? globalConfigFile : getGlobalConfigDefaultPath();
+
+        if (!daemonSocketPath.empty())
+        {
+            runDaemon(daemonSocketPath, batchFilePaths, [&](const XmlBatchConfig& batchCfg, const Zstring& cfgFilePath, const std::vector<Zstring>& jobChangedPaths)
+            {
+                FfsExitCode jobExitCode = FfsExitCode::success;
+                runBatchJob(globalConfigFilePath, batchCfg, cfgFilePath, jobChangedPaths, jobExitCode);
+                return jobExitCode;
+            }); //throw FileError
+            return;
+        }
+
+        if (batchFilePaths.size() > 1)
+            throw FileError(L"Only one batch configuration file can be run at a time."); //no config merging in batch mode
+
+        if (batchFilePaths.empty())
+        {
+            showSyntaxHelp();
+            return raiseExitCode(exitCode, FfsExitCode::aborted);
+        }
+
+        auto [batchCfg, warningMsg] = readBatchConfig(batchFilePaths[0]); //throw FileError
+        if (!warningMsg.empty())
+            throw FileError(warningMsg); //batch mode: break on errors AND even warnings!
+
+        runBatchJob(globalConfigFilePath, batchCfg, batchFilePaths[0], changedItemPaths, exitCode);
+    }
+    catch (const FileError& e)
+    {
+        notifyAppError(e.toString(), FfsExitCode::aborted, exitCode);
+    }
+}
+}
+
+
+int main(int argc, char* argv[])
+{
+    //initialize wxBase only (wxDummyConsoleApp): required by wxLocale and wxDateTime helpers, but no GTK => no X display needed
+    wxInitializer wxInit(argc, argv);
+    if (!wxInit.IsOk())
+    {
+        std::cerr << "[FreeFileSync] Failed to initialize wxWidgets.\n";
+        return static_cast<int>(FfsExitCode::exception);
+    }
+
+    FfsExitCode exitCode = FfsExitCode::success;
+
+    initAfs({getResourceDirPath(), getConfigDirPath()});
+
+    runCommandLine(argc, argv, exitCode);
+
+    const std::wstring& warningMsg = teardownAfs();
+    if (!warningMsg.empty())
+        notifyAppError(warningMsg, FfsExitCode::warning, exitCode);
+
+    return static_cast<int>(exitCode);
+}
@@ -10,6 +10,8 @@
 #include <zen/file_io.h>
 #include <zen/time.h>
 #include <zen/process_exec.h>
+#include <zen/serialize.h>
+#include <zen/crc.h>
 #include <wx/intl.h>
 #include "ffs_paths.h"
 #include "base_tools.h"
@@ -23,7 +25,7 @@ using namespace fff; //required for correct overload resolution!
 namespace
 {
 //-------------------------------------------------------------------------------------------------------------------------------
-const int XML_FORMAT_GLOBAL_CFG = 24; //2022-04-29
+const int XML_FORMAT_GLOBAL_CFG = 25; //2026-10-14
 const int XML_FORMAT_SYNC_CFG   = 17; //2020-10-14
 //-------------------------------------------------------------------------------------------------------------------------------
 }
@@ -329,6 +331,39 @@ bool readText(const std::string& input, PostSyncCondition& value)
 }
 
 
+template <> inline
+void writeText(const IoPriority& value, std::string& output)
+{
+    switch (value)
+    {
+        case IoPriority::normal:
+            output = "Normal";
+            break;
+        case IoPriority::low:
+            output = "Low";
+            break;
+        case IoPriority::idle:
+            output = "Idle";
+            break;
+    }
+}
+
+template <> inline
+bool readText(const std::string& input, IoPriority& value)
+{
+    const std::string tmp = trimCpy(input);
+    if (tmp == "Normal")
+        value = IoPriority::normal;
+    else if (tmp == "Low")
+        value = IoPriority::low;
+    else if (tmp == "Idle")
+        value = IoPriority::idle;
+    else
+        return false;
+    return true;
+}
+
+
 template <> inline
 void writeText(const PostSyncAction& value, std::string& output)
 {
@@ -747,6 +782,9 @@ void writeText(const VersioningStyle& value, std::string& output)
         case VersioningStyle::timestampFile:
             output = "TimeStamp-File";
             break;
+        case VersioningStyle::deduplicate:
+            output = "Deduplicate";
+            break;
     }
 }
 
@@ -760,6 +798,8 @@ bool readText(const std::string& input, VersioningStyle& value)
         value = VersioningStyle::timestampFolder;
     else if (tmp == "TimeStamp-File")
         value = VersioningStyle::timestampFile;
+    else if (tmp == "Deduplicate")
+        value = VersioningStyle::deduplicate;
     else
         return false;
     return true;
@@ -1024,6 +1064,54 @@ void writeStruc(const ConfigFileItem& value, XmlElement& output)
     }
 }
 
+template <> inline
+bool readStruc(const XmlElement& input, FolderPairHistory& value)
+{
+    bool success = true;
+    success = input.getAttribute("Left",    value.folderPathPhraseL) && success;
+    success = input.getAttribute("Right",   value.folderPathPhraseR) && success;
+    success = input.getAttribute("LastRun", value.lastRunTime)       && success;
+
+    int64_t durationMs = 0;
+    success = input.getAttribute("DurationMs", durationMs) && success;
+    value.duration = std::chrono::milliseconds(durationMs);
+
+    success = input.getAttribute("Items", value.items) && success;
+    success = input.getAttribute("Bytes", value.bytes) && success;
+    return success; //[!] avoid short-circuit evaluation
+}
+
+template <> inline
+void writeStruc(const FolderPairHistory& value, XmlElement& output)
+{
+    output.setAttribute("Left",       value.folderPathPhraseL);
+    output.setAttribute("Right",      value.folderPathPhraseR);
+    output.setAttribute("LastRun",    value.lastRunTime);
+    output.setAttribute("DurationMs", static_cast<int64_t>(value.duration.count()));
+    output.setAttribute("Items",      value.items);
+    output.setAttribute("Bytes",      value.bytes);
+}
+
+
+template <> inline
+bool readStruc(const XmlElement& input, DeviceHistory& value)
+{
+    bool success = true;
+    success = input.getAttribute("Device",      value.devicePathPhrase) && success;
+    success = input.getAttribute("LastRun",     value.lastRunTime)      && success;
+    success = input.getAttribute("BytesPerSec", value.bytesPerSec)      && success;
+    return success; //[!] avoid short-circuit evaluation
+}
+
+template <> inline
+void writeStruc(const DeviceHistory& value, XmlElement& output)
+{
+    output.setAttribute("Device",      value.devicePathPhrase);
+    output.setAttribute("LastRun",     value.lastRunTime);
+    output.setAttribute("BytesPerSec", value.bytesPerSec);
+}
+
+
 //TODO: remove after migration! 2018-07-27
 struct ConfigFileItemV9
 {
@@ -1073,6 +1161,9 @@ void readConfig(const XmlIn& in, SyncDirectionConfig& dirCfg)
     //    dirCfg.custom = DirectionSet();
 
     in["DetectMovedFiles"](dirCfg.detectMovedFiles);
+
+    if (in["DetectMovedFiles"].hasAttribute("ByTimeSize")) //*no error* if not available
+        in["DetectMovedFiles"].attribute("ByTimeSize", dirCfg.detectMovedFilesByTimeSize);
 }
 
 
@@ -1166,7 +1257,7 @@ void readConfig(const XmlIn& in, FilterConfig& filter /*int formatVer? but which
 }
 
 
-void readConfig(const XmlIn& in, LocalPairConfig& lpc, std::map<AfsDevice, size_t>& deviceParallelOps, int formatVer)
+void readConfig(const XmlIn& in, LocalPairConfig& lpc, std::map<AfsDevice, size_t>& deviceParallelOps, std::map<AfsDevice, uint64_t>& deviceBandwidthLimits, int formatVer)
 {
     //read folder pairs
     in["Left" ](lpc.folderPathPhraseLeft);
@@ -1205,6 +1296,21 @@ void readConfig(const XmlIn& in, LocalPairConfig& lpc, std::map<AfsDevice, size_
     setParallelOps(lpc.folderPathPhraseLeft,  parallelOpsL);
     setParallelOps(lpc.folderPathPhraseRight, parallelOpsR);
 
+    auto readBandwidthLimit = [&](const XmlIn& inFolder, const Zstring& folderPathPhrase)
+    {
+        if (inFolder.hasAttribute("BandwidthLimit"))
+        {
+            uint64_t bytesPerSec = 0;
+            inFolder.attribute("BandwidthLimit", bytesPerSec);
+
+            const uint64_t bytesPerSecPrev = getDeviceBandwidthLimit(deviceBandwidthLimits, folderPathPhrase);
+            if (bytesPerSec > 0 && (bytesPerSecPrev == 0 || bytesPerSec < bytesPerSecPrev)) //strictest limit wins
+                setDeviceBandwidthLimit(deviceBandwidthLimits, folderPathPhrase, bytesPerSec);
+        }
+    };
+    readBandwidthLimit(in["Left" ], lpc.folderPathPhraseLeft);
+    readBandwidthLimit(in["Right"], lpc.folderPathPhraseRight);
+
     //TODO: remove after migration - 2016-07-24
     auto ciReplace = [](Zstring& pathPhrase, const Zstring& oldTerm, const Zstring& newTerm) { replaceAsciiNoCase(pathPhrase, oldTerm, newTerm); };
     ciReplace(lpc.folderPathPhraseLeft,  Zstr("%csidl_MyDocuments%"), Zstr("%csidl_Documents%"));
@@ -1299,7 +1405,7 @@ void readConfig(const XmlIn& in, MainConfiguration& mainCfg, int formatVer)
     for (XmlIn inPair = inMain["FolderPairs"]["Pair"]; inPair; inPair.next())
     {
         LocalPairConfig lpc;
-        readConfig(inPair, lpc, mainCfg.deviceParallelOps, formatVer);
+        readConfig(inPair, lpc, mainCfg.deviceParallelOps, mainCfg.deviceBandwidthLimits, formatVer);
 
         if (firstItem)
         {
@@ -1537,6 +1643,28 @@ void readConfig(const XmlIn& in, XmlGlobalSettings& cfg, int formatVer)
     in2["LogFiles"                 ].attribute("MaxAge",  cfg.logfilesMaxAgeDays);
     in2["LogFiles"                 ].attribute("Format",  cfg.logFormat);
 
+    if (formatVer >= 25) //TODO: remove check after migration! 2026-10-14
+    {
+        in2["CompareContentTrustDatabase" ].attribute("Enabled", cfg.contentCmpTrustDatabase);
+        in2["CompareTimeSizeVerifyContent"].attribute("Enabled", cfg.timeSizeVerifyContent);
+        in2["SyncDatabaseJournal"         ].attribute("Enabled", cfg.syncDbJournal);
+        in2["AutoTuneParallelOps"         ].attribute("Enabled", cfg.autoTuneParallelOps);
+        in2["RemoteScanTrustDatabase"     ].attribute("Enabled", cfg.remoteScanTrustDatabase);
+        in2["SnapshotChangeDiscovery"     ].attribute("Enabled", cfg.snapshotChangeDiscovery);
+        in2["OutOfCoreComparison"         ].attribute("Enabled", cfg.outOfCoreComparison);
+        in2["SaveComparisonResult"        ].attribute("Enabled", cfg.saveComparisonResult);
+        in2["GlobalDeviceBudget"          ].attribute("Enabled", cfg.globalDeviceBudget);
+        in2["SyncIoPriority"              ].attribute("Value",   cfg.syncIoPriority);
+        in2["DropPageCacheBehind"         ].attribute("Enabled", cfg.dropPageCacheBehind);
+        in2["FlushTargetBuffers"          ].attribute("Enabled", cfg.flushTargetBuffers);
+        in2["DeltaCopy"                   ].attribute("MinSizeMB", cfg.deltaCopyMinSizeMB);
+        in2["ResumableCopy"               ].attribute("MinSizeMB", cfg.resumableCopyMinSizeMB);
+        in2["CompressVersions"            ].attribute("Enabled", cfg.compressVersions);
+        in2["LogFiles"                    ].attribute("Metrics", cfg.logMetrics);
+        in2["SyncHistory"]["FolderPairs"](cfg.syncHistory.folderPairs);
+        in2["SyncHistory"]["Devices"    ](cfg.syncHistory.devices);
+    }
+
     //TODO: remove old parameter after migration! 2021-03-06
     if (formatVer < 21)
     {
@@ -2073,6 +2201,162 @@ void readConfig(const XmlIn& in, XmlGlobalSettings& cfg, int formatVer)
 }
 
 
+/*  binary cache of the parsed XML: skip text parsing when the XML file is unchanged (large histories in GlobalSettings.xml, many .ffs_batch at cold start)
+    - stored in the config folder, not next to the XML: don't litter user folders with .ffs_batch files
+    - validated by path, size, inode, modification and change time of the XML file
+    - caches only the DOM, not the configuration: no need to update the cache format with each new setting  */
+const char XML_CACHE_DESCR[] = "FreeFileSync XML Cache";
+const int XML_CACHE_VERSION = 1; //2026-10-15
+
+
+std::optional<std::string> getXmlCacheKey(const Zstring& filePath) //noexcept
+{
+    struct stat fileInfo = {};
+    if (::stat(filePath.c_str(), &fileInfo) != 0)
+        return std::nullopt;
+
+    MemoryStreamOut<std::string> keyStream;
+    writeContainer(keyStream, filePath);
+    writeNumber<uint64_t>(keyStream, fileInfo.st_size);
+    writeNumber<uint64_t>(keyStream, fileInfo.st_ino);
+    writeNumber<int64_t >(keyStream, fileInfo.st_mtim.tv_sec);
+    writeNumber<int64_t >(keyStream, fileInfo.st_mtim.tv_nsec);
+    writeNumber<int64_t >(keyStream, fileInfo.st_ctim.tv_sec); //catch rewrites within file time precision
+    writeNumber<int64_t >(keyStream, fileInfo.st_ctim.tv_nsec);
+    return keyStream.ref();
+}
+
+
+Zstring getXmlCachePath(const Zstring& filePath)
+{
+    FNV1aHash<uint64_t> pathHash;
+    for (const Zchar c : filePath)
+        pathHash.add(c);
+
+    return appendPath(appendPath(getConfigDirPath(), Zstr("ConfigCache")), printNumber<Zstring>(Zstr("%016llx"), static_cast<unsigned long long>(pathHash.get())) + Zstr(".ffs_cache"));
+}
+
+
+void writeXmlElement(MemoryStreamOut<std::string>& streamOut, const XmlElement& elem)
+{
+    writeContainer(streamOut, elem.getName());
+    writeContainer(streamOut, elem.getValueRef());
+
+    const auto [itAttrBegin, itAttrEnd] = elem.getAttributes();
+    writeNumber<uint32_t>(streamOut, static_cast<uint32_t>(std::distance(itAttrBegin, itAttrEnd)));
+    for (auto it = itAttrBegin; it != itAttrEnd; ++it)
+    {
+        writeContainer(streamOut, it->name);
+        writeContainer(streamOut, it->value);
+    }
+
+    const auto [itChildBegin, itChildEnd] = elem.getChildren();
+    writeNumber<uint32_t>(streamOut, static_cast<uint32_t>(std::distance(itChildBegin, itChildEnd)));
+    for (auto it = itChildBegin; it != itChildEnd; ++it)
+        writeXmlElement(streamOut, *it);
+}
+
+
+void readXmlElement(MemoryStreamIn<std::string_view>& streamIn, XmlElement& elem) //throw SysErrorUnexpectedEos
+{
+    elem.setValue(readContainer<std::string>(streamIn)); //throw SysErrorUnexpectedEos
+
+    for (size_t i = readNumber<uint32_t>(streamIn); i-- > 0;) //throw SysErrorUnexpectedEos
+    {
+        const std::string attrName = readContainer<std::string>(streamIn); //throw SysErrorUnexpectedEos
+        elem.setAttribute(attrName, readContainer<std::string>(streamIn)); //
+    }
+
+    for (size_t i = readNumber<uint32_t>(streamIn); i-- > 0;) //throw SysErrorUnexpectedEos
+        readXmlElement(streamIn, elem.addChild(readContainer<std::string>(streamIn))); //throw SysErrorUnexpectedEos
+}
+
+
+void saveXmlCache(const XmlDoc& doc, const std::string& cacheKey, const Zstring& cachePath) //noexcept
+{
+    try
+    {
+        MemoryStreamOut<std::string> streamOut;
+        writeArray(streamOut, XML_CACHE_DESCR, sizeof(XML_CACHE_DESCR));
+        writeNumber<int32_t>(streamOut, XML_CACHE_VERSION);
+        writeContainer(streamOut, cacheKey);
+
+        writeContainer(streamOut, doc.getVersion());
+        writeContainer(streamOut, doc.getEncoding());
+        writeContainer(streamOut, doc.getStandalone());
+        writeContainer(streamOut, doc.root().getName());
+        writeXmlElement(streamOut, doc.root());
+
+        writeNumber<uint32_t>(streamOut, getCrc32(streamOut.ref()));
+
+        if (const std::optional<Zstring> parentPath = getParentFolderPath(cachePath))
+            createDirectoryIfMissingRecursion(*parentPath); //throw FileError
+        setFileContent(cachePath, streamOut.ref(), nullptr /*notifyUnbufferedIO*/); //throw FileError
+    }
+    catch (FileError&) {} //cache is optional
+}
+
+
+std::optional<XmlDoc> loadXmlCache(const std::string& cacheKey, const Zstring& cachePath) //noexcept
+{
+    try
+    {
+        const std::string byteStream = getFileContent(cachePath, nullptr /*notifyUnbufferedIO*/); //throw FileError
+        if (byteStream.size() < sizeof(uint32_t))
+            return std::nullopt;
+
+        //catch data corruption ASAP + don't rely on std::bad_alloc for consistency checking
+        MemoryStreamOut<std::string> crcStreamOut;
+        writeNumber<uint32_t>(crcStreamOut, getCrc32(byteStream.begin(), byteStream.end() - sizeof(uint32_t)));
+        if (!endsWith(byteStream, crcStreamOut.ref()))
+            return std::nullopt;
+
+        MemoryStreamIn<std::string_view> streamIn(byteStream); //perf: don't copy
+
+        char formatDescr[sizeof(XML_CACHE_DESCR)] = {};
+        readArray(streamIn, &formatDescr, sizeof(formatDescr)); //throw SysErrorUnexpectedEos
+
+        if (!std::equal(std::begin(formatDescr), std::end(formatDescr), std::begin(XML_CACHE_DESCR)) ||
+            readNumber<int32_t>(streamIn) != XML_CACHE_VERSION || //throw SysErrorUnexpectedEos
+            readContainer<std::string>(streamIn) != cacheKey)      //XML file changed or hash collision
+            return std::nullopt;
+
+        const std::string version    = readContainer<std::string>(streamIn); //
+        const std::string encoding   = readContainer<std::string>(streamIn); //throw SysErrorUnexpectedEos
+        const std::string standalone = readContainer<std::string>(streamIn); //
+
+        XmlDoc doc(readContainer<std::string>(streamIn)); //throw SysErrorUnexpectedEos
+        readXmlElement(streamIn, doc.root());             //
+        doc.setVersion   (version);
+        doc.setEncoding  (encoding);
+        doc.setStandalone(standalone);
+        return doc;
+    }
+    catch (FileError&) {} //not existing (yet)
+    catch (SysError&) {} //corrupted
+    return std::nullopt;
+}
+
+
+XmlDoc loadXmlCached(const Zstring& filePath) //throw FileError
+{
+    const std::optional<std::string> cacheKey = getXmlCacheKey(filePath); //noexcept
+    if (!cacheKey)
+        return loadXml(filePath); //throw FileError
+
+    const Zstring cachePath = getXmlCachePath(filePath);
+
+    if (std::optional<XmlDoc> doc = loadXmlCache(*cacheKey, cachePath)) //noexcept
+        return std::move(*doc);
+
+    XmlDoc doc = loadXml(filePath); //throw FileError
+
+    if (getXmlCacheKey(filePath) == cacheKey) //file changed while reading? don't cache
+        saveXmlCache(doc, *cacheKey, cachePath); //noexcept
+    return doc;
+}
+
+
 template <class ConfigType>
 std::pair<ConfigType, std::wstring /*warningMsg*/> parseConfig(const XmlDoc& doc, const Zstring& filePath, int currentXmlFormatVer) //noexcept
 {
@@ -2102,7 +2386,7 @@ std::pair<ConfigType, std::wstring /*warningMsg*/> parseConfig(const XmlDoc& doc
 template <class ConfigType>
 std::pair<ConfigType, std::wstring /*warningMsg*/> readConfig(const Zstring& filePath, XmlType type, int currentXmlFormatVer) //throw FileError
 {
-    XmlDoc doc = loadXml(filePath); //throw FileError
+    XmlDoc doc = loadXmlCached(filePath); //throw FileError
 
     if (getXmlTypeNoThrow(doc) != type) //noexcept
         throw FileError(replaceCpy(_("File %x does not contain a valid configuration."), L"%x", fmtPath(filePath)));
@@ -2143,7 +2427,7 @@ std::pair<XmlGuiConfig, std::wstring /*warningMsg*/> fff::readAnyConfig(const st
         const Zstring& filePath = *it;
         const bool firstItem = it == filePaths.begin(); //init all non-"mainCfg" settings with first config file
 
-        XmlDoc doc = loadXml(filePath); //throw FileError
+        XmlDoc doc = loadXmlCached(filePath); //throw FileError
 
         switch (getXmlTypeNoThrow(doc))
         {
@@ -2209,6 +2493,8 @@ void writeConfig(const SyncDirectionConfig& dirCfg, XmlOut& out)
     }
 
     out["DetectMovedFiles"](dirCfg.detectMovedFiles);
+
+    if (dirCfg.detectMovedFilesByTimeSize) out["DetectMovedFiles"].attribute("ByTimeSize", true);
 }
 
 
@@ -2249,7 +2535,7 @@ void writeConfig(const FilterConfig& filter, XmlOut& out)
 }
 
 
-void writeConfig(const LocalPairConfig& lpc, const std::map<AfsDevice, size_t>& deviceParallelOps, XmlOut& out)
+void writeConfig(const LocalPairConfig& lpc, const std::map<AfsDevice, size_t>& deviceParallelOps, const std::map<AfsDevice, uint64_t>& deviceBandwidthLimits, XmlOut& out)
 {
     XmlOut outPair = out.addChild("Pair");
 
@@ -2266,6 +2552,12 @@ void writeConfig(const LocalPairConfig& lpc, const std::map<AfsDevice, size_t>&
     //avoid "fake" changed configs by only storing "real" parallel-enabled devices in deviceParallelOps
     assert(std::all_of(deviceParallelOps.begin(), deviceParallelOps.end(), [](const auto& item) { return item.second > 1; }));
 
+    const uint64_t bandwidthLimitL = getDeviceBandwidthLimit(deviceBandwidthLimits, lpc.folderPathPhraseLeft);
+    const uint64_t bandwidthLimitR = getDeviceBandwidthLimit(deviceBandwidthLimits, lpc.folderPathPhraseRight);
+
+    if (bandwidthLimitL > 0) outPair["Left" ].attribute("BandwidthLimit", bandwidthLimitL);
+    if (bandwidthLimitR > 0) outPair["Right"].attribute("BandwidthLimit", bandwidthLimitR);
+
     //###########################################################
     //alternate comp configuration (optional)
     if (lpc.localCmpCfg)
@@ -2312,10 +2604,10 @@ void writeConfig(const MainConfiguration& mainCfg, XmlOut& out)
     //###########################################################
     XmlOut outFp = outMain["FolderPairs"];
     //write folder pairs
-    writeConfig(mainCfg.firstPair, mainCfg.deviceParallelOps, outFp);
+    writeConfig(mainCfg.firstPair, mainCfg.deviceParallelOps, mainCfg.deviceBandwidthLimits, outFp);
 
     for (const LocalPairConfig& lpc : mainCfg.additionalPairs)
-        writeConfig(lpc, mainCfg.deviceParallelOps, outFp);
+        writeConfig(lpc, mainCfg.deviceParallelOps, mainCfg.deviceBandwidthLimits, outFp);
 
     outMain["Errors"].attribute("Ignore", mainCfg.ignoreErrors);
     outMain["Errors"].attribute("Retry",  mainCfg.autoRetryCount);
@@ -2368,14 +2660,33 @@ void writeConfig(const XmlGlobalSettings& cfg, XmlOut& out)
     out["CopyLockedFiles"          ].attribute("Enabled", cfg.copyLockedFiles);
     out["CopyFilePermissions"      ].attribute("Enabled", cfg.copyFilePermissions);
     out["FileTimeTolerance"        ].attribute("Seconds", cfg.fileTimeTolerance);
+    out["CompareContentTrustDatabase"].attribute("Enabled", cfg.contentCmpTrustDatabase);
+    out["CompareTimeSizeVerifyContent"].attribute("Enabled", cfg.timeSizeVerifyContent);
+    out["SyncDatabaseJournal"        ].attribute("Enabled", cfg.syncDbJournal);
+    out["AutoTuneParallelOps"        ].attribute("Enabled", cfg.autoTuneParallelOps);
+    out["GlobalDeviceBudget"         ].attribute("Enabled", cfg.globalDeviceBudget);
+    out["RemoteScanTrustDatabase"    ].attribute("Enabled", cfg.remoteScanTrustDatabase);
+    out["SnapshotChangeDiscovery"    ].attribute("Enabled", cfg.snapshotChangeDiscovery);
+    out["OutOfCoreComparison"        ].attribute("Enabled", cfg.outOfCoreComparison);
+    out["SaveComparisonResult"       ].attribute("Enabled", cfg.saveComparisonResult);
     out["RunWithBackgroundPriority"].attribute("Enabled", cfg.runWithBackgroundPriority);
+    out["SyncIoPriority"           ].attribute("Value", cfg.syncIoPriority);
+    out["DropPageCacheBehind"      ].attribute("Enabled", cfg.dropPageCacheBehind);
+    out["FlushTargetBuffers"       ].attribute("Enabled", cfg.flushTargetBuffers);
+    out["DeltaCopy"                ].attribute("MinSizeMB", cfg.deltaCopyMinSizeMB);
+    out["ResumableCopy"            ].attribute("MinSizeMB", cfg.resumableCopyMinSizeMB);
+    out["CompressVersions"         ].attribute("Enabled", cfg.compressVersions);
     out["LockDirectoriesDuringSync"].attribute("Enabled", cfg.createLockFile);
     out["VerifyCopiedFiles"        ].attribute("Enabled", cfg.verifyFileCopy);
     out["LogFiles"                 ].attribute("MaxAge",  cfg.logfilesMaxAgeDays);
     out["LogFiles"                 ].attribute("Format",  cfg.logFormat);
+    out["LogFiles"                 ].attribute("Metrics", cfg.logMetrics);
 
     out["ProgressDialog"].attribute("AutoClose", cfg.progressDlgAutoClose);
 
+    out["SyncHistory"]["FolderPairs"](cfg.syncHistory.folderPairs);
+    out["SyncHistory"]["Devices"    ](cfg.syncHistory.devices);
+
     XmlOut outOpt = out["OptionalDialogs"];
     outOpt["ConfirmStartSync"              ].attribute("Show", cfg.confirmDlgs.confirmSyncStart);
     outOpt["ConfirmSaveConfig"             ].attribute("Show", cfg.confirmDlgs.confirmSaveConfig);
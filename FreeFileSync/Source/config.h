@@ -9,6 +9,7 @@
 
 #include <wx/gdicmn.h>
 #include <zen/file_access.h>
+#include <zen/process_priority.h>
 #include "localization.h"
 #include "base/structures.h"
 #include "ui/file_grid_attr.h"
@@ -159,11 +160,27 @@ struct XmlGlobalSettings
     bool copyFilePermissions = false;
 
     int fileTimeTolerance = zen::FAT_FILE_TIME_PRECISION_SEC; //max. allowed file time deviation; < 0 means unlimited tolerance; default 2s: FAT vs NTFS
+    bool contentCmpTrustDatabase = false; //compare by content: skip files that are unchanged since last sync according to sync.ffs_db
+    bool timeSizeVerifyContent = false; //compare by time and size: same size, different time => compare content; equal => update modification time only
+    bool remoteScanTrustDatabase = false; //FTP/SFTP: take folders from sync.ffs_db instead of traversing => only if nobody else modifies them!
+    bool snapshotChangeDiscovery = false; //Btrfs/ZFS: take folders from sync.ffs_db unless changed according to file system snapshots
+    bool outOfCoreComparison = false; //batch mode: move sub trees without changes to a temporary file after comparison
+    bool saveComparisonResult = false; //batch mode: save comparison result next to the *.ffs_batch file => open in GUI without rescanning
+    bool syncDbJournal = false; //save changes to sync.ffs_db as small journal files; full database is written only when compacting
+    bool autoTuneParallelOps = false; //synchronization: use deviceParallelOps as upper limit and adapt to measured throughput
+    bool globalDeviceBudget = false; //synchronization: parallel operations per device are shared by all FreeFileSync processes, e.g. concurrent batch jobs
     bool runWithBackgroundPriority = false;
+    zen::IoPriority syncIoPriority = zen::IoPriority::normal; //synchronization: I/O scheduling class of worker threads (Linux)
+    bool dropPageCacheBehind = false; //synchronization: don't pollute the page cache with file copies (e.g. backup on a server)
+    bool flushTargetBuffers = false; //synchronization: flush written data to disk before saving sync.ffs_db => crash-consistent backups
+    int deltaCopyMinSizeMB = 0; //synchronization: update large files by writing changed blocks only (reflink clone of the old version); 0: disabled
+    int resumableCopyMinSizeMB = 0; //synchronization: interrupted copies of large files continue from the partial temp file next time; 0: disabled
+    bool compressVersions = false; //versioning: versions that must be copied (not moved) are stored compressed (.zst, or .gz without libzstd)
     bool createLockFile = true;
     bool verifyFileCopy = false;
     int logfilesMaxAgeDays = 30; //<= 0 := no limit; for log files under %AppData%\FreeFileSync\Logs
     LogFileFormat logFormat = LogFileFormat::html;
+    bool logMetrics = false; //batch mode: write machine-readable metrics (.json) next to each log file
 
     Zstring soundFileCompareFinished;
     Zstring soundFileSyncFinished;
@@ -172,6 +189,8 @@ struct XmlGlobalSettings
     ConfirmationDialogs confirmDlgs;
     WarningDialogs warnDlgs;
 
+    SyncHistory syncHistory; //folder pair durations and device throughput of previous syncs
+
     //---------------------------------------------------------------------
 
     struct
@@ -0,0 +1,261 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#include "console_status_handler.h"
+#include <iostream>
+#include <unistd.h> //isatty
+#include <zen/format_unit.h>
+#include <zen/resolve_path.h>
+#include "afs/concrete.h"
+#include "log_file.h"
+
+using namespace zen;
+using namespace fff;
+
+
+ConsoleStatusHandler::ConsoleStatusHandler(const std::wstring& jobName,
+                                           const std::chrono::system_clock::time_point& startTime,
+                                           bool ignoreErrors,
+                                           size_t autoRetryCount,
+                                           std::chrono::seconds autoRetryDelay,
+                                           LogFileFormat logFormat) :
+    jobName_(jobName),
+    startTime_(startTime),
+    ignoreErrors_(ignoreErrors),
+    autoRetryCount_(autoRetryCount),
+    autoRetryDelay_(autoRetryDelay),
+    showProgress_(::isatty(STDOUT_FILENO) != 0),
+    logJournal_(getLogFolderDefaultPath(), logFormat, {jobName}, startTime) {}
+
+
+ConsoleStatusHandler::~ConsoleStatusHandler()
+{
+    if (!resultsReported_) //reportResults() was not called!
+        std::abort();
+}
+
+
+void ConsoleStatusHandler::logMsgAndPrint(const std::wstring& msg, MessageType type, time_t time)
+{
+    logAndPrint({time, type, utfTo<Zstringc>(msg)});
+}
+
+
+void ConsoleStatusHandler::logAndPrint(const LogEntry& entry)
+{
+    logJournal_.append(entry);
+
+    clearStatusLine();
+    (entry.type == MSG_TYPE_INFO ? std::cout : std::cerr) << formatMessage(entry) << std::flush;
+}
+
+
+void ConsoleStatusHandler::clearStatusLine()
+{
+    if (statusLineLen_ > 0) //don't mix messages with the progress line
+    {
+        std::cout << '\r' + std::string(statusLineLen_, ' ') + '\r' << std::flush;
+        statusLineLen_ = 0;
+    }
+}
+
+
+ConsoleStatusHandler::Result ConsoleStatusHandler::reportResults(const Zstring& postSyncCommand, PostSyncCondition postSyncCondition,
+                                                                 const AbstractPath& logFolderPath, int logfilesMaxAgeDays, bool logMetrics,
+                                                                 const std::set<AbstractPath>& logFilePathsToKeep,
+                                                                 const std::string& emailNotifyAddress, ResultsNotification emailNotifyCondition) //noexcept!!
+{
+    assert(!resultsReported_);
+    resultsReported_ = true;
+
+    const auto totalTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTimeSteady_);
+
+    //determine post-sync status irrespective of further errors during tear-down
+    const SyncResult syncResult = [&]
+    {
+        if (getAbortStatus())
+        {
+            logMsgAndPrint(_("Stopped"), MSG_TYPE_ERROR);
+            return SyncResult::aborted;
+        }
+        const ErrorLogStats& logCount = logJournal_.getStats();
+        if (logCount.error > 0)
+            return SyncResult::finishedError;
+        else if (logCount.warning > 0)
+            return SyncResult::finishedWarning;
+
+        if (getStatsTotal() == ProgressStats())
+            logMsgAndPrint(_("Nothing to synchronize"), MSG_TYPE_INFO);
+        return SyncResult::finishedSuccess;
+    }();
+
+    assert(syncResult == SyncResult::aborted || currentPhase() == ProcessPhase::synchronizing);
+
+    if (logMetrics) //size machines for big jobs, spot memory regressions
+        logMsgAndPrint(_("Memory usage:") + L' ' + formatMemoryUsage(getMemoryUsage()), MSG_TYPE_INFO);
+
+    const ProcessSummary summary
+    {
+        startTime_, syncResult, {jobName_},
+        getStatsCurrent(),
+        getStatsTotal  (),
+        totalTime,
+        getPhaseMetrics(),
+        getScanStats(),
+        getMemoryUsage()
+    };
+
+    AbstractPath logFilePath = AFS::appendRelPath(logFolderPath, generateLogFileName(logJournal_.getLogFormat(), summary));
+
+    auto notifyStatusNoThrow = [&](std::wstring&& msg) { try { updateStatus(std::move(msg)); /*throw AbortProcess*/ } catch (AbortProcess&) {} };
+
+    //no user cancel possible => always run post sync command and email notification
+    //--------------------- post sync command ----------------------
+    if (const Zstring cmdLine = trimCpy(postSyncCommand);
+        !cmdLine.empty())
+        if (postSyncCondition == PostSyncCondition::completion ||
+            (postSyncCondition == PostSyncCondition::errors) == (syncResult == SyncResult::aborted ||
+                                                                 syncResult == SyncResult::finishedError))
+        {
+            ErrorLog cmdLog;
+            runCommandAndLogErrors(expandMacros(cmdLine), cmdLog);
+            for (const LogEntry& entry : cmdLog)
+                logAndPrint(entry);
+        }
+
+    //--------------------- email notification ----------------------
+    if (const std::string notifyEmail = trimCpy(emailNotifyAddress);
+        !notifyEmail.empty())
+        if (emailNotifyCondition == ResultsNotification::always ||
+            (emailNotifyCondition == ResultsNotification::errorWarning && (syncResult == SyncResult::aborted       ||
+                                                                           syncResult == SyncResult::finishedError ||
+                                                                           syncResult == SyncResult::finishedWarning)) ||
+            (emailNotifyCondition == ResultsNotification::errorOnly && (syncResult == SyncResult::aborted ||
+                                                                        syncResult == SyncResult::finishedError)))
+            try
+            {
+                sendLogAsEmail(notifyEmail, summary, logJournal_.getRecentEntries(), logFilePath, notifyStatusNoThrow); //throw FileError
+                logMsgAndPrint(replaceCpy(_("Sending email notification to %x"), L"%x", utfTo<std::wstring>(notifyEmail)), MSG_TYPE_INFO);
+            }
+            catch (const FileError& e) { logMsgAndPrint(e.toString(), MSG_TYPE_ERROR); }
+
+    //--------------------- save log file ----------------------
+    try
+    {
+        saveLogFile(logFilePath, summary, logJournal_, logfilesMaxAgeDays, logFilePathsToKeep, notifyStatusNoThrow); //throw FileError
+    }
+    catch (const FileError& e)
+    {
+        logMsgAndPrint(e.toString(), MSG_TYPE_ERROR);
+
+        const AbstractPath logFileDefaultPath = AFS::appendRelPath(createAbstractPath(getLogFolderDefaultPath()), generateLogFileName(logJournal_.getLogFormat(), summary));
+        if (logFilePath != logFileDefaultPath) //fallback: log file *must* be saved no matter what!
+            try
+            {
+                logFilePath = logFileDefaultPath;
+                saveLogFile(logFileDefaultPath, summary, logJournal_, logfilesMaxAgeDays, logFilePathsToKeep, notifyStatusNoThrow); //throw FileError
+            }
+            catch (const FileError& e2) { logMsgAndPrint(e2.toString(), MSG_TYPE_ERROR); }
+    }
+
+    if (logMetrics)
+        try
+        {
+            saveMetricsFile(logFilePath, summary, logJournal_.getStats()); //throw FileError
+        }
+        catch (const FileError& e) { logMsgAndPrint(e.toString(), MSG_TYPE_ERROR); }
+    //----------------------------------------------------------
+
+    clearStatusLine();
+    std::cout << utfTo<std::string>(getSyncResultLabel(syncResult)) + '\n'; //console only: not part of the log file
+
+    return {syncResult, logJournal_.getStats(), logFilePath};
+}
+
+
+void ConsoleStatusHandler::initNewPhase(int itemsTotal, int64_t bytesTotal, ProcessPhase phaseID)
+{
+    StatusHandler::initNewPhase(itemsTotal, bytesTotal, phaseID);
+    requestUiUpdate(true /*force*/); //throw AbortProcess
+}
+
+
+void ConsoleStatusHandler::logInfo(const std::wstring& msg)
+{
+    logMsgAndPrint(msg, MSG_TYPE_INFO);
+    requestUiUpdate(false /*force*/); //throw AbortProcess
+}
+
+
+void ConsoleStatusHandler::reportWarning(const std::wstring& msg, bool& warningActive)
+{
+    logMsgAndPrint(msg, MSG_TYPE_WARNING);
+
+    if (!warningActive)
+        return;
+
+    if (!ignoreErrors_) //nobody to ask => same as BatchErrorHandling::cancel
+        abortProcessNow(AbortTrigger::program); //throw AbortProcess
+}
+
+
+ProcessCallback::Response ConsoleStatusHandler::reportError(const ErrorInfo& errorInfo)
+{
+    //log actual fail time (not "now"!)
+    const time_t failTime = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now() -
+                                                                 std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::steady_clock::now() - errorInfo.failTime));
+    //auto-retry
+    if (errorInfo.retryNumber < autoRetryCount_)
+    {
+        logMsgAndPrint(errorInfo.msg + L"\n-> " + _("Automatic retry"), MSG_TYPE_INFO, failTime);
+        delayAndCountDown(errorInfo.failTime + autoRetryDelay_,
+                          [&, statusPrefix  = _("Automatic retry") +
+                                              (errorInfo.retryNumber == 0 ? L"" : L' ' + formatNumber(errorInfo.retryNumber + 1)) + SPACED_DASH,
+                              statusPostfix = SPACED_DASH + _("Error") + L": " + replaceCpy(errorInfo.msg, L'\n', L' ')](const std::wstring& timeRemMsg)
+        { this->updateStatus(statusPrefix + timeRemMsg + statusPostfix); }); //throw AbortProcess
+        return ProcessCallback::retry;
+    }
+
+    logMsgAndPrint(errorInfo.msg, MSG_TYPE_ERROR, failTime);
+
+    if (!ignoreErrors_)
+        abortProcessNow(AbortTrigger::program); //throw AbortProcess
+
+    return ProcessCallback::ignore;
+}
+
+
+void ConsoleStatusHandler::reportFatalError(const std::wstring& msg)
+{
+    logMsgAndPrint(msg, MSG_TYPE_ERROR);
+
+    if (!ignoreErrors_)
+        abortProcessNow(AbortTrigger::program); //throw AbortProcess
+}
+
+
+void ConsoleStatusHandler::forceUiUpdateNoThrow()
+{
+    if (!showProgress_)
+        return;
+
+    std::wstring statusLine = currentStatusText();
+
+    if (const ProgressStats statsTotal = getStatsTotal();
+        statsTotal.items >= 0 && currentPhase() != ProcessPhase::scanning)
+    {
+        const ProgressStats statsCurrent = getStatsCurrent();
+        statusLine = formatNumber(statsCurrent.items) + L'/' + formatNumber(statsTotal.items) + L"  " +
+                     formatFilesizeShort(statsCurrent.bytes) + L'/' + formatFilesizeShort(statsTotal.bytes) + SPACED_DASH + statusLine;
+    }
+    replace(statusLine, L'\n', L' ');
+
+    const std::string statusLineUtf = utfTo<std::string>(statusLine);
+    const size_t statusLineLen = unicodeLength(statusLineUtf);
+
+    std::cout << '\r' + statusLineUtf + std::string(statusLineLen < statusLineLen_ ? statusLineLen_ - statusLineLen : 0, ' ') << std::flush;
+    statusLineLen_ = statusLineLen;
+}
@@ -0,0 +1,68 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#ifndef CONSOLE_STATUS_HANDLER_H_2804718925630475
+#define CONSOLE_STATUS_HANDLER_H_2804718925630475
+
+#include <chrono>
+#include <zen/error_log.h>
+#include "config.h"
+#include "status_handler.h"
+#include "log_file.h"
+
+
+namespace fff
+{
+//headless counterpart of BatchStatusHandler: no progress dialog, no popups => log to stdout/stderr
+class ConsoleStatusHandler : public StatusHandler
+{
+public:
+    ConsoleStatusHandler(const std::wstring& jobName, //should not be empty for a batch job!
+                         const std::chrono::system_clock::time_point& startTime,
+                         bool ignoreErrors,
+                         size_t autoRetryCount,
+                         std::chrono::seconds autoRetryDelay,
+                         LogFileFormat logFormat); //noexcept!!
+    ~ConsoleStatusHandler();
+
+    void     initNewPhase    (int itemsTotal, int64_t bytesTotal, ProcessPhase phaseID) override; //
+    void     logInfo         (const std::wstring& msg)                                  override; //
+    void     reportWarning   (const std::wstring& msg, bool& warningActive)             override; //throw AbortProcess
+    Response reportError     (const ErrorInfo& errorInfo)                               override; //
+    void     reportFatalError(const std::wstring& msg)                                  override; //
+
+    void forceUiUpdateNoThrow() override; //noexcept
+
+    struct Result
+    {
+        SyncResult syncResult;
+        zen::ErrorLogStats logStats;
+        AbstractPath logFilePath;
+    };
+    Result reportResults(const Zstring& postSyncCommand, PostSyncCondition postSyncCondition,
+                         const AbstractPath& logFolderPath, int logfilesMaxAgeDays, bool logMetrics, const std::set<AbstractPath>& logFilePathsToKeep,
+                         const std::string& emailNotifyAddress, ResultsNotification emailNotifyCondition); //noexcept!!
+
+private:
+    void logMsgAndPrint(const std::wstring& msg, zen::MessageType type, time_t time = std::time(nullptr));
+    void logAndPrint(const zen::LogEntry& entry);
+    void clearStatusLine();
+
+    const std::wstring jobName_;
+    const std::chrono::system_clock::time_point startTime_;
+    const std::chrono::steady_clock::time_point startTimeSteady_ = std::chrono::steady_clock::now();
+    const bool ignoreErrors_;
+    const size_t autoRetryCount_;
+    const std::chrono::seconds autoRetryDelay_;
+    const bool showProgress_; //only if stdout is a terminal: don't spam cron mails and log files
+
+    LogJournal logJournal_; //list of non-resolved errors and warnings: streamed to disk => bounded memory even for huge logs
+    size_t statusLineLen_ = 0; //length of the progress line currently shown on the terminal
+    bool resultsReported_ = false;
+};
+}
+
+#endif //CONSOLE_STATUS_HANDLER_H_2804718925630475
@@ -7,6 +7,7 @@
 #include "icon_buffer.h"
 #include <map>
 #include <set>
+#include <unordered_map>
 #include <variant>
 #include <zen/thread.h> //includes <std/thread.hpp>
 #include <zen/scope_guard.h>
@@ -15,6 +16,7 @@
 #include <wx+/image_tools.h>
 #include <wx+/std_button_layout.h>
 #include "base/icon_loader.h"
+#include "base/memory_stats.h"
 
 
 using namespace zen;
@@ -25,6 +27,10 @@ using AFS = AbstractFileSystem;
 namespace
 {
 const size_t BUFFER_SIZE_MAX = 1000; //maximum number of icons to hold in buffer: must be big enough to hold visible icons + preload buffer!
+const size_t BUFFER_SIZE_MIN = 200;  //never evict below this count due to BUFFER_BYTES_MAX: visible icons + preload buffer for large thumbnails
+const size_t BUFFER_BYTES_MAX = 64 * 1024 * 1024; //thumbnails dominate memory: 128 DIP at 200% scaling ~ 256 kB each
+
+const size_t ICON_LOADER_THREADS = 4; //thumbnail extraction is I/O + decode bound: don't let one slow file stall the rest
 
 
 }
@@ -70,12 +76,13 @@ class WorkLoad
 {
 public:
     //context of main thread
-    void set(const std::vector<AbstractPath>& newLoad)
+    void set(const std::vector<AbstractPath>& visibleLoad, const std::vector<AbstractPath>& prefetchLoad)
     {
         assert(runningOnMainThread());
         {
             std::lock_guard dummy(lockFiles_);
-            workLoad_ = newLoad;
+            visibleLoad_  = visibleLoad;
+            prefetchLoad_ = prefetchLoad;
         }
         conditionNewWork_.notify_all(); //instead of notify_one(); work around bug: https://svn.boost.org/trac/boost/ticket/7796
         //condition handling, see: https://www.boost.org/doc/libs/1_43_0/doc/html/thread/synchronization.html#thread.synchronization.condvar_ref
@@ -86,7 +93,7 @@ public:
         assert(runningOnMainThread());
         {
             std::lock_guard dummy(lockFiles_);
-            workLoad_.emplace_back(filePath); //set as next item to retrieve
+            visibleLoad_.emplace_back(filePath); //set as next item to retrieve
         }
         conditionNewWork_.notify_all();
     }
@@ -97,18 +104,33 @@ public:
         assert(!runningOnMainThread());
         std::unique_lock dummy(lockFiles_);
 
-        interruptibleWait(conditionNewWork_, dummy, [this] { return !workLoad_.empty(); }); //throw ThreadStopRequest
+        for (;;)
+        {
+            interruptibleWait(conditionNewWork_, dummy, [this] { return !visibleLoad_.empty() || !prefetchLoad_.empty(); }); //throw ThreadStopRequest
+
+            std::vector<AbstractPath>& load = !visibleLoad_.empty() ? visibleLoad_ : prefetchLoad_; //visible rows first!
+
+            AbstractPath filePath = load.    back(); //yes, no strong exception guarantee (std::bad_alloc)
+            /**/                    load.pop_back(); //
 
-        AbstractPath filePath = workLoad_.    back(); //yes, no strong exception guarantee (std::bad_alloc)
-        /**/                    workLoad_.pop_back(); //
-        return filePath;
+            if (inProgress_.insert(filePath).second) //skip if another worker is already loading this item
+                return filePath;
+        }
+    }
+
+    void done(const AbstractPath& filePath) //context of worker thread
+    {
+        std::lock_guard dummy(lockFiles_);
+        inProgress_.erase(filePath);
     }
 
 private:
     //AbstractPath is thread-safe like an int!
     std::mutex                lockFiles_;
     std::condition_variable   conditionNewWork_; //signal event: data for processing available
-    std::vector<AbstractPath> workLoad_; //processes last elements of vector first!
+    std::vector<AbstractPath> visibleLoad_;  //processes last elements of vector first!
+    std::vector<AbstractPath> prefetchLoad_; //only considered when visibleLoad_ is empty
+    std::set<AbstractPath>    inProgress_;   //items currently being loaded by some worker
 };
 
 
@@ -143,13 +165,16 @@ public:
             {
                 idata.iconFmt = std::make_unique<wxImage>(extractWxImage(std::move(*ih))); //convert in main thread!
                 assert(!*ih);
+                //byteCount unchanged: wxImage takes ownership of the same RGB/alpha buffers
             }
         }
         else
         {
             if (FileIconHolder& fih = std::get<FileIconHolder>(idata.iconHolder)) //if not yet converted...
             {
-                idata.iconFmt = std::make_unique<wxImage>(extractWxImage(std::move(fih))); //convert in main thread!
+                idata.iconFmt = std::make_unique<wxImage>(extractSharedImage(std::move(fih), idata.byteCount)); //convert in main thread!
+                totalBytes_ += idata.byteCount;
+                memoryUsage_.set(totalBytes_);
                 assert(!fih);
                 //!idata.iconFmt->IsOk(): extractWxImage() might fail if icon theme is missing a MIME type!
             }
@@ -165,10 +190,13 @@ public:
 
         //thread safety: moving ImageHolder is free from side effects, but ~wxImage() is NOT! => do NOT delete items from iconList here!
         auto rc = iconList.emplace(filePath, IconData());
-        assert(rc.second); //insertion took place
-        if (rc.second)
+        if (rc.second) //else: loaded concurrently via retrieveFileIcon() + setWorkload() => discard duplicate (~ImageHolder/~FileIconHolder are thread-safe)
         {
-            refData(rc.first).iconHolder = std::move(ih);
+            IconData& idata = refData(rc.first);
+            idata.iconHolder = std::move(ih);
+            idata.byteCount = getByteCount(idata.iconHolder);
+            totalBytes_ += idata.byteCount;
+            memoryUsage_.set(totalBytes_);
             priorityListPushBack(rc.first);
         }
     }
@@ -180,15 +208,56 @@ public:
         assert(runningOnMainThread());
         std::lock_guard dummy(lockIconList_);
 
-        while (iconList.size() > BUFFER_SIZE_MAX)
+        while (iconList.size() > BUFFER_SIZE_MAX ||
+               (totalBytes_ > BUFFER_BYTES_MAX && iconList.size() > BUFFER_SIZE_MIN))
         {
             auto itDelPos = firstInsertPos_;
             priorityListPopFront();
+            assert(totalBytes_ >= refData(itDelPos).byteCount);
+            totalBytes_ -= refData(itDelPos).byteCount;
+            memoryUsage_.set(totalBytes_);
             iconList.erase(itDelPos); //remove oldest element
         }
     }
 
 private:
+    static size_t getByteCount(std::variant<ImageHolder, FileIconHolder>& iconHolder)
+    {
+        if (ImageHolder* ih = std::get_if<ImageHolder>(&iconHolder))
+            if (*ih)
+                return static_cast<size_t>(ih->getWidth()) * ih->getHeight() * (ih->getAlpha() ? 4 : 3);
+        return 0; //file icons: accounted for after conversion, see extractSharedImage()
+    }
+
+    //call while holding lock:
+    //g_file_query_info() returns themed icons in practice => all files of the same type share a single wxImage (ref-counted)
+    wxImage extractSharedImage(FileIconHolder&& fih, size_t& byteCount)
+    {
+        assert(runningOnMainThread());
+        std::string iconName;
+        if (gchar* name = ::g_icon_to_string(fih.gicon.get()))
+        {
+            ZEN_ON_SCOPE_EXIT(::g_free(name));
+            iconName = name;
+        }
+
+        if (iconName.empty()) //not serializable => no sharing
+        {
+            wxImage img = extractWxImage(std::move(fih));
+            byteCount = img.IsOk() ? static_cast<size_t>(img.GetWidth()) * img.GetHeight() * 4 : 0;
+            return img;
+        }
+
+        auto it = sharedIcons_.find(iconName);
+        if (it == sharedIcons_.end())
+            it = sharedIcons_.emplace(iconName, extractWxImage(std::move(fih))).first;
+        else
+            fih.gicon.reset();
+
+        byteCount = 0; //bounded by number of file types, like IconBuffer::Impl::extensionIcons
+        return it->second;
+    }
+
     struct IconData;
     using FileIconMap = std::map<AbstractPath, IconData>;
     IconData& refData(FileIconMap::iterator it) { return it->second; }
@@ -253,7 +322,7 @@ private:
     struct IconData
     {
         IconData() {}
-        IconData(IconData&& tmp) noexcept : iconHolder(std::move(tmp.iconHolder)), iconFmt(std::move(tmp.iconFmt)), prev(tmp.prev), next(tmp.next) {}
+        IconData(IconData&& tmp) noexcept : iconHolder(std::move(tmp.iconHolder)), iconFmt(std::move(tmp.iconFmt)), byteCount(tmp.byteCount), prev(tmp.prev), next(tmp.next) {}
 
         std::variant<ImageHolder, FileIconHolder> iconHolder; //native icon representation: may be used by any thread
 
@@ -263,6 +332,8 @@ private:
         //- prohibit calls to ~wxImage() and transitively ~IconData()
         //- prohibit even wxImage() default constructor - better be safe than sorry!
 
+        size_t byteCount = 0; //pixel memory owned by this entry (shared file icons: 0)
+
         FileIconMap::iterator prev; //store list sorted by time of insertion into buffer
         FileIconMap::iterator next; //
     };
@@ -271,6 +342,10 @@ private:
     FileIconMap iconList; //shared resource; Zstring is thread-safe like an int
     FileIconMap::iterator firstInsertPos_ = iconList.end();
     FileIconMap::iterator lastInsertPos_  = iconList.end();
+    size_t totalBytes_ = 0;
+    MemoryUsageTracker memoryUsage_{MemoryCategory::iconCache};
+
+    std::unordered_map<std::string, wxImage> sharedIcons_; //use ONLY from main thread! icon name => image
 };
 
 //################################################################################################################################################
@@ -284,7 +359,7 @@ struct IconBuffer::Impl
     WorkLoad workload; //manage life time: enclose InterruptibleThread's (until joined)!!!
     Buffer   buffer;   //
 
-    InterruptibleThread worker;
+    std::vector<InterruptibleThread> workers;
     //-------------------------
     //-------------------------
     std::unordered_map<Zstring, wxImage, StringHashAsciiNoCase, StringEqualAsciiNoCase> extensionIcons; //no item count limit!? Test case C:\ ~ 3800 unique file extensions
@@ -293,27 +368,29 @@ struct IconBuffer::Impl
 
 IconBuffer::IconBuffer(IconSize sz) : pimpl_(std::make_unique<Impl>()), iconSizeType_(sz)
 {
-    pimpl_->worker = InterruptibleThread([&workload = pimpl_->workload, &buffer = pimpl_->buffer, sz]
-    {
-        setCurrentThreadName(Zstr("Icon Buffer"));
-
-        for (;;)
+    for (size_t i = 0; i < ICON_LOADER_THREADS; ++i)
+        pimpl_->workers.emplace_back([&workload = pimpl_->workload, &buffer = pimpl_->buffer, sz]
         {
-            //start work: blocks until next icon to load is retrieved:
-            const AbstractPath itemPath = workload.extractNext(); //throw ThreadStopRequest
+            setCurrentThreadName(Zstr("Icon Buffer"));
 
-            if (!buffer.hasIcon(itemPath)) //perf: workload may contain duplicate entries?
-                buffer.insert(itemPath, getDisplayIcon(itemPath, sz));
-        }
-    });
+            for (;;)
+            {
+                //start work: blocks until next icon to load is retrieved:
+                const AbstractPath itemPath = workload.extractNext(); //throw ThreadStopRequest
+                ZEN_ON_SCOPE_EXIT(workload.done(itemPath));
+
+                if (!buffer.hasIcon(itemPath)) //perf: workload may contain duplicate entries?
+                    buffer.insert(itemPath, getDisplayIcon(itemPath, sz));
+            }
+        });
 }
 
 
 IconBuffer::~IconBuffer()
 {
-    setWorkload({}); //make sure interruption point is always reached! needed???
-    pimpl_->worker.requestStop(); //end thread life time *before*
-    pimpl_->worker.join();        //IconBuffer::Impl member clean up!
+    setWorkload({}, {}); //make sure interruption point is always reached! needed???
+    for (InterruptibleThread& worker : pimpl_->workers) worker.requestStop(); //end thread life time *before*
+    for (InterruptibleThread& worker : pimpl_->workers) worker.join();        //IconBuffer::Impl member clean up!
 }
 
 
@@ -358,11 +435,11 @@ std::optional<wxImage> IconBuffer::retrieveFileIcon(const AbstractPath& filePath
 }
 
 
-void IconBuffer::setWorkload(const std::vector<AbstractPath>& load)
+void IconBuffer::setWorkload(const std::vector<AbstractPath>& visibleLoad, const std::vector<AbstractPath>& prefetchLoad)
 {
-    assert(load.size() < BUFFER_SIZE_MAX / 2);
+    assert(visibleLoad.size() + prefetchLoad.size() < BUFFER_SIZE_MAX / 2);
 
-    pimpl_->workload.set(load); //since buffer can only increase due to new workload,
+    pimpl_->workload.set(visibleLoad, prefetchLoad); //since buffer can only increase due to new workload,
     pimpl_->buffer.limitSize(); //this is the place to impose the limit from main thread!
 }
 
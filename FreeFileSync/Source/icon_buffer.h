@@ -32,7 +32,8 @@ public:
     static int getSize(IconSize sz); //expected and *maximum* icon size in pixel
     int getSize() const { return getSize(iconSizeType_); } //
 
-    void                   setWorkload      (const std::vector<AbstractPath>& load); //(re-)set new workload of icons to be retrieved;
+    void                   setWorkload      (const std::vector<AbstractPath>& visibleLoad,
+                                             const std::vector<AbstractPath>& prefetchLoad); //(re-)set new workload of icons to be retrieved: visible first; both processed last-to-first
     bool                   readyForRetrieval(const AbstractPath& filePath);
     std::optional<wxImage> retrieveFileIcon (const AbstractPath& filePath); //... and mark as hot
     wxImage getIconByExtension(const Zstring& filePath); //...and add to buffer
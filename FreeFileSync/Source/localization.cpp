@@ -13,6 +13,7 @@
 #include <zen/string_tools.h>
 #include <zen/file_traverser.h>
 #include <zen/file_io.h>
+#include <zen/file_path.h>
 #include <zen/i18n.h>
 #include <zen/format_unit.h>
 #include <zen/perf.h>
@@ -37,18 +38,18 @@ class FFSTranslation : public TranslationHandler
 public:
     explicit FFSTranslation(const std::string& lngStream); //throw lng::ParsingError, plural::ParsingError
 
-    std::wstring translate(const std::wstring& text) const override
+    std::wstring translate(const TranslationKey& text) const override
     {
-        //look for translation in buffer table
+        //look for translation in buffer table: hash was calculated at compile time for _()
         auto it = transMapping_.find(text);
         if (it != transMapping_.end() && !it->second.empty())
             return it->second;
-        return text; //fallback
+        return std::wstring(text.text); //fallback
     }
 
-    std::wstring translate(const std::wstring& singular, const std::wstring& plural, int64_t n) const override
+    std::wstring translate(const TranslationKey& singular, const TranslationKey& plural, int64_t n) const override
     {
-        auto it = transMappingPl_.find({singular, plural});
+        auto it = transMappingPl_.find(PluralKey{singular, plural});
         if (it != transMappingPl_.end())
         {
             const size_t formNo = pluralParser_->getForm(n);
@@ -56,12 +57,44 @@ public:
             if (formNo < it->second.size())
                 return replaceCpy(it->second[formNo], L"%x", formatNumber(n));
         }
-        return replaceCpy(std::abs(n) == 1 ? singular : plural, L"%x", formatNumber(n)); //fallback
+        return replaceCpy(std::wstring(std::abs(n) == 1 ? singular.text : plural.text), L"%x", formatNumber(n)); //fallback
     }
 
 private:
-    using Translation       = std::unordered_map<std::wstring, std::wstring>; //hash_map is 15% faster than std::map on GCC
-    using TranslationPlural = std::map<std::pair<std::wstring, std::wstring>, std::vector<std::wstring>>;
+    struct PluralKey
+    {
+        const TranslationKey& singular;
+        const TranslationKey& plural;
+    };
+
+    //heterogenous lookup: TranslationKey carries its precomputed hash => no hashing of the English text per lookup
+    struct TransHash
+    {
+        using is_transparent = int;
+        size_t operator()(const std::wstring& str)      const { return TranslationKey::calcHash(str); }
+        size_t operator()(const TranslationKey& key)    const { return key.hash; }
+
+        size_t operator()(const std::pair<std::wstring, std::wstring>& sp) const { return combine(TranslationKey::calcHash(sp.first), TranslationKey::calcHash(sp.second)); }
+        size_t operator()(const PluralKey& key)                            const { return combine(key.singular.hash, key.plural.hash); }
+
+        static size_t combine(size_t hashSingular, size_t hashPlural) { return hashSingular ^ (hashPlural + 0x9e3779b97f4a7c15ULL + (hashSingular << 6) + (hashSingular >> 2)); }
+    };
+
+    struct TransEqual
+    {
+        using is_transparent = int;
+        bool operator()(const std::wstring& lhs, const std::wstring& rhs)      const { return lhs == rhs; }
+        bool operator()(const TranslationKey& lhs, const std::wstring& rhs)    const { return lhs.text == rhs; }
+        bool operator()(const std::wstring& lhs, const TranslationKey& rhs)    const { return lhs == rhs.text; }
+
+        using StrPair = std::pair<std::wstring, std::wstring>;
+        bool operator()(const StrPair& lhs, const StrPair& rhs)   const { return lhs == rhs; }
+        bool operator()(const PluralKey& lhs, const StrPair& rhs) const { return lhs.singular.text == rhs.first && lhs.plural.text == rhs.second; }
+        bool operator()(const StrPair& lhs, const PluralKey& rhs) const { return operator()(rhs, lhs); }
+    };
+
+    using Translation       = std::unordered_map<std::wstring, std::wstring, TransHash, TransEqual>; //hash_map is 15% faster than std::map on GCC
+    using TranslationPlural = std::unordered_map<std::pair<std::wstring, std::wstring>, std::vector<std::wstring>, TransHash, TransEqual>;
 
     Translation       transMapping_; //map original text |-> translation
     TranslationPlural transMappingPl_;
@@ -97,35 +130,72 @@ FFSTranslation::FFSTranslation(const std::string& lngStream) //throw lng::Parsin
 }
 
 
+//only the active language is decompressed and parsed in full: keep the source around for setLanguage()
+std::string globalLngZipStream; //compressed Languages.zip
+Zstring globalLngFolder;        //fallback if Languages.zip is missing
+
+const size_t LNG_HEADER_BYTES_MAX = 4096; //.lng header comes first: enough to build the language list
+
+
+std::string loadLngStream(const Zstring& lngFileName) //throw FileError
+{
+    if (!globalLngFolder.empty())
+        return getFileContent(appendPath(globalLngFolder, lngFileName), nullptr /*notifyUnbufferedIO*/); //throw FileError
+
+    wxMemoryInputStream memStream(globalLngZipStream.c_str(), globalLngZipStream.size()); //does not take ownership
+    wxZipInputStream zipStream(memStream, wxConvUTF8);
+
+    while (const auto& entry = std::unique_ptr<wxZipEntry>(zipStream.GetNextEntry())) //take ownership!
+        if (utfTo<Zstring>(entry->GetName()) == lngFileName)
+        {
+            if (std::string stream(entry->GetSize(), '\0');
+                zipStream.ReadAll(stream.data(), stream.size()))
+                return stream;
+            break;
+        }
+
+    throw FileError(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(lngFileName)));
+}
+
+
 std::vector<TranslationInfo> loadTranslations(const Zstring& zipPath) //throw FileError
 {
-    std::vector<std::pair<Zstring /*file name*/, std::string /*byte stream*/>> streams;
+    std::vector<std::tuple<Zstring /*file name*/, std::string /*header byte stream*/, bool /*truncated*/>> streams;
 
     try //to load from ZIP first:
     {
-        const std::string rawStream = getFileContent(zipPath, nullptr /*notifyUnbufferedIO*/); //throw FileError
-        wxMemoryInputStream memStream(rawStream.c_str(), rawStream.size()); //does not take ownership
+        globalLngZipStream = getFileContent(zipPath, nullptr /*notifyUnbufferedIO*/); //throw FileError
+        wxMemoryInputStream memStream(globalLngZipStream.c_str(), globalLngZipStream.size()); //does not take ownership
         wxZipInputStream zipStream(memStream, wxConvUTF8);
 
+        //decompress the header only: parsing all .lng files at startup costs seconds on slow machines
         while (const auto& entry = std::unique_ptr<wxZipEntry>(zipStream.GetNextEntry())) //take ownership!
-            if (std::string stream(entry->GetSize(), '\0');
+        {
+            const bool truncated = static_cast<size_t>(entry->GetSize()) > LNG_HEADER_BYTES_MAX;
+
+            if (std::string stream(std::min<size_t>(entry->GetSize(), LNG_HEADER_BYTES_MAX), '\0');
                 zipStream.ReadAll(stream.data(), stream.size()))
-                streams.emplace_back(utfTo<Zstring>(entry->GetName()), std::move(stream));
+                streams.emplace_back(utfTo<Zstring>(entry->GetName()), std::move(stream), truncated);
             else
                 assert(false);
+        }
     }
     catch (FileError&) //fall back to folder
     {
+        globalLngZipStream.clear();
         const Zstring fallbackFolder = beforeLast(zipPath, Zstr(".zip"), IfNotFoundReturn::none);
         if (dirAvailable(fallbackFolder)) //Debug build (only!?)
-            traverseFolder(fallbackFolder, [&](const FileInfo& fi)
         {
-            if (endsWith(fi.fullPath, Zstr(".lng")))
+            globalLngFolder = fallbackFolder;
+            traverseFolder(fallbackFolder, [&](const FileInfo& fi)
             {
-                std::string stream = getFileContent(fi.fullPath, nullptr /*notifyUnbufferedIO*/); //throw FileError
-                streams.emplace_back(fi.itemName, std::move(stream));
-            }
-        }, nullptr, nullptr, [](const std::wstring& errorMsg) { throw FileError(errorMsg); });
+                if (endsWith(fi.fullPath, Zstr(".lng")))
+                {
+                    std::string stream = getFileContent(fi.fullPath, nullptr /*notifyUnbufferedIO*/); //throw FileError
+                    streams.emplace_back(fi.itemName, std::move(stream), false /*truncated*/);
+                }
+            }, nullptr, nullptr, [](const std::wstring& errorMsg) { throw FileError(errorMsg); });
+        }
         else
             throw;
     }
@@ -140,14 +210,26 @@ std::vector<TranslationInfo> loadTranslations(const Zstring& zipPath) //throw Fi
         newEntry.translatorName = L"Zenju";
         newEntry.languageFlag   = "flag_usa";
         newEntry.lngFileName    = Zstr("");
-        newEntry.lngStream      = "";
         translations.push_back(newEntry);
     }
 
-    for (/*const*/ auto& [fileName, stream] : streams)
+    for (const auto& [fileName, stream, truncated] : streams)
         try
         {
-            const lng::TransHeader lngHeader = lng::parseHeader(stream); //throw ParsingError
+            const lng::TransHeader lngHeader = [&, &fileName = fileName, &stream = stream, truncated = truncated]
+            {
+                try
+                {
+                    return lng::parseHeader(stream); //throw ParsingError
+                }
+                catch (lng::ParsingError&)
+                {
+                    if (!truncated)
+                        throw;
+                    assert(false); //LNG_HEADER_BYTES_MAX too small?
+                    return lng::parseHeader(loadLngStream(fileName)); //throw ParsingError, FileError
+                }
+            }();
             assert(!lngHeader.languageName  .empty());
             assert(!lngHeader.translatorName.empty());
             assert(!lngHeader.localeName    .empty());
@@ -163,7 +245,6 @@ std::vector<TranslationInfo> loadTranslations(const Zstring& zipPath) //throw Fi
                 newEntry.translatorName = utfTo<std::wstring>(lngHeader.translatorName);
                 newEntry.languageFlag   = lngHeader.flagFile;
                 newEntry.lngFileName    = fileName;
-                newEntry.lngStream      = std::move(stream);
                 translations.push_back(std::move(newEntry));
             }
         }
@@ -400,6 +481,8 @@ void fff::localizationCleanup()
     ZenLocale::getInstance().tearDown();
     setTranslator(nullptr); //good place for clean up rather than some time during static destruction: is this an actual benefit???
     globalTranslations.clear();
+    globalLngZipStream.clear();
+    globalLngFolder.clear();
 }
 
 
@@ -415,8 +498,9 @@ void fff::setLanguage(wxLanguage lng) //throw FileError
     for (const TranslationInfo& e : getAvailableTranslations())
         if (e.languageID == lng)
         {
-            lngStream   = e.lngStream;
             lngFileName = e.lngFileName;
+            if (!lngFileName.empty())
+                lngStream = loadLngStream(lngFileName); //throw FileError
             break;
         }
 
@@ -21,8 +21,7 @@ struct TranslationInfo
     std::wstring languageName;
     std::wstring translatorName;
     std::string languageFlag;
-    Zstring lngFileName;
-    std::string lngStream;
+    Zstring lngFileName; //empty for English (US); .lng content is loaded on demand by setLanguage()
 };
 const std::vector<TranslationInfo>& getAvailableTranslations();
 
@@ -6,8 +6,12 @@
 
 #include "log_file.h"
 #include <zen/file_io.h>
+#include <zen/file_access.h>
 #include <zen/http.h>
 #include <zen/sys_info.h>
+#include <zen/json.h>
+#include <zen/thread.h>
+#include <zen/serialize.h>
 #include <wx/datetime.h>
 //#include "ffs_paths.h"
 #include "afs/concrete.h"
@@ -19,11 +23,28 @@ using AFS = AbstractFileSystem;
 
 namespace
 {
-const int LOG_PREVIEW_FAIL_MAX = 25;
+const size_t LOG_PREVIEW_FAIL_MAX = 25;
 const int SEPARATION_LINE_LEN = 40;
 
+const size_t LOG_JOURNAL_RECENT_MAX = 100'000; //entries kept in memory
+const std::chrono::seconds LOG_JOURNAL_FLUSH_INTERVAL(1);
 
-std::string generateLogHeaderTxt(const ProcessSummary& s, const ErrorLog& log, int logPreviewFailsMax)
+
+ErrorLog getFailPreview(const ErrorLog& log)
+{
+    ErrorLog failPreview;
+    for (const LogEntry& entry : log)
+        if (entry.type & (MSG_TYPE_WARNING | MSG_TYPE_ERROR))
+        {
+            if (failPreview.size() >= LOG_PREVIEW_FAIL_MAX)
+                break;
+            failPreview.push_back(entry);
+        }
+    return failPreview;
+}
+
+
+std::string generateLogHeaderTxt(const ProcessSummary& s, const ErrorLogStats& logCount, const ErrorLog& failPreview)
 {
     const std::string tabSpace(4, ' '); //4: the only sensible space count for tabs
 
@@ -43,8 +64,6 @@ std::string generateLogHeaderTxt(const ProcessSummary& s, const ErrorLog& log, i
     summary.push_back(tabSpace + utfTo<std::string>(getSyncResultLabel(s.syncResult)));
     summary.emplace_back();
 
-    const ErrorLogStats logCount = getStats(log);
-
     if (logCount.error   > 0) summary.push_back(tabSpace + utfTo<std::string>(_("Errors:")   + L' ' + formatNumber(logCount.error)));
     if (logCount.warning > 0) summary.push_back(tabSpace + utfTo<std::string>(_("Warnings:") + L' ' + formatNumber(logCount.warning)));
 
@@ -80,15 +99,10 @@ std::string generateLogHeaderTxt(const ProcessSummary& s, const ErrorLog& log, i
         output += '\n' + utfTo<std::string>(_("Errors and warnings:")) + '\n';
         output += std::string(SEPARATION_LINE_LEN, '_') + '\n';
 
-        int previewCount = 0;
-        if (logPreviewFailsMax > 0)
-            for (const LogEntry& entry : log)
-                if (entry.type & (MSG_TYPE_WARNING | MSG_TYPE_ERROR))
-                {
-                    output += utfTo<std::string>(formatMessage(entry));
-                    if (++previewCount >= logPreviewFailsMax)
-                        break;
-                }
+        for (const LogEntry& entry : failPreview)
+            output += utfTo<std::string>(formatMessage(entry));
+
+        const int previewCount = static_cast<int>(failPreview.size());
         if (logFailTotal > previewCount)
             output += "  [...]  " + utfTo<std::string>(replaceCpy(_P("Showing %y of 1 item", "Showing %y of %x items", logFailTotal), //%x used as plural form placeholder!
                                                                   L"%y", formatNumber(previewCount))) + '\n';
@@ -197,7 +211,7 @@ std::wstring generateLogTitle(const ProcessSummary& s)
 }
 
 
-std::string generateLogHeaderHtml(const ProcessSummary& s, const ErrorLog& log, int logPreviewFailsMax)
+std::string generateLogHeaderHtml(const ProcessSummary& s, const ErrorLogStats& logCount, const ErrorLog& failPreview)
 {
     std::string output = R"(<!DOCTYPE html>
 <html lang="en">
@@ -244,8 +258,6 @@ std::string generateLogHeaderHtml(const ProcessSummary& s, const ErrorLog& log,
         </div>
         <table role="presentation" class="summary-table" style="border-spacing:0; margin-left:10px; padding:5px 10px;">)";
 
-    const ErrorLogStats logCount = getStats(log);
-
     if (logCount.error > 0) 
         output += R"(
             <tr>
@@ -302,17 +314,12 @@ std::string generateLogHeaderHtml(const ProcessSummary& s, const ErrorLog& log,
     <div style="border-bottom: 1px solid #AAA; margin: 5px 0;"></div>
     <table class="log-items" style="line-height:1em; border-spacing:0;">
 )";
-        int previewCount = 0;
-        if (logPreviewFailsMax > 0)
-            for (const LogEntry& entry : log)
-                if (entry.type & (MSG_TYPE_WARNING | MSG_TYPE_ERROR))
-                {
-                    output += formatMessageHtml(entry);
-                    if (++previewCount >= logPreviewFailsMax)
-                        break;
-                }
+        for (const LogEntry& entry : failPreview)
+            output += formatMessageHtml(entry);
+
         output += R"(	</table>
 )";
+        const int previewCount = static_cast<int>(failPreview.size());
         if (logFailTotal > previewCount)
             output += R"(	<div><span style="font-weight:600; padding:0 10px;">[&hellip;]</span>)" + 
                       htmlTxt(replaceCpy(_P("Showing %y of 1 item", "Showing %y of %x items", logFailTotal), //%x used as plural form placeholder!
@@ -377,9 +384,12 @@ void streamToLogFile(const ProcessSummary& summary, //throw FileError
     const int logItemsTotal = log.end() - log.begin();
     const int logPreviewItemsMax = std::numeric_limits<int>::max();
 
+    const ErrorLogStats logCount = getStats(log);
+    const ErrorLog failPreview = getFailPreview(log);
+
     std::string buffer = logFormat == LogFileFormat::html ? 
-                         generateLogHeaderHtml(summary, log, LOG_PREVIEW_FAIL_MAX) :
-                         generateLogHeaderTxt (summary, log, LOG_PREVIEW_FAIL_MAX);
+                         generateLogHeaderHtml(summary, logCount, failPreview) :
+                         generateLogHeaderTxt (summary, logCount, failPreview);
 
     //write log items in blocks instead of creating one big string: memory allocation might fail; think 1 million entries!
     for (const LogEntry& entry : log)
@@ -403,9 +413,7 @@ void streamToLogFile(const ProcessSummary& summary, //throw FileError
 
 
 void saveNewLogFile(const AbstractPath& logFilePath, //throw FileError, X
-                    LogFileFormat logFormat,
-                    const ProcessSummary& summary,
-                    const ErrorLog& log,
+                    const std::function<void(AFS::OutputStream& streamOut)>& streamLog /*throw FileError, X*/,
                     const std::function<void(std::wstring&& msg)>& notifyStatus /*throw X*/)
 {
     //create logfile folder if required
@@ -431,8 +439,8 @@ void saveNewLogFile(const AbstractPath& logFilePath, //throw FileError, X
 
     //already existing: undefined behavior! (e.g. fail/overwrite/auto-rename)
     std::unique_ptr<AFS::OutputStream> logFileStream = AFS::getOutputStream(logFilePath, std::nullopt /*streamSize*/, std::nullopt /*modTime*/, notifyUnbufferedIO); //throw FileError
-    streamToLogFile(summary, log, *logFileStream, logFormat); //throw FileError, X
-    logFileStream->finalize();                                //throw FileError, X
+    streamLog(*logFileStream); //throw FileError, X
+    logFileStream->finalize(); //throw FileError, X
 }
 
 
@@ -459,7 +467,8 @@ std::vector<LogFileInfo> getLogFiles(const AbstractPath& logFolderPath) //throw
         static_assert(TIME_STAMP_LENGTH == 21);
 
         if (endsWith(fi.itemName, Zstr(".log")) || //case-sensitive: e.g. ".LOG" is not from FFS, right?
-            endsWith(fi.itemName, Zstr(".html")))
+            endsWith(fi.itemName, Zstr(".html")) ||
+            endsWith(fi.itemName, Zstr(".json"))) //saveMetricsFile()
         {
             auto tsBegin = fi.itemName.begin();
             auto tsEnd   = tsBegin + fi.itemName.rfind('.');
@@ -499,19 +508,62 @@ std::vector<LogFileInfo> getLogFiles(const AbstractPath& logFolderPath) //throw
 }
 
 
+/*  avoid listing the (possibly huge, remote) log folder after each job: small index file with
+    - time stamp of the oldest log file after the last clean-up => nothing to delete until it passes the cut-off time
+    - time of the last full scan => concurrent jobs may race on the index: lost updates only delay clean-up until the next full scan   */
+const Zchar LOG_INDEX_FILE_NAME[] = Zstr("log_index.ffs_db");
+const std::chrono::hours LOG_INDEX_FULL_SCAN_INTERVAL(24);
+const size_t LOG_CLEANUP_PARALLEL_OPS = 8; //network folders: hide latency
+
+
+struct LogIndex
+{
+    time_t oldestLogTime = 0;
+    time_t lastFullScanTime = 0;
+};
+
+
+std::optional<LogIndex> loadLogIndex(const AbstractPath& logFolderPath) //noexcept
+{
+    try
+    {
+        const std::unique_ptr<AFS::InputStream> fileStreamIn = AFS::getInputStream(AFS::appendRelPath(logFolderPath, LOG_INDEX_FILE_NAME), nullptr /*notifyUnbufferedIO*/); //throw FileError, ErrorFileLocked
+        const std::string stream = bufferedLoad<std::string>(*fileStreamIn); //throw FileError, ErrorFileLocked
+
+        const std::vector<std::string> items = split(trimCpy(stream), ' ', SplitOnEmpty::skip);
+        if (items.size() == 2)
+            return LogIndex{stringTo<time_t>(items[0]), stringTo<time_t>(items[1])};
+    }
+    catch (FileError&) {} //not existing (yet), corrupted => full scan
+    return std::nullopt;
+}
+
+
+void saveLogIndex(const AbstractPath& logFolderPath, const LogIndex& logIndex) //noexcept
+{
+    try
+    {
+        const AbstractPath indexFilePath = AFS::appendRelPath(logFolderPath, LOG_INDEX_FILE_NAME);
+        const std::string stream = numberTo<std::string>(logIndex.oldestLogTime) + ' ' + numberTo<std::string>(logIndex.lastFullScanTime) + '\n';
+
+        AFS::removeFileIfExists(indexFilePath); //throw FileError
+        //already existing: undefined behavior! (e.g. fail/overwrite/auto-rename)
+        const std::unique_ptr<AFS::OutputStream> fileStreamOut = AFS::getOutputStream(indexFilePath, stream.size(), std::nullopt /*modTime*/, nullptr /*notifyUnbufferedIO*/); //throw FileError
+        fileStreamOut->write(stream.data(), stream.size()); //throw FileError
+        fileStreamOut->finalize();                          //throw FileError
+    }
+    catch (FileError&) {} //not critical: full scan next time
+}
+
+
 void limitLogfileCount(const AbstractPath& logFolderPath, //throw FileError, X
+                       time_t logFileTime, //time stamp of the log file just saved
                        int logfilesMaxAgeDays, //<= 0 := no limit
                        const std::set<AbstractPath>& logFilePathsToKeep,
                        const std::function<void(std::wstring&& msg)>& notifyStatus /*throw X*/)
 {
     if (logfilesMaxAgeDays > 0)
     {
-        const std::wstring statusPrefix = _("Cleaning up log files:") + L" [" + _P("1 day", "%x days", logfilesMaxAgeDays) + L"] ";
-
-        if (notifyStatus) notifyStatus(statusPrefix + fmtPath(AFS::getDisplayPath(logFolderPath))); //throw X
-
-        std::vector<LogFileInfo> logFiles = getLogFiles(logFolderPath); //throw FileError
-
         const time_t lastMidnightTime = []
         {
             TimeComp tc = getLocalTime(); //returns TimeComp() on error
@@ -521,21 +573,64 @@ void limitLogfileCount(const AbstractPath& logFolderPath, //throw FileError, X
             return localToTimeT(tc).first; //0 on error => swallow => no versions trimmed by versionMaxAgeDays
         }();
         const time_t cutOffTime = lastMidnightTime - static_cast<time_t>(logfilesMaxAgeDays) * 24 * 3600;
+        const time_t now = std::time(nullptr);
 
-        std::exception_ptr firstError;
+        if (const std::optional<LogIndex> logIndex = loadLogIndex(logFolderPath);
+            logIndex &&
+            logIndex->lastFullScanTime <= now && now - logIndex->lastFullScanTime < std::chrono::seconds(LOG_INDEX_FULL_SCAN_INTERVAL).count())
+        {
+            const time_t oldestLogTime = std::min(logIndex->oldestLogTime, logFileTime); //log time stamp is the *start* of a job => may be older than the last scan
+            if (oldestLogTime >= cutOffTime)
+            {
+                if (oldestLogTime != logIndex->oldestLogTime)
+                    saveLogIndex(logFolderPath, {oldestLogTime, logIndex->lastFullScanTime});
+                return; //nothing to delete yet
+            }
+        }
 
+        const std::wstring statusPrefix = _("Cleaning up log files:") + L" [" + _P("1 day", "%x days", logfilesMaxAgeDays) + L"] ";
+
+        if (notifyStatus) notifyStatus(statusPrefix + fmtPath(AFS::getDisplayPath(logFolderPath))); //throw X
+
+        const std::vector<LogFileInfo> logFiles = getLogFiles(logFolderPath); //throw FileError
+
+        std::vector<AbstractPath> logFilesToDelete;
+        time_t oldestLogTime = logFileTime;
         for (const LogFileInfo& lfi : logFiles)
-            if (lfi.timeStamp < cutOffTime &&
-                !logFilePathsToKeep.contains(lfi.filePath)) //don't trim latest log files corresponding to last used config files!
+            if (logFilePathsToKeep.contains(lfi.filePath)) //don't trim latest log files corresponding to last used config files!
                 //nitpicker's corner: what about path differences due to case? e.g. user-overriden log file path changed in case
+                ; //=> not considered for oldestLogTime: other jobs may not keep it => deleted not later than next full scan
+            else if (lfi.timeStamp < cutOffTime)
+                logFilesToDelete.push_back(lfi.filePath);
+            else
+                oldestLogTime = std::min(oldestLogTime, lfi.timeStamp);
+
+        std::exception_ptr firstError;
+
+        if (!logFilesToDelete.empty())
+        {
+            if (notifyStatus) notifyStatus(statusPrefix + _P("1 item", "%x items", logFilesToDelete.size())); //throw X
+
+            std::mutex errorLock;
+            ThreadGroup<std::function<void()>> tg(LOG_CLEANUP_PARALLEL_OPS, Zstr("Log Cleanup"));
+
+            for (const AbstractPath& filePath : logFilesToDelete)
+                tg.run([&, filePath]
             {
-                if (notifyStatus) notifyStatus(statusPrefix + fmtPath(AFS::getDisplayPath(lfi.filePath))); //throw X
                 try
                 {
-                    AFS::removeFilePlain(lfi.filePath); //throw FileError
+                    AFS::removeFilePlain(filePath); //throw FileError
                 }
-                catch (const FileError&) { if (!firstError) firstError = std::current_exception(); };
-            }
+                catch (const FileError&)
+                {
+                    std::lock_guard dummy(errorLock);
+                    if (!firstError) firstError = std::current_exception();
+                }
+            });
+            tg.wait();
+        }
+
+        saveLogIndex(logFolderPath, {firstError ? std::min(oldestLogTime, cutOffTime - 1) : oldestLogTime, now}); //retry failed deletions next time
 
         if (firstError) //late failure!
             std::rethrow_exception(firstError);
@@ -605,6 +700,185 @@ Zstring fff::generateLogFileName(LogFileFormat logFormat, const ProcessSummary&
 }
 
 
+LogJournal::LogJournal(const Zstring& logFolderPath, LogFileFormat logFormat, //noexcept
+                       const std::vector<std::wstring>& jobNames, const std::chrono::system_clock::time_point& startTime) :
+    logFormat_(logFormat)
+{
+    try
+    {
+        //"Backup FreeFileSync 2013-09-15 015052.123 [Incomplete].log" => found and cleaned up by limitLogfileCount() like any other log file
+        const Zstring logFileName = generateLogFileName(logFormat, ProcessSummary{startTime, SyncResult::finishedSuccess, jobNames}); //throw FileError
+        const Zstring journalFileName = beforeLast(logFileName, Zstr('.'), IfNotFoundReturn::all) +
+                                        STATUS_BEGIN_TOKEN + utfTo<Zstring>(_("Incomplete")) + STATUS_END_TOKEN + Zstr('.') +
+                                        afterLast(logFileName, Zstr('.'), IfNotFoundReturn::none);
+
+        createDirectoryIfMissingRecursion(logFolderPath); //throw FileError
+        journalFile_ = std::make_unique<FileOutput>(appendPath(logFolderPath, journalFileName), nullptr /*notifyUnbufferedIO*/); //throw FileError, ErrorTargetExisting
+
+        if (logFormat == LogFileFormat::html)
+        {
+            const std::string preamble = R"(<!DOCTYPE html>
+<html lang="en">
+<head>
+    <meta charset="utf-8">
+</head>
+<body style="font-family: -apple-system, 'Segoe UI', Arial, Tahoma, Helvetica, sans-serif;">
+    <table class="log-items" style="line-height:1em; border-spacing:0;">
+)";
+            journalFile_->write(preamble.data(), preamble.size()); //throw FileError
+            journalBodyOffset_ = preamble.size();
+        }
+        journalFile_->flushBuffers(); //throw FileError
+        journalWritable_ = true;
+        lastFlushTime_ = std::chrono::steady_clock::now();
+    }
+    catch (const FileError& e) //not critical: keep log in memory as usual
+    {
+        journalFile_.reset(); //remove incomplete journal file
+        append({std::time(nullptr), MSG_TYPE_INFO, utfTo<Zstringc>(e.toString())});
+    }
+}
+
+
+LogJournal::~LogJournal()
+{
+    if (journalFile_) //final log file was not saved => keep journal file
+        try
+        {
+            journalFile_->finalize(); //throw FileError
+        }
+        catch (FileError&) {} //journal file is removed by ~FileOutput()
+}
+
+
+void LogJournal::append(const LogEntry& entry) //noexcept
+{
+    switch (entry.type)
+    {
+        //*INDENT-OFF*
+        case MSG_TYPE_INFO:    ++stats_.info;    break;
+        case MSG_TYPE_WARNING: ++stats_.warning; break;
+        case MSG_TYPE_ERROR:   ++stats_.error;   break;
+        //*INDENT-ON*
+    }
+    if ((entry.type & (MSG_TYPE_WARNING | MSG_TYPE_ERROR)) && failPreview_.size() < LOG_PREVIEW_FAIL_MAX)
+        failPreview_.push_back(entry);
+
+    recentEntries_.push_back(entry);
+    ++unjournaledCount_;
+
+    if (journalWritable_)
+        try
+        {
+            assert(unjournaledCount_ == 1);
+            const std::string msg = logFormat_ == LogFileFormat::html ?
+                                    formatMessageHtml(entry) :
+                                    formatMessage    (entry);
+            journalFile_->write(msg.data(), msg.size()); //throw FileError
+            unjournaledCount_ = 0;
+
+            //don't lose more than a second worth of log entries if process is killed
+            if (const auto now = std::chrono::steady_clock::now();
+                now >= lastFlushTime_ + LOG_JOURNAL_FLUSH_INTERVAL)
+            {
+                journalFile_->flushBuffers(); //throw FileError
+                lastFlushTime_ = now;
+            }
+        }
+        catch (const FileError& e) //e.g. disk full => keep all remaining entries in memory
+        {
+            journalWritable_ = false;
+            recentEntries_.push_back({entry.time, MSG_TYPE_INFO, utfTo<Zstringc>(e.toString())});
+            ++unjournaledCount_;
+            ++stats_.info;
+        }
+
+    //bounded memory: entries already in the journal file can go
+    while (recentEntries_.size() > LOG_JOURNAL_RECENT_MAX &&
+           recentEntries_.size() > unjournaledCount_)
+    {
+        recentEntries_.pop_front();
+        ++droppedCount_;
+    }
+}
+
+
+ErrorLog LogJournal::getRecentEntries() const
+{
+    ErrorLog log;
+    if (droppedCount_ > 0)
+    {
+        const int logItemsTotal = stats_.info + stats_.warning + stats_.error;
+        log.push_back({recentEntries_.front().time, MSG_TYPE_INFO,
+                       utfTo<Zstringc>(L"[...]  " + replaceCpy(_P("Showing %y of 1 item", "Showing %y of %x items", logItemsTotal), //%x used as plural form placeholder!
+                                                               L"%y", formatNumber(recentEntries_.size())))});
+    }
+    log.insert(log.end(), recentEntries_.begin(), recentEntries_.end());
+    return log;
+}
+
+
+void LogJournal::streamToLogFile(const ProcessSummary& summary, AFS::OutputStream& streamOut) //throw FileError, X
+{
+    const int logItemsTotal = stats_.info + stats_.warning + stats_.error;
+    const int logPreviewItemsMax = std::numeric_limits<int>::max();
+
+    std::string buffer = logFormat_ == LogFileFormat::html ?
+                         generateLogHeaderHtml(summary, stats_, failPreview_) :
+                         generateLogHeaderTxt (summary, stats_, failPreview_);
+    streamOut.write(buffer.data(), buffer.size()); //throw FileError, X
+    buffer.clear();
+
+    if (journalFile_)
+    {
+        if (journalWritable_)
+            journalFile_->flushBuffers(); //throw FileError
+
+        //copy journal in blocks: think multi-GB log
+        FileInput journalIn(journalFile_->getFilePath(), nullptr /*notifyUnbufferedIO*/); //throw FileError, ErrorFileLocked
+        std::vector<std::byte> memBuf(FileInput::getBlockSize());
+        size_t bytesToSkip = journalBodyOffset_;
+        for (;;)
+        {
+            const size_t bytesRead = journalIn.read(memBuf.data(), memBuf.size()); //throw FileError, ErrorFileLocked; short read: end of stream
+            const size_t skipNow = std::min(bytesToSkip, bytesRead);
+            bytesToSkip -= skipNow;
+
+            if (bytesRead > skipNow)
+                streamOut.write(memBuf.data() + skipNow, bytesRead - skipNow); //throw FileError, X
+
+            if (bytesRead < memBuf.size())
+                break;
+        }
+    }
+
+    //entries not in journal file (always in memory)
+    for (auto it = recentEntries_.end() - unjournaledCount_; it != recentEntries_.end(); ++it)
+    {
+        buffer += logFormat_ == LogFileFormat::html ?
+                  formatMessageHtml(*it) :
+                  formatMessage    (*it);
+
+        streamOut.write(buffer.data(), buffer.size()); //throw FileError, X
+        buffer.clear();
+    }
+
+    buffer += logFormat_ == LogFileFormat::html ?
+              generateLogFooterHtml(std::wstring() /*logFilePath*/, logItemsTotal, logPreviewItemsMax) : //throw FileError
+              generateLogFooterTxt (std::wstring() /*logFilePath*/, logItemsTotal, logPreviewItemsMax);  //throw FileError
+
+    streamOut.write(buffer.data(), buffer.size()); //throw FileError, X
+}
+
+
+void LogJournal::discard()
+{
+    journalFile_.reset(); //not finalized => ~FileOutput() deletes journal file
+    journalWritable_ = false;
+    //entries logged from now on are kept in memory: e.g. save log file again to fallback location
+}
+
+
 void fff::saveLogFile(const AbstractPath& logFilePath, //throw FileError, X
                       const ProcessSummary& summary,
                       const ErrorLog& log,
@@ -616,7 +890,7 @@ void fff::saveLogFile(const AbstractPath& logFilePath, //throw FileError, X
     std::exception_ptr firstError;
     try
     {
-        saveNewLogFile(logFilePath, logFormat, summary, log, notifyStatus); //throw FileError, X
+        saveNewLogFile(logFilePath, [&](AFS::OutputStream& streamOut) { streamToLogFile(summary, log, streamOut, logFormat); }, notifyStatus); //throw FileError, X
     }
     catch (const FileError&) { if (!firstError) firstError = std::current_exception(); };
 
@@ -625,7 +899,7 @@ void fff::saveLogFile(const AbstractPath& logFilePath, //throw FileError, X
         const std::optional<AbstractPath> logFolderPath = AFS::getParentPath(logFilePath);
         assert(logFolderPath);
         if (logFolderPath) //else: logFilePath == device root; not possible with generateLogFilePath()
-            limitLogfileCount(*logFolderPath, logfilesMaxAgeDays, logFilePathsToKeep, notifyStatus); //throw FileError, X
+            limitLogfileCount(*logFolderPath, std::chrono::system_clock::to_time_t(summary.startTime), logfilesMaxAgeDays, logFilePathsToKeep, notifyStatus); //throw FileError, X
     }
     catch (const FileError&) { if (!firstError) firstError = std::current_exception(); };
 
@@ -634,6 +908,151 @@ void fff::saveLogFile(const AbstractPath& logFilePath, //throw FileError, X
 }
 
 
+void fff::saveLogFile(const AbstractPath& logFilePath, //throw FileError, X
+                      const ProcessSummary& summary,
+                      LogJournal& journal,
+                      int logfilesMaxAgeDays,
+                      const std::set<AbstractPath>& logFilePathsToKeep,
+                      const std::function<void(std::wstring&& msg)>& notifyStatus /*throw X*/)
+{
+    std::exception_ptr firstError;
+    try
+    {
+        saveNewLogFile(logFilePath, [&](AFS::OutputStream& streamOut) { journal.streamToLogFile(summary, streamOut); }, notifyStatus); //throw FileError, X
+        journal.discard();
+    }
+    catch (const FileError&) { if (!firstError) firstError = std::current_exception(); };
+
+    try
+    {
+        const std::optional<AbstractPath> logFolderPath = AFS::getParentPath(logFilePath);
+        assert(logFolderPath);
+        if (logFolderPath) //else: logFilePath == device root; not possible with generateLogFilePath()
+            limitLogfileCount(*logFolderPath, std::chrono::system_clock::to_time_t(summary.startTime), logfilesMaxAgeDays, logFilePathsToKeep, notifyStatus); //throw FileError, X
+    }
+    catch (const FileError&) { if (!firstError) firstError = std::current_exception(); };
+
+    if (firstError) //late failure!
+        std::rethrow_exception(firstError);
+}
+
+
+
+
+void fff::saveMetricsFile(const AbstractPath& logFilePath, //throw FileError
+                          const ProcessSummary& summary,
+                          const ErrorLogStats& logStats)
+{
+    auto toJson = [](const ProgressStats& stats)
+    {
+        JsonValue jstats(JsonValue::Type::object);
+        jstats.objectVal["items"] = JsonValue(stats.items);
+        jstats.objectVal["bytes"] = JsonValue(stats.bytes);
+        return jstats;
+    };
+
+    JsonValue jroot(JsonValue::Type::object);
+    jroot.objectVal["startTime"] = JsonValue(static_cast<int64_t>(std::chrono::system_clock::to_time_t(summary.startTime)));
+    jroot.objectVal["result"   ] = JsonValue([&]
+    {
+        switch (summary.syncResult)
+        {
+            //*INDENT-OFF*
+            case SyncResult::finishedSuccess: return "success";
+            case SyncResult::finishedWarning: return "warning";
+            case SyncResult::finishedError:   return "error";
+            case SyncResult::aborted:         return "aborted";
+            //*INDENT-ON*
+        }
+        assert(false);
+        return "aborted";
+    }());
+    jroot.objectVal["totalTimeMs"] = JsonValue(static_cast<int64_t>(summary.totalTime.count()));
+    jroot.objectVal["processed"] = toJson(summary.statsProcessed);
+    jroot.objectVal["total"    ] = toJson(summary.statsTotal);
+
+    std::vector<JsonValue> jobNames;
+    for (const std::wstring& jobName : summary.jobNames)
+        jobNames.emplace_back(utfTo<std::string>(jobName));
+    jroot.objectVal["jobNames"] = JsonValue(std::move(jobNames));
+
+    std::vector<JsonValue> phases;
+    for (const PhaseMetrics& pm : summary.phases)
+    {
+        JsonValue jphase(JsonValue::Type::object);
+        jphase.objectVal["phase"] = JsonValue([&]
+        {
+            switch (pm.phase)
+            {
+                //*INDENT-OFF*
+                case ProcessPhase::none:             break;
+                case ProcessPhase::scanning:         return "scanning";
+                case ProcessPhase::comparingContent: return "comparingContent";
+                case ProcessPhase::synchronizing:    return "synchronizing";
+                //*INDENT-ON*
+            }
+            assert(false);
+            return "none";
+        }());
+        jphase.objectVal["durationMs"] = JsonValue(static_cast<int64_t>(pm.duration.count()));
+        jphase.objectVal["processed" ] = toJson(pm.statsProcessed);
+        jphase.objectVal["total"     ] = toJson(pm.statsTotal);
+        if (pm.duration.count() > 0)
+            jphase.objectVal["bytesPerSec"] = JsonValue(static_cast<int64_t>(pm.statsProcessed.bytes * 1000 / pm.duration.count()));
+        phases.push_back(std::move(jphase));
+    }
+    jroot.objectVal["phases"] = JsonValue(std::move(phases));
+
+    auto toJsonFolders = [](const std::vector<FolderScanStats::Folder>& folders)
+    {
+        std::vector<JsonValue> jfolders;
+        for (const FolderScanStats::Folder& f : folders)
+        {
+            JsonValue jfolder(JsonValue::Type::object);
+            jfolder.objectVal["path"      ] = JsonValue(utfTo<std::string>(f.displayPath));
+            jfolder.objectVal["readTimeMs"] = JsonValue(static_cast<int64_t>(f.readTime.count()));
+            jfolder.objectVal["items"     ] = JsonValue(static_cast<int64_t>(f.itemCount));
+            jfolders.push_back(std::move(jfolder));
+        }
+        return JsonValue(std::move(jfolders));
+    };
+    jroot.objectVal["slowestFolders"] = toJsonFolders(summary.scanStats.slowest);
+    jroot.objectVal["largestFolders"] = toJsonFolders(summary.scanStats.largest);
+
+    JsonValue jmemory(JsonValue::Type::object);
+    for (const MemoryUsage& mu : summary.memoryUsage)
+    {
+        JsonValue jusage(JsonValue::Type::object);
+        jusage.objectVal["bytes"    ] = JsonValue(mu.bytes);
+        jusage.objectVal["peakBytes"] = JsonValue(mu.bytesPeak);
+        jmemory.objectVal[getMemoryCategoryName(mu.category)] = std::move(jusage);
+    }
+    jroot.objectVal["memory"] = std::move(jmemory);
+
+    JsonValue jlog(JsonValue::Type::object);
+    jlog.objectVal["info"   ] = JsonValue(logStats.info);
+    jlog.objectVal["warning"] = JsonValue(logStats.warning);
+    jlog.objectVal["error"  ] = JsonValue(logStats.error);
+    jroot.objectVal["messages"] = std::move(jlog);
+
+    const std::string stream = serializeJson(jroot);
+
+    const AbstractPath metricsFilePath = [&]
+    {
+        const Zstring logFileName = AFS::getItemName(logFilePath);
+        const Zstring metricsFileName = beforeLast(logFileName, Zstr('.'), IfNotFoundReturn::all) + Zstr(".json");
+
+        if (const std::optional<AbstractPath> parentPath = AFS::getParentPath(logFilePath))
+            return AFS::appendRelPath(*parentPath, metricsFileName);
+        return logFilePath; //not possible with generateLogFileName()
+    }();
+    assert(metricsFilePath != logFilePath);
+
+    //already existing: undefined behavior! (e.g. fail/overwrite/auto-rename)
+    std::unique_ptr<AFS::OutputStream> fileStream = AFS::getOutputStream(metricsFilePath, stream.size(), std::nullopt /*modTime*/, nullptr /*notifyUnbufferedIO*/); //throw FileError
+    fileStream->write(stream.data(), stream.size()); //throw FileError
+    fileStream->finalize();                          //throw FileError
+}
 
 
 void fff::sendLogAsEmail(const std::string& email, //throw FileError, X
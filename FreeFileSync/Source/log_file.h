@@ -8,7 +8,9 @@
 #define GENERATE_LOGFILE_H_931726432167489732164
 
 #include <chrono>
+#include <deque>
 #include <zen/error_log.h>
+#include <zen/file_io.h>
 #include "return_codes.h"
 #include "status_handler.h"
 #include "afs/abstract.h"
@@ -24,6 +26,46 @@ enum class LogFileFormat
 
 Zstring generateLogFileName(LogFileFormat logFormat, const ProcessSummary& summary);
 
+
+/*  incremental log: entries are appended to a journal file in the log folder as they happen
+    - bounded memory: keep only the most recent entries (e.g. for the results dialog) + the first errors/warnings for the log file header
+    - process killed mid-run: journal file remains: "Backup FreeFileSync 2013-09-15 015052.123 [Incomplete].log"
+    - journal file not available: fall back to keeping the (remaining) entries in memory         */
+class LogJournal
+{
+public:
+    LogJournal(const Zstring& logFolderPath, LogFileFormat logFormat, //noexcept
+               const std::vector<std::wstring>& jobNames, const std::chrono::system_clock::time_point& startTime);
+    ~LogJournal(); //keep journal file if final log file was not saved
+
+    void append(const zen::LogEntry& entry); //noexcept
+
+    LogFileFormat getLogFormat() const { return logFormat_; }
+    const zen::ErrorLogStats& getStats() const { return stats_; }
+    zen::ErrorLog getRecentEntries() const; //older entries dropped? => leading note
+
+    //for saveLogFile():
+    void streamToLogFile(const ProcessSummary& summary, AbstractFileSystem::OutputStream& streamOut); //throw FileError, X
+    void discard(); //final log file was saved => delete journal file
+
+private:
+    LogJournal           (const LogJournal&) = delete;
+    LogJournal& operator=(const LogJournal&) = delete;
+
+    const LogFileFormat logFormat_;
+
+    std::unique_ptr<zen::FileOutput> journalFile_; //nullptr if not available
+    bool journalWritable_ = false;
+    size_t journalBodyOffset_ = 0; //HTML preamble: only needed to view the journal file after a crash
+    std::chrono::steady_clock::time_point lastFlushTime_;
+
+    std::deque<zen::LogEntry> recentEntries_;
+    size_t unjournaledCount_ = 0; //entries at the end of recentEntries_ that are missing in the journal file
+    size_t droppedCount_ = 0;
+    zen::ErrorLog failPreview_; //first errors and warnings
+    zen::ErrorLogStats stats_;
+};
+
 void saveLogFile(const AbstractPath& logFilePath, //throw FileError, X
                  const ProcessSummary& summary,
                  const zen::ErrorLog& log,
@@ -32,6 +74,18 @@ void saveLogFile(const AbstractPath& logFilePath, //throw FileError, X
                  const std::set<AbstractPath>& logFilePathsToKeep,
                  const std::function<void(std::wstring&& msg)>& notifyStatus /*throw X*/);
 
+void saveLogFile(const AbstractPath& logFilePath, //throw FileError, X
+                 const ProcessSummary& summary,
+                 LogJournal& journal,
+                 int logfilesMaxAgeDays,
+                 const std::set<AbstractPath>& logFilePathsToKeep,
+                 const std::function<void(std::wstring&& msg)>& notifyStatus /*throw X*/);
+
+//machine-readable summary (JSON) next to the log file: per-phase wall time, items and bytes
+void saveMetricsFile(const AbstractPath& logFilePath, //throw FileError
+                     const ProcessSummary& summary,
+                     const zen::ErrorLogStats& logStats);
+
 void sendLogAsEmail(const std::string& email, //throw FileError, X
                     const ProcessSummary& summary,
                     const zen::ErrorLog& log,
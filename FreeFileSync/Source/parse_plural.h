@@ -18,7 +18,7 @@ struct Expression { virtual ~Expression() {} };
 template <class T>
 struct Expr : public Expression
 {
-    virtual T eval() const = 0;
+    virtual T eval(int64_t n) const = 0;
 };
 
 
@@ -28,11 +28,16 @@ class PluralForm
 {
 public:
     PluralForm(const std::string& stream); //throw ParsingError
-    size_t getForm(int64_t n) const { n_ = std::abs(n) ; return static_cast<size_t>(expr_->eval()); }
+
+    size_t getForm(int64_t n) const //thread-safe
+    {
+        n = std::abs(n);
+        return n < std::ssize(formTable_) ? formTable_[static_cast<size_t>(n)] : static_cast<size_t>(expr_->eval(n));
+    }
 
 private:
     std::shared_ptr<Expr<int64_t>> expr_;
-    mutable int64_t n_ = 0;
+    std::vector<uint8_t> formTable_; //precomputed forms for n < 1000: _P() is called per item => don't walk the expression tree each time
 };
 
 
@@ -115,7 +120,7 @@ struct BinaryExp : public Expr<ResultType>
     using ExpRhs = std::shared_ptr<Expr<ParamType>>;
 
     BinaryExp(const ExpLhs& lhs, const ExpRhs& rhs) : lhs_(lhs), rhs_(rhs) { assert(lhs && rhs); }
-    ResultType eval() const override { return BinaryOp()(lhs_->eval(), rhs_->eval()); }
+    ResultType eval(int64_t n) const override { return BinaryOp()(lhs_->eval(n), rhs_->eval(n)); }
 private:
     ExpLhs lhs_;
     ExpRhs rhs_;
@@ -142,7 +147,7 @@ struct ConditionalExp : public Expr<T>
                    const std::shared_ptr<Expr<T>>& thenExp,
                    const std::shared_ptr<Expr<T>>& elseExp) : ifExp_(ifExp), thenExp_(thenExp), elseExp_(elseExp) { assert(ifExp && thenExp && elseExp); }
 
-    T eval() const override { return ifExp_->eval() ? thenExp_->eval() : elseExp_->eval(); }
+    T eval(int64_t n) const override { return ifExp_->eval(n) ? thenExp_->eval(n) : elseExp_->eval(n); }
 private:
     std::shared_ptr<Expr<bool>> ifExp_;
     std::shared_ptr<Expr<T>> thenExp_;
@@ -153,7 +158,8 @@ private:
 struct ConstNumberExp : public Expr<int64_t>
 {
     ConstNumberExp(int64_t n) : n_(n) {}
-    int64_t eval() const override { return n_; }
+    int64_t eval(int64_t n) const override { return n_; }
+    int64_t getValue() const { return n_; }
 private:
     int64_t n_;
 };
@@ -161,10 +167,7 @@ private:
 
 struct VariableNumberNExp : public Expr<int64_t>
 {
-    VariableNumberNExp(int64_t& n) : n_(n) {}
-    int64_t eval() const override { return n_; }
-private:
-    int64_t& n_;
+    int64_t eval(int64_t n) const override { return n; }
 };
 
 //-------------------------------------------------------------------------------
@@ -262,10 +265,9 @@ private:
 class Parser
 {
 public:
-    Parser(const std::string& stream, int64_t& n) :
+    explicit Parser(const std::string& stream) :
         scn_(stream),
-        tk_(scn_.getNextToken()), //throw ParsingError
-        n_(n) {}
+        tk_(scn_.getNextToken()) {} //throw ParsingError
 
     std::shared_ptr<Expr<int64_t>> parse() //throw ParsingError; return value always bound!
     {
@@ -375,7 +377,7 @@ private:
 
             //"compile-time" check: n % 0
             if (auto literal = std::dynamic_pointer_cast<ConstNumberExp>(rhs))
-                if (literal->eval() == 0)
+                if (literal->getValue() == 0)
                     throw ParsingError();
 
             e = makeBiExp<std::modulus<>, int64_t>(e, rhs); //throw ParsingError
@@ -388,7 +390,7 @@ private:
         if (token().type == TokenType::variableN)
         {
             nextToken(); //throw ParsingError
-            return std::make_shared<VariableNumberNExp>(n_);
+            return std::make_shared<VariableNumberNExp>();
         }
         else if (token().type == TokenType::constNumber)
         {
@@ -427,7 +429,6 @@ private:
 
     Scanner scn_;
     Token tk_;
-    int64_t& n_;
 };
 }
 
@@ -442,10 +443,8 @@ PluralFormInfo::PluralFormInfo(const std::string& definition, int pluralCount) /
     try
     {
         PluralForm pf(definition); //throw ParsingError
-        //PERF_START
 
-        //perf: 80ns per iteration max (for arabic)
-        //=> 1000 iterations should be fast enough and still detect all "single number forms"
+        //1000 iterations should detect all "single number forms"
         for (int j = 0; j < 1000; ++j)
             if (const size_t formNo = pf.getForm(j);
                 formNo < forms_.size())
@@ -469,7 +468,17 @@ PluralFormInfo::PluralFormInfo(const std::string& definition, int pluralCount) /
 
 
 inline
-PluralForm::PluralForm(const std::string& stream) : expr_(impl::Parser(stream, n_).parse()) {} //throw ParsingError
+PluralForm::PluralForm(const std::string& stream) : expr_(impl::Parser(stream).parse()) //throw ParsingError
+{
+    std::vector<uint8_t> formTable;
+    for (int64_t n = 0; n < 1000; ++n)
+        if (const int64_t formNo = expr_->eval(n);
+            0 <= formNo && formNo <= 0xff)
+            formTable.push_back(static_cast<uint8_t>(formNo));
+        else
+            return; //invalid plural definition (PluralFormInfo will complain) => no table, always evaluate
+    formTable_ = std::move(formTable);
+}
 }
 
 #endif //PARSE_PLURAL_H_180465845670839576
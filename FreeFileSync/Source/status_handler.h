@@ -11,6 +11,7 @@
 #include <functional>
 #include <zen/error_log.h>
 #include "base/process_callback.h"
+#include "base/memory_stats.h"
 #include "return_codes.h"
 
 namespace fff
@@ -60,6 +61,17 @@ struct Statistics
 
     virtual std::optional<AbortTrigger> getAbortStatus() const = 0;
     virtual const std::wstring& currentStatusText() const = 0;
+
+    virtual std::optional<double> getExpectedBytesPerSec() const = 0; //current phase; from previous runs, if available
+};
+
+
+struct PhaseMetrics
+{
+    ProcessPhase phase = ProcessPhase::none;
+    std::chrono::milliseconds duration{}; //wall time
+    ProgressStats statsProcessed;
+    ProgressStats statsTotal;
 };
 
 
@@ -71,6 +83,9 @@ struct ProcessSummary
     ProgressStats statsProcessed;
     ProgressStats statsTotal;
     std::chrono::milliseconds totalTime{};
+    std::vector<PhaseMetrics> phases; //optional: see saveMetricsFile()
+    FolderScanStats scanStats;        //
+    std::vector<MemoryUsage> memoryUsage; //
 };
 
 
@@ -84,14 +99,22 @@ public:
     void initNewPhase(int itemsTotal, int64_t bytesTotal, ProcessPhase phase) override //(throw X)
     {
         assert((itemsTotal < 0) == (bytesTotal < 0));
+        if (currentPhase_ != ProcessPhase::none)
+            phasesDone_.push_back(getCurrentPhaseMetrics());
+
         currentPhase_ = phase;
+        phaseStartTime_ = std::chrono::steady_clock::now();
         statsCurrent_ = {};
         statsTotal_ = {itemsTotal, bytesTotal};
+        expectedBytesPerSec_ = std::nullopt;
     }
 
     void updateDataProcessed(int itemsDelta, int64_t bytesDelta) override { updateData(statsCurrent_, itemsDelta, bytesDelta); } //note: these methods MUST NOT throw in order
     void updateDataTotal    (int itemsDelta, int64_t bytesDelta) override { updateData(statsTotal_,   itemsDelta, bytesDelta); } //to allow usage within destructors!
 
+    void reportScanStats(const FolderScanStats& stats) override { scanStats_ = stats; }
+    void reportExpectedSpeed(double bytesPerSec) override { expectedBytesPerSec_ = bytesPerSec; }
+
     void requestUiUpdate(bool force) final //throw AbortProcess
     {
         if (uiUpdateDue(force))
@@ -147,7 +170,25 @@ public:
 
     std::optional<AbortTrigger> getAbortStatus() const override { return abortRequested_; }
 
+    std::optional<double> getExpectedBytesPerSec() const override { return expectedBytesPerSec_; }
+
+    std::vector<PhaseMetrics> getPhaseMetrics() const //finished phases + current one
+    {
+        std::vector<PhaseMetrics> phases = phasesDone_;
+        if (currentPhase_ != ProcessPhase::none)
+            phases.push_back(getCurrentPhaseMetrics());
+        return phases;
+    }
+
+    const FolderScanStats& getScanStats() const { return scanStats_; }
+
 private:
+    PhaseMetrics getCurrentPhaseMetrics() const
+    {
+        return {currentPhase_, std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - phaseStartTime_),
+                statsCurrent_, statsTotal_};
+    }
+
     void updateData(ProgressStats& stats, int itemsDelta, int64_t bytesDelta)
     {
         assert(stats.items >= 0);
@@ -157,8 +198,12 @@ private:
     }
 
     ProcessPhase currentPhase_ = ProcessPhase::none;
+    std::chrono::steady_clock::time_point phaseStartTime_;
+    std::vector<PhaseMetrics> phasesDone_;
+    FolderScanStats scanStats_;
     ProgressStats statsCurrent_;
     ProgressStats statsTotal_ {-1, -1};
+    std::optional<double> expectedBytesPerSec_;
     std::wstring statusText_;
 
     std::optional<AbortTrigger> abortRequested_;
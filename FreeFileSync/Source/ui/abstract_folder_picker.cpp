@@ -155,9 +155,9 @@ struct FlatTraverserCallback : public AFS::TraverserCallback
     const Result& getResult() { return result_; }
 
 private:
-    void                               onFile   (const AFS::FileInfo&    fi) override {}
-    std::shared_ptr<TraverserCallback> onFolder (const AFS::FolderInfo&  fi) override { result_.folderNames.emplace(fi.itemName, fi.isFollowedSymlink); return nullptr; }
-    HandleLink                         onSymlink(const AFS::SymlinkInfo& si) override { return HandleLink::follow; }
+    void                               onFile   (AFS::FileInfo&&    fi) override {}
+    std::shared_ptr<TraverserCallback> onFolder (AFS::FolderInfo&&  fi) override { result_.folderNames.emplace(std::move(fi.itemName), fi.isFollowedSymlink); return nullptr; }
+    HandleLink                         onSymlink(AFS::SymlinkInfo&& si) override { return HandleLink::follow; }
     HandleError reportDirError (const ErrorInfo& errorInfo)                          override { logError(errorInfo.msg); return HandleError::ignore; }
     HandleError reportItemError(const ErrorInfo& errorInfo, const Zstring& itemName) override { logError(errorInfo.msg); return HandleError::ignore; }
 
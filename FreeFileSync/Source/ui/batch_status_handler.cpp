@@ -66,7 +66,7 @@ BatchStatusHandler::~BatchStatusHandler()
 
 
 BatchStatusHandler::Result BatchStatusHandler::reportResults(const Zstring& postSyncCommand, PostSyncCondition postSyncCondition,
-                                                             const AbstractPath& logFolderPath, int logfilesMaxAgeDays, LogFileFormat logFormat,
+                                                             const AbstractPath& logFolderPath, int logfilesMaxAgeDays, LogFileFormat logFormat, bool logMetrics,
                                                              const std::set<AbstractPath>& logFilePathsToKeep,
                                                              const std::string& emailNotifyAddress, ResultsNotification emailNotifyCondition) //noexcept!!
 {
@@ -94,12 +94,21 @@ BatchStatusHandler::Result BatchStatusHandler::reportResults(const Zstring& post
 
     assert(syncResult == SyncResult::aborted || currentPhase() == ProcessPhase::synchronizing);
 
+    if (logMetrics) //size machines for big jobs, spot memory regressions
+    {
+        errorLogMemory_.update(errorLog_);
+        logMsg(errorLog_, _("Memory usage:") + L' ' + formatMemoryUsage(getMemoryUsage()), MSG_TYPE_INFO);
+    }
+
     const ProcessSummary summary
     {
         startTime_, syncResult, {jobName_},
         getStatsCurrent(),
         getStatsTotal  (),
-        totalTime
+        totalTime,
+        getPhaseMetrics(),
+        getScanStats(),
+        getMemoryUsage()
     };
 
     AbstractPath logFilePath = AFS::appendRelPath(logFolderPath, generateLogFileName(logFormat, summary));
@@ -225,6 +234,13 @@ BatchStatusHandler::Result BatchStatusHandler::reportResults(const Zstring& post
             }
             catch (const FileError& e2) { logMsg(errorLog_, e2.toString(), MSG_TYPE_ERROR); }
     }
+
+    if (logMetrics)
+        try
+        {
+            saveMetricsFile(logFilePath, summary, getStats(errorLog_)); //throw FileError
+        }
+        catch (const FileError& e) { logMsg(errorLog_, e.toString(), MSG_TYPE_ERROR); }
     //----------------------------------------------------------
 
     if (suspend) //...*before* results dialog is shown
@@ -433,4 +449,5 @@ void BatchStatusHandler::reportFatalError(const std::wstring& msg)
 void BatchStatusHandler::forceUiUpdateNoThrow()
 {
     progressDlg_->updateGui();
+    errorLogMemory_.update(errorLog_);
 }
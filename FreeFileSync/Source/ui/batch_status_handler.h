@@ -60,7 +60,7 @@ public:
         bool dlgIsMaximized;
     };
     Result reportResults(const Zstring& postSyncCommand, PostSyncCondition postSyncCondition,
-                         const AbstractPath& logFolderPath, int logfilesMaxAgeDays, LogFileFormat logFormat, const std::set<AbstractPath>& logFilePathsToKeep,
+                         const AbstractPath& logFolderPath, int logfilesMaxAgeDays, LogFileFormat logFormat, bool logMetrics, const std::set<AbstractPath>& logFilePathsToKeep,
                          const std::string& emailNotifyAddress, ResultsNotification emailNotifyCondition); //noexcept!!
 
 private:
@@ -73,6 +73,7 @@ private:
 
     SyncProgressDialog* progressDlg_; //managed to have the same lifetime as this handler!
     zen::ErrorLog errorLog_; //list of non-resolved errors and warnings
+    ErrorLogMemoryTracker errorLogMemory_;
     const BatchErrorHandling batchErrorHandling_;
     bool switchToGuiRequested_ = false;
 };
@@ -6,6 +6,7 @@
 
 #include "file_grid.h"
 #include <set>
+#include <unordered_map>
 #include <wx/dc.h>
 #include <wx/settings.h>
 #include <wx/timer.h>
@@ -462,6 +463,13 @@ private:
     }
 
 
+    uint64_t getValueVersion() const override
+    {
+        //view update IDs are unique across FileView instances; item path format may change without a view update
+        const uint64_t viewUpdateId = getDataView().getViewUpdateId();
+        return viewUpdateId == 0 ? 0 : viewUpdateId * 3 + static_cast<uint64_t>(itemPathFormat_);
+    }
+
     std::wstring getValue(size_t row, ColumnType colType) const override
     {
         std::wstring value;
@@ -1467,7 +1475,7 @@ private:
                     if (getViewType() == GridViewType::difference)
                         drawIcon(getCmpResultImage(pdi.fsObj->getCategory()), wxALIGN_CENTER);
                     else if (pdi.fsObj->getCategory() != FILE_EQUAL) //don't show = in both middle columns
-                        drawIcon(greyScale(getCmpResultImage(pdi.fsObj->getCategory())), wxALIGN_CENTER);
+                        drawIcon(getGreyScaleIcon(greyCmpIcons_, pdi.fsObj->getCategory(), getCmpResultImage), wxALIGN_CENTER);
                 }
                 break;
 
@@ -1501,7 +1509,7 @@ private:
                             if (getViewType() == GridViewType::action)
                                 drawIcon(getSyncOpImage(pdi.fsObj->getSyncOperation()), wxALIGN_CENTER);
                             else if (pdi.fsObj->getSyncOperation() != SO_EQUAL) //don't show = in both middle columns
-                                drawIcon(greyScale(getSyncOpImage(pdi.fsObj->getSyncOperation())), wxALIGN_CENTER);
+                                drawIcon(getGreyScaleIcon(greySyncIcons_, pdi.fsObj->getSyncOperation(), getSyncOpImage), wxALIGN_CENTER);
                             break;
                     }
                 }
@@ -1661,8 +1669,20 @@ private:
     }
     //*INDENT-ON*
 
+    //greyScale() per row and repaint is wasted CPU: icons depend on category/sync operation only
+    template <class Key, class Function>
+    static const wxImage& getGreyScaleIcon(std::unordered_map<Key, wxImage>& cache, Key key, Function loadIcon)
+    {
+        auto it = cache.find(key);
+        if (it == cache.end())
+            it = cache.emplace(key, greyScale(loadIcon(key))).first;
+        return it->second;
+    }
+
     bool selectionInProgress_ = false;
 
+    std::unordered_map<CompareFileResult, wxImage> greyCmpIcons_;
+    std::unordered_map<SyncOperation,     wxImage> greySyncIcons_;
     std::optional<wxBitmap> renderBufCmp_; //avoid costs of recreating this temporary variable
     std::optional<wxBitmap> renderBufSync_;
     Tooltip toolTip_;
@@ -2028,16 +2048,17 @@ private:
         std::sort(prefetchLoad.begin(), prefetchLoad.end(), [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
 
         //last inserted items are processed first in icon buffer:
-        std::vector<AbstractPath> newLoad;
+        std::vector<AbstractPath> newPrefetchLoad;
         for (const auto& [priority, filePath] : prefetchLoad)
-            newLoad.push_back(filePath);
+            newPrefetchLoad.push_back(filePath);
 
-        provRight_.updateNewAndGetUnbufferedIcons(newLoad);
-        provLeft_ .updateNewAndGetUnbufferedIcons(newLoad);
+        std::vector<AbstractPath> newVisibleLoad;
+        provRight_.updateNewAndGetUnbufferedIcons(newVisibleLoad);
+        provLeft_ .updateNewAndGetUnbufferedIcons(newVisibleLoad);
 
-        iconBuffer_.setWorkload(newLoad);
+        iconBuffer_.setWorkload(newVisibleLoad, newPrefetchLoad); //visible icons are always loaded before prefetch
 
-        if (newLoad.empty()) //let's only pay for IconUpdater while needed
+        if (newVisibleLoad.empty() && newPrefetchLoad.empty()) //let's only pay for IconUpdater while needed
             stop();
     }
 
@@ -5,8 +5,10 @@
 // *****************************************************************************
 
 #include "file_view.h"
+#include <bit>
 #include <zen/stl_tools.h>
 #include <zen/perf.h>
+#include <zen/scope_guard.h>
 #include <zen/thread.h>
 #include "../base/synchronization.h"
 
@@ -65,11 +67,11 @@ FileView::FileView(FolderComparison& folderCmp)
                                   baseObj.getAbstractPath<SelectSide::left >(),
                                   baseObj.getAbstractPath<SelectSide::right>());
     });
+    updateMemoryUsage();
 }
 
 
-template <class Predicate>
-void FileView::updateView(Predicate pred)
+void FileView::updateView(const std::vector<uint64_t>& rowsOnView)
 {
     viewRef_               .clear();
     groupDetails_          .clear();
@@ -83,9 +85,11 @@ void FileView::updateView(Predicate pred)
     std::vector<const ContainerObject*> parentsBuf; //from bottom to top of hierarchy
     const ContainerObject* groupStartObj = nullptr;
 
-    for (const FileSystemObject::ObjectId& objId : sortedRef_)
-        if (const FileSystemObject* const fsObj = FileSystemObject::retrieve(objId))
-            if (pred(*fsObj))
+    for (size_t i = 0; i < rowsOnView.size(); ++i)
+        for (uint64_t bits = rowsOnView[i]; bits != 0; bits &= bits - 1) //iterate over set bits only
+        {
+            const FileSystemObject::ObjectId& objId = sortedRef_[i * 64 + std::countr_zero(bits)];
+            if (const FileSystemObject* const fsObj = FileSystemObject::retrieve(objId))
             {
                 const size_t row = viewRef_.size();
 
@@ -125,6 +129,30 @@ void FileView::updateView(Predicate pred)
                 //-----------------------------------------------------------
                 viewRef_.push_back({objId, groupIdx});
             }
+        }
+    updateMemoryUsage();
+}
+
+
+void FileView::updateMemoryUsage()
+{
+    auto hashMapBytes = [](const auto& hashMap) //estimate: one heap node per item + bucket array
+    {
+        using HashMap = std::remove_cvref_t<decltype(hashMap)>;
+        return hashMap.size() * (sizeof(typename HashMap::value_type) + 2 * sizeof(void*)) + hashMap.bucket_count() * sizeof(void*);
+    };
+
+    size_t bytes = sortedRef_.capacity() * sizeof(sortedRef_[0]) +
+                   viewRef_  .capacity() * sizeof(viewRef_[0]) +
+                   groupDetails_.capacity() * sizeof(groupDetails_[0]) +
+                   hashMapBytes(rowPositions_) +
+                   hashMapBytes(rowPositionsFirstChild_);
+
+    for (const CategoryCache* cache : {&diffCategories_, &actionCategories_})
+        for (const CategoryRows& catRows : cache->rows)
+            bytes += sizeof(catRows) + catRows.rowBits.capacity() * sizeof(uint64_t);
+
+    memoryUsage_.set(bytes);
 }
 
 
@@ -179,6 +207,54 @@ void addNumbers(const FileSystemObject& fsObj, ViewStats& stats)
             ++stats.fileStatsRight.fileCount;
     });
 }
+
+
+template <class CategoryRows, class ViewStats> inline
+void addRows(const CategoryRows& catRows, std::vector<uint64_t>& rowsOnView, ViewStats& stats)
+{
+    assert(catRows.rowBits.size() == rowsOnView.size());
+    if (catRows.rowCount == 0)
+        return;
+
+    for (size_t i = 0; i < rowsOnView.size(); ++i)
+        rowsOnView[i] |= catRows.rowBits[i];
+
+    stats.fileStatsLeft .fileCount   += catRows.fileStatsLeft .fileCount;
+    stats.fileStatsLeft .folderCount += catRows.fileStatsLeft .folderCount;
+    stats.fileStatsLeft .bytes       += catRows.fileStatsLeft .bytes;
+    stats.fileStatsRight.fileCount   += catRows.fileStatsRight.fileCount;
+    stats.fileStatsRight.folderCount += catRows.fileStatsRight.folderCount;
+    stats.fileStatsRight.bytes       += catRows.fileStatsRight.bytes;
+}
+}
+
+
+template <class GetCategory>
+const std::vector<FileView::CategoryRows>& FileView::getCategoryRows(CategoryCache& cache, size_t categoryCount, GetCategory getCategory /*(const FileSystemObject&) -> size_t*/)
+{
+    //recalculate only after the comparison result was changed, e.g. new sync directions, (de-)selecting items
+    if (cache.rows.empty() || cache.changeId != ContainerObject::getLastChangeId())
+    {
+        cache.rows.clear();
+        cache.rows.resize(2 * categoryCount);
+        cache.changeId = ContainerObject::getLastChangeId();
+
+        for (CategoryRows& catRows : cache.rows)
+            catRows.rowBits.resize((sortedRef_.size() + 63) / 64);
+
+        for (size_t row = 0; row < sortedRef_.size(); ++row)
+            if (const FileSystemObject* const fsObj = FileSystemObject::retrieve(sortedRef_[row]))
+            {
+                const size_t category = getCategory(*fsObj);
+                assert(category < categoryCount);
+                CategoryRows& catRows = cache.rows[2 * category + (fsObj->isActive() ? 0 : 1)];
+
+                catRows.rowBits[row / 64] |= uint64_t(1) << (row % 64);
+                ++catRows.rowCount;
+                addNumbers(*fsObj, catRows); //calculate total number of bytes for each side
+            }
+    }
+    return cache.rows;
 }
 
 
@@ -191,48 +267,39 @@ FileView::DifferenceViewStats FileView::applyDifferenceFilter(bool showExcluded,
                                                               bool showEqual,
                                                               bool showConflict)
 {
+    const std::vector<CategoryRows>& catRows = getCategoryRows(diffCategories_, FILE_CONFLICT + 1, [](const FileSystemObject& fsObj) -> size_t
+    {
+        return fsObj.getCategory();
+    });
+
     DifferenceViewStats stats;
+    std::vector<uint64_t> rowsOnView((sortedRef_.size() + 63) / 64);
 
-    updateView([&](const FileSystemObject& fsObj)
+    auto categorize = [&](CompareFileResult category, bool showCategory, int& categoryCount)
     {
-        auto categorize = [&](bool showCategory, int& categoryCount)
-        {
-            if (!fsObj.isActive())
-            {
-                ++stats.excluded;
-                if (!showExcluded)
-                    return false;
-            }
-            ++categoryCount;
-            if (!showCategory)
-                return false;
+        const CategoryRows& rowsActive   = catRows[2 * category];
+        const CategoryRows& rowsExcluded = catRows[2 * category + 1];
 
-            addNumbers(fsObj, stats); //calculate total number of bytes for each side
-            return true;
-        };
+        stats.excluded += rowsExcluded.rowCount;
+        categoryCount  += rowsActive.rowCount + (showExcluded ? rowsExcluded.rowCount : 0);
 
-        switch (fsObj.getCategory())
+        if (showCategory)
         {
-            case FILE_LEFT_SIDE_ONLY:
-                return categorize(showLeftOnly, stats.leftOnly);
-            case FILE_RIGHT_SIDE_ONLY:
-                return categorize(showRightOnly, stats.rightOnly);
-            case FILE_LEFT_NEWER:
-                return categorize(showLeftNewer, stats.leftNewer);
-            case FILE_RIGHT_NEWER:
-                return categorize(showRightNewer, stats.rightNewer);
-            case FILE_DIFFERENT_CONTENT:
-                return categorize(showDifferent, stats.different);
-            case FILE_EQUAL:
-            case FILE_DIFFERENT_METADATA: //= sub-category of equal
-                return categorize(showEqual, stats.equal);
-            case FILE_CONFLICT:
-                return categorize(showConflict, stats.conflict);
+            addRows(rowsActive, rowsOnView, stats);
+            if (showExcluded)
+                addRows(rowsExcluded, rowsOnView, stats);
         }
-        assert(false);
-        return true;
-    });
-
+    };
+    categorize(FILE_LEFT_SIDE_ONLY,     showLeftOnly,   stats.leftOnly);
+    categorize(FILE_RIGHT_SIDE_ONLY,    showRightOnly,  stats.rightOnly);
+    categorize(FILE_LEFT_NEWER,         showLeftNewer,  stats.leftNewer);
+    categorize(FILE_RIGHT_NEWER,        showRightNewer, stats.rightNewer);
+    categorize(FILE_DIFFERENT_CONTENT,  showDifferent,  stats.different);
+    categorize(FILE_EQUAL,              showEqual,      stats.equal);
+    categorize(FILE_DIFFERENT_METADATA, showEqual,      stats.equal); //= sub-category of equal
+    categorize(FILE_CONFLICT,           showConflict,   stats.conflict);
+
+    updateView(rowsOnView);
     return stats;
 }
 
@@ -248,66 +315,53 @@ FileView::ActionViewStats FileView::applyActionFilter(bool showExcluded, //maps
                                                       bool showEqual,
                                                       bool showConflict)
 {
+    const std::vector<CategoryRows>& catRows = getCategoryRows(actionCategories_, SO_UNRESOLVED_CONFLICT + 1, [](const FileSystemObject& fsObj) -> size_t
+    {
+        return fsObj.getSyncOperation(); //evaluate comparison result and sync direction
+    });
+
     ActionViewStats stats;
+    std::vector<uint64_t> rowsOnView((sortedRef_.size() + 63) / 64);
 
     int moveLeft  = 0;
     int moveRight = 0;
 
-    updateView([&](const FileSystemObject& fsObj)
+    auto categorize = [&](SyncOperation category, bool showCategory, int& categoryCount)
     {
-        auto categorize = [&](bool showCategory, int& categoryCount)
-        {
-            if (!fsObj.isActive())
-            {
-                ++stats.excluded;
-                if (!showExcluded)
-                    return false;
-            }
-            ++categoryCount;
-            if (!showCategory)
-                return false;
+        const CategoryRows& rowsActive   = catRows[2 * category];
+        const CategoryRows& rowsExcluded = catRows[2 * category + 1];
 
-            addNumbers(fsObj, stats); //calculate total number of bytes for each side
-            return true;
-        };
+        stats.excluded += rowsExcluded.rowCount;
+        categoryCount  += rowsActive.rowCount + (showExcluded ? rowsExcluded.rowCount : 0);
 
-        switch (fsObj.getSyncOperation()) //evaluate comparison result and sync direction
+        if (showCategory)
         {
-            case SO_CREATE_NEW_LEFT:
-                return categorize(showCreateLeft, stats.createLeft);
-            case SO_CREATE_NEW_RIGHT:
-                return categorize(showCreateRight, stats.createRight);
-            case SO_DELETE_LEFT:
-                return categorize(showDeleteLeft, stats.deleteLeft);
-            case SO_DELETE_RIGHT:
-                return categorize(showDeleteRight, stats.deleteRight);
-            case SO_OVERWRITE_LEFT:
-            case SO_COPY_METADATA_TO_LEFT: //no extra filter button
-                return categorize(showUpdateLeft, stats.updateLeft);
-            case SO_MOVE_LEFT_FROM:
-            case SO_MOVE_LEFT_TO:
-                return categorize(showUpdateLeft, moveLeft);
-            case SO_OVERWRITE_RIGHT:
-            case SO_COPY_METADATA_TO_RIGHT: //no extra filter button
-                return categorize(showUpdateRight, stats.updateRight);
-            case SO_MOVE_RIGHT_FROM:
-            case SO_MOVE_RIGHT_TO:
-                return categorize(showUpdateRight, moveRight);
-            case SO_DO_NOTHING:
-                return categorize(showDoNothing, stats.updateNone);
-            case SO_EQUAL:
-                return categorize(showEqual, stats.equal);
-            case SO_UNRESOLVED_CONFLICT:
-                return categorize(showConflict, stats.conflict);
+            addRows(rowsActive, rowsOnView, stats);
+            if (showExcluded)
+                addRows(rowsExcluded, rowsOnView, stats);
         }
-        assert(false);
-        return true;
-    });
+    };
+    categorize(SO_CREATE_NEW_LEFT,        showCreateLeft,  stats.createLeft);
+    categorize(SO_CREATE_NEW_RIGHT,       showCreateRight, stats.createRight);
+    categorize(SO_DELETE_LEFT,            showDeleteLeft,  stats.deleteLeft);
+    categorize(SO_DELETE_RIGHT,           showDeleteRight, stats.deleteRight);
+    categorize(SO_OVERWRITE_LEFT,         showUpdateLeft,  stats.updateLeft);
+    categorize(SO_COPY_METADATA_TO_LEFT,  showUpdateLeft,  stats.updateLeft); //no extra filter button
+    categorize(SO_MOVE_LEFT_FROM,         showUpdateLeft,  moveLeft);
+    categorize(SO_MOVE_LEFT_TO,           showUpdateLeft,  moveLeft);
+    categorize(SO_OVERWRITE_RIGHT,        showUpdateRight, stats.updateRight);
+    categorize(SO_COPY_METADATA_TO_RIGHT, showUpdateRight, stats.updateRight); //no extra filter button
+    categorize(SO_MOVE_RIGHT_FROM,        showUpdateRight, moveRight);
+    categorize(SO_MOVE_RIGHT_TO,          showUpdateRight, moveRight);
+    categorize(SO_DO_NOTHING,             showDoNothing,   stats.updateNone);
+    categorize(SO_EQUAL,                  showEqual,       stats.equal);
+    categorize(SO_UNRESOLVED_CONFLICT,    showConflict,    stats.conflict);
 
     assert(moveLeft % 2 == 0 && moveRight % 2 == 0);
     stats.updateLeft  += moveLeft  / 2; //count move operations as single update
     stats.updateRight += moveRight / 2; //=> harmonize with SyncStatistics::processFile()
 
+    updateView(rowsOnView);
     return stats;
 }
 
@@ -356,11 +410,13 @@ void FileView::removeInvalidRows()
 {
     //remove rows that have been deleted meanwhile
     std::erase_if(sortedRef_, [&](const FileSystemObject::ObjectId& objId) { return !FileSystemObject::retrieve(objId); });
+    clearCategoryCache();
 
     viewRef_               .clear();
     groupDetails_          .clear();
     rowPositions_          .clear();
     rowPositionsFirstChild_.clear();
+    updateMemoryUsage();
 }
 
 
@@ -394,351 +450,370 @@ bool isDirectoryPair(const FileSystemObject& fsObj)
 }
 
 
-template <bool ascending, SelectSide side> inline
-bool lessFileName(const FileSystemObject& lhs, const FileSystemObject& rhs)
-{
-    //sort order: first files/symlinks, then directories then empty rows
-
-    //empty rows always last
-    if (lhs.isEmpty<side>())
-        return false;
-    else if (rhs.isEmpty<side>())
-        return true;
+/* sorting millions of rows: precompute sort keys once per row into a flat array
+    => comparisons must not call FileSystemObject::retrieve(), dynamic_cast or compareNatural() (= Unicode normalization + case conversion)
+    => calculate keys and sort in parallel: GUI is blocked meanwhile anyway                                                            */
+const size_t PARALLEL_SORT_MIN_ITEMS = 10'000; //per thread: don't bother starting threads for small views
 
-    //directories after files/symlinks:
-    if (isDirectoryPair(lhs))
-    {
-        if (!isDirectoryPair(rhs))
-            return false;
-    }
-    else if (isDirectoryPair(rhs))
-        return true;
 
-    //sort directories and files/symlinks by short name
-    return zen::makeSortDirection(LessNaturalSort() /*even on Linux*/, std::bool_constant<ascending>())(lhs.getItemName<side>(), rhs.getItemName<side>());
+size_t getSortThreadCount(size_t itemCount)
+{
+    return std::clamp<size_t>(itemCount / PARALLEL_SORT_MIN_ITEMS, 1, std::max(std::thread::hardware_concurrency(), 1U));
 }
 
 
-template <bool ascending>  inline //side currently unused!
-bool lessFilePath(const FileSystemObject::ObjectId& lhs, const FileSystemObject::ObjectId& rhs,
-                  const std::unordered_map<const void* /*BaseFolderPair*/, size_t /*position*/>& sortedPos,
-                  std::vector<const FolderPair*>& tempBuf)
+//run fun(0), ..., fun(taskCount - 1) on separate threads
+template <class Function>
+void parallelFor(size_t taskCount, Function fun) //throw X
 {
-    const FileSystemObject* fsObjL = FileSystemObject::retrieve(lhs);
-    const FileSystemObject* fsObjR = FileSystemObject::retrieve(rhs);
-    if (!fsObjL) //invalid rows shall appear at the end
-        return false;
-    else if (!fsObjR)
-        return true;
+    if (taskCount == 1)
+        return fun(0); //throw X
 
-    //------- presort by folder pair ----------
-    {
-        auto itL = sortedPos.find(&fsObjL->base());
-        auto itR = sortedPos.find(&fsObjR->base());
-        assert(itL != sortedPos.end() && itR != sortedPos.end());
-        if (itL == sortedPos.end()) //invalid rows shall appear at the end
-            return false;
-        else if (itR == sortedPos.end())
-            return true;
+    std::vector<std::future<void>> futures;
+    ZEN_ON_SCOPE_EXIT(for (std::future<void>& ft : futures) ft.wait()); //[!] don't leave scope while detached threads are still referencing "fun"
 
-        const size_t basePosL = itL->second;
-        const size_t basePosR = itR->second;
-
-        if (basePosL != basePosR)
-            return zen::makeSortDirection(std::less(), std::bool_constant<ascending>())(basePosL, basePosR);
-    }
+    for (size_t i = 0; i < taskCount; ++i)
+        futures.push_back(runAsync([&fun, i] { fun(i); }));
 
-    //------- sort component-wise ----------
-    const auto folderL = dynamic_cast<const FolderPair*>(fsObjL);
-    const auto folderR = dynamic_cast<const FolderPair*>(fsObjR);
-
-    std::vector<const FolderPair*>& parentsBuf = tempBuf; //from bottom to top of hierarchy, excluding base
-    parentsBuf.clear();
-
-    const auto collectParents = [&](const FileSystemObject* fsObj)
-    {
-        for (;;)
-            if (const auto folder = dynamic_cast<const FolderPair*>(&fsObj->parent())) //perf: most expensive part of this function!
-            {
-                parentsBuf.push_back(folder);
-                fsObj = folder;
-            }
-            else
-                break;
-    };
-    if (folderL)
-        parentsBuf.push_back(folderL);
-    collectParents(fsObjL);
-    const size_t parentsSizeL = parentsBuf.size();
+    for (std::future<void>& ft : futures)
+        ft.get(); //throw X
+}
 
-    if (folderR)
-        parentsBuf.push_back(folderR);
-    collectParents(fsObjR);
 
-    const std::span<const FolderPair*> parentsL(parentsBuf.data(), parentsSizeL); //no construction via iterator (yet): https://github.com/cplusplus/draft/pull/3456
-    const std::span<const FolderPair*> parentsR(parentsBuf.data() + parentsSizeL, parentsBuf.size() - parentsSizeL);
+//split [0, itemCount) into (almost) equal-sized ranges
+std::vector<size_t> getRangeBounds(size_t itemCount, size_t rangeCount)
+{
+    std::vector<size_t> bounds;
+    for (size_t i = 0; i <= rangeCount; ++i)
+        bounds.push_back(itemCount * i / rangeCount);
+    return bounds;
+}
 
-    const auto& [itL, itR] = std::mismatch(parentsL.rbegin(), parentsL.rend(),
-                                           parentsR.rbegin(), parentsR.rend());
-    if (itL == parentsL.rend())
-    {
-        if (itR == parentsR.rend())
-        {
-            //make folders always appear before contained files
-            if (folderR)
-                return false;
-            else if (folderL)
-                return true;
 
-            return zen::makeSortDirection(LessNaturalSort(), std::bool_constant<ascending>())(fsObjL->getItemNameAny(), fsObjR->getItemNameAny());
-        }
-        else
-            return true;
-    }
-    else if (itR == parentsR.rend())
-        return false;
+template <class T, class GetItem>
+std::vector<T> parallelTransform(const std::vector<FileSystemObject::ObjectId>& rows, GetItem getItem /*(const FileSystemObject::ObjectId&) -> T; thread-safe!*/)
+{
+    std::vector<T> items(rows.size());
 
-    //different components...
-    if (const std::weak_ordering cmp = compareNatural((*itL)->getItemNameAny(), (*itR)->getItemNameAny());
-        cmp != std::weak_ordering::equivalent)
+    const std::vector<size_t> bounds = getRangeBounds(rows.size(), getSortThreadCount(rows.size()));
+    parallelFor(bounds.size() - 1, [&](size_t i)
     {
-        if constexpr (ascending)
-            return std::is_lt(cmp);
-        else
-            return std::is_gt(cmp);
-    }
-    //return zen::makeSortDirection(std::less(), std::bool_constant<ascending>())(rv, 0);
-
-    /*...with equivalent names:
-        1. functional correctness => must not compare equal!  e.g. a/a/x and a/A/y
-        2. ensure stable sort order                                                            */
-    return *itL < *itR;
+        for (size_t row = bounds[i]; row < bounds[i + 1]; ++row)
+            items[row] = getItem(rows[row]);
+    });
+    return items;
 }
 
 
-template <bool ascending, SelectSide side> inline
-bool lessFilesize(const FileSystemObject& lhs, const FileSystemObject& rhs)
+//sort ranges in parallel, then merge pairwise in parallel
+template <class T, class Less>
+void parallelStableSort(std::vector<T>& items, Less less)
 {
-    //empty rows always last
-    if (lhs.isEmpty<side>())
-        return false;
-    else if (rhs.isEmpty<side>())
-        return true;
-
-    //directories second last
-    if (isDirectoryPair(lhs))
-        return false;
-    else if (isDirectoryPair(rhs))
-        return true;
+    std::vector<size_t> bounds = getRangeBounds(items.size(), getSortThreadCount(items.size()));
 
-    const FilePair* fileL = dynamic_cast<const FilePair*>(&lhs);
-    const FilePair* fileR = dynamic_cast<const FilePair*>(&rhs);
+    parallelFor(bounds.size() - 1, [&](size_t i) { std::stable_sort(items.begin() + bounds[i], items.begin() + bounds[i + 1], less); });
 
-    //then symlinks
-    if (!fileL)
-        return false;
-    else if (!fileR)
-        return true;
+    while (bounds.size() > 2)
+    {
+        const size_t mergeCount = (bounds.size() - 1) / 2;
+        parallelFor(mergeCount, [&](size_t i)
+        {
+            std::inplace_merge(items.begin() + bounds[2 * i], items.begin() + bounds[2 * i + 1], items.begin() + bounds[2 * i + 2], less);
+        });
 
-    //return list beginning with largest files first
-    return zen::makeSortDirection(std::less(), std::bool_constant<ascending>())(fileL->getFileSize<side>(), fileR->getFileSize<side>());
+        std::vector<size_t> boundsMerged;
+        for (size_t i = 0; i < bounds.size(); i += 2)
+            boundsMerged.push_back(bounds[i]);
+        if (boundsMerged.back() != bounds.back()) //odd number of ranges: last one is merged during next round
+            boundsMerged.push_back(bounds.back());
+        bounds.swap(boundsMerged);
+    }
 }
 
 
-template <bool ascending, SelectSide side> inline
-bool lessFiletime(const FileSystemObject& lhs, const FileSystemObject& rhs)
+template <class Value>
+struct RowSortKey
 {
-    if (lhs.isEmpty<side>())
-        return false; //empty rows always last
-    else if (rhs.isEmpty<side>())
-        return true; //empty rows always last
+    int category = 0; //independent from sort direction: e.g. invalid rows last, empty rows last, directories after files
+    Value value{};
+    FileSystemObject::ObjectId objId;
+};
 
-    const FilePair* fileL = dynamic_cast<const FilePair*>(&lhs);
-    const FilePair* fileR = dynamic_cast<const FilePair*>(&rhs);
 
-    const SymlinkPair* symlinkL = dynamic_cast<const SymlinkPair*>(&lhs);
-    const SymlinkPair* symlinkR = dynamic_cast<const SymlinkPair*>(&rhs);
+template <class Value, class GetKey>
+void sortRowsByKey(std::vector<FileSystemObject::ObjectId>& rows, bool ascending,
+                   GetKey getKey /*(const FileSystemObject&, RowSortKey<Value>&); thread-safe!*/)
+{
+    const int CATEGORY_INVALID = std::numeric_limits<int>::max(); //invalid rows shall appear at the end
 
-    if (!fileL && !symlinkL)
-        return false; //directories last
-    else if (!fileR && !symlinkR)
-        return true; //directories last
+    std::vector<RowSortKey<Value>> keys = parallelTransform<RowSortKey<Value>>(rows, [&](const FileSystemObject::ObjectId& objId)
+    {
+        RowSortKey<Value> key;
+        key.objId = objId;
+        if (const FileSystemObject* fsObj = FileSystemObject::retrieve(objId))
+            getKey(*fsObj, key);
+        else
+            key.category = CATEGORY_INVALID;
+        return key;
+    });
 
-    const int64_t dateL = fileL ? fileL->getLastWriteTime<side>() : symlinkL->getLastWriteTime<side>();
-    const int64_t dateR = fileR ? fileR->getLastWriteTime<side>() : symlinkR->getLastWriteTime<side>();
+    parallelStableSort(keys, [ascending](const RowSortKey<Value>& lhs, const RowSortKey<Value>& rhs)
+    {
+        if (lhs.category != rhs.category)
+            return lhs.category < rhs.category;
+        return ascending ? lhs.value < rhs.value : rhs.value < lhs.value;
+    });
 
-    //return list beginning with newest files first
-    return zen::makeSortDirection(std::less(), std::bool_constant<ascending>())(dateL, dateR);
+    for (size_t i = 0; i < keys.size(); ++i)
+        rows[i] = keys[i].objId;
 }
 
 
-template <bool ascending, SelectSide side> inline
-bool lessExtension(const FileSystemObject& lhs, const FileSystemObject& rhs)
+template <SelectSide side>
+void sortByFileName(std::vector<FileSystemObject::ObjectId>& rows, bool ascending)
 {
-    if (lhs.isEmpty<side>())
-        return false; //empty rows always last
-    else if (rhs.isEmpty<side>())
-        return true; //empty rows always last
-
-    if (dynamic_cast<const FolderPair*>(&lhs))
-        return false; //directories last
-    else if (dynamic_cast<const FolderPair*>(&rhs))
-        return true; //directories last
-
-    auto getExtension = [](const FileSystemObject& fsObj)
+    //sort order: first files/symlinks, then directories then empty rows
+    sortRowsByKey<std::string>(rows, ascending, [](const FileSystemObject& fsObj, RowSortKey<std::string>& key)
     {
-        return afterLast(fsObj.getItemName<side>(), Zstr('.'), zen::IfNotFoundReturn::none);
-    };
-
-    return zen::makeSortDirection(LessNaturalSort() /*even on Linux*/, std::bool_constant<ascending>())(getExtension(lhs), getExtension(rhs));
+        if (fsObj.isEmpty<side>())
+            key.category = 2;
+        else
+        {
+            key.category = isDirectoryPair(fsObj) ? 1 : 0;
+            key.value = getNaturalSortKey(fsObj.getItemName<side>()); //even on Linux
+        }
+    });
 }
 
 
-template <bool ascending> inline
-bool lessCmpResult(const FileSystemObject& lhs, const FileSystemObject& rhs)
+template <SelectSide side>
+void sortByFileSize(std::vector<FileSystemObject::ObjectId>& rows, bool ascending)
 {
-    return zen::makeSortDirection([](CompareFileResult lhs2, CompareFileResult rhs2)
+    //sort order: files, symlinks, directories, empty rows
+    sortRowsByKey<uint64_t>(rows, ascending, [](const FileSystemObject& fsObj, RowSortKey<uint64_t>& key)
     {
-        //presort: equal shall appear at end of list
-        if (lhs2 == FILE_EQUAL)
-            return false;
-        if (rhs2 == FILE_EQUAL)
-            return true;
-        return lhs2 < rhs2;
-    },
-    std::bool_constant<ascending>())(lhs.getCategory(), rhs.getCategory());
+        if (fsObj.isEmpty<side>())
+            key.category = 3;
+        else if (isDirectoryPair(fsObj))
+            key.category = 2;
+        else if (const FilePair* file = dynamic_cast<const FilePair*>(&fsObj))
+            key.value = file->getFileSize<side>();
+        else
+            key.category = 1;
+    });
 }
 
 
-template <bool ascending> inline
-bool lessSyncDirection(const FileSystemObject& lhs, const FileSystemObject& rhs)
+template <SelectSide side>
+void sortByFileTime(std::vector<FileSystemObject::ObjectId>& rows, bool ascending)
 {
-    return zen::makeSortDirection(std::less(), std::bool_constant<ascending>())(lhs.getSyncOperation(), rhs.getSyncOperation());
+    //sort order: files/symlinks, directories, empty rows
+    sortRowsByKey<int64_t>(rows, ascending, [](const FileSystemObject& fsObj, RowSortKey<int64_t>& key)
+    {
+        if (fsObj.isEmpty<side>())
+            key.category = 2;
+        else if (const FilePair* file = dynamic_cast<const FilePair*>(&fsObj))
+            key.value = file->getLastWriteTime<side>();
+        else if (const SymlinkPair* symlink = dynamic_cast<const SymlinkPair*>(&fsObj))
+            key.value = symlink->getLastWriteTime<side>();
+        else
+            key.category = 1;
+    });
 }
 
 
-template <bool ascending, SelectSide side>
-struct LessFullPath
+template <SelectSide side>
+void sortByExtension(std::vector<FileSystemObject::ObjectId>& rows, bool ascending)
 {
-    LessFullPath(std::vector<std::tuple<const void* /*BaseFolderPair*/, AbstractPath, AbstractPath>> folderPairs)
+    //sort order: files/symlinks, directories, empty rows
+    sortRowsByKey<std::string>(rows, ascending, [](const FileSystemObject& fsObj, RowSortKey<std::string>& key)
     {
-        //calculate positions of base folders sorted by name
-        std::sort(folderPairs.begin(), folderPairs.end(), [](const auto& a, const auto& b)
-        {
-            const auto& [baseObjA, basePathLA, basePathRA] = a;
-            const auto& [baseObjB, basePathLB, basePathRB] = b;
+        if (fsObj.isEmpty<side>())
+            key.category = 2;
+        else if (isDirectoryPair(fsObj))
+            key.category = 1;
+        else
+            key.value = getNaturalSortKey(afterLast(fsObj.getItemName<side>(), Zstr('.'), zen::IfNotFoundReturn::none)); //even on Linux
+    });
+}
 
-            const AbstractPath& basePathA = selectParam<side>(basePathLA, basePathRA);
-            const AbstractPath& basePathB = selectParam<side>(basePathLB, basePathRB);
 
-            return LessNaturalSort()/*even on Linux*/(zen::utfTo<Zstring>(AFS::getDisplayPath(basePathA)),
-                                                      zen::utfTo<Zstring>(AFS::getDisplayPath(basePathB)));
-        });
+/* sort by path: - presort by folder pair
+                 - sort component-wise; folders appear before contained files; files before sub folders */
+void sortByFilePath(std::vector<FileSystemObject::ObjectId>& rows, bool ascending,
+                    const std::unordered_map<const void* /*BaseFolderPair*/, size_t /*position*/>& sortedPos)
+{
+    struct FolderKey
+    {
+        const FolderPair* folder = nullptr;
+        const FolderKey* parent = nullptr; //nullptr: base folder
+        size_t depth = 0; //number of folders from base: >= 1
+        std::string nameKey;
+    };
 
-        size_t pos = 0;
-        for (const auto& [baseObj, basePathL, basePathR] : folderPairs)
-            sortedPos_.ref().emplace(baseObj, pos++);
-    }
+    struct PathSortKey
+    {
+        size_t basePos = 0;
+        const FolderPair* folder = nullptr; //the row itself if it's a folder, otherwise its parent folder (or nullptr)
+        const FolderKey* folderKey = nullptr; //
+        bool isFolder = false;
+        std::string nameKey; //files and symlinks only
+        FileSystemObject::ObjectId objId;
+    };
+    const size_t BASE_POS_INVALID = std::numeric_limits<size_t>::max(); //invalid rows shall appear at the end
 
-    bool operator()(const FileSystemObject::ObjectId& lhs, const FileSystemObject::ObjectId& rhs) const
+    std::vector<PathSortKey> keys = parallelTransform<PathSortKey>(rows, [&](const FileSystemObject::ObjectId& objId)
     {
-        return lessFilePath<ascending>(lhs, rhs, sortedPos_.ref(), tempBuf_);
-    }
+        PathSortKey key;
+        key.objId = objId;
+        key.basePos = BASE_POS_INVALID;
 
-private:
-    SharedRef<std::unordered_map<const void* /*BaseFolderPair*/, size_t /*position*/>> sortedPos_ = makeSharedRef<std::unordered_map<const void*, size_t>>();
-    mutable std::vector<const FolderPair*> tempBuf_; //avoid repeated memory allocation in lessFilePath()
-};
+        if (const FileSystemObject* fsObj = FileSystemObject::retrieve(objId))
+        {
+            auto it = sortedPos.find(&fsObj->base());
+            assert(it != sortedPos.end());
+            if (it != sortedPos.end())
+            {
+                key.basePos = it->second;
 
+                if (const FolderPair* folder = dynamic_cast<const FolderPair*>(fsObj))
+                {
+                    key.folder = folder;
+                    key.isFolder = true;
+                }
+                else
+                {
+                    key.folder = dynamic_cast<const FolderPair*>(&fsObj->parent());
+                    key.nameKey = getNaturalSortKey(fsObj->getItemNameAny());
+                }
+            }
+        }
+        return key;
+    });
 
-template <bool ascending>
-struct LessRelativeFolder
-{
-    LessRelativeFolder(const std::vector<std::tuple<const void* /*BaseFolderPair*/, AbstractPath, AbstractPath>>& folderPairs)
-    {
-        //take over positions of base folders as set up by user
-        size_t pos = 0;
-        for (const auto& [baseObj, basePathL, basePathR] : folderPairs)
-            sortedPos_.ref().emplace(baseObj, pos++);
-    }
+    //folder keys: calculated once per folder instead of once per comparison (walking the hierarchy via dynamic_cast is the most expensive part!)
+    std::unordered_map<const FolderPair*, FolderKey> folderKeys;
 
-    bool operator()(const FileSystemObject::ObjectId& lhs, const FileSystemObject::ObjectId& rhs) const
+    const std::function<const FolderKey*(const FolderPair*)> getFolderKey = [&](const FolderPair* folder) -> const FolderKey*
     {
-        return lessFilePath<ascending>(lhs, rhs, sortedPos_.ref(), tempBuf_);
-    }
-
-private:
-    SharedRef<std::unordered_map<const void* /*BaseFolderPair*/, size_t /*position*/>> sortedPos_ = makeSharedRef<std::unordered_map<const void*, size_t>>();
-    mutable std::vector<const FolderPair*> tempBuf_; //avoid repeated memory allocation in lessFilePath()
-};
+        if (!folder)
+            return nullptr;
 
+        auto [it, inserted] = folderKeys.try_emplace(folder);
+        FolderKey& fk = it->second;
+        if (inserted)
+        {
+            fk.folder  = folder;
+            fk.parent  = getFolderKey(dynamic_cast<const FolderPair*>(&folder->parent())); //unordered_map: references stay valid during insertion
+            fk.depth   = fk.parent ? fk.parent->depth + 1 : 1;
+            fk.nameKey = getNaturalSortKey(folder->getItemNameAny());
+        }
+        return &fk;
+    };
+    for (PathSortKey& key : keys)
+        key.folderKey = getFolderKey(key.folder);
 
-template <bool ascending, SelectSide side>
-struct LessFileName
-{
-    bool operator()(const FileSystemObject::ObjectId& lhs, const FileSystemObject::ObjectId& rhs) const
+    parallelStableSort(keys, [ascending](const PathSortKey& lhs, const PathSortKey& rhs)
     {
-        const FileSystemObject* fsObjA = FileSystemObject::retrieve(lhs);
-        const FileSystemObject* fsObjB = FileSystemObject::retrieve(rhs);
-        if (!fsObjA) //invalid rows shall appear at the end
+        if (lhs.basePos == BASE_POS_INVALID) //invalid rows shall appear at the end
             return false;
-        else if (!fsObjB)
+        else if (rhs.basePos == BASE_POS_INVALID)
             return true;
 
-        return lessFileName<ascending, side>(*fsObjA, *fsObjB);
-    }
-};
+        //------- presort by folder pair ----------
+        if (lhs.basePos != rhs.basePos)
+            return ascending ? lhs.basePos < rhs.basePos : rhs.basePos < lhs.basePos;
 
+        //------- sort component-wise ----------
+        const FolderKey* fkL = lhs.folderKey;
+        const FolderKey* fkR = rhs.folderKey;
+        const size_t depthL = fkL ? fkL->depth : 0;
+        const size_t depthR = fkR ? fkR->depth : 0;
 
-template <bool ascending, SelectSide side>
-struct LessFilesize
-{
-    bool operator()(const FileSystemObject::ObjectId& lhs, const FileSystemObject::ObjectId& rhs) const
-    {
-        const FileSystemObject* fsObjA = FileSystemObject::retrieve(lhs);
-        const FileSystemObject* fsObjB = FileSystemObject::retrieve(rhs);
-        if (!fsObjA) //invalid rows shall appear at the end
-            return false;
-        else if (!fsObjB)
-            return true;
+        for (size_t d = depthL; d > depthR; --d) fkL = fkL->parent;
+        for (size_t d = depthR; d > depthL; --d) fkR = fkR->parent;
 
-        return lessFilesize<ascending, side>(*fsObjA, *fsObjB);
-    }
-};
+        if (fkL == fkR) //one folder path is a prefix of the other
+        {
+            if (depthL != depthR)
+                return depthL < depthR;
+
+            //same parent folder: make folders always appear before contained files
+            if (rhs.isFolder)
+                return false;
+            else if (lhs.isFolder)
+                return true;
+
+            return ascending ? lhs.nameKey < rhs.nameKey : rhs.nameKey < lhs.nameKey;
+        }
+
+        //find first differing components
+        while (fkL->parent != fkR->parent)
+        {
+            fkL = fkL->parent;
+            fkR = fkR->parent;
+        }
+
+        if (fkL->nameKey != fkR->nameKey)
+            return ascending ? fkL->nameKey < fkR->nameKey : fkR->nameKey < fkL->nameKey;
 
+        /*...with equivalent names:
+            1. functional correctness => must not compare equal!  e.g. a/a/x and a/A/y
+            2. ensure stable sort order                                                            */
+        return fkL->folder < fkR->folder;
+    });
 
-template <bool ascending, SelectSide side>
-struct LessFiletime
+    for (size_t i = 0; i < keys.size(); ++i)
+        rows[i] = keys[i].objId;
+}
+
+
+template <bool ascending> inline
+bool lessCmpResult(const FileSystemObject& lhs, const FileSystemObject& rhs)
 {
-    bool operator()(const FileSystemObject::ObjectId& lhs, const FileSystemObject::ObjectId& rhs) const
+    return zen::makeSortDirection([](CompareFileResult lhs2, CompareFileResult rhs2)
     {
-        const FileSystemObject* fsObjA = FileSystemObject::retrieve(lhs);
-        const FileSystemObject* fsObjB = FileSystemObject::retrieve(rhs);
-        if (!fsObjA) //invalid rows shall appear at the end
+        //presort: equal shall appear at end of list
+        if (lhs2 == FILE_EQUAL)
             return false;
-        else if (!fsObjB)
+        if (rhs2 == FILE_EQUAL)
             return true;
+        return lhs2 < rhs2;
+    },
+    std::bool_constant<ascending>())(lhs.getCategory(), rhs.getCategory());
+}
 
-        return lessFiletime<ascending, side>(*fsObjA, *fsObjB);
-    }
-};
+
+template <bool ascending> inline
+bool lessSyncDirection(const FileSystemObject& lhs, const FileSystemObject& rhs)
+{
+    return zen::makeSortDirection(std::less(), std::bool_constant<ascending>())(lhs.getSyncOperation(), rhs.getSyncOperation());
+}
 
 
-template <bool ascending, SelectSide side>
-struct LessExtension
+std::unordered_map<const void* /*BaseFolderPair*/, size_t /*position*/>
+getBasePositions(std::vector<std::tuple<const void* /*BaseFolderPair*/, AbstractPath, AbstractPath>> folderPairs, std::optional<SelectSide> sortByName)
 {
-    bool operator()(const FileSystemObject::ObjectId& lhs, const FileSystemObject::ObjectId& rhs) const
+    if (sortByName) //calculate positions of base folders sorted by name
+        std::sort(folderPairs.begin(), folderPairs.end(), [side = *sortByName](const auto& a, const auto& b)
     {
-        const FileSystemObject* fsObjA = FileSystemObject::retrieve(lhs);
-        const FileSystemObject* fsObjB = FileSystemObject::retrieve(rhs);
-        if (!fsObjA) //invalid rows shall appear at the end
-            return false;
-        else if (!fsObjB)
-            return true;
+        const auto& [baseObjA, basePathLA, basePathRA] = a;
+        const auto& [baseObjB, basePathLB, basePathRB] = b;
 
-        return lessExtension<ascending, side>(*fsObjA, *fsObjB);
-    }
-};
+        const AbstractPath& basePathA = side == SelectSide::left ? basePathLA : basePathRA;
+        const AbstractPath& basePathB = side == SelectSide::left ? basePathLB : basePathRB;
+
+        return LessNaturalSort()/*even on Linux*/(zen::utfTo<Zstring>(AFS::getDisplayPath(basePathA)),
+                                                  zen::utfTo<Zstring>(AFS::getDisplayPath(basePathB)));
+    });
+    //else: take over positions of base folders as set up by user
+
+    std::unordered_map<const void*, size_t> sortedPos;
+    size_t pos = 0;
+    for (const auto& [baseObj, basePathL, basePathR] : folderPairs)
+        sortedPos.emplace(baseObj, pos++);
+    return sortedPos;
+}
 
 
 template <bool ascending>
@@ -783,6 +858,7 @@ void FileView::sortView(ColumnTypeRim type, ItemPathFormat pathFmt, bool onLeft,
     groupDetails_          .clear();
     rowPositions_          .clear();
     rowPositionsFirstChild_.clear();
+    clearCategoryCache();
     currentSort_ = SortInfo({type, onLeft, ascending});
 
     switch (type)
@@ -791,43 +867,31 @@ void FileView::sortView(ColumnTypeRim type, ItemPathFormat pathFmt, bool onLeft,
             switch (pathFmt)
             {
                 case ItemPathFormat::name:
-                    if      ( ascending &&  onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFileName<true,   SelectSide::left>());
-                    else if ( ascending && !onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFileName<true,  SelectSide::right>());
-                    else if (!ascending &&  onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFileName<false,  SelectSide::left>());
-                    else if (!ascending && !onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFileName<false, SelectSide::right>());
+                    if (onLeft) sortByFileName<SelectSide::left >(sortedRef_, ascending);
+                    else        sortByFileName<SelectSide::right>(sortedRef_, ascending);
                     break;
 
                 case ItemPathFormat::relative:
-                    if      ( ascending) std::sort(sortedRef_.begin(), sortedRef_.end(), LessRelativeFolder<true >(folderPairs_));
-                    else if (!ascending) std::sort(sortedRef_.begin(), sortedRef_.end(), LessRelativeFolder<false>(folderPairs_));
+                    sortByFilePath(sortedRef_, ascending, getBasePositions(folderPairs_, std::nullopt));
                     break;
 
                 case ItemPathFormat::full:
-                    if      ( ascending &&  onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFullPath<true,   SelectSide::left>(folderPairs_));
-                    else if ( ascending && !onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFullPath<true,  SelectSide::right>(folderPairs_));
-                    else if (!ascending &&  onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFullPath<false,  SelectSide::left>(folderPairs_));
-                    else if (!ascending && !onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFullPath<false, SelectSide::right>(folderPairs_));
+                    sortByFilePath(sortedRef_, ascending, getBasePositions(folderPairs_, onLeft ? SelectSide::left : SelectSide::right));
                     break;
             }
             break;
 
         case ColumnTypeRim::size:
-            if      ( ascending &&  onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFilesize<true,   SelectSide::left>());
-            else if ( ascending && !onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFilesize<true,  SelectSide::right>());
-            else if (!ascending &&  onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFilesize<false,  SelectSide::left>());
-            else if (!ascending && !onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFilesize<false, SelectSide::right>());
+            if (onLeft) sortByFileSize<SelectSide::left >(sortedRef_, ascending);
+            else        sortByFileSize<SelectSide::right>(sortedRef_, ascending);
             break;
         case ColumnTypeRim::date:
-            if      ( ascending &&  onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFiletime<true,   SelectSide::left>());
-            else if ( ascending && !onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFiletime<true,  SelectSide::right>());
-            else if (!ascending &&  onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFiletime<false,  SelectSide::left>());
-            else if (!ascending && !onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFiletime<false, SelectSide::right>());
+            if (onLeft) sortByFileTime<SelectSide::left >(sortedRef_, ascending);
+            else        sortByFileTime<SelectSide::right>(sortedRef_, ascending);
             break;
         case ColumnTypeRim::extension:
-            if      ( ascending &&  onLeft) std::stable_sort(sortedRef_.begin(), sortedRef_.end(), LessExtension<true,   SelectSide::left>());
-            else if ( ascending && !onLeft) std::stable_sort(sortedRef_.begin(), sortedRef_.end(), LessExtension<true,  SelectSide::right>());
-            else if (!ascending &&  onLeft) std::stable_sort(sortedRef_.begin(), sortedRef_.end(), LessExtension<false,  SelectSide::left>());
-            else if (!ascending && !onLeft) std::stable_sort(sortedRef_.begin(), sortedRef_.end(), LessExtension<false, SelectSide::right>());
+            if (onLeft) sortByExtension<SelectSide::left >(sortedRef_, ascending);
+            else        sortByExtension<SelectSide::right>(sortedRef_, ascending);
             break;
     }
 }
@@ -839,6 +903,7 @@ void FileView::sortView(ColumnTypeCenter type, bool ascending)
     groupDetails_          .clear();
     rowPositions_          .clear();
     rowPositionsFirstChild_.clear();
+    clearCategoryCache();
     currentSort_ = SortInfo({type, false, ascending});
 
     switch (type)
@@ -14,6 +14,7 @@
 #include <zen/stl_tools.h>
 #include "file_grid_attr.h"
 #include "../base/file_hierarchy.h"
+#include "../base/memory_stats.h"
 
 
 namespace fff
@@ -27,6 +28,8 @@ public:
     size_t rowsOnView() const { return viewRef_  .size(); } //only visible elements
     size_t rowsTotal () const { return sortedRef_.size(); } //total rows available
 
+    uint64_t getViewUpdateId() const { return viewUpdateId_; } //changes after each view update; 0 if not yet updated
+
     //returns nullptr if object is not found; complexity: constant!
     const FileSystemObject* getFsObject(size_t row) const { return row < viewRef_.size() ? FileSystemObject::retrieve(viewRef_[row].objId) : nullptr; }
     /**/  FileSystemObject* getFsObject(size_t row)       { return const_cast<FileSystemObject*>(static_cast<const FileView&>(*this).getFsObject(row)); } //see Meyers Effective C++
@@ -129,10 +132,34 @@ private:
     FileView           (const FileView&) = delete;
     FileView& operator=(const FileView&) = delete;
 
-    template <class Predicate> void updateView(Predicate pred);
+    void updateView(const std::vector<uint64_t>& rowsOnView /*bitset on sortedRef_*/);
+
+    //rows of sortedRef_ per category (= CompareFileResult or SyncOperation) and exclusion state:
+    //=> switching view filters is a mere merge of bitsets, as long as the comparison result is unchanged
+    struct CategoryRows
+    {
+        std::vector<uint64_t> rowBits; //bitset on sortedRef_
+        int rowCount = 0;
+        FileStats fileStatsLeft;
+        FileStats fileStatsRight;
+    };
+    struct CategoryCache
+    {
+        std::vector<CategoryRows> rows; //[2 * category + excluded]; empty if not yet calculated
+        uint64_t changeId = 0; //ContainerObject::getLastChangeId() at the time of calculation
+    };
+    template <class GetCategory>
+    const std::vector<CategoryRows>& getCategoryRows(CategoryCache& cache, size_t categoryCount, GetCategory getCategory);
+
+    void clearCategoryCache() { diffCategories_.rows.clear(); actionCategories_.rows.clear(); } //call after any change of sortedRef_
 
+    void updateMemoryUsage(); //call after any change of the buffers below
 
-    std::unordered_map<FileSystemObject::ObjectIdConst, size_t> rowPositions_; //find row positions on viewRef_ directly
+    CategoryCache diffCategories_;
+    CategoryCache actionCategories_;
+
+
+    std::unordered_map<FileSystemObject::ObjectIdConst, size_t, FileSystemObject::ObjectIdConst::Hash> rowPositions_; //find row positions on viewRef_ directly
     std::unordered_map<const void* /*ContainerObject*/, size_t> rowPositionsFirstChild_; //find first child on sortedRef of a hierarchy object
     //void* instead of ContainerObject*: these are weak pointers and should *never be dereferenced*!
 
@@ -160,6 +187,8 @@ private:
     std::vector<std::tuple<const void* /*BaseFolderPair*/, AbstractPath, AbstractPath>> folderPairs_;
 
     std::optional<SortInfo> currentSort_;
+
+    MemoryUsageTracker memoryUsage_{MemoryCategory::viewIndex};
 };
 }
 
@@ -321,6 +321,7 @@ void StatusHandlerTemporaryPanel::forceUiUpdateNoThrow()
         showStatsPanel();
 
     mainDlg_.compareStatus_->updateGui();
+    errorLogMemory_.update(errorLog_);
 }
 
 
@@ -709,4 +710,5 @@ void StatusHandlerFloatingDialog::updateDataProcessed(int itemsDelta, int64_t by
 void StatusHandlerFloatingDialog::forceUiUpdateNoThrow()
 {
     progressDlg_->updateGui();
+    errorLogMemory_.update(errorLog_);
 }
@@ -52,6 +52,7 @@ private:
 
     MainDialog& mainDlg_;
     zen::ErrorLog errorLog_;
+    ErrorLogMemoryTracker errorLogMemory_;
     const bool ignoreErrors_;
     const size_t autoRetryCount_;
     const std::chrono::seconds autoRetryDelay_;
@@ -116,6 +117,7 @@ private:
     const Zstring soundFileAlertPending_;
     SyncProgressDialog* progressDlg_; //managed to have the same lifetime as this handler!
     zen::ErrorLog errorLog_;
+    ErrorLogMemoryTracker errorLogMemory_;
 };
 }
 
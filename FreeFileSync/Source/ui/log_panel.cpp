@@ -55,9 +55,34 @@ enum class ColumnTypeLog
 class fff::MessageView
 {
 public:
-    MessageView(const SharedRef<const ErrorLog>& log) : log_(log) {}
+    MessageView(const SharedRef<const ErrorLog>& log) : log_(log)
+    {
+        //index message lines once: filtering and row lookup don't need to rescan the log (=> batch jobs with 100'000s of infos)
+        infoCount_   .push_back(0);
+        warningCount_.push_back(0);
+
+        const ErrorLog& errorLog = log_.ref();
+        for (size_t logIdx = 0; logIdx < errorLog.size(); ++logIdx)
+        {
+            const LogEntry& entry = errorLog[logIdx];
+            assert(!startsWith(entry.message, '\n'));
+
+            for (auto it = entry.message.begin(); it != entry.message.end();)
+            {
+                auto itEnd = std::find(it, entry.message.end(), '\n');
+                if (itEnd != it) //do not reference empty lines!
+                {
+                    lines_.push_back({static_cast<uint32_t>(logIdx), static_cast<uint32_t>(it - entry.message.begin())});
+                    infoCount_   .push_back(infoCount_   .back() + (entry.type == MSG_TYPE_INFO    ? 1 : 0));
+                    warningCount_.push_back(warningCount_.back() + (entry.type == MSG_TYPE_WARNING ? 1 : 0));
+                }
+                it = itEnd == entry.message.end() ? itEnd : itEnd + 1; //skip newline
+            }
+        }
+        assert(errorLog.size() <= std::numeric_limits<uint32_t>::max());
+    }
 
-    size_t rowsOnView() const { return viewRef_.size(); }
+    size_t rowsOnView() const { return rowCount_; }
 
     struct LogEntryView
     {
@@ -69,15 +94,29 @@ public:
 
     std::optional<LogEntryView> getEntry(size_t row) const
     {
-        if (row < viewRef_.size())
+        if (row < rowCount_)
         {
-            const Line& line = viewRef_[row];
+            //find first line with countLinesOnView(lineIdx + 1) > row: O(log n) per visible row
+            size_t first = 0;
+            size_t last = lines_.size();
+            while (first < last)
+            {
+                const size_t mid = first + (last - first) / 2;
+                if (countLinesOnView(mid + 1) <= row)
+                    first = mid + 1;
+                else
+                    last = mid;
+            }
+            assert(first < lines_.size());
+
+            const Line& line = lines_[first];
+            const LogEntry& entry = log_.ref()[line.logIdx];
 
             LogEntryView output;
-            output.time = line.logIt->time;
-            output.type = line.logIt->type;
-            output.messageLine = extractLine(line.logIt->message, line.row);
-            output.firstLine = line.row == 0; //this is virtually always correct, unless first line of the original message is empty!
+            output.time = entry.time;
+            output.type = entry.type;
+            output.messageLine = extractLine(entry.message, line.offset);
+            output.firstLine = line.offset == 0; //this is virtually always correct, unless first line of the original message is empty!
             return output;
         }
         return {};
@@ -85,59 +124,43 @@ public:
 
     void updateView(int includedTypes) //MSG_TYPE_INFO | MSG_TYPE_WARNING, etc. see error_log.h
     {
-        viewRef_.clear();
-
-        for (auto it = log_.ref().begin(); it != log_.ref().end(); ++it)
-            if (it->type & includedTypes)
-            {
-                assert(!startsWith(it->message, '\n'));
-
-                size_t rowNumber = 0;
-                bool lastCharNewline = true;
-                for (const char c : it->message)
-                    if (c == '\n')
-                    {
-                        if (!lastCharNewline) //do not reference empty lines!
-                            viewRef_.push_back({it, rowNumber});
-                        ++rowNumber;
-                        lastCharNewline = true;
-                    }
-                    else
-                        lastCharNewline = false;
-
-                if (!lastCharNewline)
-                    viewRef_.push_back({it, rowNumber});
-            }
+        includedTypes_ = includedTypes;
+        rowCount_ = countLinesOnView(lines_.size());
     }
 
 private:
-    static std::string_view extractLine(const Zstringc& message, size_t textRow)
+    //number of lines in [0, lineEnd) matching includedTypes_
+    size_t countLinesOnView(size_t lineEnd) const
     {
-        auto it1 = message.begin();
-        for (;;)
-        {
-            auto it2 = std::find_if(it1, message.end(), [](char c) { return c == '\n'; });
-            if (textRow == 0)
-                return makeStringView(it1, it2 - it1);
-
-            if (it2 == message.end())
-            {
-                assert(false);
-                return makeStringView(it1, 0);
-            }
+        size_t count = 0;
+        if (includedTypes_ & MSG_TYPE_INFO)
+            count += infoCount_[lineEnd];
+        if (includedTypes_ & MSG_TYPE_WARNING)
+            count += warningCount_[lineEnd];
+        if (includedTypes_ & MSG_TYPE_ERROR)
+            count += lineEnd - infoCount_[lineEnd] - warningCount_[lineEnd];
+        return count;
+    }
 
-            it1 = it2 + 1; //skip newline
-            --textRow;
-        }
+    static std::string_view extractLine(const Zstringc& message, size_t offset)
+    {
+        auto it1 = message.begin() + offset;
+        auto it2 = std::find(it1, message.end(), '\n');
+        return makeStringView(it1, it2 - it1);
     }
 
     struct Line
     {
-        ErrorLog::const_iterator logIt; //always bound!
-        size_t row; //LogEntry::message may span multiple rows
+        uint32_t logIdx; //index into log_
+        uint32_t offset; //LogEntry::message may span multiple rows: start of this line
     };
 
-    std::vector<Line> viewRef_; //partial view on log_
+    std::vector<Line> lines_; //all non-empty message lines of log_
+    std::vector<uint32_t> infoCount_;    //prefix count of info/warning lines: [0, lineEnd) for lineEnd in [0, lines_.size()]
+    std::vector<uint32_t> warningCount_; //error count follows from the remainder
+
+    int includedTypes_ = 0;
+    size_t rowCount_ = 0;
     /*          /|\
                  | updateView()
                  |                      */
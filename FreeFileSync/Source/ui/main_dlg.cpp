@@ -13,6 +13,7 @@
 #include <zen/perf.h>
 #include <zen/shutdown.h>
 #include <zen/resolve_path.h>
+#include <zen/time.h>
 #include <wx/clipbrd.h>
 #include <wx/wupdlock.h>
 #include <wx/sound.h>
@@ -41,6 +42,7 @@
 #include "app_icon.h"
 #include "../afs/concrete.h"
 #include "../afs/native.h"
+#include "../base/cmp_result_file.h"
 #include "../base/comparison.h"
 #include "../base/synchronization.h"
 #include "../base/algorithm.h"
@@ -62,6 +64,8 @@ const size_t EXT_APP_MAX_TOTAL_WAIT_TIME_MS = 1000;
 
 const int TOP_BUTTON_OPTIMAL_WIDTH_DIP = 170;
 constexpr std::chrono::milliseconds LAST_USED_CFG_EXISTENCE_CHECK_TIME_MAX(500);
+const size_t CFG_HISTORY_EXISTENCE_CHECK_THREADS = 16; //config history may contain hundreds of items: don't start a thread for each
+constexpr std::chrono::seconds CFG_HISTORY_EXISTENCE_CHECK_TIME_MAX(30); //keep items whose existence could not be confirmed by then
 constexpr std::chrono::milliseconds FILE_GRID_POST_UPDATE_DELAY(400);
 
 const Zchar macroNameItemPath   [] = Zstr("%item_path%");
@@ -107,7 +111,8 @@ bool acceptDialogFileDrop(const std::vector<Zstring>& shellItemPaths)
     {
         const Zstring ext = getFileExtension(shellItemPath);
         return equalAsciiNoCase(ext, "ffs_gui") ||
-               equalAsciiNoCase(ext, "ffs_batch");
+               equalAsciiNoCase(ext, "ffs_batch") ||
+               equalAsciiNoCase(ext, "ffs_cmp");
     });
 }
 
@@ -1277,12 +1282,10 @@ void MainDialog::setSyncDirManually(const std::vector<FileSystemObject*>& select
     if (!selectionIncludesNonEqualItem(selection))
         return; //harmonize with onGridContextRim(): this function should be a no-op iff context menu option is disabled!
 
-    for (FileSystemObject* fsObj : selection)
-    {
-        setSyncDirectionRec(direction, *fsObj); //set new direction (recursively)
-        setActiveStatus(true, *fsObj); //works recursively for directories
-    }
-    updateGui();
+    setSyncDirectionRec(direction, selection); //set new direction (recursively)
+    setActiveStatus(true, selection); //works recursively for directories
+
+    updateGui(); //single refresh for the whole selection
 }
 
 
@@ -1294,8 +1297,7 @@ void MainDialog::setIncludedManually(const std::vector<FileSystemObject*>& selec
     if (selection.empty())
         return; //harmonize with onGridContextRim(): this function should be a no-op iff context menu option is disabled!
 
-    for (FileSystemObject* fsObj : selection)
-        setActiveStatus(setActive, *fsObj); //works recursively for directories
+    setActiveStatus(setActive, selection); //works recursively for directories
 
     updateGuiDelayedIf(!m_bpButtonShowExcluded->isActive()); //show update GUI before removing rows
 }
@@ -1377,15 +1379,25 @@ void MainDialog::copyPathsToClipboard(const std::vector<FileSystemObject*>& sele
 
 std::vector<FileSystemObject*> MainDialog::getGridSelection(bool fromLeft, bool fromRight) const
 {
-    std::vector<size_t> selectedRows;
+    //merge selection ranges of both grids: O(ranges) instead of sorting and deduplicating millions of row indexes
+    std::vector<std::pair<size_t, size_t>> selectedRanges;
 
     if (fromLeft)
-        append(selectedRows, m_gridMainL->getSelectedRows());
+        append(selectedRanges, m_gridMainL->getSelectedRanges());
 
     if (fromRight)
-        append(selectedRows, m_gridMainR->getSelectedRows());
+        append(selectedRanges, m_gridMainR->getSelectedRanges());
+
+    std::sort(selectedRanges.begin(), selectedRanges.end());
 
-    removeDuplicates(selectedRows);
+    std::vector<size_t> selectedRows;
+    size_t rowNext = 0;
+    for (const auto& [rowFirst, rowLast] : selectedRanges)
+    {
+        for (size_t row = std::max(rowFirst, rowNext); row < rowLast; ++row)
+            selectedRows.push_back(row);
+        rowNext = std::max(rowNext, rowLast);
+    }
     assert(std::is_sorted(selectedRows.begin(), selectedRows.end()));
 
     return filegrid::getDataView(*m_gridMainC).getAllFileRef(selectedRows);
@@ -1455,6 +1467,7 @@ void MainDialog::copyToAlternateFolder(const std::vector<FileSystemObject*>& sel
                                    globalCfg_.mainDlg.copyToCfg.targetFolderPath,
                                    globalCfg_.mainDlg.copyToCfg.keepRelPaths,
                                    globalCfg_.mainDlg.copyToCfg.overwriteIfExists,
+                                   guiCfg.mainCfg.deviceParallelOps,
                                    globalCfg_.warnDlgs,
                                    statusHandler); //throw AbortProcess
 
@@ -1501,6 +1514,7 @@ void MainDialog::deleteSelectedFiles(const std::vector<FileSystemObject*>& selec
         deleteFromGridAndHD(selectionL, selectionR,
                             extractDirectionCfg(folderCmp_, getConfig().mainCfg),
                             moveToRecycler,
+                            guiCfg.mainCfg.deviceParallelOps,
                             globalCfg_.warnDlgs.warnRecyclerMissing,
                             statusHandler); //throw AbortProcess
     }
@@ -1732,7 +1746,7 @@ void MainDialog::openExternalApplication(const Zstring& commandLinePhrase, bool
                                                           globalCfg_.soundFileAlertPending);
                 try
                 {
-                    tempFileBuf_.createTempFiles(nonNativeFiles, statusHandler); //throw AbortProcess
+                    tempFileBuf_.createTempFiles(nonNativeFiles, guiCfg.mainCfg.deviceParallelOps, statusHandler); //throw AbortProcess
                     //"clearSelection" not needed/desired
                 }
                 catch (AbortProcess&) {}
@@ -1986,6 +2000,12 @@ void MainDialog::onResizeLeftFolderWidth(wxEvent& event)
 
 void MainDialog::onTreeKeyEvent(wxKeyEvent& event)
 {
+    if (operationInProgress_) //progressive display during comparison: view only => navigation keys only
+    {
+        event.Skip();
+        return;
+    }
+
     const std::vector<FileSystemObject*> selection = getTreeSelection();
 
     int keyCode = event.GetKeyCode();
@@ -2055,6 +2075,12 @@ void MainDialog::onTreeKeyEvent(wxKeyEvent& event)
 
 void MainDialog::onGridKeyEvent(wxKeyEvent& event, Grid& grid, bool leftSide)
 {
+    if (operationInProgress_) //progressive display during comparison: view only => navigation keys only
+    {
+        event.Skip();
+        return;
+    }
+
     const std::vector<FileSystemObject*> selection  = getGridSelection();
     const std::vector<FileSystemObject*> selectionL = getGridSelection(true, false);
     const std::vector<FileSystemObject*> selectionR = getGridSelection(false, true);
@@ -2321,6 +2347,9 @@ void MainDialog::onTreeGridSelection(GridSelectEvent& event)
 
 void MainDialog::onTreeGridContext(GridContextMenuEvent& event)
 {
+    if (operationInProgress_) //progressive display during comparison: view only
+        return;
+
     const std::vector<FileSystemObject*>& selection = getTreeSelection(); //referenced by lambdas!
     ContextMenu menu;
 
@@ -2425,6 +2454,9 @@ void MainDialog::onTreeGridContext(GridContextMenuEvent& event)
 
 void MainDialog::onGridContextRim(GridContextMenuEvent& event, bool leftSide)
 {
+    if (operationInProgress_) //progressive display during comparison: view only
+        return;
+
     const std::vector<FileSystemObject*> selection  = getGridSelection(); //referenced by lambdas!
     const std::vector<FileSystemObject*> selectionL = getGridSelection(true, false);
     const std::vector<FileSystemObject*> selectionR = getGridSelection(false, true);
@@ -2437,6 +2469,9 @@ void MainDialog::onGridContextRim(GridContextMenuEvent& event, bool leftSide)
 
 void MainDialog::onGridGroupContextRim(GridClickEvent& event, bool leftSide)
 {
+    if (operationInProgress_) //progressive display during comparison: view only
+        return;
+
     if (static_cast<HoverAreaGroup>(event.hoverArea_) == HoverAreaGroup::groupName)
         if (const FileView::PathDrawInfo pdi = filegrid::getDataView(*m_gridMainC).getDrawInfo(event.row_);
             pdi.folderGroupObj)
@@ -2964,27 +2999,50 @@ void MainDialog::onDirManualCorrection(wxCommandEvent& event)
 
 void MainDialog::cfgHistoryRemoveObsolete(const std::vector<Zstring>& filePaths)
 {
-    auto getUnavailableCfgFilesAsync = [filePaths] //don't use wxString: NOT thread-safe! (e.g. non-atomic ref-count)
+    //check existence of all config files in parallel!
+    ThreadGroup<std::packaged_task<bool()>> threadGroup(CFG_HISTORY_EXISTENCE_CHECK_THREADS, Zstr("Cfg Existence"));
+    threadGroup.detach(); //don't wait on threads hanging on inaccessible network shares: remaining tasks are still processed after ~ThreadGroup()
+
+    auto pendingChecks = std::make_shared<CfgExistenceChecks>();
+
+    for (const Zstring& filePath : filePaths)
     {
-        std::vector<std::future<bool>> availableFiles; //check existence of all config files in parallel!
+        std::packaged_task<bool()> pt([filePath] { return fileAvailable(filePath); });
+        pendingChecks->emplace_back(filePath, pt.get_future());
+        threadGroup.run(std::move(pt));
+    }
 
-        for (const Zstring& filePath : filePaths)
-            availableFiles.push_back(runAsync([=] { return fileAvailable(filePath); }));
+    cfgHistoryRemoveObsoleteAsync(pendingChecks, std::chrono::steady_clock::now() + CFG_HISTORY_EXISTENCE_CHECK_TIME_MAX);
+}
 
-        //potentially slow network access => limit maximum wait time!
-        waitForAllTimed(availableFiles.begin(), availableFiles.end(), std::chrono::seconds(1));
+
+void MainDialog::cfgHistoryRemoveObsoleteAsync(const std::shared_ptr<CfgExistenceChecks>& pendingChecks, std::chrono::steady_clock::time_point stopTime)
+{
+    //pendingChecks: accessed either by async thread or GUI thread, never concurrently
+    auto getUnavailableCfgFilesAsync = [pendingChecks] //don't use wxString: NOT thread-safe! (e.g. non-atomic ref-count)
+    {
+        //potentially slow network access => update config grid with intermediate results
+        const auto waitUntil = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+        for (auto& [filePath, ftAvailable] : *pendingChecks)
+            if (ftAvailable.wait_until(waitUntil) == std::future_status::timeout)
+                break;
 
         std::vector<Zstring> pathsToRemove;
 
-        auto itFut = availableFiles.begin();
-        for (auto it = filePaths.begin(); it != filePaths.end(); ++it, ++itFut)
-            if (isReady(*itFut) && !itFut->get()) //remove only files that are confirmed to be non-existent
-                pathsToRemove.push_back(*it); //file access error? probably not accessible network share or usb stick => remove cfg
+        std::erase_if(*pendingChecks, [&](auto& item)
+        {
+            auto& [filePath, ftAvailable] = item;
+            if (!isReady(ftAvailable))
+                return false;
 
+            if (!ftAvailable.get()) //remove only files that are confirmed to be non-existent
+                pathsToRemove.push_back(filePath); //file access error? probably not accessible network share or usb stick => remove cfg
+            return true;
+        });
         return pathsToRemove;
     };
 
-    guiQueue_.processAsync(getUnavailableCfgFilesAsync, [this](const std::vector<Zstring>& filePaths2)
+    guiQueue_.processAsync(getUnavailableCfgFilesAsync, [this, pendingChecks, stopTime](const std::vector<Zstring>& filePaths2)
     {
         if (!filePaths2.empty())
         {
@@ -2993,6 +3051,9 @@ void MainDialog::cfgHistoryRemoveObsolete(const std::vector<Zstring>& filePaths)
             //restore grid selection (after rows were removed)
             cfggrid::addAndSelect(*m_gridCfgHistory, activeConfigFiles_, false /*scrollToSelection*/);
         }
+
+        if (!pendingChecks->empty() && std::chrono::steady_clock::now() < stopTime)
+            cfgHistoryRemoveObsoleteAsync(pendingChecks, stopTime);
     });
 }
 
@@ -3297,7 +3358,8 @@ void MainDialog::onConfigLoad(wxCommandEvent& event)
     std::optional<Zstring> defaultFolderPath = getParentFolderPath(globalCfg_.mainDlg.config.lastSelectedFile);
 
     wxFileDialog fileSelector(this, wxString() /*message*/,  utfTo<wxString>(defaultFolderPath ? *defaultFolderPath : Zstr("")), wxString() /*default file name*/,
-                              wxString(L"FreeFileSync (*.ffs_gui; *.ffs_batch)|*.ffs_gui;*.ffs_batch") + L"|" +_("All files") + L" (*.*)|*",
+                              wxString(L"FreeFileSync (*.ffs_gui; *.ffs_batch)|*.ffs_gui;*.ffs_batch") + L"|" +
+                              _("Comparison result") + L" (*.ffs_cmp)|*.ffs_cmp" + L"|" +_("All files") + L" (*.*)|*",
                               wxFD_OPEN | wxFD_MULTIPLE);
     if (fileSelector.ShowModal() != wxID_OK)
         return;
@@ -3363,6 +3425,9 @@ void MainDialog::onConfigNew(wxCommandEvent& event)
 
 bool MainDialog::loadConfiguration(const std::vector<Zstring>& filePaths, bool ignoreBrokenConfig) //"false": error/cancel
 {
+    if (filePaths.size() == 1 && endsWith(filePaths[0], CMP_RESULT_FILE_ENDING))
+        return loadComparisonResultFile(filePaths[0]);
+
     XmlGuiConfig newGuiCfg = getDefaultGuiConfig(globalCfg_.defaultFilter);
     std::wstring warningMsg;
 
@@ -3395,6 +3460,45 @@ bool MainDialog::loadConfiguration(const std::vector<Zstring>& filePaths, bool i
 }
 
 
+bool MainDialog::loadComparisonResultFile(const Zstring& filePath) //"false": error/cancel
+{
+    ComparisonResultFile cmpResult;
+    try
+    {
+        cmpResult = loadComparisonResult(filePath); //throw FileError
+    }
+    catch (const FileError& e)
+    {
+        showNotificationDialog(this, DialogInfoType::error, PopupDialogCfg().setDetailInstructions(e.toString()));
+        return false;
+    }
+
+    if (!loadConfiguration({cmpResult.cfgFilePath})) //=> error/cancel; clears grid
+        return false;
+
+    //sync direction config and folder pairs must match the comparison result (e.g. extractDirectionCfg())
+    if (extractCompareCfg(getConfig().mainCfg).size() != cmpResult.folderCmp.size())
+    {
+        showNotificationDialog(this, DialogInfoType::error, PopupDialogCfg().setDetailInstructions(
+                                   replaceCpy(_("Configuration %x does not match the comparison result."), L"%x", fmtPath(cmpResult.cfgFilePath)) + L"\n" +
+                                   fmtPath(filePath)));
+        return false;
+    }
+
+    syncDirectionBuf_.clear(); //new folder pairs
+    folderCmp_ = std::move(cmpResult.folderCmp);
+    folderCmpFromFile_ = true;
+
+    filegrid::setData(*m_gridMainC,    folderCmp_); //update view on data
+    treegrid::setData(*m_gridOverview, folderCmp_); //
+    updateGui();
+
+    setStatusInfo(replaceCpy(_("Comparison result from %x"), L"%x",
+                             utfTo<std::wstring>(formatTime(formatDateTimeTag, getLocalTime(cmpResult.cmpTime)))), true /*highlight*/);
+    return true;
+}
+
+
 void MainDialog::removeSelectedCfgHistoryItems(bool deleteFromDisk)
 {
     const std::vector<size_t> selectedRows = m_gridCfgHistory->getSelectedRows();
@@ -3740,6 +3844,9 @@ void MainDialog::onCfgGridLabelLeftClick(GridLabelClickEvent& event)
 
 void MainDialog::onCheckRows(CheckRowsEvent& event)
 {
+    if (operationInProgress_) //progressive display during comparison: view only
+        return;
+
     std::vector<size_t> selectedRows;
 
     const size_t rowLast = std::min(event.rowLast_, filegrid::getDataView(*m_gridMainC).rowsOnView()); //consider dummy rows
@@ -3756,6 +3863,9 @@ void MainDialog::onCheckRows(CheckRowsEvent& event)
 
 void MainDialog::onSetSyncDirection(SyncDirectionEvent& event)
 {
+    if (operationInProgress_) //progressive display during comparison: view only
+        return;
+
     std::vector<size_t> selectedRows;
 
     const size_t rowLast = std::min(event.rowLast_, filegrid::getDataView(*m_gridMainC).rowsOnView()); //consider dummy rows
@@ -4135,6 +4245,7 @@ void MainDialog::onCompare(wxCommandEvent& event)
     const auto& guiCfg = getConfig();
 
     const std::vector<FolderPairCfg>& fpCfgList = extractCompareCfg(guiCfg.mainCfg);
+    bool progressiveView = false;
 
     //handle status display and error messages
     StatusHandlerTemporaryPanel statusHandler(*this, std::chrono::system_clock::now(),
@@ -4147,14 +4258,45 @@ void MainDialog::onCompare(wxCommandEvent& event)
         //GUI mode: place directory locks on directories isolated(!) during both comparison and synchronization
         std::unique_ptr<LockHolder> dirLocks;
 
+        //progressive display: show finished folder pairs while the rest is still being compared
+        FolderComparison folderCmpDone(fpCfgList.size()); //nullptr: not yet compared
+        auto onPairCompared = [&](size_t pairIdx, const std::shared_ptr<BaseFolderPair>& baseFolder)
+        {
+            folderCmpDone[pairIdx] = baseFolder;
+
+            FolderComparison folderCmpView;
+            for (const std::shared_ptr<BaseFolderPair>& baseFolderDone : folderCmpDone)
+                if (baseFolderDone)
+                    folderCmpView.push_back(baseFolderDone);
+
+            filegrid::setData(*m_gridMainC,    folderCmpView); //takes (shared) ownership
+            treegrid::setData(*m_gridOverview, folderCmpView); //
+            updateGridViewData();
+
+            //allow scrolling through the results so far: grid event handlers ignore modifications while operationInProgress_
+            m_panelCenter ->Enable();
+            m_gridOverview->Enable();
+            progressiveView = true;
+        };
+
         //COMPARE DIRECTORIES
+        syncDirectionBuf_.clear(); //new folder pairs, new database contents
+        folderCmpFromFile_ = false;
         folderCmp_ = compare(globalCfg_.warnDlgs,
                              globalCfg_.fileTimeTolerance,
+                             globalCfg_.contentCmpTrustDatabase,
+                             globalCfg_.timeSizeVerifyContent,
+                             globalCfg_.remoteScanTrustDatabase,
+                             globalCfg_.snapshotChangeDiscovery,
+                             false /*outOfCoreComparison: grid needs all rows*/,
                              true, //allowUserInteraction
                              globalCfg_.runWithBackgroundPriority,
                              globalCfg_.createLockFile,
                              dirLocks,
                              fpCfgList,
+                             guiCfg.mainCfg.deviceParallelOps,
+                             {} /*changedItemPaths*/,
+                             onPairCompared,
                              statusHandler); //throw AbortProcess
     }
     catch (AbortProcess&) {}
@@ -4165,8 +4307,15 @@ void MainDialog::onCompare(wxCommandEvent& event)
 
     setLastOperationLog(r.summary, r.errorLog.ptr());
 
+    if (progressiveView) //keep scroll position reached while reviewing
+        m_gridMainL->GetViewStart(&scrollPosX, &scrollPosY);
+
     if (r.summary.syncResult == SyncResult::aborted)
+    {
+        filegrid::setData(*m_gridMainC,    folderCmp_); //drop partial results of progressive display
+        treegrid::setData(*m_gridOverview, folderCmp_); //
         return updateGui(); //refresh grid in ANY case! (also on abort)
+    }
 
 
     filegrid::setData(*m_gridMainC,    folderCmp_); //update view on data
@@ -4202,7 +4351,7 @@ void MainDialog::onCompare(wxCommandEvent& event)
     //mark selected cfg files as "in sync" when there is nothing to do: https://freefilesync.org/forum/viewtopic.php?t=4991
     if (r.summary.syncResult == SyncResult::finishedSuccess)
     {
-        const SyncStatistics st(folderCmp_);
+        const SyncStatistics st = syncStatsBuf_.get(folderCmp_);
         if (st.createCount() +
             st.updateCount() +
             st.deleteCount() == 0)
@@ -4271,7 +4420,10 @@ void MainDialog::clearGrid(ptrdiff_t pos)
     }
 
     if (folderCmp_.empty())
+    {
         errorLogCmp_.reset();
+        folderCmpFromFile_ = false;
+    }
 
     filegrid::setData(*m_gridMainC,    folderCmp_);
     treegrid::setData(*m_gridOverview, folderCmp_);
@@ -4300,7 +4452,7 @@ void MainDialog::updateStatistics()
     };
 
     //update preview of item count and bytes to be transferred:
-    const SyncStatistics st(folderCmp_);
+    const SyncStatistics st = syncStatsBuf_.get(folderCmp_);
 
     setValue(*m_staticTextData, st.getBytesToProcess() == 0, formatFilesizeShort(st.getBytesToProcess()), *m_bitmapData, "data");
     setIntValue(*m_staticTextCreateLeft,  st.createCount<SelectSide::left >(), *m_bitmapCreateLeft,  "so_create_left_sicon");
@@ -4339,7 +4491,7 @@ void MainDialog::onStartSync(wxCommandEvent& event)
 {
     FocusPreserver fp; //e.g. keep focus on config panel after pressing F9
 
-    if (folderCmp_.empty())
+    if (folderCmp_.empty() || folderCmpFromFile_) //loaded comparison result: folders may have changed since, filter not recorded
     {
         //quick sync: simulate button click on "compare"
         wxCommandEvent dummy(wxEVT_COMMAND_BUTTON_CLICKED);
@@ -4358,7 +4510,7 @@ void MainDialog::onStartSync(wxCommandEvent& event)
 
         if (showSyncConfirmationDlg(this, false /*syncSelection*/,
                                     getSyncVariant(guiCfg.mainCfg),
-                                    SyncStatistics(folderCmp_),
+                                    syncStatsBuf_.get(folderCmp_),
                                     dontShowAgain) != ConfirmationButton::accept)
             return;
         globalCfg_.confirmDlgs.confirmSyncStart = !dontShowAgain;
@@ -4421,14 +4573,29 @@ void MainDialog::onStartSync(wxCommandEvent& event)
             }
 
             //START SYNCHRONIZATION
+            syncDirectionBuf_.clear(); //sync.ffs_db is updated
             synchronize(syncStartTime,
                         globalCfg_.verifyFileCopy,
                         globalCfg_.copyLockedFiles,
                         globalCfg_.copyFilePermissions,
                         globalCfg_.failSafeFileCopy,
+                        globalCfg_.syncDbJournal,
                         globalCfg_.runWithBackgroundPriority,
+                        globalCfg_.syncIoPriority,
+                        globalCfg_.dropPageCacheBehind,
+                        globalCfg_.flushTargetBuffers,
+                        static_cast<uint64_t>(std::max(globalCfg_.deltaCopyMinSizeMB, 0)) * 1024 * 1024,
+                        static_cast<uint64_t>(std::max(globalCfg_.resumableCopyMinSizeMB, 0)) * 1024 * 1024,
+                        globalCfg_.compressVersions,
                         extractSyncCfg(guiCfg.mainCfg),
                         folderCmp_,
+                        guiCfg.mainCfg.deviceParallelOps,
+                        globalCfg_.autoTuneParallelOps,
+                        globalCfg_.globalDeviceBudget,
+                        guiCfg.mainCfg.deviceBandwidthLimits,
+                        guiCfg.mainCfg.autoRetryCount,
+                        guiCfg.mainCfg.autoRetryDelay,
+                        globalCfg_.syncHistory,
                         globalCfg_.warnDlgs,
                         statusHandler); //throw AbortProcess
         }
@@ -4618,14 +4785,29 @@ void MainDialog::startSyncForSelecction(const std::vector<FileSystemObject*>& se
             //LockHolder? => let's go without; same behavior as manual deletion
 
             //START SYNCHRONIZATION
+            syncDirectionBuf_.clear(); //sync.ffs_db is updated
             synchronize(syncStartTime,
                         globalCfg_.verifyFileCopy,
                         globalCfg_.copyLockedFiles,
                         globalCfg_.copyFilePermissions,
                         globalCfg_.failSafeFileCopy,
+                        globalCfg_.syncDbJournal,
                         globalCfg_.runWithBackgroundPriority,
+                        globalCfg_.syncIoPriority,
+                        globalCfg_.dropPageCacheBehind,
+                        globalCfg_.flushTargetBuffers,
+                        static_cast<uint64_t>(std::max(globalCfg_.deltaCopyMinSizeMB, 0)) * 1024 * 1024,
+                        static_cast<uint64_t>(std::max(globalCfg_.resumableCopyMinSizeMB, 0)) * 1024 * 1024,
+                        globalCfg_.compressVersions,
                         fpCfgSelect,
                         folderCmpSelect,
+                        guiCfg.mainCfg.deviceParallelOps,
+                        globalCfg_.autoTuneParallelOps,
+                        globalCfg_.globalDeviceBudget,
+                        guiCfg.mainCfg.deviceBandwidthLimits,
+                        guiCfg.mainCfg.autoRetryCount,
+                        guiCfg.mainCfg.autoRetryDelay,
+                        globalCfg_.syncHistory,
                         globalCfg_.warnDlgs,
                         statusHandler); //throw AbortProcess
         }
@@ -4766,6 +4948,9 @@ void MainDialog::showLogPanel(bool show)
 
 void MainDialog::onGridDoubleClickRim(GridClickEvent& event, bool leftSide)
 {
+    if (operationInProgress_) //progressive display during comparison: view only
+        return;
+
     if (!globalCfg_.externalApps.empty())
     {
         std::vector<FileSystemObject*> selectionL;
@@ -4898,6 +5083,7 @@ void MainDialog::swapSides()
         try
         {
             statusHandler.initNewPhase(-1, -1, ProcessPhase::none);
+            syncDirectionBuf_.clear(); //database contents are for the old side assignment
             swapGrids(getConfig().mainCfg, folderCmp_,
                       statusHandler); //throw AbortProcess
         }
@@ -5144,7 +5330,7 @@ void MainDialog::applySyncDirections()
         {
             statusHandler.initNewPhase(-1, -1, ProcessPhase::none);
             redetermineSyncDirection(directCfgs,
-                                     statusHandler); //throw AbortProcess
+                                     &syncDirectionBuf_, statusHandler); //throw AbortProcess
         }
         catch (AbortProcess&) {}
 
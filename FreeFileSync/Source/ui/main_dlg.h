@@ -21,6 +21,7 @@
 #include "../config.h"
 #include "../status_handler.h"
 #include "../base/algorithm.h"
+#include "../base/synchronization.h"
 #include "../return_codes.h"
 
 
@@ -78,6 +79,7 @@ private:
     XmlGlobalSettings getGlobalCfgBeforeExit(); //destructive "get" thanks to "Iconize(false), Maximize(false)"
 
     bool loadConfiguration(const std::vector<Zstring>& filepaths, bool ignoreBrokenConfig = false); //"false": error/cancel
+    bool loadComparisonResultFile(const Zstring& filePath); //*.ffs_cmp saved by batch mode; "false": error/cancel
 
     bool trySaveConfig     (const Zstring* guiCfgPath);   //
     bool trySaveBatchConfig(const Zstring* batchCfgPath); //"false": error/cancel
@@ -88,6 +90,8 @@ private:
     void setViewFilterDefault();
 
     void cfgHistoryRemoveObsolete(const std::vector<Zstring>& filepaths);
+    using CfgExistenceChecks = std::vector<std::pair<Zstring, std::future<bool>>>;
+    void cfgHistoryRemoveObsoleteAsync(const std::shared_ptr<CfgExistenceChecks>& pendingChecks, std::chrono::steady_clock::time_point stopTime);
 
     void insertAddFolderPair(const std::vector<LocalPairConfig>& newPairs, size_t pos);
     void moveAddFolderPairUp(size_t pos);
@@ -308,7 +312,10 @@ private:
 
     //the prime data structure of this tool *bling*:
     FolderComparison folderCmp_; //optional!: sync button not available if empty
+    SyncStatisticsBuffer syncStatsBuf_; //statistics after sync direction changes: re-evaluate changed sub trees only
+    SyncDirectionBuffer syncDirectionBuf_; //sync.ffs_db contents + last sync direction config per folder pair
     std::shared_ptr<const zen::ErrorLog> errorLogCmp_;
+    bool folderCmpFromFile_ = false; //folderCmp_ loaded from *.ffs_cmp: view only => compare again before sync
 
     //folder pairs:
     std::unique_ptr<FolderPairFirst> firstFolderPair_; //always bound!!!
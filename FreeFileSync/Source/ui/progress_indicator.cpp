@@ -43,8 +43,10 @@ constexpr std::chrono::seconds PERF_WINDOW_REMAINING_TIME(60); //USB memory stic
 constexpr std::chrono::seconds      SPEED_ESTIMATE_SAMPLE_SKIP(1);
 constexpr std::chrono::milliseconds SPEED_ESTIMATE_UPDATE_INTERVAL(500);
 constexpr std::chrono::seconds      GRAPH_TOTAL_TIME_UPDATE_INTERVAL(2);
+constexpr std::chrono::seconds      MINIMIZED_UPDATE_INTERVAL(2); //systray tooltip, taskbar caption
 
-const size_t PROGRESS_GRAPH_SAMPLE_SIZE_MAX = 2'500'000; //sizeof(CurveDataStatistics::Sample) == 16 byte key/value
+const size_t PROGRESS_GRAPH_SAMPLE_SIZE_MAX = 100'000; //sizeof(CurveDataStatistics::Sample) == 16 byte key/value; >> graph width in pixel
+const double PROGRESS_GRAPH_SAMPLE_INTERVAL_MIN = 0.1; //[sec]
 
 inline wxColor getColorBytes() { return {111, 255,  99}; } //light green
 inline wxColor getColorItems() { return {127, 147, 255}; } //light blue
@@ -426,7 +428,7 @@ class CurveDataStatistics : public SparseCurveData
 public:
     CurveDataStatistics() : SparseCurveData(true /*addSteps*/) {}
 
-    void clear() { samples_.clear(); lastSample_ = {}; }
+    void clear() { samples_.clear(); lastSample_ = {}; sampleInterval_ = PROGRESS_GRAPH_SAMPLE_INTERVAL_MIN; }
 
     void addSample(double timeElapsed /*[sec]*/, double value /*[items|bytes]*/)
     {
@@ -442,13 +444,21 @@ public:
         lastSample_ = {timeElapsed, value};
 
         //allow for at most one sample per 100ms (handles duplicate inserts, too!) => unrelated to UI_UPDATE_INTERVAL!
-        if (!samples_.empty() && timeElapsed - samples_.back().x < 0.1)
+        if (!samples_.empty() && timeElapsed - samples_.back().x < sampleInterval_)
             return;
 
         samples_.push_back(CurvePoint{timeElapsed, value});
 
-        if (samples_.size() > PROGRESS_GRAPH_SAMPLE_SIZE_MAX) //limit buffer size
-            samples_.pop_front();
+        if (samples_.size() > PROGRESS_GRAPH_SAMPLE_SIZE_MAX) //limit buffer size:
+        {
+            //halve resolution instead of dropping the oldest samples: long-running jobs (20h+) keep the complete graph
+            //while memory and getLessEq()/getGreaterEq() cost stay bounded independent of job duration
+            RingBuffer<CurvePoint> samplesHalf;
+            for (size_t i = 0; i < samples_.size(); i += 2)
+                samplesHalf.push_back(samples_[i]);
+            samples_.swap(samplesHalf);
+            sampleInterval_ *= 2;
+        }
     }
 
 private:
@@ -499,6 +509,7 @@ private:
 
     RingBuffer<CurvePoint> samples_; //x: monotonously ascending with time!
     CurvePoint lastSample_; //artificial record after end of samples to visualize current time!
+    double sampleInterval_ = PROGRESS_GRAPH_SAMPLE_INTERVAL_MIN; //[sec] doubled with each resolution decrease
 };
 
 
@@ -706,6 +717,8 @@ private:
 
     void updateStaticGui();
     void updateProgressGui(bool allowYield);
+    void processUiEvents(bool allowYield);
+    bool isMinimized() const;
 
     void setExternalStatus(const wxString& status, const wxString& progress); //progress may be empty!
 
@@ -729,6 +742,7 @@ private:
     SpeedTest speedTest_  {PERF_WINDOW_BYTES_PER_SEC};
     std::chrono::nanoseconds timeLastSpeedEstimate_    = std::chrono::seconds(-100); //used for calculating intervals between collecting perf samples
     std::chrono::nanoseconds timeLastGraphTotalUpdate_ = std::chrono::seconds(-100);
+    std::chrono::nanoseconds timeLastMinimizedUpdate_  = std::chrono::seconds(-100);
 
     //help calculate total speed
     std::chrono::nanoseconds phaseStart_{}; //begin of current phase
@@ -1087,31 +1101,48 @@ void SyncProgressDialogImpl<TopLevelDialog>::updateProgressGui(bool allowYield)
 
     const bool haveTotalStats = itemsTotal >= 0 || bytesTotal >= 0;
 
-    //status texts
-    setText(*pnl_.m_staticTextStatus, replaceCpy(syncStat_->currentStatusText(), L'\n', L' ')); //no layout update for status texts!
+    const double fractionTotal = bytesTotal + itemsTotal == 0 ? 0 : 1.0 * (bytesCurrent + itemsCurrent) / (bytesTotal + itemsTotal);
+    //add both data + obj-count, to handle "deletion-only" cases
 
-    if (!haveTotalStats)
+    auto updateExternalStatus = [&]
     {
         //dialog caption, taskbar, systray tooltip
-        setExternalStatus(getDialogPhaseText(*syncStat_, paused_), formatNumber(itemsCurrent)); //status text may be "paused"!
+        setExternalStatus(getDialogPhaseText(*syncStat_, paused_), haveTotalStats ? formatPercent0(fractionTotal) : formatNumber(itemsCurrent)); //status text may be "paused"!
 
         //progress indicators
-        if (trayIcon_.get()) trayIcon_->setProgress(1); //100% = regular FFS logo
-        //taskbar_ already set to STATUS_INDETERMINATE within initNewPhase()
-    }
-    else
-    {
-        //dialog caption, taskbar, systray tooltip
+        if (!haveTotalStats)
+        {
+            if (trayIcon_.get()) trayIcon_->setProgress(1); //100% = regular FFS logo
+            //taskbar_ already set to STATUS_INDETERMINATE within initNewPhase()
+        }
+        else
+        {
+            if (trayIcon_.get()) trayIcon_->setProgress(fractionTotal);
+            if (taskbar_ .get()) taskbar_ ->setProgress(fractionTotal);
+        }
+    };
 
-        const double fractionTotal = bytesTotal + itemsTotal == 0 ? 0 : 1.0 * (bytesCurrent + itemsCurrent) / (bytesTotal + itemsTotal);
-        //add both data + obj-count, to handle "deletion-only" cases
+    //minimized to systray or taskbar: nobody sees statistics and graphs => skip formatting, layout and rendering,
+    //refresh tooltip/caption at a low rate only: dozens of minimized batch jobs would otherwise keep a CPU core busy
+    if (isMinimized())
+    {
+        if (numeric::dist(timeLastMinimizedUpdate_, timeElapsed) >= MINIMIZED_UPDATE_INTERVAL)
+        {
+            timeLastMinimizedUpdate_ = timeElapsed;
+            updateExternalStatus();
+        }
+        //graph samples: still recorded by notifyProgressChange() => complete graph after restore
+        processUiEvents(allowYield);
+        return;
+    }
 
-        setExternalStatus(getDialogPhaseText(*syncStat_, paused_), formatPercent0(fractionTotal)); //status text may be "paused"!
+    //status texts
+    setText(*pnl_.m_staticTextStatus, replaceCpy(syncStat_->currentStatusText(), L'\n', L' ')); //no layout update for status texts!
 
-        //progress indicators
-        if (trayIcon_.get()) trayIcon_->setProgress(fractionTotal);
-        if (taskbar_ .get()) taskbar_ ->setProgress(fractionTotal);
+    updateExternalStatus();
 
+    if (haveTotalStats)
+    {
         const double timeTotalSecTentative = bytesCurrent == bytesTotal ? timeElapsedDouble : std::max(curveBytesEstim_.ref().getTotalTime(), timeElapsedDouble);
 
         curveBytesEstim_.ref().setValue(timeElapsedDouble, timeTotalSecTentative, bytesCurrent, bytesTotal);
@@ -1181,6 +1212,7 @@ void SyncProgressDialogImpl<TopLevelDialog>::updateProgressGui(bool allowYield)
         {
             //remaining time: display with relative error of 10% - based on samples taken every 0.5 sec only
             //-> call more often than once per second to correctly show last few seconds countdown, but don't call too often to avoid occasional jitter
+            remTimeTest_.setFallbackBytesPerSec(syncStat_->getExpectedBytesPerSec()); //no samples during the first second
             std::optional<double> remTimeSec = remTimeTest_.getRemainingSec(itemsTotal - itemsCurrent, bytesTotal - bytesCurrent);
             setText(*pnl_.m_staticTextTimeRemaining, remTimeSec ? formatRemainingTime(*remTimeSec) : std::wstring(1, EM_DASH), &layoutChanged);
 
@@ -1217,7 +1249,22 @@ void SyncProgressDialogImpl<TopLevelDialog>::updateProgressGui(bool allowYield)
         pnl_.m_panelTimeStats->Layout();
     }
 
+    processUiEvents(allowYield);
+}
 
+
+template <class TopLevelDialog>
+bool SyncProgressDialogImpl<TopLevelDialog>::isMinimized() const
+{
+    if (trayIcon_)
+        return true;
+    return parentFrame_ ? parentFrame_->IsIconized() : this->IsIconized();
+}
+
+
+template <class TopLevelDialog>
+void SyncProgressDialogImpl<TopLevelDialog>::processUiEvents(bool allowYield)
+{
     if (allowYield)
     {
         if (paused_) //support for pause button
@@ -1615,6 +1662,7 @@ void SyncProgressDialogImpl<TopLevelDialog>::minimizeToTray()
         trayIcon_ = std::make_unique<FfsTrayIcon>([this] { this->resumeFromSystray(true /*userRequested*/); }); //FfsTrayIcon lifetime is a subset of "this"'s lifetime!
         //we may destroy FfsTrayIcon even while in the FfsTrayIcon callback!!!!
 
+        timeLastMinimizedUpdate_ = std::chrono::seconds(-100);
         updateProgressGui(false /*allowYield*/); //set tray tooltip + progress: e.g. no updates while paused
 
         this->Hide();
@@ -7,6 +7,8 @@
 #include "search_grid.h"
 #include <zen/zstring.h>
 #include <zen/utf.h>
+#include <zen/scope_guard.h>
+#include <zen/thread.h>
 //#include <zen/perf.h>
 
 using namespace zen;
@@ -101,6 +103,144 @@ ptrdiff_t findRow(const Grid& grid, //return -1 if no matching row found
     }
     return -1;
 }
+
+//###########################################################################################
+
+/* search index: normalized values of all rows and visible columns in a single buffer
+    - GridData is not thread-safe => calculate once on main thread, then search on worker threads
+    - reuse for repeated "find next" as long as GridData::getValueVersion() is unchanged          */
+struct SearchIndex
+{
+    const GridData* prov = nullptr; //weak pointer: *never dereference*!
+    uint64_t valueVersion = 0;
+    std::vector<ColumnType> colTypes;
+    bool respectCase = false;
+
+    std::string text; //UTF-8: less memory than std::wstring; each value followed by '\0' => matches can't span multiple values
+    std::vector<size_t> rowOffsets; //row i: [rowOffsets[i], rowOffsets[i + 1])
+};
+std::vector<SearchIndex> searchIndexBuf; //main thread only!
+
+
+template <bool respectCase>
+std::string getSearchText(std::wstring&& str)
+{
+    normalizeForSeach<respectCase>(str);
+    return utfTo<std::string>(str);
+}
+
+
+//return nullptr if grid data can't be buffered
+const SearchIndex* getSearchIndex(const Grid& grid1, const Grid& grid2, const Grid& grid, bool respectCase)
+{
+    assert(runningOnMainThread());
+    const GridData* prov = grid.getDataProvider();
+    if (!prov || prov->getValueVersion() == 0)
+        return nullptr;
+
+    std::vector<ColumnType> colTypes;
+    for (const Grid::ColAttributes& ca : grid.getColumnConfig())
+        if (ca.visible)
+            colTypes.push_back(ca.type);
+
+    //keep buffers of the two grids currently searched only
+    std::erase_if(searchIndexBuf, [&](const SearchIndex& index) { return index.prov != grid1.getDataProvider() && index.prov != grid2.getDataProvider(); });
+
+    auto it = std::find_if(searchIndexBuf.begin(), searchIndexBuf.end(), [&](const SearchIndex& index) { return index.prov == prov; });
+    if (it != searchIndexBuf.end() &&
+        it->valueVersion == prov->getValueVersion() &&
+        it->colTypes     == colTypes &&
+        it->respectCase  == respectCase &&
+        it->rowOffsets.size() == prov->getRowCount() + 1)
+        return &*it;
+
+    if (it == searchIndexBuf.end())
+        it = searchIndexBuf.insert(searchIndexBuf.end(), SearchIndex());
+
+    SearchIndex& index = *it;
+    index = SearchIndex(); //free memory before recalculation
+    index.prov         = prov;
+    index.valueVersion = prov->getValueVersion();
+    index.colTypes     = colTypes;
+    index.respectCase  = respectCase;
+
+    const size_t rowCount = prov->getRowCount();
+    index.rowOffsets.reserve(rowCount + 1);
+    index.rowOffsets.push_back(0);
+
+    for (size_t row = 0; row < rowCount; ++row)
+    {
+        for (const ColumnType colType : colTypes)
+        {
+            index.text += respectCase ?
+                          getSearchText<true >(prov->getValue(row, colType)) :
+                          getSearchText<false>(prov->getValue(row, colType));
+            index.text += '\0';
+        }
+        index.rowOffsets.push_back(index.text.size());
+    }
+    index.text.shrink_to_fit();
+    return &index;
+}
+
+
+ptrdiff_t findRowIndexed(const SearchIndex& index, //return -1 if no matching row found
+                         const std::string& textToFind, //normalized!
+                         bool searchAscending,
+                         size_t rowFirst, //specify area to search:
+                         size_t rowLast)  // [rowFirst, rowLast)
+{
+    rowLast = std::min(rowLast, index.rowOffsets.size() - 1); //e.g. cursor row on empty grid
+
+    //[rowFirst, rowLast) => first or last match
+    auto findInRows = [&](size_t rowFirst2, size_t rowLast2) -> ptrdiff_t
+    {
+        const size_t textFirst = index.rowOffsets[rowFirst2];
+        const std::string_view rowsText(index.text.data() + textFirst, index.rowOffsets[rowLast2] - textFirst);
+
+        const size_t pos = searchAscending ? rowsText.find(textToFind) : rowsText.rfind(textToFind);
+        if (pos == std::string_view::npos)
+            return -1;
+
+        //find row containing the match:
+        auto it = std::upper_bound(index.rowOffsets.begin() + rowFirst2, index.rowOffsets.begin() + rowLast2, textFirst + pos);
+        return it - index.rowOffsets.begin() - 1;
+    };
+
+    //split into chunks in search order: search a few chunks at a time in parallel => finish early when the match is close
+    const size_t CHUNK_ROWS = 50'000;
+
+    std::vector<std::pair<size_t, size_t>> chunks;
+    if (searchAscending)
+        for (size_t row = rowFirst; row < rowLast; row += CHUNK_ROWS)
+            chunks.emplace_back(row, std::min(row + CHUNK_ROWS, rowLast));
+    else
+        for (size_t row = rowLast; row > rowFirst; row -= std::min(CHUNK_ROWS, row - rowFirst))
+            chunks.emplace_back(row - std::min(CHUNK_ROWS, row - rowFirst), row);
+
+    const size_t threadCount = std::max(std::thread::hardware_concurrency(), 1U);
+
+    for (size_t i = 0; i < chunks.size(); i += threadCount)
+    {
+        const size_t batchEnd = std::min(i + threadCount, chunks.size());
+
+        std::vector<std::future<ptrdiff_t>> futures;
+        ZEN_ON_SCOPE_EXIT(for (std::future<ptrdiff_t>& ft : futures) if (ft.valid()) ft.wait()); //[!] detached threads reference local variables
+
+        for (size_t j = i + 1; j < batchEnd; ++j)
+            futures.push_back(runAsync([&findInRows, chunk = chunks[j]] { return findInRows(chunk.first, chunk.second); }));
+
+        if (const ptrdiff_t row = findInRows(chunks[i].first, chunks[i].second); //main thread searches first chunk
+            row >= 0)
+            return row;
+
+        for (std::future<ptrdiff_t>& ft : futures)
+            if (const ptrdiff_t row = ft.get();
+                row >= 0)
+                return row;
+    }
+    return -1;
+}
 }
 
 
@@ -119,9 +259,15 @@ std::pair<const Grid*, ptrdiff_t> fff::findGridMatch(const Grid& grid1, const Gr
 
     auto finishSearch = [&](const Grid& grid, size_t rowFirst, size_t rowLast)
     {
-        const ptrdiff_t targetRow = respectCase ?
-                                    findRow<true >(grid, searchString, searchAscending, rowFirst, rowLast) :
-                                    findRow<false>(grid, searchString, searchAscending, rowFirst, rowLast);
+        ptrdiff_t targetRow = -1;
+        if (const SearchIndex* index = getSearchIndex(grid1, grid2, grid, respectCase))
+            targetRow = findRowIndexed(*index, respectCase ?
+                                       getSearchText<true >(std::wstring(searchString)) :
+                                       getSearchText<false>(std::wstring(searchString)), searchAscending, rowFirst, rowLast);
+        else
+            targetRow = respectCase ?
+                        findRow<true >(grid, searchString, searchAscending, rowFirst, rowLast) :
+                        findRow<false>(grid, searchString, searchAscending, rowFirst, rowLast);
         if (targetRow >= 0)
         {
             result = {&grid, targetRow};
@@ -37,6 +37,7 @@
 #include "../base/synchronization.h"
 #include "../base/path_filter.h"
 #include "../base/icon_loader.h"
+#include "../base/memory_stats.h"
 #include "../status_handler.h" //uiUpdateDue()
 #include "../version/version.h"
 //#include "../log_file.h"
@@ -93,6 +94,7 @@ AboutDlg::AboutDlg(wxWindow* parent) : AboutDlgGenerated(parent)
     build += utfTo<wxString>(formatTime(formatDateTag, getCompileTime()));
 
     m_staticFfsTextVersion->SetLabelText(replaceCpy(_("Version: %x"), L"%x", build));
+    m_staticFfsTextVersion->SetToolTip(_("Memory usage:") + L'\n' + formatMemoryUsage(getMemoryUsage())); //debug info
 
     wxString variantName;
     m_staticTextFfsVariant->SetLabelText(variantName);
@@ -238,6 +240,8 @@ private:
 
     SftpAuthType sftpAuthType_ = sftpDefault_.authType;
 
+    bool ftpPreciseTimes_ = false; //no GUI: keep option set via folder path phrase ("|precisetime")
+
     AsyncGuiQueue guiQueue_;
 
     Zstring& sftpKeyFileLastSelected_;
@@ -367,6 +371,7 @@ CloudSetupDlg::CloudSetupDlg(wxWindow* parent, Zstring& folderPathPhrase, Zstrin
         m_textCtrlServerPath     ->ChangeValue(utfTo<wxString>(FILE_NAME_SEPARATOR + folderPath.afsPath.value));
         (login.useTls ? m_radioBtnEncryptSsl : m_radioBtnEncryptNone)->SetValue(true);
         m_spinCtrlTimeout        ->SetValue(login.timeoutSec);
+        ftpPreciseTimes_ = login.preciseTimes;
     }
 
     m_spinCtrlConnectionCount->SetValue(parallelOps);
@@ -708,6 +713,7 @@ AbstractPath CloudSetupDlg::getFolderPath() const
             login.password = utfTo<Zstring>((m_checkBoxShowPassword->GetValue() ? m_textCtrlPasswordVisible : m_textCtrlPasswordHidden)->GetValue());
             login.useTls = m_radioBtnEncryptSsl->GetValue();
             login.timeoutSec = m_spinCtrlTimeout->GetValue();
+            login.preciseTimes = ftpPreciseTimes_;
             return AbstractPath(condenseToFtpDevice(login), serverRelPath); //noexcept
         }
     }
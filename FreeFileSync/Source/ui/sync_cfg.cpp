@@ -25,6 +25,7 @@
 #include "../base/norm_filter.h"
 #include "../base/file_hierarchy.h"
 #include "../base/icon_loader.h"
+#include "../base/dedup_store.h"
 //#include "../log_file.h"
 #include "../afs/concrete.h"
 #include "../base_tools.h"
@@ -487,7 +488,8 @@ globalLogFolderPhrase_(globalLogFolderPhrase)
     enumVersioningStyle_.
     add(VersioningStyle::replace,          _("Replace"),    _("Move files and replace if existing")).
     add(VersioningStyle::timestampFolder, _("Time stamp") + L" [" + _("Folder") + L']', _("Move files into a time-stamped subfolder")).
-    add(VersioningStyle::timestampFile,   _("Time stamp") + L" [" + _("File")   + L']', _("Append a time stamp to each file name"));
+    add(VersioningStyle::timestampFile,   _("Time stamp") + L" [" + _("File")   + L']', _("Append a time stamp to each file name")).
+    add(VersioningStyle::deduplicate,     _("Deduplicate"), _("Store only the parts of each file that changed since previous versions"));
 
     m_spinCtrlVersionMaxDays ->SetMinSize({fastFromDIP(60), -1}); //
     m_spinCtrlVersionCountMin->SetMinSize({fastFromDIP(60), -1}); //Hack: set size (why does wxWindow::Size() not work?)
@@ -1225,6 +1227,12 @@ void ConfigDialog::updateSyncGui()
                 setText(*m_staticTextNamingCvtPart2Bold, _("YYYY-MM-DD hhmmss"));
                 setText(*m_staticTextNamingCvtPart3, L".doc");
                 break;
+
+            case VersioningStyle::deduplicate:
+                setText(*m_staticTextNamingCvtPart1, pathSep + _("Folder") + pathSep + _("File") + L".doc ");
+                setText(*m_staticTextNamingCvtPart2Bold, _("YYYY-MM-DD hhmmss"));
+                setText(*m_staticTextNamingCvtPart3, L".doc" + utfTo<std::wstring>(DEDUP_MANIFEST_ENDING));
+                break;
         }
 
         const bool enableLimitCtrls = syncOptionsEnabled && versioningStyle != VersioningStyle::replace;
@@ -210,6 +210,8 @@ FfsTrayIcon::~FfsTrayIcon()
 
 void FfsTrayIcon::setToolTip(const wxString& toolTip)
 {
+    if (toolTip == activeToolTip_) //SetIcon() is not free: e.g. re-sent to the system tray host
+        return;
     activeToolTip_ = toolTip;
     trayIcon_->SetIcon(iconGenerator_->get(activeFraction_), activeToolTip_); //another wxWidgets design bug: non-orthogonal method!
 }
@@ -217,6 +219,8 @@ void FfsTrayIcon::setToolTip(const wxString& toolTip)
 
 void FfsTrayIcon::setProgress(double fraction)
 {
+    if (fraction == activeFraction_)
+        return;
     activeFraction_ = fraction;
     trayIcon_->SetIcon(iconGenerator_->get(activeFraction_), activeToolTip_);
 }
@@ -45,27 +45,12 @@ TreeView::TreeView(FolderComparison& folderCmp, const SortInfo& si) : folderCmp_
 }
 
 
-inline
-void TreeView::compressNode(Container& cont) //remove single-element sub-trees -> gain clarity + usability (call *after* inclusion check!!!)
+TreeView::Container TreeView::getAggregate(ContainerObject& hierObj, bool cacheResult, bool cacheChildren)
 {
-    if (cont.subDirs.empty()) //single files node
-        cont.firstFileId = nullptr;
-
-#if 0 //let's not go overboard: empty folders should not be condensed => used for file exclusion filter; user expects to see them
-    if (cont.firstFileId == nullptr && //single dir node...
-        cont.subDirs.size() == 1   && //
-        cont.subDirs[0].firstFileId == nullptr && //...that is empty
-        cont.subDirs[0].subDirs.empty())          //
-        cont.subDirs.clear();
-#endif
-}
-
+    if (auto it = aggregates_.find(&hierObj);
+        it != aggregates_.end() && it->second.changeId == hierObj.getChangeId()) //changed sync directions invalidate only the path to the changed item
+        return it->second.cont;
 
-template <class Function> //(const FileSystemObject&) -> bool
-void TreeView::extractVisibleSubtree(ContainerObject& hierObj,  //in
-                                     TreeView::Container& cont, //out
-                                     Function pred)
-{
     auto getBytes = [](const FilePair& file) //MSVC screws up miserably if we put this lambda into std::for_each
     {
         ////give accumulated bytes the semantics of a sync preview!
@@ -85,9 +70,9 @@ void TreeView::extractVisibleSubtree(ContainerObject& hierObj,  //in
         return std::max(file.getFileSize<SelectSide::left>(), file.getFileSize<SelectSide::right>());
     };
 
-    cont.firstFileId = nullptr;
+    Container cont;
     for (FilePair& file : hierObj.refSubFiles())
-        if (pred(file))
+        if (lastViewFilterPred_(file))
         {
             cont.bytesNet += getBytes(file);
             ++cont.itemCountNet;
@@ -97,7 +82,7 @@ void TreeView::extractVisibleSubtree(ContainerObject& hierObj,  //in
         }
 
     for (SymlinkPair& symlink : hierObj.refSubLinks())
-        if (pred(symlink))
+        if (lastViewFilterPred_(symlink))
         {
             ++cont.itemCountNet;
 
@@ -105,37 +90,36 @@ void TreeView::extractVisibleSubtree(ContainerObject& hierObj,  //in
                 cont.firstFileId = symlink.getId();
         }
 
-    cont.bytesGross     += cont.bytesNet;
-    cont.itemCountGross += cont.itemCountNet;
-
-    cont.subDirs.reserve(hierObj.refSubFolders().size()); //avoid expensive reallocations!
+    cont.bytesGross     = cont.bytesNet;
+    cont.itemCountGross = cont.itemCountNet;
 
     for (FolderPair& folder : hierObj.refSubFolders())
     {
-        const bool included = pred(folder);
-
-        cont.subDirs.emplace_back(); //
-        auto& subDirCont = cont.subDirs.back();
-        TreeView::extractVisibleSubtree(folder, subDirCont, pred);
-        if (included)
-            ++subDirCont.itemCountGross;
+        const Container subDirCont = getAggregate(folder, cacheChildren, false);
+        const bool included = lastViewFilterPred_(folder);
 
         cont.bytesGross     += subDirCont.bytesGross;
-        cont.itemCountGross += subDirCont.itemCountGross;
+        cont.itemCountGross += subDirCont.itemCountGross + (included ? 1 : 0);
 
-        if (!included && !subDirCont.firstFileId && subDirCont.subDirs.empty())
-            cont.subDirs.pop_back();
-        else
-        {
-            subDirCont.objId = folder.getId();
-            compressNode(subDirCont);
-        }
+        if (included || subDirCont.firstFileId || subDirCont.subDirCount > 0)
+            ++cont.subDirCount;
     }
+
+    if (cacheResult)
+        aggregates_.insert_or_assign(&hierObj, CachedContainer{hierObj.getChangeId(), cont});
+    return cont;
 }
 
 
 namespace
 {
+std::wstring getDisplayName(const BaseFolderPair& baseFolder)
+{
+    return getShortDisplayNameForFolderPair(baseFolder.getAbstractPath<SelectSide::left >(),
+                                            baseFolder.getAbstractPath<SelectSide::right>());
+}
+
+
 //generate nice percentage numbers which precisely sum up to 100
 void calcPercentage(std::vector<std::pair<uint64_t, int*>>& workList)
 {
@@ -192,13 +176,13 @@ struct TreeView::LessShortName
         {
             case NodeType::root:
                 return makeSortDirection(LessNaturalSort() /*even on Linux*/,
-                                         std::bool_constant<ascending>())(utfTo<Zstring>(static_cast<const RootNodeImpl*>(lhs.node)->displayName),
-                                                                          utfTo<Zstring>(static_cast<const RootNodeImpl*>(rhs.node)->displayName));
+                                         std::bool_constant<ascending>())(utfTo<Zstring>(getDisplayName(*lhs.baseFolder)),
+                                                                          utfTo<Zstring>(getDisplayName(*rhs.baseFolder)));
 
             case NodeType::folder:
             {
-                const auto* folderL = dynamic_cast<const FolderPair*>(FileSystemObject::retrieve(static_cast<const DirNodeImpl*>(lhs.node)->objId));
-                const auto* folderR = dynamic_cast<const FolderPair*>(FileSystemObject::retrieve(static_cast<const DirNodeImpl*>(rhs.node)->objId));
+                const auto* folderL = dynamic_cast<const FolderPair*>(FileSystemObject::retrieve(lhs.objId));
+                const auto* folderR = dynamic_cast<const FolderPair*>(FileSystemObject::retrieve(rhs.objId));
 
                 if (!folderL)  //might be pathologic, but it's covered
                     return false;
@@ -220,37 +204,8 @@ struct TreeView::LessShortName
 template <bool ascending>
 void TreeView::sortSingleLevel(std::vector<TreeLine>& items, ColumnTypeOverview columnType)
 {
-    auto getBytes = [](const TreeLine& line) -> uint64_t
-    {
-        switch (line.type)
-        {
-            case NodeType::root:
-            case NodeType::folder:
-                return line.node->bytesGross;
-            case NodeType::files:
-                return line.node->bytesNet;
-        }
-        assert(false);
-        return 0U;
-    };
-
-    auto getCount = [](const TreeLine& line) -> int
-    {
-        switch (line.type)
-        {
-            case NodeType::root:
-            case NodeType::folder:
-                return line.node->itemCountGross;
-
-            case NodeType::files:
-                return line.node->itemCountNet;
-        }
-        assert(false);
-        return 0;
-    };
-
-    const auto lessBytes = [&](const TreeLine& lhs, const TreeLine& rhs) { return getBytes(lhs) < getBytes(rhs); };
-    const auto lessCount = [&](const TreeLine& lhs, const TreeLine& rhs) { return getCount(lhs) < getCount(rhs); };
+    const auto lessBytes = [](const TreeLine& lhs, const TreeLine& rhs) { return lhs.bytes     < rhs.bytes; };
+    const auto lessCount = [](const TreeLine& lhs, const TreeLine& rhs) { return lhs.itemCount < rhs.itemCount; };
 
     switch (columnType)
     {
@@ -267,21 +222,30 @@ void TreeView::sortSingleLevel(std::vector<TreeLine>& items, ColumnTypeOverview
 }
 
 
-void TreeView::getChildren(const Container& cont, unsigned int level, std::vector<TreeLine>& output)
+void TreeView::getChildren(ContainerObject& hierObj, unsigned int level, std::vector<TreeLine>& output)
 {
+    const Container cont = getAggregate(hierObj, true /*cacheResult*/, true /*cacheChildren*/);
+
     output.clear();
-    output.reserve(cont.subDirs.size() + 1); //keep pointers in "workList" valid
+    output.reserve(cont.subDirCount + 1); //keep pointers in "workList" valid
     std::vector<std::pair<uint64_t, int*>> workList;
 
-    for (const DirNodeImpl& subDir : cont.subDirs)
+    for (FolderPair& folder : hierObj.refSubFolders())
     {
-        output.push_back({level, 0, &subDir, NodeType::folder});
-        workList.emplace_back(subDir.bytesGross, &output.back().percent);
+        const Container subDirCont = getAggregate(folder, true /*cacheResult*/, false /*cacheChildren*/); //cached by now: no recursion
+        const bool included = lastViewFilterPred_(folder);
+
+        if (included || subDirCont.firstFileId || subDirCont.subDirCount > 0)
+        {
+            //remove single-element sub-trees -> gain clarity + usability: a single files node is not shown
+            output.push_back({level, 0, NodeType::folder, subDirCont.bytesGross, subDirCont.itemCountGross + (included ? 1 : 0), subDirCont.subDirCount > 0, nullptr, folder.getId()});
+            workList.emplace_back(subDirCont.bytesGross, &output.back().percent);
+        }
     }
 
-    if (cont.firstFileId)
+    if (cont.firstFileId && cont.subDirCount > 0)
     {
-        output.push_back({level, 0, &cont, NodeType::files});
+        output.push_back({level, 0, NodeType::files, cont.bytesNet, cont.itemCountNet, false, nullptr, cont.firstFileId});
         workList.emplace_back(cont.bytesNet, &output.back().percent);
     }
     calcPercentage(workList);
@@ -293,18 +257,18 @@ void TreeView::getChildren(const Container& cont, unsigned int level, std::vecto
 }
 
 
-void TreeView::applySubView(std::vector<RootNodeImpl>&& newView)
+void TreeView::applySubView()
 {
     //preserve current node expansion status
-    auto getHierAlias = [](const TreeView::TreeLine& tl) -> const ContainerObject*
+    auto getHierAlias = [](const TreeView::TreeLine& tl) -> ContainerObject*
     {
         switch (tl.type)
         {
             case NodeType::root:
-                return static_cast<const RootNodeImpl*>(tl.node)->baseFolder.get();
+                return tl.baseFolder;
 
             case NodeType::folder:
-                if (auto folder = dynamic_cast<const FolderPair*>(FileSystemObject::retrieve(static_cast<const DirNodeImpl*>(tl.node)->objId)))
+                if (auto folder = dynamic_cast<FolderPair*>(FileSystemObject::retrieve(tl.objId)))
                     return folder;
                 break;
 
@@ -324,29 +288,28 @@ void TreeView::applySubView(std::vector<RootNodeImpl>&& newView)
                     expandedNodes.insert(hierObj);
     }
 
-    //update view on full data
-    folderCmpView_.swap(newView); //newView may be an alias for folderCmpView! see sorting!
-
     //set default flat tree
     flatTree_.clear();
 
-    if (folderCmp_.size() == 1) //single folder pair case (empty pairs were already removed!) do NOT use folderCmpView for this check!
-    {
-        if (!folderCmpView_.empty()) //possibly empty!
-            getChildren(folderCmpView_[0], 0, flatTree_); //do not show root
-    }
+    if (folderCmp_.size() == 1) //single folder pair case (empty pairs were already removed!)
+        getChildren(*folderCmp_[0], 0, flatTree_); //do not show root
     else
     {
         //following is almost identical with TreeView::getChildren(): however we *cannot* reuse code here;
-        //this were only possible if we replaced "std::vector<RootNodeImpl>" with "Container"!
+        //root nodes are BaseFolderPairs, not sub folders of a ContainerObject
 
-        flatTree_.reserve(folderCmpView_.size()); //keep pointers in "workList" valid
+        flatTree_.reserve(folderCmp_.size()); //keep pointers in "workList" valid
         std::vector<std::pair<uint64_t, int*>> workList;
 
-        for (const RootNodeImpl& root : folderCmpView_)
+        for (const std::shared_ptr<BaseFolderPair>& baseObj : folderCmp_)
         {
-            flatTree_.push_back({0, 0, &root, NodeType::root});
-            workList.emplace_back(root.bytesGross, &flatTree_.back().percent);
+            const Container rootCont = getAggregate(*baseObj, true /*cacheResult*/, true /*cacheChildren*/);
+
+            if (rootCont.firstFileId || rootCont.subDirCount > 0)
+            {
+                flatTree_.push_back({0, 0, NodeType::root, rootCont.bytesGross, rootCont.itemCountGross, rootCont.subDirCount > 0, baseObj.get(), nullptr});
+                workList.emplace_back(rootCont.bytesGross, &flatTree_.back().percent);
+            }
         }
 
         calcPercentage(workList);
@@ -366,43 +329,33 @@ void TreeView::applySubView(std::vector<RootNodeImpl>&& newView)
             if (expandedNodes.contains(hierObj))
             {
                 std::vector<TreeLine> newLines;
-                getChildren(*line.node, line.level + 1, newLines);
+                getChildren(*hierObj, line.level + 1, newLines);
 
                 flatTree_.insert(flatTree_.begin() + row + 1, newLines.begin(), newLines.end());
             }
     }
+    updateMemoryUsage();
 }
 
 
-template <class Predicate>
-void TreeView::updateView(Predicate pred)
+void TreeView::updateMemoryUsage()
 {
-    //update view on full data
-    std::vector<RootNodeImpl> newView;
-    newView.reserve(folderCmp_.size()); //avoid expensive reallocations!
+    memoryUsage_.set(flatTree_.capacity() * sizeof(TreeLine) +
+                     aggregates_.size() * (sizeof(decltype(aggregates_)::value_type) + 2 * sizeof(void*)) + aggregates_.bucket_count() * sizeof(void*)); //estimate: one heap node per item + bucket array
+}
 
-    for (const std::shared_ptr<BaseFolderPair>& baseObj : folderCmp_)
-    {
-        newView.emplace_back();
-        RootNodeImpl& root = newView.back();
-        this->extractVisibleSubtree(*baseObj, root, pred); //"this->" is bogus for a static method, but GCC screws this one up
-
-        //warning: the following lines are almost 1:1 copy from extractVisibleSubtree:
-        //however we *cannot* reuse code here; this were only possible if we replaced "std::vector<RootNodeImpl>" with "Container"!
-        if (!root.firstFileId && root.subDirs.empty())
-            newView.pop_back();
-        else
-        {
-            root.baseFolder = baseObj;
-            root.displayName = getShortDisplayNameForFolderPair(baseObj->getAbstractPath<SelectSide::left >(),
-                                                                baseObj->getAbstractPath<SelectSide::right>());
 
-            this->compressNode(root); //"this->" required by two-pass lookup as enforced by GCC 4.7
-        }
+template <class Predicate>
+void TreeView::updateView(std::vector<bool> viewFilter, Predicate pred)
+{
+    if (viewFilter != lastViewFilter_) //otherwise keep aggregates of unchanged sub trees
+    {
+        aggregates_.clear();
+        lastViewFilter_ = std::move(viewFilter);
     }
-
     lastViewFilterPred_ = pred;
-    applySubView(std::move(newView));
+
+    applySubView();
 }
 
 
@@ -411,7 +364,7 @@ void TreeView::setSortDirection(ColumnTypeOverview colType, bool ascending) //ap
     currentSort_ = SortInfo{colType, ascending};
 
     //reapply current view
-    applySubView(std::move(folderCmpView_));
+    applySubView();
 }
 
 
@@ -427,7 +380,7 @@ TreeView::NodeStatus TreeView::getStatus(size_t row) const
         {
             case NodeType::root:
             case NodeType::folder:
-                return flatTree_[row].node->firstFileId || !flatTree_[row].node->subDirs.empty() ? TreeView::STATUS_REDUCED : TreeView::STATUS_EMPTY;
+                return flatTree_[row].hasChildren ? TreeView::STATUS_REDUCED : TreeView::STATUS_EMPTY;
 
             case NodeType::files:
                 return TreeView::STATUS_EMPTY;
@@ -452,13 +405,17 @@ void TreeView::expandNode(size_t row)
         switch (flatTree_[row].type)
         {
             case NodeType::root:
+                getChildren(*flatTree_[row].baseFolder, flatTree_[row].level + 1, newLines);
+                break;
             case NodeType::folder:
-                getChildren(*flatTree_[row].node, flatTree_[row].level + 1, newLines);
+                if (auto folder = dynamic_cast<FolderPair*>(FileSystemObject::retrieve(flatTree_[row].objId)))
+                    getChildren(*folder, flatTree_[row].level + 1, newLines);
                 break;
             case NodeType::files:
                 break;
         }
         flatTree_.insert(flatTree_.begin() + row + 1, newLines.begin(), newLines.end());
+        updateMemoryUsage();
     }
 }
 
@@ -510,14 +467,23 @@ void TreeView::applyDifferenceFilter(bool showExcluded,
                                      bool equalFilesActive,
                                      bool conflictFilesActive)
 {
-    updateView([showExcluded, //make sure the predicate can be stored safely!
-                              leftOnlyFilesActive,
-                              rightOnlyFilesActive,
-                              leftNewerFilesActive,
-                              rightNewerFilesActive,
-                              differentFilesActive,
-                              equalFilesActive,
-                              conflictFilesActive](const FileSystemObject& fsObj) -> bool
+    updateView({false /*difference view*/,
+                showExcluded,
+                leftOnlyFilesActive,
+                rightOnlyFilesActive,
+                leftNewerFilesActive,
+                rightNewerFilesActive,
+                differentFilesActive,
+                equalFilesActive,
+                conflictFilesActive},
+               [showExcluded, //make sure the predicate can be stored safely!
+                leftOnlyFilesActive,
+                rightOnlyFilesActive,
+                leftNewerFilesActive,
+                rightNewerFilesActive,
+                differentFilesActive,
+                equalFilesActive,
+                conflictFilesActive](const FileSystemObject& fsObj) -> bool
     {
         if (!fsObj.isActive() && !showExcluded)
             return false;
@@ -557,16 +523,27 @@ void TreeView::applyActionFilter(bool showExcluded,
                                  bool syncEqualActive,
                                  bool conflictFilesActive)
 {
-    updateView([showExcluded, //make sure the predicate can be stored safely!
-                              syncCreateLeftActive,
-                              syncCreateRightActive,
-                              syncDeleteLeftActive,
-                              syncDeleteRightActive,
-                              syncDirOverwLeftActive,
-                              syncDirOverwRightActive,
-                              syncDirNoneActive,
-                              syncEqualActive,
-                              conflictFilesActive](const FileSystemObject& fsObj) -> bool
+    updateView({true /*action view*/,
+                showExcluded,
+                syncCreateLeftActive,
+                syncCreateRightActive,
+                syncDeleteLeftActive,
+                syncDeleteRightActive,
+                syncDirOverwLeftActive,
+                syncDirOverwRightActive,
+                syncDirNoneActive,
+                syncEqualActive,
+                conflictFilesActive},
+               [showExcluded, //make sure the predicate can be stored safely!
+                syncCreateLeftActive,
+                syncCreateRightActive,
+                syncDeleteLeftActive,
+                syncDeleteRightActive,
+                syncDirOverwLeftActive,
+                syncDirOverwRightActive,
+                syncDirNoneActive,
+                syncEqualActive,
+                conflictFilesActive](const FileSystemObject& fsObj) -> bool
     {
         if (!fsObj.isActive() && !showExcluded)
             return false;
@@ -608,30 +585,20 @@ std::unique_ptr<TreeView::Node> TreeView::getLine(size_t row) const
 {
     if (row < flatTree_.size())
     {
-        const auto level  = flatTree_[row].level;
-        const int percent = flatTree_[row].percent;
+        const TreeLine& line = flatTree_[row];
 
-        switch (flatTree_[row].type)
+        switch (line.type)
         {
             case NodeType::root:
-            {
-                const auto& root = *static_cast<const TreeView::RootNodeImpl*>(flatTree_[row].node);
-                return std::make_unique<TreeView::RootNode>(percent, root.bytesGross, root.itemCountGross, getStatus(row), *root.baseFolder, root.displayName);
-            }
-            break;
+                return std::make_unique<TreeView::RootNode>(line.percent, line.bytes, line.itemCount, getStatus(row), *line.baseFolder, getDisplayName(*line.baseFolder));
 
             case NodeType::folder:
-            {
-                const auto* dir = static_cast<const TreeView::DirNodeImpl*>(flatTree_[row].node);
-                if (auto folder = dynamic_cast<FolderPair*>(FileSystemObject::retrieve(dir->objId)))
-                    return std::make_unique<TreeView::DirNode>(percent, dir->bytesGross, dir->itemCountGross, level, getStatus(row), *folder);
-            }
-            break;
+                if (auto folder = dynamic_cast<FolderPair*>(FileSystemObject::retrieve(line.objId)))
+                    return std::make_unique<TreeView::DirNode>(line.percent, line.bytes, line.itemCount, line.level, getStatus(row), *folder);
+                break;
 
             case NodeType::files:
-            {
-                const auto* parentDir = flatTree_[row].node;
-                if (FileSystemObject* firstFile = FileSystemObject::retrieve(parentDir->firstFileId))
+                if (FileSystemObject* firstFile = FileSystemObject::retrieve(line.objId))
                 {
                     std::vector<FileSystemObject*> filesAndLinks;
                     ContainerObject& parent = firstFile->parent();
@@ -645,15 +612,15 @@ std::unique_ptr<TreeView::Node> TreeView::getLine(size_t row) const
                         if (lastViewFilterPred_(fsObj))
                             filesAndLinks.push_back(&fsObj);
 
-                    return std::make_unique<TreeView::FilesNode>(percent, parentDir->bytesNet, parentDir->itemCountNet, level, filesAndLinks);
+                    return std::make_unique<TreeView::FilesNode>(line.percent, line.bytes, line.itemCount, line.level, filesAndLinks);
                 }
-            }
-            break;
+                break;
         }
     }
     return nullptr;
 }
 
+
 //##########################################################################################################
 
 namespace
@@ -8,9 +8,11 @@
 #define TREE_VIEW_H_841703190201835280256673425
 
 #include <functional>
+#include <unordered_map>
 #include <wx+/grid.h>
 #include "tree_grid_attr.h"
 #include "../base/file_hierarchy.h"
+#include "../base/memory_stats.h"
 
 
 namespace fff
@@ -109,70 +111,69 @@ private:
     TreeView           (const TreeView&) = delete;
     TreeView& operator=(const TreeView&) = delete;
 
-    struct DirNodeImpl;
-
-    struct Container
+    struct Container //aggregated numbers for the sub tree of a ContainerObject matching the view filter
     {
         uint64_t bytesGross = 0;
         uint64_t bytesNet   = 0; //bytes for files on view in this directory only
-        int itemCountGross  = 0;
+        int itemCountGross  = 0; //excluding the folder itself
         int itemCountNet    = 0; //number of files on view for in this directory only
+        int subDirCount     = 0; //number of sub directories on view
 
-        std::vector<DirNodeImpl> subDirs;
         FileSystemObject::ObjectId firstFileId = nullptr; //weak pointer to first FilePair or SymlinkPair
-        //- "compress" algorithm may hide file nodes for directories with a single included file, i.e. itemCountGross == itemCountNet == 1
         //- a ContainerObject* would be a better fit, but we need weak pointer semantics!
-        //- a std::vector<FileSystemObject::ObjectId> would be a better design, but we don't want a second memory structure as large as custom grid!
-    };
-
-    struct DirNodeImpl : public Container
-    {
-        FileSystemObject::ObjectId objId = nullptr; //weak pointer to FolderPair
-    };
-
-    struct RootNodeImpl : public Container
-    {
-        std::shared_ptr<BaseFolderPair> baseFolder;
-        std::wstring displayName;
     };
 
     enum class NodeType
     {
-        root,   //-> RootNodeImpl
-        folder, //-> DirNodeImpl
-        files   //-> Container
+        root,   //-> BaseFolderPair
+        folder, //-> FolderPair
+        files   //-> files and symlinks of a ContainerObject
     };
 
     struct TreeLine
     {
         unsigned int level = 0;
         int percent = 0; //[0, 100]
-        const Container* node = nullptr;     //
-        NodeType type = NodeType::root; //we increase size of "flatTree" using C-style types rather than have a polymorphic "folderCmpView"
+        NodeType type = NodeType::root;
+
+        uint64_t bytes = 0;    //gross for root/folder, net for files
+        int itemCount  = 0;    //
+        bool hasChildren = false; //root/folder only
+
+        BaseFolderPair* baseFolder = nullptr;       //root only: bound by folderCmp_
+        FileSystemObject::ObjectId objId = nullptr; //folder: weak pointer to FolderPair; files: weak pointer to first FilePair or SymlinkPair
     };
 
-    static void compressNode(Container& cont);
-    template <class Function>
-    static void extractVisibleSubtree(ContainerObject& hierObj, Container& cont, Function includeObject);
-    void getChildren(const Container& cont, unsigned int level, std::vector<TreeLine>& output);
-    template <class Predicate> void updateView(Predicate pred);
-    void applySubView(std::vector<RootNodeImpl>&& newView);
+    //calculate lazily for expanded nodes only (and their direct children): avoid mirroring the full hierarchy!
+    Container getAggregate(ContainerObject& hierObj, bool cacheResult, bool cacheChildren);
+    void getChildren(ContainerObject& hierObj, unsigned int level, std::vector<TreeLine>& output);
+    template <class Predicate> void updateView(std::vector<bool> viewFilter, Predicate pred);
+    void applySubView();
+    void updateMemoryUsage(); //call after flatTree_ or aggregates_ have grown
 
     template <bool ascending> static void sortSingleLevel(std::vector<TreeLine>& items, ColumnTypeOverview columnType);
     template <bool ascending> struct LessShortName;
 
-    std::vector<TreeLine> flatTree_; //collapsable/expandable sub-tree of folderCmpView -> always sorted!
-    /*             /|\
-                    | (update...)
+    std::vector<TreeLine> flatTree_; //collapsable/expandable sub-tree of folderCmp -> always sorted!
+    /*             /|                    | (update...)
                     |                         */
-    std::vector<RootNodeImpl> folderCmpView_; //partial view on folderCmp -> unsorted (cannot be, because files are not a separate entity)
+    struct CachedContainer
+    {
+        uint64_t changeId = 0; //ContainerObject::getChangeId() at the time of calculation
+        Container cont;
+    };
+    std::unordered_map<const ContainerObject*, CachedContainer> aggregates_; //weak pointers: *never dereference*!
+    //=> incremental invalidation: only the containers on the path to a changed item have a new change ID
+
+    std::vector<bool> lastViewFilter_; //aggregates_ are only valid for the same filter
     std::function<bool(const FileSystemObject& fsObj)> lastViewFilterPred_; //buffer view filter predicate for lazy evaluation of files/symlinks corresponding to a TYPE_FILES node
-    /*             /|\
-                    | (update...)
+    /*             /|                    | (update...)
                     |                         */
     std::vector<std::shared_ptr<BaseFolderPair>> folderCmp_; //full raw data
 
     SortInfo currentSort_;
+
+    MemoryUsageTracker memoryUsage_{MemoryCategory::viewIndex};
 };
 
 
@@ -48,9 +48,82 @@ void zen::libcurlTearDown()
 }
 
 
-HttpSession::HttpSession(const Zstring& server, bool useTls, const Zstring& caCertFilePath) : //throw SysError
+HttpSessionShare::HttpSessionShare() //noexcept
+{
+    shareHandle_ = ::curl_share_init();
+    if (!shareHandle_) //only memory allocation may fail
+    {
+        assert(false);
+        return;
+    }
+
+    using LockFunType = void (*)(CURL* handle, curl_lock_data data, curl_lock_access access, void* userptr); //needed for cdecl function pointer cast
+    LockFunType lockFun =     [](CURL* handle, curl_lock_data data, curl_lock_access access, void* userptr)
+    {
+        static_cast<HttpSessionShare*>(userptr)->getLock(data).lock();
+    };
+    using UnlockFunType = void (*)(CURL* handle, curl_lock_data data, void* userptr);
+    UnlockFunType unlockFun =   [](CURL* handle, curl_lock_data data, void* userptr)
+    {
+        static_cast<HttpSessionShare*>(userptr)->getLock(data).unlock();
+    };
+
+    //set locking callbacks first: libcurl uses them as soon as sharing is enabled
+    [[maybe_unused]] const CURLSHcode rc1 = ::curl_share_setopt(shareHandle_, CURLSHOPT_LOCKFUNC, lockFun);
+    assert(rc1 == CURLSHE_OK);
+    [[maybe_unused]] const CURLSHcode rc2 = ::curl_share_setopt(shareHandle_, CURLSHOPT_UNLOCKFUNC, unlockFun);
+    assert(rc2 == CURLSHE_OK);
+    [[maybe_unused]] const CURLSHcode rc3 = ::curl_share_setopt(shareHandle_, CURLSHOPT_USERDATA, this);
+    assert(rc3 == CURLSHE_OK);
+
+    [[maybe_unused]] const CURLSHcode rc4 = ::curl_share_setopt(shareHandle_, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    assert(rc4 == CURLSHE_OK);
+    [[maybe_unused]] const CURLSHcode rc5 = ::curl_share_setopt(shareHandle_, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION); //see ftp.cpp: broken for parallel FTP, but fine for HTTPS
+    assert(rc5 == CURLSHE_OK);
+    [[maybe_unused]] const CURLSHcode rc6 = ::curl_share_setopt(shareHandle_, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT); //connection pool: libcurl 7.57+
+    assert(rc6 == CURLSHE_OK);
+}
+
+
+HttpSessionShare::~HttpSessionShare()
+{
+    if (shareHandle_)
+    {
+        [[maybe_unused]] const CURLSHcode rc = ::curl_share_cleanup(shareHandle_); //closes pooled connections
+        assert(rc == CURLSHE_OK); //CURLSHE_IN_USE: some HttpSession outlived us!?
+    }
+}
+
+
+std::mutex& HttpSessionShare::getLock(curl_lock_data data)
+{
+    switch (data)
+    {
+        case CURL_LOCK_DATA_DNS:
+            return lockDns_;
+        case CURL_LOCK_DATA_SSL_SESSION:
+            return lockSsl_;
+        case CURL_LOCK_DATA_CONNECT:
+            return lockConnect_;
+
+        case CURL_LOCK_DATA_NONE:
+        case CURL_LOCK_DATA_SHARE:
+        case CURL_LOCK_DATA_COOKIE: //not shared
+        case CURL_LOCK_DATA_PSL:    //
+        case CURL_LOCK_DATA_HSTS:   //
+        case CURL_LOCK_DATA_LAST:
+            return lockShare_;
+    }
+    assert(false);
+    return lockShare_;
+}
+
+//-------------------------------------------------------------------------------------------------------------------
+
+HttpSession::HttpSession(const Zstring& server, bool useTls, const Zstring& caCertFilePath, const std::shared_ptr<HttpSessionShare>& share) : //throw SysError
     serverPrefix_((useTls ? "https://" : "http://") + utfTo<std::string>(server)),
-    caCertFilePath_(utfTo<std::string>(caCertFilePath)) {}
+    caCertFilePath_(utfTo<std::string>(caCertFilePath)),
+    share_(share) {}
 
 
 HttpSession::~HttpSession()
@@ -93,6 +166,12 @@ HttpSession::Result HttpSession::perform(const std::string& serverRelPath,
 
     options.emplace_back(CURLOPT_NOSIGNAL, 1); //thread-safety: https://curl.haxx.se/libcurl/c/threadsafe.html
 
+    if (share_ && share_->get())
+        options.emplace_back(CURLOPT_SHARE, share_->get());
+
+    options.emplace_back(CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS); //HTTP/2 for HTTPS if server supports it (ALPN), else HTTP/1.1
+    //CURLOPT_PIPEWAIT: no effect for the easy interface: each blocking perform() needs a connection of its own
+
     options.emplace_back(CURLOPT_CONNECTTIMEOUT, timeoutSec);
 
     //CURLOPT_TIMEOUT: "Since this puts a hard limit for how long time a request is allowed to take, it has limited use in dynamic use cases with varying transfer times."
@@ -9,6 +9,8 @@
 
 #include <chrono>
 #include <span>
+#include <mutex>
+#include <memory>
 #include <functional>
 #include <zen/sys_error.h>
 
@@ -40,10 +42,35 @@ struct CurlOption
 };
 
 
+//share DNS cache, TLS session tickets and connection pool between HttpSession instances (thread-safe)
+//=> idle connections survive the HttpSession that created them, and parallel sessions to the same server skip full TLS handshakes
+class HttpSessionShare
+{
+public:
+    HttpSessionShare(); //noexcept: no sharing if libcurl fails to initialize
+    ~HttpSessionShare();
+
+    CURLSH* get() const { return shareHandle_; } //nullptr if not available
+
+private:
+    HttpSessionShare           (const HttpSessionShare&) = delete;
+    HttpSessionShare& operator=(const HttpSessionShare&) = delete;
+
+    std::mutex& getLock(curl_lock_data data);
+
+    CURLSH* shareHandle_ = nullptr;
+    std::mutex lockShare_;
+    std::mutex lockDns_;
+    std::mutex lockSsl_;
+    std::mutex lockConnect_;
+};
+
+
 class HttpSession
 {
 public:
-    HttpSession(const Zstring& server, bool useTls, const Zstring& caCertFilePath /*optional*/); //throw SysError
+    HttpSession(const Zstring& server, bool useTls, const Zstring& caCertFilePath /*optional*/,
+                const std::shared_ptr<HttpSessionShare>& share = nullptr /*optional*/); //throw SysError
     ~HttpSession();
 
     struct Result
@@ -66,6 +93,7 @@ private:
 
     const std::string serverPrefix_;
     const std::string caCertFilePath_; //optional
+    const std::shared_ptr<HttpSessionShare> share_; //optional; must outlive easyHandle_
     CURL* easyHandle_ = nullptr;
     std::chrono::steady_clock::time_point lastSuccessfulUseTime_ = std::chrono::steady_clock::now();
 };
@@ -7,6 +7,8 @@
 #include "grid.h"
 #include <cassert>
 #include <set>
+#include <map>
+#include <unordered_map>
 #include <chrono>
 #include <wx/settings.h>
 #include <wx/listbox.h>
@@ -16,6 +18,7 @@
 #include <zen/basic_math.h>
 #include <zen/string_tools.h>
 #include <zen/scope_guard.h>
+#include <zen/thread.h>
 #include <zen/utf.h>
 #include <zen/zstring.h>
 #include <zen/format_unit.h>
@@ -84,6 +87,89 @@ bool renderAsEnabled(wxWindow& win)
     else
         return win.IsThisEnabled();
 }
+
+
+struct TextLayout
+{
+    wxString text; //truncated + ellipsis, if needed
+    wxSize extent;
+};
+
+TextLayout truncateText(wxDC& dc, const std::wstring& text, int maxWidth)
+{
+    TextLayout layout{text, dc.GetTextExtent(text)};
+
+    if (layout.extent.GetWidth() > maxWidth)
+    {
+        //unlike Windows Explorer, we truncate UTF-16 correctly: e.g. CJK-Ideogramm encodes to TWO wchar_t: utfTo<std::wstring>("\xf0\xa4\xbd\x9c");
+        size_t low  = 0;                   //number of unicode chars!
+        size_t high = unicodeLength(text); //
+        if (high > 1)
+            for (;;)
+            {
+                if (high - low <= 1)
+                {
+                    if (low == 0)
+                    {
+                        layout.text   = ELLIPSIS;
+                        layout.extent = dc.GetTextExtent(ELLIPSIS);
+                    }
+                    break;
+                }
+                const size_t middle = (low + high) / 2; //=> never 0 when "high - low > 1"
+
+                const wxString candidate = getUnicodeSubstring(text, 0, middle) + ELLIPSIS;
+                const wxSize extentCand = dc.GetTextExtent(candidate); //perf: most expensive call of this routine!
+
+                if (extentCand.GetWidth() <= maxWidth)
+                {
+                    low = middle;
+                    layout.text   = candidate;
+                    layout.extent = extentCand;
+                }
+                else
+                    high = middle;
+            }
+    }
+    return layout;
+}
+
+
+//each paint re-measures the same cell texts: buffer text extent + ellipsis search per (font, column width, text)
+class TextLayoutBuffer
+{
+public:
+    const TextLayout& get(wxDC& dc, const std::wstring& text, int maxWidth)
+    {
+        assert(runningOnMainThread()); //wxWidgets is not thread-safe!
+        const wxFont& font = dc.GetFont();
+
+        auto& layouts = buffer_[{font.GetRefData(), maxWidth}];
+        if (auto it = layouts.find(text);
+            it != layouts.end())
+            return it->second;
+
+        if (entryCount_ >= BUFFER_SIZE_MAX)
+        {
+            buffer_.clear(); //buffered texts are cheap to recreate: no need for LRU
+            fonts_ .clear();
+            entryCount_ = 0;
+            return get(dc, text, maxWidth);
+        }
+
+        fonts_.try_emplace(font.GetRefData(), font); //keep font alive => ref data address can't be reused by a different font
+        ++entryCount_;
+        return layouts.emplace(text, truncateText(dc, text, maxWidth)).first->second;
+    }
+
+private:
+    static constexpr size_t BUFFER_SIZE_MAX = 20'000;
+
+    std::map<std::pair<const wxObjectRefData* /*font*/, int /*maxWidth*/>, std::unordered_map<std::wstring, TextLayout>> buffer_;
+    std::map<const wxObjectRefData*, wxFont> fonts_;
+    size_t entryCount_ = 0;
+};
+TextLayoutBuffer globalTextLayoutBuffer;
 }
 
 //----------------------------------------------------------------------------------------------------------------
@@ -158,42 +244,19 @@ void GridData::drawCellText(wxDC& dc, const wxRect& rect, const std::wstring& te
         return;
 
     //truncate large texts and add ellipsis
-    wxString textTrunc = text;
-    wxSize extentTrunc = textExtentHint ? *textExtentHint : dc.GetTextExtent(text);
     assert(!textExtentHint || *textExtentHint == dc.GetTextExtent(text)); //"trust, but verify" :>
-
-    if (extentTrunc.GetWidth() > rect.width)
+    const TextLayout* layout = nullptr;
+    TextLayout layoutHint;
+    if (textExtentHint && textExtentHint->GetWidth() <= rect.width)
     {
-        //unlike Windows Explorer, we truncate UTF-16 correctly: e.g. CJK-Ideogramm encodes to TWO wchar_t: utfTo<std::wstring>("\xf0\xa4\xbd\x9c");
-        size_t low  = 0;                   //number of unicode chars!
-        size_t high = unicodeLength(text); //
-        if (high > 1)
-            for (;;)
-            {
-                if (high - low <= 1)
-                {
-                    if (low == 0)
-                    {
-                        textTrunc   = ELLIPSIS;
-                        extentTrunc = dc.GetTextExtent(ELLIPSIS);
-                    }
-                    break;
-                }
-                const size_t middle = (low + high) / 2; //=> never 0 when "high - low > 1"
-
-                const wxString candidate = getUnicodeSubstring(text, 0, middle) + ELLIPSIS;
-                const wxSize extentCand = dc.GetTextExtent(candidate); //perf: most expensive call of this routine!
-
-                if (extentCand.GetWidth() <= rect.width)
-                {
-                    low = middle;
-                    textTrunc   = candidate;
-                    extentTrunc = extentCand;
-                }
-                else
-                    high = middle;
-            }
+        layoutHint = {text, *textExtentHint}; //no truncation needed: skip buffer lookup
+        layout = &layoutHint;
     }
+    else
+        layout = &globalTextLayoutBuffer.get(dc, text, rect.width);
+
+    const wxString& textTrunc   = layout->text;
+    const wxSize&   extentTrunc = layout->extent;
 
     wxPoint pt = rect.GetTopLeft();
     if (alignment & wxALIGN_RIGHT) //note: wxALIGN_LEFT == 0!
@@ -1416,6 +1479,19 @@ private:
         rowLabelWin_.Update(); //update while dragging scroll thumb
     }
 
+    void refreshRows(size_t rowFirst, size_t rowLast) //[rowFirst, rowLast)
+    {
+        const auto& [rowFirstVis, rowLastVis] = refParent().getVisibleRows(GetClientRect());
+        rowFirst = std::max(rowFirst, static_cast<size_t>(rowFirstVis));
+        rowLast  = std::min(rowLast,  static_cast<size_t>(rowLastVis));
+        if (rowFirst < rowLast)
+        {
+            const int rowHeight = rowLabelWin_.getRowHeight();
+            const wxPoint topLeft = refParent().CalcScrolledPosition(wxPoint(0, static_cast<int>(rowFirst) * rowHeight)); //logical -> window coordinates
+            RefreshRect(wxRect(topLeft, wxSize(GetClientSize().GetWidth(), static_cast<int>(rowLast - rowFirst) * rowHeight)));
+        }
+    }
+
     void refreshRow(size_t row)
     {
         const wxRect& rowArea = rowLabelWin_.getRowLabelArea(row); //returns empty rect if row not found
@@ -1903,7 +1979,7 @@ void Grid::selectRange2(size_t rowFirst, size_t rowLast, bool positive, const Gr
     rowLast  = std::clamp<size_t>(rowLast,  0, rowCount);
 
     selection_.selectRange(rowFirst, rowLast, positive);
-    mainWin_->Refresh();
+    mainWin_->refreshRows(rowFirst, rowLast); //repaint affected rows only
 
     if (rangeEventPolicy == GridEventPolicy::allow)
     {
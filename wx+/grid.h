@@ -7,6 +7,7 @@
 #ifndef GRID_H_834702134831734869987
 #define GRID_H_834702134831734869987
 
+#include <map>
 #include <memory>
 #include <numeric>
 #include <optional>
@@ -110,6 +111,7 @@ public:
 
     //cell area:
     virtual std::wstring getValue(size_t row, ColumnType colType) const = 0;
+    virtual uint64_t getValueVersion() const { return 0; } //changes whenever getValue() may return different results: allow clients to buffer values; 0: don't buffer
     virtual void         renderRowBackgound(wxDC& dc, const wxRect& rect, size_t row,                     bool enabled, bool selected, HoverArea rowHover); //default implementation
     virtual void         renderCell        (wxDC& dc, const wxRect& rect, size_t row, ColumnType colType, bool enabled, bool selected, HoverArea rowHover);
     virtual int          getBestSize       (wxDC& dc, size_t row, ColumnType colType); //must correspond to renderCell()!
@@ -188,6 +190,7 @@ public:
     void showScrollBars(ScrollBarStatus horizontal, ScrollBarStatus vertical);
 
     std::vector<size_t> getSelectedRows() const { return selection_.get(); }
+    std::vector<std::pair<size_t, size_t>> getSelectedRanges() const { return selection_.getRanges(); } //[rowFirst, rowLast), sorted, disjoint
 
     void selectRow(size_t row, GridEventPolicy rangeEventPolicy);
     void selectAllRows (GridEventPolicy rangeEventPolicy); //turn off range selection event when calling this function in an event handler to avoid recursion!
@@ -251,40 +254,75 @@ private:
     class ColLabelWin;
     class MainWin;
 
-    class Selection
+    class Selection //interval set: select all/shift+click ranges on millions of rows are O(ranges), not O(rows)
     {
     public:
-        void init(size_t rowCount) { selected_.resize(rowCount); clear(); }
+        void init(size_t rowCount) { rowCount_ = rowCount; clear(); }
 
-        size_t gridSize() const { return selected_.size(); }
+        size_t gridSize() const { return rowCount_; }
 
         std::vector<size_t> get() const
         {
             std::vector<size_t> result;
-            for (size_t row = 0; row < selected_.size(); ++row)
-                if (selected_[row] != 0)
+            for (const auto& [rowFirst, rowLast] : ranges_)
+                for (size_t row = rowFirst; row < rowLast; ++row)
                     result.push_back(row);
             return result;
         }
 
-        void clear() { selectRange(0, selected_.size(), false); }
+        std::vector<std::pair<size_t, size_t>> getRanges() const { return {ranges_.begin(), ranges_.end()}; }
 
-        bool isSelected(size_t row) const { return row < selected_.size() ? selected_[row] != 0 : false; }
+        void clear() { ranges_.clear(); }
+
+        bool isSelected(size_t row) const
+        {
+            auto it = ranges_.upper_bound(row);
+            return it != ranges_.begin() && row < (--it)->second;
+        }
 
         void selectRange(size_t rowFirst, size_t rowLast, bool positive = true) //select [rowFirst, rowLast), trims if required!
         {
             if (rowFirst <= rowLast)
             {
-                rowFirst = std::clamp<size_t>(rowFirst, 0, selected_.size());
-                rowLast  = std::clamp<size_t>(rowLast,  0, selected_.size());
-
-                std::fill(selected_.begin() + rowFirst, selected_.begin() + rowLast, positive);
+                rowFirst = std::clamp<size_t>(rowFirst, 0, rowCount_);
+                rowLast  = std::clamp<size_t>(rowLast,  0, rowCount_);
+                if (rowFirst == rowLast)
+                    return;
+
+                //first range that overlaps or (positive only) touches [rowFirst, rowLast)
+                auto it = ranges_.upper_bound(rowFirst);
+                if (it != ranges_.begin())
+                    if (auto itPrev = std::prev(it);
+                        positive ? itPrev->second >= rowFirst : itPrev->second > rowFirst)
+                        it = itPrev;
+
+                if (positive)
+                {
+                    while (it != ranges_.end() && it->first <= rowLast) //merge adjacent ranges, too
+                    {
+                        rowFirst = std::min(rowFirst, it->first);
+                        rowLast  = std::max(rowLast,  it->second);
+                        it = ranges_.erase(it);
+                    }
+                    ranges_.emplace_hint(it, rowFirst, rowLast);
+                }
+                else
+                    while (it != ranges_.end() && it->first < rowLast)
+                    {
+                        const auto [first, last] = *it;
+                        it = ranges_.erase(it);
+                        if (first < rowFirst)
+                            ranges_.emplace_hint(it, first, rowFirst);
+                        if (rowLast < last)
+                            ranges_.emplace_hint(it, rowLast, last);
+                    }
             }
             else assert(false);
         }
 
     private:
-        std::vector<unsigned char> selected_; //effectively a vector<bool> of size "number of rows"
+        size_t rowCount_ = 0;
+        std::map<size_t /*rowFirst*/, size_t /*rowLast*/> ranges_; //[rowFirst, rowLast): disjoint, not adjacent
     };
 
     struct VisibleColumn
@@ -24,6 +24,9 @@ using namespace zen;
 
 namespace
 {
+const int XBRZ_SLICE_ROWS_MIN = 16; //xbrz.h: "avoid processing single rows only; suggestion: process at least 8-16 rows"
+
+
 ImageHolder xbrzScale(int width, int height, const unsigned char* imageRgb, const unsigned char* imageAlpha, int hqScale)
 {
     assert(imageRgb && imageAlpha && width > 0 && height > 0); //see convertToVanillaImage()
@@ -49,12 +52,32 @@ ImageHolder xbrzScale(int width, int height, const unsigned char* imageRgb, cons
             *out++ = xbrz::makePixel(*alpha++, rgb[0], rgb[1], rgb[2]);
     }
     //-----------------------------------------------------
-    xbrz::scale(hqScale,       //size_t factor - valid range: 2 - SCALE_FACTOR_MAX
-                argbSrc,       //const uint32_t* src
-                xbrTrg,        //uint32_t* trg
-                width, height, //int srcWidth, int srcHeight
-                xbrz::ColorFormat::argbUnbuffered); //ColorFormat colFmt
+    auto scaleSlice = [&](int yFirst, int yLast)
+    {
+        xbrz::scale(hqScale,       //size_t factor - valid range: 2 - SCALE_FACTOR_MAX
+                    argbSrc,       //const uint32_t* src
+                    xbrTrg,        //uint32_t* trg
+                    width, height, //int srcWidth, int srcHeight
+                    xbrz::ColorFormat::argbUnbuffered, //ColorFormat colFmt
+                    xbrz::ScalerCfg(), yFirst, yLast); //non-overlapping row slices may be scaled in parallel, see xbrz.h
+    };
     //test: total xBRZ scaling time with ARGB: 300ms, ARGB unbuffered: 50ms
+
+    //images are scaled on demand => split large images (4x/5x toolbar and status images) into row slices
+    const int sliceCount = std::max(std::min(static_cast<int>(std::thread::hardware_concurrency()), height / XBRZ_SLICE_ROWS_MIN), 1);
+    if (sliceCount == 1)
+        scaleSlice(0, height);
+    else
+    {
+        std::vector<std::future<void>> slices;
+        for (int i = 1; i < sliceCount; ++i)
+            slices.push_back(runAsync([&, i] { scaleSlice(height * i / sliceCount, height * (i + 1) / sliceCount); }));
+
+        scaleSlice(0, height / sliceCount); //main thread takes the first slice
+
+        for (std::future<void>& ft : slices)
+            ft.get();
+    }
     //-----------------------------------------------------
     //convert BGRA to RGB + alpha
     ImageHolder trgImg(hqWidth, hqHeight, true /*withAlpha*/);
@@ -70,66 +93,6 @@ ImageHolder xbrzScale(int width, int height, const unsigned char* imageRgb, cons
 }
 
 
-auto getScalerTask(const std::string& imageName, const wxImage& img, int hqScale, Protected<std::vector<std::pair<std::string, ImageHolder>>>& result)
-{
-    assert(runningOnMainThread());
-    return [imageName,
-            width  = img.GetWidth(),  //
-            height = img.GetHeight(), //don't call wxWidgets functions from worker thread
-            rgb    = img.GetData(),   //
-            alpha  = img.GetAlpha(),  //
-            hqScale, &result]
-    {
-        ImageHolder ih = xbrzScale(width, height, rgb, alpha, hqScale);
-        result.access([&](std::vector<std::pair<std::string, ImageHolder>>& r) { r.emplace_back(imageName, std::move(ih)); });
-    };
-}
-
-
-class HqParallelScaler
-{
-public:
-    explicit HqParallelScaler(int hqScale) : hqScale_(hqScale) { assert(hqScale > 1); }
-
-    ~HqParallelScaler() { threadGroup_ = {}; } //imgKeeper_ must out-live threadGroup!!!
-
-    void add(const std::string& imageName, const wxImage& img)
-    {
-        assert(runningOnMainThread());
-        imgKeeper_.push_back(img); //retain (ref-counted) wxImage so that the rgb/alpha pointers remain valid after passed to threads
-        threadGroup_->run(getScalerTask(imageName, img, hqScale_, result_));
-    }
-
-    std::unordered_map<std::string, wxImage> waitAndGetResult()
-    {
-        assert(runningOnMainThread());
-        threadGroup_->wait();
-
-        std::unordered_map<std::string, wxImage> output;
-
-        result_.access([&](std::vector<std::pair<std::string, ImageHolder>>& r)
-        {
-            for (auto& [imageName, ih] : r)
-            {
-                wxImage img(ih.getWidth(), ih.getHeight(), ih.releaseRgb(), false /*static_data*/); //pass ownership
-                img.SetAlpha(ih.releaseAlpha(), false /*static_data*/);
-
-                output.emplace(imageName, std::move(img));
-            }
-        });
-        return output;
-    }
-
-private:
-    const int hqScale_;
-    std::vector<wxImage> imgKeeper_;
-    Protected<std::vector<std::pair<std::string, ImageHolder>>> result_;
-
-    using TaskType = FunctionReturnTypeT<decltype(&getScalerTask)>;
-    std::optional<ThreadGroup<TaskType>> threadGroup_{ThreadGroup<TaskType>(std::max<int>(std::thread::hardware_concurrency(), 1), Zstr("xBRZ Scaler"))};
-    //hardware_concurrency() == 0 if "not computable or well defined"
-};
-
 //================================================================================================
 //================================================================================================
 
@@ -147,10 +110,11 @@ private:
     const wxImage& getRawImage   (const std::string& name);
     const wxImage& getScaledImage(const std::string& name);
 
+    std::unordered_map<std::string, std::string> pngStreams_; //decode on first use: only a fraction of all images is needed during startup
     std::unordered_map<std::string, wxImage> imagesRaw_;
     std::unordered_map<std::string, wxImage> imagesScaled_;
 
-    std::unique_ptr<HqParallelScaler> hqScaler_;
+    int hqScale_ = 1;
 
     using OutImageKey = std::tuple<std::string /*name*/, int /*height*/>;
 
@@ -212,34 +176,12 @@ ImageBuffer::ImageBuffer(const Zstring& zipPath) //throw FileError
     wxImage::AddHandler(new wxPNGHandler/*ownership passed*/); //activate support for .png files
 
     //do we need xBRZ scaling for high quality DPI images?
-    const int hqScale = std::clamp(numeric::intDivCeil(fastFromDIP(1000), 1000), 1, xbrz::SCALE_FACTOR_MAX);
+    hqScale_ = std::clamp(numeric::intDivCeil(fastFromDIP(1000), 1000), 1, xbrz::SCALE_FACTOR_MAX);
     //even for 125% DPI scaling, "2xBRZ + bilinear downscale" gives a better result than mere "125% bilinear upscale"!
-    if (hqScale > 1)
-        hqScaler_ = std::make_unique<HqParallelScaler>(hqScale);
 
-    for (const auto& [fileName, stream] : streams)
+    for (auto& [fileName, stream] : streams)
         if (endsWith(fileName, Zstr(".png")))
-        {
-            wxMemoryInputStream wxstream(stream.c_str(), stream.size()); //stream does not take ownership of data
-
-            wxImage img(wxstream, wxBITMAP_TYPE_PNG);
-            assert(img.IsOk());
-
-            //end this alpha/no-alpha/mask/wxDC::DrawBitmap/RTL/high-contrast-scheme interoperability nightmare here and now!!!!
-            //=> there's only one type of wxImage: with alpha channel, no mask!!!
-            convertToVanillaImage(img);
-
-            const std::string imageName = utfTo<std::string>(beforeLast(fileName, Zstr("."), IfNotFoundReturn::none));
-
-            imagesRaw_.emplace(imageName, img);
-            if (hqScaler_)
-                hqScaler_->add(imageName, img); //scale in parallel!
-            else
-                imagesScaled_.emplace(imageName, img);
-
-            //wxBitmap::NewFromPNGData(stream.c_str(), stream.size())?
-            //  => Windows: just a (slow!) wrapper for wxBitmap(wxImage())!
-        }
+            pngStreams_.emplace(utfTo<std::string>(beforeLast(fileName, Zstr("."), IfNotFoundReturn::none)), std::move(stream));
         else
             assert(false);
 }
@@ -251,28 +193,47 @@ const wxImage& ImageBuffer::getRawImage(const std::string& name)
         it != imagesRaw_.end())
         return it->second;
 
-    assert(false);
-    return wxNullImage;
+    auto itStream = pngStreams_.find(name);
+    if (itStream == pngStreams_.end())
+    {
+        assert(false);
+        return wxNullImage;
+    }
+
+    wxMemoryInputStream wxstream(itStream->second.c_str(), itStream->second.size()); //stream does not take ownership of data
+
+    wxImage img(wxstream, wxBITMAP_TYPE_PNG);
+    assert(img.IsOk());
+
+    //end this alpha/no-alpha/mask/wxDC::DrawBitmap/RTL/high-contrast-scheme interoperability nightmare here and now!!!!
+    //=> there's only one type of wxImage: with alpha channel, no mask!!!
+    convertToVanillaImage(img);
+
+    //wxBitmap::NewFromPNGData(stream.c_str(), stream.size())?
+    //  => Windows: just a (slow!) wrapper for wxBitmap(wxImage())!
+
+    pngStreams_.erase(itStream);
+    return imagesRaw_.emplace(name, std::move(img)).first->second; //std::unordered_map: references remain valid
 }
 
 
 const wxImage& ImageBuffer::getScaledImage(const std::string& name)
 {
-    //test: this function is first called about 220ms after ImageBuffer::ImageBuffer() has ended
-    //      => should be enough time to finish xBRZ scaling in parallel (which takes 50ms)
-    //debug perf: extra 800-1000ms during startup
-    if (hqScaler_)
-    {
-        imagesScaled_ = hqScaler_->waitAndGetResult();
-        hqScaler_.reset();
-    }
-
     if (auto it = imagesScaled_.find(name);
         it != imagesScaled_.end())
         return it->second;
 
-    assert(false);
-    return wxNullImage;
+    const wxImage& rawImg = getRawImage(name);
+    if (hqScale_ <= 1 || !rawImg.IsOk())
+        return imagesScaled_.emplace(name, rawImg).first->second;
+
+    //scale on demand: only images actually shown pay for xBRZ (scaling everything at startup: 50ms, debug: 800-1000ms)
+    ImageHolder ih = xbrzScale(rawImg.GetWidth(), rawImg.GetHeight(), rawImg.GetData(), rawImg.GetAlpha(), hqScale_);
+
+    wxImage img(ih.getWidth(), ih.getHeight(), ih.releaseRgb(), false /*static_data*/); //pass ownership
+    img.SetAlpha(ih.releaseAlpha(), false /*static_data*/);
+
+    return imagesScaled_.emplace(name, std::move(img)).first->second;
 }
 
 
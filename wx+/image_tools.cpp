@@ -94,18 +94,34 @@ void copyImageLayover(const wxImage& src,
         for (int x = 0; x < srcWidth; ++x)
         {
             const int w1 = *srcAlpha; //alpha-composition interpreted as weighted average
-            const int w2 = numeric::intDivRound(*trgAlpha * (255 - w1), 255);
-            const int wSum = w1 + w2;
 
-            auto calcColor = [w1, w2, wSum](unsigned char colsrc, unsigned char colTrg)
+            if (w1 == 255) //opaque or fully transparent: the bulk of an icon's pixels => skip the divisions
             {
-                return static_cast<unsigned char>(wSum == 0 ? 0 : numeric::intDivRound(colsrc * w1 + colTrg * w2, wSum));
-            };
-            trgRgb[0] = calcColor(srcRgb[0], trgRgb[0]);
-            trgRgb[1] = calcColor(srcRgb[1], trgRgb[1]);
-            trgRgb[2] = calcColor(srcRgb[2], trgRgb[2]);
+                trgRgb[0] = srcRgb[0];
+                trgRgb[1] = srcRgb[1];
+                trgRgb[2] = srcRgb[2];
+                *trgAlpha = 255;
+            }
+            else if (w1 == 0)
+            {
+                if (*trgAlpha == 0)
+                    trgRgb[0] = trgRgb[1] = trgRgb[2] = 0; //same result as general case
+            }
+            else
+            {
+                const int w2 = numeric::intDivRound(*trgAlpha * (255 - w1), 255);
+                const int wSum = w1 + w2;
+
+                auto calcColor = [w1, w2, wSum](unsigned char colsrc, unsigned char colTrg)
+                {
+                    return static_cast<unsigned char>(numeric::intDivRound(colsrc * w1 + colTrg * w2, wSum)); //wSum > 0
+                };
+                trgRgb[0] = calcColor(srcRgb[0], trgRgb[0]);
+                trgRgb[1] = calcColor(srcRgb[1], trgRgb[1]);
+                trgRgb[2] = calcColor(srcRgb[2], trgRgb[2]);
 
-            *trgAlpha = static_cast<unsigned char>(wSum);
+                *trgAlpha = static_cast<unsigned char>(wSum);
+            }
 
             srcRgb += 3;
             trgRgb += 3;
@@ -281,6 +297,74 @@ wxImage zen::layOver(const wxImage& back, const wxImage& front, int alignment)
 }
 
 
+wxImage zen::greyScale(const wxImage& img)
+{
+    if (img.HasMask()) //keep mask color unchanged
+    {
+        wxImage output = img.ConvertToGreyscale(1.0 / 3, 1.0 / 3, 1.0 / 3); //treat all channels equally!
+        adjustBrightness(output, 160);
+        return output;
+    }
+
+    wxImage output = img.Copy();
+    if (unsigned char* rgb = output.GetData())
+    {
+        const int pixelCount = output.GetWidth() * output.GetHeight();
+        //integer arithmetic instead of wxImage::ConvertToGreyscale()'s per-pixel double calculation => auto-vectorized
+        for (int i = 0; i < pixelCount; ++i)
+        {
+            const unsigned char grey = static_cast<unsigned char>((rgb[3 * i] + rgb[3 * i + 1] + rgb[3 * i + 2] + 1) / 3); //= intDivRound(r + g + b, 3)
+            rgb[3 * i] = rgb[3 * i + 1] = rgb[3 * i + 2] = grey;
+        }
+    }
+    adjustBrightness(output, 160);
+    return output;
+}
+
+
+double zen::getAvgBrightness(const wxImage& img)
+{
+    const int pixelCount = img.GetWidth() * img.GetHeight();
+    const unsigned char* rgb = img.GetData();
+
+    if (pixelCount <= 0 || !rgb)
+        return 0;
+
+    if (img.HasAlpha())
+    {
+        const unsigned char* alpha = img.GetAlpha();
+
+        //calculate average weighted by alpha channel: integer sums are exact and vectorize (unlike double accumulation)
+        uint64_t dividend = 0;
+        uint64_t alphaSum = 0;
+        for (int i = 0; i < pixelCount; ++i)
+        {
+            dividend += static_cast<uint32_t>(rgb[3 * i] + rgb[3 * i + 1] + rgb[3 * i + 2]) * alpha[i];
+            alphaSum += alpha[i];
+        }
+        return alphaSum == 0 ? 0 : dividend / (3.0 * alphaSum);
+    }
+    else
+    {
+        uint64_t sum = 0;
+        for (int i = 0; i < 3 * pixelCount; ++i) //RGB
+            sum += rgb[i];
+        return sum / (3.0 * pixelCount);
+    }
+}
+
+
+void zen::brighten(wxImage& img, int level)
+{
+    if (unsigned char* rgb = img.GetData())
+    {
+        const int byteCount = 3 * img.GetWidth() * img.GetHeight(); //RGB
+        for (int i = 0; i < byteCount; ++i) //branch-free clamp => compiles to saturated SIMD add/sub
+            rgb[i] = static_cast<unsigned char>(std::clamp(rgb[i] + level, 0, 255));
+    }
+}
+
+
 wxImage zen::resizeCanvas(const wxImage& img, wxSize newSize, int alignment)
 {
     if (newSize == img.GetSize())
@@ -0,0 +1,278 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#ifndef ARENA_H_8347502873465029834756
+#define ARENA_H_8347502873465029834756
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <memory>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <unordered_map>
+
+
+namespace zen
+{
+using ArenaBlockNotify = void (*)(int64_t bytesDelta); //optional: memory accounting of allocated blocks
+
+
+/* memory pool for many small objects with the same life time, e.g. std::list<> nodes of a file hierarchy:
+    - objects are allocated back-to-back from large blocks => better locality, no per-object malloc() overhead
+    - deallocated objects are recycled via free lists per size class
+    - all memory is released at once when the arena is destroyed
+    - NOT thread-safe!                                                                      */
+class Arena
+{
+public:
+    explicit Arena(ArenaBlockNotify onBlockChange = nullptr) : onBlockChange_(onBlockChange) {}
+    ~Arena()
+    {
+        assert(bytesInUse_ == 0); //objects must be destroyed *before* their memory!
+        if (onBlockChange_)
+            for (const Block& block : blocks_)
+                onBlockChange_(-static_cast<int64_t>(block.bytes));
+    }
+
+    void* allocate(size_t bytes)
+    {
+        const size_t sizeClass = getSizeClass(bytes);
+        if (sizeClass >= SIZE_CLASS_COUNT) //rare: large objects
+            return ::operator new(bytes);
+
+#ifndef NDEBUG
+        bytesInUse_ += sizeClass * ALIGNMENT;
+#endif
+        if (FreeItem* item = freeLists_[sizeClass])
+        {
+            freeLists_[sizeClass] = item->next;
+            return item;
+        }
+
+        const size_t itemBytes = sizeClass * ALIGNMENT;
+        if (itemBytes > static_cast<size_t>(blockEnd_ - blockPos_))
+        {
+            //exponential growth: small hierarchies don't need much memory, large ones do not need many blocks
+            const size_t blockBytes = blocks_.empty() ? BLOCK_SIZE_MIN : std::min(2 * blocks_.back().bytes, BLOCK_SIZE_MAX);
+
+            blocks_.push_back({std::make_unique_for_overwrite<std::byte[]>(blockBytes), blockBytes});
+            blockPos_ = blocks_.back().mem.get();
+            blockEnd_ = blockPos_ + blockBytes;
+
+            if (onBlockChange_)
+                onBlockChange_(blockBytes);
+        }
+
+        void* mem = blockPos_;
+        blockPos_ += itemBytes;
+        return mem;
+    }
+
+    void deallocate(void* mem, size_t bytes) noexcept
+    {
+        const size_t sizeClass = getSizeClass(bytes);
+        if (sizeClass >= SIZE_CLASS_COUNT)
+            return ::operator delete(mem);
+
+#ifndef NDEBUG
+        assert(bytesInUse_ >= sizeClass * ALIGNMENT);
+        bytesInUse_ -= sizeClass * ALIGNMENT;
+#endif
+        FreeItem* item = static_cast<FreeItem*>(mem);
+        item->next = freeLists_[sizeClass];
+        freeLists_[sizeClass] = item;
+    }
+
+private:
+    Arena           (const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    static constexpr size_t ALIGNMENT = alignof(std::max_align_t); //=> all size classes are suitably aligned for any type
+    static constexpr size_t SIZE_CLASS_COUNT = 64; //objects up to 1 KB (x64)
+    static constexpr size_t BLOCK_SIZE_MIN = 4 * 1024;
+    static constexpr size_t BLOCK_SIZE_MAX = 1024 * 1024;
+
+    static size_t getSizeClass(size_t bytes) { return (std::max<size_t>(bytes, 1) + ALIGNMENT - 1) / ALIGNMENT; }
+
+    struct FreeItem { FreeItem* next; };
+    static_assert(sizeof(FreeItem) <= ALIGNMENT);
+
+    struct Block
+    {
+        std::unique_ptr<std::byte[]> mem;
+        size_t bytes;
+    };
+    const ArenaBlockNotify onBlockChange_;
+    std::vector<Block> blocks_;
+    std::byte* blockPos_ = nullptr;
+    std::byte* blockEnd_ = nullptr;
+
+    FreeItem* freeLists_[SIZE_CLASS_COUNT] = {};
+#ifndef NDEBUG
+    size_t bytesInUse_ = 0;
+#endif
+};
+
+
+//std-conforming allocator, e.g. std::list<T, ArenaAllocator<T>>
+template <class T>
+class ArenaAllocator
+{
+public:
+    using value_type = T;
+
+    explicit ArenaAllocator(Arena& arena) : arena_(&arena) {}
+
+    template <class U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena_(other.arena_) {}
+
+    T* allocate(size_t n)
+    {
+        static_assert(alignof(T) <= alignof(std::max_align_t));
+        return static_cast<T*>(arena_->allocate(n * sizeof(T)));
+    }
+    void deallocate(T* p, size_t n) noexcept { arena_->deallocate(p, n * sizeof(T)); }
+
+    template <class U>
+    bool operator==(const ArenaAllocator<U>& other) const { return arena_ == other.arena_; }
+
+private:
+    template <class U> friend class ArenaAllocator;
+
+    Arena* arena_;
+};
+
+
+/* thread-safe memory pool for short-lived data built by many threads in parallel, e.g. folder traversal output:
+    - each thread allocates from its own blocks => no lock contention after a thread's first allocation
+    - monotonic: deallocate() is a no-op, all memory is released at once when the arena is destroyed      */
+class MonotonicArena
+{
+public:
+    explicit MonotonicArena(ArenaBlockNotify onBlockChange = nullptr) : onBlockChange_(onBlockChange) {}
+    ~MonotonicArena()
+    {
+        if (onBlockChange_)
+            for (const auto& [threadId, tb] : threadBlocks_)
+                onBlockChange_(-static_cast<int64_t>(tb.bytesReserved));
+    }
+
+    void* allocate(size_t bytes)
+    {
+        bytes = (std::max<size_t>(bytes, 1) + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+        ThreadBlocks& tb = getThreadBlocks();
+
+        if (bytes > BLOCK_SIZE_MAX) //rare: large objects get a block of their own
+            return addBlock(tb, bytes);
+
+        if (bytes > static_cast<size_t>(tb.blockEnd - tb.blockPos))
+        {
+            const size_t blockBytes = std::max(tb.nextBlockBytes, bytes);
+            tb.nextBlockBytes = std::min(2 * tb.nextBlockBytes, BLOCK_SIZE_MAX);
+
+            tb.blockPos = addBlock(tb, blockBytes);
+            tb.blockEnd = tb.blockPos + blockBytes;
+        }
+
+        void* mem = tb.blockPos;
+        tb.blockPos += bytes;
+        return mem;
+    }
+
+    void deallocate(void* mem, size_t bytes) noexcept {} //memory is released by ~MonotonicArena()
+
+private:
+    MonotonicArena           (const MonotonicArena&) = delete;
+    MonotonicArena& operator=(const MonotonicArena&) = delete;
+
+    static constexpr size_t ALIGNMENT = alignof(std::max_align_t);
+    static constexpr size_t BLOCK_SIZE_MIN = 4 * 1024;
+    static constexpr size_t BLOCK_SIZE_MAX = 1024 * 1024;
+
+    struct ThreadBlocks
+    {
+        std::vector<std::unique_ptr<std::byte[]>> blocks;
+        std::byte* blockPos = nullptr;
+        std::byte* blockEnd = nullptr;
+        size_t nextBlockBytes = BLOCK_SIZE_MIN; //exponential growth: small folders don't need much memory, large ones do not need many blocks
+        size_t bytesReserved = 0;
+    };
+
+    std::byte* addBlock(ThreadBlocks& tb, size_t blockBytes)
+    {
+        std::byte* mem = tb.blocks.emplace_back(std::make_unique_for_overwrite<std::byte[]>(blockBytes)).get();
+        tb.bytesReserved += blockBytes;
+        if (onBlockChange_)
+            onBlockChange_(blockBytes);
+        return mem;
+    }
+
+    ThreadBlocks& getThreadBlocks()
+    {
+        struct ThreadCache
+        {
+            uint64_t arenaId = 0;
+            ThreadBlocks* tb = nullptr;
+        };
+        thread_local ThreadCache cache;
+
+        if (cache.arenaId != arenaId_)
+        {
+            std::lock_guard dummy(lockThreadBlocks_);
+            cache = {arenaId_, &threadBlocks_[std::this_thread::get_id()]}; //node-based container => pointer stays valid
+        }
+        return *cache.tb;
+    }
+
+    static inline std::atomic<uint64_t> arenaCount_{0};
+    const uint64_t arenaId_ = ++arenaCount_; //unique: thread cache must not match a new arena at the address of a destroyed one
+    const ArenaBlockNotify onBlockChange_;
+
+    std::mutex lockThreadBlocks_;
+    std::unordered_map<std::thread::id, ThreadBlocks> threadBlocks_;
+};
+
+
+//std-conforming allocator: no arena => plain heap allocation
+template <class T>
+class MonotonicAllocator
+{
+public:
+    using value_type = T;
+
+    MonotonicAllocator() {}
+    explicit MonotonicAllocator(MonotonicArena* arena) : arena_(arena) {}
+
+    template <class U>
+    MonotonicAllocator(const MonotonicAllocator<U>& other) : arena_(other.arena_) {}
+
+    T* allocate(size_t n)
+    {
+        static_assert(alignof(T) <= alignof(std::max_align_t));
+        return static_cast<T*>(arena_ ? arena_->allocate(n * sizeof(T)) : ::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, size_t n) noexcept
+    {
+        if (!arena_)
+            ::operator delete(p);
+    }
+
+    template <class U>
+    bool operator==(const MonotonicAllocator<U>& other) const { return arena_ == other.arena_; }
+
+private:
+    template <class U> friend class MonotonicAllocator;
+
+    MonotonicArena* arena_ = nullptr;
+};
+}
+
+#endif //ARENA_H_8347502873465029834756
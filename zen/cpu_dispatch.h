@@ -0,0 +1,148 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#ifndef CPU_DISPATCH_H_8203746519283746501
+#define CPU_DISPATCH_H_8203746519283746501
+
+#include <utility>
+#include <vector>
+
+#if defined __x86_64__ || defined __i386__
+    #define ZEN_SIMD_X86
+    #include <immintrin.h>
+#elif defined __aarch64__
+    #define ZEN_SIMD_ARM64
+    #include <arm_neon.h>
+#endif
+
+
+namespace zen
+{
+/*  runtime CPU feature dispatch: the Makefile builds one generic binary (no -march) => SIMD kernels are compiled per instruction set
+    via ZEN_TARGET_* function attributes and the best variant is picked on first use
+    - every kernel has a scalar variant: reference result for all other variants
+    - selection is cached by the caller (function-local static) => per call: one indirect call, no feature check
+    - getSimdVariants(): everything the CPU can run => verify results against scalar (see base/benchmark.cpp)    */
+enum class SimdLevel
+{
+    scalar,
+    avx2,   //x86: AVX2 + BMI2 + PCLMUL (Haswell and later)
+    avx512, //x86: AVX-512 F/BW/VL + VPCLMULQDQ (Ice Lake and later)
+    neon,   //ARM64: ASIMD is baseline => always available
+};
+
+SimdLevel getCpuSimdLevel(); //highest level supported by CPU and OS (AVX register state saved on context switch)
+const char* getSimdLevelName(SimdLevel level);
+
+#ifdef ZEN_SIMD_X86
+    #define ZEN_TARGET_AVX2   __attribute__((target("avx2,bmi2,pclmul")))
+    #define ZEN_TARGET_AVX512 __attribute__((target("avx512f,avx512bw,avx512vl,vpclmulqdq,avx2,bmi2,pclmul")))
+#endif
+
+
+template <class Function>
+struct SimdKernel
+{
+    Function* scalar = nullptr; //mandatory
+    Function* avx2   = nullptr; //optional: nullptr => fall back to next lower level
+    Function* avx512 = nullptr; //
+    Function* neon   = nullptr; //
+};
+
+//best variant available at or below "level"
+template <class Function> Function* selectSimdVariant(const SimdKernel<Function>& kernel, SimdLevel level);
+template <class Function> Function* selectSimdVariant(const SimdKernel<Function>& kernel) { return selectSimdVariant(kernel, getCpuSimdLevel()); }
+
+//all variants implemented by the kernel that this CPU can run: scalar first
+template <class Function> std::vector<std::pair<SimdLevel, Function*>> getSimdVariants(const SimdKernel<Function>& kernel);
+
+
+
+
+
+
+
+
+//------------------------- implementation -------------------------------
+inline
+SimdLevel getCpuSimdLevel()
+{
+    static const SimdLevel level = []
+    {
+#ifdef ZEN_SIMD_X86
+        __builtin_cpu_init(); //in case we're called during static initialization
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi2") && __builtin_cpu_supports("pclmul"))
+        {
+            if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512vl") &&
+                __builtin_cpu_supports("vpclmulqdq"))
+                return SimdLevel::avx512;
+            return SimdLevel::avx2;
+        }
+#elif defined ZEN_SIMD_ARM64
+        return SimdLevel::neon;
+#endif
+        return SimdLevel::scalar;
+    }();
+    return level;
+}
+
+
+inline
+const char* getSimdLevelName(SimdLevel level)
+{
+    switch (level)
+    {
+        case SimdLevel::scalar: return "scalar";
+        case SimdLevel::avx2:   return "avx2";
+        case SimdLevel::avx512: return "avx512";
+        case SimdLevel::neon:   return "neon";
+    }
+    return "unknown";
+}
+
+
+template <class Function> inline
+Function* selectSimdVariant(const SimdKernel<Function>& kernel, SimdLevel level)
+{
+    switch (level)
+    {
+        case SimdLevel::avx512:
+            if (kernel.avx512) return kernel.avx512;
+            [[fallthrough]];
+        case SimdLevel::avx2:
+            if (kernel.avx2) return kernel.avx2;
+            break;
+        case SimdLevel::neon:
+            if (kernel.neon) return kernel.neon;
+            break;
+        case SimdLevel::scalar:
+            break;
+    }
+    return kernel.scalar;
+}
+
+
+template <class Function> inline
+std::vector<std::pair<SimdLevel, Function*>> getSimdVariants(const SimdKernel<Function>& kernel)
+{
+    const SimdLevel cpuLevel = getCpuSimdLevel();
+
+    std::vector<std::pair<SimdLevel, Function*>> variants{{SimdLevel::scalar, kernel.scalar}};
+
+    if (kernel.avx2 && (cpuLevel == SimdLevel::avx2 || cpuLevel == SimdLevel::avx512))
+        variants.emplace_back(SimdLevel::avx2, kernel.avx2);
+
+    if (kernel.avx512 && cpuLevel == SimdLevel::avx512)
+        variants.emplace_back(SimdLevel::avx512, kernel.avx512);
+
+    if (kernel.neon && cpuLevel == SimdLevel::neon)
+        variants.emplace_back(SimdLevel::neon, kernel.neon);
+
+    return variants;
+}
+}
+
+#endif //CPU_DISPATCH_H_8203746519283746501
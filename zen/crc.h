@@ -7,13 +7,18 @@
 #ifndef CRC_H_23489275827847235
 #define CRC_H_23489275827847235
 
+#include <array>
+#include <iterator>
+#include <memory>
 #include "type_traits.h"
+#include "cpu_dispatch.h"
 
 
 namespace zen
 {
 uint16_t getCrc16(const std::string& str);
 uint32_t getCrc32(const std::string& str);
+uint32_t getCrc32(const void* buffer, size_t bytes);
 template <class ByteIterator> uint16_t getCrc16(ByteIterator first, ByteIterator last);
 template <class ByteIterator> uint32_t getCrc32(ByteIterator first, ByteIterator last);
 
@@ -22,7 +27,7 @@ template <class ByteIterator> uint32_t getCrc32(ByteIterator first, ByteIterator
 
 //------------------------- implementation -------------------------------
 inline uint16_t getCrc16(const std::string& str) { return getCrc16(str.begin(), str.end()); }
-inline uint32_t getCrc32(const std::string& str) { return getCrc32(str.begin(), str.end()); }
+inline uint32_t getCrc32(const std::string& str) { return getCrc32(str.data(), str.size()); }
 
 
 template <class ByteIterator> inline
@@ -61,49 +66,177 @@ uint16_t getCrc16(ByteIterator first, ByteIterator last) //http://www.sunshine2k
 }
 
 
+namespace impl
+{
+constexpr uint32_t crc32Table[] =
+{
+    0x00000000, 0x77073096, 0xee0e612c, 0x990951ba, 0x076dc419, 0x706af48f, 0xe963a535, 0x9e6495a3, 0x0edb8832, 0x79dcb8a4,
+    0xe0d5e91e, 0x97d2d988, 0x09b64c2b, 0x7eb17cbd, 0xe7b82d07, 0x90bf1d91, 0x1db71064, 0x6ab020f2, 0xf3b97148, 0x84be41de,
+    0x1adad47d, 0x6ddde4eb, 0xf4d4b551, 0x83d385c7, 0x136c9856, 0x646ba8c0, 0xfd62f97a, 0x8a65c9ec, 0x14015c4f, 0x63066cd9,
+    0xfa0f3d63, 0x8d080df5, 0x3b6e20c8, 0x4c69105e, 0xd56041e4, 0xa2677172, 0x3c03e4d1, 0x4b04d447, 0xd20d85fd, 0xa50ab56b,
+    0x35b5a8fa, 0x42b2986c, 0xdbbbc9d6, 0xacbcf940, 0x32d86ce3, 0x45df5c75, 0xdcd60dcf, 0xabd13d59, 0x26d930ac, 0x51de003a,
+    0xc8d75180, 0xbfd06116, 0x21b4f4b5, 0x56b3c423, 0xcfba9599, 0xb8bda50f, 0x2802b89e, 0x5f058808, 0xc60cd9b2, 0xb10be924,
+    0x2f6f7c87, 0x58684c11, 0xc1611dab, 0xb6662d3d, 0x76dc4190, 0x01db7106, 0x98d220bc, 0xefd5102a, 0x71b18589, 0x06b6b51f,
+    0x9fbfe4a5, 0xe8b8d433, 0x7807c9a2, 0x0f00f934, 0x9609a88e, 0xe10e9818, 0x7f6a0dbb, 0x086d3d2d, 0x91646c97, 0xe6635c01,
+    0x6b6b51f4, 0x1c6c6162, 0x856530d8, 0xf262004e, 0x6c0695ed, 0x1b01a57b, 0x8208f4c1, 0xf50fc457, 0x65b0d9c6, 0x12b7e950,
+    0x8bbeb8ea, 0xfcb9887c, 0x62dd1ddf, 0x15da2d49, 0x8cd37cf3, 0xfbd44c65, 0x4db26158, 0x3ab551ce, 0xa3bc0074, 0xd4bb30e2,
+    0x4adfa541, 0x3dd895d7, 0xa4d1c46d, 0xd3d6f4fb, 0x4369e96a, 0x346ed9fc, 0xad678846, 0xda60b8d0, 0x44042d73, 0x33031de5,
+    0xaa0a4c5f, 0xdd0d7cc9, 0x5005713c, 0x270241aa, 0xbe0b1010, 0xc90c2086, 0x5768b525, 0x206f85b3, 0xb966d409, 0xce61e49f,
+    0x5edef90e, 0x29d9c998, 0xb0d09822, 0xc7d7a8b4, 0x59b33d17, 0x2eb40d81, 0xb7bd5c3b, 0xc0ba6cad, 0xedb88320, 0x9abfb3b6,
+    0x03b6e20c, 0x74b1d29a, 0xead54739, 0x9dd277af, 0x04db2615, 0x73dc1683, 0xe3630b12, 0x94643b84, 0x0d6d6a3e, 0x7a6a5aa8,
+    0xe40ecf0b, 0x9309ff9d, 0x0a00ae27, 0x7d079eb1, 0xf00f9344, 0x8708a3d2, 0x1e01f268, 0x6906c2fe, 0xf762575d, 0x806567cb,
+    0x196c3671, 0x6e6b06e7, 0xfed41b76, 0x89d32be0, 0x10da7a5a, 0x67dd4acc, 0xf9b9df6f, 0x8ebeeff9, 0x17b7be43, 0x60b08ed5,
+    0xd6d6a3e8, 0xa1d1937e, 0x38d8c2c4, 0x4fdff252, 0xd1bb67f1, 0xa6bc5767, 0x3fb506dd, 0x48b2364b, 0xd80d2bda, 0xaf0a1b4c,
+    0x36034af6, 0x41047a60, 0xdf60efc3, 0xa867df55, 0x316e8eef, 0x4669be79, 0xcb61b38c, 0xbc66831a, 0x256fd2a0, 0x5268e236,
+    0xcc0c7795, 0xbb0b4703, 0x220216b9, 0x5505262f, 0xc5ba3bbe, 0xb2bd0b28, 0x2bb45a92, 0x5cb36a04, 0xc2d7ffa7, 0xb5d0cf31,
+    0x2cd99e8b, 0x5bdeae1d, 0x9b64c2b0, 0xec63f226, 0x756aa39c, 0x026d930a, 0x9c0906a9, 0xeb0e363f, 0x72076785, 0x05005713,
+    0x95bf4a82, 0xe2b87a14, 0x7bb12bae, 0x0cb61b38, 0x92d28e9b, 0xe5d5be0d, 0x7cdcefb7, 0x0bdbdf21, 0x86d3d2d4, 0xf1d4e242,
+    0x68ddb3f8, 0x1fda836e, 0x81be16cd, 0xf6b9265b, 0x6fb077e1, 0x18b74777, 0x88085ae6, 0xff0f6a70, 0x66063bca, 0x11010b5c,
+    0x8f659eff, 0xf862ae69, 0x616bffd3, 0x166ccf45, 0xa00ae278, 0xd70dd2ee, 0x4e048354, 0x3903b3c2, 0xa7672661, 0xd06016f7,
+    0x4969474d, 0x3e6e77db, 0xaed16a4a, 0xd9d65adc, 0x40df0b66, 0x37d83bf0, 0xa9bcae53, 0xdebb9ec5, 0x47b2cf7f, 0x30b5ffe9,
+    0xbdbdf21c, 0xcabac28a, 0x53b39330, 0x24b4a3a6, 0xbad03605, 0xcdd70693, 0x54de5729, 0x23d967bf, 0xb3667a2e, 0xc4614ab8,
+    0x5d681b02, 0x2a6f2b94, 0xb40bbe37, 0xc30c8ea1, 0x5a05df1b, 0x2d02ef8d
+};
+static_assert(std::size(crc32Table) == 256);
+static_assert(arrayHash(crc32Table) == 2988069445);
+
+//"slicing-by-8": https://create.stephan-brumme.com/crc32/#slicing-by-8-overview
+//crc32Slices[k][b]: CRC of byte b followed by k zero bytes => process 8 bytes per iteration with 8 independent table lookups
+constexpr auto generateCrc32Slices()
+{
+    std::array<std::array<uint32_t, 256>, 8> slices{};
+    for (size_t i = 0; i < 256; ++i)
+    {
+        slices[0][i] = crc32Table[i];
+        for (size_t k = 1; k < slices.size(); ++k)
+            slices[k][i] = (slices[k - 1][i] >> 8) ^ crc32Table[slices[k - 1][i] & 0xFF];
+    }
+    return slices;
+}
+inline constexpr std::array<std::array<uint32_t, 256>, 8> crc32Slices = generateCrc32Slices();
+
+
+inline uint32_t updateCrc32(uint32_t crc, unsigned char b) { return (crc >> 8) ^ crc32Table[(crc ^ b) & 0xFF]; }
+
+
+inline
+uint32_t updateCrc32Scalar(uint32_t crc, const void* buffer, size_t bytes)
+{
+    const unsigned char*       it    = static_cast<const unsigned char*>(buffer);
+    const unsigned char* const itEnd = it + bytes;
+
+    for (; itEnd - it >= 8; it += 8) //assemble words byte-wise: endian-agnostic, compiles to plain loads on little-endian
+    {
+        const uint32_t lo = crc ^ (static_cast<uint32_t>(it[0])       | static_cast<uint32_t>(it[1]) <<  8 |
+                                   static_cast<uint32_t>(it[2]) << 16 | static_cast<uint32_t>(it[3]) << 24);
+        const uint32_t hi =        static_cast<uint32_t>(it[4])       | static_cast<uint32_t>(it[5]) <<  8 |
+                                   static_cast<uint32_t>(it[6]) << 16 | static_cast<uint32_t>(it[7]) << 24;
+        crc = crc32Slices[7][ lo        & 0xFF] ^ crc32Slices[6][(lo >>  8) & 0xFF] ^
+              crc32Slices[5][(lo >> 16) & 0xFF] ^ crc32Slices[4][ lo >> 24        ] ^
+              crc32Slices[3][ hi        & 0xFF] ^ crc32Slices[2][(hi >>  8) & 0xFF] ^
+              crc32Slices[1][(hi >> 16) & 0xFF] ^ crc32Slices[0][ hi >> 24        ];
+    }
+
+    for (; it != itEnd; ++it)
+        crc = updateCrc32(crc, *it);
+
+    return crc;
+}
+
+
+#ifdef ZEN_SIMD_X86
+//folding via carry-less multiplication: https://www.intel.com/content/dam/www/public/us/en/documents/white-papers/fast-crc-computation-generic-polynomials-pclmulqdq-paper.pdf
+//constants: bit-reflected x^(k) mod P(x) for CRC-32 (IEEE 802.3) and Barrett reduction; 64 bytes per iteration in 4 independent lanes
+ZEN_TARGET_AVX2 inline
+__m128i foldCrc32Avx2(__m128i x, __m128i k, __m128i data) //x * k (both halves) + data
+{
+    return _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x, k, 0x00),
+                                       _mm_clmulepi64_si128(x, k, 0x11)), data);
+}
+
+
+ZEN_TARGET_AVX2 inline
+uint32_t updateCrc32Avx2(uint32_t crc, const void* buffer, size_t bytes)
+{
+    const unsigned char* it = static_cast<const unsigned char*>(buffer);
+
+    if (bytes >= 64)
+    {
+        auto load = [](const unsigned char* pos) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(pos)); };
+
+        __m128i x1 = _mm_xor_si128(load(it), _mm_cvtsi32_si128(static_cast<int>(crc)));
+        __m128i x2 = load(it + 16);
+        __m128i x3 = load(it + 32);
+        __m128i x4 = load(it + 48);
+        it    += 64;
+        bytes -= 64;
+
+        const __m128i k1k2 = _mm_set_epi64x(0x01c6e41596, 0x0154442bd4);
+        for (; bytes >= 64; it += 64, bytes -= 64)
+        {
+            x1 = foldCrc32Avx2(x1, k1k2, load(it));
+            x2 = foldCrc32Avx2(x2, k1k2, load(it + 16));
+            x3 = foldCrc32Avx2(x3, k1k2, load(it + 32));
+            x4 = foldCrc32Avx2(x4, k1k2, load(it + 48));
+        }
+
+        const __m128i k3k4 = _mm_set_epi64x(0x00ccaa009e, 0x01751997d0);
+        x1 = foldCrc32Avx2(x1, k3k4, x2);
+        x1 = foldCrc32Avx2(x1, k3k4, x3);
+        x1 = foldCrc32Avx2(x1, k3k4, x4);
+
+        for (; bytes >= 16; it += 16, bytes -= 16)
+            x1 = foldCrc32Avx2(x1, k3k4, load(it));
+
+        //128 bits => 64 bits
+        const __m128i mask32 = _mm_setr_epi32(~0, 0, ~0, 0);
+        x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), _mm_clmulepi64_si128(x1, k3k4, 0x10));
+
+        const __m128i k5 = _mm_set_epi64x(0, 0x0163cd6124);
+        x1 = _mm_xor_si128(_mm_clmulepi64_si128(_mm_and_si128(x1, mask32), k5, 0x00), _mm_srli_si128(x1, 4));
+
+        //Barrett reduction => 32 bits
+        const __m128i poly = _mm_set_epi64x(0x01f7011641, 0x01db710641);
+        x2 = _mm_clmulepi64_si128(_mm_and_si128(x1, mask32), poly, 0x10);
+        x2 = _mm_clmulepi64_si128(_mm_and_si128(x2, mask32), poly, 0x00);
+        crc = static_cast<uint32_t>(_mm_extract_epi32(_mm_xor_si128(x1, x2), 1));
+    }
+    return updateCrc32Scalar(crc, it, bytes); //remaining < 16 bytes
+}
+#endif
+
+
+inline constexpr SimdKernel<uint32_t(uint32_t crc, const void* buffer, size_t bytes)> crc32Kernel
+{
+    .scalar = updateCrc32Scalar,
+#ifdef ZEN_SIMD_X86
+    .avx2   = updateCrc32Avx2,
+#endif
+};
+}
+
+
+inline
+uint32_t getCrc32(const void* buffer, size_t bytes)
+{
+    static auto* const updateCrc = selectSimdVariant(impl::crc32Kernel);
+    return updateCrc(0xFFFFFFFF, buffer, bytes) ^ 0xFFFFFFFF;
+}
+
+
 template <class ByteIterator> inline
 uint32_t getCrc32(ByteIterator first, ByteIterator last) //https://en.wikipedia.org/wiki/Cyclic_redundancy_check
 {
     static_assert(sizeof(typename std::iterator_traits<ByteIterator>::value_type) == 1);
 
-    uint32_t crc = 0xFFFFFFFF;
-    std::for_each(first, last, [&](unsigned char b)
+    if constexpr (std::contiguous_iterator<ByteIterator>)
+        return getCrc32(std::to_address(first), last - first);
+    else
     {
-        constexpr uint32_t crcTable[] =
-        {
-            0x00000000, 0x77073096, 0xee0e612c, 0x990951ba, 0x076dc419, 0x706af48f, 0xe963a535, 0x9e6495a3, 0x0edb8832, 0x79dcb8a4,
-            0xe0d5e91e, 0x97d2d988, 0x09b64c2b, 0x7eb17cbd, 0xe7b82d07, 0x90bf1d91, 0x1db71064, 0x6ab020f2, 0xf3b97148, 0x84be41de,
-            0x1adad47d, 0x6ddde4eb, 0xf4d4b551, 0x83d385c7, 0x136c9856, 0x646ba8c0, 0xfd62f97a, 0x8a65c9ec, 0x14015c4f, 0x63066cd9,
-            0xfa0f3d63, 0x8d080df5, 0x3b6e20c8, 0x4c69105e, 0xd56041e4, 0xa2677172, 0x3c03e4d1, 0x4b04d447, 0xd20d85fd, 0xa50ab56b,
-            0x35b5a8fa, 0x42b2986c, 0xdbbbc9d6, 0xacbcf940, 0x32d86ce3, 0x45df5c75, 0xdcd60dcf, 0xabd13d59, 0x26d930ac, 0x51de003a,
-            0xc8d75180, 0xbfd06116, 0x21b4f4b5, 0x56b3c423, 0xcfba9599, 0xb8bda50f, 0x2802b89e, 0x5f058808, 0xc60cd9b2, 0xb10be924,
-            0x2f6f7c87, 0x58684c11, 0xc1611dab, 0xb6662d3d, 0x76dc4190, 0x01db7106, 0x98d220bc, 0xefd5102a, 0x71b18589, 0x06b6b51f,
-            0x9fbfe4a5, 0xe8b8d433, 0x7807c9a2, 0x0f00f934, 0x9609a88e, 0xe10e9818, 0x7f6a0dbb, 0x086d3d2d, 0x91646c97, 0xe6635c01,
-            0x6b6b51f4, 0x1c6c6162, 0x856530d8, 0xf262004e, 0x6c0695ed, 0x1b01a57b, 0x8208f4c1, 0xf50fc457, 0x65b0d9c6, 0x12b7e950,
-            0x8bbeb8ea, 0xfcb9887c, 0x62dd1ddf, 0x15da2d49, 0x8cd37cf3, 0xfbd44c65, 0x4db26158, 0x3ab551ce, 0xa3bc0074, 0xd4bb30e2,
-            0x4adfa541, 0x3dd895d7, 0xa4d1c46d, 0xd3d6f4fb, 0x4369e96a, 0x346ed9fc, 0xad678846, 0xda60b8d0, 0x44042d73, 0x33031de5,
-            0xaa0a4c5f, 0xdd0d7cc9, 0x5005713c, 0x270241aa, 0xbe0b1010, 0xc90c2086, 0x5768b525, 0x206f85b3, 0xb966d409, 0xce61e49f,
-            0x5edef90e, 0x29d9c998, 0xb0d09822, 0xc7d7a8b4, 0x59b33d17, 0x2eb40d81, 0xb7bd5c3b, 0xc0ba6cad, 0xedb88320, 0x9abfb3b6,
-            0x03b6e20c, 0x74b1d29a, 0xead54739, 0x9dd277af, 0x04db2615, 0x73dc1683, 0xe3630b12, 0x94643b84, 0x0d6d6a3e, 0x7a6a5aa8,
-            0xe40ecf0b, 0x9309ff9d, 0x0a00ae27, 0x7d079eb1, 0xf00f9344, 0x8708a3d2, 0x1e01f268, 0x6906c2fe, 0xf762575d, 0x806567cb,
-            0x196c3671, 0x6e6b06e7, 0xfed41b76, 0x89d32be0, 0x10da7a5a, 0x67dd4acc, 0xf9b9df6f, 0x8ebeeff9, 0x17b7be43, 0x60b08ed5,
-            0xd6d6a3e8, 0xa1d1937e, 0x38d8c2c4, 0x4fdff252, 0xd1bb67f1, 0xa6bc5767, 0x3fb506dd, 0x48b2364b, 0xd80d2bda, 0xaf0a1b4c,
-            0x36034af6, 0x41047a60, 0xdf60efc3, 0xa867df55, 0x316e8eef, 0x4669be79, 0xcb61b38c, 0xbc66831a, 0x256fd2a0, 0x5268e236,
-            0xcc0c7795, 0xbb0b4703, 0x220216b9, 0x5505262f, 0xc5ba3bbe, 0xb2bd0b28, 0x2bb45a92, 0x5cb36a04, 0xc2d7ffa7, 0xb5d0cf31,
-            0x2cd99e8b, 0x5bdeae1d, 0x9b64c2b0, 0xec63f226, 0x756aa39c, 0x026d930a, 0x9c0906a9, 0xeb0e363f, 0x72076785, 0x05005713,
-            0x95bf4a82, 0xe2b87a14, 0x7bb12bae, 0x0cb61b38, 0x92d28e9b, 0xe5d5be0d, 0x7cdcefb7, 0x0bdbdf21, 0x86d3d2d4, 0xf1d4e242,
-            0x68ddb3f8, 0x1fda836e, 0x81be16cd, 0xf6b9265b, 0x6fb077e1, 0x18b74777, 0x88085ae6, 0xff0f6a70, 0x66063bca, 0x11010b5c,
-            0x8f659eff, 0xf862ae69, 0x616bffd3, 0x166ccf45, 0xa00ae278, 0xd70dd2ee, 0x4e048354, 0x3903b3c2, 0xa7672661, 0xd06016f7,
-            0x4969474d, 0x3e6e77db, 0xaed16a4a, 0xd9d65adc, 0x40df0b66, 0x37d83bf0, 0xa9bcae53, 0xdebb9ec5, 0x47b2cf7f, 0x30b5ffe9,
-            0xbdbdf21c, 0xcabac28a, 0x53b39330, 0x24b4a3a6, 0xbad03605, 0xcdd70693, 0x54de5729, 0x23d967bf, 0xb3667a2e, 0xc4614ab8,
-            0x5d681b02, 0x2a6f2b94, 0xb40bbe37, 0xc30c8ea1, 0x5a05df1b, 0x2d02ef8d
-        };
-        static_assert(std::size(crcTable) == 256);
-        static_assert(arrayHash(crcTable) == 2988069445);
-
-        crc = (crc >> 8) ^ crcTable[(crc ^ b) & 0xFF];
-    });
-    return crc ^ 0xFFFFFFFF;
+        uint32_t crc = 0xFFFFFFFF;
+        std::for_each(first, last, [&](unsigned char b) { crc = impl::updateCrc32(crc, b); });
+        return crc ^ 0xFFFFFFFF;
+    }
 }
 }
 
@@ -7,11 +7,14 @@
 #include "dir_watcher.h"
 #include <algorithm>
 #include <set>
+#include <cstring>
 #include "thread.h"
 #include "scope_guard.h"
 
     #include <map>
+    #include <unordered_map>
     #include <sys/inotify.h>
+    #include <sys/fanotify.h>
     #include <fcntl.h> //fcntl
     #include <unistd.h> //close
     #include <limits.h> //NAME_MAX
@@ -25,13 +28,78 @@ struct DirWatcher::Impl
 {
     int notifDescr = 0;
     std::unordered_map<int, Zstring> watchedPaths; //watch descriptor and (sub-)directory paths -> owned by "notifDescr"
+    int mountDescr = -1; //fanotify: any descriptor on the watched file system (for open_by_handle_at()); -1 if inotify is used
 };
 
 
+namespace
+{
+#ifdef FAN_REPORT_DFID_NAME
+//no error reporting: caller falls back to inotify
+//  EINVAL: kernel < 5.9  EPERM: missing CAP_SYS_ADMIN  ENODEV/EOPNOTSUPP/EXDEV: file system can't encode file handles (e.g. FUSE, network shares)
+bool tryInitFanotify(const Zstring& dirPath, int& notifDescr, int& mountDescr) //noexcept
+{
+    const int fd = ::fanotify_init(FAN_CLASS_NOTIF | FAN_REPORT_DFID_NAME | FAN_UNLIMITED_QUEUE | FAN_NONBLOCK | FAN_CLOEXEC, O_RDONLY);
+    if (fd == -1)
+        return false;
+
+    if (::fanotify_mark(fd, FAN_MARK_ADD | FAN_MARK_FILESYSTEM,
+                        FAN_CREATE      |
+                        FAN_MODIFY      |
+                        FAN_CLOSE_WRITE |
+                        FAN_DELETE      |
+                        FAN_MOVED_FROM  |
+                        FAN_MOVED_TO    |
+                        FAN_ONDIR, //also report events for directories
+                        AT_FDCWD, dirPath.c_str()) != 0)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    const int mountFd = ::open(dirPath.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (mountFd == -1)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    notifDescr = fd;
+    mountDescr = mountFd;
+    return true;
+}
+
+
+//resolve the directory handle reported by fanotify: empty if no longer existing
+Zstring getFanotifyDirPath(int mountDescr, file_handle& fh) //noexcept
+{
+    const int fd = ::open_by_handle_at(mountDescr, &fh, O_PATH | O_CLOEXEC);
+    if (fd == -1) //e.g. ESTALE: directory was deleted
+        return Zstring();
+    ZEN_ON_SCOPE_EXIT(::close(fd));
+
+    std::vector<char> buf(PATH_MAX);
+    const ssize_t bytesWritten = ::readlink(("/proc/self/fd/" + numberTo<std::string>(fd)).c_str(), buf.data(), buf.size());
+    if (bytesWritten < 0 || makeUnsigned(bytesWritten) >= buf.size())
+        return Zstring();
+
+    Zstring dirPath(buf.data(), bytesWritten);
+    if (endsWith(dirPath, Zstr(" (deleted)")))
+        return Zstring();
+    return dirPath;
+}
+#endif
+}
+
+
 DirWatcher::DirWatcher(const Zstring& dirPath) : //throw FileError
     baseDirPath_(dirPath),
     pimpl_(std::make_unique<Impl>())
 {
+#ifdef FAN_REPORT_DFID_NAME
+    if (tryInitFanotify(baseDirPath_, pimpl_->notifDescr, pimpl_->mountDescr)) //no need to traverse: new subdirectories are watched automatically
+        return;
+#endif
     //get all subdirectories
     std::vector<Zstring> fullFolderList {baseDirPath_};
     {
@@ -96,11 +164,87 @@ DirWatcher::DirWatcher(const Zstring& dirPath) : //throw FileError
 DirWatcher::~DirWatcher()
 {
     ::close(pimpl_->notifDescr); //associated watches are removed automatically!
+    if (pimpl_->mountDescr != -1)
+        ::close(pimpl_->mountDescr);
 }
 
 
 std::vector<DirWatcher::Change> DirWatcher::fetchChanges(const std::function<void()>& requestUiUpdate, std::chrono::milliseconds cbInterval) //throw FileError
 {
+#ifdef FAN_REPORT_DFID_NAME
+    if (pimpl_->mountDescr != -1)
+    {
+        std::vector<std::byte> buffer(64 * 1024);
+
+        ssize_t bytesRead = 0;
+        do
+        {
+            //non-blocking call, see FAN_NONBLOCK
+            bytesRead = ::read(pimpl_->notifDescr, &buffer[0], buffer.size());
+        }
+        while (bytesRead < 0 && errno == EINTR);
+
+        if (bytesRead < 0)
+        {
+            if (errno == EAGAIN)
+                return std::vector<Change>();
+
+            THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot monitor directory %x."), L"%x", fmtPath(baseDirPath_)), "read");
+        }
+
+        const Zstring baseDirPathPf = appendSeparator(baseDirPath_);
+        std::unordered_map<std::string, Zstring> dirPathBuf; //file handle => path; don't keep between calls: directories may be moved
+
+        std::vector<Change> output;
+
+        fanotify_event_metadata* evt = reinterpret_cast<fanotify_event_metadata*>(&buffer[0]);
+        for (size_t bytesLeft = bytesRead; FAN_EVENT_OK(evt, bytesLeft); evt = FAN_EVENT_NEXT(evt, bytesLeft))
+        {
+            if (evt->vers != FANOTIFY_METADATA_VERSION)
+                throw FileError(replaceCpy(_("Cannot monitor directory %x."), L"%x", fmtPath(baseDirPath_)), L"Unexpected fanotify metadata version.");
+
+            if (evt->mask & FAN_Q_OVERFLOW) //shouldn't happen: FAN_UNLIMITED_QUEUE
+                throw FileError(replaceCpy(_("Cannot monitor directory %x."), L"%x", fmtPath(baseDirPath_)), L"Event queue overflow.");
+
+            //the whole file system is watched => filter events outside the base directory
+            for (size_t infoPos = evt->metadata_len; infoPos + sizeof(fanotify_event_info_header) <= evt->event_len;)
+            {
+                auto& info = *reinterpret_cast<fanotify_event_info_fid*>(reinterpret_cast<std::byte*>(evt) + infoPos);
+                if (info.hdr.len == 0)
+                    break;
+                infoPos += info.hdr.len;
+
+                if (info.hdr.info_type != FAN_EVENT_INFO_TYPE_DFID_NAME)
+                    continue;
+
+                auto& fh = *reinterpret_cast<file_handle*>(info.handle);
+                const char* itemName = reinterpret_cast<const char*>(fh.f_handle + fh.handle_bytes);
+                if (itemName[0] == 0 || std::strcmp(itemName, ".") == 0) //exclude events for "self", analog to inotify
+                    continue;
+
+                const std::string handleKey(reinterpret_cast<const char*>(&fh.handle_type), sizeof(fh.handle_type) + fh.handle_bytes);
+                auto itDir = dirPathBuf.find(handleKey);
+                if (itDir == dirPathBuf.end())
+                    itDir = dirPathBuf.emplace(handleKey, getFanotifyDirPath(pimpl_->mountDescr, fh)).first;
+
+                const Zstring& parentPath = itDir->second;
+                if (parentPath.empty() || (parentPath != baseDirPath_ && !startsWith(parentPath, baseDirPathPf)))
+                    continue;
+
+                const Zstring itemPath = appendPath(parentPath, itemName);
+
+                if (evt->mask & (FAN_CREATE | FAN_MOVED_TO))
+                    output.push_back({ChangeType::create, itemPath});
+                else if (evt->mask & (FAN_MODIFY | FAN_CLOSE_WRITE))
+                    output.push_back({ChangeType::update, itemPath});
+                else if (evt->mask & (FAN_DELETE | FAN_MOVED_FROM))
+                    output.push_back({ChangeType::remove, itemPath});
+            }
+        }
+        return output;
+    }
+#endif
+
     std::vector<std::byte> buffer(512 * (sizeof(inotify_event) + NAME_MAX + 1));
 
     ssize_t bytesRead = 0;
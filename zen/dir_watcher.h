@@ -17,7 +17,8 @@
 namespace zen
 {
 //Windows: ReadDirectoryChangesW https://docs.microsoft.com/en-us/windows/win32/api/winbase/nf-winbase-readdirectorychangesw
-//Linux:   inotify               https://linux.die.net/man/7/inotify
+//Linux:   fanotify              https://man7.org/linux/man-pages/man7/fanotify.7.html
+//         inotify (fallback)    https://linux.die.net/man/7/inotify
 //macOS:   kqueue                https://developer.apple.com/library/mac/documentation/Darwin/Reference/ManPages/man2/kqueue.2.html
 
 //watch directory including subdirectories
@@ -31,6 +32,8 @@ namespace zen
 
     Linux: newly added subdirectories are reported but not automatically added for watching! -> reset Dirwatcher!
            removal of base directory is NOT notified!
+           fanotify (kernel 5.9+, requires CAP_SYS_ADMIN + CAP_DAC_READ_SEARCH) watches the whole file system with a single mark
+           => no per-folder watches, new subdirectories are included; else falls back to inotify (one watch per folder)
 
     macOS: everything works as expected; renaming of base directory is also detected
 
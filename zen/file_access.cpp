@@ -8,6 +8,8 @@
 #include <map>
 #include <algorithm>
 #include <chrono>
+#include <array>
+#include <atomic>
 #include "file_traverser.h"
 #include "scope_guard.h"
 #include "symlink_target.h"
@@ -23,6 +25,15 @@
 
     #include <fcntl.h> //open, close, AT_SYMLINK_NOFOLLOW, UTIME_OMIT
     #include <sys/stat.h>
+    #include <sys/ioctl.h>    //ioctl
+    #include <sys/sendfile.h> //sendfile
+    #include <sys/mman.h>     //mmap
+    #include <csetjmp>        //sigsetjmp
+    #include <csignal>        //sigaction
+    #include <sys/syscall.h>  //io_uring_setup, io_uring_enter
+    #include <linux/fs.h>     //FICLONE, FS_IOC_FIEMAP
+    #include <linux/fiemap.h>
+    #include <linux/io_uring.h>
 
 using namespace zen;
 
@@ -558,8 +569,667 @@ void zen::copySymlink(const Zstring& sourcePath, const Zstring& targetPath) //th
 }
 
 
+namespace
+{
+/* let the kernel do the copying if possible:
+    1. FICLONE:         reflink => copy-on-write, no data transfer at all (Btrfs, XFS, OCFS2)
+    2. copy_file_range: in-kernel copy, possibly server-side (NFSv4.2, SMB3) or offloaded to storage
+    3. sendfile:        in-kernel copy, at least avoids the round trip through user space
+
+    returns false if not supported for this source/target combination => caller falls back to user-space copy
+    CONTRACT: both file offsets at 0, target file empty                                                        */
+bool isKernelCopyUnsupported(int ec)
+{
+    return ec == EXDEV      || //different file systems (copy_file_range before kernel 5.3)
+           ec == EOPNOTSUPP || //file system does not support reflinks
+           ec == ENOTTY     || //ioctl not supported
+           ec == ENOSYS     || //syscall not available
+           ec == EINVAL     || //unsupported file types or flags (e.g. FICLONE across subvolumes/mount points)
+           ec == EPERM      || //e.g. overlayfs
+           ec == ETXTBSY;      //
+}
+
+
+bool tryCloneFile(int fdSource, int fdTarget, uint64_t fileSize, const Zstring& sourceFile, const Zstring& targetFile, //throw FileError, X
+                  const IoCallback& notifyUnbufferedIO /*throw X*/)
+{
+    if (::ioctl(fdTarget, FICLONE, fdSource) == 0)
+    {
+        if (notifyUnbufferedIO) notifyUnbufferedIO(fileSize); //throw X
+        return true;
+    }
+    if (!isKernelCopyUnsupported(errno))
+        THROW_LAST_FILE_ERROR(replaceCpy(replaceCpy(_("Cannot copy file %x to %y."), L"%x", L'\n' + fmtPath(sourceFile)), L"%y", L'\n' + fmtPath(targetFile)), "FICLONE");
+    return false;
+}
+
+
+bool tryCopyFileKernel(int fdSource, int fdTarget, const Zstring& sourceFile, const Zstring& targetFile, //throw FileError, X
+                       const IoCallback& notifyUnbufferedIO /*throw X*/)
+{
+    //use larger blocks than FileBase::getBlockSize(): no user-space buffer involved, but still report progress reasonably often
+    const size_t blockSize = 8 * 1024 * 1024;
+
+    //in-kernel copy still goes through the page cache (except for server-side copies)
+    PageCacheDropper cacheDropperIn (fdSource, false /*writeBehind*/);
+    PageCacheDropper cacheDropperOut(fdTarget, true  /*writeBehind*/);
+
+    for (const bool useSendfile : {false, true})
+    {
+        uint64_t bytesCopied = 0;
+        for (;;)
+        {
+            const ssize_t bytesDelta = useSendfile ?
+                                       ::sendfile(fdTarget, fdSource, nullptr /*offset*/, blockSize) :
+                                       ::copy_file_range(fdSource, nullptr /*off_in*/, fdTarget, nullptr /*off_out*/, blockSize, 0 /*flags*/);
+            if (bytesDelta < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+
+                //file offsets are unchanged if nothing was copied yet => try next method:
+                if (bytesCopied == 0 && isKernelCopyUnsupported(errno))
+                    break;
+
+                THROW_LAST_FILE_ERROR(replaceCpy(replaceCpy(_("Cannot copy file %x to %y."), L"%x", L'\n' + fmtPath(sourceFile)), L"%y", L'\n' + fmtPath(targetFile)),
+                                      useSendfile ? "sendfile" : "copy_file_range");
+            }
+            if (bytesDelta == 0) //EOF
+            {
+                if (bytesCopied == 0) //empty file, or pseudo file with st_size == 0 (e.g. procfs) which copy_file_range() can't handle
+                    return false;     //=> let user-space copy decide
+
+                cacheDropperIn .notifyStreamEnd(bytesCopied); //noexcept
+                cacheDropperOut.notifyStreamEnd(bytesCopied); //
+                return true;
+            }
+
+            bytesCopied += bytesDelta;
+            cacheDropperIn .notifyStreamPos(bytesCopied); //noexcept
+            cacheDropperOut.notifyStreamPos(bytesCopied); //
+            if (notifyUnbufferedIO) notifyUnbufferedIO(bytesDelta); //throw X
+        }
+    }
+    return false;
+}
+
+//st_blocks: number of 512-byte units allocated
+bool isSparseFile(const struct stat& fileInfo) { return static_cast<uint64_t>(fileInfo.st_blocks) * 512 < static_cast<uint64_t>(fileInfo.st_size); }
+
+struct DataExtent
+{
+    uint64_t offset = 0;
+    uint64_t length = 0;
+};
+
+//data extents according to SEEK_DATA/SEEK_HOLE; everything else is a hole (reads as zeros)
+//returns std::nullopt if hole detection is not supported by the file system
+std::optional<std::vector<DataExtent>> getDataExtents(int fd, uint64_t fileSize, const Zstring& filePath) //throw FileError
+{
+    std::vector<DataExtent> extents;
+    for (uint64_t pos = 0; pos < fileSize;)
+    {
+        const off_t dataPos = ::lseek(fd, pos, SEEK_DATA);
+        if (dataPos == -1)
+        {
+            if (errno == ENXIO) //no more data until end of file
+                break;
+            if (errno == EINVAL) //SEEK_DATA not supported
+                return std::nullopt;
+            THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(filePath)), "lseek(SEEK_DATA)");
+        }
+        const off_t holePos = ::lseek(fd, dataPos, SEEK_HOLE); //there's always an implicit hole at the end of the file
+        if (holePos == -1)
+            THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(filePath)), "lseek(SEEK_HOLE)");
+
+        const uint64_t extentEnd = std::min(static_cast<uint64_t>(holePos), fileSize);
+        if (static_cast<uint64_t>(dataPos) >= extentEnd) //file changed in the meantime?
+            break;
+        extents.push_back({static_cast<uint64_t>(dataPos), extentEnd - dataPos});
+        pos = extentEnd;
+    }
+    return extents;
+}
+
+
+size_t preadNoEintr(int fd, void* buffer, size_t bytesToRead, uint64_t offset, const Zstring& filePath) //throw FileError; may return short, only 0 means EOF!
+{
+    ssize_t bytesRead = 0;
+    do
+    {
+        bytesRead = ::pread(fd, buffer, bytesToRead, offset);
+    }
+    while (bytesRead < 0 && errno == EINTR);
+
+    if (bytesRead < 0)
+        THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(filePath)), "pread");
+    return bytesRead;
+}
+
+
+void pwriteAll(int fd, const void* buffer, size_t bytesToWrite, uint64_t offset, const Zstring& filePath) //throw FileError
+{
+    for (size_t bytesWritten = 0; bytesWritten < bytesToWrite;)
+    {
+        const ssize_t rv = ::pwrite(fd, static_cast<const std::byte*>(buffer) + bytesWritten, bytesToWrite - bytesWritten, offset + bytesWritten);
+        if (rv <= 0)
+        {
+            if (rv < 0 && errno == EINTR)
+                continue;
+            if (rv == 0) //comment in safe-read.c suggests to treat this as an error due to buggy drivers
+                errno = ENOSPC;
+            THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(filePath)), "pwrite");
+        }
+        bytesWritten += rv;
+    }
+}
+
+
+/* sparse files (e.g. VM images, databases): copy the data extents only
+    - holes are not written => remain holes on the (empty) target file
+    - onSourceData() sees the holes as zeros, just like a regular read
+    - returns false if hole detection is not supported
+    - CONTRACT: target file empty                                                */
+bool tryCopyFileSparse(int fdSource, int fdTarget, uint64_t fileSize, const Zstring& sourceFile, const Zstring& targetFile, //throw FileError, X
+                       const IoCallback& notifyUnbufferedIO /*throw X*/,
+                       const std::function<void(const void* buffer, size_t bytes)>& onSourceData /*throw X*/)
+{
+    const std::optional<std::vector<DataExtent>> extents = getDataExtents(fdSource, fileSize, sourceFile); //throw FileError
+    if (!extents)
+        return false;
+
+    const size_t blockSize = 1024 * 1024;
+    std::vector<std::byte> buffer(blockSize);
+
+    PageCacheDropper cacheDropperIn (fdSource, false /*writeBehind*/);
+    PageCacheDropper cacheDropperOut(fdTarget, true  /*writeBehind*/);
+
+    uint64_t pos = 0;
+    auto skipHole = [&](uint64_t holeEnd) //throw X
+    {
+        assert(pos <= holeEnd);
+        if (onSourceData)
+        {
+            std::memset(&buffer[0], 0, blockSize);
+            for (uint64_t holePos = pos; holePos < holeEnd; holePos += blockSize)
+                onSourceData(&buffer[0], static_cast<size_t>(std::min<uint64_t>(blockSize, holeEnd - holePos))); //throw X
+        }
+        if (notifyUnbufferedIO && holeEnd > pos) notifyUnbufferedIO(holeEnd - pos); //throw X
+        pos = holeEnd;
+    };
+
+    for (const DataExtent& extent : *extents)
+    {
+        skipHole(extent.offset); //throw X
+
+        for (const uint64_t extentEnd = extent.offset + extent.length; pos < extentEnd;)
+        {
+            const size_t bytesRead = preadNoEintr(fdSource, &buffer[0], static_cast<size_t>(std::min<uint64_t>(blockSize, extentEnd - pos)), pos, sourceFile); //throw FileError
+            if (bytesRead == 0) //file was truncated in the meantime
+                throw FileError(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(sourceFile)), L"Unexpected end of file.");
+
+            if (onSourceData) onSourceData(&buffer[0], bytesRead); //throw X
+
+            pwriteAll(fdTarget, &buffer[0], bytesRead, pos, targetFile); //throw FileError
+            pos += bytesRead;
+
+            cacheDropperIn .notifyStreamPos(pos); //noexcept
+            cacheDropperOut.notifyStreamPos(pos); //
+            if (notifyUnbufferedIO) notifyUnbufferedIO(bytesRead); //throw X
+        }
+    }
+    skipHole(fileSize); //throw X
+
+    //trailing hole: set file size without allocating
+    if (::ftruncate(fdTarget, fileSize) != 0)
+        THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(targetFile)), "ftruncate");
+
+    cacheDropperIn .notifyStreamEnd(pos); //noexcept
+    cacheDropperOut.notifyStreamEnd(pos); //
+    return true;
+}
+
+
+/* keep several reads and writes in flight per file: queue depth 1 leaves most of the throughput of NVMe and network file systems unused
+    - kernel ABI via <linux/io_uring.h> is all we need for plain reads and writes => no liburing dependency
+    - one ring (+ buffers) per thread: FolderPairSyncer runs parallel file copies on separate threads anyway
+    - data passes through user space => supports onSourceData, unlike tryCopyFileKernel()                              */
+class IoUring
+{
+public:
+    explicit IoUring(unsigned int entries) //throw SysError
+    {
+        io_uring_params params = {};
+        fd_ = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+        if (fd_ == -1)
+            THROW_LAST_SYS_ERROR("io_uring_setup"); //e.g. ENOSYS, or EPERM due to sysctl kernel.io_uring_disabled
+        ZEN_ON_SCOPE_FAIL(unmapRings(); ::close(fd_));
+
+        if (!(params.features & IORING_FEAT_RW_CUR_POS)) //kernel < 5.6 => no IORING_OP_READ/IORING_OP_WRITE
+            throw SysError(formatSystemError("io_uring_setup", L"", L"IORING_OP_READ/IORING_OP_WRITE not supported."));
+
+        sqRingSize_ = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+        cqRingSize_ = params.cq_off.cqes  + params.cq_entries * sizeof(io_uring_cqe);
+        if (params.features & IORING_FEAT_SINGLE_MMAP)
+            sqRingSize_ = cqRingSize_ = std::max(sqRingSize_, cqRingSize_);
+
+        sqRing_ = static_cast<std::byte*>(mapRing(sqRingSize_, IORING_OFF_SQ_RING)); //throw SysError
+        cqRing_ = params.features & IORING_FEAT_SINGLE_MMAP ? sqRing_ : static_cast<std::byte*>(mapRing(cqRingSize_, IORING_OFF_CQ_RING)); //throw SysError
+        sqesSize_ = params.sq_entries * sizeof(io_uring_sqe);
+        sqes_ = static_cast<io_uring_sqe*>(mapRing(sqesSize_, IORING_OFF_SQES)); //throw SysError
+
+        sqEntries_ = params.sq_entries;
+        sqHead_  = reinterpret_cast<unsigned int*>(sqRing_ + params.sq_off.head);
+        sqTail_  = reinterpret_cast<unsigned int*>(sqRing_ + params.sq_off.tail);
+        sqMask_  = *reinterpret_cast<unsigned int*>(sqRing_ + params.sq_off.ring_mask);
+        sqArray_ = reinterpret_cast<unsigned int*>(sqRing_ + params.sq_off.array);
+        cqHead_  = reinterpret_cast<unsigned int*>(cqRing_ + params.cq_off.head);
+        cqTail_  = reinterpret_cast<unsigned int*>(cqRing_ + params.cq_off.tail);
+        cqMask_  = *reinterpret_cast<unsigned int*>(cqRing_ + params.cq_off.ring_mask);
+        cqes_    = reinterpret_cast<io_uring_cqe*>(cqRing_ + params.cq_off.cqes);
+    }
+
+    ~IoUring()
+    {
+        unmapRings();
+        ::close(fd_);
+    }
+
+    //CONTRACT: number of operations in flight <= entries
+    void prepareReadWrite(bool write, int fd, void* buffer, size_t bytes, uint64_t offset, uint64_t userData)
+    {
+        const unsigned int tail = *sqTail_; //we're the only producer
+        if (tail - std::atomic_ref(*sqHead_).load(std::memory_order_acquire) >= sqEntries_)
+            throw std::logic_error("Contract violation! " + std::string(__FILE__) + ':' + numberTo<std::string>(__LINE__));
+
+        io_uring_sqe& sqe = sqes_[tail & sqMask_];
+        sqe = {};
+        sqe.opcode    = write ? IORING_OP_WRITE : IORING_OP_READ;
+        sqe.fd        = fd;
+        sqe.addr      = reinterpret_cast<uintptr_t>(buffer);
+        sqe.len       = static_cast<uint32_t>(bytes);
+        sqe.off       = offset;
+        sqe.user_data = userData;
+
+        sqArray_[tail & sqMask_] = tail & sqMask_;
+        std::atomic_ref(*sqTail_).store(tail + 1, std::memory_order_release);
+        ++sqPending_;
+    }
+
+    void submitAndWait(unsigned int minComplete) //throw SysError
+    {
+        for (;;)
+        {
+            const int rv = static_cast<int>(::syscall(__NR_io_uring_enter, fd_, sqPending_, minComplete,
+                                                      minComplete > 0 ? IORING_ENTER_GETEVENTS : 0, nullptr, 0));
+            if (rv == -1)
+            {
+                if (errno == EINTR)
+                    continue;
+                THROW_LAST_SYS_ERROR("io_uring_enter");
+            }
+            assert(static_cast<unsigned int>(rv) <= sqPending_);
+            sqPending_ -= std::min(static_cast<unsigned int>(rv), sqPending_);
+            if (sqPending_ == 0)
+                return;
+            minComplete = 0; //partial submission (e.g. EAGAIN/EBUSY semantics) => submit remaining without waiting
+        }
+    }
+
+    bool getCompletion(uint64_t& userData, int32_t& result) //return false if none available
+    {
+        const unsigned int head = *cqHead_; //we're the only consumer
+        if (head == std::atomic_ref(*cqTail_).load(std::memory_order_acquire))
+            return false;
+
+        const io_uring_cqe& cqe = cqes_[head & cqMask_];
+        userData = cqe.user_data;
+        result   = cqe.res;
+        std::atomic_ref(*cqHead_).store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    IoUring           (const IoUring&) = delete;
+    IoUring& operator=(const IoUring&) = delete;
+
+    void* mapRing(size_t size, off_t offset) //throw SysError
+    {
+        void* ptr = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, offset);
+        if (ptr == MAP_FAILED)
+            THROW_LAST_SYS_ERROR("mmap");
+        return ptr;
+    }
+
+    void unmapRings()
+    {
+        if (sqes_)                         ::munmap(sqes_,   sqesSize_);
+        if (cqRing_ && cqRing_ != sqRing_) ::munmap(cqRing_, cqRingSize_);
+        if (sqRing_)                       ::munmap(sqRing_, sqRingSize_);
+    }
+
+    int fd_ = -1;
+    std::byte* sqRing_ = nullptr;
+    std::byte* cqRing_ = nullptr;
+    io_uring_sqe* sqes_ = nullptr;
+    size_t sqRingSize_ = 0;
+    size_t cqRingSize_ = 0;
+    size_t sqesSize_   = 0;
+
+    unsigned int sqEntries_ = 0;
+    unsigned int* sqHead_  = nullptr;
+    unsigned int* sqTail_  = nullptr;
+    unsigned int  sqMask_  = 0;
+    unsigned int* sqArray_ = nullptr;
+    unsigned int* cqHead_  = nullptr;
+    unsigned int* cqTail_  = nullptr;
+    unsigned int  cqMask_  = 0;
+    io_uring_cqe* cqes_    = nullptr;
+
+    unsigned int sqPending_ = 0; //prepared, but not yet submitted
+};
+
+
+const size_t IO_URING_BLOCK_SIZE  = 1024 * 1024;
+const size_t IO_URING_BLOCK_COUNT = 8; //= max. operations in flight per file
+
+struct IoUringCopyContext
+{
+    IoUring ring{IO_URING_BLOCK_COUNT}; //throw SysError
+    std::unique_ptr<std::byte[]> buffer{new std::byte[IO_URING_BLOCK_COUNT * IO_URING_BLOCK_SIZE]}; //no zero-initialization
+};
+
+constinit std::atomic<bool> globalIoUringUnavailable{false}; //don't retry io_uring_setup() for each file
+
+
+std::unique_ptr<IoUringCopyContext>& refThreadIoUringContext() //nullptr if io_uring is not available
+{
+    thread_local std::unique_ptr<IoUringCopyContext> threadContext;
+
+    if (!threadContext && !globalIoUringUnavailable)
+        try
+        {
+            threadContext = std::make_unique<IoUringCopyContext>(); //throw SysError
+        }
+        catch (SysError&) { globalIoUringUnavailable = true; } //=> fall back to synchronous copy
+
+    return threadContext;
+}
+
+
+/* returns false if io_uring is not available => caller falls back to user-space copy
+    - source blocks are passed to onSourceData() and written in file order, but completed out of order
+    - CONTRACT: target file empty                                                                          */
+bool tryCopyFileIoUring(int fdSource, int fdTarget, const Zstring& sourceFile, const Zstring& targetFile, //throw FileError, X
+                        const IoCallback& notifyUnbufferedIO /*throw X*/,
+                        const std::function<void(const void* buffer, size_t bytes)>& onSourceData /*throw X*/)
+{
+    std::unique_ptr<IoUringCopyContext>& ctx = refThreadIoUringContext();
+    if (!ctx)
+        return false;
+
+    struct Block
+    {
+        size_t bytesRead    = 0;
+        size_t bytesWritten = 0;
+        bool readDone = false;
+    };
+    std::array<Block, IO_URING_BLOCK_COUNT> blocks;
+
+    auto getBlock  = [&](uint64_t blockIdx) -> Block& { return blocks[blockIdx % IO_URING_BLOCK_COUNT]; };
+    auto getBuffer = [&](uint64_t blockIdx) { return &ctx->buffer[blockIdx % IO_URING_BLOCK_COUNT * IO_URING_BLOCK_SIZE]; };
+
+    //user_data: block index + read/write flag
+    size_t opsInFlight = 0;
+    auto submitRead = [&](uint64_t blockIdx)
+    {
+        const Block& b = getBlock(blockIdx);
+        ctx->ring.prepareReadWrite(false /*write*/, fdSource, getBuffer(blockIdx) + b.bytesRead, IO_URING_BLOCK_SIZE - b.bytesRead,
+                                   blockIdx * IO_URING_BLOCK_SIZE + b.bytesRead, blockIdx << 1);
+        ++opsInFlight;
+    };
+    auto submitWrite = [&](uint64_t blockIdx)
+    {
+        const Block& b = getBlock(blockIdx);
+        ctx->ring.prepareReadWrite(true /*write*/, fdTarget, getBuffer(blockIdx) + b.bytesWritten, b.bytesRead - b.bytesWritten,
+                                   blockIdx * IO_URING_BLOCK_SIZE + b.bytesWritten, blockIdx << 1 | 1);
+        ++opsInFlight;
+    };
+    auto waitForOpsInFlight = [&] //throw SysError
+    {
+        uint64_t userData = 0;
+        int32_t  result   = 0;
+        while (opsInFlight > 0)
+        {
+            ctx->ring.submitAndWait(1); //throw SysError
+            while (ctx->ring.getCompletion(userData, result))
+                --opsInFlight;
+        }
+    };
+
+    //the kernel writes into our buffers until all operations are completed!
+    ZEN_ON_SCOPE_FAIL
+    (
+        try
+        {
+            waitForOpsInFlight(); //throw SysError
+        }
+        catch (SysError&) //can't wait for completions => better leak ring + buffer than have the kernel write to freed memory
+        {
+            assert(false);
+            [[maybe_unused]] IoUringCopyContext* leaked = ctx.release();
+        }
+    );
+
+    PageCacheDropper cacheDropperIn (fdSource, false /*writeBehind*/);
+    PageCacheDropper cacheDropperOut(fdTarget, true  /*writeBehind*/);
+
+    uint64_t blockNextRead   = 0; //next block to start reading
+    uint64_t blockNextWrite  = 0; //next block to pass to onSourceData() and start writing
+    uint64_t blockNextRetire = 0; //next block to wait for write completion
+    std::optional<uint64_t> blockEnd; //known after the first short read: no more reads from there on
+    uint64_t bytesRetired = 0;
+
+    try
+    {
+        for (;;)
+        {
+            //process in file order:
+            while (blockNextWrite < blockNextRead && getBlock(blockNextWrite).readDone && (!blockEnd || blockNextWrite < *blockEnd))
+            {
+                const Block& b = getBlock(blockNextWrite);
+                if (b.bytesRead < IO_URING_BLOCK_SIZE) //end of file
+                    blockEnd = blockNextWrite + (b.bytesRead > 0 ? 1 : 0);
+
+                if (b.bytesRead > 0)
+                {
+                    if (onSourceData) onSourceData(getBuffer(blockNextWrite), b.bytesRead); //throw X
+                    cacheDropperIn.notifyStreamPos(blockNextWrite * IO_URING_BLOCK_SIZE + b.bytesRead); //noexcept
+                    submitWrite(blockNextWrite);
+                }
+                ++blockNextWrite;
+            }
+
+            while (blockNextRetire < blockNextWrite && getBlock(blockNextRetire).bytesWritten == getBlock(blockNextRetire).bytesRead)
+            {
+                bytesRetired += getBlock(blockNextRetire++).bytesRead;
+                cacheDropperOut.notifyStreamPos(bytesRetired); //noexcept
+            }
+
+            if (blockEnd && blockNextRetire >= *blockEnd)
+                break;
+
+            //keep the pipeline filled:
+            while (!blockEnd && blockNextRead - blockNextRetire < IO_URING_BLOCK_COUNT)
+            {
+                getBlock(blockNextRead) = {};
+                submitRead(blockNextRead++);
+            }
+            //-------------------------------------------------------------------------------
+            assert(opsInFlight > 0);
+            ctx->ring.submitAndWait(1); //throw SysError
+
+            uint64_t userData = 0;
+            int32_t  result   = 0;
+            while (ctx->ring.getCompletion(userData, result))
+            {
+                --opsInFlight;
+                const uint64_t blockIdx = userData >> 1;
+                const bool     isWrite  = userData & 1;
+
+                if (blockEnd && blockIdx >= *blockEnd) //reading beyond end of file: ignore result
+                    continue;
+
+                Block& b = getBlock(blockIdx);
+                if (result == -EINTR || result == -EAGAIN)
+                    isWrite ? submitWrite(blockIdx) : submitRead(blockIdx);
+                else if (result < 0)
+                {
+                    if (isWrite)
+                        throw FileError(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(targetFile)), formatSystemError("io_uring(IORING_OP_WRITE)", -result));
+                    else
+                        throw FileError(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(sourceFile)), formatSystemError("io_uring(IORING_OP_READ)", -result));
+                }
+                else if (isWrite)
+                {
+                    if (result == 0) //comment in safe-read.c suggests to treat this as an error due to buggy drivers
+                        throw FileError(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(targetFile)), formatSystemError("io_uring(IORING_OP_WRITE)", ENOSPC));
+
+                    b.bytesWritten += result;
+                    if (notifyUnbufferedIO) notifyUnbufferedIO(result); //throw X
+
+                    if (b.bytesWritten < b.bytesRead) //short write
+                        submitWrite(blockIdx);
+                }
+                else
+                {
+                    b.bytesRead += result;
+                    if (result > 0 && b.bytesRead < IO_URING_BLOCK_SIZE) //short read: EOF is only signaled by 0 bytes
+                        submitRead(blockIdx);
+                    else
+                        b.readDone = true;
+                }
+            }
+        }
+    }
+    catch (const SysError& e)
+    {
+        throw FileError(replaceCpy(replaceCpy(_("Cannot copy file %x to %y."), L"%x", L'\n' + fmtPath(sourceFile)), L"%y", L'\n' + fmtPath(targetFile)), e.toString());
+    }
+
+    //blocks read beyond end of file (if any) are still in flight:
+    try
+    {
+        waitForOpsInFlight(); //throw SysError
+    }
+    catch (const SysError& e)
+    {
+        throw FileError(replaceCpy(replaceCpy(_("Cannot copy file %x to %y."), L"%x", L'\n' + fmtPath(sourceFile)), L"%y", L'\n' + fmtPath(targetFile)), e.toString());
+    }
+
+    cacheDropperIn .notifyStreamEnd(bytesRetired); //noexcept
+    cacheDropperOut.notifyStreamEnd(bytesRetired); //
+    return true;
+}
+
+
+//copyNewFileDelta(): granularity of changed ranges; smaller blocks share more storage, but fragment the target file
+const size_t DELTA_COPY_BLOCK_SIZE = 128 * 1024;
+
+
+FileCopyResult finalizeFileCopy(FileOutput& fileOut, const struct stat& sourceInfo, const Zstring& targetFile) //throw FileError, X
+{
+    //flush intermediate buffers before fiddling with the raw file handle
+    fileOut.flushBuffers(); //throw FileError, X
+
+    struct stat targetInfo = {};
+    if (::fstat(fileOut.getHandle(), &targetInfo) != 0)
+        THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot read file attributes of %x."), L"%x", fmtPath(targetFile)), "fstat");
+
+    //close output file handle before setting file time; also good place to catch errors when closing stream!
+    fileOut.finalize(); //throw FileError, (X)  essentially a close() since  buffers were already flushed
+
+    //==========================================================================================================
+    //take fileOut ownership => from this point on, WE are responsible for calling removeFilePlain() on failure!!
+    //===========================================================================================================
+
+    std::optional<FileError> errorModTime;
+    try
+    {
+        /*  we cannot set the target file times (::futimes) while the file descriptor is still open after a write operation:
+            this triggers bugs on Samba shares where the modification time is set to current time instead.
+            Linux: https://bugs.debian.org/cgi-bin/bugreport.cgi?bug=340236
+                   http://comments.gmane.org/gmane.linux.file-systems.cifs/2854
+            macOS: https://freefilesync.org/forum/viewtopic.php?t=356             */
+        setWriteTimeNative(targetFile, sourceInfo.st_mtim, ProcSymlink::follow); //throw FileError
+    }
+    catch (const FileError& e)
+    {
+        errorModTime = FileError(e.toString()); //avoid slicing
+    }
+
+    FileCopyResult result;
+    result.fileSize = sourceInfo.st_size;
+    result.sourceModTime = sourceInfo.st_mtim;
+    result.sourceFileIdx = sourceInfo.st_ino;
+    result.targetFileIdx = targetInfo.st_ino;
+    result.errorModTime = errorModTime;
+    return result;
+}
+}
+
+
+namespace
+{
+void copyFileData(FileInput& fileIn, FileOutput& fileOut, const struct stat& sourceInfo, const Zstring& sourceFile, const Zstring& targetFile, //throw FileError, (ErrorFileLocked), X
+                  const IoCallback& notifyUnbufferedIO /*throw X*/,
+                  const std::function<void(const void* buffer, size_t bytes)>& onSourceData /*throw X*/)
+{
+    //kernel copy first: fileIn/fileOut have not yet buffered/read anything => raw file offsets are still at 0
+    //don't reserveSpace() before: preallocated blocks would be replaced by FICLONE anyway
+    bool copyDone = !onSourceData && //data must pass through user space
+                    tryCloneFile(fileIn.getHandle(), fileOut.getHandle(), sourceInfo.st_size, sourceFile, targetFile, notifyUnbufferedIO); //throw FileError, X
+
+    //copy_file_range/sendfile and the user-space copies would inflate holes to their full size
+    if (!copyDone && isSparseFile(sourceInfo))
+        copyDone = tryCopyFileSparse(fileIn.getHandle(), fileOut.getHandle(), sourceInfo.st_size, sourceFile, targetFile, notifyUnbufferedIO, onSourceData); //throw FileError, X
+
+    if (!copyDone && !onSourceData)
+        copyDone = tryCopyFileKernel(fileIn.getHandle(), fileOut.getHandle(), sourceFile, targetFile, notifyUnbufferedIO); //throw FileError, X
+
+    if (!copyDone)
+    {
+        //preallocate disk space + reduce fragmentation (perf: no real benefit)
+        fileOut.reserveSpace(sourceInfo.st_size); //throw FileError
+
+        //io_uring: several reads/writes in flight; fall back to synchronous copy if not available
+        if (!tryCopyFileIoUring(fileIn.getHandle(), fileOut.getHandle(), sourceFile, targetFile, notifyUnbufferedIO, onSourceData)) //throw FileError, X
+        {
+            if (onSourceData)
+            {
+                const size_t blockSize = fileIn.getBlockSize();
+                std::vector<std::byte> buffer(blockSize);
+                for (;;)
+                {
+                    const size_t bytesRead = fileIn.read(&buffer[0], blockSize); //throw FileError, (ErrorFileLocked), X; return "bytesToRead" bytes unless end of stream!
+                    onSourceData(&buffer[0], bytesRead); //throw X
+                    fileOut.write(&buffer[0], bytesRead); //throw FileError, X
+
+                    if (bytesRead < blockSize) //end of file
+                        break;
+                }
+            }
+            else
+                bufferedStreamCopy(fileIn, fileOut); //throw FileError, (ErrorFileLocked), X
+        }
+    }
+}
+}
+
+
 FileCopyResult zen::copyNewFile(const Zstring& sourceFile, const Zstring& targetFile, //throw FileError, ErrorTargetExisting, (ErrorFileLocked), X
-                                const IoCallback& notifyUnbufferedIO /*throw X*/)
+                                const IoCallback& notifyUnbufferedIO /*throw X*/,
+                                const std::function<void(const void* buffer, size_t bytes)>& onSourceData /*throw X*/)
 {
     int64_t totalUnbufferedIO = 0;
 
@@ -587,34 +1257,82 @@ FileCopyResult zen::copyNewFile(const Zstring& sourceFile, const Zstring& target
     }
     FileOutput fileOut(fdTarget, targetFile, IOCallbackDivider(notifyUnbufferedIO, totalUnbufferedIO)); //pass ownership
 
-    //preallocate disk space + reduce fragmentation (perf: no real benefit)
-    fileOut.reserveSpace(sourceInfo.st_size); //throw FileError
+    copyFileData(fileIn, fileOut, sourceInfo, sourceFile, targetFile, notifyUnbufferedIO, onSourceData); //throw FileError, (ErrorFileLocked), X
 
-    bufferedStreamCopy(fileIn, fileOut); //throw FileError, (ErrorFileLocked), X
+    return finalizeFileCopy(fileOut, sourceInfo, targetFile); //throw FileError, X
+}
+
+
+std::optional<FileCopyResult> zen::copyNewFileAnonymous(const Zstring& sourceFile, const Zstring& targetFile, //throw FileError, ErrorTargetExisting, (ErrorFileLocked), X
+                                                        const IoCallback& notifyUnbufferedIO /*throw X*/,
+                                                        const std::function<void(const void* buffer, size_t bytes)>& onSourceData /*throw X*/,
+                                                        const std::function<void()>& onBeforeLink /*throw X*/)
+{
+    const std::optional<Zstring> parentPath = getParentFolderPath(targetFile);
+    if (!parentPath)
+        return std::nullopt;
+
+    int64_t totalUnbufferedIO = 0;
+
+    FileInput fileIn(sourceFile, IOCallbackDivider(notifyUnbufferedIO, totalUnbufferedIO)); //throw FileError, (ErrorFileLocked -> Windows-only)
+
+    struct stat sourceInfo = {};
+    if (::fstat(fileIn.getHandle(), &sourceInfo) != 0)
+        THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot read file attributes of %x."), L"%x", fmtPath(sourceFile)), "fstat");
+
+    const mode_t mode = sourceInfo.st_mode & (S_IRWXU | S_IRWXG | S_IRWXO); //see copyNewFile()
+
+    //no O_EXCL: the inode must stay linkable
+    const int fdTarget = ::open(parentPath->c_str(), O_TMPFILE | O_WRONLY | O_CLOEXEC, mode);
+    if (fdTarget == -1)
+    {
+        //EOPNOTSUPP: file system without O_TMPFILE support (e.g. NFS, FUSE); EISDIR: kernel < 3.11
+        if (errno == EOPNOTSUPP || errno == EISDIR || errno == EINVAL)
+            return std::nullopt;
+        THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(targetFile)), "open(O_TMPFILE)");
+    }
+    FileOutput fileOut(fdTarget, targetFile, IOCallbackDivider(notifyUnbufferedIO, totalUnbufferedIO), true /*anonymous*/); //pass ownership: not finalized => inode is freed on close
+
+    copyFileData(fileIn, fileOut, sourceInfo, sourceFile, targetFile, notifyUnbufferedIO, onSourceData); //throw FileError, (ErrorFileLocked), X
 
-    //flush intermediate buffers before fiddling with the raw file handle
     fileOut.flushBuffers(); //throw FileError, X
 
     struct stat targetInfo = {};
     if (::fstat(fileOut.getHandle(), &targetInfo) != 0)
         THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot read file attributes of %x."), L"%x", fmtPath(targetFile)), "fstat");
 
-    //close output file handle before setting file time; also good place to catch errors when closing stream!
-    fileOut.finalize(); //throw FileError, (X)  essentially a close() since  buffers were already flushed
+    if (onBeforeLink)
+        onBeforeLink(); //throw X
 
-    //==========================================================================================================
-    //take fileOut ownership => from this point on, WE are responsible for calling removeFilePlain() on failure!!
-    //===========================================================================================================
+    //AT_EMPTY_PATH requires CAP_DAC_READ_SEARCH => unprivileged: link via /proc instead
+    if (::linkat(fileOut.getHandle(), "", AT_FDCWD, targetFile.c_str(), AT_EMPTY_PATH) != 0)
+    {
+        const std::string procFdPath = "/proc/self/fd/" + numberTo<std::string>(fileOut.getHandle());
+        if (errno == EEXIST ||
+            ::linkat(AT_FDCWD, procFdPath.c_str(), AT_FDCWD, targetFile.c_str(), AT_SYMLINK_FOLLOW) != 0)
+        {
+            const int ec = errno; //copy before making other system calls!
+            const std::wstring errorMsg = replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(targetFile));
+            const std::wstring errorDescr = formatSystemError("linkat", ec);
+
+            if (ec == EEXIST)
+                throw ErrorTargetExisting(errorMsg, errorDescr);
+
+            throw FileError(errorMsg, errorDescr);
+        }
+    }
+    //==========================================================================================
+    //file is visible now => from this point on, WE are responsible for calling removeFilePlain() on failure!!
+    //==========================================================================================
+    ZEN_ON_SCOPE_FAIL(try { removeFilePlain(targetFile); }
+    catch (FileError&) {});
+
+    fileOut.finalize(); //throw FileError, (X)  essentially a close() since buffers were already flushed
 
     std::optional<FileError> errorModTime;
     try
     {
-        /*  we cannot set the target file times (::futimes) while the file descriptor is still open after a write operation:
-            this triggers bugs on Samba shares where the modification time is set to current time instead.
-            Linux: https://bugs.debian.org/cgi-bin/bugreport.cgi?bug=340236
-                   http://comments.gmane.org/gmane.linux.file-systems.cifs/2854
-            macOS: https://freefilesync.org/forum/viewtopic.php?t=356             */
-        setWriteTimeNative(targetFile, sourceInfo.st_mtim, ProcSymlink::follow); //throw FileError
+        setWriteTimeNative(targetFile, sourceInfo.st_mtim, ProcSymlink::follow); //throw FileError; after close(): see finalizeFileCopy()
     }
     catch (const FileError& e)
     {
@@ -631,3 +1349,417 @@ FileCopyResult zen::copyNewFile(const Zstring& sourceFile, const Zstring& target
 }
 
 
+std::optional<FileCopyResult> zen::copyNewFileDelta(const Zstring& sourceFile, const Zstring& baseFile, const Zstring& targetFile, //throw FileError, ErrorTargetExisting, (ErrorFileLocked), X
+                                                    const IoCallback& notifyUnbufferedIO /*throw X*/,
+                                                    const std::function<void(const void* buffer, size_t bytes)>& onSourceData /*throw X*/)
+{
+    //report source reads only: base blocks are compared, not copied => progress matches file size
+    FileInput fileIn(sourceFile, notifyUnbufferedIO); //throw FileError, (ErrorFileLocked -> Windows-only)
+
+    struct stat sourceInfo = {};
+    if (::fstat(fileIn.getHandle(), &sourceInfo) != 0)
+        THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot read file attributes of %x."), L"%x", fmtPath(sourceFile)), "fstat");
+
+    const int fdBase = ::open(baseFile.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fdBase == -1)
+        THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot open file %x."), L"%x", fmtPath(baseFile)), "open");
+    ZEN_ON_SCOPE_EXIT(::close(fdBase));
+
+    const mode_t mode = sourceInfo.st_mode & (S_IRWXU | S_IRWXG | S_IRWXO); //see copyNewFile()
+
+    //read access: compare against the cloned blocks instead of the base file => same data, no need to keep two files in sync
+    const int fdTarget = ::open(targetFile.c_str(), O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, mode);
+    if (fdTarget == -1)
+    {
+        const int ec = errno; //copy before making other system calls!
+        const std::wstring errorMsg = replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(targetFile));
+        const std::wstring errorDescr = formatSystemError("open", ec);
+
+        if (ec == EEXIST)
+            throw ErrorTargetExisting(errorMsg, errorDescr);
+
+        throw FileError(errorMsg, errorDescr);
+    }
+    FileOutput fileOut(fdTarget, targetFile, nullptr /*notifyUnbufferedIO*/); //pass ownership => not finalized: deletes target file
+
+    //cloning the base file is what makes this cheap: without it, the unchanged blocks would be written all over again
+    if (::ioctl(fdTarget, FICLONE, fdBase) != 0)
+    {
+        if (!isKernelCopyUnsupported(errno))
+            THROW_LAST_FILE_ERROR(replaceCpy(replaceCpy(_("Cannot copy file %x to %y."), L"%x", L'\n' + fmtPath(baseFile)), L"%y", L'\n' + fmtPath(targetFile)), "FICLONE");
+
+        return std::nullopt; //=> caller falls back to regular copy
+    }
+
+    const size_t blockSize = DELTA_COPY_BLOCK_SIZE;
+    std::vector<std::byte> bufferSrc(blockSize);
+    std::vector<std::byte> bufferTrg(blockSize);
+
+    PageCacheDropper cacheDropperOut(fdTarget, true /*writeBehind*/);
+
+    uint64_t pos = 0;
+    for (;;)
+    {
+        const size_t bytesRead = fileIn.read(&bufferSrc[0], blockSize); //throw FileError, (ErrorFileLocked), X; return "bytesToRead" bytes unless end of stream!
+        if (onSourceData) onSourceData(&bufferSrc[0], bytesRead); //throw X
+
+        //cloned block beyond end of base file: short read => compares unequal
+        size_t bytesReadTrg = 0;
+        while (bytesReadTrg < bytesRead)
+        {
+            const size_t bytesDelta = preadNoEintr(fdTarget, &bufferTrg[bytesReadTrg], bytesRead - bytesReadTrg, pos + bytesReadTrg, targetFile); //throw FileError
+            if (bytesDelta == 0) //EOF
+                break;
+            bytesReadTrg += bytesDelta;
+        }
+
+        if (bytesReadTrg != bytesRead || std::memcmp(&bufferSrc[0], &bufferTrg[0], bytesRead) != 0)
+            pwriteAll(fdTarget, &bufferSrc[0], bytesRead, pos, targetFile); //throw FileError; only changed blocks stop sharing storage with the base file
+
+        pos += bytesRead;
+        cacheDropperOut.notifyStreamPos(pos); //noexcept
+
+        if (bytesRead < blockSize) //end of file
+            break;
+    }
+
+    //source shorter than base file: drop the remaining cloned blocks
+    if (::ftruncate(fdTarget, pos) != 0)
+        THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(targetFile)), "ftruncate");
+
+    cacheDropperOut.notifyStreamEnd(pos); //noexcept
+
+    return finalizeFileCopy(fileOut, sourceInfo, targetFile); //throw FileError, X
+}
+
+
+
+std::optional<bool> zen::sparseFilesHaveSameContent(const Zstring& filePath1, const Zstring& filePath2, const IoCallback& notifyUnbufferedIO /*throw X*/) //throw FileError, X
+{
+    FileInput fileIn1(filePath1, nullptr /*notifyUnbufferedIO*/); //throw FileError, (ErrorFileLocked)
+    FileInput fileIn2(filePath2, nullptr /*notifyUnbufferedIO*/); //
+
+    struct stat fileInfo1 = {};
+    struct stat fileInfo2 = {};
+    if (::fstat(fileIn1.getHandle(), &fileInfo1) != 0)
+        THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot read file attributes of %x."), L"%x", fmtPath(filePath1)), "fstat");
+    if (::fstat(fileIn2.getHandle(), &fileInfo2) != 0)
+        THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot read file attributes of %x."), L"%x", fmtPath(filePath2)), "fstat");
+
+    if (!isSparseFile(fileInfo1) && !isSparseFile(fileInfo2))
+        return std::nullopt;
+
+    if (fileInfo1.st_size != fileInfo2.st_size)
+        return false;
+    const uint64_t fileSize = fileInfo1.st_size;
+
+    const std::optional<std::vector<DataExtent>> extents1 = getDataExtents(fileIn1.getHandle(), fileSize, filePath1); //throw FileError
+    const std::optional<std::vector<DataExtent>> extents2 = getDataExtents(fileIn2.getHandle(), fileSize, filePath2); //
+    if (!extents1 || !extents2)
+        return std::nullopt;
+
+    //merge: compare wherever at least one file has data (holes read as zeros)
+    std::vector<DataExtent> extentsCmp;
+    {
+        std::vector<DataExtent> extentsAll = *extents1;
+        append(extentsAll, *extents2);
+        std::sort(extentsAll.begin(), extentsAll.end(), [](const DataExtent& lhs, const DataExtent& rhs) { return lhs.offset < rhs.offset; });
+
+        for (const DataExtent& extent : extentsAll)
+            if (!extentsCmp.empty() && extent.offset <= extentsCmp.back().offset + extentsCmp.back().length)
+                extentsCmp.back().length = std::max(extentsCmp.back().length, extent.offset + extent.length - extentsCmp.back().offset);
+            else
+                extentsCmp.push_back(extent);
+    }
+
+    const size_t blockSize = 1024 * 1024;
+    std::vector<std::byte> buffer1(blockSize);
+    std::vector<std::byte> buffer2(blockSize);
+
+    uint64_t bytesSkipped = fileSize;
+    for (const DataExtent& extent : extentsCmp)
+    {
+        bytesSkipped -= extent.length;
+
+        for (uint64_t pos = extent.offset; pos < extent.offset + extent.length;)
+        {
+            const size_t bytesToRead = static_cast<size_t>(std::min<uint64_t>(blockSize, extent.offset + extent.length - pos));
+
+            //"bytesToRead" bytes unless end of file:
+            auto readBlock = [&](int fd, std::byte* buffer, const Zstring& filePath) //throw FileError
+            {
+                size_t bytesRead = 0;
+                while (bytesRead < bytesToRead)
+                    if (const size_t delta = preadNoEintr(fd, buffer + bytesRead, bytesToRead - bytesRead, pos + bytesRead, filePath); //throw FileError
+                        delta > 0)
+                        bytesRead += delta;
+                    else
+                        break;
+                return bytesRead;
+            };
+            const size_t bytesRead1 = readBlock(fileIn1.getHandle(), &buffer1[0], filePath1); //throw FileError
+            const size_t bytesRead2 = readBlock(fileIn2.getHandle(), &buffer2[0], filePath2); //
+
+            if (bytesRead1 != bytesRead2 ||
+                std::memcmp(&buffer1[0], &buffer2[0], bytesRead1) != 0)
+                return false;
+
+            if (notifyUnbufferedIO) notifyUnbufferedIO(bytesRead1); //throw X
+
+            if (bytesRead1 < bytesToRead) //files were truncated in the meantime
+                return false;
+            pos += bytesRead1;
+        }
+    }
+    if (notifyUnbufferedIO) notifyUnbufferedIO(bytesSkipped); //throw X
+
+    return true;
+}
+
+
+namespace
+{
+struct PhysicalExtent
+{
+    uint64_t logical  = 0;
+    uint64_t physical = 0;
+    uint64_t length   = 0;
+};
+
+//physical location of the data extents according to FIEMAP; adjacent extents are merged => independent from how the file system splits them
+//returns std::nullopt if not supported or if any extent has no stable, unique physical location (delayed allocation, inline, compressed, encrypted)
+std::optional<std::vector<PhysicalExtent>> getPhysicalExtents(int fd, const Zstring& filePath) //throw FileError
+{
+    constexpr __u32 EXTENTS_PER_CALL = 256;
+    constexpr __u32 FLAGS_UNSTABLE = FIEMAP_EXTENT_UNKNOWN | FIEMAP_EXTENT_DELALLOC | FIEMAP_EXTENT_ENCODED | FIEMAP_EXTENT_DATA_ENCRYPTED |
+                                     FIEMAP_EXTENT_NOT_ALIGNED | FIEMAP_EXTENT_DATA_INLINE | FIEMAP_EXTENT_DATA_TAIL;
+
+    std::vector<std::byte> buffer(sizeof(struct fiemap) + EXTENTS_PER_CALL * sizeof(struct fiemap_extent));
+    std::vector<PhysicalExtent> extents;
+
+    for (uint64_t pos = 0;;)
+    {
+        struct fiemap& fm = *reinterpret_cast<struct fiemap*>(&buffer[0]);
+        fm = {};
+        fm.fm_start        = pos;
+        fm.fm_length       = FIEMAP_MAX_OFFSET - pos;
+        fm.fm_flags        = FIEMAP_FLAG_SYNC; //flush dirty pages first: data not yet written has no final location
+        fm.fm_extent_count = EXTENTS_PER_CALL;
+
+        if (::ioctl(fd, FS_IOC_FIEMAP, &fm) != 0)
+        {
+            if (errno == EOPNOTSUPP || errno == ENOTTY || errno == EINVAL) //e.g. NFS, FUSE, tmpfs
+                return std::nullopt;
+            THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(filePath)), "ioctl(FS_IOC_FIEMAP)");
+        }
+        if (fm.fm_mapped_extents == 0)
+            return extents;
+
+        for (__u32 i = 0; i < fm.fm_mapped_extents; ++i)
+        {
+            const struct fiemap_extent& fe = fm.fm_extents[i];
+            if (fe.fe_flags & FLAGS_UNSTABLE)
+                return std::nullopt;
+
+            if (!extents.empty() &&
+                extents.back().logical  + extents.back().length == fe.fe_logical &&
+                extents.back().physical + extents.back().length == fe.fe_physical)
+                extents.back().length += fe.fe_length;
+            else
+                extents.push_back({fe.fe_logical, fe.fe_physical, fe.fe_length});
+
+            if (fe.fe_flags & FIEMAP_EXTENT_LAST)
+                return extents;
+        }
+        const struct fiemap_extent& feLast = fm.fm_extents[fm.fm_mapped_extents - 1];
+        pos = feLast.fe_logical + feLast.fe_length;
+    }
+}
+}
+
+
+std::optional<bool> zen::sharedFilesHaveSameContent(const Zstring& filePath1, const Zstring& filePath2, const IoCallback& notifyUnbufferedIO /*throw X*/) //throw FileError, X
+{
+    FileInput fileIn1(filePath1, nullptr /*notifyUnbufferedIO*/); //throw FileError, (ErrorFileLocked)
+    FileInput fileIn2(filePath2, nullptr /*notifyUnbufferedIO*/); //
+
+    struct stat fileInfo1 = {};
+    struct stat fileInfo2 = {};
+    if (::fstat(fileIn1.getHandle(), &fileInfo1) != 0)
+        THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot read file attributes of %x."), L"%x", fmtPath(filePath1)), "fstat");
+    if (::fstat(fileIn2.getHandle(), &fileInfo2) != 0)
+        THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot read file attributes of %x."), L"%x", fmtPath(filePath2)), "fstat");
+
+    if (!S_ISREG(fileInfo1.st_mode) || !S_ISREG(fileInfo2.st_mode))
+        return std::nullopt;
+
+    if (fileInfo1.st_size != fileInfo2.st_size)
+        return false;
+
+    //physical addresses are unique per device only (Btrfs: st_dev differs per subvolume => reflinks across subvolumes are not detected)
+    if (fileInfo1.st_dev != fileInfo2.st_dev)
+        return std::nullopt;
+
+    auto haveSameStorage = [&] //throw FileError
+    {
+        if (fileInfo1.st_ino == fileInfo2.st_ino) //hard link, bind mount, or same file selected twice
+            return true;
+
+        //reflinks (Btrfs, XFS, bcachefs) or deduplicated copies: same data if every logical range maps to the same physical range
+        //=> holes must match, too: a hole and an extent full of zeros would be equal, but we don't read to find out
+        const std::optional<std::vector<PhysicalExtent>> extents1 = getPhysicalExtents(fileIn1.getHandle(), filePath1); //throw FileError
+        if (!extents1 || extents1->empty()) //empty: nothing allocated, e.g. all in page cache or empty file => regular comparison is cheap
+            return false;
+
+        const std::optional<std::vector<PhysicalExtent>> extents2 = getPhysicalExtents(fileIn2.getHandle(), filePath2); //throw FileError
+        if (!extents2)
+            return false;
+
+        return std::equal(extents1->begin(), extents1->end(), extents2->begin(), extents2->end(), [](const PhysicalExtent& lhs, const PhysicalExtent& rhs)
+        {
+            return lhs.logical  == rhs.logical  &&
+                   lhs.physical == rhs.physical &&
+                   lhs.length   == rhs.length;
+        });
+    };
+    if (!haveSameStorage()) //throw FileError
+        return std::nullopt;
+
+    if (notifyUnbufferedIO) notifyUnbufferedIO(fileInfo1.st_size); //throw X
+    return true;
+}
+
+
+namespace
+{
+/*  file mapping + file truncated by another process in the meantime => SIGBUS when accessing pages beyond the new end!
+    => access mapped memory only within memcmpMappedGuarded(): SIGBUS on this thread jumps back instead of killing the process
+    - SIGBUS not caused by us: forward to previous handler; SIG_DFL: faulting instruction is re-executed => default action  */
+thread_local sigjmp_buf* mappedAccessJmpBuf = nullptr; //initial-exec TLS: async-signal-safe in practice
+struct sigaction sigbusActionPrev = {};
+
+
+void onSigbus(int sig, siginfo_t* info, void* context)
+{
+    if (mappedAccessJmpBuf)
+        ::siglongjmp(*mappedAccessJmpBuf, 1);
+
+    if (sigbusActionPrev.sa_flags & SA_SIGINFO)
+        sigbusActionPrev.sa_sigaction(sig, info, context);
+    else if (sigbusActionPrev.sa_handler != SIG_DFL &&
+             sigbusActionPrev.sa_handler != SIG_IGN)
+        sigbusActionPrev.sa_handler(sig);
+    else
+        ::sigaction(SIGBUS, &sigbusActionPrev, nullptr);
+}
+
+
+bool installSigbusHandler() //noexcept
+{
+    static const bool installed = []
+    {
+        struct sigaction action = {};
+        action.sa_sigaction = onSigbus;
+        action.sa_flags = SA_SIGINFO;
+        ::sigemptyset(&action.sa_mask);
+        return ::sigaction(SIGBUS, &action, &sigbusActionPrev) == 0;
+    }();
+    return installed;
+}
+
+
+//returns std::nullopt if mapped memory became inaccessible (SIGBUS)
+//[!] no C++ objects with destructors in here: siglongjmp() skips them!
+std::optional<bool> memcmpMappedGuarded(const std::byte* ptr1, const std::byte* ptr2, size_t len) //noexcept
+{
+    sigjmp_buf jmpBuf;
+    if (::sigsetjmp(jmpBuf, 1 /*savemask: SIGBUS is blocked while running the handler*/) != 0)
+    {
+        mappedAccessJmpBuf = nullptr;
+        return std::nullopt;
+    }
+    mappedAccessJmpBuf = &jmpBuf;
+    const bool equal = std::memcmp(ptr1, ptr2, len) == 0;
+    mappedAccessJmpBuf = nullptr;
+    return equal;
+}
+}
+
+
+std::optional<bool> zen::mappedFilesHaveSameContent(const Zstring& filePath1, const Zstring& filePath2, const IoCallback& notifyUnbufferedIO /*throw X*/) //throw FileError, X
+{
+    //small files: mmap() + page fault setup costs more than the copy we save
+    constexpr uint64_t MAPPED_COMPARE_SIZE_MIN = 4 * 1024 * 1024;
+    //map window by window: bounded address space on 32-bit + munmap() lets the page cache dropper do its job
+    //window offsets are multiples of 2 MiB => huge-page friendly (transparent huge pages for file mappings)
+    constexpr size_t MAPPED_COMPARE_WINDOW = 64 * 1024 * 1024;
+    //compare block by block: report progress + allow cancellation, exit early on first difference
+    constexpr size_t MAPPED_COMPARE_BLOCK = 1024 * 1024;
+
+    FileInput fileIn1(filePath1, nullptr /*notifyUnbufferedIO*/); //throw FileError, (ErrorFileLocked)
+    FileInput fileIn2(filePath2, nullptr /*notifyUnbufferedIO*/); //
+
+    struct stat fileInfo1 = {};
+    struct stat fileInfo2 = {};
+    if (::fstat(fileIn1.getHandle(), &fileInfo1) != 0)
+        THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot read file attributes of %x."), L"%x", fmtPath(filePath1)), "fstat");
+    if (::fstat(fileIn2.getHandle(), &fileInfo2) != 0)
+        THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot read file attributes of %x."), L"%x", fmtPath(filePath2)), "fstat");
+
+    if (!S_ISREG(fileInfo1.st_mode) || !S_ISREG(fileInfo2.st_mode))
+        return std::nullopt;
+
+    if (fileInfo1.st_size != fileInfo2.st_size)
+        return false;
+    const uint64_t fileSize = fileInfo1.st_size;
+
+    if (fileSize < MAPPED_COMPARE_SIZE_MIN || !installSigbusHandler())
+        return std::nullopt;
+
+    PageCacheDropper cacheDropper1(fileIn1.getHandle(), false /*writeBehind*/);
+    PageCacheDropper cacheDropper2(fileIn2.getHandle(), false /*writeBehind*/);
+
+    for (uint64_t windowPos = 0; windowPos < fileSize; windowPos += MAPPED_COMPARE_WINDOW)
+    {
+        const size_t windowSize = static_cast<size_t>(std::min<uint64_t>(MAPPED_COMPARE_WINDOW, fileSize - windowPos));
+
+        auto mapWindow = [&](int fd, const Zstring& filePath) -> const std::byte* //throw FileError
+        {
+            void* ptr = ::mmap(nullptr, windowSize, PROT_READ, MAP_PRIVATE, fd, windowPos);
+            if (ptr == MAP_FAILED)
+            {
+                if (windowPos == 0) //e.g. FUSE/network file system without mmap support => fall back to read()
+                    return nullptr;
+                THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(filePath)), "mmap");
+            }
+            ::madvise(ptr, windowSize, MADV_SEQUENTIAL); //aggressive read-ahead; pages behind are freed early
+            return static_cast<const std::byte*>(ptr);
+        };
+        const std::byte* const view1 = mapWindow(fileIn1.getHandle(), filePath1); //throw FileError
+        if (!view1)
+            return std::nullopt;
+        ZEN_ON_SCOPE_EXIT(::munmap(const_cast<std::byte*>(view1), windowSize));
+
+        const std::byte* const view2 = mapWindow(fileIn2.getHandle(), filePath2); //throw FileError
+        if (!view2)
+            return std::nullopt;
+        ZEN_ON_SCOPE_EXIT(::munmap(const_cast<std::byte*>(view2), windowSize));
+
+        for (size_t pos = 0; pos < windowSize; pos += MAPPED_COMPARE_BLOCK)
+        {
+            const size_t bytesCmp = std::min(MAPPED_COMPARE_BLOCK, windowSize - pos);
+
+            if (const std::optional<bool> equal = memcmpMappedGuarded(view1 + pos, view2 + pos, bytesCmp); //noexcept
+                !equal || !*equal) //std::nullopt: file was truncated in the meantime
+                return false;
+
+            if (notifyUnbufferedIO) notifyUnbufferedIO(bytesCmp); //throw X
+        }
+        //pages are still mapped => dropping the page cache only works for the previous windows: good enough
+        cacheDropper1.notifyStreamPos(windowPos);
+        cacheDropper2.notifyStreamPos(windowPos);
+    }
+    cacheDropper1.notifyStreamEnd(fileSize);
+    cacheDropper2.notifyStreamEnd(fileSize);
+    return true;
+}
@@ -99,7 +99,35 @@ struct FileCopyResult
 
 FileCopyResult copyNewFile(const Zstring& sourceFile, const Zstring& targetFile, //throw FileError, ErrorTargetExisting, ErrorFileLocked, X
                            //accummulated delta != file size! consider ADS, sparse, compressed files
-                           const IoCallback& notifyUnbufferedIO /*throw X*/);
+                           const IoCallback& notifyUnbufferedIO /*throw X*/,
+                           //optional: inspect source content while copying, e.g. to calculate a hash => disables in-kernel copy!
+                           const std::function<void(const void* buffer, size_t bytes)>& onSourceData /*throw X*/);
+
+/*  transactional copy without temporary file name: write to an anonymous inode (O_TMPFILE), then link it as "targetFile" once complete
+    => no rename, no orphaned temp files after a crash; onBeforeLink: e.g. delete the old target file
+    returns std::nullopt if O_TMPFILE is not supported (e.g. NFS, FUSE) => nothing created, onBeforeLink() not called, caller falls back to temp file + rename */
+std::optional<FileCopyResult> copyNewFileAnonymous(const Zstring& sourceFile, const Zstring& targetFile, //throw FileError, ErrorTargetExisting, ErrorFileLocked, X
+                                                   const IoCallback& notifyUnbufferedIO /*throw X*/,
+                                                   const std::function<void(const void* buffer, size_t bytes)>& onSourceData /*throw X*/,
+                                                   const std::function<void()>& onBeforeLink /*throw X*/);
+
+/*  delta copy: create "targetFile" as reflink clone of "baseFile" (usually the old version of the file to update), then overwrite changed blocks only
+    => unchanged blocks keep sharing storage with "baseFile"; source is read completely, so onSourceData() sees all data
+    returns std::nullopt if "baseFile" can't be cloned (e.g. no reflink support) => no target file created, caller falls back to copyNewFile() */
+std::optional<FileCopyResult> copyNewFileDelta(const Zstring& sourceFile, const Zstring& baseFile, const Zstring& targetFile, //throw FileError, ErrorTargetExisting, ErrorFileLocked, X
+                                               const IoCallback& notifyUnbufferedIO /*throw X*/,
+                                               const std::function<void(const void* buffer, size_t bytes)>& onSourceData /*throw X*/);
+
+//sparse files: skip ranges that are holes in both files; returns std::nullopt if neither file is sparse (or hole detection is not supported)
+std::optional<bool> sparseFilesHaveSameContent(const Zstring& filePath1, const Zstring& filePath2, const IoCallback& notifyUnbufferedIO /*throw X*/); //throw FileError, X
+
+//same inode (hard link) or reflinks sharing all physical extents => equal without reading any data
+//returns std::nullopt if storage is not shared (or can't be determined) => caller compares content
+std::optional<bool> sharedFilesHaveSameContent(const Zstring& filePath1, const Zstring& filePath2, const IoCallback& notifyUnbufferedIO /*throw X*/); //throw FileError, X
+
+//compare on memory-mapped pages: no copy from page cache into user buffers
+//returns std::nullopt if not worth it (small files) or mmap() is not supported => caller falls back to read()
+std::optional<bool> mappedFilesHaveSameContent(const Zstring& filePath1, const Zstring& filePath2, const IoCallback& notifyUnbufferedIO /*throw X*/); //throw FileError, X
 }
 
 #endif //FILE_ACCESS_H_8017341345614857
@@ -5,14 +5,57 @@
 // *****************************************************************************
 
 #include "file_io.h"
+#include <atomic>
 
     #include <sys/stat.h>
-    #include <fcntl.h>  //open
+    #include <fcntl.h>  //open, sync_file_range
     #include <unistd.h> //close, read, write
 
 using namespace zen;
 
 
+namespace
+{
+constinit std::atomic<bool> globalPageCacheDropBehind{false};
+}
+
+
+void zen::setPageCacheDropBehind(bool enable) { globalPageCacheDropBehind = enable; }
+bool zen::getPageCacheDropBehind() { return globalPageCacheDropBehind; }
+
+
+void PageCacheDropper::dropBehind(uint64_t streamPos, bool streamEnd) //noexcept
+{
+    //errors are not critical: we're only giving hints to the kernel; write errors are reported by write()/fsync()/close() as usual
+    if (writeBehind_)
+    {
+        //start asynchronous write-back of the current window
+        if (streamPos > writePos_)
+            if (::sync_file_range(handle_, writePos_, streamPos - writePos_, SYNC_FILE_RANGE_WRITE) != 0)
+                assert(false);
+        writePos_ = streamPos;
+
+        //wait for the write-back of the previous window(s): dirty pages can't be dropped
+        //=> nice side effect: limits the amount of dirty pages for this stream
+        const uint64_t dropEnd = streamEnd ? streamPos : streamPos - std::min(streamPos, DROP_WINDOW_SIZE);
+        if (dropEnd > dropPos_)
+        {
+            if (::sync_file_range(handle_, dropPos_, dropEnd - dropPos_, SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER) != 0)
+                assert(false);
+            if (::posix_fadvise(handle_, dropPos_, dropEnd - dropPos_, POSIX_FADV_DONTNEED) != 0)
+                assert(false);
+            dropPos_ = dropEnd;
+        }
+    }
+    else if (streamPos > dropPos_)
+    {
+        if (::posix_fadvise(handle_, dropPos_, streamPos - dropPos_, POSIX_FADV_DONTNEED) != 0)
+            assert(false);
+        dropPos_ = streamPos;
+    }
+}
+
+
 FileBase::~FileBase()
 {
     if (hFile_ != invalidFileHandle)
@@ -109,6 +152,12 @@ size_t FileInput::tryRead(void* buffer, size_t bytesToRead) //throw FileError, E
     if (static_cast<size_t>(bytesRead) > bytesToRead) //better safe than sorry
         throw FileError(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(getFilePath())), formatSystemError("ReadFile", L"", L"Buffer overflow."));
 
+    streamPos_ += bytesRead;
+    if (bytesRead == 0)
+        cacheDropper_.notifyStreamEnd(streamPos_); //noexcept
+    else
+        cacheDropper_.notifyStreamPos(streamPos_); //noexcept
+
     //if ::read is interrupted (EINTR) right in the middle, it will return successfully with "bytesRead < bytesToRead"
 
     return bytesRead; //"zero indicates end of file"
@@ -146,9 +195,16 @@ size_t FileInput::read(void* buffer, size_t bytesToRead) //throw FileError, Erro
         if (it == itEnd)
             break;
         //--------------------------------------------------------------------
-        const size_t bytesRead = tryRead(&memBuf_[0], blockSize); //throw FileError, ErrorFileLocked; may return short, only 0 means EOF! => CONTRACT: bytesToRead > 0
-        bufPos_ = 0;
-        bufPosEnd_ = bytesRead;
+        //at least one full block left: read directly into caller's buffer => no memcpy() through memBuf_
+        const bool readDirect = static_cast<size_t>(itEnd - it) >= blockSize;
+        const size_t bytesRead = tryRead(readDirect ? it : &memBuf_[0], blockSize); //throw FileError, ErrorFileLocked; may return short, only 0 means EOF! => CONTRACT: bytesToRead > 0
+        if (readDirect)
+            it += bytesRead; //memBuf_ is empty at this point
+        else
+        {
+            bufPos_ = 0;
+            bufPosEnd_ = bytesRead;
+        }
 
         if (notifyUnbufferedIO_) notifyUnbufferedIO_(bytesRead); //throw X
 
@@ -190,8 +246,8 @@ FileBase::FileHandle openHandleForWrite(const Zstring& filePath) //throw FileErr
 }
 
 
-FileOutput::FileOutput(FileHandle handle, const Zstring& filePath, const IoCallback& notifyUnbufferedIO) :
-    FileBase(handle, filePath), notifyUnbufferedIO_(notifyUnbufferedIO)
+FileOutput::FileOutput(FileHandle handle, const Zstring& filePath, const IoCallback& notifyUnbufferedIO, bool anonymous) :
+    FileBase(handle, filePath), notifyUnbufferedIO_(notifyUnbufferedIO), anonymous_(anonymous)
 {
 }
 
@@ -203,7 +259,7 @@ FileOutput::FileOutput(const Zstring& filePath, const IoCallback& notifyUnbuffer
 FileOutput::~FileOutput()
 {
 
-    if (getHandle() != invalidFileHandle) //not finalized => clean up garbage
+    if (getHandle() != invalidFileHandle && !anonymous_) //not finalized => clean up garbage
     {
         //"deleting while handle is open" == FILE_FLAG_DELETE_ON_CLOSE
         if (::unlink(getFilePath().c_str()) != 0)
@@ -236,6 +292,9 @@ size_t FileOutput::tryWrite(const void* buffer, size_t bytesToWrite) //throw Fil
     if (bytesWritten > static_cast<ssize_t>(bytesToWrite)) //better safe than sorry
         throw FileError(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(getFilePath())), formatSystemError("write", L"", L"Buffer overflow."));
 
+    streamPos_ += bytesWritten;
+    cacheDropper_.notifyStreamPos(streamPos_); //noexcept
+
     //if ::write() is interrupted (EINTR) right in the middle, it will return successfully with "bytesWritten < bytesToWrite"!
     return bytesWritten;
 }
@@ -251,6 +310,17 @@ void FileOutput::write(const void* buffer, size_t bytesToWrite) //throw FileErro
     const auto itEnd = it + bytesToWrite;
     for (;;)
     {
+        //nothing buffered + at least one full block left: write directly from caller's buffer => no memcpy() through memBuf_
+        if (bufPos_ == bufPosEnd_ && static_cast<size_t>(itEnd - it) >= blockSize)
+        {
+            const size_t bytesWritten = tryWrite(it, blockSize); //throw FileError; may return short! CONTRACT: bytesToWrite > 0
+            it += bytesWritten;
+            if (notifyUnbufferedIO_) notifyUnbufferedIO_(bytesWritten); //throw X!
+            if (it == itEnd)
+                return;
+            continue;
+        }
+
         if (memBuf_.size() - bufPos_ < blockSize) //support memBuf_.size() > blockSize to reduce memmove()s, but perf test shows: not really needed!
             // || bufPos_ == bufPosEnd_) -> not needed while memBuf_.size() == blockSize
         {
@@ -290,6 +360,7 @@ void FileOutput::flushBuffers() //throw FileError, X
 void FileOutput::finalize() //throw FileError, X
 {
     flushBuffers(); //throw FileError, X
+    cacheDropper_.notifyStreamEnd(streamPos_); //noexcept
     close();        //throw FileError
     //~FileBase() calls this one, too, but we want to propagate errors if any
 }
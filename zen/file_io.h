@@ -52,6 +52,36 @@ private:
 
 //-----------------------------------------------------------------------------------------------
 
+/* "no cache pollution" mode for streaming copies: e.g. nightly backup on a server => don't evict the hot pages of other applications
+    - process-wide setting: applies to all file streams (and kernel copies) started while enabled
+    - read:  drop already processed pages behind the stream position
+    - write: start write-back early (sync_file_range) and drop the pages of the previous window once they are on disk
+    - don't use O_DIRECT instead: alignment requirements for buffer, offset and size, plus unclear semantics on network file systems */
+void setPageCacheDropBehind(bool enable);
+bool getPageCacheDropBehind();
+
+class PageCacheDropper
+{
+public:
+    PageCacheDropper(FileBase::FileHandle handle, bool writeBehind) : handle_(handle), writeBehind_(writeBehind), enabled_(getPageCacheDropBehind()) {}
+
+    void notifyStreamPos(uint64_t streamPos) { if (enabled_ && streamPos - dropPos_ >= (writeBehind_ ? 2 : 1) * DROP_WINDOW_SIZE) dropBehind(streamPos, false); } //noexcept
+    void notifyStreamEnd(uint64_t streamPos) { if (enabled_) dropBehind(streamPos, true); } //noexcept; write: wait until all data is on disk
+
+private:
+    void dropBehind(uint64_t streamPos, bool streamEnd); //noexcept
+
+    static constexpr uint64_t DROP_WINDOW_SIZE = 8 * 1024 * 1024;
+
+    const FileBase::FileHandle handle_;
+    const bool writeBehind_;
+    const bool enabled_;
+    uint64_t dropPos_  = 0; //page cache dropped for all data before this position
+    uint64_t writePos_ = 0; //write-back started for all data before this position
+};
+
+//-----------------------------------------------------------------------------------------------
+
 class FileInput : public FileBase
 {
 public:
@@ -68,6 +98,9 @@ private:
     std::vector<std::byte> memBuf_ = std::vector<std::byte>(getBlockSize());
     size_t bufPos_   = 0;
     size_t bufPosEnd_= 0;
+
+    uint64_t streamPos_ = 0; //bytes read from handle
+    PageCacheDropper cacheDropper_{getHandle(), false /*writeBehind*/};
 };
 
 
@@ -75,7 +108,8 @@ class FileOutput : public FileBase
 {
 public:
     FileOutput(                   const Zstring& filePath, const IoCallback& notifyUnbufferedIO /*throw X*/); //throw FileError, ErrorTargetExisting
-    FileOutput(FileHandle handle, const Zstring& filePath, const IoCallback& notifyUnbufferedIO /*throw X*/); //takes ownership!
+    FileOutput(FileHandle handle, const Zstring& filePath, const IoCallback& notifyUnbufferedIO /*throw X*/, //takes ownership!
+               bool anonymous = false); //O_TMPFILE: "filePath" is not yet linked => nothing to delete if not finalized
     ~FileOutput();
 
     void reserveSpace(uint64_t expectedSize); //throw FileError
@@ -90,9 +124,13 @@ private:
     size_t tryWrite(const void* buffer, size_t bytesToWrite); //throw FileError; may return short! CONTRACT: bytesToWrite > 0
 
     IoCallback notifyUnbufferedIO_; //throw X
+    const bool anonymous_ = false;
     std::vector<std::byte> memBuf_ = std::vector<std::byte>(getBlockSize());
     size_t bufPos_    = 0;
     size_t bufPosEnd_ = 0;
+
+    uint64_t streamPos_ = 0; //bytes written to handle
+    PageCacheDropper cacheDropper_{getHandle(), true /*writeBehind*/};
 };
 //-----------------------------------------------------------------------------------------------
 //native stream I/O convenience functions:
@@ -0,0 +1,140 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#ifndef FLAT_MAP_H_3817460298457102938
+#define FLAT_MAP_H_3817460298457102938
+
+#include <vector>
+#include <tuple>
+#include <algorithm>
+#include <cassert>
+
+
+namespace zen
+{
+/*  compact std::unordered_map<> replacement for the typical file hierarchy folder with only a handful of items:
+    - single std::vector<>: no buckets, no per-item nodes; empty map: no allocation at all
+    - sorted range + small unsorted tail for new items => insertion in amortized O(sqrt n) instead of O(n)
+    - tail is merged during insertion only: const access is read-only => safe for concurrent readers, same as std::unordered_map<>
+    - iteration order is unspecified (just like std::unordered_map<>)
+    - iterators and references are invalidated by insertion and erasure (unlike std::unordered_map<>)! */
+template <class K, class V>
+class FlatMap
+{
+public:
+    using key_type       = K;
+    using mapped_type    = V;
+    using value_type     = std::pair<K, V>;
+    using iterator       = typename std::vector<value_type>::iterator;
+    using const_iterator = typename std::vector<value_type>::const_iterator;
+
+    FlatMap() {}
+
+    iterator       begin()       { return items_.begin(); }
+    iterator       end  ()       { return items_.end  (); }
+    const_iterator begin() const { return items_.begin(); }
+    const_iterator end  () const { return items_.end  (); }
+
+    size_t size() const { return items_.size(); }
+    bool  empty() const { return items_.empty(); }
+
+    void reserve(size_t itemCount) { items_.reserve(itemCount); }
+    void clear() { items_.clear(); sortedCount_ = 0; }
+
+    iterator       find(const K& key)       { return items_.begin() + findPos(key); }
+    const_iterator find(const K& key) const { return items_.begin() + findPos(key); }
+
+    bool contains(const K& key) const { return findPos(key) != items_.size(); }
+
+    template <class... Args>
+    std::pair<iterator, bool> try_emplace(const K& key, Args&&... args)
+    {
+        if (const size_t pos = findPos(key); pos != items_.size())
+            return {items_.begin() + pos, false};
+
+        if (const size_t tailSize = items_.size() - sortedCount_;
+            tailSize >= TAIL_SIZE_MIN && tailSize * tailSize >= items_.size())
+            mergeTail();
+
+        items_.emplace_back(std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(std::forward<Args>(args)...));
+        return {items_.end() - 1, true};
+    }
+
+    template <class U>
+    std::pair<iterator, bool> emplace(const K& key, U&& value) { return try_emplace(key, std::forward<U>(value)); }
+
+    template <class U>
+    std::pair<iterator, bool> insert_or_assign(const K& key, U&& value)
+    {
+        auto rv = try_emplace(key, std::forward<U>(value));
+        if (!rv.second)
+            rv.first->second = std::forward<U>(value);
+        return rv;
+    }
+
+    V& operator[](const K& key) { return try_emplace(key).first->second; }
+
+    iterator erase(const_iterator it)
+    {
+        if (static_cast<size_t>(it - items_.cbegin()) < sortedCount_)
+            --sortedCount_;
+        return items_.erase(it);
+    }
+
+    size_t erase(const K& key)
+    {
+        if (const size_t pos = findPos(key); pos != items_.size())
+        {
+            erase(items_.cbegin() + pos);
+            return 1;
+        }
+        return 0;
+    }
+
+    template <class Predicate>
+    friend size_t eraseIf(FlatMap& m, Predicate p) //equivalent of std::erase_if()
+    {
+        m.mergeTail();
+        const size_t sizeOld = m.items_.size();
+        m.items_.erase(std::remove_if(m.items_.begin(), m.items_.end(), p), m.items_.end());
+        m.sortedCount_ = m.items_.size();
+        return sizeOld - m.items_.size();
+    }
+
+private:
+    static constexpr size_t TAIL_SIZE_MIN = 16; //tiny folders: linear search is fastest anyway
+
+    static bool lessKey(const value_type& lhs, const value_type& rhs) { return lhs.first < rhs.first; }
+
+    size_t findPos(const K& key) const //return size() if not found
+    {
+        const auto itSortedEnd = items_.begin() + sortedCount_;
+
+        if (auto it = std::lower_bound(items_.begin(), itSortedEnd, key, [](const value_type& item, const K& k) { return item.first < k; });
+            it != itSortedEnd && it->first == key)
+            return it - items_.begin();
+
+        for (auto it = itSortedEnd; it != items_.end(); ++it)
+            if (it->first == key)
+                return it - items_.begin();
+
+        return items_.size();
+    }
+
+    void mergeTail()
+    {
+        const auto itSortedEnd = items_.begin() + sortedCount_;
+        std::sort(itSortedEnd, items_.end(), lessKey);
+        std::inplace_merge(items_.begin(), itSortedEnd, items_.end(), lessKey); //keys are unique => no stability concerns
+        sortedCount_ = items_.size();
+    }
+
+    std::vector<value_type> items_;
+    size_t sortedCount_ = 0; //items_[0, sortedCount_) sorted by key, followed by unsorted tail
+};
+}
+
+#endif //FLAT_MAP_H_3817460298457102938
@@ -7,6 +7,7 @@
 #include "format_unit.h"
 #include <ctime>
 #include <cstdio>
+#include <climits> //CHAR_MAX
 #include "basic_math.h"
 #include "sys_error.h"
 #include "i18n.h"
@@ -158,16 +159,208 @@ std::wstring zen::formatPercent0(double fraction)
 
 
 
-std::wstring zen::formatNumber(int64_t n)
+namespace
+{
+/*  formatNumber() and formatUtcToLocalTime() are called for each visible grid cell on every paint
+    => avoid swprintf("%'lld"), localtime_r() and mktime() per call:
+    - locale data is cached per thread: nl_langinfo() returns pointers into the active locale => pointer change == locale change
+    - UTC offset is cached per UTC day (if constant for the whole day), formatted date per local day     */
+struct NumberGrouping
+{
+    const char* thouSepRaw = nullptr;
+    const char* groupingRaw = nullptr;
+    std::wstring thouSep;
+    std::string grouping; //see localeconv(): each char is the size of a group, last one repeats, CHAR_MAX: no further grouping
+};
+
+
+const NumberGrouping& getNumberGrouping()
 {
     //::setlocale (LC_ALL, ""); -> see localization.cpp::wxWidgetsLocale
-    static_assert(sizeof(long long int) == sizeof(n));
-    return printNumber<std::wstring>(L"%'lld", n); //considers grouping (')
+    thread_local NumberGrouping ng;
+
+    const char* thouSepRaw  = ::nl_langinfo(THOUSEP);
+    const char* groupingRaw = ::nl_langinfo(GROUPING);
+    if (thouSepRaw != ng.thouSepRaw || groupingRaw != ng.groupingRaw)
+    {
+        ng.thouSepRaw  = thouSepRaw;
+        ng.groupingRaw = groupingRaw;
+        ng.thouSep  = thouSepRaw  ? utfTo<std::wstring>(thouSepRaw) : std::wstring();
+        ng.grouping = groupingRaw ? groupingRaw : "";
+    }
+    return ng;
+}
+
+
+constexpr int64_t SECS_PER_DAY = 24 * 3600;
+
+//https://howardhinnant.github.io/date_algorithms.html#civil_from_days
+std::tm civilFromUnixDays(int64_t unixDays)
+{
+    const int64_t days = unixDays + 719468;
+    const int64_t era = numeric::intDivFloor(days, int64_t(146097));
+    const int64_t doe = days - era * 146097;                              //[0, 146096]
+    const int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365; //[0, 399]
+    const int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);           //[0, 365]
+    const int64_t mp  = (5 * doy + 2) / 153;                               //[0, 11]
+    const int64_t d   = doy - (153 * mp + 2) / 5 + 1;                      //[1, 31]
+    const int64_t m   = mp < 10 ? mp + 3 : mp - 9;                         //[1, 12]
+    const int64_t y   = yoe + era * 400 + (m <= 2);
+
+    const bool leapYear = (y % 4 == 0 && y % 100 != 0) || y % 400 == 0;
+    const int daysBeforeMonth[] = {0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334};
+
+    std::tm ctc = {};
+    ctc.tm_year = static_cast<int>(y - 1900);
+    ctc.tm_mon  = static_cast<int>(m - 1);
+    ctc.tm_mday = static_cast<int>(d);
+    ctc.tm_wday = static_cast<int>((unixDays % 7 + 11) % 7); //1970-01-01 was a Thursday
+    ctc.tm_yday = daysBeforeMonth[m - 1] + (leapYear && m > 2) + static_cast<int>(d) - 1;
+    ctc.tm_isdst = -1;
+    return ctc;
+}
+
+
+std::optional<long> getUtcOffset(time_t utc) //see getLocalTime()
+{
+    const int cycles400 = static_cast<int>(numeric::intDivFloor(utc, secsPer400Years));
+    utc -= secsPer400Years * cycles400;
+
+    std::tm ctc = {};
+    if (::localtime_r(&utc, &ctc) == nullptr)
+        return {};
+    return ctc.tm_gmtoff;
+}
+
+
+struct LocalTimeCache
+{
+    struct UtcDay
+    {
+        int64_t utcDay = std::numeric_limits<int64_t>::min();
+        std::optional<long> utcOffset; //empty: offset changes during the day (DST) or localtime_r() failed
+    };
+    struct LocalDay
+    {
+        int64_t localDay = std::numeric_limits<int64_t>::min();
+        const char* dateFmtRaw = nullptr; //nl_langinfo(D_FMT) => detect locale change
+        std::wstring dateString;
+    };
+    static constexpr size_t SLOTS = 64; //direct-mapped: a typical grid page spans only a handful of days
+
+    UtcDay   utcDays  [SLOTS];
+    LocalDay localDays[SLOTS];
+};
+
+
+size_t getCacheSlot(int64_t day) { return static_cast<size_t>(day) % LocalTimeCache::SLOTS; }
+
+
+std::wstring formatLocalTimeFromCache(time_t utcTime) //returns empty string if not cacheable
+{
+    thread_local LocalTimeCache cache;
+
+    const int64_t utcDay = numeric::intDivFloor(static_cast<int64_t>(utcTime), SECS_PER_DAY);
+
+    LocalTimeCache::UtcDay& ud = cache.utcDays[getCacheSlot(utcDay)];
+    if (ud.utcDay != utcDay)
+    {
+        ud.utcDay = utcDay;
+        ud.utcOffset.reset();
+
+        const std::optional<long> offsetBegin = getUtcOffset(static_cast<time_t>(utcDay * SECS_PER_DAY));
+        const std::optional<long> offsetEnd   = getUtcOffset(static_cast<time_t>(utcDay * SECS_PER_DAY + SECS_PER_DAY - 1));
+        if (offsetBegin && offsetBegin == offsetEnd)
+            ud.utcOffset = offsetBegin;
+    }
+    if (!ud.utcOffset)
+        return {};
+
+    const int64_t localTime = static_cast<int64_t>(utcTime) + *ud.utcOffset;
+    const int64_t localDay  = numeric::intDivFloor(localTime, SECS_PER_DAY);
+    const int64_t secOfDay  = localTime - localDay * SECS_PER_DAY;
+
+    std::tm ctc = civilFromUnixDays(localDay);
+    ctc.tm_hour = static_cast<int>(secOfDay / 3600);
+    ctc.tm_min  = static_cast<int>(secOfDay / 60 % 60);
+    ctc.tm_sec  = static_cast<int>(secOfDay % 60);
+
+    char buffer[128];
+    LocalTimeCache::LocalDay& ld = cache.localDays[getCacheSlot(localDay)];
+    if (const char* dateFmtRaw = ::nl_langinfo(D_FMT);
+        ld.localDay != localDay || ld.dateFmtRaw != dateFmtRaw)
+    {
+        const size_t charsWritten = std::strftime(buffer, sizeof(buffer), "%x  ", &ctc);
+        if (charsWritten == 0)
+            return {};
+        ld.localDay   = localDay;
+        ld.dateFmtRaw = dateFmtRaw;
+        ld.dateString = utfTo<std::wstring>(std::string_view(buffer, charsWritten));
+    }
+
+    const size_t charsWritten = std::strftime(buffer, sizeof(buffer), "%X", &ctc);
+    if (charsWritten == 0)
+        return {};
+
+    return ld.dateString + utfTo<std::wstring>(std::string_view(buffer, charsWritten));
+}
+}
+
+
+std::wstring zen::formatNumber(int64_t n)
+{
+    const NumberGrouping& ng = getNumberGrouping();
+    if (ng.thouSep.size() > 4) //unexpected locale data
+    {
+        static_assert(sizeof(long long int) == sizeof(n));
+        return printNumber<std::wstring>(L"%'lld", n); //considers grouping (')
+    }
+
+    //format from the back into a stack buffer: sign + max. 20 digits + 19 separators
+    wchar_t buffer[1 + 20 + 19 * 4];
+    wchar_t* const bufEnd = std::end(buffer);
+    wchar_t* it = bufEnd;
+
+    uint64_t absN = n < 0 ? 0 - static_cast<uint64_t>(n) : static_cast<uint64_t>(n);
+
+    auto itGroup = ng.grouping.begin();
+    int groupSize = itGroup != ng.grouping.end() && *itGroup > 0 && *itGroup != CHAR_MAX ? *itGroup : 0; //0: no (further) grouping
+    int digitsInGroup = 0;
+
+    for (;;)
+    {
+        *--it = static_cast<wchar_t>(L'0' + absN % 10);
+        absN /= 10;
+        if (absN == 0)
+            break;
+
+        if (groupSize > 0 && ++digitsInGroup == groupSize)
+        {
+            it -= ng.thouSep.size();
+            std::copy(ng.thouSep.begin(), ng.thouSep.end(), it);
+            digitsInGroup = 0;
+
+            if (itGroup + 1 != ng.grouping.end()) //last group size repeats
+            {
+                ++itGroup;
+                groupSize = *itGroup > 0 && *itGroup != CHAR_MAX ? *itGroup : 0;
+            }
+        }
+    }
+    if (n < 0)
+        *--it = L'-';
+
+    return std::wstring(it, bufEnd);
 }
 
 
 std::wstring zen::formatUtcToLocalTime(time_t utcTime)
 {
+    if (std::wstring dateString = formatLocalTimeFromCache(utcTime);
+        !dateString.empty())
+        return dateString;
+
+    //DST switch during this day, or locale/time zone weirdness: take the slow path
     auto errorMsg = [&] { return _("Error") + L" (time_t: " + numberTo<std::wstring>(utcTime) + L')'; };
 
     const TimeComp& loc = getLocalTime(utcTime); //returns TimeComp() on error
@@ -17,8 +17,8 @@
 //minimal layer enabling text translation - without platform/library dependencies!
 
 #define ZEN_TRANS_CONCAT_SUB(X, Y) X ## Y
-#define _(s)        zen::translate(ZEN_TRANS_CONCAT_SUB(L, s))
-#define _P(s, p, n) zen::translate(ZEN_TRANS_CONCAT_SUB(L, s), ZEN_TRANS_CONCAT_SUB(L, p), n)
+#define _(s)        zen::translate(zen::TranslationKey(ZEN_TRANS_CONCAT_SUB(L, s)))
+#define _P(s, p, n) zen::translate(zen::TranslationKey(ZEN_TRANS_CONCAT_SUB(L, s)), zen::TranslationKey(ZEN_TRANS_CONCAT_SUB(L, p)), n)
 //source and translation are required to use %x as number placeholder
 //for plural form, which will be substituted automatically!!!
 
@@ -26,6 +26,27 @@
 
 namespace zen
 {
+//English source text + hash: computed at compile time for _() and _P() => no string allocation and hashing per lookup
+struct TranslationKey
+{
+    template <size_t N>
+    consteval TranslationKey(const wchar_t (&str)[N]) : TranslationKey(std::wstring_view(str, N - 1)) {} //string literal
+
+    constexpr explicit TranslationKey(std::wstring_view str) : text(str), hash(calcHash(str)) {} //runtime text, e.g. from config file
+
+    static constexpr size_t calcHash(std::wstring_view str) //= hashString<size_t>(): same hash for std::wstring lookup
+    {
+        FNV1aHash<size_t> h;
+        for (const wchar_t c : str)
+            h.add(c);
+        return h.get();
+    }
+
+    std::wstring_view text;
+    size_t hash;
+};
+
+
 //implement handler to enable program-wide localizations:
 struct TranslationHandler
 {
@@ -34,8 +55,8 @@ struct TranslationHandler
     virtual ~TranslationHandler() {}
 
     //C++11: std::wstring should be thread-safe like an int
-    virtual std::wstring translate(const std::wstring& text) const = 0; //simple translation
-    virtual std::wstring translate(const std::wstring& singular, const std::wstring& plural, int64_t n) const = 0;
+    virtual std::wstring translate(const TranslationKey& text) const = 0; //simple translation
+    virtual std::wstring translate(const TranslationKey& singular, const TranslationKey& plural, int64_t n) const = 0;
 
 private:
     TranslationHandler           (const TranslationHandler&) = delete;
@@ -76,10 +97,19 @@ void setTranslator(std::unique_ptr<const TranslationHandler>&& newHandler)
 
 
 inline
-std::wstring translate(const std::wstring& text)
+std::wstring translate(const TranslationKey& text)
 {
     if (std::shared_ptr<const TranslationHandler> t = getTranslator()) //std::shared_ptr => temporarily take (shared) ownership while using the interface!
         return t->translate(text);
+    return std::wstring(text.text);
+}
+
+
+inline
+std::wstring translate(const std::wstring& text)
+{
+    if (std::shared_ptr<const TranslationHandler> t = getTranslator())
+        return t->translate(TranslationKey(text));
     return text;
 }
 
@@ -87,12 +117,12 @@ std::wstring translate(const std::wstring& text)
 //translate plural forms: "%x day" "%x days"
 //returns "1 day" if n == 1; "123 days" if n == 123 for english language
 template <class T> inline
-std::wstring translate(const std::wstring& singular, const std::wstring& plural, T n)
+std::wstring translate(const TranslationKey& singular, const TranslationKey& plural, T n)
 {
     static_assert(sizeof(n) <= sizeof(int64_t));
     const auto n64 = static_cast<int64_t>(n);
 
-    assert(contains(plural, L"%x"));
+    assert(contains(plural.text, L"%x"));
 
     if (std::shared_ptr<const TranslationHandler> t = getTranslator())
     {
@@ -101,7 +131,7 @@ std::wstring translate(const std::wstring& singular, const std::wstring& plural,
         return translation;
     }
     //fallback:
-    return replaceCpy(std::abs(n64) == 1 ? singular : plural, L"%x", formatNumber(n));
+    return replaceCpy(std::wstring(std::abs(n64) == 1 ? singular.text : plural.text), L"%x", formatNumber(n));
 }
 }
 
@@ -61,6 +61,8 @@ struct JsonParsingError
 JsonValue parseJson(const std::string& stream); //throw JsonParsingError
 
 
+class JsonReader; //pull-style reading without building the JsonValue tree: see below
+
 
 //helper functions for JsonValue access:
 inline
@@ -129,8 +131,11 @@ namespace
 }
 
 
-[[nodiscard]] std::string jsonUnescape(const std::string& str)
+[[nodiscard]] std::string jsonUnescape(std::string_view str)
 {
+    if (!contains(str, '\\')) //perf: most strings don't use escaping
+        return std::string(str);
+
     std::string output;
     std::basic_string<impl::Char16> utf16Buf;
 
@@ -330,7 +335,7 @@ struct Token
 class Scanner
 {
 public:
-    Scanner(const std::string& stream) : stream_(stream), pos_(stream_.begin())
+    explicit Scanner(std::string_view stream) : stream_(stream), pos_(stream_.begin())
     {
         if (zen::startsWith(stream_, BYTE_ORDER_MARK_UTF8))
             pos_ += strLength(BYTE_ORDER_MARK_UTF8);
@@ -338,8 +343,11 @@ public:
 
     Token getNextToken() //throw JsonParsingError
     {
+        prevTokenEnd_ = pos_;
+
         //skip whitespace
         pos_ = std::find_if_not(pos_, stream_.end(), isJsonWhiteSpace);
+        tokenBegin_ = pos_;
 
         if (pos_ == stream_.end())
             return TokenType::eof;
@@ -403,6 +411,9 @@ public:
         return std::max(crSum, nlSum); //be compatible with Linux/Mac/Win
     }
 
+    size_t posTokenBegin  () const { return tokenBegin_   - stream_.begin(); } //token returned last
+    size_t posPrevTokenEnd() const { return prevTokenEnd_ - stream_.begin(); } //token returned before
+
     size_t posCol() const //current col beginning with 0
     {
         //seek beginning of line
@@ -427,131 +438,200 @@ private:
         return zen::startsWith(makeStringView(pos_, stream_.end()), prefix);
     }
 
-    const std::string stream_;
-    std::string::const_iterator pos_;
+    const std::string_view stream_;
+    std::string_view::const_iterator pos_;
+    std::string_view::const_iterator tokenBegin_   = pos_;
+    std::string_view::const_iterator prevTokenEnd_ = pos_;
 };
+}
 
 
-class JsonParser
+/* pull-style reading: extract selected values without building the JsonValue tree, e.g. for large server responses
+    - "stream" is not copied: must outlive JsonReader
+    - readObject()/readArray() callbacks must read (or skip) exactly one value each  */
+class JsonReader
 {
 public:
-    JsonParser(const std::string& stream) :
+    explicit JsonReader(std::string_view stream) :
         scn_(stream),
         tk_(scn_.getNextToken()) {} //throw JsonParsingError
 
-    JsonValue parse() //throw JsonParsingError
+    JsonValue::Type peekType() const //throw JsonParsingError
     {
-        JsonValue jval = parseValue(); //throw JsonParsingError
-        expectToken(TokenType::eof); //
-        return jval;
-    }
+        switch (token().type)
+        {
+            //*INDENT-OFF*
+            case json_impl::TokenType::curlyOpen:  return JsonValue::Type::object;
+            case json_impl::TokenType::squareOpen: return JsonValue::Type::array;
+            case json_impl::TokenType::string:     return JsonValue::Type::string;
+            case json_impl::TokenType::number:     return JsonValue::Type::number;
+            case json_impl::TokenType::boolean:    return JsonValue::Type::boolean;
+            case json_impl::TokenType::null:       return JsonValue::Type::null;
+            //*INDENT-ON*
 
-private:
-    JsonParser           (const JsonParser&) = delete;
-    JsonParser& operator=(const JsonParser&) = delete;
+            case json_impl::TokenType::eof:
+            case json_impl::TokenType::curlyClose:
+            case json_impl::TokenType::squareClose:
+            case json_impl::TokenType::colon:
+            case json_impl::TokenType::comma:
+                break;
+        }
+        throw JsonParsingError(scn_.posRow(), scn_.posCol()); //unexpected token
+    }
 
-    JsonValue parseValue() //throw JsonParsingError
+    template <class Function>
+    void readObject(Function onMember) //throw JsonParsingError, X
     {
-        if (token().type == TokenType::curlyOpen)
-        {
-            nextToken(); //throw JsonParsingError
+        consumeToken(json_impl::TokenType::curlyOpen); //throw JsonParsingError
 
-            JsonValue jval(JsonValue::Type::object);
+        if (token().type != json_impl::TokenType::curlyClose)
+            for (;;)
+            {
+                expectToken(json_impl::TokenType::string); //throw JsonParsingError
+                const std::string name = std::move(tk_.primVal);
+                nextToken(); //throw JsonParsingError
 
-            if (token().type != TokenType::curlyClose)
-                for (;;)
-                {
-                    expectToken(TokenType::string); //throw JsonParsingError
-                    std::string name = token().primVal;
-                    nextToken(); //throw JsonParsingError
+                consumeToken(json_impl::TokenType::colon); //throw JsonParsingError
 
-                    consumeToken(TokenType::colon); //throw JsonParsingError
+                onMember(name); //throw JsonParsingError, X
 
-                    JsonValue value = parseValue(); //throw JsonParsingError
-                    jval.objectVal.emplace(std::move(name), std::move(value));
+                if (token().type != json_impl::TokenType::comma)
+                    break;
+                nextToken(); //throw JsonParsingError
+            }
 
-                    if (token().type != TokenType::comma)
-                        break;
-                    nextToken(); //throw JsonParsingError
-                }
+        consumeToken(json_impl::TokenType::curlyClose); //throw JsonParsingError
+    }
 
-            consumeToken(TokenType::curlyClose); //throw JsonParsingError
-            return jval;
-        }
-        else if (token().type == TokenType::squareOpen)
-        {
-            nextToken(); //throw JsonParsingError
+    template <class Function>
+    void readArray(Function onElement) //throw JsonParsingError, X
+    {
+        consumeToken(json_impl::TokenType::squareOpen); //throw JsonParsingError
 
-            JsonValue jval(JsonValue::Type::array);
+        if (token().type != json_impl::TokenType::squareClose)
+            for (;;)
+            {
+                onElement(); //throw JsonParsingError, X
 
-            if (token().type != TokenType::squareClose)
-                for (;;)
-                {
-                    JsonValue value = parseValue();  //throw JsonParsingError
-                    jval.arrayVal.emplace_back(std::move(value));
+                if (token().type != json_impl::TokenType::comma)
+                    break;
+                nextToken(); //throw JsonParsingError
+            }
 
-                    if (token().type != TokenType::comma)
-                        break;
-                    nextToken(); //throw JsonParsingError
-                }
+        consumeToken(json_impl::TokenType::squareClose); //throw JsonParsingError
+    }
 
-            consumeToken(TokenType::squareClose); //throw JsonParsingError
-            return jval;
-        }
-        else if (token().type == TokenType::string)
-        {
-            JsonValue jval(token().primVal);
-            nextToken(); //throw JsonParsingError
-            return jval;
-        }
-        else if (token().type == TokenType::number)
+    std::optional<std::string> readPrimitive() //throw JsonParsingError
+    {
+        switch (peekType()) //throw JsonParsingError
         {
-            JsonValue jval(JsonValue::Type::number);
-            jval.primVal = token().primVal;
-            nextToken(); //throw JsonParsingError
-            return jval;
+            case JsonValue::Type::string:
+            case JsonValue::Type::number:
+            case JsonValue::Type::boolean:
+            {
+                std::string primVal = std::move(tk_.primVal);
+                nextToken(); //throw JsonParsingError
+                return primVal;
+            }
+            case JsonValue::Type::null:
+                nextToken(); //throw JsonParsingError
+                return std::nullopt;
+
+            case JsonValue::Type::object:
+            case JsonValue::Type::array:
+                break;
         }
-        else if (token().type == TokenType::boolean)
+        throw JsonParsingError(scn_.posRow(), scn_.posCol());
+    }
+
+    JsonValue readValue() //throw JsonParsingError
+    {
+        switch (const JsonValue::Type type = peekType()) //throw JsonParsingError
         {
-            JsonValue jval(JsonValue::Type::boolean);
-            jval.primVal = token().primVal;
-            nextToken(); //throw JsonParsingError
-            return jval;
+            case JsonValue::Type::object:
+            {
+                JsonValue jval(JsonValue::Type::object);
+                readObject([&](const std::string& name) { jval.objectVal.emplace(name, readValue()); }); //throw JsonParsingError
+                return jval;
+            }
+            case JsonValue::Type::array:
+            {
+                JsonValue jval(JsonValue::Type::array);
+                readArray([&] { jval.arrayVal.emplace_back(readValue()); }); //throw JsonParsingError
+                return jval;
+            }
+            case JsonValue::Type::null:
+                nextToken(); //throw JsonParsingError
+                return JsonValue();
+
+            case JsonValue::Type::string:
+            case JsonValue::Type::number:
+            case JsonValue::Type::boolean:
+            {
+                JsonValue jval(type);
+                jval.primVal = std::move(tk_.primVal);
+                nextToken(); //throw JsonParsingError
+                return jval;
+            }
         }
-        else if (token().type == TokenType::null)
+        throw JsonParsingError(scn_.posRow(), scn_.posCol());
+    }
+
+    void skipValue() //throw JsonParsingError
+    {
+        switch (peekType()) //throw JsonParsingError
         {
-            nextToken(); //throw JsonParsingError
-            return JsonValue();
+            case JsonValue::Type::object:
+                readObject([&](const std::string& /*name*/) { skipValue(); }); //throw JsonParsingError
+                break;
+            case JsonValue::Type::array:
+                readArray([&] { skipValue(); }); //throw JsonParsingError
+                break;
+            case JsonValue::Type::null:
+            case JsonValue::Type::string:
+            case JsonValue::Type::number:
+            case JsonValue::Type::boolean:
+                nextToken(); //throw JsonParsingError
+                break;
         }
-        else //unexpected token
-            throw JsonParsingError(scn_.posRow(), scn_.posCol());
     }
 
-    const Token& token() const { return tk_; }
+    void expectEnd() { expectToken(json_impl::TokenType::eof); } //throw JsonParsingError
+
+    size_t posValueBegin() const { return scn_.posTokenBegin(); }
+    size_t posValueEnd  () const { return scn_.posPrevTokenEnd(); }
+
+private:
+    JsonReader           (const JsonReader&) = delete;
+    JsonReader& operator=(const JsonReader&) = delete;
+
+    const json_impl::Token& token() const { return tk_; }
 
     void nextToken() { tk_ = scn_.getNextToken(); } //throw JsonParsingError
 
-    void expectToken(TokenType t) //throw JsonParsingError
+    void expectToken(json_impl::TokenType t) //throw JsonParsingError
     {
         if (token().type != t)
             throw JsonParsingError(scn_.posRow(), scn_.posCol());
     }
 
-    void consumeToken(TokenType t) //throw JsonParsingError
+    void consumeToken(json_impl::TokenType t) //throw JsonParsingError
     {
         expectToken(t); //throw JsonParsingError
         nextToken();    //
     }
 
-    Scanner scn_;
-    Token tk_;
+    json_impl::Scanner scn_;
+    json_impl::Token tk_;
 };
-}
 
 inline
 JsonValue parseJson(const std::string& stream) //throw JsonParsingError
 {
-    return json_impl::JsonParser(stream).parse(); //throw JsonParsingError
+    JsonReader reader(stream); //throw JsonParsingError
+    JsonValue jval = reader.readValue(); //
+    reader.expectEnd();                  //
+    return jval;
 }
 }
 
@@ -407,6 +407,58 @@ void zen::verifySignature(const std::string& message, const std::string& signatu
 }
 
 
+zen::HashStream::HashStream(HashAlgorithm algo) : //throw SysError
+    mdctx_(::EVP_MD_CTX_create())
+{
+    if (!mdctx_)
+        throw SysError(formatSystemError("EVP_MD_CTX_create", L"", L"Unexpected failure.")); //no more error details
+    ZEN_ON_SCOPE_FAIL(::EVP_MD_CTX_destroy(mdctx_));
+
+    const EVP_MD* mdType = [&]
+    {
+        switch (algo)
+        {
+            //*INDENT-OFF*
+            case HashAlgorithm::md5:    return ::EVP_md5();
+            case HashAlgorithm::sha1:   return ::EVP_sha1();
+            case HashAlgorithm::sha256: return ::EVP_sha256();
+            //*INDENT-ON*
+        }
+        throw std::logic_error("Contract violation! " + std::string(__FILE__) + ':' + numberTo<std::string>(__LINE__));
+    }();
+
+    if (::EVP_DigestInit_ex(mdctx_,   //EVP_MD_CTX* ctx
+                            mdType,   //const EVP_MD* type
+                            nullptr) != 1) //ENGINE* impl
+        throw SysError(formatLastOpenSSLError("EVP_DigestInit_ex"));
+}
+
+
+zen::HashStream::~HashStream() { ::EVP_MD_CTX_destroy(mdctx_); }
+
+
+void zen::HashStream::update(const void* data, size_t len) //throw SysError
+{
+    if (::EVP_DigestUpdate(mdctx_, data, len) != 1)
+        throw SysError(formatLastOpenSSLError("EVP_DigestUpdate"));
+}
+
+
+std::string zen::HashStream::finalize() //throw SysError
+{
+    std::string digest(EVP_MAX_MD_SIZE, '\0');
+    unsigned int digestLen = 0;
+
+    if (::EVP_DigestFinal_ex(mdctx_,                                       //EVP_MD_CTX* ctx
+                             reinterpret_cast<unsigned char*>(&digest[0]), //unsigned char* md
+                             &digestLen) != 1)                             //unsigned int* s
+        throw SysError(formatLastOpenSSLError("EVP_DigestFinal_ex"));
+
+    digest.resize(digestLen);
+    return digest;
+}
+
+
 bool zen::isPuttyKeyStream(const std::string& keyStream)
 {
     std::string firstLine(keyStream.begin(), std::find_if(keyStream.begin(), keyStream.end(), isLineBreak<char>));
@@ -9,6 +9,8 @@
 
 #include "sys_error.h"
 
+struct evp_md_ctx_st; //EVP_MD_CTX
+
 
 namespace zen
 {
@@ -35,6 +37,31 @@ std::string convertRsaKey(const std::string& keyStream, RsaStreamType typeFrom,
 
 bool isPuttyKeyStream(const std::string& keyStream);
 std::string convertPuttyKeyToPkix(const std::string& keyStream, const std::string& passphrase); //throw SysError
+
+
+enum class HashAlgorithm
+{
+    md5,
+    sha1,
+    sha256,
+};
+
+//incremental message digest, e.g. hash a file while streaming
+class HashStream
+{
+public:
+    explicit HashStream(HashAlgorithm algo); //throw SysError
+    ~HashStream();
+
+    void update(const void* data, size_t len); //throw SysError
+    std::string finalize(); //throw SysError; returns raw digest bytes
+
+private:
+    HashStream           (const HashStream&) = delete;
+    HashStream& operator=(const HashStream&) = delete;
+
+    evp_md_ctx_st* const mdctx_;
+};
 }
 
 #endif //OPEN_SSL_H_801974580936508934568792347506
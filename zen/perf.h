@@ -7,7 +7,12 @@
 #ifndef PERF_H_83947184145342652456
 #define PERF_H_83947184145342652456
 
+#include <atomic>
 #include <chrono>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
 #include "scope_guard.h"
 #include "string_tools.h"
 
@@ -25,6 +30,27 @@
     perfTest.resume();
     ZEN_ON_SCOPE_EXIT(perfTest.pause());                      */
 
+
+//############# scoped tracing: Chrome trace/Perfetto JSON ##################
+/* Example:
+        void loadDatabase()
+        {
+            ZEN_TRACE_SCOPE("loadDatabase");
+            ...
+            ZEN_TRACE_SCOPE_ARG("parseStream", stream.size());
+
+    - no-op until enableTracing(true) (one relaxed atomic load per span)
+    - compile out via ZEN_TRACING_DISABLED
+    - view getTraceJson() output in chrome://tracing or https://ui.perfetto.dev  */
+#ifdef ZEN_TRACING_DISABLED
+    #define ZEN_TRACE_SCOPE(name)
+    #define ZEN_TRACE_SCOPE_ARG(name, arg)
+#else
+    #define ZEN_TRACE_SCOPE(name)          [[maybe_unused]] zen::TraceSpan ZEN_CONCAT(traceSpan, __LINE__)(name);
+    #define ZEN_TRACE_SCOPE_ARG(name, arg) [[maybe_unused]] zen::TraceSpan ZEN_CONCAT(traceSpan, __LINE__)(name, static_cast<int64_t>(arg));
+#endif
+//###########################################################################
+
 namespace zen
 {
 /* issue with wxStopWatch? https://freefilesync.org/forum/viewtopic.php?t=1426
@@ -110,6 +136,166 @@ private:
     StopWatch watch_;
     bool resultShown_ = false;
 };
+
+//---------------------------------------------------------------------------
+
+void enableTracing(bool enable);
+std::string getTraceJson(); //thread-safe: may be called while spans are recorded
+
+
+class TraceSpan
+{
+public:
+    explicit TraceSpan(const char* name /*string literal!*/, std::optional<int64_t> arg = {});
+    ~TraceSpan();
+
+private:
+    TraceSpan           (const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+    const char* const name_;
+    const std::optional<int64_t> arg_;
+    std::chrono::steady_clock::time_point startTime_{}; //== time_point{} if tracing disabled
+};
+
+
+
+
+
+
+
+
+//######################## implementation ##########################
+namespace impl
+{
+const size_t TRACE_EVENTS_PER_THREAD_MAX = 100'000; //ring buffer: keep the latest events only
+
+struct TraceEvent
+{
+    const char* name;
+    std::optional<int64_t> arg;
+    std::chrono::microseconds begin;
+    std::chrono::microseconds duration;
+};
+
+
+struct TraceThreadBuffer
+{
+    explicit TraceThreadBuffer(size_t id) : threadId(id) {}
+
+    const size_t threadId;
+    std::mutex lockEvents; //uncontended: only getTraceJson() competes with the owning thread
+    std::vector<TraceEvent> events;
+    size_t nextPos = 0; //once events is full: position to overwrite next
+};
+
+
+struct TraceGlobals
+{
+    std::atomic<bool> enabled{false};
+    const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+    std::mutex lockThreads;
+    std::vector<std::shared_ptr<TraceThreadBuffer>> threads; //keep events of finished threads
+};
+inline TraceGlobals globalTrace;
+
+
+inline
+TraceThreadBuffer& getTraceThreadBuffer()
+{
+    thread_local const std::shared_ptr<TraceThreadBuffer> threadBuf = []
+    {
+        std::lock_guard dummy(globalTrace.lockThreads);
+        auto buf = std::make_shared<TraceThreadBuffer>(globalTrace.threads.size() + 1);
+        globalTrace.threads.push_back(buf);
+        return buf;
+    }();
+    return *threadBuf;
+}
+}
+
+
+inline
+void enableTracing(bool enable) { impl::globalTrace.enabled = enable; }
+
+
+inline
+TraceSpan::TraceSpan(const char* name, std::optional<int64_t> arg) : name_(name), arg_(arg)
+{
+    if (impl::globalTrace.enabled.load(std::memory_order_relaxed))
+        startTime_ = std::chrono::steady_clock::now();
+}
+
+
+inline
+TraceSpan::~TraceSpan()
+{
+    if (startTime_ != std::chrono::steady_clock::time_point())
+    {
+        using namespace std::chrono;
+        const steady_clock::time_point now = steady_clock::now();
+
+        impl::TraceThreadBuffer& buf = impl::getTraceThreadBuffer();
+        const impl::TraceEvent event
+        {
+            name_, arg_,
+            duration_cast<microseconds>(startTime_ - impl::globalTrace.startTime),
+            duration_cast<microseconds>(now - startTime_)
+        };
+
+        std::lock_guard dummy(buf.lockEvents);
+        if (buf.events.size() < impl::TRACE_EVENTS_PER_THREAD_MAX)
+            buf.events.push_back(event);
+        else
+        {
+            buf.events[buf.nextPos] = event;
+            buf.nextPos = (buf.nextPos + 1) % buf.events.size();
+        }
+    }
+}
+
+
+inline
+std::string getTraceJson()
+{
+    std::vector<std::shared_ptr<impl::TraceThreadBuffer>> threads;
+    {
+        std::lock_guard dummy(impl::globalTrace.lockThreads);
+        threads = impl::globalTrace.threads;
+    }
+
+    std::string output = "{\"traceEvents\":[";
+    bool firstEvent = true;
+
+    for (const std::shared_ptr<impl::TraceThreadBuffer>& buf : threads)
+    {
+        std::lock_guard dummy(buf->lockEvents);
+
+        for (const impl::TraceEvent& event : buf->events)
+        {
+            if (!firstEvent)
+                output += ',';
+            firstEvent = false;
+
+            output += "\n{\"name\":\"";
+            for (const char* it = event.name; *it != '\0'; ++it)
+                if (*it == '"' || *it == '\\')
+                    output += '_'; //names are string literals: don't bother escaping
+                else
+                    output += *it;
+
+            output += "\",\"ph\":\"X\",\"pid\":1,\"tid\":" + numberTo<std::string>(buf->threadId) +
+                      ",\"ts\":"  + numberTo<std::string>(event.begin   .count()) +
+                      ",\"dur\":" + numberTo<std::string>(event.duration.count());
+            if (event.arg)
+                output += ",\"args\":{\"arg\":" + numberTo<std::string>(*event.arg) + '}';
+            output += '}';
+        }
+    }
+    output += "\n]}\n";
+    return output;
+}
 }
 
 #endif //PERF_H_83947184145342652456
@@ -6,6 +6,9 @@
 
 #include "process_priority.h"
 #include "i18n.h"
+#include "thread.h"
+    #include <sys/syscall.h>
+    #include <unistd.h>
 
 
 using namespace zen;
@@ -52,3 +55,65 @@ private:
     const int oldIoPrio;
 };
 */
+
+
+void zen::setCurrentThreadIoPriority(IoPriority prio) //throw FileError
+{
+    //ioprio_set() is not wrapped by glibc and <linux/ioprio.h> is not always available (see above) => define what we need:
+    const int IOPRIO_CLASS_SHIFT = 13;
+    const int IOPRIO_CLASS_BE    = 2;
+    const int IOPRIO_CLASS_IDLE  = 3;
+    const int IOPRIO_WHO_PROCESS = 1; //with ID 0: calling *thread*
+
+    const int ioPrio = [&]
+    {
+        switch (prio)
+        {
+            case IoPriority::normal:
+                return 0; //IOPRIO_CLASS_NONE: derive from CPU nice value (= default)
+            case IoPriority::low:
+                return (IOPRIO_CLASS_BE << IOPRIO_CLASS_SHIFT) | 7;
+            case IoPriority::idle:
+                return IOPRIO_CLASS_IDLE << IOPRIO_CLASS_SHIFT;
+        }
+        throw std::logic_error("Contract violation! " + std::string(__FILE__) + ':' + numberTo<std::string>(__LINE__));
+    }();
+
+    if (::syscall(SYS_ioprio_set, IOPRIO_WHO_PROCESS, 0, ioPrio) != 0)
+        THROW_LAST_FILE_ERROR(_("Cannot change process I/O priorities."), "ioprio_set");
+}
+
+
+namespace
+{
+const std::chrono::milliseconds BANDWIDTH_BURST_MAX(500); //unused budget is capped: no catching up after idle periods
+}
+
+
+BandwidthLimiter::BandwidthLimiter(uint64_t bytesPerSec) : bytesPerSec_(static_cast<double>(bytesPerSec))
+{
+    assert(bytesPerSec > 0);
+}
+
+
+void BandwidthLimiter::consume(int64_t bytes) //throw ThreadStopRequest
+{
+    if (bytes <= 0)
+        return;
+
+    std::chrono::duration<double> delay{};
+    {
+        std::lock_guard dummy(lockBucket_);
+
+        const auto now = std::chrono::steady_clock::now();
+        budget_ = std::min(budget_ + std::chrono::duration<double>(now - lastRefill_).count() * bytesPerSec_,
+                           std::chrono::duration<double>(BANDWIDTH_BURST_MAX).count() * bytesPerSec_);
+        lastRefill_ = now;
+
+        budget_ -= bytes; //concurrent threads accumulate debt => all of them wait accordingly
+        if (budget_ < 0)
+            delay = std::chrono::duration<double>(-budget_ / bytesPerSec_);
+    }
+    if (delay.count() > 0)
+        interruptibleSleep(delay); //throw ThreadStopRequest
+}
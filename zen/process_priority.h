@@ -8,6 +8,8 @@
 #define PROCESS_PRIORITY_H_83421759082143245
 
 #include <memory>
+#include <mutex>
+#include <chrono>
 #include "file_error.h"
 
 
@@ -34,6 +36,36 @@ private:
     struct Impl;
     const std::unique_ptr<Impl> pimpl_;
 };
+
+
+enum class IoPriority
+{
+    normal,
+    low,  //best effort, lowest priority level
+    idle, //only when no other process needs the disk
+};
+//context of worker thread; Linux: affects reads and (direct) writes to local disks only
+void setCurrentThreadIoPriority(IoPriority prio); //throw FileError
+
+
+//token bucket: cap throughput of all threads sharing the limiter; thread-safe
+class BandwidthLimiter
+{
+public:
+    explicit BandwidthLimiter(uint64_t bytesPerSec);
+
+    //context of worker thread: block while over budget
+    void consume(int64_t bytes); //throw ThreadStopRequest
+
+private:
+    BandwidthLimiter           (const BandwidthLimiter&) = delete;
+    BandwidthLimiter& operator=(const BandwidthLimiter&) = delete;
+
+    const double bytesPerSec_;
+    std::mutex lockBucket_;
+    double budget_ = 0; //bytes; negative: debt to be paid by sleeping
+    std::chrono::steady_clock::time_point lastRefill_ = std::chrono::steady_clock::now();
+};
 }
 
 #endif //PROCESS_PRIORITY_H_83421759082143245
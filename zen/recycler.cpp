@@ -6,8 +6,14 @@
 
 #include "recycler.h"
 #include "file_access.h"
+#include "sys_info.h"
+#include "thread.h"
+#include "time.h"
 
+    #include <unordered_map>
     #include <sys/stat.h>
+    #include <fcntl.h>  //openat
+    #include <unistd.h> //getuid
     #include <gio/gio.h>
     #include "scope_guard.h"
 
@@ -117,6 +123,179 @@ bool zen::recycleOrDeleteIfExists(const Zstring& itemPath) //throw FileError
 //*INDENT-ON*
 
 
+namespace
+{
+struct TrashFolder
+{
+    ~TrashFolder()
+    {
+        if (filesFd != -1) ::close(filesFd);
+        if (infoFd  != -1) ::close(infoFd);
+    }
+
+    Zstring topDir; //empty for home trash: .trashinfo contains absolute path, otherwise path relative to topDir
+    int filesFd = -1;
+    int infoFd  = -1;
+};
+
+
+/*  find the trash folder g_file_trash() just moved "itemName" to: freedesktop.org Trash specification, same order as GIO
+    https://specifications.freedesktop.org/trash-spec/trashspec-latest.html
+    => nullptr if not found, e.g. GIO deleted permanently, or trash name was made unique => keep using g_file_trash()   */
+std::unique_ptr<TrashFolder> findTrashFolder(const Zstring& parentPath, dev_t deviceId, const Zstring& itemName) //noexcept
+{
+    std::vector<std::pair<Zstring /*trashPath*/, Zstring /*topDir*/>> candidates;
+
+    if (const char* xdgDataPath = ::getenv("XDG_DATA_HOME"); //no ownership transfer + no extended error reporting
+        xdgDataPath && xdgDataPath[0] != 0)
+        candidates.emplace_back(appendPath(xdgDataPath, Zstr("Trash")), Zstring());
+    else
+        try { candidates.emplace_back(appendPath(getUserHome(), Zstr(".local/share/Trash")), Zstring()); /*throw FileError*/ }
+        catch (FileError&) {}
+
+    Zstring topDir = parentPath; //mount point: topmost parent folder on the same device
+    for (;;)
+    {
+        const std::optional<Zstring> parentPath2 = getParentFolderPath(topDir);
+        struct stat parentInfo = {};
+        if (!parentPath2 || ::stat(parentPath2->c_str(), &parentInfo) != 0 || parentInfo.st_dev != deviceId)
+            break;
+        topDir = *parentPath2;
+    }
+    const Zstring userId = numberTo<Zstring>(::getuid());
+
+    if (struct stat trashInfo = {};
+        ::lstat(appendPath(topDir, Zstr(".Trash")).c_str(), &trashInfo) == 0 && S_ISDIR(trashInfo.st_mode) && (trashInfo.st_mode & S_ISVTX))
+        candidates.emplace_back(appendPath(appendPath(topDir, Zstr(".Trash")), userId), topDir);
+
+    candidates.emplace_back(appendPath(topDir, Zstr(".Trash-") + userId), topDir);
+
+    for (const auto& [trashPath, trashTopDir] : candidates)
+        if (struct stat infoFileInfo = {};
+            ::lstat(appendPath(trashPath, Zstr("info/") + itemName + Zstr(".trashinfo")).c_str(), &infoFileInfo) == 0 && infoFileInfo.st_dev == deviceId)
+        {
+            auto trashFolder = std::make_unique<TrashFolder>();
+            trashFolder->topDir  = trashTopDir;
+            trashFolder->filesFd = ::open(appendPath(trashPath, Zstr("files")).c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+            trashFolder->infoFd  = ::open(appendPath(trashPath, Zstr("info" )).c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+            if (trashFolder->filesFd == -1 || trashFolder->infoFd == -1)
+                return nullptr;
+            return trashFolder;
+        }
+    return nullptr;
+}
+}
+
+
+struct TrashSession::Impl
+{
+    Protected<std::unordered_map<dev_t, std::unique_ptr<TrashFolder>>> trashFolders; //nullptr: use g_file_trash()
+};
+
+
+TrashSession::TrashSession() : pimpl_(std::make_unique<Impl>()) {}
+TrashSession::~TrashSession() {}
+
+
+bool TrashSession::recycleOrDeleteIfExists(const Zstring& itemPath) //throw FileError
+{
+    const std::optional<Zstring> parentPath = getParentFolderPath(itemPath);
+    struct stat itemInfo = {};
+
+    if (::getuid() == 0 || //root: GIO's idea of "home trash" might differ => don't guess
+        !parentPath ||
+        ::lstat(itemPath.c_str(), &itemInfo) != 0) //not existing or access error => let g_file_trash() decide
+        return zen::recycleOrDeleteIfExists(itemPath); //throw FileError
+
+    const Zstring itemName = afterLast(itemPath, FILE_NAME_SEPARATOR, IfNotFoundReturn::all);
+
+    //first item per device: let GIO decide if trash is available + create trash folder
+    std::optional<bool> firstItemDeleted;
+    const TrashFolder* trashFolder = nullptr;
+
+    pimpl_->trashFolders.access([&](auto& trashFolders)
+    {
+        const auto [it, inserted] = trashFolders.try_emplace(itemInfo.st_dev);
+        if (inserted)
+        {
+            ZEN_ON_SCOPE_FAIL(trashFolders.erase(it)); //retry with next item
+            firstItemDeleted = zen::recycleOrDeleteIfExists(itemPath); //throw FileError
+            it->second = findTrashFolder(*parentPath, itemInfo.st_dev, itemName); //noexcept
+        }
+        trashFolder = it->second.get(); //pointer stays valid: items are never removed
+    });
+
+    if (firstItemDeleted)
+        return *firstItemDeleted;
+
+    if (!trashFolder)
+        return zen::recycleOrDeleteIfExists(itemPath); //throw FileError
+    //---------------------------------------------------------------------------------------
+
+    const std::wstring errorMsg = replaceCpy(_("Unable to move %x to the recycle bin."), L"%x", fmtPath(itemPath));
+
+    std::string trashInfo;
+    {
+        const Zstring& origPath = trashFolder->topDir.empty() ? itemPath : //home trash: absolute path
+                                  afterFirst(itemPath, appendSeparator(trashFolder->topDir), IfNotFoundReturn::all);
+
+        gchar* origPathEsc = ::g_uri_escape_string(origPath.c_str(), "/", false /*allow_utf8*/);
+        ZEN_ON_SCOPE_EXIT(::g_free(origPathEsc));
+
+        trashInfo = std::string("[Trash Info]\nPath=") + origPathEsc +
+                    "\nDeletionDate=" + utfTo<std::string>(formatTime(Zstr("%Y-%m-%dT%H:%M:%S"))) + '\n';
+    }
+
+    for (int i = 1;; ++i) //same naming scheme as GIO: "name", "name.2", "name.3", ...
+    {
+        const Zstring trashName = i == 1 ? itemName : itemName + Zstr('.') + numberTo<Zstring>(i);
+        const Zstring infoName  = trashName + Zstr(".trashinfo");
+
+        //reserve trash name by exclusively creating the .trashinfo file
+        const int fdInfo = ::openat(trashFolder->infoFd, infoName.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+        if (fdInfo == -1)
+        {
+            if (errno == EEXIST)
+                continue;
+            THROW_LAST_FILE_ERROR(errorMsg, "openat(" + utfTo<std::string>(infoName) + ')');
+        }
+        auto guardInfoFile = makeGuard<ScopeGuardRunMode::onExit>([&] { ::unlinkat(trashFolder->infoFd, infoName.c_str(), 0); });
+        {
+            ZEN_ON_SCOPE_EXIT(::close(fdInfo));
+
+            for (size_t bytesWritten = 0; bytesWritten < trashInfo.size();)
+            {
+                const ssize_t bytesDelta = ::write(fdInfo, trashInfo.c_str() + bytesWritten, trashInfo.size() - bytesWritten);
+                if (bytesDelta <= 0)
+                {
+                    if (bytesDelta < 0 && errno == EINTR)
+                        continue;
+                    THROW_LAST_FILE_ERROR(errorMsg, "write(" + utfTo<std::string>(infoName) + ')');
+                }
+                bytesWritten += bytesDelta;
+            }
+        }
+
+        //renameat() silently replaces existing files (and empty folders): orphaned trash item without .trashinfo?
+        if (struct stat trashItemInfo = {};
+            ::fstatat(trashFolder->filesFd, trashName.c_str(), &trashItemInfo, AT_SYMLINK_NOFOLLOW) == 0)
+            continue;
+
+        if (::renameat(AT_FDCWD, itemPath.c_str(), trashFolder->filesFd, trashName.c_str()) != 0)
+        {
+            if (errno == ENOENT) //item not existing (anymore)
+                return false;
+            if (errno == EXDEV) //e.g. bind mount on the same device
+                return zen::recycleOrDeleteIfExists(itemPath); //throw FileError
+
+            THROW_LAST_FILE_ERROR(errorMsg, "renameat");
+        }
+        guardInfoFile.dismiss();
+        return true;
+    }
+}
+
+
 /* We really need access to a similar function to check whether a directory supports trashing and emit a warning if it does not!
 
    The following function looks perfect, alas it is restricted to local files and to the implementation of GIO only:
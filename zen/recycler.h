@@ -8,6 +8,7 @@
 #define RECYCLER_H_18345067341545
 
 #include <vector>
+#include <memory>
 #include <functional>
 #include "file_error.h"
 
@@ -35,6 +36,26 @@ namespace zen
 bool recycleOrDeleteIfExists(const Zstring& itemPath); //throw FileError, return "true" if file/dir was actually deleted
 
 
+/*  move many items to the recycle bin efficiently: g_file_trash() is slow, e.g. looks up the mount table for each single item
+    Linux: - first item per device is trashed via recycleOrDeleteIfExists() => GIO decides if trash is supported and creates the trash folder
+           - remaining items: move directly into that trash folder + write .trashinfo (freedesktop.org Trash specification)
+    - multi-threaded access: internally synchronized!                                                                          */
+class TrashSession
+{
+public:
+    TrashSession();
+    ~TrashSession();
+
+    bool recycleOrDeleteIfExists(const Zstring& itemPath); //throw FileError, return "true" if file/dir was actually deleted
+
+private:
+    TrashSession           (const TrashSession&) = delete;
+    TrashSession& operator=(const TrashSession&) = delete;
+
+    struct Impl;
+    const std::unique_ptr<Impl> pimpl_;
+};
+
 }
 
 #endif //RECYCLER_H_18345067341545
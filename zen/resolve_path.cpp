@@ -99,7 +99,7 @@ Zstring resolveRelativePath(const Zstring& relativePath)
 
 
 //returns value if resolved
-std::optional<Zstring> tryResolveMacro(const Zstring& macro) //macro without %-characters
+std::optional<Zstring> tryResolveMacro(const Zstring& macro, bool& timeDependent) //macro without %-characters
 {
     Zstring timeStr;
     auto resolveTimePhrase = [&](const Zchar* phrase, const Zchar* format) -> bool
@@ -108,6 +108,7 @@ std::optional<Zstring> tryResolveMacro(const Zstring& macro) //macro without %-c
             return false;
 
         timeStr = formatTime(format);
+        timeDependent = true;
         return true;
     };
 
@@ -128,6 +129,7 @@ std::optional<Zstring> tryResolveMacro(const Zstring& macro) //macro without %-c
 
     if (equalAsciiNoCase(macro, Zstr("WeekDay")))
     {
+        timeDependent = true;
         const int weekDayStartSunday = stringTo<int>(formatTime(Zstr("%w"))); //[0 (Sunday), 6 (Saturday)] => not localized!
         //alternative 1: use "%u": ISO 8601 weekday as number with Monday as 1 (1-7) => newer standard than %w
         //alternative 2: ::mktime() + std::tm::tm_wday
@@ -149,11 +151,10 @@ std::optional<Zstring> tryResolveMacro(const Zstring& macro) //macro without %-c
 }
 
 const Zchar MACRO_SEP = Zstr('%');
-}
 
 
 //returns expanded or original string
-Zstring zen::expandMacros(const Zstring& text)
+Zstring expandMacrosImpl(const Zstring& text, bool& timeDependent)
 {
     if (contains(text, MACRO_SEP))
     {
@@ -164,16 +165,71 @@ Zstring zen::expandMacros(const Zstring& text)
             Zstring potentialMacro = beforeFirst(rest, MACRO_SEP, IfNotFoundReturn::none);
             Zstring postfix        = afterFirst (rest, MACRO_SEP, IfNotFoundReturn::none); //text == prefix + MACRO_SEP + potentialMacro + MACRO_SEP + postfix
 
-            if (std::optional<Zstring> value = tryResolveMacro(potentialMacro))
-                return prefix + *value + expandMacros(postfix);
+            if (std::optional<Zstring> value = tryResolveMacro(potentialMacro, timeDependent))
+                return prefix + *value + expandMacrosImpl(postfix, timeDependent);
             else
-                return prefix + MACRO_SEP + potentialMacro + expandMacros(MACRO_SEP + postfix);
+                return prefix + MACRO_SEP + potentialMacro + expandMacrosImpl(MACRO_SEP + postfix, timeDependent);
         }
     }
     return text;
 }
 
 
+/*  path phrases are resolved over and over: each folder pair/versioning/log path on every config grid refresh, while typing, during startup
+    => memoize: resolution depends only on environment variables, user home and current directory, none of which change during runtime
+       except for time macros: %Date%, %Time%, ... => never cached                                                                        */
+class ResolvedPathCache
+{
+public:
+    std::optional<Zstring> get(const Zstring& pathPhrase)
+    {
+        return cache_.access([&](const Cache& cache) -> std::optional<Zstring>
+        {
+            if (auto it = cache.find(pathPhrase);
+                it != cache.end())
+                return it->second;
+            return {};
+        });
+    }
+
+    void set(const Zstring& pathPhrase, const Zstring& resolvedPath)
+    {
+        cache_.access([&](Cache& cache)
+        {
+            if (cache.size() >= CACHE_SIZE_MAX) //e.g. phrases while typing: no need for LRU, just start over
+                cache.clear();
+            cache.insert_or_assign(pathPhrase, resolvedPath);
+        });
+    }
+
+private:
+    static constexpr size_t CACHE_SIZE_MAX = 1000;
+
+    using Cache = std::unordered_map<Zstring /*path phrase*/, Zstring /*resolved*/>;
+    Protected<Cache> cache_;
+};
+
+ResolvedPathCache& getMacroCache()        { static ResolvedPathCache inst; return inst; }
+ResolvedPathCache& getResolvedPathCache() { static ResolvedPathCache inst; return inst; }
+}
+
+
+Zstring zen::expandMacros(const Zstring& text)
+{
+    if (!contains(text, MACRO_SEP)) //most common case: no need to touch the cache
+        return text;
+
+    if (std::optional<Zstring> expanded = getMacroCache().get(text))
+        return *expanded;
+
+    bool timeDependent = false;
+    Zstring expanded = expandMacrosImpl(text, timeDependent);
+    if (!timeDependent)
+        getMacroCache().set(text, expanded);
+    return expanded;
+}
+
+
 namespace
 {
 
@@ -235,9 +291,11 @@ Zstring zen::makePathPhrase(const Zstring& itemPath)
 //coordinate changes with acceptsFolderPathPhraseNative()!
 Zstring zen::getResolvedFilePath(const Zstring& pathPhrase) //noexcept
 {
-    Zstring path = pathPhrase;
+    if (std::optional<Zstring> resolvedPath = getResolvedPathCache().get(pathPhrase))
+        return *resolvedPath;
 
-    path = expandMacros(path); //expand before trimming!
+    bool timeDependent = false;
+    Zstring path = expandMacrosImpl(pathPhrase, timeDependent); //expand before trimming!
 
     trim(path); //remove leading/trailing whitespace before allowing misinterpretation in applyLongPathPrefix()
 
@@ -258,6 +316,8 @@ Zstring zen::getResolvedFilePath(const Zstring& pathPhrase) //noexcept
     if (const std::optional<PathComponents> pc = parsePathComponents(path))
         path = appendPath(pc->rootPath, pc->relPath);
 
+    if (!timeDependent)
+        getResolvedPathCache().set(pathPhrase, path);
     return path;
 }
 
@@ -62,6 +62,8 @@ bufferedLoad(BufferedInputStream& streamIn); //throw X
 template <class N, class BufferedOutputStream> void writeNumber   (BufferedOutputStream& stream, const N& num);                   //
 template <class C, class BufferedOutputStream> void writeContainer(BufferedOutputStream& stream, const C& str);                   //noexcept
 template <         class BufferedOutputStream> void writeArray    (BufferedOutputStream& stream, const void* buffer, size_t len); //
+//variable-length integer (LEB128): 1 byte for values < 128; signed types are zigzag-encoded => small negative numbers stay short, too
+template <class N, class BufferedOutputStream> void writeVarInt   (BufferedOutputStream& stream, N num);                          //
 //----------------------------------------------------------------------
 struct SysErrorUnexpectedEos : public SysError
 {
@@ -71,6 +73,7 @@ struct SysErrorUnexpectedEos : public SysError
 template <class N, class BufferedInputStream> N    readNumber   (BufferedInputStream& stream); //throw SysErrorUnexpectedEos (corrupted data)
 template <class C, class BufferedInputStream> C    readContainer(BufferedInputStream& stream); //
 template <         class BufferedInputStream> void readArray    (BufferedInputStream& stream, void* buffer, size_t len); //
+template <class N, class BufferedInputStream> N    readVarInt   (BufferedInputStream& stream); //
 
 
 struct IOCallbackDivider
@@ -93,7 +96,8 @@ private:
 template <class BinContainer>
 struct MemoryStreamIn
 {
-    explicit MemoryStreamIn(const BinContainer& cont) : buffer_(cont) {} //this better be cheap!
+    explicit MemoryStreamIn(const BinContainer& cont) : buffer_(cont) {} //this better be cheap! e.g. use std::string_view
+    explicit MemoryStreamIn(BinContainer&& cont) : buffer_(std::move(cont)) {} //take ownership without copy
 
     size_t read(void* buffer, size_t bytesToRead) //return "bytesToRead" bytes unless end of stream!
     {
@@ -156,6 +160,7 @@ void bufferedStreamCopy(BufferedInputStream& streamIn,   //throw X
     if (blockSize == 0)
         throw std::logic_error("Contract violation! " + std::string(__FILE__) + ':' + numberTo<std::string>(__LINE__));
 
+    //full blocks bypass the internal buffers of FileInput/FileOutput (and SFTP streams): read() syscall -> buffer -> write() syscall
     std::vector<std::byte> buffer(blockSize);
     for (;;)
     {
@@ -211,6 +216,33 @@ void writeNumber(BufferedOutputStream& stream, const N& num)
 }
 
 
+template <class N, class BufferedOutputStream> inline
+void writeVarInt(BufferedOutputStream& stream, N num)
+{
+    static_assert(isInteger<N>);
+    using UN = std::make_unsigned_t<N>;
+
+    UN val = static_cast<UN>(num);
+    if constexpr (std::is_signed_v<N>)
+        val = static_cast<UN>(val << 1) ^ static_cast<UN>(num < 0 ? ~UN(0) : 0); //zigzag: 0, -1, 1, -2, 2, ... => 0, 1, 2, 3, 4, ...
+
+    unsigned char buf[(sizeof(N) * 8 + 6) / 7] = {};
+    size_t len = 0;
+    for (;;)
+    {
+        const auto b = static_cast<unsigned char>(val & 0x7f);
+        val >>= 7;
+        if (val == 0)
+        {
+            buf[len++] = b;
+            break;
+        }
+        buf[len++] = b | 0x80;
+    }
+    writeArray(stream, buf, len);
+}
+
+
 template <class C, class BufferedOutputStream> inline
 void writeContainer(BufferedOutputStream& stream, const C& cont) //don't even consider UTF8 conversions here, we're handling arbitrary binary data!
 {
@@ -241,6 +273,31 @@ N readNumber(BufferedInputStream& stream) //throw SysErrorUnexpectedEos
 }
 
 
+template <class N, class BufferedInputStream> inline
+N readVarInt(BufferedInputStream& stream) //throw SysErrorUnexpectedEos
+{
+    static_assert(isInteger<N>);
+    using UN = std::make_unsigned_t<N>;
+
+    UN val = 0;
+    for (int shift = 0;; shift += 7)
+    {
+        if (shift >= static_cast<int>(sizeof(N) * 8))
+            throw SysErrorUnexpectedEos(); //too many continuation bytes: most likely this is due to data corruption!
+
+        const auto b = readNumber<unsigned char>(stream); //throw SysErrorUnexpectedEos
+        val |= static_cast<UN>(static_cast<UN>(b & 0x7f) << shift);
+        if ((b & 0x80) == 0)
+            break;
+    }
+
+    if constexpr (std::is_signed_v<N>)
+        return static_cast<N>((val >> 1) ^ (UN(0) - (val & 1)));
+    else
+        return val;
+}
+
+
 template <class C, class BufferedInputStream> inline
 C readContainer(BufferedInputStream& stream) //throw SysErrorUnexpectedEos
 {
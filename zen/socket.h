@@ -7,8 +7,12 @@
 #ifndef SOCKET_H_23498325972583947678456437
 #define SOCKET_H_23498325972583947678456437
 
+#include <unordered_map>
 #include "sys_error.h"
+#include "thread.h"
     #include <unistd.h> //close
+    #include <fcntl.h>  //fcntl
+    #include <poll.h>   //poll
     #include <sys/socket.h>
     #include <netdb.h> //getaddrinfo
 
@@ -46,31 +50,80 @@ public:
         if (!servinfo)
             throw SysError(formatSystemError("getaddrinfo", L"", L"Empty server info."));
 
-        const auto getConnectedSocket = [](const auto& /*::addrinfo*/ ai)
-        {
-            SocketType testSocket = ::socket(ai.ai_family,    //int socket_family
-                                             SOCK_CLOEXEC |
-                                             ai.ai_socktype,  //int socket_type
-                                             ai.ai_protocol); //int protocol
-            if (testSocket == invalidSocket)
-                THROW_LAST_SYS_ERROR_WSA("socket");
-            ZEN_ON_SCOPE_FAIL(closeSocket(testSocket));
-
+        //RFC 8305 "happy eyeballs": start the next connection attempt after a short delay instead of waiting for the previous one to fail
+        //=> hosts with broken IPv6 routes don't add a full connect timeout to each new session
+        std::vector<const ::addrinfo*> addresses;
+        for (const auto* /*::addrinfo*/ si = servinfo; si; si = si->ai_next)
+            addresses.push_back(si);
 
-            if (::connect(testSocket, ai.ai_addr, static_cast<int>(ai.ai_addrlen)) != 0)
-                THROW_LAST_SYS_ERROR_WSA("connect");
+        const std::optional<int> preferredFamily = getPreferredAddressFamily(server);
+        addresses = interleaveAddressFamilies(addresses, preferredFamily ? *preferredFamily : addresses[0]->ai_family);
 
-            return testSocket;
+        struct Attempt
+        {
+            SocketType socket;
+            int family;
         };
+        std::vector<Attempt> pending;
+        ZEN_ON_SCOPE_EXIT(for (const Attempt& a : pending) closeSocket(a.socket));
 
         std::optional<SysError> firstError;
-        for (const auto* /*::addrinfo*/ si = servinfo; si; si = si->ai_next)
-            try
+        size_t nextIdx = 0;
+        auto startNextAttempt = [&]
+        {
+            while (nextIdx < addresses.size())
+                try
+                {
+                    const ::addrinfo& ai = *addresses[nextIdx++];
+                    pending.push_back({startConnect(ai), ai.ai_family}); //throw SysError
+                    return;
+                }
+                catch (const SysError& e) { if (!firstError) firstError = e; }
+        };
+
+        startNextAttempt();
+        auto nextAttemptTime = std::chrono::steady_clock::now() + CONNECTION_ATTEMPT_DELAY;
+
+        while (!pending.empty())
+        {
+            std::vector<::pollfd> fds;
+            for (const Attempt& a : pending)
+                fds.push_back({.fd = a.socket, .events = POLLOUT});
+
+            int timeoutMs = -1; //no more addresses to try: wait for pending attempts only
+            if (nextIdx < addresses.size())
+                timeoutMs = static_cast<int>(std::max<int64_t>(std::chrono::ceil<std::chrono::milliseconds>(nextAttemptTime - std::chrono::steady_clock::now()).count(), 0));
+
+            if (::poll(fds.data(), fds.size(), timeoutMs) < 0 && errno != EINTR)
+                THROW_LAST_SYS_ERROR_WSA("poll");
+
+            bool attemptFailed = false;
+            for (size_t i = fds.size(); i-- > 0;)
+                if (fds[i].revents != 0) //POLLOUT, POLLERR or POLLHUP: connect() finished
+                {
+                    const Attempt attempt = pending[i];
+                    pending.erase(pending.begin() + i);
+                    try
+                    {
+                        finishConnect(attempt.socket); //throw SysError
+                        setPreferredAddressFamily(server, attempt.family);
+                        socket_ = attempt.socket; //pass ownership
+                        return;
+                    }
+                    catch (const SysError& e)
+                    {
+                        closeSocket(attempt.socket);
+                        if (!firstError) firstError = e;
+                        attemptFailed = true;
+                    }
+                }
+
+            if (attemptFailed || std::chrono::steady_clock::now() >= nextAttemptTime) //don't wait for the delay after a failure
             {
-                socket_ = getConnectedSocket(*si); //throw SysError; pass ownership
-                return;
+                startNextAttempt();
+                nextAttemptTime = std::chrono::steady_clock::now() + CONNECTION_ATTEMPT_DELAY;
             }
-            catch (const SysError& e) { if (!firstError) firstError = e; }
+        }
 
         throw* firstError; //list was not empty, so there must have been an error!
     }
@@ -83,6 +136,79 @@ private:
     Socket           (const Socket&) = delete;
     Socket& operator=(const Socket&) = delete;
 
+    static constexpr std::chrono::milliseconds CONNECTION_ATTEMPT_DELAY{250}; //RFC 8305: recommended value
+
+    static SocketType startConnect(const ::addrinfo& ai) //throw SysError
+    {
+        SocketType testSocket = ::socket(ai.ai_family,    //int socket_family
+                                         SOCK_CLOEXEC | SOCK_NONBLOCK |
+                                         ai.ai_socktype,  //int socket_type
+                                         ai.ai_protocol); //int protocol
+        if (testSocket == invalidSocket)
+            THROW_LAST_SYS_ERROR_WSA("socket");
+        ZEN_ON_SCOPE_FAIL(closeSocket(testSocket));
+
+        if (::connect(testSocket, ai.ai_addr, static_cast<int>(ai.ai_addrlen)) != 0 && errno != EINPROGRESS)
+            THROW_LAST_SYS_ERROR_WSA("connect");
+
+        return testSocket;
+    }
+
+    static void finishConnect(SocketType testSocket) //throw SysError
+    {
+        int error = 0;
+        socklen_t errorLen = sizeof(error);
+        if (::getsockopt(testSocket, SOL_SOCKET, SO_ERROR, &error, &errorLen) != 0)
+            THROW_LAST_SYS_ERROR_WSA("getsockopt(SO_ERROR)");
+        if (error != 0)
+            throw SysError(formatSystemError("connect", error));
+
+        //callers expect a blocking socket
+        const int flags = ::fcntl(testSocket, F_GETFL);
+        if (flags == -1 || ::fcntl(testSocket, F_SETFL, flags & ~O_NONBLOCK) != 0)
+            THROW_LAST_SYS_ERROR_WSA("fcntl(O_NONBLOCK)");
+    }
+
+    //RFC 8305, 4: alternate address families, starting with the preferred one
+    static std::vector<const ::addrinfo*> interleaveAddressFamilies(const std::vector<const ::addrinfo*>& addresses, int firstFamily)
+    {
+        std::vector<const ::addrinfo*> first;
+        std::vector<const ::addrinfo*> other;
+        for (const ::addrinfo* ai : addresses)
+            (ai->ai_family == firstFamily ? first : other).push_back(ai);
+
+        std::vector<const ::addrinfo*> output;
+        for (size_t i = 0; i < std::max(first.size(), other.size()); ++i)
+        {
+            if (i < first.size()) output.push_back(first[i]);
+            if (i < other.size()) output.push_back(other[i]);
+        }
+        return output;
+    }
+
+    //address family of the last successful connection per host: for the process lifetime
+    using PreferredFamilies = std::unordered_map<Zstring, int>;
+    static Protected<PreferredFamilies>& refPreferredFamilies()
+    {
+        static Protected<PreferredFamilies> families; //static: no lifetime issues, accessed by worker threads only
+        return families;
+    }
+
+    static std::optional<int> getPreferredAddressFamily(const Zstring& server)
+    {
+        return refPreferredFamilies().access([&](const PreferredFamilies& families) -> std::optional<int>
+        {
+            if (const auto it = families.find(server); it != families.end())
+                return it->second;
+            return std::nullopt;
+        });
+    }
+
+    static void setPreferredAddressFamily(const Zstring& server, int family)
+    {
+        refPreferredFamilies().access([&](PreferredFamilies& families) { families[server] = family; });
+    }
+
     SocketType socket_ = invalidSocket;
 };
 
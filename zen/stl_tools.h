@@ -298,16 +298,16 @@ template <class Num>
 class FNV1aHash //FNV-1a: https://en.wikipedia.org/wiki/Fowler%E2%80%93Noll%E2%80%93Vo_hash_function
 {
 public:
-    FNV1aHash() {}
-    explicit FNV1aHash(Num startVal) : hashVal_(startVal) {}
+    constexpr FNV1aHash() {}
+    constexpr explicit FNV1aHash(Num startVal) : hashVal_(startVal) {}
 
-    void add(Num n)
+    constexpr void add(Num n)
     {
         hashVal_ ^= n;
         hashVal_ *= prime_;
     }
 
-    Num get() const { return hashVal_; }
+    constexpr Num get() const { return hashVal_; }
 
 private:
     static_assert(isUnsignedInt<Num>);
@@ -85,6 +85,13 @@ template <class S, class T, class U>            void replace   (S& str, const T&
 template <class S, class T, class U> [[nodiscard]] S replaceCpyAsciiNoCase(S  str, const T& oldTerm, const U& newTerm);
 template <class S, class T, class U>            void replaceAsciiNoCase   (S& str, const T& oldTerm, const U& newTerm);
 
+//replace multiple placeholders in a single pass, e.g. formatMessage(_("Moving %x to %y"), {{L"%x", fmtPath(from)}, {L"%y", fmtPath(to)}})
+//=> one allocation instead of one per chained replaceCpy(); replacement text is never searched for placeholders
+template <class S> using FormatArgs = std::initializer_list<std::pair<std::basic_string_view<GetCharTypeT<S>> /*placeholder*/,
+                                                                      std::basic_string_view<GetCharTypeT<S>> /*replacement*/>>;
+template <class S> [[nodiscard]] S formatMessage(const S& format, FormatArgs<S> args);
+template <class S> void formatMessageTo(S& output, const S& format, FormatArgs<S> args); //reuses output's capacity, e.g. of a thread_local buffer
+
 //high-performance conversion between numbers and strings
 template <class S,   class Num> S   numberTo(const Num& number);
 template <class Num, class S>   Num stringTo(const S&   str);
@@ -530,6 +537,65 @@ S replaceCpyAsciiNoCase(S str, const T& oldTerm, const U& newTerm)
 }
 
 
+template <class S> inline
+void formatMessageTo(S& output, const S& format, FormatArgs<S> args)
+{
+    using Char = GetCharTypeT<S>;
+    const Char*       it     = strBegin(format);
+    const Char* const fmtEnd = it + strLength(format);
+
+    //first argument whose placeholder starts at "pos", or nullptr
+    auto matchArg = [&](const Char* pos) -> const typename FormatArgs<S>::value_type*
+    {
+        for (const auto& arg : args)
+            if (!arg.first.empty() && static_cast<size_t>(fmtEnd - pos) >= arg.first.size() &&
+                *pos == arg.first[0] && impl::equalSubstring(pos, arg.first.data(), arg.first.size()))
+                return &arg;
+        return nullptr;
+    };
+
+    //pass 1: determine final size
+    size_t outputLen = 0;
+    for (const Char* pos = it; pos != fmtEnd;)
+        if (const auto* arg = matchArg(pos))
+        {
+            outputLen += arg->second.size();
+            pos       += arg->first .size();
+        }
+        else
+        {
+            ++outputLen;
+            ++pos;
+        }
+
+    //pass 2: copy
+    output.clear();
+    output.reserve(outputLen);
+
+    for (const Char* pos = it; pos != fmtEnd;)
+        if (const auto* arg = matchArg(pos))
+        {
+            impl::stringAppend(output, it, pos);
+            impl::stringAppend(output, arg->second.data(), arg->second.data() + arg->second.size());
+            it = pos += arg->first.size();
+        }
+        else
+            ++pos;
+
+    impl::stringAppend(output, it, fmtEnd);
+    assert(strLength(output) == outputLen);
+}
+
+
+template <class S> inline
+S formatMessage(const S& format, FormatArgs<S> args)
+{
+    S output;
+    formatMessageTo(output, format, args);
+    return output;
+}
+
+
 template <class Char, class Function> inline
 std::pair<Char*, Char*> trimCpy(Char* first, Char* last, bool fromLeft, bool fromRight, Function trimThisChar)
 {
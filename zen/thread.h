@@ -9,6 +9,7 @@
 
 #include <thread>
 #include <future>
+#include <shared_mutex>
 #include "ring_buffer.h"
 #include "zstring.h"
 
@@ -93,6 +94,10 @@ bool waitForAllTimed(InputIterator first, InputIterator last, const Duration& wa
 
 template<typename T> inline
 bool isReady(const std::future<T>& f) { assert(f.valid()); return f.wait_for(std::chrono::seconds(0)) == std::future_status::ready; }
+
+//run fun(0), ..., fun(itemCount - 1): one thread per item, first item on the current thread => CPU-bound work on a handful of independent items
+template <class Function>
+void runParallel(size_t itemCount, Function fun);
 //------------------------------------------------------------------------------------------
 
 //wait until first job is successful or all failed
@@ -145,6 +150,36 @@ private:
     T value_{};
 };
 
+
+//reader-writer variant: concurrent read-only access, exclusive access for changes
+template <class T>
+class ProtectedShared
+{
+public:
+    ProtectedShared() {}
+
+    template <class Function>
+    auto access(Function fun) //-> decltype(fun(std::declval<T&>()))
+    {
+        std::lock_guard dummy(lockValue_);
+        return fun(value_);
+    }
+
+    template <class Function>
+    auto accessShared(Function fun) const //-> decltype(fun(std::declval<const T&>()))
+    {
+        std::shared_lock dummy(lockValue_);
+        return fun(value_);
+    }
+
+private:
+    ProtectedShared           (const ProtectedShared&) = delete;
+    ProtectedShared& operator=(const ProtectedShared&) = delete;
+
+    mutable std::shared_mutex lockValue_;
+    T value_{};
+};
+
 //------------------------------------------------------------------------------------------
 
 template <class Function>
@@ -170,6 +205,7 @@ public:
     //context of controlling OR worker thread, non-blocking:
     void run(Function&& wi /*should throw ThreadStopRequest when needed*/, bool insertFront = false)
     {
+        bool wakeWorker = false;
         {
             std::lock_guard dummy(workLoad_.ref().lock);
 
@@ -181,8 +217,12 @@ public:
 
             if (worker_.size() < std::min(tasksPending, threadCountMax_))
                 addWorkerThread();
+
+            wakeWorker = workLoad_.ref().workersIdle > 0; //busy workers pick up the task without notification
         }
-        workLoad_.ref().conditionNewTask.notify_all();
+        //one task => one worker: notify_all() would wake *all* idle workers just for them to go back to sleep
+        if (wakeWorker)
+            workLoad_.ref().conditionNewTask.notify_one();
     }
 
     //context of controlling thread, blocking:
@@ -228,7 +268,12 @@ private:
             std::unique_lock dummy(workLoad.lock);
             for (;;)
             {
-                interruptibleWait(workLoad.conditionNewTask, dummy, [&tasks = workLoad.tasks] { return !tasks.empty(); }); //throw ThreadStopRequest
+                if (workLoad.tasks.empty())
+                {
+                    ++workLoad.workersIdle;
+                    interruptibleWait(workLoad.conditionNewTask, dummy, [&tasks = workLoad.tasks] { return !tasks.empty(); }); //throw ThreadStopRequest
+                    --workLoad.workersIdle;
+                }
 
                 Function task = std::move(workLoad.tasks.    front()); //noexcept thanks to move
                 /**/                      workLoad.tasks.pop_front();  //
@@ -257,6 +302,7 @@ private:
         std::mutex lock;
         RingBuffer<Function> tasks; //FIFO! :)
         size_t tasksPending = 0;
+        size_t workersIdle = 0; //waiting for conditionNewTask
         std::condition_variable conditionNewTask;
         std::vector<std::function<void()>> onCompletionCallbacks;
     };
@@ -309,6 +355,26 @@ auto runAsync(Function&& fun)
 }
 
 
+template <class Function> inline
+void runParallel(size_t itemCount, Function fun)
+{
+    std::vector<std::future<void>> futures;
+
+    for (size_t pos = 1; pos < itemCount; ++pos)
+        try
+        {
+            futures.push_back(runAsync([&fun, pos] { fun(pos); }));
+        }
+        catch (const std::system_error&) { fun(pos); } //failed to create thread: no big deal
+
+    if (itemCount > 0)
+        fun(0);
+
+    for (std::future<void>& ft : futures)
+        ft.get();
+}
+
+
 template <class InputIterator, class Duration> inline
 bool waitForAllTimed(InputIterator first, InputIterator last, const Duration& duration)
 {
@@ -363,12 +363,30 @@ TargetString utfTo(const SourceString& str, std::false_type)
     using CharTrg = GetCharTypeT<TargetString>;
     static_assert(sizeof(CharSrc) != sizeof(CharTrg));
 
+    const CharSrc*       it    = strBegin(str);
+    const CharSrc* const itEnd = it + strLength(str);
+
     TargetString output;
+    if (it != itEnd)
+        output.reserve(itEnd - it); //exact for ASCII-only strings (i.e. most file paths)
 
-    UtfDecoder<CharSrc> decoder(strBegin(str), strLength(str));
-    while (const std::optional<CodePoint> cp = decoder.getNext())
-        codePointToUtf<CharTrg>(*cp, [&](CharTrg c) { output += c; });
+    auto isAscii = [](CharSrc c) { return isAsciiChar(c); };
+
+    while (it != itEnd)
+    {
+        //fast path: ASCII runs are identical in UTF-8/16/32 => no decoding needed
+        for (; it != itEnd && isAscii(*it); ++it)
+            output += static_cast<CharTrg>(*it);
 
+        //ASCII code units are never part of a multi-unit sequence => decode non-ASCII run separately
+        const CharSrc* const itRunEnd = std::find_if(it, itEnd, isAscii);
+
+        UtfDecoder<CharSrc> decoder(it, itRunEnd - it);
+        while (const std::optional<CodePoint> cp = decoder.getNext())
+            codePointToUtf<CharTrg>(*cp, [&](CharTrg c) { output += c; });
+
+        it = itRunEnd;
+    }
     return output;
 }
 
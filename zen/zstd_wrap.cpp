@@ -0,0 +1,115 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#include "zstd_wrap.h"
+#include <zstd.h> //https://facebook.github.io/zstd/zstd_manual.html
+#include "scope_guard.h"
+
+using namespace zen;
+
+
+size_t zen::impl::zstd_compressBound(size_t len)
+{
+    return ::ZSTD_compressBound(len); //upper limit for buffer size, larger than input size!!!
+}
+
+
+size_t zen::impl::zstd_compress(const void* src, size_t srcLen, void* trg, size_t trgLen, int level, int threadCount) //throw SysError
+{
+    ZSTD_CCtx* cctx = ::ZSTD_createCCtx();
+    if (!cctx)
+        throw SysError(formatSystemError("ZSTD_createCCtx", L"", L"Out of memory."));
+    ZEN_ON_SCOPE_EXIT(::ZSTD_freeCCtx(cctx));
+
+    size_t rv = ::ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, level);
+    if (::ZSTD_isError(rv))
+        throw SysError(formatSystemError("ZSTD_CCtx_setParameter(ZSTD_c_compressionLevel)", L"", zen::utfTo<std::wstring>(::ZSTD_getErrorName(rv))));
+
+    if (threadCount > 0)
+        /*rv =*/ ::ZSTD_CCtx_setParameter(cctx, ZSTD_c_nbWorkers, threadCount); //fails if libzstd is built without ZSTD_MULTITHREAD => continue single-threaded
+
+    rv = ::ZSTD_compress2(cctx, trg, trgLen, src, srcLen);
+    if (::ZSTD_isError(rv) || rv > trgLen)
+        throw SysError(formatSystemError("ZSTD_compress2", L"", ::ZSTD_isError(rv) ? zen::utfTo<std::wstring>(::ZSTD_getErrorName(rv)) : L""));
+
+    return rv;
+}
+
+
+class InputStreamAsZstd::Impl
+{
+public:
+    Impl(const std::function<size_t(void* buffer, size_t bytesToRead)>& readBlock /*throw X*/, int level, int threadCount) : //throw SysError
+        readBlock_(readBlock),
+        cctx_(::ZSTD_createCCtx())
+    {
+        if (!cctx_)
+            throw SysError(formatSystemError("ZSTD_createCCtx", L"", L"Out of memory."));
+        ZEN_ON_SCOPE_FAIL(::ZSTD_freeCCtx(cctx_));
+
+        const size_t rv = ::ZSTD_CCtx_setParameter(cctx_, ZSTD_c_compressionLevel, level);
+        if (::ZSTD_isError(rv))
+            throw SysError(formatSystemError("ZSTD_CCtx_setParameter(ZSTD_c_compressionLevel)", L"", zen::utfTo<std::wstring>(::ZSTD_getErrorName(rv))));
+
+        if (threadCount > 0) //compress in background threads while we're reading/writing => parallel I/O and compression
+            /*rv =*/ ::ZSTD_CCtx_setParameter(cctx_, ZSTD_c_nbWorkers, threadCount); //fails if libzstd is built without ZSTD_MULTITHREAD => continue single-threaded
+
+        bufIn_.resize(::ZSTD_CStreamInSize());
+    }
+
+    ~Impl() { ::ZSTD_freeCCtx(cctx_); }
+
+    size_t read(void* buffer, size_t bytesToRead) //throw SysError, X; return "bytesToRead" bytes unless end of stream!
+    {
+        if (bytesToRead == 0) //"read() with a count of 0 returns zero" => indistinguishable from end of file! => check!
+            throw std::logic_error("Contract violation! " + std::string(__FILE__) + ':' + numberTo<std::string>(__LINE__));
+
+        ZSTD_outBuffer out{buffer, bytesToRead, 0};
+
+        while (out.pos < out.size && !frameDone_)
+        {
+            if (in_.pos == in_.size && !eof_)
+            {
+                const size_t bytesRead = readBlock_(bufIn_.data(), bufIn_.size()); //throw X; returning 0 signals EOF: Posix read() semantics
+                in_ = {bufIn_.data(), bytesRead, 0};
+                if (bytesRead == 0)
+                    eof_ = true;
+            }
+
+            const size_t rv = ::ZSTD_compressStream2(cctx_, &out, &in_, eof_ ? ZSTD_e_end : ZSTD_e_continue);
+            if (::ZSTD_isError(rv))
+                throw SysError(formatSystemError("ZSTD_compressStream2", L"", zen::utfTo<std::wstring>(::ZSTD_getErrorName(rv))));
+
+            if (eof_ && rv == 0) //frame completely flushed
+                frameDone_ = true;
+        }
+        return out.pos;
+    }
+
+private:
+    const std::function<size_t(void* buffer, size_t bytesToRead)> readBlock_; //throw X
+    ZSTD_CCtx* const cctx_;
+    std::vector<std::byte> bufIn_;
+    ZSTD_inBuffer in_{};
+    bool eof_ = false;
+    bool frameDone_ = false;
+};
+
+
+zen::InputStreamAsZstd::InputStreamAsZstd(const std::function<size_t(void* buffer, size_t bytesToRead)>& readBlock /*throw X*/, int level, int threadCount) : //throw SysError
+    pimpl_(std::make_unique<Impl>(readBlock, level, threadCount)) {}
+zen::InputStreamAsZstd::~InputStreamAsZstd() {}
+size_t zen::InputStreamAsZstd::read(void* buffer, size_t bytesToRead) { return pimpl_->read(buffer, bytesToRead); } //throw SysError, X
+
+
+size_t zen::impl::zstd_decompress(const void* src, size_t srcLen, void* trg, size_t trgLen) //throw SysError
+{
+    const size_t rv = ::ZSTD_decompress(trg, trgLen, src, srcLen);
+    if (::ZSTD_isError(rv) || rv > trgLen)
+        throw SysError(formatSystemError("ZSTD_decompress", L"", ::ZSTD_isError(rv) ? zen::utfTo<std::wstring>(::ZSTD_getErrorName(rv)) : L""));
+
+    return rv;
+}
@@ -0,0 +1,118 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#ifndef ZSTD_WRAP_H_2837465019283746
+#define ZSTD_WRAP_H_2837465019283746
+
+#include "serialize.h"
+#include "sys_error.h"
+
+
+namespace zen
+{
+//same container layout as zlib_wrap.h: uncompressed size (uint64_t) + compressed data
+// level: 1 (fastest) to 19 (best compression)
+// threadCount: 0 = single-threaded; ignored if libzstd was built without multi-threading support
+template <class BinContainer> //as specified in serialize.h
+BinContainer compressZstd(const BinContainer& stream, int level, int threadCount); //throw SysError
+
+template <class BinContainer>
+BinContainer decompressZstd(const BinContainer& stream); //throw SysError
+
+
+class InputStreamAsZstd //convert input stream into a standard .zst frame on the fly: counterpart of InputStreamAsGzip
+{
+public:
+    InputStreamAsZstd( //throw SysError
+        const std::function<size_t(void* buffer, size_t bytesToRead)>& readBlock /*throw X;  returning 0 signals EOF: Posix read() semantics*/,
+        int level, int threadCount);
+    ~InputStreamAsZstd();
+
+    size_t read(void* buffer, size_t bytesToRead); //throw SysError, X; return "bytesToRead" bytes unless end of stream!
+
+private:
+    class Impl;
+    const std::unique_ptr<Impl> pimpl_;
+};
+
+
+
+
+
+
+//######################## implementation ##########################
+namespace impl
+{
+size_t zstd_compressBound(size_t len);
+size_t zstd_compress  (const void* src, size_t srcLen, void* trg, size_t trgLen, int level, int threadCount); //throw SysError
+size_t zstd_decompress(const void* src, size_t srcLen, void* trg, size_t trgLen);                             //throw SysError
+}
+
+
+template <class BinContainer>
+BinContainer compressZstd(const BinContainer& stream, int level, int threadCount) //throw SysError
+{
+    BinContainer contOut;
+    if (!stream.empty()) //don't dereference iterator into empty container!
+    {
+        //save uncompressed stream size for decompression
+        const uint64_t uncompressedSize = stream.size(); //use portable number type!
+        contOut.resize(sizeof(uncompressedSize));
+        std::memcpy(&contOut[0], &uncompressedSize, sizeof(uncompressedSize));
+
+        const size_t bufferEstimate = impl::zstd_compressBound(stream.size()); //upper limit for buffer size, larger than input size!!!
+
+        contOut.resize(contOut.size() + bufferEstimate);
+
+        const size_t bytesWritten = impl::zstd_compress(&*stream.begin(),
+                                                        stream.size(),
+                                                        &*contOut.begin() + contOut.size() - bufferEstimate,
+                                                        bufferEstimate,
+                                                        level, threadCount); //throw SysError
+        if (bytesWritten < bufferEstimate)
+            contOut.resize(contOut.size() - (bufferEstimate - bytesWritten)); //caveat: unsigned arithmetics
+        //caveat: physical memory consumption still *unchanged*!
+    }
+    return contOut;
+}
+
+
+template <class BinContainer>
+BinContainer decompressZstd(const BinContainer& stream) //throw SysError
+{
+    BinContainer contOut;
+    if (!stream.empty()) //don't dereference iterator into empty container!
+    {
+        //retrieve size of uncompressed data
+        uint64_t uncompressedSize = 0; //use portable number type!
+        if (stream.size() < sizeof(uncompressedSize))
+            throw SysError(L"zstd error: stream size < 8");
+
+        std::memcpy(&uncompressedSize, &*stream.begin(), sizeof(uncompressedSize));
+
+        if (uncompressedSize == 0) //cannot be 0: compressZstd() directly maps empty -> empty container
+            throw SysError(L"zstd error: uncompressed size == 0");
+
+        try
+        {
+            contOut.resize(static_cast<size_t>(uncompressedSize)); //throw std::bad_alloc
+        }
+        //most likely this is due to data corruption:
+        catch (const std::length_error& e) { throw SysError(L"zstd error: " + _("Out of memory.") + L' ' + utfTo<std::wstring>(e.what())); }
+        catch (const    std::bad_alloc& e) { throw SysError(L"zstd error: " + _("Out of memory.") + L' ' + utfTo<std::wstring>(e.what())); }
+
+        const size_t bytesWritten = impl::zstd_decompress(&*stream.begin() + sizeof(uncompressedSize),
+                                                          stream.size() - sizeof(uncompressedSize),
+                                                          &*contOut.begin(),
+                                                          static_cast<size_t>(uncompressedSize)); //throw SysError
+        if (bytesWritten != static_cast<size_t>(uncompressedSize))
+            throw SysError(formatSystemError("ZSTD_decompress", L"", L"bytes written != uncompressed size."));
+    }
+    return contOut;
+}
+}
+
+#endif //ZSTD_WRAP_H_2837465019283746
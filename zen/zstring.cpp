@@ -5,19 +5,88 @@
 // *****************************************************************************
 
 #include "zstring.h"
+#include <array>
+#include <cstring>
     #include <glib.h>
     #include "sys_error.h"
 
 using namespace zen;
 
 
+namespace
+{
+/* process 8 chars at a time ("SWAR"): portable without instruction set dependencies or build flags,
+   and simple enough for the compiler to vectorize further  */
+using CharBlock = uint64_t;
+constexpr CharBlock BLOCK_ONES      = 0x0101010101010101;
+constexpr CharBlock BLOCK_HIGH_BITS = 0x8080808080808080;
+
+
+bool isAsciiUtf8(const char* str, size_t len)
+{
+    const char* const strEnd = str + len;
+
+    CharBlock bitsSet = 0;
+    for (; strEnd - str >= static_cast<ptrdiff_t>(sizeof(CharBlock)); str += sizeof(CharBlock))
+    {
+        CharBlock block = 0;
+        std::memcpy(&block, str, sizeof(block)); //unaligned access
+        bitsSet |= block;
+    }
+    for (; str != strEnd; ++str)
+        bitsSet |= static_cast<unsigned char>(*str);
+
+    return (bitsSet & BLOCK_HIGH_BITS) == 0;
+}
+
+
+//precondition: all chars are ASCII (high bit not set) => no carry between chars
+inline
+CharBlock asciiBlockToUpper(CharBlock block)
+{
+    const CharBlock geLowerA = block + BLOCK_ONES * (0x80 - 'a');     //high bit set if char >= 'a'
+    const CharBlock gtLowerZ = block + BLOCK_ONES * (0x80 - 'z' - 1); //high bit set if char >  'z'
+    const CharBlock isLower = geLowerA & ~gtLowerZ & BLOCK_HIGH_BITS;
+    return block - (isLower >> 2); //'a' - 'A' == 0x20 == 0x80 >> 2
+}
+
+
+void asciiToUpperInPlace(char* str, size_t len)
+{
+    char* const strEnd = str + len;
+
+    for (; strEnd - str >= static_cast<ptrdiff_t>(sizeof(CharBlock)); str += sizeof(CharBlock))
+    {
+        CharBlock block = 0;
+        std::memcpy(&block, str, sizeof(block));
+        block = asciiBlockToUpper(block);
+        std::memcpy(str, &block, sizeof(block));
+    }
+    for (; str != strEnd; ++str)
+        *str = asciiToUpper(*str);
+}
+}
+
+
 Zstring getUnicodeNormalForm(const Zstring& str)
 {
     //fast pre-check:
-    if (isAsciiString(str)) //perf: in the range of 3.5ns
+    if (isAsciiUtf8(str.c_str(), str.size())) //perf: in the range of 3.5ns
         return str;
     static_assert(std::is_same_v<decltype(str), const Zbase<Zchar>&>, "god bless our ref-counting! => save output string memory consumption!");
 
+    //g_utf8_normalize() is slow and allocates: memoize recent results, e.g. same name normalized for ZstringNorm *and* ZstringNoCase
+    struct NormFormCacheEntry
+    {
+        Zstring str;
+        Zstring strNorm;
+    };
+    thread_local std::array<NormFormCacheEntry, 64> normFormCache; //direct-mapped; per thread => no locking
+
+    NormFormCacheEntry& cacheEntry = normFormCache[hashString<size_t>(str) % normFormCache.size()];
+    if (cacheEntry.str == str && !cacheEntry.str.empty())
+        return cacheEntry.strNorm;
+
     //Example: const char* decomposed  = "\x6f\xcc\x81";
     //         const char* precomposed = "\xc3\xb3";
     try
@@ -26,7 +95,12 @@ Zstring getUnicodeNormalForm(const Zstring& str)
         if (!outStr)
             throw SysError(formatSystemError("g_utf8_normalize(" + utfTo<std::string>(str) + ')', L"", L"Conversion failed."));
         ZEN_ON_SCOPE_EXIT(::g_free(outStr));
-        return outStr;
+
+        Zstring strNorm = outStr;
+        if (strNorm == str)
+            strNorm = str; //already normalized: share memory
+        cacheEntry = {str, strNorm};
+        return strNorm;
 
     }
     catch ([[maybe_unused]] const SysError& e)
@@ -42,11 +116,11 @@ Zstring getUpperCase(const Zstring& str)
     assert(str.find(Zchar('\0')) == Zstring::npos); //don't expect embedded nulls!
 
     //fast pre-check:
-    if (isAsciiString(str)) //perf: in the range of 3.5ns
+    if (isAsciiUtf8(str.c_str(), str.size())) //perf: in the range of 3.5ns
     {
         Zstring output = str;
-        for (Zchar& c : output)
-            c = asciiToUpper(c);
+        if (!output.empty())
+            asciiToUpperInPlace(&output[0], output.size());
         return output;
     }
 
@@ -72,6 +146,23 @@ Zstring getUpperCase(const Zstring& str)
 }
 
 
+Zstring getUpperCaseKey(const Zstring& str)
+{
+    if (isAsciiUtf8(str.c_str(), str.size()))
+        return str; //perf: ref-counted copy
+    return getUpperCase(str);
+}
+
+
+std::strong_ordering compareUpperCaseKey(const Zstring& lhsKey, const Zstring& rhsKey)
+{
+    //non-ASCII keys: asciiToUpper() is a no-op for getUpperCase() output
+    return std::lexicographical_compare_three_way(lhsKey.begin(), lhsKey.end(), //respect embedded 0
+                                                  rhsKey.begin(), rhsKey.end(),
+    [](Zchar lhs, Zchar rhs) { return asciiToUpper(lhs) <=> asciiToUpper(rhs); });
+}
+
+
 namespace
 {
 std::weak_ordering compareNoCaseUtf8(const char* lhs, size_t lhsLen, const char* rhs, size_t rhsLen)
@@ -182,3 +273,54 @@ std::weak_ordering compareNatural(const Zstring& lhs, const Zstring& rhs)
     }
 
 }
+
+
+std::string getNaturalSortKey(const Zstring& str)
+{
+    //mirror compareNatural() block by block: each block is tagged by a type byte ordered like compareNatural() orders the blocks
+    const char BLOCK_WHITESPACE = '\x01'; //whitespace before numbers
+    const char BLOCK_NUMBER     = '\x02'; //numbers before text
+    const char BLOCK_TEXT       = '\x03'; //end of string (= end of key) before everything
+
+    const Zstring& strNorm = getUnicodeNormalForm(str);
+    const char*       it    = strNorm.c_str();
+    const char* const itEnd = it + strNorm.size();
+
+    std::string key; //not Zstring: std::string compares as unsigned char
+    key.reserve(strNorm.size() + 8);
+
+    while (it != itEnd)
+        if (isWhiteSpace(*it))
+        {
+            key += BLOCK_WHITESPACE;
+            while (it != itEnd && isWhiteSpace(*it)) ++it;
+        }
+        else if (isDigit(*it))
+        {
+            while (it != itEnd && *it == '0') ++it;
+
+            const char* const digitsBegin = it;
+            while (it != itEnd && isDigit(*it)) ++it;
+
+            //more digits means bigger number: digit count as fixed-size big-endian prefix, then compare digits from left
+            const auto digitCount = static_cast<uint32_t>(it - digitsBegin);
+            key += BLOCK_NUMBER;
+            for (int shift = 24; shift >= 0; shift -= 8)
+                key += static_cast<char>((digitCount >> shift) & 0xff);
+            key.append(digitsBegin, it);
+        }
+        else
+        {
+            const char* const textBegin = it++;
+            while (it != itEnd && !isWhiteSpace(*it) && !isDigit(*it)) ++it;
+
+            //same as compareNoCaseUtf8(): UTF-8 byte order == code point order
+            key += BLOCK_TEXT;
+            UtfDecoder<char> dec(textBegin, it - textBegin);
+            while (const std::optional<impl::CodePoint> cp = dec.getNext())
+                impl::codePointToUtf8(::g_unichar_toupper(*cp), [&](char c) { key += c; });
+            key += '\0'; //shorter text before longer text with same prefix (code points > 0!)
+        }
+
+    return key;
+}
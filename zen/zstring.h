@@ -38,10 +38,17 @@ Zstring getUnicodeNormalForm(const Zstring& str);
     - output is Unicode-normalized                                         */
 Zstring getUpperCase(const Zstring& str);
 
+/* case-insensitive sort key: no memory allocation for ASCII strings (= most file names), which are upper-cased during comparison instead
+   => compareUpperCaseKey(getUpperCaseKey(lhs), getUpperCaseKey(rhs)) == getUpperCase(lhs) <=> getUpperCase(rhs)              */
+Zstring getUpperCaseKey(const Zstring& str);
+std::strong_ordering compareUpperCaseKey(const Zstring& lhsKey, const Zstring& rhsKey);
+
 //------------------------------------------------------------------------------------------
 struct ZstringNorm //use as STL container key: avoid needless Unicode normalizations during std::map<>::find()
 {
     /*explicit*/ ZstringNorm(const Zstring& str) : normStr(getUnicodeNormalForm(str)) {}
+    struct InNormalForm {}; //perf: caller already knows str is normalized
+    ZstringNorm(const Zstring& str, InNormalForm) : normStr(str) { assert(getUnicodeNormalForm(str) == str); }
     Zstring normStr;
 
     std::strong_ordering operator<=>(const ZstringNorm&) const = default;
@@ -67,6 +74,10 @@ std::weak_ordering compareNatural(const Zstring& lhs, const Zstring& rhs);
 
 struct LessNaturalSort { bool operator()(const Zstring& lhs, const Zstring& rhs) const { return std::is_lt(compareNatural(lhs, rhs)); } };
 
+//binary sort key: comparing keys yields the same order as compareNatural(), equal keys <=> equivalent strings
+//=> calculate once when sorting many items instead of normalizing/case-converting during each comparison
+std::string getNaturalSortKey(const Zstring& str);
+
 
 //------------------------------------------------------------------------------------------
 //common Unicode characters
@@ -49,6 +49,8 @@ public:
 
     void setValue(std::string&& value) { value_ = std::move(value); } //perf
 
+    const std::string& getValueRef() const { return value_; } //perf: raw string value, no conversion
+
     ///Retrieve an attribute by name.
     /**
       \tparam T String-convertible user data type: e.g. any string class, all built-in arithmetic numbers
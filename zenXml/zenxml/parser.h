@@ -75,10 +75,19 @@ XmlDoc parseXml(const std::string& stream); //throw XmlParsingError
 namespace xml_impl
 {
 template <class Predicate> inline
-std::string normalize(const std::string_view& str, Predicate pred) //pred: unary function taking a char, return true if value shall be encoded as hex
+void normalize(std::string_view str, std::string& output, Predicate pred) //pred: unary function taking a char, return true if value shall be encoded as hex
 {
-    std::string output;
-    for (const char c : str)
+    auto needsEncoding = [&](char c) { return c == '&' || c == '<' || c == '>' || pred(c); };
+
+    for (auto it = str.begin(); ;)
+    {
+        //perf: append runs of unchanged chars at once
+        const auto itEnc = std::find_if(it, str.end(), needsEncoding);
+        output.append(it, itEnc);
+        if (itEnc == str.end())
+            break;
+
+        const char c = *itEnc;
         switch (c)
         {
 			//*INDENT-OFF*
@@ -86,45 +95,40 @@ std::string normalize(const std::string_view& str, Predicate pred) //pred: unary
 			case '<': output +=  "&lt;"; break; //normalization mandatory: https://www.w3.org/TR/xml/#syntax
 			case '>': output +=  "&gt;"; break; //
 			default:
-				if (pred(c))
+				if      (c == '\'') output += "&apos;";
+				else if (c ==  '"') output += "&quot;";
+				else
 				{
-					if      (c == '\'') output += "&apos;";
-					else if (c ==  '"') output += "&quot;";
-					else
-					{
-						output += "&#x";
-						const auto [high, low] = hexify(c);
-						output += high;
-						output += low;
-						output += ';';
-					}
+					output += "&#x";
+					const auto [high, low] = hexify(c);
+					output += high;
+					output += low;
+					output += ';';
 				}
-				else
-					output += c;
 				break;
 			//*INDENT-ON*
         }
-    return output;
+        it = itEnc + 1;
+    }
 }
 
 inline
-std::string normalizeName(const std::string& str)
+void normalizeName(std::string_view str, std::string& output)
 {
-    /*const*/ std::string nameFmt = normalize(str, [](char c) { return isWhiteSpace(c) || c == '=' || c == '/' || c == '\'' || c == '"'; });
-    assert(!nameFmt.empty());
-    return nameFmt;
+    assert(!str.empty());
+    normalize(str, output, [](char c) { return isWhiteSpace(c) || c == '=' || c == '/' || c == '\'' || c == '"'; });
 }
 
 inline
-std::string normalizeElementValue(const std::string& str)
+void normalizeElementValue(std::string_view str, std::string& output)
 {
-    return normalize(str, [](char c) { return static_cast<unsigned char>(c) < 32; });
+    normalize(str, output, [](char c) { return static_cast<unsigned char>(c) < 32; });
 }
 
 inline
-std::string normalizeAttribValue(const std::string& str)
+void normalizeAttribValue(std::string_view str, std::string& output)
 {
-    return normalize(str, [](char c) { return static_cast<unsigned char>(c) < 32 || c == '\'' || c == '"'; });
+    normalize(str, output, [](char c) { return static_cast<unsigned char>(c) < 32 || c == '\'' || c == '"'; });
 }
 
 
@@ -146,6 +150,9 @@ namespace
 {
 std::string denormalize(const std::string_view& str)
 {
+    if (std::none_of(str.begin(), str.end(), [](char c) { return c == '&' || c == '\r'; })) //perf: nothing to convert for most names/values
+        return std::string(str);
+
     std::string output;
     for (auto it = str.begin(); it != str.end(); ++it)
     {
@@ -190,44 +197,64 @@ std::string denormalize(const std::string_view& str)
 }
 
 
+//write directly into output stream: avoid string temporaries for each element and attribute
 void serialize(const XmlElement& element, std::string& stream,
                const std::string& lineBreak,
                const std::string& indent,
                size_t indentLevel)
 {
-    const std::string& nameFmt = normalizeName(element.getName());
-
-    for (size_t i = 0; i < indentLevel; ++i)
-        stream += indent;
+    auto writeIndent = [&]
+    {
+        for (size_t i = 0; i < indentLevel; ++i)
+            stream += indent;
+    };
+    writeIndent();
 
-    stream += '<' + nameFmt;
+    stream += '<';
+    normalizeName(element.getName(), stream);
 
     auto attr = element.getAttributes();
     for (auto it = attr.first; it != attr.second; ++it)
-        stream += ' ' + normalizeName(it->name) + "=\"" + normalizeAttribValue(it->value) + '"';
+    {
+        stream += ' ';
+        normalizeName(it->name, stream);
+        stream += "=\"";
+        normalizeAttribValue(it->value, stream);
+        stream += '"';
+    }
+
+    auto writeEndTag = [&]
+    {
+        stream += "</";
+        normalizeName(element.getName(), stream);
+        stream += '>';
+        stream += lineBreak;
+    };
 
     auto itPair = element.getChildren();
     if (itPair.first != itPair.second) //structured element
     {
         //no support for mixed-mode content
-        stream += '>' + lineBreak;
+        stream += '>';
+        stream += lineBreak;
 
         std::for_each(itPair.first, itPair.second,
         [&](const XmlElement& el) { serialize(el, stream, lineBreak, indent, indentLevel + 1); });
 
-        for (size_t i = 0; i < indentLevel; ++i)
-            stream += indent;
-        stream += "</" + nameFmt + '>' + lineBreak;
+        writeIndent();
+        writeEndTag();
     }
-    else
+    else if (const std::string& value = element.getValueRef();
+             !value.empty()) //value element
     {
-        std::string value;
-        element.getValue(value);
-
-        if (!value.empty()) //value element
-            stream += '>' + normalizeElementValue(value) + "</" + nameFmt + '>' + lineBreak;
-        else //empty element
-            stream += "/>" + lineBreak;
+        stream += '>';
+        normalizeElementValue(value, stream);
+        writeEndTag();
+    }
+    else //empty element
+    {
+        stream += "/>";
+        stream += lineBreak;
     }
 }
 }
@@ -240,19 +267,23 @@ std::string serializeXml(const XmlDoc& doc,
 {
     std::string output = "<?xml";
 
-    const std::string& version = doc.getVersion();
-    if (!version.empty())
-        output += " version=\"" + xml_impl::normalizeAttribValue(version) + '"';
-
-    const std::string& encoding = doc.getEncoding();
-    if (!encoding.empty())
-        output += " encoding=\"" + xml_impl::normalizeAttribValue(encoding) + '"';
-
-    const std::string& standalone = doc.getStandalone();
-    if (!standalone.empty())
-        output += " standalone=\"" + xml_impl::normalizeAttribValue(standalone) + '"';
+    auto writeDeclAttribute = [&](const char* name, const std::string& value)
+    {
+        if (!value.empty())
+        {
+            output += ' ';
+            output += name;
+            output += "=\"";
+            xml_impl::normalizeAttribValue(value, output);
+            output += '"';
+        }
+    };
+    writeDeclAttribute("version",    doc.getVersion());
+    writeDeclAttribute("encoding",   doc.getEncoding());
+    writeDeclAttribute("standalone", doc.getStandalone());
 
-    output += "?>" + lineBreak;
+    output += "?>";
+    output += lineBreak;
 
     xml_impl::serialize(doc.root(), output, lineBreak, indent, 0 /*indentLevel*/);
     return output;
@@ -311,7 +342,7 @@ struct Token
 class Scanner
 {
 public:
-    explicit Scanner(const std::string& stream) : stream_(stream), pos_(stream_.begin())
+    explicit Scanner(std::string_view stream) : stream_(stream), pos_(stream_.begin())
     {
         if (zen::startsWith(stream_, BYTE_ORDER_MARK_UTF8))
             pos_ += strLength(BYTE_ORDER_MARK_UTF8);
@@ -326,22 +357,33 @@ public:
             return Token::TK_END;
 
         //skip XML comments
-        if (startsWith(xmlCommentBegin_))
+        if (startsWith(xmlCommentBegin))
         {
-            auto it = std::search(pos_ + xmlCommentBegin_.size(), stream_.end(), xmlCommentEnd_.begin(), xmlCommentEnd_.end());
+            auto it = std::search(pos_ + xmlCommentBegin.size(), stream_.end(), xmlCommentEnd.begin(), xmlCommentEnd.end());
             if (it != stream_.end())
             {
-                pos_ = it + xmlCommentEnd_.size();
+                pos_ = it + xmlCommentEnd.size();
                 return getNextToken(); //throw XmlParsingError
             }
         }
 
-        for (auto it = tokens_.begin(); it != tokens_.end(); ++it)
-            if (startsWith(it->first))
-            {
-                pos_ += it->first.size();
-                return it->second;
-            }
+        switch (*pos_) //perf: dispatch on first char instead of trying all tokens
+        {
+            case '<':
+                if (startsWith("<?xml")) return pos_ += 5, Token::TK_DECL_BEGIN;
+                if (startsWith("</"))    return pos_ += 2, Token::TK_LESS_SLASH;
+                return ++pos_, Token::TK_LESS;
+            case '?':
+                if (startsWith("?>")) return pos_ += 2, Token::TK_DECL_END;
+                break;
+            case '/':
+                if (startsWith("/>")) return pos_ += 2, Token::TK_SLASH_GREATER;
+                break;
+            case '>':  return ++pos_, Token::TK_GREATER;
+            case '=':  return ++pos_, Token::TK_EQUAL;
+            case '"':
+            case '\'': return ++pos_, Token::TK_QUOTE;
+        }
 
         const auto itNameEnd = std::find_if(pos_, stream_.end(), [](char c)
         {
@@ -415,37 +457,23 @@ private:
     Scanner           (const Scanner&) = delete;
     Scanner& operator=(const Scanner&) = delete;
 
-    bool startsWith(const std::string& prefix) const
+    bool startsWith(std::string_view prefix) const
     {
         return zen::startsWith(makeStringView(pos_, stream_.end()), prefix);
     }
 
-    using TokenList = std::vector<std::pair<std::string, Token::Type>>;
-    const TokenList tokens_
-    {
-        {"<?xml", Token::TK_DECL_BEGIN   },
-        {"?>",    Token::TK_DECL_END     },
-        {"</",    Token::TK_LESS_SLASH   },
-        {"/>",    Token::TK_SLASH_GREATER},
-        {"<",     Token::TK_LESS         }, //evaluate after TK_DECL_BEGIN!
-        {">",     Token::TK_GREATER      },
-        {"=",     Token::TK_EQUAL        },
-        {"\"",    Token::TK_QUOTE        },
-        {"\'",    Token::TK_QUOTE        },
-    };
+    static constexpr std::string_view xmlCommentBegin = "<!--";
+    static constexpr std::string_view xmlCommentEnd   = "-->";
 
-    const std::string xmlCommentBegin_ = "<!--";
-    const std::string xmlCommentEnd_   = "-->";
-
-    const std::string stream_;
-    std::string::const_iterator pos_;
+    const std::string_view stream_; //no copy: parseXml() input outlives Scanner
+    std::string_view::const_iterator pos_;
 };
 
 
 class XmlParser
 {
 public:
-    explicit XmlParser(const std::string& stream) :
+    explicit XmlParser(std::string_view stream) :
         scn_(stream),
         tk_(scn_.getNextToken()) {} //throw XmlParsingError
 
@@ -460,7 +488,7 @@ public:
 
             while (token().type == Token::TK_NAME)
             {
-                std::string attribName = token().name;
+                const std::string attribName = std::move(tk_.name);
                 nextToken(); //throw XmlParsingError
 
                 consumeToken(Token::TK_EQUAL); //throw XmlParsingError
@@ -502,11 +530,9 @@ private:
             nextToken(); //throw XmlParsingError
 
             expectToken(Token::TK_NAME); //throw XmlParsingError
-            const std::string elementName = token().name;
+            XmlElement& newElement = parent.addChild(std::move(tk_.name));
             nextToken(); //throw XmlParsingError
 
-            XmlElement& newElement = parent.addChild(elementName);
-
             parseAttributes(newElement);
 
             if (token().type == Token::TK_SLASH_GREATER) //empty element
@@ -528,7 +554,7 @@ private:
             consumeToken(Token::TK_LESS_SLASH); //throw XmlParsingError
 
             expectToken(Token::TK_NAME); //throw XmlParsingError
-            if (token().name != elementName)
+            if (token().name != newElement.getName())
                 throw XmlParsingError(scn_.posRow(), scn_.posCol());
             nextToken(); //throw XmlParsingError
 
@@ -540,16 +566,16 @@ private:
     {
         while (token().type == Token::TK_NAME)
         {
-            const std::string attribName = token().name;
+            std::string attribName = std::move(tk_.name);
             nextToken(); //throw XmlParsingError
 
             consumeToken(Token::TK_EQUAL); //throw XmlParsingError
             expectToken (Token::TK_QUOTE); //
-            std::string attribValue = scn_.extractAttributeValue();
+            const std::string attribValue = scn_.extractAttributeValue();
             nextToken(); //throw XmlParsingError
 
             consumeToken(Token::TK_QUOTE); //throw XmlParsingError
-            element.setAttribute(attribName, attribValue);
+            element.setAttribute(std::move(attribName), attribValue);
         }
     }
 